@@ -238,6 +238,13 @@ compile_shader "$SHADER_DIR/basic.vert" "basic_vert"
 compile_shader "$SHADER_DIR/basic.frag" "basic_frag"
 compile_shader "$SHADER_DIR/textured.vert" "textured_vert"
 compile_shader "$SHADER_DIR/textured.frag" "textured_frag"
+compile_shader "$SHADER_DIR/textured_array.vert" "textured_array_vert"
+compile_shader "$SHADER_DIR/textured_array.frag" "textured_array_frag"
+compile_shader "$SHADER_DIR/circle.frag" "circle_frag"
+compile_shader "$SHADER_DIR/static.vert" "static_vert"
+compile_shader "$SHADER_DIR/static_array.vert" "static_array_vert"
+compile_shader "$SHADER_DIR/overlay_array.vert" "overlay_array_vert"
+compile_shader "$SHADER_DIR/overlay_array.frag" "overlay_array_frag"
 
 # Copy VMA header to build location
 cp $DEPS/vk_mem_alloc.h $ANDROID_PROJECT/app/jni/src/vk_mem_alloc.h 2>/dev/null || true
@@ -308,6 +315,12 @@ android {
         }
     }
 
+    // Game data placed in src/main/assets is read from the APK in place,
+    // which needs it stored uncompressed
+    androidResources {
+        noCompress 'hog', 'pig', 'ham', 'mvl', 'msn', 'mn2', 'rdl', 'rl2', 's11', 's22', 'txb', 'zip'
+    }
+
     lint {
         abortOnError false
     }
@@ -462,6 +475,7 @@ set(PHYSFS_INCLUDE_DIR "${PHYSFS_ROOT}/include")
 # --------------------------------------------------------------------------
 set(DXX_LIBRARY_SOURCES
     ${DXX_SRC_ROOT}/common/maths/fixc.cpp
+    ${DXX_SRC_ROOT}/common/maths/light_span.cpp
     ${DXX_SRC_ROOT}/common/maths/tables.cpp
     ${DXX_SRC_ROOT}/common/maths/vecmat.cpp
 )
@@ -484,6 +498,7 @@ set(DXX_COMMON_SOURCES
     ${DXX_SRC_ROOT}/common/2d/pixel.cpp
     ${DXX_SRC_ROOT}/common/2d/rect.cpp
     ${DXX_SRC_ROOT}/common/2d/rle.cpp
+    ${DXX_SRC_ROOT}/common/2d/rle_span.cpp
     ${DXX_SRC_ROOT}/common/2d/scalec.cpp
     ${DXX_SRC_ROOT}/common/3d/draw.cpp
     ${DXX_SRC_ROOT}/common/3d/globvars.cpp
@@ -502,21 +517,33 @@ set(DXX_COMMON_SOURCES
     ${DXX_SRC_ROOT}/common/main/cli.cpp
     ${DXX_SRC_ROOT}/common/main/cmd.cpp
     ${DXX_SRC_ROOT}/common/main/cvar.cpp
+    ${DXX_SRC_ROOT}/common/main/frame_profile.cpp
+    ${DXX_SRC_ROOT}/common/main/level_cache.cpp
+    ${DXX_SRC_ROOT}/common/main/load_trace.cpp
     ${DXX_SRC_ROOT}/common/main/piggy.cpp
     ${DXX_SRC_ROOT}/common/maths/rand.cpp
     ${DXX_SRC_ROOT}/common/mem/mem.cpp
+    ${DXX_SRC_ROOT}/common/mem/mem_account.cpp
+    ${DXX_SRC_ROOT}/common/mem/mem_trim.cpp
     ${DXX_SRC_ROOT}/common/misc/error.cpp
     ${DXX_SRC_ROOT}/common/misc/hash.cpp
     ${DXX_SRC_ROOT}/common/misc/hmp.cpp
     ${DXX_SRC_ROOT}/common/misc/ignorecase.cpp
+    ${DXX_SRC_ROOT}/common/misc/parallel.cpp
+    ${DXX_SRC_ROOT}/common/misc/physfs_apk.cpp
+    ${DXX_SRC_ROOT}/common/misc/physfs_hog.cpp
     ${DXX_SRC_ROOT}/common/misc/physfsrwops.cpp
     ${DXX_SRC_ROOT}/common/misc/physfsx.cpp
+    ${DXX_SRC_ROOT}/common/misc/resample_span.cpp
     ${DXX_SRC_ROOT}/common/misc/strutil.cpp
     ${DXX_SRC_ROOT}/common/misc/vgrphys.cpp
     ${DXX_SRC_ROOT}/common/misc/vgwphys.cpp
     # OGL support
     ${DXX_SRC_ROOT}/common/arch/ogl/ogl_extensions.cpp
     ${DXX_SRC_ROOT}/common/arch/ogl/ogl_sync.cpp
+    ${DXX_SRC_ROOT}/common/arch/ogl/ogl_texture_cache.cpp
+    ${DXX_SRC_ROOT}/common/arch/ogl/ogl_texture_pool.cpp
+    ${DXX_SRC_ROOT}/common/arch/ogl/ogl_texture_prep.cpp
     # SDL_mixer support
     ${DXX_SRC_ROOT}/common/arch/sdl/digi_mixer_music.cpp
     ${DXX_SRC_ROOT}/common/arch/sdl/jukebox.cpp
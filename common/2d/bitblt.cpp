@@ -29,6 +29,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "u_mem.h"
 #include "gr.h"
 #include "rle.h"
+#include "rle_span.h"
 #include "dxxerror.h"
 #include "byteutil.h"
 #if DXX_USE_OGL
@@ -55,10 +56,7 @@ static void gr_bm_ubitblt0x_rle(grs_canvas &dest, unsigned w, unsigned h, int dx
 #if !DXX_USE_OGL
 static void gr_linear_rep_movsdm(uint8_t *const dest, const uint8_t *const src, const uint_fast32_t num_pixels)
 {
-	auto predicate = [&](uint8_t s, uint8_t d) {
-		return s == 255 ? d : s;
-	};
-	std::transform(src, src + num_pixels, dest, dest, predicate);
+	gr_copy_masked(dest, src, num_pixels);
 }
 #endif
 
@@ -344,6 +342,14 @@ void gr_bm_ubitbltm(grs_canvas &canvas, const unsigned w, const unsigned h, cons
 	ubyte c;
 
 	auto &dest = canvas.cv_bitmap;
+	/* gr_bm_pixel clips each pixel, so only copy whole rows when no
+	 * pixel would be clipped
+	 */
+	if (src.get_type() == bm_mode::linear && !src.get_flag_mask(BM_FLAG_RLE) && dest.get_type() == bm_mode::linear && dx + w <= dest.bm_w && dy + h <= dest.bm_h)
+	{
+		gr_bm_ubitblt00m(w, h, dx, dy, sx, sy, src, dest);
+		return;
+	}
 	range_for (const uint_fast32_t y1, xrange(h))
 		range_for (const uint_fast32_t x1, xrange(w))
 			if ((c=gr_gpixel(src,sx+x1,sy+y1))!=255)
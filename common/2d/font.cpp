@@ -54,7 +54,11 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "partial_range.h"
 #include "d_range.h"
 #include <array>
+#include <functional>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace dcx {
 
@@ -89,18 +93,58 @@ constexpr std::integral_constant<uint8_t, 255> kerndata_terminator{};
 
 #define BITS_TO_BYTES(x)    (((x)+7)>>3)
 
+/* Changed by every font load, since a new font may reuse the address of
+ * a freed one.
+ */
+static unsigned font_generation;
+
+/* What a cached measurement or layout of a string depends on, other than
+ * the text.
+ */
+struct string_cache_key
+{
+	const grs_font *font{};
+	unsigned font_generation{};
+	float scale_x{}, scale_y{};
+	constexpr bool operator==(const string_cache_key &) const = default;
+};
+
+/* Longer strings, such as wrapped briefing text, are not cached */
+constexpr std::size_t string_cache_max_length{128};
+
+static string_cache_key get_string_cache_key(const grs_font &cv_font)
+{
+	return {&cv_font, font_generation, FNTScaleX.operator float(), FNTScaleY.operator float()};
+}
+
+/* Each string has one slot, which it shares with any other string that
+ * hashes there.  Returns nullptr if the string is too long to cache.
+ */
+template <typename T, std::size_t N>
+static T *get_string_cache_slot(std::array<T, N> &cache, const string_cache_key &key, const std::string_view text)
+{
+	if (text.size() > string_cache_max_length)
+		return nullptr;
+	return &cache[(std::hash<std::string_view>{}(text) ^ std::hash<const grs_font *>{}(key.font)) % N];
+}
+
 static int gr_internal_string_clipped(grs_canvas &, const grs_font &cv_font, int x, int y, const char *s);
 static int gr_internal_string_clipped_m(grs_canvas &, const grs_font &cv_font, int x, int y, const char *s);
 
-static const uint8_t *find_kern_entry(const grs_font &font, const uint8_t first, const uint8_t second)
+static std::unique_ptr<int16_t[]> build_kern_table(const uint8_t *p, const unsigned nchars)
 {
-	auto p{font.ft_kerndata};
-
-	while (*p != kerndata_terminator)
-		if (p[0]==first && p[1]==second)
-			return p;
-		else p+=3;
-	return NULL;
+	const std::size_t n{std::size_t{nchars} * nchars};
+	auto table{std::make_unique_for_overwrite<int16_t[]>(n)};
+	std::fill_n(table.get(), n, -1);
+	for (; *p != kerndata_terminator; p += 3)
+	{
+		if (p[0] >= nchars || p[1] >= nchars)
+			continue;
+		/* If a pair is listed more than once, the first entry is used. */
+		if (auto &k{table[p[0] * nchars + p[1]]}; k < 0)
+			k = p[2];
+	}
+	return table;
 }
 
 //takes the character AFTER being offset into font
@@ -159,9 +203,9 @@ static get_char_width_result<T> get_char_width(const grs_font &cv_font, const ui
 			const unsigned letter2 = c2 - cv_font.ft_minchar;
 
 			if (INFONT(letter2)) {
-				const auto p{find_kern_entry(cv_font, letter, letter2)};
-				if (p)
-					return {width, static_cast<T>(fontscale_x(p[2]))};
+				const unsigned nchars{cv_font.ft_maxchar - cv_font.ft_minchar + 1u};
+				if (const auto k{cv_font.ft_kerntable[letter * nchars + letter2]}; k >= 0)
+					return {width, static_cast<T>(fontscale_x(k))};
 			}
 		}
 	}
@@ -623,17 +667,39 @@ static void ogl_init_font(grs_font *const font)
 	ogl_loadbmtexture_f(font->ft_parent_bitmap, CGameCfg.TexFilt, 0, 0);
 }
 
-static void ogl_internal_string(grs_canvas &canvas, const grs_font &cv_font, const int entry_x, int yy, const char *const s)
+/* A character, or the marker rectangle of control code 0x03, of a laid
+ * out string.  Positions are relative to where the string is drawn,
+ * except that the x of a centered string is relative to the canvas.
+ */
+struct ogl_string_glyph
+{
+	int x, y, w, h;
+	/* Index of the character in the font, or ogl_string_glyph_rect */
+	uint16_t letter;
+	color_palette_index color;
+};
+
+constexpr uint16_t ogl_string_glyph_rect{UINT16_MAX};
+
+struct ogl_string_layout
+{
+	string_cache_key key;
+	/* The canvas width for a centered string, else -1 */
+	int centered_width;
+	color_palette_index fg_color, final_fg_color;
+	std::string text;
+	std::vector<ogl_string_glyph> glyphs;
+};
+
+static void ogl_layout_string(grs_canvas &canvas, const grs_font &cv_font, const int entry_x, const char *const s, std::vector<ogl_string_glyph> &glyphs)
 {
 	auto orig_color{canvas.cv_font_fg_color};	//to allow easy reseting to default string color with colored strings -MPM
 
-	if (grd_curscreen->sc_canvas.cv_bitmap.get_type() != bm_mode::ogl)
-		Error("carp.\n");
 	const auto &&fspacy1{FSPACY(1)};
 	const font_character_extent INFONT{cv_font};
 	const auto &&fontscale_x{FONTSCALE_X()};
 	const auto &&FONTSCALE_Y_ft_h{FONTSCALE_Y(cv_font.ft_h)};
-	ogl_colors colors;
+	int yy{};
 	for (auto next_row{s}; next_row;)
 	{
 		auto text_ptr{std::exchange(next_row, nullptr)};
@@ -661,10 +727,14 @@ static void ogl_internal_string(grs_canvas &canvas, const grs_font &cv_font, con
 					text_ptr++;
 				}
 				if (state.draw_full_width_as_fg_color)
-				{
-					const auto color{canvas.cv_font_fg_color};
-					gr_rect(canvas, line_x, yy + cv_font.ft_baseline + 2, line_x + cv_font.ft_w, yy + cv_font.ft_baseline + 3, color);
-				}
+					glyphs.push_back({
+						.x = line_x,
+						.y = yy + cv_font.ft_baseline + 2,
+						.w = cv_font.ft_w,
+						.h = 1,
+						.letter = ogl_string_glyph_rect,
+						.color = canvas.cv_font_fg_color,
+					});
 
 				continue;
 			}
@@ -672,7 +742,14 @@ static void ogl_internal_string(grs_canvas &canvas, const grs_font &cv_font, con
 				? cv_font.ft_widths[letter]
 				: cv_font.ft_w};
 
-			ogl_ubitmapm_cs(canvas, line_x, yy, fontscale_x(ft_w), FONTSCALE_Y_ft_h, cv_font.ft_bitmaps[letter], (cv_font.ft_flags & FT_COLOR) ? colors.white : (canvas.cv_bitmap.get_type() == bm_mode::ogl) ? colors.init(canvas.cv_font_fg_color) : throw std::runtime_error("non-color string to non-ogl dest"));
+			glyphs.push_back({
+				.x = line_x,
+				.y = yy,
+				.w = static_cast<int>(fontscale_x(ft_w)),
+				.h = static_cast<int>(FONTSCALE_Y_ft_h),
+				.letter = static_cast<uint16_t>(letter),
+				.color = canvas.cv_font_fg_color,
+			});
 
 			line_x += spacing;
 			text_ptr++;
@@ -680,6 +757,71 @@ static void ogl_internal_string(grs_canvas &canvas, const grs_font &cv_font, con
 	}
 }
 
+static void ogl_internal_string(grs_canvas &canvas, const grs_font &cv_font, const int entry_x, const int entry_y, const char *const s)
+{
+	if (grd_curscreen->sc_canvas.cv_bitmap.get_type() != bm_mode::ogl)
+		Error("carp.\n");
+	/* Most strings are drawn the same way frame after frame, so keep
+	 * their layouts.
+	 */
+	static std::array<ogl_string_layout, 64> layouts;
+	static ogl_string_layout uncached;
+	const bool centered{entry_x == 0x8000};
+	const int centered_width{centered ? canvas.cv_bitmap.bm_w : -1};
+	const auto fg_color{canvas.cv_font_fg_color};
+	const std::string_view text{s};
+	const auto key{get_string_cache_key(cv_font)};
+	auto layout{get_string_cache_slot(layouts, key, text)};
+	if (!layout)
+		layout = &uncached;
+	if (layout == &uncached || layout->key != key || layout->centered_width != centered_width || layout->fg_color != fg_color || layout->text != text)
+	{
+		if (layout != &uncached)
+		{
+			layout->key = key;
+			layout->centered_width = centered_width;
+			layout->fg_color = fg_color;
+			layout->text = text;
+		}
+		layout->glyphs.clear();
+		ogl_layout_string(canvas, cv_font, centered ? 0x8000 : 0, s, layout->glyphs);
+		layout->final_fg_color = canvas.cv_font_fg_color;
+	}
+	else
+		canvas.cv_font_fg_color = layout->final_fg_color;
+
+	const int dx{centered ? 0 : entry_x};
+	ogl_colors colors;
+	/* Every character of the string is drawn by one call.  The list is
+	 * kept to avoid allocating for every string.
+	 */
+	static std::vector<ogl_glyph_quad> quads;
+	quads.clear();
+	for (auto &g : layout->glyphs)
+	{
+		const int x{g.x + dx};
+		const int y{g.y + entry_y};
+		if (g.letter == ogl_string_glyph_rect)
+		{
+			/* Keep the characters before the rectangle under it */
+			ogl_ubitmapm_glyphs(canvas, quads);
+			quads.clear();
+			gr_rect(canvas, x, y, x + g.w, y + g.h, g.color);
+			continue;
+		}
+		const auto &color_array{(cv_font.ft_flags & FT_COLOR) ? colors.white : (canvas.cv_bitmap.get_type() == bm_mode::ogl) ? colors.init(g.color) : throw std::runtime_error("non-color string to non-ogl dest")};
+		quads.push_back({
+			.x = x,
+			.y = y,
+			.w = g.w,
+			.h = g.h,
+			.bm = &cv_font.ft_bitmaps[g.letter],
+			.color = {{color_array[0], color_array[1], color_array[2], color_array[3]}},
+		});
+	}
+	ogl_ubitmapm_glyphs(canvas, quads);
+}
+
 #define gr_internal_color_string ogl_internal_string
 #endif //OGL
 
@@ -806,7 +948,28 @@ unsigned gr_get_string_height(const grs_font &cv_font, const unsigned lines)
 
 gr_string_size gr_get_string_size(const grs_font &cv_font, const char *s)
 {
-	return gr_get_string_size(cv_font, s, UINT_MAX);
+	struct string_size_entry
+	{
+		string_cache_key key;
+		std::string text;
+		gr_string_size size;
+	};
+	/* Menus and the HUD measure the same strings every frame */
+	static std::array<string_size_entry, 128> cache;
+	if (!s)
+		return gr_get_string_size(cv_font, s, UINT_MAX);
+	const std::string_view text{s};
+	const auto key{get_string_cache_key(cv_font)};
+	const auto e{get_string_cache_slot(cache, key, text)};
+	if (!e)
+		return gr_get_string_size(cv_font, s, UINT_MAX);
+	if (e->key != key || e->text != text)
+	{
+		e->key = key;
+		e->text = text;
+		e->size = gr_get_string_size(cv_font, s, UINT_MAX);
+	}
+	return e->size;
 }
 
 gr_string_size gr_get_string_size(const grs_font &cv_font, const char *s, const unsigned max_chars_per_line)
@@ -907,8 +1070,16 @@ static void grs_font_read(grs_font *gf, NamedPHYSFS_File fp)
 	gf->ft_kerndata = reinterpret_cast<uint8_t *>(d.ft_kerndata);
 }
 
+static std::array<color_palette_index, 256> font_colormap(const palette_array_t &palette)
+{
+	auto colormap{build_colormap_good(palette)};
+	colormap[TRANSPARENCY_COLOR] = TRANSPARENCY_COLOR;              // changed from colormap[255] = 255 to this for macintosh
+	return colormap;
+}
+
 static std::unique_ptr<grs_font> gr_internal_init_font(const std::span<const char> fontname)
 {
+	++font_generation;
 	color_palette_index *ptr;
 	color_palette_index *ft_data;
 	struct {
@@ -1015,12 +1186,13 @@ static std::unique_ptr<grs_font> gr_internal_init_font(const std::span<const cha
 				break;
 		}
 		font->ft_kerndata = begin_kerndata;
+		font->ft_kerntable = build_kern_table(begin_kerndata, nchars);
 	}
 	else
 		font->ft_kerndata = nullptr;
 
 	if (font->ft_flags & FT_COLOR) {		//remap palette
-		palette_array_t palette;
+		auto &palette{font->ft_palette};
 		/* `freq` exists so that decode_data can write to it, but it is
 		 * otherwise unused.  `decode_data` is not guaranteed to write
 		 * to every element, but the bitset constructor will initialize
@@ -1029,16 +1201,14 @@ static std::unique_ptr<grs_font> gr_internal_init_font(const std::span<const cha
 		 */
 		std::bitset<256> freq;
 
-		if (constexpr std::size_t buffer_size{sizeof(palette[0]) * palette.size()}; PHYSFSX_readBytes(fontfile, palette, buffer_size) != buffer_size)		//read the palette
+		if (constexpr std::size_t buffer_size{sizeof(palette)}; PHYSFSX_readBytes(fontfile, palette, buffer_size) != buffer_size)		//read the palette
 		{
 			[[unlikely]];
 			return {};
 		}
 
-		auto colormap{build_colormap_good(palette)};
-
-		colormap[TRANSPARENCY_COLOR] = TRANSPARENCY_COLOR;              // changed from colormap[255] = 255 to this for macintosh
-
+		auto &colormap{font->ft_colormap};
+		colormap = font_colormap(palette);
 		decode_data(std::span{ft_data, ptr}, colormap, freq);
 	}
 	fontfile.reset();
@@ -1087,6 +1257,14 @@ void gr_remap_font(grs_font *font)
 		 * its content.  Ignore the attempt.
 		 */
 		return;
+	if (font_colormap(font->ft_palette) == font->ft_colormap)
+		/* Every color of the font maps to the same index as before, as
+		 * when the mode changes but the palette does not, or the new
+		 * palette keeps the colors the font uses.  The data and the
+		 * texture made from it are already right, so do not read the
+		 * file again or upload a new texture.
+		 */
+		return;
 	auto n{gr_internal_init_font(font->ft_filename)};
 	if (!n)
 		/* If the font fails to load, retain the old font, which may have
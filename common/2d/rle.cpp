@@ -25,6 +25,8 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  */
 
 #include <algorithm>
+#include <list>
+#include <unordered_map>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -34,7 +36,12 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "gr.h"
 #include "dxxerror.h"
 #include "rle.h"
+#include "rle_span.h"
 #include "byteutil.h"
+#include "args.h"
+#if !DXX_USE_OGL
+#include "texmap.h"
+#endif
 
 #include "compiler-range_for.h"
 #include "d_range.h"
@@ -47,18 +54,31 @@ struct rle_cache_element
 {
 	const grs_bitmap *rle_bitmap;
 	grs_bitmap_ptr expanded_bitmap;
-	int last_used;
+	std::size_t bytes;
+};
+
+/* Entries are kept most recently used first.  The index maps the source
+ * bitmap to its entry, so a lookup does not search the list.
+ */
+struct rle_cache_t
+{
+	std::list<rle_cache_element> entries;
+	std::unordered_map<const grs_bitmap *, std::list<rle_cache_element>::iterator> index;
+	std::size_t bytes;
+	rle_cache_stats stats;
 };
 
+/* The callers expand a few bitmaps and then use them together, such as
+ * the two halves of a merged texture, so keep the most recent entries
+ * even when they alone exceed the budget.
+ */
+constexpr std::size_t rle_cache_min_entries{8};
+
 constexpr uint8_t RLE_CODE{0xe0};
 constexpr uint8_t NOT_RLE_CODE{0x1f};
 static_assert((RLE_CODE | NOT_RLE_CODE) == 0xff, "RLE mask error");
 
-static uint8_t rle_cache_initialized;
-static int rle_counter;
-static int rle_next;
-
-static std::array<rle_cache_element, 32> rle_cache;
+static rle_cache_t rle_cache;
 
 static inline int IS_RLE_CODE(const uint8_t &x)
 {
@@ -79,11 +99,10 @@ uint8_t *gr_rle_decode(const color_palette_index *sb, color_palette_index *db, c
 	using std::distance;
 	for (; sb != e.src;)
 	{
-		auto p{sb};
-		color_palette_index c;
-		for (; c = *p, !IS_RLE_CODE(c);)
-			if (++p == e.src)
-				return db;
+		const auto p{gr_rle_find_code(sb, e.src)};
+		if (p == e.src)
+			return db;
+		const color_palette_index c{*p};
 		const size_t count{(size_t{c} & NOT_RLE_CODE)};
 		const size_t cn{std::min<size_t>(distance(sb, p), distance(db, e.dst))};
 		memcpy(db, sb, cn);
@@ -101,6 +120,50 @@ uint8_t *gr_rle_decode(const color_palette_index *sb, color_palette_index *db, c
 	return db;
 }
 
+namespace {
+
+// Uncompress the rest of a scanline, from source pixel i to x2.  A row of
+// literal pixels is copied in one go rather than as runs of length 1.
+template <bool masked>
+void gr_rle_expand_runs(uint8_t *dest, const uint8_t *src, uint_fast32_t i, const uint_fast32_t x2)
+{
+	while (i <= x2)
+	{
+		const auto remaining{x2 - i + 1};
+		if (!IS_RLE_CODE(*src))
+		{
+			/* The literals are scanned one byte at a time, because
+			 * the end of the row may be the end of the bitmap.
+			 */
+			auto e{src};
+			for (const auto limit{src + remaining}; e != limit && !IS_RLE_CODE(*e); ++e)
+			{
+			}
+			const std::size_t n = e - src;
+			if constexpr (masked)
+				gr_copy_masked(dest, src, n);
+			else
+				memcpy(dest, src, n);
+			src = e;
+			dest += n;
+			i += n;
+			continue;
+		}
+		const auto code{*src++};
+		if (code == RLE_CODE)
+			return;
+		const auto color{*src++};
+		// we know have 'count' pixels of 'color'.
+		const auto count{std::min<uint_fast32_t>(code & NOT_RLE_CODE, remaining)};
+		if (!masked || color != TRANSPARENCY_COLOR)
+			rle_stosb(dest, count, color);
+		i += count;
+		dest += count;
+	}
+}
+
+}
+
 #if !DXX_USE_OGL
 // Given pointer to start of one scanline of rle data, uncompress it to
 // dest, from source pixels x1 to x2.
@@ -139,26 +202,7 @@ void gr_rle_expand_scanline_masked(uint8_t *dest, const uint8_t *src, const uint
 	dest += count;
 	i += count;
 
-	while( i <= x2 )
-	{
-		color = *src++;
-		if ( color == RLE_CODE ) return;
-		if ( IS_RLE_CODE(color) )	{
-			count = color & NOT_RLE_CODE;
-			color = *src++;
-		} else {
-			// unique
-			count = 1;
-		}
-		// we know have '*count' pixels of 'color'.
-		if ( i+count <= x2 )	{
-		} else {
-			count = x2-i+1;
-		}
-		if ( color != 255 )rle_stosb( dest, count, color );
-		i += count;
-		dest += count;
-	}
+	gr_rle_expand_runs<true>(dest, src, i, x2);
 }
 #endif
 
@@ -197,25 +241,7 @@ void gr_rle_expand_scanline(uint8_t *dest, const uint8_t *src, const uint_fast32
 	dest += count;
 	i += count;
 
-	while( i <= x2 )		{
-		auto color{*src++};
-		if ( color == RLE_CODE ) return;
-		if ( IS_RLE_CODE(color) )	{
-			count = color & (~RLE_CODE);
-			color = *src++;
-		} else {
-			// unique
-			count = 1;
-		}
-		// we know have '*count' pixels of 'color'.
-		if ( i+count <= x2 )	{
-		} else {
-			count = x2-i+1;
-		}
-		rle_stosb(dest, count, color);
-		i += count;
-		dest += count;
-	}
+	gr_rle_expand_runs<false>(dest, src, i, x2);
 }
 
 namespace {
@@ -380,32 +406,30 @@ void gr_bitmap_rle_compress(grs_bitmap &bmp)
 	bmp.add_flags(BM_FLAG_RLE | large_rle);
 }
 
-namespace {
-
-static void rle_cache_init()
+void rle_cache_close(void)
 {
-	rle_cache = {};
-	rle_cache_initialized = 1;
-}
-
+#if !DXX_USE_OGL
+	tmap_tiles_flush();
+#endif
+	rle_cache.index.clear();
+	rle_cache.entries.clear();
+	rle_cache.bytes = 0;
 }
 
-void rle_cache_close(void)
+void rle_cache_flush()
 {
-	if (rle_cache_initialized)	{
-		rle_cache_initialized = 0;
-		range_for (auto &i, rle_cache)
-			i.expanded_bitmap.reset();
-	}
+	/* The source bitmaps are about to be paged out, and a bitmap paged
+	 * back in at the same address may hold different data.
+	 */
+	rle_cache_close();
 }
 
-void rle_cache_flush()
+const rle_cache_stats &rle_cache_get_stats()
 {
-	range_for (auto &i, rle_cache)
-	{
-		i.rle_bitmap = NULL;
-		i.last_used = 0;
-	}
+	auto &stats = rle_cache.stats;
+	stats.entries = rle_cache.entries.size();
+	stats.bytes = rle_cache.bytes;
+	return stats;
 }
 
 namespace {
@@ -428,46 +452,40 @@ static void rle_expand_texture_sub(const grs_bitmap &bmp, grs_bitmap &rle_temp_b
 
 grs_bitmap *_rle_expand_texture(const grs_bitmap &bmp)
 {
-	int lowest_count, lc;
-
-	if (!rle_cache_initialized) rle_cache_init();
-
 	Assert(!(bmp.get_flag_mask(BM_FLAG_PAGED_OUT)));
 
-	lc = rle_counter;
-	rle_counter++;
-
-	if (rle_counter < 0)
-		rle_counter = 0;
-	
-	if ( rle_counter < lc )	{
-		rle_cache_flush();
+	auto &entries = rle_cache.entries;
+	auto &stats = rle_cache.stats;
+	if (const auto i{rle_cache.index.find(&bmp)}; i != rle_cache.index.end())
+	{
+		++stats.hits;
+		entries.splice(entries.begin(), entries, i->second);
+		return i->second->expanded_bitmap.get();
 	}
+	++stats.misses;
 
-	lowest_count = rle_cache[rle_next].last_used;
-	auto least_recently_used{&rle_cache[rle_next]};
-	rle_next++;
-	if (rle_next >= rle_cache.size())
-		rle_next = 0;
-
-	range_for (auto &i, rle_cache)
+	const std::size_t bytes{std::size_t{bmp.bm_w} * bmp.bm_h};
+	const std::size_t budget{std::size_t{CGameArg.SysRleCacheBudget} * 1024};
+	if (entries.size() >= rle_cache_min_entries && rle_cache.bytes + bytes > budget)
 	{
-		if (i.rle_bitmap == &bmp)
-		{
-			i.last_used = rle_counter;
-			return i.expanded_bitmap.get();
-		}
-		if (i.last_used < lowest_count)
-		{
-			lowest_count = (least_recently_used = &i)->last_used;
-		}
+#if !DXX_USE_OGL
+		//binned spans may still read the bitmaps being evicted
+		tmap_tiles_flush();
+#endif
+		do {
+			auto &e = entries.back();
+			rle_cache.bytes -= e.bytes;
+			rle_cache.index.erase(e.rle_bitmap);
+			entries.pop_back();
+			++stats.evictions;
+		} while (entries.size() >= rle_cache_min_entries && rle_cache.bytes + bytes > budget);
 	}
 
-	least_recently_used->expanded_bitmap = gr_create_bitmap(bmp.bm_w, bmp.bm_h);
-	rle_expand_texture_sub(bmp, *least_recently_used->expanded_bitmap.get());
-	least_recently_used->rle_bitmap = &bmp;
-	least_recently_used->last_used = rle_counter;
-	return least_recently_used->expanded_bitmap.get();
+	auto &e = entries.emplace_front(rle_cache_element{&bmp, gr_create_bitmap(bmp.bm_w, bmp.bm_h), bytes});
+	rle_expand_texture_sub(bmp, *e.expanded_bitmap.get());
+	rle_cache.index.emplace(&bmp, entries.begin());
+	rle_cache.bytes += bytes;
+	return e.expanded_bitmap.get();
 }
 
 #if !DXX_USE_OGL
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * The vector versions use the compiler's generic vector types, which it
+ * lowers to SSE2 on x86 and to NEON on ARM.  Loads and stores go through
+ * memcpy, since neither the bitmaps nor the canvas rows are aligned.
+ */
+
+#include <cstring>
+#include "rle_span.h"
+
+namespace dcx {
+
+namespace {
+
+constexpr std::size_t rle_lanes_per_step = 16;
+using rle_lanes = uint8_t __attribute__((vector_size(rle_lanes_per_step)));
+
+constexpr uint8_t rle_transparent_pixel = 255;
+/* Same as RLE_CODE in rle.cpp */
+constexpr uint8_t rle_code = 0xe0;
+
+}
+
+void gr_copy_masked(uint8_t *dest, const uint8_t *src, std::size_t n)
+{
+	for (; n >= rle_lanes_per_step; n -= rle_lanes_per_step, dest += rle_lanes_per_step, src += rle_lanes_per_step)
+	{
+		rle_lanes s, d;
+		std::memcpy(&s, src, sizeof(s));
+		std::memcpy(&d, dest, sizeof(d));
+		d = s == rle_transparent_pixel ? d : s;
+		std::memcpy(dest, &d, sizeof(d));
+	}
+	gr_copy_masked_reference(dest, src, n);
+}
+
+void gr_copy_masked_reference(uint8_t *dest, const uint8_t *src, std::size_t n)
+{
+	for (; n; --n, ++dest, ++src)
+		if (const auto c = *src; c != rle_transparent_pixel)
+			*dest = c;
+}
+
+const uint8_t *gr_rle_find_code(const uint8_t *p, const uint8_t *const e)
+{
+	for (; e - p >= static_cast<std::ptrdiff_t>(rle_lanes_per_step); p += rle_lanes_per_step)
+	{
+		rle_lanes b;
+		std::memcpy(&b, p, sizeof(b));
+		const auto is_code = (b & rle_code) == rle_code;
+		uint64_t words[2];
+		std::memcpy(words, &is_code, sizeof(words));
+		/* The scalar scan finds which lane it was */
+		if (words[0] | words[1])
+			break;
+	}
+	return gr_rle_find_code_reference(p, e);
+}
+
+const uint8_t *gr_rle_find_code_reference(const uint8_t *p, const uint8_t *const e)
+{
+	for (; p != e; ++p)
+		if ((*p & rle_code) == rle_code)
+			break;
+	return p;
+}
+
+}
@@ -114,6 +114,25 @@ namespace {
 
 static void must_clip_tmap_face(grs_canvas &, std::size_t nv, g3s_codes cc, grs_bitmap &bm, polygon_clip_points &Vbuf0, polygon_clip_points &Vbuf1, tmap_drawer_type tmap_drawer_ptr);
 
+/* Most faces are entirely on screen, so the clip buffers are only filled
+ * for the faces that need them.
+ */
+static g3s_codes build_face_codes(const std::span<g3_draw_tmap_point *const> pointlist)
+{
+	g3s_codes cc;
+	for (const auto p : pointlist)
+	{
+		cc.uand &= p->p3_codes;
+		cc.uor  |= p->p3_codes;
+	}
+	return cc;
+}
+
+static void prepare_clip_points(const std::span<g3_draw_tmap_point *const> pointlist, polygon_clip_points &Vbuf0)
+{
+	std::ranges::copy(pointlist, Vbuf0.begin());
+}
+
 //deal with face that must be clipped
 static void must_clip_flat_face(grs_canvas &canvas, std::size_t nv, g3s_codes cc, polygon_clip_points &Vbuf0, polygon_clip_points &Vbuf1, const uint8_t color)
 {
@@ -149,37 +168,32 @@ free_points:
 //returns 1 if off screen, 0 if drew
 void _g3_draw_poly(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const uint8_t color)
 {
-	g3s_codes cc;
-
-	polygon_clip_points Vbuf0, Vbuf1;
-	auto &bufptr{Vbuf0};
-
-	for (const auto &&[pl, bp] : zip(pointlist, bufptr))
-	{
-		bp = pl;
-		cc.uand &= bp->p3_codes;
-		cc.uor  |= bp->p3_codes;
-	}
+	const auto cc{build_face_codes(pointlist)};
 
 	if (cc.uand != clipping_code::None)
 		return;	//all points off screen
 
+	const auto must_clip = [&]() {
+		polygon_clip_points Vbuf0, Vbuf1;
+		prepare_clip_points(pointlist, Vbuf0);
+		must_clip_flat_face(canvas, pointlist.size(), cc, Vbuf0, Vbuf1, color);
+	};
 	if (cc.uor != clipping_code::None)
 	{
-		must_clip_flat_face(canvas, pointlist.size(), cc, Vbuf0, Vbuf1, color);
+		must_clip();
 		return;
 	}
 
 	//now make list of 2d coords (& check for overflow)
 	std::array<fix, MAX_POINTS_IN_POLY*2> Vertex_list;
-	for (const auto &&[i, pl, p] : enumerate(zip(pointlist, bufptr)))
+	for (const auto &&[i, p] : enumerate(pointlist))
 	{
 		if (!(p->p3_flags&projection_flag::projected))
 			g3_project_point(*p);
 
 		if (p->p3_flags&projection_flag::overflow)
 		{
-			must_clip_flat_face(canvas, pointlist.size(), cc, Vbuf0, Vbuf1, color);
+			must_clip();
 			return;
 		}
 
@@ -193,18 +207,13 @@ void _g3_draw_poly(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 //draw a texture-mapped face.
 void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const g3s_uvl *const uvl_list, const g3s_lrgb *const light_rgb, grs_bitmap &bm, const tmap_drawer_type tmap_drawer_ptr)
 {
-	g3s_codes cc;
+	const auto cc{build_face_codes(pointlist)};
 
-	polygon_clip_points Vbuf0, Vbuf1;
-	auto &bufptr = Vbuf0;
+	if (cc.uand != clipping_code::None)
+		return;	//all points off screen
 
-	for (auto &&[i, pl, bp] : enumerate(zip(pointlist, bufptr)))
+	for (auto &&[i, p] : enumerate(pointlist))
 	{
-		const auto p = bp = pl;
-
-		cc.uand &= p->p3_codes;
-		cc.uor  |= p->p3_codes;
-
 		if constexpr (!DXX_USE_OGL)
 		{
 		p->p3_u = uvl_list[i].u;
@@ -216,18 +225,17 @@ void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 
 	}
 
-	if (cc.uand != clipping_code::None)
-		return;	//all points off screen
-
 	if (cc.uor != clipping_code::None)
 	{
+		polygon_clip_points Vbuf0, Vbuf1;
+		prepare_clip_points(pointlist, Vbuf0);
 		must_clip_tmap_face(canvas, pointlist.size(), cc, bm, Vbuf0, Vbuf1, tmap_drawer_ptr);
 		return;
 	}
 
 	//now make list of 2d coords (& check for overflow)
 
-	for (auto &&p : std::span(bufptr).first(pointlist.size()))
+	for (auto &&p : pointlist)
 	{
 		if (!(p->p3_flags&projection_flag::projected))
 			g3_project_point(*p);
@@ -237,7 +245,7 @@ void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 			return;
 		}
 	}
-	(*tmap_drawer_ptr)(canvas, bm, std::span(bufptr).first(pointlist.size()));
+	(*tmap_drawer_ptr)(canvas, bm, pointlist);
 }
 
 namespace {
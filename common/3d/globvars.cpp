@@ -20,6 +20,9 @@ vms_vector	View_position;
 
 vms_matrix	Unscaled_matrix;	//before scaling
 vms_matrix	View_matrix;
+#if DXX_USE_OGL
+std::array<float, 16>	Gl_view_matrix;	//View_matrix and View_position for OpenGL
+#endif
 
 vms_vector	Window_scale;		//scaling for window aspect
 vms_vector	Matrix_scale;		//how the matrix is scaled, window_scale * zoom
@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include "dxxsconf.h"
 #include "maths.h"
+#include <array>
 #include "fwd-vecmat.h"
 
 namespace dcx {
@@ -28,6 +30,13 @@ extern vms_vector Window_scale;
 extern vms_vector View_position,Matrix_scale;
 extern vms_matrix View_matrix,Unscaled_matrix;
 
+#if DXX_USE_OGL
+//the view set by g3_set_view_matrix as a column-major matrix taking world
+//coordinates to rotated point space, with z negated for OpenGL.  Instances
+//do not change it.
+extern std::array<float, 16> Gl_view_matrix;
+#endif
+
 }
 
 //vertex buffers for polygon drawing and clipping
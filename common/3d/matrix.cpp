@@ -11,6 +11,7 @@
  */
  
 
+#include <cstdlib>
 #include "3d.h"
 #include "globvars.h"
 
@@ -18,6 +19,10 @@ namespace dcx {
 namespace {
 
 static void scale_matrix(fix);
+#if DXX_USE_OGL
+static void build_gl_matrix(std::array<float, 16> &);
+static void set_gl_view_matrix();
+#endif
 
 }
 
@@ -29,6 +34,36 @@ void g3_set_view_matrix(const vms_vector &view_pos,const vms_matrix &view_matrix
 	scale_matrix(zoom);
 }
 
+void g3_set_view_position(const vms_vector &view_pos)
+{
+	View_position = view_pos;
+#if DXX_USE_OGL
+	set_gl_view_matrix();
+#endif
+}
+
+#if DXX_USE_STEREOSCOPIC_RENDER
+vms_vector g3_stereo_visibility_position(const fix eye_offset)
+{
+	auto p = View_position;
+	vm_vec_scale_add2(p, Unscaled_matrix.rvec, -eye_offset);
+	vm_vec_scale_add2(p, Unscaled_matrix.fvec, -2 * std::abs(eye_offset));
+	return p;
+}
+#endif
+
+#if DXX_USE_OGL
+void g3_get_gl_instance_matrix(std::array<float, 16> &m)
+{
+	build_gl_matrix(m);
+}
+#endif
+
+g3_view_state g3_get_view_state()
+{
+	return {View_position, View_matrix.rvec, View_matrix.uvec, View_matrix.fvec, Canv_w2, Canv_h2};
+}
+
 namespace {
 
 //performs aspect scaling on global view matrix
@@ -56,7 +91,34 @@ static void scale_matrix(const fix View_zoom)
 	vm_vec_scale(View_matrix.uvec,Matrix_scale.y);
 	vm_vec_scale(View_matrix.fvec,Matrix_scale.z);
 
+#if DXX_USE_OGL
+	set_gl_view_matrix();
+#endif
+}
+
+#if DXX_USE_OGL
+static void build_gl_matrix(std::array<float, 16> &m)
+{
+	//world to view: rotate(p - View_position), with z negated
+	const auto f = [](const fix x) { return static_cast<double>(x) / F1_0; };
+	const auto set_row = [&f, &m](const unsigned r, const vms_vector &v, const double sign) {
+		m[r] = sign * f(v.x);
+		m[4 + r] = sign * f(v.y);
+		m[8 + r] = sign * f(v.z);
+		m[12 + r] = -sign * (f(v.x) * f(View_position.x) + f(v.y) * f(View_position.y) + f(v.z) * f(View_position.z));
+	};
+	set_row(0, View_matrix.rvec, 1);
+	set_row(1, View_matrix.uvec, 1);
+	set_row(2, View_matrix.fvec, -1);
+	m[3] = m[7] = m[11] = 0;
+	m[15] = 1;
+}
+
+static void set_gl_view_matrix()
+{
+	build_gl_matrix(Gl_view_matrix);
 }
+#endif
 
 }
 
@@ -11,6 +11,10 @@
  */
 
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
 #include "3d.h"
 #include "globvars.h"
 
@@ -50,6 +54,88 @@ clipping_code g3_rotate_point(g3s_point &dest,const vms_vector &src)
 	return g3_code_point(dest);
 }
 
+namespace {
+
+/* The batch kernel gathers the points into one vector per coordinate, so the
+ * subtraction, the three dot products and the clipping tests are done for
+ * all lanes at once.  The compiler lowers the generic vector types to SSE2
+ * on x86 and to NEON on ARM.
+ *
+ * Neither has a 64-bit integer multiply, so the dot products are taken in
+ * double precision.  A view matrix element of at most g3_rotate_max_element
+ * keeps each product below 2**49 and the sum below 2**51, so both are
+ * exact.  Adding g3_rotate_magic then leaves the sum's two's complement in
+ * the low bits of the mantissa, from which the shift by 16 and the
+ * truncation to fix that vm_vec_dot3 does are plain bit operations, and the
+ * result is bit-identical to g3_rotate_point.
+ */
+constexpr std::size_t g3_rotate_lanes = 4;
+constexpr fix g3_rotate_max_element = F1_0 * 4;
+constexpr double g3_rotate_magic = 6755399441055744.0;	/* 2**52 + 2**51 */
+using g3_lanes = int32_t __attribute__((vector_size(g3_rotate_lanes * sizeof(int32_t))));
+using g3_ulanes = uint32_t __attribute__((vector_size(g3_rotate_lanes * sizeof(uint32_t))));
+using g3_wide_ulanes = uint64_t __attribute__((vector_size(g3_rotate_lanes * sizeof(uint64_t))));
+using g3_dlanes = double __attribute__((vector_size(g3_rotate_lanes * sizeof(double))));
+
+bool g3_rotate_matrix_is_exact(const vms_matrix &m)
+{
+	for (const auto &v : {m.rvec, m.uvec, m.fvec})
+		for (const fix e : {v.x, v.y, v.z})
+			if (e < -g3_rotate_max_element || e > g3_rotate_max_element)
+				return false;
+	return true;
+}
+
+}
+
+void g3_rotate_points(const std::span<const vms_vector> src, const std::span<g3s_point> dest)
+{
+	const auto &m = View_matrix;
+	const auto &vp = View_position;
+	const std::size_t n = src.size();
+	std::size_t i = 0;
+	if (g3_rotate_matrix_is_exact(m))
+		for (; i + g3_rotate_lanes <= n; i += g3_rotate_lanes)
+		{
+			/* Spelled out per lane, so that the gather and the scatter
+			 * below are unrolled at -O2 too
+			 */
+			const auto gather = [&vp, p = &src[i]]<std::size_t... k>(const fix vms_vector::*const c, std::index_sequence<k...>) {
+				return std::array<uint32_t, g3_rotate_lanes>{{(static_cast<uint32_t>(p[k].*c) - static_cast<uint32_t>(vp.*c))...}};
+			};
+			constexpr auto lanes = std::make_index_sequence<g3_rotate_lanes>();
+			const auto ax = gather(&vms_vector::x, lanes), ay = gather(&vms_vector::y, lanes), az = gather(&vms_vector::z, lanes);
+			g3_lanes dx, dy, dz;
+			std::memcpy(&dx, ax.data(), sizeof(dx));
+			std::memcpy(&dy, ay.data(), sizeof(dy));
+			std::memcpy(&dz, az.data(), sizeof(dz));
+			const auto fx = __builtin_convertvector(dx, g3_dlanes);
+			const auto fy = __builtin_convertvector(dy, g3_dlanes);
+			const auto fz = __builtin_convertvector(dz, g3_dlanes);
+			/* (p >> 16) truncated to 32 bits is bits 16 to 47 of p */
+			const g3_lanes x = __builtin_bit_cast(g3_lanes, __builtin_convertvector(__builtin_bit_cast(g3_wide_ulanes, fx * m.rvec.x + fy * m.rvec.y + fz * m.rvec.z + g3_rotate_magic) >> 16, g3_ulanes));
+			const g3_lanes y = __builtin_bit_cast(g3_lanes, __builtin_convertvector(__builtin_bit_cast(g3_wide_ulanes, fx * m.uvec.x + fy * m.uvec.y + fz * m.uvec.z + g3_rotate_magic) >> 16, g3_ulanes));
+			const g3_lanes z = __builtin_bit_cast(g3_lanes, __builtin_convertvector(__builtin_bit_cast(g3_wide_ulanes, fx * m.fvec.x + fy * m.fvec.y + fz * m.fvec.z + g3_rotate_magic) >> 16, g3_ulanes));
+			/* As build_g3_clipping_code_from_viewer_relative_position */
+			const auto nz = __builtin_bit_cast(g3_lanes, -__builtin_bit_cast(g3_ulanes, z));
+			const g3_lanes codes =
+				((x > z) & static_cast<int32_t>(clipping_code::off_right)) |
+				((y > z) & static_cast<int32_t>(clipping_code::off_top)) |
+				((x < nz) & static_cast<int32_t>(clipping_code::off_left)) |
+				((y < nz) & static_cast<int32_t>(clipping_code::off_bot)) |
+				((z < 0) & static_cast<int32_t>(clipping_code::behind));
+			[&x, &y, &z, &codes, d = &dest[i]]<std::size_t... k>(std::index_sequence<k...>) {
+				((
+					d[k].p3_vec = {x[k], y[k], z[k]},
+					d[k].p3_flags = {},
+					d[k].p3_codes = static_cast<clipping_code>(codes[k])
+				), ...);
+			}(lanes);
+		}
+	for (; i < n; ++i)
+		g3_rotate_point(dest[i], src[i]);
+}
+
 /* Multiply `a` and `b` into a 64-bit result.  Check whether ((a * b) / c) will
  * overflow when stored into a 32-bit signed integer.  If the quotient does not
  * overflow a 32-bit value, then return a std::optional that contains the
@@ -182,6 +268,37 @@ void g3_project_point(g3s_point &p)
 #endif
 }
 
+g3_sphere_projection g3_project_sphere_bounds(const vms_vector &pos, const fix rad, g3_screen_bounds &bounds)
+{
+	g3s_point p;
+	g3_rotate_point(p, pos);
+	//the view matrix is scaled, so in view space the sphere is an
+	//ellipsoid with these half axes
+	const double rx{f2fl(fixmul(rad, Matrix_scale.x))}, ry{f2fl(fixmul(rad, Matrix_scale.y))}, rz{f2fl(fixmul(rad, Matrix_scale.z))};
+	const double z{f2fl(p.p3_vec.z)};
+	if (z + rz <= 0)
+		return g3_sphere_projection::behind;
+	const double z_near{z - rz};
+	if (z_near < 1. / 16)
+		return g3_sphere_projection::near;
+	const double z_far{z + rz};
+	//every point of the box around the ellipsoid projects between its
+	//corners, so the extremes are at the nearest or the farthest depth
+	const auto lo = [z_near, z_far](const double v) {
+		return std::clamp(std::min(v / z_near, v / z_far), -1e4, 1e4);
+	};
+	const auto hi = [z_near, z_far](const double v) {
+		return std::clamp(std::max(v / z_near, v / z_far), -1e4, 1e4);
+	};
+	const double x{f2fl(p.p3_vec.x)}, y{f2fl(p.p3_vec.y)};
+	const double w2{f2fl(Canv_w2)}, h2{f2fl(Canv_h2)};
+	bounds.left = static_cast<int>(std::floor(w2 + w2 * lo(x - rx)));
+	bounds.right = static_cast<int>(std::ceil(w2 + w2 * hi(x + rx)));
+	bounds.top = static_cast<int>(std::floor(h2 - h2 * hi(y + ry)));
+	bounds.bot = static_cast<int>(std::ceil(h2 - h2 * lo(y - ry)));
+	return g3_sphere_projection::bounded;
+}
+
 #if DXX_USE_EDITOR
 //from a 2d point, compute the vector through that point
 vms_vector g3_point_2_vec(short sx,short sy)
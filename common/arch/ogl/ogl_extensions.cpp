@@ -20,7 +20,21 @@ bool ogl_have_ARB_sync = false;
 PFNGLFENCESYNCPROC glFenceSyncFunc = nullptr;
 PFNGLDELETESYNCPROC glDeleteSyncFunc = nullptr;
 PFNGLCLIENTWAITSYNCPROC glClientWaitSyncFunc = nullptr;
+bool ogl_have_ARB_buffer_storage = false;
+PFNGLGENBUFFERSPROC glGenBuffersFunc = nullptr;
+PFNGLDELETEBUFFERSPROC glDeleteBuffersFunc = nullptr;
+PFNGLBINDBUFFERPROC glBindBufferFunc = nullptr;
+PFNGLBUFFERSTORAGEPROC glBufferStorageFunc = nullptr;
+PFNGLMAPBUFFERRANGEPROC glMapBufferRangeFunc = nullptr;
+bool ogl_have_pixel_buffer_object = false;
+PFNGLBUFFERDATAPROC glBufferDataFunc = nullptr;
+PFNGLUNMAPBUFFERPROC glUnmapBufferFunc = nullptr;
 GLfloat ogl_maxanisotropy = 0.0f;
+bool ogl_have_texture_env_combine = false;
+PFNGLACTIVETEXTUREPROC glActiveTextureFunc = nullptr;
+PFNGLCLIENTACTIVETEXTUREPROC glClientActiveTextureFunc = nullptr;
+GLenum ogl_compressed_rgb_format = 0;
+PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage2DFunc = nullptr;
 void ogl_extensions_init() {}
 }
 #else
@@ -42,9 +56,31 @@ PFNGLFENCESYNCPROC glFenceSyncFunc = NULL;
 PFNGLDELETESYNCPROC glDeleteSyncFunc = NULL;
 PFNGLCLIENTWAITSYNCPROC glClientWaitSyncFunc = NULL;
 
+/* GL_ARB_buffer_storage */
+bool ogl_have_ARB_buffer_storage = false;
+PFNGLGENBUFFERSPROC glGenBuffersFunc = NULL;
+PFNGLDELETEBUFFERSPROC glDeleteBuffersFunc = NULL;
+PFNGLBINDBUFFERPROC glBindBufferFunc = NULL;
+PFNGLBUFFERSTORAGEPROC glBufferStorageFunc = NULL;
+PFNGLMAPBUFFERRANGEPROC glMapBufferRangeFunc = NULL;
+
+/* GL_ARB_pixel_buffer_object */
+bool ogl_have_pixel_buffer_object = false;
+PFNGLBUFFERDATAPROC glBufferDataFunc = NULL;
+PFNGLUNMAPBUFFERPROC glUnmapBufferFunc = NULL;
+
 /* GL_EXT_texture_filter_anisotropic */
 GLfloat ogl_maxanisotropy = 0.0f;
 
+/* GL_ARB_multitexture, GL_ARB_texture_env_combine */
+bool ogl_have_texture_env_combine = false;
+PFNGLACTIVETEXTUREPROC glActiveTextureFunc = NULL;
+PFNGLCLIENTACTIVETEXTUREPROC glClientActiveTextureFunc = NULL;
+
+/* GL_EXT_texture_compression_s3tc, GL_OES_compressed_ETC1_RGB8_texture */
+GLenum ogl_compressed_rgb_format = 0;
+PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage2DFunc = NULL;
+
 namespace {
 
 static std::array<long, 2> parse_version_str(const char *v)
@@ -153,6 +189,71 @@ void ogl_extensions_init()
 		? (ogl_have_ARB_sync = true, std::span<const char>{"DXX-Rebirth: OpenGL: GL_ARB_sync available"})
 		: std::span<const char>{"DXX-Rebirth: OpenGL: GL_ARB_sync not available"};
 	con_puts(CON_VERBOSE, s);
+
+	/* GL_ARB_buffer_storage */
+	if (is_supported(extension_str, version, "GL_ARB_buffer_storage", 4, 4, -1, -1)) {
+		glGenBuffersFunc = reinterpret_cast<PFNGLGENBUFFERSPROC>(SDL_GL_GetProcAddress("glGenBuffers"));
+		glDeleteBuffersFunc = reinterpret_cast<PFNGLDELETEBUFFERSPROC>(SDL_GL_GetProcAddress("glDeleteBuffers"));
+		glBindBufferFunc = reinterpret_cast<PFNGLBINDBUFFERPROC>(SDL_GL_GetProcAddress("glBindBuffer"));
+		glBufferStorageFunc = reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(SDL_GL_GetProcAddress("glBufferStorage"));
+		glMapBufferRangeFunc = reinterpret_cast<PFNGLMAPBUFFERRANGEPROC>(SDL_GL_GetProcAddress("glMapBufferRange"));
+	}
+	const auto bs = (glGenBuffersFunc && glDeleteBuffersFunc && glBindBufferFunc && glBufferStorageFunc && glMapBufferRangeFunc)
+		? (ogl_have_ARB_buffer_storage = true, std::span<const char>{"DXX-Rebirth: OpenGL: GL_ARB_buffer_storage available"})
+		: std::span<const char>{"DXX-Rebirth: OpenGL: GL_ARB_buffer_storage not available"};
+	con_puts(CON_VERBOSE, bs);
+
+	/* GL_ARB_pixel_buffer_object, mapped with glMapBufferRange */
+	if (is_supported(extension_str, version, "GL_ARB_pixel_buffer_object", 3, 0, 3, 0)) {
+		if (!glGenBuffersFunc)
+		{
+			glGenBuffersFunc = reinterpret_cast<PFNGLGENBUFFERSPROC>(SDL_GL_GetProcAddress("glGenBuffers"));
+			glDeleteBuffersFunc = reinterpret_cast<PFNGLDELETEBUFFERSPROC>(SDL_GL_GetProcAddress("glDeleteBuffers"));
+			glBindBufferFunc = reinterpret_cast<PFNGLBINDBUFFERPROC>(SDL_GL_GetProcAddress("glBindBuffer"));
+			glMapBufferRangeFunc = reinterpret_cast<PFNGLMAPBUFFERRANGEPROC>(SDL_GL_GetProcAddress("glMapBufferRange"));
+		}
+		glBufferDataFunc = reinterpret_cast<PFNGLBUFFERDATAPROC>(SDL_GL_GetProcAddress("glBufferData"));
+		glUnmapBufferFunc = reinterpret_cast<PFNGLUNMAPBUFFERPROC>(SDL_GL_GetProcAddress("glUnmapBuffer"));
+	}
+	const auto pbo = (glGenBuffersFunc && glDeleteBuffersFunc && glBindBufferFunc && glMapBufferRangeFunc && glBufferDataFunc && glUnmapBufferFunc)
+		? (ogl_have_pixel_buffer_object = true, std::span<const char>{"DXX-Rebirth: OpenGL: GL_ARB_pixel_buffer_object available"})
+		: std::span<const char>{"DXX-Rebirth: OpenGL: GL_ARB_pixel_buffer_object not available"};
+	con_puts(CON_VERBOSE, pbo);
+
+	/* GL_ARB_multitexture, GL_ARB_texture_env_combine */
+	if (is_supported(extension_str, version, "GL_ARB_multitexture", 1, 3, 1, 1) &&
+		is_supported(extension_str, version, "GL_ARB_texture_env_combine", 1, 3, 1, 1))
+	{
+		GLint units = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_UNITS, &units);
+		if (units >= 3)
+		{
+			glActiveTextureFunc = reinterpret_cast<PFNGLACTIVETEXTUREPROC>(SDL_GL_GetProcAddress("glActiveTexture"));
+			glClientActiveTextureFunc = reinterpret_cast<PFNGLCLIENTACTIVETEXTUREPROC>(SDL_GL_GetProcAddress("glClientActiveTexture"));
+		}
+	}
+	const auto tc = (glActiveTextureFunc && glClientActiveTextureFunc)
+		? (ogl_have_texture_env_combine = true, std::span<const char>{"DXX-Rebirth: OpenGL: GL_ARB_texture_env_combine available on three texture units"})
+		: std::span<const char>{"DXX-Rebirth: OpenGL: GL_ARB_texture_env_combine not available on three texture units"};
+	con_puts(CON_VERBOSE, tc);
+
+	/* compressed opaque textures */
+#if DXX_USE_OGLES
+	const auto &compression_ext = "GL_OES_compressed_ETC1_RGB8_texture";
+	constexpr GLenum compression_format = GL_ETC1_RGB8_OES;
+#else
+	const auto &compression_ext = "GL_EXT_texture_compression_s3tc";
+	constexpr GLenum compression_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+#endif
+	if (is_supported(extension_str, version, compression_ext, -1, -1, -1, -1))
+		glCompressedTexImage2DFunc = reinterpret_cast<PFNGLCOMPRESSEDTEXIMAGE2DPROC>(SDL_GL_GetProcAddress("glCompressedTexImage2D"));
+	if (glCompressedTexImage2DFunc)
+	{
+		ogl_compressed_rgb_format = compression_format;
+		con_printf(CON_VERBOSE, "DXX-Rebirth: OpenGL: %s available", compression_ext);
+	}
+	else
+		con_printf(CON_VERBOSE, "DXX-Rebirth: OpenGL: %s not available", compression_ext);
 }
 
 }
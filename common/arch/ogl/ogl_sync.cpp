@@ -33,11 +33,29 @@ ogl_sync::~ogl_sync()
 		con_puts(CON_URGENT, "DXX-Rebirth: OpenGL: fence sync object was never destroyed!");
 }
 
-void ogl_sync::sync_deleter::operator()(GLsync fence_func) const
+void ogl_fence_deleter::operator()(GLsync fence_func) const
 {
 	glDeleteSyncFunc(fence_func);
 }
 
+ogl_fence ogl_insert_fence()
+{
+	return ogl_fence(glFenceSyncFunc(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+void ogl_wait_fence(const ogl_fence &fence)
+{
+	if (fence)
+		while (glClientWaitSyncFunc(fence.get(), GL_SYNC_FLUSH_COMMANDS_BIT, 34000000ULL) == GL_TIMEOUT_EXPIRED)
+		{
+		}
+}
+
+bool ogl_fence_signalled(const ogl_fence &fence)
+{
+	return !fence || glClientWaitSyncFunc(fence.get(), GL_SYNC_FLUSH_COMMANDS_BIT, 0) != GL_TIMEOUT_EXPIRED;
+}
+
 void ogl_sync::before_swap()
 {
 	if (const auto local_fence = std::move(fence))
@@ -64,7 +82,7 @@ void ogl_sync::before_swap()
 void ogl_sync::after_swap()
 {
 	if (method == SYNC_GL_FENCE || method == SYNC_GL_FENCE_SLEEP ) {
-		fence.reset(glFenceSyncFunc(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		fence = ogl_insert_fence();
 	} else if (method == SYNC_GL_FINISH_AFTER_SWAP) {
 		glFinish();
 	}
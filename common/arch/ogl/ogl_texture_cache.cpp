@@ -0,0 +1,415 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Block compression of opaque textures and the cache file that keeps the
+ * results between runs.
+ */
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include "console.h"
+#include "ogl_texture_cache.h"
+
+namespace dcx {
+
+namespace {
+
+constexpr char ogl_texture_cache_filename[] = "texcache.bin";
+constexpr std::array<uint8_t, 4> ogl_texture_cache_magic{{'D', 'X', 'T', 'C'}};
+constexpr PHYSFS_uint32 ogl_texture_cache_version = 1;
+constexpr PHYSFS_uint64 ogl_texture_cache_header_size = std::size(ogl_texture_cache_magic) + sizeof(PHYSFS_uint32);
+/* key, format, level count, w, h, then the size of each level before it */
+constexpr PHYSFS_uint64 ogl_texture_cache_record_header_size = 8 + 1 + 1 + 2 + 2;
+
+using block_texels = std::array<std::array<int, 3>, 16>;
+
+/* The 4x4 block at (bx, by), in row major order */
+block_texels ogl_read_block(const uint8_t *const rgb, const unsigned w, const unsigned h, const unsigned bx, const unsigned by)
+{
+	block_texels t;
+	for (unsigned y = 0; y < 4; ++y)
+		for (unsigned x = 0; x < 4; ++x)
+		{
+			const auto *const p = &rgb[(std::size_t{std::min(by + y, h - 1)} * w + std::min(bx + x, w - 1)) * 3];
+			t[y * 4 + x] = {{p[0], p[1], p[2]}};
+		}
+	return t;
+}
+
+int ogl_color_distance(const std::array<int, 3> &a, const std::array<int, 3> &b)
+{
+	const int dr = a[0] - b[0], dg = a[1] - b[1], db = a[2] - b[2];
+	return dr * dr + dg * dg + db * db;
+}
+
+uint16_t ogl_bc1_pack565(const std::array<int, 3> &c)
+{
+	return static_cast<uint16_t>((((c[0] * 31 + 127) / 255) << 11) | (((c[1] * 63 + 127) / 255) << 5) | ((c[2] * 31 + 127) / 255));
+}
+
+std::array<int, 3> ogl_bc1_unpack565(const uint16_t c)
+{
+	const int r = c >> 11, g = (c >> 5) & 63, b = c & 31;
+	return {{(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)}};
+}
+
+/* Endpoints from the corners of the block's bounding box, along the
+ * diagonal that follows the colors' correlation with green, and each
+ * texel set to the nearest of the four palette colors.
+ */
+void ogl_compress_bc1_block(const block_texels &t, std::vector<uint8_t> &out)
+{
+	std::array<int, 3> lo{{255, 255, 255}}, hi{{0, 0, 0}}, mean{};
+	for (const auto &c : t)
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			lo[i] = std::min(lo[i], c[i]);
+			hi[i] = std::max(hi[i], c[i]);
+			mean[i] += c[i];
+		}
+	for (auto &m : mean)
+		m /= 16;
+	int cov_rg = 0, cov_bg = 0;
+	for (const auto &c : t)
+	{
+		cov_rg += (c[0] - mean[0]) * (c[1] - mean[1]);
+		cov_bg += (c[2] - mean[2]) * (c[1] - mean[1]);
+	}
+	if (cov_rg < 0)
+		std::swap(lo[0], hi[0]);
+	if (cov_bg < 0)
+		std::swap(lo[2], hi[2]);
+	/* Inset the box a little, since texels rarely sit on its corners */
+	for (unsigned i = 0; i < 3; ++i)
+	{
+		const int inset = (hi[i] - lo[i]) / 16;
+		hi[i] -= inset;
+		lo[i] += inset;
+	}
+	uint16_t c0 = ogl_bc1_pack565(hi), c1 = ogl_bc1_pack565(lo);
+	/* c0 > c1 selects the four color mode */
+	if (c0 < c1)
+		std::swap(c0, c1);
+	uint32_t indices = 0;
+	if (c0 != c1)
+	{
+		const auto p0 = ogl_bc1_unpack565(c0), p1 = ogl_bc1_unpack565(c1);
+		std::array<std::array<int, 3>, 4> palette{{p0, p1}};
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			palette[2][i] = (2 * p0[i] + p1[i]) / 3;
+			palette[3][i] = (p0[i] + 2 * p1[i]) / 3;
+		}
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			unsigned best = 0;
+			int best_error = std::numeric_limits<int>::max();
+			for (unsigned p = 0; p < 4; ++p)
+				if (const int e = ogl_color_distance(t[i], palette[p]); e < best_error)
+				{
+					best_error = e;
+					best = p;
+				}
+			indices |= best << (2 * i);
+		}
+	}
+	const std::array<uint8_t, 8> block{{
+		static_cast<uint8_t>(c0), static_cast<uint8_t>(c0 >> 8),
+		static_cast<uint8_t>(c1), static_cast<uint8_t>(c1 >> 8),
+		static_cast<uint8_t>(indices), static_cast<uint8_t>(indices >> 8),
+		static_cast<uint8_t>(indices >> 16), static_cast<uint8_t>(indices >> 24),
+	}};
+	out.insert(out.end(), block.begin(), block.end());
+}
+
+/* Intensity modifiers of the ETC1 tables, in selector order */
+constexpr std::array<std::array<int, 4>, 8> etc1_modifiers{{
+	{{2, 8, -2, -8}},
+	{{5, 17, -5, -17}},
+	{{9, 29, -9, -29}},
+	{{13, 42, -13, -42}},
+	{{18, 60, -18, -60}},
+	{{24, 80, -24, -80}},
+	{{33, 106, -33, -106}},
+	{{47, 183, -47, -183}},
+}};
+
+struct etc1_subblock
+{
+	unsigned table;
+	int error;
+	/* Selector of each texel, indexed like block_texels */
+	std::array<uint8_t, 16> selector;
+};
+
+/* Best table and selectors for the texels of one half of a block */
+etc1_subblock ogl_etc1_fit(const block_texels &t, const std::array<uint8_t, 8> &texels, const std::array<int, 3> &base)
+{
+	etc1_subblock best{};
+	best.error = std::numeric_limits<int>::max();
+	for (unsigned table = 0; table < etc1_modifiers.size(); ++table)
+	{
+		etc1_subblock s{};
+		s.table = table;
+		for (const auto i : texels)
+		{
+			int best_error = std::numeric_limits<int>::max();
+			for (unsigned m = 0; m < 4; ++m)
+			{
+				const auto d = etc1_modifiers[table][m];
+				const std::array<int, 3> c{{std::clamp(base[0] + d, 0, 255), std::clamp(base[1] + d, 0, 255), std::clamp(base[2] + d, 0, 255)}};
+				if (const int e = ogl_color_distance(t[i], c); e < best_error)
+				{
+					best_error = e;
+					s.selector[i] = m;
+				}
+			}
+			s.error += best_error;
+		}
+		if (s.error < best.error)
+			best = s;
+	}
+	return best;
+}
+
+/* Each half of the block gets its average color, in differential mode
+ * when the two averages are close enough, and the block is split the way
+ * that fits better.
+ */
+void ogl_compress_etc1_block(const block_texels &t, std::vector<uint8_t> &out)
+{
+	uint32_t best_high = 0, best_low = 0;
+	int best_error = std::numeric_limits<int>::max();
+	for (const uint32_t flip : {0u, 1u})
+	{
+		std::array<std::array<uint8_t, 8>, 2> halves;
+		std::array<unsigned, 2> n{};
+		for (unsigned y = 0; y < 4; ++y)
+			for (unsigned x = 0; x < 4; ++x)
+			{
+				const unsigned half = flip ? y >= 2 : x >= 2;
+				halves[half][n[half]++] = y * 4 + x;
+			}
+		std::array<std::array<int, 3>, 2> average{};
+		for (unsigned h = 0; h < 2; ++h)
+		{
+			for (const auto i : halves[h])
+				for (unsigned c = 0; c < 3; ++c)
+					average[h][c] += t[i][c];
+			for (auto &a : average[h])
+				a = (a + 4) / 8;
+		}
+		std::array<std::array<int, 3>, 2> q5, base;
+		bool differential = true;
+		for (unsigned c = 0; c < 3; ++c)
+		{
+			q5[0][c] = (average[0][c] * 31 + 127) / 255;
+			q5[1][c] = (average[1][c] * 31 + 127) / 255;
+			const int d = q5[1][c] - q5[0][c];
+			if (d < -4 || d > 3)
+				differential = false;
+		}
+		uint32_t high = (flip) | (differential ? 2u : 0u);
+		for (unsigned c = 0; c < 3; ++c)
+		{
+			const unsigned shift = 24 - 8 * c;
+			if (differential)
+			{
+				base[0][c] = (q5[0][c] << 3) | (q5[0][c] >> 2);
+				base[1][c] = (q5[1][c] << 3) | (q5[1][c] >> 2);
+				high |= (q5[0][c] << (shift + 3)) | ((static_cast<uint32_t>(q5[1][c] - q5[0][c]) & 7) << shift);
+			}
+			else
+			{
+				const int q0 = (average[0][c] * 15 + 127) / 255, q1 = (average[1][c] * 15 + 127) / 255;
+				base[0][c] = q0 * 17;
+				base[1][c] = q1 * 17;
+				high |= (q0 << (shift + 4)) | (q1 << shift);
+			}
+		}
+		const auto s0 = ogl_etc1_fit(t, halves[0], base[0]);
+		const auto s1 = ogl_etc1_fit(t, halves[1], base[1]);
+		if (const int e = s0.error + s1.error; e < best_error)
+		{
+			best_error = e;
+			best_high = high | (s0.table << 5) | (s1.table << 2);
+			best_low = 0;
+			for (unsigned h = 0; h < 2; ++h)
+				for (const auto i : halves[h])
+				{
+					const unsigned selector = (h ? s1 : s0).selector[i];
+					/* Texels are numbered down each column */
+					const unsigned j = (i % 4) * 4 + i / 4;
+					best_low |= ((selector >> 1) << (16 + j)) | ((selector & 1) << j);
+				}
+		}
+	}
+	const std::array<uint8_t, 8> block{{
+		static_cast<uint8_t>(best_high >> 24), static_cast<uint8_t>(best_high >> 16),
+		static_cast<uint8_t>(best_high >> 8), static_cast<uint8_t>(best_high),
+		static_cast<uint8_t>(best_low >> 24), static_cast<uint8_t>(best_low >> 16),
+		static_cast<uint8_t>(best_low >> 8), static_cast<uint8_t>(best_low),
+	}};
+	out.insert(out.end(), block.begin(), block.end());
+}
+
+}
+
+ogl_texture_cache ogl_level_texture_cache;
+
+void ogl_compress_rgb(const ogl_block_format format, const uint8_t *const rgb, const unsigned w, const unsigned h, std::vector<uint8_t> &out)
+{
+	out.reserve(out.size() + std::size_t{(w + 3) / 4} * ((h + 3) / 4) * 8);
+	for (unsigned by = 0; by < h; by += 4)
+		for (unsigned bx = 0; bx < w; bx += 4)
+		{
+			const auto t = ogl_read_block(rgb, w, h, bx, by);
+			if (format == ogl_block_format::etc1)
+				ogl_compress_etc1_block(t, out);
+			else
+				ogl_compress_bc1_block(t, out);
+		}
+}
+
+uint64_t ogl_texture_cache_hash(const std::span<const uint8_t> data, uint64_t h)
+{
+	for (const auto b : data)
+	{
+		h ^= b;
+		h *= 0x100000001b3ull;
+	}
+	return h;
+}
+
+void ogl_texture_cache::read_index()
+{
+	indexed = true;
+	auto [fp, err] = PHYSFSX_openReadBuffered(ogl_texture_cache_filename);
+	if (!fp)
+		return;
+	std::array<uint8_t, 4> magic;
+	PHYSFS_uint32 version;
+	if (PHYSFS_readBytes(fp, magic.data(), magic.size()) != magic.size() || magic != ogl_texture_cache_magic || !PHYSFS_readULE32(fp, &version) || version != ogl_texture_cache_version)
+	{
+		con_printf(CON_NORMAL, "OpenGL: ignoring texture cache \"%s\" from another version", ogl_texture_cache_filename);
+		return;
+	}
+	const PHYSFS_uint64 length = PHYSFS_fileLength(fp);
+	PHYSFS_uint64 offset = ogl_texture_cache_header_size;
+	for (;;)
+	{
+		PHYSFS_uint32 key_low, key_high;
+		uint8_t format, levels;
+		PHYSFS_uint16 w, h;
+		if (!PHYSFS_readULE32(fp, &key_low) || !PHYSFS_readULE32(fp, &key_high) || PHYSFS_readBytes(fp, &format, 1) != 1 || PHYSFS_readBytes(fp, &levels, 1) != 1 || !PHYSFS_readULE16(fp, &w) || !PHYSFS_readULE16(fp, &h))
+			break;
+		const auto data_offset = offset + ogl_texture_cache_record_header_size;
+		offset = data_offset;
+		bool complete = true;
+		for (unsigned l = 0; l < levels; ++l)
+		{
+			PHYSFS_uint32 size;
+			if (!PHYSFS_readULE32(fp, &size) || (offset += 4 + size) > length || !PHYSFS_seek(fp, offset))
+			{
+				complete = false;
+				break;
+			}
+		}
+		/* A record cut short by a crash ends the usable part of the file */
+		if (!complete)
+			break;
+		index.insert_or_assign((uint64_t{key_high} << 32) | key_low, location{data_offset, static_cast<ogl_block_format>(format), levels, w, h});
+		file_size = offset;
+	}
+	if (!file_size)
+		file_size = ogl_texture_cache_header_size;
+	con_printf(CON_VERBOSE, "OpenGL: texture cache has %zu textures", index.size());
+}
+
+bool ogl_texture_cache::load(const uint64_t key, entry &e)
+{
+	if (!indexed)
+		read_index();
+	const auto i = index.find(key);
+	if (i == index.end())
+		return false;
+	if (!reader)
+	{
+		reader = PHYSFSX_openReadBuffered(ogl_texture_cache_filename).first;
+		if (!reader)
+			return false;
+	}
+	const auto &l = i->second;
+	if (!PHYSFS_seek(reader, l.offset))
+		return false;
+	e.format = l.format;
+	e.w = l.w;
+	e.h = l.h;
+	e.levels.resize(l.levels);
+	for (auto &level : e.levels)
+	{
+		PHYSFS_uint32 size;
+		if (!PHYSFS_readULE32(reader, &size))
+			return false;
+		level.resize(size);
+		if (PHYSFS_readBytes(reader, level.data(), size) != size)
+			return false;
+	}
+	return true;
+}
+
+void ogl_texture_cache::store(const uint64_t key, entry e)
+{
+	pending.emplace_back(key, std::move(e));
+}
+
+void ogl_texture_cache::flush()
+{
+	if (pending.empty())
+		return;
+	if (!indexed)
+		read_index();
+	/* The reader would not see what is appended */
+	reader.reset();
+	RAIIPHYSFS_File fp{index.empty() ? PHYSFS_openWrite(ogl_texture_cache_filename) : PHYSFS_openAppend(ogl_texture_cache_filename)};
+	if (!fp)
+	{
+		con_printf(CON_URGENT, "OpenGL: failed to write texture cache \"%s\": %s", ogl_texture_cache_filename, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+		pending.clear();
+		return;
+	}
+	if (index.empty())
+	{
+		PHYSFS_writeBytes(fp, ogl_texture_cache_magic.data(), ogl_texture_cache_magic.size());
+		PHYSFS_writeULE32(fp, ogl_texture_cache_version);
+		file_size = ogl_texture_cache_header_size;
+	}
+	for (const auto &[key, e] : pending)
+	{
+		const uint8_t format = static_cast<uint8_t>(e.format), levels = static_cast<uint8_t>(e.levels.size());
+		PHYSFS_writeULE32(fp, static_cast<PHYSFS_uint32>(key));
+		PHYSFS_writeULE32(fp, static_cast<PHYSFS_uint32>(key >> 32));
+		PHYSFS_writeBytes(fp, &format, 1);
+		PHYSFS_writeBytes(fp, &levels, 1);
+		PHYSFS_writeULE16(fp, e.w);
+		PHYSFS_writeULE16(fp, e.h);
+		const auto data_offset = file_size + ogl_texture_cache_record_header_size;
+		file_size = data_offset;
+		for (const auto &level : e.levels)
+		{
+			PHYSFS_writeULE32(fp, level.size());
+			PHYSFS_writeBytes(fp, level.data(), level.size());
+			file_size += 4 + level.size();
+		}
+		index.insert_or_assign(key, location{data_offset, e.format, levels, e.w, e.h});
+	}
+	con_printf(CON_VERBOSE, "OpenGL: added %zu textures to texture cache", pending.size());
+	pending.clear();
+}
+
+}
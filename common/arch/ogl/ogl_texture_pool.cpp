@@ -0,0 +1,168 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Texture entry pool and residency budget, shared by the OpenGL and
+ * Vulkan backends.
+ */
+
+#include <algorithm>
+#include <ranges>
+#include "args.h"
+#include "console.h"
+#include "mem_account.h"
+#include "ogl_texture_pool.h"
+
+namespace dcx {
+
+namespace {
+
+/* A texture used in this many recent frames is never evicted, so that a
+ * working set larger than the budget does not reload every frame.
+ */
+constexpr uint32_t ogl_texture_min_evict_age = 2;
+
+}
+
+ogl_texture_pool ogl_textures;
+
+ogl_texture &ogl_texture_pool::allocate()
+{
+	ogl_texture *t;
+	if (free_entries.empty())
+	{
+		t = &entries.emplace_back();
+		t->pool_index = entries.size() - 1;
+	}
+	else
+	{
+		t = free_entries.back();
+		free_entries.pop_back();
+	}
+	t->pool_in_use = true;
+	t->last_used_frame = frame;
+	return *t;
+}
+
+void ogl_texture_pool::release(ogl_texture &t)
+{
+	if (!t.pool_in_use)
+		return;
+	note_unloaded(t);
+	t.pool_in_use = false;
+	t.evictable = false;
+	free_entries.emplace_back(&t);
+}
+
+void ogl_texture_pool::clear()
+{
+	free_entries.clear();
+	/* Hand out low indices first, as the fixed list did */
+	for (auto &t : entries | std::views::reverse)
+	{
+		t.pool_in_use = false;
+		t.evictable = false;
+		t.resident_bytes = 0;
+		free_entries.emplace_back(&t);
+	}
+	mem_account_sub(mem_tag::textures, std::exchange(resident_bytes, 0));
+	need_trim = false;
+	trim_all = false;
+}
+
+void ogl_texture_pool::note_loaded(ogl_texture &t, const std::size_t bytes, const bool evictable)
+{
+	note_unloaded(t);
+	t.resident_bytes = bytes;
+	t.evictable = evictable;
+	t.last_used_frame = frame;
+	resident_bytes += bytes;
+	mem_account_add(mem_tag::textures, bytes);
+	need_trim = true;
+}
+
+void ogl_texture_pool::note_unloaded(ogl_texture &t)
+{
+	const auto bytes{std::exchange(t.resident_bytes, 0)};
+	resident_bytes -= bytes;
+	mem_account_sub(mem_tag::textures, bytes);
+}
+
+bool ogl_texture_pool::evict_candidate(const ogl_texture &t) const
+{
+	return t.evictable && t.resident_bytes && frame - t.last_used_frame >= ogl_texture_min_evict_age;
+}
+
+std::span<ogl_texture *const> ogl_texture_pool::end_frame()
+{
+	++frame;
+	evict_entries.clear();
+	if (std::exchange(trim_all, false))
+	{
+		need_trim = false;
+		for (auto &t : entries)
+			if (evict_candidate(t))
+				evict_entries.emplace_back(&t);
+		evictions += evict_entries.size();
+		if (!evict_entries.empty())
+			con_printf(CON_DEBUG, "OpenGL: evicting %zu textures to free memory", evict_entries.size());
+		return evict_entries;
+	}
+	const std::size_t budget_bytes = std::size_t{CGameArg.OglTextureBudget} << 20;
+	if (!budget_bytes || !std::exchange(need_trim, false) || resident_bytes <= budget_bytes)
+		return {};
+	for (auto &t : entries)
+		if (evict_candidate(t))
+			evict_entries.emplace_back(&t);
+	std::ranges::sort(evict_entries, {}, &ogl_texture::last_used_frame);
+	std::size_t excess = resident_bytes - budget_bytes, count = 0;
+	for (const auto t : evict_entries)
+	{
+		++count;
+		if (t->resident_bytes >= excess)
+			break;
+		excess -= t->resident_bytes;
+	}
+	evict_entries.resize(count);
+	evictions += count;
+	if (count)
+		con_printf(CON_DEBUG, "OpenGL: evicting %zu textures to fit texture budget of %uMB", count, CGameArg.OglTextureBudget);
+	return evict_entries;
+}
+
+std::size_t ogl_texture_pool::request_trim()
+{
+	trim_all = true;
+	std::size_t bytes{};
+	for (auto &t : entries)
+		if (evict_candidate(t))
+			bytes += t.resident_bytes;
+	return bytes;
+}
+
+ogl_texture_pool::stats ogl_texture_pool::get_stats() const
+{
+	return {
+		.entries = entries.size(),
+		.used = entries.size() - free_entries.size(),
+		.resident_bytes = resident_bytes,
+		.budget_bytes = std::size_t{CGameArg.OglTextureBudget} << 20,
+		.evictions = evictions,
+	};
+}
+
+std::size_t ogl_textures_trim()
+{
+	return ogl_textures.request_trim();
+}
+
+/* Kept for font.cpp, which allocates its texture before loading it */
+ogl_texture *ogl_get_free_texture()
+{
+	return &ogl_textures.allocate();
+}
+
+}
@@ -0,0 +1,173 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Palette expansion, mip levels and the worker threads for texture
+ * uploads.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "dxxerror.h"
+#include "fwd-gr.h"
+#include "ogl_texture_prep.h"
+#include "parallel.h"
+
+namespace dcx {
+
+namespace {
+
+template <unsigned N>
+void ogl_expand_texels(const std::array<std::array<uint8_t, 4>, 257> &texel, const uint8_t *src, const std::size_t count, uint8_t *dst)
+{
+	for (const auto end = src + count; src != end; ++src, dst += N)
+		std::memcpy(dst, texel[*src].data(), N);
+}
+
+}
+
+ogl_palette_lut::ogl_palette_lut(const palette_array_t &pal, const GLenum format, const int bm_flags)
+{
+	switch (format)
+	{
+		case GL_RGBA:
+			texel_bytes = 4;
+			break;
+		case GL_RGB:
+			texel_bytes = 3;
+			break;
+		case GL_LUMINANCE_ALPHA:
+			texel_bytes = 2;
+			break;
+		case GL_LUMINANCE:
+#if !DXX_USE_OGLES
+		case GL_COLOR_INDEX:
+#endif
+			texel_bytes = 1;
+			break;
+		default:
+			Error("ogl_palette_lut unknown texformat\n");
+	}
+	for (unsigned c = 0; c != texel.size(); ++c)
+	{
+		auto &t = texel[c];
+		t = {};
+#if !DXX_USE_OGLES
+		if (format == GL_COLOR_INDEX)
+			t[0] = static_cast<uint8_t>(c);
+		else
+#endif
+		if (c == 254 && (bm_flags & BM_FLAG_SUPER_TRANSPARENT))
+		{
+			if (format == GL_RGBA)
+				t = {{255, 255, 255, 0}};
+			else if (format == GL_LUMINANCE_ALPHA)
+				t = {{255, 0}};
+			else
+				Error("ogl_palette_lut unhandled super-transparent texformat\n");
+		}
+		else if ((c == 255 && (bm_flags & BM_FLAG_TRANSPARENT)) || c == 256)
+			/* transparent pixel */;
+		else if (format == GL_LUMINANCE_ALPHA)
+			t = {{255, 255}};
+		else if (format == GL_LUMINANCE)
+			t = {{255}};
+		else
+		{
+			const auto &rgb = pal[c];
+			t = {{static_cast<uint8_t>(rgb.r * 4), static_cast<uint8_t>(rgb.g * 4), static_cast<uint8_t>(rgb.b * 4), 255}};
+		}
+	}
+}
+
+void ogl_palette_lut::expand(const uint8_t *const src, const std::size_t count, uint8_t *const dst) const
+{
+	/* Fixed size copies let the compiler turn the loop into vector
+	 * gathers and stores.
+	 */
+	switch (texel_bytes)
+	{
+		case 4:
+			ogl_expand_texels<4>(texel, src, count, dst);
+			break;
+		case 3:
+			ogl_expand_texels<3>(texel, src, count, dst);
+			break;
+		case 2:
+			ogl_expand_texels<2>(texel, src, count, dst);
+			break;
+		default:
+			ogl_expand_texels<1>(texel, src, count, dst);
+			break;
+	}
+}
+
+void ogl_palette_lut::expand_one(const unsigned c, uint8_t *const dst) const
+{
+	std::memcpy(dst, texel[c].data(), texel_bytes);
+}
+
+void ogl_expand_palettized(const ogl_palette_lut &lut, const uint8_t *const data, uint8_t *texp, const unsigned truewidth, const unsigned width, const unsigned height, const int dxo, const int dyo, const unsigned twidth, const unsigned theight)
+{
+	const unsigned bpt = lut.bytes_per_texel();
+	const unsigned used = std::min(width, twidth);
+	for (unsigned y = 0; y < theight; ++y)
+	{
+		unsigned x = 0;
+		if (y < height)
+		{
+			lut.expand(&data[dxo + truewidth * (y + dyo)], used, texp);
+			texp += used * bpt;
+			x = used;
+			if (x < twidth)
+			{
+				/* end of bitmap reached - fill this pixel with last color to make a clean border when filtering this texture */
+				lut.expand_one(data[(width * (y + 1)) - 1], texp);
+				texp += bpt;
+				++x;
+			}
+		}
+		else if (y == height)
+		{
+			/* fill this row with the last row, for the same reason */
+			lut.expand(&data[width * (height - 1)], used, texp);
+			texp += used * bpt;
+			x = used;
+		}
+		for (; x < twidth; ++x, texp += bpt)
+			lut.expand_one(256, texp);
+	}
+}
+
+void ogl_build_mipmaps(const uint8_t *const level0, unsigned w, unsigned h, const unsigned bytes_per_texel, std::vector<std::vector<uint8_t>> &levels)
+{
+	const uint8_t *src = level0;
+	while (w > 1 || h > 1)
+	{
+		const unsigned nw = std::max(w / 2, 1u), nh = std::max(h / 2, 1u);
+		/* A dimension that is already 1 is not halved */
+		const unsigned sx = w > 1 ? bytes_per_texel : 0, sy = h > 1 ? w * bytes_per_texel : 0;
+		auto &dst = levels.emplace_back(std::size_t{nw} * nh * bytes_per_texel);
+		auto *d = dst.data();
+		for (unsigned y = 0; y < nh; ++y)
+		{
+			const uint8_t *row = src + std::size_t{y} * (h > 1 ? 2 : 1) * w * bytes_per_texel;
+			for (unsigned x = 0; x < nw; ++x, row += (w > 1 ? 2 : 1) * bytes_per_texel)
+				for (unsigned b = 0; b < bytes_per_texel; ++b)
+					*d++ = static_cast<uint8_t>((row[b] + row[b + sx] + row[b + sy] + row[b + sx + sy] + 2) / 4);
+		}
+		src = dst.data();
+		w = nw;
+		h = nh;
+	}
+}
+
+void ogl_parallel_for(const std::size_t count, const std::function<void(std::size_t)> &fn)
+{
+	parallel_for(count, fn);
+}
+
+}
@@ -12,7 +12,10 @@
  *  -- MD2211 (2006-04-24)
  */
 
+#include <future>
+#include <optional>
 #include <span>
+#include <string>
 #include <SDL.h>
 #include <SDL_mixer.h>
 #include <string.h>
@@ -211,6 +214,36 @@ enum class CurrentMusicType : uint8_t
 
 static CurrentMusicType current_music_type{CurrentMusicType::None};
 
+/* A song read by a worker thread while the game shows a briefing or
+ * score screen, or while the previous jukebox track plays, so that
+ * starting it does not wait for the file.  The worker only reads the file,
+ * converts HMP to MIDI and, for ADLMIDI, builds the synthesizer.
+ * Everything that touches SDL_mixer or the console stays on the thread
+ * which starts the song.
+ */
+struct mix_prefetched_song
+{
+	/* The bytes to give to load_mus_data */
+	hmpmid_result data;
+#if DXX_USE_ADLMIDI
+	ADL_MIDIPlayer_t adlmidi;
+#endif
+};
+
+static std::string mix_prefetch_filename;
+static std::future<mix_prefetched_song> mix_prefetch;
+
+/* Wait for the prefetch of `filename`, if there is one, and return its
+ * song.  A prefetch of some other file is kept, since the score screen
+ * plays its own song before the level song that was prefetched.
+ */
+static std::optional<hmpmid_result> mix_collect_prefetch(const char *filename);
+
+/* Read all of a file which is not HMP, in the order mix_play_file tries:
+ * the filesystem, then PhysFS.  Safe to call from any thread.
+ */
+static hmpmid_result mix_read_file(const char *filename);
+
 static CurrentMusicType load_mus_data(const char *filename, std::span<const uint8_t> data, int loop, void (*const hook_finished_track)());
 static CurrentMusicType load_mus_file(const char *filename, int loop, void (*const hook_finished_track)());
 
@@ -235,7 +268,11 @@ int mix_play_file(const char *filename, int loop, void (*const entry_hook_finish
 	// It's a .hmp!
 	if (const auto fptr = strrchr(filename, '.'); fptr && !d_stricmp(fptr, ".hmp"))
 	{
-		if (auto &&[v, hoe] = hmp2mid(filename); hoe == hmp_open_error::None)
+		auto prefetched{mix_collect_prefetch(filename)};
+		/* A prefetch which failed is read again, so that hmp2mid prints
+		 * the error from the main thread.
+		 */
+		if (auto &&[v, hoe] = (prefetched && std::get<1>(*prefetched) == hmp_open_error::None) ? std::move(*prefetched) : hmp2mid(filename); hoe == hmp_open_error::None)
 		{
 			current_music_hndlbuf = std::move(v);
 			current_music_type = load_mus_data(filename, current_music_hndlbuf, loop, hook_finished_track);
@@ -247,6 +284,15 @@ int mix_play_file(const char *filename, int loop, void (*const entry_hook_finish
 			return 0;
 	}
 
+	// use the bytes read ahead by mix_prefetch_file, if any
+	if (auto prefetched{mix_collect_prefetch(filename)}; prefetched && std::get<1>(*prefetched) == hmp_open_error::None)
+	{
+		current_music_hndlbuf = std::move(std::get<0>(*prefetched));
+		current_music_type = load_mus_data(filename, current_music_hndlbuf, loop, hook_finished_track);
+		if (current_music_type != CurrentMusicType::None)
+			return 1;
+	}
+
 	// try loading music via given filename
 	{
 		current_music_type = load_mus_file(filename, loop, hook_finished_track);
@@ -291,6 +337,68 @@ int mix_play_file(const char *filename, int loop, void (*const entry_hook_finish
 	return 0;
 }
 
+void mix_prefetch_file(const char *const filename)
+{
+	if (mix_prefetch.valid() && mix_prefetch_filename == filename)
+		return;
+	const auto fptr = strrchr(filename, '.');
+	if (!fptr)
+		return;
+	const bool is_hmp{!d_stricmp(fptr, ".hmp")};
+	/* Read the settings here, so that the worker never looks at the
+	 * configuration or at SDL_mixer.
+	 */
+#if DXX_USE_ADLMIDI
+	struct adlmidi_settings
+	{
+		int sample_rate;
+		int num_chips;
+		int bank;
+	} adl{};
+	/* The first adl_init loads the library and reports the result on the
+	 * console, so the worker only builds a synthesizer once the library has
+	 * been loaded.
+	 */
+	const bool make_adlmidi{(is_hmp || !d_stricmp(fptr, ".mid")) && CGameCfg.ADLMIDI_enabled && !current_adlmidi && adl_playFormat};
+	if (make_adlmidi)
+	{
+		Mix_QuerySpec(&adl.sample_rate, nullptr, nullptr);
+		adl.num_chips = CGameCfg.ADLMIDI_num_chips;
+		adl.bank = CGameCfg.ADLMIDI_bank;
+	}
+#endif
+	/* Assigning over a pending future waits for the previous worker */
+	mix_prefetch_filename = filename;
+	mix_prefetch = std::async(std::launch::async, [name = mix_prefetch_filename, is_hmp
+#if DXX_USE_ADLMIDI
+		, make_adlmidi, adl
+#endif
+	]() {
+		mix_prefetched_song r;
+		/* Only the reading is done here.  A file which fails is read
+		 * again by mix_play_file, which reports the error.
+		 */
+		if (!is_hmp)
+			r.data = mix_read_file(name.c_str());
+		else if (auto &&[hmp, hoe, pec] = hmp_open(name.c_str()); hmp)
+			r.data = {hmp2mid(*hmp), hmp_open_error::None};
+		else
+			std::get<1>(r.data) = hoe;
+#if DXX_USE_ADLMIDI
+		if (make_adlmidi)
+			if (const auto adlmidi = adl_init(adl.sample_rate))
+			{
+				adl_switchEmulator(adlmidi, ADLMIDI_EMU_DOSBOX);
+				adl_setNumChips(adlmidi, adl.num_chips);
+				adl_setBank(adlmidi, adl.bank);
+				adl_setSoftPanEnabled(adlmidi, 1);
+				r.adlmidi.reset(adlmidi);
+			}
+#endif
+		return r;
+	});
+}
+
 // What to do when stopping song playback
 void mix_free_music()
 {
@@ -341,6 +449,46 @@ void mix_pause_resume_music()
 
 namespace {
 
+static std::optional<hmpmid_result> mix_collect_prefetch(const char *const filename)
+{
+	if (!mix_prefetch.valid() || mix_prefetch_filename != filename)
+		return std::nullopt;
+	auto song{mix_prefetch.get()};
+#if DXX_USE_ADLMIDI
+	/* The synthesizer is only installed if nothing built one while the
+	 * worker ran, and only if ADLMIDI is still enabled.
+	 */
+	if (song.adlmidi && !current_adlmidi && CGameCfg.ADLMIDI_enabled)
+		current_adlmidi = std::move(song.adlmidi);
+#endif
+	return std::move(song.data);
+}
+
+static hmpmid_result mix_read_file(const char *const filename)
+{
+	std::vector<uint8_t> v;
+	if (RWops_ptr rw{SDL_RWFromFile(filename, "rb")})
+	{
+		/* SDL_RWsize is not available with SDL1 */
+		if (const auto len{SDL_RWseek(rw.get(), 0, RW_SEEK_END)}; len > 0 && SDL_RWseek(rw.get(), 0, RW_SEEK_SET) == 0)
+		{
+			v.resize(len);
+			if (SDL_RWread(rw.get(), v.data(), 1, v.size()) == v.size())
+				return {std::move(v), hmp_open_error::None};
+		}
+	}
+	else if (RAIIPHYSFS_File filehandle{PHYSFS_openRead(filename)})
+	{
+		if (const auto len{PHYSFS_fileLength(filehandle)}; len > 0)
+		{
+			v.resize(len);
+			if (PHYSFSX_readBytes(filehandle, v.data(), len) == len)
+				return {std::move(v), hmp_open_error::None};
+		}
+	}
+	return {std::vector<uint8_t>{}, hmp_open_error::physfs_open};
+}
+
 static CurrentMusicType load_mus_data(const char *const filename, const std::span<const uint8_t> data, int loop, void (*const hook_finished_track)())
 {
 #if DXX_USE_ADLMIDI
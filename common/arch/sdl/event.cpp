@@ -23,10 +23,14 @@
 #include "cmd.h"
 #include "config.h"
 #include "inferno.h"
+#include "console.h"
 
 #include "joy.h"
 #include "args.h"
 #include "partial_range.h"
+#include "input_latency.h"
+#include "mem_trim.h"
+#include "fwd-game.h"
 #ifdef __ANDROID__
 #include "touch.h"
 #endif
@@ -43,11 +47,49 @@ struct event_poll_state
 	void process_event_batch(std::ranges::subrange<const SDL_Event *>);
 };
 
+/* Set when what is on screen may have changed, so that the next
+ * event_process draws even if the front window is idle.
+ */
+static uint8_t event_redraw_pending{1};
+
+/* Returns true if an event arrived within `milliseconds`, without taking
+ * it off the queue.
+ */
+static bool event_wait_for_input(const unsigned milliseconds)
+{
+#if SDL_MAJOR_VERSION == 1
+	/* SDL 1.2 has no timed wait, so check the queue at a coarse interval */
+	const uint32_t start = SDL_GetTicks();
+	for (;;)
+	{
+		SDL_Event event;
+		SDL_PumpEvents();
+		if (SDL_PeepEvents(&event, 1, SDL_PEEKEVENT, SDL_ALLEVENTS) > 0)
+			return true;
+		if (SDL_GetTicks() - start >= milliseconds)
+			return false;
+		SDL_Delay(10);
+	}
+#elif SDL_MAJOR_VERSION == 2
+	return SDL_WaitEventTimeout(nullptr, milliseconds);
+#endif
+}
+
 }
 
 #if SDL_MAJOR_VERSION == 2
 extern SDL_Window *g_pRebirthSDLMainWindow;
 
+/* SDL does not suspend the program for the background until this loop
+ * has taken SDL_APP_DIDENTERBACKGROUND, so the caches are trimmed before
+ * the system decides which process to kill.
+ */
+static void mem_trim_handler(const mem_trim_level level)
+{
+	if (const auto freed{mem_trim(level)})
+		con_printf(CON_VERBOSE, "Freed %" DXX_PRI_size_type " bytes of caches for the system", freed);
+}
+
 static void windowevent_handler(const SDL_WindowEvent &windowevent)
 {
 	switch (windowevent.event)
@@ -98,7 +140,11 @@ window_event_result event_poll()
 #endif
 		if (peep <= 0)
 			break;
+		event_redraw_pending = 1;
 		state.process_event_batch(unchecked_partial_range(events, static_cast<unsigned>(peep)));
+#ifdef __ANDROID__
+		touch_overlay_apply_motion();
+#endif
 		if (state.highest_result == window_event_result::deleted)
 			break;
 	}
@@ -124,11 +170,28 @@ void event_poll_state::process_event_batch(const std::ranges::subrange<const SDL
 	for (auto &&event : events)
 	{
 		window_event_result result;
+#if SDL_MAJOR_VERSION == 1
+		// SDL 1.2 events carry no time, so use the time they were taken
+		input_latency_begin_event(SDL_GetTicks());
+#elif SDL_MAJOR_VERSION == 2
+		input_latency_begin_event(event.common.timestamp);
+#endif
 		switch(event.type) {
 #if SDL_MAJOR_VERSION == 2
 			case SDL_WINDOWEVENT:
 				windowevent_handler(event.window);
 				continue;
+			case SDL_APP_DIDENTERBACKGROUND:
+				mem_trim_handler(mem_trim_level::background);
+				continue;
+			case SDL_APP_LOWMEMORY:
+				mem_trim_handler(mem_trim_level::critical);
+				continue;
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+			case SDL_RENDER_DEVICE_RESET:
+				gr_context_reset();
+				continue;
+#endif
 #endif
 			case SDL_KEYDOWN:
 			case SDL_KEYUP:
@@ -187,6 +250,7 @@ void event_poll_state::process_event_batch(const std::ranges::subrange<const SDL
 		}
 		highest_result = std::max(result, highest_result);
 	}
+	input_latency_end_event();
 }
 
 void event_flush()
@@ -240,9 +304,18 @@ window_event_result event_process(void)
 	window *wind = window_get_front();
 	window_event_result highest_result;
 
+	// A front window which does not animate is drawn again only when
+	// input arrives, a redraw is requested or its wait runs out.  Until
+	// then, sleep instead of drawing the same picture at the frame cap.
+	const unsigned idle_wait = (wind && !CGameArg.SysHeadless) ? wind->get_idle_wait() : 0;
+	if (idle_wait && !event_redraw_pending && !event_wait_for_input(idle_wait))
+		event_redraw_pending = 1;
+
 	timer_update();
 
 	highest_result = event_poll();	// send input events first
+	if (highest_result != window_event_result::ignored)
+		event_redraw_pending = 1;
 
 	cmd_queue_process();
 
@@ -253,6 +326,10 @@ window_event_result event_process(void)
 	if ((highest_result == window_event_result::deleted) || (window_get_front() != wind))
 		return highest_result;
 
+	if (idle_wait && !event_redraw_pending)
+		return highest_result;
+	event_redraw_pending = 0;
+
 	const d_event event{event_type::window_draw};	// then draw all visible windows
 	for (wind = window_get_first(); wind != nullptr;)
 	{
@@ -274,14 +351,24 @@ window_event_result event_process(void)
 		wind = window_get_next(*wind);
 	}
 
+	if (CGameArg.SysHeadless)
+		return highest_result;
 #ifdef __ANDROID__
 	touch_overlay_draw();
 #endif
 	gr_flip();
+#if DXX_USE_SCREENSHOT
+	screenshot_after_flip();
+#endif
 
 	return highest_result;
 }
 
+void event_request_redraw()
+{
+	event_redraw_pending = 1;
+}
+
 namespace {
 
 template <bool activate_focus>
@@ -17,6 +17,7 @@
 #include "hudmsg.h"
 #include "songs.h"
 #include "jukebox.h"
+#include "digi_mixer_music.h"
 #include "dxxerror.h"
 #include "console.h"
 #include "config.h"
@@ -26,6 +27,7 @@
 
 #include "partial_range.h"
 #include <memory>
+#include <string>
 
 namespace dcx {
 
@@ -96,6 +98,15 @@ class jukebox_songs
 public:
 	void unload();
 	list_pointers list;	// the actual list
+	/* The CMLevelMusicPath that `list` was built from.  songs_init
+	 * reloads the jukebox before each song, so an unchanged path reuses
+	 * the list instead of scanning the directory again.
+	 */
+	std::string loaded_path;
+	/* The track jukebox_hook_next plays, chosen when the current track
+	 * starts so that it can be read ahead.  -1 if none.
+	 */
+	int next_track = -1;
 	static const std::size_t max_songs = 1024;	// maximum number of pointers that 'list' can hold, i.e. size of list / size of one pointer
 };
 
@@ -106,6 +117,8 @@ static jukebox_songs JukeboxSongs;
 void jukebox_songs::unload()
 {
 	list.reset();
+	loaded_path.clear();
+	next_track = -1;
 }
 
 void jukebox_unload()
@@ -217,10 +230,12 @@ static std::size_t read_m3u(void)
 /* Loads music file names from a given directory or M3U playlist */
 void jukebox_load()
 {
+	auto &cfgpath = CGameCfg.CMLevelMusicPath;
+	if (JukeboxSongs.list && JukeboxSongs.loaded_path == cfgpath.data())
+		return;
 	jukebox_unload();
 
 	// Check if it's an M3U file
-	auto &cfgpath = CGameCfg.CMLevelMusicPath;
 	size_t musiclen = strlen(cfgpath.data());
 	std::size_t num_songs;
 	if (musiclen > 4 && !d_stricmp(&cfgpath[musiclen - 4], ".m3u"))
@@ -267,6 +282,7 @@ void jukebox_load()
 
 	if (num_songs)
 	{
+		JukeboxSongs.loaded_path = cfgpath.data();
 		con_printf(CON_DEBUG,"Jukebox: %" DXX_PRI_size_type " music file(s) found in %s", num_songs, cfgpath.data());
 		if (CGameCfg.CMLevelMusicTrack[1] != num_songs)
 		{
@@ -288,7 +304,9 @@ static void jukebox_hook_next()
 	if (!JukeboxSongs.list || CGameCfg.CMLevelMusicTrack[0] == -1)
 		return;
 
-	if (CGameCfg.CMLevelMusicPlayOrder == LevelMusicPlayOrder::Random)
+	if (JukeboxSongs.next_track >= 0 && JukeboxSongs.next_track < CGameCfg.CMLevelMusicTrack[1])
+		CGameCfg.CMLevelMusicTrack[0] = JukeboxSongs.next_track;
+	else if (CGameCfg.CMLevelMusicPlayOrder == LevelMusicPlayOrder::Random)
 		CGameCfg.CMLevelMusicTrack[0] = d_rand() % CGameCfg.CMLevelMusicTrack[1]; // simply a random selection - no check if this song has already been played. But that's how I roll!
 	else
 		CGameCfg.CMLevelMusicTrack[0]++;
@@ -298,6 +316,43 @@ static void jukebox_hook_next()
 	jukebox_play();
 }
 
+/* The path songs_play_file needs for jukebox track `track`, or an empty
+ * string if there is no such track.
+ */
+static std::string jukebox_track_path(const int track)
+{
+	if (track < 0 || track + 1 > CGameCfg.CMLevelMusicTrack[1])
+		return {};
+	const auto music_filename{JukeboxSongs.list[track]};
+	if (!music_filename)
+		return {};
+	auto &cfgpath = CGameCfg.CMLevelMusicPath;
+	const size_t musiclen = strlen(cfgpath.data());
+	if (musiclen > 4 && !d_stricmp(&cfgpath[musiclen - 4], ".m3u"))	// if it's from an M3U playlist
+		return music_filename;
+	// if it's from a specified path
+	return std::string{cfgpath.data()} + music_filename;
+}
+
+/* Pick the track after the one which just started, and start reading it,
+ * so that the change of track does not wait for the file.
+ */
+static void jukebox_prefetch_next()
+{
+	JukeboxSongs.next_track = -1;
+	const auto count{CGameCfg.CMLevelMusicTrack[1]};
+	if (CGameCfg.CMLevelMusicPlayOrder == LevelMusicPlayOrder::Level || count <= 0)
+		return;
+	const int next{CGameCfg.CMLevelMusicPlayOrder == LevelMusicPlayOrder::Random
+		? static_cast<int>(d_rand() % count)
+		: (CGameCfg.CMLevelMusicTrack[0] + 1) % count};
+	if (const auto path{jukebox_track_path(next)}; !path.empty())
+	{
+		JukeboxSongs.next_track = next;
+		mix_prefetch_file(path.c_str());
+	}
+}
+
 // Play tracks from Jukebox directory. Play track specified in GameCfg.CMLevelMusicTrack[0] and loop depending on CGameCfg.CMLevelMusicPlayOrder
 int jukebox_play()
 {
@@ -314,26 +369,14 @@ int jukebox_play()
 		return 0;
 
 	const size_t size_music_filename = strlen(music_filename);
-	auto &cfgpath = CGameCfg.CMLevelMusicPath;
-	const size_t musiclen = strlen(cfgpath.data());
 	{
-	char *LevelMusicPath;
-	std::unique_ptr<char[]> full_filename;
-	if (musiclen > 4 && !d_stricmp(&cfgpath[musiclen - 4], ".m3u"))	// if it's from an M3U playlist
-		LevelMusicPath = music_filename;
-	else											// if it's from a specified path
-	{
-		const std::size_t size_full_filename = musiclen + size_music_filename + 1;
-		full_filename = std::make_unique<char[]>(size_full_filename);
-		LevelMusicPath = full_filename.get();
-		snprintf(full_filename.get(), size_full_filename, "%s%s", cfgpath.data(), music_filename);
-	}
-
-	if (!songs_play_file(LevelMusicPath, (CGameCfg.CMLevelMusicPlayOrder == LevelMusicPlayOrder::Level ? 1 : 0), (CGameCfg.CMLevelMusicPlayOrder == LevelMusicPlayOrder::Level ? nullptr : jukebox_hook_next)))
+	auto LevelMusicPath{jukebox_track_path(CGameCfg.CMLevelMusicTrack[0])};
+	if (!songs_play_file(LevelMusicPath.data(), (CGameCfg.CMLevelMusicPlayOrder == LevelMusicPlayOrder::Level ? 1 : 0), (CGameCfg.CMLevelMusicPlayOrder == LevelMusicPlayOrder::Level ? nullptr : jukebox_hook_next)))
 	{
 		return 0;	// whoops, got an error
 	}
 	}
+	jukebox_prefetch_next();
 
 	// Formatting a pretty message
 	const char *prefix = "...";
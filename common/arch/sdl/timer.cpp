@@ -10,7 +10,14 @@
  *
  */
 
+#include <algorithm>
+#include <climits>
 #include <SDL.h>
+#ifdef __ANDROID__
+#include <cmath>
+#include <dlfcn.h>
+#include "console.h"
+#endif
 
 #include "fwd-game.h"
 #include "maths.h"
@@ -22,21 +29,92 @@ namespace dcx {
 
 static fix64 F64_RunTime = 0;
 
+namespace {
+
+/* The clock the game time is read from.  SDL2 has a monotonic counter of
+ * the system's finest resolution.  SDL1 has only milliseconds, which
+ * round frame times at high rates.
+ */
+#if SDL_MAJOR_VERSION == 2
+using timer_counter = uint64_t;
+
+static timer_counter timer_read_counter()
+{
+	return SDL_GetPerformanceCounter();
+}
+
+static uint64_t timer_counter_frequency()
+{
+	return SDL_GetPerformanceFrequency();
+}
+#else
+/* Wraps after 49 days, which the unsigned difference in timer_update
+ * absorbs
+ */
+using timer_counter = uint32_t;
+
+static timer_counter timer_read_counter()
+{
+	return SDL_GetTicks();
+}
+
+static uint64_t timer_counter_frequency()
+{
+	return 1000;
+}
+#endif
+
+/* The scheduler wakes a sleeper late by an amount that depends on the
+ * system.  timer_wait_toward measures it, and spins instead of sleeping
+ * when the deadline is nearer than that.
+ */
+struct timer_sleep_accuracy
+{
+	fix oversleep_average{F1_0 / 1000};
+	fix margin() const
+	{
+		return std::clamp(oversleep_average + F1_0 / 4000, F1_0 / 4000, F1_0 / 250);
+	}
+};
+
+static timer_sleep_accuracy Sleep_accuracy;
+
+struct frame_pacing_window
+{
+	fix64 start;
+	fix64 total_late;
+	fix max_late;
+	unsigned frames;
+};
+
+static frame_pacing_window Frame_pacing_window;
+static timer_frame_pacing Frame_pacing;
+
+}
+
 fix64 timer_update()
 {
 	static bool already_initialized;
-	static fix64 last_tv;
-	const fix64 cur_tv = static_cast<fix64>(SDL_GetTicks()) * F1_0 / 1000;
-	const fix64 prev_tv = last_tv;
-	fix64 runtime = F64_RunTime;
-	last_tv = cur_tv;
+	static uint64_t frequency;
+	static timer_counter last_counter;
+	/* Counter ticks since the first update.  Converting the total, rather
+	 * than each step, keeps the rounding from adding up.
+	 */
+	static uint64_t elapsed;
+	const timer_counter now = timer_read_counter();
 	if (unlikely(!already_initialized))
 	{
 		already_initialized = true;
+		frequency = timer_counter_frequency();
+		last_counter = now;
+		return F64_RunTime;
 	}
-	else if (likely(prev_tv < cur_tv)) // in case SDL_GetTicks wraps, don't update and have a little hickup
-		F64_RunTime = (runtime += (cur_tv - prev_tv)); // increment! this value will overflow long after we are all dead... so why bother checking?
-	return runtime;
+	elapsed += static_cast<timer_counter>(now - last_counter);
+	last_counter = now;
+	/* Split the conversion, so that the product cannot overflow however
+	 * fine the counter is
+	 */
+	return F64_RunTime = static_cast<fix64>((elapsed / frequency) * F1_0 + (elapsed % frequency) * F1_0 / frequency);
 }
 
 fix64 timer_query(void)
@@ -49,30 +127,177 @@ void timer_delay_ms(unsigned milliseconds)
 	SDL_Delay(milliseconds);
 }
 
+void timer_wait_toward(const fix64 deadline, const unsigned max_sleep_ms)
+{
+	const auto now = timer_update();
+	const auto margin = Sleep_accuracy.margin();
+	if (deadline - now <= margin)
+		return;
+	const auto ms = static_cast<unsigned>(std::min<fix64>(max_sleep_ms, ((deadline - now - margin) * 1000) >> 16));
+	if (!ms)
+		return;
+	SDL_Delay(ms);
+	const auto oversleep = timer_update() - now - fix64{ms} * F1_0 / 1000;
+	auto &average = Sleep_accuracy.oversleep_average;
+	average = (average * 7 + static_cast<fix>(std::clamp<fix64>(oversleep, 0, F1_0 / 100))) / 8;
+}
+
 // Replacement for timer_delay which considers calc time the program needs between frames (not reentrant)
 void timer_delay_bound(const unsigned caller_bound)
 {
-	static uint32_t FrameStart;
+	static fix64 FrameStart;
 
-	uint32_t start = FrameStart;
 	const auto multiplayer{+(Game_mode & GM_MULTI)};
 	const auto vsync{CGameCfg.VSync};
-	const auto bound = vsync ? 1000u / MAXIMUM_FPS : caller_bound;
+	const auto deadline = FrameStart + fix64{vsync ? 1000u / MAXIMUM_FPS : caller_bound} * F1_0 / 1000;
 	for (;;)
 	{
-		const uint32_t tv_now = SDL_GetTicks();
+		const auto now = timer_update();
 		if (multiplayer)
 			multi_do_frame(); // during long wait, keep packets flowing
-		if (!vsync)
-			SDL_Delay(1);
-		if (unlikely(start > tv_now))
-			start = tv_now;
-		if (unlikely(tv_now - start >= bound))
+		if (now >= deadline || unlikely(now < FrameStart))
 		{
-			FrameStart = tv_now;
+			FrameStart = now;
 			break;
 		}
+		if (!vsync)
+			timer_wait_toward(deadline, multiplayer ? 1 : UINT_MAX);
+	}
+}
+
+void timer_record_frame_lateness(const fix late)
+{
+	auto &w = Frame_pacing_window;
+	w.total_late += late;
+	w.max_late = std::max(w.max_late, late);
+	++w.frames;
+	if (const auto now = timer_query(); now - w.start >= F1_0)
+	{
+		Frame_pacing = {static_cast<fix>(w.total_late / w.frames), w.max_late};
+		w = {now, 0, 0, 0};
+	}
+}
+
+timer_frame_pacing timer_get_frame_pacing()
+{
+	return Frame_pacing;
+}
+
+#ifdef __ANDROID__
+namespace {
+
+/* AThermal_getThermalHeadroom is API 31 and the build targets API 24, so
+ * resolve it at runtime.  A headroom of 1.0 is the point at which the device
+ * starts severe throttling.
+ */
+struct AThermalManager;
+using AThermal_acquireManager_t = AThermalManager *(*)();
+using AThermal_getThermalHeadroom_t = float (*)(AThermalManager *, int forecastSeconds);
+
+struct frame_pacer
+{
+	AThermalManager *thermal_manager;
+	AThermal_getThermalHeadroom_t get_thermal_headroom;
+	bool thermal_probed;
+	uint8_t load_divisor = 1;
+	uint8_t thermal_divisor = 1;
+	uint8_t reported_divisor = 1;
+	fix64 work_average;
+	fix64 last_change;
+	fix64 next_thermal_poll;
+};
+
+static frame_pacer pacer;
+
+static void frame_pacer_probe_thermal()
+{
+	pacer.thermal_probed = true;
+	const auto libandroid = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+	if (!libandroid)
+		return;
+	const auto acquire = reinterpret_cast<AThermal_acquireManager_t>(dlsym(libandroid, "AThermal_acquireManager"));
+	const auto headroom = reinterpret_cast<AThermal_getThermalHeadroom_t>(dlsym(libandroid, "AThermal_getThermalHeadroom"));
+	if (!acquire || !headroom)
+		return;
+	if (const auto manager = acquire())
+	{
+		pacer.thermal_manager = manager;
+		pacer.get_thermal_headroom = headroom;
+		con_puts(CON_VERBOSE, "Frame pacing: using thermal headroom");
+	}
+}
+
+static void frame_pacer_poll_thermal(const fix64 now)
+{
+	if (!pacer.thermal_probed)
+		frame_pacer_probe_thermal();
+	if (!pacer.get_thermal_headroom || now < pacer.next_thermal_poll)
+		return;
+	/* The platform rate-limits headroom queries and returns NaN when polled
+	 * too often, so sample every few seconds and forecast ahead by as much.
+	 */
+	pacer.next_thermal_poll = now + F1_0 * 5;
+	const auto headroom = pacer.get_thermal_headroom(pacer.thermal_manager, 5);
+	if (std::isnan(headroom))
+		return;
+	if (headroom >= 0.95f)
+		pacer.thermal_divisor = 3;
+	else if (headroom >= 0.85f)
+		pacer.thermal_divisor = 2;
+	else if (headroom < 0.75f)
+		pacer.thermal_divisor = 1;
+}
+
+static fix frame_pacer_vsync_period()
+{
+	SDL_DisplayMode mode;
+	if (SDL_GetCurrentDisplayMode(0, &mode) || mode.refresh_rate <= 0)
+		return F1_0 / 60;
+	return F1_0 / mode.refresh_rate;
+}
+
+}
+
+fix timer_paced_frame_bound(const fix bound, const fix64 work)
+{
+	if (!CGameCfg.AdaptivePacing)
+		return bound;
+	const auto now = timer_query();
+	frame_pacer_poll_thermal(now);
+	/* With vsync enabled the caller's bound is only a safety limit; pace in
+	 * whole refresh intervals instead, so a reduced rate stays even.
+	 */
+	const auto period = CGameCfg.VSync ? frame_pacer_vsync_period() : bound;
+	pacer.work_average = (pacer.work_average * 7 + work) / 8;
+	const auto divisor = pacer.load_divisor;
+	if (now - pacer.last_change >= F1_0)
+	{
+		/* Drop to the next lower rate when the frame work consistently fills
+		 * the current interval, so that frames arrive at a steady cadence
+		 * instead of alternating between fast and late.  Only step back up
+		 * once the work fits comfortably within the faster interval.
+		 */
+		if (divisor < 3 && pacer.work_average > period * divisor * 9 / 10)
+		{
+			++pacer.load_divisor;
+			pacer.last_change = now;
+		}
+		else if (divisor > 1 && now - pacer.last_change >= F1_0 * 3 && pacer.work_average < period * (divisor - 1) * 6 / 10)
+		{
+			--pacer.load_divisor;
+			pacer.last_change = now;
+		}
+	}
+	const uint8_t effective = std::max(pacer.load_divisor, pacer.thermal_divisor);
+	if (effective != pacer.reported_divisor)
+	{
+		pacer.reported_divisor = effective;
+		con_printf(CON_VERBOSE, "Frame pacing: frame interval %u (%s)", effective, pacer.thermal_divisor >= pacer.load_divisor ? "thermal" : "load");
 	}
+	if (effective == 1)
+		return bound;
+	return period * effective;
 }
+#endif
 
 }
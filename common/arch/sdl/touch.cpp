@@ -60,6 +60,9 @@ struct virtual_stick {
 	SDL_FingerID finger_id;
 	bool key_up, key_down, key_left, key_right;
 	SDL_Scancode sc_up, sc_down, sc_left, sc_right;
+	// Last position reported for the finger, applied by touch_overlay_apply_motion
+	bool moved;
+	float finger_x, finger_y;
 };
 
 static virtual_stick left_stick, right_stick;
@@ -84,6 +87,7 @@ static std::array<touch_zone, BTN_COUNT> buttons;
 static bool overlay_enabled = true;
 static bool overlay_initialized = false;
 static bool invert_y_axis = false;
+static bool analog_sticks = false;
 static bool controls_visible = true;
 static touch_zone toggle_button;
 static int screen_width, screen_height;
@@ -164,6 +168,8 @@ static void compute_stick_deflection(virtual_stick &stick, float fx, float fy, b
 	if (dist > 1.0f) { ddx /= dist; ddy /= dist; }
 	stick.dx = ddx;
 	stick.dy = ddy;
+	if (analog_sticks)
+		return;
 	if (invert_y)
 		ddy = -ddy;
 	update_stick_keys(stick, ddx, ddy);
@@ -599,6 +605,7 @@ int touch_overlay_handle_event(const SDL_Event &event)
 				left_stick.center_x = fx;
 				left_stick.center_y = fy;
 				left_stick.dx = left_stick.dy = 0.0f;
+				left_stick.moved = false;
 				return 1;
 			}
 
@@ -610,6 +617,7 @@ int touch_overlay_handle_event(const SDL_Event &event)
 				right_stick.center_x = fx;
 				right_stick.center_y = fy;
 				right_stick.dx = right_stick.dy = 0.0f;
+				right_stick.moved = false;
 				right_stick.firing = false;
 				// Check if initial touch is in fire zone
 				update_fire_state(right_stick, fx, fy);
@@ -624,20 +632,16 @@ int touch_overlay_handle_event(const SDL_Event &event)
 			fy = event.tfinger.y;
 			fid = event.tfinger.fingerId;
 
-			// Left stick motion
-			if (left_stick.active && left_stick.finger_id == fid)
-			{
-				compute_stick_deflection(left_stick, fx, fy);
-				return 1;
-			}
-
-			// Right stick motion (+ dynamic fire zone transitions)
-			if (right_stick.active && right_stick.finger_id == fid)
-			{
-				compute_stick_deflection(right_stick, fx, fy, invert_y_axis);
-				update_fire_state(right_stick, fx, fy);
-				return 1;
-			}
+			// A 240Hz panel reports several moves per frame, and only the
+			// last matters, so keep it for touch_overlay_apply_motion
+			for (auto &stick : {&left_stick, &right_stick})
+				if (stick->active && stick->finger_id == fid)
+				{
+					stick->moved = true;
+					stick->finger_x = fx;
+					stick->finger_y = fy;
+					return 1;
+				}
 			break;
 		}
 
@@ -649,6 +653,7 @@ int touch_overlay_handle_event(const SDL_Event &event)
 			if (left_stick.active && left_stick.finger_id == fid)
 			{
 				left_stick.active = false;
+				left_stick.moved = false;
 				left_stick.dx = left_stick.dy = 0.0f;
 				release_all_stick_keys(left_stick);
 				return 1;
@@ -658,6 +663,7 @@ int touch_overlay_handle_event(const SDL_Event &event)
 			if (right_stick.active && right_stick.finger_id == fid)
 			{
 				right_stick.active = false;
+				right_stick.moved = false;
 				right_stick.dx = right_stick.dy = 0.0f;
 				release_all_stick_keys(right_stick);
 				if (right_stick.firing)
@@ -700,6 +706,50 @@ void touch_overlay_set_invert_y(bool invert)
 	invert_y_axis = invert;
 }
 
+void touch_overlay_apply_motion()
+{
+	if (left_stick.moved)
+	{
+		left_stick.moved = false;
+		compute_stick_deflection(left_stick, left_stick.finger_x, left_stick.finger_y);
+	}
+	// Right stick motion (+ dynamic fire zone transitions)
+	if (right_stick.moved)
+	{
+		right_stick.moved = false;
+		compute_stick_deflection(right_stick, right_stick.finger_x, right_stick.finger_y, invert_y_axis);
+		update_fire_state(right_stick, right_stick.finger_x, right_stick.finger_y);
+	}
+}
+
+void touch_overlay_set_analog(const bool analog)
+{
+	if (analog_sticks == analog)
+		return;
+	analog_sticks = analog;
+	if (analog)
+	{
+		release_all_stick_keys(left_stick);
+		release_all_stick_keys(right_stick);
+	}
+	else
+	{
+		// Press the keys for wherever the sticks are held now
+		update_stick_keys(left_stick, left_stick.dx, left_stick.dy);
+		update_stick_keys(right_stick, right_stick.dx, invert_y_axis ? -right_stick.dy : right_stick.dy);
+	}
+}
+
+touch_stick_axes touch_overlay_get_axes()
+{
+	if (!overlay_enabled || !overlay_initialized)
+		return {};
+	return {
+		left_stick.dx, left_stick.dy,
+		right_stick.dx, invert_y_axis ? -right_stick.dy : right_stick.dy,
+	};
+}
+
 }  // namespace dcx
 
 #endif  // __ANDROID__
@@ -43,6 +43,7 @@ void window::send_creation_events()
 	if (FrontWindow)
 		FrontWindow->next = this;
 	FrontWindow = this;
+	event_request_redraw();
 	if (prev_front)
 		prev_front->send_event(d_event{event_type::window_deactivated});
 	this->send_event(d_create_event{});
@@ -51,6 +52,7 @@ void window::send_creation_events()
 
 window::~window()
 {
+	event_request_redraw();
 	if (this == FrontWindow)
 		FrontWindow = this->prev;
 	if (this == FirstWindow)
@@ -124,6 +126,7 @@ void window_select(window &wind)
 	FrontWindow->next = &wind;
 	wind.next = nullptr;
 	FrontWindow = &wind;
+	event_request_redraw();
 	
 	if (wind.is_visible())
 	{
@@ -137,6 +140,7 @@ window *window::set_visible(uint8_t visible)
 {
 	window *prev = window_get_front();
 	w_visible = visible;
+	event_request_redraw();
 	auto wind = window_get_front();	// get the new front window
 	if (wind == prev)
 		return wind;
@@ -0,0 +1,54 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* A small micro-benchmark harness.  Each case is a function which runs
+ * its operation `iterations` times.  The runner picks the count so that
+ * a run takes long enough to time, repeats the run, and reports the best
+ * time per iteration.
+ *
+ * The report is JSON in the layout of Google Benchmark, so that the same
+ * tools can compare two runs.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace dcx {
+
+using bench_function = void (*)(uint64_t iterations);
+
+struct bench_case
+{
+	const char *name;
+	bench_function function;
+};
+
+std::vector<bench_case> &bench_get_cases();
+
+struct bench_registrar
+{
+	bench_registrar(const char *const name, const bench_function function)
+	{
+		bench_get_cases().push_back({name, function});
+	}
+};
+
+/* Keep the compiler from discarding a result which is never used */
+template <typename T>
+static inline void bench_keep(const T &t)
+{
+	asm volatile("" : : "r,m"(t) : "memory");
+}
+
+}
+
+#define DXX_BENCHMARK(NAME)	\
+	static void dxx_bench_##NAME(uint64_t);	\
+	static const ::dcx::bench_registrar dxx_bench_registrar_##NAME{#NAME, dxx_bench_##NAME};	\
+	static void dxx_bench_##NAME(const uint64_t iterations)
@@ -0,0 +1,56 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * Benchmarks of the bitmap name table in hash.cpp
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "hash.h"
+#include "bench.h"
+
+namespace {
+
+using namespace dcx;
+
+/* About as many names as the D2 pig file, in the form of its names */
+struct name_table
+{
+	std::vector<std::string> names, missing;
+	hashtable ht;
+	name_table()
+	{
+		char buf[16];
+		for (int i = 0; i != 2600; ++i)
+		{
+			std::snprintf(buf, sizeof(buf), i % 3 ? "rbot%03i" : "Eye%02i#%i", i, i % 7);
+			names.emplace_back(buf);
+			std::snprintf(buf, sizeof(buf), "miss%04i", i);
+			missing.emplace_back(buf);
+		}
+		for (std::size_t i = 0; i != names.size(); ++i)
+			hashtable_insert(&ht, names[i].c_str(), i);
+	}
+};
+
+name_table table;
+
+}
+
+DXX_BENCHMARK(hashtable_search_hit)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(hashtable_search(&table.ht, table.names[i % table.names.size()].c_str()));
+}
+
+DXX_BENCHMARK(hashtable_search_miss)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(hashtable_search(&table.ht, table.missing[i % table.missing.size()].c_str()));
+}
@@ -0,0 +1,127 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * Usage: bench-common [--filter=<substring>] [--json=<file>]
+ *
+ * Runs every benchmark whose name contains the filter, prints a table to
+ * stderr, and writes the JSON report to the file, or to stdout.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include "bench.h"
+
+namespace dcx {
+
+std::vector<bench_case> &bench_get_cases()
+{
+	static std::vector<bench_case> cases;
+	return cases;
+}
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+struct bench_result
+{
+	const char *name;
+	uint64_t iterations;
+	double ns_per_iteration;
+};
+
+double bench_time_ns(const bench_function f, const uint64_t iterations)
+{
+	const auto start{bench_clock::now()};
+	f(iterations);
+	return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+}
+
+bench_result bench_run(const bench_case &c)
+{
+	/* Double the count until one run takes at least 10ms, then scale it
+	 * to about 100ms per repetition.
+	 */
+	constexpr double min_ns{10e6}, target_ns{100e6};
+	constexpr unsigned repetitions{3};
+	uint64_t iterations{1};
+	double ns;
+	while ((ns = bench_time_ns(c.function, iterations)) < min_ns && iterations < (uint64_t{1} << 40))
+		iterations *= 2;
+	iterations = std::max<uint64_t>(1, static_cast<uint64_t>(iterations * (target_ns / std::max(ns, 1.))));
+	double best{bench_time_ns(c.function, iterations)};
+	for (unsigned i = 1; i != repetitions; ++i)
+		best = std::min(best, bench_time_ns(c.function, iterations));
+	return {c.name, iterations, best / iterations};
+}
+
+void bench_write_json(FILE *const f, const char *const executable, const std::vector<bench_result> &results)
+{
+	char date[32]{};
+	const std::time_t now{std::time(nullptr)};
+	if (const auto tm{std::localtime(&now)})
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", tm);
+	std::fprintf(f, "{\n  \"context\": {\n    \"date\": \"%s\",\n    \"executable\": \"%s\",\n    \"num_cpus\": %u\n  },\n  \"benchmarks\": [", date, executable, std::thread::hardware_concurrency());
+	const char *separator{""};
+	for (auto &r : results)
+	{
+		std::fprintf(f, "%s\n    {\n      \"name\": \"%s\",\n      \"iterations\": %llu,\n      \"real_time\": %.3f,\n      \"cpu_time\": %.3f,\n      \"time_unit\": \"ns\"\n    }", separator, r.name, static_cast<unsigned long long>(r.iterations), r.ns_per_iteration, r.ns_per_iteration);
+		separator = ",";
+	}
+	std::fputs("\n  ]\n}\n", f);
+}
+
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	using namespace dcx;
+	const char *filter{""};
+	const char *json{nullptr};
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *const a{argv[i]};
+		if (!std::strncmp(a, "--filter=", 9))
+			filter = a + 9;
+		else if (!std::strncmp(a, "--json=", 7))
+			json = a + 7;
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--filter=<substring>] [--json=<file>]\n", argv[0]);
+			return 2;
+		}
+	}
+	auto cases{bench_get_cases()};
+	std::sort(cases.begin(), cases.end(), [](const bench_case &a, const bench_case &b) { return std::strcmp(a.name, b.name) < 0; });
+	std::vector<bench_result> results;
+	for (auto &c : cases)
+	{
+		if (!std::strstr(c.name, filter))
+			continue;
+		const auto &r{results.emplace_back(bench_run(c))};
+		std::fprintf(stderr, "%-32s %12.2f ns %14llu iterations\n", r.name, r.ns_per_iteration, static_cast<unsigned long long>(r.iterations));
+	}
+	FILE *const f{json ? std::fopen(json, "w") : stdout};
+	if (!f)
+	{
+		std::fprintf(stderr, "%s: failed to open \"%s\": %s\n", argv[0], json, std::strerror(errno));
+		return 1;
+	}
+	bench_write_json(f, argv[0], results);
+	if (f != stdout)
+		std::fclose(f);
+	return 0;
+}
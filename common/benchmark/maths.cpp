@@ -0,0 +1,152 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * Benchmarks of the fixed point and vector math in fixc.cpp and
+ * vecmat.cpp
+ */
+
+#include <array>
+#include <random>
+#include "maths.h"
+#include "vecmat.h"
+#include "bench.h"
+
+namespace {
+
+using namespace dcx;
+
+/* Enough inputs that the loop does not learn one branch pattern, few
+ * enough that they stay in the L1 cache.
+ */
+constexpr std::size_t input_count{256};
+
+struct bench_inputs
+{
+	std::array<fix, input_count> a, b, c;
+	std::array<quadint, input_count> q;
+	std::array<vms_vector, input_count> v;
+	std::array<vms_matrix, input_count> m;
+	bench_inputs()
+	{
+		std::minstd_rand rng{12345};
+		std::uniform_int_distribution<fix> any(-F1_0 * 1000, F1_0 * 1000), positive(F1_0 / 16, F1_0 * 1000);
+		for (std::size_t i = 0; i != input_count; ++i)
+		{
+			a[i] = any(rng);
+			b[i] = positive(rng);
+			c[i] = positive(rng);
+			q[i] = quadint{int64_t{positive(rng)} * positive(rng)};
+			v[i] = {any(rng), any(rng), any(rng)};
+			/* A rotation built from three angles, as the game builds them */
+			const vms_angvec angles{static_cast<fixang>(rng()), static_cast<fixang>(rng()), static_cast<fixang>(rng())};
+			m[i] = vm_angles_2_matrix(angles);
+		}
+	}
+};
+
+const bench_inputs inputs;
+
+}
+
+DXX_BENCHMARK(fixdiv)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(fixdiv(inputs.a[i % input_count], inputs.b[i % input_count]));
+}
+
+DXX_BENCHMARK(fixmuldiv)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(fixmuldiv(inputs.a[i % input_count], inputs.b[i % input_count], inputs.c[i % input_count]));
+}
+
+DXX_BENCHMARK(quad_sqrt)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(quad_sqrt(inputs.q[i % input_count]));
+}
+
+DXX_BENCHMARK(vm_vec_normalize)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+	{
+		auto v{inputs.v[i % input_count]};
+		bench_keep(vm_vec_normalize(v));
+		bench_keep(v);
+	}
+}
+
+DXX_BENCHMARK(vm_vec_normalize_quick)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+	{
+		auto v{inputs.v[i % input_count]};
+		bench_keep(vm_vec_normalize_quick(v));
+		bench_keep(v);
+	}
+}
+
+DXX_BENCHMARK(vm_vec_build_dot)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(vm_vec_build_dot(inputs.v[i % input_count], inputs.v[(i + 1) % input_count]));
+}
+
+DXX_BENCHMARK(vm_vec_build_dot_reference)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(vm_vec_build_dot_reference(inputs.v[i % input_count], inputs.v[(i + 1) % input_count]));
+}
+
+DXX_BENCHMARK(vm_vec_cross)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(vm_vec_cross(inputs.v[i % input_count], inputs.v[(i + 1) % input_count]));
+}
+
+DXX_BENCHMARK(vm_vec_cross_reference)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(vm_vec_cross_reference(inputs.v[i % input_count], inputs.v[(i + 1) % input_count]));
+}
+
+DXX_BENCHMARK(vm_vec_rotate)
+{
+	vms_vector r;
+	for (uint64_t i = 0; i != iterations; ++i)
+	{
+		vm_vec_rotate(r, inputs.v[i % input_count], inputs.m[(i + 1) % input_count]);
+		bench_keep(r);
+	}
+}
+
+DXX_BENCHMARK(vm_matrix_x_matrix)
+{
+	vms_matrix r;
+	for (uint64_t i = 0; i != iterations; ++i)
+	{
+		vm_matrix_x_matrix(r, inputs.m[i % input_count], inputs.m[(i + 1) % input_count]);
+		bench_keep(r);
+	}
+}
+
+DXX_BENCHMARK(vm_vec_rotate_reference)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+		bench_keep(vm_vec_build_rotated_reference(inputs.v[i % input_count], inputs.m[(i + 1) % input_count]));
+}
+
+DXX_BENCHMARK(vm_matrix_x_matrix_reference)
+{
+	vms_matrix r;
+	for (uint64_t i = 0; i != iterations; ++i)
+	{
+		_vm_matrix_x_matrix_reference(r, inputs.m[i % input_count], inputs.m[(i + 1) % input_count]);
+		bench_keep(r);
+	}
+}
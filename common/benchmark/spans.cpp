@@ -0,0 +1,202 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * Benchmarks of the pixel kernels of the RLE decoder and the software
+ * texture mapper
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "rle_span.h"
+#include "tmap_span.h"
+#include "bench.h"
+
+namespace {
+
+using namespace dcx;
+
+constexpr std::size_t row_width{320};
+constexpr uint8_t rle_code{0xe0}, not_rle_code{0x1f};
+
+/* A row of a 320 wide bitmap, encoded as the RLE encoder would: runs of
+ * 2 or more equal pixels become a code and a pixel, and pixels which look
+ * like codes are escaped as runs of 1.
+ */
+struct rle_row
+{
+	std::vector<uint8_t> encoded;
+	rle_row()
+	{
+		std::minstd_rand rng{12345};
+		std::array<uint8_t, row_width> pixels;
+		for (std::size_t i = 0; i != row_width;)
+		{
+			/* Mostly short literals, with a few long runs of one colour */
+			const uint8_t c = rng();
+			const std::size_t n = std::min<std::size_t>(row_width - i, rng() % 4 ? 1 : 2 + rng() % 24);
+			std::fill_n(pixels.begin() + i, n, c);
+			i += n;
+		}
+		for (std::size_t i = 0; i != row_width;)
+		{
+			const auto c = pixels[i];
+			std::size_t n = 1;
+			while (i + n != row_width && pixels[i + n] == c && n < not_rle_code)
+				++n;
+			if (n > 1 || (c & rle_code) == rle_code)
+			{
+				encoded.push_back(rle_code | n);
+				encoded.push_back(c);
+			}
+			else
+				encoded.push_back(c);
+			i += n;
+		}
+		encoded.push_back(rle_code);
+	}
+};
+
+/* The row loop of gr_rle_decode */
+uint8_t *rle_expand(const uint8_t *sb, const uint8_t *const se, uint8_t *db, uint8_t *const de)
+{
+	for (; sb != se;)
+	{
+		const auto p{gr_rle_find_code(sb, se)};
+		if (p == se)
+			return db;
+		const std::size_t count{std::size_t{*p} & not_rle_code};
+		const std::size_t cn{std::min<std::size_t>(p - sb, de - db)};
+		std::memcpy(db, sb, cn);
+		db += cn;
+		if (!count)
+			break;
+		sb += cn;
+		if (sb == se || db == de || count > static_cast<std::size_t>(de - db))
+			break;
+		if (++sb == se)
+			break;
+		std::fill_n(db, count, *sb++);
+		db += count;
+	}
+	return db;
+}
+
+const rle_row row;
+
+struct span_inputs
+{
+	std::array<uint8_t, 64 * 64> pixels;
+	std::array<uint8_t, 128 * 256> fade;
+	std::array<uint8_t, row_width> masked_src;
+	std::array<uint8_t, row_width> dest;
+	span_inputs()
+	{
+		std::minstd_rand rng{12345};
+		for (auto &p : pixels)
+			p = rng();
+		for (auto &f : fade)
+			f = rng();
+		/* A sprite row: about a third transparent */
+		for (auto &p : masked_src)
+			p = rng() % 3 ? static_cast<uint8_t>(rng() % 255) : 255;
+	}
+	/* A span across most of a 320 wide screen, as a wall close to the
+	 * viewer would draw
+	 */
+	tmap_span span(const bool transparent)
+	{
+		return {
+			.dest = dest.data(),
+			.pixels = pixels.data(),
+			.fade = fade.data(),
+			.count = 256,
+			.transparent = transparent,
+			.color = 0,
+			.u = F1_0 * 3,
+			.v = F1_0 * 5 * 64,
+			.z = F1_0 * 4,
+			.l = 0x1000,
+			.dudx = F1_0 / 5,
+			.dvdx = (F1_0 / 7) * 64,
+			.dzdx = F1_0 / 1024,
+			.dldx = 8,
+		};
+	}
+};
+
+span_inputs spans;
+
+template <void (&kernel)(const tmap_span &)>
+void bench_tmap_span(const uint64_t iterations, const bool transparent)
+{
+	const auto s{spans.span(transparent)};
+	for (uint64_t i = 0; i != iterations; ++i)
+	{
+		kernel(s);
+		bench_keep(spans.dest);
+	}
+}
+
+}
+
+DXX_BENCHMARK(rle_expand_row)
+{
+	std::array<uint8_t, row_width> out;
+	const auto b{row.encoded.data()}, e{b + row.encoded.size()};
+	for (uint64_t i = 0; i != iterations; ++i)
+	{
+		bench_keep(rle_expand(b, e, out.data(), out.data() + out.size()));
+		bench_keep(out);
+	}
+}
+
+DXX_BENCHMARK(gr_copy_masked)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+	{
+		gr_copy_masked(spans.dest.data(), spans.masked_src.data(), row_width);
+		bench_keep(spans.dest);
+	}
+}
+
+DXX_BENCHMARK(gr_copy_masked_reference)
+{
+	for (uint64_t i = 0; i != iterations; ++i)
+	{
+		gr_copy_masked_reference(spans.dest.data(), spans.masked_src.data(), row_width);
+		bench_keep(spans.dest);
+	}
+}
+
+DXX_BENCHMARK(tmap_span_lin)
+{
+	bench_tmap_span<tmap_span_lin>(iterations, false);
+}
+
+DXX_BENCHMARK(tmap_span_lin_reference)
+{
+	bench_tmap_span<tmap_span_lin_reference>(iterations, false);
+}
+
+DXX_BENCHMARK(tmap_span_per)
+{
+	bench_tmap_span<tmap_span_per>(iterations, false);
+}
+
+DXX_BENCHMARK(tmap_span_per_reference)
+{
+	bench_tmap_span<tmap_span_per_reference>(iterations, false);
+}
+
+DXX_BENCHMARK(tmap_span_per_transparent)
+{
+	bench_tmap_span<tmap_span_per>(iterations, true);
+}
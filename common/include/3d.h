@@ -205,6 +205,30 @@ void g3_stereo_frame(const int xeye, const int xoff);
 //set view from x,y,z, viewer matrix, and zoom.  Must call one of g3_set_view_*() 
 void g3_set_view_matrix(const vms_vector &view_pos,const vms_matrix &view_matrix,fix zoom);
 
+//move the view, keeping its orientation and zoom
+void g3_set_view_position(const vms_vector &view_pos);
+
+#if DXX_USE_STEREOSCOPIC_RENDER
+//the point that both eyes of a stereo view can find the visible segments
+//from: between the eyes, for a view whose eye is eye_offset to the right
+//of the middle, and far enough behind them that its view holds both of
+//theirs
+[[nodiscard]]
+vms_vector g3_stereo_visibility_position(fix eye_offset);
+#endif
+
+//everything the current view projects points with, so callers can tell
+//whether two frames see the world the same way
+struct g3_view_state
+{
+	vms_vector position, rvec, uvec, fvec;
+	fix canv_w2, canv_h2;
+	constexpr bool operator==(const g3_view_state &) const = default;
+};
+
+[[nodiscard]]
+g3_view_state g3_get_view_state();
+
 //end the frame
 #if DXX_USE_OGL
 #define g3_end_frame() ogl_end_frame()
@@ -227,6 +251,13 @@ g3_instance_context g3_start_instance_angles(const vms_vector &pos, const vms_an
 //pops the old context
 void g3_done_instance(const g3_instance_context &);
 
+#if DXX_USE_OGL
+//the transform from the current instance's space to GL eye space, as
+//Gl_view_matrix is for the world.  Points in that space need not be
+//rotated when GL applies this.
+void g3_get_gl_instance_matrix(std::array<float, 16> &);
+#endif
+
 //Misc utility functions:
 
 //returns true if a plane is facing the viewer. takes the unrotated surface 
@@ -242,6 +273,10 @@ namespace dcx {
 //rotates a point. returns codes.  does not check if already rotated
 clipping_code g3_rotate_point(g3s_point &dest,const vms_vector &src);
 
+//rotates each point of src into the same element of dest, exactly as
+//g3_rotate_point would, several at a time.  dest must be at least as long
+void g3_rotate_points(std::span<const vms_vector> src, std::span<g3s_point> dest);
+
 [[nodiscard]]
 static inline g3s_point g3_rotate_point(const vms_vector &src)
 {
@@ -252,6 +287,23 @@ static inline g3s_point g3_rotate_point(const vms_vector &src)
 //projects a point
 void g3_project_point(g3s_point &point);
 
+enum class g3_sphere_projection : uint8_t
+{
+	behind,		//wholly behind the eye
+	near,		//reaches so close to the eye that no bound is useful
+	bounded,	//the bounds were set
+};
+
+struct g3_screen_bounds
+{
+	int left, top, right, bot;
+};
+
+//finds a rectangle of the canvas that holds the projection of a sphere.
+//It may be larger than the projection, but never misses any of it.
+[[nodiscard]]
+g3_sphere_projection g3_project_sphere_bounds(const vms_vector &pos, fix rad, g3_screen_bounds &bounds);
+
 //calculate the depth of a point - returns the z coord of the rotated point
 [[nodiscard]]
 fix g3_calc_point_depth(const vms_vector &pnt, const vms_vector &View_position, const vms_vector &View_matrix_f);
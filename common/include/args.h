@@ -76,8 +76,11 @@ struct CArg : prohibit_void_ptr<CArg>
 	bool DbgSafelog;
 	bool SysShowCmdHelp;
 	bool SysLowMem;
+	bool SysPortalVisibility;
+	bool SysLevelCache;
 	int8_t SysUsePlayersDir;
 	bool SysAutoRecordDemo;
+	bool SysCompressDemo;
 	bool SysWindow;
 	bool SysAutoDemo;
 	bool GfxSkipHiresFNT;
@@ -85,9 +88,19 @@ struct CArg : prohibit_void_ptr<CArg>
 	bool SndNoMusic;
 	bool SysNoBorders;
 	bool SysNoTitles;
+#if DXX_USE_OGL
+	static constexpr std::false_type SysHeadless{};
+#else
+	/* Run with SDL's dummy video and audio drivers, and do not draw the
+	 * game
+	 */
+	bool SysHeadless;
+#endif
 #if DXX_USE_SDLMIXER
 	bool SndDisableSdlMixer;
 	digi_mixer_method SndMixerMethod;
+	/* Samples per channel in each SDL_mixer buffer, or 0 for the default */
+	uint16_t SndBufferSize;
 #else
 	static constexpr std::true_type SndDisableSdlMixer{};
 #endif
@@ -100,12 +113,26 @@ struct CArg : prohibit_void_ptr<CArg>
 	bool OglFixedFont;
 	SyncGLMethod OglSyncMethod;
 	bool OglDarkEdges;
+	bool OglStaticGeometry;
+	bool OglStreamBuffer;
+	bool OglFrontToBack;
+	bool OglModelMatrix;
+	unsigned OglInsetScale;
+	unsigned OglInsetRate;
+	unsigned OglTextureBudget;
+	bool OglTextureCache;
 	bool DbgUseOldTextureMerge;
 	bool DbgGlIntensity4Ok;
 	bool DbgGlReadPixelsOk;
 	bool DbgGlGetTexLevelParamOk;
 	bool DbgGlLuminance4Alpha4Ok;
 	bool DbgGlRGBA2Ok;
+#if DXX_USE_VULKAN
+	bool OglVkArrayTextures;
+	int OglVkRecordThreads;
+	int OglVkDynResMin;
+	bool OglVkShaderLights;
+#endif
 #if DXX_USE_STEREOSCOPIC_RENDER
 	bool OglStereo;
 	uint8_t OglStereoView;
@@ -127,6 +154,12 @@ struct CArg : prohibit_void_ptr<CArg>
 	bool SysNoNiceFPS;
 	int SysMaxFPS;
 	int SysRenderZoomAdjustment;
+	unsigned SysRleCacheBudget;
+	unsigned SysBitmapCacheBudget;
+	unsigned SysTexMergeCacheBudget;
+	unsigned SysPhysicsTick;
+	unsigned SysAiBudget;
+	unsigned SysThreads;
 	uint16_t MplUdpHostPort;
 	uint16_t MplUdpMyPort;
 #if DXX_USE_TRACKER
@@ -136,11 +169,14 @@ struct CArg : prohibit_void_ptr<CArg>
 	std::string SysMissionDir;
 	std::string SysHogDir;
 	std::string SysPilot;
+	std::string SysAutoExec;
 	std::string SysRecordDemoNameTemplate;
+	std::string SysTimeDemo;
 	std::string MplUdpHostAddr;
 	std::string DbgAltTex;
 #if !DXX_USE_OGL
 	std::string DbgTexMap;
+	int DbgTexMapThreads;
 #endif
 };
 extern CArg CGameArg;
@@ -0,0 +1,159 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Placement of paged in bitmaps in a fixed buffer.  Bitmaps are laid out
+ * one after another from a cursor that wraps at the end of the buffer.
+ * When the next bitmap does not fit, the entries in its way are
+ * reclaimed in the order they were placed: an entry used since it was
+ * last reached is moved down to the cursor and kept, and any other is
+ * evicted.  This is the clock approximation of least recently used, and
+ * only the bitmaps that went cold are paged out.
+ *
+ * The ring does not know what the entries are.  The caller passes a
+ * policy to reserve(), which is asked about each entry in the way:
+ *
+ *	void before_reclaim();
+ *		Called once, before the first entry is reclaimed.
+ *	bitmap_cache_ring_use use(const bitmap_cache_ring::entry &);
+ *		Whether the entry was used since it was last reached, and
+ *		forget that it was, so that it is evicted when next reached
+ *		unless it is used again.  `stale` if the entry no longer
+ *		holds its bitmap, which is then dropped silently.
+ *	void evict(const bitmap_cache_ring::entry &);
+ *	void moved(const bitmap_cache_ring::entry &);
+ *		The entry's data now starts at its new offset.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+
+namespace dcx {
+
+enum class bitmap_cache_ring_use : uint8_t
+{
+	stale,
+	cold,
+	hot,
+};
+
+class bitmap_cache_ring
+{
+public:
+	struct entry
+	{
+		uint32_t offset, length;
+		uint16_t id;
+	};
+	struct stats
+	{
+		std::size_t entries, evictions, relocations;
+	};
+private:
+	/* In ring order starting from the cursor, so the front is the next
+	 * entry in the way
+	 */
+	std::deque<entry> resident;
+	uint8_t *base{};
+	std::size_t capacity{}, cursor{};
+	std::size_t evictions{}, relocations{};
+public:
+	/* Use `size` bytes at `b`, which hold nothing yet */
+	void reset(uint8_t *b, std::size_t size);
+	/* Forget every entry, for when the caller paged them all out */
+	void clear();
+	/* Whether reserve(n) would find n free bytes without reclaiming */
+	bool fits_without_reclaim(std::size_t n) const;
+	/* Make n bytes at the cursor free, and return them.  Returns nullptr
+	 * only if n is larger than the whole buffer.  The caller then writes
+	 * the bitmap and calls commit(), before the next reserve().
+	 */
+	template <typename Policy>
+		uint8_t *reserve(std::size_t n, Policy &&policy);
+	/* Record that the last reserve() now holds `length` bytes of `id`.
+	 * `length` may be less than was reserved.
+	 */
+	void commit(uint16_t id, std::size_t length);
+	uint8_t *data(const entry &e) const
+	{
+		return base + e.offset;
+	}
+	std::size_t size() const
+	{
+		return capacity;
+	}
+	stats get_stats() const;
+};
+
+template <typename Policy>
+uint8_t *bitmap_cache_ring::reserve(const std::size_t n, Policy &&policy)
+{
+	if (n > capacity)
+		return nullptr;
+	bool reclaimed{};
+	for (;;)
+	{
+		const bool wrap{cursor + n > capacity};
+		if (resident.empty())
+		{
+			if (wrap)
+				cursor = 0;
+			return base + cursor;
+		}
+		const auto f{resident.front()};
+		if (f.offset < cursor)
+		{
+			/* Nothing lies between the cursor and the end */
+			if (!wrap)
+				return base + cursor;
+			cursor = 0;
+			continue;
+		}
+		if (!wrap && f.offset >= cursor + n)
+			return base + cursor;
+		resident.pop_front();
+		if (!reclaimed)
+		{
+			reclaimed = true;
+			policy.before_reclaim();
+		}
+		switch (policy.use(f))
+		{
+			case bitmap_cache_ring_use::stale:
+				break;
+			case bitmap_cache_ring_use::cold:
+				policy.evict(f);
+				++evictions;
+				break;
+			case bitmap_cache_ring_use::hot:
+				if (wrap)
+					/* It lies past the last place this bitmap could
+					 * go in this lap, so it stays where it is, to be
+					 * reached again at the end of the next lap.
+					 */
+					resident.push_back(f);
+				else
+				{
+					const entry moved{static_cast<uint32_t>(cursor), f.length, f.id};
+					if (moved.offset != f.offset)
+					{
+						std::memmove(base + moved.offset, base + f.offset, f.length);
+						policy.moved(moved);
+						++relocations;
+					}
+					cursor += f.length;
+					resident.push_back(moved);
+				}
+				break;
+		}
+	}
+}
+
+}
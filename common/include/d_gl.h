@@ -22,6 +22,12 @@ typedef unsigned char GLubyte;
 typedef signed char GLbyte;
 #define GL_REPEAT 0x2901
 #define GL_CLAMP_TO_EDGE 0x812F
+// Texel formats, for the palette expansion shared with OpenGL
+#define GL_COLOR_INDEX 0x1900
+#define GL_RGB 0x1907
+#define GL_RGBA 0x1908
+#define GL_LUMINANCE 0x1909
+#define GL_LUMINANCE_ALPHA 0x190A
 #else
 #ifdef _WIN32
 #include "loadgl.h"
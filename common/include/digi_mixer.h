@@ -67,9 +67,11 @@ void digi_mixer_end_sound(sound_channel);
 void digi_mixer_set_digi_volume(int);
 int digi_mixer_is_channel_playing(sound_channel);
 void digi_mixer_stop_all_channels();
+void digi_mixer_flush();
 int digi_mixer_init();
 }
 namespace dsx {
 sound_channel digi_mixer_start_sound(sound_effect, fix, sound_pan, int, int, int, sound_object *);
+void digi_mixer_convert_sounds();
 }
 #endif
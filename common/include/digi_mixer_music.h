@@ -17,6 +17,10 @@ namespace dcx {
 
 int mix_play_music(const char *, int);
 int mix_play_file(const char *, int, void (*)());
+/* Start converting an HMP file on a worker thread, so that a later
+ * mix_play_file of the same file does not need to wait for it.
+ */
+void mix_prefetch_file(const char *);
 void mix_set_music_volume(int);
 void mix_stop_music();
 void mix_pause_music();
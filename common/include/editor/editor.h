@@ -268,6 +268,23 @@ extern   int medlisp_update_screen();
 namespace dsx {
 extern	int create_new_mine(void);
 
+/* How generate_benchmark_mine grows a mine.  The chances are percents. */
+struct benchmark_mine_parameters
+{
+	unsigned segments;
+	unsigned branching;	// chance to grow from any segment instead of the newest
+	unsigned doors;		// chance for each connection to get a door
+	unsigned lights;	// chance for each segment to get a light on a wall
+	unsigned robots;	// chance for each segment to get a robot
+	unsigned seed;
+};
+
+/* Replace the mine with one grown at random from cubes, and save it as
+ * `filename` with a mission that holds it, for measuring how the game
+ * scales with the size of a level.  Returns 0 on success.
+ */
+int generate_benchmark_mine(const benchmark_mine_parameters &p, const char *filename);
+
 }
 #endif
 #ifdef DXX_BUILD_DESCENT
@@ -457,6 +474,9 @@ int save_mine_data_compiled(PHYSFS_File *SaveFile);
 }
 #endif
 void editor_status( const char *text);
+//	Show a status message now, with how far along a long job is, rather
+//	than when the editor is next drawn.
+void editor_status_progress(const char *text, std::size_t done, std::size_t total);
 
 extern int MacroNumEvents;
 extern int MacroStatus;
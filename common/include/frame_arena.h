@@ -0,0 +1,97 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Scratch memory for data which lives no longer than one rendered view.
+ * Allocation moves a pointer, deallocation does nothing, and the whole
+ * arena is reset at once by frame_arena_next_frame, which render_start_frame
+ * calls.
+ *
+ * There are two arenas, used in turn, so that whatever was allocated
+ * before a reset is still valid until the reset after it.  A view drawn
+ * inside another may therefore reset the arena without freeing the outer
+ * view's data.
+ *
+ * The arenas are not locked.  Only one thread at a time may use them,
+ * as the object list worker of render_mine does while the main thread
+ * waits for it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dcx {
+
+class frame_arena
+{
+	struct block;
+	block *head{};
+	std::size_t used_total{}, high_water{};
+	std::byte *cursor{}, *limit{};
+	void *allocate_slow(std::size_t size, std::size_t align);
+	void free_blocks();
+public:
+	frame_arena() = default;
+	frame_arena(const frame_arena &) = delete;
+	frame_arena &operator=(const frame_arena &) = delete;
+	~frame_arena();
+	void *allocate(const std::size_t size, const std::size_t align)
+	{
+		const auto p{reinterpret_cast<std::byte *>((reinterpret_cast<std::uintptr_t>(cursor) + align - 1) & ~(std::uintptr_t{align} - 1))};
+		if (p && static_cast<std::size_t>(limit - p) >= size)
+		{
+			cursor = p + size;
+			return p;
+		}
+		return allocate_slow(size, align);
+	}
+	/* Forget every allocation.  If the last use needed more than one block,
+	 * they are replaced by one block big enough for all of it, so a steady
+	 * load settles on a single block.
+	 */
+	void reset();
+	/* The most the arena held between two resets */
+	std::size_t peak() const
+	{
+		return high_water;
+	}
+};
+
+void *frame_arena_allocate(std::size_t size, std::size_t align);
+
+/* Switch to the other arena and reset it */
+void frame_arena_next_frame();
+
+/* A standard allocator over the current frame arena.  It has no state,
+ * so containers using it may be moved and swapped freely, but they must
+ * not outlive the frame.
+ */
+template <typename T>
+struct frame_arena_allocator
+{
+	using value_type = T;
+	frame_arena_allocator() = default;
+	template <typename U>
+		constexpr frame_arena_allocator(const frame_arena_allocator<U> &)
+		{
+		}
+	T *allocate(const std::size_t n)
+	{
+		return static_cast<T *>(frame_arena_allocate(n * sizeof(T), alignof(T)));
+	}
+	void deallocate(T *, std::size_t)
+	{
+	}
+	template <typename U>
+		constexpr bool operator==(const frame_arena_allocator<U> &) const
+		{
+			return true;
+		}
+};
+
+}
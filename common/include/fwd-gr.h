@@ -135,6 +135,14 @@ struct grs_font;
 uint_fast32_t gr_list_modes(std::array<screen_mode, 50> &modes);
 #elif SDL_MAJOR_VERSION == 2
 extern SDL_Window *g_pRebirthSDLMainWindow;
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+/* SDL replaced the GL context, as Android does after the system destroyed
+ * it in the background.  Set up the new context as gr_set_mode would.
+ * Textures from -gl_texcache are uploaded again a few each frame, and the
+ * others are loaded when next drawn.
+ */
+void gr_context_reset();
+#endif
 #endif
 
 }
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <span>
 #include "maths.h"
 #include "dxxsconf.h"
 #include "dsx-ns.h"
@@ -62,6 +63,12 @@ vm_magnitude vm_vec_copy_normalize(vms_vector &dest, const vms_vector &src);
 
 vm_magnitude vm_vec_normalize(vms_vector &v);
 
+/* Normalize every vector of `vs`.  This gives the same results as calling
+ * vm_vec_normalize on each, but the loop lets the square roots and
+ * divisions of neighbouring vectors overlap.
+ */
+void vm_vec_normalize_batch(std::span<vms_vector> vs);
+
 vm_magnitude vm_vec_copy_normalize_quick(vms_vector &dest, const vms_vector &src);
 
 vm_magnitude vm_vec_normalize_quick(vms_vector &v);
@@ -95,6 +102,17 @@ void vm_vec_rotate (vms_vector &dest, const vms_vector &src, const vms_matrix &m
 [[nodiscard]]
 vms_vector vm_vec_build_rotated(const vms_vector &src, const vms_matrix &m);
 void _vm_matrix_x_matrix (vms_matrix &dest, const vms_matrix &src0, const vms_matrix &src1);
+
+/* The plain versions of these use NEON when the target has it, and
+ * return the same bits as the scalar _reference versions.
+ */
+[[nodiscard]]
+fix vm_vec_build_dot_reference(const vms_vector &v0, const vms_vector &v1);
+[[nodiscard]]
+vms_vector vm_vec_cross_reference(const vms_vector &src0, const vms_vector &src1);
+[[nodiscard]]
+vms_vector vm_vec_build_rotated_reference(const vms_vector &src, const vms_matrix &m);
+void _vm_matrix_x_matrix_reference(vms_matrix &dest, const vms_matrix &src0, const vms_matrix &src1);
 [[nodiscard]]
 vms_angvec vm_extract_angles_matrix(const vms_matrix &m);
 [[nodiscard]]
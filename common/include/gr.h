@@ -329,6 +329,18 @@ struct grs_font : public prohibit_void_ptr<grs_font>
 	const uint16_t *ft_widths = nullptr;     // Array of widths (required for prop font)
 	const uint8_t *ft_kerndata = nullptr;    // Array of kerning triplet data
 	std::unique_ptr<uint8_t[]> ft_allocdata;
+	/* The spacing of each kerned pair of characters, indexed by
+	 * first * (ft_maxchar - ft_minchar + 1) + second, or -1 if the pair
+	 * is not kerned.  Built from ft_kerndata when the font is loaded.
+	 */
+	std::unique_ptr<int16_t[]> ft_kerntable;
+	/* For a color font, the palette its file is drawn in, and the map from
+	 * that palette to the game palette that ft_data was remapped with.
+	 * Remapping to a palette that gives the same map changes nothing, so
+	 * the font is kept as is.
+	 */
+	palette_array_t ft_palette;
+	std::array<color_palette_index, 256> ft_colormap;
 #if DXX_USE_OGL
 	// These fields do not participate in disk i/o!
 	std::unique_ptr<grs_bitmap[]> ft_bitmaps;
@@ -20,17 +20,32 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 #pragma once
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace dcx {
 
+/* Maps names to numbers, ignoring case.  The table stores the key
+ * pointers, not copies of the names, so each name must outlive the
+ * table.  Inserting a name already present keeps the first value.
+ *
+ * Slots are probed linearly, and each keeps the case-folded hash of its
+ * name, so that a probe only compares names whose hashes match.
+ */
 struct hashtable
 {
-	struct compare_t
+	struct slot
 	{
-		bool operator()(const char *l, const char *r) const;
+		const char *key;
+		uint32_t hash;
+		int value;
 	};
-	std::map<const char *, int, compare_t> m;
+	/* A power of two in size, at most half full.  Empty slots have a
+	 * null key.
+	 */
+	std::vector<slot> slots;
+	std::size_t count{};
 };
 
 int hashtable_search( hashtable *ht, const char *key );
@@ -126,6 +126,8 @@ using hmpmid_result = std::tuple<std::vector<uint8_t>, hmp_open_error>;
 
 hmp_open_result hmp_open(const char *filename);
 hmpmid_result hmp2mid(const char *hmp_name);
+/* Convert an opened file.  This never prints, so it can run on any thread. */
+std::vector<uint8_t> hmp2mid(const hmp_file &hmp);
 #ifdef _WIN32
 void hmp_setvolume(hmp_file *hmp, int volume);
 int hmp_play(hmp_file *hmp, int bLoop);
@@ -80,9 +80,10 @@ iff_status_code iff_read_bitmap(const char *ifilename, grs_bitmap &bm, palette_a
 //returns iff error codes. max_bitmaps is size of array.
 iff_read_result iff_read_animbrush(const char *ifilename);
 
-// After a read
-extern ubyte iff_transparent_color;
-extern ubyte iff_has_transparency;	// 0=no transparency, 1=iff_transparent_color is valid
+// After a read on the same thread.  Each thread has its own, so that
+// files can be read side by side.
+extern thread_local ubyte iff_transparent_color;
+extern thread_local ubyte iff_has_transparency;	// 0=no transparency, 1=iff_transparent_color is valid
 
 int iff_write_bitmap(const char *ofilename,grs_bitmap *bm,palette_array_t *palette);
 	//writes an IFF file from a grs_bitmap structure. writes palette if not null
@@ -89,6 +89,16 @@ enum class PHYSFSX_case_search_result : int8_t
 [[nodiscard]]
 PHYSFSX_case_search_result PHYSFSEXT_locateCorrectCase(char *buf);
 
+/**
+ * \fn void PHYSFSEXT_invalidateCaseIndex()
+ * \brief Forget the directory listings kept by PHYSFSEXT_locateCorrectCase.
+ *
+ * Listings are dropped automatically when the search path or the write
+ *  directory changes.  Call this after adding or removing a file, so that
+ *  a name in another case finds it.
+ */
+void PHYSFSEXT_invalidateCaseIndex();
+
 /* end of ignorecase.h ... */
 
 }
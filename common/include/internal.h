@@ -17,6 +17,16 @@
 namespace dcx {
 void ogl_init_texture_list_internal(void);
 void ogl_smash_texture_list_internal(void);
+/* The context was replaced, and every GL object with it.  Forget them,
+ * and queue the textures that -gl_texcache can upload again.
+ */
+void ogl_lose_context_internal();
+/* Upload some of the textures queued by ogl_lose_context_internal */
+void ogl_restore_textures_internal();
+void ogl_init_stream();
+void ogl_close_stream();
+/* Pass on every queued ogl_read_screen, waiting for the GPU */
+void ogl_close_screen_reads();
 
 extern int linedotscale;
 
@@ -44,7 +54,7 @@ static constexpr GLfloat CPAL2Tb(const color_palette_index c)
 
 }
 
-#define OGL_SET_FEATURE_STATE(G,V,F)	static_cast<void>(G != V && (G = V, F, 0))
+#define OGL_SET_FEATURE_STATE(G,V,F)	static_cast<void>(G != V && (ogl_stream_flush(), G = V, F, 0))
 #define OGL_ENABLE(a)	OGL_SET_FEATURE_STATE(GL_##a##_enabled, 1, glEnable(GL_##a))
 #define OGL_DISABLE(a)	OGL_SET_FEATURE_STATE(GL_##a##_enabled, 0, glDisable(GL_##a))
 
@@ -60,6 +70,7 @@ static inline void OGL_VIEWPORT(const unsigned x, const unsigned y, const unsign
 {
 	if (w!=last_width || h!=last_height)
 	{
+		ogl_stream_flush();
 		last_width = w;
 		last_height = h;
 		glViewport(x,grd_curscreen->sc_canvas.cv_bitmap.bm_h-y-h,w,h);
@@ -25,6 +25,47 @@ namespace dcx {
 class submodel_angles;
 
 struct polygon_model_points : std::array<g3s_point, 1000> {};
+
+enum class polygon_model_draw_kind : uint8_t
+{
+	defpoints,
+	flatpoly,
+	tmappoly,
+	sortnorm,
+	rodbm,
+	subcall,
+	glow,
+};
+
+/* One record of a polygon model's interpreter data, decoded when the model
+ * is loaded.  The children of a sortnorm or subcall follow it in the list,
+ * so drawing walks ranges of the list instead of decoding the model data
+ * and following its offsets.  The pointers are into the model data.
+ */
+struct polygon_model_draw_op
+{
+	polygon_model_draw_kind kind;
+	/* defpoints: points defined; polygons: vertices */
+	uint16_t count;
+	/* defpoints: first point defined; flatpoly: color; tmappoly: texture;
+	 * subcall: submodel; glow: glow number
+	 */
+	uint16_t value;
+	/* Ops in the children that follow.  sortnorm has the children at its
+	 * first and second offsets, and subcall only the first.
+	 */
+	std::array<uint32_t, 2> children;
+	/* defpoints: the points; polygons and sortnorm: a point on the plane;
+	 * subcall: the offset of the submodel
+	 */
+	const vms_vector *point;
+	/* polygons and sortnorm: the normal of the plane */
+	const vms_vector *normal;
+	const int16_t *indices;
+	const g3s_uvl *uvls;
+	/* rodbm: the record, which it reads directly */
+	const uint8_t *record;
+};
 }
 
 #ifdef DXX_BUILD_DESCENT
@@ -42,6 +83,8 @@ struct glow_values_t : public std::array<fix, glow_array_size> {};
 //calls the object interpreter to render an object.  The object renderer
 //is really a seperate pipeline. returns true if drew
 void g3_draw_polygon_model(grs_bitmap *const *model_bitmaps, polygon_model_points &Interp_point_list, grs_canvas &, tmap_drawer_type tmap_drawer_ptr, submodel_angles anim_angles, g3s_lrgb model_light, const glow_values_t *glow_values, const uint8_t *p);
+//draws a model from its decoded draw list, as the interpreter would
+void g3_draw_polygon_model(grs_bitmap *const *model_bitmaps, polygon_model_points &Interp_point_list, grs_canvas &, tmap_drawer_type tmap_drawer_ptr, submodel_angles anim_angles, g3s_lrgb model_light, const glow_values_t *glow_values, std::span<const polygon_model_draw_op> ops);
 
 //init code for bitmap models
 int16_t g3_init_polygon_model(std::span<uint8_t> model);
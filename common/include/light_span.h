@@ -0,0 +1,47 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Dynamic light kernels.  The vertices are laid out as separate arrays of
+ * coordinates and of light, so the kernels can step several vertices at
+ * a time, and do not depend on the segment or object state.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include "maths.h"
+#include "vecmat.h"
+
+namespace dcx {
+
+struct light_span_vertices
+{
+	const fix *x, *y, *z;
+	/* Light added to each vertex */
+	fix *r, *g, *b;
+};
+
+struct light_span_source
+{
+	vms_vector pos;
+	fix r, g, b;
+	/* Vertices at a quick distance of range or more are not lit */
+	fix range;
+};
+
+/* For every vertex in [begin, end) nearer than range by
+ * vm_vec_dist_quick, add the light divided by the distance, which is
+ * clamped to at least MIN_LIGHT_DIST, as apply_light does with
+ * add_light_div.  The plain version processes 8 vertices at a time in
+ * vector registers, and is within one unit of the _reference version,
+ * which steps one vertex at a time.  For lights of the strength objects
+ * emit, the two are the same.
+ */
+void light_span_div(const light_span_source &light, const light_span_vertices &v, std::size_t begin, std::size_t end);
+void light_span_div_reference(const light_span_source &light, const light_span_vertices &v, std::size_t begin, std::size_t end);
+
+}
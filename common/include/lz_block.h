@@ -0,0 +1,41 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* A small LZ77 compressor in the style of the LZ4 block format, for data
+ * written by the game itself.  Each sequence is a token byte holding the
+ * literal count and the match length, the literals, then a 16-bit little
+ * endian distance back to the match.  The last sequence has literals
+ * only.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dcx {
+
+/* The most bytes that lz_block_compress can write for `size` input bytes */
+constexpr std::size_t lz_block_compress_bound(const std::size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+/* Compress `input` into `output`, which must hold at least
+ * lz_block_compress_bound(input.size()) bytes.  Returns the number of
+ * bytes written.
+ */
+std::size_t lz_block_compress(std::span<const uint8_t> input, std::span<uint8_t> output);
+
+/* Decompress `input` into `output`.  Returns false, leaving `output`
+ * unspecified, if `input` is malformed or does not decompress to exactly
+ * output.size() bytes.
+ */
+bool lz_block_decompress(std::span<const uint8_t> input, std::span<uint8_t> output);
+
+}
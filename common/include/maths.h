@@ -28,6 +28,10 @@ void d_srand (unsigned int seed);
 [[nodiscard]]
 int d_rand ();			// Random number function which returns in the range 0-0x7FFF
 
+/* A seed which, passed to d_srand, makes d_rand continue from here */
+[[nodiscard]]
+unsigned d_rand_state();
+
 
 //=============================== FIXED POINT ===============================
 
@@ -138,6 +142,19 @@ ushort long_sqrt (int32_t a);
 [[nodiscard]]
 uint32_t quad_sqrt (quadint);
 
+/* The plain versions return the integer nearest to the root.  The
+ * _reference versions are the original Newton loops, which stop wherever
+ * the iteration first repeats, so they may be one above or below the
+ * plain result.  They are kept for the accuracy test.
+ */
+[[gnu::const]]
+[[nodiscard]]
+ushort long_sqrt_reference(int32_t a);
+
+[[gnu::const]]
+[[nodiscard]]
+uint32_t quad_sqrt_reference(quadint);
+
 //computes the square root of a fix, returning a fix
 [[gnu::const]]
 [[nodiscard]]
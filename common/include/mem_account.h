@@ -0,0 +1,108 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Accounting of the large allocations, by what they hold, so that the
+ * caches can be sized for devices with little memory.  Each tag keeps
+ * the bytes currently held and the most ever held at once.  The owners
+ * of the memory report it; nothing here allocates or frees.
+ *
+ * The counters are atomic, so any thread may report.  The console
+ * command `mem` shows them, and the frame profile CSV records them.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace dcx {
+
+enum class mem_tag : uint8_t
+{
+	/* Texels uploaded to the renderer, as kept by ogl_texture_pool */
+	textures,
+	/* The pig bitmap cache */
+	bitmaps,
+	/* Sound samples as read from the pig or sound file */
+	sounds,
+	/* Sounds converted to the output format of SDL_mixer */
+	mixer_chunks,
+	/* Level data read from the mission: the mine while it is parsed,
+	 * and replacement bitmaps
+	 */
+	mission,
+	/* Buffers of the demo being recorded or played */
+	demo,
+	/* Device memory taken by the Vulkan allocator, including the memory
+	 * of the textures counted above
+	 */
+	vma,
+};
+
+constexpr std::size_t mem_tag_count{static_cast<std::size_t>(mem_tag::vma) + 1};
+
+struct mem_account_counters
+{
+	std::size_t current, peak;
+};
+
+void mem_account_add(mem_tag tag, std::size_t bytes);
+void mem_account_sub(mem_tag tag, std::size_t bytes);
+mem_account_counters mem_account_get(mem_tag tag);
+/* Set the peak of every tag to its current value */
+void mem_account_reset_peaks();
+const char *mem_tag_name(mem_tag tag);
+
+/* The size of one buffer, or group of buffers, counted under a tag.  The
+ * owner calls set() when the size changes, and the destructor takes the
+ * last size back out.
+ */
+class mem_account_tracked
+{
+	mem_tag tag;
+	std::size_t bytes;
+public:
+	explicit mem_account_tracked(const mem_tag t, const std::size_t b = 0) :
+		tag(t), bytes(b)
+	{
+		if (b)
+			mem_account_add(t, b);
+	}
+	mem_account_tracked(mem_account_tracked &&o) :
+		tag(o.tag), bytes(std::exchange(o.bytes, 0))
+	{
+	}
+	mem_account_tracked &operator=(mem_account_tracked &&o)
+	{
+		if (this != &o)
+		{
+			set(0);
+			tag = o.tag;
+			bytes = std::exchange(o.bytes, 0);
+		}
+		return *this;
+	}
+	~mem_account_tracked()
+	{
+		set(0);
+	}
+	void set(const std::size_t b)
+	{
+		if (b > bytes)
+			mem_account_add(tag, b - bytes);
+		else if (b < bytes)
+			mem_account_sub(tag, bytes - b);
+		bytes = b;
+	}
+	std::size_t size() const
+	{
+		return bytes;
+	}
+};
+
+}
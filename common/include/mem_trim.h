@@ -0,0 +1,56 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Caches that can give their memory back when the system runs short.
+ * Each cache registers a function that frees what it can do without,
+ * and returns how many bytes that was.  Whatever is freed must be built
+ * again when it is next used, so the caches are trimmed in order of how
+ * cheap that is.
+ *
+ * Android kills the processes in the background that hold the most
+ * memory first, so the event loop trims the cheap caches when the
+ * program goes to the background, and every cache when the system
+ * reports that memory is low.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dcx {
+
+/* What it takes to build a trimmed cache again, cheapest first */
+enum class mem_trim_cost : uint8_t
+{
+	/* Computed again from data that is still in memory */
+	convert,
+	/* Read again from the game data */
+	page_in,
+	/* Read again, and given to the renderer again */
+	upload,
+};
+
+enum class mem_trim_level : uint8_t
+{
+	/* The program went to the background; trim only what is cheap to
+	 * build again
+	 */
+	background,
+	/* The system is short of memory; trim everything */
+	critical,
+};
+
+/* Add a cache.  Registering the same function again does nothing, so
+ * an owner may register each time it is set up.  The function is called
+ * from the main thread.
+ */
+void mem_trim_register(mem_trim_cost cost, std::size_t (*trim)());
+/* Trim the caches that `level` allows, and return the bytes freed */
+std::size_t mem_trim(mem_trim_level level);
+
+}
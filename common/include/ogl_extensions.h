@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include "dxxsconf.h"
@@ -56,6 +57,86 @@ typedef void (APIENTRYP PFNGLWAITSYNCPROC) (GLsync sync, GLbitfield flags, GLuin
 #define GL_SYNC_GPU_COMMANDS_COMPLETE     0x9117
 #define GL_TIMEOUT_EXPIRED                0x911B
 
+/* GL_ARB_buffer_storage, with the buffer object functions it needs */
+#ifndef GL_VERSION_1_5
+typedef std::ptrdiff_t GLsizeiptr;
+typedef std::ptrdiff_t GLintptr;
+#define GL_ARRAY_BUFFER                   0x8892
+typedef void (APIENTRYP PFNGLBINDBUFFERPROC) (GLenum target, GLuint buffer);
+typedef void (APIENTRYP PFNGLDELETEBUFFERSPROC) (GLsizei n, const GLuint *buffers);
+typedef void (APIENTRYP PFNGLGENBUFFERSPROC) (GLsizei n, GLuint *buffers);
+#endif
+
+/* Pixel pack buffers, GL_ARB_pixel_buffer_object */
+#ifndef GL_VERSION_1_5
+#define GL_STREAM_READ                    0x88E1
+typedef void (APIENTRYP PFNGLBUFFERDATAPROC) (GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+typedef GLboolean (APIENTRYP PFNGLUNMAPBUFFERPROC) (GLenum target);
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER              0x88EB
+#endif
+#ifndef GL_VERSION_3_0
+#define GL_MAP_READ_BIT                   0x0001
+#define GL_MAP_WRITE_BIT                  0x0002
+typedef void *(APIENTRYP PFNGLMAPBUFFERRANGEPROC) (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+#endif
+#ifndef GL_VERSION_4_4
+#define GL_MAP_PERSISTENT_BIT             0x0040
+#define GL_MAP_COHERENT_BIT               0x0080
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC) (GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+#endif
+
+/* Compressed textures, GL_EXT_texture_compression_s3tc and
+ * GL_OES_compressed_ETC1_RGB8_texture
+ */
+#ifndef GL_VERSION_1_3
+typedef void (APIENTRYP PFNGLCOMPRESSEDTEXIMAGE2DPROC) (GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data);
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT   0x83F0
+#endif
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES                  0x8D64
+#endif
+
+/* Multitexture with GL_ARB_texture_env_combine, core in OpenGL 1.3 and
+ * OpenGL ES 1.1.  OpenGL ES names the sources GL_SRCn_*; the values are
+ * the same.
+ */
+#ifndef GL_VERSION_1_3
+typedef void (APIENTRYP PFNGLACTIVETEXTUREPROC) (GLenum texture);
+typedef void (APIENTRYP PFNGLCLIENTACTIVETEXTUREPROC) (GLenum texture);
+#endif
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0                       0x84C0
+#define GL_TEXTURE1                       0x84C1
+#define GL_TEXTURE2                       0x84C2
+#endif
+#ifndef GL_MAX_TEXTURE_UNITS
+#define GL_MAX_TEXTURE_UNITS              0x84E2
+#endif
+#ifndef GL_COMBINE
+#define GL_COMBINE                        0x8570
+#define GL_COMBINE_RGB                    0x8571
+#define GL_COMBINE_ALPHA                  0x8572
+#define GL_INTERPOLATE                    0x8575
+#define GL_PRIMARY_COLOR                  0x8577
+#define GL_PREVIOUS                       0x8578
+#define GL_OPERAND0_RGB                   0x8590
+#define GL_OPERAND1_RGB                   0x8591
+#define GL_OPERAND2_RGB                   0x8592
+#define GL_OPERAND0_ALPHA                 0x8598
+#define GL_OPERAND1_ALPHA                 0x8599
+#endif
+#ifndef GL_SOURCE0_RGB
+#define GL_SOURCE0_RGB                    0x8580
+#define GL_SOURCE1_RGB                    0x8581
+#define GL_SOURCE2_RGB                    0x8582
+#define GL_SOURCE0_ALPHA                  0x8588
+#define GL_SOURCE1_ALPHA                  0x8589
+#endif
+
 /* GL_EXT_texture */
 #ifndef GL_VERSION_1_1
 #ifdef GL_EXT_texture
@@ -78,7 +159,28 @@ extern bool ogl_have_ARB_sync;
 extern PFNGLFENCESYNCPROC glFenceSyncFunc;
 extern PFNGLDELETESYNCPROC glDeleteSyncFunc;
 extern PFNGLCLIENTWAITSYNCPROC glClientWaitSyncFunc;
+extern bool ogl_have_ARB_buffer_storage;
+extern PFNGLGENBUFFERSPROC glGenBuffersFunc;
+extern PFNGLDELETEBUFFERSPROC glDeleteBuffersFunc;
+extern PFNGLBINDBUFFERPROC glBindBufferFunc;
+extern PFNGLBUFFERSTORAGEPROC glBufferStorageFunc;
+extern PFNGLMAPBUFFERRANGEPROC glMapBufferRangeFunc;
+/* Set when the screen can be read into a buffer object and mapped later.
+ * Uses the buffer functions above, which are loaded for either.
+ */
+extern bool ogl_have_pixel_buffer_object;
+extern PFNGLBUFFERDATAPROC glBufferDataFunc;
+extern PFNGLUNMAPBUFFERPROC glUnmapBufferFunc;
 extern GLfloat ogl_maxanisotropy;
+/* Set when there are three texture units whose environments can combine,
+ * as the single pass overlay draw needs
+ */
+extern bool ogl_have_texture_env_combine;
+extern PFNGLACTIVETEXTUREPROC glActiveTextureFunc;
+extern PFNGLCLIENTACTIVETEXTUREPROC glClientActiveTextureFunc;
+/* Internal format of the compressed opaque textures, or 0 if none */
+extern GLenum ogl_compressed_rgb_format;
+extern PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage2DFunc;
 
 /* Global initialization:
  * will need an OpenGL context and intialize all function pointers.
@@ -31,9 +31,15 @@
 #include "pstypes.h"
 #include "3d.h"
 #include <array>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
 
 namespace dcx {
 
+enum class opengl_texture_filter : uint8_t;
+
 /* we need to export ogl_texture for 2d/font.c */
 struct ogl_texture
 {
@@ -48,6 +54,18 @@ struct ogl_texture
 	GLfloat prio;
 	int wrapstate;
 	unsigned long numrend;
+	/* The -gl_texcache entry that the texels were uploaded from, or 0,
+	 * so that they can be uploaded again if the context is lost
+	 */
+	uint64_t cache_key;
+	opengl_texture_filter cache_texfilt;
+	bool cache_texanis;
+	/* Kept by ogl_texture_pool, and not reset by ogl_init_texture */
+	uint32_t pool_index{};
+	uint32_t last_used_frame{};
+	uint32_t resident_bytes{};
+	bool pool_in_use{};
+	bool evictable{};
 };
 
 extern ogl_texture* ogl_get_free_texture();
@@ -106,6 +124,57 @@ constexpr int opengl_bitmap_use_dst_canvas = -1;
 bool ogl_ubitmapm_cs(grs_canvas &, int x, int y,int dw, int dh, grs_bitmap &bm, int c);
 bool ogl_ubitmapm_cs(grs_canvas &, int x, int y,int dw, int dh, grs_bitmap &bm, const ogl_colors::array_type &c);
 bool ogl_ubitmapm_cs(grs_canvas &, int x, int y, int dw, int dh, grs_bitmap &bm, const ogl_colors::array_type &c, bool fill);
+
+/* One character of a string, in canvas coordinates */
+struct ogl_glyph_quad
+{
+	int x, y, w, h;
+	grs_bitmap *bm;
+	std::array<GLfloat, 4> color;
+};
+
+/* Draw the characters of a string in one call.  All the bitmaps must be
+ * sub bitmaps of the same font texture.
+ */
+void ogl_ubitmapm_glyphs(grs_canvas &, std::span<const ogl_glyph_quad> glyphs);
+
+/* Copy a rectangle of the screen, in screen coordinates, into a texture,
+ * and draw it back to the same rectangle on a later frame.  Only one
+ * rectangle is kept.  ogl_draw_screen_region returns false, drawing
+ * nothing, if the copy is of another rectangle or was lost with a mode
+ * change.
+ */
+void ogl_retain_screen_region(int x, int y, int w, int h);
+bool ogl_draw_screen_region(int x, int y, int w, int h);
+void ogl_discard_screen_region();
+
+/* The same for the views in the two cockpit windows, one copy for each
+ * `view`.  ogl_draw_view_region stretches the copy over the rectangle it
+ * is given, which may be larger than the one it was taken from, so that
+ * a view can be rendered small and scaled up.  Not implemented for
+ * Vulkan.
+ */
+void ogl_retain_view_region(unsigned view, int x, int y, int w, int h);
+bool ogl_draw_view_region(unsigned view, int x, int y, int w, int h);
+void ogl_discard_view_regions();
+
+/* The whole screen, as 8-bit RGB without padding between rows */
+struct ogl_screen_image
+{
+	unsigned w, h;
+	/* The bottom row comes first, as glReadPixels gives it */
+	bool bottom_up;
+	std::vector<uint8_t> rgb;
+};
+
+/* Read the screen and pass it to `done`.  OpenGL reads the frame last
+ * shown, Vulkan the frame being drawn once it is finished.  Where the
+ * driver allows, the copy is queued on the GPU and `done` is called by a
+ * later gr_flip, so that the game does not wait for the GPU; otherwise
+ * `done` is called before this returns.  Returns false, and never calls
+ * `done`, if the screen cannot be read.
+ */
+bool ogl_read_screen(std::function<void(ogl_screen_image &&)> done);
 bool ogl_ubitblt_cs(grs_canvas &, int dw, int dh, int dx, int dy, int sx, int sy);
 bool ogl_ubitblt_i(unsigned dw, unsigned dh, unsigned dx, unsigned dy, unsigned sw, unsigned sh, unsigned sx, unsigned sy, const grs_bitmap &src, grs_bitmap &dest, opengl_texture_filter texfilt);
 bool ogl_ubitblt(unsigned w, unsigned h, unsigned dx, unsigned dy, unsigned sx, unsigned sy, const grs_bitmap &src, grs_bitmap &dest);
@@ -135,6 +204,102 @@ static inline void g3_draw_tmap_2(grs_canvas &canvas, const unsigned nv, const s
 }
 
 namespace dcx {
+#if DXX_USE_VULKAN
+/* Smoothed time from queueing a frame for present until its rendering was
+ * seen complete, for the FPS indicator
+ */
+fix64 vk_get_present_latency();
+
+/* Coarse passes timed with GPU timestamps for -renderstats.  Marking a
+ * pass flushes batched draws so that they are attributed to the pass that
+ * issued them.
+ */
+enum class vk_gpu_pass : uint8_t
+{
+	mine,
+	objects,
+	hud,
+	blit_2d,
+};
+void vk_set_gpu_pass(vk_gpu_pass);
+
+/* While an object group is open, the opaque polygons of models and sprites
+ * are held per texture instead of drawn, so that identical objects drawn
+ * one after another go out as one batch per texture rather than one per
+ * polygon.  Any other draw sends the held polygons first.
+ */
+void vk_begin_object_group();
+void vk_end_object_group();
+#endif
+/* With -gl_staticgeometry, the world space corners of every segment side
+ * are uploaded once per level, four per side, starting at
+ * (segnum * MAX_SIDES_PER_SEGMENT + sidenum) * 4.  While a wall face is
+ * drawn, ogl_static_face names its corners, so that the backend can take
+ * the positions from the static buffer instead of the rotated points and
+ * only stream lighting and texture coordinates.
+ */
+struct ogl_static_face
+{
+	unsigned base;
+	std::array<uint8_t, 4> corner;
+	bool active;
+};
+extern ogl_static_face ogl_current_static_face;
+void ogl_upload_static_geometry(std::span<const std::array<float, 3>> corners);
+void ogl_free_static_geometry();
+
+#if !DXX_USE_VULKAN
+/* With -gl_modelmatrix, the points of a polygon model are not rotated.
+ * While its faces are drawn, this names the matrix that takes the space
+ * of the submodel being drawn to eye space, one per submodel, and the
+ * points hold positions in that space for GL to transform.  nullptr when
+ * the points are rotated.
+ */
+extern const std::array<float, 16> *ogl_current_model_matrix;
+#endif
+
+/* Lines whose world space ends do not move, such as the automap's edges.
+ * Line n runs from points[2 * n] to points[2 * n + 1].  Drawing takes the
+ * lines to show this frame, each with its own color, in the order given,
+ * and sends them in one call instead of rotating the ends and drawing the
+ * lines one at a time.
+ */
+struct ogl_static_line
+{
+	uint32_t line;
+	color_palette_index color;
+};
+void ogl_upload_static_lines(std::span<const std::array<float, 3>> points);
+void ogl_draw_static_lines(std::span<const ogl_static_line> lines);
+void ogl_free_static_lines();
+
+/* A dynamic light as apply_light casts it, in world units, for backends
+ * that light static faces on the GPU.  The layout matches the shaders'
+ * std430 struct.  Sources with segment set only reach the corners of that
+ * segment; headlight_max_dist is nonzero for a headlight pointing along
+ * headlight_dir.
+ */
+struct ogl_static_light
+{
+	std::array<float, 3> pos;
+	float range;
+	std::array<float, 3> color;
+	uint32_t segment;
+	std::array<float, 3> headlight_dir;
+	float headlight_max_dist;
+};
+static_assert(sizeof(ogl_static_light) == 48);
+constexpr uint32_t ogl_static_light_any_segment = UINT32_MAX;
+/* True when static faces get their dynamic light from
+ * ogl_set_static_lights, so that the caller leaves it out of their colors
+ */
+bool ogl_static_lights_enabled();
+void ogl_set_static_lights(std::span<const ogl_static_light> lights, float saturation);
+/* With -gl_streambuffer, textured polygons are batched until the texture
+ * changes.  Code that sets GL state or draws by itself must flush them
+ * first.
+ */
+void ogl_stream_flush();
 void ogl_draw_vertex_reticle(grs_canvas &, int cross, int primary, int secondary, int color, int alpha, int size_offs);
 void ogl_toggle_depth_test(int enable);
 void ogl_set_blending(gr_blend);
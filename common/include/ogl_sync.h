@@ -25,17 +25,26 @@
 
 namespace dcx {
 
+/* A GL_ARB_sync fence object, deleted with its owner */
+class ogl_fence_deleter
+{
+public:
+	typedef GLsync pointer;
+	void operator()(pointer p) const;
+};
+using ogl_fence = std::unique_ptr<GLsync, ogl_fence_deleter>;
+
+ogl_fence ogl_insert_fence();
+/* Block until the GPU has passed fence */
+void ogl_wait_fence(const ogl_fence &fence);
+/* Whether the GPU has passed fence, without waiting */
+bool ogl_fence_signalled(const ogl_fence &fence);
+
 class ogl_sync {
-	class sync_deleter
-	{
-	public:
-		typedef GLsync pointer;
-		void operator()(pointer p) const;
-	};
 	private:
 		SyncGLMethod method{SYNC_GL_NONE};
 		fix wait_timeout{0};
-		std::unique_ptr<GLsync, sync_deleter> fence;
+		ogl_fence fence;
 	public:
 		~ogl_sync();
 
@@ -0,0 +1,84 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* With -gl_texcache, opaque level textures are block compressed the first
+ * time they are seen, and the compressed mip levels are kept in a cache
+ * file in the write directory, so that later loads upload them directly.
+ * Entries are keyed by a hash of everything that went into the texels, so
+ * a changed palette or filter setting adds an entry instead of reusing a
+ * stale one.  Delete the file to reclaim the space.
+ */
+
+#pragma once
+
+#include "dxxsconf.h"
+
+#if !DXX_USE_OGL
+#error "This file can only be included in OpenGL enabled builds."
+#endif
+
+#include "physfsx.h"
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace dcx {
+
+/* Block formats with 8 bytes for each 4x4 block of RGB texels.  These
+ * values are written to the cache file, so they must not be renumbered.
+ */
+enum class ogl_block_format : uint8_t
+{
+	/* S3TC DXT1, for desktop OpenGL */
+	bc1 = 1,
+	/* ETC1, which also decodes as ETC2 RGB8, for OpenGL ES */
+	etc1 = 2,
+};
+
+/* Compress a w x h image of 3 byte texels, appending the blocks to out.
+ * Sizes that are not a multiple of 4 repeat the last row and column into
+ * the partial blocks.
+ */
+void ogl_compress_rgb(ogl_block_format format, const uint8_t *rgb, unsigned w, unsigned h, std::vector<uint8_t> &out);
+
+/* FNV-1a, for building cache keys from several pieces */
+uint64_t ogl_texture_cache_hash(std::span<const uint8_t> data, uint64_t h = 0xcbf29ce484222325ull);
+
+class ogl_texture_cache
+{
+public:
+	struct entry
+	{
+		ogl_block_format format;
+		uint16_t w, h;
+		std::vector<std::vector<uint8_t>> levels;
+	};
+	/* Fill e from the cache file.  Returns false on a miss. */
+	bool load(uint64_t key, entry &e);
+	/* Queue e for the cache file, until flush writes it */
+	void store(uint64_t key, entry e);
+	void flush();
+private:
+	struct location
+	{
+		PHYSFS_uint64 offset;
+		ogl_block_format format;
+		uint8_t levels;
+		uint16_t w, h;
+	};
+	std::unordered_map<uint64_t, location> index;
+	std::vector<std::pair<uint64_t, entry>> pending;
+	RAIIPHYSFS_File reader;
+	PHYSFS_uint64 file_size{};
+	bool indexed{};
+	void read_index();
+};
+
+extern ogl_texture_cache ogl_level_texture_cache;
+
+}
@@ -0,0 +1,92 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Storage for the ogl_texture entries of both OpenGL and Vulkan backends.
+ * Entries are never moved, so that grs_bitmap::gltexture stays valid, and
+ * freed entries are reused from a free list.  Textures that can be loaded
+ * again from their bitmap are evicted least recently used first when more
+ * than -gl_texturebudget is resident.
+ */
+
+#pragma once
+
+#include "dxxsconf.h"
+
+#if !DXX_USE_OGL
+#error "This file can only be included in OpenGL enabled builds."
+#endif
+
+#include "ogl_init.h"
+#include <deque>
+#include <span>
+#include <vector>
+
+namespace dcx {
+
+class ogl_texture_pool
+{
+	std::deque<ogl_texture> entries;
+	std::vector<ogl_texture *> free_entries;
+	std::vector<ogl_texture *> evict_entries;
+	std::size_t resident_bytes{};
+	uint32_t frame{};
+	unsigned evictions{};
+	/* Set when a load may have taken the pool over budget */
+	bool need_trim{};
+	/* Set by request_trim, for the next end_frame */
+	bool trim_all{};
+	/* Whether end_frame may evict t */
+	bool evict_candidate(const ogl_texture &t) const;
+public:
+	struct stats
+	{
+		std::size_t entries, used, resident_bytes, budget_bytes;
+		unsigned evictions;
+	};
+	ogl_texture &allocate();
+	/* The backend must have unloaded t first */
+	void release(ogl_texture &t);
+	/* Free every entry, for when no bitmap holds a texture */
+	void clear();
+	ogl_texture &operator[](const std::size_t i)
+	{
+		return entries[i];
+	}
+	auto begin()
+	{
+		return entries.begin();
+	}
+	auto end()
+	{
+		return entries.end();
+	}
+	void touch(ogl_texture &t) const
+	{
+		t.last_used_frame = frame;
+	}
+	/* Record that t was uploaded.  Evictable textures are those that
+	 * ogl_loadbmtexture_f can load again.
+	 */
+	void note_loaded(ogl_texture &t, std::size_t bytes, bool evictable);
+	void note_unloaded(ogl_texture &t);
+	/* Call once per frame.  Returns the least recently used textures that
+	 * the backend must unload to fit the budget again.
+	 */
+	std::span<ogl_texture *const> end_frame();
+	/* Have the next end_frame evict every texture that the budget could
+	 * evict, whatever the budget.  Returns the bytes that will free.
+	 */
+	std::size_t request_trim();
+	stats get_stats() const;
+};
+
+extern ogl_texture_pool ogl_textures;
+
+/* ogl_textures.request_trim, for mem_trim_register */
+std::size_t ogl_textures_trim();
+
+}
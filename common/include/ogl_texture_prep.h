@@ -0,0 +1,69 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* CPU side of texture uploads, shared by the OpenGL and Vulkan backends:
+ * expanding palettized bitmaps to texels, building mip levels, and running
+ * that work on worker threads.  Nothing here calls GL or Vulkan, so it is
+ * safe to use off the render thread.
+ */
+
+#pragma once
+
+#include "dxxsconf.h"
+
+#if !DXX_USE_OGL
+#error "This file can only be included in OpenGL enabled builds."
+#endif
+
+#include "d_gl.h"
+#include "palette.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace dcx {
+
+/* The texel of each palette index in one upload format, so that expanding
+ * a bitmap is one table lookup per pixel.  Entry 256 is the transparent
+ * padding outside the bitmap.  The transparency rules are those of
+ * ogl_filltexbuf.
+ */
+class ogl_palette_lut
+{
+	std::array<std::array<uint8_t, 4>, 257> texel;
+	unsigned texel_bytes;
+public:
+	ogl_palette_lut(const palette_array_t &pal, GLenum format, int bm_flags);
+	unsigned bytes_per_texel() const
+	{
+		return texel_bytes;
+	}
+	void expand(const uint8_t *src, std::size_t count, uint8_t *dst) const;
+	void expand_one(unsigned c, uint8_t *dst) const;
+};
+
+/* Expand a width x height bitmap of palette indices, with rows truewidth
+ * apart, starting at (dxo, dyo), into a twidth x theight texture.  The
+ * last column and row are repeated once into the padding, so that filtering
+ * does not darken the border, and the remaining padding is transparent.
+ */
+void ogl_expand_palettized(const ogl_palette_lut &lut, const uint8_t *data, uint8_t *texp, unsigned truewidth, unsigned width, unsigned height, int dxo, int dyo, unsigned twidth, unsigned theight);
+
+/* Append every mip level after the w x h level 0 down to 1x1, each the
+ * 2x2 box filter of the one before, as gluBuild2DMipmaps does for power of
+ * two sizes.
+ */
+void ogl_build_mipmaps(const uint8_t *level0, unsigned w, unsigned h, unsigned bytes_per_texel, std::vector<std::vector<uint8_t>> &levels);
+
+/* Call fn(i) for each i < count, spread over the worker pool of
+ * parallel_for and the calling thread.  Returns once every call is done.
+ */
+void ogl_parallel_for(std::size_t count, const std::function<void(std::size_t)> &fn);
+
+}
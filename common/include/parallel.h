@@ -0,0 +1,60 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* A pool of worker threads for game logic that splits into calls which
+ * touch no shared state.  The threads are started on first use and live
+ * until the program exits, so a call costs a wakeup rather than a thread
+ * start, and it can be used every frame.
+ *
+ * On Linux and Android parts with big and little cores, the pool has one
+ * thread per big core and keeps its workers on those cores.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace dcx {
+
+/* Call fn(i) for each i < count, spread over the pool and the calling
+ * thread.  Returns once every call is done.  Each thread starts on its
+ * own run of consecutive indices, and threads which finish early steal
+ * half of what another has left.
+ *
+ * Only one call uses the pool at a time.  A call made while another is
+ * running, including one made from inside fn, runs its indices in order
+ * on the calling thread.
+ */
+void parallel_for(std::size_t count, const std::function<void(std::size_t)> &fn);
+
+/* The number of threads parallel_for uses, counting the calling thread */
+unsigned parallel_for_threads();
+
+/* Use at most `limit` threads, counting the caller.  0 means all of the
+ * pool.  1 makes every call run its indices in order on the calling
+ * thread, which is useful to rule out the threads when a replay diverges.
+ */
+void parallel_set_thread_limit(unsigned limit);
+
+struct parallel_stats
+{
+	/* Calls that used the pool */
+	uint32_t jobs;
+	/* Runs of indices taken from another thread */
+	uint32_t steals;
+	/* Time the callers waited for the workers after finishing their own
+	 * share, in microseconds
+	 */
+	uint32_t wait_us;
+};
+
+/* Returns the counts since the last call, and resets them */
+parallel_stats parallel_take_stats();
+
+}
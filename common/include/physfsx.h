@@ -14,12 +14,15 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <ranges>
 #include <span>
 #include <stdarg.h>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 // When PhysicsFS can *easily* be built as a framework on Mac OS X,
 // the framework form will be supported again -kreatordxx
@@ -460,6 +463,54 @@ public:
 	}
 };
 
+/* A read-only memory map of a file that PhysFS found in a plain
+ * directory, or in a HOG that hogcreate -a aligned.  Reads from it are
+ * copies, with no system call.  Files inside other archives cannot be
+ * mapped, so users must keep a PHYSFS_File to fall back on.
+ */
+class PHYSFSX_mapped_file
+{
+	const uint8_t *base{};
+	std::size_t length{};
+public:
+	PHYSFSX_mapped_file() = default;
+	PHYSFSX_mapped_file(const uint8_t *base, std::size_t length) :
+		base{base}, length{length}
+	{
+	}
+	PHYSFSX_mapped_file(PHYSFSX_mapped_file &&o) :
+		base{std::exchange(o.base, nullptr)}, length{std::exchange(o.length, 0)}
+	{
+	}
+	PHYSFSX_mapped_file &operator=(PHYSFSX_mapped_file &&o)
+	{
+		if (this != &o)
+		{
+			reset();
+			base = std::exchange(o.base, nullptr);
+			length = std::exchange(o.length, 0);
+		}
+		return *this;
+	}
+	~PHYSFSX_mapped_file()
+	{
+		reset();
+	}
+	explicit operator bool() const
+	{
+		return base;
+	}
+	std::span<const uint8_t> get() const
+	{
+		return {base, length};
+	}
+	/* Ask the system to start reading part of the file into memory,
+	 * without waiting for it.
+	 */
+	void prefetch(std::size_t offset, std::size_t n) const;
+	void reset();
+};
+
 typedef char file_extension_t[5];
 
 [[nodiscard]]
@@ -538,8 +589,105 @@ std::pair<RAIINamedPHYSFS_File, PHYSFS_ErrorCode> PHYSFSX_openReadBuffered(const
 std::pair<RAIINamedPHYSFS_File, PHYSFS_ErrorCode> PHYSFSX_openReadBuffered_updateCase(char *filename);
 
 std::pair<RAIIPHYSFS_File, PHYSFS_ErrorCode> PHYSFSX_openWriteBuffered(const char *filename);
+
+/* The contents of a file, built in memory so that PHYSFSX_queueWrite can
+ * write it later.  The PHYSFSX_puts and PHYSFSX_printf overloads match
+ * the PHYSFS_File versions, except that they cannot fail.
+ */
+struct PHYSFSX_write_buffer
+{
+	std::vector<uint8_t> contents;
+	void write(const void *const buffer, const std::size_t len)
+	{
+		const auto p{static_cast<const uint8_t *>(buffer)};
+		contents.insert(contents.end(), p, p + len);
+	}
+	void writeU8(const uint8_t v)
+	{
+		contents.push_back(v);
+	}
+	void writeULE16(const uint16_t v)
+	{
+		writeU8(v);
+		writeU8(v >> 8);
+	}
+	void writeULE32(const uint32_t v)
+	{
+		writeULE16(v);
+		writeULE16(v >> 16);
+	}
+	/* Write zeros where the file has fields that are no longer used */
+	void skip(const std::size_t len)
+	{
+		contents.resize(contents.size() + len);
+	}
+};
+
+static inline void PHYSFSX_puts(PHYSFSX_write_buffer &file, const std::span<const char> s)
+{
+	file.write(s.data(), s.size());
+}
+
+static inline void PHYSFSX_puts_literal(PHYSFSX_write_buffer &file, const std::span<const char> s)
+{
+	file.write(s.data(), s.size() - 1);
+}
+
+void PHYSFSX_printf(PHYSFSX_write_buffer &file, const char *format) = delete;
+
+dxx_compiler_attribute_format_printf(2, 3)
+void PHYSFSX_printf(PHYSFSX_write_buffer &file, const char *format, ...);
+
+/* Write `contents` to `filename` on a background thread, so that the
+ * caller does not wait for the storage.  The file is written under a
+ * temporary name, ending in '$', and renamed over `filename` once it is
+ * complete.  Nothing is written if the file already has these contents.
+ *
+ * A file that is queued again before the thread reaches it is written
+ * once, with the newer contents.  Failures are reported on the console
+ * by the next call to PHYSFSX_queueWrite or PHYSFSX_waitForQueuedWrites.
+ */
+void PHYSFSX_queueWrite(const char *filename, PHYSFSX_write_buffer &&contents);
+
+/* Read `filename` and discard the data, so that the storage has it in
+ * cache when the game opens it.  Missing files are ignored.
+ */
+void PHYSFSX_readAhead(const char *filename);
+
+/* PHYSFSX_readAhead on the thread that writes queued files */
+void PHYSFSX_queueReadAhead(const char *filename);
+
+/* Return once every queued file is written.  Call this before reading,
+ * listing or deleting any file that may have been queued.
+ */
+void PHYSFSX_waitForQueuedWrites();
+
+/* Map the file that PhysFS would open as filename.  The result is empty
+ * if the file is in an archive, or cannot be mapped on this platform.
+ * expected_length guards against mapping a different file than PhysFS
+ * opened.
+ */
+[[nodiscard]]
+PHYSFSX_mapped_file PHYSFSX_mapReadOnly(const char *filename, PHYSFS_sint64 expected_length);
 extern void PHYSFSX_addArchiveContent();
 extern void PHYSFSX_removeArchiveContent();
+/* Read HOG files with the archiver in physfs_hog.cpp instead of PhysFS's
+ * own, so that the directory hogcreate -a writes is used.  It also reads
+ * the HOG2 files of Descent 3, as PhysFS's does.  Call before the first
+ * HOG is mounted.
+ */
+void PHYSFSX_registerHogArchiver();
+/* If `filename` is in the HOG mounted from the path `archive`, set where
+ * its data is in the HOG.
+ */
+bool PHYSFSX_findHogMember(const char *archive, const char *filename, PHYSFS_uint64 &offset, PHYSFS_uint64 &length);
+#ifdef __ANDROID__
+/* Append the files packaged in the APK's assets to the search path, read
+ * in place instead of being copied out to storage first.  Archives among
+ * them are mounted from the APK as archives elsewhere are.
+ */
+void PHYSFSX_mountApkAssets();
+#endif
 }
 
 #ifdef DXX_BUILD_DESCENT
@@ -0,0 +1,35 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* The resampler of the SoundBlaster16 emulation of the SDL_mixer
+ * backend.  It does not depend on any sound state, so it can be tested
+ * on its own.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace dcx {
+
+constexpr std::size_t digi_resample_filter_length = 51;
+
+/* Upsample the unsigned 8-bit samples of `input` by `factor`, stuffing
+ * zeros between them, and low-pass filter the result with `coeffs`.
+ * `output` receives input.size() * factor signed 16-bit samples.
+ *
+ * The plain version splits the filter into one phase per output position
+ * and skips the products against the stuffed zeros, several outputs at a
+ * time.  It writes the same result as the _reference version, which runs
+ * the whole filter over the zero stuffed signal.
+ */
+void digi_resample_fir(std::span<const uint8_t> input, std::size_t factor, std::span<const int32_t, digi_resample_filter_length> coeffs, std::span<int16_t> output);
+void digi_resample_fir_reference(std::span<const uint8_t> input, std::size_t factor, std::span<const int32_t, digi_resample_filter_length> coeffs, std::span<int16_t> output);
+
+}
@@ -73,6 +73,13 @@ static inline const grs_bitmap *rle_expand_texture(const grs_bitmap &bmp)
 
 void rle_cache_close();
 void rle_cache_flush();
+
+struct rle_cache_stats
+{
+	unsigned long hits, misses, evictions;
+	std::size_t entries, bytes;
+};
+const rle_cache_stats &rle_cache_get_stats();
 void rle_swap_0_255(grs_bitmap &bmp);
 void rle_remap(grs_bitmap &bmp, const std::array<color_palette_index, 256> &colormap);
 #if !DXX_USE_OGL
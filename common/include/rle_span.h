@@ -0,0 +1,35 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Byte kernels of the RLE decoder and the transparent blitters.  They do
+ * not depend on any bitmap state, so they can be tested on their own.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "dsx-ns.h"
+
+namespace dcx {
+
+/* Copy `n` pixels from `src` to `dest`, except where `src` is
+ * TRANSPARENCY_COLOR, which leaves `dest` unchanged.  The plain version
+ * compares 16 pixels at a time, and writes the same result as the
+ * _reference version, which steps one pixel at a time.
+ */
+void gr_copy_masked(uint8_t *dest, const uint8_t *src, std::size_t n);
+void gr_copy_masked_reference(uint8_t *dest, const uint8_t *src, std::size_t n);
+
+/* Return the first byte in [`p`, `e`) that starts a run of an RLE row, or
+ * `e` if every byte is a literal pixel.  Every byte in [`p`, `e`) must be
+ * readable, even past the returned byte.
+ */
+const uint8_t *gr_rle_find_code(const uint8_t *p, const uint8_t *e);
+const uint8_t *gr_rle_find_code_reference(const uint8_t *p, const uint8_t *e);
+
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* A fixed-size set of free slot numbers.  Unlike a stack of free slots,
+ * it can always hand out the lowest free slot and report the highest
+ * used slot, each in a few word operations.
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace dcx {
+
+template <std::size_t N>
+class slot_bitmap
+{
+	using word_type = uint64_t;
+	static constexpr std::size_t word_bits{64};
+	static constexpr std::size_t word_count{(N + word_bits - 1) / word_bits};
+	static constexpr word_type tail_mask{
+		(N % word_bits) ? (word_type{1} << (N % word_bits)) - 1 : ~word_type{0}
+	};
+	/* Bit set means the slot is free.  Bits past N in the last word are
+	 * kept clear, so they are never reported as free.
+	 */
+	std::array<word_type, word_count> words;
+public:
+	/* A new set has every slot free */
+	constexpr slot_bitmap()
+	{
+		free_all();
+	}
+	static constexpr std::size_t size()
+	{
+		return N;
+	}
+	constexpr bool operator==(const slot_bitmap &) const = default;
+	/* Mark every slot free */
+	constexpr void free_all()
+	{
+		for (auto &w : words)
+			w = ~word_type{0};
+		words.back() = tail_mask;
+	}
+	/* Mark every slot used */
+	constexpr void use_all()
+	{
+		words = {};
+	}
+	constexpr bool is_free(const std::size_t i) const
+	{
+		return words[i / word_bits] & (word_type{1} << (i % word_bits));
+	}
+	constexpr void set_free(const std::size_t i)
+	{
+		words[i / word_bits] |= (word_type{1} << (i % word_bits));
+	}
+	constexpr void set_used(const std::size_t i)
+	{
+		words[i / word_bits] &= ~(word_type{1} << (i % word_bits));
+	}
+	/* Returns the lowest free slot, or N if every slot is used */
+	constexpr std::size_t first_free() const
+	{
+		for (std::size_t w = 0; w != word_count; ++w)
+			if (const auto bits{words[w]})
+				return w * word_bits + std::countr_zero(bits);
+		return N;
+	}
+	/* Returns the highest used slot, or N if every slot is free */
+	constexpr std::size_t last_used() const
+	{
+		for (std::size_t w = word_count; w--;)
+		{
+			const auto used{~words[w] & (w == word_count - 1 ? tail_mask : ~word_type{0})};
+			if (used)
+				return w * word_bits + (word_bits - 1 - std::countl_zero(used));
+		}
+		return N;
+	}
+};
+
+}
@@ -55,6 +55,15 @@ void draw_tmap(grs_canvas &, const grs_bitmap &bp, std::span<const g3_draw_tmap_
 //function that takes the same parms as draw_tmap, but renders as flat poly
 //we need this to do the cloaked effect
 void draw_tmap_flat(grs_canvas &, const grs_bitmap &bp, std::span<const g3_draw_tmap_point *const> vertbuf);
+
+//Between tmap_tiles_begin and tmap_tiles_end, the spans are binned by rows
+//of the canvas and filled on -tmap_threads threads at the next flush.
+//Flush before anything else reads the canvas, or frees or reuses a bitmap
+//that a binned span may still read.
+void tmap_tiles_begin();
+void tmap_tiles_flush();
+void tmap_tiles_end();
+void tmap_tiles_close();
 #endif
 
 // -------------------------------------------------------------------------------------------------------
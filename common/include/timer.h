@@ -24,6 +24,13 @@ fix64 timer_update();
 fix64 timer_query();
 
 void timer_delay_ms(unsigned milliseconds);
+/* Wait part of the way to `deadline`, a time from timer_update.  While
+ * the deadline is further off than the system usually oversleeps, sleep
+ * for up to `max_sleep_ms`, stopping that much short of it.  Otherwise,
+ * return at once, so that the caller spins on timer_update for the rest.
+ * Call it in a loop until the deadline passes.
+ */
+void timer_wait_toward(fix64 deadline, unsigned max_sleep_ms);
 static inline void timer_delay(fix seconds)
 {
 	timer_delay_ms(f2i(seconds * 1000));
@@ -34,5 +41,23 @@ static inline void timer_delay2(int fps)
 	timer_delay_bound(1000u / fps);
 }
 
+/* How late frames were against the frame limiter's deadline, over the
+ * last whole second.
+ */
+struct timer_frame_pacing
+{
+	fix mean_late, max_late;
+};
+void timer_record_frame_lateness(fix late);
+[[nodiscard]]
+timer_frame_pacing timer_get_frame_pacing();
+#ifdef __ANDROID__
+/* Adjust the frame period `bound` for thermal headroom and for how long the
+ * last frame took to simulate and render (`work`).  Returns `bound` unchanged
+ * while the device keeps up and CGameCfg.AdaptivePacing is set.
+ */
+fix timer_paced_frame_bound(fix bound, fix64 work);
+#endif
+
 }
 #endif
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Span kernels of the software texture mapper.  A span carries everything
+ * the kernel reads, so the kernels do not depend on the texmapper globals
+ * and can be tested on their own.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "maths.h"
+
+namespace dcx {
+
+struct tmap_span
+{
+	uint8_t *dest;
+	/* 64x64 texture */
+	const uint8_t *pixels;
+	/* Rows of 256 entries, laid out as gr_fade_table */
+	const uint8_t *fade;
+	unsigned count;
+	bool transparent;
+	/* Color of flat spans */
+	uint8_t color;
+	/* v and dvdx are premultiplied by 64, and l and dldx are in 8.8, as
+	 * set up by the scanline functions
+	 */
+	fix u, v, z, l;
+	fix dudx, dvdx, dzdx, dldx;
+};
+
+/* Affine and perspective divided spans with lighting.  The plain versions
+ * process 8 pixels at a time in vector registers, and are bit-identical to
+ * the _reference versions, which step one pixel at a time.
+ */
+void tmap_span_lin(const tmap_span &s);
+void tmap_span_lin_reference(const tmap_span &s);
+void tmap_span_per(const tmap_span &s);
+void tmap_span_per_reference(const tmap_span &s);
+/* Unlit affine span */
+void tmap_span_lin_nolight(const tmap_span &s);
+void tmap_span_flat(const tmap_span &s);
+/* Remaps the pixels already in dest through fade, which is a single row
+ * of the fade table
+ */
+void tmap_span_shaded(const tmap_span &s);
+
+enum class tmap_span_kind : uint8_t
+{
+	lin,
+	lin_nolight,
+	per,
+	flat,
+	shaded,
+};
+
+void tmap_span_draw(tmap_span_kind kind, const tmap_span &s);
+
+}
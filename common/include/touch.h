@@ -21,6 +21,26 @@ void touch_overlay_set_enabled(bool enabled);
 bool touch_overlay_is_enabled();
 void touch_overlay_set_invert_y(bool invert);
 
+/* Finger motion is only recorded as it arrives.  This moves the sticks
+ * to the last position of each finger, once per batch of events.
+ */
+void touch_overlay_apply_motion();
+
+/* While analog, the sticks stop sending W/A/S/D and the arrow keys, and
+ * the game reads their deflection instead.  The game turns this on while
+ * it is the front window, so that menus can still be driven by keys.
+ */
+void touch_overlay_set_analog(bool analog);
+
+struct touch_stick_axes
+{
+	// -1 to 1, 0 while the stick is not held.  Positive y is down,
+	// after applying touch_overlay_set_invert_y to the look stick.
+	float move_x, move_y, look_x, look_y;
+};
+
+touch_stick_axes touch_overlay_get_axes();
+
 }
 
 #endif
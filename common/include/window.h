@@ -45,6 +45,15 @@ public:
 
 	virtual window_event_result event_handler(const d_event &) = 0;
 
+	/* How many milliseconds event_process may wait for input, without
+	 * drawing, while this window is in front.  0 draws every frame, for
+	 * windows which animate or must keep the game running.
+	 */
+	virtual unsigned get_idle_wait() const
+	{
+		return 0;
+	}
+
 	void send_creation_events();
 	friend int window_close(window *wind);
 	friend window *window_get_front();
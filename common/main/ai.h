@@ -28,6 +28,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <cstddef>
 #include <utility>
 #include <span>
+#include <vector>
 #include "dxxsconf.h"
 #include "dsx-ns.h"
 #include "fmtcheck.h"
@@ -226,7 +227,13 @@ int ai_door_is_openable(
 #endif
 	const shared_segment &segp, sidenum_t sidenum);
 player_visibility_state player_is_visible_from_object(const d_robot_info_array &Robot_info, vmobjptridx_t objp, vms_vector &pos, fix field_of_view, const vms_vector &vec_to_player);
+// Cast ahead, on the worker threads, the player visibility checks which
+// objects are likely to make this frame.  Call after the player moves.
+void ai_perception_prepass();
 extern void ai_reset_all_paths(void);   // Reset all paths.  Call at the start of a level.
+// Forget any garbage collection of Point_segs in progress.  Call when
+// Point_segs is replaced wholesale.
+void ai_path_garbage_collect_abandon();
 
 #if DXX_BUILD_DESCENT == 2
 // In escort.c
@@ -333,6 +340,18 @@ std::pair<create_path_result, unsigned> create_path_points(vmobjptridx_t objp, c
 void ai_save_state(PHYSFS_File * fp);
 int ai_restore_state(const d_robot_info_array &Robot_info, NamedPHYSFS_File fp, int version, physfsx_endian swap);
 
+/* The AI state that is not kept in the objects, for level snapshots */
+struct ai_snapshot
+{
+	int Overall_agitation;
+	std::array<ai_cloak_info, MAX_AI_CLOAK_INFO> Ai_cloak_info;
+	/* Only the allocated part of Point_segs */
+	std::vector<point_seg> Point_segs;
+};
+
+void ai_take_snapshot(ai_snapshot &s);
+void ai_restore_snapshot(const ai_snapshot &s);
+
 #if DXX_USE_EDITOR
 void player_follow_path(object &objp);
 void check_create_player_path();
@@ -316,6 +316,8 @@ struct ai_local_rw
 	sbyte      achieved_state[MAX_SUBMODELS]; // Last achieved state
 };
 
+constexpr std::size_t MAX_AI_CLOAK_INFO{8};		//	Must be a power of 2!
+
 struct ai_cloak_info : public prohibit_void_ptr<ai_cloak_info>
 {
 	fix64       last_time;
@@ -51,6 +51,19 @@ enum class LevelMusicPlayOrder : uint8_t
 	Random,
 };
 
+#if DXX_USE_VULKAN
+/* Vulkan swapchain present mode.  These values are written to a file as
+ * integers, so they must not be renumbered.
+ */
+enum class vk_present_mode : uint8_t
+{
+	fifo,
+	fifo_relaxed,
+	mailbox,
+	immediate,
+};
+#endif
+
 struct CCfg : prohibit_void_ptr<CCfg>
 {
 	uint16_t ResolutionX;
@@ -79,6 +92,10 @@ struct CCfg : prohibit_void_ptr<CCfg>
 	opengl_texture_filter TexFilt;
 	bool TexAnisotropy;
 	bool Multisample;
+#if DXX_USE_VULKAN
+	vk_present_mode VkPresentMode;
+	uint8_t VkFramesInFlight;
+#endif
 	bool FPSIndicator;
 	uint8_t GammaLevel;
 	bool ReverseStereo;
@@ -93,6 +110,7 @@ struct CCfg : prohibit_void_ptr<CCfg>
 	enumerated_array<ntstring<PATH_MAX - 1>, 5, song_number> CMMiscMusic;
 #ifdef __ANDROID__
 	bool TouchInvertY;
+	bool AdaptivePacing;
 #endif
 };
 
@@ -30,8 +30,19 @@
 
 #define CVAR_MAX_LENGTH 1024
 
+/* Names are compared by content, so that a name typed at the console
+ * finds the cvar registered under it.
+ */
+struct cvar_name_less
+{
+	bool operator()(const char *const a, const char *const b) const
+	{
+		return d_stricmp(a, b) < 0;
+	}
+};
+
 /* The list of cvars */
-typedef std::map<const char *, std::reference_wrapper<cvar_t>> cvar_list_type;
+typedef std::map<const char *, std::reference_wrapper<cvar_t>, cvar_name_less> cvar_list_type;
 static cvar_list_type cvar_list;
 
 const char *cvar_t::operator=(const char *s)
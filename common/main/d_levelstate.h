@@ -9,6 +9,7 @@
 #include "dxxsconf.h"
 #include "object.h"
 #include "morph.h"
+#include "slot_bitmap.h"
 
 #ifdef DXX_BUILD_DESCENT
 namespace dcx {
@@ -39,7 +40,11 @@ struct d_level_unique_object_state
 	d_thief_unique_state ThiefState;
 	d_guided_missile_indices Guided_missile;
 #endif
-	std::array<imobjidx_t, MAX_OBJECTS> free_obj_list = init_object_number_array<imobjidx_t>(std::make_index_sequence<MAX_OBJECTS>());
+	/* Free object slots.  obj_allocate takes the lowest free slot, so
+	 * live objects stay packed at the low end and Highest_object_index
+	 * stays close to num_objects.
+	 */
+	slot_bitmap<MAX_OBJECTS> free_objects;
 	object_array Objects;
 	d_level_unique_boss_state BossState;
 	d_level_unique_control_center_state ControlCenterState;
@@ -155,6 +155,14 @@ void digi_start_sound_queued(sound_effect soundnum, fix volume);
 
 extern int Dont_start_sound_objects;
 void digi_select_system();
+/* Convert the loaded sounds to the output format now, instead of when
+ * each is first played.  Call after the sounds change.
+ */
+void digi_prepare_sounds();
+/* Send the volume and pan changes made since the last call to the
+ * mixer.  Changes may be held until then.
+ */
+void digi_flush_channel_updates();
 
 void digi_end_soundobj(sound_object &);
 void SoundQ_end();
@@ -273,6 +281,11 @@ struct digi_sound
 	allocated_data data;
 	std::span<const uint8_t> span() const
 	{
+		/* A sound that piggy_sound_page_in has not read yet has a
+		 * length, but no data.
+		 */
+		if (!data)
+			return {};
 		return {data.get(), length};
 	}
 };
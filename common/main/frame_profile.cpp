@@ -0,0 +1,176 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * Per-subsystem frame timing
+ *
+ */
+
+#include "frame_profile.h"
+#include "console.h"
+#include "cvar.h"
+#include "physfsx.h"
+
+namespace dcx {
+
+bool frame_profile_enabled;
+
+namespace {
+
+/* 0: off.  1: record.  2: record and draw the graph. */
+cvar_t frame_profile_cvar{"frame_profile", "0", CVAR_NONE, 0, 0};
+/* When set to a file name, the history is written there as CSV at the
+ * end of the frame, and the variable is cleared.
+ */
+cvar_t frame_profile_csv_cvar{"frame_profile_csv", "", CVAR_NONE, 0, 0};
+
+frame_profile_scope *frame_profile_current;
+std::array<frame_profile_clock::duration, frame_profile_zone_count> frame_profile_frame;
+std::array<uint32_t, frame_profile_counter_count> frame_profile_frame_counts;
+frame_profile_game_history frame_profile_frames;
+frame_profile_totals frame_profile_running_totals;
+
+constexpr std::array<const char *, frame_profile_zone_count> frame_profile_zone_names{{
+	"ai",
+	"physics",
+	"move_objects",
+	"collide",
+	"sound",
+	"multiplayer",
+	"render_segments",
+	"render_lighting",
+	"render_objects",
+	"render_draw",
+}};
+
+constexpr std::array<const char *, frame_profile_counter_count> frame_profile_counter_names{{
+	"splash_candidates",
+}};
+
+void frame_profile_write_csv(const char *const filename)
+{
+	auto &&[file, physfserr] = PHYSFSX_openWriteBuffered(filename);
+	if (!file)
+	{
+		con_printf(CON_URGENT, "frame_profile: failed to open \"%s\" for writing: %s", filename, PHYSFS_getErrorByCode(physfserr));
+		return;
+	}
+	PHYSFSX_puts_literal(file, "frame");
+	for (const auto name : frame_profile_zone_names)
+		PHYSFSX_printf(file, ",%s_us", name);
+	PHYSFSX_puts_literal(file, ",total_us,parallel_jobs,parallel_steals,parallel_wait_us");
+	for (std::size_t t = 0; t != mem_tag_count; ++t)
+		PHYSFSX_printf(file, ",mem_%s_kb", mem_tag_name(static_cast<mem_tag>(t)));
+	for (const auto name : frame_profile_counter_names)
+		PHYSFSX_printf(file, ",%s", name);
+	PHYSFSX_puts_literal(file, "\n");
+	const auto n{frame_profile_frames.size()};
+	for (std::size_t i = 0; i != n; ++i)
+	{
+		auto &s = frame_profile_frames[i];
+		PHYSFSX_printf(file, "%zu", i);
+		for (const auto us : s.us)
+			PHYSFSX_printf(file, ",%u", us);
+		PHYSFSX_printf(file, ",%u,%u,%u,%u", s.total(), s.parallel.jobs, s.parallel.steals, s.parallel.wait_us);
+		for (const auto kb : s.mem_kb)
+			PHYSFSX_printf(file, ",%u", kb);
+		for (const auto n : s.counts)
+			PHYSFSX_printf(file, ",%u", n);
+		PHYSFSX_puts_literal(file, "\n");
+	}
+	con_printf(CON_NORMAL, "frame_profile: wrote %zu frames to \"%s\"", n, filename);
+}
+
+}
+
+void frame_profile_scope::open()
+{
+	parent = frame_profile_current;
+	frame_profile_current = this;
+	start = frame_profile_clock::now();
+}
+
+void frame_profile_scope::close()
+{
+	const auto elapsed{frame_profile_clock::now() - start};
+	frame_profile_frame[static_cast<std::size_t>(zone)] += elapsed - nested;
+	if (parent)
+		parent->nested += elapsed;
+	frame_profile_current = parent;
+}
+
+void frame_profile_init()
+{
+	cvar_registervariable(frame_profile_cvar);
+	cvar_registervariable(frame_profile_csv_cvar);
+}
+
+void frame_profile_end_frame()
+{
+	if (frame_profile_enabled)
+	{
+		frame_profile_sample s;
+		for (std::size_t i = 0; i != frame_profile_zone_count; ++i)
+		{
+			const auto us{std::chrono::duration_cast<std::chrono::microseconds>(frame_profile_frame[i]).count()};
+			s.us[i] = static_cast<uint32_t>(us);
+		}
+		s.parallel = parallel_take_stats();
+		for (std::size_t t = 0; t != mem_tag_count; ++t)
+			s.mem_kb[t] = static_cast<uint32_t>(mem_account_get(static_cast<mem_tag>(t)).current / 1024);
+		s.counts = frame_profile_frame_counts;
+		frame_profile_frames.push(s);
+		++frame_profile_running_totals.frames;
+		frame_profile_running_totals.us += s.total();
+	}
+	else
+		parallel_take_stats();
+	frame_profile_frame = {};
+	frame_profile_frame_counts = {};
+	const auto enable{frame_profile_cvar.intval != 0};
+	if (frame_profile_enabled != enable)
+	{
+		frame_profile_enabled = enable;
+		if (enable)
+			frame_profile_frames.clear();
+	}
+	if (!frame_profile_csv_cvar.string.empty())
+	{
+		const std::string filename{std::move(frame_profile_csv_cvar.string)};
+		cvar_set_cvar(&frame_profile_csv_cvar, "");
+		frame_profile_write_csv(filename.c_str());
+	}
+}
+
+unsigned frame_profile_mode()
+{
+	return frame_profile_enabled ? (frame_profile_cvar.intval > 1 ? 2 : 1) : 0;
+}
+
+const frame_profile_game_history &frame_profile_get_history()
+{
+	return frame_profile_frames;
+}
+
+const frame_profile_totals &frame_profile_get_totals()
+{
+	return frame_profile_running_totals;
+}
+
+const char *frame_profile_zone_name(const frame_profile_zone z)
+{
+	return frame_profile_zone_names[static_cast<std::size_t>(z)];
+}
+
+void frame_profile_count(const frame_profile_counter c, const uint32_t n)
+{
+	if (frame_profile_enabled)
+		frame_profile_frame_counts[static_cast<std::size_t>(c)] += n;
+}
+
+}
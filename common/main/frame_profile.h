@@ -0,0 +1,173 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Per-subsystem frame timing.  Code marks a zone with a
+ * frame_profile_scope, and the time is charged to that zone for the
+ * current frame.  Scopes nest: a scope is charged only its own time,
+ * and the time of any scope opened inside it is charged to the inner
+ * zone instead, so the zones of one frame never overlap and can be
+ * stacked.  The last frames are kept in a ring for the on-screen graph
+ * and the CSV dump.
+ *
+ * Profiling is off unless the console variable frame_profile is set.
+ * When off, a scope costs one test of a flag.  Scopes must only be
+ * opened on the main thread.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "mem_account.h"
+#include "parallel.h"
+
+namespace dcx {
+
+enum class frame_profile_zone : uint8_t
+{
+	ai,
+	physics,
+	move_objects,
+	collide,
+	sound,
+	multiplayer,
+	render_segments,
+	render_lighting,
+	render_objects,
+	render_draw,
+};
+
+constexpr std::size_t frame_profile_zone_count{static_cast<std::size_t>(frame_profile_zone::render_draw) + 1};
+
+/* Events counted per frame, to tell why a zone took as long as it did */
+enum class frame_profile_counter : uint8_t
+{
+	/* Objects considered for the damage of an explosion */
+	splash_candidates,
+};
+
+constexpr std::size_t frame_profile_counter_count{static_cast<std::size_t>(frame_profile_counter::splash_candidates) + 1};
+
+/* The time charged to each zone in one frame, in microseconds */
+struct frame_profile_sample
+{
+	std::array<uint32_t, frame_profile_zone_count> us{};
+	/* The use of the worker pool in the frame.  Its wait time is within
+	 * the zones of the callers, so it is not part of total().
+	 */
+	parallel_stats parallel{};
+	/* The memory held by each mem_tag at the end of the frame, in KB */
+	std::array<uint32_t, mem_tag_count> mem_kb{};
+	std::array<uint32_t, frame_profile_counter_count> counts{};
+	uint32_t total() const
+	{
+		uint32_t t{};
+		for (const auto u : us)
+			t += u;
+		return t;
+	}
+};
+
+/* A ring of the last N samples.  Once full, each push drops the oldest
+ * sample.
+ */
+template <std::size_t N>
+class frame_profile_history
+{
+	std::array<frame_profile_sample, N> samples{};
+	std::size_t next{}, count{};
+public:
+	static constexpr std::size_t capacity()
+	{
+		return N;
+	}
+	std::size_t size() const
+	{
+		return count;
+	}
+	void clear()
+	{
+		next = count = 0;
+	}
+	void push(const frame_profile_sample &s)
+	{
+		samples[next] = s;
+		next = (next + 1) % N;
+		if (count < N)
+			++count;
+	}
+	/* Sample 0 is the oldest kept, size() - 1 the newest */
+	const frame_profile_sample &operator[](const std::size_t i) const
+	{
+		return samples[(next + N - count + i) % N];
+	}
+};
+
+using frame_profile_clock = std::chrono::steady_clock;
+
+extern bool frame_profile_enabled;
+
+class frame_profile_scope
+{
+	frame_profile_scope *parent;
+	frame_profile_clock::time_point start;
+	frame_profile_clock::duration nested{};
+	frame_profile_zone zone;
+	bool active;
+	void open();
+	void close();
+public:
+	frame_profile_scope(const frame_profile_zone z) :
+		zone(z), active(frame_profile_enabled)
+	{
+		if (active)
+			open();
+	}
+	~frame_profile_scope()
+	{
+		if (active)
+			close();
+	}
+	frame_profile_scope(const frame_profile_scope &) = delete;
+	frame_profile_scope &operator=(const frame_profile_scope &) = delete;
+};
+
+using frame_profile_game_history = frame_profile_history<256>;
+
+/* Register the console variables */
+void frame_profile_init();
+
+/* Commit the times of the frame just finished to the history, and pick
+ * up changes to the console variables.  Call once per frame, after
+ * rendering.
+ */
+void frame_profile_end_frame();
+
+/* Returns 0 when off, 1 when recording, 2 when also drawing the graph */
+unsigned frame_profile_mode();
+
+const frame_profile_game_history &frame_profile_get_history();
+
+/* The frames recorded since the program started, and their total time.
+ * Unlike the history, these only ever grow.
+ */
+struct frame_profile_totals
+{
+	uint64_t frames;
+	uint64_t us;
+};
+
+const frame_profile_totals &frame_profile_get_totals();
+
+const char *frame_profile_zone_name(frame_profile_zone);
+
+/* Add n to a counter of the current frame.  Main thread only. */
+void frame_profile_count(frame_profile_counter c, uint32_t n = 1);
+
+}
@@ -25,6 +25,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 #pragma once
 
+#include <span>
 #include "dsx-ns.h"
 #include "vecmat.h"
 
@@ -81,6 +82,16 @@ struct sphere_intersects_wall_result
 
 namespace dsx {
 
+//Object pairs seen by the object check of fvi: culled by the box swept by
+//the vector, tested against the object's sphere, and reported to
+//collide_two_objects after a hit.
+struct object_pair_counts
+{
+	unsigned long culled, tested, reported;
+};
+
+extern object_pair_counts Object_pair_counts;
+
 //this data contains the parms to fvi()
 struct fvi_query
 {
@@ -131,6 +142,12 @@ struct fvi_query
 [[nodiscard]]
 fvi_hit_type find_vector_intersection(fvi_query fq, segnum_t startseg, fix rad, fvi_info &hit_data);
 
+//Cast a vector from fq.p0 to each point of ends, with the rest of fq, as
+//find_vector_intersection would for each.  Checking that the start point
+//is in startseg is done once for all of them.  fates receives the hit
+//type of each vector, and hit_data, if not empty, the rest of each.
+void find_vector_intersections(const fvi_query &fq, segnum_t startseg, fix rad, std::span<const vms_vector> ends, std::span<fvi_hit_type> fates, std::span<fvi_info> hit_data);
+
 //finds the uv coords of the given point on the given seg & side
 //fills in u & v. if l is non-NULL fills it in also
 [[nodiscard]]
@@ -28,6 +28,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "maths.h"
 #include <chrono>
 #include <cstdint>
+#include <span>
 #include <type_traits>
 
 #ifdef DXX_BUILD_DESCENT
@@ -124,11 +125,22 @@ void reset_time();       // called when starting level
  */
 #ifdef DXX_BUILD_DESCENT
 // If automap_flag == 1, then call automap routine to write message.
-#if DXX_USE_SCREENSHOT_FORMAT_LEGACY
-void write_bmp(PHYSFS_File *, unsigned w, unsigned h);
-#endif
 void save_screen_shot(int automap_flag);
 #endif
+/* Return once every screenshot taken so far is queued for writing */
+void screenshot_finish_writes();
+/* Queue the screenshots finished since the last frame for writing, and
+ * the frame just shown, if frame capture is running
+ */
+void screenshot_after_flip();
+#if DXX_USE_OGL
+/* Start or stop writing every frame shown to a raw rgb24 file in the
+ * screenshot directory, for an encoder to turn into video.  Frames are
+ * dropped, and counted, rather than slow the game when the storage
+ * cannot keep up.
+ */
+void frame_capture_toggle();
+#endif
 #endif
 
 // force cockpit redraw next time. call this if you've trashed the screen
@@ -205,6 +217,8 @@ extern d_flickering_light_state Flickering_light_state;
 
 extern uint8_t BigWindowSwitch;
 void compute_slide_segs();
+// slide the textures of the sliding sides in these segments, by the game time since they were last seen
+void slide_visible_textures(std::span<const segnum_t> segments);
 
 // turn flickering off (because light has been turned off)
 void disable_flicker(d_flickering_light_state &fls, vmsegidx_t segnum, sidenum_t sidenum);
@@ -212,6 +226,9 @@ void disable_flicker(d_flickering_light_state &fls, vmsegidx_t segnum, sidenum_t
 // turn flickering off (because light has been turned on)
 void enable_flicker(d_flickering_light_state &fls, vmsegidx_t segnum, sidenum_t sidenum);
 
+// rebuild the list of lights that are not disabled
+void compute_active_flickers(d_flickering_light_state &fls);
+
 /*
  * reads a flickering_light structure from a PHYSFS_File
  */
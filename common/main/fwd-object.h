@@ -192,6 +192,8 @@ shortpos create_shortpos_native(const d_level_shared_segment_state &, const obje
 namespace dsx {
 // Draw a blob-type object, like a fireball
 void draw_object_blob(GameBitmaps_array &GameBitmaps, const object_base &Viewer, grs_canvas &, const object_base &obj, bitmap_index bitmap);
+// Draw a blob of the given size at a point, scaled to the shape of the bitmap
+void draw_blob(GameBitmaps_array &GameBitmaps, grs_canvas &, const vms_vector &pos, fix size, bitmap_index bitmap);
 
 // do whatever setup needs to be done
 void init_objects();
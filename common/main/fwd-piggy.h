@@ -102,6 +102,28 @@ extern std::array<digi_sound, MAX_SOUND_FILES> GameSounds;
 extern GameBitmaps_array GameBitmaps;
 void piggy_bitmap_page_in(GameBitmaps_array &, bitmap_index bmp);
 
+/* Queue a paged out bitmap to be paged in later by
+ * piggy_bitmap_service_prefetch, instead of when it is first drawn.
+ */
+void piggy_bitmap_request_prefetch(GameBitmaps_array &, bitmap_index bmp);
+
+/* Page in queued bitmaps until budget_us microseconds are spent, and
+ * return how many are still queued.  At least one is paged in.
+ */
+std::size_t piggy_bitmap_service_prefetch(GameBitmaps_array &, unsigned budget_us);
+
+/* Page in every bitmap in the list, which may repeat bitmaps and is
+ * reordered.  Bitmaps are read in file order, and when the PIG is
+ * memory mapped, they are copied and scanned on the worker threads.
+ */
+void piggy_bitmap_page_in_all(GameBitmaps_array &, std::span<bitmap_index> bitmaps);
+
+/* piggy_read_sounds only reserves space for the sounds.  Read the sound
+ * if it was not read yet, and return whether it has data.  The sound file
+ * is memory mapped when it is not in an archive.
+ */
+bool piggy_sound_page_in(sound_effect soundnum);
+
 #if DXX_BUILD_DESCENT == 1
 void piggy_read_sounds(int pc_shareware);
 #elif DXX_BUILD_DESCENT == 2
@@ -70,7 +70,9 @@ extern powerup_names_array Powerup_names;
 void draw_powerup(const d_vclip_array &Vclip, grs_canvas &, const object_base &obj);
 int do_powerup(vmobjptridx_t obj);
 
-//process (animate) a powerup for one frame
+//advance a powerup's animation by one frame.  It only touches the powerup.
+void do_powerup_animation(const d_vclip_array &Vclip, object_base &obj, objnum_t objnum);
+//process a powerup for one frame, after do_powerup_animation
 void do_powerup_frame(const d_vclip_array &Vclip, vmobjptridx_t obj);
 
 void do_megawow_powerup(object &plrobj, int quantity);
@@ -404,6 +404,12 @@ struct d_flickering_light_state
 	using Flickering_light_array_t = std::array<flickering_light, 100>;
 	unsigned Num_flickering_lights;
 	Flickering_light_array_t Flickering_lights;
+	/* Indices of the lights that are not disabled, in order, so that
+	 * flicker_lights does not visit the rest.  Rebuilt by
+	 * compute_active_flickers.
+	 */
+	unsigned Num_active_flickering_lights;
+	std::array<uint8_t, std::tuple_size<Flickering_light_array_t>::value> Active_flickering_lights;
 };
 #endif
 
@@ -445,6 +451,7 @@ struct game_cheats : prohibit_void_ptr<game_cheats>
 void game_render_frame(const d_robot_info_array &Robot_info, const control_info &Controls);
 void game_render_frame_mono(const d_robot_info_array &Robot_info, const control_info &Controls);
 window_event_result ReadControls(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, const d_event &event, control_info &Controls);
+void game_replay_ticks(unsigned ticks, unsigned seed);
 
 }
 #endif
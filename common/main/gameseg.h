@@ -30,8 +30,10 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "maths.h"
 #include "vecmat.h"
 #include "segment.h"
+#include "fwd-wall.h"
 
 #include <utility>
+#include <vector>
 #include "dxxsconf.h"
 #include "dsx-ns.h"
 #include "d_array.h"
@@ -212,10 +214,25 @@ icsegptridx_t find_point_seg(const d_level_shared_segment_state &, const vms_vec
 //      Return the distance.
 vm_distance find_connected_distance(const vms_vector &p0, vcsegptridx_t seg0, const vms_vector &p1, vcsegptridx_t seg1, int max_depth, wall_is_doorway_mask wid_flag);
 
-#if DXX_BUILD_DESCENT == 1
-static inline void flush_fcd_cache() {}
-#elif DXX_BUILD_DESCENT == 2
+//      The same as find_connected_distance, for many seg1 from one seg0.  Every segment reachable
+//      from seg0 is searched once, and the search is kept until seg0, wid_flag or a wall changes.
+vm_distance find_connected_distance_from(const vms_vector &p0, vcsegptridx_t seg0, const vms_vector &p1, vcsegptridx_t seg1, int max_depth, wall_is_doorway_mask wid_flag);
+
+//      Index the segments of the level by position, for the search of all segments in find_point_seg.
+void build_segment_grid(fvcsegptridx &vcsegptridx, fvcvertptr &vcvertptr);
+
+//      Fill `segments`, in segment order, with every segment whose bounds come within radius of p.
+//      Returns false, with `segments` empty, if there is no grid to search, and the caller must
+//      consider every segment.
+bool find_segments_near(const vms_vector &p, fix radius, std::vector<segnum_t> &segments);
+
+//      Forget the paths find_connected_distance remembers, as when the level changes.
 void flush_fcd_cache();
+
+//      A number that changes when the state of any wall changes, and on flush_fcd_cache, so that
+//      other searches through the walls know when what they remember is stale.
+uint32_t wall_state_generation(fvcwallptr &vcwallptr);
+#if DXX_BUILD_DESCENT == 2
 void apply_all_changed_light(const d_level_shared_destructible_light_state &LevelSharedDestructibleLightState, fvmsegptridx &vmsegptridx);
 void	set_ambient_sound_flags(void);
 #endif
@@ -89,6 +89,16 @@ window_event_result PlayerFinishedLevel(
 // called when the player has died
 window_event_result DoPlayerDead(void);
 
+/* Read the files of level `level_num` on a worker thread, so that
+ * loading it later does not wait on the disk.  Does nothing if that
+ * level is already being read.
+ */
+void gameseq_prefetch_level(int level_num);
+/* Prefetch the level after the current one, if there is one */
+void gameseq_prefetch_next_level();
+/* Stop the prefetch, if any, and wait for its file to close */
+void gameseq_cancel_level_prefetch();
+
 #if DXX_BUILD_DESCENT == 1
 #define gameseq_remove_unused_players(Robot_info)	gameseq_remove_unused_players()
 #undef PlayerFinishedLevel
@@ -78,6 +78,11 @@ extern std::array<bitmap_index, MAX_GAUGE_BMS> Gauges_hires;    // hires gauges
 void add_points_to_score(player_info &, unsigned points, game_mode_flags);
 void add_bonus_points_to_score(player_info &, unsigned points, game_mode_flags);
 void render_gauges(grs_canvas &, game_mode_flags game_mode);
+/* Put back the status bar kept from an earlier frame, if nothing that it
+ * shows has changed since.  Returns false, drawing nothing, if the status
+ * bar must be drawn with render_gauges.
+ */
+bool draw_retained_gauges(grs_canvas &, game_mode_flags game_mode);
 void init_gauges(void);
 void draw_hud(const d_robot_info_array &Robot_info, grs_canvas &, const object &, const control_info &Controls, game_mode_flags);     // draw all the HUD stuff
 }
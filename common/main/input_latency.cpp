@@ -0,0 +1,66 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * Input to present latency
+ *
+ */
+
+#include <optional>
+#include "input_latency.h"
+
+namespace dcx {
+
+namespace {
+
+std::optional<uint32_t> input_latency_event;
+std::optional<uint32_t> input_latency_pending;
+input_latency_histogram input_latency_samples;
+
+}
+
+void input_latency_begin_event(const uint32_t event_ms)
+{
+	input_latency_event = event_ms;
+}
+
+void input_latency_end_event()
+{
+	input_latency_event.reset();
+}
+
+void input_latency_consume()
+{
+	if (!input_latency_event)
+		return;
+	/* The tick counter wraps after 49 days, so compare by difference */
+	if (!input_latency_pending || static_cast<int32_t>(*input_latency_event - *input_latency_pending) < 0)
+		input_latency_pending = input_latency_event;
+}
+
+void input_latency_presented(const uint32_t now_ms)
+{
+	if (!input_latency_pending)
+		return;
+	const int32_t latency = static_cast<int32_t>(now_ms - *input_latency_pending);
+	input_latency_pending.reset();
+	input_latency_samples.add(latency < 0 ? 0 : latency);
+}
+
+void input_latency_clear()
+{
+	input_latency_samples.clear();
+	input_latency_pending.reset();
+}
+
+const input_latency_histogram &input_latency_get_histogram()
+{
+	return input_latency_samples;
+}
+
+}
@@ -0,0 +1,84 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Input to present latency.  The event loop records the time of each
+ * input event as it is dispatched.  When the controls take an event, its
+ * time is held until the frame is presented, and the difference is added
+ * to a histogram.  If several events feed one frame, the oldest counts.
+ *
+ * Times are in milliseconds of SDL_GetTicks, the clock of the SDL event
+ * timestamps.  Everything here runs on the main thread.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dcx {
+
+/* One bucket per millisecond.  The last bucket also holds every longer
+ * latency.
+ */
+class input_latency_histogram
+{
+public:
+	static constexpr std::size_t bucket_count{64};
+private:
+	std::array<uint32_t, bucket_count> buckets{};
+	uint32_t count{};
+public:
+	uint32_t size() const
+	{
+		return count;
+	}
+	void clear()
+	{
+		buckets = {};
+		count = 0;
+	}
+	void add(const uint32_t ms)
+	{
+		++buckets[ms < bucket_count ? ms : bucket_count - 1];
+		++count;
+	}
+	/* The latency that `percent` percent of the samples do not exceed.
+	 * Returns 0 if there are no samples.
+	 */
+	uint32_t percentile(const unsigned percent) const
+	{
+		const uint64_t wanted{(uint64_t{count} * percent + 99) / 100};
+		uint64_t seen{};
+		for (std::size_t i = 0; i != bucket_count; ++i)
+		{
+			seen += buckets[i];
+			if (seen >= wanted && seen)
+				return i;
+		}
+		return 0;
+	}
+};
+
+/* Called by the event loop before it dispatches an input event, and
+ * with no argument once the event is done.
+ */
+void input_latency_begin_event(uint32_t event_ms);
+void input_latency_end_event();
+
+/* Called by the controls when they use the event being dispatched */
+void input_latency_consume();
+
+/* Called when a frame has been presented */
+void input_latency_presented(uint32_t now_ms);
+
+/* Forget the samples taken so far, such as at the start of a level */
+void input_latency_clear();
+
+const input_latency_histogram &input_latency_get_histogram();
+
+}
@@ -0,0 +1,103 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * Files of derived level data in the write directory
+ *
+ */
+
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include "level_cache.h"
+#include "args.h"
+#include "console.h"
+#include "physfsx.h"
+
+namespace dcx {
+
+uint64_t Level_cache_key;
+
+namespace {
+
+constexpr char level_cache_directory[] = "levelcache";
+constexpr std::array<uint8_t, 4> level_cache_magic{{'D', 'X', 'L', 'C'}};
+
+/* levelcache/<key>.<kind> */
+using level_cache_path = std::array<char, sizeof(level_cache_directory) + 1 + 16 + 1 + 16>;
+
+bool level_cache_filename(level_cache_path &path, const char *const kind)
+{
+	if (!CGameArg.SysLevelCache || !Level_cache_key)
+		return false;
+	const auto n = std::snprintf(path.data(), path.size(), "%s/%016" PRIx64 ".%s", level_cache_directory, Level_cache_key, kind);
+	return n > 0 && static_cast<std::size_t>(n) < path.size();
+}
+
+}
+
+uint64_t level_cache_hash(const std::span<const uint8_t> data, uint64_t h)
+{
+	for (const auto b : data)
+	{
+		h ^= b;
+		h *= 0x100000001b3ull;
+	}
+	return h;
+}
+
+bool level_cache_read(const char *const kind, const uint32_t version, const std::span<uint8_t> out)
+{
+	level_cache_path path;
+	if (!level_cache_filename(path, kind))
+		return false;
+	auto [fp, err] = PHYSFSX_openReadBuffered(path.data());
+	if (!fp)
+		return false;
+	std::array<uint8_t, 4> magic;
+	PHYSFS_uint32 file_version;
+	PHYSFS_uint64 key, size;
+	if (PHYSFS_readBytes(fp, magic.data(), magic.size()) != static_cast<PHYSFS_sint64>(magic.size()) || magic != level_cache_magic ||
+		!PHYSFS_readULE32(fp, &file_version) || file_version != version ||
+		!PHYSFS_readULE64(fp, &key) || key != Level_cache_key ||
+		!PHYSFS_readULE64(fp, &size) || size != out.size() ||
+		PHYSFS_readBytes(fp, out.data(), out.size()) != static_cast<PHYSFS_sint64>(out.size()))
+	{
+		con_printf(CON_VERBOSE, "Level cache: ignoring \"%s\"", path.data());
+		return false;
+	}
+	con_printf(CON_VERBOSE, "Level cache: read \"%s\"", path.data());
+	return true;
+}
+
+void level_cache_write(const char *const kind, const uint32_t version, const std::span<const uint8_t> data)
+{
+	level_cache_path path;
+	if (!level_cache_filename(path, kind))
+		return;
+	PHYSFS_mkdir(level_cache_directory);
+	RAIIPHYSFS_File fp{PHYSFS_openWrite(path.data())};
+	if (!fp)
+	{
+		con_printf(CON_URGENT, "Level cache: failed to write \"%s\": %s", path.data(), PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+		return;
+	}
+	/* The key is written last, so a file cut short never matches */
+	PHYSFS_writeBytes(fp, level_cache_magic.data(), level_cache_magic.size());
+	PHYSFS_writeULE32(fp, version);
+	PHYSFS_writeULE64(fp, 0);
+	PHYSFS_writeULE64(fp, data.size());
+	if (PHYSFS_writeBytes(fp, data.data(), data.size()) != static_cast<PHYSFS_sint64>(data.size()) ||
+		!PHYSFS_seek(fp, level_cache_magic.size() + sizeof(PHYSFS_uint32)) ||
+		!PHYSFS_writeULE64(fp, Level_cache_key))
+		con_printf(CON_URGENT, "Level cache: failed to write \"%s\": %s", path.data(), PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+	else
+		con_printf(CON_VERBOSE, "Level cache: wrote \"%s\"", path.data());
+}
+
+}
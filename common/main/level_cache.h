@@ -0,0 +1,40 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Data derived from a level's mine, kept in files in the write directory
+ * so that later loads of the same mine can read it back instead of
+ * computing it again.  Each file is named by a hash of the mine data it
+ * was derived from, so an edited level never picks up a stale file.
+ *
+ * The cache is only used with -levelcache.  Files hold host order data
+ * and are not meant to be moved between machines.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace dcx {
+
+/* Hash of the mine of the level being loaded, set by the mine loader.
+ * Zero when no mine has been loaded from a file.
+ */
+extern uint64_t Level_cache_key;
+
+uint64_t level_cache_hash(std::span<const uint8_t> data, uint64_t h = 0xcbf29ce484222325ull);
+
+/* Fill `out` from the `kind` file of the current mine.  Returns false,
+ * leaving `out` unspecified, unless the file exists, was written with
+ * this `version`, and holds exactly out.size() bytes.
+ */
+bool level_cache_read(const char *kind, uint32_t version, std::span<uint8_t> out);
+
+/* Write `data` as the `kind` file of the current mine */
+void level_cache_write(const char *kind, uint32_t version, std::span<const uint8_t> data);
+
+}
@@ -75,6 +75,8 @@ g3s_lrgb compute_object_light(const d_level_unique_light_state &LevelUniqueLight
 #if DXX_BUILD_DESCENT == 2
 void toggle_headlight_active(object &);
 #endif
+// forget the light cached for sources that stay put, when a level is loaded
+void reset_dynamic_light_cache();
 }
 void start_lighting_frame(const object &viewer);
 #endif
@@ -0,0 +1,155 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * Timing of level entry
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "load_trace.h"
+#include "console.h"
+#include "cvar.h"
+#include "physfsx.h"
+
+namespace dcx {
+
+namespace {
+
+using load_trace_clock = std::chrono::steady_clock;
+
+struct load_trace_record
+{
+	const char *name;
+	/* The span that this span waited for, or nullptr */
+	const char *waits_for;
+	unsigned thread;
+	unsigned depth;
+	load_trace_clock::time_point start, end;
+};
+
+cvar_t load_trace_json_cvar{"load_trace_json", "", CVAR_NONE, 0, 0};
+
+std::mutex load_trace_mutex;
+/* The spans of the trace in progress, in the order they opened */
+std::vector<load_trace_record> load_trace_records;
+/* The spans open on all threads */
+unsigned load_trace_open;
+std::atomic<unsigned> load_trace_thread_count;
+thread_local const unsigned load_trace_thread{++load_trace_thread_count};
+thread_local unsigned load_trace_depth;
+
+unsigned long load_trace_us(const load_trace_clock::duration d)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+void load_trace_write_json(const char *const filename, const std::vector<load_trace_record> &records)
+{
+	auto &&[file, physfserr] = PHYSFSX_openWriteBuffered(filename);
+	if (!file)
+	{
+		con_printf(CON_URGENT, "load_trace: failed to open \"%s\" for writing: %s", filename, PHYSFS_getErrorByCode(physfserr));
+		return;
+	}
+	const auto origin{records.front().start};
+	PHYSFSX_puts_literal(file, "{\"traceEvents\":[\n");
+	const char *separator{""};
+	for (auto &r : records)
+	{
+		PHYSFSX_printf(file, "%s{\"name\":\"%s%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lu,\"dur\":%lu}", separator, r.name, r.waits_for ? r.waits_for : "", r.thread, load_trace_us(r.start - origin), load_trace_us(r.end - r.start));
+		separator = ",\n";
+	}
+	PHYSFSX_puts_literal(file, "\n]}\n");
+}
+
+/* Follow the stages of the first span.  A stage that waited for another
+ * thread is replaced by the span it waited for, since that span, not the
+ * waiting thread, set the time.
+ */
+void load_trace_print_critical_path(const std::vector<load_trace_record> &records)
+{
+	const auto &root = records.front();
+	con_printf(CON_VERBOSE, "load: critical path of %s, %lu us:", root.name, load_trace_us(root.end - root.start));
+	for (auto &r : records)
+	{
+		if (r.thread != root.thread || r.depth != root.depth + 1)
+			continue;
+		if (!r.waits_for)
+		{
+			con_printf(CON_VERBOSE, "load:   %s %lu us", r.name, load_trace_us(r.end - r.start));
+			continue;
+		}
+		const auto w{std::ranges::find_if(records, [&r](const load_trace_record &t) {
+			return t.thread != r.thread && !std::strcmp(t.name, r.waits_for);
+		})};
+		if (w == records.end())
+			continue;
+		con_printf(CON_VERBOSE, "load:   %s %lu us on thread %u, waited %lu us", w->name, load_trace_us(w->end - w->start), w->thread, load_trace_us(r.end - r.start));
+	}
+}
+
+void load_trace_finish(const std::vector<load_trace_record> &records)
+{
+	for (auto &r : records)
+		if (r.waits_for)
+			con_printf(CON_VERBOSE, "load: [%u] %*s%s%s %lu us", r.thread, static_cast<int>(2 * r.depth), "", r.name, r.waits_for, load_trace_us(r.end - r.start));
+		else
+			con_printf(CON_VERBOSE, "load: [%u] %*s%s %lu us", r.thread, static_cast<int>(2 * r.depth), "", r.name, load_trace_us(r.end - r.start));
+	if (std::ranges::any_of(records, [](const load_trace_record &r) { return r.waits_for != nullptr; }))
+		load_trace_print_critical_path(records);
+	if (!load_trace_json_cvar.string.empty())
+		load_trace_write_json(load_trace_json_cvar.string.c_str(), records);
+}
+
+std::size_t load_trace_open_span(const char *const name, const char *const waits_for)
+{
+	const std::lock_guard lock{load_trace_mutex};
+	++load_trace_open;
+	load_trace_records.emplace_back(load_trace_record{name, waits_for, load_trace_thread, load_trace_depth++, load_trace_clock::now(), {}});
+	return load_trace_records.size() - 1;
+}
+
+}
+
+load_trace_span::load_trace_span(const char *const name) :
+	index{load_trace_open_span(name, nullptr)}
+{
+}
+
+load_trace_span::load_trace_span(const char *const name, const char *const waits_for) :
+	index{load_trace_open_span(name, waits_for)}
+{
+}
+
+load_trace_span::~load_trace_span()
+{
+	--load_trace_depth;
+	std::vector<load_trace_record> finished;
+	{
+		const std::lock_guard lock{load_trace_mutex};
+		load_trace_records[index].end = load_trace_clock::now();
+		if (--load_trace_open)
+			return;
+		finished = std::exchange(load_trace_records, {});
+	}
+	load_trace_finish(finished);
+}
+
+void load_trace_init()
+{
+	cvar_registervariable(load_trace_json_cvar);
+}
+
+}
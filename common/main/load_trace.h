@@ -0,0 +1,43 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Timing of level entry and of startup.  Each stage of loading opens a
+ * load_trace_span with a static name.  Spans nest.  When the last open
+ * span closes, the tree of spans is written to the console at verbose
+ * level, and, if the console variable load_trace_json names a file,
+ * written there as a Chrome trace (load it in chrome://tracing or
+ * Perfetto).
+ *
+ * Spans may be opened on any thread.  A thread that waits for a stage
+ * running on another thread opens a span with load_trace_wait, so that
+ * the console listing can show which stages were on the critical path.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace dcx {
+
+class load_trace_span
+{
+	std::size_t index;
+public:
+	explicit load_trace_span(const char *name);
+	/* A span for the time spent waiting on the span `waits_for`, which
+	 * runs on another thread.
+	 */
+	load_trace_span(const char *name, const char *waits_for);
+	~load_trace_span();
+	load_trace_span(const load_trace_span &) = delete;
+	load_trace_span &operator=(const load_trace_span &) = delete;
+};
+
+/* Register the console variables */
+void load_trace_init();
+
+}
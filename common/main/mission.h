@@ -256,6 +256,25 @@ struct mission_entry_predicate
 //Returns nullptr if mission loaded ok, else error string.
 const char *load_mission_by_name (mission_entry_predicate mission_name, mission_name_type);
 
+/* Scanning the missions directory opens every mission file, which is
+ * slow with many missions.  This starts the scan on a background
+ * thread, keeping the header of each mission in a cache that
+ * build_mission_list then reads instead of the files.  The cache is
+ * kept in missions.cache, and a file is only opened again when its size
+ * or modification time changes.  The scan is waited for when a mission
+ * list is built, or when the returned object is destroyed.
+ */
+struct mission_list_scan
+{
+	mission_list_scan() = default;
+	mission_list_scan(const mission_list_scan &) = delete;
+	mission_list_scan &operator=(const mission_list_scan &) = delete;
+	~mission_list_scan();
+};
+
+[[nodiscard]]
+mission_list_scan mission_list_start_scan();
+
 #if DXX_USE_EDITOR
 void create_new_mission(void);
 #endif
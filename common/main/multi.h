@@ -157,7 +157,7 @@ static inline player_ship_color get_team_color(const team_number tnum)
 }
 
 // What version of the multiplayer protocol is this? Increment each time something drastic changes in Multiplayer without the version number changes. Reset to 0 each time the version of the game changes
-constexpr std::uint16_t MULTI_PROTO_VERSION{16};
+constexpr std::uint16_t MULTI_PROTO_VERSION{22};
 // PROTOCOL VARIABLES AND DEFINES - END
 
 // limits for Packets (i.e. positional updates) per sec
@@ -519,6 +519,8 @@ void multi_prep_level_objects(const d_powerup_info_array &Powerup_info, const d_
 void multi_prep_level_player();
 void multi_leave_game(void);
 void multi_process_bigdata(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, playernum_t pnum, std::span<const uint8_t> buf);
+/* The name of multiplayer command `type`, or nullptr if there is none */
+const char *multi_command_name(uint8_t type);
 void multi_make_ghost_player(playernum_t);
 void multi_make_player_ghost(playernum_t);
 }
@@ -701,6 +703,21 @@ void multi_send_kill_goal_counts();
 #ifdef DXX_BUILD_DESCENT
 namespace dsx {
 extern bool MultiLevelInv_AllowSpawn(powerup_type_t powerup_type);
+/* Note that the object in `objnum` was created, deleted, or changed what
+ * it holds, so that the next recount counts it again.
+ */
+void MultiLevelInv_ObjectChanged(objnum_t objnum);
+/* Note that every object was replaced, as when a level is loaded */
+void MultiLevelInv_ObjectsReplaced();
+/* Note that the object in `objnum` was created, deleted, moved to
+ * another segment or replaced, so that its share of the world checksum
+ * is taken again before the checksum is next sent.
+ */
+void multi_world_checksum_object_changed(objnum_t objnum);
+/* Note that every object was replaced, and forget the checksums of the
+ * last level.
+ */
+void multi_world_checksum_objects_replaced();
 netflag_flag multi_powerup_is_allowed(powerup_type_t id, const netflag_flag AllowedItems);
 netflag_flag multi_powerup_is_allowed(powerup_type_t id, const netflag_flag AllowedItems, const netflag_flag SpawnGrantedItems);
 void show_netgame_info(const netgame_info &netgame);
@@ -863,6 +880,10 @@ struct netgame_info : prohibit_void_ptr<netgame_info>
 	uint8_t	PacketsPerSec{30};
 	ubyte						PacketLossPrevention;
 	ubyte						NoFriendlyFire;
+	/* Show remote players a little in the past, blended between the
+	 * positions received, instead of jumping to each one as it arrives.
+	 */
+	ubyte						SmoothPositions;
 	per_team_array<callsign_t>						team_name;
 	per_player_array<uint32_t>						locations;
 	per_player_array<per_player_array<uint16_t>>	kills;
@@ -71,6 +71,7 @@
 	VALUE(MULTI_VULWPN_AMMO_ADJ      , 6)	\
         VALUE(MULTI_PLAYER_INV           , DXX_MP_SIZE_PLAYER_INVENTORY)	\
 	D2X_MP_COMMANDS(VALUE)	\
+	VALUE(MULTI_WORLD_CHECKSUM       , 13)	/* (uint objects, uint walls, uint players) */	\
 
 #if DXX_BUILD_DESCENT == 1
 #define DXX_MP_SIZE_ENDLEVEL_START	3
@@ -51,6 +51,19 @@ using udp::dispatch;
 }
 
 window_event_result net_udp_setup_game(void);
+/* Print the traffic counts of the netgame to the console, then clear
+ * them if `reset`.
+ */
+void net_udp_print_stats(bool reset);
+/* Draw the traffic counts over the game, when the net_stats console
+ * variable asks for it.
+ */
+void net_udp_show_stats(grs_canvas &canvas);
+/* Host a game of `levelnum` of `mission` without asking anything, for
+ * the host console command.  The settings come from the netgame
+ * profile, and players join the game in progress.
+ */
+void net_udp_host_game(const char *mission, int levelnum);
 }
 #endif
 void net_udp_manual_join_game();
@@ -74,6 +87,45 @@ enum class tracker_game_id : uint16_t
 #endif
 #define UDP_MAX_NETGAMES 900
 constexpr std::integral_constant<unsigned, 12> UDP_NETGAMES_PPAGE{}; // Netgames on one page of Netlist
+
+struct net_udp_traffic_counter
+{
+	uint32_t count;
+	uint32_t bytes;
+};
+
+/* Round trip times are counted in buckets of under 25ms, under 50ms and
+ * so on, doubling each time.  The last bucket holds everything longer.
+ */
+constexpr std::size_t net_udp_rtt_buckets = 8;
+
+/* Counts of the traffic of the current netgame, cleared when a netgame
+ * starts.
+ */
+struct net_udp_traffic_stats
+{
+	fix64 start_time;
+	/* By upid, the first byte of each datagram */
+	std::array<net_udp_traffic_counter, 256> upid_sent, upid_received;
+	/* By multiplayer_command_t, the first byte of each message carried
+	 * in mdata.
+	 */
+	std::array<net_udp_traffic_counter, 256> command_sent, command_received;
+	uint32_t mdata_resends;
+	unsigned mdata_queue_peak;
+	std::array<uint32_t, net_udp_rtt_buckets> rtt;
+};
+
+extern net_udp_traffic_stats Net_udp_traffic_stats;
+
+static inline void net_udp_count_traffic(std::array<net_udp_traffic_counter, 256> &counters, const uint8_t type, const std::size_t bytes, const unsigned n = 1)
+{
+	auto &c = counters[type];
+	c.count += n;
+	c.bytes += bytes * n;
+}
+
+void net_udp_stats_init();
 }
 #define UDP_NETGAMES_PAGES 75 // Pages available on Netlist (UDP_MAX_NETGAMES/UDP_NETGAMES_PPAGE)
 #define UDP_TIMEOUT (5*F1_0) // 5 seconds disconnect timeout
@@ -84,7 +136,7 @@ constexpr std::integral_constant<unsigned, 12> UDP_NETGAMES_PPAGE{}; // Netgames
 
 // UDP-Packet identificators (ubyte) and their (max. sizes).
 #define UPID_MAX_SIZE			       1024 // Max size for a packet
-#define UPID_MDATA_BUF_SIZE			454
+#define UPID_MDATA_BUF_SIZE			1016 // sizeof(UDP_mdata_info) == UPID_MAX_SIZE
 #if DXX_USE_TRACKER
 #define UPID_TRACKER_REGISTER			 21 // Register or update a game on the tracker.
 #define UPID_TRACKER_REMOVE			 22 // Remove our game from the tracker.
@@ -133,6 +185,7 @@ struct UDP_mdata_info : prohibit_void_ptr<UDP_mdata_info>
 	uint32_t			pkt_num;
 	std::array<uint8_t, UPID_MDATA_BUF_SIZE> mbuf;
 };
+static_assert(sizeof(UDP_mdata_info) <= UPID_MAX_SIZE, "mdata packets must fit the receive buffer");
 
 #ifdef DXX_BUILD_DESCENT
 // structure to store MDATA to maybe resend
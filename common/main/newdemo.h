@@ -60,6 +60,8 @@ extern int NewdemoFrameCount;
 extern int Newdemo_vcr_state;
 extern sbyte Newdemo_do_interpolate;
 extern int Newdemo_show_percentage;
+// Set while -timedemo plays: each recorded frame is shown once, unpaced
+extern bool Newdemo_timedemo;
 
 //Does demo start automatically?
 extern int Auto_demo;
@@ -84,6 +86,8 @@ void newdemo_record_viewer_object(vcobjptridx_t obj);
 icobjptridx_t newdemo_find_object(object_signature_t signature);
 void newdemo_record_kill_sound_linked_to_object(vcobjptridx_t);
 void newdemo_start_playback(const char *filename);
+/* Play `filename` as a time demo, then report the frame times and quit */
+void newdemo_start_timedemo(const char *filename);
 void newdemo_record_morph_frame(vcobjptridx_t);
 }
 void newdemo_record_sound_3d_once(sound_effect soundno, sound_pan angle, int volume );
@@ -144,6 +148,8 @@ extern window_event_result newdemo_playback_one_frame();
 #ifdef DXX_BUILD_DESCENT
 namespace dsx {
 extern window_event_result newdemo_goto_end(int to_rewrite);
+/* Move playback by `seconds` of recording, forward or backward */
+window_event_result newdemo_seek(int seconds);
 }
 #endif
 extern window_event_result newdemo_goto_beginning();
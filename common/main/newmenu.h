@@ -356,6 +356,7 @@ struct newmenu : newmenu_layout, window, mixin_trackable_window
 	}
 	std::shared_ptr<int> rval;			// Pointer to return value (for polling newmenus)
 	virtual window_event_result event_handler(const d_event &) override;
+	virtual unsigned get_idle_wait() const override;
 	static int process_until_closed(newmenu *);
 };
 
@@ -565,6 +566,7 @@ struct listbox : listbox_layout, window
 	uint8_t mouse_state{0};
 	marquee::ptr marquee;
 	virtual window_event_result event_handler(const d_event &) override;
+	virtual unsigned get_idle_wait() const override;
 	virtual window_event_result callback_handler(const d_event &, window_event_result default_return_value) = 0;
 };
 
@@ -54,6 +54,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "escort.h"
 #endif
 #include <array>
+#include <span>
 #include <utility>
 
 namespace dcx {
@@ -774,6 +775,69 @@ window_event_result dead_player_frame(const d_robot_info_array &Robot_info);
 window_event_result game_move_all_objects(const d_level_shared_robot_info_state &LevelSharedRobotInfoState);     // moves all objects
 window_event_result endlevel_move_all_objects(const d_level_shared_robot_info_state &LevelSharedRobotInfoState);
 
+// While it lives, draw objects that move in fixed steps (-physicstick)
+// between their places before and after the last step
+class object_tick_interpolation
+{
+	struct saved_place
+	{
+		vmobjidx_t objnum;
+		vms_vector pos;
+		vms_matrix orient;
+	};
+	std::vector<saved_place> saved;
+public:
+	explicit object_tick_interpolation(object_array &Objects);
+	~object_tick_interpolation();
+	object_tick_interpolation(const object_tick_interpolation &) = delete;
+	object_tick_interpolation &operator=(const object_tick_interpolation &) = delete;
+};
+
+/* The type, signature and segment of each object slot, in arrays of their
+ * own, so that a scan for objects of some type reads a byte per slot
+ * instead of a cache line of each object.  Linking an object and deleting
+ * it keep an entry current, as does every direct change of a live object's
+ * type.  object_move_all refreshes the whole table, for objects loaded in
+ * place from a file or the network.  Positions are not kept here, because
+ * too much code moves objects directly.
+ */
+struct object_hot_fields
+{
+	std::array<object_type_t, MAX_OBJECTS> type;
+	std::array<object_signature_t, MAX_OBJECTS> signature;
+	std::array<segnum_t, MAX_OBJECTS> segnum;
+	void update(vcobjptridx_t obj);
+	void refresh(const object_array &Objects);
+	/* Whether the object in slot objnum may be of type t.  Use it to skip
+	 * slots before reading the object itself.
+	 */
+	bool is(const objnum_t objnum, const object_type_t t) const
+	{
+		return type[objnum] == t;
+	}
+};
+
+extern object_hot_fields Object_hot_fields;
+
+/* The objects linked into each segment, newest first, in the same order
+ * as objects_in.  obj_link_unchecked and obj_unlink keep it beside the
+ * object::next/prev lists, so a scan of one segment reads a short
+ * contiguous array instead of following links across Objects.  Code
+ * which empties a segment by assigning unique_segment::objects directly
+ * leaves stale entries here; they are dropped when the segment's list
+ * is next seen empty.
+ */
+class segment_object_index
+{
+	per_segment_array<std::vector<objnum_t>> objects;
+public:
+	void link(vcsegptridx_t segnum, objnum_t objnum);
+	void unlink(segnum_t segnum, objnum_t objnum);
+	std::span<const objnum_t> in(vcsegptridx_t segnum) const;
+};
+
+extern segment_object_index Segment_object_index;
+
 }
 
 namespace dcx {
@@ -30,10 +30,17 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #ifdef DXX_BUILD_DESCENT
 
 #include "fwd-vclip.h"
+#include "fwd-segment.h"
 
 namespace dsx {
 void paging_touch_all(const d_vclip_array &Vclip);
 
+/* Queue the bitmaps that the player may soon see for background
+ * page-in, and spend a small budget paging in queued bitmaps.  Call once
+ * per frame, outside rendering.
+ */
+void paging_prefetch_frame(const d_vclip_array &Vclip, vcsegidx_t player_segnum);
+
 }
 #endif
 
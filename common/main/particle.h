@@ -0,0 +1,54 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* Cosmetic fireballs that need no object.  An effect particle plays a
+ * vclip at a point for its lifetime, and may drift.  It does not
+ * collide, cast light, damage anything, or take an object slot, so a
+ * fight full of sparks cannot crowd out the objects that matter.  When
+ * the pool is full, the particle nearest the end of its life is
+ * replaced.
+ *
+ * The particles are moved with the objects, and drawn with the objects
+ * of the segment they are in.  Demos record objects, so while a demo is
+ * being recorded, the effects are created as objects instead.
+ */
+
+#pragma once
+
+#include "fwd-gr.h"
+#include "fwd-segment.h"
+#include "fwd-vclip.h"
+#include "fwd-vecmat.h"
+#include "maths.h"
+
+#ifdef DXX_BUILD_DESCENT
+namespace dsx {
+
+/* Create a fireball with no damage, as
+ * object_create_explosion_without_damage, for a caller that does not
+ * need the object.  If `lifetime` is not -1, it replaces the play time
+ * of the vclip.  Fireballs that light their surroundings are still made
+ * objects, because particles do not cast light.
+ */
+void create_cosmetic_explosion(const d_vclip_array &Vclip, vmsegptridx_t segnum, const vms_vector &position, fix size, vclip_index vclip_type, fix lifetime = -1);
+
+/* Create a particle, unconditionally.  `velocity` may be zero.  A
+ * particle that drifts out of the mine is dropped.
+ */
+void effect_particle_create(vcsegidx_t segnum, const vms_vector &position, const vms_vector &velocity, fix size, vclip_index vclip_type, fix lifetime);
+
+/* Age and move every particle by `frametime` */
+void effect_particles_move(fix frametime);
+/* Whether any particle is in `segnum` */
+bool effect_particles_in(segnum_t segnum);
+/* Draw the particles in `segnum`, with the settings fireball objects use */
+void effect_particles_render(const d_vclip_array &Vclip, grs_canvas &canvas, segnum_t segnum);
+/* Drop every particle, as when the level changes */
+void effect_particles_clear();
+
+}
+#endif
@@ -109,6 +109,12 @@ enum class properties_init_result : bool
 
 properties_init_result properties_init(d_level_shared_robot_info_state &LevelSharedRobotInfoState);
 
+/* Read the data files that properties_init and piggy_read_sounds open,
+ * so that they come from cache.  It changes no game state, so startup
+ * runs it on its own thread.
+ */
+void piggy_read_ahead();
+
 #if DXX_BUILD_DESCENT == 2
 enum class pig_hamfile_version : uint8_t
 {
@@ -28,9 +28,11 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "fwd-piggy.h"
 #include "vecmat.h"
 #include "3d.h"
+#include "interp.h"
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <vector>
 #include "d_array.h"
 #include "inferno.h"
 #include "pack.h"
@@ -83,6 +85,25 @@ enum class submodel_index : uint8_t
 template <typename T>
 using per_submodel_array = enumerated_array<T, MAX_SUBMODELS, submodel_index>;
 
+struct polygon_model_draw_range
+{
+	uint32_t begin, end;
+};
+
+/* Empty if the model data could not be decoded, in which case the model is
+ * drawn by the interpreter.
+ */
+struct polygon_model_draw_list
+{
+	std::vector<polygon_model_draw_op> ops;
+	polygon_model_draw_range model;
+	std::array<polygon_model_draw_range, MAX_SUBMODELS> submodels;
+	std::span<const polygon_model_draw_op> operator[](const polygon_model_draw_range r) const
+	{
+		return std::span(ops).subspan(r.begin, r.end - r.begin);
+	}
+};
+
 //used to describe a polygon model
 struct polymodel : prohibit_void_ptr<polymodel>
 {
@@ -102,6 +123,7 @@ struct polymodel : prohibit_void_ptr<polymodel>
 	ubyte   n_textures;
 	uint8_t n_models;
 	polygon_simpler_model_index simpler_model;                      // alternate model with less detail (0 if none, model_num+1 else)
+	polygon_model_draw_list draw_list;
 	//vms_vector min,max;
 };
 
@@ -134,6 +156,11 @@ void init_polygon_models(d_level_shared_polygon_model_state &);
  */
 void align_polygon_model_data(polymodel *pm);
 
+/* Decodes the model data into pm.draw_list.  The list is left empty if the
+ * model data is not valid.
+ */
+void build_polygon_model_draw_list(polymodel &pm);
+
 }
 #ifdef DXX_BUILD_DESCENT
 namespace dsx {
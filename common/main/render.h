@@ -131,6 +131,15 @@ void render_start_frame(void);
 // this frame
 g3s_codes rotate_list(fvcvertptr &vcvertptr, std::span<const vertnum_t> pointnumlist);
 
+// How many objects render_mine drew, and how many it skipped because
+// their bounding sphere was outside every window they could be seen
+// through or behind the view, since the last call.  For -renderstats.
+struct render_object_cull_stats
+{
+	unsigned drawn, outside_window, behind;
+};
+render_object_cull_stats render_take_object_cull_stats();
+
 #ifdef DXX_BUILD_DESCENT
 namespace dsx {
 void render_frame(grs_canvas &, fix eye_offset, window_rendered_data &);  //draws the world into the current canvas
@@ -144,5 +153,13 @@ void draw_object_tmap_rod(grs_canvas &, const d_level_unique_light_state *const
 
 void draw_hostage(const d_vclip_array &Vclip, grs_canvas &, const d_level_unique_light_state &, vmobjptridx_t obj);
 void draw_morph_object(grs_canvas &, const d_level_unique_light_state &LevelUniqueLightState, vmobjptridx_t obj);
+// Precompute which segments can see each other for -pvs
+void build_segment_visibility(fvcsegptridx &vcsegptridx, fvcvertptr &vcvertptr);
+// Forget the segment lists kept for views that have not moved
+void invalidate_render_list_cache();
+#if DXX_USE_OGL
+// Upload the level's wall corners for -gl_staticgeometry
+void build_static_geometry(fvcsegptridx &vcsegptridx, fvcvertptr &vcvertptr);
+#endif
 }
 #endif
@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include <vector>
 #include "dxxsconf.h"
+#include "frame_arena.h"
 #include "fwd-segment.h"
 #include "fwd-robot.h"
 #include "objnum.h"
@@ -25,7 +26,7 @@ struct render_state_t
 		{
 			objnum_t objnum;
 		};
-		std::vector<distant_object> objects;
+		std::vector<distant_object, frame_arena_allocator<distant_object>> objects;
 		uint16_t Seg_depth{0};		//depth for this seg in Render_list
 		bool processed = false;		//whether this entry has been processed
 		rect render_window;
@@ -33,7 +34,8 @@ struct render_state_t
 	unsigned N_render_segs{0};
 	std::array<segnum_t, MAX_RENDER_SEGS> Render_list;
 	std::array<short, MAX_SEGMENTS> render_pos;	//where in render_list does this segment appear?
-	std::unordered_map<segnum_t, per_segment_state_t> render_seg_map;
+	/* Rebuilt every view, so kept in the frame arena */
+	std::unordered_map<segnum_t, per_segment_state_t, std::hash<segnum_t>, std::equal_to<segnum_t>, frame_arena_allocator<std::pair<const segnum_t, per_segment_state_t>>> render_seg_map;
 };
 
 }
@@ -143,6 +143,12 @@ struct shared_side
 	side_type type;           // replaces num_faces and tri_edge, 1 = quad, 2 = 0:2 triangulation, 3 = 1:3 triangulation
 	wallnum_t wall_num;
 	std::array<vms_vector, 2> normals;  // 2 normals, if quadrilateral, both the same.
+	/* Set with type and normals: the absolute vertex numbers of the faces,
+	 * as create_abs_vertex_lists returns them, and the lowest vertex of the
+	 * faces, which fvi uses as the point on the plane of either face.
+	 */
+	std::array<vertnum_t, 6> face_vertices;
+	vertnum_t plane_vertex;
 };
 
 enum class sidenum_t : uint8_t
@@ -0,0 +1,59 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/* In-memory copies of the mutable state of the current level: objects,
+ * players, walls, doors, triggers, AI and the random number generator.
+ * A snapshot holds only the segments that differ from a copy taken the
+ * first time a snapshot is taken on the level, so most of its size is the
+ * live objects.
+ *
+ * Snapshots back the console quick save and the single player rewind
+ * buffer.  They are never written to disk, and are not a replacement for
+ * the savegame, which also records the mission and the ship between
+ * levels.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "dsx-ns.h"
+
+#ifdef DXX_BUILD_DESCENT
+namespace dsx {
+
+struct level_snapshot;
+
+struct level_snapshot_deleter
+{
+	void operator()(level_snapshot *) const;
+};
+
+using level_snapshot_ptr = std::unique_ptr<level_snapshot, level_snapshot_deleter>;
+
+/* Returns null unless a single player game is running on a level, with
+ * the player alive.
+ */
+level_snapshot_ptr level_snapshot_take();
+
+/* Returns false, changing nothing, if `s` was taken on another level or
+ * the game cannot be restored now.
+ */
+bool level_snapshot_restore(const level_snapshot &s);
+
+std::size_t level_snapshot_size(const level_snapshot &s);
+
+/* Register the console commands and the rewind_seconds variable */
+void level_snapshot_init();
+
+/* Called once per game frame, before anything moves, to keep the rewind
+ * buffer filled.
+ */
+void level_snapshot_poll();
+
+}
+#endif
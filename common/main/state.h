@@ -81,6 +81,8 @@ enum class deny_save_result : bool
 };
 
 int state_get_game_id(const d_game_unique_state::savegame_file_path &filename);
+/* Wait until the last autosave is on disk */
+void state_wait_for_autosave();
 
 }
 
@@ -45,6 +45,8 @@ namespace dsx {
 
 [[nodiscard]]
 grs_bitmap &texmerge_get_cached_bitmap(GameBitmaps_array &GameBitmaps, const Textures_array &Textures, texture1_value tmap_bottom, texture2_value tmap_top);
+/* Merge the overlays of every side of the mine, until the cache is full */
+void texmerge_cache_level_textures(GameBitmaps_array &GameBitmaps, const Textures_array &Textures);
 
 }
 #endif
@@ -31,6 +31,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "dxxsconf.h"
 #include "fwd-valptridx.h"
 #include "fwd-vclip.h"
+#include "fwd-vecmat.h"
 #include "fwd-weapon.h"
 
 #ifdef DXX_BUILD_DESCENT
@@ -72,6 +73,8 @@ struct vclip : public prohibit_void_ptr<vclip>
 namespace dsx {
 // draw an object which renders as a vclip.
 void draw_vclip_object(grs_canvas &, vcobjptridx_t obj, fix timeleft, const vclip &);
+// draw a vclip as a sprite at a point, with no object.  The vclip must not be a rod.
+void draw_vclip_sprite(grs_canvas &, const vms_vector &pos, fix size, fix timeleft, const vclip &);
 void draw_weapon_vclip(const d_vclip_array &Vclip, const weapon_info_array &Weapon_info, grs_canvas &, vcobjptridx_t obj);
 }
 
@@ -256,6 +256,11 @@ struct d_level_unique_cloaking_wall_state
 struct d_level_unique_wall_state
 {
 	wall_array Walls;
+	/* Advanced whenever a wall or side texture changes in a way that can
+	 * change which sides a vector passes through, so that a saved
+	 * find_vector_intersection result can tell it is stale.
+	 */
+	unsigned change_count;
 };
 
 struct d_level_unique_wall_subsystem_state :
@@ -94,7 +94,41 @@ static unsigned fixdivquadlongu(quadint n, uint64_t d)
 	return static_cast<std::underlying_type_t<quadint>>(n) / d;
 }
 
+/* Returns the integer nearest to the square root of `n`, which must be
+ * below 2**63.  The double root is within one of the integer root, even
+ * after `n` is rounded to fit a double, and the corrections are exact
+ * integer products, so the result does not depend on the FPU.
+ */
+[[nodiscard]]
+static uint32_t isqrt_nearest(const uint64_t n)
+{
+	uint64_t r{static_cast<uint64_t>(sqrt(static_cast<double>(n)))};
+	if (r * r > n)
+		--r;
+	else if ((r + 1) * (r + 1) <= n)
+		++r;
+	/* (r + 1/2)**2 is r*r + r + 1/4, so n is nearer r + 1 exactly when it
+	 * is more than r*r + r.
+	 */
+	return static_cast<uint32_t>(r + (n - r * r > r));
+}
+
 uint32_t quad_sqrt(const quadint iq)
+{
+	const auto n{static_cast<std::underlying_type_t<quadint>>(iq)};
+	if (n <= 0)
+		return 0;
+	return isqrt_nearest(n);
+}
+
+ushort long_sqrt(const int32_t a)
+{
+	if (a <= 0)
+		return 0;
+	return static_cast<ushort>(isqrt_nearest(a));
+}
+
+uint32_t quad_sqrt_reference(const quadint iq)
 {
 	const uint32_t low{static_cast<uint32_t>(iq)};
 	const int32_t high{static_cast<int32_t>(static_cast<std::underlying_type_t<quadint>>(iq) >> 32)};
@@ -105,7 +139,7 @@ uint32_t quad_sqrt(const quadint iq)
 		return 0;
 
 	if (high==0 && static_cast<int32_t>(low)>=0)
-		return long_sqrt(static_cast<int32_t>(low));
+		return long_sqrt_reference(static_cast<int32_t>(low));
 
 	if ((i = high >> 24)) {
 		cnt=12+16;
@@ -149,8 +183,7 @@ uint32_t quad_sqrt(const quadint iq)
 	return r;
 }
 
-//computes the square root of a long, returning a short
-ushort long_sqrt(int32_t a)
+ushort long_sqrt_reference(int32_t a)
 {
 	int cnt,r,old_r,t;
 
@@ -0,0 +1,125 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * The vector version uses the compiler's generic vector types, as the
+ * texture mapper spans do.  Integer division has no vector instruction,
+ * so the division of fixdiv is done in double precision.  A double holds
+ * the 48 bit dividend exactly, and for quotients below 2^22 the correctly
+ * rounded quotient never rounds across an integer, so truncating it
+ * matches the integer division.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include "light_span.h"
+
+namespace dcx {
+
+namespace {
+
+constexpr unsigned light_lanes_per_step = 8;
+using light_lanes = int32_t __attribute__((vector_size(light_lanes_per_step * sizeof(int32_t))));
+using light_ulanes = uint32_t __attribute__((vector_size(light_lanes_per_step * sizeof(uint32_t))));
+using light_dlanes = double __attribute__((vector_size(light_lanes_per_step * sizeof(double))));
+
+/* MIN_LIGHT_DIST in lighting.h */
+constexpr fix light_span_min_dist = F1_0 * 4;
+
+/* vm_vec_dist_quick */
+fix light_span_quick_dist(const vms_vector &p, const fix x, const fix y, const fix z)
+{
+	fix a = std::abs(x - p.x), b = std::abs(y - p.y), c = std::abs(z - p.z);
+	if (a < b)
+		std::swap(a, b);
+	if (b < c)
+	{
+		std::swap(b, c);
+		if (a < b)
+			std::swap(a, b);
+	}
+	const fix bc = (b >> 2) + (c >> 3);
+	return static_cast<fix>(static_cast<uint32_t>(a + bc + (bc >> 1)));
+}
+
+/* fixdiv, for a divisor that is never 0 */
+fix light_span_fixdiv(const fix a, const fix b)
+{
+	return static_cast<fix>((fix64{a} * 65536) / b);
+}
+
+}
+
+void light_span_div_reference(const light_span_source &light, const light_span_vertices &v, const std::size_t begin, const std::size_t end)
+{
+	for (auto i = begin; i != end; ++i)
+	{
+		fix dist = light_span_quick_dist(light.pos, v.x[i], v.y[i], v.z[i]);
+		if (!(dist < light.range))
+			continue;
+		if (dist < light_span_min_dist)
+			dist = light_span_min_dist;
+		v.r[i] += light_span_fixdiv(light.r, dist);
+		v.g[i] += light_span_fixdiv(light.g, dist);
+		v.b[i] += light_span_fixdiv(light.b, dist);
+	}
+}
+
+/* Vectors are not passed to or returned from helpers, since that would
+ * change the ABI for wider vector units.
+ */
+void light_span_div(const light_span_source &light, const light_span_vertices &v, const std::size_t begin, const std::size_t end)
+{
+	const auto steps = (end - begin) / light_lanes_per_step;
+	const double er = light.r * 65536.0, eg = light.g * 65536.0, eb = light.b * 65536.0;
+	auto i = begin;
+	for (std::size_t s = 0; s < steps; ++s, i += light_lanes_per_step)
+	{
+		light_lanes dx, dy, dz;
+		std::memcpy(&dx, v.x + i, sizeof(dx));
+		std::memcpy(&dy, v.y + i, sizeof(dy));
+		std::memcpy(&dz, v.z + i, sizeof(dz));
+		dx -= light.pos.x;
+		dy -= light.pos.y;
+		dz -= light.pos.z;
+		/* abs, by the sign mask of each lane */
+		dx = (dx ^ (dx >> 31)) - (dx >> 31);
+		dy = (dy ^ (dy >> 31)) - (dy >> 31);
+		dz = (dz ^ (dz >> 31)) - (dz >> 31);
+		/* The largest, middle and smallest of the three.  A comparison
+		 * yields all bits set in the lanes where it holds.
+		 */
+		const light_lanes xy = dx > dy;
+		const auto hi = (dx & xy) | (dy & ~xy);
+		const auto lo = (dy & xy) | (dx & ~xy);
+		const light_lanes hz = hi > dz, lz = lo > dz;
+		const auto a = (hi & hz) | (dz & ~hz);
+		const auto c = (dz & lz) | (lo & ~lz);
+		const auto ua = __builtin_bit_cast(light_ulanes, a);
+		const auto b = __builtin_bit_cast(light_lanes, __builtin_bit_cast(light_ulanes, dx) + __builtin_bit_cast(light_ulanes, dy) + __builtin_bit_cast(light_ulanes, dz) - ua - __builtin_bit_cast(light_ulanes, c));
+		const auto bc = (b >> 2) + (c >> 3);
+		auto dist = __builtin_bit_cast(light_lanes, ua + __builtin_bit_cast(light_ulanes, bc + (bc >> 1)));
+		const light_lanes lit = dist < light.range;
+		const light_lanes near = dist < light_span_min_dist;
+		dist = (dist & ~near) | (light_span_min_dist & near);
+		const auto ddist = __builtin_convertvector(dist, light_dlanes);
+		light_lanes r, g, bl;
+		std::memcpy(&r, v.r + i, sizeof(r));
+		std::memcpy(&g, v.g + i, sizeof(g));
+		std::memcpy(&bl, v.b + i, sizeof(bl));
+		r += __builtin_convertvector(er / ddist, light_lanes) & lit;
+		g += __builtin_convertvector(eg / ddist, light_lanes) & lit;
+		bl += __builtin_convertvector(eb / ddist, light_lanes) & lit;
+		std::memcpy(v.r + i, &r, sizeof(r));
+		std::memcpy(v.g + i, &g, sizeof(g));
+		std::memcpy(v.b + i, &bl, sizeof(bl));
+	}
+	light_span_div_reference(light, v, i, end);
+}
+
+}
@@ -28,6 +28,14 @@ int d_rand()
 	return rand() & 0x7fff;
 }
 
+unsigned d_rand_state()
+{
+	/* The state of rand cannot be read, so start a new sequence */
+	const unsigned seed = rand();
+	srand(seed);
+	return seed;
+}
+
 #else
 
 static unsigned int d_rand_seed;
@@ -42,6 +50,11 @@ void d_srand(unsigned int seed)
 	d_rand_seed = seed;
 }
 
+unsigned d_rand_state()
+{
+	return d_rand_seed;
+}
+
 #endif
 
 }
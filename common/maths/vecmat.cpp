@@ -14,6 +14,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <math.h>           // for sqrt
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include "d_construct.h"
 #include "maths.h"
@@ -39,6 +42,36 @@ vms_vector vm_vec_build_divide(const vms_vector &src, const fix m)
 	};
 }
 
+/* Same result as vm_vec_build_divide, for a divisor that is no smaller
+ * than any component, which is true of both magnitudes.  One division
+ * finds 2**48/m, and each quotient is then a multiply, which is at most
+ * one low, and a single correction.  Since |a| <= m, the product fits in
+ * 64 bits.
+ */
+[[nodiscard]]
+vms_vector vm_vec_build_divide_by_magnitude(const vms_vector &src, const fix m)
+{
+	/* A magnitude above INT32_MAX wrapped negative when it was converted,
+	 * and only fixdiv gives the same answer for that.
+	 */
+	if (unlikely(m < 0))
+		return vm_vec_build_divide(src, m);
+	const uint64_t d{static_cast<uint32_t>(m)};
+	const uint64_t reciprocal{(uint64_t{1} << 48) / d};
+	const auto divide{[d, reciprocal](const fix a) {
+		const uint64_t n{static_cast<uint64_t>(std::abs(int64_t{a}))};
+		uint64_t q{(n * reciprocal) >> 32};
+		if ((q + 1) * d <= (n << 16))
+			++q;
+		return static_cast<fix>(a < 0 ? -static_cast<int64_t>(q) : static_cast<int64_t>(q));
+	}};
+	return vms_vector{
+		.x = divide(src.x),
+		.y = divide(src.y),
+		.z = divide(src.z),
+	};
+}
+
 static void vm_vector_to_matrix_f(vms_matrix &m)
 {
 	if (m.fvec.x == 0 && m.fvec.z == 0) {		//forward vec is straight up or down
@@ -84,6 +117,33 @@ static fix vm_vec_dot3(fix x,fix y,fix z,const vms_vector &v)
 	return p >> 16;
 }
 
+/* The NEON kernels compute the same 64-bit sums of 32x32 bit products as
+ * the scalar code, wrapping the same way, and keep the same 32 bits of
+ * (sum >> 16), so the results are bit-identical.  vmull and vmlal do two
+ * of the widening products per instruction.  Other targets use the scalar
+ * _reference versions: on x86-64, SSE4.1 versions were no faster than
+ * the scalar 64-bit multiplies.
+ */
+#if defined(__ARM_NEON)
+
+[[nodiscard]]
+fix vm_simd_dot(const vms_vector &a, const vms_vector &b)
+{
+	const auto p{vmull_s32(vld1_s32(&a.x), vld1_s32(&b.x))};
+	return (vgetq_lane_s64(p, 0) + vgetq_lane_s64(p, 1) + (int64_t{a.z} * int64_t{b.z})) >> 16;
+}
+
+/* vmovn keeps the low 32 bits of each (sum >> 16), as the scalar
+ * conversion to fix does.
+ */
+[[nodiscard]]
+int32x2_t vm_simd_fix(const int64x2_t p)
+{
+	return vmovn_s64(vshrq_n_s64(p, 16));
+}
+
+#endif
+
 //make sure a vector is reasonably sized to go into a cross product
 [[nodiscard]]
 static vms_vector check_vec(vms_vector v)
@@ -266,6 +326,15 @@ void vm_vec_scale2(vms_vector &dest,fix n,fix d)
 }
 
 fix vm_vec_build_dot(const vms_vector &v0,const vms_vector &v1)
+{
+#if defined(__ARM_NEON)
+	return vm_simd_dot(v0, v1);
+#else
+	return vm_vec_build_dot_reference(v0, v1);
+#endif
+}
+
+fix vm_vec_build_dot_reference(const vms_vector &v0,const vms_vector &v1)
 {
 	return vm_vec_dot3({v0.x}, {v0.y}, {v0.z}, v1);
 }
@@ -329,7 +398,7 @@ vm_magnitude vm_vec_copy_normalize(vms_vector &dest,const vms_vector &src)
 {
 	const auto m{vm_vec_mag(src)};
 	if (likely(m)) {
-		dest = vm_vec_build_divide(src, m);
+		dest = vm_vec_build_divide_by_magnitude(src, m);
 	}
 	return m;
 }
@@ -340,12 +409,20 @@ vm_magnitude vm_vec_normalize(vms_vector &v)
 	return vm_vec_copy_normalize(v,v);
 }
 
+//normalize each vector in place, leaving zero vectors unchanged
+void vm_vec_normalize_batch(const std::span<vms_vector> vs)
+{
+	for (auto &v : vs)
+		if (const auto m{vm_vec_mag(v)})
+			v = vm_vec_build_divide_by_magnitude(v, m);
+}
+
 //normalize a vector. returns mag of source vec. uses approx mag
 vm_magnitude vm_vec_copy_normalize_quick(vms_vector &dest,const vms_vector &src)
 {
 	const auto m{vm_vec_mag_quick(src)};
 	if (likely(m)) {
-		dest = vm_vec_build_divide(src, m);
+		dest = vm_vec_build_divide_by_magnitude(src, m);
 	}
 	return m;
 }
@@ -384,6 +461,27 @@ vms_vector vm_vec_normal(const vms_vector &p0, const vms_vector &p1, const vms_v
 //quite easy for this routine to overflow and underflow.  Be careful that
 //your inputs are ok.
 vms_vector vm_vec_cross(const vms_vector &src0, const vms_vector &src1)
+{
+#if defined(__ARM_NEON)
+	/* {x, y} from {y0, z0} * {z1, x1} + (-{z0, x0}) * {y1, z1} */
+	const auto p{vld1_s32(&src0.y)};
+	const auto q{vset_lane_s32(src1.x, vdup_n_s32(src1.z), 1)};
+	const auto r{vneg_s32(vset_lane_s32(src0.x, vdup_n_s32(src0.z), 1))};
+	const auto s{vld1_s32(&src1.y)};
+	const auto xy{vm_simd_fix(vmlal_s32(vmull_s32(p, q), r, s))};
+	const auto qz0{fixmulaccum({}, src0.x, src1.y)};
+	const auto qz1{fixmulaccum(qz0, -src0.y, src1.x)};
+	return vms_vector{
+		.x = vget_lane_s32(xy, 0),
+		.y = vget_lane_s32(xy, 1),
+		.z = fixquadadjust(qz1),
+	};
+#else
+	return vm_vec_cross_reference(src0, src1);
+#endif
+}
+
+vms_vector vm_vec_cross_reference(const vms_vector &src0, const vms_vector &src1)
 {
 	const auto qx0{fixmulaccum({}, src0.y, src1.z)};
 	const auto qx1{fixmulaccum(qx0, -src0.z, src1.y)};
@@ -507,10 +605,29 @@ vms_matrix vm_vector_to_matrix_u(const vms_vector &fvec, const vms_vector &uvec)
 
 vms_vector vm_vec_build_rotated(const vms_vector &src, const vms_matrix &m)
 {
+#if defined(__ARM_NEON)
+	/* vld3 splits rvec and uvec into {rvec.x, uvec.x}, {rvec.y, uvec.y}
+	 * and {rvec.z, uvec.z}, so both of their dot products are one
+	 * multiply and two multiply-accumulates.
+	 */
+	const auto ru{vld3_s32(&m.rvec.x)};
+	const auto xy{vm_simd_fix(vmlal_n_s32(vmlal_n_s32(vmull_n_s32(ru.val[0], src.x), ru.val[1], src.y), ru.val[2], src.z))};
 	return {
-		.x = vm_vec_build_dot(src, m.rvec),
-		.y = vm_vec_build_dot(src, m.uvec),
-		.z = vm_vec_build_dot(src, m.fvec)
+		.x = vget_lane_s32(xy, 0),
+		.y = vget_lane_s32(xy, 1),
+		.z = vm_simd_dot(src, m.fvec)
+	};
+#else
+	return vm_vec_build_rotated_reference(src, m);
+#endif
+}
+
+vms_vector vm_vec_build_rotated_reference(const vms_vector &src, const vms_matrix &m)
+{
+	return {
+		.x = vm_vec_build_dot_reference(src, m.rvec),
+		.y = vm_vec_build_dot_reference(src, m.uvec),
+		.z = vm_vec_build_dot_reference(src, m.fvec)
 	};
 }
 
@@ -523,6 +640,32 @@ void vm_vec_rotate(vms_vector &dest,const vms_vector &src,const vms_matrix &m)
 //mulitply 2 matrices, fill in dest.  returns ptr to dest
 //dest CANNOT equal either source
 void _vm_matrix_x_matrix(vms_matrix &dest,const vms_matrix &src0,const vms_matrix &src1)
+{
+	/* Each row of dest is the rows of src0 weighted by the components of
+	 * the same row of src1.
+	 */
+#if defined(__ARM_NEON)
+	const auto r{vld1_s32(&src0.rvec.x)}, u{vld1_s32(&src0.uvec.x)}, f{vld1_s32(&src0.fvec.x)};
+	const auto combine_xy{[r, u, f](const vms_vector &s, vms_vector &d) {
+		vst1_s32(&d.x, vm_simd_fix(vmlal_n_s32(vmlal_n_s32(vmull_n_s32(r, s.x), u, s.y), f, s.z)));
+	}};
+	combine_xy(src1.rvec, dest.rvec);
+	combine_xy(src1.uvec, dest.uvec);
+	combine_xy(src1.fvec, dest.fvec);
+	/* As in vm_vec_build_rotated, vld3 gathers the components of the rvec
+	 * and uvec of src1, which weight the z of the rows of src0.
+	 */
+	const auto s{vld3_s32(&src1.rvec.x)};
+	const auto z{vm_simd_fix(vmlal_n_s32(vmlal_n_s32(vmull_n_s32(s.val[0], src0.rvec.z), s.val[1], src0.uvec.z), s.val[2], src0.fvec.z))};
+	dest.rvec.z = vget_lane_s32(z, 0);
+	dest.uvec.z = vget_lane_s32(z, 1);
+	dest.fvec.z = vm_vec_dot3(src0.rvec.z, src0.uvec.z, src0.fvec.z, src1.fvec);
+#else
+	_vm_matrix_x_matrix_reference(dest, src0, src1);
+#endif
+}
+
+void _vm_matrix_x_matrix_reference(vms_matrix &dest,const vms_matrix &src0,const vms_matrix &src1)
 {
 	dest.rvec.x = vm_vec_dot3(src0.rvec.x,src0.uvec.x,src0.fvec.x, src1.rvec);
 	dest.uvec.x = vm_vec_dot3(src0.rvec.x,src0.uvec.x,src0.fvec.x, src1.uvec);
@@ -0,0 +1,76 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * Tagged memory accounting
+ *
+ */
+
+#include <array>
+#include <atomic>
+#include "mem_account.h"
+
+namespace dcx {
+
+namespace {
+
+struct mem_account_slot
+{
+	std::atomic<std::size_t> current, peak;
+};
+
+constinit std::array<mem_account_slot, mem_tag_count> mem_account_slots{};
+
+constexpr std::array<const char *, mem_tag_count> mem_tag_names{{
+	"textures",
+	"bitmaps",
+	"sounds",
+	"mixer_chunks",
+	"mission",
+	"demo",
+	"vma",
+}};
+
+}
+
+void mem_account_add(const mem_tag tag, const std::size_t bytes)
+{
+	auto &s = mem_account_slots[static_cast<std::size_t>(tag)];
+	const auto now{s.current.fetch_add(bytes, std::memory_order_relaxed) + bytes};
+	auto peak{s.peak.load(std::memory_order_relaxed)};
+	while (peak < now && !s.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+	{
+	}
+}
+
+void mem_account_sub(const mem_tag tag, const std::size_t bytes)
+{
+	mem_account_slots[static_cast<std::size_t>(tag)].current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+mem_account_counters mem_account_get(const mem_tag tag)
+{
+	auto &s = mem_account_slots[static_cast<std::size_t>(tag)];
+	return {
+		.current = s.current.load(std::memory_order_relaxed),
+		.peak = s.peak.load(std::memory_order_relaxed),
+	};
+}
+
+void mem_account_reset_peaks()
+{
+	for (auto &s : mem_account_slots)
+		s.peak.store(s.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+const char *mem_tag_name(const mem_tag tag)
+{
+	return mem_tag_names[static_cast<std::size_t>(tag)];
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * Registry of the caches trimmed when memory is short
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include "mem_trim.h"
+
+namespace dcx {
+
+namespace {
+
+struct mem_trim_cache
+{
+	mem_trim_cost cost;
+	std::size_t (*trim)();
+};
+
+/* One for each kind of cache, with room to spare */
+constexpr std::size_t mem_trim_max_caches{8};
+
+/* Kept in order of cost, and of registration within a cost */
+static std::array<mem_trim_cache, mem_trim_max_caches> mem_trim_caches;
+static std::size_t mem_trim_count;
+
+}
+
+void mem_trim_register(const mem_trim_cost cost, std::size_t (*const trim)())
+{
+	const auto b{mem_trim_caches.begin()}, e{b + mem_trim_count};
+	if (mem_trim_count == mem_trim_caches.size() || std::find_if(b, e, [trim](const mem_trim_cache &c) { return c.trim == trim; }) != e)
+		return;
+	const auto pos{std::upper_bound(b, e, cost, [](const mem_trim_cost c, const mem_trim_cache &m) { return c < m.cost; })};
+	std::move_backward(pos, e, e + 1);
+	*pos = {cost, trim};
+	++mem_trim_count;
+}
+
+std::size_t mem_trim(const mem_trim_level level)
+{
+	const auto limit{level == mem_trim_level::critical ? mem_trim_cost::upload : mem_trim_cost::convert};
+	std::size_t freed{};
+	for (const auto &c : std::span(mem_trim_caches).first(mem_trim_count))
+	{
+		if (c.cost > limit)
+			break;
+		freed += c.trim();
+	}
+	return freed;
+}
+
+}
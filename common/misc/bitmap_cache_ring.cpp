@@ -0,0 +1,61 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * Placement of paged in bitmaps in a fixed buffer
+ *
+ */
+
+#include "bitmap_cache_ring.h"
+
+namespace dcx {
+
+void bitmap_cache_ring::reset(uint8_t *const b, const std::size_t size)
+{
+	base = b;
+	capacity = size;
+	clear();
+}
+
+void bitmap_cache_ring::clear()
+{
+	resident.clear();
+	cursor = 0;
+}
+
+bool bitmap_cache_ring::fits_without_reclaim(const std::size_t n) const
+{
+	if (n > capacity)
+		return false;
+	if (resident.empty())
+		return true;
+	const std::size_t f{resident.front().offset};
+	if (cursor + n <= capacity)
+		return f < cursor || f >= cursor + n;
+	/* It would wrap, which needs the rest of the lap to be empty, and
+	 * room before the oldest entry
+	 */
+	return f < cursor && f >= n;
+}
+
+void bitmap_cache_ring::commit(const uint16_t id, const std::size_t length)
+{
+	resident.push_back(entry{static_cast<uint32_t>(cursor), static_cast<uint32_t>(length), id});
+	cursor += length;
+}
+
+bitmap_cache_ring::stats bitmap_cache_ring::get_stats() const
+{
+	return {
+		.entries = resident.size(),
+		.evictions = evictions,
+		.relocations = relocations,
+	};
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+#include <algorithm>
+#include <array>
+#include <new>
+#include "frame_arena.h"
+
+namespace dcx {
+
+namespace {
+
+constexpr std::size_t frame_arena_min_block = 64 * 1024;
+
+std::array<frame_arena, 2> frame_arenas;
+unsigned frame_arena_current;
+
+}
+
+/* The header of each block.  The usable bytes follow it. */
+struct frame_arena::block
+{
+	block *next;
+	std::size_t size;
+	std::byte *data()
+	{
+		return reinterpret_cast<std::byte *>(this + 1);
+	}
+};
+
+void frame_arena::free_blocks()
+{
+	for (auto b{head}; b;)
+	{
+		const auto next{b->next};
+		::operator delete(b);
+		b = next;
+	}
+	head = nullptr;
+	cursor = limit = nullptr;
+}
+
+frame_arena::~frame_arena()
+{
+	free_blocks();
+}
+
+void *frame_arena::allocate_slow(const std::size_t size, const std::size_t align)
+{
+	if (head)
+		used_total += cursor - head->data();
+	const auto bytes{std::max(frame_arena_min_block, size + align)};
+	const auto b{static_cast<block *>(::operator new(sizeof(block) + bytes))};
+	b->next = head;
+	b->size = bytes;
+	head = b;
+	cursor = b->data();
+	limit = cursor + bytes;
+	return allocate(size, align);
+}
+
+void frame_arena::reset()
+{
+	if (!head)
+		return;
+	const std::size_t used{used_total + (cursor - head->data())};
+	high_water = std::max(high_water, used);
+	used_total = 0;
+	if (head->next)
+	{
+		/* Keep room for the alignment padding of each allocation */
+		const auto want{used + used / 8};
+		free_blocks();
+		allocate_slow(want, 1);
+	}
+	cursor = head->data();
+}
+
+void *frame_arena_allocate(const std::size_t size, const std::size_t align)
+{
+	return frame_arenas[frame_arena_current].allocate(size, align);
+}
+
+void frame_arena_next_frame()
+{
+	frame_arena_current ^= 1;
+	frame_arenas[frame_arena_current].reset();
+}
+
+}
@@ -27,29 +27,73 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 namespace dcx {
 
-bool hashtable::compare_t::operator()(const char *l, const char *r) const
+namespace {
+
+/* FNV-1a over the lower-cased name */
+static uint32_t hashtable_hash(const char *key)
+{
+	uint32_t h{2166136261u};
+	for (; *key; ++key)
+	{
+		h ^= static_cast<uint8_t>(tolower(static_cast<unsigned>(*key)));
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static bool hashtable_equal(const char *l, const char *r)
 {
 	for (;; ++l, ++r)
 	{
-		uint_fast32_t ll = tolower(static_cast<unsigned>(*l)), lr = tolower(static_cast<unsigned>(*r));
-		if (ll < lr)
-			return true;
-		if (lr < ll || !ll)
+		const uint_fast32_t ll = tolower(static_cast<unsigned>(*l)), lr = tolower(static_cast<unsigned>(*r));
+		if (ll != lr)
 			return false;
+		if (!ll)
+			return true;
+	}
+}
+
+/* Returns the slot holding `key`, or the empty slot where it would go */
+static hashtable::slot &hashtable_probe(hashtable &ht, const char *const key, const uint32_t hash)
+{
+	const std::size_t mask{ht.slots.size() - 1};
+	for (std::size_t i{hash & mask};; i = (i + 1) & mask)
+	{
+		auto &s = ht.slots[i];
+		if (!s.key || (s.hash == hash && hashtable_equal(s.key, key)))
+			return s;
 	}
 }
 
+static void hashtable_grow(hashtable &ht)
+{
+	std::vector<hashtable::slot> old(ht.slots.empty() ? 64 : ht.slots.size() * 2);
+	old.swap(ht.slots);
+	for (const auto &s : old)
+		if (s.key)
+			hashtable_probe(ht, s.key, s.hash) = s;
+}
+
+}
+
 int hashtable_search(hashtable *ht, const char *key)
 {
-	auto i = ht->m.find(key);
-	if (i != ht->m.end())
-		return i->second;
-	return -1;
+	if (!ht->count)
+		return -1;
+	const auto &s = hashtable_probe(*ht, key, hashtable_hash(key));
+	return s.key ? s.value : -1;
 }
 
 void hashtable_insert(hashtable *ht, const char *key, int value)
 {
-	ht->m.insert(std::make_pair(key, value));
+	if ((ht->count + 1) * 2 > ht->slots.size())
+		hashtable_grow(*ht);
+	const auto hash{hashtable_hash(key)};
+	auto &s = hashtable_probe(*ht, key, hash);
+	if (s.key)
+		return;
+	s = {key, hash, value};
+	++ ht->count;
 }
 
 }
@@ -677,7 +677,7 @@ struct midhdr
 {
 	int16_t num_trks;
 	int16_t time_div;
-	midhdr(hmp_file *hmp) :
+	midhdr(const hmp_file *hmp) :
 		num_trks(hmp->num_trks), time_div(hmp->tempo*1.6)
 	{
 	}
@@ -698,8 +698,12 @@ hmpmid_result hmp2mid(const char *hmp_name)
 			con_printf(CON_CRITICAL, "Failed to read HMP music %s: hmp_open_error=%u", hmp_name, underlying_value(hoe));
 		return {std::vector<uint8_t>{}, hoe};
 	}
+	return {hmp2mid(*hmp), hmp_open_error::None};
+}
 
-	const midhdr mh(hmp.get());
+std::vector<uint8_t> hmp2mid(const hmp_file &hmp)
+{
+	const midhdr mh(&hmp);
 	std::vector<uint8_t> midbuf;
 	// write MIDI-header
 	midbuf.resize(serial::message_type<decltype(mh)>::maximum_size);
@@ -707,17 +711,17 @@ hmpmid_result hmp2mid(const char *hmp_name)
 	serial::process_buffer(bb, mh);
 
 	// tracks
-	for (int i = 1; i < hmp->num_trks; i++)
+	for (int i = 1; i < hmp.num_trks; i++)
 	{
 		midbuf.insert(midbuf.end(), track_header.begin(), track_header.end());
 		auto size_before = midbuf.size();
 		auto midtrklenpos = midbuf.size() - 4;
-		hmptrk2mid(hmp->trks[i].data.get(), hmp->trks[i].len, midbuf);
+		hmptrk2mid(hmp.trks[i].data.get(), hmp.trks[i].len, midbuf);
 		auto size_after = midbuf.size();
 		serial::writer::be_bytebuffer bbmi{&midbuf[midtrklenpos]};
 		serial::process_buffer(bbmi, static_cast<int32_t>(size_after - size_before));
 	}
-	return {midbuf, hmp_open_error::None};
+	return midbuf;
 }
 
 }
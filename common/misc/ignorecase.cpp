@@ -11,7 +11,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-#include <optional>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "physfsx.h"
 #include "physfs_list.h"
@@ -40,54 +43,90 @@ namespace dcx {
 
 namespace {
 
-/* I'm not screwing around with stricmp vs. strcasecmp... */
-static std::optional<std::size_t> caseInsensitiveStringCompare(const char *x, const char *y)
+/* The names in each directory searched, keyed by their upper-cased
+ * form.  PhysFS merges every archive on the search path into each
+ * listing, so listing the root of a large HOG costs as much as
+ * thousands of compares.  A directory is listed once, and the listings
+ * are dropped when the search path or the write directory changes, or
+ * when PHYSFSEXT_invalidateCaseIndex is called after a file is written.
+ */
+struct case_index
 {
-	const auto sx{x};
-	for (;;)
-    {
-		const auto ux = toupper(static_cast<unsigned>(*x));
-		const auto uy = toupper(static_cast<unsigned>(*y));
-        if (ux != uy)
-			return std::nullopt;
-		if (!ux)
-			return std::distance(sx, x);
-        x++;
-        y++;
+	std::mutex mutex;
+	uint64_t search_path_hash{};
+	unsigned generation{};
+	std::unordered_map<std::string, std::unordered_map<std::string, std::string>> directories;
+};
+
+case_index Case_index;
+std::atomic<unsigned> Case_index_generation;
+
+static void hash_string(uint64_t &h, const char *s)
+{
+	for (;; ++s)
+	{
+		h ^= static_cast<uint8_t>(*s);
+		h *= 0x100000001b3ull;
+		if (!*s)
+			break;
 	}
-} /* caseInsensitiveStringCompare */
+}
+
+static uint64_t search_path_hash()
+{
+	uint64_t h{0xcbf29ce484222325ull};
+	PHYSFS_getSearchPathCallback([](void *const data, const char *const s) {
+		hash_string(*static_cast<uint64_t *>(data), s);
+	}, &h);
+	if (const auto w = PHYSFS_getWriteDir())
+		hash_string(h, w);
+	return h;
+}
+
+static std::string fold_case(const char *s)
+{
+	std::string r;
+	for (; *s; ++s)
+		r.push_back(toupper(static_cast<unsigned>(*s)));
+	return r;
+}
 
 static PHYSFSX_case_search_result locateOneElement(char *const sptr, char *const ptr, const char *buf)
 {
     if (PHYSFS_exists(buf))
         return PHYSFSX_case_search_result::success;  /* quick rejection: exists in current case. */
 
-	struct search_result : PHYSFSX_uncounted_list
+	const std::lock_guard lock{Case_index.mutex};
+	const auto h{search_path_hash()};
+	const auto generation{Case_index_generation.load(std::memory_order_relaxed)};
+	if (Case_index.search_path_hash != h || Case_index.generation != generation)
+	{
+		Case_index.directories.clear();
+		Case_index.search_path_hash = h;
+		Case_index.generation = generation;
+	}
+	if (ptr)
+		*ptr = 0;
+	const auto &&[it, inserted] = Case_index.directories.try_emplace(ptr ? buf : "/");
+	if (inserted)
 	{
-		search_result(char *ptr, const char *buf) :
-			PHYSFSX_uncounted_list(PHYSFS_enumerateFiles(ptr ? (*ptr = 0, buf) : "/"))
-		{
-			if (ptr)
-				*ptr = '/';
-		}
-	};
-	const search_result s{ptr, buf};
-	if (!s)
-		/* Failed to list the directory.  No names are available, so there is
-		 * no list to iterate.
-		 */
+		/* On failure to list the directory, it is recorded with no names */
+		const PHYSFSX_uncounted_list s{PHYSFS_enumerateFiles(it->first.c_str())};
+		if (s)
+			for (const auto i : s)
+				/* Of names that differ only in case, keep the first */
+				it->second.try_emplace(fold_case(i), i);
+	}
+	if (ptr)
+		*ptr = '/';
+	const auto &names = it->second;
+	const auto found = names.find(fold_case(sptr));
+	if (found == names.end())
+		/* no match at all... */
 		return PHYSFSX_case_search_result::file_missing;
-	for (const auto i : s)
-    {
-		if (const auto o = caseInsensitiveStringCompare(i, sptr))
-        {
-			std::memcpy(sptr, i, *o); /* found a match. Overwrite with this case. */
-            return PHYSFSX_case_search_result::success;
-        } /* if */
-    } /* for */
-
-    /* no match at all... */
-    return PHYSFSX_case_search_result::file_missing;
+	/* found a match. Overwrite with this case. */
+	std::memcpy(sptr, found->second.data(), found->second.size());
+	return PHYSFSX_case_search_result::success;
 } /* locateOneElement */
 
 }
@@ -116,6 +155,11 @@ PHYSFSX_case_search_result PHYSFSEXT_locateCorrectCase(char *buf)
     return step();
 } /* PHYSFSEXT_locateCorrectCase */
 
+void PHYSFSEXT_invalidateCaseIndex()
+{
+	Case_index_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
 }
 
 #ifdef TEST_PHYSFSEXT_LOCATECORRECTCASE
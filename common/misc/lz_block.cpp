@@ -0,0 +1,151 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * The compressor is greedy: it looks up the last position whose first
+ * four bytes hashed the same, and takes the match if those bytes are
+ * equal.  That is fast, and good enough for the repetitive records of a
+ * demo.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "lz_block.h"
+
+namespace dcx {
+
+namespace {
+
+constexpr std::size_t lz_min_match = 4;
+constexpr std::size_t lz_max_distance = UINT16_MAX;
+constexpr unsigned lz_hash_bits = 12;
+
+uint32_t lz_load32(const uint8_t *const p)
+{
+	uint32_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+unsigned lz_hash(const uint32_t v)
+{
+	return (v * 2654435761u) >> (32 - lz_hash_bits);
+}
+
+/* Write the part of `length` that did not fit in the token nibble */
+uint8_t *lz_write_length(uint8_t *op, std::size_t length)
+{
+	if (length < 15)
+		return op;
+	for (length -= 15; length >= 255; length -= 255)
+		*op++ = 255;
+	*op++ = static_cast<uint8_t>(length);
+	return op;
+}
+
+uint8_t *lz_write_sequence(uint8_t *op, const uint8_t *const literals, const std::size_t literal_count, const std::size_t distance, const std::size_t match_length)
+{
+	const std::size_t match_code = match_length ? match_length - lz_min_match : 0;
+	*op++ = static_cast<uint8_t>((std::min<std::size_t>(literal_count, 15) << 4) | std::min<std::size_t>(match_code, 15));
+	op = lz_write_length(op, literal_count);
+	if (literal_count)
+		std::memcpy(op, literals, literal_count);
+	op += literal_count;
+	if (!match_length)
+		return op;
+	*op++ = static_cast<uint8_t>(distance);
+	*op++ = static_cast<uint8_t>(distance >> 8);
+	return lz_write_length(op, match_code);
+}
+
+/* Read the part of a length that did not fit in the token nibble.
+ * Returns false if the input ends first.
+ */
+bool lz_read_length(const std::span<const uint8_t> input, std::size_t &ip, std::size_t &length)
+{
+	if (length != 15)
+		return true;
+	for (;;)
+	{
+		if (ip == input.size())
+			return false;
+		const auto b = input[ip++];
+		length += b;
+		if (b != 255)
+			return true;
+	}
+}
+
+}
+
+std::size_t lz_block_compress(const std::span<const uint8_t> input, const std::span<uint8_t> output)
+{
+	const auto in = input.data();
+	const std::size_t n = input.size();
+	uint8_t *op = output.data();
+	/* One past the last position with each hash, or 0 for none */
+	std::array<uint32_t, 1u << lz_hash_bits> last{};
+	std::size_t anchor = 0;
+	for (std::size_t i = 0; i + lz_min_match <= n;)
+	{
+		const auto v = lz_load32(in + i);
+		auto &slot = last[lz_hash(v)];
+		const std::size_t candidate = slot;
+		slot = static_cast<uint32_t>(i + 1);
+		if (!candidate || i + 1 - candidate > lz_max_distance || lz_load32(in + candidate - 1) != v)
+		{
+			++i;
+			continue;
+		}
+		const std::size_t match = candidate - 1;
+		std::size_t length = lz_min_match;
+		while (i + length != n && in[match + length] == in[i + length])
+			++length;
+		op = lz_write_sequence(op, in + anchor, i - anchor, i - match, length);
+		i += length;
+		anchor = i;
+	}
+	op = lz_write_sequence(op, in + anchor, n - anchor, 0, 0);
+	return op - output.data();
+}
+
+bool lz_block_decompress(const std::span<const uint8_t> input, const std::span<uint8_t> output)
+{
+	std::size_t ip = 0, op = 0;
+	while (ip != input.size())
+	{
+		const auto token = input[ip++];
+		std::size_t literal_count = token >> 4;
+		if (!lz_read_length(input, ip, literal_count) ||
+			literal_count > input.size() - ip ||
+			literal_count > output.size() - op)
+			return false;
+		if (literal_count)
+			std::memcpy(output.data() + op, input.data() + ip, literal_count);
+		ip += literal_count;
+		op += literal_count;
+		if (ip == input.size())
+			break;
+		if (input.size() - ip < 2)
+			return false;
+		const std::size_t distance = input[ip] | (input[ip + 1] << 8);
+		ip += 2;
+		std::size_t length = token & 15;
+		if (!distance || distance > op || !lz_read_length(input, ip, length))
+			return false;
+		length += lz_min_match;
+		if (length > output.size() - op)
+			return false;
+		/* The match may overlap what it writes, so copy a byte at a time */
+		for (const auto end = op + length; op != end; ++op)
+			output[op] = output[op - distance];
+	}
+	return op == output.size();
+}
+
+}
@@ -0,0 +1,287 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#include "parallel.h"
+
+namespace dcx {
+
+namespace {
+
+constexpr unsigned parallel_max_threads = 8;
+
+/* A range of indices [begin, end) packed into one word, begin in the low
+ * half, so that its owner and a thief can both change it with one
+ * compare-exchange.
+ */
+constexpr uint64_t parallel_pack(const uint32_t begin, const uint32_t end)
+{
+	return begin | (uint64_t{end} << 32);
+}
+
+struct alignas(64) parallel_slot
+{
+	std::atomic<uint64_t> range;
+};
+
+std::atomic<unsigned> parallel_thread_limit;
+std::atomic<uint32_t> parallel_stat_jobs, parallel_stat_steals;
+std::atomic<uint64_t> parallel_stat_wait_us;
+
+#if defined(__linux__)
+/* On big.LITTLE parts, the CPUs with the highest maximum frequency.  A
+ * fork/join is as slow as its slowest participant, so the workers are
+ * kept off the little cores.  Empty if all CPUs are alike or the
+ * frequencies cannot be read.
+ */
+std::vector<unsigned> parallel_performance_cpus(const unsigned cpus)
+{
+	std::vector<unsigned long> freq(cpus);
+	for (unsigned i = 0; i != cpus; ++i)
+	{
+		char path[80];
+		std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq", i);
+		if (const auto f{std::fopen(path, "r")})
+		{
+			if (std::fscanf(f, "%lu", &freq[i]) != 1)
+				freq[i] = 0;
+			std::fclose(f);
+		}
+		if (!freq[i])
+			return {};
+	}
+	const auto [lo, hi]{std::minmax_element(freq.begin(), freq.end())};
+	if (*lo == *hi)
+		return {};
+	std::vector<unsigned> result;
+	for (unsigned i = 0; i != cpus; ++i)
+		if (freq[i] == *hi)
+			result.emplace_back(i);
+	return result;
+}
+#endif
+
+/* One job at a time.  Each participant starts with an equal slice of the
+ * indices, takes from the front of its own slice, and when that is empty
+ * steals the back half of another.  The slices keep neighbouring indices
+ * on one thread, and the stealing evens out uneven calls.
+ *
+ * A job is only replaced when no worker is inside it, so a worker that
+ * wakes late finds either the job it was woken for, with every slice
+ * empty, or the next job.
+ */
+class parallel_pool
+{
+	std::mutex m;
+	std::condition_variable wake, idle;
+	const std::function<void(std::size_t)> *fn{};
+	unsigned participants{};
+	unsigned busy{};
+	unsigned generation{};
+	bool stop{};
+	/* Set while a job is running, so that a call from a worker or from
+	 * another thread runs serially instead of waiting.
+	 */
+	std::atomic<bool> active{};
+	std::array<parallel_slot, parallel_max_threads> slots;
+	std::vector<std::thread> workers;
+#if defined(__linux__)
+	std::vector<unsigned> affinity;
+#endif
+	bool steal(const unsigned self, const unsigned n)
+	{
+		for (unsigned k = 1; k != n; ++k)
+		{
+			auto &victim{slots[(self + k) % n].range};
+			auto r{victim.load(std::memory_order_relaxed)};
+			for (;;)
+			{
+				const auto begin{static_cast<uint32_t>(r)}, end{static_cast<uint32_t>(r >> 32)};
+				if (begin >= end)
+					break;
+				const uint32_t mid{begin + (end - begin) / 2};
+				if (victim.compare_exchange_weak(r, parallel_pack(begin, mid), std::memory_order_acq_rel, std::memory_order_relaxed))
+				{
+					/* The own slot is empty, so no thief changes it
+					 * between the exchange above and this store.
+					 */
+					slots[self].range.store(parallel_pack(mid, end), std::memory_order_release);
+					parallel_stat_steals.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+	void take(const std::function<void(std::size_t)> &f, const unsigned self, const unsigned n)
+	{
+		auto &own{slots[self].range};
+		do {
+			auto r{own.load(std::memory_order_acquire)};
+			for (;;)
+			{
+				const auto begin{static_cast<uint32_t>(r)}, end{static_cast<uint32_t>(r >> 32)};
+				if (begin >= end)
+					break;
+				if (own.compare_exchange_weak(r, parallel_pack(begin + 1, end), std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					f(begin);
+					r = own.load(std::memory_order_acquire);
+				}
+			}
+		} while (steal(self, n));
+	}
+	void worker_main(const unsigned self)
+	{
+#if defined(__linux__)
+		if (!affinity.empty())
+		{
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			for (const auto cpu : affinity)
+				CPU_SET(cpu, &set);
+			sched_setaffinity(0, sizeof(set), &set);
+		}
+#endif
+		unsigned seen{};
+		std::unique_lock lock(m);
+		for (;;)
+		{
+			wake.wait(lock, [this, &seen] { return stop || generation != seen; });
+			if (stop)
+				return;
+			seen = generation;
+			const auto n{participants};
+			if (self >= n)
+				continue;
+			++busy;
+			const auto f{fn};
+			lock.unlock();
+			take(*f, self, n);
+			lock.lock();
+			if (!--busy)
+				idle.notify_all();
+		}
+	}
+public:
+	parallel_pool()
+	{
+		auto threads{std::max(std::thread::hardware_concurrency(), 1u)};
+#if defined(__linux__)
+		affinity = parallel_performance_cpus(threads);
+		if (!affinity.empty())
+			threads = affinity.size();
+#endif
+		threads = std::min(threads, parallel_max_threads);
+		workers.reserve(threads - 1);
+		for (unsigned i = 1; i < threads; ++i)
+			workers.emplace_back(&parallel_pool::worker_main, this, i);
+	}
+	~parallel_pool()
+	{
+		{
+			std::lock_guard lock(m);
+			stop = true;
+		}
+		wake.notify_all();
+		for (auto &t : workers)
+			t.join();
+	}
+	unsigned threads() const
+	{
+		const auto limit{parallel_thread_limit.load(std::memory_order_relaxed)};
+		const unsigned all = workers.size() + 1;
+		return limit ? std::min(limit, all) : all;
+	}
+	/* Returns false, having done nothing, if another job is running */
+	bool run(const std::size_t count, const std::function<void(std::size_t)> &f)
+	{
+		if (active.exchange(true, std::memory_order_acquire))
+			return false;
+		const unsigned n = std::min<std::size_t>(threads(), count);
+		{
+			std::unique_lock lock(m);
+			idle.wait(lock, [this] { return !busy; });
+			for (unsigned i = 0; i != n; ++i)
+				slots[i].range.store(parallel_pack(count * i / n, count * (i + 1) / n), std::memory_order_relaxed);
+			fn = &f;
+			participants = n;
+			++generation;
+		}
+		wake.notify_all();
+		take(f, 0, n);
+		{
+			std::unique_lock lock(m);
+			if (busy)
+			{
+				const auto start{std::chrono::steady_clock::now()};
+				idle.wait(lock, [this] { return !busy; });
+				parallel_stat_wait_us.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+			}
+		}
+		parallel_stat_jobs.fetch_add(1, std::memory_order_relaxed);
+		active.store(false, std::memory_order_release);
+		return true;
+	}
+};
+
+parallel_pool &get_parallel_pool()
+{
+	static parallel_pool pool;
+	return pool;
+}
+
+}
+
+void parallel_for(const std::size_t count, const std::function<void(std::size_t)> &fn)
+{
+	if (!count)
+		return;
+	if (count > 1 && count <= UINT32_MAX && parallel_thread_limit.load(std::memory_order_relaxed) != 1)
+	{
+		auto &pool = get_parallel_pool();
+		if (pool.threads() > 1 && pool.run(count, fn))
+			return;
+	}
+	for (std::size_t i = 0; i < count; ++i)
+		fn(i);
+}
+
+unsigned parallel_for_threads()
+{
+	if (parallel_thread_limit.load(std::memory_order_relaxed) == 1)
+		return 1;
+	return get_parallel_pool().threads();
+}
+
+void parallel_set_thread_limit(const unsigned limit)
+{
+	parallel_thread_limit.store(limit, std::memory_order_relaxed);
+}
+
+parallel_stats parallel_take_stats()
+{
+	return parallel_stats{
+		.jobs = parallel_stat_jobs.exchange(0, std::memory_order_relaxed),
+		.steals = parallel_stat_steals.exchange(0, std::memory_order_relaxed),
+		.wait_us = static_cast<uint32_t>(parallel_stat_wait_us.exchange(0, std::memory_order_relaxed)),
+	};
+}
+
+}
@@ -0,0 +1,344 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * PhysFS archiver for the game data packaged in an Android APK
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <jni.h>
+#include <android/asset_manager.h>
+#include <android/asset_manager_jni.h>
+#include <SDL.h>
+#include "physfsx.h"
+#include "console.h"
+#include "strutil.h"
+
+namespace dcx {
+
+namespace {
+
+/* The search path entry for the assets.  PhysFS picks the archiver by the
+ * extension of the name that is mounted.
+ */
+constexpr char apk_assets_extension[]{"apkassets"};
+constexpr char apk_assets_mount_name[]{"apk.apkassets"};
+
+static AAssetManager *Apk_asset_manager;
+
+struct apk_asset_close
+{
+	void operator()(AAsset *const a) const
+	{
+		AAsset_close(a);
+	}
+};
+
+/* An open asset, shared by the handles that PhysFS duplicates from it.
+ * When the asset is stored uncompressed, the buffer is mapped from the
+ * APK, and reading copies straight from the page cache.
+ */
+struct apk_asset_file
+{
+	std::shared_ptr<AAsset> asset;
+	const uint8_t *data;
+	PHYSFS_sint64 length, position;
+};
+
+struct apk_asset_entry
+{
+	std::string name;
+	PHYSFS_sint64 length;
+};
+
+struct apk_asset_directory
+{
+	PHYSFS_Io *io;
+	std::vector<apk_asset_entry> files;
+	apk_asset_entry *find(const char *const name)
+	{
+		for (auto &f : files)
+			if (!d_stricmp(f.name.c_str(), name))
+				return &f;
+		return nullptr;
+	}
+};
+
+static PHYSFS_Io *apk_asset_make_io(apk_asset_file &&);
+
+static apk_asset_file &apk_asset_io_file(PHYSFS_Io *const io)
+{
+	return *static_cast<apk_asset_file *>(io->opaque);
+}
+
+static PHYSFS_sint64 apk_asset_io_read(PHYSFS_Io *const io, void *const buf, const PHYSFS_uint64 len)
+{
+	auto &f = apk_asset_io_file(io);
+	const auto n = std::min<PHYSFS_uint64>(len, f.length - f.position);
+	std::memcpy(buf, f.data + f.position, n);
+	f.position += n;
+	return n;
+}
+
+static PHYSFS_sint64 apk_asset_io_write(PHYSFS_Io *, const void *, PHYSFS_uint64)
+{
+	PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+	return -1;
+}
+
+static int apk_asset_io_seek(PHYSFS_Io *const io, const PHYSFS_uint64 offset)
+{
+	auto &f = apk_asset_io_file(io);
+	if (offset > static_cast<PHYSFS_uint64>(f.length))
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+		return 0;
+	}
+	f.position = offset;
+	return 1;
+}
+
+static PHYSFS_sint64 apk_asset_io_tell(PHYSFS_Io *const io)
+{
+	return apk_asset_io_file(io).position;
+}
+
+static PHYSFS_sint64 apk_asset_io_length(PHYSFS_Io *const io)
+{
+	return apk_asset_io_file(io).length;
+}
+
+static PHYSFS_Io *apk_asset_io_duplicate(PHYSFS_Io *const io)
+{
+	auto &f = apk_asset_io_file(io);
+	return apk_asset_make_io({f.asset, f.data, f.length, 0});
+}
+
+static int apk_asset_io_flush(PHYSFS_Io *)
+{
+	return 1;
+}
+
+static void apk_asset_io_destroy(PHYSFS_Io *const io)
+{
+	delete &apk_asset_io_file(io);
+	delete io;
+}
+
+static PHYSFS_Io *apk_asset_make_io(apk_asset_file &&f)
+{
+	return new PHYSFS_Io{
+		.version = 0,
+		.opaque = new apk_asset_file(std::move(f)),
+		.read = apk_asset_io_read,
+		.write = apk_asset_io_write,
+		.seek = apk_asset_io_seek,
+		.tell = apk_asset_io_tell,
+		.length = apk_asset_io_length,
+		.duplicate = apk_asset_io_duplicate,
+		.flush = apk_asset_io_flush,
+		.destroy = apk_asset_io_destroy,
+	};
+}
+
+static void *apk_assets_open_archive(PHYSFS_Io *const io, const char *const name, const int forWrite, int *const claimed)
+{
+	const auto ext = std::strrchr(name, '.');
+	if (!ext || d_stricmp(ext + 1, apk_assets_extension) || !Apk_asset_manager)
+		return nullptr;
+	*claimed = 1;
+	if (forWrite)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+		return nullptr;
+	}
+	const auto dir = AAssetManager_openDir(Apk_asset_manager, "");
+	if (!dir)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+		return nullptr;
+	}
+	auto r = std::make_unique<apk_asset_directory>();
+	/* The lengths are found when first needed, since finding one opens
+	 * the asset.
+	 */
+	while (const auto f = AAssetDir_getNextFileName(dir))
+		r->files.push_back({f, -1});
+	AAssetDir_close(dir);
+	r->io = io;
+	return r.release();
+}
+
+static PHYSFS_EnumerateCallbackResult apk_assets_enumerate(void *const opaque, const char *const dirname, const PHYSFS_EnumerateCallback cb, const char *const origdir, void *const callbackdata)
+{
+	/* The NDK lists only the files of a directory, so only the top level
+	 * is offered.
+	 */
+	if (*dirname)
+		return PHYSFS_ENUM_OK;
+	for (auto &f : static_cast<apk_asset_directory *>(opaque)->files)
+		switch (const auto r = cb(callbackdata, origdir, f.name.c_str()))
+		{
+			case PHYSFS_ENUM_OK:
+				break;
+			case PHYSFS_ENUM_ERROR:
+				PHYSFS_setErrorCode(PHYSFS_ERR_APP_CALLBACK);
+				[[fallthrough]];
+			default:
+				return r;
+		}
+	return PHYSFS_ENUM_OK;
+}
+
+static PHYSFS_Io *apk_assets_open_read(void *const opaque, const char *const filename)
+{
+	const auto entry = static_cast<apk_asset_directory *>(opaque)->find(filename);
+	if (!entry)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+		return nullptr;
+	}
+	std::shared_ptr<AAsset> asset{AAssetManager_open(Apk_asset_manager, entry->name.c_str(), AASSET_MODE_BUFFER), apk_asset_close{}};
+	if (!asset)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+		return nullptr;
+	}
+	/* A compressed asset is inflated into memory here.  The build keeps
+	 * the game data uncompressed so that this is a mapping of the APK.
+	 */
+	const auto data = static_cast<const uint8_t *>(AAsset_getBuffer(asset.get()));
+	if (!data)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_IO);
+		return nullptr;
+	}
+	const auto length = AAsset_getLength64(asset.get());
+	return apk_asset_make_io({std::move(asset), data, length, 0});
+}
+
+static PHYSFS_Io *apk_assets_open_write(void *, const char *)
+{
+	PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+	return nullptr;
+}
+
+static int apk_assets_modify(void *, const char *)
+{
+	PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+	return 0;
+}
+
+static int apk_assets_stat(void *const opaque, const char *const filename, PHYSFS_Stat *const st)
+{
+	*st = {};
+	st->modtime = st->createtime = st->accesstime = -1;
+	st->readonly = 1;
+	if (!*filename)
+	{
+		st->filetype = PHYSFS_FILETYPE_DIRECTORY;
+		return 1;
+	}
+	const auto entry = static_cast<apk_asset_directory *>(opaque)->find(filename);
+	if (!entry)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+		return 0;
+	}
+	if (entry->length < 0)
+		if (const auto a = AAssetManager_open(Apk_asset_manager, entry->name.c_str(), AASSET_MODE_UNKNOWN))
+		{
+			entry->length = AAsset_getLength64(a);
+			AAsset_close(a);
+		}
+	st->filetype = PHYSFS_FILETYPE_REGULAR;
+	st->filesize = entry->length;
+	return 1;
+}
+
+static void apk_assets_close_archive(void *const opaque)
+{
+	const std::unique_ptr<apk_asset_directory> d{static_cast<apk_asset_directory *>(opaque)};
+	d->io->destroy(d->io);
+}
+
+static const PHYSFS_Archiver apk_assets_archiver{
+	.version = 0,
+	.info = {
+		.extension = apk_assets_extension,
+		.description = "Android APK assets",
+		.author = "DXX-Rebirth",
+		.url = "https://www.dxx-rebirth.com/",
+		.supportsSymlinks = 0,
+	},
+	.openArchive = apk_assets_open_archive,
+	.enumerate = apk_assets_enumerate,
+	.openRead = apk_assets_open_read,
+	.openWrite = apk_assets_open_write,
+	.openAppend = apk_assets_open_write,
+	.remove = apk_assets_modify,
+	.mkdir = apk_assets_modify,
+	.stat = apk_assets_stat,
+	.closeArchive = apk_assets_close_archive,
+};
+
+static AAssetManager *get_apk_asset_manager()
+{
+	const auto env = static_cast<JNIEnv *>(SDL_AndroidGetJNIEnv());
+	const auto activity = static_cast<jobject>(SDL_AndroidGetActivity());
+	if (!env || !activity)
+		return nullptr;
+	AAssetManager *r{};
+	const auto cls = env->GetObjectClass(activity);
+	if (const auto get_assets = env->GetMethodID(cls, "getAssets", "()Landroid/content/res/AssetManager;"))
+		if (const auto assets = env->CallObjectMethod(activity, get_assets))
+		{
+			/* The native manager is valid while the Java object lives,
+			 * which is kept for the life of the program.
+			 */
+			r = AAssetManager_fromJava(env, env->NewGlobalRef(assets));
+			env->DeleteLocalRef(assets);
+		}
+	if (env->ExceptionCheck())
+		env->ExceptionClear();
+	env->DeleteLocalRef(cls);
+	env->DeleteLocalRef(activity);
+	return r;
+}
+
+}
+
+void PHYSFSX_mountApkAssets()
+{
+	Apk_asset_manager = get_apk_asset_manager();
+	if (!Apk_asset_manager)
+	{
+		con_puts(CON_VERBOSE, "PHYSFS: no Android asset manager, not reading game data from the APK");
+		return;
+	}
+	if (!PHYSFS_registerArchiver(&apk_assets_archiver))
+	{
+		con_printf(CON_URGENT, "PHYSFS: failed to register the APK asset archiver: %s", PHYSFS_getLastError());
+		return;
+	}
+	/* The archiver reads nothing from its stream; the mount only needs a
+	 * name with the archiver's extension.
+	 */
+	static const uint8_t marker{};
+	if (PHYSFS_mountMemory(&marker, sizeof(marker), nullptr, apk_assets_mount_name, nullptr, 1))
+		con_puts(CON_DEBUG, "PHYSFS: appended the APK assets to the search path");
+	else
+		con_printf(CON_VERBOSE, "PHYSFS: failed to mount the APK assets: %s", PHYSFS_getLastError());
+}
+
+}
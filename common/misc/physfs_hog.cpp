@@ -0,0 +1,563 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * PhysFS archiver for HOG files, with the directory of indexed HOGs
+ *
+ */
+
+/* A HOG is "DHF", then for each file a 13 byte name, a 32 bit little
+ * endian length, and the data.  There is no directory, so finding a file
+ * reads a header from every page of the HOG.
+ *
+ * `hogcreate -a` writes an indexed HOG, which is still a HOG to every
+ * reader.  The data of each file starts on a 4096 byte boundary, with the
+ * gaps filled by files named hogpad.dxx.  The last file, hogindex.dxx,
+ * holds a hashed directory:
+ *
+ *	char magic[8]		"DXXHOGIX"
+ *	uint32_t version	1
+ *	uint32_t alignment	4096
+ *	uint32_t count		the number of files, without the padding
+ *	uint32_t buckets	a power of two
+ *	uint32_t bucket[buckets]	1 + the first file in the chain, or 0
+ *	then for each file:
+ *	char name[13], pad[3]
+ *	uint32_t offset, length	where the data is in the HOG
+ *	uint32_t next		1 + the next file in the chain, or 0
+ *	uint32_t index_length	the length of hogindex.dxx
+ *	char magic[8]		"DXXHOGIX"
+ *
+ * Each value is little endian.  A file is in the chain of the bucket
+ * picked by the FNV-1a hash of its lower case name.  The index ends the
+ * HOG, so a reader finds it from the last 12 bytes.
+ *
+ * PhysFS's own HOG reader is replaced, since it would claim every HOG
+ * first.  A HOG without a valid index is read as before.  PhysFS does not
+ * give access to its own archiver once it is replaced, so the HOG2 files
+ * of Descent 3, which it also read, are read here:
+ *
+ *	char magic[4]		"HOG2"
+ *	uint32_t count
+ *	uint32_t data_offset	where the data of the first file starts
+ *	char reserved[56]
+ *	then for each file:
+ *	char name[36]
+ *	uint32_t flags, length, timestamp
+ *
+ * The data of the files follows in the same order.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "physfsx.h"
+#include "console.h"
+#include "strutil.h"
+
+namespace dcx {
+
+namespace {
+
+constexpr char hog_extension[]{"HOG"};
+constexpr char hog_index_magic[]{"DXXHOGIX"};
+constexpr char hog_index_name[]{"hogindex.dxx"};
+constexpr char hog_pad_name[]{"hogpad.dxx"};
+constexpr std::size_t hog_name_length{13};
+constexpr std::size_t hog_header_length{hog_name_length + 4};
+constexpr std::size_t hog2_name_length{36};
+constexpr std::size_t hog2_header_length{4 + 4 * 2 + 56};
+constexpr std::size_t hog2_entry_length{hog2_name_length + 4 * 3};
+constexpr std::size_t hog_index_header_length{8 + 4 * 4};
+constexpr std::size_t hog_index_entry_length{16 + 4 * 3};
+constexpr std::size_t hog_index_trailer_length{4 + 8};
+
+struct hog_entry
+{
+	std::array<char, hog2_name_length + 1> name;
+	uint32_t offset, length;
+	/* 1 + the next entry in the chain, or 0 */
+	uint32_t next;
+};
+
+struct hog_directory
+{
+	PHYSFS_Io *io;
+	/* The path the HOG was mounted from */
+	std::string path;
+	std::vector<hog_entry> files;
+	std::vector<uint32_t> buckets;
+	const hog_entry *find(const char *name) const;
+};
+
+/* The mounted HOGs, so that a member can be found by the path of its
+ * archive
+ */
+struct hog_registry
+{
+	std::mutex m;
+	std::vector<const hog_directory *> mounted;
+};
+
+static hog_registry Hog_registry;
+
+struct hog_file
+{
+	PHYSFS_Io *io;
+	uint32_t offset, length, position;
+};
+
+static uint32_t hog_read_u32(const uint8_t *const p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint32_t hog_name_hash(const char *name)
+{
+	uint32_t h{2166136261u};
+	for (; *name; ++name)
+		h = (h ^ static_cast<uint8_t>(std::tolower(static_cast<uint8_t>(*name)))) * 16777619u;
+	return h;
+}
+
+static bool hog_read_all(PHYSFS_Io *const io, void *const buf, const PHYSFS_uint64 len)
+{
+	return io->read(io, buf, len) == static_cast<PHYSFS_sint64>(len);
+}
+
+const hog_entry *hog_directory::find(const char *const name) const
+{
+	if (buckets.empty())
+		return nullptr;
+	for (auto i{buckets[hog_name_hash(name) & (buckets.size() - 1)]}; i; i = files[i - 1].next)
+	{
+		auto &f{files[i - 1]};
+		if (!d_stricmp(f.name.data(), name))
+			return &f;
+	}
+	return nullptr;
+}
+
+/* Make room in the chains for `count` files */
+static void hog_size_buckets(hog_directory &d, const std::size_t count)
+{
+	std::size_t n{1};
+	while (n < count)
+		n <<= 1;
+	d.buckets.assign(n, 0);
+	d.files.clear();
+	d.files.reserve(count);
+}
+
+/* A later file of the same name replaces an earlier one, in the place of
+ * the earlier one.
+ */
+static void hog_add_entry(hog_directory &d, hog_entry f)
+{
+	auto &b{d.buckets[hog_name_hash(f.name.data()) & (d.buckets.size() - 1)]};
+	for (auto i{b}; i; i = d.files[i - 1].next)
+		if (auto &e{d.files[i - 1]}; !d_stricmp(e.name.data(), f.name.data()))
+		{
+			f.next = e.next;
+			e = f;
+			return;
+		}
+	f.next = b;
+	d.files.push_back(f);
+	b = static_cast<uint32_t>(d.files.size());
+}
+
+/* Read the directory that hogcreate -a appended.  Returns false, having
+ * read nothing into `d`, if there is none or it does not describe this
+ * HOG.
+ */
+static bool hog_load_index(hog_directory &d, const PHYSFS_uint64 hog_length)
+{
+	const auto io{d.io};
+	if (hog_length < 3 + hog_header_length + hog_index_header_length + hog_index_trailer_length)
+		return false;
+	std::array<uint8_t, hog_index_trailer_length> trailer;
+	if (!io->seek(io, hog_length - trailer.size()) || !hog_read_all(io, trailer.data(), trailer.size()))
+		return false;
+	if (std::memcmp(&trailer[4], hog_index_magic, 8))
+		return false;
+	const auto index_length{hog_read_u32(trailer.data())};
+	if (index_length < hog_index_header_length + hog_index_trailer_length || index_length > hog_length - 3 - hog_header_length)
+		return false;
+	/* The index must be the data of the last file, so that readers that
+	 * ignore it still see a valid HOG.
+	 */
+	const auto index_offset{hog_length - index_length};
+	std::vector<uint8_t> index(hog_header_length + index_length);
+	if (!io->seek(io, index_offset - hog_header_length) || !hog_read_all(io, index.data(), index.size()))
+		return false;
+	if (d_stricmp(reinterpret_cast<const char *>(index.data()), hog_index_name) || hog_read_u32(&index[13]) != index_length)
+		return false;
+	const auto header{&index[hog_header_length]};
+	if (std::memcmp(header, hog_index_magic, 8) || hog_read_u32(header + 8) != 1)
+		return false;
+	const auto count{hog_read_u32(header + 16)}, bucket_count{hog_read_u32(header + 20)};
+	if (!bucket_count || (bucket_count & (bucket_count - 1)) ||
+		(index_length - hog_index_header_length - hog_index_trailer_length) / 4 < bucket_count ||
+		(index_length - hog_index_header_length - hog_index_trailer_length - 4 * static_cast<PHYSFS_uint64>(bucket_count)) != static_cast<PHYSFS_uint64>(count) * hog_index_entry_length)
+		return false;
+	std::vector<uint32_t> buckets(bucket_count);
+	auto p{header + hog_index_header_length};
+	for (auto &b : buckets)
+	{
+		b = hog_read_u32(p);
+		p += 4;
+		if (b > count)
+			return false;
+	}
+	std::vector<hog_entry> files(count);
+	for (auto &f : files)
+	{
+		f.name = {};
+		std::memcpy(f.name.data(), p, hog_name_length - 1);
+		f.offset = hog_read_u32(p + 16);
+		f.length = hog_read_u32(p + 20);
+		f.next = hog_read_u32(p + 24);
+		p += hog_index_entry_length;
+		if (f.next > count || f.offset < 3 + hog_header_length || f.offset > index_offset - hog_header_length || f.length > index_offset - hog_header_length - f.offset)
+			return false;
+	}
+	d.files = std::move(files);
+	d.buckets = std::move(buckets);
+	return true;
+}
+
+/* Read every header, as PhysFS's HOG reader does */
+static bool hog_load_entries(hog_directory &d, const PHYSFS_uint64 hog_length)
+{
+	const auto io{d.io};
+	std::vector<hog_entry> files;
+	for (PHYSFS_uint64 pos{3}; pos < hog_length;)
+	{
+		std::array<uint8_t, hog_header_length> header;
+		if (!io->seek(io, pos) || !hog_read_all(io, header.data(), header.size()))
+			return false;
+		hog_entry f{};
+		std::memcpy(f.name.data(), header.data(), hog_name_length - 1);
+		f.length = hog_read_u32(&header[13]);
+		pos += header.size();
+		if (f.length > hog_length - pos)
+		{
+			PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+			return false;
+		}
+		f.offset = pos;
+		pos += f.length;
+		if (!d_stricmp(f.name.data(), hog_pad_name) || !d_stricmp(f.name.data(), hog_index_name))
+			continue;
+		files.push_back(f);
+	}
+	hog_size_buckets(d, files.size());
+	for (auto &f : files)
+		hog_add_entry(d, f);
+	return true;
+}
+
+/* Read the table of a HOG2, as PhysFS's HOG reader does */
+static bool hog2_load_entries(hog_directory &d, const PHYSFS_uint64 hog_length)
+{
+	const auto io{d.io};
+	std::array<uint8_t, hog2_header_length> header;
+	if (!io->seek(io, 0) || !hog_read_all(io, header.data(), header.size()))
+		return false;
+	const auto count{hog_read_u32(&header[4])};
+	if (count > (hog_length - header.size()) / hog2_entry_length)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+		return false;
+	}
+	std::vector<uint8_t> table(count * hog2_entry_length);
+	if (!hog_read_all(io, table.data(), table.size()))
+		return false;
+	hog_size_buckets(d, count);
+	PHYSFS_uint64 pos{hog_read_u32(&header[8])};
+	for (auto p{table.data()}; p != table.data() + table.size(); p += hog2_entry_length)
+	{
+		hog_entry f{};
+		std::memcpy(f.name.data(), p, hog2_name_length);
+		f.length = hog_read_u32(p + hog2_name_length + 4);
+		if (pos > hog_length || f.length > hog_length - pos || pos > UINT32_MAX)
+		{
+			PHYSFS_setErrorCode(PHYSFS_ERR_CORRUPT);
+			return false;
+		}
+		f.offset = pos;
+		pos += f.length;
+		hog_add_entry(d, f);
+	}
+	return true;
+}
+
+static PHYSFS_Io *hog_make_io(hog_file &&);
+
+static hog_file &hog_io_file(PHYSFS_Io *const io)
+{
+	return *static_cast<hog_file *>(io->opaque);
+}
+
+static PHYSFS_sint64 hog_io_read(PHYSFS_Io *const io, void *const buf, const PHYSFS_uint64 len)
+{
+	auto &f = hog_io_file(io);
+	const auto n{std::min<PHYSFS_uint64>(len, f.length - f.position)};
+	if (!n)
+		return 0;
+	const auto r{f.io->read(f.io, buf, n)};
+	if (r > 0)
+		f.position += r;
+	return r;
+}
+
+static PHYSFS_sint64 hog_io_write(PHYSFS_Io *, const void *, PHYSFS_uint64)
+{
+	PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+	return -1;
+}
+
+static int hog_io_seek(PHYSFS_Io *const io, const PHYSFS_uint64 offset)
+{
+	auto &f = hog_io_file(io);
+	if (offset > f.length)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_PAST_EOF);
+		return 0;
+	}
+	if (!f.io->seek(f.io, f.offset + offset))
+		return 0;
+	f.position = offset;
+	return 1;
+}
+
+static PHYSFS_sint64 hog_io_tell(PHYSFS_Io *const io)
+{
+	return hog_io_file(io).position;
+}
+
+static PHYSFS_sint64 hog_io_length(PHYSFS_Io *const io)
+{
+	return hog_io_file(io).length;
+}
+
+static PHYSFS_Io *hog_open_member(PHYSFS_Io *const archive, const uint32_t offset, const uint32_t length)
+{
+	const auto io{archive->duplicate(archive)};
+	if (!io)
+		return nullptr;
+	if (!io->seek(io, offset))
+	{
+		io->destroy(io);
+		return nullptr;
+	}
+	return hog_make_io({io, offset, length, 0});
+}
+
+static PHYSFS_Io *hog_io_duplicate(PHYSFS_Io *const io)
+{
+	auto &f = hog_io_file(io);
+	return hog_open_member(f.io, f.offset, f.length);
+}
+
+static int hog_io_flush(PHYSFS_Io *)
+{
+	return 1;
+}
+
+static void hog_io_destroy(PHYSFS_Io *const io)
+{
+	auto &f = hog_io_file(io);
+	f.io->destroy(f.io);
+	delete &f;
+	delete io;
+}
+
+static PHYSFS_Io *hog_make_io(hog_file &&f)
+{
+	return new PHYSFS_Io{
+		.version = 0,
+		.opaque = new hog_file(std::move(f)),
+		.read = hog_io_read,
+		.write = hog_io_write,
+		.seek = hog_io_seek,
+		.tell = hog_io_tell,
+		.length = hog_io_length,
+		.duplicate = hog_io_duplicate,
+		.flush = hog_io_flush,
+		.destroy = hog_io_destroy,
+	};
+}
+
+static void *hog_open_archive(PHYSFS_Io *const io, const char *const name, const int forWrite, int *const claimed)
+{
+	std::array<char, 4> magic;
+	if (!io->seek(io, 0) || !hog_read_all(io, magic.data(), magic.size()))
+		return nullptr;
+	const bool hog2{!std::memcmp(magic.data(), "HOG2", 4)};
+	if (!hog2 && std::memcmp(magic.data(), "DHF", 3))
+		return nullptr;
+	*claimed = 1;
+	if (forWrite)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+		return nullptr;
+	}
+	const auto hog_length{io->length(io)};
+	if (hog_length < 0)
+		return nullptr;
+	auto r = std::make_unique<hog_directory>();
+	r->io = io;
+	if (hog2)
+	{
+		if (!hog2_load_entries(*r, hog_length))
+			return nullptr;
+	}
+	else if (hog_load_index(*r, hog_length))
+		con_printf(CON_DEBUG, "PHYSFS: read the directory of %zu files from \"%s\"", r->files.size(), name);
+	else if (!hog_load_entries(*r, hog_length))
+		return nullptr;
+	r->path = name;
+	{
+		const std::lock_guard lock{Hog_registry.m};
+		Hog_registry.mounted.push_back(r.get());
+	}
+	return r.release();
+}
+
+static PHYSFS_EnumerateCallbackResult hog_enumerate(void *const opaque, const char *const dirname, const PHYSFS_EnumerateCallback cb, const char *const origdir, void *const callbackdata)
+{
+	/* A HOG has no directories */
+	if (*dirname)
+		return PHYSFS_ENUM_OK;
+	for (auto &f : static_cast<hog_directory *>(opaque)->files)
+		switch (const auto r = cb(callbackdata, origdir, f.name.data()))
+		{
+			case PHYSFS_ENUM_OK:
+				break;
+			case PHYSFS_ENUM_ERROR:
+				PHYSFS_setErrorCode(PHYSFS_ERR_APP_CALLBACK);
+				[[fallthrough]];
+			default:
+				return r;
+		}
+	return PHYSFS_ENUM_OK;
+}
+
+static PHYSFS_Io *hog_open_read(void *const opaque, const char *const filename)
+{
+	const auto d{static_cast<hog_directory *>(opaque)};
+	const auto entry{d->find(filename)};
+	if (!entry)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+		return nullptr;
+	}
+	return hog_open_member(d->io, entry->offset, entry->length);
+}
+
+static PHYSFS_Io *hog_open_write(void *, const char *)
+{
+	PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+	return nullptr;
+}
+
+static int hog_modify(void *, const char *)
+{
+	PHYSFS_setErrorCode(PHYSFS_ERR_READ_ONLY);
+	return 0;
+}
+
+static int hog_stat(void *const opaque, const char *const filename, PHYSFS_Stat *const st)
+{
+	*st = {};
+	st->modtime = st->createtime = st->accesstime = -1;
+	st->readonly = 1;
+	if (!*filename)
+	{
+		st->filetype = PHYSFS_FILETYPE_DIRECTORY;
+		return 1;
+	}
+	const auto entry{static_cast<hog_directory *>(opaque)->find(filename)};
+	if (!entry)
+	{
+		PHYSFS_setErrorCode(PHYSFS_ERR_NOT_FOUND);
+		return 0;
+	}
+	st->filetype = PHYSFS_FILETYPE_REGULAR;
+	st->filesize = entry->length;
+	return 1;
+}
+
+static void hog_close_archive(void *const opaque)
+{
+	const std::unique_ptr<hog_directory> d{static_cast<hog_directory *>(opaque)};
+	{
+		const std::lock_guard lock{Hog_registry.m};
+		std::erase(Hog_registry.mounted, d.get());
+	}
+	d->io->destroy(d->io);
+}
+
+static const PHYSFS_Archiver hog_archiver{
+	.version = 0,
+	.info = {
+		.extension = hog_extension,
+		.description = "Descent I/II HOG file format, with the hogcreate index, and Descent 3 HOG2",
+		.author = "DXX-Rebirth",
+		.url = "https://www.dxx-rebirth.com/",
+		.supportsSymlinks = 0,
+	},
+	.openArchive = hog_open_archive,
+	.enumerate = hog_enumerate,
+	.openRead = hog_open_read,
+	.openWrite = hog_open_write,
+	.openAppend = hog_open_write,
+	.remove = hog_modify,
+	.mkdir = hog_modify,
+	.stat = hog_stat,
+	.closeArchive = hog_close_archive,
+};
+
+}
+
+void PHYSFSX_registerHogArchiver()
+{
+	/* PhysFS tries the archivers for an extension in the order they were
+	 * registered, and its own would claim every HOG.
+	 */
+	if (!PHYSFS_deregisterArchiver(hog_extension))
+	{
+		con_printf(CON_VERBOSE, "PHYSFS: keeping the built in HOG reader: %s", PHYSFS_getLastError());
+		return;
+	}
+	if (!PHYSFS_registerArchiver(&hog_archiver))
+		con_printf(CON_URGENT, "PHYSFS: failed to register the HOG archiver: %s", PHYSFS_getLastError());
+}
+
+bool PHYSFSX_findHogMember(const char *const archive, const char *const filename, PHYSFS_uint64 &offset, PHYSFS_uint64 &length)
+{
+	const std::lock_guard lock{Hog_registry.m};
+	for (const auto d : Hog_registry.mounted)
+		if (d->path == archive)
+			if (const auto entry{d->find(filename)})
+			{
+				offset = entry->offset;
+				length = entry->length;
+				return true;
+			}
+	return false;
+}
+
+}
@@ -15,6 +15,21 @@
 #include "physfs_list.h"
 #include "physfsx.h"
 #include "strutil.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace dcx {
 
@@ -112,6 +127,28 @@ const file_extension_t *PHYSFSX_checkMatchingExtension(const char *filename, con
 	return nullptr;
 }
 
+/* Mount the archive that PhysFS finds as `relname`, whose real path is
+ * `realpath`.  An archive among the APK's assets has no path that the
+ * system can open, so it is mounted through a PhysFS handle, under the
+ * same name so that unmounting by path still finds it.
+ */
+static int PHYSFSX_mountArchive(const char *const relname, const char *const realpath, const char *const mountpoint, const int append)
+{
+	if (PHYSFS_mount(realpath, mountpoint, append))
+		return 1;
+#ifdef __ANDROID__
+	if (const auto fp = PHYSFS_openRead(relname))
+	{
+		if (PHYSFS_mountHandle(fp, realpath, mountpoint, append))
+			return 1;
+		PHYSFS_close(fp);
+	}
+#else
+	(void)relname;
+#endif
+	return 0;
+}
+
 // Add a searchpath, but that searchpath is relative to an existing searchpath
 // It will add the first one it finds and return a PhysFS error code, if it doesn't find any it returns PHYSFS_ERR_OK
 PHYSFS_ErrorCode PHYSFSX_addRelToSearchPath(char *const relname2, std::array<char, PATH_MAX> &pathname, physfs_search_path add_to_end)
@@ -126,7 +163,7 @@ PHYSFS_ErrorCode PHYSFSX_addRelToSearchPath(char *const relname2, std::array<cha
 		return PHYSFS_ERR_OK;
 	}
 
-	auto r = PHYSFS_mount(pathname.data(), nullptr, static_cast<int>(add_to_end));
+	auto r = PHYSFSX_mountArchive(relname2, pathname.data(), nullptr, static_cast<int>(add_to_end));
 	const auto action = add_to_end != physfs_search_path::prepend ? "append" : "insert";
 	if (r)
 	{
@@ -258,6 +295,7 @@ int PHYSFSX_rename(const char *oldpath, const char *newpath)
 	std::array<char, PATH_MAX> old, n;
 	if (!PHYSFSX_getRealPath(oldpath, old) || !PHYSFSX_getRealPath(newpath, n))
 		return -1;
+	PHYSFSEXT_invalidateCaseIndex();
 	return (rename(old.data(), n.data()) == 0);
 }
 
@@ -341,11 +379,290 @@ std::pair<RAIIPHYSFS_File, PHYSFS_ErrorCode> PHYSFSX_openWriteBuffered(const cha
 	RAIIPHYSFS_File fp{PHYSFS_openWrite(filename)};
 	if (!fp)
 		return {nullptr, PHYSFS_getLastErrorCode()};
+	PHYSFSEXT_invalidateCaseIndex();
 	while (!PHYSFS_setBuffer(fp, bufSize) && bufSize)
 		bufSize /= 2;
 	return {std::move(fp), PHYSFS_ERR_OK};
 }
 
+void PHYSFSX_printf(PHYSFSX_write_buffer &file, const char *const format, ...)
+{
+	auto &c = file.contents;
+	const auto used{c.size()};
+	va_list args;
+	va_start(args, format);
+	char buffer[1024];
+	const std::size_t len = std::max(vsnprintf(buffer, sizeof(buffer), format, args), 0);
+	va_end(args);
+	if (len < sizeof(buffer))
+	{
+		file.write(buffer, len);
+		return;
+	}
+	c.resize(used + len + 1);
+	va_start(args, format);
+	vsnprintf(reinterpret_cast<char *>(&c[used]), len + 1, format, args);
+	va_end(args);
+	c.pop_back();
+}
+
+namespace {
+
+/* One thread writes the queued files in order.  A request with no
+ * contents is a read ahead.
+ */
+class physfsx_write_queue
+{
+	struct request
+	{
+		std::string filename;
+		std::optional<std::vector<uint8_t>> contents;
+	};
+	std::mutex m;
+	std::condition_variable wake, idle;
+	std::deque<request> pending;
+	std::vector<std::pair<std::string, PHYSFS_ErrorCode>> failures;
+	bool busy{};
+	bool stop{};
+	std::thread worker{&physfsx_write_queue::worker_main, this};
+	static bool file_has_contents(const char *filename, std::span<const uint8_t> contents);
+	static PHYSFS_ErrorCode write_file(const std::string &filename, std::span<const uint8_t> contents);
+	void worker_main();
+	void report_failures(std::unique_lock<std::mutex> &lock);
+public:
+	~physfsx_write_queue()
+	{
+		{
+			std::lock_guard lock(m);
+			stop = true;
+		}
+		wake.notify_one();
+		worker.join();
+	}
+	void push(request &&r);
+	void wait();
+	void push_write(const char *const filename, std::vector<uint8_t> &&contents)
+	{
+		push({filename, std::move(contents)});
+	}
+	void push_read(const char *const filename)
+	{
+		push({filename, std::nullopt});
+	}
+};
+
+bool physfsx_write_queue::file_has_contents(const char *const filename, const std::span<const uint8_t> contents)
+{
+	const RAIIPHYSFS_File f{PHYSFS_openRead(filename)};
+	const PHYSFS_sint64 size = contents.size();
+	if (!f || PHYSFS_fileLength(f) != size)
+		return false;
+	std::vector<uint8_t> existing(contents.size());
+	return PHYSFS_readBytes(f, existing.data(), existing.size()) == size && std::ranges::equal(existing, contents);
+}
+
+PHYSFS_ErrorCode physfsx_write_queue::write_file(const std::string &filename, const std::span<const uint8_t> contents)
+{
+	if (file_has_contents(filename.c_str(), contents))
+		return PHYSFS_ERR_OK;
+	auto tempfile{filename};
+	tempfile.back() = '$';
+	auto &&[fp, physfserr]{PHYSFSX_openWriteBuffered(tempfile.c_str())};
+	if (!fp)
+	{
+		/* The players directory is created on the first write to it */
+		const auto slash{tempfile.rfind('/')};
+		if (slash == std::string::npos || slash == 0)
+			return physfserr;
+		PHYSFS_mkdir(tempfile.substr(0, slash).c_str());
+		auto &&[fp2, physfserr2]{PHYSFSX_openWriteBuffered(tempfile.c_str())};
+		if (!fp2)
+			return physfserr2;
+		fp = std::move(fp2);
+	}
+	if (PHYSFS_writeBytes(fp, contents.data(), contents.size()) != static_cast<PHYSFS_sint64>(contents.size()) || !fp.close())
+	{
+		const auto e{PHYSFS_getLastErrorCode()};
+		fp.reset();
+		PHYSFS_delete(tempfile.c_str());
+		return e;
+	}
+	PHYSFS_delete(filename.c_str());
+	if (PHYSFSX_rename(tempfile.c_str(), filename.c_str()) != 1)
+		return PHYSFS_ERR_IO;
+	return PHYSFS_ERR_OK;
+}
+
+void physfsx_write_queue::worker_main()
+{
+	std::unique_lock lock(m);
+	for (;;)
+	{
+		wake.wait(lock, [this] { return stop || !pending.empty(); });
+		/* Queued files are still written when the program exits */
+		if (pending.empty())
+			return;
+		auto r{std::move(pending.front())};
+		pending.pop_front();
+		busy = true;
+		lock.unlock();
+		auto e{PHYSFS_ERR_OK};
+		if (r.contents)
+			e = write_file(r.filename, *r.contents);
+		else
+			PHYSFSX_readAhead(r.filename.c_str());
+		lock.lock();
+		if (e != PHYSFS_ERR_OK)
+			failures.emplace_back(std::move(r.filename), e);
+		busy = false;
+		if (pending.empty())
+			idle.notify_all();
+	}
+}
+
+void physfsx_write_queue::report_failures(std::unique_lock<std::mutex> &lock)
+{
+	if (failures.empty())
+		return;
+	const auto f{std::exchange(failures, {})};
+	lock.unlock();
+	for (const auto &[filename, e] : f)
+		con_printf(CON_URGENT, "Failed to write \"%s\": %s", filename.c_str(), PHYSFS_getErrorByCode(e));
+	lock.lock();
+}
+
+void physfsx_write_queue::push(request &&r)
+{
+	std::unique_lock lock(m);
+	report_failures(lock);
+	const auto same_file{std::ranges::find(pending, r.filename, &request::filename)};
+	if (same_file == pending.end())
+		pending.emplace_back(std::move(r));
+	else if (r.contents)
+		/* Write the newer contents where the older were queued.  A read
+		 * ahead of a file already queued is dropped.
+		 */
+		same_file->contents = std::move(r.contents);
+	else
+		return;
+	wake.notify_one();
+}
+
+void physfsx_write_queue::wait()
+{
+	std::unique_lock lock(m);
+	idle.wait(lock, [this] { return !busy && pending.empty(); });
+	report_failures(lock);
+}
+
+physfsx_write_queue &get_write_queue()
+{
+	static physfsx_write_queue queue;
+	return queue;
+}
+
+}
+
+void PHYSFSX_readAhead(const char *const filename)
+{
+	const RAIIPHYSFS_File f{PHYSFS_openRead(filename)};
+	if (!f)
+		return;
+	std::array<uint8_t, 65536> buffer;
+	while (PHYSFS_readBytes(f, buffer.data(), buffer.size()) == static_cast<PHYSFS_sint64>(buffer.size()))
+	{
+	}
+}
+
+void PHYSFSX_queueWrite(const char *const filename, PHYSFSX_write_buffer &&contents)
+{
+	get_write_queue().push_write(filename, std::move(contents.contents));
+}
+
+void PHYSFSX_queueReadAhead(const char *const filename)
+{
+	get_write_queue().push_read(filename);
+}
+
+void PHYSFSX_waitForQueuedWrites()
+{
+	get_write_queue().wait();
+}
+
+void PHYSFSX_mapped_file::reset()
+{
+#ifndef _WIN32
+	if (base)
+		munmap(const_cast<uint8_t *>(base), length);
+#endif
+	base = nullptr;
+	length = 0;
+}
+
+void PHYSFSX_mapped_file::prefetch(std::size_t offset, std::size_t n) const
+{
+#ifndef _WIN32
+	if (offset >= length)
+		return;
+	n = std::min(n, length - offset);
+	static const std::size_t page_size{static_cast<std::size_t>(sysconf(_SC_PAGESIZE))};
+	const auto page_offset{offset % page_size};
+	madvise(const_cast<uint8_t *>(base + offset - page_offset), n + page_offset, MADV_WILLNEED);
+#else
+	(void)offset;
+	(void)n;
+#endif
+}
+
+PHYSFSX_mapped_file PHYSFSX_mapReadOnly(const char *const filename, const PHYSFS_sint64 expected_length)
+{
+#ifndef _WIN32
+	if (expected_length <= 0)
+		return {};
+	/* Find the name with the case that PhysFS used to open the file */
+	char name[PATH_MAX];
+	snprintf(name, sizeof(name), "%s", filename);
+	std::array<char, PATH_MAX> real_path;
+	if (PHYSFSEXT_locateCorrectCase(name) != PHYSFSX_case_search_result::success || !PHYSFSX_getRealPath(name, real_path))
+		return {};
+	/* When PhysFS found the file in an archive, the real path names a
+	 * member of the archive file, and open fails.  A member of a HOG is
+	 * mapped from the HOG if its data starts on a page.
+	 */
+	PHYSFS_uint64 offset{0}, length;
+	int fd{open(real_path.data(), O_RDONLY)};
+	if (fd == -1)
+	{
+		const auto archive{PHYSFS_getRealDir(name)};
+		if (!archive || std::strchr(name, '/') || !PHYSFSX_findHogMember(archive, name, offset, length))
+			return {};
+		static const PHYSFS_uint64 page_size{static_cast<PHYSFS_uint64>(sysconf(_SC_PAGESIZE))};
+		if (length != static_cast<PHYSFS_uint64>(expected_length) || offset % page_size || (fd = open(archive, O_RDONLY)) == -1)
+			return {};
+		snprintf(real_path.data(), real_path.size(), "%s", archive);
+	}
+	struct stat st;
+	void *p{MAP_FAILED};
+	if (!fstat(fd, &st) && S_ISREG(st.st_mode))
+	{
+		/* No member of a HOG starts at 0 */
+		if (!offset)
+			length = st.st_size;
+		if (length == static_cast<PHYSFS_uint64>(expected_length) && offset + length <= static_cast<PHYSFS_uint64>(st.st_size))
+			p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, offset);
+	}
+	close(fd);
+	if (p == MAP_FAILED)
+		return {};
+	con_printf(CON_VERBOSE, "PHYSFS: mapped \"%s\" from \"%s\"", filename, real_path.data());
+	return {static_cast<const uint8_t *>(p), static_cast<std::size_t>(length)};
+#else
+	(void)filename;
+	(void)expected_length;
+	return {};
+#endif
+}
+
 static uint8_t add_archives_to_search_path()
 {
 	uint8_t content_updated{};
@@ -357,7 +674,7 @@ static uint8_t add_archives_to_search_path()
 	for (const auto i : s)
 	{
 		std::array<char, PATH_MAX> realfile;
-		if (PHYSFSX_getRealPath(i, realfile) && PHYSFS_mount(realfile.data(), nullptr, 0))
+		if (PHYSFSX_getRealPath(i, realfile) && PHYSFSX_mountArchive(i, realfile.data(), nullptr, 0))
 		{
 			con_printf(CON_DEBUG, "PHYSFS: Added %s to Search Path",realfile.data());
 			content_updated = 1;
@@ -375,7 +692,7 @@ static uint8_t add_demo_files_to_search_path(uint8_t content_updated)
 		char demofile[PATH_MAX];
 		snprintf(demofile, sizeof(demofile), DEMO_DIR "%s", i);
 		std::array<char, PATH_MAX> realfile;
-		if (PHYSFSX_getRealPath(demofile, realfile) && PHYSFS_mount(realfile.data(), DEMO_DIR, 0))
+		if (PHYSFSX_getRealPath(demofile, realfile) && PHYSFSX_mountArchive(demofile, realfile.data(), DEMO_DIR, 0))
 		{
 			con_printf(CON_DEBUG, "PHYSFS: Added %s to " DEMO_DIR, realfile.data());
 			content_updated = 1;
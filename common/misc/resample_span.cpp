@@ -0,0 +1,88 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * The vector version uses the compiler's generic vector types, which it
+ * lowers to SSE2 on x86 and to NEON on ARM.  Each step computes the same
+ * phase of several consecutive input positions, so every lane uses the
+ * same coefficient, and the samples are one unaligned load.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "resample_span.h"
+
+namespace dcx {
+
+namespace {
+
+constexpr std::size_t resample_lanes_per_step = 8;
+using resample_lanes = int32_t __attribute__((vector_size(resample_lanes_per_step * sizeof(int32_t))));
+
+int32_t resample_signed_sample(const uint8_t s)
+{
+	return int32_t{s} + INT8_MIN;
+}
+
+}
+
+void digi_resample_fir(const std::span<const uint8_t> input, const std::size_t factor, const std::span<const int32_t, digi_resample_filter_length> coeffs, const std::span<int16_t> output)
+{
+	const std::size_t n = input.size();
+	/* Output q * factor + p is the sum of x[q - t] * coeffs[p + t * factor].
+	 * Phase 0 has the most taps.
+	 */
+	const std::size_t taps = (digi_resample_filter_length + factor - 1) / factor;
+	/* The samples, converted to signed, after enough zeros that the first
+	 * outputs can read back past the start of the sound.
+	 */
+	std::vector<int32_t> padded(taps + n);
+	std::transform(input.begin(), input.end(), std::next(padded.begin(), taps), resample_signed_sample);
+	const int32_t *const x = padded.data() + taps;
+	std::size_t q = 0;
+	for (; n - q >= resample_lanes_per_step; q += resample_lanes_per_step)
+		for (std::size_t p = 0; p != factor; ++p)
+		{
+			resample_lanes acc{};
+			for (std::size_t t = 0, j = p; j < digi_resample_filter_length; ++t, j += factor)
+			{
+				resample_lanes s;
+				std::memcpy(&s, x + q - t, sizeof(s));
+				acc += s * coeffs[j];
+			}
+			for (std::size_t l = 0; l != resample_lanes_per_step; ++l)
+				output[(q + l) * factor + p] = static_cast<int16_t>(acc[l] >> 8);
+		}
+	for (; q != n; ++q)
+		for (std::size_t p = 0; p != factor; ++p)
+		{
+			int32_t acc{};
+			for (std::size_t t = 0, j = p; j < digi_resample_filter_length; ++t, j += factor)
+				acc += *(x + q - t) * coeffs[j];
+			output[q * factor + p] = static_cast<int16_t>(acc >> 8);
+		}
+}
+
+void digi_resample_fir_reference(const std::span<const uint8_t> input, const std::size_t factor, const std::span<const int32_t, digi_resample_filter_length> coeffs, const std::span<int16_t> output)
+{
+	const std::size_t outsize = input.size() * factor;
+	for (std::size_t nn = 0; nn != outsize; ++nn)
+	{
+		/* Only every factor'th position of the upsampled signal holds a
+		 * sample.  The rest are zero.
+		 */
+		const std::size_t min_idx = (nn + 1 > digi_resample_filter_length ? nn + 1 - digi_resample_filter_length : 0u);
+		int32_t acc{};
+		for (std::size_t kk = min_idx; kk <= nn; ++kk)
+			if (kk % factor == 0)
+				acc += resample_signed_sample(input[kk / factor]) * coeffs[nn - kk];
+		output[nn] = static_cast<int16_t>(acc >> 8);
+	}
+}
+
+}
@@ -29,12 +29,14 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <algorithm>
 #include "maths.h"
 #include "gr.h"
 #include "grdef.h"
 #include "texmap.h"
 #include "texmapl.h"
 #include "scanline.h"
+#include "tmap_span.h"
 #include "strutil.h"
 #include "dxxerror.h"
 
@@ -42,159 +44,60 @@ namespace dcx {
 
 tmap_scanline_function_table tmap_scanline_functions;
 
-void c_tmap_scanline_flat()
+//the current scanline, stopping where the per pixel index check of the
+//other scanline functions would stop
+static tmap_span tmap_scanline_span()
 {
-	uint8_t *dest;
-        int x, index = fx_xleft + (bytes_per_row * fx_y );
+	const int index = fx_xleft + (bytes_per_row * fx_y);
+	const int width = fx_xright - fx_xleft + 1;
+	const int limit = SWIDTH * SHEIGHT - index - 1;
+	return {
+		.dest = &write_buffer[index],
+		.pixels = pixptr,
+		.fade = gr_fade_table.front().data(),
+		.count = static_cast<unsigned>(std::max(std::min(width, limit), 0)),
+		.transparent = static_cast<bool>(Transparency_on),
+		.color = tmap_flat_color,
+		.u = fx_u,
+		.v = fx_v * 64,
+		.z = fx_z,
+		.l = fx_l >> 8,
+		.dudx = fx_du_dx,
+		.dvdx = fx_dv_dx * 64,
+		.dzdx = fx_dz_dx,
+		.dldx = fx_dl_dx / 256,
+	};
+}
 
-	dest = (write_buffer + fx_xleft + (bytes_per_row * fx_y ));
+//draw the span now, or bin it if the spans are being tiled
+static void tmap_scanline_draw(const tmap_span_kind kind, const tmap_span &s)
+{
+	if (tmap_tiles_recording)
+		tmap_tiles_record(kind, s);
+	else
+		tmap_span_draw(kind, s);
+}
 
-	for (x= fx_xright-fx_xleft+1 ; x > 0; --x ) {
-		if (++index >= SWIDTH*SHEIGHT) return;
-		*dest++ = tmap_flat_color;
-	}
-//         memset(dest,tmap_flat_color,fx_xright-fx_xleft+1);
+void c_tmap_scanline_flat()
+{
+	tmap_scanline_draw(tmap_span_kind::flat, tmap_scanline_span());
 }
 
 void c_tmap_scanline_shaded(const gr_fade_level fade)
 {
-	uint8_t tmp;
-	int x, index = fx_xleft + (bytes_per_row * fx_y );
-
-	auto dest = &write_buffer[fx_xleft + (bytes_per_row * fx_y)];
-	for (x= fx_xright-fx_xleft+1 ; x > 0; --x ) {
-		if (++index >= SWIDTH*SHEIGHT) return;
-		tmp = *dest;
-		*dest++ = gr_fade_table[fade][tmp];
-	}
+	auto s = tmap_scanline_span();
+	s.fade = gr_fade_table[fade].data();
+	tmap_scanline_draw(tmap_span_kind::shaded, s);
 }
 
 void c_tmap_scanline_lin_nolight()
 {
-	uint c;
-	int x, index = fx_xleft + (bytes_per_row * fx_y );
-	fix u,v,dudx, dvdx;
-
-	u = fx_u;
-	v = fx_v*64;
-	dudx = fx_du_dx; 
-	dvdx = fx_dv_dx*64; 
-
-	auto dest = &write_buffer[fx_xleft + (bytes_per_row * fx_y)];
-
-	if (!Transparency_on)	{
-		for (x= fx_xright-fx_xleft+1 ; x > 0; --x ) {
-			if (++index >= SWIDTH*SHEIGHT) return;
-			*dest++ = static_cast<uint32_t>(pixptr[ (f2i(v)&(64*63)) + (f2i(u)&63) ]);
-			u += dudx;
-			v += dvdx;
-		}
-	} else {
-		for (x= fx_xright-fx_xleft+1 ; x > 0; --x ) {
-			if (++index >= SWIDTH*SHEIGHT) return;
-			c = static_cast<uint32_t>(pixptr[ (f2i(v)&(64*63)) + (f2i(u)&63) ]);
-			if ( c!=255)
-				*dest = c;
-			dest++;
-			u += dudx;
-			v += dvdx;
-		}
-	}
+	tmap_scanline_draw(tmap_span_kind::lin_nolight, tmap_scanline_span());
 }
 
 void c_tmap_scanline_lin()
 {
-	uint c;
-	int x, j, index = fx_xleft + (bytes_per_row * fx_y);
-	fix u,v,l,dudx, dvdx, dldx;
-
-	u = fx_u;
-	v = fx_v*64;
-	dudx = fx_du_dx; 
-	dvdx = fx_dv_dx*64; 
-
-	l = fx_l>>8;
-	dldx = fx_dl_dx/256;
-	auto dest = &write_buffer[fx_xleft + (bytes_per_row * fx_y)];
-
-	if (!Transparency_on)	{
-		const auto read_fade_table_entry = [&fadeTableLocalCopy = gr_fade_table, pixPtrLocalCopy = pixptr](const fix l, const fix v, const fix u) {
-			//edited 05/18/99 Matt Mueller - changed from 0xff00 to 0x7f00 to fix glitches
-			return fadeTableLocalCopy.base_type::operator[]((l >> 8) & 0x7f)[pixPtrLocalCopy[(f2i(v) & (64 * 63)) + (f2i(u) & 63)]];
-			//end edit -MM
-		};
-		x = fx_xright-fx_xleft+1;
-
-		if ((j = reinterpret_cast<uintptr_t>(dest) & 3) != 0)
-			{
-			j = 4 - j;
-
-			if (j > x)
-				j = x;
-
-			while (j > 0)
-				{	
-				if (++index >= SWIDTH*SHEIGHT) return;
-				*dest++ = read_fade_table_entry(l, v, u);
-				l += dldx;
-				u += dudx;
-				v += dvdx;
-				x--;
-				j--;
-				}
-			}
-
-		j &= ~3;
-		while (j > 0)
-			{
-				uint32_t destlong;
-			destlong = read_fade_table_entry(l, v, u) << 24;
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			destlong |= read_fade_table_entry(l, v, u) << 16;
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			destlong |= read_fade_table_entry(l, v, u) << 8;
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			destlong |= read_fade_table_entry(l, v, u);
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			*reinterpret_cast<uint32_t *>(dest) = destlong;
-			dest += 4;
-			x -= 4;
-			j -= 4;
-			index += 4;
-			if (index+4 >= SWIDTH*SHEIGHT) return;
-			}
-
-		while (x-- > 0)
-			{
-			if (++index >= SWIDTH*SHEIGHT) return;
-			*dest++ = read_fade_table_entry(l, v, u);
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			}
-
-	} else {
-		for (x= fx_xright-fx_xleft+1 ; x > 0; --x ) {
-			if (++index >= SWIDTH*SHEIGHT) return;
-			c = static_cast<uint32_t>(pixptr[ (f2i(v)&(64*63)) + (f2i(u)&63) ]);
-			if ( c!=TRANSPARENCY_COLOR)
-			//edited 05/18/99 Matt Mueller - changed from 0xff00 to 0x7f00 to fix glitches
-				*dest = gr_fade_table.base_type::operator[]((l >> 8) & 0x7f)[c];
-			//end edit -MM
-			dest++;
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-		}
-	}
+	tmap_scanline_draw(tmap_span_kind::lin, tmap_scanline_span());
 }
 
 // This texture mapper uses floating point extensively and writes 8 pixels at once, so it likely works
@@ -460,118 +363,9 @@ static void c_fp_tmap_scanline_per()
 	}
 }
 
-// note the unrolling loop is broken. It is never called, and uses big endian. -- FH
 static void c_tmap_scanline_per()
 {
-	uint c;
-	int x, j, index = fx_xleft + (bytes_per_row * fx_y);
-	fix l,u,v,z;
-	fix dudx, dvdx, dzdx, dldx;
-
-	u = fx_u;
-	v = fx_v*64;
-	z = fx_z;
-	dudx = fx_du_dx; 
-	dvdx = fx_dv_dx*64; 
-	dzdx = fx_dz_dx;
-
-	l = fx_l>>8;
-	dldx = fx_dl_dx/256;
-	auto dest = &write_buffer[fx_xleft + (bytes_per_row * fx_y)];
-
-	if (!Transparency_on)	{
-		const auto pixPtrLocalCopy{pixptr};
-		auto &fadeTableLocalCopy = gr_fade_table;
-
-		x = fx_xright-fx_xleft+1; // x = number of pixels in scanline
-
-		if ((j = reinterpret_cast<uintptr_t>(dest) & 3) != 0)
-			{
-			j = 4 - j;
-
-			if (j > x)
-				j = x;
-
-			while (j > 0)
-				{	
-				if (++index >= SWIDTH*SHEIGHT) return;
-				//edited 05/18/99 Matt Mueller - changed from 0xff00 to 0x7f00 to fix glitches
-				*dest++ = fadeTableLocalCopy.base_type::operator[]((l >> 8) & 0x7f)[static_cast<uint32_t>(pixPtrLocalCopy[((v / z) & (64 * 63)) + ((u / z) & 63)])];
-				//end edit -MM
-				l += dldx;
-				u += dudx;
-				v += dvdx;
-				z += dzdx;
-				x--;
-				j--;
-				}
-			}
-
-		j &= ~3;
-		while (j > 0)
-			{
-				uint32_t destlong;
-			//edited 05/18/99 Matt Mueller - changed from 0xff00 to 0x7f00 to fix glitches
-			destlong = fadeTableLocalCopy.base_type::operator[]((l >> 8) & 0x7f)[pixPtrLocalCopy[ ( (v/z)&(64*63) ) + ((u/z)&63) ] ] << 24;
-			//end edit -MM
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			z += dzdx;
-			//edited 05/18/99 Matt Mueller - changed from 0xff00 to 0x7f00 to fix glitches
-			destlong |= fadeTableLocalCopy.base_type::operator[]((l >> 8) & 0x7f)[pixPtrLocalCopy[ ( (v/z)&(64*63) ) + ((u/z)&63) ] ] << 16;
-			//end edit -MM
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			z += dzdx;
-			//edited 05/18/99 Matt Mueller - changed from 0xff00 to 0x7f00 to fix glitches
-			destlong |= fadeTableLocalCopy.base_type::operator[]((l >> 8) & 0x7f)[pixPtrLocalCopy[ ( (v/z)&(64*63) ) + ((u/z)&63) ] ] << 8;
-			//end edit -MM
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			z += dzdx;
-			//edited 05/18/99 Matt Mueller - changed from 0xff00 to 0x7f00 to fix glitches
-			destlong |= fadeTableLocalCopy.base_type::operator[]((l >> 8) & 0x7f)[pixPtrLocalCopy[ ( (v/z)&(64*63) ) + ((u/z)&63) ] ];
-			//end edit -MM
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			z += dzdx;
-			*reinterpret_cast<uint32_t *>(dest) = destlong;
-			dest += 4;
-			x -= 4;
-			j -= 4;
-			index += 4;
-			if (index+4 >= SWIDTH*SHEIGHT) return;
-			}
-
-		while (x-- > 0)
-			{
-			if (++index >= SWIDTH*SHEIGHT) return;
-			//edited 05/18/99 Matt Mueller - changed from 0xff00 to 0x7f00 to fix glitches
-			*dest++ = fadeTableLocalCopy.base_type::operator[]((l >> 8) & 0x7f)[pixPtrLocalCopy[ ( (v/z)&(64*63) ) + ((u/z)&63) ] ];
-			//end edit -MM
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			z += dzdx;
-			}
-
-	} else {
-		for (x= fx_xright-fx_xleft+1 ; x > 0; --x ) {
-			if (++index >= SWIDTH*SHEIGHT) return;
-			c = static_cast<uint32_t>(pixptr[ ( (v/z)&(64*63) ) + ((u/z)&63) ]);
-			if ( c!=TRANSPARENCY_COLOR)
-				*dest = gr_fade_table.base_type::operator[]((l >> 8) & 0x7f)[c];
-			dest++;
-			l += dldx;
-			u += dudx;
-			v += dvdx;
-			z += dzdx;
-		}
-	}
+	tmap_scanline_draw(tmap_span_kind::per, tmap_scanline_span());
 }
 
 static void c_tmap_scanline_quad()
@@ -646,13 +440,16 @@ void select_tmap(const std::string &type)
 	if (type == "fp")
 	{
 		cur_tmap_scanline_per=c_fp_tmap_scanline_per;
+		tmap_scanline_functions.sl_per_binned = false;
 	}
 	else if (type == "quad")
 	{
 		cur_tmap_scanline_per=c_tmap_scanline_quad;
+		tmap_scanline_functions.sl_per_binned = false;
 	}
 	else {
 		cur_tmap_scanline_per=c_tmap_scanline_per;
+		tmap_scanline_functions.sl_per_binned = true;
 	}
 }
 
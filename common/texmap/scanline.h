@@ -40,6 +40,8 @@ struct tmap_scanline_function_table
 {
 	using per = void ();
 	per *sl_per;
+	/* sl_per goes through tmap_scanline_draw, so its spans can be tiled */
+	bool sl_per_binned;
 };
 
 #define cur_tmap_scanline_per (tmap_scanline_functions.sl_per)
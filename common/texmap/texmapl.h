@@ -34,6 +34,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "dxxsconf.h"
 #include "dsx-ns.h"
 #include <array>
+#include "tmap_span.h"
 
 namespace dcx {
 
@@ -57,6 +58,10 @@ extern  unsigned char *write_buffer;
 
 extern uint8_t tmap_flat_color;
 
+//set between tmap_tiles_begin and tmap_tiles_end
+extern bool tmap_tiles_recording;
+void tmap_tiles_record(tmap_span_kind kind, const tmap_span &s);
+
 constexpr std::integral_constant<std::size_t, 641> FIX_RECIP_TABLE_SIZE{};	//increased from 321 to 641, since this res is now quite achievable.. slight fps boost -MM
 extern const std::array<fix, FIX_RECIP_TABLE_SIZE> fix_recip_table;
 static inline fix fix_recip(unsigned i)
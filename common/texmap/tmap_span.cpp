@@ -0,0 +1,191 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * The vector versions use the compiler's generic vector types, which it
+ * lowers to SSE2 on x86 and to NEON on ARM.  Neither has a byte gather,
+ * so the texel and fade table lookups are per lane, but the u/v/z/l
+ * stepping, the perspective divide and the index arithmetic are done for
+ * all lanes at once.
+ */
+
+#include <algorithm>
+#include "tmap_span.h"
+
+namespace dcx {
+
+namespace {
+
+constexpr unsigned tmap_lanes_per_step = 8;
+using tmap_lanes = int32_t __attribute__((vector_size(tmap_lanes_per_step * sizeof(int32_t))));
+using tmap_ulanes = uint32_t __attribute__((vector_size(tmap_lanes_per_step * sizeof(uint32_t))));
+using tmap_dlanes = double __attribute__((vector_size(tmap_lanes_per_step * sizeof(double))));
+
+constexpr uint8_t tmap_transparent_texel = 255;
+
+/* The scanline functions let the interpolants wrap, so do the same
+ * without signed overflow.
+ */
+fix tmap_step(const fix a, const fix d)
+{
+	return static_cast<fix>(static_cast<uint32_t>(a) + static_cast<uint32_t>(d));
+}
+
+unsigned tmap_lin_texel(const fix u, const fix v, fix)
+{
+	return (f2i(v) & (64 * 63)) + (f2i(u) & 63);
+}
+
+unsigned tmap_per_texel(const fix u, const fix v, const fix z)
+{
+	return ((v / z) & (64 * 63)) + ((u / z) & 63);
+}
+
+template <unsigned (*texel_index)(fix, fix, fix)>
+void tmap_span_reference(const tmap_span &s)
+{
+	fix u = s.u, v = s.v, z = s.z, l = s.l;
+	auto dest = s.dest;
+	for (unsigned n = s.count; n; --n, ++dest)
+	{
+		const auto c = s.pixels[texel_index(u, v, z)];
+		if (!s.transparent || c != tmap_transparent_texel)
+			//edited 05/18/99 Matt Mueller - changed from 0xff00 to 0x7f00 to fix glitches
+			*dest = s.fade[((l >> 8) & 0x7f) * 256 + c];
+		l = tmap_step(l, s.dldx);
+		u = tmap_step(u, s.dudx);
+		v = tmap_step(v, s.dvdx);
+		z = tmap_step(z, s.dzdx);
+	}
+}
+
+/* Vectors are not passed to or returned from helpers, since that would
+ * change the ABI for wider vector units.
+ */
+template <unsigned (*texel_index)(fix, fix, fix), bool perspective>
+void tmap_span_vector(const tmap_span &s)
+{
+	constexpr tmap_ulanes lane{0, 1, 2, 3, 4, 5, 6, 7};
+	tmap_ulanes u = static_cast<uint32_t>(s.u) + lane * static_cast<uint32_t>(s.dudx);
+	tmap_ulanes v = static_cast<uint32_t>(s.v) + lane * static_cast<uint32_t>(s.dvdx);
+	tmap_ulanes z = static_cast<uint32_t>(s.z) + lane * static_cast<uint32_t>(s.dzdx);
+	tmap_ulanes l = static_cast<uint32_t>(s.l) + lane * static_cast<uint32_t>(s.dldx);
+	auto dest = s.dest;
+	const unsigned steps = s.count / tmap_lanes_per_step;
+	for (unsigned i = 0; i < steps; ++i, dest += tmap_lanes_per_step)
+	{
+		tmap_lanes texel;
+		if constexpr (perspective)
+		{
+			/* A double holds every int32_t exactly, and the quotient of
+			 * two of them never rounds across an integer, so truncating
+			 * it matches integer division.
+			 */
+			const auto dz = __builtin_convertvector(__builtin_bit_cast(tmap_lanes, z), tmap_dlanes);
+			const auto uz = __builtin_convertvector(__builtin_convertvector(__builtin_bit_cast(tmap_lanes, u), tmap_dlanes) / dz, tmap_lanes);
+			const auto vz = __builtin_convertvector(__builtin_convertvector(__builtin_bit_cast(tmap_lanes, v), tmap_dlanes) / dz, tmap_lanes);
+			texel = (vz & (64 * 63)) + (uz & 63);
+		}
+		else
+			texel = ((__builtin_bit_cast(tmap_lanes, v) >> 16) & (64 * 63)) + ((__builtin_bit_cast(tmap_lanes, u) >> 16) & 63);
+		/* ((l >> 8) & 0x7f) * 256 */
+		const auto row = l & 0x7f00;
+		if (s.transparent)
+		{
+			for (unsigned k = 0; k < tmap_lanes_per_step; ++k)
+				if (const auto c = s.pixels[texel[k]]; c != tmap_transparent_texel)
+					dest[k] = s.fade[row[k] + c];
+		}
+		else
+		{
+			for (unsigned k = 0; k < tmap_lanes_per_step; ++k)
+				dest[k] = s.fade[row[k] + s.pixels[texel[k]]];
+		}
+		u += static_cast<uint32_t>(s.dudx) * tmap_lanes_per_step;
+		v += static_cast<uint32_t>(s.dvdx) * tmap_lanes_per_step;
+		z += static_cast<uint32_t>(s.dzdx) * tmap_lanes_per_step;
+		l += static_cast<uint32_t>(s.dldx) * tmap_lanes_per_step;
+	}
+	auto tail = s;
+	tail.dest = dest;
+	tail.count = s.count % tmap_lanes_per_step;
+	tail.u = u[0];
+	tail.v = v[0];
+	tail.z = z[0];
+	tail.l = l[0];
+	tmap_span_reference<texel_index>(tail);
+}
+
+}
+
+void tmap_span_lin(const tmap_span &s)
+{
+	tmap_span_vector<tmap_lin_texel, false>(s);
+}
+
+void tmap_span_lin_reference(const tmap_span &s)
+{
+	tmap_span_reference<tmap_lin_texel>(s);
+}
+
+void tmap_span_per(const tmap_span &s)
+{
+	tmap_span_vector<tmap_per_texel, true>(s);
+}
+
+void tmap_span_per_reference(const tmap_span &s)
+{
+	tmap_span_reference<tmap_per_texel>(s);
+}
+
+void tmap_span_lin_nolight(const tmap_span &s)
+{
+	fix u = s.u, v = s.v;
+	auto dest = s.dest;
+	for (unsigned n = s.count; n; --n, ++dest)
+	{
+		const auto c = s.pixels[tmap_lin_texel(u, v, 0)];
+		if (!s.transparent || c != tmap_transparent_texel)
+			*dest = c;
+		u = tmap_step(u, s.dudx);
+		v = tmap_step(v, s.dvdx);
+	}
+}
+
+void tmap_span_flat(const tmap_span &s)
+{
+	std::fill_n(s.dest, s.count, s.color);
+}
+
+void tmap_span_shaded(const tmap_span &s)
+{
+	std::transform(s.dest, s.dest + s.count, s.dest, [fade = s.fade](const uint8_t c) { return fade[c]; });
+}
+
+void tmap_span_draw(const tmap_span_kind kind, const tmap_span &s)
+{
+	switch (kind)
+	{
+		case tmap_span_kind::lin:
+			tmap_span_lin(s);
+			break;
+		case tmap_span_kind::lin_nolight:
+			tmap_span_lin_nolight(s);
+			break;
+		case tmap_span_kind::per:
+			tmap_span_per(s);
+			break;
+		case tmap_span_kind::flat:
+			tmap_span_flat(s);
+			break;
+		case tmap_span_kind::shaded:
+			tmap_span_shaded(s);
+			break;
+	}
+}
+
+}
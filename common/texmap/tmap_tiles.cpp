@@ -0,0 +1,201 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ * Binned span filling for the software renderer.  While tiling is on, the
+ * scanline functions record their spans instead of drawing them, sorted
+ * into bands of rows of the canvas.  A flush fills the bands on a pool of
+ * worker threads.  Every band is written by exactly one thread, in the
+ * order its spans were recorded, so the result is the same as drawing the
+ * spans as they come.
+ *
+ * The bands span the whole width of the canvas.  Spans are horizontal, so
+ * a band never has to clip a span, and the row of a span is all that is
+ * needed to bin it.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "dxxsconf.h"
+#include "texmap.h"
+#include "texmapl.h"
+#include "scanline.h"
+#include "args.h"
+#include "console.h"
+
+#if !DXX_USE_OGL
+namespace dcx {
+
+bool tmap_tiles_recording;
+
+namespace {
+
+constexpr int tmap_tile_rows = 16;
+constexpr unsigned tmap_max_tile_threads = 16;
+
+struct tmap_tile_record
+{
+	tmap_span span;
+	tmap_span_kind kind;
+};
+
+std::vector<std::vector<tmap_tile_record>> tmap_tile_bands;
+const uint8_t *tmap_tile_buffer;
+int tmap_tile_row_bytes;
+bool tmap_tile_recorded;
+
+std::array<std::thread, tmap_max_tile_threads> tmap_tile_workers;
+unsigned tmap_tile_worker_count;
+std::mutex tmap_tile_mutex;
+std::condition_variable tmap_tile_start, tmap_tile_done;
+uint64_t tmap_tile_generation;
+unsigned tmap_tile_pending;
+bool tmap_tile_quit;
+std::atomic<unsigned> tmap_tile_next_band;
+
+void tmap_tiles_fill_bands()
+{
+	const unsigned bands = tmap_tile_bands.size();
+	for (unsigned b; (b = tmap_tile_next_band.fetch_add(1, std::memory_order_relaxed)) < bands;)
+	{
+		auto &band = tmap_tile_bands[b];
+		for (auto &r : band)
+			tmap_span_draw(r.kind, r.span);
+		band.clear();
+	}
+}
+
+void tmap_tiles_worker_main()
+{
+	uint64_t generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock lock(tmap_tile_mutex);
+			tmap_tile_start.wait(lock, [&generation] { return tmap_tile_quit || tmap_tile_generation != generation; });
+			if (tmap_tile_quit)
+				return;
+			generation = tmap_tile_generation;
+		}
+		tmap_tiles_fill_bands();
+		{
+			std::lock_guard lock(tmap_tile_mutex);
+			if (!--tmap_tile_pending)
+				tmap_tile_done.notify_one();
+		}
+	}
+}
+
+/* The main thread fills bands too, so it is not counted */
+unsigned tmap_tiles_requested_workers()
+{
+	const int requested = CGameArg.DbgTexMapThreads;
+	return std::min<unsigned>(requested < 0
+		? std::max(std::thread::hardware_concurrency(), 1u) - 1
+		: std::max(requested, 1) - 1, tmap_max_tile_threads);
+}
+
+void tmap_tiles_create_workers()
+{
+	const unsigned count = tmap_tiles_requested_workers();
+	tmap_tile_quit = false;
+	for (auto &w : std::span(tmap_tile_workers).first(count))
+		w = std::thread(tmap_tiles_worker_main);
+	tmap_tile_worker_count = count;
+	con_printf(CON_VERBOSE, "DXX-Rebirth: filling texture mapped spans on %u threads", count + 1);
+}
+
+}
+
+void tmap_tiles_begin()
+{
+	if (!CGameArg.DbgTexMapThreads || !tmap_scanline_functions.sl_per_binned)
+		return;
+	if (!tmap_tile_worker_count)
+	{
+		tmap_tiles_create_workers();
+		if (!tmap_tile_worker_count)
+			return;
+	}
+	tmap_tiles_recording = true;
+}
+
+void tmap_tiles_record(const tmap_span_kind kind, const tmap_span &s)
+{
+	if (!s.count)
+		return;
+	if (write_buffer != tmap_tile_buffer || bytes_per_row != tmap_tile_row_bytes)
+	{
+		tmap_tiles_flush();
+		tmap_tile_buffer = write_buffer;
+		tmap_tile_row_bytes = bytes_per_row;
+	}
+	/* A span that starts left of the canvas begins on the row above the
+	 * one it was set up for.  If that puts it in two bands, draw it in
+	 * order with everything recorded so far.
+	 */
+	const std::ptrdiff_t first = s.dest - tmap_tile_buffer;
+	const std::ptrdiff_t band = first / bytes_per_row / tmap_tile_rows;
+	if (first < 0 || band != (first + static_cast<std::ptrdiff_t>(s.count) - 1) / bytes_per_row / tmap_tile_rows)
+	{
+		tmap_tiles_flush();
+		tmap_span_draw(kind, s);
+		return;
+	}
+	if (band >= std::ssize(tmap_tile_bands))
+		tmap_tile_bands.resize(band + 1);
+	tmap_tile_bands[band].push_back({s, kind});
+	tmap_tile_recorded = true;
+}
+
+void tmap_tiles_flush()
+{
+	if (!tmap_tile_recorded)
+		return;
+	tmap_tile_recorded = false;
+	tmap_tile_next_band.store(0, std::memory_order_relaxed);
+	{
+		std::lock_guard lock(tmap_tile_mutex);
+		tmap_tile_pending = tmap_tile_worker_count;
+		++tmap_tile_generation;
+	}
+	tmap_tile_start.notify_all();
+	tmap_tiles_fill_bands();
+	std::unique_lock lock(tmap_tile_mutex);
+	tmap_tile_done.wait(lock, [] { return !tmap_tile_pending; });
+}
+
+void tmap_tiles_end()
+{
+	if (!tmap_tiles_recording)
+		return;
+	tmap_tiles_flush();
+	tmap_tiles_recording = false;
+}
+
+void tmap_tiles_close()
+{
+	tmap_tiles_end();
+	{
+		std::lock_guard lock(tmap_tile_mutex);
+		tmap_tile_quit = true;
+	}
+	tmap_tile_start.notify_all();
+	for (auto &w : tmap_tile_workers)
+		if (w.joinable())
+			w.join();
+	tmap_tile_worker_count = 0;
+	tmap_tile_generation = 0;
+	tmap_tile_bands = {};
+}
+
+}
+#endif
@@ -0,0 +1,172 @@
+#include "bitmap_cache_ring.h"
+#include <array>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth bitmap_cache_ring
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+/* Bitmaps are runs of their own id, so a misplaced move or an overlap
+ * shows up as a wrong byte.
+ */
+struct test_cache
+{
+	std::array<uint8_t, 100> buffer{};
+	dcx::bitmap_cache_ring ring;
+	std::array<int, 256> offset;
+	std::array<uint8_t, 256> used{};
+	std::array<uint8_t, 256> length{};
+	std::vector<uint16_t> evicted;
+	unsigned reclaims{};
+	test_cache()
+	{
+		offset.fill(-1);
+		ring.reset(buffer.data(), buffer.size());
+	}
+	void before_reclaim()
+	{
+		++reclaims;
+	}
+	dcx::bitmap_cache_ring_use use(const dcx::bitmap_cache_ring::entry &e)
+	{
+		if (offset[e.id] != static_cast<int>(e.offset))
+			return dcx::bitmap_cache_ring_use::stale;
+		return std::exchange(used[e.id], 0) ? dcx::bitmap_cache_ring_use::hot : dcx::bitmap_cache_ring_use::cold;
+	}
+	void evict(const dcx::bitmap_cache_ring::entry &e)
+	{
+		offset[e.id] = -1;
+		evicted.emplace_back(e.id);
+	}
+	void moved(const dcx::bitmap_cache_ring::entry &e)
+	{
+		offset[e.id] = e.offset;
+	}
+	void page_in(const uint16_t id, const uint8_t n)
+	{
+		const auto p{ring.reserve(n, *this)};
+		BOOST_REQUIRE(p);
+		std::fill_n(p, n, id);
+		offset[id] = p - buffer.data();
+		length[id] = n;
+		ring.commit(id, n);
+	}
+	bool intact(const uint16_t id) const
+	{
+		if (offset[id] < 0)
+			return false;
+		for (unsigned i = 0; i != length[id]; ++i)
+			if (buffer[offset[id] + i] != id)
+				return false;
+		return true;
+	}
+};
+
+}
+
+/* Test that bitmaps are placed one after another until the buffer is
+ * full, and that the oldest unused ones are evicted first after that.
+ */
+BOOST_AUTO_TEST_CASE(bitmap_cache_ring_evicts_oldest)
+{
+	test_cache c;
+	for (uint16_t id = 1; id <= 4; ++id)
+		c.page_in(id, 25);
+	BOOST_TEST(c.reclaims == 0u);
+	BOOST_TEST(c.offset[4] == 75);
+	c.page_in(5, 30);
+	BOOST_TEST(c.evicted == (std::vector<uint16_t>{1, 2}), boost::test_tools::per_element());
+	BOOST_TEST(c.offset[5] == 0);
+	for (uint16_t id = 3; id <= 5; ++id)
+		BOOST_TEST(c.intact(id));
+}
+
+/* Test that a bitmap used since it was placed is moved out of the way
+ * and kept, and that the cold one behind it is evicted instead.
+ */
+BOOST_AUTO_TEST_CASE(bitmap_cache_ring_keeps_hot)
+{
+	test_cache c;
+	for (uint16_t id = 1; id <= 4; ++id)
+		c.page_in(id, 25);
+	c.used[1] = 1;
+	c.page_in(5, 20);
+	/* 1 was hot and already at the cursor, so it stays, and 2 goes */
+	BOOST_TEST(c.evicted == (std::vector<uint16_t>{2}), boost::test_tools::per_element());
+	BOOST_TEST(c.offset[1] == 0);
+	BOOST_TEST(c.offset[5] == 25);
+	c.used[3] = 1;
+	c.page_in(6, 10);
+	/* 3 is moved down next to 5, and 4, now in the way, goes */
+	BOOST_TEST(c.offset[3] == 45);
+	BOOST_TEST(c.offset[6] == 70);
+	BOOST_TEST(c.evicted == (std::vector<uint16_t>{2, 4}), boost::test_tools::per_element());
+	BOOST_TEST(c.ring.get_stats().relocations == 1u);
+	for (const uint16_t id : {1, 3, 5, 6})
+		BOOST_TEST(c.intact(id));
+}
+
+/* Test that a cache where every bitmap is hot still makes room, by
+ * evicting the oldest once all were given their second chance.
+ */
+BOOST_AUTO_TEST_CASE(bitmap_cache_ring_all_hot)
+{
+	test_cache c;
+	for (uint16_t id = 1; id <= 10; ++id)
+	{
+		c.page_in(id, 10);
+		c.used[id] = 1;
+	}
+	c.page_in(11, 15);
+	BOOST_TEST(c.evicted == (std::vector<uint16_t>{1, 2}), boost::test_tools::per_element());
+	BOOST_TEST(c.intact(11));
+	for (uint16_t id = 3; id <= 10; ++id)
+		BOOST_TEST(c.intact(id));
+	BOOST_TEST(!c.ring.reserve(101, c));
+}
+
+/* Test that entries whose bitmap went elsewhere are dropped without
+ * being evicted, and that fits_without_reclaim agrees with reserve.
+ */
+BOOST_AUTO_TEST_CASE(bitmap_cache_ring_stale_and_fits)
+{
+	test_cache c;
+	c.page_in(1, 40);
+	c.page_in(2, 40);
+	BOOST_TEST(c.ring.fits_without_reclaim(20));
+	BOOST_TEST(!c.ring.fits_without_reclaim(21));
+	c.offset[1] = -1;
+	c.page_in(3, 30);
+	BOOST_TEST(c.evicted.empty());
+	BOOST_TEST(c.offset[3] == 0);
+	BOOST_TEST(c.ring.fits_without_reclaim(10));
+	BOOST_TEST(!c.ring.fits_without_reclaim(11));
+	c.ring.clear();
+	BOOST_TEST(c.ring.fits_without_reclaim(100));
+}
+
+/* Test that a long run of page-ins of mixed sizes, with some bitmaps
+ * kept in use, never overwrites a bitmap that is still resident.
+ */
+BOOST_AUTO_TEST_CASE(bitmap_cache_ring_random)
+{
+	test_cache c;
+	uint32_t seed{12345};
+	const auto next{[&seed](const unsigned range) {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) % range;
+	}};
+	for (unsigned i = 0; i != 20000; ++i)
+	{
+		const uint16_t id = 1 + next(60);
+		if (c.offset[id] >= 0)
+			c.used[id] = 1;
+		else
+			c.page_in(id, 1 + next(40));
+		for (uint16_t j = 1; j <= 60; ++j)
+			if (c.offset[j] >= 0)
+				BOOST_REQUIRE(c.intact(j));
+	}
+}
@@ -0,0 +1,65 @@
+#include "frame_arena.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth frame_arena
+#include <boost/test/unit_test.hpp>
+
+/* Test that allocations are aligned, do not overlap, and that a reset
+ * starts again at the same address.
+ */
+BOOST_AUTO_TEST_CASE(frame_arena_bump_and_reset)
+{
+	dcx::frame_arena a;
+	const auto p0{static_cast<std::byte *>(a.allocate(3, 1))};
+	const auto p1{static_cast<std::byte *>(a.allocate(8, 8))};
+	const auto p2{static_cast<std::byte *>(a.allocate(64, 64))};
+	BOOST_TEST(reinterpret_cast<std::uintptr_t>(p1) % 8 == 0u);
+	BOOST_TEST(reinterpret_cast<std::uintptr_t>(p2) % 64 == 0u);
+	BOOST_TEST(p1 >= p0 + 3);
+	BOOST_TEST(p2 >= p1 + 8);
+	a.reset();
+	BOOST_TEST(a.allocate(3, 1) == p0);
+}
+
+/* Test that an arena which overflowed its block is left with one block
+ * large enough for the same load.
+ */
+BOOST_AUTO_TEST_CASE(frame_arena_grows_to_one_block)
+{
+	dcx::frame_arena a;
+	std::vector<std::byte *> first;
+	for (unsigned i = 0; i != 100; ++i)
+		first.emplace_back(static_cast<std::byte *>(a.allocate(4096, 16)));
+	a.reset();
+	BOOST_TEST(a.peak() >= 100u * 4096);
+	auto prev{static_cast<std::byte *>(a.allocate(4096, 16))};
+	for (unsigned i = 1; i != 100; ++i)
+	{
+		const auto p{static_cast<std::byte *>(a.allocate(4096, 16))};
+		BOOST_TEST(p == prev + 4096);
+		prev = p;
+	}
+}
+
+/* Test that standard containers work over the allocator, and that the
+ * data of one frame survives the next reset.
+ */
+BOOST_AUTO_TEST_CASE(frame_arena_containers)
+{
+	dcx::frame_arena_next_frame();
+	std::vector<int, dcx::frame_arena_allocator<int>> v;
+	for (int i = 0; i != 1000; ++i)
+		v.emplace_back(i);
+	std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, dcx::frame_arena_allocator<std::pair<const int, int>>> m;
+	for (int i = 0; i != 500; ++i)
+		m.emplace(i, i * 2);
+	dcx::frame_arena_next_frame();
+	std::vector<int, dcx::frame_arena_allocator<int>> w(1000, -1);
+	for (int i = 0; i != 1000; ++i)
+		BOOST_TEST(v[i] == i);
+	for (int i = 0; i != 500; ++i)
+		BOOST_TEST(m.at(i) == i * 2);
+}
@@ -0,0 +1,56 @@
+#include "frame_profile.h"
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth frame_profile
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+dcx::frame_profile_sample make_sample(const uint32_t ai)
+{
+	dcx::frame_profile_sample s;
+	s.us[static_cast<std::size_t>(dcx::frame_profile_zone::ai)] = ai;
+	return s;
+}
+
+}
+
+/* Test that the history keeps samples oldest first before it fills.
+ */
+BOOST_AUTO_TEST_CASE(frame_profile_history_partial)
+{
+	dcx::frame_profile_history<4> h;
+	BOOST_TEST(h.size() == 0u);
+	h.push(make_sample(1));
+	h.push(make_sample(2));
+	BOOST_TEST(h.size() == 2u);
+	BOOST_TEST(h[0].total() == 1u);
+	BOOST_TEST(h[1].total() == 2u);
+}
+
+/* Test that a full history drops the oldest sample on each push.
+ */
+BOOST_AUTO_TEST_CASE(frame_profile_history_wrap)
+{
+	dcx::frame_profile_history<3> h;
+	for (uint32_t i = 1; i <= 5; ++i)
+		h.push(make_sample(i));
+	BOOST_TEST(h.size() == 3u);
+	BOOST_TEST(h[0].total() == 3u);
+	BOOST_TEST(h[1].total() == 4u);
+	BOOST_TEST(h[2].total() == 5u);
+	h.clear();
+	BOOST_TEST(h.size() == 0u);
+	h.push(make_sample(7));
+	BOOST_TEST(h[0].total() == 7u);
+}
+
+/* Test that the total sums every zone.
+ */
+BOOST_AUTO_TEST_CASE(frame_profile_sample_total)
+{
+	dcx::frame_profile_sample s;
+	for (std::size_t i = 0; i != dcx::frame_profile_zone_count; ++i)
+		s.us[i] = i + 1;
+	BOOST_TEST(s.total() == dcx::frame_profile_zone_count * (dcx::frame_profile_zone_count + 1) / 2);
+}
@@ -0,0 +1,55 @@
+#include "hash.h"
+#include <cctype>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth hash
+#include <boost/test/unit_test.hpp>
+
+/* Test that lookups ignore case, and that a missing name is -1.
+ */
+BOOST_AUTO_TEST_CASE(hashtable_ignores_case)
+{
+	dcx::hashtable ht;
+	BOOST_TEST(dcx::hashtable_search(&ht, "rbot061") == -1);
+	dcx::hashtable_insert(&ht, "rbot061", 3);
+	dcx::hashtable_insert(&ht, "Eye03#2", 7);
+	BOOST_TEST(dcx::hashtable_search(&ht, "RBOT061") == 3);
+	BOOST_TEST(dcx::hashtable_search(&ht, "eye03#2") == 7);
+	BOOST_TEST(dcx::hashtable_search(&ht, "rbot06") == -1);
+	BOOST_TEST(dcx::hashtable_search(&ht, "rbot0611") == -1);
+}
+
+/* Test that inserting a name again keeps the first value.
+ */
+BOOST_AUTO_TEST_CASE(hashtable_first_insert_wins)
+{
+	dcx::hashtable ht;
+	dcx::hashtable_insert(&ht, "door01", 1);
+	dcx::hashtable_insert(&ht, "DOOR01", 2);
+	BOOST_TEST(dcx::hashtable_search(&ht, "door01") == 1);
+	BOOST_TEST(ht.count == 1u);
+}
+
+/* Test that every name is still found after the table has grown many
+ * times.
+ */
+BOOST_AUTO_TEST_CASE(hashtable_grow)
+{
+	std::vector<std::string> names;
+	for (unsigned i = 0; i != 3000; ++i)
+		names.emplace_back("bitmap" + std::to_string(i) + "#" + std::to_string(i % 7));
+	dcx::hashtable ht;
+	for (unsigned i = 0; i != names.size(); ++i)
+		dcx::hashtable_insert(&ht, names[i].c_str(), i);
+	BOOST_TEST(ht.count == names.size());
+	BOOST_TEST(ht.slots.size() >= names.size() * 2);
+	for (unsigned i = 0; i != names.size(); ++i)
+	{
+		auto upper = names[i];
+		for (auto &c : upper)
+			c = std::toupper(static_cast<unsigned char>(c));
+		BOOST_TEST(dcx::hashtable_search(&ht, upper.c_str()) == static_cast<int>(i));
+	}
+}
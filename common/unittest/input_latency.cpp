@@ -0,0 +1,63 @@
+#include "input_latency.h"
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth input_latency
+#include <boost/test/unit_test.hpp>
+
+/* Test that an empty histogram reports 0 for every percentile.
+ */
+BOOST_AUTO_TEST_CASE(input_latency_histogram_empty)
+{
+	dcx::input_latency_histogram h;
+	BOOST_TEST(h.size() == 0u);
+	BOOST_TEST(h.percentile(50) == 0u);
+	BOOST_TEST(h.percentile(100) == 0u);
+}
+
+/* Test the median and tail of a known set of samples.
+ */
+BOOST_AUTO_TEST_CASE(input_latency_histogram_percentile)
+{
+	dcx::input_latency_histogram h;
+	for (uint32_t i = 1; i <= 100; ++i)
+		h.add(i % 20);
+	BOOST_TEST(h.size() == 100u);
+	BOOST_TEST(h.percentile(50) == 9u);
+	BOOST_TEST(h.percentile(95) == 18u);
+	BOOST_TEST(h.percentile(100) == 19u);
+	h.clear();
+	BOOST_TEST(h.size() == 0u);
+	h.add(3);
+	BOOST_TEST(h.percentile(1) == 3u);
+}
+
+/* Test that latencies past the last bucket are kept in it.
+ */
+BOOST_AUTO_TEST_CASE(input_latency_histogram_overflow)
+{
+	dcx::input_latency_histogram h;
+	h.add(1000);
+	BOOST_TEST(h.percentile(50) == dcx::input_latency_histogram::bucket_count - 1);
+}
+
+/* Test that a frame fed by several events reports the oldest, and that
+ * events the controls do not use are not counted.
+ */
+BOOST_AUTO_TEST_CASE(input_latency_oldest_event)
+{
+	dcx::input_latency_clear();
+	dcx::input_latency_begin_event(100);
+	dcx::input_latency_end_event();
+	dcx::input_latency_begin_event(104);
+	dcx::input_latency_consume();
+	dcx::input_latency_end_event();
+	dcx::input_latency_begin_event(102);
+	dcx::input_latency_consume();
+	dcx::input_latency_end_event();
+	dcx::input_latency_consume();
+	dcx::input_latency_presented(112);
+	dcx::input_latency_presented(130);
+	auto &h = dcx::input_latency_get_histogram();
+	BOOST_TEST(h.size() == 1u);
+	BOOST_TEST(h.percentile(100) == 10u);
+}
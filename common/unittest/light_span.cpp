@@ -0,0 +1,117 @@
+#include "light_span.h"
+#include <array>
+#include <random>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth light_span
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+constexpr std::size_t vertex_capacity = 83;
+
+struct light_fixture
+{
+	std::minstd_rand rng{12345};
+	std::array<fix, vertex_capacity> x, y, z;
+	std::array<fix, vertex_capacity> reference_r, reference_g, reference_b;
+	std::array<fix, vertex_capacity> vector_r, vector_g, vector_b;
+	fix random_fix(const fix lo, const fix hi)
+	{
+		return std::uniform_int_distribution<fix>(lo, hi)(rng);
+	}
+	light_span_vertices reference_vertices()
+	{
+		return {x.data(), y.data(), z.data(), reference_r.data(), reference_g.data(), reference_b.data()};
+	}
+	light_span_vertices vector_vertices()
+	{
+		return {x.data(), y.data(), z.data(), vector_r.data(), vector_g.data(), vector_b.data()};
+	}
+	void randomize(const fix extent)
+	{
+		for (std::size_t i = 0; i < vertex_capacity; ++i)
+		{
+			x[i] = random_fix(-extent, extent);
+			y[i] = random_fix(-extent, extent);
+			z[i] = random_fix(-extent, extent);
+			reference_r[i] = vector_r[i] = random_fix(0, F1_0 * 4);
+			reference_g[i] = vector_g[i] = random_fix(0, F1_0 * 4);
+			reference_b[i] = vector_b[i] = random_fix(0, F1_0 * 4);
+		}
+	}
+	light_span_source random_light(const fix extent, const fix emission)
+	{
+		return {
+			.pos = {random_fix(-extent, extent), random_fix(-extent, extent), random_fix(-extent, extent)},
+			.r = random_fix(0, emission),
+			.g = random_fix(0, emission),
+			.b = random_fix(0, emission),
+			.range = random_fix(0, extent * 2),
+		};
+	}
+	static void check_close(const std::array<fix, vertex_capacity> &reference, const std::array<fix, vertex_capacity> &vector)
+	{
+		for (std::size_t i = 0; i < vertex_capacity; ++i)
+			BOOST_REQUIRE_LE(std::abs(reference[i] - vector[i]), 1);
+	}
+};
+
+}
+
+BOOST_FIXTURE_TEST_CASE(light_span_div_matches_reference, light_fixture)
+{
+	for (unsigned i = 0; i < 2000; ++i)
+	{
+		/* Alternate between lights near the vertices and lights so strong
+		 * that the quotients leave the exact range of the vector divide.
+		 */
+		const fix extent = (i & 1) ? F1_0 * 16 : F1_0 * 400;
+		randomize(extent);
+		const auto light = random_light(extent, (i & 2) ? F1_0 * 64 : F1_0 * 4096);
+		const std::size_t begin = i % 11, end = vertex_capacity - (i % 5);
+		light_span_div_reference(light, reference_vertices(), begin, end);
+		light_span_div(light, vector_vertices(), begin, end);
+		check_close(reference_r, vector_r);
+		check_close(reference_g, vector_g);
+		check_close(reference_b, vector_b);
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(light_span_div_clamps_distance, light_fixture)
+{
+	randomize(0);
+	const light_span_source light{
+		.pos = {},
+		.r = F1_0 * 8,
+		.g = F1_0 * 4,
+		.b = 0,
+		.range = F1_0 * 100,
+	};
+	/* Every vertex is at the light, so the distance is clamped to
+	 * MIN_LIGHT_DIST, and each light is divided by 4.
+	 */
+	const auto r0 = vector_r, g0 = vector_g, b0 = vector_b;
+	light_span_div(light, vector_vertices(), 0, vertex_capacity);
+	for (std::size_t i = 0; i < vertex_capacity; ++i)
+	{
+		BOOST_TEST(vector_r[i] == r0[i] + F1_0 * 2);
+		BOOST_TEST(vector_g[i] == g0[i] + F1_0);
+		BOOST_TEST(vector_b[i] == b0[i]);
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(light_span_div_skips_out_of_range, light_fixture)
+{
+	randomize(F1_0 * 16);
+	const light_span_source light{
+		.pos = {F1_0 * 1000, 0, 0},
+		.r = F1_0 * 64,
+		.g = F1_0 * 64,
+		.b = F1_0 * 64,
+		.range = F1_0 * 100,
+	};
+	const auto r0 = vector_r;
+	light_span_div(light, vector_vertices(), 0, vertex_capacity);
+	BOOST_TEST(vector_r == r0);
+}
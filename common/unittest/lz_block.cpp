@@ -0,0 +1,69 @@
+#include "lz_block.h"
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth lz_block
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+std::vector<uint8_t> round_trip(const std::vector<uint8_t> &input, std::size_t &packed_size)
+{
+	std::vector<uint8_t> packed(dcx::lz_block_compress_bound(input.size()));
+	packed_size = dcx::lz_block_compress(input, packed);
+	BOOST_TEST(packed_size <= packed.size());
+	packed.resize(packed_size);
+	std::vector<uint8_t> output(input.size());
+	BOOST_TEST(dcx::lz_block_decompress(packed, output));
+	return output;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(lz_block_round_trip_random)
+{
+	std::minstd_rand rng{12345};
+	for (const std::size_t n : {0u, 1u, 3u, 4u, 5u, 15u, 16u, 300u, 70000u})
+	{
+		std::vector<uint8_t> input(n);
+		for (auto &b : input)
+			b = std::uniform_int_distribution<unsigned>(0, 255)(rng);
+		std::size_t packed_size;
+		BOOST_TEST(round_trip(input, packed_size) == input, boost::test_tools::per_element());
+	}
+}
+
+/* Records that repeat with small changes, like the objects of a demo
+ * frame, must shrink, including runs longer than the token nibbles hold.
+ */
+BOOST_AUTO_TEST_CASE(lz_block_round_trip_repetitive)
+{
+	std::minstd_rand rng{54321};
+	std::vector<uint8_t> input;
+	for (unsigned record = 0; record != 2000; ++record)
+	{
+		for (unsigned i = 0; i != 24; ++i)
+			input.push_back(static_cast<uint8_t>(i));
+		input.push_back(std::uniform_int_distribution<unsigned>(0, 3)(rng));
+	}
+	input.insert(input.end(), 1000, 0x55);
+	std::size_t packed_size;
+	BOOST_TEST(round_trip(input, packed_size) == input, boost::test_tools::per_element());
+	BOOST_TEST(packed_size < input.size() / 4);
+}
+
+/* Damaged input must be rejected without writing past the output */
+BOOST_AUTO_TEST_CASE(lz_block_reject_malformed)
+{
+	std::vector<uint8_t> input(1000, 7);
+	std::vector<uint8_t> packed(dcx::lz_block_compress_bound(input.size()));
+	packed.resize(dcx::lz_block_compress(input, packed));
+	std::vector<uint8_t> output(input.size());
+	BOOST_TEST(!dcx::lz_block_decompress(std::span(packed).first(packed.size() / 2), output));
+	std::vector<uint8_t> small(input.size() - 1);
+	BOOST_TEST(!dcx::lz_block_decompress(packed, small));
+	/* A match reaching back before the start of the output */
+	const std::vector<uint8_t> bad_distance{0x10, 1, 5, 0};
+	BOOST_TEST(!dcx::lz_block_decompress(bad_distance, output));
+}
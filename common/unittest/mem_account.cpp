@@ -0,0 +1,70 @@
+#include "mem_account.h"
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth mem_account
+#include <boost/test/unit_test.hpp>
+
+/* Test that the peak follows the most held at once, and that a reset
+ * brings it down to the current value.
+ */
+BOOST_AUTO_TEST_CASE(mem_account_current_and_peak)
+{
+	using dcx::mem_tag;
+	dcx::mem_account_add(mem_tag::sounds, 1000);
+	dcx::mem_account_add(mem_tag::sounds, 500);
+	dcx::mem_account_sub(mem_tag::sounds, 1200);
+	auto c{dcx::mem_account_get(mem_tag::sounds)};
+	BOOST_TEST(c.current == 300u);
+	BOOST_TEST(c.peak == 1500u);
+	BOOST_TEST(dcx::mem_account_get(mem_tag::bitmaps).peak == 0u);
+	dcx::mem_account_reset_peaks();
+	BOOST_TEST(dcx::mem_account_get(mem_tag::sounds).peak == 300u);
+	dcx::mem_account_sub(mem_tag::sounds, 300);
+}
+
+/* Test that a tracked size reports only its changes, moves with its
+ * owner, and is taken back out when destroyed.
+ */
+BOOST_AUTO_TEST_CASE(mem_account_tracked_size)
+{
+	using dcx::mem_tag;
+	{
+		dcx::mem_account_tracked a{mem_tag::demo, 64};
+		a.set(100);
+		a.set(40);
+		BOOST_TEST(dcx::mem_account_get(mem_tag::demo).current == 40u);
+		dcx::mem_account_tracked b{std::move(a)};
+		BOOST_TEST(a.size() == 0u);
+		BOOST_TEST(dcx::mem_account_get(mem_tag::demo).current == 40u);
+		dcx::mem_account_tracked c{mem_tag::demo, 10};
+		c = std::move(b);
+		BOOST_TEST(dcx::mem_account_get(mem_tag::demo).current == 40u);
+	}
+	const auto c{dcx::mem_account_get(mem_tag::demo)};
+	BOOST_TEST(c.current == 0u);
+	BOOST_TEST(c.peak == 100u);
+}
+
+/* Test that reports from several threads are all counted.
+ */
+BOOST_AUTO_TEST_CASE(mem_account_threads)
+{
+	using dcx::mem_tag;
+	std::vector<std::thread> threads;
+	for (unsigned t = 0; t != 4; ++t)
+		threads.emplace_back([] {
+			for (unsigned i = 0; i != 10000; ++i)
+			{
+				dcx::mem_account_add(mem_tag::mixer_chunks, 3);
+				dcx::mem_account_sub(mem_tag::mixer_chunks, 1);
+			}
+		});
+	for (auto &t : threads)
+		t.join();
+	const auto c{dcx::mem_account_get(mem_tag::mixer_chunks)};
+	BOOST_TEST(c.current == 80000u);
+	BOOST_TEST(c.peak >= c.current);
+	BOOST_TEST(c.peak <= 120000u);
+}
@@ -0,0 +1,57 @@
+#include "mem_trim.h"
+#include <string>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth mem_trim
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+std::string trim_order;
+
+std::size_t trim_upload()
+{
+	trim_order += 'u';
+	return 1000;
+}
+
+std::size_t trim_page_in()
+{
+	trim_order += 'p';
+	return 100;
+}
+
+std::size_t trim_convert_a()
+{
+	trim_order += 'a';
+	return 10;
+}
+
+std::size_t trim_convert_b()
+{
+	trim_order += 'b';
+	return 1;
+}
+
+}
+
+/* Test that the caches are trimmed cheapest first, that a repeated
+ * registration is ignored, and that going to the background trims only
+ * the caches which are cheap to build again.
+ */
+BOOST_AUTO_TEST_CASE(mem_trim_order_and_level)
+{
+	using dcx::mem_trim_cost;
+	using dcx::mem_trim_level;
+	BOOST_TEST(dcx::mem_trim(mem_trim_level::critical) == 0u);
+	dcx::mem_trim_register(mem_trim_cost::upload, trim_upload);
+	dcx::mem_trim_register(mem_trim_cost::convert, trim_convert_a);
+	dcx::mem_trim_register(mem_trim_cost::page_in, trim_page_in);
+	dcx::mem_trim_register(mem_trim_cost::convert, trim_convert_b);
+	dcx::mem_trim_register(mem_trim_cost::convert, trim_convert_a);
+	BOOST_TEST(dcx::mem_trim(mem_trim_level::critical) == 1111u);
+	BOOST_TEST(trim_order == "abpu");
+	trim_order.clear();
+	BOOST_TEST(dcx::mem_trim(mem_trim_level::background) == 11u);
+	BOOST_TEST(trim_order == "ab");
+}
@@ -0,0 +1,91 @@
+#include "parallel.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth parallel
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(parallel_for_calls_each_index_once)
+{
+	for (const std::size_t count : {0u, 1u, 2u, 7u, 1000u})
+	{
+		std::vector<std::atomic<unsigned>> calls(count);
+		dcx::parallel_for(count, [&calls](const std::size_t i) {
+			calls[i].fetch_add(1, std::memory_order_relaxed);
+		});
+		for (auto &c : calls)
+			BOOST_TEST(c.load() == 1u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(parallel_for_repeats)
+{
+	std::atomic<std::size_t> sum{};
+	for (unsigned round = 0; round < 500; ++round)
+		dcx::parallel_for(16, [&sum](const std::size_t i) {
+			sum.fetch_add(i, std::memory_order_relaxed);
+		});
+	BOOST_TEST(sum.load() == 500u * (15u * 16u / 2));
+}
+
+BOOST_AUTO_TEST_CASE(parallel_for_threads_counts_caller)
+{
+	BOOST_TEST(dcx::parallel_for_threads() >= 1u);
+}
+
+/* Test that uneven work is finished, which needs the idle threads to steal
+ * from the one whose slice holds the slow indices.
+ */
+BOOST_AUTO_TEST_CASE(parallel_for_uneven_work)
+{
+	constexpr std::size_t count = 64;
+	std::vector<std::atomic<unsigned>> calls(count);
+	dcx::parallel_take_stats();
+	dcx::parallel_for(count, [&calls](const std::size_t i) {
+		if (i < count / 8)
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		calls[i].fetch_add(1, std::memory_order_relaxed);
+	});
+	for (auto &c : calls)
+		BOOST_TEST(c.load() == 1u);
+	const auto stats{dcx::parallel_take_stats()};
+	if (dcx::parallel_for_threads() > 1)
+	{
+		BOOST_TEST(stats.jobs == 1u);
+		BOOST_TEST(stats.steals > 0u);
+	}
+}
+
+/* Test that a call from inside fn, and a call with the limit set to one
+ * thread, run their indices in order on the calling thread.
+ */
+BOOST_AUTO_TEST_CASE(parallel_for_nested_and_serial)
+{
+	std::atomic<unsigned> total{};
+	dcx::parallel_for(4, [&total](std::size_t) {
+		const auto caller{std::this_thread::get_id()};
+		std::size_t expected{};
+		bool in_order{true};
+		dcx::parallel_for(10, [&](const std::size_t j) {
+			in_order &= (j == expected++ && std::this_thread::get_id() == caller);
+		});
+		if (in_order)
+			total.fetch_add(1, std::memory_order_relaxed);
+	});
+	BOOST_TEST(total.load() == 4u);
+	dcx::parallel_set_thread_limit(1);
+	BOOST_TEST(dcx::parallel_for_threads() == 1u);
+	const auto caller{std::this_thread::get_id()};
+	std::vector<std::size_t> order;
+	dcx::parallel_for(100, [&](const std::size_t i) {
+		if (std::this_thread::get_id() == caller)
+			order.emplace_back(i);
+	});
+	dcx::parallel_set_thread_limit(0);
+	BOOST_TEST(order.size() == 100u);
+	for (std::size_t i = 0; i != order.size(); ++i)
+		BOOST_TEST(order[i] == i);
+}
@@ -0,0 +1,70 @@
+#include "resample_span.h"
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth resample_span
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+struct resample_fixture
+{
+	std::minstd_rand rng{12345};
+	std::array<int32_t, dcx::digi_resample_filter_length> coeffs;
+	resample_fixture()
+	{
+		/* Full scale coefficients, so that a sum which overflows int16
+		 * must be truncated the same way by both versions.
+		 */
+		for (auto &c : coeffs)
+			c = std::uniform_int_distribution<int32_t>(-65535, 65535)(rng);
+	}
+	std::vector<uint8_t> sound(const std::size_t n)
+	{
+		std::vector<uint8_t> s(n);
+		for (auto &b : s)
+			b = std::uniform_int_distribution<unsigned>(0, 255)(rng);
+		return s;
+	}
+};
+
+}
+
+/* Test that the polyphase version matches the direct form for every
+ * length around the vector step, at both upsampling factors.
+ */
+BOOST_FIXTURE_TEST_CASE(resample_matches_reference, resample_fixture)
+{
+	for (const std::size_t factor : {2u, 4u})
+		for (std::size_t n = 0; n != 40; ++n)
+		{
+			const auto input = sound(n);
+			std::vector<int16_t> expected(n * factor), actual(n * factor, 0x5555);
+			dcx::digi_resample_fir_reference(input, factor, coeffs, expected);
+			dcx::digi_resample_fir(input, factor, coeffs, actual);
+			BOOST_TEST(actual == expected, boost::test_tools::per_element());
+		}
+}
+
+/* Compare the time of both versions on one second of 11kHz sound.  Only
+ * the results are checked; the times are reported with
+ * --log_level=message.
+ */
+BOOST_FIXTURE_TEST_CASE(resample_benchmark, resample_fixture)
+{
+	constexpr std::size_t factor = 4;
+	const auto input = sound(11025);
+	std::vector<int16_t> expected(input.size() * factor), actual(input.size() * factor);
+	using clock = std::chrono::steady_clock;
+	const auto t0 = clock::now();
+	dcx::digi_resample_fir_reference(input, factor, coeffs, expected);
+	const auto t1 = clock::now();
+	dcx::digi_resample_fir(input, factor, coeffs, actual);
+	const auto t2 = clock::now();
+	using us = std::chrono::microseconds;
+	BOOST_TEST_MESSAGE("direct form: " << std::chrono::duration_cast<us>(t1 - t0).count() << "us, polyphase: " << std::chrono::duration_cast<us>(t2 - t1).count() << "us");
+	BOOST_TEST(actual == expected);
+}
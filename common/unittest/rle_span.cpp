@@ -0,0 +1,69 @@
+#include "rle_span.h"
+#include <array>
+#include <random>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth rle_span
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+constexpr std::size_t buffer_size = 100;
+
+struct byte_fixture
+{
+	std::minstd_rand rng{12345};
+	std::array<uint8_t, buffer_size> src, reference_dest, vector_dest;
+	/* Fill with values from [lo, 255], so that a small range makes the
+	 * interesting values common
+	 */
+	void fill(std::array<uint8_t, buffer_size> &a, const unsigned lo)
+	{
+		for (auto &b : a)
+			b = std::uniform_int_distribution<unsigned>(lo, 255)(rng);
+	}
+};
+
+}
+
+BOOST_FIXTURE_TEST_CASE(gr_copy_masked_matches_reference, byte_fixture)
+{
+	for (unsigned i = 0; i < 2000; ++i)
+	{
+		fill(src, i % 2 ? 250 : 0);
+		fill(reference_dest, 0);
+		vector_dest = reference_dest;
+		const std::size_t offset = i % 7, n = i % (buffer_size - offset);
+		gr_copy_masked_reference(reference_dest.data() + offset, src.data(), n);
+		gr_copy_masked(vector_dest.data() + offset, src.data(), n);
+		BOOST_REQUIRE(reference_dest == vector_dest);
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(gr_copy_masked_keeps_transparent, byte_fixture)
+{
+	src.fill(255);
+	src[3] = 0;
+	reference_dest.fill(7);
+	gr_copy_masked(reference_dest.data(), src.data(), 20);
+	BOOST_CHECK_EQUAL(reference_dest[2], 7);
+	BOOST_CHECK_EQUAL(reference_dest[3], 0);
+	BOOST_CHECK_EQUAL(reference_dest[19], 7);
+}
+
+BOOST_FIXTURE_TEST_CASE(gr_rle_find_code_matches_reference, byte_fixture)
+{
+	for (unsigned i = 0; i < 2000; ++i)
+	{
+		/* Codes are 0xe0 and up, so start near them to vary the run
+		 * of literals
+		 */
+		fill(src, 0);
+		for (auto &b : src)
+			if (b >= 0xe0 && rng() % 16)
+				b &= 0x7f;
+		const std::size_t offset = i % 5, n = i % (buffer_size - offset);
+		const auto b = src.data() + offset, e = b + n;
+		BOOST_REQUIRE(gr_rle_find_code(b, e) == gr_rle_find_code_reference(b, e));
+	}
+}
@@ -0,0 +1,56 @@
+#include "3d.h"
+#include "common/3d/globvars.h"
+#include <array>
+#include <random>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth rotate_points
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+fix random_fix(std::minstd_rand &rng, const fix lo, const fix hi)
+{
+	return std::uniform_int_distribution<fix>(lo, hi)(rng);
+}
+
+vms_vector random_vector(std::minstd_rand &rng, const fix range)
+{
+	return {random_fix(rng, -range, range), random_fix(rng, -range, range), random_fix(rng, -range, range)};
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(g3_rotate_points_matches_g3_rotate_point)
+{
+	std::minstd_rand rng{12345};
+	std::array<vms_vector, 23> src;
+	std::array<g3s_point, src.size()> batch, single;
+	for (unsigned i = 0; i < 200; ++i)
+	{
+		View_position = random_vector(rng, F1_0 * 2000);
+		View_matrix = vm_angles_2_matrix(vms_angvec{
+			static_cast<fixang>(rng()), static_cast<fixang>(rng()), static_cast<fixang>(rng())
+		});
+		/* Zoomed views, some too far for the vector path */
+		if (const fix scale = F1_0 * (i % 7) + F1_0 / 2; i & 1)
+			for (auto &v : {&View_matrix.rvec, &View_matrix.uvec, &View_matrix.fvec})
+				vm_vec_scale(*v, scale);
+		for (auto &v : src)
+			v = random_vector(rng, F1_0 * 4000);
+		/* Points on the edges of the view pyramid */
+		src[0] = View_position;
+		src[1] = vm_vec_build_add(View_position, View_matrix.fvec);
+		const auto n = i % (src.size() + 1);
+		g3_rotate_points(std::span(src).first(n), batch);
+		for (std::size_t j = 0; j < n; ++j)
+		{
+			g3_rotate_point(single[j], src[j]);
+			BOOST_CHECK_EQUAL(batch[j].p3_vec.x, single[j].p3_vec.x);
+			BOOST_CHECK_EQUAL(batch[j].p3_vec.y, single[j].p3_vec.y);
+			BOOST_CHECK_EQUAL(batch[j].p3_vec.z, single[j].p3_vec.z);
+			BOOST_CHECK(batch[j].p3_codes == single[j].p3_codes);
+			BOOST_CHECK(batch[j].p3_flags == single[j].p3_flags);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#include "slot_bitmap.h"
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth slot_bitmap
+#include <boost/test/unit_test.hpp>
+
+/* Test that a freshly freed set hands out slots lowest first.
+ */
+BOOST_AUTO_TEST_CASE(slot_bitmap_lowest_first)
+{
+	dcx::slot_bitmap<350> s;
+	BOOST_TEST(s.first_free() == 0u);
+	BOOST_TEST(s.last_used() == 350u);
+	s.set_used(0);
+	s.set_used(1);
+	BOOST_TEST(s.first_free() == 2u);
+	BOOST_TEST(s.last_used() == 1u);
+	s.set_free(0);
+	BOOST_TEST(s.first_free() == 0u);
+	BOOST_TEST(s.last_used() == 1u);
+}
+
+/* Test that slots across a word boundary are found.
+ */
+BOOST_AUTO_TEST_CASE(slot_bitmap_word_boundary)
+{
+	dcx::slot_bitmap<130> s;
+	s.use_all();
+	BOOST_TEST(s.first_free() == 130u);
+	BOOST_TEST(s.last_used() == 129u);
+	s.set_free(129);
+	BOOST_TEST(s.first_free() == 129u);
+	BOOST_TEST(s.last_used() == 128u);
+	s.set_free(64);
+	BOOST_TEST(s.first_free() == 64u);
+	BOOST_TEST(s.is_free(64));
+	BOOST_TEST(!s.is_free(63));
+}
+
+/* Test that the padding bits past the end are never reported free.
+ */
+BOOST_AUTO_TEST_CASE(slot_bitmap_tail)
+{
+	dcx::slot_bitmap<3> s;
+	s.free_all();
+	for (unsigned i = 0; i != 3; ++i)
+		s.set_used(i);
+	BOOST_TEST(s.first_free() == 3u);
+	BOOST_TEST(s.last_used() == 2u);
+}
@@ -0,0 +1,107 @@
+#include "tmap_span.h"
+#include <array>
+#include <random>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Rebirth tmap_span
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+constexpr std::size_t span_capacity = 80;
+
+struct span_fixture
+{
+	std::minstd_rand rng{12345};
+	std::array<uint8_t, 64 * 64> pixels;
+	/* Every light value the kernels can select */
+	std::array<uint8_t, 128 * 256> fade;
+	std::array<uint8_t, span_capacity + 1> reference_dest, vector_dest;
+	span_fixture()
+	{
+		for (auto &p : pixels)
+			p = rng();
+		/* Make transparent texels common enough to matter */
+		for (unsigned i = 0; i < pixels.size(); i += 7)
+			pixels[i] = 255;
+		for (auto &f : fade)
+			f = rng();
+	}
+	fix random_fix(const fix lo, const fix hi)
+	{
+		return std::uniform_int_distribution<fix>(lo, hi)(rng);
+	}
+	tmap_span random_span(const unsigned count, const bool transparent, uint8_t *const dest)
+	{
+		return {
+			.dest = dest,
+			.pixels = pixels.data(),
+			.fade = fade.data(),
+			.count = count,
+			.transparent = transparent,
+			.color = 0,
+			.u = random_fix(INT32_MIN, INT32_MAX),
+			.v = random_fix(INT32_MIN, INT32_MAX),
+			.z = random_fix(F1_0 / 16, F1_0 * 64),
+			.l = random_fix(0, 0x7fff),
+			.dudx = random_fix(-F1_0 * 4, F1_0 * 4),
+			.dvdx = random_fix(-F1_0 * 256, F1_0 * 256),
+			.dzdx = random_fix(-F1_0 / 512, F1_0 / 512),
+			.dldx = random_fix(-64, 64),
+		};
+	}
+	template <typename kernel, typename reference>
+	void check(kernel &&k, reference &&r)
+	{
+		for (unsigned i = 0; i < 2000; ++i)
+		{
+			const unsigned count = i % span_capacity;
+			const bool transparent = i & 1;
+			for (unsigned j = 0; j < reference_dest.size(); ++j)
+				reference_dest[j] = vector_dest[j] = j;
+			auto s = random_span(count, transparent, reference_dest.data());
+			r(s);
+			s.dest = vector_dest.data();
+			k(s);
+			BOOST_REQUIRE(reference_dest == vector_dest);
+		}
+	}
+};
+
+}
+
+BOOST_FIXTURE_TEST_CASE(tmap_span_lin_matches_reference, span_fixture)
+{
+	check(tmap_span_lin, tmap_span_lin_reference);
+}
+
+BOOST_FIXTURE_TEST_CASE(tmap_span_per_matches_reference, span_fixture)
+{
+	check(tmap_span_per, tmap_span_per_reference);
+}
+
+BOOST_FIXTURE_TEST_CASE(tmap_span_lin_reference_steps, span_fixture)
+{
+	/* One texel across, lit at 0x1200, so row 0x12 */
+	const tmap_span s{
+		.dest = reference_dest.data(),
+		.pixels = pixels.data(),
+		.fade = fade.data(),
+		.count = 3,
+		.transparent = false,
+		.color = 0,
+		.u = F1_0 * 5,
+		.v = F1_0 * 64 * 2,
+		.z = 0,
+		.l = 0x1200,
+		.dudx = F1_0,
+		.dvdx = 0,
+		.dzdx = 0,
+		.dldx = 0,
+	};
+	reference_dest[3] = 0;
+	tmap_span_lin(s);
+	for (unsigned x = 0; x < 3; ++x)
+		BOOST_CHECK_EQUAL(reference_dest[x], fade[0x12 * 256 + pixels[2 * 64 + 5 + x]]);
+	BOOST_CHECK_EQUAL(reference_dest[3], 0);
+}
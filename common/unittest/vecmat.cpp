@@ -1,4 +1,7 @@
 #include "vecmat.h"
+#include <array>
+#include <cmath>
+#include <random>
 
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE Rebirth vecmat
@@ -231,3 +234,125 @@ BOOST_AUTO_TEST_CASE(vm_vec_mag_0)
 	BOOST_CHECK_EQUAL(static_cast<int32_t>(vm_vec_mag(vms_vector{.x = 0, .y = 90, .z = 0})), 90);
 	BOOST_CHECK_EQUAL(static_cast<int32_t>(vm_vec_mag(vms_vector{.x = 0, .y = 0, .z = 45})), 45);
 }
+
+/* Test that the square roots are the nearest integer to the root, and
+ * never more than one away from the original Newton loops.
+ */
+BOOST_AUTO_TEST_CASE(quad_sqrt_nearest)
+{
+	std::minstd_rand rng{12345};
+	const auto check{[](const int64_t n) {
+		const auto r{quad_sqrt(quadint{n})};
+		const auto expected{static_cast<int64_t>(quad_sqrt_reference(quadint{n}))};
+		BOOST_TEST(std::abs(int64_t{r} - expected) <= 1, "quad_sqrt(" << n << ") = " << r << ", reference " << expected);
+		const auto rr{static_cast<long double>(r)};
+		const auto root{std::sqrt(static_cast<long double>(n))};
+		BOOST_TEST(std::fabs(rr - root) <= 0.5l, "quad_sqrt(" << n << ") = " << r);
+		if (n <= INT32_MAX)
+		{
+			const auto s{long_sqrt(static_cast<int32_t>(n))};
+			BOOST_TEST(s == r);
+			BOOST_TEST(std::abs(int32_t{s} - int32_t{long_sqrt_reference(static_cast<int32_t>(n))}) <= 1);
+		}
+	}};
+	for (int64_t n = 0; n != 70000; ++n)
+		check(n);
+	for (int64_t b : {int64_t{1} << 15, int64_t{46340}, int64_t{46341}, int64_t{1} << 20, int64_t{3037000498}})
+		for (const int64_t d : {-1, 0, 1})
+		{
+			check(b * b + d);
+			check(b * b + b + d);
+			check(b * b + 2 * b + d);
+		}
+	check(INT64_MAX);
+	for (unsigned i = 0; i != 100000; ++i)
+	{
+		const auto hi{std::uniform_int_distribution<uint64_t>(0, INT64_MAX)(rng)};
+		check(hi >> std::uniform_int_distribution<unsigned>(0, 62)(rng));
+	}
+	BOOST_TEST(quad_sqrt(quadint{-1}) == 0u);
+	BOOST_TEST(long_sqrt(-1) == 0u);
+}
+
+/* Test that normalizing divides by the magnitude exactly as fixdiv does,
+ * that the result has unit length to within a few units, and that the
+ * batch form agrees with normalizing one at a time.
+ */
+BOOST_AUTO_TEST_CASE(vm_vec_normalize_accuracy)
+{
+	std::minstd_rand rng{54321};
+	std::array<vms_vector, 64> batch;
+	for (unsigned i = 0; i != 20000; ++i)
+	{
+		const unsigned shift{std::uniform_int_distribution<unsigned>(0, 30)(rng)};
+		std::uniform_int_distribution<fix> component(-(INT32_MAX >> shift), INT32_MAX >> shift);
+		const vms_vector v{.x = component(rng), .y = component(rng), .z = component(rng)};
+		batch[i % batch.size()] = v;
+		vms_vector n{};
+		const auto m{vm_vec_copy_normalize(n, v)};
+		if (!m)
+			continue;
+		BOOST_TEST(n.x == fixdiv(v.x, m));
+		BOOST_TEST(n.y == fixdiv(v.y, m));
+		BOOST_TEST(n.z == fixdiv(v.z, m));
+		if (m > F1_0)
+			BOOST_TEST(std::abs(static_cast<fix>(vm_vec_mag(n)) - F1_0) <= 4);
+		vms_vector q{};
+		if (const auto mq{vm_vec_copy_normalize_quick(q, v)})
+		{
+			BOOST_TEST(q.x == fixdiv(v.x, mq));
+			BOOST_TEST(q.y == fixdiv(v.y, mq));
+			BOOST_TEST(q.z == fixdiv(v.z, mq));
+		}
+		if (i % batch.size() == batch.size() - 1)
+		{
+			auto expected{batch};
+			for (auto &e : expected)
+				vm_vec_normalize(e);
+			vm_vec_normalize_batch(batch);
+			for (std::size_t j = 0; j != batch.size(); ++j)
+			{
+				BOOST_TEST(batch[j].x == expected[j].x);
+				BOOST_TEST(batch[j].y == expected[j].y);
+				BOOST_TEST(batch[j].z == expected[j].z);
+			}
+		}
+	}
+}
+
+/* Test that the vector kernels return the same bits as the scalar
+ * versions, including for inputs whose products overflow.
+ */
+BOOST_AUTO_TEST_CASE(vm_simd_matches_reference)
+{
+	std::minstd_rand rng{2468};
+	const auto random_vector{[&rng]() {
+		const unsigned shift{std::uniform_int_distribution<unsigned>(0, 24)(rng)};
+		std::uniform_int_distribution<fix> component(-(INT32_MAX >> shift), INT32_MAX >> shift);
+		return vms_vector{.x = component(rng), .y = component(rng), .z = component(rng)};
+	}};
+	for (unsigned i = 0; i != 20000; ++i)
+	{
+		const auto a{random_vector()}, b{random_vector()};
+		const vms_matrix m0{random_vector(), random_vector(), random_vector()};
+		const vms_matrix m1{random_vector(), random_vector(), random_vector()};
+		BOOST_TEST(vm_vec_build_dot(a, b) == vm_vec_build_dot_reference(a, b));
+		const auto c{vm_vec_cross(a, b)}, cr{vm_vec_cross_reference(a, b)};
+		BOOST_TEST(c.x == cr.x);
+		BOOST_TEST(c.y == cr.y);
+		BOOST_TEST(c.z == cr.z);
+		const auto r{vm_vec_build_rotated(a, m0)}, rr{vm_vec_build_rotated_reference(a, m0)};
+		BOOST_TEST(r.x == rr.x);
+		BOOST_TEST(r.y == rr.y);
+		BOOST_TEST(r.z == rr.z);
+		vms_matrix p, pr;
+		_vm_matrix_x_matrix(p, m0, m1);
+		_vm_matrix_x_matrix_reference(pr, m0, m1);
+		for (const auto v : {&vms_matrix::rvec, &vms_matrix::uvec, &vms_matrix::fvec})
+		{
+			BOOST_TEST((p.*v).x == (pr.*v).x);
+			BOOST_TEST((p.*v).y == (pr.*v).y);
+			BOOST_TEST((p.*v).z == (pr.*v).z);
+		}
+	}
+}
@@ -546,6 +546,7 @@ static void load_hxm(const d_fname &hxmname)
 					pm->model_data.reset();
 					return;
 				}
+				build_polygon_model_draw_list(*pm);
 
 				Dying_modelnums[repl_num] = build_polygon_model_index_from_untrusted(PHYSFSX_readInt(f));
 				Dead_modelnums[repl_num] = build_polygon_model_index_from_untrusted(PHYSFSX_readInt(f));
@@ -636,6 +637,7 @@ void load_custom_data(const d_fname &level_name)
 	auto &hx1 = "hx1";
 	copy(begin(hx1), end(hx1), o);
 	load_hxm(custom_file);
+	digi_prepare_sounds();
 }
 
 void custom_close()
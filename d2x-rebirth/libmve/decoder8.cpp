@@ -13,17 +13,141 @@
 
 #include "decoders.h"
 #include "console.h"
+#include "parallel.h"
 
 #include "dxxsconf.h"
 #include "compiler-range_for.h"
 #include "d_range.h"
 #include <array>
+#include <memory>
+#include <vector>
 
 using namespace dcx;
 
 namespace d2x {
 
 static void dispatchDecoder(const uint8_t *vBackBuf1, const uint8_t *vBackBuf2, std::size_t width, std::size_t height, unsigned char **pFrame, unsigned char codeType, const unsigned char **pData, int *pDataRemain, int *curXb, int *curYb);
+static void relFar(int i, int sign, int *x, int *y);
+
+namespace {
+
+/* Where each row of blocks starts in the data stream, and where the frame
+ * can be cut into bands that decode independently.
+ */
+struct frame_plan8
+{
+	std::vector<const unsigned char *> row_data;
+	/* clean[j] is true if rows before j and rows from j on never copy
+	 * from each other.
+	 */
+	std::vector<bool> clean;
+};
+
+/* The number of data bytes block type `op` reads, given its data */
+static std::size_t blockDataSize8(const unsigned op, const unsigned char *const d)
+{
+	switch (op)
+	{
+		case 0x2:
+		case 0x3:
+		case 0x4:
+		case 0xe:
+			return 1;
+		case 0x5:
+		case 0xf:
+			return 2;
+		case 0x7:
+			return d[0] <= d[1] ? 10 : 4;
+		case 0x8:
+			return d[0] <= d[1] ? 16 : 12;
+		case 0x9:
+			return d[0] <= d[1] ? (d[2] <= d[3] ? 20 : 8) : 12;
+		case 0xa:
+			return d[0] <= d[1] ? 32 : 24;
+		case 0xb:
+			return 64;
+		case 0xc:
+			return 16;
+		case 0xd:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+/* Walk the opcode map without decoding.  Returns false if the frame has
+ * a block of type 0x6, whose skip crosses rows and so must be decoded in
+ * order, or if the blocks read past the end of the data.
+ */
+static bool planFrame8(const std::size_t width, const std::size_t height, std::span<const uint8_t> pMap, const unsigned char *pData, const int dataRemain, frame_plan8 &plan)
+{
+	if (dataRemain < 0)
+		return false;
+	const auto pDataEnd{pData + dataRemain};
+	const std::size_t xb = width >> 3;
+	const std::size_t yb = height >> 3;
+	const std::ptrdiff_t w = width;
+	plan.row_data.resize(yb + 1);
+	/* The lowest pixel row read by a type 0x2 copy in each row, and the
+	 * highest read by a type 0x3 copy.
+	 */
+	std::vector<std::ptrdiff_t> reach_down(yb), reach_up(yb);
+	for (std::size_t j = 0; j != yb; ++j)
+	{
+		plan.row_data[j] = pData;
+		std::ptrdiff_t down = -1, up = PTRDIFF_MAX;
+		for (std::size_t i = 0; i != xb; ++i)
+		{
+			const unsigned op = (i & 1) ? (pMap.front() >> 4) : (pMap.front() & 0xf);
+			if (i & 1)
+				pMap = pMap.subspan<1>();
+			if (op == 0x6)
+				return false;
+			const std::size_t remain = pDataEnd - pData;
+			/* The blocks whose size depends on their data read at most 4
+			 * bytes to find it, and are never shorter than that.
+			 */
+			if ((op == 0x7 || op == 0x8 || op == 0x9 || op == 0xa) && remain < 4)
+				return false;
+			const auto size{blockDataSize8(op, pData)};
+			if (size > remain)
+				return false;
+			if (op == 0x2 || op == 0x3)
+			{
+				int x, y;
+				relFar(*pData, op == 0x2 ? 1 : -1, &x, &y);
+				const std::ptrdiff_t first = (static_cast<std::ptrdiff_t>(8 * j) + y) * w + static_cast<std::ptrdiff_t>(8 * i) + x;
+				if (op == 0x2)
+					down = std::max(down, (first + 7 * w + 7) / w);
+				else
+					/* Rounded down, so that a copy which starts left of the
+					 * frame edge counts the row it wraps back into.
+					 */
+					up = std::min(up, (first >= 0 ? first : first - (w - 1)) / w);
+			}
+			pData += size;
+		}
+		reach_down[j] = down;
+		reach_up[j] = up;
+	}
+	plan.row_data[yb] = pData;
+	plan.clean.assign(yb + 1, true);
+	for (std::ptrdiff_t down = -1, j = 1; j < static_cast<std::ptrdiff_t>(yb); ++j)
+	{
+		down = std::max(down, reach_down[j - 1]);
+		if (down >= 8 * j)
+			plan.clean[j] = false;
+	}
+	for (std::ptrdiff_t up = PTRDIFF_MAX, j = yb - 1; j > 0; --j)
+	{
+		up = std::min(up, reach_up[j]);
+		if (up < 8 * j)
+			plan.clean[j] = false;
+	}
+	return true;
+}
+
+}
 
 void decodeFrame8(const uint8_t *const vBackBuf2, const std::size_t width, const std::size_t height, unsigned char *pFrame, std::span<const uint8_t> pMap, const unsigned char *pData, int dataRemain)
 {
@@ -32,6 +156,62 @@ void decodeFrame8(const uint8_t *const vBackBuf2, const std::size_t width, const
 
 	xb = width >> 3;
 	yb = height >> 3;
+	/* Blocks of types 0x2 and 0x3 copy from other blocks of the frame
+	 * being decoded, so the frame can only be split between rows which
+	 * no such copy crosses.  Each band then has its own start in the data
+	 * stream, found by walking the opcode map.
+	 */
+	if (const auto threads{parallel_for_threads()}; threads > 1 && yb >= 8)
+	{
+		frame_plan8 plan;
+		if (planFrame8(width, height, pMap, pData, dataRemain, plan))
+		{
+			std::vector<std::pair<int, int>> bands;
+			const int target{std::max(yb / static_cast<int>(threads), 1)};
+			for (int first = 0, j = 1; j <= yb; ++j)
+				if (j == yb || (plan.clean[j] && j - first >= target))
+				{
+					bands.emplace_back(first, j);
+					first = j;
+				}
+			if (bands.size() > 1)
+			{
+				/* If a band goes wrong, the frame is decoded again in
+				 * order, from what it held before.
+				 */
+				const std::vector<uint8_t> saved(pFrame, pFrame + width * height);
+				const auto bands_ok{std::make_unique<bool[]>(bands.size())};
+				parallel_for(bands.size(), [&](const std::size_t b) {
+					const auto [first, last] = bands[b];
+					const auto bandBegin{pFrame + 8 * first * width};
+					const auto bandEnd{pFrame + 8 * last * width};
+					auto bandFrame{bandBegin};
+					auto bandData{plan.row_data[first]};
+					auto bandMap{pMap.subspan(first * (xb / 2))};
+					int bandRemain{dataRemain - static_cast<int>(plan.row_data[first] - pData)};
+					for (int j = first; j < last; ++j)
+					{
+						for (int i = 0; i < xb / 2; ++i)
+						{
+							const auto m = bandMap.front();
+							dispatchDecoder(vBackBuf1, vBackBuf2, width, height, &bandFrame, m & 0xf, &bandData, &bandRemain, &i, &j);
+							if (bandFrame < bandBegin || bandFrame >= bandEnd)
+								return;
+							dispatchDecoder(vBackBuf1, vBackBuf2, width, height, &bandFrame, m >> 4, &bandData, &bandRemain, &i, &j);
+							if (bandFrame < bandBegin || bandFrame >= bandEnd)
+								return;
+							bandMap = bandMap.subspan<1>();
+						}
+						bandFrame += 7 * width;
+					}
+					bands_ok[b] = (bandData == plan.row_data[last]);
+				});
+				if (std::all_of(bands_ok.get(), bands_ok.get() + bands.size(), [](const bool ok) { return ok; }))
+					return;
+				std::ranges::copy(saved, pFrame);
+			}
+		}
+	}
 	for (int j=0; j<yb; j++)
 	{
 		for (int i=0; i<xb/2; i++)
@@ -79,6 +259,17 @@ static void relFar(int i, int sign, int *x, int *y)
 	}
 }
 
+/* One row of a block.  The pattern fills compute all 8 pixels at once with
+ * the compiler's generic vector types, and store them with one write.
+ */
+using pattern_lanes = uint8_t __attribute__((vector_size(8)));
+using pattern_wide_lanes = uint16_t __attribute__((vector_size(16)));
+
+static void storePatternRow(unsigned char *const pFrame, const pattern_lanes row)
+{
+	memcpy(pFrame, &row, sizeof(row));
+}
+
 /* copies an 8x8 block from pSrc to pDest.
    pDest and pSrc are both g_width bytes wide */
 static void copyFrame(const std::size_t width, uint8_t *pDest, const uint8_t *pSrc)
@@ -98,16 +289,17 @@ static void patternRow4Pixels(unsigned char *pFrame,
 							  unsigned char pat0, unsigned char pat1,
 							  const std::array<uint8_t, 4> &p)
 {
-	unsigned short mask=0x0003;
-	unsigned short shift=0;
-	unsigned short pattern = (pat1 << 8) | pat0;
-
-	while (mask != 0)
-	{
-		*pFrame++ = {p[(mask & pattern) >> shift]};
-		mask <<= 2;
-		shift += 2;
-	}
+	constexpr pattern_wide_lanes shifts{0, 2, 4, 6, 8, 10, 12, 14};
+	const uint16_t pattern = (pat1 << 8) | pat0;
+	const auto index{__builtin_convertvector(((pattern_wide_lanes{} + pattern) >> shifts) & 3, pattern_lanes)};
+	/* Pick between p[0] and p[1] by the low bit, between p[2] and p[3] by
+	 * the low bit, and then between those by the high bit.
+	 */
+	const auto low{__builtin_bit_cast(pattern_lanes, (index & 1) != 0)};
+	const auto high{__builtin_bit_cast(pattern_lanes, (index & 2) != 0)};
+	const auto p01{(low & p[1]) | (~low & p[0])};
+	const auto p23{(low & p[3]) | (~low & p[2])};
+	storePatternRow(pFrame, (high & p23) | (~high & p01));
 }
 
 // Fill in the next four 2x2 pixel blocks with p[0], p[1], p[2], or p[3],
@@ -173,13 +365,9 @@ static void patternQuadrant4Pixels(const std::size_t width, unsigned char *pFram
 // fills the next 8 pixels with either p[0] or p[1], depending on pattern
 static void patternRow2Pixels(unsigned char *pFrame, const uint8_t pat, const std::array<uint8_t, 4> &p)
 {
-	unsigned char mask=0x01;
-
-	while (mask != 0)
-	{
-		*pFrame++ = {p[(mask & pat) ? 1 : 0]};
-		mask <<= 1;
-	}
+	constexpr pattern_lanes bits{1, 2, 4, 8, 16, 32, 64, 128};
+	const auto set{__builtin_bit_cast(pattern_lanes, ((pattern_lanes{} + pat) & bits) != 0)};
+	storePatternRow(pFrame, (set & p[1]) | (~set & p[0]));
 }
 
 // fills the next four 2 x 2 pixel boxes with either p[0] or p[1], depending on pattern
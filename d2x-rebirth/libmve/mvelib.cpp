@@ -13,7 +13,11 @@
 #endif
 
 #include "mvelib.h"
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 namespace d2x {
 
@@ -42,6 +46,79 @@ static int _mvefile_fetch_next_chunk(MVEFILE *movie);
  */
 static void _mvestream_reset(MVESTREAM *movie);
 
+/* Chunks read ahead of the player, so that a slow read shows up as a
+ * shorter queue instead of a late frame.  A chunk holds about one frame.
+ */
+constexpr std::size_t mvefile_read_ahead_chunks = 32;
+
+}
+
+struct mvefile_reader
+{
+	std::mutex lock;
+	std::condition_variable cv;
+	std::deque<std::vector<uint8_t>> chunks;
+	/* Set by the reader at the end of the stream or on a read error */
+	bool done{};
+	/* Set by the player to make the reader exit */
+	bool stop{};
+	std::thread thread;
+	mvefile_reader(SDL_RWops *stream);
+	~mvefile_reader();
+	void run(SDL_RWops *stream);
+};
+
+mvefile_reader::mvefile_reader(SDL_RWops *const stream) :
+	thread{&mvefile_reader::run, this, stream}
+{
+}
+
+mvefile_reader::~mvefile_reader()
+{
+	{
+		const std::lock_guard l{lock};
+		stop = true;
+	}
+	cv.notify_all();
+	thread.join();
+}
+
+void mvefile_reader::run(SDL_RWops *const stream)
+{
+	for (;;)
+	{
+		std::vector<uint8_t> chunk;
+		unsigned char buffer[4];
+		if (MovieFileRead(stream, buffer))
+		{
+			chunk.resize(_mve_get_ushort(buffer));
+			if (!MovieFileRead(stream, chunk))
+				break;
+		}
+		else
+			break;
+		std::unique_lock l{lock};
+		cv.wait(l, [this]{ return stop || chunks.size() < mvefile_read_ahead_chunks; });
+		if (stop)
+			return;
+		chunks.emplace_back(std::move(chunk));
+		l.unlock();
+		cv.notify_all();
+	}
+	{
+		const std::lock_guard l{lock};
+		done = true;
+	}
+	cv.notify_all();
+}
+
+void mvefile_reader_deleter::operator()(mvefile_reader *const r) const
+{
+	delete r;
+}
+
+namespace {
+
 /************************************************************
  * public MVEFILE functions
  ************************************************************/
@@ -64,6 +141,7 @@ std::unique_ptr<MVEFILE> mvefile_open(RWops_ptr stream)
     {
 		return nullptr;
     }
+	file->reader.reset(new mvefile_reader(file->stream.get()));
 
     /* now, prefetch the next chunk */
 	_mvefile_fetch_next_chunk(file.get());
@@ -71,10 +149,15 @@ std::unique_ptr<MVEFILE> mvefile_open(RWops_ptr stream)
 }
 
 /*
- * reset a MVE file
+ * reset a MVE file to its start
  */
 static void mvefile_reset(MVEFILE *file)
 {
+	/* The reader must stop before the stream can be moved */
+	file->reader.reset();
+	if (file->stream)
+		SDL_RWseek(file->stream.get(), 0, RW_SEEK_SET);
+
     /* initialize the file */
     _mvefile_set_buffer_size(file, 1024);
 
@@ -82,7 +165,9 @@ static void mvefile_reset(MVEFILE *file)
     if (! _mvefile_read_header(file))
     {
 		*file = {};
+		return;
     }
+	file->reader.reset(new mvefile_reader(file->stream.get()));
 
     /* now, prefetch the next chunk */
     _mvefile_fetch_next_chunk(file);
@@ -352,9 +437,23 @@ static int _mvefile_fetch_next_chunk(MVEFILE *movie)
     unsigned char buffer[4];
     unsigned short length;
 
-    /* fail if not open */
-    if (! movie->stream)
-        return 0;
+	/* fail if not open */
+	if (! movie->stream)
+		return 0;
+
+	if (const auto r = movie->reader.get())
+	{
+		std::unique_lock l{r->lock};
+		r->cv.wait(l, [r]{ return r->done || !r->chunks.empty(); });
+		if (r->chunks.empty())
+			return 0;
+		movie->cur_chunk = std::move(r->chunks.front());
+		r->chunks.pop_front();
+		l.unlock();
+		r->cv.notify_all();
+		movie->next_segment = 0;
+		return 1;
+	}
 
     /* fail if we can't read the next segment descriptor */
 	if (!MovieFileRead(movie->stream.get(), buffer))
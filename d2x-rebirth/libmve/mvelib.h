@@ -14,6 +14,7 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
 #include <span>
 #include <vector>
 #include "dxxsconf.h"
@@ -46,6 +47,16 @@ enum class mve_opcode : uint8_t
 	None = 0xff,
 };
 
+/*
+ * thread which reads chunks ahead of the player
+ */
+struct mvefile_reader;
+
+struct mvefile_reader_deleter
+{
+	void operator()(mvefile_reader *) const;
+};
+
 /*
  * structure for maintaining info on a MVEFILE stream
  */
@@ -59,6 +70,10 @@ struct MVEFILE
 	RWops_ptr stream{};
 	std::vector<uint8_t> cur_chunk;
 	std::size_t next_segment = 0;
+	/* While this exists, only the reader touches `stream`.  It is declared
+	 * after `stream`, so that it stops before the stream is closed.
+	 */
+	std::unique_ptr<mvefile_reader, mvefile_reader_deleter> reader;
 };
 
 /*
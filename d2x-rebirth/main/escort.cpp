@@ -690,16 +690,58 @@ static icobjidx_t exists_in_mine_2(const unique_segment &segp, const std::option
 	return object_none;
 }
 
+//	-----------------------------------------------------------------------------
+//	Choosing a goal searches the mine from the same segment with the same
+//	keys several times, and the Guide-Bot chooses again whenever it
+//	runs out of goals.  Keep the last search and reuse it until the
+//	start segment, the Guide-Bot, its keys or its mode change, or until
+//	any wall changes in a way which could change what
+//	ai_door_is_openable reports.
+struct escort_bfs_cache
+{
+	std::array<segnum_t, MAX_SEGMENTS> list;
+	std::size_t length;
+	segnum_t start_seg = segment_none;
+	object_signature_t signature;
+	uint32_t powerup_flags;
+	ai_mode mode;
+	unsigned wall_change_count;
+};
+
+static escort_bfs_cache Escort_bfs_cache;
+
+//	Return the segments the Guide-Bot can reach from start_seg, nearest
+//	first, as create_bfs_list would.
+static std::span<const segnum_t> escort_bfs_list(const object &Buddy_objp, const vcsegidx_t start_seg, const player_flags powerup_flags)
+{
+	auto &c = Escort_bfs_cache;
+	const auto flags{powerup_flags.get_player_flags()};
+	const auto mode{Buddy_objp.ctype.ai_info.ail.mode};
+	const auto wall_change_count{LevelUniqueWallSubsystemState.change_count};
+	if (c.start_seg != start_seg ||
+		c.signature != Buddy_objp.signature ||
+		c.powerup_flags != flags ||
+		c.mode != mode ||
+		c.wall_change_count != wall_change_count)
+	{
+		auto &Robot_info = LevelSharedRobotInfoState.Robot_info;
+		auto &robptr = Robot_info[get_robot_id(Buddy_objp)];
+		c.length = create_bfs_list(Buddy_objp, robptr, start_seg, powerup_flags, c.list);
+		c.start_seg = start_seg;
+		c.signature = Buddy_objp.signature;
+		c.powerup_flags = flags;
+		c.mode = mode;
+		c.wall_change_count = wall_change_count;
+	}
+	return {c.list.data(), c.length};
+}
+
 //	-----------------------------------------------------------------------------
 static std::pair<icsegidx_t, d_unique_buddy_state::Escort_goal_reachability> exists_fuelcen_in_mine(const object &Buddy_objp, const player_flags powerup_flags)
 {
 	const vcsegidx_t start_seg{Buddy_objp.segnum};
-	auto &Robot_info = LevelSharedRobotInfoState.Robot_info;
-	std::array<segnum_t, MAX_SEGMENTS> bfs_list;
-	auto &robptr = Robot_info[get_robot_id(Buddy_objp)];
-	const auto length = create_bfs_list(Buddy_objp, robptr, start_seg, powerup_flags, bfs_list);
 	{
-		const auto &&rb = partial_const_range(bfs_list, length);
+		const auto rb{escort_bfs_list(Buddy_objp, start_seg, powerup_flags)};
 		const auto &&i{std::ranges::find(rb, segment_special::fuelcen, [](const segnum_t &s) {
 			return vcsegptr(s)->special;
 		})};
@@ -721,12 +763,7 @@ static std::pair<icsegidx_t, d_unique_buddy_state::Escort_goal_reachability> exi
 //	-2 means object does exist in mine, but buddy-bot can't reach it (eg, behind triggered wall)
 static std::pair<icobjidx_t, d_unique_buddy_state::Escort_goal_reachability> exists_in_mine(const object &Buddy_objp, const vcsegidx_t start_seg, const std::optional<object_type_t> objtype, const std::optional<uint8_t> objid, const int special, const player_flags powerup_flags)
 {
-	auto &Robot_info = LevelSharedRobotInfoState.Robot_info;
-	std::array<segnum_t, MAX_SEGMENTS> bfs_list;
-	auto &robptr = Robot_info[get_robot_id(Buddy_objp)];
-	const auto length = create_bfs_list(Buddy_objp, robptr, start_seg, powerup_flags, bfs_list);
-
-	range_for (const auto segnum, partial_const_range(bfs_list, length))
+	for (const auto segnum : escort_bfs_list(Buddy_objp, start_seg, powerup_flags))
 	{
 		const auto &&objnum = exists_in_mine_2(vcsegptr(segnum), objtype, objid, special);
 			if (objnum != object_none)
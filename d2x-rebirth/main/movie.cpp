@@ -440,7 +440,6 @@ int RotateRobot(MVESTREAM *const pMovie)
 
 	if (err == MVE_StepStatus::EndOfFile)     //end of movie, so reset
 	{
-		SDL_RWseek(pMovie->movie->stream.get(), 0, SEEK_SET);
 		mve_reset(pMovie);
 		err = MVE_rmStepMovie(*pMovie);
 	}
@@ -14,9 +14,11 @@
 #include <conf.h>
 #endif
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -24,6 +26,159 @@
 
 #define SWAPINT(x)   (((x)<<24) | (((unsigned)(x)) >> 24) | (((x) &0x0000ff00) << 8) | (((x) & 0x00ff0000) >> 8))
 
+/*
+ * With -a, the data of each file starts on a page, so that the game can
+ * map it, and a hashed directory is appended.  Both are made of ordinary
+ * HOG entries, so the result is still read by anything that reads HOGs.
+ * The layout is described in common/misc/physfs_hog.cpp.
+ */
+#define HOG_ALIGNMENT	4096
+#define HOG_HEADER_LENGTH	(13 + 4)
+#define HOG_PAD_NAME	"hogpad.dxx"
+#define HOG_INDEX_NAME	"hogindex.dxx"
+#define HOG_INDEX_MAGIC	"DXXHOGIX"
+
+struct hog_index_entry {
+	char name[13];
+	unsigned long offset, length, next;
+};
+
+static void put_u32(unsigned char *p, unsigned long v)
+{
+	p[0] = v & 0xff;
+	p[1] = (v >> 8) & 0xff;
+	p[2] = (v >> 16) & 0xff;
+	p[3] = (v >> 24) & 0xff;
+}
+
+static void write_header(FILE *hogfile, const char *name, unsigned long length)
+{
+	unsigned char header[HOG_HEADER_LENGTH];
+
+	memset(header, 0, sizeof(header));
+	strncpy((char *)header, name, 12);
+	put_u32(header + 13, length);
+	fwrite(header, sizeof(header), 1, hogfile);
+}
+
+static unsigned long name_hash(const char *name)
+{
+	unsigned long h = 2166136261UL;
+
+	for (; *name; name++)
+		h = ((h ^ (unsigned char)tolower((unsigned char)*name)) * 16777619UL) & 0xffffffffUL;
+	return h;
+}
+
+static int
+create_aligned(FILE *hogfile)
+{
+	DIR *dp;
+	struct dirent *ep;
+	struct stat statbuf;
+	struct hog_index_entry *entries = NULL;
+	unsigned long count = 0, allocated = 0, buckets = 1, pos = 3, gap, i;
+	unsigned long *bucket;
+	unsigned long index_length;
+	unsigned char *index, *p;
+	char *buf;
+	FILE *readfile;
+
+	dp = opendir("./");
+	if (dp == NULL)
+		return 1;
+	while ((ep = readdir(dp))) {
+		if (stat(ep->d_name, &statbuf) || S_ISDIR(statbuf.st_mode))
+			continue;
+		if (strlen(ep->d_name) > 12) {
+			fprintf(stderr, "error: filename %s too long! (12 chars max!)\n", ep->d_name);
+			return 1;
+		}
+		if (!strcasecmp(ep->d_name, HOG_PAD_NAME) || !strcasecmp(ep->d_name, HOG_INDEX_NAME)) {
+			fprintf(stderr, "error: filename %s is reserved for the index\n", ep->d_name);
+			return 1;
+		}
+		/* Pad with a file of its own, so that the data starts on a page */
+		gap = (HOG_ALIGNMENT - (pos + HOG_HEADER_LENGTH) % HOG_ALIGNMENT) % HOG_ALIGNMENT;
+		if (gap) {
+			if (gap < HOG_HEADER_LENGTH)
+				gap += HOG_ALIGNMENT;
+			write_header(hogfile, HOG_PAD_NAME, gap - HOG_HEADER_LENGTH);
+			for (i = HOG_HEADER_LENGTH; i < gap; i++)
+				fputc(0, hogfile);
+			pos += gap;
+		}
+		if ((unsigned long)statbuf.st_size > 0xffffffffUL - 2 * HOG_ALIGNMENT - pos) {
+			fprintf(stderr, "error: %s does not fit in the HOG\n", ep->d_name);
+			return 1;
+		}
+		if (count == allocated) {
+			allocated = allocated ? allocated * 2 : 64;
+			entries = (struct hog_index_entry *)realloc(entries, allocated * sizeof(*entries));
+		}
+		readfile = fopen(ep->d_name, "rb");
+		buf = (char *)malloc(statbuf.st_size ? statbuf.st_size : 1);
+		if (entries == NULL || readfile == NULL || buf == NULL) {
+			fprintf(stderr, "error: unable to read %s\n", ep->d_name);
+			return 1;
+		}
+		printf("Filename: %s \tLength: %i\n", ep->d_name, (int)statbuf.st_size);
+		memset(entries[count].name, 0, 13);
+		strcpy(entries[count].name, ep->d_name);
+		entries[count].offset = pos + HOG_HEADER_LENGTH;
+		entries[count].length = statbuf.st_size;
+		count++;
+		write_header(hogfile, ep->d_name, statbuf.st_size);
+		if (statbuf.st_size) {
+			fread(buf, statbuf.st_size, 1, readfile);
+			fwrite(buf, statbuf.st_size, 1, hogfile);
+		}
+		free(buf);
+		fclose(readfile);
+		pos += HOG_HEADER_LENGTH + statbuf.st_size;
+	}
+	closedir(dp);
+
+	while (buckets < count)
+		buckets <<= 1;
+	index_length = 24 + 4 * buckets + 28 * count + 12;
+	bucket = (unsigned long *)calloc(buckets, sizeof(*bucket));
+	index = (unsigned char *)calloc(index_length, 1);
+	if (bucket == NULL || index == NULL) {
+		fprintf(stderr, "error: unable to allocate memory\n");
+		return 1;
+	}
+	for (i = 0; i < count; i++) {
+		unsigned long *b = &bucket[name_hash(entries[i].name) & (buckets - 1)];
+		entries[i].next = *b;
+		*b = i + 1;
+	}
+	memcpy(index, HOG_INDEX_MAGIC, 8);
+	put_u32(index + 8, 1);
+	put_u32(index + 12, HOG_ALIGNMENT);
+	put_u32(index + 16, count);
+	put_u32(index + 20, buckets);
+	p = index + 24;
+	for (i = 0; i < buckets; i++, p += 4)
+		put_u32(p, bucket[i]);
+	for (i = 0; i < count; i++, p += 28) {
+		memcpy(p, entries[i].name, 13);
+		put_u32(p + 16, entries[i].offset);
+		put_u32(p + 20, entries[i].length);
+		put_u32(p + 24, entries[i].next);
+	}
+	/* The trailer ends the HOG, so that a reader can find the index */
+	put_u32(p, index_length);
+	memcpy(p + 4, HOG_INDEX_MAGIC, 8);
+	write_header(hogfile, HOG_INDEX_NAME, index_length);
+	fwrite(index, index_length, 1, hogfile);
+	printf("Indexed %lu files\n", count);
+	free(index);
+	free(bucket);
+	free(entries);
+	return 0;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -34,10 +189,17 @@ main(int argc, char *argv[])
 	char *buf;
 	struct stat statbuf;
 	int tmp;
+	int aligned = 0;
 
+	if (argc == 3 && !strcmp(argv[1], "-a")) {
+		aligned = 1;
+		argv++;
+		argc--;
+	}
 	if (argc != 2) {
-		printf("Usage: hogcreate hogfile\n"
-		       "creates hogfile using all the files in the current directory\n");
+		printf("Usage: hogcreate [-a] hogfile\n"
+		       "creates hogfile using all the files in the current directory\n"
+		       "  -a  start each file on a page and append an index\n");
 		exit(0);
 	}
 	hogfile = fopen(argv[1], "wb");
@@ -46,6 +208,11 @@ main(int argc, char *argv[])
 	fwrite(buf, 3, 1, hogfile);
 	printf("Creating: %s\n", argv[1]);
 	free(buf);
+	if (aligned) {
+		tmp = create_aligned(hogfile);
+		fclose(hogfile);
+		return tmp;
+	}
 	dp = opendir("./");
 	if (dp != NULL) {
 		while ((ep = readdir(dp))) {
@@ -11,6 +11,7 @@
  *
  */
 
+#include <algorithm>
 #include <stdexcept>
 #include <stdlib.h>
 #include "dxxsconf.h"
@@ -23,6 +24,10 @@
 #include "polyobj.h"
 #include "byteutil.h"
 #include "u_mem.h"
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+#include "args.h"
+#include "ogl_init.h"
+#endif
 
 #include "compiler-range_for.h"
 #include "d_range.h"
@@ -224,29 +229,37 @@ protected:
 	const tmap_drawer_type tmap_drawer_ptr;
 	const submodel_angles anim_angles;
 	const g3s_lrgb model_light;
-private:
 	void rotate(uint_fast32_t i, const vms_vector *const src, const uint_fast32_t n)
 	{
-		for (auto &&[dest, src] : zip(partial_range(Interp_point_list, i, i + n), unchecked_partial_range(src, n)))
-			g3_rotate_point(dest, src);
+		g3_rotate_points(std::span(src, n), partial_range(Interp_point_list, i, i + n));
 	}
+private:
 	void set_color_by_model_light(fix g3s_lrgb::*const c, g3s_lrgb &o, const fix color) const
 	{
 		o.*c = fixmul(color, model_light.*c);
 	}
 protected:
 	template <std::size_t N>
-		std::array<g3_draw_tmap_point *, N> prepare_point_list(const uint_fast32_t nv, const uint8_t *const p)
+		std::array<g3_draw_tmap_point *, N> prepare_point_list(const uint_fast32_t nv, const int16_t *const indices)
 		{
 			std::array<g3_draw_tmap_point *, N> point_list;
 			for (uint_fast32_t i = 0; i < nv; ++i)
-				point_list[i] = &Interp_point_list[wp(p + 30)[i]];
+				point_list[i] = &Interp_point_list[indices[i]];
 			return point_list;
 		}
+	template <std::size_t N>
+		std::array<g3_draw_tmap_point *, N> prepare_point_list(const uint_fast32_t nv, const uint8_t *const p)
+		{
+			return prepare_point_list<N>(nv, wp(p + 30));
+		}
 	g3s_lrgb get_noglow_light(const uint8_t *const p) const
+	{
+		return get_noglow_light(*vp(p + 16));
+	}
+	g3s_lrgb get_noglow_light(const vms_vector &normal) const
 	{
 		g3s_lrgb light;
-		const auto negdot = -vm_vec_build_dot(View_matrix.fvec, *vp(p + 16));
+		const auto negdot = -vm_vec_build_dot(View_matrix.fvec, normal);
 		const auto color = (f1_0 / 4) + ((negdot * 3) / 4);
 		set_color_by_model_light(&g3s_lrgb::r, light, color);
 		set_color_by_model_light(&g3s_lrgb::g, light, color);
@@ -313,6 +326,10 @@ public:
 	{
 		if (nv > MAX_POINTS_PER_POLY)
 			return;
+		draw_flatpoly(*vp(p + 4), *vp(p + 16), wp(p + 30), nv, w(p + 28));
+	}
+	void draw_flatpoly(const vms_vector &point, const vms_vector &normal, const int16_t *const indices, const uint_fast32_t nv, const int16_t model_color)
+	{
 #if DXX_BUILD_DESCENT == 2
 		fix effective_glow_value;
 		if (glow_values && glow_num < glow_values->size())
@@ -324,17 +341,17 @@ public:
 		else
 			effective_glow_value = 0;
 #endif
-		if (g3_check_normal_facing(*vp(p+4),*vp(p+16)) > 0)
+		if (g3_check_normal_facing(point, normal) > 0)
 		{
 #if DXX_BUILD_DESCENT == 1
-				const uint8_t color = w(p + 28);
+				const uint8_t color = model_color;
 #elif DXX_BUILD_DESCENT == 2
 				//					DPH: Now we treat this color as 15bpp
 				const uint8_t color = effective_glow_value == -2
 					? 255
-					: gr_find_closest_color_15bpp(packed_color_r5g5b5{w(p + 28)});
+					: gr_find_closest_color_15bpp(packed_color_r5g5b5{model_color});
 #endif
-				g3_draw_poly(canvas, nv, prepare_point_list<MAX_POINTS_PER_POLY>(nv, p), color);
+				g3_draw_poly(canvas, nv, prepare_point_list<MAX_POINTS_PER_POLY>(nv, indices), color);
 		}
 	}
 	static g3s_lrgb get_glow_light(const fix c)
@@ -345,12 +362,16 @@ public:
 	{
 		if (nv > MAX_POINTS_PER_POLY)
 			return;
-		if (!(g3_check_normal_facing(*vp(p+4),*vp(p+16)) > 0))
+		draw_tmappoly(*vp(p + 4), *vp(p + 16), wp(p + 30), reinterpret_cast<const g3s_uvl *>(p+30+((nv&~1)+1)*2), nv, w(p + 28));
+	}
+	void draw_tmappoly(const vms_vector &point, const vms_vector &normal, const int16_t *const indices, const g3s_uvl *const uvls, const uint_fast32_t nv, const uint16_t texture)
+	{
+		if (!(g3_check_normal_facing(point, normal) > 0))
 			return;
 		//calculate light from surface normal
 		const auto &&light = (glow_values && glow_num < glow_values->size())
 			? get_glow_light((*glow_values)[std::exchange(glow_num, -1)]) //yes glow
-			: get_noglow_light(p); //no glow
+			: get_noglow_light(normal); //no glow
 		//now poke light into l values
 		std::array<g3s_uvl, MAX_POINTS_PER_POLY> uvl_list;
 		std::array<g3s_lrgb, MAX_POINTS_PER_POLY> lrgb_list;
@@ -358,10 +379,10 @@ public:
 		range_for (const uint_fast32_t i, xrange(nv))
 		{
 			lrgb_list[i] = light;
-			uvl_list[i] = (reinterpret_cast<const g3s_uvl *>(p+30+((nv&~1)+1)*2))[i];
+			uvl_list[i] = uvls[i];
 			uvl_list[i].l = average_light;
 		}
-		g3_draw_tmap(canvas, nv, prepare_point_list<MAX_POINTS_PER_POLY>(nv, p), uvl_list, lrgb_list, *model_bitmaps[w(p + 28)], tmap_drawer_ptr);
+		g3_draw_tmap(canvas, nv, prepare_point_list<MAX_POINTS_PER_POLY>(nv, indices), uvl_list, lrgb_list, *model_bitmaps[texture], tmap_drawer_ptr);
 	}
 	void op_sortnorm(const uint8_t *const p)
 	{
@@ -380,6 +401,82 @@ public:
 	{
 		glow_num = w(p+2);
 	}
+	/* Each child is drawn by a new state, as the interpreter does, so the
+	 * glow number does not carry into or out of a child.
+	 */
+	void draw_list(const std::span<const polygon_model_draw_op> ops)
+	{
+		for (auto i = ops.begin(); i != ops.end(); ++i)
+		{
+			auto &op = *i;
+			switch (op.kind)
+			{
+				case polygon_model_draw_kind::defpoints:
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+					if (ogl_current_model_matrix)
+					{
+						for (auto &&[dst, src] : zip(partial_range(Interp_point_list, op.value, static_cast<std::size_t>(op.value + op.count)), std::span(op.point, op.count)))
+							dst.p3_vec = src;
+						break;
+					}
+#endif
+					rotate(op.value, op.point, op.count);
+					break;
+				case polygon_model_draw_kind::flatpoly:
+					draw_flatpoly(*op.point, *op.normal, op.indices, op.count, op.value);
+					break;
+				case polygon_model_draw_kind::tmappoly:
+					draw_tmappoly(*op.point, *op.normal, op.indices, op.uvls, op.count, op.value);
+					break;
+				case polygon_model_draw_kind::sortnorm:
+				{
+					const std::span first{std::next(i), op.children[0]};
+					const std::span second{first.end(), op.children[1]};
+					const bool facing = g3_check_normal_facing(*op.point, *op.normal) > 0;
+					//draw back then front if facing, else front then back
+					g3_draw_polygon_model(model_bitmaps, Interp_point_list, canvas, tmap_drawer_ptr, anim_angles, model_light, glow_values, facing ? second : first);
+					g3_draw_polygon_model(model_bitmaps, Interp_point_list, canvas, tmap_drawer_ptr, anim_angles, model_light, glow_values, facing ? first : second);
+					i += op.children[0] + op.children[1];
+					break;
+				}
+				case polygon_model_draw_kind::rodbm:
+				{
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+					/* The rod makes its own eye space points */
+					const auto model_matrix{std::exchange(ogl_current_model_matrix, nullptr)};
+#endif
+					op_rodbm(op.record);
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+					ogl_current_model_matrix = model_matrix;
+#endif
+					break;
+				}
+				case polygon_model_draw_kind::subcall:
+				{
+					auto &&ctx = g3_start_instance_angles(*op.point, anim_angles ? anim_angles[op.value] : zero_angles);
+					const std::span children{std::next(i), op.children[0]};
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+					if (ogl_current_model_matrix)
+					{
+						std::array<float, 16> submodel_matrix;
+						g3_get_gl_instance_matrix(submodel_matrix);
+						const auto parent_matrix{std::exchange(ogl_current_model_matrix, &submodel_matrix)};
+						g3_draw_polygon_model(model_bitmaps, Interp_point_list, canvas, tmap_drawer_ptr, anim_angles, model_light, glow_values, children);
+						ogl_current_model_matrix = parent_matrix;
+					}
+					else
+#endif
+						g3_draw_polygon_model(model_bitmaps, Interp_point_list, canvas, tmap_drawer_ptr, anim_angles, model_light, glow_values, children);
+					g3_done_instance(ctx);
+					i += op.children[0];
+					break;
+				}
+				case polygon_model_draw_kind::glow:
+					glow_num = op.value;
+					break;
+			}
+		}
+	}
 };
 
 class g3_draw_morphing_model_state :
@@ -913,6 +1010,27 @@ void g3_draw_polygon_model(grs_bitmap *const *const model_bitmaps, polygon_model
 	iterate_polymodel(p, state);
 }
 
+void g3_draw_polygon_model(grs_bitmap *const *const model_bitmaps, polygon_model_points &Interp_point_list, grs_canvas &canvas, const tmap_drawer_type tmap_drawer_ptr, const submodel_angles anim_angles, const g3s_lrgb model_light, const glow_values_t *const glow_values, const std::span<const polygon_model_draw_op> ops)
+{
+	g3_draw_polygon_model_state state(model_bitmaps, Interp_point_list, canvas, tmap_drawer_ptr, anim_angles, model_light, glow_values);
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+	if (CGameArg.OglModelMatrix && !ogl_current_model_matrix)
+	{
+		/* The outermost call, for the model's own space.  Each submodel
+		 * sets its matrix as it is reached, so every point is moved by GL
+		 * instead of being rotated here.
+		 */
+		std::array<float, 16> model_matrix;
+		g3_get_gl_instance_matrix(model_matrix);
+		ogl_current_model_matrix = &model_matrix;
+		state.draw_list(ops);
+		ogl_current_model_matrix = nullptr;
+		return;
+	}
+#endif
+	state.draw_list(ops);
+}
+
 #ifndef NDEBUG
 static int nest_count;
 #endif
@@ -967,3 +1085,178 @@ void g3_validate_polygon_model(const std::span<uint8_t> model)
 #endif
 
 }
+
+namespace dcx {
+
+namespace {
+
+/* Unlike the interpreter, this checks that every record and point index
+ * is inside the model, so that the draw list need not.  Polygons that the
+ * interpreter would skip for having too many vertices are left out.
+ */
+class polygon_model_draw_list_builder
+{
+	/* A cycle of offsets stops at one of these */
+	static constexpr unsigned max_depth = 1000;
+	static constexpr std::size_t max_ops = UINT16_MAX;
+	static constexpr std::size_t max_points = sizeof(polygon_model_points) / sizeof(g3s_point);
+	const std::span<const uint8_t> model;
+	std::vector<polygon_model_draw_op> &ops;
+	unsigned depth = 0;
+	bool contains(const std::ptrdiff_t offset, const std::size_t size) const
+	{
+		return offset >= 0 && static_cast<std::size_t>(offset) <= model.size() && size <= model.size() - offset;
+	}
+	static bool valid_points(const int16_t *const indices, const unsigned nv)
+	{
+		return std::all_of(indices, indices + nv, [](const int16_t i) { return i >= 0 && static_cast<std::size_t>(i) < max_points; });
+	}
+	bool add_child(const std::size_t parent, const unsigned child, const std::ptrdiff_t offset)
+	{
+		const auto before = ops.size();
+		if (!add(offset))
+			return false;
+		ops[parent].children[child] = ops.size() - before;
+		return true;
+	}
+public:
+	polygon_model_draw_list_builder(const std::span<const uint8_t> model, std::vector<polygon_model_draw_op> &ops) :
+		model(model), ops(ops)
+	{
+	}
+	bool add(std::ptrdiff_t offset);
+};
+
+bool polygon_model_draw_list_builder::add(std::ptrdiff_t offset)
+{
+	if (++depth > max_depth)
+		return false;
+	for (;;)
+	{
+		if (!contains(offset, sizeof(int16_t)))
+			return false;
+		const auto p = model.data() + offset;
+		const uint16_t op = w(p);
+		if (op == OP_EOF)
+			break;
+		if (!contains(offset, 4) || ops.size() >= max_ops)
+			return false;
+		const uint16_t n = w(p + 2);
+		polygon_model_draw_op r{};
+		std::size_t record_size;
+		switch (op)
+		{
+			case OP_DEFPOINTS:
+			case OP_DEFP_START:
+			{
+				const std::size_t header = op == OP_DEFPOINTS ? 4 : 8;
+				record_size = header + n * sizeof(vms_vector);
+				if (!contains(offset, record_size))
+					return false;
+				r.kind = polygon_model_draw_kind::defpoints;
+				r.value = op == OP_DEFPOINTS ? 0 : w(p + 4);
+				if (r.value + n > max_points)
+					return false;
+				r.point = vp(p + header);
+				break;
+			}
+			case OP_FLATPOLY:
+			case OP_TMAPPOLY:
+			{
+				const std::size_t uvl_offset = 30 + ((n & ~1) + 1) * 2;
+				record_size = uvl_offset + (op == OP_TMAPPOLY ? n * sizeof(g3s_uvl) : 0);
+				if (!contains(offset, record_size))
+					return false;
+				if (n <= MAX_POINTS_PER_POLY && !valid_points(wp(p + 30), n))
+					return false;
+				r.kind = op == OP_FLATPOLY ? polygon_model_draw_kind::flatpoly : polygon_model_draw_kind::tmappoly;
+				r.point = vp(p + 4);
+				r.normal = vp(p + 16);
+				r.value = w(p + 28);
+				r.indices = wp(p + 30);
+				if (op == OP_TMAPPOLY)
+					r.uvls = reinterpret_cast<const g3s_uvl *>(p + uvl_offset);
+				break;
+			}
+			case OP_SORTNORM:
+				record_size = 32;
+				if (!contains(offset, record_size))
+					return false;
+				r.kind = polygon_model_draw_kind::sortnorm;
+				r.point = vp(p + 16);
+				r.normal = vp(p + 4);
+				break;
+			case OP_RODBM:
+				record_size = 36;
+				if (!contains(offset, record_size))
+					return false;
+				r.kind = polygon_model_draw_kind::rodbm;
+				r.record = p;
+				break;
+			case OP_SUBCALL:
+				record_size = 20;
+				if (!contains(offset, record_size))
+					return false;
+				r.kind = polygon_model_draw_kind::subcall;
+				r.value = n;
+				if (r.value >= MAX_SUBMODELS)
+					return false;
+				r.point = vp(p + 4);
+				break;
+			case OP_GLOW:
+				record_size = 4;
+				r.kind = polygon_model_draw_kind::glow;
+				r.value = n;
+				break;
+			default:
+				return false;
+		}
+		r.count = n;
+		const auto i = ops.size();
+		const bool skip = (r.kind == polygon_model_draw_kind::flatpoly || r.kind == polygon_model_draw_kind::tmappoly) && n > MAX_POINTS_PER_POLY;
+		if (!skip)
+			ops.emplace_back(r);
+		if (r.kind == polygon_model_draw_kind::sortnorm)
+		{
+			if (!add_child(i, 0, offset + w(p + 28)) || !add_child(i, 1, offset + w(p + 30)))
+				return false;
+		}
+		else if (r.kind == polygon_model_draw_kind::subcall)
+		{
+			if (!add_child(i, 0, offset + w(p + 16)))
+				return false;
+		}
+		offset += record_size;
+	}
+	--depth;
+	return true;
+}
+
+}
+
+void build_polygon_model_draw_list(polymodel &pm)
+{
+	auto &dl = pm.draw_list;
+	dl.ops.clear();
+	const std::span<const uint8_t> model{pm.model_data.get(), pm.model_data ? pm.model_data_size : 0};
+	const auto add_root = [&](const std::ptrdiff_t offset, polygon_model_draw_range &r) {
+		const uint32_t begin = dl.ops.size();
+		if (!polygon_model_draw_list_builder{model, dl.ops}.add(offset))
+			return false;
+		r = {begin, static_cast<uint32_t>(dl.ops.size())};
+		return true;
+	};
+	if (!add_root(0, dl.model))
+	{
+		dl.ops = {};
+		return;
+	}
+	for (const unsigned i : xrange(std::min<unsigned>(pm.n_models, MAX_SUBMODELS)))
+		if (!add_root(pm.submodel_ptrs[i], dl.submodels[i]))
+		{
+			dl.ops = {};
+			return;
+		}
+}
+
+}
@@ -66,6 +66,7 @@
 #endif
 
 #include "ogl_sync.h"
+#include "input_latency.h"
 #include <memory>
 #ifdef __ANDROID__
 #include "touch.h"
@@ -181,6 +182,7 @@ void ogl_swap_buffers_internal(void)
 #endif
 #endif
 	sync_helper.after_swap();
+	input_latency_presented(SDL_GetTicks());
 }
 
 }
@@ -607,6 +609,26 @@ static void ogl_init_state(void)
 	ogl_init_pixel_buffers(grd_curscreen->get_screen_width(), grd_curscreen->get_screen_height());
 }
 
+#if SDL_MAJOR_VERSION == 2
+void gr_context_reset()
+{
+	if (!gl_initialized)
+		return;
+	const auto w{grd_curscreen->get_screen_width()}, h{grd_curscreen->get_screen_height()};
+	ogl_lose_context_internal();
+	sync_helper.deinit();
+	sync_helper.init(CGameArg.OglSyncMethod, CGameArg.OglSyncWait);
+	OGL_VIEWPORT(0, 0, w, h);
+	ogl_init_state();
+	ogl_init_stream();
+#ifdef __ANDROID__
+	touch_overlay_init(w, h);
+	touch_overlay_set_invert_y(CGameCfg.TouchInvertY);
+#endif
+	gr_remap_color_fonts();
+}
+#endif
+
 }
 
 namespace dsx {
@@ -747,6 +769,7 @@ int gr_set_mode(screen_mode mode)
 
 	OGL_VIEWPORT(0,0,w,h);
 	ogl_init_state();
+	ogl_init_stream();
 #ifdef __ANDROID__
 	touch_overlay_init(w, h);
 	touch_overlay_set_invert_y(CGameCfg.TouchInvertY);
@@ -923,6 +946,8 @@ void gr_close()
 
 	if (gl_initialized)
 	{
+		ogl_close_screen_reads();
+		ogl_close_stream();
 		ogl_smash_texture_list_internal();
 		sync_helper.deinit();
 	}
@@ -964,6 +989,7 @@ namespace dcx {
 
 void ogl_upixelc(const grs_bitmap &cv_bitmap, unsigned x, unsigned y, const color_palette_index c)
 {
+	ogl_stream_flush();
 	std::array<GLfloat, 2> vertices = {{
 		(x + cv_bitmap.bm_x) / static_cast<float>(last_width),
 		static_cast<GLfloat>(1.0 - (y + cv_bitmap.bm_y) / static_cast<float>(last_height))
@@ -991,6 +1017,7 @@ void ogl_upixelc(const grs_bitmap &cv_bitmap, unsigned x, unsigned y, const colo
 
 color_palette_index ogl_ugpixel(const grs_bitmap &bitmap, unsigned x, unsigned y)
 {
+	ogl_stream_flush();
 	ubyte buf[4];
 
 #if !DXX_USE_OGLES
@@ -1006,6 +1033,7 @@ color_palette_index ogl_ugpixel(const grs_bitmap &bitmap, unsigned x, unsigned y
 
 void ogl_urect(grs_canvas &canvas, const int left, const int top, const int right, const int bot, const color_palette_index c)
 {
+	ogl_stream_flush();
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
 
@@ -1050,6 +1078,7 @@ void ogl_urect(grs_canvas &canvas, const int left, const int top, const int righ
 
 void ogl_ulinec(grs_canvas &canvas, const int left, const int top, const int right, const int bot, const int c)
 {
+	ogl_stream_flush();
 	GLfloat xo,yo,xf,yf;
 	GLfloat fade_alpha = (canvas.cv_fade_level >= GR_FADE_OFF)
 		? 1.0
@@ -1094,6 +1123,7 @@ static int do_pal_step;
 
 void ogl_do_palfx(void)
 {
+	ogl_stream_flush();
 	OGL_DISABLE(TEXTURE_2D);
 
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -1185,53 +1215,6 @@ void gr_palette_load( palette_array_t &pal )
 	reset_computed_colors();
 }
 
-//writes out an uncompressed RGB .tga file
-//if we got really spiffy, we could optionally link in libpng or something, and use that.
-#if DXX_USE_SCREENSHOT_FORMAT_LEGACY
-void write_bmp(PHYSFS_File *const TGAFile, const unsigned w, const unsigned h)
-{
-	struct TGA_header
-	{
-		unsigned char TGAheader[12];
-		unsigned char header[6];
-	};
-	TGA_header TGA;
-	GLbyte HeightH,HeightL,WidthH,WidthL;
-	const unsigned buffer_size_TGA = w * h * 3;
-	const auto buf = std::make_unique<uint8_t[]>(buffer_size_TGA);
-
-	glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, buf.get());
-	for (const auto pixel : xrange(w * h))
-		std::swap(buf[pixel * 3], buf[pixel * 3 + 2]);
-
-	HeightH = static_cast<GLbyte>(h / 256);
-	HeightL = static_cast<GLbyte>(h % 256);
-	WidthH  = static_cast<GLbyte>(w / 256);
-	WidthL  = static_cast<GLbyte>(w % 256);
-	// Write TGA Header
-	TGA.TGAheader[0] = 0;
-	TGA.TGAheader[1] = 0;
-	TGA.TGAheader[2] = 2;
-	TGA.TGAheader[3] = 0;
-	TGA.TGAheader[4] = 0;
-	TGA.TGAheader[5] = 0;
-	TGA.TGAheader[6] = 0;
-	TGA.TGAheader[7] = 0;
-	TGA.TGAheader[8] = 0;
-	TGA.TGAheader[9] = 0;
-	TGA.TGAheader[10] = 0;
-	TGA.TGAheader[11] = 0;
-	TGA.header[0] = WidthL;
-	TGA.header[1] = WidthH;
-	TGA.header[2] = HeightL;
-	TGA.header[3] = HeightH;
-	TGA.header[4] = static_cast<GLbyte>(24);
-	TGA.header[5] = 0;
-	PHYSFSX_writeBytes(TGAFile, &TGA, sizeof(TGA_header));
-	PHYSFSX_writeBytes(TGAFile, buf, buffer_size_TGA);
-}
-#endif
-
 }
 
 #endif  // !DXX_USE_VULKAN
@@ -44,6 +44,8 @@
 #include "palette.h"
 #include "rle.h"
 #include "console.h"
+#include "load_trace.h"
+#include "timer.h"
 #include "config.h"
 #include "u_mem.h"
 
@@ -59,8 +61,14 @@
 #include "gamefont.h"
 #include "byteutil.h"
 #include "internal.h"
+#include "mem_trim.h"
+#include "ogl_sync.h"
+#include "ogl_texture_cache.h"
+#include "ogl_texture_pool.h"
+#include "ogl_texture_prep.h"
 #include "gauges.h"
 #include "object.h"
+#include "render.h"
 #include "args.h"
 
 #include "compiler-range_for.h"
@@ -69,8 +77,11 @@
 #include "partial_range.h"
 
 #include <algorithm>
+#include <cstring>
+#include <deque>
 #include <memory>
 #include <utility>
+#include <vector>
 using std::max;
 
 //change to 1 for lots of spew.
@@ -91,6 +102,7 @@ struct enable_ogl_client_state
 {
 	enable_ogl_client_state() noexcept
 	{
+		dcx::ogl_stream_flush();
 		glEnableClientState(G);
 	}
 	~enable_ogl_client_state() noexcept
@@ -134,26 +146,296 @@ static int ogl_rgb_internalformat = GL_RGB8;
 #endif
 static std::unique_ptr<GLfloat[]> sphere_va, circle_va, disk_va;
 static std::array<std::unique_ptr<GLfloat[]>, 3> secondary_lva;
-static int r_polyc,r_tpolyc,r_bitmapc,r_ubitbltc;
-#define f2glf(x) (f2fl(x))
 
-#define OGL_BINDTEXTURE(a) glBindTexture(GL_TEXTURE_2D, a);
+namespace {
+
+/* A rectangle of the screen, copied into a texture after it was drawn so
+ * that a later frame can put it back with one quad.  handle is 0 when
+ * there is no copy.
+ */
+struct ogl_retained_region
+{
+	GLuint handle{};
+	int x{}, y{}, w{}, h{};
+	unsigned tw{}, th{};
+};
+
+}
 
-/* I assume this ought to be >= MAX_BITMAP_FILES in piggy.h? */
-static std::array<ogl_texture, 20000> ogl_texture_list;
-static int ogl_texture_list_cur;
+static ogl_retained_region ogl_retained;
+/* The views in the cockpit windows, for ogl_retain_view_region */
+static std::array<ogl_retained_region, 2> ogl_retained_views;
+static int r_polyc,r_tpolyc,r_bitmapc,r_ubitbltc;
+#define f2glf(x) (f2fl(x))
 
 /* some function prototypes */
 
 #define GL_TEXTURE0_ARB 0x84C0
-static int ogl_loadtexture(const palette_array_t &, const uint8_t *data, int dxo, int dyo, ogl_texture &tex, int bm_flags, int data_format, opengl_texture_filter texfilt, bool texanis, bool edgepad) dxx_compiler_attribute_nonnull();
+static int ogl_loadtexture(const palette_array_t &, const uint8_t *data, int dxo, int dyo, ogl_texture &tex, int bm_flags, opengl_texture_filter texfilt, bool texanis, bool edgepad) dxx_compiler_attribute_nonnull();
 static void ogl_freetexture(ogl_texture &gltexture);
+static void ogl_unloadtexture(ogl_texture &gltexture);
+static void ogl_begin_texture_batch();
+static void ogl_end_texture_batch();
+static void ogl_discard_region(ogl_retained_region &r);
 
 static void ogl_loadbmtexture(grs_bitmap &bm, bool edgepad)
 {
 	ogl_loadbmtexture_f(bm, CGameCfg.TexFilt, CGameCfg.TexAnisotropy, edgepad);
 }
 
+/*
+ * With -gl_streambuffer and GL_ARB_buffer_storage, textured polygons are
+ * written to a persistently mapped ring instead of client arrays, so that
+ * the driver does not copy each draw.  The ring has one section for each
+ * frame that may be in flight; a section is fenced when its frame is
+ * swapped and waited for before it is written again.  Consecutive fans
+ * with the same texture are written as triangles and drawn together, so
+ * anything else that reaches GL must call ogl_stream_flush first.
+ */
+namespace {
+
+struct ogl_stream_vertex
+{
+	std::array<GLfloat, 3> position;
+	std::array<GLfloat, 4> color;
+	std::array<GLfloat, 2> texcoord;
+};
+
+class ogl_stream_ring
+{
+	static constexpr unsigned sections = 3;
+	static constexpr std::size_t section_vertices = 32768;
+	GLuint buffer = 0;
+	ogl_stream_vertex *mapped = nullptr;
+	std::array<ogl_fence, sections> fences;
+	unsigned section = 0;
+	/* Vertices are counted from the start of the buffer */
+	std::size_t used = 0;
+	std::size_t batch_first = 0;
+	/* Texture that the pending batch samples, or 0 if untextured */
+	GLuint batch_texture = 0;
+public:
+	/* Texture bound to GL_TEXTURE_2D, tracked while the ring is active so
+	 * that rebinding it neither flushes nor reaches GL
+	 */
+	GLuint bound_texture = 0;
+	bool active() const
+	{
+		return mapped;
+	}
+	void init();
+	void close();
+	void flush();
+	bool draw_fan(GLuint texture, std::span<const ogl_stream_vertex> fan);
+	void end_frame();
+};
+
+static ogl_stream_ring ogl_stream;
+
+namespace {
+
+/* Texture names given up while the GPU may still draw with them.  They
+ * are deleted once the fence inserted after their last use has passed,
+ * so that deleting a texture, or replacing one, never waits for the GPU.
+ * The names stay allocated until then, so a batched draw that still
+ * refers to one need not be flushed first.
+ */
+struct ogl_retired_textures
+{
+	ogl_fence fence;
+	std::vector<GLuint> handles;
+};
+
+}
+
+/* Retired in the current frame, and not yet covered by a fence */
+static std::vector<GLuint> ogl_retiring_textures;
+static std::deque<ogl_retired_textures> ogl_retired_textures_queue;
+
+/* Give up the texture name in `handle`, and clear it */
+static void ogl_retire_texture_name(GLuint &handle)
+{
+	if (ogl_stream.bound_texture == handle)
+		ogl_stream.bound_texture = 0;
+	if (ogl_have_ARB_sync)
+		ogl_retiring_textures.push_back(handle);
+	else
+	{
+		ogl_stream.flush();
+		glDeleteTextures(1, &handle);
+	}
+	handle = 0;
+}
+
+/* Delete the retired names the GPU is done with.  Called at the end of a
+ * frame, after the last draw that may use them.  With `wait`, delete all
+ * of them, as when the context is going away.
+ */
+static void ogl_delete_retired_textures(const bool wait)
+{
+	if (!ogl_retiring_textures.empty())
+	{
+		if (wait)
+		{
+			ogl_stream.flush();
+			glDeleteTextures(ogl_retiring_textures.size(), ogl_retiring_textures.data());
+			ogl_retiring_textures.clear();
+		}
+		else
+			ogl_retired_textures_queue.push_back({ogl_insert_fence(), std::exchange(ogl_retiring_textures, {})});
+	}
+	while (!ogl_retired_textures_queue.empty())
+	{
+		auto &r = ogl_retired_textures_queue.front();
+		if (!wait && !ogl_fence_signalled(r.fence))
+			break;
+		glDeleteTextures(r.handles.size(), r.handles.data());
+		ogl_retired_textures_queue.pop_front();
+	}
+}
+
+void ogl_stream_ring::init()
+{
+	close();
+	if (!CGameArg.OglStreamBuffer)
+		return;
+	if (!ogl_have_ARB_buffer_storage || !ogl_have_ARB_sync)
+	{
+		con_puts(CON_NORMAL, "DXX-Rebirth: OpenGL: -gl_streambuffer needs GL_ARB_buffer_storage and GL_ARB_sync, using client arrays");
+		return;
+	}
+	constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	constexpr GLsizeiptr size = sizeof(ogl_stream_vertex) * section_vertices * sections;
+	glGenBuffersFunc(1, &buffer);
+	glBindBufferFunc(GL_ARRAY_BUFFER, buffer);
+	glBufferStorageFunc(GL_ARRAY_BUFFER, size, nullptr, flags);
+	mapped = static_cast<ogl_stream_vertex *>(glMapBufferRangeFunc(GL_ARRAY_BUFFER, 0, size, flags));
+	glBindBufferFunc(GL_ARRAY_BUFFER, 0);
+	if (!mapped)
+	{
+		con_puts(CON_URGENT, "DXX-Rebirth: OpenGL: failed to map stream buffer, using client arrays");
+		close();
+		return;
+	}
+	con_printf(CON_VERBOSE, "DXX-Rebirth: OpenGL: streaming vertices through a %uKiB persistently mapped buffer", static_cast<unsigned>(size / 1024));
+}
+
+void ogl_stream_ring::close()
+{
+	fences = {};
+	if (buffer)
+		glDeleteBuffersFunc(1, &buffer);
+	buffer = 0;
+	mapped = nullptr;
+	section = 0;
+	used = batch_first = 0;
+	batch_texture = bound_texture = 0;
+}
+
+void ogl_stream_ring::flush()
+{
+	const auto count = used - batch_first;
+	if (!count)
+		return;
+	glBindBufferFunc(GL_ARRAY_BUFFER, buffer);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(ogl_stream_vertex), reinterpret_cast<const GLvoid *>(offsetof(ogl_stream_vertex, position)));
+	glColorPointer(4, GL_FLOAT, sizeof(ogl_stream_vertex), reinterpret_cast<const GLvoid *>(offsetof(ogl_stream_vertex, color)));
+	if (batch_texture)
+	{
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(ogl_stream_vertex), reinterpret_cast<const GLvoid *>(offsetof(ogl_stream_vertex, texcoord)));
+	}
+	glDrawArrays(GL_TRIANGLES, static_cast<GLint>(batch_first), static_cast<GLsizei>(count));
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glBindBufferFunc(GL_ARRAY_BUFFER, 0);
+	batch_first = used;
+}
+
+/* Returns false, leaving the draw to the caller, when the frame's section
+ * is full
+ */
+bool ogl_stream_ring::draw_fan(const GLuint texture, const std::span<const ogl_stream_vertex> fan)
+{
+	if (fan.size() < 3)
+		return true;
+	if (texture != batch_texture)
+	{
+		flush();
+		batch_texture = texture;
+	}
+	const std::size_t n = (fan.size() - 2) * 3;
+	if (used + n > (section + 1) * section_vertices)
+	{
+		flush();
+		return false;
+	}
+	auto out = mapped + used;
+	for (std::size_t i = 1; i + 1 != fan.size(); ++i)
+	{
+		*out++ = fan[0];
+		*out++ = fan[i];
+		*out++ = fan[i + 1];
+	}
+	used += n;
+	return true;
+}
+
+void ogl_stream_ring::end_frame()
+{
+	if (!mapped)
+		return;
+	flush();
+	fences[section] = ogl_insert_fence();
+	section = (section + 1) % sections;
+	ogl_wait_fence(std::exchange(fences[section], {}));
+	used = batch_first = section * section_vertices;
+}
+
+/* Copy a fan from the arrays that the client array path would draw */
+template <std::size_t N>
+static bool ogl_stream_fan(const GLuint texture, const std::size_t nv, const flatten_array<GLfloat, 3, N> &positions, const flatten_array<GLfloat, 4, N> &colors, const flatten_array<GLfloat, 2, N> *const texcoords)
+{
+	if (!ogl_stream.active())
+		return false;
+	std::array<ogl_stream_vertex, N> fan;
+	for (std::size_t i = 0; i != nv; ++i)
+		fan[i] = {positions.nested[i], colors.nested[i], texcoords ? texcoords->nested[i] : std::array<GLfloat, 2>{}};
+	return ogl_stream.draw_fan(texture, std::span(fan).first(nv));
+}
+
+static void ogl_bind_texture(const GLuint handle)
+{
+	if (ogl_stream.active())
+	{
+		if (ogl_stream.bound_texture == handle)
+			return;
+		ogl_stream.flush();
+		ogl_stream.bound_texture = handle;
+	}
+	glBindTexture(GL_TEXTURE_2D, handle);
+}
+
+}
+
+void ogl_stream_flush()
+{
+	ogl_stream.flush();
+}
+
+void ogl_init_stream()
+{
+	ogl_stream.init();
+}
+
+void ogl_close_stream()
+{
+	ogl_stream.close();
+}
+
 }
 
 #if DXX_USE_OGLES
@@ -241,6 +523,7 @@ void ogl_init_texture(ogl_texture &t, int w, int h, int flags)
 	t.wrapstate = -1;
 	t.lw = t.w = w;
 	t.h = h;
+	t.cache_key = 0;
 	ogl_init_texture_stats(t);
 }
 
@@ -250,50 +533,69 @@ static void ogl_reset_texture(ogl_texture &t)
 }
 
 static void ogl_reset_texture_stats_internal(void){
-	range_for (auto &i, ogl_texture_list)
+	range_for (auto &i, ogl_textures)
 		if (i.handle>0)
 			ogl_init_texture_stats(i);
 }
 
+namespace {
+
+/* A texture that was uploaded from the -gl_texcache file when the
+ * context was lost.  The key is kept to tell whether the entry was since
+ * reused by another bitmap.
+ */
+struct ogl_texture_restore
+{
+	ogl_texture *tex;
+	uint64_t cache_key;
+};
+
+/* Time each frame may spend in ogl_restore_textures_internal */
+constexpr fix64 ogl_texture_restore_budget{F1_0 / 500};
+
+}
+
+/* Drawn from the front, so the textures are restored in the order they
+ * were last used, most recent first
+ */
+static std::vector<ogl_texture_restore> ogl_texture_restores;
+
 void ogl_init_texture_list_internal(void){
-	ogl_texture_list_cur=0;
-	range_for (auto &i, ogl_texture_list)
+	ogl_texture_restores.clear();
+	range_for (auto &i, ogl_textures)
 		ogl_reset_texture(i);
+	ogl_textures.clear();
+	mem_trim_register(mem_trim_cost::upload, ogl_textures_trim);
 }
 
 void ogl_smash_texture_list_internal(void){
+	ogl_stream.flush();
+	ogl_delete_retired_textures(true);
+	ogl_stream.bound_texture = 0;
 	sphere_va.reset();
 	circle_va.reset();
 	disk_va.reset();
 	secondary_lva = {};
-	range_for (auto &i, ogl_texture_list)
+	ogl_discard_screen_region();
+	ogl_discard_view_regions();
+	range_for (auto &i, ogl_textures)
 	{
 		if (i.handle>0){
 			glDeleteTextures( 1, &i.handle );
 			i.handle=0;
 		}
+		ogl_textures.note_unloaded(i);
 		i.wrapstate = -1;
 	}
 }
 
-ogl_texture* ogl_get_free_texture(void){
-	for (unsigned i = ogl_texture_list.size(); i--;)
-	{
-		if (ogl_texture_list[ogl_texture_list_cur].handle<=0 && ogl_texture_list[ogl_texture_list_cur].w==0)
-			return &ogl_texture_list[ogl_texture_list_cur];
-		if (++ogl_texture_list_cur >= ogl_texture_list.size())
-			ogl_texture_list_cur=0;
-	}
-	throw std::runtime_error("OpenGL: texture list full");
-}
-
 static void ogl_texture_stats(grs_canvas &canvas)
 {
 	int used{0}, usedother = 0, usedidx = 0, usedrgb = 0, usedrgba = 0;
 	int databytes{0}, truebytes = 0;
 	GLint idx, r, g, b, a, dbl, depth;
 	int res, colorsize, depthsize;
-	range_for (auto &i, ogl_texture_list)
+	range_for (auto &i, ogl_textures)
 	{
 		if (i.handle>0){
 			used++;
@@ -340,6 +642,10 @@ static void ogl_texture_stats(grs_canvas &canvas)
 	gr_printf(canvas, game_font, fspacx2, fspacy1 + line_spacing, "%i(%i,%i,%i,%i) %iK(%iK wasted) (%i postcachedtex)", used, usedrgba, usedrgb, usedidx, usedother, truebytes / 1024, (truebytes - databytes) / 1024, r_texcount - r_cachedtexcount);
 	gr_printf(canvas, game_font, fspacx2, fspacy1 + (line_spacing * 2), "%ibpp(r%i,g%i,b%i,a%i)x%i=%iK depth%i=%iK", idx, r, g, b, a, dbl, colorsize / 1024, depth, depthsize / 1024);
 	gr_printf(canvas, game_font, fspacx2, fspacy1 + (line_spacing * 3), "total=%iK", (colorsize + depthsize + truebytes) / 1024);
+	const auto pool = ogl_textures.get_stats();
+	gr_printf(canvas, game_font, fspacx2, fspacy1 + (line_spacing * 4), "pool %zu/%zu resident %zuK budget %zuK evicted %u", pool.used, pool.entries, pool.resident_bytes / 1024, pool.budget_bytes / 1024, pool.evictions);
+	const auto cull = render_take_object_cull_stats();
+	gr_printf(canvas, game_font, fspacx2, fspacy1 + (line_spacing * 5), "objects %u drawn %u culled outside window %u behind", cull.drawn, cull.outside_window, cull.behind);
 }
 
 }
@@ -347,8 +653,9 @@ static void ogl_texture_stats(grs_canvas &canvas)
 static void ogl_bindbmtex(grs_bitmap &bm, bool edgepad){
 	if (bm.gltexture==NULL || bm.gltexture->handle<=0)
 		ogl_loadbmtexture(bm, edgepad);
-	OGL_BINDTEXTURE(bm.gltexture->handle);
+	ogl_bind_texture(bm.gltexture->handle);
 	bm.gltexture->numrend++;
+	ogl_textures.touch(*bm.gltexture);
 }
 
 //gltexture MUST be bound first
@@ -356,6 +663,7 @@ static void ogl_texwrap(ogl_texture *const gltexture, const int state)
 {
 	if (gltexture->wrapstate != state || gltexture->numrend < 1)
 	{
+		ogl_stream.flush();
 		gltexture->wrapstate = state;
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, state);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, state);
@@ -424,12 +732,14 @@ namespace dsx {
 
 void ogl_cache_level_textures(void)
 {
+	const load_trace_span trace{"ogl_cache_level_textures"};
 	auto &Effects = LevelUniqueEffectsClipState.Effects;
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &vcobjptridx = Objects.vcptridx;
 	int max_efx{0},ef;
 	
 	ogl_reset_texture_stats_internal();//loading a new lev should reset textures
+	ogl_begin_texture_batch();
 	
 	range_for (auto &ec, partial_const_range(Effects, Num_effects))
 	{
@@ -558,6 +868,7 @@ void ogl_cache_level_textures(void)
 			}
 		}
 	}
+	ogl_end_texture_batch();
 	glmprintf((CON_DEBUG, "finished caching"));
 	r_cachedtexcount = r_texcount;
 }
@@ -618,6 +929,7 @@ static std::unique_ptr<GLfloat[]> circle_array_init_2(const unsigned nsides, con
 
 void ogl_draw_vertex_reticle(grs_canvas &canvas, int cross, int primary, int secondary, int color, int alpha, int size_offs)
 {
+	ogl_stream.flush();
 	int size=270+(size_offs*20);
 	float scale = (static_cast<float>(SWIDTH)/SHEIGHT);
 	auto &&rgb{PAL2T(color)};
@@ -796,6 +1108,7 @@ void ogl_draw_vertex_reticle(grs_canvas &canvas, int cross, int primary, int sec
  */
 void g3_draw_sphere(grs_canvas &canvas, const g3_draw_sphere_point &pnt, fix rad, const uint8_t c)
 {
+	ogl_stream.flush();
 	int i;
 	const float scale = (static_cast<float>(canvas.cv_bitmap.bm_w) / canvas.cv_bitmap.bm_h);
 	std::array<GLfloat, 20 * 4> color_array;
@@ -838,6 +1151,7 @@ void g3_draw_sphere(grs_canvas &canvas, const g3_draw_sphere_point &pnt, fix rad
 
 int gr_ucircle(grs_canvas &canvas, const fix xc1, const fix yc1, const fix r1, const uint8_t c)
 {
+	ogl_stream.flush();
 	int nsides;
 	OGL_DISABLE(TEXTURE_2D);
 	glColor4f(CPAL2Tr(c), CPAL2Tg(c), CPAL2Tb(c), (canvas.cv_fade_level >= GR_FADE_OFF)?1.0:1.0 - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0));
@@ -856,6 +1170,7 @@ int gr_ucircle(grs_canvas &canvas, const fix xc1, const fix yc1, const fix r1, c
 
 int gr_disk(grs_canvas &canvas, const fix x, const fix y, const fix r, const uint8_t c)
 {
+	ogl_stream.flush();
 	int nsides;
 	OGL_DISABLE(TEXTURE_2D);
 	glColor4f(CPAL2Tr(c), CPAL2Tg(c), CPAL2Tb(c), (canvas.cv_fade_level >= GR_FADE_OFF) ? 1.0 : 1.0 - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0));
@@ -872,6 +1187,22 @@ int gr_disk(grs_canvas &canvas, const fix x, const fix y, const fix r, const uin
 	return 0;
 }
 
+namespace {
+
+/* Model space positions cannot join the stream, which holds eye space
+ * fans, so send what it holds first to keep the order of the draws.
+ */
+static void ogl_draw_model_fan(const GLenum mode, const std::size_t nv)
+{
+	ogl_stream.flush();
+	glPushMatrix();
+	glMultMatrixf(ogl_current_model_matrix->data());
+	glDrawArrays(mode, 0, nv);
+	glPopMatrix();
+}
+
+}
+
 /*
  * Draw flat-shaded Polygon (Lasers, Drone-arms, Driller-ears)
  */
@@ -908,12 +1239,147 @@ void _g3_draw_poly(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 		auto &pv = p->p3_vec;
 		v[0] = f2glf(pv.x);
 		v[1] = f2glf(pv.y);
-		v[2] = -f2glf(pv.z);
+		v[2] = ogl_current_model_matrix ? f2glf(pv.z) : -f2glf(pv.z);
 	}
 
 	glVertexPointer(3, GL_FLOAT, 0, vertices.flat.data());
 	glColorPointer(4, GL_FLOAT, 0, color_array.flat.data());
-	glDrawArrays(GL_TRIANGLE_FAN, 0, pointlist.size());
+	if (ogl_current_model_matrix)
+		ogl_draw_model_fan(GL_TRIANGLE_FAN, pointlist.size());
+	else
+		glDrawArrays(GL_TRIANGLE_FAN, 0, pointlist.size());
+}
+
+/*
+ * Static wall geometry for -gl_staticgeometry.  This fixed-function path
+ * has no buffer objects, so the corners stay in one client array for the
+ * level and are drawn through Gl_view_matrix instead of being converted
+ * from the rotated points every frame.
+ */
+ogl_static_face ogl_current_static_face;
+
+namespace {
+static std::vector<std::array<GLfloat, 3>> ogl_static_corners;
+
+static const GLfloat *ogl_static_face_positions()
+{
+	auto &face = ogl_current_static_face;
+	if (!face.active || face.base + 4 > ogl_static_corners.size())
+		return nullptr;
+	return ogl_static_corners[face.base].data();
+}
+
+/* glDrawElements indexes every array with the same corner numbers, so the
+ * streamed colors and texture coordinates move to the slots of their
+ * corners.  overlay_texcoord_array is for texture unit 1, whose client
+ * array the caller enables.
+ */
+static void ogl_draw_static_face(const GLfloat *const positions, const std::size_t nv, const flatten_array<GLfloat, 4, MAX_POINTS_PER_POLY> &color_array, const flatten_array<GLfloat, 2, MAX_POINTS_PER_POLY> *const texcoord_array, const flatten_array<GLfloat, 2, MAX_POINTS_PER_POLY> *const overlay_texcoord_array = nullptr)
+{
+	flatten_array<GLfloat, 4, 4> colors;
+	flatten_array<GLfloat, 2, 4> texcoords, overlay_texcoords;
+	std::array<GLubyte, 4> indices;
+	for (std::size_t i = 0; i != nv; ++i)
+	{
+		const auto c = ogl_current_static_face.corner[i];
+		indices[i] = c;
+		colors.nested[c] = color_array.nested[i];
+		if (texcoord_array)
+			texcoords.nested[c] = texcoord_array->nested[i];
+		if (overlay_texcoord_array)
+			overlay_texcoords.nested[c] = overlay_texcoord_array->nested[i];
+	}
+	glPushMatrix();
+	glMultMatrixf(Gl_view_matrix.data());
+	glVertexPointer(3, GL_FLOAT, 0, positions);
+	glColorPointer(4, GL_FLOAT, 0, colors.flat.data());
+	if (texcoord_array)
+		glTexCoordPointer(2, GL_FLOAT, 0, texcoords.flat.data());
+	if (overlay_texcoord_array)
+	{
+		glClientActiveTextureFunc(GL_TEXTURE1);
+		glTexCoordPointer(2, GL_FLOAT, 0, overlay_texcoords.flat.data());
+		glClientActiveTextureFunc(GL_TEXTURE0);
+	}
+	glDrawElements(GL_TRIANGLE_FAN, nv, GL_UNSIGNED_BYTE, indices.data());
+	glPopMatrix();
+}
+}
+
+void ogl_upload_static_geometry(const std::span<const std::array<float, 3>> corners)
+{
+	ogl_static_corners.assign(corners.begin(), corners.end());
+}
+
+void ogl_free_static_geometry()
+{
+	ogl_static_corners = {};
+}
+
+const std::array<float, 16> *ogl_current_model_matrix;
+
+namespace {
+static std::vector<std::array<GLfloat, 3>> ogl_static_line_points;
+/* The ends and colors of the lines drawn this frame, gathered so that GLES,
+ * which cannot index more than 65536 points, can draw them with
+ * glDrawArrays
+ */
+static std::vector<std::array<GLfloat, 3>> ogl_static_line_positions;
+static std::vector<std::array<GLfloat, 4>> ogl_static_line_colors;
+}
+
+void ogl_upload_static_lines(const std::span<const std::array<float, 3>> points)
+{
+	ogl_static_line_points.assign(points.begin(), points.end());
+}
+
+void ogl_draw_static_lines(const std::span<const ogl_static_line> lines)
+{
+	auto &positions = ogl_static_line_positions;
+	auto &colors = ogl_static_line_colors;
+	positions.clear();
+	colors.clear();
+	const std::size_t npoints = ogl_static_line_points.size();
+	for (auto &l : lines)
+	{
+		const std::size_t i = std::size_t{l.line} * 2;
+		if (i + 1 >= npoints)
+			continue;
+		auto &&rgb{PAL2T(l.color)};
+		const std::array<GLfloat, 4> c{{rgb.r / 63.0f, rgb.g / 63.0f, rgb.b / 63.0f, 1.0f}};
+		positions.insert(positions.end(), {ogl_static_line_points[i], ogl_static_line_points[i + 1]});
+		colors.insert(colors.end(), {c, c});
+	}
+	if (positions.empty())
+		return;
+	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY> cs;
+	OGL_DISABLE(TEXTURE_2D);
+	glDisable(GL_CULL_FACE);
+	glPushMatrix();
+	glMultMatrixf(Gl_view_matrix.data());
+	glVertexPointer(3, GL_FLOAT, 0, positions.front().data());
+	glColorPointer(4, GL_FLOAT, 0, colors.front().data());
+	glDrawArrays(GL_LINES, 0, positions.size());
+	glPopMatrix();
+}
+
+void ogl_free_static_lines()
+{
+	ogl_static_line_points = {};
+	ogl_static_line_positions = {};
+	ogl_static_line_colors = {};
+}
+
+/* Fixed-function lighting cannot reproduce apply_light's falloff, so walls
+ * keep their vertex light
+ */
+bool ogl_static_lights_enabled()
+{
+	return false;
+}
+
+void ogl_set_static_lights(std::span<const ogl_static_light>, float)
+{
 }
 
 /*
@@ -923,9 +1389,7 @@ void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 {
 	GLfloat color_alpha = 1.0;
 
-	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY> cs;
 	if (tmap_drawer_ptr == draw_tmap) {
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 		OGL_ENABLE(TEXTURE_2D);
 		ogl_bindbmtex(bm, 0);
 		ogl_texwrap(bm.gltexture, GL_REPEAT);
@@ -945,6 +1409,7 @@ void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 	flatten_array<GLfloat, 2, MAX_POINTS_PER_POLY> texcoord_array;
 
 	const auto nv = pointlist.size();
+	const auto static_positions = ogl_static_face_positions();
 	for (auto &&[point, light, uvl, vert, color, texcoord] : zip(
 			pointlist,
 			unchecked_partial_range(light_rgb, nv),
@@ -955,9 +1420,12 @@ void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 		)
 	)
 	{
-		vert[0] = f2glf(point->p3_vec.x);
-		vert[1] = f2glf(point->p3_vec.y);
-		vert[2] = -f2glf(point->p3_vec.z);
+		if (!static_positions)
+		{
+			vert[0] = f2glf(point->p3_vec.x);
+			vert[1] = f2glf(point->p3_vec.y);
+			vert[2] = ogl_current_model_matrix ? f2glf(point->p3_vec.z) : -f2glf(point->p3_vec.z);
+		}
 		color[3] = color_alpha;
 		if (tmap_drawer_ptr == draw_tmap_flat) {
 			color[0] = color[1] = color[2] = 0;
@@ -979,66 +1447,229 @@ void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 		}
 	}
 
-	glVertexPointer(3, GL_FLOAT, 0, vertices.flat.data());
-	glColorPointer(4, GL_FLOAT, 0, color_array.flat.data());
-	if (tmap_drawer_ptr == draw_tmap) {
-		glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array.flat.data());
+	const bool textured = tmap_drawer_ptr == draw_tmap;
+	if (!static_positions && !ogl_current_model_matrix && ogl_stream_fan(textured ? bm.gltexture->handle : 0, nv, vertices, color_array, textured ? &texcoord_array : nullptr))
+		return;
+	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY> cs;
+	if (textured)
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	if (static_positions)
+		ogl_draw_static_face(static_positions, nv, color_array, textured ? &texcoord_array : nullptr);
+	else
+	{
+		glVertexPointer(3, GL_FLOAT, 0, vertices.flat.data());
+		glColorPointer(4, GL_FLOAT, 0, color_array.flat.data());
+		if (tmap_drawer_ptr == draw_tmap)
+			glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array.flat.data());
+		if (ogl_current_model_matrix)
+			ogl_draw_model_fan(GL_TRIANGLE_FAN, nv);
+		else
+			glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
 	}
 	
-	glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
-	
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 }
 
-/*
- * Everything texturemapped with secondary texture (walls with secondary texture)
+namespace {
+
+static std::array<GLfloat, 2> ogl_overlay_texcoord(const g3s_uvl &uvl, const texture2_rotation_low orient)
+{
+	const GLfloat uf = f2glf(uvl.u), vf = f2glf(uvl.v);
+	switch (orient)
+	{
+		case texture2_rotation_low::_1:
+			return {1.0f - vf, uf};
+		case texture2_rotation_low::_2:
+			return {1.0f - uf, 1.0f - vf};
+		case texture2_rotation_low::_3:
+			return {vf, 1.0f - uf};
+		default:
+			return {uf, vf};
+	}
+}
+
+static void ogl_set_combine(const GLenum rgb_function, const GLenum alpha_function)
+{
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+	glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, rgb_function);
+	glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, alpha_function);
+}
+
+/* A wall and its overlay in one draw.  Unit 0 samples the bottom texture
+ * unlit, unit 1 blends the overlay over it by the overlay's alpha, and
+ * unit 2 applies the vertex color, which is what the second pass of
+ * _g3_draw_tmap_2 blends.  Unit 2 has the overlay bound only so that its
+ * environment runs; it does not read it.  The lighting is shared, so both
+ * bitmaps must take the same.
  */
-void _g3_draw_tmap_2(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const std::span<const g3s_uvl, 4> uvl_list, const std::span<const g3s_lrgb, 4> light_rgb, grs_bitmap &bmbot, grs_bitmap &bm, const texture2_rotation_low orient, const tmap_drawer_type tmap_drawer_ptr)
+static bool ogl_draw_tmap_overlay(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const std::span<const g3s_uvl, 4> uvl_list, const std::span<const g3s_lrgb, 4> light_rgb, grs_bitmap &bmbot, grs_bitmap &bm, const texture2_rotation_low orient, const tmap_drawer_type tmap_drawer_ptr)
 {
-	_g3_draw_tmap(canvas, pointlist, uvl_list.data(), light_rgb.data(), bmbot, tmap_drawer_ptr);//draw the bottom texture first.. could be optimized with multitexturing..
-	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY> cs;
-	(void)cs;
+	if (!ogl_have_texture_env_combine || tmap_drawer_ptr != draw_tmap)
+		return false;
+	const auto unlit = bm.get_flag_mask(BM_FLAG_NO_LIGHTING);
+	if (unlit != bmbot.get_flag_mask(BM_FLAG_NO_LIGHTING))
+		return false;
+	ogl_stream.flush();
 	r_tpolyc++;
 	OGL_ENABLE(TEXTURE_2D);
+	/* Load both on unit 0, where the stream ring tracks the binding */
 	ogl_bindbmtex(bm, 1);
 	ogl_texwrap(bm.gltexture, GL_REPEAT);
+	ogl_bindbmtex(bmbot, 0);
+	ogl_texwrap(bmbot.gltexture, GL_REPEAT);
 
+	const GLfloat alpha = (canvas.cv_fade_level >= GR_FADE_OFF)
+		? 1.0
+		: (1.0 - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0));
+	flatten_array<GLfloat, 3, MAX_POINTS_PER_POLY> vertices;
 	flatten_array<GLfloat, 4, MAX_POINTS_PER_POLY> color_array;
+	flatten_array<GLfloat, 2, MAX_POINTS_PER_POLY> texcoord_array, overlay_texcoord_array;
+	const auto nv = pointlist.size();
+	const auto static_positions = ogl_static_face_positions();
+	for (auto &&[point, light, uvl, vert, color, texcoord, overlay_texcoord] : zip(
+			pointlist,
+			unchecked_partial_range(light_rgb, nv),
+			unchecked_partial_range(uvl_list, nv),
+			unchecked_partial_range(vertices.nested, nv),
+			unchecked_partial_range(color_array.nested, nv),
+			unchecked_partial_range(texcoord_array.nested, nv),
+			partial_range(overlay_texcoord_array.nested, nv)
+		)
+	)
 	{
-		const GLfloat alpha = (canvas.cv_fade_level >= GR_FADE_OFF)
-			? 1.0
-			: (1.0 - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0));
-		auto &&color_range = unchecked_partial_range(color_array.nested, pointlist.size());
-		if (bm.get_flag_mask(BM_FLAG_NO_LIGHTING))
+		if (!static_positions)
 		{
-			for (auto &e : color_range)
-			{
-				e[0] = e[1] = e[2] = 1.0;
-				e[3] = alpha;
-			}
+			vert[0] = f2glf(point->p3_vec.x);
+			vert[1] = f2glf(point->p3_vec.y);
+			vert[2] = -f2glf(point->p3_vec.z);
 		}
+		if (unlit)
+			color[0] = color[1] = color[2] = 1.0;
 		else
 		{
-			for (auto &&[e, l] : zip(
-					color_range,
-					unchecked_partial_range(light_rgb, pointlist.size())
-				)
-			)
-			{
-				e[0] = f2glf(l.r);
-				e[1] = f2glf(l.g);
-				e[2] = f2glf(l.b);
-				e[3] = alpha;
-			}
+			color[0] = f2glf(light.r);
+			color[1] = f2glf(light.g);
+			color[2] = f2glf(light.b);
 		}
+		color[3] = alpha;
+		texcoord[0] = f2glf(uvl.u);
+		texcoord[1] = f2glf(uvl.v);
+		overlay_texcoord = ogl_overlay_texcoord(uvl, orient);
 	}
 
-	flatten_array<GLfloat, 3, MAX_POINTS_PER_POLY> vertices;
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+	glActiveTextureFunc(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, bm.gltexture->handle);
+	glEnable(GL_TEXTURE_2D);
+	ogl_set_combine(GL_INTERPOLATE, GL_ADD);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
+	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PREVIOUS);
+	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE2_RGB, GL_TEXTURE);
+	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND2_RGB, GL_SRC_ALPHA);
+	/* The alpha test keeps a texel that either pass would have drawn */
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PREVIOUS);
+	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+	glActiveTextureFunc(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, bm.gltexture->handle);
+	glEnable(GL_TEXTURE_2D);
+	ogl_set_combine(GL_MODULATE, GL_MODULATE);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PREVIOUS);
+	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
+	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_PREVIOUS);
+	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
+	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+
+	{
+		ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY> cs;
+		glClientActiveTextureFunc(GL_TEXTURE1);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glClientActiveTextureFunc(GL_TEXTURE0);
+		if (static_positions)
+			ogl_draw_static_face(static_positions, nv, color_array, &texcoord_array, &overlay_texcoord_array);
+		else
+		{
+			glVertexPointer(3, GL_FLOAT, 0, vertices.flat.data());
+			glColorPointer(4, GL_FLOAT, 0, color_array.flat.data());
+			glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array.flat.data());
+			glClientActiveTextureFunc(GL_TEXTURE1);
+			glTexCoordPointer(2, GL_FLOAT, 0, overlay_texcoord_array.flat.data());
+			glClientActiveTextureFunc(GL_TEXTURE0);
+			glDrawArrays(GL_TRIANGLE_FAN, 0, nv);
+		}
+		glClientActiveTextureFunc(GL_TEXTURE1);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glClientActiveTextureFunc(GL_TEXTURE0);
+	}
+
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glDisable(GL_TEXTURE_2D);
+	glActiveTextureFunc(GL_TEXTURE1);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glDisable(GL_TEXTURE_2D);
+	glActiveTextureFunc(GL_TEXTURE0);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	return true;
+}
+
+}
+
+/*
+ * Everything texturemapped with secondary texture (walls with secondary texture)
+ */
+void _g3_draw_tmap_2(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const std::span<const g3s_uvl, 4> uvl_list, const std::span<const g3s_lrgb, 4> light_rgb, grs_bitmap &bmbot, grs_bitmap &bm, const texture2_rotation_low orient, const tmap_drawer_type tmap_drawer_ptr)
+{
+	if (ogl_draw_tmap_overlay(canvas, pointlist, uvl_list, light_rgb, bmbot, bm, orient, tmap_drawer_ptr))
+		return;
+	_g3_draw_tmap(canvas, pointlist, uvl_list.data(), light_rgb.data(), bmbot, tmap_drawer_ptr);//draw the bottom texture first
+	r_tpolyc++;
+	OGL_ENABLE(TEXTURE_2D);
+	ogl_bindbmtex(bm, 1);
+	ogl_texwrap(bm.gltexture, GL_REPEAT);
+
+	flatten_array<GLfloat, 4, MAX_POINTS_PER_POLY> color_array;
+	{
+		const GLfloat alpha = (canvas.cv_fade_level >= GR_FADE_OFF)
+			? 1.0
+			: (1.0 - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0));
+		auto &&color_range = unchecked_partial_range(color_array.nested, pointlist.size());
+		if (bm.get_flag_mask(BM_FLAG_NO_LIGHTING))
+		{
+			for (auto &e : color_range)
+			{
+				e[0] = e[1] = e[2] = 1.0;
+				e[3] = alpha;
+			}
+		}
+		else
+		{
+			for (auto &&[e, l] : zip(
+					color_range,
+					unchecked_partial_range(light_rgb, pointlist.size())
+				)
+			)
+			{
+				e[0] = f2glf(l.r);
+				e[1] = f2glf(l.g);
+				e[2] = f2glf(l.b);
+				e[3] = alpha;
+			}
+		}
+	}
+
+	flatten_array<GLfloat, 3, MAX_POINTS_PER_POLY> vertices;
 	flatten_array<GLfloat, 2, MAX_POINTS_PER_POLY> texcoord_array;
 
 	const auto nv = pointlist.size();
+	const auto static_positions = ogl_static_face_positions();
 	for (auto &&[point, uvl, vert, texcoord] : zip(
 			pointlist,
 			unchecked_partial_range(uvl_list, nv),
@@ -1047,29 +1678,21 @@ void _g3_draw_tmap_2(grs_canvas &canvas, const std::span<g3_draw_tmap_point *con
 		)
 	)
 	{
-		const GLfloat uf = f2glf(uvl.u), vf = f2glf(uvl.v);
-		switch(orient){
-			case texture2_rotation_low::_1:
-				texcoord[0] = 1.0 - vf;
-				texcoord[1] = uf;
-				break;
-			case texture2_rotation_low::_2:
-				texcoord[0] = 1.0 - uf;
-				texcoord[1] = 1.0 - vf;
-				break;
-			case texture2_rotation_low::_3:
-				texcoord[0] = vf;
-				texcoord[1] = 1.0 - uf;
-				break;
-			default:
-				texcoord[0] = uf;
-				texcoord[1] = vf;
-				break;
-		}
+		texcoord = ogl_overlay_texcoord(uvl, orient);
+		if (static_positions)
+			continue;
 		vert[0] = f2glf(point->p3_vec.x);
 		vert[1] = f2glf(point->p3_vec.y);
 		vert[2] = -f2glf(point->p3_vec.z);
 	}
+	if (!static_positions && ogl_stream_fan(bm.gltexture->handle, nv, vertices, color_array, &texcoord_array))
+		return;
+	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY> cs;
+	if (static_positions)
+	{
+		ogl_draw_static_face(static_positions, nv, color_array, &texcoord_array);
+		return;
+	}
 	glVertexPointer(3, GL_FLOAT, 0, vertices.flat.data());
 	glColorPointer(4, GL_FLOAT, 0, color_array.flat.data());
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array.flat.data());
@@ -1082,9 +1705,6 @@ void _g3_draw_tmap_2(grs_canvas &canvas, const std::span<g3_draw_tmap_point *con
 void g3_draw_bitmap(grs_canvas &canvas, const vms_vector &pos, const fix iwidth, const fix iheight, grs_bitmap &bm)
 {
 	r_bitmapc++;
-	
-	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY> cs;
-	auto &i = std::get<0>(cs);
 
 	OGL_ENABLE(TEXTURE_2D);
 	ogl_bindbmtex(bm, 0);
@@ -1113,7 +1733,7 @@ void g3_draw_bitmap(grs_canvas &canvas, const vms_vector &pos, const fix iwidth,
 	const auto bmglv = bm.gltexture->v;
 	const auto alpha = canvas.cv_fade_level >= GR_FADE_OFF ? 1.0 : (1.0 - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0));
 	const auto vert_z = -f2glf(rpv.z);
-	for (i=0;i<4;i++){
+	for (unsigned i = 0; i < point_count; i++){
 		auto pv = rpv;
 		switch (i){
 			case 0:
@@ -1150,6 +1770,18 @@ void g3_draw_bitmap(grs_canvas &canvas, const vms_vector &pos, const fix iwidth,
 		vertices[i].y = f2glf(pv.y);
 		vertices[i].z = vert_z;
 	}
+	/* Sprites sharing a bitmap, as the frames of a cloud of fireballs
+	 * often do, go out as one draw
+	 */
+	if (ogl_stream.active())
+	{
+		std::array<ogl_stream_vertex, point_count> fan;
+		for (std::size_t i = 0; i != fan.size(); ++i)
+			fan[i] = {{{vertices[i].x, vertices[i].y, vertices[i].z}}, {{color_array[i].r, color_array[i].g, color_array[i].b, color_array[i].a}}, {{texcoord_array[i].u, texcoord_array[i].v}}};
+		if (ogl_stream.draw_fan(bm.gltexture->handle, fan))
+			return;
+	}
+	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY> cs;
 	glVertexPointer(3, GL_FLOAT, 0, vertices.data());
 	glColorPointer(4, GL_FLOAT, 0, color_array.data());
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array.data());
@@ -1190,8 +1822,8 @@ bool ogl_ubitblt_i(unsigned dw,unsigned dh,unsigned dx,unsigned dy, unsigned sw,
 	
 	OGL_ENABLE(TEXTURE_2D);
 	
-	ogl_loadtexture(gr_current_pal, src.get_bitmap_data(), sx, sy, tex, src.get_flags(), 0, texfilt, 0, 0);
-	OGL_BINDTEXTURE(tex.handle);
+	ogl_loadtexture(gr_current_pal, src.get_bitmap_data(), sx, sy, tex, src.get_flags(), texfilt, 0, 0);
+	ogl_bind_texture(tex.handle);
 	
 	ogl_texwrap(&tex,GL_CLAMP_TO_EDGE);
 
@@ -1239,6 +1871,7 @@ bool ogl_ubitblt(unsigned w,unsigned h,unsigned dx,unsigned dy, unsigned sx, uns
  */
 void ogl_toggle_depth_test(int enable)
 {
+	ogl_stream.flush();
 	if (enable)
 		glEnable(GL_DEPTH_TEST);
 	else
@@ -1250,6 +1883,7 @@ void ogl_toggle_depth_test(int enable)
  */
 void ogl_set_blending(const gr_blend cv_blend_func)
 {
+	ogl_stream.flush();
 	GLenum s, d;
 	switch (cv_blend_func)
 	{
@@ -1272,6 +1906,7 @@ void ogl_set_blending(const gr_blend cv_blend_func)
 
 void ogl_start_frame(grs_canvas &canvas)
 {
+	ogl_stream.flush();
 	r_polyc=0;r_tpolyc=0;r_bitmapc=0;r_ubitbltc=0;
 
 	OGL_VIEWPORT(canvas.cv_bitmap.bm_x, canvas.cv_bitmap.bm_y, canvas.cv_bitmap.bm_w, canvas.cv_bitmap.bm_h);
@@ -1305,6 +1940,7 @@ void ogl_start_frame(grs_canvas &canvas)
 #if DXX_USE_STEREOSCOPIC_RENDER
 void ogl_stereo_frame(const bool left_eye, const int xoff)
 {
+	ogl_stream.flush();
 	const float dxoff = xoff * 2.0f / grd_curscreen->sc_canvas.cv_bitmap.bm_w;
 	float stereo_transform_dxoff;
 
@@ -1397,6 +2033,7 @@ void ogl_stereo_frame(const bool left_eye, const int xoff)
 #endif
 
 void ogl_end_frame(void){
+	ogl_stream.flush();
 	OGL_VIEWPORT(0, 0, grd_curscreen->get_screen_width(), grd_curscreen->get_screen_height());
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();//clear matrix
@@ -1411,6 +2048,87 @@ void ogl_end_frame(void){
 	glDisable(GL_DEPTH_TEST);
 }
 
+namespace {
+
+/* A screen read into a pixel pack buffer, waiting for the GPU */
+struct ogl_screen_read
+{
+	GLuint buffer;
+	ogl_fence fence;
+	unsigned w, h;
+	std::function<void(ogl_screen_image &&)> done;
+};
+
+/* More reads than this wait for the GPU instead of queueing */
+constexpr std::size_t ogl_max_screen_reads{4};
+static std::deque<ogl_screen_read> ogl_screen_reads;
+
+}
+
+bool ogl_read_screen(std::function<void(ogl_screen_image &&)> done)
+{
+	if (!CGameArg.DbgGlReadPixelsOk)
+		return false;
+	const unsigned w = grd_curscreen->get_screen_width();
+	const unsigned h = grd_curscreen->get_screen_height();
+	const std::size_t size{std::size_t{w} * h * 3};
+#if !DXX_USE_OGLES
+	glReadBuffer(GL_FRONT);
+#endif
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	if (ogl_have_pixel_buffer_object && ogl_have_ARB_sync && ogl_screen_reads.size() < ogl_max_screen_reads)
+	{
+		auto &r = ogl_screen_reads.emplace_back(0, ogl_fence{}, w, h, std::move(done));
+		glGenBuffersFunc(1, &r.buffer);
+		glBindBufferFunc(GL_PIXEL_PACK_BUFFER, r.buffer);
+		glBufferDataFunc(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+		glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+		glBindBufferFunc(GL_PIXEL_PACK_BUFFER, 0);
+		r.fence = ogl_insert_fence();
+		return true;
+	}
+	ogl_screen_image image{w, h, true, std::vector<uint8_t>(size)};
+	glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, image.rgb.data());
+	done(std::move(image));
+	return true;
+}
+
+/* Pass on the screen reads the GPU has finished, in the order they were
+ * made.  With `wait`, wait for all of them.
+ */
+static void ogl_finish_screen_reads(const bool wait)
+{
+	while (!ogl_screen_reads.empty())
+	{
+		auto &r = ogl_screen_reads.front();
+		if (wait)
+			ogl_wait_fence(r.fence);
+		else if (!ogl_fence_signalled(r.fence))
+			return;
+		const std::size_t stride{std::size_t{r.w} * 3};
+		ogl_screen_image image{r.w, r.h, false, std::vector<uint8_t>(stride * r.h)};
+		glBindBufferFunc(GL_PIXEL_PACK_BUFFER, r.buffer);
+		if (const auto p = static_cast<const uint8_t *>(glMapBufferRangeFunc(GL_PIXEL_PACK_BUFFER, 0, image.rgb.size(), GL_MAP_READ_BIT)))
+		{
+			/* Turn the rows over while copying, which costs nothing */
+			for (unsigned y = 0; y < r.h; ++y)
+				std::memcpy(&image.rgb[y * stride], p + (r.h - 1 - y) * stride, stride);
+			glUnmapBufferFunc(GL_PIXEL_PACK_BUFFER);
+		}
+		else
+		{
+			con_puts(CON_URGENT, "DXX-Rebirth: OpenGL: failed to map screen read buffer");
+			image.rgb.clear();
+		}
+		glBindBufferFunc(GL_PIXEL_PACK_BUFFER, 0);
+		glDeleteBuffersFunc(1, &r.buffer);
+		auto done{std::move(r.done)};
+		ogl_screen_reads.pop_front();
+		if (!image.rgb.empty())
+			done(std::move(image));
+	}
+}
+
 void gr_flip(void)
 {
 	if (CGameArg.DbgRenderStats)
@@ -1420,6 +2138,12 @@ void gr_flip(void)
 	}
 
 	ogl_do_palfx();
+	ogl_stream.end_frame();
+	ogl_finish_screen_reads(false);
+	for (const auto t : ogl_textures.end_frame())
+		ogl_unloadtexture(*t);
+	ogl_restore_textures_internal();
+	ogl_delete_retired_textures(false);
 	ogl_swap_buffers_internal();
 	glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -1438,128 +2162,22 @@ void ogl_close_pixel_buffers(void)
 	texbuf.reset();
 }
 
-static void ogl_filltexbuf(const palette_array_t &pal, const uint8_t *const data, GLubyte *texp, const unsigned truewidth, const unsigned width, const unsigned height, const int dxo, const int dyo, const unsigned twidth, const unsigned theight, const int type, const int bm_flags, const int data_format)
+void ogl_close_screen_reads()
+{
+	ogl_finish_screen_reads(true);
+}
+
+static void ogl_check_texture_size(const unsigned width, const unsigned height)
 {
 	if ((width > max(static_cast<unsigned>(grd_curscreen->get_screen_width()), 1024u)) ||
 		(height > max(static_cast<unsigned>(grd_curscreen->get_screen_height()), 256u)))
 		Error("Texture is too big: %ix%i", width, height);
+}
 
-	for (unsigned y=0;y<theight;y++)
-	{
-		int i=dxo+truewidth*(y+dyo);
-		for (unsigned x=0;x<twidth;x++)
-		{
-			int c;
-			if (x<width && y<height)
-			{
-				if (data_format)
-				{
-					int j;
-
-					for (j = 0; j < data_format; ++j)
-						(*(texp++)) = data[i * data_format + j];
-					i++;
-					continue;
-				}
-				else
-				{
-					c = data[i++];
-				}
-			}
-			else if (x == width && y < height) // end of bitmap reached - fill this pixel with last color to make a clean border when filtering this texture
-			{
-				c = data[(width*(y+1))-1];
-			}
-			else if (y == height && x < width) // end of bitmap reached - fill this row with color or last row to make a clean border when filtering this texture
-			{
-				c = data[(width*(height-1))+x];
-			}
-			else
-			{
-				c = 256; // fill the pad space with transparency (or blackness)
-			}
-
-			if (c == 254 && (bm_flags & BM_FLAG_SUPER_TRANSPARENT))
-			{
-				switch (type)
-				{
-					case GL_RGBA:
-						(*(texp++)) = 255;
-						(*(texp++)) = 255;
-						[[fallthrough]];
-					case GL_LUMINANCE_ALPHA:
-						(*(texp++)) = 255;
-						(*(texp++)) = 0; // transparent pixel
-						break;
-#if !DXX_USE_OGLES
-					case GL_COLOR_INDEX:
-						(*(texp++)) = c;
-						break;
-#endif
-					default:
-						Error("ogl_filltexbuf unhandled super-transparent texformat\n");
-						break;
-				}
-			}
-			else if ((c == 255 && (bm_flags & BM_FLAG_TRANSPARENT)) || c == 256)
-			{
-				switch (type)
-				{
-					case GL_RGBA:
-						(*(texp++))=0;
-						[[fallthrough]];
-					case GL_RGB:
-						(*(texp++))=0;
-						[[fallthrough]];
-					case GL_LUMINANCE_ALPHA:
-						(*(texp++))=0;
-						[[fallthrough]];
-					case GL_LUMINANCE:
-						(*(texp++))=0;//transparent pixel
-						break;
-#if !DXX_USE_OGLES
-					case GL_COLOR_INDEX:
-						(*(texp++)) = c;
-						break;
-#endif
-					default:
-						Error("ogl_filltexbuf unknown texformat\n");
-						break;
-				}
-			}
-			else
-			{
-				switch (type)
-				{
-					case GL_LUMINANCE_ALPHA:
-						(*(texp++))=255;
-						[[fallthrough]];
-					case GL_LUMINANCE://these could prolly be done to make the intensity based upon the intensity of the resulting color, but its not needed for anything (yet?) so no point. :)
-						(*(texp++))=255;
-						break;
-					case GL_RGB:
-						(*(texp++)) = pal[c].r * 4;
-						(*(texp++)) = pal[c].g * 4;
-						(*(texp++)) = pal[c].b * 4;
-						break;
-					case GL_RGBA:
-						(*(texp++)) = pal[c].r * 4;
-						(*(texp++)) = pal[c].g * 4;
-						(*(texp++)) = pal[c].b * 4;
-						(*(texp++)) = 255;//not transparent
-						break;
-#if !DXX_USE_OGLES
-					case GL_COLOR_INDEX:
-						(*(texp++)) = c;
-						break;
-#endif
-					default:
-						Error("ogl_filltexbuf unknown texformat\n");
-						break;
-				}
-			}
-		}
-	}
+static void ogl_filltexbuf(const palette_array_t &pal, const uint8_t *const data, GLubyte *texp, const unsigned truewidth, const unsigned width, const unsigned height, const int dxo, const int dyo, const unsigned twidth, const unsigned theight, const int type, const int bm_flags)
+{
+	ogl_check_texture_size(width, height);
+	ogl_expand_palettized(ogl_palette_lut(pal, type, bm_flags), data, texp, truewidth, width, height, dxo, dyo, twidth, theight);
 }
 
 static void tex_set_size1(ogl_texture &tex, const unsigned dbits, const unsigned bits, const unsigned w, const unsigned h)
@@ -1625,12 +2243,7 @@ static void tex_set_size(ogl_texture &tex)
 	tex_set_size1(tex,bi,a,w,h);
 }
 
-//loads a palettized bitmap into a ogl RGBA texture.
-//Sizes and pads dimensions to multiples of 2 if necessary.
-//In theory this could be a problem for repeating textures, but all real
-//textures (not sprites, etc) in descent are 64x64, so we are ok.
-//stores OpenGL textured id in *texid and u/v values required to get only the real data in *u/*v
-static int ogl_loadtexture(const palette_array_t &pal, const uint8_t *data, const int dxo, int dyo, ogl_texture &tex, const int bm_flags, const int data_format, opengl_texture_filter texfilt, const bool texanis, const bool edgepad)
+static void ogl_set_texture_size(ogl_texture &tex)
 {
 	tex.tw = {std::bit_ceil(tex.w)};
 	tex.th = {std::bit_ceil(tex.h)};	//calculate smallest texture size that can accommodate us (must be power of 2)
@@ -1638,122 +2251,101 @@ static int ogl_loadtexture(const palette_array_t &pal, const uint8_t *data, cons
 	//calculate u/v values that would make the resulting texture correctly sized
 	tex.u = static_cast<float>(static_cast<double>(tex.w) / static_cast<double>(tex.tw));
 	tex.v = static_cast<float>(static_cast<double>(tex.h) / static_cast<double>(tex.th));
+}
 
-	auto *bufP = texbuf.get();
-	const uint8_t *outP = texbuf.get();
-	{
-		if (bm_flags >= 0)
-			ogl_filltexbuf (pal, data, texbuf.get(), tex.lw, tex.w, tex.h, dxo, dyo, tex.tw, tex.th,
-								 tex.format, bm_flags, data_format);
-		else {
-			if (!dxo && !dyo && (tex.w == tex.tw) && (tex.h == tex.th))
-				outP = data;
-			else {
-				int h, w, tw;
-
-				h = tex.lw / tex.w;
-				w = (tex.w - dxo) * h;
-				data += tex.lw * dyo + h * dxo;
-				
-				tw = tex.tw * h;
-				h = tw - w;
-				for (; dyo < tex.h; dyo++, data += tex.lw) {
-					memcpy (bufP, data, w);
-					bufP += w;
-					memset (bufP, 0, h);
-					bufP += h;
-				}
-				memset (bufP, 0, tex.th * tw - (bufP - texbuf.get()));
-			}
-		}
-	}
+static bool ogl_texture_needs_edge_pad(const ogl_texture &tex, const opengl_texture_filter texfilt, const bool edgepad)
+{
+	return tex.format == GL_RGBA && texfilt != opengl_texture_filter::classic && edgepad && !CGameArg.OglDarkEdges;
+}
 
-	//bleed color (rgb) into the alpha area, to deal with "dark edges problem"
-	if (tex.format == GL_RGBA && texfilt != opengl_texture_filter::classic && edgepad && !CGameArg.OglDarkEdges)
+//bleed color (rgb) into the alpha area, to deal with "dark edges problem"
+static void ogl_pad_texture_edges(GLubyte *p, const unsigned tw, const unsigned th)
+{
+	GLubyte *pdone = p + (4 * tw * th);
+	int line = 4 * tw;
+	p += 4;
+	pdone -= 4;
+	GLubyte *ptop = p + line;
+	GLubyte *pbottom = pdone - line;
+
+	for (; p < pdone; p += 4)
 	{
-		GLubyte *p = bufP;
-		GLubyte *pdone = p + (4 * tex.tw * tex.th);
-		int line = 4 * tex.tw;
-		p += 4;
-		pdone -= 4;
-		GLubyte *ptop = p + line;
-		GLubyte *pbottom = pdone - line;
-
-		for (; p < pdone; p += 4)
+		//offsets 0 to 2 are r, g, b. offset 3 is alpha. 0x00 is transparent, 0xff is opaque.
+		if (! *(p + 3))
 		{
-			//offsets 0 to 2 are r, g, b. offset 3 is alpha. 0x00 is transparent, 0xff is opaque.
-			if (! *(p + 3))
+			if (*(p - 1))
 			{
-				if (*(p - 1))
+				*p = *(p - 4);
+				*(p + 1) = *(p - 3);
+				*(p + 2) = *(p - 2);
+				continue;
+			} //from left
+			if (*(p + 7))
+			{
+				*p = *(p + 4);
+				*(p + 1) = *(p + 5);
+				*(p + 2) = *(p + 6);
+				continue;
+			} //from right
+			if (p >= ptop)
+			{
+				if (*(p - line + 3))
 				{
-					*p = *(p - 4);
-					*(p + 1) = *(p - 3);
-					*(p + 2) = *(p - 2);
+					*p = *(p - line);
+					*(p + 1) = *(p - line + 1);
+					*(p + 2) = *(p - line + 2);
 					continue;
-				} //from left
-				if (*(p + 7))
+				} //from above
+			}
+			if (p < pbottom)
+			{
+				if (*(p + line + 3))
 				{
-					*p = *(p + 4);
-					*(p + 1) = *(p + 5);
-					*(p + 2) = *(p + 6);
+					*p = *(p + line);
+					*(p + 1) = *(p + line + 1);
+					*(p + 2) = *(p + line + 2);
 					continue;
-				} //from right
-				if (p >= ptop)
+				} //from below
+				if (*(p + line - 1))
 				{
-					if (*(p - line + 3))
-					{
-						*p = *(p - line);
-						*(p + 1) = *(p - line + 1);
-						*(p + 2) = *(p - line + 2);
-						continue;
-					} //from above
-				}
-				if (p < pbottom)
+					*p = *(p + line - 4);
+					*(p + 1) = *(p + line - 3);
+					*(p + 2) = *(p + line - 2);
+					continue;
+				} //bottom left
+				if (*(p + line + 7))
 				{
-					if (*(p + line + 3))
-					{
-						*p = *(p + line);
-						*(p + 1) = *(p + line + 1);
-						*(p + 2) = *(p + line + 2);
-						continue;
-					} //from below
-					if (*(p + line - 1))
-					{
-						*p = *(p + line - 4);
-						*(p + 1) = *(p + line - 3);
-						*(p + 2) = *(p + line - 2);
-						continue;
-					} //bottom left
-					if (*(p + line + 7))
-					{
-						*p = *(p + line + 4);
-						*(p + 1) = *(p + line + 5);
-						*(p + 2) = *(p + line + 6);
-						continue;
-					} //bottom right
-				}
-				if (p >= ptop)
+					*p = *(p + line + 4);
+					*(p + 1) = *(p + line + 5);
+					*(p + 2) = *(p + line + 6);
+					continue;
+				} //bottom right
+			}
+			if (p >= ptop)
+			{
+				if (*(p - line - 1))
 				{
-					if (*(p - line - 1))
-					{
-						*p = *(p - line - 4);
-						*(p + 1) = *(p - line - 3);
-						*(p + 2) = *(p - line - 2);
-						continue;
-					} //top left
-					if (*(p - line + 7))
-					{
-						*p = *(p - line + 4);
-						*(p + 1) = *(p - line + 5);
-						*(p + 2) = *(p - line + 6);
-						continue;
-					} //top right
-				}
+					*p = *(p - line - 4);
+					*(p + 1) = *(p - line - 3);
+					*(p + 2) = *(p - line - 2);
+					continue;
+				} //top left
+				if (*(p - line + 7))
+				{
+					*p = *(p - line + 4);
+					*(p + 1) = *(p - line + 5);
+					*(p + 2) = *(p - line + 6);
+					continue;
+				} //top right
 			}
 		}
 	}
+}
 
-	int rescale{1};
+//pick the upscale factor for texfilt, and the filter to use after scaling
+static opengl_texture_filter ogl_texture_rescale(const ogl_texture &tex, opengl_texture_filter texfilt, int &rescale)
+{
+	rescale = 1;
 	if (texfilt == opengl_texture_filter::upscale)
 	{
 		rescale = 4;
@@ -1766,53 +2358,45 @@ static int ogl_loadtexture(const palette_array_t &pal, const uint8_t *data, cons
 			rescale = 1;
 		}
 	}
-	std::unique_ptr<GLubyte[]> buftemp;
-	if (rescale > 1)
+	return texfilt;
+}
+
+static std::unique_ptr<GLubyte[]> ogl_upscale_texture(const ogl_texture &tex, const GLubyte *outP, const int rescale)
+{
+	int rebpp{3};
+	if (tex.format == GL_RGBA) rebpp = 4;
+	if (tex.format == GL_LUMINANCE) rebpp = 1;
+	auto buftemp = std::make_unique<GLubyte[]>(rescale * tex.tw * rescale * tex.th * rebpp);
+	int x,y;
+	GLubyte *p = buftemp.get();
+	int len = tex.tw*rebpp*rescale;
+	int bppscale = (rebpp*rescale);
+
+	for (y = 0; y < tex.th; y++)
 	{
-		int rebpp{3};
-		if (tex.format == GL_RGBA) rebpp = 4;
-		if (tex.format == GL_LUMINANCE) rebpp = 1;
-		buftemp = std::make_unique<GLubyte[]>(rescale * tex.tw * rescale * tex.th * rebpp);
-		int x,y;
-		GLubyte *p = buftemp.get();
-		int len = tex.tw*rebpp*rescale;
-		int bppscale = (rebpp*rescale);
+		GLubyte	*p1;
 
-		for (y = 0; y < tex.th; y++)
+		for (x = 0; x < len; x++)
 		{
-			GLubyte	*p1 = bufP;
-
-			for (x = 0; x < len; x++)
-			{
-				*(p+x) = *(outP + ((x / bppscale)*rebpp + (x % rebpp)));
-			}
-			p1 = p;
+			*(p+x) = *(outP + ((x / bppscale)*rebpp + (x % rebpp)));
+		}
+		p1 = p;
+		p += len;
+		int y2;
+		for (y2 = 1; y2 < rescale; y2++)
+		{
+			memcpy (p, p1, len);
 			p += len;
-			int y2;
-			for (y2 = 1; y2 < rescale; y2++)
-			{
-				memcpy (p, p1, len);
-				p += len;
-			}
-			outP += tex.tw*rebpp;
 		}
-		outP = buftemp.get();
+		outP += tex.tw*rebpp;
 	}
+	return buftemp;
+}
 
-	// Generate OpenGL texture IDs.
-	glGenTextures (1, &tex.handle);
-#if !DXX_USE_OGLES
-	//set priority
-	glPrioritizeTextures (1, &tex.handle, &tex.prio);
-#endif
-	// Give our data to OpenGL.
-	OGL_BINDTEXTURE(tex.handle);
-	glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-
-	// should match structue in menu.cpp
-	// organized in switches for better readability
-	bool buildmipmap = false;
-	GLint gl_mag_filter_int, gl_min_filter_int;
+// should match structue in menu.cpp
+// organized in switches for better readability
+static bool ogl_texture_filter_params(const opengl_texture_filter texfilt, const bool texanis, GLint &gl_mag_filter_int, GLint &gl_min_filter_int)
+{
 	switch (texfilt)
 	{
 		default:
@@ -1822,21 +2406,35 @@ static int ogl_loadtexture(const palette_array_t &pal, const uint8_t *data, cons
 			{
 				// looks nicer if anisotropy is applied.
 				gl_min_filter_int = GL_NEAREST_MIPMAP_LINEAR;
-				buildmipmap = true;
+				return true;
 			}
-			else
-			{
-				gl_min_filter_int = GL_NEAREST;
-				buildmipmap = false;
-			}
-			break;
+			gl_min_filter_int = GL_NEAREST;
+			return false;
 		case opengl_texture_filter::upscale: // Upscaled - i.e. Blocky Filtered (Bilinear)
 		case opengl_texture_filter::trilinear: // Smooth - Trilinear
 			gl_mag_filter_int = GL_LINEAR;
 			gl_min_filter_int = GL_LINEAR_MIPMAP_LINEAR;
-			buildmipmap = true;
-			break;
+			return true;
 	}
+}
+
+//gives the prepared texels to OpenGL.  If mips is not empty, it holds
+//every mip level after the first, so GLU need not build them here.
+static void ogl_upload_texture(ogl_texture &tex, const GLubyte *const outP, const int rescale, const opengl_texture_filter texfilt, const bool texanis, const std::vector<std::vector<GLubyte>> &mips)
+{
+	// Generate OpenGL texture IDs.
+	if (!tex.handle)
+		glGenTextures (1, &tex.handle);
+#if !DXX_USE_OGLES
+	//set priority
+	glPrioritizeTextures (1, &tex.handle, &tex.prio);
+#endif
+	// Give our data to OpenGL.
+	ogl_bind_texture(tex.handle);
+	glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	GLint gl_mag_filter_int, gl_min_filter_int;
+	const bool buildmipmap = ogl_texture_filter_params(texfilt, texanis, gl_mag_filter_int, gl_min_filter_int);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl_mag_filter_int);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl_min_filter_int);
 	if (texanis && ogl_maxanisotropy > 1.0f)
@@ -1845,7 +2443,7 @@ static int ogl_loadtexture(const palette_array_t &pal, const uint8_t *data, cons
 #if DXX_USE_OGLES // in OpenGL ES 1.1 the mipmaps are automatically generated by a parameter
 	glTexParameteri (GL_TEXTURE_2D, GL_GENERATE_MIPMAP, buildmipmap ? GL_TRUE : GL_FALSE);
 #else
-	if (buildmipmap)
+	if (buildmipmap && mips.empty())
 	{
 		gluBuild2DMipmaps (
 				GL_TEXTURE_2D, tex.internalformat, 
@@ -1861,13 +2459,338 @@ static int ogl_loadtexture(const palette_array_t &pal, const uint8_t *data, cons
 			tex.tw * rescale, tex.th * rescale, 0, tex.format, // RGBA textures.
 			GL_UNSIGNED_BYTE, // imageData is a GLubyte pointer.
 			outP);
+#if !DXX_USE_OGLES
+		if (buildmipmap)
+		{
+			GLsizei w = tex.tw * rescale, h = tex.th * rescale;
+			for (GLint level = 1; const auto &m : mips)
+			{
+				w = max(w / 2, 1);
+				h = max(h / 2, 1);
+				glTexImage2D(GL_TEXTURE_2D, level++, tex.internalformat, w, h, 0, tex.format, GL_UNSIGNED_BYTE, m.data());
+			}
+		}
+#endif
 	}
 
 	tex_set_size(tex);
 	r_texcount++;
+}
+
+//gives the block compressed levels from e to OpenGL
+static void ogl_upload_compressed_texture(ogl_texture &tex, const ogl_texture_cache::entry &e, const opengl_texture_filter texfilt, const bool texanis)
+{
+	if (!tex.handle)
+		glGenTextures (1, &tex.handle);
+#if !DXX_USE_OGLES
+	glPrioritizeTextures (1, &tex.handle, &tex.prio);
+#endif
+	ogl_bind_texture(tex.handle);
+	glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	GLint gl_mag_filter_int, gl_min_filter_int;
+	ogl_texture_filter_params(texfilt, texanis, gl_mag_filter_int, gl_min_filter_int);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl_mag_filter_int);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl_min_filter_int);
+	if (texanis && ogl_maxanisotropy > 1.0f)
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, ogl_maxanisotropy);
+#if DXX_USE_OGLES
+	//compressed textures cannot generate their own mip levels
+	glTexParameteri (GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_FALSE);
+#endif
+	GLsizei w = e.w, h = e.h;
+	int bytes = 0;
+	for (GLint level = 0; const auto &l : e.levels)
+	{
+		glCompressedTexImage2DFunc(GL_TEXTURE_2D, level++, ogl_compressed_rgb_format, w, h, 0, l.size(), l.data());
+		bytes += l.size();
+		w = max(w / 2, 1);
+		h = max(h / 2, 1);
+	}
+	tex.bytes = tex.bytesu = bytes;
+	r_texcount++;
+}
+
+//loads a palettized bitmap into a ogl RGBA texture.
+//Sizes and pads dimensions to multiples of 2 if necessary.
+//In theory this could be a problem for repeating textures, but all real
+//textures (not sprites, etc) in descent are 64x64, so we are ok.
+//stores OpenGL textured id in *texid and u/v values required to get only the real data in *u/*v
+static int ogl_loadtexture(const palette_array_t &pal, const uint8_t *data, const int dxo, int dyo, ogl_texture &tex, const int bm_flags, opengl_texture_filter texfilt, const bool texanis, const bool edgepad)
+{
+	/* A batched draw may sample the texture that is about to be replaced */
+	ogl_stream.flush();
+	ogl_set_texture_size(tex);
+
+	auto *bufP = texbuf.get();
+	const uint8_t *outP = texbuf.get();
+	{
+		if (bm_flags >= 0)
+			ogl_filltexbuf (pal, data, texbuf.get(), tex.lw, tex.w, tex.h, dxo, dyo, tex.tw, tex.th,
+								 tex.format, bm_flags);
+		else {
+			if (!dxo && !dyo && (tex.w == tex.tw) && (tex.h == tex.th))
+				outP = data;
+			else {
+				int h, w, tw;
+
+				h = tex.lw / tex.w;
+				w = (tex.w - dxo) * h;
+				data += tex.lw * dyo + h * dxo;
+				
+				tw = tex.tw * h;
+				h = tw - w;
+				for (; dyo < tex.h; dyo++, data += tex.lw) {
+					memcpy (bufP, data, w);
+					bufP += w;
+					memset (bufP, 0, h);
+					bufP += h;
+				}
+				memset (bufP, 0, tex.th * tw - (bufP - texbuf.get()));
+			}
+		}
+	}
+
+	if (ogl_texture_needs_edge_pad(tex, texfilt, edgepad))
+		ogl_pad_texture_edges(bufP, tex.tw, tex.th);
+
+	int rescale;
+	texfilt = ogl_texture_rescale(tex, texfilt, rescale);
+	std::unique_ptr<GLubyte[]> buftemp;
+	if (rescale > 1)
+	{
+		buftemp = ogl_upscale_texture(tex, outP, rescale);
+		outP = buftemp.get();
+	}
+	ogl_upload_texture(tex, outP, rescale, texfilt, texanis, {});
+	tex.cache_key = 0;
 	return 0;
 }
 
+/*
+ * While ogl_cache_level_textures runs, bitmap textures are queued instead
+ * of loaded.  The queue is converted to texels, upscaled and mip-mapped on
+ * worker threads, and only the glTexImage2D calls are left for this
+ * thread.  A queued entry already has its GL name, so that a bitmap seen
+ * twice is queued once.
+ *
+ * With -gl_texcache, opaque textures are instead block compressed on the
+ * workers, or read back compressed from the cache file if an earlier run
+ * already did so.
+ */
+namespace {
+
+struct ogl_texture_job
+{
+	ogl_texture *tex;
+	/* A copy of the palette indices, since paging in or merging a later
+	 * bitmap may reuse the buffer that holds this one
+	 */
+	std::vector<uint8_t> pixels;
+	ogl_palette_lut lut;
+	opengl_texture_filter texfilt;
+	bool texanis, edgepad;
+	int rescale;
+	std::vector<GLubyte> texels;
+	std::unique_ptr<GLubyte[]> upscaled;
+	std::vector<std::vector<GLubyte>> mips;
+	/* Nonzero if the texture is block compressed */
+	uint64_t cache_key;
+	bool cached;
+	ogl_texture_cache::entry compressed;
+};
+
+}
+
+static std::vector<ogl_texture_job> ogl_texture_jobs;
+static bool ogl_texture_batching;
+
+static ogl_block_format ogl_compressed_block_format()
+{
+	return ogl_compressed_rgb_format == GL_ETC1_RGB8_OES ? ogl_block_format::etc1 : ogl_block_format::bc1;
+}
+
+/* Everything that goes into the compressed levels, or 0 if the texture is
+ * not to be compressed.  Textures with alpha are not, since the block
+ * formats used here have none.
+ */
+static uint64_t ogl_texture_cache_key(const ogl_texture &tex, const uint8_t *const data, const int bm_flags, const opengl_texture_filter texfilt, const bool texanis, const bool edgepad)
+{
+	if (!CGameArg.OglTextureCache || !ogl_compressed_rgb_format || tex.format != GL_RGB)
+		return 0;
+	const std::array<uint32_t, 8> params{{
+		static_cast<uint32_t>(tex.lw), tex.w, tex.h, static_cast<uint32_t>(bm_flags), static_cast<uint32_t>(texfilt),
+		texanis && ogl_maxanisotropy > 1.0f, edgepad, static_cast<uint32_t>(ogl_compressed_block_format()),
+	}};
+	auto h = ogl_texture_cache_hash({data, std::size_t{static_cast<unsigned>(tex.lw)} * tex.h});
+	h = ogl_texture_cache_hash({reinterpret_cast<const uint8_t *>(gr_palette.data()), sizeof(gr_palette)}, h);
+	h = ogl_texture_cache_hash({reinterpret_cast<const uint8_t *>(params.data()), sizeof(params)}, h);
+	/* 0 means uncompressed */
+	return h ? h : 1;
+}
+
+static void ogl_queue_texture(ogl_texture &tex, const uint8_t *const data, const int bm_flags, const opengl_texture_filter texfilt, const bool texanis, const bool edgepad)
+{
+	ogl_check_texture_size(tex.w, tex.h);
+	ogl_set_texture_size(tex);
+	glGenTextures(1, &tex.handle);
+	ogl_texture_jobs.push_back({
+		.tex = &tex,
+		.pixels = std::vector<uint8_t>(data, data + std::size_t{static_cast<unsigned>(tex.lw)} * tex.h),
+		.lut = ogl_palette_lut(gr_palette, tex.format, bm_flags),
+		.texfilt = texfilt,
+		.texanis = texanis,
+		.edgepad = edgepad,
+		.rescale = 1,
+		.texels = {},
+		.upscaled = {},
+		.mips = {},
+		.cache_key = ogl_texture_cache_key(tex, data, bm_flags, texfilt, texanis, edgepad),
+		.cached = false,
+		.compressed = {},
+	});
+}
+
+/* Runs on a worker thread, so it must not touch GL */
+static void ogl_prepare_texture(ogl_texture_job &job)
+{
+	const auto &tex = *job.tex;
+	const unsigned bpt = job.lut.bytes_per_texel();
+	job.texels.resize(std::size_t{tex.tw} * tex.th * bpt);
+	ogl_expand_palettized(job.lut, job.pixels.data(), job.texels.data(), tex.lw, tex.w, tex.h, 0, 0, tex.tw, tex.th);
+	if (ogl_texture_needs_edge_pad(tex, job.texfilt, job.edgepad))
+		ogl_pad_texture_edges(job.texels.data(), tex.tw, tex.th);
+	job.texfilt = ogl_texture_rescale(tex, job.texfilt, job.rescale);
+	const GLubyte *outP = job.texels.data();
+	if (job.rescale > 1)
+		outP = (job.upscaled = ogl_upscale_texture(tex, outP, job.rescale)).get();
+	GLint mag, min;
+	const bool buildmipmap = ogl_texture_filter_params(job.texfilt, job.texanis, mag, min);
+	const unsigned w = tex.tw * job.rescale, h = tex.th * job.rescale;
+	if (job.cache_key)
+	{
+		/* Compressed textures carry all their levels, on OpenGL ES too */
+		if (buildmipmap)
+			ogl_build_mipmaps(outP, w, h, bpt, job.mips);
+		auto &e = job.compressed;
+		e.format = ogl_compressed_block_format();
+		e.w = w;
+		e.h = h;
+		ogl_compress_rgb(e.format, outP, w, h, e.levels.emplace_back());
+		for (unsigned mw = w, mh = h; const auto &m : job.mips)
+		{
+			mw = std::max(mw / 2, 1u);
+			mh = std::max(mh / 2, 1u);
+			ogl_compress_rgb(e.format, m.data(), mw, mh, e.levels.emplace_back());
+		}
+		job.texels = {};
+		job.upscaled.reset();
+		job.mips = {};
+		return;
+	}
+#if !DXX_USE_OGLES
+	if (buildmipmap)
+		ogl_build_mipmaps(outP, w, h, bpt, job.mips);
+#endif
+}
+
+static void ogl_begin_texture_batch()
+{
+	ogl_texture_batching = true;
+}
+
+static void ogl_end_texture_batch()
+{
+	ogl_texture_batching = false;
+	for (auto &job : ogl_texture_jobs)
+		if (job.tex && job.cache_key)
+		{
+			job.cached = ogl_level_texture_cache.load(job.cache_key, job.compressed) && job.compressed.format == ogl_compressed_block_format();
+			if (!job.cached)
+				job.compressed = {};
+			else
+				/* upscaling picks its own filter */
+				job.texfilt = ogl_texture_rescale(*job.tex, job.texfilt, job.rescale);
+		}
+	ogl_parallel_for(ogl_texture_jobs.size(), [](const std::size_t i) {
+		auto &job = ogl_texture_jobs[i];
+		if (job.tex && !job.cached)
+			ogl_prepare_texture(job);
+	});
+	ogl_stream.flush();
+	for (auto &job : ogl_texture_jobs)
+	{
+		if (!job.tex)
+			continue;
+		if (job.cache_key)
+		{
+			ogl_upload_compressed_texture(*job.tex, job.compressed, job.texfilt, job.texanis);
+			job.tex->cache_texfilt = job.texfilt;
+			job.tex->cache_texanis = job.texanis;
+			if (!job.cached)
+				ogl_level_texture_cache.store(job.cache_key, std::move(job.compressed));
+		}
+		else
+			ogl_upload_texture(*job.tex, job.upscaled ? job.upscaled.get() : job.texels.data(), job.rescale, job.texfilt, job.texanis, job.mips);
+		job.tex->cache_key = job.cache_key;
+		ogl_textures.note_loaded(*job.tex, job.tex->bytes, true);
+	}
+	ogl_texture_jobs.clear();
+	ogl_level_texture_cache.flush();
+}
+
+/* The bitmap went away before its texture was uploaded */
+static void ogl_cancel_texture_job(const ogl_texture &tex)
+{
+	for (auto &job : ogl_texture_jobs)
+		if (job.tex == &tex)
+			job.tex = nullptr;
+}
+
+void ogl_lose_context_internal()
+{
+	/* Deleting the names of the lost context does nothing in the new
+	 * one, since it has made none yet, so the usual teardown is safe.
+	 */
+	ogl_screen_reads.clear();
+	ogl_stream.close();
+	ogl_texture_restores.clear();
+	for (auto &i : ogl_textures)
+		if (i.handle > 0 && i.cache_key)
+			ogl_texture_restores.push_back({&i, i.cache_key});
+	std::ranges::sort(ogl_texture_restores, std::ranges::greater{}, [](const ogl_texture_restore &r) { return r.tex->last_used_frame; });
+	ogl_smash_texture_list_internal();
+	if (!ogl_texture_restores.empty())
+		con_printf(CON_VERBOSE, "DXX-Rebirth: OpenGL: context lost, restoring %zu textures from the texture cache", ogl_texture_restores.size());
+}
+
+void ogl_restore_textures_internal()
+{
+	if (ogl_texture_restores.empty())
+		return;
+	const auto start{timer_query()};
+	auto i{ogl_texture_restores.begin()};
+	const auto e{ogl_texture_restores.end()};
+	for (; i != e && timer_query() - start < ogl_texture_restore_budget; ++i)
+	{
+		auto &tex = *i->tex;
+		/* Drawn since, and so loaded from its bitmap, or freed */
+		if (tex.handle || !tex.pool_in_use || tex.cache_key != i->cache_key)
+			continue;
+		ogl_texture_cache::entry entry;
+		if (!ogl_level_texture_cache.load(i->cache_key, entry) || entry.format != ogl_compressed_block_format())
+		{
+			/* Loaded from its bitmap when next drawn */
+			tex.cache_key = 0;
+			continue;
+		}
+		ogl_stream.flush();
+		ogl_upload_compressed_texture(tex, entry, tex.cache_texfilt, tex.cache_texanis);
+		ogl_textures.note_loaded(tex, tex.bytes, true);
+	}
+	ogl_texture_restores.erase(ogl_texture_restores.begin(), i);
+}
+
 void ogl_loadbmtexture_f(grs_bitmap &rbm, const opengl_texture_filter texfilt, bool texanis, bool edgepad)
 {
 	assert(!rbm.get_flag_mask(BM_FLAG_PAGED_OUT));
@@ -1924,24 +2847,51 @@ void ogl_loadbmtexture_f(grs_bitmap &rbm, const opengl_texture_filter texfilt, b
 			con_printf(CON_URGENT, "error: insufficient space to decode %ux%hu bitmap.  Please report this as a bug.", bm_w, bm->bm_h);
 		}
 	}
-	ogl_loadtexture(gr_palette, buf, 0, 0, *bm->gltexture, bm->get_flags(), 0, texfilt, texanis, edgepad);
+	if (ogl_texture_batching)
+	{
+		ogl_queue_texture(*bm->gltexture, buf, bm->get_flags(), texfilt, texanis, edgepad);
+		return;
+	}
+	ogl_loadtexture(gr_palette, buf, 0, 0, *bm->gltexture, bm->get_flags(), texfilt, texanis, edgepad);
+	ogl_textures.note_loaded(*bm->gltexture, bm->gltexture->bytes, true);
+}
+
+static void ogl_deletetexture(ogl_texture &gltexture)
+{
+	r_texcount--;
+	glmprintf((CON_DEBUG, "ogl_freetexture(%p):%i (%i left)", &gltexture, gltexture.handle, r_texcount));
+	ogl_retire_texture_name(gltexture.handle);
 }
 
 static void ogl_freetexture(ogl_texture &gltexture)
 {
 	if (gltexture.handle>0) {
-		r_texcount--;
-		glmprintf((CON_DEBUG, "ogl_freetexture(%p):%i (%i left)", &gltexture, gltexture.handle, r_texcount));
-		glDeleteTextures( 1, &gltexture.handle );
+		ogl_deletetexture(gltexture);
 //		gltexture->handle=0;
 		ogl_reset_texture(gltexture);
 	}
 }
 
+/* Delete the GL texture of a pool entry, leaving its size, so that the
+ * bitmap loads it again on next use
+ */
+static void ogl_unloadtexture(ogl_texture &gltexture)
+{
+	ogl_deletetexture(gltexture);
+	gltexture.handle = 0;
+	gltexture.wrapstate = -1;
+	ogl_textures.note_unloaded(gltexture);
+}
+
 void ogl_freebmtexture(grs_bitmap &bm)
 {
 	if (auto &gltexture = bm.gltexture)
-		ogl_freetexture(*std::exchange(gltexture, nullptr));
+	{
+		auto &t = *std::exchange(gltexture, nullptr);
+		ogl_cancel_texture_job(t);
+		ogl_freetexture(t);
+		ogl_textures.release(t);
+	}
 }
 
 const ogl_colors::array_type ogl_colors::white = {{
@@ -1975,14 +2925,49 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, int x, int y,int dw, int dh, grs_bitmap
 	return ogl_ubitmapm_cs(canvas, x, y, dw, dh, bm, color.init(c), true);
 }
 
+namespace {
+
+struct ogl_bitmap_texcoords
+{
+	GLfloat u1, u2, v1, v2;
+};
+
+/* The part of its texture that a bitmap, which may be a sub bitmap,
+ * covers.  The texture must be loaded.
+ */
+static ogl_bitmap_texcoords ogl_get_bitmap_texcoords(const grs_bitmap &bm)
+{
+	GLfloat u1,u2,v1,v2;
+	if (bm.bm_x==0){
+		u1=0;
+		if (bm.bm_w==bm.gltexture->w)
+			u2=bm.gltexture->u;
+		else
+			u2=(bm.bm_w+bm.bm_x)/static_cast<float>(bm.gltexture->tw);
+	}else {
+		u1=bm.bm_x/static_cast<float>(bm.gltexture->tw);
+		u2=(bm.bm_w+bm.bm_x)/static_cast<float>(bm.gltexture->tw);
+	}
+	if (bm.bm_y==0){
+		v1=0;
+		if (bm.bm_h==bm.gltexture->h)
+			v2=bm.gltexture->v;
+		else
+			v2=(bm.bm_h+bm.bm_y)/static_cast<float>(bm.gltexture->th);
+	}else{
+		v1=bm.bm_y/static_cast<float>(bm.gltexture->th);
+		v2=(bm.bm_h+bm.bm_y)/static_cast<float>(bm.gltexture->th);
+	}
+	return {u1, u2, v1, v2};
+}
+
+}
+
 /*
  * Menu / gauges 
  */
 bool ogl_ubitmapm_cs(grs_canvas &canvas, const int entry_x, const int entry_y, const int entry_dw, const int entry_dh, grs_bitmap &bm, const ogl_colors::array_type &color_array)
 {
-	GLfloat u1,u2,v1,v2;
-	ogl_client_states<GLfloat, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY> cs;
-	auto &xo = std::get<0>(cs);
 	const int adjusted_canvas_x = entry_x + canvas.cv_bitmap.bm_x;
 	const int adjusted_canvas_y = entry_y + canvas.cv_bitmap.bm_y;
 
@@ -1997,7 +2982,7 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, const int entry_x, const int entry_y, c
 			? bm.bm_h
 			: entry_dh);
 
-	xo = adjusted_canvas_x / (static_cast<double>(last_width));
+	const GLfloat xo = adjusted_canvas_x / (static_cast<double>(last_width));
 	const GLfloat xf = (effective_dw + adjusted_canvas_x) / (static_cast<double>(last_width));
 	const GLfloat yo = 1.0 - adjusted_canvas_y / (static_cast<double>(last_height));
 	const GLfloat yf = 1.0 - (effective_dh + adjusted_canvas_y) / (static_cast<double>(last_height));
@@ -2005,27 +2990,7 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, const int entry_x, const int entry_y, c
 	OGL_ENABLE(TEXTURE_2D);
 	ogl_bindbmtex(bm, 0);
 	ogl_texwrap(bm.gltexture,GL_CLAMP_TO_EDGE);
-	
-	if (bm.bm_x==0){
-		u1=0;
-		if (bm.bm_w==bm.gltexture->w)
-			u2=bm.gltexture->u;
-		else
-			u2=(bm.bm_w+bm.bm_x)/static_cast<float>(bm.gltexture->tw);
-	}else {
-		u1=bm.bm_x/static_cast<float>(bm.gltexture->tw);
-		u2=(bm.bm_w+bm.bm_x)/static_cast<float>(bm.gltexture->tw);
-	}
-	if (bm.bm_y==0){
-		v1=0;
-		if (bm.bm_h==bm.gltexture->h)
-			v2=bm.gltexture->v;
-		else
-			v2=(bm.bm_h+bm.bm_y)/static_cast<float>(bm.gltexture->th);
-	}else{
-		v1=bm.bm_y/static_cast<float>(bm.gltexture->th);
-		v2=(bm.bm_h+bm.bm_y)/static_cast<float>(bm.gltexture->th);
-	}
+	const auto [u1, u2, v1, v2]{ogl_get_bitmap_texcoords(bm)};
 
 	const std::array<GLfloat, 8> vertices{{
 		xo, yo,
@@ -2039,6 +3004,15 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, const int entry_x, const int entry_y, c
 		u2, v2,
 		u1, v2,
 	}};
+	if (ogl_stream.active())
+	{
+		std::array<ogl_stream_vertex, 4> fan;
+		for (std::size_t i = 0; i != fan.size(); ++i)
+			fan[i] = {{{vertices[i * 2], vertices[i * 2 + 1], 0}}, {{color_array[i * 4], color_array[i * 4 + 1], color_array[i * 4 + 2], color_array[i * 4 + 3]}}, {{texcoord_array[i * 2], texcoord_array[i * 2 + 1]}}};
+		if (ogl_stream.draw_fan(bm.gltexture->handle, fan))
+			return 0;
+	}
+	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY> cs;
 	glVertexPointer(2, GL_FLOAT, 0, vertices.data());
 	glColorPointer(4, GL_FLOAT, 0, color_array.data());
 	glTexCoordPointer(2, GL_FLOAT, 0, texcoord_array.data());
@@ -2046,6 +3020,156 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, const int entry_x, const int entry_y, c
 	return 0;
 }
 
+void ogl_ubitmapm_glyphs(grs_canvas &canvas, const std::span<const ogl_glyph_quad> glyphs)
+{
+	if (glyphs.empty())
+		return;
+	auto &first_bm{*glyphs.front().bm};
+	OGL_ENABLE(TEXTURE_2D);
+	ogl_bindbmtex(first_bm, 0);
+	ogl_texwrap(first_bm.gltexture, GL_CLAMP_TO_EDGE);
+	const GLuint texture{first_bm.gltexture->handle};
+	const double width{static_cast<double>(last_width)}, height{static_cast<double>(last_height)};
+	/* Two triangles per character, since separate fans cannot share a
+	 * draw.  The buffers are kept to avoid allocating for every string.
+	 */
+	static std::vector<ogl_stream_vertex> triangles;
+	triangles.clear();
+	triangles.reserve(glyphs.size() * 6);
+	for (auto &g : glyphs)
+	{
+		const int x{g.x + canvas.cv_bitmap.bm_x};
+		const int y{g.y + canvas.cv_bitmap.bm_y};
+		const GLfloat xo = x / width;
+		const GLfloat xf = (g.w + x) / width;
+		const GLfloat yo = 1.0 - y / height;
+		const GLfloat yf = 1.0 - (g.h + y) / height;
+		const auto [u1, u2, v1, v2]{ogl_get_bitmap_texcoords(*g.bm)};
+		const ogl_stream_vertex a{{{xo, yo, 0}}, g.color, {{u1, v1}}};
+		const ogl_stream_vertex b{{{xf, yo, 0}}, g.color, {{u2, v1}}};
+		const ogl_stream_vertex c{{{xf, yf, 0}}, g.color, {{u2, v2}}};
+		const ogl_stream_vertex d{{{xo, yf, 0}}, g.color, {{u1, v2}}};
+		if (ogl_stream.active() && ogl_stream.draw_fan(texture, std::array{a, b, c, d}))
+			continue;
+		triangles.insert(triangles.end(), {a, b, c, a, c, d});
+	}
+	if (triangles.empty())
+		return;
+	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY> cs;
+	glVertexPointer(3, GL_FLOAT, sizeof(ogl_stream_vertex), triangles.front().position.data());
+	glColorPointer(4, GL_FLOAT, sizeof(ogl_stream_vertex), triangles.front().color.data());
+	glTexCoordPointer(2, GL_FLOAT, sizeof(ogl_stream_vertex), triangles.front().texcoord.data());
+	glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(triangles.size()));
+}
+
+/* Copy a rectangle of the screen into `r`, sampled with `filter` when it
+ * is drawn back
+ */
+static void ogl_retain_region(ogl_retained_region &r, const int x, const int y, const int w, const int h, const GLint filter)
+{
+	const unsigned tw{std::bit_ceil(static_cast<unsigned>(w))}, th{std::bit_ceil(static_cast<unsigned>(h))};
+	ogl_stream.flush();
+	/* The last copy may still be drawn from, so copy into a new texture
+	 * instead of waiting for the GPU to finish with the old one.
+	 */
+	if (!r.handle || r.tw != tw || r.th != th || ogl_have_ARB_sync)
+	{
+		ogl_discard_region(r);
+		glGenTextures(1, &r.handle);
+		ogl_bind_texture(r.handle);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, ogl_rgb_internalformat, tw, th, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+		r.tw = tw;
+		r.th = th;
+	}
+	else
+		ogl_bind_texture(r.handle);
+	/* GL counts rows from the bottom of the window */
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, x, last_height - y - h, w, h);
+	r.x = x;
+	r.y = y;
+	r.w = w;
+	r.h = h;
+}
+
+/* Draw the copy in `r` stretched over a rectangle of the screen */
+static void ogl_draw_region(const ogl_retained_region &r, const int x, const int y, const int w, const int h)
+{
+	const GLfloat xo = x / static_cast<double>(last_width);
+	const GLfloat xf = (x + w) / static_cast<double>(last_width);
+	const GLfloat yo = 1.0 - y / static_cast<double>(last_height);
+	const GLfloat yf = 1.0 - (y + h) / static_cast<double>(last_height);
+	/* The copy is stored bottom row first */
+	const GLfloat u = r.w / static_cast<float>(r.tw);
+	const GLfloat v = r.h / static_cast<float>(r.th);
+	const std::array<ogl_stream_vertex, 4> fan{{
+		{{{xo, yo, 0}}, {{1, 1, 1, 1}}, {{0, v}}},
+		{{{xf, yo, 0}}, {{1, 1, 1, 1}}, {{u, v}}},
+		{{{xf, yf, 0}}, {{1, 1, 1, 1}}, {{u, 0}}},
+		{{{xo, yf, 0}}, {{1, 1, 1, 1}}, {{0, 0}}},
+	}};
+	OGL_ENABLE(TEXTURE_2D);
+	ogl_bind_texture(r.handle);
+	if (ogl_stream.active() && ogl_stream.draw_fan(r.handle, fan))
+		return;
+	ogl_client_states<int, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY> cs;
+	glVertexPointer(3, GL_FLOAT, sizeof(ogl_stream_vertex), fan.front().position.data());
+	glColorPointer(4, GL_FLOAT, sizeof(ogl_stream_vertex), fan.front().color.data());
+	glTexCoordPointer(2, GL_FLOAT, sizeof(ogl_stream_vertex), fan.front().texcoord.data());
+	glDrawArrays(GL_TRIANGLE_FAN, 0, fan.size());
+}
+
+static void ogl_discard_region(ogl_retained_region &r)
+{
+	if (!r.handle)
+		return;
+	ogl_retire_texture_name(r.handle);
+	r = {};
+}
+
+void ogl_retain_screen_region(const int x, const int y, const int w, const int h)
+{
+	ogl_retain_region(ogl_retained, x, y, w, h, GL_NEAREST);
+}
+
+bool ogl_draw_screen_region(const int x, const int y, const int w, const int h)
+{
+	auto &r = ogl_retained;
+	if (!r.handle || r.x != x || r.y != y || r.w != w || r.h != h)
+		return false;
+	ogl_draw_region(r, x, y, w, h);
+	return true;
+}
+
+void ogl_discard_screen_region()
+{
+	ogl_discard_region(ogl_retained);
+}
+
+void ogl_retain_view_region(const unsigned view, const int x, const int y, const int w, const int h)
+{
+	/* The copy is usually drawn larger than it was taken */
+	ogl_retain_region(ogl_retained_views[view], x, y, w, h, GL_LINEAR);
+}
+
+bool ogl_draw_view_region(const unsigned view, const int x, const int y, const int w, const int h)
+{
+	auto &r = ogl_retained_views[view];
+	if (!r.handle)
+		return false;
+	ogl_draw_region(r, x, y, w, h);
+	return true;
+}
+
+void ogl_discard_view_regions()
+{
+	for (auto &r : ogl_retained_views)
+		ogl_discard_region(r);
+}
+
 bool ogl_ubitmapm_cs(grs_canvas &canvas, int x0, int y0, int dw, int dh, grs_bitmap &bm, const ogl_colors::array_type &color_array, bool fill)
 {
 #if DXX_USE_STEREOSCOPIC_RENDER
@@ -2062,7 +3186,10 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, int x0, int y0, int dw, int dh, grs_bit
 		}
 #if !DXX_USE_OGLES
 		if (VR_stereo == StereoFormat::QuadBuffers)
+		{
+			ogl_stream.flush();
 			glDrawBuffer(GL_BACK_LEFT);
+		}
 #endif
 		ogl_ubitmapm_cs(canvas, x, y, w, h, bm, color_array);
 		const auto &&[vx, vy]{gr_build_stereo_viewport_offset_right_eye(VR_stereo, x, y, 1)};
@@ -2070,7 +3197,10 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, int x0, int y0, int dw, int dh, grs_bit
 		y = vy;
 #if !DXX_USE_OGLES
 		if (VR_stereo == StereoFormat::QuadBuffers)
+		{
+			ogl_stream.flush();
 			glDrawBuffer(GL_BACK_RIGHT);
+		}
 #endif
 		ogl_ubitmapm_cs(canvas, x, y, w, h, bm, color_array);
 		return 0;
@@ -2084,6 +3214,7 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, int x0, int y0, int dw, int dh, grs_bit
 // blit rectangular region from screen
 bool ogl_ubitblt_cs(grs_canvas &canvas, int dw, int dh, int dx, int dy, int sx, int sy)
 {
+	ogl_stream.flush();
 #if DXX_USE_STEREOSCOPIC_RENDER
 	dy = canvas.cv_bitmap.bm_h - (dy + dh);	// GL y flip
 	sy = canvas.cv_bitmap.bm_h - (sy + dh);	// GL y flip
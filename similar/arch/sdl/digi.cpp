@@ -15,6 +15,7 @@
 #include "config.h"
 #include "digi.h"
 #include "sounds.h"
+#include "piggy.h"
 #include "console.h"
 #include "rbaudio.h"
 #include "args.h"
@@ -209,6 +210,22 @@ void digi_select_system()
 		fptr = digi_audio_table;
 }
 
+void digi_prepare_sounds()
+{
+#if DXX_USE_SDLMIXER
+	if (!CGameArg.SndDisableSdlMixer)
+		digi_mixer_convert_sounds();
+#endif
+}
+
+void digi_flush_channel_updates()
+{
+#if DXX_USE_SDLMIXER
+	if (!CGameArg.SndDisableSdlMixer)
+		digi_mixer_flush();
+#endif
+}
+
 /* Stub functions */
 
 int  digi_init()
@@ -231,6 +248,7 @@ void digi_set_channel_pan(const sound_channel channel, const sound_pan pan)
 
 sound_channel digi_start_sound(const sound_effect soundnum, const fix volume, const sound_pan pan, const int looping, const int loop_start, const int loop_end, sound_object *const soundobj)
 {
+	piggy_sound_page_in(soundnum);
 	return fptr->start_sound(soundnum, volume, pan, looping, loop_start, loop_end, soundobj);
 }
 
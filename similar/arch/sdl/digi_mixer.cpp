@@ -14,6 +14,8 @@
  *  -- MD2211 (2006-10-12)
  */
 
+#include <algorithm>
+#include <bit>
 #include <bitset>
 #include <span>
 #include <stdlib.h>
@@ -37,12 +39,19 @@
 #include "piggy.h"
 #include "u_mem.h"
 #include <memory>
+#include <utility>
+#include <vector>
 #include "compiler-cf_assert.h"
 #include "d_bitset.h"
 #include "d_range.h"
 #include "d_underlying_value.h"
 #include "d_uspan.h"
 #include "d_zip.h"
+#include "level_cache.h"
+#include "mem_account.h"
+#include "mem_trim.h"
+#include "parallel.h"
+#include "resample_span.h"
 
 #define MIX_DIGI_DEBUG 0
 
@@ -72,6 +81,61 @@ constexpr int MIX_OUTPUT_CHANNELS{2};
 constexpr auto digi_sample_rate{underlying_value(sound_sample_rate::_44k)};
 enumerated_bitset<64, sound_channel> channels;
 
+/* Volume and pan changes are held until digi_mixer_flush, so that a
+ * frame of changes costs at most one call into SDL_mixer per channel
+ * and effect, all under one hold of its audio lock.  Each SDL_mixer call
+ * takes that lock, and waits for the audio callback when it is mixing.
+ */
+struct channel_update
+{
+	/* -1 when unknown */
+	int16_t distance{-1}, pan{-1};
+};
+struct channel_updates_t
+{
+	std::array<channel_update, 64> pending, applied;
+	uint64_t dirty{};
+};
+channel_updates_t channel_updates;
+
+/* Holds the lock SDL_mixer takes around each call, so that nested calls
+ * only take it again from the thread which already has it.
+ */
+#ifdef SDL_MIXER_VERSION_ATLEAST
+#if SDL_MIXER_VERSION_ATLEAST(2, 6, 0)
+#define DXX_USE_MIX_LOCKAUDIO 1
+#endif
+#endif
+struct RAIIMix_LockAudio
+{
+#ifdef DXX_USE_MIX_LOCKAUDIO
+	RAIIMix_LockAudio()
+	{
+		Mix_LockAudio();
+	}
+	~RAIIMix_LockAudio()
+	{
+		Mix_UnlockAudio();
+	}
+	RAIIMix_LockAudio(const RAIIMix_LockAudio &) = delete;
+	RAIIMix_LockAudio &operator=(const RAIIMix_LockAudio &) = delete;
+#else
+	/* Older SDL_mixer has no public lock, so each call locks alone.
+	 * The empty constructor keeps holders of the lock from being
+	 * reported as unused.
+	 */
+	RAIIMix_LockAudio()
+	{
+	}
+#endif
+};
+
+static void digi_mixer_forget_updates(const unsigned c)
+{
+	channel_updates.dirty &= ~(uint64_t{1} << c);
+	channel_updates.pending[c] = {};
+}
+
 /* channel management */
 static sound_channel digi_mixer_find_channel(const enumerated_bitset<64, sound_channel> &channels, const unsigned max_channels)
 {
@@ -87,7 +151,14 @@ struct RAIIMix_Chunk : public Mix_Chunk
 	constexpr RAIIMix_Chunk() : Mix_Chunk{} {}
 	~RAIIMix_Chunk()
 	{
-		delete [] abuf;
+		reset();
+	}
+	void reset()
+	{
+		if (abuf)
+			mem_account_sub(mem_tag::mixer_chunks, alen);
+		delete [] std::exchange(abuf, nullptr);
+		alen = 0;
 	}
 	RAIIMix_Chunk(const RAIIMix_Chunk &) = delete;
 	RAIIMix_Chunk &operator=(const RAIIMix_Chunk &) = delete;
@@ -123,10 +194,11 @@ int digi_mixer_init()
 #endif
 	if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) Error("SDL audio initialisation failed: %s.", SDL_GetError());
 
+	const std::size_t buffer_size{CGameArg.SndBufferSize ? CGameArg.SndBufferSize : SOUND_BUFFER_SIZE};
 #if SDL_MAJOR_VERSION == 1
-	if (Mix_OpenAudio(digi_sample_rate, MIX_OUTPUT_FORMAT, MIX_OUTPUT_CHANNELS, SOUND_BUFFER_SIZE))
+	if (Mix_OpenAudio(digi_sample_rate, MIX_OUTPUT_FORMAT, MIX_OUTPUT_CHANNELS, buffer_size))
 #else
-	if (Mix_OpenAudioDevice(digi_sample_rate, MIX_OUTPUT_FORMAT, MIX_OUTPUT_CHANNELS, SOUND_BUFFER_SIZE, NULL, 0))
+	if (Mix_OpenAudioDevice(digi_sample_rate, MIX_OUTPUT_FORMAT, MIX_OUTPUT_CHANNELS, buffer_size, NULL, 0))
 #endif
 	{
 		//edited on 10/05/98 by Matt Mueller - should keep running, just with no sound.
@@ -134,6 +206,17 @@ int digi_mixer_init()
 		CGameArg.SndNoSound = 1;
 		return 1;
 	}
+	{
+		/* A sound started now is heard once the buffer being filled is
+		 * played, so one buffer is the least latency the mixer adds.
+		 * The device may add more of its own.
+		 */
+		int freq{};
+		uint16_t format{};
+		int output_channels{};
+		if (Mix_QuerySpec(&freq, &format, &output_channels) && freq > 0)
+			con_printf(CON_NORMAL, "SDL_mixer: %i Hz, %" DXX_PRI_size_type " samples per buffer, %" DXX_PRI_size_type " ms output latency", freq, buffer_size, buffer_size * 1000 / freq);
+	}
 
 	digi_mixer_max_channels = Mix_AllocateChannels(digi_mixer_max_channels);
 	channels.reset();
@@ -224,7 +307,7 @@ namespace emulate_soundblaster16 {
 	b_s16 = int32(round(b * (2^16 -1)));  % coeffs!
 
  */
-constexpr std::size_t FILTER_LEN = 51;
+constexpr std::size_t FILTER_LEN = digi_resample_filter_length;
 static constexpr std::array<int32_t, FILTER_LEN> coeffs_quarterband{{
 		0, 0, -7, -25, -35, 0, 94, 200, 205, 0, -395, -751, -702, 0, 1178, 2127,
 		1907, 0, -3050, -5490, -5011, 0, 9275, 20326, 29311, 32767, 29311,
@@ -243,78 +326,6 @@ coeffs_halfband{{
 #endif
 ;
 
-// Fixed-point FIR filtering
-// Not optimal: consider optimization with 1/4, 1/2 band filters, and symmetric kernels
-static auto filter_fir(const unique_span<int8_t> signal_storage, const std::span<const int32_t, FILTER_LEN> coeffs)
-{
-	const auto signal{signal_storage.span()};
-	const std::size_t outsize = signal.size();
-	unique_span<int16_t> result(outsize);
-	const auto output{result.span()};
-	// A FIR filter is just a 1D convolution
-	// Keep only signalLen samples
-	for (const auto nn : xrange(outsize))
-	{
-		// Determine start/stop indices for convolved chunk
-		constexpr std::size_t coeffsLen = FILTER_LEN;
-		/* Avoid use of `std::max` here, since `nn + 1 < coeffsLen` would cause
-		 * unsigned subtraction to underflow.
-		 */
-		const std::size_t min_idx = (nn + 1 > coeffsLen ? nn + 1 - coeffsLen : 0u);
-		const std::size_t max_idx = nn;
-		if (min_idx > max_idx)
-			continue;
-
-		int32_t cur_output{0};  // Increase bit size for fixed point expansion
-		// Sum over each sample * coefficient in this column
-		for (const auto kk : xrange(min_idx, max_idx + 1))
-		{
-			const auto product = int32_t{signal[kk]} * coeffs[nn - kk];
-			cur_output = cur_output + product;
-		}
-
-		// Save and fit back into int16
-		output[nn] = static_cast<int16_t>(cur_output >> 8);  // Arithmetic shift
-	}
-	return result;
-}
-
-static auto upsample(const std::span<const uint8_t> input, const upscale_factor upFactor)
-{
-	const std::size_t factor = underlying_value(upFactor);
-	switch (upFactor)
-	{
-		case upscale_factor::from_11khz_to_44khz:
-#if DXX_BUILD_DESCENT == 2
-		case upscale_factor::from_22khz_to_44khz:
-#endif
-			break;
-		default:
-			cf_assert(false);
-	}
-	const auto upsampledLen = input.size() * factor;
-	/* Caution: `output` is sparsely initialized, so the value-initialization
-	 * from `make_unique` is necessary.  This site cannot be converted to
-	 * `make_unique_for_overwrite`.
-	 */
-	unique_span<int8_t> result(upsampledLen);
-	const auto output{result.span()};
-	using output_type = decltype(output)::value_type;
-	for (const auto ii : xrange(input.size()))
-	{
-		/* Assert that the minimum and maximum possible values in the input can
-		 * be represented in the output without truncation. */
-		using conversion_type = int16_t;
-		using input_type = decltype(input)::value_type;
-		constexpr int8_t convert_u8_to_s8{INT8_MIN};
-		static_assert(std::in_range<output_type>(conversion_type{input_type{0}} + convert_u8_to_s8));
-		static_assert(std::in_range<output_type>(conversion_type{input_type{UINT8_MAX}} + convert_u8_to_s8));
-		// Save input sample, convert to signed
-		output[ii*factor] = conversion_type{input[ii]} + convert_u8_to_s8;
-	}
-	return result;
-}
-
 static auto replicateChannel(const unique_span<int16_t> input_storage, const std::size_t output_per_input)
 {
 	const std::size_t chFactor = MIX_OUTPUT_CHANNELS;
@@ -343,12 +354,11 @@ static auto convert_audio(const std::span<const uint8_t> input, const std::size_
 #endif
 		coeffs_quarterband;
 
-	return replicateChannel(
-	// First upsample
-	// Apply LPF filter to smooth out upscaled points
+	// Upsample, and apply LPF filter to smooth out upscaled points
 	// There will be some uniform amplitude loss here, but less than -3dB
-		filter_fir(upsample(input, upFactor), coeffs),
-		output_per_input);
+	unique_span<int16_t> filtered(input.size() * underlying_value(upFactor));
+	digi_resample_fir(input, underlying_value(upFactor), coeffs, filtered.span());
+	return replicateChannel(std::move(filtered), output_per_input);
 }
 
 }
@@ -418,6 +428,10 @@ namespace dsx {
 namespace {
 
 static std::array<RAIIMix_Chunk, MAX_SOUNDS> SoundChunks;
+/* Hash of the data and rate each chunk was converted from by
+ * digi_mixer_convert_sounds, or 0
+ */
+static std::array<uint64_t, MAX_SOUNDS> SoundChunkSources;
 
 /*
  * Play-time conversion. Performs output conversion only once per sound effect used.
@@ -493,27 +507,123 @@ static void mixdigi_convert_sound(const sound_effect sound_idx, RAIIMix_Chunk &s
 	}
 	sci.alen = cvtbuf.size();
 	sci.abuf = cvtbuf.release();
+	if (sci.abuf)
+		mem_account_add(mem_tag::mixer_chunks, sci.alen);
 	sci.allocated = 1;
 	sci.volume = 128; // Max volume = 128
 }
 
+static uint16_t mixdigi_sound_rate(const digi_sound &gs)
+{
+#if DXX_BUILD_DESCENT == 1
+	return gs.freq;
+#elif DXX_BUILD_DESCENT == 2
+	(void)gs;
+	return underlying_value(GameArg.SndDigiSampleRate);
+#endif
+}
+
 static Mix_Chunk &mixdigi_convert_sound(const sound_effect i)
 {
 	auto &sci = SoundChunks[i];
 	if (!sci.abuf)
 	{
 		auto &gs = GameSounds[i];
-#if DXX_BUILD_DESCENT == 1
-		const auto freq{gs.freq};
-#elif DXX_BUILD_DESCENT == 2
-		const auto freq = underlying_value(GameArg.SndDigiSampleRate);
-#endif
 		//proceed only if not converted yet
-		mixdigi_convert_sound(i, sci, gs, freq);
+		mixdigi_convert_sound(i, sci, gs, mixdigi_sound_rate(gs));
 	}
 	return sci;
 }
 
+/* Free the chunks that no channel is playing.  Each is converted again
+ * when it is next started.
+ */
+static std::size_t digi_mixer_trim_sounds()
+{
+	if (!digi_initialised)
+		return 0;
+	const RAIIMix_LockAudio lock;
+	std::array<const Mix_Chunk *, 64> playing;
+	std::size_t n_playing{};
+	for (const unsigned c : xrange(std::min<unsigned>(digi_mixer_max_channels, playing.size())))
+		if (Mix_Playing(c))
+			playing[n_playing++] = Mix_GetChunk(c);
+	const std::span<const Mix_Chunk *const> in_use{playing.data(), n_playing};
+	std::size_t freed{};
+	for (auto &&[sci, source] : zip(SoundChunks, SoundChunkSources))
+	{
+		if (!sci.abuf || std::ranges::find(in_use, &sci) != in_use.end())
+			continue;
+		freed += sci.alen;
+		sci.reset();
+		source = 0;
+	}
+	return freed;
+}
+
+}
+
+void digi_mixer_convert_sounds()
+{
+	if (!digi_initialised)
+		return;
+	mem_trim_register(mem_trim_cost::convert, digi_mixer_trim_sounds);
+	const std::size_t n = std::min<std::size_t>(Num_sound_files, MAX_SOUNDS);
+	/* A chunk is kept only if it was converted by this function from the
+	 * same data at the same rate.  Chunks converted on demand have no
+	 * recorded source, and are converted again here.  Sounds which are
+	 * not read yet are converted when they are first played, so only
+	 * their old chunk, if any, is freed.
+	 */
+	std::array<uint64_t, MAX_SOUNDS> sources{};
+	parallel_for(n, [&sources](const std::size_t i) {
+		auto &gs = GameSounds[i];
+		const auto data = gs.span();
+		if (data.empty())
+			return;
+		const auto freq = mixdigi_sound_rate(gs);
+		const std::array<uint8_t, 2> rate{{static_cast<uint8_t>(freq), static_cast<uint8_t>(freq >> 8)}};
+		sources[i] = level_cache_hash(data, level_cache_hash(rate));
+	});
+	std::vector<sound_effect> stale;
+	for (std::size_t i = 0; i != n; ++i)
+	{
+		const auto s{static_cast<sound_effect>(i)};
+		if (!sources[i] ? !SoundChunks[s].abuf : (SoundChunks[s].abuf && sources[i] == SoundChunkSources[i]))
+			continue;
+		stale.emplace_back(s);
+	}
+	if (stale.empty())
+		return;
+	/* A playing channel may still refer to a chunk which is about to be
+	 * freed.
+	 */
+	digi_mixer_stop_all_channels();
+	for (const auto s : stale)
+	{
+		SoundChunks[s].reset();
+		SoundChunkSources[underlying_value(s)] = 0;
+	}
+	const auto convert = [&stale, &sources](const std::size_t j) {
+		const auto s = stale[j];
+		const auto i = underlying_value(s);
+		mixdigi_convert_sound(s);
+		if (SoundChunks[s].abuf)
+			SoundChunkSources[i] = sources[i];
+	};
+#if DXX_FEATURE_EXTERNAL_RESAMPLER_SDL_NATIVE
+	/* SDL conversion reports failures to the console, which is not safe
+	 * to use from the worker threads.
+	 */
+	if (CGameArg.SndMixerMethod == digi_mixer_method::sdl_native)
+	{
+		for (std::size_t j = 0; j != stale.size(); ++j)
+			convert(j);
+	}
+	else
+#endif
+		parallel_for(stale.size(), convert);
+	con_printf(CON_VERBOSE, "Converted %" DXX_PRI_size_type " sounds for SDL_mixer", stale.size());
 }
 
 // Volume 0-F1_0
@@ -544,10 +654,16 @@ sound_channel digi_mixer_start_sound(sound_effect soundnum, const fix volume, co
 #endif
 
 	const int mix_loop = looping * -1;
-	Mix_PlayChannel(channel, &(SoundChunks[soundnum]), mix_loop);
-	Mix_SetPanning(channel, 255-mix_pan, mix_pan);
-	Mix_SetDistance(channel, UINT8_MAX - fix2byte(volume));
+	const uint8_t distance = UINT8_MAX - fix2byte(volume);
+	{
+		const RAIIMix_LockAudio lock;
+		Mix_PlayChannel(channel, &(SoundChunks[soundnum]), mix_loop);
+		Mix_SetPanning(channel, 255-mix_pan, mix_pan);
+		Mix_SetDistance(channel, distance);
+	}
 	channels.set(c);
+	digi_mixer_forget_updates(channel);
+	channel_updates.applied[channel] = {distance, static_cast<int16_t>(mix_pan)};
 	return c;
 }
 
@@ -558,13 +674,38 @@ namespace dcx {
 void digi_mixer_set_channel_volume(const sound_channel channel, const int volume)
 {
 	if (!digi_initialised) return;
-	Mix_SetDistance(underlying_value(channel), UINT8_MAX - fix2byte(volume));
+	const unsigned c = underlying_value(channel);
+	if (c >= channel_updates.pending.size())
+		return;
+	channel_updates.pending[c].distance = UINT8_MAX - fix2byte(volume);
+	channel_updates.dirty |= uint64_t{1} << c;
 }
 
 void digi_mixer_set_channel_pan(const sound_channel channel, const sound_pan pan)
 {
-	int mix_pan = fix2byte(static_cast<fix>(pan));
-	Mix_SetPanning(underlying_value(channel), 255 - mix_pan, mix_pan);
+	const unsigned c = underlying_value(channel);
+	if (c >= channel_updates.pending.size())
+		return;
+	channel_updates.pending[c].pan = fix2byte(static_cast<fix>(pan));
+	channel_updates.dirty |= uint64_t{1} << c;
+}
+
+void digi_mixer_flush()
+{
+	if (!digi_initialised || !channel_updates.dirty)
+		return;
+	const RAIIMix_LockAudio lock;
+	for (auto dirty{std::exchange(channel_updates.dirty, 0)}; dirty; dirty &= dirty - 1)
+	{
+		const unsigned c = std::countr_zero(dirty);
+		auto &p = channel_updates.pending[c];
+		auto &a = channel_updates.applied[c];
+		if (const auto d{p.distance}; d >= 0 && d != a.distance)
+			Mix_SetDistance(c, a.distance = d);
+		if (const auto mix_pan{p.pan}; mix_pan >= 0 && mix_pan != a.pan)
+			Mix_SetPanning(c, 255 - mix_pan, a.pan = mix_pan);
+		p = {};
+	}
 }
 
 void digi_mixer_stop_sound(const sound_channel channel)
@@ -576,6 +717,7 @@ void digi_mixer_stop_sound(const sound_channel channel)
 #endif
 	Mix_HaltChannel(c);
 	channels.reset(channel);
+	digi_mixer_forget_updates(c);
 }
 
 void digi_mixer_end_sound(const sound_channel channel)
@@ -604,6 +746,8 @@ int digi_mixer_is_channel_playing(const sound_channel c)
 void digi_mixer_stop_all_channels()
 {
 	channels = {};
+	channel_updates.dirty = 0;
+	channel_updates.pending = {};
 	Mix_HaltChannel(-1);
 }
 
@@ -31,7 +31,9 @@
 
 #include "compiler-range_for.h"
 #include "d_range.h"
+#include "input_latency.h"
 #include <memory>
+#include <vector>
 
 using std::min;
 
@@ -41,10 +43,162 @@ static int sdl_video_flags = SDL_SWSURFACE | SDL_HWPALETTE | SDL_DOUBLEBUF;
 static SDL_Surface *screen, *canvas;
 static int gr_installed;
 
+namespace {
+
+/* Presenting the 8-bit canvas to a 16 or 32-bit screen.  Blitting
+ * converts and copies every pixel every frame, though most frames
+ * change only part of the screen, such as the cockpit gauges or a menu
+ * cursor.  Instead, the canvas is compared row by row with a copy of
+ * what was last presented, and only the span of each row that changed
+ * is expanded through a table of the palette's screen pixels, straight
+ * into the screen surface.  Only those rectangles are then sent to the
+ * display.
+ *
+ * A double buffered screen swaps whole frames, so it cannot be updated
+ * in part, and a screen of another depth is left to SDL.  Both keep the
+ * blit.
+ */
+struct canvas_presenter
+{
+	std::vector<uint8_t> presented;
+	std::vector<SDL_Rect> rects;
+	std::array<uint32_t, 256> colors;
+	unsigned bytes_per_pixel;
+	/* Whether the next present must send the whole canvas, as after
+	 * the palette or the screen changes
+	 */
+	bool full;
+	void reset(const SDL_Surface *s);
+	void set_palette(const std::array<SDL_Color, 256> &c);
+	void present();
+	template <typename pixel_type>
+		void expand_row(const uint8_t *src, pixel_type *dst, unsigned x0, unsigned x1) const;
+};
+
+static canvas_presenter Canvas_presenter;
+
+void canvas_presenter::reset(const SDL_Surface *const s)
+{
+	full = true;
+	rects.clear();
+	presented.clear();
+	const auto bpp{s->format->BytesPerPixel};
+	if ((s->flags & SDL_DOUBLEBUF) || (bpp != 2 && bpp != 4))
+	{
+		bytes_per_pixel = 0;
+		return;
+	}
+	bytes_per_pixel = bpp;
+	presented.resize(static_cast<std::size_t>(canvas->w) * canvas->h);
+}
+
+void canvas_presenter::set_palette(const std::array<SDL_Color, 256> &c)
+{
+	if (!bytes_per_pixel)
+		return;
+	for (std::size_t i{0}; i != c.size(); ++i)
+		colors[i] = SDL_MapRGB(screen->format, c[i].r, c[i].g, c[i].b);
+	full = true;
+}
+
+template <typename pixel_type>
+void canvas_presenter::expand_row(const uint8_t *const src, pixel_type *const dst, const unsigned x0, const unsigned x1) const
+{
+	/* Unrolled so that the table reads and the stores of several
+	 * pixels are in flight together.
+	 */
+	unsigned x{x0};
+	for (; x + 4 <= x1; x += 4)
+	{
+		const pixel_type p0(colors[src[x]]), p1(colors[src[x + 1]]), p2(colors[src[x + 2]]), p3(colors[src[x + 3]]);
+		dst[x] = p0;
+		dst[x + 1] = p1;
+		dst[x + 2] = p2;
+		dst[x + 3] = p3;
+	}
+	for (; x != x1; ++x)
+		dst[x] = pixel_type(colors[src[x]]);
+}
+
+void canvas_presenter::present()
+{
+	const unsigned w = canvas->w, h = canvas->h;
+	if (SDL_MUSTLOCK(screen) && SDL_LockSurface(screen) < 0)
+		return;
+	rects.clear();
+	/* The rectangle being grown from consecutive changed rows */
+	unsigned run_y{0}, run_x0{0}, run_x1{0};
+	bool in_run{false};
+	const auto close_run = [&](const unsigned y) {
+		if (!in_run)
+			return;
+		in_run = false;
+		rects.push_back({static_cast<Sint16>(run_x0), static_cast<Sint16>(run_y), static_cast<Uint16>(run_x1 - run_x0), static_cast<Uint16>(y - run_y)});
+	};
+	const auto canvas_pixels{static_cast<const uint8_t *>(canvas->pixels)};
+	const auto screen_pixels{static_cast<uint8_t *>(screen->pixels)};
+	for (unsigned y{0}; y != h; ++y)
+	{
+		const auto src{canvas_pixels + y * canvas->pitch};
+		const auto last{&presented[static_cast<std::size_t>(y) * w]};
+		unsigned x0, x1;
+		if (full)
+		{
+			x0 = 0;
+			x1 = w;
+		}
+		else
+		{
+			const auto first_change{std::mismatch(src, src + w, last)};
+			if (first_change.first == src + w)
+			{
+				close_run(y);
+				continue;
+			}
+			x0 = first_change.first - src;
+			x1 = w;
+			while (src[x1 - 1] == last[x1 - 1])
+				--x1;
+		}
+		std::copy(src + x0, src + x1, last + x0);
+		const auto dst{screen_pixels + y * screen->pitch};
+		if (bytes_per_pixel == 4)
+			expand_row(src, reinterpret_cast<uint32_t *>(dst), x0, x1);
+		else
+			expand_row(src, reinterpret_cast<uint16_t *>(dst), x0, x1);
+		if (!in_run)
+		{
+			in_run = true;
+			run_y = y;
+			run_x0 = x0;
+			run_x1 = x1;
+		}
+		else
+		{
+			run_x0 = std::min(run_x0, x0);
+			run_x1 = std::max(run_x1, x1);
+		}
+	}
+	close_run(h);
+	full = false;
+	if (SDL_MUSTLOCK(screen))
+		SDL_UnlockSurface(screen);
+	if (!rects.empty())
+		SDL_UpdateRects(screen, rects.size(), rects.data());
+}
+
+}
+
 void gr_flip()
 {
-	SDL_BlitSurface(canvas, nullptr, screen, nullptr);
-	SDL_Flip(screen);
+	if (Canvas_presenter.bytes_per_pixel)
+		Canvas_presenter.present();
+	else
+	{
+		SDL_BlitSurface(canvas, nullptr, screen, nullptr);
+		SDL_Flip(screen);
+	}
+	input_latency_presented(SDL_GetTicks());
 }
 
 // returns possible (fullscreen) resolutions if any.
@@ -119,6 +273,8 @@ int gr_set_mode(screen_mode mode)
 		exit(1);
 	}
 
+	Canvas_presenter.reset(screen);
+
 	*grd_curscreen = {};
 	grd_curscreen->sdl_surface = RAII_SDL_Surface(canvas);
 	grd_curscreen->set_screen_width_height(w, h);
@@ -151,6 +307,7 @@ void gr_toggle_fullscreen()
 	CGameCfg.WindowMode = WindowMode;
 	gr_remap_color_fonts();
 	SDL_WM_ToggleFullScreen(screen);
+	Canvas_presenter.full = true;
 }
 
 }
@@ -239,6 +396,7 @@ void gr_palette_step_up( int r, int g, int b )
 		colors[i].b = std::clamp(ib, 0, 63) * 4;
 	}
 	SDL_SetColors(canvas, colors.data(), 0, colors.size());
+	Canvas_presenter.set_palette(colors);
 }
 
 void gr_palette_load( palette_array_t &pal )
@@ -274,6 +432,7 @@ void gr_palette_load( palette_array_t &pal )
 	}
 
 	SDL_SetColors(canvas, colors.data(), 0, colors.size());
+	Canvas_presenter.set_palette(colors);
 	reset_computed_colors();
 	gr_remap_color_fonts();
 }
@@ -3,14 +3,16 @@
 layout(push_constant) uniform PushConstants {
     mat4 mvp;
     float alpha_ref;
-    float pad[3];
+    float fade;
+    float pad[2];
 } pc;
 
 layout(location = 0) in vec4 fragColor;
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    if (fragColor.a < pc.alpha_ref)
+    vec4 color = vec4(fragColor.rgb, fragColor.a * pc.fade);
+    if (color.a < pc.alpha_ref)
         discard;
-    outColor = fragColor;
+    outColor = color;
 }
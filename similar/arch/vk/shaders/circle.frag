@@ -0,0 +1,26 @@
+#version 450
+
+layout(push_constant) uniform PushConstants {
+    mat4 mvp;
+    float alpha_ref;
+    float fade;
+    float pad[2];
+} pc;
+
+// xy: position relative to the unit circle, z: inner radius (0 for a disk)
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec3 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    float d = length(fragTexCoord.xy);
+    float aa = max(fwidth(d), 1e-5);
+    float coverage = clamp((1.0 - d) / aa + 0.5, 0.0, 1.0);
+    if (fragTexCoord.z > 0.0)
+        coverage *= clamp((d - fragTexCoord.z) / aa + 0.5, 0.0, 1.0);
+    vec4 color = vec4(fragColor.rgb, fragColor.a * pc.fade * coverage);
+    if (color.a < pc.alpha_ref)
+        discard;
+    outColor = color;
+}
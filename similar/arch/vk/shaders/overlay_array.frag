@@ -0,0 +1,47 @@
+#version 450
+
+layout(push_constant) uniform PushConstants {
+    mat4 mvp;
+    float alpha_ref;
+    float fade;
+    float pad[2];
+} pc;
+
+layout(set = 0, binding = 0) uniform sampler2DArray texSampler;
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec3 fragTexCoord;
+// vk_overlay_word: the rotation in the low two bits, the layer plus one above
+layout(location = 2) flat in uint fragOverlay;
+
+layout(location = 0) out vec4 outColor;
+
+// False in the opaque wall pipelines, which then never discard and keep
+// early depth testing
+layout(constant_id = 0) const bool alpha_test = true;
+
+// The overlay's texture coordinates, as _g3_draw_tmap_2 rotates them for
+// the second pass.  The sampler repeats, so these agree with it for
+// coordinates that were moved by whole textures.
+vec2 overlayTexCoord(vec2 uv, uint orient) {
+    if (orient == 1u)
+        return vec2(1.0 - uv.y, uv.x);
+    if (orient == 2u)
+        return vec2(1.0) - uv;
+    if (orient == 3u)
+        return vec2(uv.y, 1.0 - uv.x);
+    return uv;
+}
+
+void main() {
+    vec4 base = texture(texSampler, fragTexCoord);
+    float layer = float((fragOverlay >> 2u) - 1u);
+    vec4 overlay = texture(texSampler, vec3(overlayTexCoord(fragTexCoord.xy, fragOverlay & 3u), layer));
+    // The overlay over the bottom texture, as the blended second pass
+    vec4 texel = vec4(mix(base.rgb, overlay.rgb, overlay.a), overlay.a + base.a * (1.0 - overlay.a));
+    vec4 color = texel * fragColor;
+    color.a *= pc.fade;
+    if (alpha_test && color.a < pc.alpha_ref)
+        discard;
+    outColor = color;
+}
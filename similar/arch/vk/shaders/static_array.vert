@@ -0,0 +1,91 @@
+#version 450
+
+layout(push_constant) uniform PushConstants {
+    mat4 mvp;
+    float alpha_ref;
+    float fade;
+    float pad[2];
+} pc;
+
+// World space side corners of the level, three floats each
+layout(std430, set = 1, binding = 0) readonly buffer StaticCorners {
+    float corners[];
+};
+
+// Dynamic lights, as apply_light casts them onto vertices.  A light with a
+// segment only reaches the corners of that segment; headlight_max_dist is
+// nonzero for a headlight.
+struct Light {
+    vec3 pos;
+    float range;
+    vec3 color;
+    uint segment;
+    vec3 headlight_dir;
+    float headlight_max_dist;
+};
+layout(std430, set = 1, binding = 1) readonly buffer StaticLights {
+    uint light_count;
+    float saturation;
+    uint pad0, pad1;
+    Light lights[];
+};
+
+layout(location = 0) in uint inCorner;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in float inLayer;
+layout(location = 4) in uint inFlags;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec3 fragTexCoord;
+// Read by overlay_array.frag only
+layout(location = 2) flat out uint fragOverlay;
+
+// Corners are stored four per side, six sides per segment
+const uint CORNERS_PER_SEGMENT = 24u;
+const float MIN_LIGHT_DIST = 4.0;
+const float HEADLIGHT_SCALE = 10.0;
+
+vec3 dynamicLight(vec3 p) {
+    uint segment = inCorner / CORNERS_PER_SEGMENT;
+    vec3 sum = vec3(0.0);
+    for (uint i = 0u; i < light_count; i++) {
+        Light l = lights[i];
+        float dist = distance(l.pos, p);
+        if (l.segment != 0xffffffffu) {
+            if (l.segment != segment)
+                continue;
+            float q = (dist / 4.0) * (dist / 4.0);
+            if (q < l.range)
+                sum += l.color / max(q, MIN_LIGHT_DIST);
+            continue;
+        }
+        bool headlight = l.headlight_max_dist > 0.0;
+        if ((headlight ? dist / 8.0 : dist) >= l.range)
+            continue;
+        float d = max(dist, MIN_LIGHT_DIST);
+        if (!headlight)
+            sum += l.color / d;
+        else {
+            float dp = dot(normalize(p - l.pos), l.headlight_dir);
+            if (dp < 0.5)
+                sum += l.color / (HEADLIGHT_SCALE * d);
+            else if (d < l.headlight_max_dist)
+                sum += dp * dp * l.color / 8.0;
+        }
+    }
+    return sum;
+}
+
+void main() {
+    uint i = inCorner * 3u;
+    vec3 p = vec3(corners[i], corners[i + 1u], corners[i + 2u]);
+    gl_Position = pc.mvp * vec4(p, 1.0);
+    fragColor = inColor;
+    // Bit 0 of inFlags: the face takes dynamic light
+    if ((inFlags & 1u) != 0u && light_count != 0u)
+        fragColor.rgb = min(inColor.rgb + dynamicLight(p) * saturation, vec3(saturation));
+    fragTexCoord = vec3(inTexCoord, inLayer);
+    // The rest of inFlags: the overlay, see vk_overlay_word
+    fragOverlay = inFlags >> 1u;
+}
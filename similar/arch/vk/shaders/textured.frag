@@ -3,7 +3,8 @@
 layout(push_constant) uniform PushConstants {
     mat4 mvp;
     float alpha_ref;
-    float pad[3];
+    float fade;
+    float pad[2];
 } pc;
 
 layout(set = 0, binding = 0) uniform sampler2D texSampler;
@@ -13,10 +14,15 @@ layout(location = 1) in vec2 fragTexCoord;
 
 layout(location = 0) out vec4 outColor;
 
+// False in the opaque wall pipelines, which then never discard and keep
+// early depth testing
+layout(constant_id = 0) const bool alpha_test = true;
+
 void main() {
     vec4 texel = texture(texSampler, fragTexCoord);
     vec4 color = texel * fragColor;
-    if (color.a < pc.alpha_ref)
+    color.a *= pc.fade;
+    if (alpha_test && color.a < pc.alpha_ref)
         discard;
     outColor = color;
 }
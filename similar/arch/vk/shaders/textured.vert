@@ -3,7 +3,8 @@
 layout(push_constant) uniform PushConstants {
     mat4 mvp;
     float alpha_ref;
-    float pad[3];
+    float fade;
+    float pad[2];
 } pc;
 
 layout(location = 0) in vec3 inPosition;
@@ -0,0 +1,28 @@
+#version 450
+
+layout(push_constant) uniform PushConstants {
+    mat4 mvp;
+    float alpha_ref;
+    float fade;
+    float pad[2];
+} pc;
+
+layout(set = 0, binding = 0) uniform sampler2DArray texSampler;
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec3 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+// False in the opaque wall pipelines, which then never discard and keep
+// early depth testing
+layout(constant_id = 0) const bool alpha_test = true;
+
+void main() {
+    vec4 texel = texture(texSampler, fragTexCoord);
+    vec4 color = texel * fragColor;
+    color.a *= pc.fade;
+    if (alpha_test && color.a < pc.alpha_ref)
+        discard;
+    outColor = color;
+}
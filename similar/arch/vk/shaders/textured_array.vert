@@ -0,0 +1,22 @@
+#version 450
+
+layout(push_constant) uniform PushConstants {
+    mat4 mvp;
+    float alpha_ref;
+    float fade;
+    float pad[2];
+} pc;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in float inLayer;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec3 fragTexCoord;
+
+void main() {
+    gl_Position = pc.mvp * vec4(inPosition, 1.0);
+    fragColor = inColor;
+    fragTexCoord = vec3(inTexCoord, inLayer);
+}
@@ -12,6 +12,8 @@
 #include "vk_mem_alloc.h"
 
 #include <array>
+#include <deque>
+#include <functional>
 #include <vector>
 #include <cstring>
 #include <cmath>
@@ -22,25 +24,57 @@
 
 namespace dcx {
 
-// Maximum frames in flight for double-buffering
-constexpr uint32_t VK_MAX_FRAMES_IN_FLIGHT = 2;
+enum class vk_present_mode : uint8_t;
+enum class vk_gpu_pass : uint8_t;
+struct ogl_screen_image;
 
-// Per-frame ring buffer size for vertex data (4MB per frame)
+// Maximum frames in flight; the count actually used is
+// vk_state::frames_in_flight, from CGameCfg.VkFramesInFlight
+constexpr uint32_t VK_MAX_FRAMES_IN_FLIGHT = 3;
+
+// GPU timestamps: each frame slot owns VK_TIMESTAMPS_PER_FRAME queries of
+// vk_state::timestamp_pool, one per vk_set_gpu_pass change
+constexpr uint32_t VK_TIMESTAMPS_PER_FRAME = 64;
+constexpr std::size_t VK_GPU_PASS_COUNT = 4;
+
+// Command recording threads.  Frames with fewer draw records than
+// VK_PARALLEL_RECORD_MIN are recorded on the main thread, where the
+// handoff would cost more than it saves.
+constexpr unsigned VK_MAX_RECORD_THREADS = 4;
+constexpr std::size_t VK_PARALLEL_RECORD_MIN = 256;
+
+// Per-frame vertex ring chunk size (4MB).  A frame that overflows its
+// first chunk chains further chunks, up to VK_VERTEX_RING_MAX_CHUNKS.
 constexpr VkDeviceSize VK_VERTEX_RING_SIZE = 4 * 1024 * 1024;
+constexpr uint32_t VK_VERTEX_RING_MAX_CHUNKS = 8;
+
+// Per-frame index ring size (16-bit indices for fan triangulation)
+constexpr VkDeviceSize VK_INDEX_RING_SIZE = 512 * 1024;
+
+// Texture staging: VK_UPLOAD_BATCHES upload batches, each owning a
+// VK_UPLOAD_SLICE_SIZE slice of one persistent staging buffer
+constexpr uint32_t VK_UPLOAD_BATCHES = 4;
+constexpr VkDeviceSize VK_UPLOAD_SLICE_SIZE = 4 * 1024 * 1024;
+
+// Overflow chunks are released after this many frames that fit in the first chunk
+constexpr uint32_t VK_VERTEX_RING_TRIM_FRAMES = 120;
 
 // Push constant layout: MVP matrix (64 bytes) + flags (16 bytes)
 struct vk_push_constants {
 	float mvp[16];       // 4x4 column-major matrix
 	float alpha_ref;     // alpha test reference value
-	float pad[3];
+	float fade;          // canvas fade level, multiplied into fragment alpha
+	float pad[2];
 };
 static_assert(sizeof(vk_push_constants) == 80);
 
-// Vertex format for all draw calls
+// Vertex as the draw code builds it; see vk_ring_vertex_3d for what reaches the GPU
 struct vk_vertex {
 	float x, y, z;      // position
 	float r, g, b, a;   // color
 	float u, v;          // texcoord
+	float layer;         // texture array layer, or circle inner radius (VK_PIPE_CIRCLE_*)
+	uint16_t overlay = 0; // vk_overlay_word, for the overlay array pipelines
 };
 
 // Pipeline variant indices
@@ -48,17 +82,81 @@ enum vk_pipeline_id {
 	VK_PIPE_TEXTURED_3D = 0,  // textured 3D geometry (walls, robots)
 	VK_PIPE_FLAT_3D,           // flat-shaded 3D (lasers, drone arms)
 	VK_PIPE_LINE_3D,           // 3D lines
+	VK_PIPE_TEXTURED_ARRAY_3D, // textured 3D walls sampling the level texture array
 	VK_PIPE_TEXTURED_2D,       // 2D textured (bitmaps, UI)
 	VK_PIPE_FLAT_2D,           // 2D flat color (rectangles)
 	VK_PIPE_LINE_2D,           // 2D lines
+	VK_PIPE_CIRCLE_3D,         // 3D disks (spheres), coverage from circle.frag
+	VK_PIPE_CIRCLE_2D,         // 2D circles and disks
+	VK_PIPE_STATIC_3D,         // textured walls positioned from the static geometry buffer
+	VK_PIPE_STATIC_ARRAY_3D,   // the same, sampling the level texture array
+	VK_PIPE_OVERLAY_ARRAY_3D,  // walls with an overlay, both layers of the level texture array in one draw
+	VK_PIPE_STATIC_OVERLAY_ARRAY_3D, // the same, from the static geometry buffer
 	VK_PIPE_COUNT
 };
 
+// Vertex ring layouts.  Draw code fills in a vk_vertex, which is packed
+// as it is copied into the ring: RGBA8 unorm colors and half float texture
+// coordinates and layer.  2D pipelines have no depth, so they drop z.
+struct vk_ring_vertex_3d {
+	float x, y, z;
+	uint32_t color;
+	uint16_t u, v, layer, overlay;
+};
+struct vk_ring_vertex_2d {
+	float x, y;
+	uint32_t color;
+	uint16_t u, v, layer, pad;
+};
+// Static pipelines read the position from vk_state::static_buffer
+struct vk_ring_vertex_static {
+	uint32_t corner;
+	uint32_t color;
+	uint16_t u, v, layer, flags;
+};
+// vk_ring_vertex_static::flags: add the shader's dynamic light to color
+constexpr uint16_t VK_STATIC_VERTEX_LIT = 1 << 0;
+// The rest of the flags hold the vk_overlay_word
+constexpr unsigned VK_STATIC_VERTEX_OVERLAY_SHIFT = 1;
+
+// The overlay of a wall, as the overlay shaders read it: the
+// texture2_rotation_low in the low two bits, above them the overlay's layer
+// plus one.  The static vertex shifts it past its own flag, so the layer
+// must fit in 13 bits.
+constexpr unsigned VK_OVERLAY_MAX_LAYER = (1u << (16 - VK_STATIC_VERTEX_OVERLAY_SHIFT - 2)) - 2;
+constexpr uint16_t vk_overlay_word(const unsigned layer, const unsigned orient)
+{
+	return static_cast<uint16_t>((layer + 1) << 2 | (orient & 3));
+}
+static_assert(sizeof(vk_ring_vertex_3d) == 24);
+static_assert(sizeof(vk_ring_vertex_2d) == 20);
+static_assert(sizeof(vk_ring_vertex_static) == 16);
+
+constexpr bool vk_pipeline_is_2d(const vk_pipeline_id id)
+{
+	return id == VK_PIPE_TEXTURED_2D || id == VK_PIPE_FLAT_2D || id == VK_PIPE_LINE_2D || id == VK_PIPE_CIRCLE_2D;
+}
+
+constexpr bool vk_pipeline_is_static(const vk_pipeline_id id)
+{
+	return id == VK_PIPE_STATIC_3D || id == VK_PIPE_STATIC_ARRAY_3D || id == VK_PIPE_STATIC_OVERLAY_ARRAY_3D;
+}
+
+constexpr uint32_t vk_ring_vertex_size(const vk_pipeline_id id)
+{
+	return vk_pipeline_is_2d(id)
+		? sizeof(vk_ring_vertex_2d)
+		: vk_pipeline_is_static(id)
+			? sizeof(vk_ring_vertex_static)
+			: sizeof(vk_ring_vertex_3d);
+}
+
 // Blend mode
 enum vk_blend_mode {
 	VK_BLEND_NORMAL = 0,      // src_alpha, 1-src_alpha
 	VK_BLEND_ADDITIVE_A,      // src_alpha, one
 	VK_BLEND_ADDITIVE_C,      // one, one
+	VK_BLEND_SUBTRACTIVE_C,   // zero, 1-src_color (darkening palette flash)
 	VK_BLEND_COUNT
 };
 
@@ -71,22 +169,145 @@ struct vk_texture {
 	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
 	uint32_t w = 0, h = 0;
 	uint32_t tw = 0, th = 0;  // padded to power-of-two
+	uint32_t layers = 1;      // > 1 for a 2D array texture
 	float u_scale = 1.0f, v_scale = 1.0f;
 	bool valid = false;
 };
 
+// One host-visible, persistently mapped block of the vertex ring
+struct vk_vertex_chunk {
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VmaAllocation allocation = VK_NULL_HANDLE;
+	void *mapped = nullptr;
+};
+
+// Batch of buffer-to-image copies submitted together
+struct vk_upload_batch {
+	VkCommandBuffer cmd = VK_NULL_HANDLE;
+	VkFence fence = VK_NULL_HANDLE;
+	VkSemaphore done = VK_NULL_HANDLE;  // waited on by the graphics queue (dedicated transfer queue only)
+	VkDeviceSize used = 0;              // bytes used in this batch's staging slice
+	bool recording = false;
+	bool submitted = false;
+
+	// Staging buffers for uploads larger than a slice, freed when the batch is reused
+	std::vector<std::pair<VkBuffer, VmaAllocation>> oversized;
+};
+
+// Texture destroyed once the GPU has finished the submission that may use it
+struct vk_retired_texture {
+	vk_texture *tex;
+	uint64_t serial;
+};
+
+// One flushed batch, recorded into a command buffer by vk_record_frame.
+// A record with no vertices writes a timestamp to its query slot instead.
+struct vk_draw_record {
+	VkPipeline pipeline;
+	VkDescriptorSet descriptor_set;
+	VkBuffer vertex_buffer;
+	VkViewport viewport;
+	VkRect2D scissor;
+	float mvp[16];
+	uint64_t mvp_serial;
+	float fade;
+	uint32_t first_vertex;
+	uint32_t vertex_count;
+	uint32_t first_index;
+	uint32_t index_count;
+	uint32_t query;
+};
+
+// Swapchain objects replaced by vk_recreate_swapchain, destroyed once the
+// frames that may still use them have completed
+struct vk_retired_swapchain {
+	VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+	std::vector<VkImageView> views;
+	std::vector<VkFramebuffer> framebuffers;
+	VkImage depth_image = VK_NULL_HANDLE;
+	VmaAllocation depth_allocation = VK_NULL_HANDLE;
+	VkImageView depth_view = VK_NULL_HANDLE;
+	VkImage scene_image = VK_NULL_HANDLE;
+	VmaAllocation scene_allocation = VK_NULL_HANDLE;
+	VkImageView scene_view = VK_NULL_HANDLE;
+	VkFramebuffer scene_framebuffer = VK_NULL_HANDLE;
+	uint64_t serial = 0;
+};
+
 // Per-frame resources
 struct vk_frame_data {
+	uint64_t submit_serial = 0;         // serial of the last submission from this frame
+	fix64 present_time = 0;             // timer_query() when the frame was presented
+	uint32_t timestamp_count = 0;       // queries written in this frame's range
+	std::array<vk_gpu_pass, VK_TIMESTAMPS_PER_FRAME> timestamp_pass{};  // pass that starts at each query
 	VkCommandBuffer cmd = VK_NULL_HANDLE;
+	VkCommandBuffer secondary_cmd = VK_NULL_HANDLE;  // main thread's range when recording in parallel
+	std::vector<vk_draw_record> draw_records;
+	VkFramebuffer framebuffer = VK_NULL_HANDLE;  // target of the frame's render pass
+	float render_scale = 1.0f;          // fraction of the swapchain extent rendered
 	VkSemaphore image_available = VK_NULL_HANDLE;
 	VkSemaphore render_finished = VK_NULL_HANDLE;
 	VkFence fence = VK_NULL_HANDLE;
 
-	// Vertex ring buffer
+	// Vertex ring buffer, made of one or more chunks
+	std::vector<vk_vertex_chunk> vertex_chunks;
+	uint32_t vertex_chunk = 0;          // chunk currently being filled
+	VkDeviceSize vertex_offset = 0;     // offset within that chunk
+	uint32_t vertex_quiet_frames = 0;   // consecutive frames that fit in the first chunk
+
+	// Index ring buffer
+	VkBuffer index_buffer = VK_NULL_HANDLE;
+	VmaAllocation index_allocation = VK_NULL_HANDLE;
+	void *index_mapped = nullptr;
+	VkDeviceSize index_offset = 0;
+};
+
+// Draw batching counters, reset at the start of every frame
+struct vk_draw_stats {
+	uint32_t draws = 0;                     // vk_draw_* requests
+	uint32_t grouped_draws = 0;             // fans held by an object group
+	uint32_t batches = 0;                   // vkCmdDraw calls actually recorded
+	uint32_t pipeline_binds = 0;
+	uint32_t pipeline_binds_skipped = 0;    // batch flushed with the pipeline already bound
+	uint32_t descriptor_binds = 0;
+	uint32_t descriptor_binds_skipped = 0;
+	uint32_t push_constants = 0;
+	uint32_t push_constants_skipped = 0;    // MVP unchanged since the last push
+	uint32_t viewport_sets = 0;
+	uint32_t viewport_sets_skipped = 0;
+	uint32_t scissor_sets = 0;
+	uint32_t scissor_sets_skipped = 0;
+	uint32_t vertex_bytes = 0;              // vertex ring usage
+	uint32_t texture_uploads = 0;
+	uint32_t upload_stalls = 0;             // waits for an upload batch to be reusable
+	uint32_t record_threads = 0;            // threads that recorded the frame
+};
+
+// Pending draw batch.  Consecutive draws that share pipeline, texture, MVP
+// and fade are appended to the ring and become a single draw record.
+struct vk_draw_batch {
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
 	VkBuffer vertex_buffer = VK_NULL_HANDLE;
-	VmaAllocation vertex_allocation = VK_NULL_HANDLE;
-	void *vertex_mapped = nullptr;
-	VkDeviceSize vertex_offset = 0;
+	float mvp[16] = {};
+	uint64_t mvp_serial = 0;                // g_vk.mvp_serial when mvp was copied
+	float fade = 1.0f;                      // vk_push_constants::fade
+	uint32_t first_vertex = 0;
+	uint32_t vertex_count = 0;
+	uint32_t first_index = 0;
+	uint32_t index_count = 0;               // nonzero for an indexed batch
+};
+
+// A screen read from ogl_read_screen.  vk_end_frame copies the swapchain
+// image into `buffer`, and the read is passed on once the submission that
+// copied it has completed.
+struct vk_screen_read {
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VmaAllocation allocation = VK_NULL_HANDLE;
+	const uint8_t *mapped = nullptr;
+	uint64_t submit_serial = 0;             // 0 until the copy is recorded
+	VkExtent2D extent{};
+	std::function<void(ogl_screen_image &&)> done;
 };
 
 // Global Vulkan state
@@ -97,20 +318,43 @@ struct vk_state {
 	VkDevice device = VK_NULL_HANDLE;
 	VkQueue graphics_queue = VK_NULL_HANDLE;
 	uint32_t queue_family = 0;
+	VkQueue transfer_queue = VK_NULL_HANDLE;      // graphics_queue if there is no dedicated one
+	uint32_t transfer_family = 0;
 	VmaAllocator allocator = VK_NULL_HANDLE;
 
 	// Surface and swapchain
+	struct SDL_Window *window = nullptr;  // for making the surface again
 	VkSurfaceKHR surface = VK_NULL_HANDLE;
+	bool surface_lost = false;  // make the surface again before the next frame
 	VkSwapchainKHR swapchain = VK_NULL_HANDLE;
 	VkFormat swapchain_format = VK_FORMAT_UNDEFINED;
 	VkExtent2D swapchain_extent = {0, 0};
 	std::vector<VkImage> swapchain_images;
 	std::vector<VkImageView> swapchain_views;
+	std::vector<vk_retired_swapchain> retired_swapchains;
+	bool swapchain_stale = false;  // rebuild after the next present
 
 	// Render pass and framebuffers
 	VkRenderPass render_pass = VK_NULL_HANDLE;
 	std::vector<VkFramebuffer> framebuffers;
 
+	// Dynamic resolution (-vk_dynres).  While render_scale is below 1, the
+	// frame is drawn into the top left of scene_image through
+	// scene_render_pass, which is compatible with render_pass, and then
+	// blitted to the swapchain image.
+	VkRenderPass scene_render_pass = VK_NULL_HANDLE;
+	VkImage scene_image = VK_NULL_HANDLE;
+	VmaAllocation scene_allocation = VK_NULL_HANDLE;
+	VkImageView scene_view = VK_NULL_HANDLE;
+	VkFramebuffer scene_framebuffer = VK_NULL_HANDLE;
+	VkFilter scene_filter = VK_FILTER_NEAREST;
+	bool scene_blit = false;                // swapchain images accept the blit
+	float render_scale = 1.0f;
+	float render_scale_min = 1.0f;
+	float render_scale_target_ms = 0;       // GPU time per frame the controller aims for
+	float render_scale_gpu_ms = 0;          // smoothed GPU time per frame
+	uint32_t render_scale_frames = 0;       // frames measured since the last change
+
 	// Depth buffer
 	VkImage depth_image = VK_NULL_HANDLE;
 	VmaAllocation depth_allocation = VK_NULL_HANDLE;
@@ -123,25 +367,91 @@ struct vk_state {
 	VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
 	VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
 
+	// Static wall geometry (-gl_staticgeometry): the level's side corners,
+	// read from set 1 by the static pipelines.  static_mvp maps them
+	// through Gl_view_matrix and is rebuilt when either matrix changes.
+	VkDescriptorSetLayout static_set_layout = VK_NULL_HANDLE;
+	VkDescriptorSet static_descriptor_set = VK_NULL_HANDLE;
+	VkBuffer static_buffer = VK_NULL_HANDLE;
+	VmaAllocation static_allocation = VK_NULL_HANDLE;
+	uint32_t static_corner_count = 0;
+	float static_mvp[16] = {};
+	uint64_t static_mvp_serial = 0;
+	uint64_t static_mvp_base_serial = 0;    // g_vk.mvp_serial that static_mvp was built from
+	std::array<float, 16> static_view{};    // Gl_view_matrix that static_mvp was built from
+	// Dynamic lights for the static pipelines (-vk_shaderlights), at set 1
+	// binding 1: one light_slice_size slice per frame in flight, selected
+	// by the dynamic offset
+	VkBuffer light_buffer = VK_NULL_HANDLE;
+	VmaAllocation light_allocation = VK_NULL_HANDLE;
+	uint8_t *light_mapped = nullptr;
+	VkDeviceSize light_slice_size = 0;
+
 	// Pipeline layout (shared by all pipelines)
 	VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
 
 	// Pipelines for each variant and blend mode
 	VkPipeline pipelines[VK_PIPE_COUNT][VK_BLEND_COUNT] = {};
+	// Wall pipelines with normal blend that never discard, for bitmaps
+	// with no transparent texels; null for the other variants
+	VkPipeline opaque_pipelines[VK_PIPE_COUNT] = {};
+	VkPipelineCache pipeline_cache = VK_NULL_HANDLE;  // saved as vkpipeline.bin in the write directory
 
 	// Per-frame data
 	std::array<vk_frame_data, VK_MAX_FRAMES_IN_FLIGHT> frames;
 	uint32_t current_frame = 0;
+	uint32_t frames_in_flight = 2;
 	uint32_t current_image_index = 0;
 
+	// Present mode requested by gr_set_attributes, and the one in use
+	VkPresentModeKHR requested_present_mode = VK_PRESENT_MODE_FIFO_KHR;
+	VkPresentModeKHR present_mode = VK_PRESENT_MODE_FIFO_KHR;
+	// Smoothed time from present until the frame's fence was seen signalled
+	fix64 present_latency = 0;
+
+	// GPU timestamps, enabled with -renderstats or -vk_dynres where the queue supports them
+	VkQueryPool timestamp_pool = VK_NULL_HANDLE;
+	float timestamp_period = 0;                   // nanoseconds per tick
+	vk_gpu_pass gpu_pass{};
+	std::array<float, VK_GPU_PASS_COUNT> gpu_pass_ms{};  // smoothed per-pass GPU time
+
 	// White 1x1 texture used when no texture is bound
 	vk_texture white_texture;
+	vk_texture *level_textures = nullptr;  // 2D array of the level's wall textures
 
 	// Currently bound texture descriptor set
 	VkDescriptorSet bound_texture = VK_NULL_HANDLE;
+	// The draws being made are opaque: every texel is, the vertices have
+	// alpha 1, so opaque_pipelines can draw them when nothing fades or
+	// blends them
+	bool draw_opaque = false;
+
+	// Texture uploads
+	VkCommandPool upload_pool = VK_NULL_HANDLE;
+	VkBuffer staging_buffer = VK_NULL_HANDLE;
+	VmaAllocation staging_allocation = VK_NULL_HANDLE;
+	void *staging_mapped = nullptr;
+	std::array<vk_upload_batch, VK_UPLOAD_BATCHES> uploads;
+	uint32_t current_upload = 0;
+	std::vector<VkSemaphore> upload_waits;  // signalled upload batches not yet waited on
+
+	// Submission serials, for deferred texture destruction
+	uint64_t submit_serial = 0;
+	uint64_t completed_serial = 0;
+	std::vector<vk_retired_texture> retired_textures;
+
+	// Screen reads, oldest first.  Only made when the swapchain images
+	// can be a transfer source.
+	std::deque<vk_screen_read> screen_reads;
+	bool swapchain_readable = false;
+
+	// Draw batching
+	vk_draw_batch batch;
+	vk_draw_stats draw_stats;
+	vk_draw_stats last_draw_stats;          // counters of the last completed frame
+	uint32_t vertex_peak_bytes = 0;         // highest per-frame vertex ring usage
 
 	// Current state
-	bool in_render_pass = false;
 	bool frame_started = false;
 	bool initialized = false;
 
@@ -152,6 +462,10 @@ struct vk_state {
 	// Current blend mode
 	vk_blend_mode current_blend = VK_BLEND_NORMAL;
 
+	// Palette flash from gr_palette_step_up, drawn by ogl_do_palfx
+	std::array<float, 3> palette_flash{};
+	bool palette_flash_active = false;
+
 	// Current pipeline mode (3D vs 2D)
 	bool is_3d_mode = false;
 
@@ -159,6 +473,11 @@ struct vk_state {
 	float projection_matrix[16];
 	float modelview_matrix[16];
 	float mvp_matrix[16];
+	uint64_t mvp_serial = 0;     // bumped by every vk_update_mvp
+
+	// Viewport and scissor for subsequent draws
+	VkViewport viewport{};
+	VkRect2D scissor{};
 	static constexpr int MAX_MATRIX_STACK = 8;
 	float projection_stack[MAX_MATRIX_STACK][16];
 	float modelview_stack[MAX_MATRIX_STACK][16];
@@ -174,20 +493,47 @@ void vk_mat4_ortho(float m[16], float l, float r, float b, float t, float n, flo
 void vk_mat4_perspective(float m[16], float fovy_deg, float aspect, float near, float far);
 void vk_mat4_multiply(float out[16], const float a[16], const float b[16]);
 void vk_update_mvp();
+// Apply CGameCfg.VkPresentMode; takes effect at the next swapchain creation
+void vk_set_present_mode(vk_present_mode mode);
+// Set the viewport and scissor used by subsequent draws
+void vk_set_viewport(int32_t x, int32_t y, uint32_t w, uint32_t h);
 
 // Init/shutdown
 bool vk_init(struct SDL_Window *window, uint32_t w, uint32_t h);
 void vk_shutdown();
 bool vk_recreate_swapchain(uint32_t w, uint32_t h);
+// Return to full resolution and retarget the dynamic resolution controller
+// at the current display refresh rate
+void vk_reset_render_scale();
+
+// Move the frame's vertex ring to its next chunk, allocating it if needed
+bool vk_next_vertex_chunk(vk_frame_data &frame);
 
 // Pipeline creation
 bool vk_create_pipelines();
 void vk_destroy_pipelines();
+// Save the pipeline cache to the write directory and destroy it
+void vk_destroy_pipeline_cache();
 
 // Texture management
 vk_texture *vk_create_texture(uint32_t w, uint32_t h, const uint8_t *rgba_data);
+// 2D array texture of layers tightly packed w x h RGBA images
+vk_texture *vk_create_texture_array(uint32_t w, uint32_t h, uint32_t layers, const uint8_t *rgba_data);
 void vk_destroy_texture(vk_texture *tex);
 void vk_bind_texture(vk_texture *tex);
+bool vk_create_upload_resources();
+void vk_destroy_upload_resources();
+// Submit the recorded texture copies; called before each frame submission
+// and at the end of load phases
+void vk_submit_uploads();
+// Destroy and delete a texture from vk_create_texture once no in-flight
+// or currently recorded frame can reference it
+void vk_retire_texture(vk_texture *tex);
+void vk_collect_retired_textures(bool all);
+// Release every cached bitmap texture (they reload on next use)
+void vk_release_bitmap_textures();
+// Release the least recently used bitmap textures over -gl_texturebudget
+void vk_evict_bitmap_textures();
 
 // Frame lifecycle
 bool vk_begin_frame();
@@ -195,9 +541,16 @@ void vk_end_frame();
 void vk_present();
 
 // Drawing - these match the existing OGL function signatures
-void vk_draw_triangles(const vk_vertex *verts, uint32_t count, bool textured, bool is_3d);
-void vk_draw_triangle_fan(const vk_vertex *verts, uint32_t count, bool textured, bool is_3d);
-void vk_draw_lines(const vk_vertex *verts, uint32_t count, bool is_3d);
+// fade scales fragment alpha on the GPU, so vertices carry unfaded colors
+void vk_draw_triangles(const vk_vertex *verts, uint32_t count, bool textured, bool is_3d, float fade = 1.0f);
+void vk_draw_triangle_fan(const vk_vertex *verts, uint32_t count, bool textured, bool is_3d, float fade = 1.0f);
+void vk_draw_lines(const vk_vertex *verts, uint32_t count, bool is_3d, float fade = 1.0f);
+
+// Record the pending draw batch into the frame's command buffer
+void vk_flush_draws();
+bool vk_create_record_workers();
+void vk_destroy_record_workers();
+void vk_record_frame(vk_frame_data &frame, const VkRenderPassBeginInfo &rpbi);
 
 }  // namespace dcx
 
@@ -22,6 +22,10 @@
 #include "console.h"
 #include "config.h"
 #include "vers_id.h"
+#include "ogl_texture_pool.h"
+#include "input_latency.h"
+#include "render.h"
+#include <algorithm>
 
 using std::min;
 using std::max;
@@ -111,7 +115,10 @@ int gr_set_mode(screen_mode mode)
 
 	// Initialize or recreate Vulkan swapchain
 	if (g_vk.initialized)
+	{
 		vk_recreate_swapchain(w, h);
+		vk_reset_render_scale();
+	}
 
 	gamefont_choose_game_font(w, h);
 	gr_remap_color_fonts();
@@ -121,7 +128,9 @@ int gr_set_mode(screen_mode mode)
 
 void gr_set_attributes(void)
 {
-	// No GL attributes needed for Vulkan
+	// Swapchain settings, used by the next vk_init
+	vk_set_present_mode(CGameCfg.VkPresentMode);
+	g_vk.frames_in_flight = std::clamp<uint32_t>(CGameCfg.VkFramesInFlight, 1, VK_MAX_FRAMES_IN_FLIGHT);
 }
 
 int gr_init()
@@ -202,9 +211,13 @@ uint_fast32_t gr_list_modes(std::array<screen_mode, 50> &gsmodes)
 	return 0;
 }
 
-void gr_palette_step_up(int r, int g, int b)
+void gr_palette_step_up(const int r, const int g, const int b)
 {
-	// Palette step-up handled in ogl_do_palfx via Vulkan
+	const auto apply_gamma = [](const int v) {
+		return v >= 0 ? std::max(v + gr_palette_gamma, 0) : std::min(v + gr_palette_gamma, 0);
+	};
+	g_vk.palette_flash = {{apply_gamma(r) / 63.0f, apply_gamma(g) / 63.0f, apply_gamma(b) / 63.0f}};
+	g_vk.palette_flash_active = r || g || b || gr_palette_gamma;
 }
 
 void gr_palette_load(palette_array_t &pal)
@@ -216,13 +229,45 @@ void gr_palette_load(palette_array_t &pal)
 
 static unsigned s_frame_count = 0;
 
+// -renderstats: command recording counters of the previous frame
+static void vk_draw_stats_overlay(grs_canvas &canvas)
+{
+	const auto &s = g_vk.last_draw_stats;
+	const auto &game_font = *GAME_FONT;
+	gr_set_fontcolor(canvas, BM_XRGB(255, 255, 255), -1);
+	const auto &&fspacx2 = FSPACX(2);
+	const auto &&fspacy1 = FSPACY(1);
+	const auto &&line_spacing = LINE_SPACING(game_font, game_font);
+	gr_printf(canvas, game_font, fspacx2, fspacy1, "%u draws (%u grouped) %u batches %uK vertices", s.draws, s.grouped_draws, s.batches, s.vertex_bytes / 1024);
+	gr_printf(canvas, game_font, fspacx2, fspacy1 + line_spacing, "pipeline %u/%u set %u/%u push %u/%u (issued/skipped)", s.pipeline_binds, s.pipeline_binds_skipped, s.descriptor_binds, s.descriptor_binds_skipped, s.push_constants, s.push_constants_skipped);
+	gr_printf(canvas, game_font, fspacx2, fspacy1 + (line_spacing * 2), "viewport %u/%u scissor %u/%u uploads %u (%u stalls) threads %u", s.viewport_sets, s.viewport_sets_skipped, s.scissor_sets, s.scissor_sets_skipped, s.texture_uploads, s.upload_stalls, s.record_threads);
+	if (g_vk.timestamp_pool)
+	{
+		const auto &ms = g_vk.gpu_pass_ms;
+		gr_printf(canvas, game_font, fspacx2, fspacy1 + (line_spacing * 3), "GPU ms: mine %.2f objects %.2f hud %.2f 2d %.2f scale %u%%", ms[0], ms[1], ms[2], ms[3], static_cast<unsigned>(std::lround(g_vk.render_scale * 100)));
+	}
+	const auto pool = ogl_textures.get_stats();
+	gr_printf(canvas, game_font, fspacx2, fspacy1 + (line_spacing * 4), "textures %zu/%zu resident %zuK budget %zuK evicted %u", pool.used, pool.entries, pool.resident_bytes / 1024, pool.budget_bytes / 1024, pool.evictions);
+	const auto cull = render_take_object_cull_stats();
+	gr_printf(canvas, game_font, fspacx2, fspacy1 + (line_spacing * 5), "objects %u drawn %u culled outside window %u behind", cull.drawn, cull.outside_window, cull.behind);
+}
+
 void gr_flip(void)
 {
 	if (!g_vk.frame_started && !vk_begin_frame())
 		return;
 
+	if (CGameArg.DbgRenderStats)
+	{
+		gr_set_default_canvas();
+		vk_draw_stats_overlay(*grd_curcanv);
+	}
+
+	ogl_do_palfx();
 	vk_end_frame();
 	vk_present();
+	input_latency_presented(SDL_GetTicks());
+	vk_evict_bitmap_textures();
 
 	s_frame_count++;
 	if (s_frame_count <= 5 || s_frame_count % 60 == 0)
@@ -232,13 +277,6 @@ void gr_flip(void)
 	vk_begin_frame();
 }
 
-#if DXX_USE_SCREENSHOT_FORMAT_LEGACY
-void write_bmp(PHYSFS_File *const TGAFile, const unsigned w, const unsigned h)
-{
-	// Screenshot not yet implemented for Vulkan
-}
-#endif
-
 }
 
 #endif  // DXX_USE_VULKAN
@@ -12,6 +12,14 @@
 #include <SDL_log.h>
 #include "console.h"
 #include "dxxerror.h"
+#include "config.h"
+#include "args.h"
+#include "ogl_init.h"
+#include "timer.h"
+#include "mem_account.h"
+#include <algorithm>
+#include <numeric>
+#include <span>
 
 // Android can't statically link Vulkan 1.1+ functions.
 // Use VMA's dynamic function loading to resolve them at runtime.
@@ -70,6 +78,79 @@ void vk_mat4_multiply(float out[16], const float a[16], const float b[16])
 void vk_update_mvp()
 {
 	vk_mat4_multiply(g_vk.mvp_matrix, g_vk.projection_matrix, g_vk.modelview_matrix);
+	++g_vk.mvp_serial;
+}
+
+void vk_set_present_mode(const vk_present_mode mode)
+{
+	switch (mode)
+	{
+		case vk_present_mode::fifo_relaxed:
+			g_vk.requested_present_mode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+			break;
+		case vk_present_mode::mailbox:
+			g_vk.requested_present_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+			break;
+		case vk_present_mode::immediate:
+			g_vk.requested_present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+			break;
+		case vk_present_mode::fifo:
+		default:
+			g_vk.requested_present_mode = VK_PRESENT_MODE_FIFO_KHR;
+			break;
+	}
+}
+
+fix64 vk_get_present_latency()
+{
+	return g_vk.present_latency;
+}
+
+static const char *vk_present_mode_name(const VkPresentModeKHR mode)
+{
+	switch (mode)
+	{
+		case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+			return "FIFO_RELAXED";
+		case VK_PRESENT_MODE_MAILBOX_KHR:
+			return "MAILBOX";
+		case VK_PRESENT_MODE_IMMEDIATE_KHR:
+			return "IMMEDIATE";
+		default:
+			return "FIFO";
+	}
+}
+
+// The requested present mode if the surface supports it, else FIFO (which
+// every implementation must support)
+static VkPresentModeKHR vk_choose_present_mode()
+{
+	if (g_vk.requested_present_mode == VK_PRESENT_MODE_FIFO_KHR)
+		return VK_PRESENT_MODE_FIFO_KHR;
+	uint32_t count = 0;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(g_vk.physical_device, g_vk.surface, &count, nullptr);
+	std::vector<VkPresentModeKHR> modes(count);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(g_vk.physical_device, g_vk.surface, &count, modes.data());
+	if (std::find(modes.begin(), modes.end(), g_vk.requested_present_mode) != modes.end())
+		return g_vk.requested_present_mode;
+	con_printf(CON_NORMAL, "VK: Present mode %s not supported, using FIFO", vk_present_mode_name(g_vk.requested_present_mode));
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+void vk_set_viewport(int32_t x, int32_t y, uint32_t w, uint32_t h)
+{
+	if (g_vk.viewport.x != x || g_vk.viewport.y != y ||
+		g_vk.viewport.width != w || g_vk.viewport.height != h)
+		vk_flush_draws();
+	g_vk.viewport = {};
+	g_vk.viewport.x = static_cast<float>(x);
+	g_vk.viewport.y = static_cast<float>(y);
+	g_vk.viewport.width = static_cast<float>(w);
+	g_vk.viewport.height = static_cast<float>(h);
+	g_vk.viewport.minDepth = 0.0f;
+	g_vk.viewport.maxDepth = 1.0f;
+	g_vk.scissor.offset = {x, y};
+	g_vk.scissor.extent = {w, h};
 }
 
 static bool vk_create_instance(SDL_Window *window)
@@ -168,19 +249,34 @@ static bool vk_create_device()
 		return false;
 	}
 
+	// Prefer a transfer-only family (a DMA engine) for texture uploads
+	g_vk.transfer_family = g_vk.queue_family;
+	for (uint32_t i = 0; i < qf_count; i++)
+	{
+		const auto flags = qf_props[i].queueFlags;
+		if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+		{
+			g_vk.transfer_family = i;
+			break;
+		}
+	}
+
 	float priority = 1.0f;
-	VkDeviceQueueCreateInfo queue_ci{};
-	queue_ci.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	queue_ci.queueFamilyIndex = g_vk.queue_family;
-	queue_ci.queueCount = 1;
-	queue_ci.pQueuePriorities = &priority;
+	std::array<VkDeviceQueueCreateInfo, 2> queue_ci{};
+	queue_ci[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queue_ci[0].queueFamilyIndex = g_vk.queue_family;
+	queue_ci[0].queueCount = 1;
+	queue_ci[0].pQueuePriorities = &priority;
+	queue_ci[1] = queue_ci[0];
+	queue_ci[1].queueFamilyIndex = g_vk.transfer_family;
+	const uint32_t queue_ci_count = g_vk.transfer_family != g_vk.queue_family ? 2 : 1;
 
 	static const char *device_extensions[] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
 	VkDeviceCreateInfo dev_ci{};
 	dev_ci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	dev_ci.queueCreateInfoCount = 1;
-	dev_ci.pQueueCreateInfos = &queue_ci;
+	dev_ci.queueCreateInfoCount = queue_ci_count;
+	dev_ci.pQueueCreateInfos = queue_ci.data();
 	dev_ci.enabledExtensionCount = 1;
 	dev_ci.ppEnabledExtensionNames = device_extensions;
 
@@ -190,11 +286,24 @@ static bool vk_create_device()
 		return false;
 	}
 	vkGetDeviceQueue(g_vk.device, g_vk.queue_family, 0, &g_vk.graphics_queue);
+	vkGetDeviceQueue(g_vk.device, g_vk.transfer_family, 0, &g_vk.transfer_queue);
+	if (g_vk.transfer_family != g_vk.queue_family)
+		con_printf(CON_DEBUG, "VK: Using transfer queue family %u for uploads", g_vk.transfer_family);
 	con_puts(CON_DEBUG, "VK: Device created");
 	SDL_Log("VK: Device created");
 	return true;
 }
 
+static void VKAPI_PTR vk_account_allocate(VmaAllocator, uint32_t, VkDeviceMemory, VkDeviceSize size, void *)
+{
+	mem_account_add(mem_tag::vma, size);
+}
+
+static void VKAPI_PTR vk_account_free(VmaAllocator, uint32_t, VkDeviceMemory, VkDeviceSize size, void *)
+{
+	mem_account_sub(mem_tag::vma, size);
+}
+
 static bool vk_create_allocator()
 {
 	// Set up dynamic Vulkan function pointers for VMA
@@ -208,6 +317,15 @@ static bool vk_create_allocator()
 	ci.instance = g_vk.instance;
 	ci.vulkanApiVersion = VK_API_VERSION_1_1;
 	ci.pVulkanFunctions = &vma_funcs;
+	/* VMA takes device memory in large blocks, so this counts what the
+	 * driver holds, not what the allocations use
+	 */
+	static constexpr VmaDeviceMemoryCallbacks memory_callbacks{
+		.pfnAllocate = vk_account_allocate,
+		.pfnFree = vk_account_free,
+		.pUserData = nullptr,
+	};
+	ci.pDeviceMemoryCallbacks = &memory_callbacks;
 
 	if (vmaCreateAllocator(&ci, &g_vk.allocator) != VK_SUCCESS)
 	{
@@ -240,12 +358,34 @@ static bool vk_create_swapchain(uint32_t w, uint32_t h)
 	}
 	g_vk.swapchain_format = chosen.format;
 
+	// Dynamic resolution blits the scene into the swapchain image
+	g_vk.scene_blit = false;
+	if (g_vk.render_scale_min < 1.0f)
+	{
+		VkFormatProperties fp;
+		vkGetPhysicalDeviceFormatProperties(g_vk.physical_device, chosen.format, &fp);
+		constexpr VkFormatFeatureFlags blit = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+		if ((caps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) && (fp.optimalTilingFeatures & blit) == blit)
+		{
+			g_vk.scene_blit = true;
+			g_vk.scene_filter = (fp.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+		}
+		else
+			con_puts(CON_NORMAL, "VK: Surface does not support blits, dynamic resolution disabled");
+	}
+
 	g_vk.swapchain_extent.width = w;
 	g_vk.swapchain_extent.height = h;
 	if (caps.currentExtent.width != UINT32_MAX)
 		g_vk.swapchain_extent = caps.currentExtent;
+	vk_set_viewport(0, 0, g_vk.swapchain_extent.width, g_vk.swapchain_extent.height);
+
+	g_vk.present_mode = vk_choose_present_mode();
 
-	uint32_t image_count = caps.minImageCount + 1;
+	// FIFO with one frame in flight gains nothing from an extra image;
+	// MAILBOX needs one to replace queued frames
+	uint32_t image_count = caps.minImageCount +
+		(g_vk.present_mode == VK_PRESENT_MODE_MAILBOX_KHR || g_vk.frames_in_flight > 1 ? 1 : 0);
 	if (caps.maxImageCount > 0 && image_count > caps.maxImageCount)
 		image_count = caps.maxImageCount;
 
@@ -257,11 +397,15 @@ static bool vk_create_swapchain(uint32_t w, uint32_t h)
 	sci.imageColorSpace = chosen.colorSpace;
 	sci.imageExtent = g_vk.swapchain_extent;
 	sci.imageArrayLayers = 1;
-	sci.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	// Reading the images back, for screenshots, needs transfer source
+	g_vk.swapchain_readable = caps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	sci.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+		(g_vk.scene_blit ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0) |
+		(g_vk.swapchain_readable ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
 	sci.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	sci.preTransform = caps.currentTransform;
 	sci.compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
-	sci.presentMode = VK_PRESENT_MODE_FIFO_KHR;  // guaranteed available, vsync
+	sci.presentMode = g_vk.present_mode;
 	sci.clipped = VK_TRUE;
 	sci.oldSwapchain = g_vk.swapchain;
 
@@ -272,9 +416,7 @@ static bool vk_create_swapchain(uint32_t w, uint32_t h)
 		return false;
 	}
 
-	// Destroy old swapchain if any
-	if (sci.oldSwapchain != VK_NULL_HANDLE)
-		vkDestroySwapchainKHR(g_vk.device, sci.oldSwapchain, nullptr);
+	// The old swapchain, if any, was retired by vk_rebuild_swapchain
 
 	vkGetSwapchainImagesKHR(g_vk.device, g_vk.swapchain, &image_count, nullptr);
 	g_vk.swapchain_images.resize(image_count);
@@ -318,16 +460,26 @@ static bool vk_create_depth_buffer()
 	ici.arrayLayers = 1;
 	ici.samples = VK_SAMPLE_COUNT_1_BIT;
 	ici.tiling = VK_IMAGE_TILING_OPTIMAL;
-	ici.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	// Depth is cleared at the start of the pass and not stored, so it never
+	// needs to leave the tile memory of a tiling GPU.  Where the device has
+	// lazily allocated memory, it is then never backed by any.
+	ici.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
 
 	VmaAllocationCreateInfo ai{};
-	ai.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+	ai.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
 
 	if (vmaCreateImage(g_vk.allocator, &ici, &ai, &g_vk.depth_image, &g_vk.depth_allocation, nullptr) != VK_SUCCESS)
 	{
-		con_puts(CON_URGENT, "VK: Failed to create depth buffer");
-		return false;
+		ici.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		ai.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		if (vmaCreateImage(g_vk.allocator, &ici, &ai, &g_vk.depth_image, &g_vk.depth_allocation, nullptr) != VK_SUCCESS)
+		{
+			con_puts(CON_URGENT, "VK: Failed to create depth buffer");
+			return false;
+		}
 	}
+	else
+		con_puts(CON_DEBUG, "VK: Depth buffer is lazily allocated");
 
 	VkImageViewCreateInfo vci{};
 	vci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -346,7 +498,11 @@ static bool vk_create_depth_buffer()
 	return true;
 }
 
-static bool vk_create_render_pass()
+// The swapchain pass presents its color attachment.  The scene pass leaves
+// it ready to be blitted, and must not overwrite it before the previous
+// frame's blit has read it.  Both have the same attachment formats, so they
+// are compatible and share the pipelines.
+static bool vk_create_render_pass(VkRenderPass &render_pass, const bool scene)
 {
 	std::array<VkAttachmentDescription, 2> attachments{};
 	// Color
@@ -357,7 +513,7 @@ static bool vk_create_render_pass()
 	attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	attachments[0].finalLayout = scene ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 	// Depth
 	attachments[1].format = VK_FORMAT_D32_SFLOAT;
 	attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
@@ -377,12 +533,19 @@ static bool vk_create_render_pass()
 	subpass.pColorAttachments = &color_ref;
 	subpass.pDepthStencilAttachment = &depth_ref;
 
-	VkSubpassDependency dep{};
-	dep.srcSubpass = VK_SUBPASS_EXTERNAL;
-	dep.dstSubpass = 0;
-	dep.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	dep.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-	dep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	std::array<VkSubpassDependency, 2> deps{};
+	deps[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+	deps[0].dstSubpass = 0;
+	deps[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+		(scene ? VK_PIPELINE_STAGE_TRANSFER_BIT : 0);
+	deps[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	deps[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	deps[1].srcSubpass = 0;
+	deps[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+	deps[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	deps[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	deps[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	deps[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
 	VkRenderPassCreateInfo rpci{};
 	rpci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -390,10 +553,10 @@ static bool vk_create_render_pass()
 	rpci.pAttachments = attachments.data();
 	rpci.subpassCount = 1;
 	rpci.pSubpasses = &subpass;
-	rpci.dependencyCount = 1;
-	rpci.pDependencies = &dep;
+	rpci.dependencyCount = scene ? 2 : 1;
+	rpci.pDependencies = deps.data();
 
-	if (vkCreateRenderPass(g_vk.device, &rpci, nullptr, &g_vk.render_pass) != VK_SUCCESS)
+	if (vkCreateRenderPass(g_vk.device, &rpci, nullptr, &render_pass) != VK_SUCCESS)
 	{
 		con_puts(CON_URGENT, "VK: Failed to create render pass");
 		return false;
@@ -401,6 +564,66 @@ static bool vk_create_render_pass()
 	return true;
 }
 
+static bool vk_create_render_passes()
+{
+	return vk_create_render_pass(g_vk.render_pass, false) && vk_create_render_pass(g_vk.scene_render_pass, true);
+}
+
+// Full swapchain size, so that changing the render scale only changes the
+// render area and never reallocates
+static bool vk_create_scene_target()
+{
+	VkImageCreateInfo ici{};
+	ici.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	ici.imageType = VK_IMAGE_TYPE_2D;
+	ici.format = g_vk.swapchain_format;
+	ici.extent = {g_vk.swapchain_extent.width, g_vk.swapchain_extent.height, 1};
+	ici.mipLevels = 1;
+	ici.arrayLayers = 1;
+	ici.samples = VK_SAMPLE_COUNT_1_BIT;
+	ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+	ici.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+	VmaAllocationCreateInfo ai{};
+	ai.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+	if (vmaCreateImage(g_vk.allocator, &ici, &ai, &g_vk.scene_image, &g_vk.scene_allocation, nullptr) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: Failed to create scene image");
+		return false;
+	}
+
+	VkImageViewCreateInfo vci{};
+	vci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	vci.image = g_vk.scene_image;
+	vci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	vci.format = g_vk.swapchain_format;
+	vci.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	vci.subresourceRange.levelCount = 1;
+	vci.subresourceRange.layerCount = 1;
+	if (vkCreateImageView(g_vk.device, &vci, nullptr, &g_vk.scene_view) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: Failed to create scene image view");
+		return false;
+	}
+
+	std::array<VkImageView, 2> att = {g_vk.scene_view, g_vk.depth_view};
+	VkFramebufferCreateInfo fbci{};
+	fbci.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	fbci.renderPass = g_vk.scene_render_pass;
+	fbci.attachmentCount = static_cast<uint32_t>(att.size());
+	fbci.pAttachments = att.data();
+	fbci.width = g_vk.swapchain_extent.width;
+	fbci.height = g_vk.swapchain_extent.height;
+	fbci.layers = 1;
+	if (vkCreateFramebuffer(g_vk.device, &fbci, nullptr, &g_vk.scene_framebuffer) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: Failed to create scene framebuffer");
+		return false;
+	}
+	return true;
+}
+
 static bool vk_create_framebuffers()
 {
 	g_vk.framebuffers.resize(g_vk.swapchain_views.size());
@@ -422,6 +645,8 @@ static bool vk_create_framebuffers()
 			return false;
 		}
 	}
+	if (g_vk.scene_blit)
+		return vk_create_scene_target();
 	return true;
 }
 
@@ -442,17 +667,22 @@ static bool vk_create_command_pool()
 
 static bool vk_create_descriptor_pool()
 {
-	// Pool for texture samplers - support up to 1024 textures
-	VkDescriptorPoolSize pool_size{};
-	pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	pool_size.descriptorCount = 1024;
+	// Pool for texture samplers - support up to 1024 textures - and the
+	// static geometry and light buffers
+	std::array<VkDescriptorPoolSize, 3> pool_sizes{};
+	pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	pool_sizes[0].descriptorCount = 1024;
+	pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	pool_sizes[1].descriptorCount = 1;
+	pool_sizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	pool_sizes[2].descriptorCount = 1;
 
 	VkDescriptorPoolCreateInfo dpci{};
 	dpci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	dpci.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-	dpci.maxSets = 1024;
-	dpci.poolSizeCount = 1;
-	dpci.pPoolSizes = &pool_size;
+	dpci.maxSets = 1024 + 1;
+	dpci.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+	dpci.pPoolSizes = pool_sizes.data();
 
 	if (vkCreateDescriptorPool(g_vk.device, &dpci, nullptr, &g_vk.descriptor_pool) != VK_SUCCESS)
 	{
@@ -477,9 +707,62 @@ static bool vk_create_descriptor_pool()
 		con_puts(CON_URGENT, "VK: Failed to create descriptor set layout");
 		return false;
 	}
+
+	// Set 1, binding 0 = static geometry corners, binding 1 = this frame's
+	// dynamic lights
+	std::array<VkDescriptorSetLayoutBinding, 2> static_bindings{};
+	static_bindings[0].binding = 0;
+	static_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	static_bindings[0].descriptorCount = 1;
+	static_bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	static_bindings[1].binding = 1;
+	static_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	static_bindings[1].descriptorCount = 1;
+	static_bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	dslci.bindingCount = static_cast<uint32_t>(static_bindings.size());
+	dslci.pBindings = static_bindings.data();
+	if (vkCreateDescriptorSetLayout(g_vk.device, &dslci, nullptr, &g_vk.static_set_layout) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: Failed to create static geometry descriptor set layout");
+		return false;
+	}
+	return true;
+}
+
+// Host-visible, coherent, persistently mapped buffer
+static bool vk_create_mapped_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                    VkBuffer &buffer, VmaAllocation &allocation, void *&mapped)
+{
+	VkBufferCreateInfo bci{};
+	bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bci.size = size;
+	bci.usage = usage;
+
+	VmaAllocationCreateInfo ai{};
+	ai.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+	ai.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+	VmaAllocationInfo alloc_info{};
+	if (vmaCreateBuffer(g_vk.allocator, &bci, &ai, &buffer,
+	                    &allocation, &alloc_info) != VK_SUCCESS)
+		return false;
+	mapped = alloc_info.pMappedData;
 	return true;
 }
 
+static bool vk_create_vertex_chunk(vk_vertex_chunk &chunk)
+{
+	return vk_create_mapped_buffer(VK_VERTEX_RING_SIZE, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+	                               chunk.buffer, chunk.allocation, chunk.mapped);
+}
+
+static void vk_destroy_vertex_chunk(vk_vertex_chunk &chunk)
+{
+	if (chunk.buffer)
+		vmaDestroyBuffer(g_vk.allocator, chunk.buffer, chunk.allocation);
+	chunk = {};
+}
+
 static bool vk_create_per_frame_resources()
 {
 	VkCommandBufferAllocateInfo cbai{};
@@ -488,7 +771,7 @@ static bool vk_create_per_frame_resources()
 	cbai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 	cbai.commandBufferCount = 1;
 
-	for (auto &frame : g_vk.frames)
+	for (auto &frame : std::span(g_vk.frames).first(g_vk.frames_in_flight))
 	{
 		if (vkAllocateCommandBuffers(g_vk.device, &cbai, &frame.cmd) != VK_SUCCESS)
 			return false;
@@ -503,29 +786,361 @@ static bool vk_create_per_frame_resources()
 		fci.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 		vkCreateFence(g_vk.device, &fci, nullptr, &frame.fence);
 
-		// Vertex ring buffer (host-visible, coherent)
+		// First vertex ring chunk; overflow chunks are added on demand
+		vk_vertex_chunk chunk;
+		if (!vk_create_vertex_chunk(chunk))
+		{
+			con_puts(CON_URGENT, "VK: Failed to create vertex ring buffer");
+			return false;
+		}
+		frame.vertex_chunks.push_back(chunk);
+		frame.vertex_chunk = 0;
+		frame.vertex_offset = 0;
+
+		if (!vk_create_mapped_buffer(VK_INDEX_RING_SIZE, VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+		                             frame.index_buffer, frame.index_allocation, frame.index_mapped))
+		{
+			con_puts(CON_URGENT, "VK: Failed to create index ring buffer");
+			return false;
+		}
+		frame.index_offset = 0;
+	}
+	return true;
+}
+
+bool vk_next_vertex_chunk(vk_frame_data &frame)
+{
+	const uint32_t next = frame.vertex_chunk + 1;
+	if (next >= frame.vertex_chunks.size())
+	{
+		if (next >= VK_VERTEX_RING_MAX_CHUNKS)
+			return false;
+		vk_vertex_chunk chunk;
+		if (!vk_create_vertex_chunk(chunk))
+			return false;
+		frame.vertex_chunks.push_back(chunk);
+		con_printf(CON_VERBOSE, "VK: vertex ring grown to %u chunks", next + 1);
+	}
+	frame.vertex_chunk = next;
+	frame.vertex_offset = 0;
+	return true;
+}
+
+// Release the overflow chunks of a frame whose fence has signalled
+static void vk_trim_vertex_chunks(vk_frame_data &frame)
+{
+	while (frame.vertex_chunks.size() > 1)
+	{
+		vk_destroy_vertex_chunk(frame.vertex_chunks.back());
+		frame.vertex_chunks.pop_back();
+	}
+	con_puts(CON_VERBOSE, "VK: vertex ring trimmed to 1 chunk");
+}
+
+// ============================================================================
+// Dynamic resolution
+// ============================================================================
+
+void vk_reset_render_scale()
+{
+	g_vk.render_scale = 1.0f;
+	g_vk.render_scale_gpu_ms = 0;
+	g_vk.render_scale_frames = 0;
+	int hz = 60;
+	SDL_DisplayMode mode;
+	if (!SDL_GetCurrentDisplayMode(0, &mode) && mode.refresh_rate > 0)
+		hz = mode.refresh_rate;
+	if (CGameArg.SysMaxFPS > 0 && !CGameCfg.VSync)
+		hz = std::min(hz, CGameArg.SysMaxFPS);
+	// Leave some of the frame interval for the CPU side of the pipeline
+	g_vk.render_scale_target_ms = 850.0f / hz;
+}
+
+// Fill cost scales with the pixel count, so a frame over budget shrinks
+// both axes by the square root of the overrun.  Scales are kept to 5% steps
+// and the average is left to settle after each change, so the controller
+// does not chase single slow frames.
+static void vk_update_render_scale(const float gpu_ms)
+{
+	g_vk.render_scale_gpu_ms = g_vk.render_scale_gpu_ms ? (g_vk.render_scale_gpu_ms * 7 + gpu_ms) / 8 : gpu_ms;
+	if (++g_vk.render_scale_frames < 30)
+		return;
+	const float target = g_vk.render_scale_target_ms;
+	const float average = g_vk.render_scale_gpu_ms;
+	float scale = g_vk.render_scale;
+	if (average > target)
+		scale = std::floor(scale * std::sqrt(target / average) * 20) / 20;
+	else if (average < target * 0.7f)
+		scale = std::round(scale * 20 + 1) / 20;
+	else
+		return;
+	scale = std::clamp(scale, g_vk.render_scale_min, 1.0f);
+	if (scale == g_vk.render_scale)
+		return;
+	g_vk.render_scale = scale;
+	g_vk.render_scale_frames = 0;
+	con_printf(CON_DEBUG, "VK: render scale %u%% (GPU %.2f ms, target %.2f ms)", static_cast<unsigned>(std::lround(scale * 100)), average, target);
+}
+
+static VkExtent2D vk_scene_extent(const float scale)
+{
+	return {
+		std::max(1u, static_cast<uint32_t>(g_vk.swapchain_extent.width * scale + 0.5f)),
+		std::max(1u, static_cast<uint32_t>(g_vk.swapchain_extent.height * scale + 0.5f)),
+	};
+}
+
+// Upscale the rendered part of the scene image into the swapchain image.
+// The frame waits for the swapchain image only at the transfer stage, so
+// the scene can render before the image has been acquired.
+static void vk_blit_scene(const VkCommandBuffer cmd, const VkExtent2D scene_extent)
+{
+	const auto image = g_vk.swapchain_images[g_vk.current_image_index];
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	VkImageBlit region{};
+	region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.srcSubresource.layerCount = 1;
+	region.srcOffsets[1] = {static_cast<int32_t>(scene_extent.width), static_cast<int32_t>(scene_extent.height), 1};
+	region.dstSubresource = region.srcSubresource;
+	region.dstOffsets[1] = {static_cast<int32_t>(g_vk.swapchain_extent.width), static_cast<int32_t>(g_vk.swapchain_extent.height), 1};
+	vkCmdBlitImage(cmd, g_vk.scene_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, g_vk.scene_filter);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+// ============================================================================
+// Screen reads
+// ============================================================================
+
+static bool vk_swapchain_format_bgra()
+{
+	return g_vk.swapchain_format == VK_FORMAT_B8G8R8A8_UNORM || g_vk.swapchain_format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+static bool vk_swapchain_format_rgba()
+{
+	return g_vk.swapchain_format == VK_FORMAT_R8G8B8A8_UNORM || g_vk.swapchain_format == VK_FORMAT_R8G8B8A8_SRGB;
+}
+
+// Copy the finished swapchain image into a buffer for each read that
+// waits for a frame.  The image is in PRESENT_SRC layout, whether the
+// render pass or vk_blit_scene wrote it last, and is left so.
+static void vk_record_screen_reads(const VkCommandBuffer cmd)
+{
+	const auto image = g_vk.swapchain_images[g_vk.current_image_index];
+	const auto extent = g_vk.swapchain_extent;
+	bool transitioned = false;
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	for (auto &r : g_vk.screen_reads)
+	{
+		if (r.submit_serial)
+			continue;
+		// vk_present assigns this serial to the submission
+		r.submit_serial = g_vk.submit_serial + 1;
+		r.extent = extent;
 		VkBufferCreateInfo bci{};
 		bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bci.size = VK_VERTEX_RING_SIZE;
-		bci.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		bci.size = VkDeviceSize{extent.width} * extent.height * 4;
+		bci.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		VmaAllocationCreateInfo aci{};
+		aci.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+		aci.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		VmaAllocationInfo info{};
+		if (vmaCreateBuffer(g_vk.allocator, &bci, &aci, &r.buffer, &r.allocation, &info) != VK_SUCCESS)
+		{
+			con_puts(CON_URGENT, "VK: Failed to create screen read buffer");
+			r.buffer = VK_NULL_HANDLE;
+			continue;
+		}
+		r.mapped = static_cast<const uint8_t *>(info.pMappedData);
+		if (!transitioned)
+		{
+			transitioned = true;
+			barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+		VkBufferImageCopy region{};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = {extent.width, extent.height, 1};
+		vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, r.buffer, 1, &region);
+	}
+	if (!transitioned)
+		return;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barrier.dstAccessMask = 0;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	// The copies must also be visible to the host once the fence signals
+	VkMemoryBarrier host{};
+	host.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	host.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	host.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+		0, 1, &host, 0, nullptr, 1, &barrier);
+}
 
-		VmaAllocationCreateInfo ai{};
-		ai.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-		ai.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+static void vk_destroy_screen_read(vk_screen_read &r)
+{
+	if (r.buffer)
+		vmaDestroyBuffer(g_vk.allocator, r.buffer, r.allocation);
+	r.buffer = VK_NULL_HANDLE;
+}
 
-		VmaAllocationInfo alloc_info{};
-		if (vmaCreateBuffer(g_vk.allocator, &bci, &ai, &frame.vertex_buffer,
-		                    &frame.vertex_allocation, &alloc_info) != VK_SUCCESS)
+// Pass on the reads whose copies have completed, in the order they were made
+static void vk_finish_screen_reads()
+{
+	while (!g_vk.screen_reads.empty())
+	{
+		auto &r = g_vk.screen_reads.front();
+		if (!r.submit_serial || r.submit_serial > g_vk.completed_serial)
+			return;
+		std::function<void(ogl_screen_image &&)> done;
+		ogl_screen_image image{r.extent.width, r.extent.height, false, {}};
+		if (r.buffer)
 		{
-			con_puts(CON_URGENT, "VK: Failed to create vertex ring buffer");
-			return false;
+			done = std::move(r.done);
+			const std::size_t pixels{std::size_t{image.w} * image.h};
+			image.rgb.resize(pixels * 3);
+			// Drop the alpha while copying out of the buffer
+			const bool bgra = vk_swapchain_format_bgra();
+			auto o = image.rgb.data();
+			for (const auto *p = r.mapped, *const e = p + pixels * 4; p != e; p += 4)
+			{
+				*o++ = p[bgra ? 2 : 0];
+				*o++ = p[1];
+				*o++ = p[bgra ? 0 : 2];
+			}
 		}
-		frame.vertex_mapped = alloc_info.pMappedData;
-		frame.vertex_offset = 0;
+		vk_destroy_screen_read(r);
+		g_vk.screen_reads.pop_front();
+		if (done)
+			done(std::move(image));
 	}
+}
+
+bool ogl_read_screen(std::function<void(ogl_screen_image &&)> done)
+{
+	// Reads queue on the GPU; more than this many are refused rather than
+	// stall a frame
+	constexpr std::size_t max_screen_reads{4};
+	if (!g_vk.initialized || !g_vk.swapchain_readable ||
+		!(vk_swapchain_format_bgra() || vk_swapchain_format_rgba()) ||
+		g_vk.screen_reads.size() >= max_screen_reads)
+		return false;
+	g_vk.screen_reads.emplace_back().done = std::move(done);
 	return true;
 }
 
+// ============================================================================
+// GPU timestamps
+// ============================================================================
+
+static void vk_create_timestamp_pool()
+{
+	if (!CGameArg.DbgRenderStats && !g_vk.scene_blit)
+		return;
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(g_vk.physical_device, &props);
+	uint32_t qf_count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(g_vk.physical_device, &qf_count, nullptr);
+	std::vector<VkQueueFamilyProperties> qf_props(qf_count);
+	vkGetPhysicalDeviceQueueFamilyProperties(g_vk.physical_device, &qf_count, qf_props.data());
+	if (!qf_props[g_vk.queue_family].timestampValidBits || !(props.limits.timestampPeriod > 0))
+	{
+		con_puts(CON_VERBOSE, "VK: GPU timestamps not supported on the graphics queue");
+		return;
+	}
+
+	VkQueryPoolCreateInfo qpci{};
+	qpci.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	qpci.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	qpci.queryCount = VK_TIMESTAMPS_PER_FRAME * VK_MAX_FRAMES_IN_FLIGHT;
+	if (vkCreateQueryPool(g_vk.device, &qpci, nullptr, &g_vk.timestamp_pool) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: Failed to create timestamp query pool");
+		return;
+	}
+	g_vk.timestamp_period = props.limits.timestampPeriod;
+}
+
+// Queued as a draw record, so it lands between the draws it separates
+static void vk_write_timestamp(vk_frame_data &frame, const vk_gpu_pass pass)
+{
+	auto &rec = frame.draw_records.emplace_back();
+	rec.vertex_count = 0;
+	rec.query = g_vk.current_frame * VK_TIMESTAMPS_PER_FRAME + frame.timestamp_count;
+	frame.timestamp_pass[frame.timestamp_count++] = pass;
+}
+
+// Called once the frame's fence has signalled.  Each interval between two
+// consecutive queries is charged to the pass that began it.  Mine and
+// object draws interleave segment by segment, so a pass total is the sum of
+// many short intervals rather than one contiguous span.
+static void vk_read_timestamps(vk_frame_data &frame)
+{
+	const uint32_t count = std::exchange(frame.timestamp_count, 0);
+	if (count < 2)
+		return;
+	std::array<uint64_t, VK_TIMESTAMPS_PER_FRAME> ticks;
+	if (vkGetQueryPoolResults(g_vk.device, g_vk.timestamp_pool, g_vk.current_frame * VK_TIMESTAMPS_PER_FRAME, count,
+	                          sizeof(ticks), ticks.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+		return;
+	std::array<float, VK_GPU_PASS_COUNT> ms{};
+	for (uint32_t i = 0; i + 1 < count; ++i)
+		ms[static_cast<std::size_t>(frame.timestamp_pass[i])] += (ticks[i + 1] - ticks[i]) * g_vk.timestamp_period * 1e-6f;
+	for (std::size_t i = 0; i < VK_GPU_PASS_COUNT; ++i)
+		g_vk.gpu_pass_ms[i] = (g_vk.gpu_pass_ms[i] * 7 + ms[i]) / 8;
+	if (g_vk.scene_blit)
+		vk_update_render_scale(std::accumulate(ms.begin(), ms.end(), 0.0f));
+}
+
+void vk_set_gpu_pass(const vk_gpu_pass pass)
+{
+	if (g_vk.gpu_pass == pass)
+		return;
+	g_vk.gpu_pass = pass;
+	if (!g_vk.timestamp_pool || !g_vk.frame_started)
+		return;
+	auto &frame = g_vk.frames[g_vk.current_frame];
+	// Keep the last query of the range for vk_end_frame
+	if (frame.timestamp_count + 1 >= VK_TIMESTAMPS_PER_FRAME)
+		return;
+	vk_flush_draws();
+	vk_write_timestamp(frame, pass);
+}
+
 static bool vk_create_white_texture()
 {
 	const uint8_t white[] = {255, 255, 255, 255};
@@ -540,6 +1155,7 @@ bool vk_init(SDL_Window *window, uint32_t w, uint32_t h)
 {
 	g_vk.screen_width = w;
 	g_vk.screen_height = h;
+	g_vk.window = window;
 
 	if (!vk_create_instance(window))
 		return false;
@@ -556,11 +1172,14 @@ bool vk_init(SDL_Window *window, uint32_t w, uint32_t h)
 		return false;
 	if (!vk_create_allocator())
 		return false;
+	if (const int dynres = CGameArg.OglVkDynResMin; dynres > 0 && dynres < 100)
+		g_vk.render_scale_min = std::max(dynres, 25) / 100.0f;
+	vk_reset_render_scale();
 	if (!vk_create_swapchain(w, h))
 		return false;
 	if (!vk_create_depth_buffer())
 		return false;
-	if (!vk_create_render_pass())
+	if (!vk_create_render_passes())
 		return false;
 	if (!vk_create_framebuffers())
 		return false;
@@ -570,49 +1189,165 @@ bool vk_init(SDL_Window *window, uint32_t w, uint32_t h)
 		return false;
 	if (!vk_create_per_frame_resources())
 		return false;
+	if (!vk_create_upload_resources())
+		return false;
+	if (!vk_create_record_workers())
+		return false;
 	if (!vk_create_pipelines())
 		return false;
 	if (!vk_create_white_texture())
 		return false;
+	vk_create_timestamp_pool();
 
 	vk_mat4_identity(g_vk.projection_matrix);
 	vk_mat4_identity(g_vk.modelview_matrix);
 	vk_mat4_identity(g_vk.mvp_matrix);
 
 	g_vk.initialized = true;
-	con_puts(CON_DEBUG, "VK: Initialization complete");
+	con_printf(CON_DEBUG, "VK: Initialization complete (%s, %u frames in flight)", vk_present_mode_name(g_vk.present_mode), g_vk.frames_in_flight);
 	SDL_Log("VK: Initialization complete");
 	return true;
 }
 
-bool vk_recreate_swapchain(uint32_t w, uint32_t h)
+static void vk_destroy_swapchain_objects(vk_retired_swapchain &sc)
 {
-	vkDeviceWaitIdle(g_vk.device);
-
-	// Cleanup old framebuffers and views
-	for (auto fb : g_vk.framebuffers)
+	for (auto fb : sc.framebuffers)
 		vkDestroyFramebuffer(g_vk.device, fb, nullptr);
-	g_vk.framebuffers.clear();
-
-	for (auto iv : g_vk.swapchain_views)
+	for (auto iv : sc.views)
 		vkDestroyImageView(g_vk.device, iv, nullptr);
-	g_vk.swapchain_views.clear();
+	if (sc.depth_view)
+		vkDestroyImageView(g_vk.device, sc.depth_view, nullptr);
+	if (sc.depth_image)
+		vmaDestroyImage(g_vk.allocator, sc.depth_image, sc.depth_allocation);
+	if (sc.scene_framebuffer)
+		vkDestroyFramebuffer(g_vk.device, sc.scene_framebuffer, nullptr);
+	if (sc.scene_view)
+		vkDestroyImageView(g_vk.device, sc.scene_view, nullptr);
+	if (sc.scene_image)
+		vmaDestroyImage(g_vk.allocator, sc.scene_image, sc.scene_allocation);
+	if (sc.swapchain)
+		vkDestroySwapchainKHR(g_vk.device, sc.swapchain, nullptr);
+}
 
-	if (g_vk.depth_view)
-		vkDestroyImageView(g_vk.device, g_vk.depth_view, nullptr);
-	if (g_vk.depth_image)
-		vmaDestroyImage(g_vk.allocator, g_vk.depth_image, g_vk.depth_allocation);
+static void vk_collect_retired_swapchains(const bool all)
+{
+	auto &retired = g_vk.retired_swapchains;
+	const auto completed = g_vk.completed_serial;
+	const auto keep = std::partition(retired.begin(), retired.end(), [all, completed](const vk_retired_swapchain &r) {
+		return !all && r.serial > completed;
+	});
+	for (auto i = keep; i != retired.end(); ++i)
+		vk_destroy_swapchain_objects(*i);
+	retired.erase(keep, retired.end());
+}
 
-	if (!vk_create_swapchain(w, h))
-		return false;
+// Move the swapchain and what was made for it into a record to retire
+static vk_retired_swapchain vk_take_swapchain_objects()
+{
+	vk_retired_swapchain old;
+	old.swapchain = g_vk.swapchain;
+	old.views = std::move(g_vk.swapchain_views);
+	old.framebuffers = std::move(g_vk.framebuffers);
+	old.depth_image = std::exchange(g_vk.depth_image, VK_NULL_HANDLE);
+	old.depth_allocation = std::exchange(g_vk.depth_allocation, VK_NULL_HANDLE);
+	old.depth_view = std::exchange(g_vk.depth_view, VK_NULL_HANDLE);
+	old.scene_image = std::exchange(g_vk.scene_image, VK_NULL_HANDLE);
+	old.scene_allocation = std::exchange(g_vk.scene_allocation, VK_NULL_HANDLE);
+	old.scene_view = std::exchange(g_vk.scene_view, VK_NULL_HANDLE);
+	old.scene_framebuffer = std::exchange(g_vk.scene_framebuffer, VK_NULL_HANDLE);
+	old.serial = g_vk.submit_serial;
+	g_vk.swapchain_views.clear();
+	g_vk.framebuffers.clear();
+	return old;
+}
+
+// Create what depends on the swapchain just created
+static bool vk_finish_swapchain(const VkFormat old_format)
+{
+	if (g_vk.swapchain_format != old_format)
+	{
+		con_puts(CON_VERBOSE, "VK: Surface format changed, rebuilding render pass and pipelines");
+		vkDeviceWaitIdle(g_vk.device);
+		vkDestroyRenderPass(g_vk.device, g_vk.render_pass, nullptr);
+		vkDestroyRenderPass(g_vk.device, g_vk.scene_render_pass, nullptr);
+		vk_destroy_pipelines();
+		if (!vk_create_render_passes() || !vk_create_pipelines())
+			return false;
+	}
 	if (!vk_create_depth_buffer())
 		return false;
 	if (!vk_create_framebuffers())
 		return false;
+	return true;
+}
 
+// Replace the swapchain, its framebuffers and the depth buffer.  The old
+// objects are handed to the new swapchain as oldSwapchain and destroyed
+// once the frames already submitted against them have completed, so
+// nothing waits for the device to go idle.  Pipelines and descriptors are
+// kept unless the surface format changed under the render pass.
+static bool vk_rebuild_swapchain()
+{
+	g_vk.swapchain_stale = false;
+	auto old{vk_take_swapchain_objects()};
+	const auto old_format = g_vk.swapchain_format;
+	const bool created = vk_create_swapchain(g_vk.screen_width, g_vk.screen_height);
+	// oldSwapchain is retired even when creation fails
+	g_vk.retired_swapchains.push_back(std::move(old));
+	if (!created)
+		return false;
+	return vk_finish_swapchain(old_format);
+}
+
+// Android destroys the surface of the window while the program is in the
+// background, and it then reports VK_ERROR_SURFACE_LOST_KHR.  Only the
+// surface and the swapchain depend on it, so the device, the textures and
+// the pipelines are kept, and resuming uploads nothing.  On failure, the
+// next frame tries again.
+static bool vk_recreate_surface()
+{
+	VkSurfaceKHR surface;
+	if (!SDL_Vulkan_CreateSurface(g_vk.window, g_vk.instance, &surface))
+	{
+		con_printf(CON_URGENT, "VK: SDL_Vulkan_CreateSurface failed: %s", SDL_GetError());
+		return false;
+	}
+	VkBool32 present_support = false;
+	vkGetPhysicalDeviceSurfaceSupportKHR(g_vk.physical_device, g_vk.queue_family, surface, &present_support);
+	if (!present_support)
+	{
+		con_puts(CON_URGENT, "VK: New surface cannot be presented from the graphics queue");
+		vkDestroySurfaceKHR(g_vk.instance, surface, nullptr);
+		return false;
+	}
+	// A swapchain of the old surface cannot be handed to one of the new
+	// surface, so it goes now, with everything that used it
+	vkDeviceWaitIdle(g_vk.device);
+	auto old{vk_take_swapchain_objects()};
+	vk_destroy_swapchain_objects(old);
+	vk_collect_retired_swapchains(true);
+	g_vk.swapchain = VK_NULL_HANDLE;
+	vkDestroySurfaceKHR(g_vk.instance, std::exchange(g_vk.surface, surface), nullptr);
+	const auto old_format = g_vk.swapchain_format;
+	if (!vk_create_swapchain(g_vk.screen_width, g_vk.screen_height))
+		return false;
+	g_vk.surface_lost = false;
+	con_puts(CON_VERBOSE, "VK: Surface lost, made it again and kept the device");
+	return vk_finish_swapchain(old_format);
+}
+
+bool vk_recreate_swapchain(uint32_t w, uint32_t h)
+{
 	g_vk.screen_width = w;
 	g_vk.screen_height = h;
-	return true;
+	// The frame being recorded targets an image of the current swapchain;
+	// vk_present rebuilds after queueing it
+	if (g_vk.frame_started)
+	{
+		g_vk.swapchain_stale = true;
+		return true;
+	}
+	return vk_rebuild_swapchain();
 }
 
 void vk_shutdown()
@@ -621,15 +1356,31 @@ void vk_shutdown()
 		return;
 
 	vkDeviceWaitIdle(g_vk.device);
+	vk_destroy_record_workers();
+	vk_collect_retired_swapchains(true);
+	// The game is closing; reads not yet passed on are dropped
+	for (auto &r : g_vk.screen_reads)
+		vk_destroy_screen_read(r);
+	g_vk.screen_reads.clear();
+
+	con_printf(CON_VERBOSE, "VK: peak vertex ring usage %u KiB per frame (chunk size %u KiB)",
+	           g_vk.vertex_peak_bytes / 1024, static_cast<unsigned>(VK_VERTEX_RING_SIZE / 1024));
+
+	vk_release_bitmap_textures();
+	vk_collect_retired_textures(true);
+	ogl_free_static_geometry();
 
 	// Destroy white texture
 	vk_destroy_texture(&g_vk.white_texture);
+	vk_destroy_upload_resources();
 
 	// Destroy per-frame resources
 	for (auto &frame : g_vk.frames)
 	{
-		if (frame.vertex_buffer)
-			vmaDestroyBuffer(g_vk.allocator, frame.vertex_buffer, frame.vertex_allocation);
+		for (auto &chunk : frame.vertex_chunks)
+			vk_destroy_vertex_chunk(chunk);
+		if (frame.index_buffer)
+			vmaDestroyBuffer(g_vk.allocator, frame.index_buffer, frame.index_allocation);
 		if (frame.fence)
 			vkDestroyFence(g_vk.device, frame.fence, nullptr);
 		if (frame.render_finished)
@@ -639,9 +1390,15 @@ void vk_shutdown()
 	}
 
 	vk_destroy_pipelines();
+	vk_destroy_pipeline_cache();
+
+	if (g_vk.timestamp_pool)
+		vkDestroyQueryPool(g_vk.device, g_vk.timestamp_pool, nullptr);
 
 	if (g_vk.descriptor_set_layout)
 		vkDestroyDescriptorSetLayout(g_vk.device, g_vk.descriptor_set_layout, nullptr);
+	if (g_vk.static_set_layout)
+		vkDestroyDescriptorSetLayout(g_vk.device, g_vk.static_set_layout, nullptr);
 	if (g_vk.descriptor_pool)
 		vkDestroyDescriptorPool(g_vk.device, g_vk.descriptor_pool, nullptr);
 	if (g_vk.command_pool)
@@ -649,8 +1406,16 @@ void vk_shutdown()
 
 	for (auto fb : g_vk.framebuffers)
 		vkDestroyFramebuffer(g_vk.device, fb, nullptr);
+	if (g_vk.scene_framebuffer)
+		vkDestroyFramebuffer(g_vk.device, g_vk.scene_framebuffer, nullptr);
+	if (g_vk.scene_view)
+		vkDestroyImageView(g_vk.device, g_vk.scene_view, nullptr);
+	if (g_vk.scene_image)
+		vmaDestroyImage(g_vk.allocator, g_vk.scene_image, g_vk.scene_allocation);
 	if (g_vk.render_pass)
 		vkDestroyRenderPass(g_vk.device, g_vk.render_pass, nullptr);
+	if (g_vk.scene_render_pass)
+		vkDestroyRenderPass(g_vk.device, g_vk.scene_render_pass, nullptr);
 
 	if (g_vk.depth_view)
 		vkDestroyImageView(g_vk.device, g_vk.depth_view, nullptr);
@@ -689,15 +1454,35 @@ bool vk_begin_frame()
 		SDL_Log("VK: vkWaitForFences timed out (frame %u)", g_vk.current_frame);
 		return false;
 	}
+	if (frame.present_time)
+	{
+		const fix64 latency = timer_query() - std::exchange(frame.present_time, 0);
+		g_vk.present_latency = g_vk.present_latency ? (g_vk.present_latency * 7 + latency) / 8 : latency;
+	}
+	if (g_vk.timestamp_pool)
+		vk_read_timestamps(frame);
+	if (g_vk.surface_lost && !vk_recreate_surface())
+		return false;
 
 	VkResult result = vkAcquireNextImageKHR(g_vk.device, g_vk.swapchain, 1000000000ULL,
 	                                         frame.image_available, VK_NULL_HANDLE,
 	                                         &g_vk.current_image_index);
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		vk_rebuild_swapchain();
+		return false;
+	}
+	if (result == VK_ERROR_SURFACE_LOST_KHR)
 	{
-		vk_recreate_swapchain(g_vk.screen_width, g_vk.screen_height);
+		g_vk.surface_lost = true;
 		return false;
 	}
+	// A suboptimal image has been acquired and must still be presented
+	if (result == VK_SUBOPTIMAL_KHR)
+	{
+		g_vk.swapchain_stale = true;
+		result = VK_SUCCESS;
+	}
 	if (result == VK_TIMEOUT || result == VK_NOT_READY)
 	{
 		SDL_Log("VK: vkAcquireNextImageKHR timed out/not ready");
@@ -709,6 +1494,12 @@ bool vk_begin_frame()
 		return false;
 	}
 
+	// Everything submitted from this frame slot has completed
+	g_vk.completed_serial = std::max(g_vk.completed_serial, frame.submit_serial);
+	vk_collect_retired_textures(false);
+	vk_collect_retired_swapchains(false);
+	vk_finish_screen_reads();
+
 	vkResetFences(g_vk.device, 1, &frame.fence);
 	vkResetCommandBuffer(frame.cmd, 0);
 
@@ -716,25 +1507,36 @@ bool vk_begin_frame()
 	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 	vkBeginCommandBuffer(frame.cmd, &begin_info);
+	if (g_vk.timestamp_pool)
+		vkCmdResetQueryPool(frame.cmd, g_vk.timestamp_pool, g_vk.current_frame * VK_TIMESTAMPS_PER_FRAME, VK_TIMESTAMPS_PER_FRAME);
 
-	std::array<VkClearValue, 2> clear_values{};
-	clear_values[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
-	clear_values[1].depthStencil = {1.0f, 0};
+	// The render pass itself is recorded by vk_end_frame
+	frame.draw_records.clear();
+	g_vk.frame_started = true;
 
-	VkRenderPassBeginInfo rpbi{};
-	rpbi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	rpbi.renderPass = g_vk.render_pass;
-	rpbi.framebuffer = g_vk.framebuffers[g_vk.current_image_index];
-	rpbi.renderArea.extent = g_vk.swapchain_extent;
-	rpbi.clearValueCount = static_cast<uint32_t>(clear_values.size());
-	rpbi.pClearValues = clear_values.data();
-	vkCmdBeginRenderPass(frame.cmd, &rpbi, VK_SUBPASS_CONTENTS_INLINE);
+	// Until ogl_start_frame says otherwise, the frame is 2D
+	g_vk.gpu_pass = vk_gpu_pass::blit_2d;
+	if (g_vk.timestamp_pool)
+		vk_write_timestamp(frame, g_vk.gpu_pass);
 
-	g_vk.in_render_pass = true;
-	g_vk.frame_started = true;
+	// The fence has signalled, so the GPU no longer reads this frame's chunks
+	if (frame.vertex_chunk != 0)
+		frame.vertex_quiet_frames = 0;
+	else if (frame.vertex_chunks.size() > 1 && ++frame.vertex_quiet_frames >= VK_VERTEX_RING_TRIM_FRAMES)
+	{
+		vk_trim_vertex_chunks(frame);
+		frame.vertex_quiet_frames = 0;
+	}
+	frame.vertex_chunk = 0;
 	frame.vertex_offset = 0;
+	frame.index_offset = 0;
 	g_vk.bound_texture = VK_NULL_HANDLE;
 
+	// A fresh command buffer has no bound state
+	g_vk.batch = {};
+	g_vk.last_draw_stats = g_vk.draw_stats;
+	g_vk.draw_stats = {};
+
 	return true;
 }
 
@@ -743,13 +1545,38 @@ void vk_end_frame()
 	if (!g_vk.frame_started)
 		return;
 
+	vk_flush_draws();
+
 	auto &frame = g_vk.frames[g_vk.current_frame];
+	if (g_vk.timestamp_pool)
+		vk_write_timestamp(frame, g_vk.gpu_pass);
 
-	if (g_vk.in_render_pass)
-	{
-		vkCmdEndRenderPass(frame.cmd);
-		g_vk.in_render_pass = false;
-	}
+	const uint32_t vertex_bytes = static_cast<uint32_t>(frame.vertex_chunk * VK_VERTEX_RING_SIZE + frame.vertex_offset);
+	g_vk.draw_stats.vertex_bytes = vertex_bytes;
+	g_vk.vertex_peak_bytes = std::max(g_vk.vertex_peak_bytes, vertex_bytes);
+
+	std::array<VkClearValue, 2> clear_values{};
+	clear_values[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+	clear_values[1].depthStencil = {1.0f, 0};
+
+	// At full scale the frame renders straight into the swapchain image
+	frame.render_scale = g_vk.scene_blit ? g_vk.render_scale : 1.0f;
+	const bool scaled = frame.render_scale < 1.0f;
+	frame.framebuffer = scaled ? g_vk.scene_framebuffer : g_vk.framebuffers[g_vk.current_image_index];
+
+	VkRenderPassBeginInfo rpbi{};
+	rpbi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	rpbi.renderPass = scaled ? g_vk.scene_render_pass : g_vk.render_pass;
+	rpbi.framebuffer = frame.framebuffer;
+	rpbi.renderArea.extent = scaled ? vk_scene_extent(frame.render_scale) : g_vk.swapchain_extent;
+	rpbi.clearValueCount = static_cast<uint32_t>(clear_values.size());
+	rpbi.pClearValues = clear_values.data();
+	vk_record_frame(frame, rpbi);
+	frame.draw_records.clear();
+	if (scaled)
+		vk_blit_scene(frame.cmd, rpbi.renderArea.extent);
+	if (!g_vk.screen_reads.empty())
+		vk_record_screen_reads(frame.cmd);
 
 	vkEndCommandBuffer(frame.cmd);
 	g_vk.frame_started = false;
@@ -761,15 +1588,29 @@ void vk_present()
 
 	VkSubmitInfo submit{};
 	submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	submit.waitSemaphoreCount = 1;
-	submit.pWaitSemaphores = &frame.image_available;
-	submit.pWaitDstStageMask = &wait_stage;
 	submit.commandBufferCount = 1;
 	submit.pCommandBuffers = &frame.cmd;
 	submit.signalSemaphoreCount = 1;
 	submit.pSignalSemaphores = &frame.render_finished;
 
+	// Texture copies recorded during this frame go first
+	vk_submit_uploads();
+	std::array<VkSemaphore, VK_UPLOAD_BATCHES + 1> wait_semaphores;
+	std::array<VkPipelineStageFlags, VK_UPLOAD_BATCHES + 1> wait_stages;
+	uint32_t wait_count = 0;
+	wait_semaphores[wait_count] = frame.image_available;
+	wait_stages[wait_count++] = frame.render_scale < 1.0f ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	for (const auto s : g_vk.upload_waits)
+	{
+		wait_semaphores[wait_count] = s;
+		wait_stages[wait_count++] = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
+	g_vk.upload_waits.clear();
+	submit.waitSemaphoreCount = wait_count;
+	submit.pWaitSemaphores = wait_semaphores.data();
+	submit.pWaitDstStageMask = wait_stages.data();
+
+	frame.submit_serial = ++g_vk.submit_serial;
 	VkResult submit_result = vkQueueSubmit(g_vk.graphics_queue, 1, &submit, frame.fence);
 	if (submit_result != VK_SUCCESS)
 		SDL_Log("VK: vkQueueSubmit failed: %d", submit_result);
@@ -783,10 +1624,18 @@ void vk_present()
 	present.pImageIndices = &g_vk.current_image_index;
 
 	VkResult present_result = vkQueuePresentKHR(g_vk.graphics_queue, &present);
-	if (present_result != VK_SUCCESS && present_result != VK_SUBOPTIMAL_KHR)
+	if (present_result == VK_ERROR_OUT_OF_DATE_KHR || present_result == VK_SUBOPTIMAL_KHR)
+		g_vk.swapchain_stale = true;
+	else if (present_result == VK_ERROR_SURFACE_LOST_KHR)
+		g_vk.surface_lost = true;
+	else if (present_result != VK_SUCCESS)
 		SDL_Log("VK: vkQueuePresentKHR failed: %d", present_result);
+	frame.present_time = timer_query();
 
-	g_vk.current_frame = (g_vk.current_frame + 1) % VK_MAX_FRAMES_IN_FLIGHT;
+	g_vk.current_frame = (g_vk.current_frame + 1) % g_vk.frames_in_flight;
+	// A lost surface is made again by the next vk_begin_frame
+	if (g_vk.swapchain_stale && !g_vk.surface_lost)
+		vk_rebuild_swapchain();
 }
 
 }  // namespace dcx
@@ -8,6 +8,7 @@
 
 #include "vk_common.h"
 #include "console.h"
+#include "physfsx.h"
 
 // Embedded SPIR-V shaders (generated by glslangValidator at build time)
 // Defined at global scope in vk_shaders.cpp
@@ -19,9 +20,138 @@ extern const uint32_t textured_vert_spv[];
 extern const uint32_t textured_vert_spv_size;
 extern const uint32_t textured_frag_spv[];
 extern const uint32_t textured_frag_spv_size;
+extern const uint32_t textured_array_vert_spv[];
+extern const uint32_t textured_array_vert_spv_size;
+extern const uint32_t textured_array_frag_spv[];
+extern const uint32_t textured_array_frag_spv_size;
+extern const uint32_t circle_frag_spv[];
+extern const uint32_t circle_frag_spv_size;
+extern const uint32_t static_vert_spv[];
+extern const uint32_t static_vert_spv_size;
+extern const uint32_t static_array_vert_spv[];
+extern const uint32_t static_array_vert_spv_size;
+extern const uint32_t overlay_array_vert_spv[];
+extern const uint32_t overlay_array_vert_spv_size;
+extern const uint32_t overlay_array_frag_spv[];
+extern const uint32_t overlay_array_frag_spv_size;
 
 namespace dcx {
 
+// ============================================================================
+// Pipeline cache
+// ============================================================================
+
+#define DXX_VK_PIPELINE_CACHE_NAME	"vkpipeline.bin"
+
+namespace {
+
+// Written ahead of the driver's cache data.  Some drivers do not validate
+// the data they are given, so it is only passed back to the same device
+// and driver build that produced it.
+struct vk_pipeline_cache_header
+{
+	static constexpr uint32_t magic_value = 0x4b565844;	// "DXVK"
+	uint32_t magic;
+	uint32_t header_size;
+	uint32_t vendor_id;
+	uint32_t device_id;
+	uint32_t driver_version;
+	uint8_t uuid[VK_UUID_SIZE];
+	uint32_t data_size;
+};
+
+}
+
+static vk_pipeline_cache_header vk_pipeline_cache_expected_header()
+{
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(g_vk.physical_device, &props);
+	vk_pipeline_cache_header h{};
+	h.magic = vk_pipeline_cache_header::magic_value;
+	h.header_size = sizeof(h);
+	h.vendor_id = props.vendorID;
+	h.device_id = props.deviceID;
+	h.driver_version = props.driverVersion;
+	memcpy(h.uuid, props.pipelineCacheUUID, sizeof(h.uuid));
+	return h;
+}
+
+// Read the saved cache data, if it was written for this device and driver
+static std::vector<uint8_t> vk_read_pipeline_cache()
+{
+	std::vector<uint8_t> data;
+	const auto &&[f, physfserr]{PHYSFSX_openReadBuffered(DXX_VK_PIPELINE_CACHE_NAME)};
+	if (!f)
+	{
+		con_printf(physfserr == PHYSFS_ERR_NOT_FOUND ? CON_VERBOSE : CON_NORMAL, "VK: Failed to read \"" DXX_VK_PIPELINE_CACHE_NAME "\": %s", PHYSFS_getErrorByCode(physfserr));
+		return data;
+	}
+	vk_pipeline_cache_header h;
+	const auto expected = vk_pipeline_cache_expected_header();
+	if (PHYSFS_readBytes(f, &h, sizeof(h)) != sizeof(h) ||
+		memcmp(&h, &expected, offsetof(vk_pipeline_cache_header, data_size)))
+	{
+		con_puts(CON_VERBOSE, "VK: Discarding pipeline cache from a different device or driver");
+		return data;
+	}
+	if (PHYSFS_fileLength(f) != static_cast<PHYSFS_sint64>(sizeof(h) + h.data_size))
+	{
+		con_puts(CON_NORMAL, "VK: Discarding truncated pipeline cache");
+		return data;
+	}
+	data.resize(h.data_size);
+	if (PHYSFS_readBytes(f, data.data(), data.size()) != static_cast<PHYSFS_sint64>(data.size()))
+		data.clear();
+	return data;
+}
+
+static bool vk_create_pipeline_cache()
+{
+	const auto data = vk_read_pipeline_cache();
+	VkPipelineCacheCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	ci.initialDataSize = data.size();
+	ci.pInitialData = data.empty() ? nullptr : data.data();
+	if (vkCreatePipelineCache(g_vk.device, &ci, nullptr, &g_vk.pipeline_cache) == VK_SUCCESS)
+	{
+		if (!data.empty())
+			con_printf(CON_DEBUG, "VK: Loaded %u byte pipeline cache", static_cast<unsigned>(data.size()));
+		return !data.empty();
+	}
+	// Rejected data: start over with an empty cache
+	ci.initialDataSize = 0;
+	ci.pInitialData = nullptr;
+	if (vkCreatePipelineCache(g_vk.device, &ci, nullptr, &g_vk.pipeline_cache) != VK_SUCCESS)
+		g_vk.pipeline_cache = VK_NULL_HANDLE;
+	return false;
+}
+
+static void vk_save_pipeline_cache()
+{
+	if (!g_vk.pipeline_cache)
+		return;
+	size_t size = 0;
+	if (vkGetPipelineCacheData(g_vk.device, g_vk.pipeline_cache, &size, nullptr) != VK_SUCCESS || !size)
+		return;
+	std::vector<uint8_t> data(size);
+	if (vkGetPipelineCacheData(g_vk.device, g_vk.pipeline_cache, &size, data.data()) != VK_SUCCESS)
+		return;
+	auto &&[f, physfserr]{PHYSFSX_openWriteBuffered(DXX_VK_PIPELINE_CACHE_NAME)};
+	if (!f)
+	{
+		con_printf(CON_NORMAL, "VK: Failed to write \"" DXX_VK_PIPELINE_CACHE_NAME "\": %s", PHYSFS_getErrorByCode(physfserr));
+		return;
+	}
+	auto h = vk_pipeline_cache_expected_header();
+	h.data_size = static_cast<uint32_t>(size);
+	PHYSFSX_writeBytes(f, &h, sizeof(h));
+	PHYSFSX_writeBytes(f, data.data(), size);
+}
+
+// ============================================================================
+// Pipelines
+// ============================================================================
+
 static VkShaderModule create_shader_module(const uint32_t *code, uint32_t size)
 {
 	VkShaderModuleCreateInfo ci{};
@@ -36,11 +166,13 @@ static VkShaderModule create_shader_module(const uint32_t *code, uint32_t size)
 }
 
 static VkPipeline create_pipeline(
+	const vk_pipeline_id id,
 	VkShaderModule vert, VkShaderModule frag,
 	VkPrimitiveTopology topology,
 	bool depth_test, bool depth_write,
 	VkBlendFactor src_blend, VkBlendFactor dst_blend,
-	float line_width)
+	float line_width,
+	const VkSpecializationInfo *const frag_specialization = nullptr)
 {
 	std::array<VkPipelineShaderStageCreateInfo, 2> stages{};
 	stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -51,23 +183,55 @@ static VkPipeline create_pipeline(
 	stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 	stages[1].module = frag;
 	stages[1].pName = "main";
-
-	// Vertex input: position(3) + color(4) + texcoord(2)
+	stages[1].pSpecializationInfo = frag_specialization;
+
+	// Vertex input: position(3, or 2 for 2D) + RGBA8 color + half texcoord(2)
+	// + half array layer.  A 2D position reads as z = 0 in the shaders.
+	// Static pipelines replace the position with a corner index and add
+	// vk_ring_vertex_static::flags.  The 3D overlay pipeline adds
+	// vk_ring_vertex_3d::overlay.
+	const bool is_2d = vk_pipeline_is_2d(id);
 	VkVertexInputBindingDescription binding{};
 	binding.binding = 0;
-	binding.stride = sizeof(vk_vertex);
+	binding.stride = vk_ring_vertex_size(id);
 	binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-	std::array<VkVertexInputAttributeDescription, 3> attrs{};
-	attrs[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(vk_vertex, x)};
-	attrs[1] = {1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(vk_vertex, r)};
-	attrs[2] = {2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(vk_vertex, u)};
+	std::array<VkVertexInputAttributeDescription, 5> attrs{};
+	uint32_t attr_count = 4;
+	if (vk_pipeline_is_static(id))
+	{
+		attrs[0] = {0, 0, VK_FORMAT_R32_UINT, offsetof(vk_ring_vertex_static, corner)};
+		attrs[1] = {1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(vk_ring_vertex_static, color)};
+		attrs[2] = {2, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(vk_ring_vertex_static, u)};
+		attrs[3] = {3, 0, VK_FORMAT_R16_SFLOAT, offsetof(vk_ring_vertex_static, layer)};
+		attrs[4] = {4, 0, VK_FORMAT_R16_UINT, offsetof(vk_ring_vertex_static, flags)};
+		attr_count = 5;
+	}
+	else if (is_2d)
+	{
+		attrs[0] = {0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(vk_ring_vertex_2d, x)};
+		attrs[1] = {1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(vk_ring_vertex_2d, color)};
+		attrs[2] = {2, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(vk_ring_vertex_2d, u)};
+		attrs[3] = {3, 0, VK_FORMAT_R16_SFLOAT, offsetof(vk_ring_vertex_2d, layer)};
+	}
+	else
+	{
+		attrs[0] = {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(vk_ring_vertex_3d, x)};
+		attrs[1] = {1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(vk_ring_vertex_3d, color)};
+		attrs[2] = {2, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(vk_ring_vertex_3d, u)};
+		attrs[3] = {3, 0, VK_FORMAT_R16_SFLOAT, offsetof(vk_ring_vertex_3d, layer)};
+		if (id == VK_PIPE_OVERLAY_ARRAY_3D)
+		{
+			attrs[4] = {4, 0, VK_FORMAT_R16_UINT, offsetof(vk_ring_vertex_3d, overlay)};
+			attr_count = 5;
+		}
+	}
 
 	VkPipelineVertexInputStateCreateInfo vertex_input{};
 	vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 	vertex_input.vertexBindingDescriptionCount = 1;
 	vertex_input.pVertexBindingDescriptions = &binding;
-	vertex_input.vertexAttributeDescriptionCount = static_cast<uint32_t>(attrs.size());
+	vertex_input.vertexAttributeDescriptionCount = attr_count;
 	vertex_input.pVertexAttributeDescriptions = attrs.data();
 
 	VkPipelineInputAssemblyStateCreateInfo input_assembly{};
@@ -138,14 +302,14 @@ static VkPipeline create_pipeline(
 	pci.subpass = 0;
 
 	VkPipeline pipeline;
-	if (vkCreateGraphicsPipelines(g_vk.device, VK_NULL_HANDLE, 1, &pci, nullptr, &pipeline) != VK_SUCCESS)
+	if (vkCreateGraphicsPipelines(g_vk.device, g_vk.pipeline_cache, 1, &pci, nullptr, &pipeline) != VK_SUCCESS)
 		return VK_NULL_HANDLE;
 	return pipeline;
 }
 
 bool vk_create_pipelines()
 {
-	// Pipeline layout: push constants + 1 descriptor set (textures)
+	// Pipeline layout: push constants + 2 descriptor sets (textures, static geometry)
 	VkPushConstantRange push_range{};
 	push_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 	push_range.offset = 0;
@@ -153,8 +317,9 @@ bool vk_create_pipelines()
 
 	VkPipelineLayoutCreateInfo plci{};
 	plci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	plci.setLayoutCount = 1;
-	plci.pSetLayouts = &g_vk.descriptor_set_layout;
+	const std::array<VkDescriptorSetLayout, 2> set_layouts{{g_vk.descriptor_set_layout, g_vk.static_set_layout}};
+	plci.setLayoutCount = static_cast<uint32_t>(set_layouts.size());
+	plci.pSetLayouts = set_layouts.data();
 	plci.pushConstantRangeCount = 1;
 	plci.pPushConstantRanges = &push_range;
 
@@ -164,13 +329,24 @@ bool vk_create_pipelines()
 		return false;
 	}
 
+	// The cache lives as long as the device, so pipelines rebuilt later
+	// (e.g. for a new render pass) are served from it too
+	const bool cache_loaded = g_vk.pipeline_cache ? true : vk_create_pipeline_cache();
+
 	// Load shader modules
 	VkShaderModule basic_vert = create_shader_module(basic_vert_spv, basic_vert_spv_size);
 	VkShaderModule basic_frag = create_shader_module(basic_frag_spv, basic_frag_spv_size);
 	VkShaderModule tex_vert = create_shader_module(textured_vert_spv, textured_vert_spv_size);
 	VkShaderModule tex_frag = create_shader_module(textured_frag_spv, textured_frag_spv_size);
-
-	if (!basic_vert || !basic_frag || !tex_vert || !tex_frag)
+	VkShaderModule array_vert = create_shader_module(textured_array_vert_spv, textured_array_vert_spv_size);
+	VkShaderModule array_frag = create_shader_module(textured_array_frag_spv, textured_array_frag_spv_size);
+	VkShaderModule circle_frag = create_shader_module(circle_frag_spv, circle_frag_spv_size);
+	VkShaderModule static_vert = create_shader_module(static_vert_spv, static_vert_spv_size);
+	VkShaderModule static_array_vert = create_shader_module(static_array_vert_spv, static_array_vert_spv_size);
+	VkShaderModule overlay_vert = create_shader_module(overlay_array_vert_spv, overlay_array_vert_spv_size);
+	VkShaderModule overlay_frag = create_shader_module(overlay_array_frag_spv, overlay_array_frag_spv_size);
+
+	if (!basic_vert || !basic_frag || !tex_vert || !tex_frag || !array_vert || !array_frag || !circle_frag || !static_vert || !static_array_vert || !overlay_vert || !overlay_frag)
 	{
 		con_puts(CON_URGENT, "VK: Failed to create shader modules");
 		return false;
@@ -184,39 +360,102 @@ bool vk_create_pipelines()
 		{VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA},  // normal
 		{VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE},                  // additive_a
 		{VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ONE},                        // additive_c
+		{VK_BLEND_FACTOR_ZERO, VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR},       // subtractive_c
 	};
 
 	for (int b = 0; b < VK_BLEND_COUNT; b++)
 	{
 		// Textured 3D
-		g_vk.pipelines[VK_PIPE_TEXTURED_3D][b] = create_pipeline(
+		g_vk.pipelines[VK_PIPE_TEXTURED_3D][b] = create_pipeline(VK_PIPE_TEXTURED_3D,
 			tex_vert, tex_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
 			true, true, blends[b].src, blends[b].dst, 1.0f);
 
 		// Flat 3D
-		g_vk.pipelines[VK_PIPE_FLAT_3D][b] = create_pipeline(
+		g_vk.pipelines[VK_PIPE_FLAT_3D][b] = create_pipeline(VK_PIPE_FLAT_3D,
 			basic_vert, basic_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
 			true, true, blends[b].src, blends[b].dst, 1.0f);
 
 		// Line 3D
-		g_vk.pipelines[VK_PIPE_LINE_3D][b] = create_pipeline(
+		g_vk.pipelines[VK_PIPE_LINE_3D][b] = create_pipeline(VK_PIPE_LINE_3D,
 			basic_vert, basic_frag, VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
 			true, false, blends[b].src, blends[b].dst, 1.0f);
 
+		// Textured 3D from the level texture array
+		g_vk.pipelines[VK_PIPE_TEXTURED_ARRAY_3D][b] = create_pipeline(VK_PIPE_TEXTURED_ARRAY_3D,
+			array_vert, array_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			true, true, blends[b].src, blends[b].dst, 1.0f);
+
 		// Textured 2D
-		g_vk.pipelines[VK_PIPE_TEXTURED_2D][b] = create_pipeline(
+		g_vk.pipelines[VK_PIPE_TEXTURED_2D][b] = create_pipeline(VK_PIPE_TEXTURED_2D,
 			tex_vert, tex_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
 			false, false, blends[b].src, blends[b].dst, 1.0f);
 
 		// Flat 2D
-		g_vk.pipelines[VK_PIPE_FLAT_2D][b] = create_pipeline(
+		g_vk.pipelines[VK_PIPE_FLAT_2D][b] = create_pipeline(VK_PIPE_FLAT_2D,
 			basic_vert, basic_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
 			false, false, blends[b].src, blends[b].dst, 1.0f);
 
 		// Line 2D
-		g_vk.pipelines[VK_PIPE_LINE_2D][b] = create_pipeline(
+		g_vk.pipelines[VK_PIPE_LINE_2D][b] = create_pipeline(VK_PIPE_LINE_2D,
 			basic_vert, basic_frag, VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
 			false, false, blends[b].src, blends[b].dst, 1.0f);
+
+		// Circles: one quad each, the array vertex shader passes the
+		// inner radius through in the layer attribute
+		g_vk.pipelines[VK_PIPE_CIRCLE_3D][b] = create_pipeline(VK_PIPE_CIRCLE_3D,
+			array_vert, circle_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			true, true, blends[b].src, blends[b].dst, 1.0f);
+		g_vk.pipelines[VK_PIPE_CIRCLE_2D][b] = create_pipeline(VK_PIPE_CIRCLE_2D,
+			array_vert, circle_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			false, false, blends[b].src, blends[b].dst, 1.0f);
+
+		// Walls from the static geometry buffer
+		g_vk.pipelines[VK_PIPE_STATIC_3D][b] = create_pipeline(VK_PIPE_STATIC_3D,
+			static_vert, tex_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			true, true, blends[b].src, blends[b].dst, 1.0f);
+		g_vk.pipelines[VK_PIPE_STATIC_ARRAY_3D][b] = create_pipeline(VK_PIPE_STATIC_ARRAY_3D,
+			static_array_vert, array_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			true, true, blends[b].src, blends[b].dst, 1.0f);
+
+		// Walls with an overlay, both textures from the level texture
+		// array.  static_array_vert passes the overlay through for these.
+		g_vk.pipelines[VK_PIPE_OVERLAY_ARRAY_3D][b] = create_pipeline(VK_PIPE_OVERLAY_ARRAY_3D,
+			overlay_vert, overlay_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			true, true, blends[b].src, blends[b].dst, 1.0f);
+		g_vk.pipelines[VK_PIPE_STATIC_OVERLAY_ARRAY_3D][b] = create_pipeline(VK_PIPE_STATIC_OVERLAY_ARRAY_3D,
+			static_array_vert, overlay_frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+			true, true, blends[b].src, blends[b].dst, 1.0f);
+	}
+
+	// Opaque walls: the textured shaders' alpha_test constant is false, so
+	// the fragments are never discarded and the depth test can run before
+	// the shader
+	{
+		const VkBool32 alpha_test = VK_FALSE;
+		const VkSpecializationMapEntry entry{0, 0, sizeof(alpha_test)};
+		VkSpecializationInfo opaque{};
+		opaque.mapEntryCount = 1;
+		opaque.pMapEntries = &entry;
+		opaque.dataSize = sizeof(alpha_test);
+		opaque.pData = &alpha_test;
+		const auto &normal = blends[VK_BLEND_NORMAL];
+		struct opaque_variant {
+			vk_pipeline_id id;
+			VkShaderModule vert, frag;
+		};
+		const std::array<opaque_variant, 6> variants{{
+			{VK_PIPE_TEXTURED_3D, tex_vert, tex_frag},
+			{VK_PIPE_TEXTURED_ARRAY_3D, array_vert, array_frag},
+			{VK_PIPE_STATIC_3D, static_vert, tex_frag},
+			{VK_PIPE_STATIC_ARRAY_3D, static_array_vert, array_frag},
+			{VK_PIPE_OVERLAY_ARRAY_3D, overlay_vert, overlay_frag},
+			{VK_PIPE_STATIC_OVERLAY_ARRAY_3D, static_array_vert, overlay_frag},
+		}};
+		for (const auto &v : variants)
+			if (!(g_vk.opaque_pipelines[v.id] = create_pipeline(v.id,
+				v.vert, v.frag, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+				true, true, normal.src, normal.dst, 1.0f, &opaque)))
+				con_printf(CON_URGENT, "VK: Failed to create opaque pipeline %d", v.id);
 	}
 
 	// Cleanup shader modules (no longer needed after pipeline creation)
@@ -224,6 +463,13 @@ bool vk_create_pipelines()
 	vkDestroyShaderModule(g_vk.device, basic_frag, nullptr);
 	vkDestroyShaderModule(g_vk.device, tex_vert, nullptr);
 	vkDestroyShaderModule(g_vk.device, tex_frag, nullptr);
+	vkDestroyShaderModule(g_vk.device, array_vert, nullptr);
+	vkDestroyShaderModule(g_vk.device, array_frag, nullptr);
+	vkDestroyShaderModule(g_vk.device, circle_frag, nullptr);
+	vkDestroyShaderModule(g_vk.device, static_vert, nullptr);
+	vkDestroyShaderModule(g_vk.device, static_array_vert, nullptr);
+	vkDestroyShaderModule(g_vk.device, overlay_vert, nullptr);
+	vkDestroyShaderModule(g_vk.device, overlay_frag, nullptr);
 
 	// Verify all pipelines were created
 	for (int p = 0; p < VK_PIPE_COUNT; p++)
@@ -234,12 +480,23 @@ bool vk_create_pipelines()
 				return false;
 			}
 
+	// Save a fresh cache right away, so the next launch benefits even if
+	// this one does not exit cleanly
+	if (!cache_loaded)
+		vk_save_pipeline_cache();
+
 	con_puts(CON_DEBUG, "VK: All pipelines created");
 	return true;
 }
 
 void vk_destroy_pipelines()
 {
+	for (auto &p : g_vk.opaque_pipelines)
+		if (p)
+		{
+			vkDestroyPipeline(g_vk.device, p, nullptr);
+			p = VK_NULL_HANDLE;
+		}
 	for (int p = 0; p < VK_PIPE_COUNT; p++)
 		for (int b = 0; b < VK_BLEND_COUNT; b++)
 			if (g_vk.pipelines[p][b])
@@ -254,6 +511,15 @@ void vk_destroy_pipelines()
 	}
 }
 
+void vk_destroy_pipeline_cache()
+{
+	if (!g_vk.pipeline_cache)
+		return;
+	vk_save_pipeline_cache();
+	vkDestroyPipelineCache(g_vk.device, g_vk.pipeline_cache, nullptr);
+	g_vk.pipeline_cache = VK_NULL_HANDLE;
+}
+
 }  // namespace dcx
 
 #endif  // DXX_USE_VULKAN
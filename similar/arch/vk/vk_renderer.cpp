@@ -36,8 +36,15 @@
 #include "d_levelstate.h"
 #include "d_zip.h"
 #include "partial_range.h"
+#include "mem_trim.h"
+#include "ogl_texture_pool.h"
+#include "ogl_texture_prep.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <span>
+#include <thread>
 #include <memory>
 #include <stdexcept>
 using std::max;
@@ -68,157 +75,1244 @@ static constexpr float CPAL2Tb(const color_palette_index c)
 	return CPAL2T(c).b / 63.0f;
 }
 
+// Alpha for the canvas fade level, applied by the fragment shader
+static float vk_fade_alpha(const grs_canvas &canvas, const float levels = static_cast<float>(GR_FADE_LEVELS) - 1.0f)
+{
+	return canvas.cv_fade_level >= GR_FADE_OFF ? 1.0f : 1.0f - static_cast<float>(canvas.cv_fade_level) / levels;
+}
+
 }  // namespace dcx
 
 namespace {
 
+// Ring space reserved for one draw
+struct vk_draw_reservation {
+	uint8_t *verts = nullptr;  // vk_ring_vertex_2d or vk_ring_vertex_3d
+	bool is_2d = false;
+	uint16_t *indices = nullptr;
+	uint32_t base_index = 0;   // batch-relative index of verts[0]
+};
+
+// Texture coordinates and layers only; denormals flush to zero
+static uint16_t vk_half(const float f)
+{
+	uint32_t x;
+	memcpy(&x, &f, sizeof(x));
+	const uint16_t sign = (x >> 16) & 0x8000;
+	const int32_t exponent = static_cast<int32_t>((x >> 23) & 0xff) - 127 + 15;
+	if (exponent <= 0)
+		return sign;
+	if (exponent >= 31)
+		return sign | 0x7c00;
+	const uint32_t mantissa = x & 0x7fffff;
+	// Round to nearest; a carry out of the mantissa correctly bumps the exponent
+	return static_cast<uint16_t>((sign | (exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+}
+
+// Out of range colors clamp, as glColor does in the fixed-function pipeline
+static uint32_t vk_unorm8(const float c)
+{
+	return static_cast<uint32_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+static uint32_t vk_pack_color(const dcx::vk_vertex &v)
+{
+	return vk_unorm8(v.r) | vk_unorm8(v.g) << 8 | vk_unorm8(v.b) << 16 | vk_unorm8(v.a) << 24;
+}
+
+// Pack count vertices into the reservation, starting at ring vertex first
+static void vk_pack_vertices(const vk_draw_reservation &r, const uint32_t first, const dcx::vk_vertex *const src, const uint32_t count)
+{
+	if (r.is_2d)
+	{
+		auto *const out = reinterpret_cast<dcx::vk_ring_vertex_2d *>(r.verts) + first;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const auto &v = src[i];
+			out[i] = {v.x, v.y, vk_pack_color(v), vk_half(v.u), vk_half(v.v), vk_half(v.layer), 0};
+		}
+	}
+	else
+	{
+		auto *const out = reinterpret_cast<dcx::vk_ring_vertex_3d *>(r.verts) + first;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const auto &v = src[i];
+			out[i] = {v.x, v.y, v.z, vk_pack_color(v), vk_half(v.u), vk_half(v.v), vk_half(v.layer), v.overlay};
+		}
+	}
+}
+
 // Convert fan to triangle list: {0,1,2, 0,2,3, 0,3,4, ...}
-static uint32_t fan_to_list(dcx::vk_vertex *out, const dcx::vk_vertex *fan, uint32_t fan_count)
+static uint32_t fan_to_list(const vk_draw_reservation &r, const dcx::vk_vertex *fan, uint32_t fan_count)
 {
 	if (fan_count < 3)
 		return 0;
 	uint32_t tri_count = fan_count - 2;
 	for (uint32_t i = 0; i < tri_count; i++)
 	{
-		out[i * 3 + 0] = fan[0];
-		out[i * 3 + 1] = fan[i + 1];
-		out[i * 3 + 2] = fan[i + 2];
+		vk_pack_vertices(r, i * 3, &fan[0], 1);
+		vk_pack_vertices(r, i * 3 + 1, &fan[i + 1], 2);
 	}
 	return tri_count * 3;
 }
 
+// Half floats keep about three decimal digits, so shift a wall polygon's
+// texture coordinates next to the origin.  The textures repeat, so a whole
+// number offset does not change what is sampled.
+static void vk_recentre_uvs(const std::span<dcx::vk_vertex> verts)
+{
+	const float du = std::floor(verts[0].u);
+	const float dv = std::floor(verts[0].v);
+	if (!du && !dv)
+		return;
+	for (auto &v : verts)
+	{
+		v.u -= du;
+		v.v -= dv;
+	}
+}
+
 }  // anonymous namespace
 
 namespace dcx {
 
-// Append vertices to the per-frame ring buffer and issue a draw call
-static void vk_emit_draw(vk_pipeline_id pipe_id, const vk_vertex *verts, uint32_t count)
+static bool vk_object_groups_pending();
+static void vk_send_object_groups();
+
+// Queue the pending batch as a draw record.  Nothing is recorded into a
+// command buffer until vk_end_frame, so that vk_record_frame can split the
+// records between threads.
+void vk_flush_draws()
 {
-	if (!g_vk.frame_started || count == 0)
+	if (vk_object_groups_pending())
+		vk_send_object_groups();
+	auto &batch = g_vk.batch;
+	if (!g_vk.frame_started || batch.vertex_count == 0)
 		return;
 
-	auto &frame = g_vk.frames[g_vk.current_frame];
-	const VkDeviceSize needed = count * sizeof(vk_vertex);
+	auto &rec = g_vk.frames[g_vk.current_frame].draw_records.emplace_back();
+	rec.pipeline = batch.pipeline;
+	rec.descriptor_set = batch.descriptor_set;
+	rec.vertex_buffer = batch.vertex_buffer;
+	rec.viewport = g_vk.viewport;
+	rec.scissor = g_vk.scissor;
+	memcpy(rec.mvp, batch.mvp, sizeof(rec.mvp));
+	rec.mvp_serial = batch.mvp_serial;
+	rec.fade = batch.fade;
+	rec.first_vertex = batch.first_vertex;
+	rec.vertex_count = batch.vertex_count;
+	rec.first_index = batch.first_index;
+	rec.index_count = batch.index_count;
+	batch.vertex_count = 0;
+	batch.index_count = 0;
+}
+
+// State last recorded into one command buffer
+struct vk_bound_state {
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+	VkBuffer vertex_buffer = VK_NULL_HANDLE;
+	bool index_buffer_bound = false;
+	const vk_draw_record *push = nullptr;   // record whose MVP and fade were pushed
+	const VkViewport *viewport = nullptr;
+	const VkRect2D *scissor = nullptr;
+};
+
+// Map a viewport or scissor in screen coordinates onto a render area
+// scaled down by dynamic resolution
+static VkViewport vk_scale_viewport(VkViewport v, const float scale)
+{
+	v.x *= scale;
+	v.y *= scale;
+	v.width *= scale;
+	v.height *= scale;
+	return v;
+}
+
+static VkRect2D vk_scale_scissor(const VkRect2D &r, const float scale)
+{
+	const int32_t x0 = static_cast<int32_t>(std::floor(r.offset.x * scale));
+	const int32_t y0 = static_cast<int32_t>(std::floor(r.offset.y * scale));
+	const int32_t x1 = static_cast<int32_t>(std::ceil((r.offset.x + r.extent.width) * scale));
+	const int32_t y1 = static_cast<int32_t>(std::ceil((r.offset.y + r.extent.height) * scale));
+	return {{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}};
+}
 
-	if (frame.vertex_offset + needed > VK_VERTEX_RING_SIZE)
+// Record draws into cmd, skipping state that the previous record already
+// set.  Each command buffer starts with no bound state, so a secondary
+// command buffer sets everything again for its first record.
+static void vk_record_draws(const VkCommandBuffer cmd, const std::span<const vk_draw_record> records, const vk_frame_data &frame, vk_draw_stats &stats)
+{
+	const float scale = frame.render_scale;
+	const VkBuffer index_buffer = frame.index_buffer;
+	vk_bound_state bound;
+	// Set 1 stays bound across the set 0 binds below, as every pipeline
+	// shares the layout.  Its dynamic offset selects this frame's lights.
+	if (g_vk.static_descriptor_set)
 	{
-		con_puts(CON_VERBOSE, "VK: vertex ring buffer full, skipping draw");
-		return;
+		const uint32_t light_offset = static_cast<uint32_t>((&frame - g_vk.frames.data()) * g_vk.light_slice_size);
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+			g_vk.pipeline_layout, 1, 1, &g_vk.static_descriptor_set, 1, &light_offset);
 	}
+	for (auto &rec : records)
+	{
+		if (!rec.vertex_count)
+		{
+			vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, g_vk.timestamp_pool, rec.query);
+			continue;
+		}
 
-	// Copy vertices into ring buffer
-	memcpy(static_cast<uint8_t *>(frame.vertex_mapped) + frame.vertex_offset, verts, needed);
+		// Viewport and scissor only change with the swapchain (or a canvas
+		// that calls vk_set_viewport), so record them only when they differ
+		if (!bound.viewport || memcmp(bound.viewport, &rec.viewport, sizeof(VkViewport)))
+		{
+			if (scale < 1.0f)
+			{
+				const auto viewport = vk_scale_viewport(rec.viewport, scale);
+				vkCmdSetViewport(cmd, 0, 1, &viewport);
+			}
+			else
+				vkCmdSetViewport(cmd, 0, 1, &rec.viewport);
+			++stats.viewport_sets;
+		}
+		else
+			++stats.viewport_sets_skipped;
+		bound.viewport = &rec.viewport;
+		if (!bound.scissor || memcmp(bound.scissor, &rec.scissor, sizeof(VkRect2D)))
+		{
+			if (scale < 1.0f)
+			{
+				const auto scissor = vk_scale_scissor(rec.scissor, scale);
+				vkCmdSetScissor(cmd, 0, 1, &scissor);
+			}
+			else
+				vkCmdSetScissor(cmd, 0, 1, &rec.scissor);
+			++stats.scissor_sets;
+		}
+		else
+			++stats.scissor_sets_skipped;
+		bound.scissor = &rec.scissor;
 
-	VkCommandBuffer cmd = frame.cmd;
+		if (bound.vertex_buffer != rec.vertex_buffer)
+		{
+			const VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(cmd, 0, 1, &rec.vertex_buffer, &offset);
+			bound.vertex_buffer = rec.vertex_buffer;
+		}
+
+		if (bound.pipeline != rec.pipeline)
+		{
+			vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, rec.pipeline);
+			bound.pipeline = rec.pipeline;
+			++stats.pipeline_binds;
+		}
+		else
+			++stats.pipeline_binds_skipped;
+
+		// All pipelines share one layout, so push constants and the descriptor
+		// set stay valid across pipeline binds.  The serial check skips the
+		// compare when vk_update_mvp has not run between the two records.
+		if (!bound.push || bound.push->fade != rec.fade ||
+			(bound.push->mvp_serial != rec.mvp_serial && memcmp(bound.push->mvp, rec.mvp, sizeof(rec.mvp))))
+		{
+			vk_push_constants pc{};
+			memcpy(pc.mvp, rec.mvp, sizeof(pc.mvp));
+			pc.alpha_ref = 0.02f;
+			pc.fade = rec.fade;
+			vkCmdPushConstants(cmd, g_vk.pipeline_layout,
+				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+				0, sizeof(pc), &pc);
+			++stats.push_constants;
+		}
+		else
+			++stats.push_constants_skipped;
+		bound.push = &rec;
+
+		if (bound.descriptor_set != rec.descriptor_set)
+		{
+			vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+				g_vk.pipeline_layout, 0, 1, &rec.descriptor_set, 0, nullptr);
+			bound.descriptor_set = rec.descriptor_set;
+			++stats.descriptor_binds;
+		}
+		else
+			++stats.descriptor_binds_skipped;
+
+		if (rec.index_count)
+		{
+			if (!bound.index_buffer_bound)
+			{
+				vkCmdBindIndexBuffer(cmd, index_buffer, 0, VK_INDEX_TYPE_UINT16);
+				bound.index_buffer_bound = true;
+			}
+			vkCmdDrawIndexed(cmd, rec.index_count, 1, rec.first_index,
+				static_cast<int32_t>(rec.first_vertex), 0);
+		}
+		else
+			vkCmdDraw(cmd, rec.vertex_count, 1, rec.first_vertex, 0);
+		++stats.batches;
+	}
+}
+
+// ============================================================
+// Parallel command recording
+// ============================================================
+
+// A large frame's records are split into contiguous ranges, each recorded
+// into a secondary command buffer by a worker (the main thread takes the
+// first range).  The primary executes them in list order, so the draws
+// reach the GPU in exactly the order the renderer issued them.  Only the
+// command recording is threaded: the game's traversal of Render_list
+// shares the point cache and texture state, so it stays on the main thread.
+
+namespace {
 
-	// Bind pipeline for current blend mode
-	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-		g_vk.pipelines[pipe_id][g_vk.current_blend]);
+struct vk_record_worker {
+	std::thread thread;
+	VkCommandPool pool = VK_NULL_HANDLE;    // used only by this worker
+	std::array<VkCommandBuffer, VK_MAX_FRAMES_IN_FLIGHT> cmd{};
+	std::span<const vk_draw_record> records;
+	vk_draw_stats stats;
+};
+
+std::array<vk_record_worker, VK_MAX_RECORD_THREADS> vk_record_workers;
+unsigned vk_record_worker_count;
+std::mutex vk_record_mutex;
+std::condition_variable vk_record_start, vk_record_done;
+uint64_t vk_record_generation;
+unsigned vk_record_pending;
+bool vk_record_quit;
 
-	// Set viewport and scissor
-	VkViewport vp{};
-	vp.width = static_cast<float>(g_vk.swapchain_extent.width);
-	vp.height = static_cast<float>(g_vk.swapchain_extent.height);
-	vp.minDepth = 0.0f;
-	vp.maxDepth = 1.0f;
-	vkCmdSetViewport(cmd, 0, 1, &vp);
+}
 
-	VkRect2D scissor{};
-	scissor.extent = g_vk.swapchain_extent;
-	vkCmdSetScissor(cmd, 0, 1, &scissor);
+static void vk_record_secondary(const VkCommandBuffer cmd, const vk_frame_data &frame, const std::span<const vk_draw_record> records, vk_draw_stats &stats)
+{
+	VkCommandBufferInheritanceInfo inherit{};
+	inherit.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inherit.renderPass = g_vk.render_pass;  // compatible with scene_render_pass
+	inherit.subpass = 0;
+	inherit.framebuffer = frame.framebuffer;
+
+	VkCommandBufferBeginInfo begin_info{};
+	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	begin_info.pInheritanceInfo = &inherit;
+	vkResetCommandBuffer(cmd, 0);
+	vkBeginCommandBuffer(cmd, &begin_info);
+	vk_record_draws(cmd, records, frame, stats);
+	vkEndCommandBuffer(cmd);
+}
 
-	// Push constants: MVP matrix + alpha ref
-	vk_push_constants pc{};
-	memcpy(pc.mvp, g_vk.mvp_matrix, sizeof(pc.mvp));
-	pc.alpha_ref = 0.02f;
-	vkCmdPushConstants(cmd, g_vk.pipeline_layout,
-		VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-		0, sizeof(pc), &pc);
+static void vk_record_worker_main(vk_record_worker &w)
+{
+	uint64_t generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock lock(vk_record_mutex);
+			vk_record_start.wait(lock, [&generation] { return vk_record_quit || vk_record_generation != generation; });
+			if (vk_record_quit)
+				return;
+			generation = vk_record_generation;
+		}
+		w.stats = {};
+		const auto &frame = g_vk.frames[g_vk.current_frame];
+		vk_record_secondary(w.cmd[g_vk.current_frame], frame, w.records, w.stats);
+		{
+			std::lock_guard lock(vk_record_mutex);
+			if (!--vk_record_pending)
+				vk_record_done.notify_one();
+		}
+	}
+}
 
-	// Bind texture descriptor set
-	VkDescriptorSet ds = g_vk.bound_texture ? g_vk.bound_texture : g_vk.white_texture.descriptor_set;
-	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-		g_vk.pipeline_layout, 0, 1, &ds, 0, nullptr);
+bool vk_create_record_workers()
+{
+	const int requested = CGameArg.OglVkRecordThreads;
+	// Leave a core for the main thread, which records a range itself
+	const unsigned count = std::min<unsigned>(requested < 0
+		? std::max(std::thread::hardware_concurrency(), 1u) - 1
+		: requested, VK_MAX_RECORD_THREADS);
+
+	VkCommandBufferAllocateInfo cbai{};
+	cbai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	cbai.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+	cbai.commandBufferCount = g_vk.frames_in_flight;
+	if (count)
+	{
+		cbai.commandPool = g_vk.command_pool;
+		cbai.commandBufferCount = 1;
+		for (auto &frame : std::span(g_vk.frames).first(g_vk.frames_in_flight))
+			if (vkAllocateCommandBuffers(g_vk.device, &cbai, &frame.secondary_cmd) != VK_SUCCESS)
+				return false;
+		cbai.commandBufferCount = g_vk.frames_in_flight;
+	}
+	for (auto &w : std::span(vk_record_workers).first(count))
+	{
+		VkCommandPoolCreateInfo cpci{};
+		cpci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cpci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		cpci.queueFamilyIndex = g_vk.queue_family;
+		if (vkCreateCommandPool(g_vk.device, &cpci, nullptr, &w.pool) != VK_SUCCESS)
+			return false;
+		cbai.commandPool = w.pool;
+		if (vkAllocateCommandBuffers(g_vk.device, &cbai, w.cmd.data()) != VK_SUCCESS)
+			return false;
+	}
+	vk_record_quit = false;
+	for (auto &w : std::span(vk_record_workers).first(count))
+		w.thread = std::thread(vk_record_worker_main, std::ref(w));
+	vk_record_worker_count = count;
+	con_printf(CON_VERBOSE, "VK: %u command recording threads", count);
+	return true;
+}
 
-	// Bind vertex buffer
-	VkDeviceSize offset = frame.vertex_offset;
-	vkCmdBindVertexBuffers(cmd, 0, 1, &frame.vertex_buffer, &offset);
+void vk_destroy_record_workers()
+{
+	{
+		std::lock_guard lock(vk_record_mutex);
+		vk_record_quit = true;
+	}
+	vk_record_start.notify_all();
+	for (auto &w : vk_record_workers)
+	{
+		if (w.thread.joinable())
+			w.thread.join();
+		if (w.pool)
+			vkDestroyCommandPool(g_vk.device, w.pool, nullptr);
+		w.pool = VK_NULL_HANDLE;
+		w.cmd = {};
+	}
+	vk_record_worker_count = 0;
+	vk_record_generation = 0;
+}
 
-	vkCmdDraw(cmd, count, 1, 0, 0);
+namespace {
+static void vk_write_static_lights(const vk_frame_data &frame);
+}
 
+// Record the frame's render pass into its primary command buffer
+void vk_record_frame(vk_frame_data &frame, const VkRenderPassBeginInfo &rpbi)
+{
+	vk_write_static_lights(frame);
+	const std::span<const vk_draw_record> records = frame.draw_records;
+	auto &stats = g_vk.draw_stats;
+	const unsigned workers = records.size() >= VK_PARALLEL_RECORD_MIN ? vk_record_worker_count : 0;
+	if (!workers)
+	{
+		vkCmdBeginRenderPass(frame.cmd, &rpbi, VK_SUBPASS_CONTENTS_INLINE);
+		vk_record_draws(frame.cmd, records, frame, stats);
+		vkCmdEndRenderPass(frame.cmd);
+		stats.record_threads = 1;
+		return;
+	}
+
+	const std::size_t ranges = workers + 1;
+	const auto range = [&records, ranges](const std::size_t i) {
+		const auto first = records.size() * i / ranges;
+		return records.subspan(first, records.size() * (i + 1) / ranges - first);
+	};
+	{
+		std::lock_guard lock(vk_record_mutex);
+		for (unsigned i = 0; i < workers; ++i)
+			vk_record_workers[i].records = range(i + 1);
+		vk_record_pending = workers;
+		++vk_record_generation;
+	}
+	vk_record_start.notify_all();
+	vk_record_secondary(frame.secondary_cmd, frame, range(0), stats);
+
+	std::array<VkCommandBuffer, VK_MAX_RECORD_THREADS + 1> cmds;
+	cmds[0] = frame.secondary_cmd;
+	{
+		std::unique_lock lock(vk_record_mutex);
+		vk_record_done.wait(lock, [] { return !vk_record_pending; });
+	}
+	for (unsigned i = 0; i < workers; ++i)
+	{
+		auto &w = vk_record_workers[i];
+		cmds[i + 1] = w.cmd[g_vk.current_frame];
+		stats.batches += w.stats.batches;
+		stats.pipeline_binds += w.stats.pipeline_binds;
+		stats.pipeline_binds_skipped += w.stats.pipeline_binds_skipped;
+		stats.descriptor_binds += w.stats.descriptor_binds;
+		stats.descriptor_binds_skipped += w.stats.descriptor_binds_skipped;
+		stats.push_constants += w.stats.push_constants;
+		stats.push_constants_skipped += w.stats.push_constants_skipped;
+		stats.viewport_sets += w.stats.viewport_sets;
+		stats.viewport_sets_skipped += w.stats.viewport_sets_skipped;
+		stats.scissor_sets += w.stats.scissor_sets;
+		stats.scissor_sets_skipped += w.stats.scissor_sets_skipped;
+	}
+
+	vkCmdBeginRenderPass(frame.cmd, &rpbi, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+	vkCmdExecuteCommands(frame.cmd, static_cast<uint32_t>(ranges), cmds.data());
+	vkCmdEndRenderPass(frame.cmd);
+	stats.record_threads = static_cast<uint32_t>(ranges);
+}
+
+// Reserve ring space for vertex_count vertices (and index_count indices
+// for an indexed draw), extending the pending batch when the draw state
+// matches and flushing it otherwise.  Returns empty verts when the ring
+// is full; an indexed request that does not fit the index ring fails
+// without side effects so the caller can fall back to a plain list.
+// mvp and mvp_serial default to the current matrix stack.
+static vk_draw_reservation vk_reserve_draw(vk_pipeline_id pipe_id, uint32_t vertex_count, uint32_t index_count, const float fade, const float *const mvp = g_vk.mvp_matrix, const uint64_t mvp_serial = g_vk.mvp_serial)
+{
+	vk_draw_reservation r;
+	if (!g_vk.frame_started || vertex_count == 0)
+		return r;
+	if (vk_object_groups_pending())
+		vk_send_object_groups();
+
+	auto &frame = g_vk.frames[g_vk.current_frame];
+	if (index_count &&
+		(vertex_count > UINT16_MAX + 1u ||
+		 frame.index_offset + index_count * sizeof(uint16_t) > VK_INDEX_RING_SIZE))
+		return r;
+
+	// first_vertex counts in strides of the pipeline's layout, so start on
+	// a multiple of it.  Batches never mix layouts, so a batch that goes on
+	// needs no padding.
+	const uint32_t stride = vk_ring_vertex_size(pipe_id);
+	const VkDeviceSize needed = vertex_count * stride;
+	VkDeviceSize offset = (frame.vertex_offset + stride - 1) / stride * stride;
+	if (offset + needed > VK_VERTEX_RING_SIZE)
+	{
+		// A batch cannot span chunks
+		vk_flush_draws();
+		if (needed > VK_VERTEX_RING_SIZE || !vk_next_vertex_chunk(frame))
+		{
+			con_puts(CON_VERBOSE, "VK: vertex ring buffer full, skipping draw");
+			return r;
+		}
+		offset = frame.vertex_offset;
+	}
+	frame.vertex_offset = offset;
+
+	++g_vk.draw_stats.draws;
+
+	const VkPipeline opaque = g_vk.draw_opaque && fade == 1.0f && g_vk.current_blend == VK_BLEND_NORMAL
+		? g_vk.opaque_pipelines[pipe_id]
+		: VK_NULL_HANDLE;
+	const VkPipeline pipeline = opaque ? opaque : g_vk.pipelines[pipe_id][g_vk.current_blend];
+	const VkDescriptorSet ds = g_vk.bound_texture ? g_vk.bound_texture : g_vk.white_texture.descriptor_set;
+	auto &batch = g_vk.batch;
+	const bool indexed = index_count != 0;
+	if (batch.vertex_count &&
+		(batch.pipeline != pipeline || batch.descriptor_set != ds || batch.fade != fade ||
+		 (batch.index_count != 0) != indexed ||
+		 (indexed && batch.vertex_count + vertex_count > UINT16_MAX + 1u) ||
+		 (batch.mvp_serial != mvp_serial && memcmp(batch.mvp, mvp, sizeof(batch.mvp)))))
+		vk_flush_draws();
+
+	auto &chunk = frame.vertex_chunks[frame.vertex_chunk];
+	if (!batch.vertex_count)
+	{
+		batch.pipeline = pipeline;
+		batch.descriptor_set = ds;
+		batch.vertex_buffer = chunk.buffer;
+		memcpy(batch.mvp, mvp, sizeof(batch.mvp));
+		batch.mvp_serial = mvp_serial;
+		batch.fade = fade;
+		batch.first_vertex = static_cast<uint32_t>(frame.vertex_offset / stride);
+		batch.first_index = static_cast<uint32_t>(frame.index_offset / sizeof(uint16_t));
+	}
+
+	r.verts = static_cast<uint8_t *>(chunk.mapped) + frame.vertex_offset;
+	r.is_2d = vk_pipeline_is_2d(pipe_id);
+	r.base_index = batch.vertex_count;
+	batch.vertex_count += vertex_count;
 	frame.vertex_offset += needed;
+	if (indexed)
+	{
+		r.indices = reinterpret_cast<uint16_t *>(static_cast<uint8_t *>(frame.index_mapped) + frame.index_offset);
+		batch.index_count += index_count;
+		frame.index_offset += index_count * sizeof(uint16_t);
+	}
+	return r;
 }
 
-void vk_draw_triangles(const vk_vertex *verts, uint32_t count, bool textured, bool is_3d)
+static vk_pipeline_id vk_triangle_pipeline(bool textured, bool is_3d)
 {
-	vk_pipeline_id pipe;
 	if (textured)
-		pipe = is_3d ? VK_PIPE_TEXTURED_3D : VK_PIPE_TEXTURED_2D;
-	else
-		pipe = is_3d ? VK_PIPE_FLAT_3D : VK_PIPE_FLAT_2D;
-	vk_emit_draw(pipe, verts, count);
+		return is_3d ? VK_PIPE_TEXTURED_3D : VK_PIPE_TEXTURED_2D;
+	return is_3d ? VK_PIPE_FLAT_3D : VK_PIPE_FLAT_2D;
+}
+
+void vk_draw_triangles(const vk_vertex *verts, uint32_t count, bool textured, bool is_3d, const float fade)
+{
+	const auto r = vk_reserve_draw(vk_triangle_pipeline(textured, is_3d), count, 0, fade);
+	if (r.verts)
+		vk_pack_vertices(r, 0, verts, count);
+}
+
+// ============================================================
+// Object groups
+// ============================================================
+
+namespace {
+
+// Fans held for one draw state while an object group is open
+struct vk_object_group
+{
+	vk_pipeline_id pipe;
+	VkDescriptorSet descriptor_set;
+	bool opaque;
+	float mvp[16];
+	uint64_t mvp_serial;
+	std::vector<vk_vertex> verts;
+	std::vector<uint8_t> fan_counts;
+};
+
+// Groups are kept across frames so that their vectors keep their capacity;
+// only the first vk_object_groups_used are in use
+static std::vector<vk_object_group> vk_object_groups;
+static std::size_t vk_object_groups_used;
+static bool vk_object_grouping;
+static bool vk_object_groups_sending;
+
+// The objects are depth tested and transparent texels are discarded, so
+// opaque fans can go out in any order.  Anything blended or faded keeps
+// its place.
+static bool vk_object_group_accepts(const vk_pipeline_id pipe, const vk_vertex *const verts, const uint32_t count, const float fade)
+{
+	if (!vk_object_grouping || vk_object_groups_sending || count < 3 || count > MAX_POINTS_PER_POLY)
+		return false;
+	if (pipe != VK_PIPE_TEXTURED_3D && pipe != VK_PIPE_TEXTURED_ARRAY_3D && pipe != VK_PIPE_FLAT_3D)
+		return false;
+	if (fade != 1.0f || g_vk.current_blend != VK_BLEND_NORMAL || !g_vk.frame_started)
+		return false;
+	return std::all_of(verts, verts + count, [](const vk_vertex &v) { return v.a == 1.0f; });
+}
+
+static bool vk_group_fan(const vk_pipeline_id pipe, const vk_vertex *const verts, const uint32_t count, const float fade)
+{
+	if (!vk_object_group_accepts(pipe, verts, count, fade))
+		return false;
+	const VkDescriptorSet ds = g_vk.bound_texture ? g_vk.bound_texture : g_vk.white_texture.descriptor_set;
+	vk_object_group *g = nullptr;
+	for (auto &o : std::span(vk_object_groups).first(vk_object_groups_used))
+		if (o.pipe == pipe && o.descriptor_set == ds && o.opaque == g_vk.draw_opaque &&
+			(o.mvp_serial == g_vk.mvp_serial || !memcmp(o.mvp, g_vk.mvp_matrix, sizeof(o.mvp))))
+		{
+			g = &o;
+			break;
+		}
+	if (!g)
+	{
+		if (vk_object_groups_used == vk_object_groups.size())
+			vk_object_groups.emplace_back();
+		g = &vk_object_groups[vk_object_groups_used++];
+		g->pipe = pipe;
+		g->descriptor_set = ds;
+		g->opaque = g_vk.draw_opaque;
+		memcpy(g->mvp, g_vk.mvp_matrix, sizeof(g->mvp));
+		g->mvp_serial = g_vk.mvp_serial;
+		g->verts.clear();
+		g->fan_counts.clear();
+	}
+	g->verts.insert(g->verts.end(), verts, verts + count);
+	g->fan_counts.emplace_back(count);
+	++g_vk.draw_stats.grouped_draws;
+	return true;
+}
+
+// Send one group as indexed batches of at most 65536 vertices, or as plain
+// lists if the index ring is full
+static void vk_send_object_group(const vk_object_group &g)
+{
+	const vk_vertex *v = g.verts.data();
+	for (auto fan = g.fan_counts.begin(), end = g.fan_counts.end(); fan != end;)
+	{
+		uint32_t vertex_count = 0, index_count = 0;
+		auto last = fan;
+		for (; last != end && vertex_count + *last <= UINT16_MAX + 1u; ++last)
+		{
+			vertex_count += *last;
+			index_count += (*last - 2) * 3;
+		}
+		if (const auto r = vk_reserve_draw(g.pipe, vertex_count, index_count, 1.0f, g.mvp, g.mvp_serial); r.verts)
+		{
+			vk_pack_vertices(r, 0, v, vertex_count);
+			auto base = static_cast<uint16_t>(r.base_index);
+			auto *idx = r.indices;
+			for (auto f = fan; f != last; base += *f++)
+				for (uint32_t i = 0; i < *f - 2u; ++i)
+				{
+					*idx++ = base;
+					*idx++ = static_cast<uint16_t>(base + i + 1);
+					*idx++ = static_cast<uint16_t>(base + i + 2);
+				}
+			v += vertex_count;
+		}
+		else
+			for (auto f = fan; f != last; v += *f++)
+				if (const auto l = vk_reserve_draw(g.pipe, (*f - 2u) * 3, 0, 1.0f, g.mvp, g.mvp_serial); l.verts)
+					fan_to_list(l, v, *f);
+		fan = last;
+	}
+}
+
+}
+
+static bool vk_object_groups_pending()
+{
+	return vk_object_groups_used && !vk_object_groups_sending;
+}
+
+static void vk_send_object_groups()
+{
+	vk_object_groups_sending = true;
+	const auto bound_texture = g_vk.bound_texture;
+	const auto draw_opaque = g_vk.draw_opaque;
+	const auto blend = std::exchange(g_vk.current_blend, VK_BLEND_NORMAL);
+	for (auto &g : std::span(vk_object_groups).first(vk_object_groups_used))
+	{
+		g_vk.bound_texture = g.descriptor_set;
+		g_vk.draw_opaque = g.opaque;
+		vk_send_object_group(g);
+	}
+	g_vk.bound_texture = bound_texture;
+	g_vk.draw_opaque = draw_opaque;
+	g_vk.current_blend = blend;
+	vk_object_groups_used = 0;
+	vk_object_groups_sending = false;
+}
+
+void vk_begin_object_group()
+{
+	vk_object_grouping = true;
+}
+
+void vk_end_object_group()
+{
+	vk_object_grouping = false;
+	if (vk_object_groups_pending())
+		vk_send_object_groups();
 }
 
-void vk_draw_triangle_fan(const vk_vertex *verts, uint32_t count, bool textured, bool is_3d)
+static void vk_draw_fan(vk_pipeline_id pipe, const vk_vertex *verts, uint32_t count, const float fade = 1.0f)
 {
 	if (count < 3)
 		return;
-	// Convert fan to triangle list
-	const uint32_t max_tris = (count - 2) * 3;
-	std::vector<vk_vertex> list_verts(max_tris);
-	uint32_t list_count = fan_to_list(list_verts.data(), verts, count);
-	vk_draw_triangles(list_verts.data(), list_count, textured, is_3d);
+	if (vk_group_fan(pipe, verts, count, fade))
+		return;
+	const uint32_t list_count = (count - 2) * 3;
+
+	// Indexed: each fan vertex is written once, triangles come from the index ring
+	if (const auto r = vk_reserve_draw(pipe, count, list_count, fade); r.verts)
+	{
+		vk_pack_vertices(r, 0, verts, count);
+		const uint16_t base = static_cast<uint16_t>(r.base_index);
+		for (uint32_t i = 0; i < count - 2; i++)
+		{
+			r.indices[i * 3 + 0] = base;
+			r.indices[i * 3 + 1] = static_cast<uint16_t>(base + i + 1);
+			r.indices[i * 3 + 2] = static_cast<uint16_t>(base + i + 2);
+		}
+		return;
+	}
+
+	// Index ring exhausted: expand the fan straight into the vertex ring
+	if (const auto r = vk_reserve_draw(pipe, list_count, 0, fade); r.verts)
+		fan_to_list(r, verts, count);
+}
+
+void vk_draw_triangle_fan(const vk_vertex *verts, uint32_t count, bool textured, bool is_3d, const float fade)
+{
+	vk_draw_fan(vk_triangle_pipeline(textured, is_3d), verts, count, fade);
 }
 
-void vk_draw_lines(const vk_vertex *verts, uint32_t count, bool is_3d)
+void vk_draw_lines(const vk_vertex *verts, uint32_t count, bool is_3d, const float fade)
 {
-	vk_pipeline_id pipe = is_3d ? VK_PIPE_LINE_3D : VK_PIPE_LINE_2D;
-	vk_emit_draw(pipe, verts, count);
+	const auto r = vk_reserve_draw(is_3d ? VK_PIPE_LINE_3D : VK_PIPE_LINE_2D, count, 0, fade);
+	if (r.verts)
+		vk_pack_vertices(r, 0, verts, count);
 }
 
 // ============================================================
-// Texture management stubs (interface with DXX bitmap system)
+// Static wall geometry
 // ============================================================
 
+ogl_static_face ogl_current_static_face;
+
+namespace {
+
+// Lights beyond this many per frame are dropped; a busy Descent 2 fight
+// stays well under it
+constexpr std::size_t VK_MAX_STATIC_LIGHTS = 512;
+
+// Header of each light_buffer slice, as the shaders' StaticLights block
+struct vk_static_light_header
+{
+	uint32_t count;
+	float saturation;
+	uint32_t pad[2];
+};
+static_assert(sizeof(vk_static_light_header) == 16);
+
+// The lights set_dynamic_light collected for the frame being built
+static std::vector<ogl_static_light> vk_static_lights;
+static float vk_static_light_saturation = 1;
+
+static bool vk_create_light_buffer()
+{
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(g_vk.physical_device, &props);
+	const VkDeviceSize align = std::max<VkDeviceSize>(props.limits.minStorageBufferOffsetAlignment, 1);
+	const VkDeviceSize slice = sizeof(vk_static_light_header) + VK_MAX_STATIC_LIGHTS * sizeof(ogl_static_light);
+	g_vk.light_slice_size = (slice + align - 1) / align * align;
+
+	VkBufferCreateInfo bci{};
+	bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bci.size = g_vk.light_slice_size * VK_MAX_FRAMES_IN_FLIGHT;
+	bci.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	VmaAllocationCreateInfo aci{};
+	aci.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+	aci.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+	VmaAllocationInfo info{};
+	if (vmaCreateBuffer(g_vk.allocator, &bci, &aci, &g_vk.light_buffer, &g_vk.light_allocation, &info) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: failed to create static light buffer");
+		g_vk.light_buffer = VK_NULL_HANDLE;
+		return false;
+	}
+	g_vk.light_mapped = static_cast<uint8_t *>(info.pMappedData);
+	// Every slice starts with no lights, for frames recorded before
+	// set_dynamic_light first runs
+	memset(g_vk.light_mapped, 0, bci.size);
+	vmaFlushAllocation(g_vk.allocator, g_vk.light_allocation, 0, VK_WHOLE_SIZE);
+	return true;
+}
+
+// Copy the collected lights into the slice that frame's draws read
+static void vk_write_static_lights(const vk_frame_data &frame)
+{
+	if (!g_vk.light_mapped)
+		return;
+	const VkDeviceSize offset = (&frame - g_vk.frames.data()) * g_vk.light_slice_size;
+	const auto slice = g_vk.light_mapped + offset;
+	const std::size_t count = ogl_static_lights_enabled() ? std::min(vk_static_lights.size(), VK_MAX_STATIC_LIGHTS) : 0;
+	const vk_static_light_header header{static_cast<uint32_t>(count), vk_static_light_saturation, {}};
+	memcpy(slice, &header, sizeof(header));
+	if (count)
+		memcpy(slice + sizeof(header), vk_static_lights.data(), count * sizeof(ogl_static_light));
+	vmaFlushAllocation(g_vk.allocator, g_vk.light_allocation, offset, sizeof(header) + count * sizeof(ogl_static_light));
+}
+
+}
+
+bool ogl_static_lights_enabled()
+{
+	return CGameArg.OglVkShaderLights && g_vk.static_descriptor_set;
+}
+
+void ogl_set_static_lights(const std::span<const ogl_static_light> lights, const float saturation)
+{
+	vk_static_lights.assign(lights.begin(), lights.end());
+	vk_static_light_saturation = saturation;
+}
+
+void ogl_upload_static_geometry(const std::span<const std::array<float, 3>> corners)
+{
+	ogl_free_static_geometry();
+	if (!g_vk.initialized || corners.empty())
+		return;
+
+	VkBufferCreateInfo bci{};
+	bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bci.size = corners.size_bytes();
+	bci.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	VmaAllocationCreateInfo aci{};
+	aci.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+	aci.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+	VmaAllocationInfo info{};
+	if (vmaCreateBuffer(g_vk.allocator, &bci, &aci, &g_vk.static_buffer, &g_vk.static_allocation, &info) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: failed to create static geometry buffer");
+		g_vk.static_buffer = VK_NULL_HANDLE;
+		return;
+	}
+	memcpy(info.pMappedData, corners.data(), corners.size_bytes());
+	vmaFlushAllocation(g_vk.allocator, g_vk.static_allocation, 0, VK_WHOLE_SIZE);
+	if (!vk_create_light_buffer())
+	{
+		ogl_free_static_geometry();
+		return;
+	}
+
+	VkDescriptorSetAllocateInfo dsai{};
+	dsai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	dsai.descriptorPool = g_vk.descriptor_pool;
+	dsai.descriptorSetCount = 1;
+	dsai.pSetLayouts = &g_vk.static_set_layout;
+	if (vkAllocateDescriptorSets(g_vk.device, &dsai, &g_vk.static_descriptor_set) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: failed to allocate static geometry descriptor set");
+		g_vk.static_descriptor_set = VK_NULL_HANDLE;
+		ogl_free_static_geometry();
+		return;
+	}
+	VkDescriptorBufferInfo dbi{};
+	dbi.buffer = g_vk.static_buffer;
+	dbi.range = VK_WHOLE_SIZE;
+	VkDescriptorBufferInfo light_dbi{};
+	light_dbi.buffer = g_vk.light_buffer;
+	light_dbi.range = g_vk.light_slice_size;
+	std::array<VkWriteDescriptorSet, 2> wds{};
+	for (auto &w : wds)
+	{
+		w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		w.dstSet = g_vk.static_descriptor_set;
+		w.descriptorCount = 1;
+	}
+	wds[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	wds[0].pBufferInfo = &dbi;
+	wds[1].dstBinding = 1;
+	wds[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	wds[1].pBufferInfo = &light_dbi;
+	vkUpdateDescriptorSets(g_vk.device, static_cast<uint32_t>(wds.size()), wds.data(), 0, nullptr);
+	g_vk.static_corner_count = static_cast<uint32_t>(corners.size());
+	con_printf(CON_DEBUG, "VK: uploaded %u static wall corners", g_vk.static_corner_count);
+}
+
+// Levels load between frames, so waiting for the device is cheaper here
+// than tagging the buffer for deferred destruction
+void ogl_free_static_geometry()
+{
+	if (!g_vk.static_buffer && !g_vk.static_descriptor_set && !g_vk.light_buffer)
+		return;
+	vkDeviceWaitIdle(g_vk.device);
+	if (g_vk.static_descriptor_set)
+		vkFreeDescriptorSets(g_vk.device, g_vk.descriptor_pool, 1, &g_vk.static_descriptor_set);
+	if (g_vk.static_buffer)
+		vmaDestroyBuffer(g_vk.allocator, g_vk.static_buffer, g_vk.static_allocation);
+	if (g_vk.light_buffer)
+		vmaDestroyBuffer(g_vk.allocator, g_vk.light_buffer, g_vk.light_allocation);
+	g_vk.static_descriptor_set = VK_NULL_HANDLE;
+	g_vk.static_buffer = VK_NULL_HANDLE;
+	g_vk.static_allocation = VK_NULL_HANDLE;
+	g_vk.static_corner_count = 0;
+	g_vk.light_buffer = VK_NULL_HANDLE;
+	g_vk.light_allocation = VK_NULL_HANDLE;
+	g_vk.light_mapped = nullptr;
+	vk_static_lights.clear();
+}
+
+namespace {
+
+// The current wall face, if its corners can be taken from the static
+// geometry buffer
+static const ogl_static_face *vk_static_face()
+{
+	auto &face = ogl_current_static_face;
+	if (!face.active || !g_vk.static_descriptor_set || face.base + 4 > g_vk.static_corner_count)
+		return nullptr;
+	return &face;
+}
+
+// The matrix stack's MVP composed with Gl_view_matrix.  Serials come from
+// the counter that vk_update_mvp uses, and the stack's own MVP moves to a
+// fresh one as well, so that batches never confuse the two.
+static const float *vk_static_mvp(uint64_t &serial)
+{
+	if (g_vk.static_mvp_base_serial != g_vk.mvp_serial || g_vk.static_view != Gl_view_matrix)
+	{
+		g_vk.static_view = Gl_view_matrix;
+		vk_mat4_multiply(g_vk.static_mvp, g_vk.mvp_matrix, g_vk.static_view.data());
+		g_vk.static_mvp_serial = ++g_vk.mvp_serial;
+		g_vk.static_mvp_base_serial = ++g_vk.mvp_serial;
+	}
+	serial = g_vk.static_mvp_serial;
+	return g_vk.static_mvp;
+}
+
+static void vk_pack_static_vertex(const vk_draw_reservation &r, const uint32_t i, const uint32_t corner, const vk_vertex &v, const uint16_t flags)
+{
+	reinterpret_cast<vk_ring_vertex_static *>(r.verts)[i] = {corner, vk_pack_color(v), vk_half(v.u), vk_half(v.v), vk_half(v.layer), static_cast<uint16_t>(flags | v.overlay << VK_STATIC_VERTEX_OVERLAY_SHIFT)};
+}
+
+// As vk_draw_fan, for a wall face whose positions are in the static
+// geometry buffer.  Only the corner numbers, colors and texture
+// coordinates go through the ring.
+static void vk_draw_static_fan(const ogl_static_face &face, const vk_pipeline_id pipe, const vk_vertex *const verts, const uint32_t count, const float fade, const uint16_t flags)
+{
+	if (count < 3)
+		return;
+	const uint32_t list_count = (count - 2) * 3;
+	uint64_t serial;
+	const float *const mvp = vk_static_mvp(serial);
+	if (const auto r = vk_reserve_draw(pipe, count, list_count, fade, mvp, serial); r.verts)
+	{
+		for (uint32_t i = 0; i < count; i++)
+			vk_pack_static_vertex(r, i, face.base + face.corner[i], verts[i], flags);
+		const uint16_t base = static_cast<uint16_t>(r.base_index);
+		for (uint32_t i = 0; i < count - 2; i++)
+		{
+			r.indices[i * 3 + 0] = base;
+			r.indices[i * 3 + 1] = static_cast<uint16_t>(base + i + 1);
+			r.indices[i * 3 + 2] = static_cast<uint16_t>(base + i + 2);
+		}
+		return;
+	}
+	if (const auto r = vk_reserve_draw(pipe, list_count, 0, fade, mvp, serial); r.verts)
+		for (uint32_t i = 0; i < count - 2; i++)
+		{
+			vk_pack_static_vertex(r, i * 3, face.base + face.corner[0], verts[0], flags);
+			vk_pack_static_vertex(r, i * 3 + 1, face.base + face.corner[i + 1], verts[i + 1], flags);
+			vk_pack_static_vertex(r, i * 3 + 2, face.base + face.corner[i + 2], verts[i + 2], flags);
+		}
+}
+
+// Draw a textured wall fan, from the static geometry buffer when the face
+// is in it.  A lit face also takes the shader's dynamic light.
+static void vk_draw_wall_fan(const vk_pipeline_id pipe, const vk_vertex *const verts, const uint32_t count, const float fade, const ogl_static_face *const face, const bool lit)
+{
+	if (face)
+		vk_draw_static_fan(*face,
+			pipe == VK_PIPE_TEXTURED_ARRAY_3D
+				? VK_PIPE_STATIC_ARRAY_3D
+				: pipe == VK_PIPE_OVERLAY_ARRAY_3D
+					? VK_PIPE_STATIC_OVERLAY_ARRAY_3D
+					: VK_PIPE_STATIC_3D,
+			verts, count, fade, lit ? VK_STATIC_VERTEX_LIT : 0);
+	else
+		vk_draw_fan(pipe, verts, count, fade);
+}
+
+}
+
+// ============================================================
+// Bitmap texture cache (interface with DXX bitmap system)
+// ============================================================
+
+// Vulkan texture uploaded for each ogl_textures entry, by pool index.  A
+// loaded entry has handle == index + 1.
+static std::vector<vk_texture *> vk_texture_slots;
+
+static vk_texture *vk_bitmap_texture(const ogl_texture &t)
+{
+	return t.handle > 0 ? vk_texture_slots[t.handle - 1] : nullptr;
+}
+
+static void vk_free_bitmap_texture(ogl_texture &t)
+{
+	if (t.handle <= 0)
+		return;
+	vk_retire_texture(std::exchange(vk_texture_slots[t.handle - 1], nullptr));
+	t.handle = 0;
+	ogl_textures.note_unloaded(t);
+}
+
+// Palettized to RGBA, with the same transparency rules as ogl_filltexbuf
+static void vk_palettized_to_rgba(const palette_array_t &pal, const uint8_t *src, const unsigned pixels, const uint8_t bm_flags, uint8_t *dst)
+{
+	ogl_palette_lut(pal, GL_RGBA, bm_flags).expand(src, pixels, dst);
+}
+
+using vk_bitmap_decodebuf = std::array<uint8_t, 300*1024>;
+
+// Palette indices of a bitmap, expanding RLE bitmaps into decodebuf
+static const uint8_t *vk_bitmap_pixels(grs_bitmap &bm, vk_bitmap_decodebuf &decodebuf)
+{
+	if (!bm.get_flag_mask(BM_FLAG_RLE))
+		return bm.get_bitmap_data();
+	class bm_rle_expand_state
+	{
+		uint8_t *dbits;
+		uint8_t *const ebits;
+	public:
+		bm_rle_expand_state(uint8_t *const b, uint8_t *const e) :
+			dbits(b), ebits(e)
+		{
+		}
+		uint8_t *get_begin_dbits() const
+		{
+			return dbits;
+		}
+		uint8_t *get_end_dbits() const
+		{
+			return ebits;
+		}
+		void consume_dbits(const unsigned w)
+		{
+			dbits += w;
+		}
+	};
+	decodebuf = {};
+	if (!bm_rle_expand(bm).loop(bm.bm_w, bm_rle_expand_state(begin(decodebuf), end(decodebuf))))
+		con_printf(CON_URGENT, "error: insufficient space to decode %ux%u bitmap.  Please report this as a bug.", bm.bm_w, bm.bm_h);
+	return decodebuf.data();
+}
+
+// Level texture array (-vk_arraytextures): the level's 64x64 wall
+// textures share one 2D array image, so walls draw without rebinding.
+// Layer + 1 of each GameBitmaps entry packed into g_vk.level_textures,
+// 0 if the bitmap is not packed.
+static std::vector<uint16_t> vk_level_texture_layers;
+static const grs_bitmap *vk_level_texture_bitmaps;
+
+static unsigned vk_level_texture_layer(const grs_bitmap &bm)
+{
+	if (!g_vk.level_textures || std::less<const grs_bitmap *>{}(&bm, vk_level_texture_bitmaps))
+		return 0;
+	const std::size_t i = &bm - vk_level_texture_bitmaps;
+	return i < vk_level_texture_layers.size() ? vk_level_texture_layers[i] : 0;
+}
+
+static void vk_release_level_textures()
+{
+	if (g_vk.level_textures)
+		vk_retire_texture(std::exchange(g_vk.level_textures, nullptr));
+	vk_level_texture_layers.clear();
+}
+
 void ogl_init_texture(ogl_texture &t, int w, int h, int flags)
 {
-	t = {};
+	t.handle = 0;
+	t.internalformat = 0;
+	t.format = 0;
 	t.w = w;
 	t.h = h;
-	t.handle = 0;
+	t.tw = t.th = 0;
+	t.lw = w;
+	t.bytesu = t.bytes = 0;
+	t.u = t.v = 0;
+	t.prio = 0;
 	t.wrapstate = -1;
+	t.numrend = 0;
 }
 
 void ogl_init_texture_list_internal()
 {
+	vk_release_level_textures();
+	for (auto &t : ogl_textures)
+	{
+		vk_free_bitmap_texture(t);
+		ogl_init_texture(t, 0, 0, 0);
+	}
+	ogl_textures.clear();
+	mem_trim_register(mem_trim_cost::upload, ogl_textures_trim);
 }
 
 void ogl_smash_texture_list_internal()
 {
+	// Keep the entries so the bitmaps reload on next use
+	vk_release_level_textures();
+	for (auto &t : ogl_textures)
+	{
+		vk_free_bitmap_texture(t);
+		t.wrapstate = -1;
+	}
 }
 
 void ogl_vivify_texture_list_internal()
 {
 }
 
+void vk_release_bitmap_textures()
+{
+	ogl_smash_texture_list_internal();
+}
+
+void vk_evict_bitmap_textures()
+{
+	// vk_retire_texture keeps each until the frames using it are done
+	for (const auto t : ogl_textures.end_frame())
+		vk_free_bitmap_texture(*t);
+}
+
 void ogl_loadbmtexture_f(grs_bitmap &rbm, const opengl_texture_filter texfilt, bool texanis, bool edgepad)
 {
-	// For Vulkan, texture loading is deferred to the point of use
-	// The actual Vulkan texture is created on first bind
+	grs_bitmap *bm = &rbm;
+	while (const auto bm_parent = bm->bm_parent)
+		bm = bm_parent;
+	if (bm->gltexture && bm->gltexture->handle > 0)
+		return;
+	if (!g_vk.initialized || !bm->bm_data)
+		return;
+	const unsigned bm_w = bm->bm_w;
+	const unsigned bm_h = bm->bm_h;
+	if (bm->gltexture == NULL)
+		ogl_init_texture(*(bm->gltexture = ogl_get_free_texture()), bm_w, bm_h, 0);
+	else if (bm->gltexture->w == 0)
+	{
+		bm->gltexture->lw = bm_w;
+		bm->gltexture->w = bm_w;
+		bm->gltexture->h = bm_h;
+	}
+
+	vk_bitmap_decodebuf decodebuf;
+	const auto buf = vk_bitmap_pixels(*bm, decodebuf);
+
+	// Conversion buffer is reused across uploads
+	static std::vector<uint8_t> rgba;
+	rgba.resize(bm_w * bm_h * 4);
+	vk_palettized_to_rgba(gr_palette, buf, bm_w * bm_h, bm->get_flags(), rgba.data());
+
+	auto *const vkt = vk_create_texture(bm_w, bm_h, rgba.data());
+	if (!vkt)
+	{
+		con_printf(CON_URGENT, "VK: failed to create %ux%u bitmap texture", bm_w, bm_h);
+		return;
+	}
+	auto &t = *bm->gltexture;
+	t.tw = vkt->tw;
+	t.th = vkt->th;
+	t.u = vkt->u_scale;
+	t.v = vkt->v_scale;
+	const std::size_t slot = t.pool_index;
+	if (slot >= vk_texture_slots.size())
+		vk_texture_slots.resize(slot + 1);
+	vk_texture_slots[slot] = vkt;
+	t.handle = static_cast<GLuint>(slot + 1);
+	ogl_textures.note_loaded(t, std::size_t{vkt->tw} * vkt->th * 4, true);
 }
 
 void ogl_freebmtexture(grs_bitmap &bm)
 {
-	// Free the Vulkan texture if any
-	if (bm.gltexture)
+	if (auto &gltexture = bm.gltexture)
 	{
-		auto *vkt = reinterpret_cast<vk_texture *>(bm.gltexture->handle);
-		if (vkt)
+		auto &t = *std::exchange(gltexture, nullptr);
+		if (t.handle > 0)
 		{
-			vk_destroy_texture(vkt);
-			bm.gltexture->handle = 0;
+			vk_free_bitmap_texture(t);
+			ogl_init_texture(t, 0, 0, 0);
 		}
+		ogl_textures.release(t);
+	}
+}
+
+// Bind the bitmap's texture, uploading it on first use
+static const ogl_texture *vk_bind_bitmap(grs_bitmap &bm, bool edgepad)
+{
+	if (bm.gltexture == NULL || bm.gltexture->handle <= 0)
+		ogl_loadbmtexture_f(bm, CGameCfg.TexFilt, CGameCfg.TexAnisotropy, edgepad);
+	const auto t = bm.gltexture;
+	vk_bind_texture(t ? vk_bitmap_texture(*t) : nullptr);
+	if (t)
+	{
+		++t->numrend;
+		ogl_textures.touch(*t);
 	}
+	return t;
+}
+
+// Bind a wall bitmap, from the level texture array when it is packed
+// there.  Returns the pipeline to draw it with and sets layer.
+static vk_pipeline_id vk_bind_wall_bitmap(grs_bitmap &bm, float &layer)
+{
+	if (const auto l = vk_level_texture_layer(bm))
+	{
+		vk_bind_texture(g_vk.level_textures);
+		layer = static_cast<float>(l - 1);
+		return VK_PIPE_TEXTURED_ARRAY_3D;
+	}
+	vk_bind_bitmap(bm, true);
+	layer = 0;
+	return VK_PIPE_TEXTURED_3D;
 }
 
 // ============================================================
@@ -247,6 +1341,52 @@ void g3_draw_line(const g3_draw_line_context &context, const g3_draw_line_point
 	vk_draw_lines(verts.data(), 2, true);
 }
 
+namespace {
+std::vector<std::array<float, 3>> vk_static_line_points;
+std::vector<vk_vertex> vk_static_line_verts;
+}
+
+void ogl_upload_static_lines(const std::span<const std::array<float, 3>> points)
+{
+	vk_static_line_points.assign(points.begin(), points.end());
+}
+
+// The ends are moved to view space here, like the rotated points that
+// g3_draw_line takes, so that all the lines share one draw
+void ogl_draw_static_lines(const std::span<const ogl_static_line> lines)
+{
+	auto &verts = vk_static_line_verts;
+	verts.clear();
+	const auto &m = Gl_view_matrix;
+	for (auto &l : lines)
+	{
+		const std::size_t i = std::size_t{l.line} * 2;
+		if (i + 1 >= vk_static_line_points.size())
+			continue;
+		auto &&rgb{PAL2T(l.color)};
+		for (const auto &p : {vk_static_line_points[i], vk_static_line_points[i + 1]})
+		{
+			vk_vertex v{};
+			v.x = m[0] * p[0] + m[4] * p[1] + m[8] * p[2] + m[12];
+			v.y = m[1] * p[0] + m[5] * p[1] + m[9] * p[2] + m[13];
+			v.z = m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14];
+			v.r = rgb.r / 63.0f;
+			v.g = rgb.g / 63.0f;
+			v.b = rgb.b / 63.0f;
+			v.a = 1.0f;
+			verts.push_back(v);
+		}
+	}
+	if (!verts.empty())
+		vk_draw_lines(verts.data(), verts.size(), true);
+}
+
+void ogl_free_static_lines()
+{
+	vk_static_line_points = {};
+	vk_static_line_verts = {};
+}
+
 void _g3_draw_poly(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const uint8_t palette_color_index)
 {
 	if (pointlist.size() < 3 || pointlist.size() > MAX_POINTS_PER_POLY)
@@ -256,48 +1396,59 @@ void _g3_draw_poly(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 	const float cr = rgb.r / 63.0f;
 	const float cg = rgb.g / 63.0f;
 	const float cb = rgb.b / 63.0f;
-	const float ca = (canvas.cv_fade_level >= GR_FADE_OFF)
-		? 1.0f
-		: 1.0f - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0f);
 
 	std::array<vk_vertex, MAX_POINTS_PER_POLY> fan_verts;
 	for (size_t i = 0; i < pointlist.size(); i++)
 	{
 		auto &pv = pointlist[i]->p3_vec;
 		fan_verts[i] = {f2glf(pv.x), f2glf(pv.y), -f2glf(pv.z),
-		                cr, cg, cb, ca, 0.0f, 0.0f};
+		                cr, cg, cb, 1.0f, 0.0f, 0.0f};
 	}
 
-	vk_draw_triangle_fan(fan_verts.data(), static_cast<uint32_t>(pointlist.size()), false, true);
+	vk_draw_triangle_fan(fan_verts.data(), static_cast<uint32_t>(pointlist.size()), false, true, vk_fade_alpha(canvas));
 }
 
-void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const g3s_uvl *const uvl_list, const g3s_lrgb *const light_rgb, grs_bitmap &bm, const tmap_drawer_type tmap_drawer_ptr)
+// As _g3_draw_tmap.  A nonzero overlay is a vk_overlay_word for a wall
+// whose bitmap is in the level texture array; the overlay shaders sample
+// both layers in one draw.
+static void vk_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const g3s_uvl *const uvl_list, const g3s_lrgb *const light_rgb, grs_bitmap &bm, const tmap_drawer_type tmap_drawer_ptr, const uint16_t overlay)
 {
 	const auto nv = pointlist.size();
 	if (nv < 3)
 		return;
 
-	const float color_alpha = (canvas.cv_fade_level >= GR_FADE_OFF)
-		? 1.0f
-		: (tmap_drawer_ptr == draw_tmap_flat
-			? (1.0f - static_cast<float>(canvas.cv_fade_level) / static_cast<float>(NUM_LIGHTING_LEVELS))
-			: (1.0f - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0f)));
+	const float fade = tmap_drawer_ptr == draw_tmap_flat
+		? vk_fade_alpha(canvas, NUM_LIGHTING_LEVELS)
+		: vk_fade_alpha(canvas);
 
 	bool textured = (tmap_drawer_ptr == draw_tmap);
 
-	// TODO: Bind Vulkan texture from bitmap when textured
-	if (!textured)
+	vk_pipeline_id pipe = VK_PIPE_FLAT_3D;
+	float layer = 0;
+	if (textured)
+	{
+		pipe = vk_bind_wall_bitmap(bm, layer);
+		if (overlay)
+			pipe = VK_PIPE_OVERLAY_ARRAY_3D;
+	}
+	else
 		vk_bind_texture(nullptr);
 
+	const auto static_face = textured ? vk_static_face() : nullptr;
 	std::array<vk_vertex, MAX_POINTS_PER_POLY> fan_verts;
 	for (size_t i = 0; i < nv; i++)
 	{
-		auto &pv = pointlist[i]->p3_vec;
 		vk_vertex &v = fan_verts[i];
-		v.x = f2glf(pv.x);
-		v.y = f2glf(pv.y);
-		v.z = -f2glf(pv.z);
-		v.a = color_alpha;
+		if (!static_face)
+		{
+			auto &pv = pointlist[i]->p3_vec;
+			v.x = f2glf(pv.x);
+			v.y = f2glf(pv.y);
+			v.z = -f2glf(pv.z);
+		}
+		v.a = 1.0f;
+		v.layer = layer;
+		v.overlay = overlay;
 
 		if (tmap_drawer_ptr == draw_tmap_flat)
 		{
@@ -318,32 +1469,66 @@ void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const
 			v.v = f2glf(uvl_list[i].v);
 		}
 	}
+	if (textured)
+		vk_recentre_uvs(std::span(fan_verts).first(nv));
+
+	// Every vertex has alpha 1, so a bitmap with no transparent texels
+	// draws opaque.  An overlay is blended over this bitmap, so the draw
+	// is as opaque as the bottom one.
+	g_vk.draw_opaque = textured && !bm.get_flag_mask(BM_FLAG_TRANSPARENT | BM_FLAG_SUPER_TRANSPARENT);
+	vk_draw_wall_fan(pipe, fan_verts.data(), static_cast<uint32_t>(nv), fade, static_face, !bm.get_flag_mask(BM_FLAG_NO_LIGHTING));
+	g_vk.draw_opaque = false;
+}
+
+void _g3_draw_tmap(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const g3s_uvl *const uvl_list, const g3s_lrgb *const light_rgb, grs_bitmap &bm, const tmap_drawer_type tmap_drawer_ptr)
+{
+	vk_draw_tmap(canvas, pointlist, uvl_list, light_rgb, bm, tmap_drawer_ptr, 0);
+}
 
-	vk_draw_triangle_fan(fan_verts.data(), static_cast<uint32_t>(nv), textured, true);
+// The overlay shaders rotate the overlay's texture coordinates by orient
+// and blend it over the bottom texture by its alpha, as the second pass
+// would.  That needs both bitmaps in the level texture array and lit the
+// same way, since the draw has only one set of vertex colors.
+static uint16_t vk_overlay_for(const grs_bitmap &bmbot, const grs_bitmap &bm, const texture2_rotation_low orient, const tmap_drawer_type tmap_drawer_ptr)
+{
+	if (tmap_drawer_ptr != draw_tmap || bmbot.get_flag_mask(BM_FLAG_NO_LIGHTING) != bm.get_flag_mask(BM_FLAG_NO_LIGHTING))
+		return 0;
+	if (!vk_level_texture_layer(bmbot))
+		return 0;
+	const auto l = vk_level_texture_layer(bm);
+	if (!l || l - 1 > VK_OVERLAY_MAX_LAYER)
+		return 0;
+	return vk_overlay_word(l - 1, static_cast<unsigned>(orient));
 }
 
 void _g3_draw_tmap_2(grs_canvas &canvas, const std::span<g3_draw_tmap_point *const> pointlist, const std::span<const g3s_uvl, 4> uvl_list, const std::span<const g3s_lrgb, 4> light_rgb, grs_bitmap &bmbot, grs_bitmap &bm, const texture2_rotation_low orient, const tmap_drawer_type tmap_drawer_ptr)
 {
+	if (const auto overlay = vk_overlay_for(bmbot, bm, orient, tmap_drawer_ptr))
+		return vk_draw_tmap(canvas, pointlist, uvl_list.data(), light_rgb.data(), bmbot, tmap_drawer_ptr, overlay);
+
 	// Draw bottom texture first
 	_g3_draw_tmap(canvas, pointlist, uvl_list.data(), light_rgb.data(), bmbot, tmap_drawer_ptr);
 
 	// Then draw overlay texture with rotation
 	const auto nv = pointlist.size();
-	const float alpha = (canvas.cv_fade_level >= GR_FADE_OFF)
-		? 1.0f
-		: (1.0f - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0f));
 
-	// TODO: Bind overlay Vulkan texture
+	float layer;
+	const auto pipe = vk_bind_wall_bitmap(bm, layer);
 
+	const auto static_face = vk_static_face();
 	std::array<vk_vertex, MAX_POINTS_PER_POLY> fan_verts;
 	for (size_t i = 0; i < nv; i++)
 	{
-		auto &pv = pointlist[i]->p3_vec;
 		vk_vertex &v = fan_verts[i];
-		v.x = f2glf(pv.x);
-		v.y = f2glf(pv.y);
-		v.z = -f2glf(pv.z);
-		v.a = alpha;
+		if (!static_face)
+		{
+			auto &pv = pointlist[i]->p3_vec;
+			v.x = f2glf(pv.x);
+			v.y = f2glf(pv.y);
+			v.z = -f2glf(pv.z);
+		}
+		v.a = 1.0f;
+		v.layer = layer;
 
 		if (bm.get_flag_mask(BM_FLAG_NO_LIGHTING))
 			v.r = v.g = v.b = 1.0f;
@@ -368,8 +1553,9 @@ void _g3_draw_tmap_2(grs_canvas &canvas, const std::span<g3_draw_tmap_point *con
 				v.u = uf; v.v = vf; break;
 		}
 	}
+	vk_recentre_uvs(std::span(fan_verts).first(nv));
 
-	vk_draw_triangle_fan(fan_verts.data(), static_cast<uint32_t>(nv), true, true);
+	vk_draw_wall_fan(pipe, fan_verts.data(), static_cast<uint32_t>(nv), vk_fade_alpha(canvas), static_face, !bm.get_flag_mask(BM_FLAG_NO_LIGHTING));
 }
 
 void g3_draw_bitmap(grs_canvas &canvas, const vms_vector &pos, const fix iwidth, const fix iheight, grs_bitmap &bm)
@@ -378,12 +1564,10 @@ void g3_draw_bitmap(grs_canvas &canvas, const vms_vector &pos, const fix iwidth,
 	const auto height = fixmul(iheight, Matrix_scale.y);
 
 	const auto &&rpv{vm_vec_build_rotated(vm_vec_build_sub(pos, View_position), View_matrix)};
-	const float alpha = (canvas.cv_fade_level >= GR_FADE_OFF) ? 1.0f
-		: (1.0f - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0f));
 
-	// TODO: bind Vulkan texture from bitmap
-	const float bmglu = 1.0f; // bm.gltexture ? bm.gltexture->u : 1.0f
-	const float bmglv = 1.0f;
+	const auto gltexture = vk_bind_bitmap(bm, false);
+	const float bmglu = gltexture ? gltexture->u : 1.0f;
+	const float bmglv = gltexture ? gltexture->v : 1.0f;
 
 	const float vz = -f2glf(rpv.z);
 	std::array<vk_vertex, 4> fan_verts;
@@ -393,7 +1577,7 @@ void g3_draw_bitmap(grs_canvas &canvas, const vms_vector &pos, const fix iwidth,
 		pv.x += dx;
 		pv.y += dy;
 		fan_verts[idx] = {f2glf(pv.x), f2glf(pv.y), vz,
-		                  1.0f, 1.0f, 1.0f, alpha, tu, tv};
+		                  1.0f, 1.0f, 1.0f, 1.0f, tu, tv};
 	};
 
 	make_vert(0, -width,  height, 0.0f, 0.0f);
@@ -401,7 +1585,7 @@ void g3_draw_bitmap(grs_canvas &canvas, const vms_vector &pos, const fix iwidth,
 	make_vert(2,  width, -height, bmglu, bmglv);
 	make_vert(3, -width, -height, 0.0f, bmglv);
 
-	vk_draw_triangle_fan(fan_verts.data(), 4, true, true);
+	vk_draw_triangle_fan(fan_verts.data(), 4, true, true, vk_fade_alpha(canvas));
 }
 
 void ogl_draw_vertex_reticle(grs_canvas &canvas, int cross, int primary, int secondary, int color, int alpha, int size_offs)
@@ -430,20 +1614,36 @@ void ogl_draw_vertex_reticle(grs_canvas &canvas, int cross, int primary, int sec
 
 bool ogl_ubitblt_i(unsigned dw, unsigned dh, unsigned dx, unsigned dy, unsigned sw, unsigned sh, unsigned sx, unsigned sy, const grs_bitmap &src, grs_bitmap &dest, const opengl_texture_filter texfilt)
 {
-	// TODO: implement proper texture blit for Vulkan
-	// For now, create a temporary texture and draw a quad
+	// The source is usually a canvas that changes between calls, so upload
+	// the region into a one-shot texture, as ogl.cpp does.
+	static std::vector<uint8_t> rgba;
+	rgba.resize(sw * sh * 4);
+	const auto data = src.get_bitmap_data();
+	const ogl_palette_lut lut(gr_current_pal, GL_RGBA, src.get_flags());
+	for (unsigned row = 0; row < sh; row++)
+		lut.expand(data + (sy + row) * src.bm_rowsize + sx, sw, rgba.data() + row * sw * 4);
+	auto *const tex = vk_create_texture(sw, sh, rgba.data());
+	if (!tex)
+		return false;
+	vk_bind_texture(tex);
+
+	dx += dest.bm_x;
+	dy += dest.bm_y;
 	const float xo = dx / static_cast<float>(g_vk.screen_width);
 	const float xs = dw / static_cast<float>(g_vk.screen_width);
 	const float yo = 1.0f - dy / static_cast<float>(g_vk.screen_height);
 	const float ys = dh / static_cast<float>(g_vk.screen_height);
+	const float u = tex->u_scale;
+	const float v = tex->v_scale;
 
 	std::array<vk_vertex, 4> fan;
 	fan[0] = {xo, yo, 0, 1, 1, 1, 1, 0, 0};
-	fan[1] = {xo + xs, yo, 0, 1, 1, 1, 1, 1, 0};
-	fan[2] = {xo + xs, yo - ys, 0, 1, 1, 1, 1, 1, 1};
-	fan[3] = {xo, yo - ys, 0, 1, 1, 1, 1, 0, 1};
+	fan[1] = {xo + xs, yo, 0, 1, 1, 1, 1, u, 0};
+	fan[2] = {xo + xs, yo - ys, 0, 1, 1, 1, 1, u, v};
+	fan[3] = {xo, yo - ys, 0, 1, 1, 1, 1, 0, v};
 
 	vk_draw_triangle_fan(fan.data(), 4, true, false);
+	vk_retire_texture(tex);
 	return false;
 }
 
@@ -466,7 +1666,6 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, const int entry_x, const int entry_y, c
 
 bool ogl_ubitmapm_cs(grs_canvas &canvas, int x0, int y0, int dw, int dh, grs_bitmap &bm, const ogl_colors::array_type &color_array, bool fill)
 {
-	// TODO: proper bitmap rendering with Vulkan texture
 	const int x = x0 + canvas.cv_bitmap.bm_x;
 	const int y = y0 + canvas.cv_bitmap.bm_y;
 	const float xo = x / static_cast<float>(g_vk.screen_width);
@@ -474,6 +1673,18 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, int x0, int y0, int dw, int dh, grs_bit
 	const float xs = (dw > 0 ? dw : bm.bm_w) / static_cast<float>(g_vk.screen_width);
 	const float ys = (dh > 0 ? dh : bm.bm_h) / static_cast<float>(g_vk.screen_height);
 
+	// Sub-bitmaps (font glyphs, cockpit pieces) address part of the parent texture
+	float u1 = 0, u2 = 1, v1 = 0, v2 = 1;
+	if (const auto gltexture = vk_bind_bitmap(bm, false); gltexture && gltexture->tw && gltexture->th)
+	{
+		const float tw = static_cast<float>(gltexture->tw);
+		const float th = static_cast<float>(gltexture->th);
+		u1 = bm.bm_x / tw;
+		u2 = (bm.bm_x == 0 && bm.bm_w == gltexture->w) ? gltexture->u : (bm.bm_w + bm.bm_x) / tw;
+		v1 = bm.bm_y / th;
+		v2 = (bm.bm_y == 0 && bm.bm_h == gltexture->h) ? gltexture->v : (bm.bm_h + bm.bm_y) / th;
+	}
+
 	std::array<vk_vertex, 4> fan;
 	for (int i = 0; i < 4; i++)
 	{
@@ -482,15 +1693,43 @@ bool ogl_ubitmapm_cs(grs_canvas &canvas, int x0, int y0, int dw, int dh, grs_bit
 		fan[i].b = color_array[i * 4 + 2];
 		fan[i].a = color_array[i * 4 + 3];
 	}
-	fan[0].x = xo;      fan[0].y = yo;      fan[0].z = 0; fan[0].u = 0; fan[0].v = 0;
-	fan[1].x = xo + xs; fan[1].y = yo;      fan[1].z = 0; fan[1].u = 1; fan[1].v = 0;
-	fan[2].x = xo + xs; fan[2].y = yo - ys; fan[2].z = 0; fan[2].u = 1; fan[2].v = 1;
-	fan[3].x = xo;      fan[3].y = yo - ys; fan[3].z = 0; fan[3].u = 0; fan[3].v = 1;
+	fan[0].x = xo;      fan[0].y = yo;      fan[0].z = 0; fan[0].u = u1; fan[0].v = v1;
+	fan[1].x = xo + xs; fan[1].y = yo;      fan[1].z = 0; fan[1].u = u2; fan[1].v = v1;
+	fan[2].x = xo + xs; fan[2].y = yo - ys; fan[2].z = 0; fan[2].u = u2; fan[2].v = v2;
+	fan[3].x = xo;      fan[3].y = yo - ys; fan[3].z = 0; fan[3].u = u1; fan[3].v = v2;
 
 	vk_draw_triangle_fan(fan.data(), 4, true, false);
 	return false;
 }
 
+// Consecutive draws with the same pipeline and texture already share a
+// batch, so each character is drawn on its own
+void ogl_ubitmapm_glyphs(grs_canvas &canvas, const std::span<const ogl_glyph_quad> glyphs)
+{
+	for (auto &g : glyphs)
+	{
+		ogl_colors::array_type color_array;
+		for (std::size_t i = 0; i != 4; ++i)
+			std::copy(g.color.begin(), g.color.end(), std::next(color_array.begin(), i * 4));
+		ogl_ubitmapm_cs(canvas, g.x, g.y, g.w, g.h, *g.bm, color_array, false);
+	}
+}
+
+// Copying the swapchain image back is not implemented, so callers redraw
+// the region every frame
+void ogl_retain_screen_region(int, int, int, int)
+{
+}
+
+bool ogl_draw_screen_region(int, int, int, int)
+{
+	return false;
+}
+
+void ogl_discard_screen_region()
+{
+}
+
 bool ogl_ubitblt_cs(grs_canvas &canvas, int dw, int dh, int dx, int dy, int sx, int sy)
 {
 	// Stub for screen copy
@@ -536,25 +1775,18 @@ void ogl_urect(grs_canvas &canvas, const int left, const int top, const int righ
 	const float cr = CPAL2Tr(c);
 	const float cg = CPAL2Tg(c);
 	const float cb = CPAL2Tb(c);
-	const float ca = (canvas.cv_fade_level >= GR_FADE_OFF)
-		? 1.0f
-		: 1.0f - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0f);
 
 	std::array<vk_vertex, 4> fan;
-	fan[0] = {xo, yo, 0, cr, cg, cb, ca, 0, 0};
-	fan[1] = {xo, yf, 0, cr, cg, cb, ca, 0, 0};
-	fan[2] = {xf, yf, 0, cr, cg, cb, ca, 0, 0};
-	fan[3] = {xf, yo, 0, cr, cg, cb, ca, 0, 0};
+	fan[0] = {xo, yo, 0, cr, cg, cb, 1, 0, 0};
+	fan[1] = {xo, yf, 0, cr, cg, cb, 1, 0, 0};
+	fan[2] = {xf, yf, 0, cr, cg, cb, 1, 0, 0};
+	fan[3] = {xf, yo, 0, cr, cg, cb, 1, 0, 0};
 
-	vk_draw_triangle_fan(fan.data(), 4, false, false);
+	vk_draw_triangle_fan(fan.data(), 4, false, false, vk_fade_alpha(canvas));
 }
 
 void ogl_ulinec(grs_canvas &canvas, const int left, const int top, const int right, const int bot, const int c)
 {
-	const float ca = (canvas.cv_fade_level >= GR_FADE_OFF)
-		? 1.0f
-		: 1.0f - static_cast<float>(canvas.cv_fade_level) / (static_cast<float>(GR_FADE_LEVELS) - 1.0f);
-
 	const float cr = CPAL2Tr(c);
 	const float cg = CPAL2Tg(c);
 	const float cb = CPAL2Tb(c);
@@ -565,10 +1797,10 @@ void ogl_ulinec(grs_canvas &canvas, const int left, const int top, const int rig
 	const float yf = 1.0f - (bot + canvas.cv_bitmap.bm_y + 0.5f) / static_cast<float>(g_vk.screen_height);
 
 	std::array<vk_vertex, 2> verts;
-	verts[0] = {xo, yo, 0, cr, cg, cb, ca, 0, 0};
-	verts[1] = {xf, yf, 0, cr, cg, cb, ca, 0, 0};
+	verts[0] = {xo, yo, 0, cr, cg, cb, 1, 0, 0};
+	verts[1] = {xf, yf, 0, cr, cg, cb, 1, 0, 0};
 
-	vk_draw_lines(verts.data(), 2, false);
+	vk_draw_lines(verts.data(), 2, false, vk_fade_alpha(canvas));
 }
 
 void ogl_toggle_depth_test(int enable)
@@ -596,6 +1828,7 @@ void ogl_set_blending(const gr_blend cv_blend_func)
 
 void ogl_start_frame(grs_canvas &canvas)
 {
+	vk_set_gpu_pass(vk_gpu_pass::mine);
 	g_vk.is_3d_mode = true;
 
 	// Set up perspective projection (matching GL: fov=90, aspect=1, near=0.1, far=5000)
@@ -608,6 +1841,7 @@ void ogl_start_frame(grs_canvas &canvas)
 
 void ogl_end_frame()
 {
+	vk_set_gpu_pass(vk_gpu_pass::blit_2d);
 	g_vk.is_3d_mode = false;
 
 	// Switch to orthographic projection for 2D
@@ -616,10 +1850,36 @@ void ogl_end_frame()
 	vk_update_mvp();
 }
 
+// Palette flashes are one fullscreen quad blended over the finished frame,
+// as ogl.cpp does, so no geometry is re-recorded when the flash changes.
 void ogl_do_palfx()
 {
-	// Palette effects - draw fullscreen tinted quad
-	// Simplified stub for now
+	if (!g_vk.palette_flash_active)
+		return;
+	auto [r, g, b] = g_vk.palette_flash;
+	const auto saved_blend = g_vk.current_blend;
+	if (r <= 0 && g <= 0 && b <= 0)
+	{
+		// scale negative effect by 2.5 to match D1/D2 on GL
+		r *= -2.5f;
+		g *= -2.5f;
+		b *= -2.5f;
+		g_vk.current_blend = VK_BLEND_SUBTRACTIVE_C;
+	}
+	else
+		g_vk.current_blend = VK_BLEND_ADDITIVE_C;
+
+	vk_mat4_ortho(g_vk.projection_matrix, 0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 1.0f);
+	vk_mat4_identity(g_vk.modelview_matrix);
+	vk_update_mvp();
+
+	std::array<vk_vertex, 4> fan;
+	fan[0] = {0, 0, 0, r, g, b, 1, 0, 0};
+	fan[1] = {0, 1, 0, r, g, b, 1, 0, 0};
+	fan[2] = {1, 1, 0, r, g, b, 1, 0, 0};
+	fan[3] = {1, 0, 0, r, g, b, 1, 0, 0};
+	vk_draw_fan(VK_PIPE_FLAT_2D, fan.data(), 4);
+	g_vk.current_blend = saved_blend;
 }
 
 void ogl_init_shared_palette()
@@ -643,22 +1903,6 @@ void ogl_set_screen_mode()
 // by other game code through ogl_init.h declarations.
 // -------------------------------------------------------
 
-static std::array<ogl_texture, 20000> ogl_texture_list;
-static unsigned ogl_texture_list_cur;
-
-ogl_texture* ogl_get_free_texture()
-{
-	for (unsigned i = ogl_texture_list.size(); i--;)
-	{
-		if (ogl_texture_list[ogl_texture_list_cur].handle <= 0 &&
-		    ogl_texture_list[ogl_texture_list_cur].w == 0)
-			return &ogl_texture_list[ogl_texture_list_cur];
-		if (++ogl_texture_list_cur >= ogl_texture_list.size())
-			ogl_texture_list_cur = 0;
-	}
-	throw std::runtime_error("Vulkan: texture list full");
-}
-
 const ogl_colors::array_type ogl_colors::white = {{
 	1.0, 1.0, 1.0, 1.0,
 	1.0, 1.0, 1.0, 1.0,
@@ -684,21 +1928,63 @@ const ogl_colors::array_type &ogl_colors::init_palette(const unsigned c)
 	return a;
 }
 
-int gr_ucircle(grs_canvas &, const fix, const fix, const fix, const uint8_t)
+// Circles, disks and spheres are one quad each.  circle.frag derives the
+// coverage from the distance to the centre; the quad extends one pixel
+// (pad) past the radius so the antialiased rim is not clipped.  inner is
+// the ring's inner radius as a fraction of the outer one, 0 for a disk.
+static void vk_draw_circle(const vk_pipeline_id pipe, const float x, const float y, const float z, const float rx, const float ry, const float pad, const float inner, const color_palette_index c, const float fade)
+{
+	vk_bind_texture(nullptr);
+	const float cr = CPAL2Tr(c);
+	const float cg = CPAL2Tg(c);
+	const float cb = CPAL2Tb(c);
+	const float px = rx * pad, py = ry * pad;
+	std::array<vk_vertex, 4> fan;
+	fan[0] = {x - px, y - py, z, cr, cg, cb, 1, -pad, -pad, inner};
+	fan[1] = {x + px, y - py, z, cr, cg, cb, 1, pad, -pad, inner};
+	fan[2] = {x + px, y + py, z, cr, cg, cb, 1, pad, pad, inner};
+	fan[3] = {x - px, y + py, z, cr, cg, cb, 1, -pad, pad, inner};
+	vk_draw_fan(pipe, fan.data(), 4, fade);
+}
+
+static void vk_draw_circle_2d(const grs_canvas &canvas, const fix xc, const fix yc, const fix r, const color_palette_index c, const bool filled)
+{
+	const float rpx = f2fl(r);
+	if (rpx <= 0)
+		return;
+	const float x = (f2fl(xc) + canvas.cv_bitmap.bm_x + 0.5f) / static_cast<float>(g_vk.screen_width);
+	const float y = 1.0f - (f2fl(yc) + canvas.cv_bitmap.bm_y + 0.5f) / static_cast<float>(g_vk.screen_height);
+	// A one pixel outline; circles too small for a hole are drawn filled
+	const float inner = filled || rpx <= 1 ? 0.0f : 1.0f - 1.0f / rpx;
+	vk_draw_circle(VK_PIPE_CIRCLE_2D, x, y, 0, rpx / g_vk.screen_width, rpx / g_vk.screen_height,
+		(rpx + 1) / rpx, inner, c, vk_fade_alpha(canvas));
+}
+
+int gr_ucircle(grs_canvas &canvas, const fix xc1, const fix yc1, const fix r1, const uint8_t c)
 {
-	// TODO: Vulkan circle rendering
+	vk_draw_circle_2d(canvas, xc1, yc1, r1, c, false);
 	return 0;
 }
 
-int gr_disk(grs_canvas &, const fix, const fix, const fix, const uint8_t)
+int gr_disk(grs_canvas &canvas, const fix x, const fix y, const fix r, const uint8_t c)
 {
-	// TODO: Vulkan disk rendering
+	vk_draw_circle_2d(canvas, x, y, r, c, true);
 	return 0;
 }
 
-void g3_draw_sphere(grs_canvas &, const g3_rotated_point &, fix, const uint8_t)
+/*
+ * Stars on heaven in exit sequence, automap objects
+ */
+void g3_draw_sphere(grs_canvas &canvas, const g3_rotated_point &pnt, const fix rad, const uint8_t c)
 {
-	// TODO: Vulkan sphere rendering
+	// The projection has a fixed aspect of 1, so correct for the canvas as
+	// ogl.cpp does
+	const float scale = static_cast<float>(canvas.cv_bitmap.bm_w) / canvas.cv_bitmap.bm_h;
+	const float r = f2glf(rad);
+	const float rx = scale >= 1 ? r / scale : r;
+	const float ry = scale >= 1 ? r : r * scale;
+	vk_draw_circle(VK_PIPE_CIRCLE_3D, f2glf(pnt.p3_vec.x), f2glf(pnt.p3_vec.y), -f2glf(pnt.p3_vec.z),
+		rx, ry, 1.0f, 0.0f, c, 1.0f);
 }
 
 }  // namespace dcx
@@ -707,7 +1993,85 @@ namespace dsx {
 
 void ogl_cache_level_textures()
 {
-	// Pre-cache textures for the level - stub for Vulkan
+	vk_release_level_textures();
+	if (!CGameArg.OglVkArrayTextures || !g_vk.initialized)
+		return;
+
+	// The level's wall textures and overlays, plus every frame of the
+	// effects that animate them
+	auto &Effects = LevelUniqueEffectsClipState.Effects;
+	std::vector<bitmap_index> bitmaps;
+	const auto add_texture = [&bitmaps](const texture_index t) {
+		if (t < NumTextures && t < Textures.size())
+			bitmaps.emplace_back(Textures[t]);
+	};
+	range_for (const unique_segment &seg, vcsegptr)
+	{
+		range_for (auto &side, seg.sides)
+		{
+			add_texture(get_texture_index(side.tmap_num));
+			if (side.tmap_num2 != texture2_value::None)
+				add_texture(get_texture_index(side.tmap_num2));
+		}
+	}
+	range_for (auto &ec, partial_const_range(Effects, Num_effects))
+	{
+		if (ec.changing_wall_texture == texture_index{UINT16_MAX})
+			continue;
+		range_for (const auto f, partial_const_range(ec.vc.frames, ec.vc.num_frames))
+			bitmaps.emplace_back(f);
+	}
+	std::sort(bitmaps.begin(), bitmaps.end());
+	bitmaps.erase(std::unique(bitmaps.begin(), bitmaps.end()), bitmaps.end());
+
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(g_vk.physical_device, &props);
+	const std::size_t max_layers = std::min<std::size_t>(props.limits.maxImageArrayLayers, UINT16_MAX);
+
+	constexpr unsigned tw = 64, th = 64;
+	constexpr std::size_t layer_pixels = tw * th, layer_bytes = layer_pixels * 4;
+	// Palette indices and flags of each layer.  They are copied here,
+	// since paging in a later bitmap may reuse the cache that holds an
+	// earlier one, and then expanded to RGBA on worker threads.
+	std::vector<uint8_t> pixels;
+	std::vector<uint8_t> layer_flags;
+	std::vector<uint16_t> layers(GameBitmaps.size());
+	vk_bitmap_decodebuf decodebuf;
+	uint16_t count = 0;
+	for (const auto b : bitmaps)
+	{
+		if (count == max_layers)
+		{
+			con_printf(CON_VERBOSE, "VK: level texture array full at %u layers", count);
+			break;
+		}
+		if (!GameBitmaps.valid_index(b))
+			continue;
+		PIGGY_PAGE_IN(b);
+		auto &bm = GameBitmaps[b];
+		if (bm.bm_w != tw || bm.bm_h != th || !bm.bm_data)
+			continue;
+		const auto src = vk_bitmap_pixels(bm, decodebuf);
+		pixels.insert(pixels.end(), src, src + layer_pixels);
+		layer_flags.emplace_back(bm.get_flags());
+		layers[static_cast<std::size_t>(b)] = ++count;
+	}
+	if (count < 2)
+		return;
+	std::vector<uint8_t> rgba(count * layer_bytes);
+	ogl_parallel_for(count, [&](const std::size_t i) {
+		vk_palettized_to_rgba(gr_palette, &pixels[i * layer_pixels], layer_pixels, layer_flags[i], &rgba[i * layer_bytes]);
+	});
+
+	g_vk.level_textures = vk_create_texture_array(tw, th, count, rgba.data());
+	if (!g_vk.level_textures)
+	{
+		con_printf(CON_URGENT, "VK: failed to create %u layer level texture array", count);
+		return;
+	}
+	vk_level_texture_layers = std::move(layers);
+	vk_level_texture_bitmaps = GameBitmaps.data();
+	con_printf(CON_DEBUG, "VK: packed %u level textures into an array", count);
 }
 
 }  // namespace dsx
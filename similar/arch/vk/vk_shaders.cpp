@@ -18,5 +18,12 @@
 #include "basic_frag_spv.h"
 #include "textured_vert_spv.h"
 #include "textured_frag_spv.h"
+#include "textured_array_vert_spv.h"
+#include "textured_array_frag_spv.h"
+#include "circle_frag_spv.h"
+#include "static_vert_spv.h"
+#include "static_array_vert_spv.h"
+#include "overlay_array_vert_spv.h"
+#include "overlay_array_frag_spv.h"
 
 #endif  // DXX_USE_VULKAN
@@ -8,40 +8,221 @@
 
 #include "vk_common.h"
 #include "console.h"
+#include <algorithm>
 
 namespace dcx {
 
-static VkCommandBuffer vk_begin_single_command()
+// ============================================================================
+// Upload batches
+// ============================================================================
+
+// Texture copies are recorded into the current upload batch, whose staging
+// memory is a slice of one persistent mapped buffer.  Batches are submitted
+// before each frame (or when their slice fills) and reused round-robin once
+// their fence has signalled, so uploading never idles the queue.
+
+static bool vk_separate_transfer_queue()
+{
+	return g_vk.transfer_family != g_vk.queue_family;
+}
+
+bool vk_create_upload_resources()
+{
+	VkCommandPoolCreateInfo pci{};
+	pci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	pci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	pci.queueFamilyIndex = g_vk.transfer_family;
+	if (vkCreateCommandPool(g_vk.device, &pci, nullptr, &g_vk.upload_pool) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: Failed to create upload command pool");
+		return false;
+	}
+
+	VkBufferCreateInfo bci{};
+	bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bci.size = VK_UPLOAD_SLICE_SIZE * VK_UPLOAD_BATCHES;
+	bci.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+	VmaAllocationCreateInfo aci{};
+	aci.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+	aci.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+	VmaAllocationInfo info{};
+	if (vmaCreateBuffer(g_vk.allocator, &bci, &aci, &g_vk.staging_buffer, &g_vk.staging_allocation, &info) != VK_SUCCESS)
+	{
+		con_puts(CON_URGENT, "VK: Failed to create staging buffer");
+		return false;
+	}
+	g_vk.staging_mapped = info.pMappedData;
+
+	for (auto &b : g_vk.uploads)
+	{
+		VkCommandBufferAllocateInfo ai{};
+		ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		ai.commandPool = g_vk.upload_pool;
+		ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		ai.commandBufferCount = 1;
+		if (vkAllocateCommandBuffers(g_vk.device, &ai, &b.cmd) != VK_SUCCESS)
+			return false;
+
+		VkFenceCreateInfo fi{};
+		fi.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		if (vkCreateFence(g_vk.device, &fi, nullptr, &b.fence) != VK_SUCCESS)
+			return false;
+
+		if (vk_separate_transfer_queue())
+		{
+			VkSemaphoreCreateInfo si{};
+			si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			if (vkCreateSemaphore(g_vk.device, &si, nullptr, &b.done) != VK_SUCCESS)
+				return false;
+		}
+	}
+	g_vk.current_upload = 0;
+	return true;
+}
+
+static void vk_free_oversized(vk_upload_batch &b)
+{
+	for (auto &[buffer, allocation] : b.oversized)
+		vmaDestroyBuffer(g_vk.allocator, buffer, allocation);
+	b.oversized.clear();
+}
+
+void vk_destroy_upload_resources()
+{
+	for (auto &b : g_vk.uploads)
+	{
+		vk_free_oversized(b);
+		if (b.done)
+			vkDestroySemaphore(g_vk.device, b.done, nullptr);
+		if (b.fence)
+			vkDestroyFence(g_vk.device, b.fence, nullptr);
+		b = {};
+	}
+	g_vk.upload_waits.clear();
+	if (g_vk.staging_buffer)
+		vmaDestroyBuffer(g_vk.allocator, g_vk.staging_buffer, g_vk.staging_allocation);
+	g_vk.staging_buffer = VK_NULL_HANDLE;
+	g_vk.staging_mapped = nullptr;
+	if (g_vk.upload_pool)
+		vkDestroyCommandPool(g_vk.device, g_vk.upload_pool, nullptr);
+	g_vk.upload_pool = VK_NULL_HANDLE;
+}
+
+// Wait on any signalled upload semaphores with an empty graphics submission,
+// so that a batch can signal its semaphore again during long load phases
+// with no frame to consume it
+static void vk_consume_upload_waits()
 {
-	VkCommandBufferAllocateInfo ai{};
-	ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	ai.commandPool = g_vk.command_pool;
-	ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	ai.commandBufferCount = 1;
+	if (g_vk.upload_waits.empty())
+		return;
+	std::array<VkPipelineStageFlags, VK_UPLOAD_BATCHES> stages;
+	stages.fill(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+	VkSubmitInfo si{};
+	si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	si.waitSemaphoreCount = static_cast<uint32_t>(g_vk.upload_waits.size());
+	si.pWaitSemaphores = g_vk.upload_waits.data();
+	si.pWaitDstStageMask = stages.data();
+	vkQueueSubmit(g_vk.graphics_queue, 1, &si, VK_NULL_HANDLE);
+	g_vk.upload_waits.clear();
+}
 
-	VkCommandBuffer cmd;
-	vkAllocateCommandBuffers(g_vk.device, &ai, &cmd);
+static vk_upload_batch &vk_begin_upload_batch()
+{
+	auto &b = g_vk.uploads[g_vk.current_upload];
+	if (b.recording)
+		return b;
+	if (b.submitted)
+	{
+		if (vkGetFenceStatus(g_vk.device, b.fence) != VK_SUCCESS)
+		{
+			++g_vk.draw_stats.upload_stalls;
+			vkWaitForFences(g_vk.device, 1, &b.fence, VK_TRUE, UINT64_MAX);
+		}
+		if (b.done && std::find(g_vk.upload_waits.begin(), g_vk.upload_waits.end(), b.done) != g_vk.upload_waits.end())
+			vk_consume_upload_waits();
+		vkResetFences(g_vk.device, 1, &b.fence);
+		b.submitted = false;
+	}
+	vk_free_oversized(b);
+	vkResetCommandBuffer(b.cmd, 0);
 
 	VkCommandBufferBeginInfo bi{};
 	bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-	vkBeginCommandBuffer(cmd, &bi);
-	return cmd;
+	vkBeginCommandBuffer(b.cmd, &bi);
+	b.used = 0;
+	b.recording = true;
+	return b;
 }
 
-static void vk_end_single_command(VkCommandBuffer cmd)
+void vk_submit_uploads()
 {
-	vkEndCommandBuffer(cmd);
+	auto &b = g_vk.uploads[g_vk.current_upload];
+	if (!b.recording)
+		return;
+	vkEndCommandBuffer(b.cmd);
 
 	VkSubmitInfo si{};
 	si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 	si.commandBufferCount = 1;
-	si.pCommandBuffers = &cmd;
+	si.pCommandBuffers = &b.cmd;
+	if (b.done)
+	{
+		si.signalSemaphoreCount = 1;
+		si.pSignalSemaphores = &b.done;
+	}
+	if (vkQueueSubmit(g_vk.transfer_queue, 1, &si, b.fence) != VK_SUCCESS)
+		con_puts(CON_URGENT, "VK: Failed to submit texture uploads");
+	else if (b.done)
+		g_vk.upload_waits.push_back(b.done);
+	b.recording = false;
+	b.submitted = true;
+	g_vk.current_upload = (g_vk.current_upload + 1) % VK_UPLOAD_BATCHES;
+}
 
-	vkQueueSubmit(g_vk.graphics_queue, 1, &si, VK_NULL_HANDLE);
-	vkQueueWaitIdle(g_vk.graphics_queue);
+// Reserve size bytes of staging memory in the current batch.  Returns the
+// batch to record the copy into, with the source buffer and offset.
+static vk_upload_batch *vk_reserve_upload(VkDeviceSize size, VkBuffer &buffer, VkDeviceSize &offset, void *&mapped)
+{
+	if (size > VK_UPLOAD_SLICE_SIZE)
+	{
+		// Too big for a slice: give it its own staging buffer
+		auto &b = vk_begin_upload_batch();
+		VkBufferCreateInfo bci{};
+		bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bci.size = size;
+		bci.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+		VmaAllocationCreateInfo aci{};
+		aci.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+		aci.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+		VmaAllocation allocation;
+		VmaAllocationInfo info{};
+		if (vmaCreateBuffer(g_vk.allocator, &bci, &aci, &buffer, &allocation, &info) != VK_SUCCESS)
+			return nullptr;
+		b.oversized.emplace_back(buffer, allocation);
+		offset = 0;
+		mapped = info.pMappedData;
+		return &b;
+	}
 
-	vkFreeCommandBuffers(g_vk.device, g_vk.command_pool, 1, &cmd);
+	// Copy offsets must be a multiple of the texel size
+	constexpr VkDeviceSize align = 16;
+	{
+		auto &b = g_vk.uploads[g_vk.current_upload];
+		if (b.recording && ((b.used + align - 1) & ~(align - 1)) + size > VK_UPLOAD_SLICE_SIZE)
+			vk_submit_uploads();
+	}
+	auto &b = vk_begin_upload_batch();
+	const VkDeviceSize start = (b.used + align - 1) & ~(align - 1);
+	b.used = start + size;
+	buffer = g_vk.staging_buffer;
+	offset = VK_UPLOAD_SLICE_SIZE * g_vk.current_upload + start;
+	mapped = static_cast<uint8_t *>(g_vk.staging_mapped) + offset;
+	return &b;
 }
 
 static uint32_t next_power_of_two(uint32_t v)
@@ -56,39 +237,62 @@ static uint32_t next_power_of_two(uint32_t v)
 	return v;
 }
 
-vk_texture *vk_create_texture(uint32_t w, uint32_t h, const uint8_t *rgba_data)
+// Create a sampled texture with the given number of layers.  A single layer
+// is padded to power-of-two dimensions; array layers are used as given.
+static vk_texture *vk_create_texture_layers(uint32_t w, uint32_t h, uint32_t layers, const uint8_t *rgba_data)
 {
 	auto *tex = new vk_texture();
 	tex->w = w;
 	tex->h = h;
-	tex->tw = next_power_of_two(w);
-	tex->th = next_power_of_two(h);
+	tex->tw = layers > 1 ? w : next_power_of_two(w);
+	tex->th = layers > 1 ? h : next_power_of_two(h);
+	tex->layers = layers;
 	tex->u_scale = static_cast<float>(w) / static_cast<float>(tex->tw);
 	tex->v_scale = static_cast<float>(h) / static_cast<float>(tex->th);
 
-	const VkDeviceSize image_size = static_cast<VkDeviceSize>(tex->tw) * tex->th * 4;
+	const VkDeviceSize image_size = static_cast<VkDeviceSize>(tex->tw) * tex->th * 4 * layers;
 
-	// Create staging buffer
-	VkBuffer staging_buffer;
-	VmaAllocation staging_alloc;
+	// Create image
+	VkImageCreateInfo ici{};
+	ici.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	ici.imageType = VK_IMAGE_TYPE_2D;
+	ici.format = VK_FORMAT_R8G8B8A8_UNORM;
+	ici.extent = {tex->tw, tex->th, 1};
+	ici.mipLevels = 1;
+	ici.arrayLayers = layers;
+	ici.samples = VK_SAMPLE_COUNT_1_BIT;
+	ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+	ici.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 
-	VkBufferCreateInfo bci{};
-	bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	bci.size = image_size;
-	bci.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	VmaAllocationCreateInfo iai{};
+	iai.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 
-	VmaAllocationCreateInfo sai{};
-	sai.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+	// Sampled by the graphics queue after a copy on the transfer queue
+	const std::array<uint32_t, 2> families = {g_vk.queue_family, g_vk.transfer_family};
+	if (vk_separate_transfer_queue())
+	{
+		ici.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		ici.queueFamilyIndexCount = families.size();
+		ici.pQueueFamilyIndices = families.data();
+	}
 
-	if (vmaCreateBuffer(g_vk.allocator, &bci, &sai, &staging_buffer, &staging_alloc, nullptr) != VK_SUCCESS)
+	if (vmaCreateImage(g_vk.allocator, &ici, &iai, &tex->image, &tex->allocation, nullptr) != VK_SUCCESS)
 	{
 		delete tex;
 		return nullptr;
 	}
 
 	// Copy data to staging (pad if necessary)
+	VkBuffer staging_buffer;
+	VkDeviceSize staging_offset;
 	void *mapped;
-	vmaMapMemory(g_vk.allocator, staging_alloc, &mapped);
+	auto *batch = vk_reserve_upload(image_size, staging_buffer, staging_offset, mapped);
+	if (!batch)
+	{
+		vmaDestroyImage(g_vk.allocator, tex->image, tex->allocation);
+		delete tex;
+		return nullptr;
+	}
 	if (w == tex->tw && h == tex->th)
 	{
 		memcpy(mapped, rgba_data, image_size);
@@ -101,32 +305,10 @@ vk_texture *vk_create_texture(uint32_t w, uint32_t h, const uint8_t *rgba_data)
 		for (uint32_t row = 0; row < h; row++)
 			memcpy(dst + row * tex->tw * 4, rgba_data + row * w * 4, w * 4);
 	}
-	vmaUnmapMemory(g_vk.allocator, staging_alloc);
-
-	// Create image
-	VkImageCreateInfo ici{};
-	ici.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-	ici.imageType = VK_IMAGE_TYPE_2D;
-	ici.format = VK_FORMAT_R8G8B8A8_UNORM;
-	ici.extent = {tex->tw, tex->th, 1};
-	ici.mipLevels = 1;
-	ici.arrayLayers = 1;
-	ici.samples = VK_SAMPLE_COUNT_1_BIT;
-	ici.tiling = VK_IMAGE_TILING_OPTIMAL;
-	ici.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-
-	VmaAllocationCreateInfo iai{};
-	iai.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-
-	if (vmaCreateImage(g_vk.allocator, &ici, &iai, &tex->image, &tex->allocation, nullptr) != VK_SUCCESS)
-	{
-		vmaDestroyBuffer(g_vk.allocator, staging_buffer, staging_alloc);
-		delete tex;
-		return nullptr;
-	}
+	++g_vk.draw_stats.texture_uploads;
 
 	// Transition image to transfer dst, copy, then transition to shader read
-	auto cmd = vk_begin_single_command();
+	const auto cmd = batch->cmd;
 
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -137,7 +319,7 @@ vk_texture *vk_create_texture(uint32_t w, uint32_t h, const uint8_t *rgba_data)
 	barrier.image = tex->image;
 	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	barrier.subresourceRange.levelCount = 1;
-	barrier.subresourceRange.layerCount = 1;
+	barrier.subresourceRange.layerCount = layers;
 	barrier.srcAccessMask = 0;
 	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
@@ -146,8 +328,9 @@ vk_texture *vk_create_texture(uint32_t w, uint32_t h, const uint8_t *rgba_data)
 		0, 0, nullptr, 0, nullptr, 1, &barrier);
 
 	VkBufferImageCopy region{};
+	region.bufferOffset = staging_offset;
 	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.layerCount = 1;
+	region.imageSubresource.layerCount = layers;
 	region.imageExtent = {tex->tw, tex->th, 1};
 
 	vkCmdCopyBufferToImage(cmd, staging_buffer, tex->image,
@@ -156,26 +339,25 @@ vk_texture *vk_create_texture(uint32_t w, uint32_t h, const uint8_t *rgba_data)
 	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	// On a transfer queue the frame submission's semaphore wait orders the
+	// copy against fragment shading instead
+	const bool transfer = vk_separate_transfer_queue();
+	barrier.dstAccessMask = transfer ? 0 : VK_ACCESS_SHADER_READ_BIT;
 
 	vkCmdPipelineBarrier(cmd,
-		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		transfer ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
 		0, 0, nullptr, 0, nullptr, 1, &barrier);
 
-	vk_end_single_command(cmd);
-
-	// Cleanup staging
-	vmaDestroyBuffer(g_vk.allocator, staging_buffer, staging_alloc);
-
 	// Create image view
 	VkImageViewCreateInfo vci{};
 	vci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	vci.image = tex->image;
-	vci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	vci.viewType = layers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
 	vci.format = VK_FORMAT_R8G8B8A8_UNORM;
 	vci.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	vci.subresourceRange.levelCount = 1;
-	vci.subresourceRange.layerCount = 1;
+	vci.subresourceRange.layerCount = layers;
 
 	if (vkCreateImageView(g_vk.device, &vci, nullptr, &tex->view) != VK_SUCCESS)
 	{
@@ -231,6 +413,16 @@ vk_texture *vk_create_texture(uint32_t w, uint32_t h, const uint8_t *rgba_data)
 	return tex;
 }
 
+vk_texture *vk_create_texture(uint32_t w, uint32_t h, const uint8_t *rgba_data)
+{
+	return vk_create_texture_layers(w, h, 1, rgba_data);
+}
+
+vk_texture *vk_create_texture_array(uint32_t w, uint32_t h, uint32_t layers, const uint8_t *rgba_data)
+{
+	return vk_create_texture_layers(w, h, layers, rgba_data);
+}
+
 void vk_destroy_texture(vk_texture *tex)
 {
 	if (!tex)
@@ -248,6 +440,31 @@ void vk_destroy_texture(vk_texture *tex)
 	*tex = {};
 }
 
+void vk_retire_texture(vk_texture *tex)
+{
+	if (!tex)
+		return;
+	if (g_vk.bound_texture && g_vk.bound_texture == tex->descriptor_set)
+		g_vk.bound_texture = VK_NULL_HANDLE;
+	// The frame being recorded is submitted with the next serial
+	g_vk.retired_textures.push_back({tex, g_vk.submit_serial + 1});
+}
+
+void vk_collect_retired_textures(bool all)
+{
+	auto &retired = g_vk.retired_textures;
+	const auto completed = g_vk.completed_serial;
+	const auto keep = std::partition(retired.begin(), retired.end(), [all, completed](const vk_retired_texture &r) {
+		return !all && r.serial > completed;
+	});
+	for (auto i = keep; i != retired.end(); ++i)
+	{
+		vk_destroy_texture(i->tex);
+		delete i->tex;
+	}
+	retired.erase(keep, retired.end());
+}
+
 void vk_bind_texture(vk_texture *tex)
 {
 	if (!tex || !tex->valid)
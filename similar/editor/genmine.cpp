@@ -0,0 +1,214 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * Generate large mines for benchmarks
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <random>
+#include <span>
+#include <unordered_set>
+#include <vector>
+#include "inferno.h"
+#include "segment.h"
+#include "editor.h"
+#include "editor/esegment.h"
+#include "editor/medwall.h"
+#include "kdefs.h"
+#include "ai.h"
+#include "console.h"
+#include "d_levelstate.h"
+#include "gamesave.h"
+#include "gameseg.h"
+#include "gameseq.h"
+#include "object.h"
+#include "physfsx.h"
+#include "robot.h"
+#include "strutil.h"
+#include "textures.h"
+#include "wall.h"
+
+namespace dsx {
+
+namespace {
+
+/* The mine is grown from cubes of the default size, which stay aligned
+ * to a grid as they are attached.  A cube is only attached where its
+ * cell of the grid is free, so that no two cubes overlap.
+ */
+static uint64_t benchmark_mine_cell(const vms_vector &center)
+{
+	const auto axis = [](const fix f) {
+		const auto cell{std::lround(f2fl(f) / f2fl(DEFAULT_X_SIZE))};
+		return static_cast<uint64_t>(cell + (1 << 20)) & ((uint64_t{1} << 21) - 1);
+	};
+	return axis(center.x) << 42 | axis(center.y) << 21 | axis(center.z);
+}
+
+/* The first texture that casts light, for the lit segments */
+static std::optional<texture_index> benchmark_mine_light_texture()
+{
+	auto &TmapInfo = LevelUniqueTmapInfoState.TmapInfo;
+	for (unsigned t{0}; t != NumTextures; ++t)
+		if (TmapInfo[static_cast<texture_index>(t)].lighting > 0)
+			return static_cast<texture_index>(t);
+	return std::nullopt;
+}
+
+/* The robots that a level can hold any number of */
+static std::vector<uint8_t> benchmark_mine_robot_ids(const d_robot_info_array &Robot_info)
+{
+	std::vector<uint8_t> r;
+	for (unsigned i{0}; i != LevelSharedRobotInfoState.N_robot_types; ++i)
+	{
+		auto &ri = Robot_info[static_cast<robot_id>(i)];
+		if (ri.boss_flag == boss_robot_id::None && !robot_is_companion(ri) && !robot_is_thief(ri))
+			r.emplace_back(i);
+	}
+	return r;
+}
+
+static void benchmark_mine_write_mission(const char *const level_filename, const unsigned segments)
+{
+	std::array<char, PATH_MAX> mission_filename;
+	if (!change_filename_extension(mission_filename, level_filename,
+#if DXX_BUILD_DESCENT == 1
+		"MSN"
+#elif DXX_BUILD_DESCENT == 2
+		"MN2"
+#endif
+	))
+		return;
+	std::array<char, PATH_MAX> level_name;
+	if (!change_filename_extension(level_name, level_filename, DXX_LEVEL_FILE_EXTENSION))
+		return;
+	auto &&[file, physfserr] = PHYSFSX_openWriteBuffered(mission_filename.data());
+	if (!file)
+	{
+		con_printf(CON_URGENT, "genmine: failed to open \"%s\" for writing: %s", mission_filename.data(), PHYSFS_getErrorByCode(physfserr));
+		return;
+	}
+	PHYSFSX_printf(file, "name = Benchmark, %u segments\ntype = normal\nnum_levels = 1\n%s\n", segments, level_name.data());
+}
+
+}
+
+int generate_benchmark_mine(const benchmark_mine_parameters &p, const char *const filename)
+{
+	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
+	auto &Vertices = LevelSharedVertexState.get_vertices();
+	auto &vcvertptr = Vertices.vcptr;
+	auto &Walls = LevelUniqueWallSubsystemState.Walls;
+	auto &Robot_info = LevelSharedRobotInfoState.Robot_info;
+	create_new_mine();
+	SetPlayerFromCurseg();
+
+	std::minstd_rand rng{p.seed};
+	const auto chance = [&rng](const unsigned percent) {
+		return rng() % 100 < percent;
+	};
+	std::vector<segnum_t> grown{segment_first};
+	std::unordered_set<uint64_t> used{benchmark_mine_cell(compute_segment_center(vcvertptr, vcsegptr(segment_first)))};
+	std::array<sidenum_t, static_cast<std::size_t>(MAX_SIDES_PER_SEGMENT.value)> sides;
+	for (const auto s : MAX_SIDES_PER_SEGMENT)
+		sides[underlying_value(s)] = s;
+	const auto target{std::min<std::size_t>(p.segments, MAX_SEGMENTS - 1)};
+	/* Give up once this many tries in a row found no free cell */
+	unsigned stuck{0};
+	while (grown.size() < target && stuck < 1000)
+	{
+		/* A corridor grows from its newest segment; a branch from any */
+		const auto &&from{vmsegptridx(stuck || chance(p.branching) ? grown[rng() % grown.size()] : grown.back())};
+		std::ranges::shuffle(sides, rng);
+		const auto center{compute_segment_center(vcvertptr, from)};
+		const auto side{std::ranges::find_if(sides, [&](const sidenum_t s) {
+			if (IS_CHILD(from->children[s]))
+				return false;
+			const auto face{compute_center_point_on_side(vcvertptr, from, s)};
+			return !used.contains(benchmark_mine_cell(vm_vec_build_add(face, vm_vec_build_sub(face, center))));
+		})};
+		if (side == sides.end())
+		{
+			++stuck;
+			continue;
+		}
+		stuck = 0;
+		Cursegp = from;
+		if (med_attach_segment(from, vmsegptr(&New_segment), *side, sidenum_t::WFRONT))
+			break;
+		grown.emplace_back(Cursegp);
+		used.insert(benchmark_mine_cell(compute_segment_center(vcvertptr, Cursegp)));
+		if (chance(p.doors) && Walls.get_count() < MAX_WALLS - 2)
+		{
+			const auto added{Cursegp};
+			Cursegp = from;
+			Curside = *side;
+			wall_add_door();
+			Cursegp = added;
+		}
+	}
+
+	unsigned lit{0};
+	if (const auto light{benchmark_mine_light_texture()})
+	{
+		for (const auto s : grown)
+		{
+			if (!chance(p.lights))
+				continue;
+			const auto &&seg{vmsegptr(s)};
+			std::ranges::shuffle(sides, rng);
+			if (const auto side{std::ranges::find_if(sides, [&](const sidenum_t i) { return !IS_CHILD(seg->children[i]); })}; side != sides.end())
+			{
+				seg->unique_segment::sides[*side].tmap_num = build_texture1_value(*light);
+				++lit;
+			}
+		}
+		LightAmbientLighting();
+	}
+
+	unsigned robots{0};
+	if (const auto ids{benchmark_mine_robot_ids(Robot_info)}; !ids.empty())
+		/* Keep the player's segment clear, and leave half the objects for
+		 * the weapons and effects of the fight.
+		 */
+		for (const auto s : std::span(grown).subspan(1))
+		{
+			if (robots >= MAX_OBJECTS / 2)
+				break;
+			if (!chance(p.robots))
+				continue;
+			const auto &&seg{vmsegptridx(s)};
+			if (place_object(LevelUniqueObjectState, LevelSharedPolygonModelState, Robot_info, LevelSharedSegmentState, LevelUniqueSegmentState, seg, compute_segment_center(vcvertptr, seg), OBJ_ROBOT, ids[rng() % ids.size()]))
+				++robots;
+		}
+
+	Cursegp = imsegptridx(segment_first);
+	Curside = sidenum_t::WBACK;
+	{
+		const auto name{Current_level_name.next()};
+		std::snprintf(name.data(), name.size(), "Benchmark %zu", grown.size());
+	}
+	if (save_level(
+#if DXX_BUILD_DESCENT == 2
+		LevelSharedSegmentState.DestructibleLights,
+#endif
+		filename))
+	{
+		con_printf(CON_URGENT, "genmine: failed to save \"%s\"", filename);
+		return 1;
+	}
+	benchmark_mine_write_mission(filename, grown.size());
+	con_printf(CON_NORMAL, "genmine: saved \"%s\": %zu segments, %u walls, %u lights, %u robots", filename, grown.size(), static_cast<unsigned>(Walls.get_count()), lit, robots);
+	return 0;
+}
+
+}
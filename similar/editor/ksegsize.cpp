@@ -23,6 +23,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  *
  */
 
+#include <algorithm>
 #include <stdlib.h>
 #include "editor.h"
 #include "editor/esegment.h"
@@ -98,29 +99,24 @@ static void validate_modified_segments(void)
 {
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Vertices = LevelSharedVertexState.get_vertices();
-	visited_segment_bitarray_t modified_segments;
 	auto &vcvertptr = Vertices.vcptr;
-	for (int v=0; v<Modified_vertex_index; v++) {
-		const auto v0 = Modified_vertices[v];
+	//	Mark the moved vertices, so that one pass over the segments finds every
+	//	segment using any of them.
+	per_vertex_array<uint8_t> modified_vertices{};
+	for (int v=0; v<Modified_vertex_index; v++)
+		modified_vertices[Modified_vertices[v]] = 1;
 
-		range_for (const auto &&segp, vmsegptridx)
+	range_for (const auto &&segp, vmsegptridx)
+	{
+		if (segp->segnum != segment_none)
 		{
-			if (segp->segnum != segment_none)
+			if (std::ranges::none_of(segp->verts, [&modified_vertices](const vertnum_t w) { return modified_vertices[w]; }))
+				continue;
+			validate_segment(vcvertptr, segp);
+			for (const auto s : MAX_SIDES_PER_SEGMENT)
 			{
-				if (modified_segments[segp])
-					continue;
-				range_for (const auto w, segp->verts)
-					if (w == v0)
-					{
-						modified_segments[segp] = true;
-						validate_segment(vcvertptr, segp);
-						for (const auto s : MAX_SIDES_PER_SEGMENT)
-						{
-							Num_tilings = 1;
-							assign_default_uvs_to_side(segp, s);
-						}
-						break;
-					}
+				Num_tilings = 1;
+				assign_default_uvs_to_side(segp, s);
 			}
 		}
 	}
@@ -181,6 +181,13 @@ void editor_status( const char *text)
 	strcpy(status_line.data(), text);
 }
 
+void editor_status_progress(const char *const text, const std::size_t done, const std::size_t total)
+{
+	editor_status_fmt("%s... %u%%", text, static_cast<unsigned>(total ? done * 100 / total : 100));
+	print_status_bar(status_line);
+	gr_flip();
+}
+
 // 	int  tm_sec;	/* seconds after the minute -- [0,61] */
 // 	int  tm_min;	/* minutes after the hour	-- [0,59] */
 // 	int  tm_hour;	/* hours after midnight	-- [0,23] */
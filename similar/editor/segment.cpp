@@ -27,7 +27,9 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <algorithm>
 #include <ranges>
+#include <vector>
 #include "gr.h"
 #include "inferno.h"
 #include "segment.h"
@@ -581,30 +583,36 @@ static void compress_segments(void)
 //	Combine duplicate vertices.
 //	If two vertices have the same coordinates, within some small tolerance, then assign
 //	the same vertex number to the two vertices, freeing up one of the vertices.
+//	Only vertices near in x can be near, so the pairs are found by sweeping the
+//	vertices in order of x, rather than by testing every pair.  The pairs are then
+//	combined in the order that testing every pair would have combined them.
 void med_combine_duplicate_vertices(per_vertex_array<uint8_t> &vlp)
 {
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Vertices = LevelSharedVertexState.get_vertices();
-	auto &vcvertptridx = Vertices.vcptridx;
-	const std::ranges::subrange range{vcvertptridx};
-	// Note: ok to do to <, rather than <= because w for loop starts at v+1
-	if (range.empty())
-		return;
-	for (auto i = range.begin();;)
+	auto &vcvertptr = Vertices.vcptr;
+	std::vector<vertnum_t> candidates;
+	range_for (const auto &&v, Vertices.vcptridx)
+		if (vlp[v])	//	used to be Vertex_active[v]
+			candidates.emplace_back(v);
+	const auto x_of = [&vcvertptr](const vertnum_t v) { return vcvertptr(v)->x; };
+	std::ranges::sort(candidates, {}, x_of);
+	std::vector<std::pair<vertnum_t, vertnum_t>> near_pairs;
+	for (auto i = candidates.begin(); i != candidates.end(); ++i)
 	{
-		const auto &&v = *i;
-		if (++i == range.end())
-			return;
-		if (vlp[v]) {
-			auto &vvp = *v;
-			for (auto &&w : std::ranges::subrange(i, range.end()))
-				if (vlp[w]) {	//	used to be Vertex_active[w]
-					if (vnear(vvp, *w)) {
-						change_vertex_occurrences(vmsegptr, v, w);
-					}
-				}
+		const vms_vector &vvp = *vcvertptr(*i);
+		for (auto j = std::next(i); j != candidates.end(); ++j)
+		{
+			const vms_vector &wvp = *vcvertptr(*j);
+			if (static_cast<int64_t>(wvp.x) - vvp.x > FIX_EPSILON)
+				break;
+			if (vnear(vvp, wvp))
+				near_pairs.emplace_back(std::min(*i, *j), std::max(*i, *j));
 		}
 	}
+	std::ranges::sort(near_pairs);
+	for (const auto &[v, w] : near_pairs)
+		change_vertex_occurrences(vmsegptr, v, w);
 }
 
 // ------------------------------------------------------------------------------
@@ -1481,14 +1489,42 @@ static int check_seg_concavity(const shared_segment &s)
 
 // -----------------------------------------------------------------------------
 //	Find all concave segments and add to list
+//	The result for each segment is kept with a digest of its vertices, so that after
+//	an edit only the segments whose vertices moved or changed are checked again.
 void find_concave_segs()
 {
 	Warning_segs.clear();
 
+	struct concavity
+	{
+		uint64_t digest;
+		bool checked, concave;
+	};
+	static std::vector<concavity> Segment_concavity;
+	Segment_concavity.resize(MAX_SEGMENTS);
+	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
+	auto &vcvertptr = LevelSharedVertexState.get_vertices().vcptr;
 	range_for (const auto &&s, vcsegptridx)
 		if (s->segnum != segment_none)
-			if (check_seg_concavity(s))
+		{
+			uint64_t digest{0xcbf29ce484222325};
+			const auto mix = [&digest](const uint32_t w) {
+				digest = (digest ^ w) * 0x100000001b3;
+			};
+			for (const auto v : s->verts)
+			{
+				const vms_vector &p = *vcvertptr(v);
+				mix(static_cast<uint32_t>(v));
+				mix(p.x);
+				mix(p.y);
+				mix(p.z);
+			}
+			auto &c = Segment_concavity[s.get_unchecked_index()];
+			if (!c.checked || c.digest != digest)
+				c = {digest, true, static_cast<bool>(check_seg_concavity(s))};
+			if (c.concave)
 				Warning_segs.emplace_back(s);
+		}
 }
 
 
@@ -28,6 +28,9 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <stdarg.h>
 #include <math.h>
 #include <string.h>
+#include <algorithm>
+#include <span>
+#include <vector>
 #include "inferno.h"
 #include "segment.h"
 #include "editor/editor.h"
@@ -41,6 +44,7 @@ COPYRIGHT 1993-1998 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "fvi.h"
 #include "render.h"
 #include "seguvs.h"
+#include "parallel.h"
 
 #include "compiler-range_for.h"
 #include "d_enumerate.h"
@@ -904,10 +908,25 @@ struct hash_info {
 #define	FVI_HASH_SIZE 8
 #define	FVI_HASH_AND_MASK (FVI_HASH_SIZE - 1)
 
-//	Note: This should be malloced.
-//			Also, the vector should not be 12 bytes, you should only care about some smaller portion of it.
-static std::array<hash_info, FVI_HASH_SIZE> fvi_cache;
-static int Hash_hits=0, Hash_retries=0, Hash_calcs=0;
+//	Light one light source adds to a vertex of a side.
+struct side_vertex_light {
+	segnum_t segnum;
+	sidenum_t sidenum;
+	side_relative_vertnum vertnum;
+	fix light;
+};
+
+//	Light one light source adds to the center of a segment.
+struct segment_center_light {
+	segnum_t segnum;
+	fix light;
+};
+
+//	Everything one light source adds, in the order the serial cast added it.
+struct light_source_result {
+	std::vector<side_vertex_light> sides;
+	std::vector<segment_center_light> centers;
+};
 
 //	-----------------------------------------------------------------------------------------
 //	Set light from a light source.
@@ -925,7 +944,9 @@ static int Hash_hits=0, Hash_retries=0, Hash_calcs=0;
 //	light surface itself, light will be properly cast on the light surface.  Otherwise, the
 //	vector V would be the null vector.
 //	If quick_light set, then don't use find_vector_intersection
-static void cast_light_from_side(const vmsegptridx_t segp, const sidenum_t light_side, fix light_intensity, int quick_light)
+//	The light is recorded in result, rather than added to the mine, so that
+//	lights can be cast side by side.
+static void cast_light_from_side(const vcsegptridx_t segp, const sidenum_t light_side, fix light_intensity, int quick_light, std::vector<side_vertex_light> &result)
 {
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Vertices = LevelSharedVertexState.get_vertices();
@@ -933,6 +954,7 @@ static void cast_light_from_side(const vmsegptridx_t segp, const sidenum_t light
 	auto &Walls = LevelUniqueWallSubsystemState.Walls;
 	auto &vcwallptr = Walls.vcptr;
 	const auto segment_center{compute_segment_center(vcvertptr, segp)};
+	std::array<hash_info, FVI_HASH_SIZE> fvi_cache;
 	//	Do for four lights, one just inside each corner of side containing light.
 	range_for (const auto lightnum, Side_to_verts[light_side])
 	{
@@ -951,8 +973,9 @@ static void cast_light_from_side(const vmsegptridx_t segp, const sidenum_t light
 // -- Old way, before 5/8/95 --		inverse_segment_magnitude = fixdiv(F1_0/5, vm_vec_mag(&vector_to_center));
 // -- Old way, before 5/8/95 --		vm_vec_scale_add(&light_location, &light_location, &vector_to_center, inverse_segment_magnitude);
 
-		for (auto &rseg : vmsegptr)
+		for (const auto &&rsegp : vcsegptridx)
 		{
+			auto &rseg = *rsegp;
 			fix			dist_to_rseg;
 
 			range_for (auto &i, fvi_cache)
@@ -963,7 +986,7 @@ static void cast_light_from_side(const vmsegptridx_t segp, const sidenum_t light
 			dist_to_rseg = vm_vec_dist_quick(r_segment_center, segment_center);
 
 			if (dist_to_rseg <= LIGHT_DISTANCE_THRESHOLD) {
-				for (const auto &&[sidenum, srside, urside] : enumerate(zip(rseg.shared_segment::sides, rseg.unique_segment::sides)))
+				for (const auto &&[sidenum, srside] : enumerate(rseg.shared_segment::sides))
 				{
 					if (WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, rseg, static_cast<sidenum_t>(sidenum)) != wall_is_doorway_result::no_wall)
 					{
@@ -1005,16 +1028,13 @@ static void cast_light_from_side(const vmsegptridx_t segp, const sidenum_t light
 												if (hashp->vector == vector_to_light)
 												{
 													hit_type = hashp->hit_type;
-													Hash_hits++;
 													break;
 												} else {
 													Int3();	// How is this possible?  Should be no hits!
-													Hash_retries++;
 													hash_value = (hash_value+1) & FVI_HASH_AND_MASK;
 													hashp = &fvi_cache[hash_value];
 												}
 											} else {
-												Hash_calcs++;
 												hashp->vector = vector_to_light;
 												hashp->flag = 1;
 
@@ -1035,10 +1055,7 @@ static void cast_light_from_side(const vmsegptridx_t segp, const sidenum_t light
 										hit_type = fvi_hit_type::None;
 									switch (hit_type) {
 										case fvi_hit_type::None:
-											light_at_point = fixmul(light_at_point, light_intensity);
-											urside.uvls[vertnum].l += light_at_point;
-											if (urside.uvls[vertnum].l > F1_0)
-												urside.uvls[vertnum].l = F1_0;
+											result.push_back({rsegp, static_cast<sidenum_t>(sidenum), vertnum, fixmul(light_at_point, light_intensity)});
 											break;
 										case fvi_hit_type::Wall:
 											break;
@@ -1080,8 +1097,8 @@ static void calim_zero_light_values(void)
 
 //	------------------------------------------------------------------------------------------
 //	Used in setting average light value in a segment, cast light from a side to the center
-//	of all segments.
-static void cast_light_from_side_to_center(const vmsegptridx_t segp, const sidenum_t light_side, fix light_intensity, int quick_light)
+//	of all segments.  As cast_light_from_side, the light is recorded in result.
+static void cast_light_from_side_to_center(const vcsegptridx_t segp, const sidenum_t light_side, fix light_intensity, int quick_light, std::vector<segment_center_light> &result)
 {
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Vertices = LevelSharedVertexState.get_vertices();
@@ -1094,7 +1111,7 @@ static void cast_light_from_side_to_center(const vmsegptridx_t segp, const siden
 		auto &vert_light_location = *vcvertptr(light_vertex_num);
 		const auto light_location{vm_vec_scale_add(vert_light_location, /* vector_to_center = */ vm_vec_build_sub(segment_center, vert_light_location), F1_0 / 64)};
 
-		for (const csmusegment rsegp : vmsegptr)
+		for (const auto &&rsegp : vcsegptridx)
 		{
 			fix			dist_to_rseg;
 //if ((segp == &Segments[Bugseg]) && (rsegp == &Segments[Bugseg]))
@@ -1133,12 +1150,7 @@ static void cast_light_from_side_to_center(const vmsegptridx_t segp, const siden
 							light_at_point = fixmul(light_at_point, light_intensity);
 							if (light_at_point >= F1_0)
 								light_at_point = F1_0-1;
-							{
-								auto &static_light = rsegp.u.static_light;
-								static_light += light_at_point;
-								if (static_light < 0)	// if it went negative, saturate
-									static_light = 0;
-							}
+							result.push_back({rsegp, light_at_point});
 							break;
 						case fvi_hit_type::Wall:
 							break;
@@ -1160,11 +1172,22 @@ static void cast_light_from_side_to_center(const vmsegptridx_t segp, const siden
 
 //	------------------------------------------------------------------------------------------
 //	Process all lights.
+//	The lights are cast side by side, in batches, each into its own result.
+//	The results are then added to the mine in the order of the lights, so the
+//	saturation at F1_0 and at 0 happens exactly as if the lights had been cast
+//	one after another, and the lighting does not depend on the thread count.
 static void calim_process_all_lights(int quick_light)
 {
 	auto &TmapInfo = LevelUniqueTmapInfoState.TmapInfo;
 	auto &Walls = LevelUniqueWallSubsystemState.Walls;
 	auto &vcwallptr = Walls.vcptr;
+	struct light_source
+	{
+		segnum_t segnum;
+		sidenum_t sidenum;
+		fix intensity;
+	};
+	std::vector<light_source> lights;
 	range_for (const auto &&segp, vmsegptridx)
 	{
 		for (const auto &&[sidenum, value] : enumerate(segp->unique_segment::sides))
@@ -1187,12 +1210,47 @@ static void calim_process_all_lights(int quick_light)
 
 				if (light_intensity) {
 					light_intensity /= 4;			// casting light from four spots, so divide by 4.
-					cast_light_from_side(segp, static_cast<sidenum_t>(sidenum), light_intensity, quick_light);
-					cast_light_from_side_to_center(segp, static_cast<sidenum_t>(sidenum), light_intensity, quick_light);
+					lights.push_back({segp, static_cast<sidenum_t>(sidenum), light_intensity});
 				}
 			}
 		}
 	}
+
+	//	Enough lights per batch to keep every thread busy, few enough to
+	//	show progress and to bound the memory held by the results.
+	const std::size_t batch_size = parallel_for_threads() * 8;
+	std::vector<light_source_result> results(std::min(batch_size, lights.size()));
+	for (std::size_t first = 0; first < lights.size(); first += batch_size)
+	{
+		const std::size_t count = std::min(batch_size, lights.size() - first);
+		parallel_for(count, [&](const std::size_t i) {
+			auto &l = lights[first + i];
+			auto &r = results[i];
+			r.sides.clear();
+			r.centers.clear();
+			const auto &&segp = vcsegptridx(l.segnum);
+			cast_light_from_side(segp, l.sidenum, l.intensity, quick_light, r.sides);
+			cast_light_from_side_to_center(segp, l.sidenum, l.intensity, quick_light, r.centers);
+		});
+		for (auto &r : std::span(results).first(count))
+		{
+			for (auto &sl : r.sides)
+			{
+				auto &l = vmsegptr(sl.segnum)->unique_segment::sides[sl.sidenum].uvls[sl.vertnum].l;
+				l += sl.light;
+				if (l > F1_0)
+					l = F1_0;
+			}
+			for (auto &cl : r.centers)
+			{
+				auto &static_light = vmsegptr(cl.segnum)->unique_segment::static_light;
+				static_light += cl.light;
+				if (static_light < 0)	// if it went negative, saturate
+					static_light = 0;
+			}
+		}
+		editor_status_progress("Casting light", first + count, lights.size());
+	}
 }
 
 //	------------------------------------------------------------------------------------------
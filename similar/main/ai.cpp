@@ -24,10 +24,14 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  */
 
 #include <algorithm>
+#include <bitset>
+#include <chrono>
 #include <cstdlib>
 #include <stdio.h>
 #include <time.h>
 #include <optional>
+#include <span>
+#include <vector>
 
 #include "inferno.h"
 #include "game.h"
@@ -65,6 +69,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "fuelcen.h"
 #include "controls.h"
 #include "kconfig.h"
+#include "parallel.h"
 
 #if DXX_USE_EDITOR
 #include "editor/editor.h"
@@ -191,7 +196,6 @@ constexpr std::integral_constant<int, F1_0> Robot_sound_volume{};
 constexpr fix ANIM_RATE{F1_0 / 16};
 constexpr int DELTA_ANG_SCALE{16};
 constexpr int OVERALL_AGITATION_MAX{100};
-constexpr std::size_t MAX_AI_CLOAK_INFO{8};		//	Must be a power of 2!
 
 enum {
 	Flinch_scale = 4,
@@ -363,22 +367,29 @@ static bool silly_animation_angle(fixang vms_angvec::*const a, const vms_angvec
 	return true;
 }
 
-static void frame_animation_angle(fixang vms_angvec::*const a, const fix frametime, const vms_angvec &deltaang, const vms_angvec &goalang, vms_angvec &curang)
+/* Move every angle of joints [1, n) toward its goal.  The angles are
+ * stepped alike, without branches, so that the loop can be vectorized.
+ * The distance to the goal is only used by its magnitude, so taking it
+ * modulo 2^16 finds the shorter way round, and an angle already at its
+ * goal is set to the goal again.
+ */
+static void frame_animation_joints(const fix frametime, const unsigned n, const std::span<const vms_angvec> deltaang, const std::span<const vms_angvec> goalang, const std::span<vms_angvec> curang)
 {
-	fix delta_to_goal = goalang.*a - curang.*a;
-	if (delta_to_goal > 32767)
-		delta_to_goal = delta_to_goal - 65536;
-	else if (delta_to_goal < -32767)
-		delta_to_goal = 65536 + delta_to_goal;
-	if (delta_to_goal)
+	for (unsigned joint{1}; joint < n; ++joint)
 	{
-		// Due to deltaang.*a being usually small values and frametime getting smaller with higher FPS, the usual use of fixmul will have scaled_delta_angle result in 0 way too often and long, making the robot animation run circles around itself. So multiply deltaang by DELTA_ANG_SCALE when passed to fixmul.
-		const fix scaled_delta_angle = fixmul(deltaang.*a * DELTA_ANG_SCALE, frametime); // fixmul(deltaang.*a, frametime) * DELTA_ANG_SCALE;
-		auto &ca = curang.*a;
-		if (abs(delta_to_goal) < abs(scaled_delta_angle))
-			ca = goalang.*a;
-		else
-			ca += scaled_delta_angle;
+		const auto &delta{deltaang[joint]};
+		const auto &goal{goalang[joint]};
+		auto &cur{curang[joint]};
+		const std::array<fixang, 3> d{delta.p, delta.b, delta.h}, g{goal.p, goal.b, goal.h};
+		std::array<fixang, 3> c{cur.p, cur.b, cur.h};
+		for (unsigned i{0}; i != 3; ++i)
+		{
+			const int delta_to_goal{static_cast<int16_t>(g[i] - c[i])};
+			// Due to the delta angles being usually small values and frametime getting smaller with higher FPS, the usual use of fixmul will have scaled_delta_angle result in 0 way too often and long, making the robot animation run circles around itself. So multiply the delta by DELTA_ANG_SCALE when passed to fixmul.
+			const fix scaled_delta_angle{fixmul(d[i] * DELTA_ANG_SCALE, frametime)};
+			c[i] = (abs(delta_to_goal) < abs(scaled_delta_angle)) ? g[i] : static_cast<fixang>(c[i] + scaled_delta_angle);
+		}
+		cur = {c[0], c[1], c[2]};
 	}
 }
 
@@ -686,6 +697,7 @@ void init_ai_objects(const d_robot_info_array &Robot_info)
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &vmobjptridx = Objects.vmptridx;
 	Point_segs_free_ptr = Point_segs.begin();
+	ai_path_garbage_collect_abandon();
 	Boss_gate_segs.clear();
 	Boss_teleport_segs.clear();
 
@@ -818,6 +830,108 @@ static void ai_turn_randomly(const vms_vector &vec_to_player, object_base &obj,
 //		Decreases wait between fire times by Overall_agitation/64 seconds.
 
 
+namespace {
+
+//	Most robots which looked for the player last frame look again this
+//	frame, from where they stand toward where the player stands.  The
+//	perception pass casts those vectors on the worker threads before the
+//	serial AI runs.  player_is_visible_from_object takes a saved result
+//	only when the vector it would cast is exactly the one that was cast
+//	and no wall has changed since, so the AI sees the same result it
+//	would have computed itself.
+struct ai_perception_cast
+{
+	vms_vector pos, target, hit_pnt;
+	segnum_t startseg;
+	object_signature_t signature;
+	fvi_hit_type hit_type;
+	unsigned frame, wall_change_count;
+};
+
+//	Below this many casts, waking the worker threads costs more than it
+//	saves.
+constexpr std::size_t ai_perception_parallel_threshold = 16;
+
+static unsigned Ai_perception_frame;
+static std::bitset<MAX_OBJECTS> Ai_perception_wanted;
+static std::array<ai_perception_cast, MAX_OBJECTS> Ai_perception_casts;
+static std::vector<objnum_t> Ai_perception_objects;
+
+static fvi_hit_type ai_perception_find_vector_intersection(const vcobjptridx_t objp, const vms_vector &pos, const vms_vector &target, const segnum_t startseg, fvi_info &hit_data)
+{
+	return find_vector_intersection(fvi_query{
+		pos,
+		target,
+		fvi_query::unused_ignore_obj_list,
+		fvi_query::unused_LevelUniqueObjectState,
+		fvi_query::unused_Robot_info,
+		FQ_TRANSWALL, // -- Why were we checking objects? | FQ_CHECK_OBJS;		//what about trans walls???
+		objp,
+	}, startseg, F1_0 / 4, hit_data);
+}
+
+static const ai_perception_cast *ai_perception_find(const object_base &obj, const objnum_t objnum, const vms_vector &pos, const segnum_t startseg)
+{
+	auto &c = Ai_perception_casts[objnum];
+	if (c.frame != Ai_perception_frame ||
+		c.signature != obj.signature ||
+		c.wall_change_count != LevelUniqueWallSubsystemState.change_count ||
+		c.startseg != startseg ||
+		c.pos != pos ||
+		c.target != Believed_player_pos)
+		return nullptr;
+	return &c;
+}
+
+}
+
+//	Cast, for every object which looked for the player on the previous
+//	frame, the vector it will most likely cast this frame.  Call once
+//	per frame, after the player has moved and before any robot thinks.
+void ai_perception_prepass()
+{
+	auto &Objects = LevelUniqueObjectState.Objects;
+	auto &vcobjptridx = Objects.vcptridx;
+	++Ai_perception_frame;
+	auto &objects = Ai_perception_objects;
+	objects.clear();
+	if (Ai_perception_wanted.none())
+		return;
+	const auto highest{Objects.get_count()};
+	for (std::size_t i = 0; i < highest; ++i)
+		if (Ai_perception_wanted[i])
+		{
+			const objnum_t objnum{static_cast<objnum_t>(i)};
+			const auto &obj = *vcobjptridx(objnum);
+			if (obj.type != OBJ_NONE && !(obj.flags & OF_SHOULD_BE_DEAD))
+				objects.emplace_back(objnum);
+		}
+	Ai_perception_wanted.reset();
+	if (objects.size() < ai_perception_parallel_threshold)
+		return;
+	const auto target{ConsoleObject->pos};
+	const auto frame{Ai_perception_frame};
+	const auto wall_change_count{LevelUniqueWallSubsystemState.change_count};
+	/* Without FQ_CHECK_OBJS, find_vector_intersection only reads the
+	 * level, so the casts can run side by side.  Each writes only its
+	 * own entry.
+	 */
+	parallel_for(objects.size(), [&](const std::size_t i) {
+		const auto &&objp = vcobjptridx(objects[i]);
+		auto &obj = *objp;
+		auto &c = Ai_perception_casts[objects[i]];
+		fvi_info hit_data;
+		c.hit_type = ai_perception_find_vector_intersection(objp, obj.pos, target, obj.segnum, hit_data);
+		c.hit_pnt = hit_data.hit_pnt;
+		c.pos = obj.pos;
+		c.target = target;
+		c.startseg = obj.segnum;
+		c.signature = obj.signature;
+		c.wall_change_count = wall_change_count;
+		c.frame = frame;
+	});
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 //	Returns:
 //		0		Player is not visible from object, obstruction or something.
@@ -858,17 +972,19 @@ player_visibility_state player_is_visible_from_object(const d_robot_info_array &
 		}
 	} else
 		startseg			= obj.segnum;
-	fvi_info Hit_data;
-	const auto Hit_type = find_vector_intersection(fvi_query{
-		pos,
-		Believed_player_pos,
-		fvi_query::unused_ignore_obj_list,
-		fvi_query::unused_LevelUniqueObjectState,
-		fvi_query::unused_Robot_info,
-		FQ_TRANSWALL, // -- Why were we checking objects? | FQ_CHECK_OBJS;		//what about trans walls???
-		objp,
-	}, startseg, F1_0 / 4, Hit_data);
-	Hit_pos = Hit_data.hit_pnt;
+	Ai_perception_wanted.set(objp.get_unchecked_index());
+	fvi_hit_type Hit_type;
+	if (const auto c{ai_perception_find(obj, objp, pos, startseg)})
+	{
+		Hit_type = c->hit_type;
+		Hit_pos = c->hit_pnt;
+	}
+	else
+	{
+		fvi_info Hit_data;
+		Hit_type = ai_perception_find_vector_intersection(objp, pos, Believed_player_pos, startseg, Hit_data);
+		Hit_pos = Hit_data.hit_pnt;
+	}
 
 	if (Hit_type == fvi_hit_type::None)
 	{
@@ -915,6 +1031,7 @@ static int do_silly_animation(const d_robot_info_array &Robot_info, object &objp
 
 	at_goal = 1;
 	auto &Polygon_models = LevelSharedPolygonModelState.Polygon_models;
+	const unsigned n_models{Polygon_models[pobj_info->model_num].n_models};
 	for (const uint8_t gun_num_idx : xrange(1u + num_guns))
 	{
 		const auto gun_num = robot_gun_number{gun_num_idx};
@@ -925,7 +1042,7 @@ static int do_silly_animation(const d_robot_info_array &Robot_info, object &objp
 			auto &jp = jr.angles;
 			vms_angvec	*pobjp = &pobj_info->anim_angles[jointnum];
 
-			if (jointnum >= Polygon_models[objp.rtype.pobj_info.model_num].n_models) {
+			if (jointnum >= n_models) {
 				Int3();		// Contact Mike: incompatible data, illegal jointnum, problem in pof file?
 				continue;
 			}
@@ -966,21 +1083,11 @@ static int do_silly_animation(const d_robot_info_array &Robot_info, object &objp
 //	Delta orientation of object is at:		ai_info.delta_angles
 static void ai_frame_animation(object &objp)
 {
-	int	joint;
 	auto &pobj_info = objp.rtype.pobj_info;
 	auto &Polygon_models = LevelSharedPolygonModelState.Polygon_models;
 	const auto num_joints = Polygon_models[pobj_info.model_num].n_models;
 	const auto &ail = objp.ctype.ai_info.ail;
-	for (joint=1; joint<num_joints; joint++) {
-		auto &curang = pobj_info.anim_angles[joint];
-		auto &goalang = ail.goal_angles[joint];
-		auto &deltaang = ail.delta_angles[joint];
-
-		const fix frametime = FrameTime;
-		frame_animation_angle(&vms_angvec::p, frametime, deltaang, goalang, curang);
-		frame_animation_angle(&vms_angvec::b, frametime, deltaang, goalang, curang);
-		frame_animation_angle(&vms_angvec::h, frametime, deltaang, goalang, curang);
-	}
+	frame_animation_joints(FrameTime, num_joints, ail.delta_angles, ail.goal_angles, pobj_info.anim_angles);
 }
 
 // ----------------------------------------------------------------------------------
@@ -2321,7 +2428,6 @@ static void init_boss_segments(const segment_array &segments, const object &boss
 {
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Vertices = LevelSharedVertexState.get_vertices();
-	constexpr unsigned QUEUE_SIZE = 256;
 	auto &vcsegptridx = segments.vcptridx;
 	auto &vmsegptr = segments.vmptr;
 #if DXX_BUILD_DESCENT == 1
@@ -2336,73 +2442,79 @@ static void init_boss_segments(const segment_array &segments, const object &boss
 	auto &Walls = LevelUniqueWallSubsystemState.Walls;
 	auto &vcwallptr = Walls.vcptr;
 	{
-		int			head, tail;
-		std::array<segnum_t, QUEUE_SIZE> seg_queue;
-
 		const auto original_boss_seg = boss_objp.segnum;
-		head = 0;
-		tail = 0;
-		seg_queue[head++] = original_boss_seg;
 		auto &vcvertptr = Vertices.vcptr;
 
-		if (!size_check || !boss_intersects_wall(vcvertptr, boss_objp, vcsegptridx(original_boss_seg)))
-		{
-			a.emplace_back(original_boss_seg);
-#if DXX_USE_EDITOR
-			Selected_segs.emplace_back(original_boss_seg);
-#endif
-		}
+		//	The segments the search has reached, in the order it reached
+		//	them.  This is also the search queue: segments before tail have
+		//	been expanded.  Whether the boss fits does not steer the
+		//	search, so the search can run ahead of the fit tests.
+		std::vector<segnum_t> seg_queue;
+		std::size_t tail = 0;
+		seg_queue.emplace_back(original_boss_seg);
 
 		visited_segment_bitarray_t visited;
 
-		while (tail != head) {
-			const cscusegment segp = *vmsegptr(seg_queue[tail++]);
-
-			tail &= QUEUE_SIZE-1;
-
-			for (const auto &&[sidenum, csegnum] : enumerate(segp.s.children))
+		const auto search_until = [&](const std::size_t want) {
+			while (tail != seg_queue.size() && seg_queue.size() < want)
 			{
-				const auto w = WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, segp, static_cast<sidenum_t>(sidenum));
-				if ((w & WALL_IS_DOORWAY_FLAG::fly) || one_wall_hack)
+				const cscusegment segp = *vmsegptr(seg_queue[tail++]);
+
+				for (const auto &&[sidenum, csegnum] : enumerate(segp.s.children))
 				{
+					const auto w = WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, segp, static_cast<sidenum_t>(sidenum));
+					if ((w & WALL_IS_DOORWAY_FLAG::fly) || one_wall_hack)
+					{
 #if DXX_BUILD_DESCENT == 2
-					//	If we get here and w == wall_is_doorway_result::wall, then we want to process through this wall, else not.
-					if (IS_CHILD(csegnum)) {
-						if (one_wall_hack)
-							one_wall_hack--;
-					} else
-						continue;
+						//	If we get here and w == wall_is_doorway_result::wall, then we want to process through this wall, else not.
+						if (IS_CHILD(csegnum)) {
+							if (one_wall_hack)
+								one_wall_hack--;
+						} else
+							continue;
 #endif
 
-					if (auto &&v = visited[csegnum])
-					{
-					}
-					else
-					{
-						v = true;
-						seg_queue[head++] = csegnum;
-						head &= QUEUE_SIZE-1;
-						if (head > tail) {
-							if (head == tail + QUEUE_SIZE-1)
-								Int3();	//	queue overflow.  Make it bigger!
-						} else
-							if (head+QUEUE_SIZE == tail + QUEUE_SIZE-1)
-								Int3();	//	queue overflow.  Make it bigger!
-	
-						if (!size_check || !boss_intersects_wall(vcvertptr, boss_objp, vcsegptridx(csegnum))) {
-							a.emplace_back(csegnum);
-#if DXX_USE_EDITOR
-							Selected_segs.emplace_back(csegnum);
-							#endif
-							if (a.size() >= a.max_size())
-							{
-								tail = head;
-								break;
-							}
+						if (auto &&v = visited[csegnum])
+						{
+						}
+						else
+						{
+							v = true;
+							seg_queue.emplace_back(csegnum);
 						}
 					}
 				}
 			}
+		};
+
+		//	Each fit test tries the boss's sphere at up to nine places in
+		//	the segment and only reads the level, so a block of them runs
+		//	on the worker threads.  Blocks are taken in search order, and
+		//	the list stops filling at the same segment a serial pass would.
+		constexpr std::size_t fit_block = 64;
+		std::array<uint8_t, fit_block> fits;
+		for (std::size_t first = 0; a.size() < a.max_size(); first += fit_block)
+		{
+			search_until(first + fit_block);
+			if (first >= seg_queue.size())
+				break;
+			const auto count{std::min(fit_block, seg_queue.size() - first)};
+			if (size_check)
+				parallel_for(count, [&](const std::size_t i) {
+					fits[i] = !boss_intersects_wall(vcvertptr, boss_objp, vcsegptridx(seg_queue[first + i]));
+				});
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (size_check && !fits[i])
+					continue;
+				const auto segnum{seg_queue[first + i]};
+				a.emplace_back(segnum);
+#if DXX_USE_EDITOR
+				Selected_segs.emplace_back(segnum);
+#endif
+				if (a.size() >= a.max_size())
+					break;
+			}
 		}
 		// Last resort - add original seg even if boss doesn't fit in it
 		if (a.empty())
@@ -3271,6 +3383,94 @@ static bool skip_ai_for_time_splice(const vcobjptridx_t robot, const robot_info
 	return false;
 }
 
+/* With -aibudget, a robot which is far from the player and could not see
+ * the player when it last looked thinks only once every Ai_lod.divisor
+ * frames, in a phase set by its object number.  It banks the frame time
+ * of the frames it skips and thinks with all of it, so its timers and
+ * turns keep pace.  The divisor doubles when the AI of a frame takes
+ * longer than the budget and halves when it takes less than half of it.
+ * Robots near the player always think every frame.
+ */
+struct ai_lod_scheduler
+{
+	static constexpr unsigned max_divisor{16};
+	unsigned divisor{1};
+	unsigned frame{0};
+	std::chrono::steady_clock::duration spent{};
+	std::array<fix, MAX_OBJECTS> banked{};
+	std::array<object_signature_t, MAX_OBJECTS> banked_signature{};
+	void end_frame(unsigned budget_ms);
+};
+
+ai_lod_scheduler Ai_lod;
+
+void ai_lod_scheduler::end_frame(const unsigned budget_ms)
+{
+	const std::chrono::steady_clock::duration budget{std::chrono::milliseconds(budget_ms)};
+	if (spent > budget)
+		divisor = std::min(divisor * 2, max_divisor);
+	else if (spent < budget / 2 && divisor > 1)
+		divisor /= 2;
+	spent = {};
+	++frame;
+}
+
+static bool ai_lod_may_defer(const object &robot, const robot_info &robptr)
+{
+	if (+(Game_mode & GM_MULTI))
+		return false;
+	if (robot_is_companion(robptr) || robot_is_thief(robptr) || robptr.boss_flag != boss_robot_id::None)
+		return false;
+	const auto &ailp = robot.ctype.ai_info.ail;
+	if (static_cast<uint8_t>(ailp.player_awareness_type) >= static_cast<uint8_t>(player_awareness_type_t::PA_WEAPON_ROBOT_COLLISION) - 1)
+		return false;
+	if (player_is_visible(ailp.previous_visibility))
+		return false;
+	return vm_vec_dist_quick(robot.pos, ConsoleObject->pos) > F1_0 * 100;
+}
+
+/* Returns true if the robot should skip this frame, after banking the
+ * frame time.  Otherwise returns the frame time to think with.
+ */
+static std::optional<fix> ai_lod_schedule(const vcobjptridx_t robot, const robot_info &robptr)
+{
+	auto &lod = Ai_lod;
+	const auto i = robot.get_unchecked_index();
+	auto &banked = lod.banked[i];
+	if (lod.banked_signature[i] != robot->signature)
+	{
+		lod.banked_signature[i] = robot->signature;
+		banked = 0;
+	}
+	if (lod.divisor > 1 && (lod.frame + i) % lod.divisor && ai_lod_may_defer(robot, robptr))
+	{
+		banked += FrameTime;
+		return std::nullopt;
+	}
+	return FrameTime + std::exchange(banked, 0);
+}
+
+/* Sets FrameTime for one robot's thinking and adds the time the thinking
+ * took to the frame's AI time.
+ */
+class ai_lod_think
+{
+	const std::chrono::steady_clock::time_point start{std::chrono::steady_clock::now()};
+	const fix saved_frame_time{FrameTime};
+public:
+	ai_lod_think(const fix frame_time)
+	{
+		FrameTime = frame_time;
+	}
+	ai_lod_think(const ai_lod_think &) = delete;
+	ai_lod_think &operator=(const ai_lod_think &) = delete;
+	~ai_lod_think()
+	{
+		FrameTime = saved_frame_time;
+		Ai_lod.spent += std::chrono::steady_clock::now() - start;
+	}
+};
+
 }
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -3292,6 +3492,7 @@ void do_ai_frame(const d_level_shared_robot_info_state &LevelSharedRobotInfoStat
 #if DXX_BUILD_DESCENT == 2
 	auto &BuddyState = LevelUniqueObjectState.BuddyState;
 	auto &vcobjptr = Objects.vcptr;
+	auto &vcobjptridx = Objects.vcptridx;
 	ailp.next_action_time -= FrameTime;
 #endif
 
@@ -3319,6 +3520,15 @@ void do_ai_frame(const d_level_shared_robot_info_state &LevelSharedRobotInfoStat
 	if (do_any_robot_dying_frame(Robot_info, obj))
 		return;
 
+	std::optional<ai_lod_think> lod_think;
+	if (CGameArg.SysAiBudget)
+	{
+		const auto frame_time = ai_lod_schedule(obj, robptr);
+		if (!frame_time)
+			return;
+		lod_think.emplace(*frame_time);
+	}
+
 	// Kind of a hack.  If a robot is flinching, but it is time for it to fire, unflinch it.
 	// Else, you can turn a big nasty robot into a wimp by firing flares at it.
 	// This also allows the player to see the cool flinch effect for mechs without unbalancing the game.
@@ -3399,8 +3609,11 @@ void do_ai_frame(const d_level_shared_robot_info_state &LevelSharedRobotInfoStat
 				const object *min_obj{nullptr};
 				fix min_dist = F1_0*200, cur_dist;
 
-				for (auto &obj_search : vcobjptr)
+				for (const auto &&obj_search_idx : vcobjptridx)
 				{
+					if (!Object_hot_fields.is(obj_search_idx.get_unchecked_index(), OBJ_ROBOT))
+						continue;
+					const object &obj_search = obj_search_idx;
 					if (&obj_search != obj && obj_search.type == OBJ_ROBOT)
 					{
 						cur_dist = vm_vec_dist_quick(obj->pos, obj_search.pos);
@@ -4650,6 +4863,8 @@ void do_ai_frame_all(const d_robot_info_array &Robot_info)
 	auto &vmobjptr = Objects.vmptr;
 
 	set_player_awareness_all(vmobjptr, vcsegptridx, LevelUniqueRobotAwarenessState);
+	if (const auto budget = CGameArg.SysAiBudget)
+		Ai_lod.end_frame(budget);
 
 #if DXX_BUILD_DESCENT == 2
 	auto &BossUniqueState = LevelUniqueObjectState.BossState;
@@ -5123,6 +5338,7 @@ int ai_restore_state(const d_robot_info_array &Robot_info, const NamedPHYSFS_Fil
 		if (temp > Point_segs.size())
 			throw std::out_of_range("too many points");
 		Point_segs_free_ptr = Point_segs.begin() + temp;
+		ai_path_garbage_collect_abandon();
 	} else
 		ai_reset_all_paths();
 
@@ -5151,4 +5367,18 @@ int ai_restore_state(const d_robot_info_array &Robot_info, const NamedPHYSFS_Fil
 	return 1;
 }
 
+void ai_take_snapshot(ai_snapshot &s)
+{
+	s.Overall_agitation = Overall_agitation;
+	s.Ai_cloak_info = Ai_cloak_info;
+	s.Point_segs.assign(Point_segs.begin(), Point_segs_free_ptr);
+}
+
+void ai_restore_snapshot(const ai_snapshot &s)
+{
+	Overall_agitation = s.Overall_agitation;
+	Ai_cloak_info = s.Ai_cloak_info;
+	Point_segs_free_ptr = std::copy(s.Point_segs.begin(), s.Point_segs.end(), Point_segs.begin());
+}
+
 }
@@ -23,11 +23,14 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  *
  */
 
+#include <algorithm>
+#include <climits>
 #include <numeric>
 #include <random>
 #include <stdio.h>		//	for printf()
 #include <stdlib.h>		// for d_rand() and qsort()
 #include <string.h>		// for memset()
+#include <vector>
 
 #include "inferno.h"
 #include "console.h"
@@ -78,11 +81,75 @@ static void ai_path_set_orient_and_vel(const d_robot_info_array &Robot_info, obj
 								);
 static void maybe_ai_path_garbage_collect(void);
 static void ai_path_garbage_collect(void);
+static bool ai_path_make_room();
 #if PATH_VALIDATION
 static void validate_all_paths();
 static int validate_path(int, point_seg* psegs, uint_fast32_t num_points);
 #endif
 
+//	Paths recently created by create_path_to_segment.  Robots of one type
+//	chasing the same goal from the same segment usually ask for the same
+//	path within a few frames of each other, so later robots copy the path
+//	instead of searching the mine again.  Each robot still gets its own
+//	copy in Point_segs, since paths are polished in place.
+struct path_cache_entry
+{
+	int tick{-1};
+	segnum_t start_seg, end_seg;
+	unsigned max_length;
+	create_path_safety_flag safety_flag;
+	robot_id id;
+	ai_behavior behavior;
+	std::vector<point_seg> points;
+};
+
+//	How long a cached path may be reused.  Doors can change in that
+//	time, which a robot already copes with when it follows an older path.
+constexpr int path_cache_ticks{8};
+
+std::array<path_cache_entry, 8> Path_cache;
+unsigned Path_cache_next;
+
+//	Companions are excluded because their paths depend on the player's
+//	keys and their mode, and fleeing robots because their paths avoid
+//	the player's segment.
+static bool path_cache_usable(const object &obj, const robot_info &robptr)
+{
+	if (obj.type != OBJ_ROBOT || obj.ctype.ai_info.behavior == ai_behavior::AIB_RUN_FROM)
+		return false;
+#if DXX_BUILD_DESCENT == 2
+	if (robptr.companion)
+		return false;
+#elif DXX_BUILD_DESCENT == 1
+	(void)robptr;
+#endif
+	return true;
+}
+
+static path_cache_entry *path_cache_find(const object &obj, const segnum_t start_seg, const segnum_t end_seg, const unsigned max_length, const create_path_safety_flag safety_flag)
+{
+	for (auto &e : Path_cache)
+		if (e.tick <= d_tick_count && e.tick + path_cache_ticks > d_tick_count &&
+			e.start_seg == start_seg && e.end_seg == end_seg &&
+			e.max_length == max_length && e.safety_flag == safety_flag &&
+			e.id == get_robot_id(obj) && e.behavior == obj.ctype.ai_info.behavior)
+			return &e;
+	return nullptr;
+}
+
+static void path_cache_store(const object &obj, const segnum_t start_seg, const segnum_t end_seg, const unsigned max_length, const create_path_safety_flag safety_flag, const point_seg *const psegs, const unsigned num_points)
+{
+	auto &e = Path_cache[Path_cache_next++ % Path_cache.size()];
+	e.tick = d_tick_count;
+	e.start_seg = start_seg;
+	e.end_seg = end_seg;
+	e.max_length = max_length;
+	e.safety_flag = safety_flag;
+	e.id = get_robot_id(obj);
+	e.behavior = obj.ctype.ai_info.behavior;
+	e.points.assign(psegs, psegs + num_points);
+}
+
 //	-----------------------------------------------------------------------------------------------------------
 //	Insert the point at the center of the side connecting two segments between the two points.
 // This is messy because we must insert into the list.  The simplest (and not too slow) way to do this is to start
@@ -283,6 +350,12 @@ std::pair<create_path_result, unsigned> create_path_points(const vmobjptridx_t o
 	int qtail{0}, qhead = 0;
 	int		i;
 	std::array<seg_seg, MAX_SEGMENTS> seg_queue;
+	/* The queue entry that reached each entry's start segment, or -1 for
+	 * start_seg, so that the path can be walked back without searching
+	 * the queue.
+	 */
+	std::array<int16_t, MAX_SEGMENTS> seg_queue_parent;
+	int		cur_parent{-1};
 	int		cur_depth;
 	point_seg_array_t::iterator	original_psegs = psegs;
 	unsigned l_num_points{0};
@@ -300,7 +373,8 @@ std::pair<create_path_result, unsigned> create_path_points(const vmobjptridx_t o
 }
 
 	visited_segment_bitarray_t visited;
-	std::array<uint16_t, MAX_SEGMENTS> depth{};
+	/* Only entries below qtail are read, so there is no need to clear it */
+	std::array<uint16_t, MAX_SEGMENTS> depth;
 
 	//	If there is a segment we're not allowed to visit, mark it.
 	if (avoid_seg != segment_none) {
@@ -338,6 +412,7 @@ std::pair<create_path_result, unsigned> create_path_points(const vmobjptridx_t o
 		: std::minstd_rand::default_seed
 	);
 	std::uniform_int_distribution uid03(0, 3);
+	auto &player_info = get_local_plrobj().ctype.player_info;
 #endif
 	while (cur_seg != end_seg) {
 		const cscusegment &&segp = vcsegptr(cur_seg);
@@ -366,20 +441,24 @@ std::pair<create_path_result, unsigned> create_path_points(const vmobjptridx_t o
 
 		for (const auto snum : side_traversal_translation)
 		{
-			if (!IS_CHILD(segp.s.children[snum]))
+			const auto this_seg = segp.s.children[snum];
+			if (!IS_CHILD(this_seg))
+				continue;
+			/* A segment already reached is never queued again, so skip
+			 * the passability tests for it.  The tests have no side
+			 * effects, so the path found is the same.
+			 */
+			if (visited[this_seg])
 				continue;
 #if DXX_BUILD_DESCENT == 1
 #define AI_DOOR_OPENABLE_PLAYER_FLAGS
 #elif DXX_BUILD_DESCENT == 2
 #define AI_DOOR_OPENABLE_PLAYER_FLAGS	player_info.powerup_flags,
-			auto &player_info = get_local_plrobj().ctype.player_info;
 #endif
 			if ((WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, segp, snum) & WALL_IS_DOORWAY_FLAG::fly) || ai_door_is_openable(obj, robptr, AI_DOOR_OPENABLE_PLAYER_FLAGS segp, snum))
 #undef AI_DOOR_OPENABLE_PLAYER_FLAGS
 			{
-				const auto this_seg = segp.s.children[snum];
 #if DXX_BUILD_DESCENT == 2
-				Assert(this_seg != segment_none);
 				if (((cur_seg == avoid_seg) || (this_seg == avoid_seg)) && (ConsoleObject->segnum == avoid_seg)) {
 					const auto center_point{compute_center_point_on_side(vcvertptr, segp, snum)};
 					fvi_info		hit_data;
@@ -400,16 +479,17 @@ std::pair<create_path_result, unsigned> create_path_points(const vmobjptridx_t o
 				}
 #endif
 
-				if (!visited[this_seg]) {
+				{
 					seg_queue[qtail].start = cur_seg;
 					seg_queue[qtail].end = this_seg;
+					seg_queue_parent[qtail] = cur_parent;
 					visited[this_seg] = true;
 					depth[qtail++] = cur_depth+1;
 					if (depth[qtail-1] == max_depth) {
 						end_seg = seg_queue[qtail-1].end;
 						goto cpp_done1;
 					}	// end if (depth[...
-				}	// end if (!visited...
+				}
 			}	// if (WALL_IS_DOORWAY(...
 #if DXX_BUILD_DESCENT == 2
 dont_add: ;
@@ -427,6 +507,7 @@ dont_add: ;
 
 		cur_seg = seg_queue[qhead].end;
 		cur_depth = depth[qhead];
+		cur_parent = qhead;
 		qhead++;
 
 cpp_done1: ;
@@ -450,10 +531,7 @@ cpp_done1: ;
 #endif
 
 	while (qtail >= 0) {
-		segnum_t	parent_seg, this_seg;
-
-		this_seg = seg_queue[qtail].end;
-		parent_seg = seg_queue[qtail].start;
+		const segnum_t this_seg = seg_queue[qtail].end;
 		psegs->segnum = this_seg;
 		psegs->point = compute_segment_center(vcvertptr, vcsegptr(this_seg));
 		psegs++;
@@ -464,11 +542,11 @@ cpp_done1: ;
 		#endif
 #endif
 
-		if (parent_seg == start_seg)
+		if (seg_queue[qtail].start == start_seg)
 			break;
 
-		while (seg_queue[--qtail].end != parent_seg)
-			Assert(qtail >= 0);
+		qtail = seg_queue_parent[qtail];
+		assert(qtail >= 0);
 	}
 
 	psegs->segnum = start_seg;
@@ -669,7 +747,18 @@ void create_path_to_segment(const vmobjptridx_t objp, const robot_info &robptr,
 	if (end_seg == segment_none) {
 		;
 	} else {
-		aip->path_length = create_path_points(objp, &robptr, start_seg, end_seg, Point_segs_free_ptr, max_length, create_path_random_flag::random, safety_flag, segment_none).second;
+		const auto cache = path_cache_usable(obj, robptr);
+		if (const auto cached = cache ? path_cache_find(obj, start_seg, end_seg, max_length, safety_flag) : nullptr)
+		{
+			std::ranges::copy(cached->points, Point_segs_free_ptr);
+			aip->path_length = static_cast<short>(cached->points.size());
+		}
+		else
+		{
+			aip->path_length = create_path_points(objp, &robptr, start_seg, end_seg, Point_segs_free_ptr, max_length, create_path_random_flag::random, safety_flag, segment_none).second;
+			if (cache)
+				path_cache_store(obj, start_seg, end_seg, max_length, safety_flag, Point_segs_free_ptr, aip->path_length);
+		}
 #if DXX_BUILD_DESCENT == 2
 		aip->path_length = polish_path(objp, Point_segs_free_ptr, aip->path_length);
 #endif
@@ -681,11 +770,8 @@ void create_path_to_segment(const vmobjptridx_t objp, const robot_info &robptr,
 #endif
 #endif
 		Point_segs_free_ptr += aip->path_length;
-		if (Point_segs_free_ptr - Point_segs + MAX_PATH_LENGTH*2 > MAX_POINT_SEGS) {
-			//Int3();	//	Contact Mike: This is stupid.  Should call maybe_ai_garbage_collect before the add.
-			ai_reset_all_paths();
+		if (ai_path_make_room())
 			return;
-		}
 //		Assert(Point_segs_free_ptr - Point_segs + MAX_PATH_LENGTH*2 < MAX_POINT_SEGS);
 		aip->PATH_DIR = 1;		//	Initialize to moving forward.
 #if DXX_BUILD_DESCENT == 1
@@ -741,10 +827,8 @@ void create_path_to_segment(const vmobjptridx_t objp, const robot_info &robptr,
 		aip->hide_index = Point_segs_free_ptr - Point_segs;
 		aip->cur_path_index = 0;
 		Point_segs_free_ptr += aip->path_length;
-		if (Point_segs_free_ptr - Point_segs + MAX_PATH_LENGTH*2 > MAX_POINT_SEGS) {
-			ai_reset_all_paths();
+		if (ai_path_make_room())
 			return;
-		}
 
 		aip->PATH_DIR = 1;		//	Initialize to moving forward.
 		// -- UNUSED! aip->SUBMODE = AISM_GOHIDE;		//	This forces immediate movement.
@@ -792,11 +876,8 @@ void create_path_to_station(const vmobjptridx_t objp, const robot_info &robptr,
 #endif
 #endif
 		Point_segs_free_ptr += aip->path_length;
-		if (Point_segs_free_ptr - Point_segs + MAX_PATH_LENGTH*2 > MAX_POINT_SEGS) {
-			//Int3();	//	Contact Mike: Stupid.
-			ai_reset_all_paths();
+		if (ai_path_make_room())
 			return;
-		}
 //		Assert(Point_segs_free_ptr - Point_segs + MAX_PATH_LENGTH*2 < MAX_POINT_SEGS);
 		aip->PATH_DIR = 1;		//	Initialize to moving forward.
 		// aip->SUBMODE = AISM_GOHIDE;		//	This forces immediate movement.
@@ -839,10 +920,7 @@ void create_n_segment_path(const vmobjptridx_t objp, const robot_info &robptr, u
 	validate_path(8, Point_segs_free_ptr, aip->path_length);
 #endif
 	Point_segs_free_ptr += aip->path_length;
-	if (Point_segs_free_ptr - Point_segs + MAX_PATH_LENGTH*2 > MAX_POINT_SEGS) {
-		//Int3();	//	Contact Mike: This is curious, though not deadly. /eip++;g
-		ai_reset_all_paths();
-	}
+	ai_path_make_room();
 
 	aip->PATH_DIR = 1;		//	Initialize to moving forward.
 #if DXX_BUILD_DESCENT == 1
@@ -935,10 +1013,7 @@ static void create_path(const vmobjptridx_t objp, const robot_info &robptr)
 		validate_path(5, Point_segs_free_ptr, aip->path_length);
 #endif
 		Point_segs_free_ptr += aip->path_length;
-		if (Point_segs_free_ptr - Point_segs + MAX_PATH_LENGTH*2 > MAX_POINT_SEGS) {
-			//Int3();	//	Contact Mike: This is curious, though not deadly. /eip++;g
-			ai_reset_all_paths();
-		}
+		ai_path_make_room();
 		aip->PATH_DIR = 1;		//	Initialize to moving forward.
 		aip->SUBMODE = AISM_HIDING;		//	Pretend we are hiding, so we sit here until bothered.
 	}
@@ -1340,17 +1415,42 @@ void ai_path_set_orient_and_vel(const d_robot_info_array &Robot_info, object &ob
 }
 
 //	----------------------------------------------------------------------------------------------------------
-//	Garbage colledion -- Free all unused records in Point_segs and compress all paths.
-void ai_path_garbage_collect()
+//	An object owns a path in Point_segs if it is a robot under AI (or morph) control with a nonempty path.
+static bool object_has_path(const object &obj)
 {
-	int free_path_index{0};
-	int num_path_objects{0};
-	int	objind;
-	std::array<obj_path, MAX_OBJECTS>		object_list;
+	return obj.type == OBJ_ROBOT && (obj.control_source == object::control_type::ai
+#if DXX_BUILD_DESCENT == 2
+		|| obj.control_source == object::control_type::morph
+#endif
+		) && obj.ctype.ai_info.path_length;
+}
+
+//	A garbage collection in progress.  A pass records where every path
+//	started, then moves a few paths down per step, in order of their
+//	position, so that a busy level does not stall while the whole pool is
+//	compacted.  Between steps, every path is still whole at its
+//	hide_index.  New paths are allocated past snapshot_end while a pass is
+//	running.  The last step moves them down as one block.
+struct path_gc_state
+{
+	std::array<obj_path, MAX_OBJECTS> object_list;
+	unsigned num_path_objects;
+	unsigned objind;
+	int free_path_index;
+	int snapshot_end;
+	bool active;
+};
 
+path_gc_state Path_gc;
+
+//	Number of paths moved by one step of an incremental pass.
+constexpr unsigned path_gc_step_paths{16};
+
+static void ai_path_garbage_collect_begin()
+{
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &vcobjptridx = Objects.vcptridx;
-	auto &vmobjptridx = Objects.vmptridx;
+	auto &gc = Path_gc;
 
 	Last_tick_garbage_collected = d_tick_count;
 
@@ -1358,40 +1458,48 @@ void ai_path_garbage_collect()
 	validate_all_paths();
 #endif
 	//	Create a list of objects which have paths of length 1 or more.
+	unsigned num_path_objects{0};
 	range_for (const auto &&objp, vcobjptridx)
 	{
-		if (objp->type == OBJ_ROBOT && (objp->control_source == object::control_type::ai
-#if DXX_BUILD_DESCENT == 2
-			|| objp->control_source == object::control_type::morph
-#endif
-										  )) {
-			const auto &aip = objp->ctype.ai_info;
-			if (aip.path_length) {
-				auto &ol{object_list[num_path_objects]};
-				++ num_path_objects;
-				ol.path_start = aip.hide_index;
-				ol.objnum = objp;
-			}
+		if (object_has_path(objp))
+		{
+			auto &ol{gc.object_list[num_path_objects]};
+			++ num_path_objects;
+			ol.path_start = objp->ctype.ai_info.hide_index;
+			ol.objnum = objp;
 		}
 	}
-	std::ranges::sort(std::span(object_list).first(num_path_objects), {}, &obj_path::path_start);
-
-	for (objind=0; objind < num_path_objects; objind++) {
-		ai_static	*aip;
-		int			i;
-		int			old_index;
-
-		auto objnum = object_list[objind].objnum;
-		object &objp = vmobjptridx(objnum);
-		aip = &objp.ctype.ai_info;
-		old_index = aip->hide_index;
+	std::ranges::sort(std::span(gc.object_list).first(num_path_objects), {}, &obj_path::path_start);
+	gc.num_path_objects = num_path_objects;
+	gc.objind = 0;
+	gc.free_path_index = 0;
+	gc.snapshot_end = Point_segs_free_ptr - Point_segs;
+	gc.active = true;
+}
 
-		aip->hide_index = free_path_index;
-		for (i=0; i<aip->path_length; i++)
-			Point_segs[free_path_index++] = Point_segs[old_index++];
+//	Move the paths which were allocated while the pass ran down to the end
+//	of the compacted paths, and release everything after them.
+static void ai_path_garbage_collect_finish()
+{
+	auto &Objects = LevelUniqueObjectState.Objects;
+	auto &gc = Path_gc;
+	const int free_path_index = gc.free_path_index;
+	const int snapshot_end = gc.snapshot_end;
+	const int end = Point_segs_free_ptr - Point_segs;
+	gc.active = false;
+	if (snapshot_end != free_path_index)
+	{
+		std::copy(Point_segs.begin() + snapshot_end, Point_segs.begin() + end, Point_segs.begin() + free_path_index);
+		for (auto &obj : Objects.vmptr)
+		{
+			if (!object_has_path(obj))
+				continue;
+			auto &aip = obj.ctype.ai_info;
+			if (aip.hide_index >= snapshot_end)
+				aip.hide_index -= snapshot_end - free_path_index;
+		}
 	}
-
-	Point_segs_free_ptr = Point_segs.begin() + free_path_index;
+	Point_segs_free_ptr = Point_segs.begin() + free_path_index + (end - snapshot_end);
 
 #ifndef NDEBUG
 	{
@@ -1410,10 +1518,76 @@ void ai_path_garbage_collect()
 #endif
 }
 
+//	Move up to max_paths paths of the pass in progress.  Paths are moved in
+//	order of position, each to the end of the paths already moved, so a
+//	path is only ever copied downward into space no other path uses.  A
+//	robot which has been given a new path since the pass began, or which
+//	is gone, is skipped; its old path is garbage.
+static void ai_path_garbage_collect_step(unsigned max_paths)
+{
+	auto &Objects = LevelUniqueObjectState.Objects;
+	auto &vmobjptr = Objects.vmptr;
+	auto &gc = Path_gc;
+	for (; gc.objind < gc.num_path_objects && max_paths; ++gc.objind, --max_paths)
+	{
+		const auto &ol = gc.object_list[gc.objind];
+		auto &objp = *vmobjptr(ol.objnum);
+		if (!object_has_path(objp))
+			continue;
+		auto &aip = objp.ctype.ai_info;
+		if (aip.hide_index != ol.path_start)
+			continue;
+		const int old_index = aip.hide_index;
+		aip.hide_index = gc.free_path_index;
+		std::copy(Point_segs.begin() + old_index, Point_segs.begin() + old_index + aip.path_length, Point_segs.begin() + gc.free_path_index);
+		gc.free_path_index += aip.path_length;
+	}
+	if (gc.objind == gc.num_path_objects)
+		ai_path_garbage_collect_finish();
+}
+
+//	----------------------------------------------------------------------------------------------------------
+//	Garbage colledion -- Free all unused records in Point_segs and compress all paths.
+void ai_path_garbage_collect()
+{
+	ai_path_garbage_collect_begin();
+	ai_path_garbage_collect_step(UINT_MAX);
+}
+
+//	-----------------------------------------------------------------------------
+//	Called just after a path is appended.  If the pool has no room left for
+//	another long path, compact it, and only if that is not enough, drop
+//	every path.  Return true if the paths were dropped.  Spawn loops used to
+//	drop every robot's path here whenever the pool filled.
+bool ai_path_make_room()
+{
+	const auto full = [] {
+		return Point_segs_free_ptr - Point_segs + MAX_PATH_LENGTH*2 > MAX_POINT_SEGS;
+	};
+	if (!full())
+		return false;
+	if (Path_gc.active)
+		ai_path_garbage_collect_step(UINT_MAX);
+	else
+		ai_path_garbage_collect();
+	if (!full())
+		return false;
+	ai_reset_all_paths();
+	return true;
+}
+
 //	-----------------------------------------------------------------------------
 //	Do garbage collection if not been done for awhile, or things getting really critical.
 void maybe_ai_path_garbage_collect(void)
 {
+	if (Path_gc.active)
+	{
+		/* Near full, finish the pass at once rather than risk running
+		 * out of room before it ends.
+		 */
+		ai_path_garbage_collect_step(Point_segs_free_ptr - Point_segs > MAX_POINT_SEGS - MAX_PATH_LENGTH ? UINT_MAX : path_gc_step_paths);
+		return;
+	}
 	if (Point_segs_free_ptr - Point_segs > MAX_POINT_SEGS - MAX_PATH_LENGTH) {
 		if (Last_tick_garbage_collected+1 >= d_tick_count) {
 			//	This is kind of bad.  Garbage collected last frame or this frame.
@@ -1425,11 +1599,13 @@ void maybe_ai_path_garbage_collect(void)
 		}
 	} else if (Point_segs_free_ptr - Point_segs > 3*MAX_POINT_SEGS/4) {
 		if (Last_tick_garbage_collected + 16 < d_tick_count) {
-			ai_path_garbage_collect();
+			ai_path_garbage_collect_begin();
+			ai_path_garbage_collect_step(path_gc_step_paths);
 		}
 	} else if (Point_segs_free_ptr - Point_segs > MAX_POINT_SEGS/2) {
 		if (Last_tick_garbage_collected + 256 < d_tick_count) {
-			ai_path_garbage_collect();
+			ai_path_garbage_collect_begin();
+			ai_path_garbage_collect_step(path_gc_step_paths);
 		}
 	}
 }
@@ -1450,10 +1626,17 @@ void ai_reset_all_paths(void)
 			obj.ctype.ai_info.path_length = 0;
 		}
 	}
+	for (auto &e : Path_cache)
+		e.tick = -1;
 
 	ai_path_garbage_collect();
 }
 
+void ai_path_garbage_collect_abandon()
+{
+	Path_gc.active = false;
+}
+
 //	---------------------------------------------------------------------------------------------------------
 //	Probably called because a robot bashed a wall, getting a bunch of retries.
 //	Try to resume path.
@@ -81,6 +81,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "d_range.h"
 #include "d_zip.h"
 #include <memory>
+#include <vector>
 
 #define EF_USED     1   // This edge is used
 #define EF_DEFINING 2   // A structure defining edge that should always draw.
@@ -128,6 +129,10 @@ struct automap : ::dcx::window
 	unsigned end_valid_edges{};
 	std::unique_ptr<Edge_info[]>		edges;
 	std::unique_ptr<Edge_info *[]>			drawingListBright;
+#if DXX_USE_OGL
+	// Edges to draw this frame, by index into `edges`
+	std::vector<ogl_static_line> drawn_lines;
+#endif
 
 	// Screen canvas variables
 	grs_subcanvas		automap_view;
@@ -152,6 +157,26 @@ struct automap : ::dcx::window
 	color_t			green_31;
 };
 
+/* The edges of the last automap opened on this level.  The cache holds
+ * them while no automap is open, so that the next automap only adds the
+ * segments visited since.  automap_clear_visited discards them at the
+ * start of each level.
+ */
+struct automap_edge_cache
+{
+	std::unique_ptr<Edge_info[]> edges;
+	int num_edges{};
+	unsigned end_valid_edges{};
+	unsigned max_edges{};
+	// What the edges were built from, if built is set
+	bool built{};
+	bool add_all_edges{};
+	std::size_t inputs{};
+	per_segment_array<uint8_t> visited;
+};
+
+static automap_edge_cache Automap_edge_cache;
+
 //	----------------------------------------------------------------------------------------------------------
 //	Set the segment depth of all segments from start_seg in `depth`.
 //	Returns maximum depth value.
@@ -233,6 +258,9 @@ static void init_automap_subcanvas(grs_subcanvas &view, grs_canvas &container)
 }
 
 static void automap_build_edge_list(automap &am, int add_all_edges);
+#if DXX_USE_OGL
+static void upload_automap_edges(const automap &am);
+#endif
 }
 
 }
@@ -312,6 +340,9 @@ static void recompute_automap_segment_visibility(const d_level_unique_automap_st
 	if (cheats.fullautomap)
 		compute_depth_all_segments = 1;
 	automap_build_edge_list(am, compute_depth_all_segments);
+#if DXX_USE_OGL
+	upload_automap_edges(am);
+#endif
 	am.max_segments_away = set_segment_depths(initial_segnum, compute_depth_all_segments ? nullptr : &LevelUniqueAutomapState.Automap_visited, am.depth_array);
 	am.segment_limit = am.max_segments_away;
 	adjust_segment_limit(am, am.segment_limit);
@@ -684,6 +715,7 @@ static void ClearMarkers()
 
 void automap_clear_visited(d_level_unique_automap_state &LevelUniqueAutomapState)
 {
+	Automap_edge_cache = {};
 #if DXX_BUILD_DESCENT == 2
 	ClearMarkers();
 #endif
@@ -1271,6 +1303,15 @@ window_event_result automap::event_handler(const d_event &event)
 			draw_automap(vcobjptr, *this);
 			break;
 		case event_type::window_close:
+#if DXX_USE_OGL
+			ogl_free_static_lines();
+#endif
+			{
+				auto &cache{Automap_edge_cache};
+				cache.edges = std::move(edges);
+				cache.num_edges = num_edges;
+				cache.end_valid_edges = end_valid_edges;
+			}
 			if (!pause_game)
 				ConsoleObject->mtype.phys_info.flags |= old_wiggle;		// Restore wiggle
 			event_toggle_focus(0);
@@ -1313,7 +1354,17 @@ void do_automap()
 	auto am{window_create<automap>(grd_curscreen->sc_canvas, 0, 0, SWIDTH, SHEIGHT)};
 	const auto max_edges{LevelSharedSegmentState.Num_segments * 12};
 	am->max_edges = max_edges;
-	am->edges = std::make_unique<Edge_info[]>(max_edges);
+	if (auto &cache{Automap_edge_cache}; cache.edges && cache.max_edges == max_edges)
+	{
+		am->edges = std::move(cache.edges);
+		am->num_edges = cache.num_edges;
+		am->end_valid_edges = cache.end_valid_edges;
+	}
+	else
+	{
+		cache.built = false;
+		am->edges = std::make_unique<Edge_info[]>(max_edges);
+	}
 	am->drawingListBright = std::make_unique<Edge_info *[]>(max_edges);
 
 	init_automap_colors(*am);
@@ -1370,7 +1421,11 @@ namespace {
 
 void draw_all_edges(automap &am)
 {
+#if DXX_USE_OGL
+	am.drawn_lines.clear();
+#else
 	auto &canvas{am.automap_view};
+#endif
 	auto &LevelSharedVertexState{LevelSharedSegmentState.get_vertex_state()};
 	auto &Vertices{LevelSharedVertexState.get_vertices()};
 	unsigned nbright{0};
@@ -1413,7 +1468,11 @@ void draw_all_edges(automap &am)
 					const uint8_t color = (e->flags & EF_NO_FADE)
 						? e->color
 						: gr_fade_table[(gr_fade_level{8})][e->color];
+#if DXX_USE_OGL
+					am.drawn_lines.push_back({static_cast<uint32_t>(e - am.edges.get()), color});
+#else
 					g3_draw_line(g3_draw_line_context{canvas, color}, Segment_points[e->verts[0]], Segment_points[e->verts[1]]);
+#endif
 				} 	else {
 					am.drawingListBright[nbright++] = e;
 				}
@@ -1432,7 +1491,6 @@ void draw_all_edges(automap &am)
 	range_for (const auto e, range)
 	{
 		const auto p1{&Segment_points[e->verts[0]]};
-		const auto p2{&Segment_points[e->verts[1]]};
 		fix dist{p1->p3_vec.z - min_distance};
 		// Make distance be 1.0 to 0.0, where 0.0 is 10 segments away;
 		if ( dist < 0 ) dist=0;
@@ -1442,8 +1500,16 @@ void draw_all_edges(automap &am)
 			? e->color
 			: gr_fade_table[static_cast<gr_fade_level>(f2i((F1_0 - fixdiv(dist, am.farthest_dist)) * 31))][e->color]
 		};
+#if DXX_USE_OGL
+		am.drawn_lines.push_back({static_cast<uint32_t>(e - am.edges.get()), color});
+#else
+		const auto p2{&Segment_points[e->verts[1]]};
 		g3_draw_line(g3_draw_line_context{canvas, color}, *p1, *p2);
+#endif
 	}
+#if DXX_USE_OGL
+	ogl_draw_static_lines(am.drawn_lines);
+#endif
 }
 
 //==================================================================
@@ -1698,7 +1764,132 @@ static void add_unknown_segment_edges(automap &am, const shared_segment &seg)
 	}
 }
 
-void automap_build_edge_list(automap &am, int add_all_edges)
+static void automap_mark_frontier_edges(automap &am)
+{
+	auto &Automap_visited{LevelUniqueAutomapState.Automap_visited};
+	range_for (const auto &&segp, vcsegptridx)
+	{
+#if DXX_USE_EDITOR
+		if (segp->shared_segment::segnum != segment_none)
+#endif
+			if (!Automap_visited[segp])
+			{
+				add_unknown_segment_edges(am, segp);
+			}
+	}
+}
+
+static void automap_find_defining_edges(automap &am)
+{
+	// Find unnecessary lines (These are lines that don't have to be drawn because they have small curvature)
+	for (auto &i : unchecked_partial_range(am.edges.get(), am.end_valid_edges))
+	{
+		const auto e{&i};
+		if (!(e->flags&EF_USED)) continue;
+
+		const auto num_faces{e->num_faces};
+		if (num_faces < 2)
+			continue;
+		for (unsigned e1{0}; e1 < num_faces; ++e1)
+		{
+			const auto e1segnum{e->segnum[e1]};
+			const auto &e1siden0{vcsegptr(e1segnum)->shared_segment::sides[e->sides[e1]].normals[0]};
+			for (unsigned e2{1}; e2 < num_faces; ++e2)
+			{
+				if (e1 == e2)
+					continue;
+				const auto e2segnum{e->segnum[e2]};
+				if (e1segnum == e2segnum)
+					continue;
+				if (vm_vec_build_dot(e1siden0, vcsegptr(e2segnum)->shared_segment::sides[e->sides[e2]].normals[0]) > (F1_0 - (F1_0 / 10)))
+				{
+					e->flags &= (~EF_DEFINING);
+					break;
+				}
+			}
+			if (!(e->flags & EF_DEFINING))
+				break;
+		}
+	}
+}
+
+/* Everything other than the visited segments that the colors of the edges
+ * depend on
+ */
+static std::size_t get_automap_edge_inputs()
+{
+	auto &vcwallptr{LevelUniqueWallSubsystemState.Walls.vcptr};
+	std::size_t h{static_cast<std::size_t>(Current_level_num)};
+	const auto mix = [&h](const std::size_t v) {
+		h = (h ^ v) * 1099511628211u;
+	};
+	mix(LevelUniqueObjectState.ControlCenterState.Control_center_present);
+	mix(Player_num);
+	for (auto &w : vcwallptr)
+	{
+		mix(w.type | underlying_value(w.keys) << 8 | static_cast<uint8_t>(w.clip_num) << 16);
+		mix(underlying_value(w.trigger));
+		mix(underlying_value(vcsegptr(w.segnum)->unique_segment::sides[w.sidenum].tmap_num2));
+	}
+	return h;
+}
+
+/* Try to bring the edges that am took from Automap_edge_cache up to date
+ * by adding only the segments visited since they were built.  Returns
+ * false if they must be built again.
+ */
+static bool automap_update_edge_list(automap &am, const bool add_all_edges, const std::size_t inputs)
+{
+#if DXX_USE_EDITOR
+	/* The editor can change the mine without starting a new level */
+	(void)am;
+	(void)add_all_edges;
+	(void)inputs;
+	return false;
+#else
+	auto &cache{Automap_edge_cache};
+	if (!cache.built || cache.add_all_edges != add_all_edges || cache.inputs != inputs || cache.max_edges != am.max_edges)
+		return false;
+	auto &Automap_visited{LevelUniqueAutomapState.Automap_visited};
+	bool added{false};
+	for (const auto &&[now, before] : zip(Automap_visited, cache.visited))
+	{
+		/* A restored game can forget segments */
+		if (before && !now)
+			return false;
+		if (now && !before)
+			added = true;
+	}
+	if (!added)
+		return true;
+	/* Unvisited segments only change frontier flags, so with every
+	 * segment drawn, newly visited ones change the colors of edges that
+	 * are already in the list
+	 */
+	if (add_all_edges)
+		return false;
+	auto &vcwallptr{LevelUniqueWallSubsystemState.Walls.vcptr};
+	range_for (const auto &&segp, vcsegptridx)
+	{
+#if DXX_USE_EDITOR
+		if (segp->shared_segment::segnum != segment_none)
+#endif
+			if (Automap_visited[segp] && !cache.visited[segp])
+				add_segment_edges(vcsegptr, vcwallptr, am, segp);
+	}
+	/* Both passes look at every edge, but only check flags and normals,
+	 * which is cheap next to finding the edges of every segment.
+	 */
+	for (auto &i : unchecked_partial_range(am.edges.get(), am.end_valid_edges))
+		if (i.flags & EF_USED)
+			i.flags = (i.flags & ~EF_FRONTIER) | EF_DEFINING;
+	automap_mark_frontier_edges(am);
+	automap_find_defining_edges(am);
+	return true;
+#endif
+}
+
+static void automap_rebuild_edge_list(automap &am, const bool add_all_edges)
 {
 	// clear edge list
 	for (auto &i : unchecked_partial_range(am.edges.get(), am.max_edges))
@@ -1734,49 +1925,54 @@ void automap_build_edge_list(automap &am, int add_all_edges)
 					add_segment_edges(vcsegptr, vcwallptr, am, segp);
 				}
 		}
-		range_for (const auto &&segp, vcsegptridx)
-		{
-#if DXX_USE_EDITOR
-			if (segp->shared_segment::segnum != segment_none)
-#endif
-				if (!LevelUniqueAutomapState.Automap_visited[segp])
-				{
-					add_unknown_segment_edges(am, segp);
-				}
-		}
+		automap_mark_frontier_edges(am);
 	}
+	automap_find_defining_edges(am);
+}
 
-	// Find unnecessary lines (These are lines that don't have to be drawn because they have small curvature)
-	for (auto &i : unchecked_partial_range(am.edges.get(), am.end_valid_edges))
-	{
-		const auto e{&i};
-		if (!(e->flags&EF_USED)) continue;
+void automap_build_edge_list(automap &am, int add_all_edges)
+{
+	const auto inputs{get_automap_edge_inputs()};
+	if (!automap_update_edge_list(am, add_all_edges, inputs))
+		automap_rebuild_edge_list(am, add_all_edges);
+	auto &cache{Automap_edge_cache};
+	cache.built = true;
+	cache.add_all_edges = add_all_edges;
+	cache.inputs = inputs;
+	cache.max_edges = am.max_edges;
+	cache.visited = LevelUniqueAutomapState.Automap_visited;
+}
 
-		const auto num_faces{e->num_faces};
-		if (num_faces < 2)
+#if DXX_USE_OGL
+/* The edges do not move while the automap is open, so their ends are
+ * given to the renderer once, in world space, and each frame only picks
+ * the edges to draw and their colors.
+ */
+void upload_automap_edges(const automap &am)
+{
+	auto &LevelSharedVertexState{LevelSharedSegmentState.get_vertex_state()};
+	auto &vcvertptr{LevelSharedVertexState.get_vertices().vcptr};
+	std::vector<std::array<float, 3>> points;
+	points.reserve(std::size_t{am.end_valid_edges} * 2);
+	for (auto &e : unchecked_partial_range(am.edges.get(), am.end_valid_edges))
+	{
+		/* Unused slots keep their place, so that edges are found by
+		 * their index
+		 */
+		if (!(e.flags & EF_USED))
+		{
+			points.insert(points.end(), 2, {});
 			continue;
-		for (unsigned e1{0}; e1 < num_faces; ++e1)
+		}
+		for (const auto v : e.verts)
 		{
-			const auto e1segnum{e->segnum[e1]};
-			const auto &e1siden0{vcsegptr(e1segnum)->shared_segment::sides[e->sides[e1]].normals[0]};
-			for (unsigned e2{1}; e2 < num_faces; ++e2)
-			{
-				if (e1 == e2)
-					continue;
-				const auto e2segnum{e->segnum[e2]};
-				if (e1segnum == e2segnum)
-					continue;
-				if (vm_vec_build_dot(e1siden0, vcsegptr(e2segnum)->shared_segment::sides[e->sides[e2]].normals[0]) > (F1_0 - (F1_0 / 10)))
-				{
-					e->flags &= (~EF_DEFINING);
-					break;
-				}
-			}
-			if (!(e->flags & EF_DEFINING))
-				break;
+			auto &p{*vcvertptr(v)};
+			points.push_back({{f2fl(p.x), f2fl(p.y), f2fl(p.z)}});
 		}
 	}
+	ogl_upload_static_lines(points);
 }
+#endif
 
 }
 
@@ -45,6 +45,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "iff.h"
 #include "powerup.h"
 #include "sounds.h"
+#include "digi.h"
 #include "piggy.h"
 #include "aistruct.h"
 #include "robot.h"
@@ -158,6 +159,7 @@ int gamedata_init(d_level_shared_robot_info_state &LevelSharedRobotInfoState)
 	if (retval != properties_init_result::skip_gamedata_read_tbl)
 		gamedata_read_tbl(LevelSharedRobotInfoState, Vclip, retval == properties_init_result::shareware);
 	piggy_read_sounds(retval == properties_init_result::shareware);
+	digi_prepare_sounds();
 	
 	return 0;
 }
@@ -303,6 +305,7 @@ int gamedata_init(d_level_shared_robot_info_state &LevelSharedRobotInfoState)
 				Error("Cannot open ham file\n");
 
 	piggy_read_sounds();
+	digi_prepare_sounds();
 
 	return 0;
 }
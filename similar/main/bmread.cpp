@@ -26,7 +26,10 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 #include "dxxsconf.h"
 #include <algorithm>
+#include <map>
+#include <span>
 #include <string>
+#include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -62,6 +65,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "physfs-serial.h"
 #include "args.h"
 #include "text.h"
+#include "parallel.h"
 #if DXX_BUILD_DESCENT == 1
 #include "fuelcen.h"
 #elif DXX_BUILD_DESCENT == 2
@@ -280,6 +284,106 @@ int compute_average_pixel(grs_bitmap *n)
 
 namespace {
 
+// The name a bitmap file is registered under in the piggy file.
+static std::array<char, 20> bm_piggy_name(const char *const filename)
+{
+#if DXX_BUILD_DESCENT == 1
+	return removeext(filename);
+#elif DXX_BUILD_DESCENT == 2
+	std::array<char, 20> fname{};
+	const auto path = d_splitpath(filename);
+	if (path.base_end - path.base_start >= fname.size())
+		Error("File <%s> - bitmap error, filename too long", filename);
+	memcpy(fname.data(), path.base_start, path.base_end - path.base_start);
+	return fname;
+#endif
+}
+
+#define LINEBUF_SIZE 600
+
+//---------------------------------------------------------------
+// Bitmap files named in the table, read before the table is parsed.
+// Reading a file does not depend on anything the table sets, so the
+// files are read side by side.  Remapping and registering a bitmap do,
+// and the order of registration sets the bitmap numbers, so those are
+// left to the parse, which takes the bitmap from here instead of
+// reading the file.  A file that failed to read is read again by the
+// parse, to report the error on the right line.
+struct prefetched_bitmap
+{
+	bool animbrush;
+	int transparent_color = -1;
+	iff_status_code status = iff_status_code::no_file;
+	palette_array_t palette;
+	grs_main_bitmap bm;
+	iff_read_result brush;
+};
+
+static std::map<std::string, prefetched_bitmap, std::less<>> Prefetched_bitmaps;
+
+static void bm_prefetch_files(PHYSFS_File *const InfoFile, const int have_bin_tbl, const int pc_shareware)
+{
+	for (PHYSFSX_gets_line_t<LINEBUF_SIZE> inputline; PHYSFSX_fgets(inputline, InfoFile);)
+	{
+		if (have_bin_tbl)
+			decode_text_line(inputline);
+		if (const auto comment = strchr(inputline, ';'))
+			*comment = 0;
+		char *arg = strtok(inputline, equal_space);
+		if (arg && arg[0] == '@' && pc_shareware)
+			continue;
+		for (; arg; arg = strtok(nullptr, equal_space))
+		{
+			const auto len = strlen(arg);
+			if (len < 4)
+				continue;
+			const auto ext = &arg[len - 4];
+			const bool animbrush = !d_stricmp(ext, ".abm");
+			if (!animbrush && d_stricmp(ext, ".bbm"))
+				continue;
+			/* As bm_load_sub and ab_load, skip files already in the
+			 * piggy file.
+			 */
+			const auto &&fname = bm_piggy_name(arg);
+			std::array<char, 24> tempname;
+			const auto piggy_name = animbrush
+				? std::span<const char>(tempname.data(), snprintf(tempname.data(), tempname.size(), "%.16s#0", fname.data()))
+				: std::span<const char>(fname);
+			if (piggy_find_bitmap(piggy_name) != bitmap_index{})
+				continue;
+			Prefetched_bitmaps.try_emplace(arg).first->second.animbrush = animbrush;
+		}
+	}
+	std::vector<std::pair<const std::string, prefetched_bitmap> *> files;
+	for (auto &f : Prefetched_bitmaps)
+		files.emplace_back(&f);
+	parallel_for(files.size(), [&files](const std::size_t i) {
+		auto &[filename, p] = *files[i];
+		if (p.animbrush)
+		{
+			p.brush = iff_read_animbrush(filename.c_str());
+			p.status = p.brush.status;
+		}
+		else
+			p.status = iff_read_bitmap(filename.c_str(), p.bm, &p.palette);
+		if (p.status == iff_status_code::no_error && iff_has_transparency)
+			p.transparent_color = iff_transparent_color;
+	});
+}
+
+// Take the file read by bm_prefetch_files, if it was read successfully.
+static prefetched_bitmap *bm_take_prefetched(const char *const filename)
+{
+	const auto i = Prefetched_bitmaps.find(filename);
+	if (i == Prefetched_bitmaps.end() || i->second.status != iff_status_code::no_error)
+		return nullptr;
+	/* Once registered, the bitmap is found in the piggy file, so it is
+	 * taken only once.
+	 */
+	i->second.status = iff_status_code::no_file;
+	return &i->second;
+}
+
 //---------------------------------------------------------------
 // Loads a bitmap from either the piggy file, a r64 file, or a
 // whatever extension is passed.
@@ -292,15 +396,7 @@ static bitmap_index bm_load_sub(const int skip, const char *const filename)
 		return bitmap_index{};
 	}
 
-#if DXX_BUILD_DESCENT == 1
-	const auto &&fname = removeext(filename);
-#elif DXX_BUILD_DESCENT == 2
-	std::array<char, 20> fname{};
-	const auto path = d_splitpath(filename);
-	if (path.base_end - path.base_start >= fname.size())
-		Error("File <%s> - bitmap error, filename too long", filename);
-	memcpy(fname.data(), path.base_start, path.base_end - path.base_start);
-#endif
+	const auto &&fname = bm_piggy_name(filename);
 
 	if (const auto bitmap_num = piggy_find_bitmap(fname); bitmap_num != bitmap_index{})
 	{
@@ -308,12 +404,27 @@ static bitmap_index bm_load_sub(const int skip, const char *const filename)
 	}
 
 	grs_bitmap n;
-	if (const auto iff_error{iff_read_bitmap(filename, n, &newpal)}; iff_error != iff_status_code::no_error)
+	int transparent_color;
+	if (const auto p = bm_take_prefetched(filename))
 	{
-		Error("File <%s> - IFF error: %s, line %d",filename,iff_errormsg(iff_error),linenum);
+		/* The piggy file takes over the data, as it would from a bitmap
+		 * read here.
+		 */
+		n = p->bm;
+		p->bm.bm_data = nullptr;
+		newpal = p->palette;
+		transparent_color = p->transparent_color;
+	}
+	else
+	{
+		if (const auto iff_error{iff_read_bitmap(filename, n, &newpal)}; iff_error != iff_status_code::no_error)
+		{
+			Error("File <%s> - IFF error: %s, line %d",filename,iff_errormsg(iff_error),linenum);
+		}
+		transparent_color = iff_has_transparency ? iff_transparent_color : -1;
 	}
 
-	gr_remap_bitmap_good(n, newpal, iff_has_transparency ? iff_transparent_color : -1, SuperX);
+	gr_remap_bitmap_good(n, newpal, transparent_color, SuperX);
 
 #if !DXX_USE_OGL
 	n.avg_color = compute_average_pixel(&n);
@@ -362,7 +473,9 @@ static void ab_load(int skip, const char * filename, std::array<bitmap_index, MA
 	}
 	}
 
-	auto read_result{iff_read_animbrush(filename)};
+	const auto p = bm_take_prefetched(filename);
+	auto read_result{p ? std::move(p->brush) : iff_read_animbrush(filename)};
+	const int transparent_color = p ? p->transparent_color : iff_has_transparency ? iff_transparent_color : -1;
 	auto &bm = read_result.bm;
 	auto &newpal = read_result.palette;
 	*nframes = read_result.n_bitmaps;
@@ -385,7 +498,7 @@ static void ab_load(int skip, const char * filename, std::array<bitmap_index, MA
 #elif DXX_BUILD_DESCENT == 2
 		snprintf(tempname.data(), tempname.size(), "%.*s#%" PRIuFAST32, DXX_ptrdiff_cast_int(path.base_end - path.base_start), path.base_start, i );
 #endif
-		gr_remap_bitmap_good(*bm[i].get(), newpal, iff_has_transparency ? iff_transparent_color : -1, SuperX);
+		gr_remap_bitmap_good(*bm[i].get(), newpal, transparent_color, SuperX);
 #if !DXX_USE_OGL
 		bm[i]->avg_color = compute_average_pixel(bm[i].get());
 #endif
@@ -492,8 +605,6 @@ static get_texture_result get_texture(d_level_unique_tmap_info_state::TmapInfo_a
 
 }
 
-#define LINEBUF_SIZE 600
-
 #if DXX_BUILD_DESCENT == 1 || (DXX_BUILD_DESCENT == 2 && DXX_USE_EDITOR)
 //-----------------------------------------------------------------
 // Initializes all properties and bitmaps from BITMAPS.TBL file.
@@ -594,6 +705,7 @@ int gamedata_read_tbl(d_level_shared_robot_info_state &LevelSharedRobotInfoState
 		have_bin_tbl = 1;
 	}
 #endif
+	bm_prefetch_files(InfoFile, have_bin_tbl, pc_shareware);
 	linenum = 0;
 
 	PHYSFS_seek(InfoFile, 0L);
@@ -825,6 +937,7 @@ int gamedata_read_tbl(d_level_shared_robot_info_state &LevelSharedRobotInfoState
       }
 	}
 
+	Prefetched_bitmaps.clear();
 	NumTextures = texture_count;
 	LevelUniqueTmapInfoState.Num_tmaps = tmap_count;
 
@@ -46,6 +46,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "vclip.h"
 #include "polyobj.h"
 #include "fireball.h"
+#include "particle.h"
 #include "hudmsg.h"
 #include "laser.h"
 #include "dxxerror.h"
@@ -74,6 +75,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "gameseq.h"
 #include "collide.h"
 #include "escort.h"
+#include "frame_profile.h"
 
 #include "d_levelstate.h"
 #include "partial_range.h"
@@ -693,7 +695,8 @@ int check_effect_blowup(const d_level_shared_destructible_light_state &LevelShar
 					vc = vclip_index{3};
 				}
 
-				object_create_explosion_without_damage(Vclip, seg, pnt, dest_size, vc);
+				create_cosmetic_explosion(Vclip, seg, pnt, dest_size, vc);
+				++LevelUniqueWallSubsystemState.change_count;
 
 #if DXX_BUILD_DESCENT == 2
 				if (ec != eclip_none && db != texture_index{UINT16_MAX} && !(Effects[ec].flags & EF_ONE_SHOT))
@@ -917,11 +920,11 @@ static window_event_result collide_weapon_and_wall(
 					imobjptridx(weapon->ctype.laser_info.parent_num));
 			}
 			else
-				object_create_explosion_without_damage(Vclip, vmsegptridx(weapon->segnum), weapon->pos, wi->impact_size, wi->wall_hit_vclip);
+				create_cosmetic_explosion(Vclip, vmsegptridx(weapon->segnum), weapon->pos, wi->impact_size, wi->wall_hit_vclip);
 
 		} else {
 			digi_link_sound_to_pos( sound_effect::SOUND_LASER_HIT_WATER,hitseg, sidenum_t::WLEFT, hitpt, 0, F1_0 );
-			object_create_explosion_without_damage(Vclip, vmsegptridx(weapon->segnum), weapon->pos, wi->impact_size, vclip_index::water_hit);
+			create_cosmetic_explosion(Vclip, vmsegptridx(weapon->segnum), weapon->pos, wi->impact_size, vclip_index::water_hit);
 		}
 
 		weapon->flags |= OF_SHOULD_BE_DEAD;		//make flares die in water
@@ -955,7 +958,7 @@ static window_event_result collide_weapon_and_wall(
 					explode_badass_weapon(Robot_info, weapon, hitpt);
 #endif
 				else
-					object_create_explosion_without_damage(Vclip, vmsegptridx(weapon->segnum), weapon->pos, Weapon_info[get_weapon_id(weapon)].impact_size, wall_hit_vclip);
+					create_cosmetic_explosion(Vclip, vmsegptridx(weapon->segnum), weapon->pos, Weapon_info[get_weapon_id(weapon)].impact_size, wall_hit_vclip);
 			}
 		}
 	}
@@ -1116,7 +1119,7 @@ static void collide_robot_and_player(const d_robot_info_array &Robot_info, const
 		if (collision_seg != segment_none)
 		{
 			auto &wi{Weapon_info[weapon_id_type::LASER_ID_L1]};
-			object_create_explosion_without_damage(Vclip, collision_seg, collision_point, wi.impact_size, wi.wall_hit_vclip);
+			create_cosmetic_explosion(Vclip, collision_seg, collision_point, wi.impact_size, wi.wall_hit_vclip);
 		}
 	}
 
@@ -2251,7 +2254,7 @@ static void collide_player_and_weapon(const d_robot_info_array &Robot_info, cons
 		multi_digi_link_sound_to_pos((player_info.powerup_flags & PLAYER_FLAGS_INVULNERABLE) ? sound_effect::SOUND_WEAPON_HIT_DOOR : sound_effect::SOUND_PLAYER_GOT_HIT, player_segp, sidenum_t::WLEFT, collision_point, 0, F1_0);
 	}
 
-	object_create_explosion_without_damage(Vclip, player_segp, collision_point, i2f(10) / 2, vclip_index::player_hit);
+	create_cosmetic_explosion(Vclip, player_segp, collision_point, i2f(10) / 2, vclip_index::player_hit);
 	if ( Weapon_info[get_weapon_id(weapon)].damage_radius )
 	{
 		const auto obj2weapon{vm_vec_build_sub(collision_point, playerobj->pos)};
@@ -2296,7 +2299,7 @@ void collide_player_and_nasty_robot(const d_robot_info_array &Robot_info, const
 {
 	const auto &&player_segp = vmsegptridx(playerobj->segnum);
 	digi_link_sound_to_pos(Robot_info[get_robot_id(robot)].claw_sound, player_segp, sidenum_t::WLEFT, collision_point, 0, F1_0);
-	object_create_explosion_without_damage(Vclip, player_segp, collision_point, i2f(10) / 2, vclip_index::player_hit);
+	create_cosmetic_explosion(Vclip, player_segp, collision_point, i2f(10) / 2, vclip_index::player_hit);
 
 	bump_two_objects(Robot_info, playerobj, robot, 0);	//no damage from bump
 
@@ -2328,7 +2331,7 @@ void collide_player_and_materialization_center(const vmobjptridx_t objp)
 {
 	const auto &&segp = vmsegptridx(objp->segnum);
 	digi_link_sound_to_pos(sound_effect::SOUND_PLAYER_GOT_HIT, segp, sidenum_t::WLEFT, objp->pos, 0, F1_0);
-	object_create_explosion_without_damage(Vclip, segp, objp->pos, i2f(10) / 2, vclip_index::player_hit);
+	create_cosmetic_explosion(Vclip, segp, objp->pos, i2f(10) / 2, vclip_index::player_hit);
 
 	if (get_player_id(objp) != Player_num)
 		return;
@@ -2618,6 +2621,7 @@ struct assert_no_truncation
 
 void collide_two_objects(const d_robot_info_array &Robot_info, vmobjptridx_t A, vmobjptridx_t B, vms_vector &collision_point)
 {
+	const frame_profile_scope profile{frame_profile_zone::collide};
 	if (B->type < A->type)
 	{
 		using std::swap;
@@ -2782,6 +2786,7 @@ window_event_result collide_object_with_wall(
 #endif
 	const d_robot_info_array &Robot_info, const vmobjptridx_t A, fix hitspeed, const vmsegptridx_t hitseg, const sidenum_t hitwall, const vms_vector &hitpt)
 {
+	const frame_profile_scope profile{frame_profile_zone::collide};
 	auto &Objects = LevelUniqueObjectState.Objects;
 
 	switch( A->type )	{
@@ -110,8 +110,10 @@ Cfg GameCfg;
 #endif
 #ifdef __ANDROID__
 #define TouchInvertYStr "TouchInvertY"
+#define AdaptivePacingStr "AdaptivePacing"
 #define DXX_DESCENT_CFG_ANDROID_BLOCK(VERB_d)	\
-	VERB_d(TouchInvertYStr, CGameCfg.TouchInvertY)
+	VERB_d(TouchInvertYStr, CGameCfg.TouchInvertY)	\
+	VERB_d(AdaptivePacingStr, CGameCfg.AdaptivePacing)
 #else
 #define DXX_DESCENT_CFG_ANDROID_BLOCK(VERB_d)
 #endif
@@ -119,6 +121,16 @@ Cfg GameCfg;
 #define MultisampleStr "Multisample"
 #define FPSIndicatorStr "FPSIndicator"
 #define GrabinputStr "GrabInput"
+#if DXX_USE_VULKAN
+#define VkPresentModeStr "VulkanPresentMode"
+#define VkFramesInFlightStr "VulkanFramesInFlight"
+#define DXX_DESCENT_CFG_VULKAN_BLOCK(VERB_d)	\
+	VERB_d(VkPresentModeStr, underlying_value(CGameCfg.VkPresentMode))	\
+	VERB_d(VkFramesInFlightStr, CGameCfg.VkFramesInFlight)	\
+
+#else
+#define DXX_DESCENT_CFG_VULKAN_BLOCK(VERB_d)
+#endif
 
 namespace {
 
@@ -163,6 +175,7 @@ namespace {
 	VERB_d(MultisampleStr, CGameCfg.Multisample)	\
 	VERB_d(FPSIndicatorStr, CGameCfg.FPSIndicator)	\
 	VERB_d(GrabinputStr, CGameCfg.Grabinput)	\
+	DXX_DESCENT_CFG_VULKAN_BLOCK(VERB_d)	\
 	DXX_DESCENT_CFG_ANDROID_BLOCK(VERB_d)	\
 
 struct descent_cfg_file_prepared_text
@@ -182,48 +195,6 @@ struct descent_cfg_file_prepared_text
 	buffer_type buf;
 };
 
-static bool cfg_file_unchanged(const descent_cfg_file_prepared_text &current_cfg_text)
-{
-	const auto &&[f, physfserr]{PHYSFSX_openReadBuffered_updateCase(dxx_descent_cfg_name)};
-	if (!f)
-	{
-		/* If the file cannot be read, assume that a new file must be written. */
-		con_printf(physfserr == PHYSFS_ERR_NOT_FOUND ? CON_VERBOSE : CON_NORMAL, "Failed to read \"" DXX_DESCENT_CFG_NAME "\": %s", PHYSFS_getErrorByCode(physfserr));
-		return false;
-	}
-	const auto existing_file_size{PHYSFS_fileLength(f)};
-	if (existing_file_size != current_cfg_text.written)
-	{
-		/* The file is of a different length, so its contents must be
-		 * different.  A new file must be written.
-		 */
-		con_printf(CON_VERBOSE, "Replacing configuration file \"" DXX_DESCENT_CFG_NAME "\" due to size mismatch: current=%" DXX_PRI_size_type "; new=%" DXX_PRI_size_type, static_cast<std::size_t>(existing_file_size), current_cfg_text.written);
-		return false;
-	}
-	descent_cfg_file_prepared_text::buffer_type previous_cfg_text;
-	if (const auto rb{PHYSFS_readBytes(f, previous_cfg_text.data(), previous_cfg_text.size())}; rb != existing_file_size)
-	{
-		/* Log this at a higher level because it is strange for the file to
-		 * change size between when `PHYSFS_fileLength` examines it and when
-		 * `PHYSFS_readBytes` reads it.
-		 */
-		con_printf(CON_NORMAL, "Replacing configuration file \"" DXX_DESCENT_CFG_NAME "\" due to read count mismatch: expected=%" DXX_PRI_size_type "; read=%" DXX_PRI_size_type, static_cast<std::size_t>(existing_file_size), static_cast<std::size_t>(rb));
-		return false;
-	}
-	const auto pcbegin{previous_cfg_text.begin()};
-	const auto pcend{std::next(pcbegin, existing_file_size)};
-	const auto ccbegin{current_cfg_text.buf.begin()};
-	const auto ccend{std::next(ccbegin, existing_file_size)};
-	/* The two ranges are of equal length, so `in1 == pcend` if and only if `in2 == ccend`. */
-	if (const auto mm{std::ranges::mismatch(pcbegin, pcend, ccbegin, ccend)}; mm.in1 != pcend)
-	{
-		con_printf(CON_VERBOSE, "Replacing configuration file \"" DXX_DESCENT_CFG_NAME "\" due to content mismatch at offset %" DXX_PRI_size_type, mm.in1 - pcbegin);
-		return false;
-	}
-	con_puts(CON_VERBOSE, "Retaining configuration file \"" DXX_DESCENT_CFG_NAME "\"");
-	return true;
-}
-
 static auto build_cfg_file_text(const CCfg &CGameCfg, const Cfg &GameCfg)
 {
 #if DXX_BUILD_DESCENT == 1
@@ -304,10 +275,16 @@ void ReadConfigFile(CCfg &CGameCfg, Cfg &GameCfg)
 	CGameCfg.Multisample = 0;
 	CGameCfg.FPSIndicator = 0;
 	CGameCfg.Grabinput = true;
+#if DXX_USE_VULKAN
+	CGameCfg.VkPresentMode = vk_present_mode::fifo;
+	CGameCfg.VkFramesInFlight = 2;
+#endif
 #ifdef __ANDROID__
 	CGameCfg.TouchInvertY = false;
+	CGameCfg.AdaptivePacing = true;
 #endif
 
+	PHYSFSX_waitForQueuedWrites();
 	auto &&[infile, physfserr]{PHYSFSX_openReadBuffered_updateCase(dxx_descent_cfg_name)};
 	if (!infile)
 	{
@@ -447,9 +424,20 @@ void ReadConfigFile(CCfg &CGameCfg, Cfg &GameCfg)
 			convert_integer(CGameCfg.FPSIndicator, value);
 		else if (compare_nonterminated_name(name, GrabinputStr))
 			convert_integer(CGameCfg.Grabinput, value);
+#if DXX_USE_VULKAN
+		else if (compare_nonterminated_name(name, VkPresentModeStr))
+		{
+			if (auto r = convert_integer<uint8_t>(value); r && *r <= underlying_value(vk_present_mode::immediate))
+				CGameCfg.VkPresentMode = vk_present_mode{*r};
+		}
+		else if (compare_nonterminated_name(name, VkFramesInFlightStr))
+			convert_integer(CGameCfg.VkFramesInFlight, value);
+#endif
 #ifdef __ANDROID__
 		else if (compare_nonterminated_name(name, TouchInvertYStr))
 			convert_integer(CGameCfg.TouchInvertY, value);
+		else if (compare_nonterminated_name(name, AdaptivePacingStr))
+			convert_integer(CGameCfg.AdaptivePacing, value);
 #endif
 	}
 
@@ -463,15 +451,10 @@ void ReadConfigFile(CCfg &CGameCfg, Cfg &GameCfg)
 int WriteConfigFile(const CCfg &CGameCfg, const Cfg &GameCfg)
 {
 	const auto current_cfg_text{build_cfg_file_text(CGameCfg, GameCfg)};
-	if (cfg_file_unchanged(current_cfg_text))
-		return 0;
-	auto &&[outfile, physfserr]{PHYSFSX_openWriteBuffered(DXX_DESCENT_CFG_NAME)};
-	if (!outfile)
-	{
-		con_printf(CON_NORMAL, "Failed to write \"" DXX_DESCENT_CFG_NAME "\": %s", PHYSFS_getErrorByCode(physfserr));
-		return 1;
-	}
-	PHYSFSX_writeBytes(outfile, current_cfg_text.buf.data(), current_cfg_text.written);
+	/* The queue skips the write if the file already has this text. */
+	PHYSFSX_write_buffer outfile;
+	outfile.write(current_cfg_text.buf.data(), current_cfg_text.written);
+	PHYSFSX_queueWrite(DXX_DESCENT_CFG_NAME, std::move(outfile));
 	return 0;
 }
 
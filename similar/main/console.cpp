@@ -17,6 +17,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <sys/time.h>
+#include <mutex>
 #include <ranges>
 #include <SDL.h>
 #include "window.h"
@@ -33,6 +34,18 @@
 #include "cli.h"
 #include "cmd.h"
 #include "cvar.h"
+#include "frame_profile.h"
+#include "load_trace.h"
+#include "mem_account.h"
+#include "rle.h"
+#include "fvi.h"
+#include "snapshot.h"
+#if DXX_USE_EDITOR
+#include "editor/editor.h"
+#endif
+#if DXX_USE_UDP
+#include "net_udp.h"
+#endif
 
 #include <array>
 
@@ -75,6 +88,10 @@ struct console_window : window
 };
 
 static RAIIPHYSFS_File gamelog_fp;
+/* Held while a line is added, since startup tasks print from their own
+ * threads.
+ */
+static std::mutex con_mutex;
 static std::array<console_buffer, CON_LINES_MAX> con_buffer;
 static con_state con_state;
 static int con_scroll_offset, con_size;
@@ -252,6 +269,7 @@ static void con_print_file(const char *const buffer)
  */
 static void con_force_puts(const con_priority priority, const std::span<char> buffer)
 {
+	const std::lock_guard lock{con_mutex};
 	con_add_buffer_line(priority, buffer);
 	con_scrub_markup(buffer);
 	/* Produce a sanitised version and send it to the console */
@@ -276,6 +294,7 @@ void con_puts(const con_priority_wrapper priority, const std::span<const char> b
 	{
 		typename con_priority_wrapper::scratch_buffer<CON_LINE_LENGTH> scratch_buffer;
 		auto &&b = priority.prepare_buffer(scratch_buffer, buffer);
+		const std::lock_guard lock{con_mutex};
 		/* add given string to con_buffer */
 		con_add_buffer_line(priority, b);
 		con_print_file(b.data());
@@ -456,6 +475,104 @@ window_event_result console_window::event_handler(const d_event &event)
 	return window_event_result::ignored;
 }
 
+static void con_cmd_rle_cache(unsigned long, const char *const *)
+{
+	const auto &stats = rle_cache_get_stats();
+	con_printf(CON_NORMAL, "RLE cache: %zu bitmaps, %zu of %u KB, %lu hits, %lu misses, %lu evictions", stats.entries, stats.bytes / 1024, CGameArg.SysRleCacheBudget, stats.hits, stats.misses, stats.evictions);
+}
+
+static void con_cmd_mem(unsigned long argc, const char *const *const argv)
+{
+	std::size_t current{}, peak{};
+	for (std::size_t t = 0; t != mem_tag_count; ++t)
+	{
+		const auto tag{static_cast<mem_tag>(t)};
+		const auto c{mem_account_get(tag)};
+		con_printf(CON_NORMAL, "%-13s %8zu KB, peak %8zu KB", mem_tag_name(tag), c.current / 1024, c.peak / 1024);
+		/* The device memory holds the textures, so it is not added again */
+		if (tag != mem_tag::vma)
+		{
+			current += c.current;
+			peak += c.peak;
+		}
+	}
+	con_printf(CON_NORMAL, "%-13s %8zu KB, sum of peaks %8zu KB", "total", current / 1024, peak / 1024);
+	if (argc > 1 && !strcmp(argv[1], "reset"))
+		mem_account_reset_peaks();
+}
+
+static void con_cmd_object_pairs(unsigned long argc, const char *const *const argv)
+{
+	auto &counts = Object_pair_counts;
+	con_printf(CON_NORMAL, "Object pairs: %lu culled, %lu tested, %lu reported", counts.culled, counts.tested, counts.reported);
+	if (argc > 1 && !strcmp(argv[1], "reset"))
+		counts = {};
+}
+
+static void con_cmd_ai_replay(unsigned long argc, const char *const *const argv)
+{
+	if (argc < 2)
+	{
+		cmd_insertf("help %s", argv[0]);
+		return;
+	}
+	const auto ticks{strtoul(argv[1], nullptr, 10)};
+	const auto seed{argc > 2 ? strtoul(argv[2], nullptr, 10) : 1ul};
+	dsx::game_replay_ticks(ticks, seed);
+}
+
+static void con_cmd_quit(unsigned long, const char *const *)
+{
+	/* Leave through the same path as closing the window */
+	SDL_Event event{};
+	event.type = SDL_QUIT;
+	SDL_PushEvent(&event);
+}
+
+#if DXX_USE_EDITOR
+static void con_cmd_genmine(unsigned long argc, const char *const *const argv)
+{
+	if (argc < 3)
+	{
+		cmd_insertf("help %s", argv[0]);
+		return;
+	}
+	if (Game_wind)
+	{
+		con_puts(CON_NORMAL, "genmine: leave the game first");
+		return;
+	}
+	const auto arg = [argc, argv](const unsigned long i, const unsigned d) {
+		return argc > i ? static_cast<unsigned>(strtoul(argv[i], nullptr, 10)) : d;
+	};
+	dsx::generate_benchmark_mine({
+		.segments = arg(1, 0),
+		.branching = arg(3, 20),
+		.doors = arg(4, 10),
+		.lights = arg(5, 30),
+		.robots = arg(6, 10),
+		.seed = arg(7, 1),
+	}, argv[2]);
+}
+#endif
+
+#if DXX_USE_UDP
+static void con_cmd_host(unsigned long argc, const char *const *const argv)
+{
+	if (argc < 2)
+	{
+		cmd_insertf("help %s", argv[0]);
+		return;
+	}
+	dsx::net_udp_host_game(argv[1], argc > 2 ? atoi(argv[2]) : 1);
+}
+
+static void con_cmd_netstats(unsigned long argc, const char *const *const argv)
+{
+	dsx::net_udp_print_stats(argc > 1 && !strcmp(argv[1], "reset"));
+}
+#endif
+
 }
 
 void con_init(void)
@@ -469,6 +586,22 @@ void con_init(void)
 	cli_init();
 	cmd_init();
 	cvar_init();
+	frame_profile_init();
+	load_trace_init();
+	cmd_addcommand("rle_cache", con_cmd_rle_cache, "rle_cache\n" "    show the use of the cache of expanded RLE bitmaps");
+	cmd_addcommand("mem", con_cmd_mem, "mem [reset]\n" "    show the memory held by textures, bitmaps, sounds, mission and demo data and the Vulkan allocator, now and at most.  With reset, start the peaks again from now");
+	cmd_addcommand("object_pairs", con_cmd_object_pairs, "object_pairs [reset]\n" "    show how many object pairs the collision checks culled, tested and reported");
+	cmd_addcommand("ai_replay", con_cmd_ai_replay, "ai_replay <ticks> [seed]\n" "    run <ticks> game ticks with a scripted player and no rendering, then show the time taken and a checksum of the result");
+	cmd_addcommand("quit", con_cmd_quit, "quit\n" "    leave the program");
+	dsx::level_snapshot_init();
+#if DXX_USE_EDITOR
+	cmd_addcommand("genmine", con_cmd_genmine, "genmine <segments> <file> [branching] [doors] [lights] [robots] [seed]\n" "    replace the mine with one of <segments> cubes grown at random and save it as <file>, with a mission holding it.  [branching] (default 20) is the percent chance to grow from any segment instead of the newest; [doors] (default 10), [lights] (default 30) and [robots] (default 10) are the percent chances of a door on each connection, a light in each segment and a robot in each segment");
+#endif
+#if DXX_USE_UDP
+	cmd_addcommand("host", con_cmd_host, "host <mission> [level]\n" "    host a multiplayer game of <mission> with the settings of the netgame profile, starting at [level] (default 1)");
+	cmd_addcommand("netstats", con_cmd_netstats, "netstats [reset]\n" "    show the network traffic of the netgame by packet type and by message type, the resends and the round trip times.  Set net_stats to 1 to log this every 30 seconds, or 2 to also draw it over the game");
+	net_udp_stats_init();
+#endif
 }
 
 }
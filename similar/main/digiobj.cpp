@@ -45,6 +45,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 #include "compiler-range_for.h"
 #include "d_levelstate.h"
+#include "slot_bitmap.h"
 #include <iterator>
 #include <utility>
 
@@ -104,9 +105,81 @@ static short next_signature=0;
 
 static int N_active_sound_objects;
 
+using sound_object_slot = uint8_t;
+constexpr sound_object_slot sound_object_slot_none{UINT8_MAX};
+static_assert(MAX_SOUND_OBJECTS < sound_object_slot_none);
+
+/* The free slots, and the used slots chained by the object or segment
+ * they are linked to, so that finding a slot never scans SoundObjects.
+ * A slot is only claimed by sound_object_link and only released by
+ * sound_object_release, which keep this in step with the flags.
+ */
+struct sound_object_index
+{
+	slot_bitmap<MAX_SOUND_OBJECTS> free;
+	/* The next slot linked to the same object or segment */
+	std::array<sound_object_slot, MAX_SOUND_OBJECTS> next;
+	std::array<sound_object_slot, MAX_OBJECTS> by_object;
+	std::array<sound_object_slot, MAX_SEGMENTS> by_segment;
+	sound_object_index()
+	{
+		clear();
+	}
+	void clear()
+	{
+		free.free_all();
+		by_object.fill(sound_object_slot_none);
+		by_segment.fill(sound_object_slot_none);
+	}
+};
+
+static sound_object_index Sound_object_index;
+
+static sound_object_slot sound_object_slot_of(const sound_object &so)
+{
+	return &so - std::as_const(SoundObjects).data();
+}
+
+static sound_object_slot &sound_object_chain(const sound_object &so)
+{
+	auto &idx = Sound_object_index;
+	return (so.flags & SOF_LINK_TO_OBJ)
+		? idx.by_object[so.link_type.obj.objnum]
+		: idx.by_segment[so.link_type.pos.segnum];
+}
+
+/* Claim a free slot whose link_type is set */
+static void sound_object_link(sound_object &so, const uint8_t link_flag)
+{
+	auto &idx = Sound_object_index;
+	const auto i{sound_object_slot_of(so)};
+	so.flags = SOF_USED | link_flag;
+	auto &head = sound_object_chain(so);
+	idx.next[i] = head;
+	head = i;
+	idx.free.set_used(i);
+}
+
+/* Mark as dead, so some other sound can use this sound */
+static void sound_object_release(sound_object &so)
+{
+	if (!so.flags)
+		return;
+	auto &idx = Sound_object_index;
+	const auto i{sound_object_slot_of(so)};
+	for (auto *p = &sound_object_chain(so); *p != sound_object_slot_none; p = &idx.next[*p])
+		if (*p == i)
+		{
+			*p = idx.next[i];
+			break;
+		}
+	so.flags = 0;
+	idx.free.set_free(i);
+}
+
 static void digi_kill_sound(sound_object &s)
 {
-	s.flags = 0;	// Mark as dead, so some other sound can use this sound
+	sound_object_release(s);
 	if (s.channel != sound_channel::None)
 	{
 		N_active_sound_objects--;
@@ -116,39 +189,30 @@ static void digi_kill_sound(sound_object &s)
 
 static std::pair<sound_objects_t::iterator, sound_objects_t::iterator> find_sound_object_flags0(sound_objects_t &SoundObjects)
 {
-	const auto eso = SoundObjects.end();
-	const auto &&i{std::ranges::find(SoundObjects.begin(), eso, 0, &sound_object::flags)};
-	return {i, eso};
+	return {std::next(SoundObjects.begin(), Sound_object_index.free.first_free()), SoundObjects.end()};
 }
 
 static std::pair<sound_objects_t::iterator, sound_objects_t::iterator> find_sound_object(sound_objects_t &SoundObjects, const unsigned soundnum, const vcobjidx_t obj, const sound_stack once)
 {
 	if (once == sound_stack::allow_stacking)
 		return find_sound_object_flags0(SoundObjects);
-	const auto eso = SoundObjects.end();
-	sound_objects_t::iterator free_sound_object = eso;
-	for (auto i = SoundObjects.begin(); i != eso; ++i)
+	auto &idx = Sound_object_index;
+	const objnum_t o = obj;
+	for (auto i = idx.by_object[o]; i != sound_object_slot_none; i = idx.next[i])
 	{
-		constexpr uint8_t used_obj = SOF_USED | SOF_LINK_TO_OBJ;
-		auto &so = *i;
-		const auto flags{so.flags};
-		if (flags == 0)
-			free_sound_object = i;
-		else if (so.soundnum == soundnum && (flags & used_obj) == used_obj)
+		auto &so = SoundObjects[i];
+		if (so.soundnum == soundnum)
 		{
 			/* No check for a signature match here.  If the signature
 			 * matches, this sound will be reclaimed to prevent
 			 * stacking.  If the signature does not match, then the old
 			 * sound is tied to a dead object and needs to be removed.
 			 */
-			if (so.link_type.obj.objnum == obj)
-			{
-				digi_kill_sound(so);
-				return {i, eso};
-			}
+			digi_kill_sound(so);
+			return {std::next(SoundObjects.begin(), i), SoundObjects.end()};
 		}
 	}
-	return {free_sound_object, eso};
+	return find_sound_object_flags0(SoundObjects);
 }
 
 }
@@ -205,7 +269,7 @@ static std::pair<int, sound_pan> digi_get_sound_loc(const vms_matrix &listener,
 		int num_search_segs = f2i(max_distance/20);
 		if ( num_search_segs < 1 ) num_search_segs = 1;
 
-		const auto path_distance = find_connected_distance(listener_pos, listener_seg, sound_pos, sound_seg, num_search_segs, wall_is_doorway_mask::fly_rendpast);
+		const auto path_distance = find_connected_distance_from(listener_pos, listener_seg, sound_pos, sound_seg, num_search_segs, wall_is_doorway_mask::fly_rendpast);
 		if ( path_distance > -1 )	{
 			const int volume = max_volume - fixdiv(path_distance,max_distance);
 			if (volume > 0)
@@ -286,6 +350,7 @@ void digi_init_sounds()
 		i.channel = sound_channel::None;
 		i.flags = 0;	// Mark as dead, so some other sound can use this sound
 	}
+	Sound_object_index.clear();
 	N_active_sound_objects = 0;
 }
 
@@ -332,7 +397,10 @@ void digi_change_looping_volume( fix volume )
 {
 	digi_looping_volume = volume;
 	if (digi_looping_channel != sound_channel::None)
+	{
 		digi_set_channel_volume( digi_looping_channel, volume );
+		digi_flush_channel_updates();
+	}
 }
 
 namespace {
@@ -419,7 +487,7 @@ static void digi_link_sound_common(const object_base &viewer, sound_object &so,
 		// just cancel it and be done with it.
 		if (so.channel == sound_channel::None && !(so.flags & SOF_PLAY_FOREVER))
 		{
-			so.flags = 0;
+			sound_object_release(so);
 			return;
 		}
 	}
@@ -438,7 +506,7 @@ void digi_link_sound_to_object3(const sound_effect org_soundnum, const vcobjptri
 
 	if (soundnum == sound_effect::None)
 		return;
-	if (!GameSounds[soundnum].data)
+	if (!piggy_sound_page_in(soundnum))
 	{
 		Int3();
 		return;
@@ -459,9 +527,9 @@ void digi_link_sound_to_object3(const sound_effect org_soundnum, const vcobjptri
 	if (f.first == f.second)
 		return;
 	auto &so = *f.first;
-	so.flags = SOF_USED | SOF_LINK_TO_OBJ;
 	so.link_type.obj.objnum = objnum;
 	so.link_type.obj.objsignature = objnum->signature;
+	sound_object_link(so, SOF_LINK_TO_OBJ);
 	so.loop_start = loop_start;
 	so.loop_end = loop_end;
 	digi_link_sound_common(viewer, so, objnum->pos, forever, max_volume, max_distance, soundnum, vcsegptridx(objnum->segnum));
@@ -490,7 +558,7 @@ static void digi_link_sound_to_pos2(const sound_effect org_soundnum, const vcseg
 
 	if (soundnum == sound_effect::None)
 		return;
-	if (!GameSounds[soundnum].data)
+	if (!piggy_sound_page_in(soundnum))
 	{
 		Int3();
 		return;
@@ -507,10 +575,10 @@ static void digi_link_sound_to_pos2(const sound_effect org_soundnum, const vcseg
 	if (f.first == f.second)
 		return;
 	auto &so = *f.first;
-	so.flags = SOF_USED | SOF_LINK_TO_POS;
 	so.link_type.pos.segnum = segnum;
 	so.link_type.pos.sidenum = sidenum;
 	so.link_type.pos.position = pos;
+	sound_object_link(so, SOF_LINK_TO_POS);
 	so.loop_start = so.loop_end = -1;
 	digi_link_sound_common(viewer, so, pos, forever, max_volume, max_distance, soundnum, segnum);
 }
@@ -527,14 +595,14 @@ void digi_kill_sound_linked_to_segment(const vmsegidx_t segnum, const sidenum_t
 {
 	if (soundnum != sound_effect::None)
 		soundnum = digi_xlat_sound(soundnum);
-	range_for (auto &i, SoundObjects)
+	auto &idx = Sound_object_index;
+	const segnum_t s = segnum;
+	for (auto n = idx.by_segment[s]; n != sound_object_slot_none;)
 	{
-		if ( (i.flags & SOF_USED) && (i.flags & SOF_LINK_TO_POS) )	{
-			if ((i.link_type.pos.segnum == segnum) && (i.link_type.pos.sidenum==sidenum) && (soundnum == sound_effect::None || i.soundnum==soundnum))
-			{
-				digi_kill_sound(i);
-			}
-		}
+		auto &i = SoundObjects[n];
+		n = idx.next[n];
+		if (i.link_type.pos.sidenum == sidenum && (soundnum == sound_effect::None || i.soundnum == soundnum))
+			digi_kill_sound(i);
 	}
 }
 
@@ -543,13 +611,13 @@ void digi_kill_sound_linked_to_object(const vcobjptridx_t objnum)
 	if ( Newdemo_state == ND_STATE_RECORDING )		{
 		newdemo_record_kill_sound_linked_to_object( objnum );
 	}
-	range_for (auto &i, SoundObjects)
+	auto &idx = Sound_object_index;
+	const objnum_t o = objnum;
+	for (auto n = idx.by_object[o]; n != sound_object_slot_none;)
 	{
-		if ( (i.flags & SOF_USED) && (i.flags & SOF_LINK_TO_OBJ ) )	{
-			if (i.link_type.obj.objnum == objnum)	{
-				digi_kill_sound(i);
-			}
-		}
+		auto &i = SoundObjects[n];
+		n = idx.next[n];
+		digi_kill_sound(i);
 	}
 }
 
@@ -604,7 +672,7 @@ void digi_sync_sounds()
 				{
 					if ( !digi_is_channel_playing(s.channel) )	{
 						digi_end_sound( s.channel );
-						s.flags = 0;	// Mark as dead, so some other sound can use this sound
+						sound_object_release(s);
 						N_active_sound_objects--;
 						continue;		// Go on to next sound...
 					}
@@ -633,7 +701,7 @@ void digi_sync_sounds()
 							digi_end_sound( s.channel );
 						N_active_sound_objects--;
 					}
-					s.flags = 0;	// Mark as dead, so some other sound can use this sound
+					sound_object_release(s);
 					continue;		// Go on to next sound...
 				} else {
 					digi_update_sound_loc(viewer->orient, viewer->pos, vcsegptridx(viewer->segnum), objp.pos, vcsegptridx(objp.segnum), s);
@@ -656,7 +724,7 @@ void digi_sync_sounds()
 					}
 
 					if (! (s.flags & SOF_PLAY_FOREVER)) {
-						s.flags = 0;	// Mark as dead, so some other sound can use this sound
+						sound_object_release(s);
 						continue;
 					}
 
@@ -677,6 +745,7 @@ void digi_sync_sounds()
 
 		}
 	}
+	digi_flush_channel_updates();
 }
 
 void digi_pause_digi_sounds()
@@ -691,7 +760,7 @@ void digi_pause_digi_sounds()
 		{
 			s.channel = sound_channel::None;
 			if (! (s.flags & SOF_PLAY_FOREVER))
-				s.flags = 0;	// Mark as dead, so some other sound can use this sound
+				sound_object_release(s);
 			N_active_sound_objects--;
 			digi_stop_sound(c);
 		}
@@ -730,7 +799,7 @@ void digi_stop_digi_sounds()
 				digi_stop_sound( s.channel );
 				N_active_sound_objects--;
 			}
-			s.flags = 0;	// Mark as dead, so some other sound can use this sound
+			sound_object_release(s);
 		}
 	}
 
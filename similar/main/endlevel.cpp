@@ -678,6 +678,7 @@ window_event_result start_endlevel_sequence()
 	if (dead)
 		return window_event_result::ignored;				//don't start if dead!
 	con_puts(CON_NORMAL, "You have escaped the mine!");
+	gameseq_prefetch_next_level();
 
 #if DXX_BUILD_DESCENT == 2
 	auto &Robot_info = LevelSharedRobotInfoState.Robot_info;
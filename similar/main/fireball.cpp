@@ -24,10 +24,12 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  */
 
 #include <algorithm>
+#include <memory>
 #include <numeric>
 #include <random>
 #include <ranges>
 #include <optional>
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -51,6 +53,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "ai.h"
 #include "weapon.h"
 #include "fireball.h"
+#include "particle.h"
 #include "collide.h"
 #include "physics.h"
 #include "laser.h"
@@ -61,6 +64,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "gameseg.h"
 #include "automap.h"
 #include "byteutil.h"
+#include "frame_profile.h"
 
 #include "compiler-range_for.h"
 #include "d_array.h"
@@ -195,6 +199,40 @@ struct connected_segment_raw_distances
 	std::optional<segnum_t> scan_segment_depths(unsigned desired_depth, std::minstd_rand &mrd) const;
 };
 
+/* The depths from the last few segments searched, shared by the callers
+ * that pick a segment some distance from a player.  A search to some
+ * depth has the same depths up to that depth as a search to any greater
+ * depth, so a kept search answers any query no deeper than itself.  The
+ * searches are dropped when any wall changes.
+ */
+struct connected_segment_distance_cache
+{
+	struct entry
+	{
+		segnum_t source;
+		connected_segment_raw_distances::segment_distance_count_type max_depth;
+		uint32_t generation;
+		std::shared_ptr<const connected_segment_raw_distances> distances;
+	};
+	std::array<entry, MAX_PLAYERS> entries;
+	unsigned next;
+};
+
+static connected_segment_distance_cache Connected_segment_distances;
+
+static std::shared_ptr<const connected_segment_raw_distances> get_connected_segment_distances(fvcsegptr &vcsegptr, fvcwallptr &vcwallptr, const connected_segment_raw_distances::segment_distance_count_type max_depth, const vcsegidx_t source)
+{
+	auto &c = Connected_segment_distances;
+	const auto generation{wall_state_generation(vcwallptr)};
+	for (auto &e : c.entries)
+		if (e.distances && e.source == source && e.generation == generation && e.max_depth >= max_depth)
+			return e.distances;
+	auto &e = c.entries[c.next];
+	c.next = (c.next + 1) % c.entries.size();
+	e = {source, max_depth, generation, std::make_shared<const connected_segment_raw_distances>(vcsegptr, vcwallptr, max_depth, source)};
+	return e.distances;
+}
+
 static void init_debris_object(object_base &debris, const object_base &parent, const submodel_index subobj_num)
 {
 	//Set polygon-object-specific data
@@ -417,6 +455,63 @@ imobjptridx_t object_create_explosion_without_damage(const d_vclip_array &Vclip,
 
 namespace {
 
+/* The center of an object can be a little outside the bounds of the
+ * segment it is linked into, as when it is pushed against a wall.  The
+ * segments are searched this much further than the explosion reaches,
+ * which is more than the radius of the largest robots.
+ */
+constexpr fix splash_damage_segment_slack{F1_0 * 20};
+
+/* The objects that an explosion at `pos` may reach within `maxdistance`,
+ * in object order.  Only the objects in the segments near enough are
+ * candidates, unless there is no segment grid to find those.
+ */
+static std::vector<objnum_t> splash_damage_candidates(fvmobjptridx &vmobjptridx, const vms_vector &pos, const fix maxdistance)
+{
+	std::vector<objnum_t> candidates;
+	std::vector<segnum_t> segments;
+	if (find_segments_near(pos, maxdistance + splash_damage_segment_slack, segments))
+	{
+		for (const auto segnum : segments)
+			range_for (const auto objp, objects_in(vmsegptr(segnum), vmobjptridx, vmsegptr))
+				candidates.emplace_back(objp);
+		std::ranges::sort(candidates);
+#ifndef NDEBUG
+		/* Every object in reach must be a candidate, or the explosion
+		 * would miss an object that the scan of all objects damaged.
+		 */
+		range_for (const auto &&objp, vmobjptridx)
+			if (objp->type != OBJ_NONE && vm_vec_dist_quick(objp->pos, pos) < maxdistance && !std::ranges::binary_search(candidates, static_cast<objnum_t>(objp)))
+				con_printf(CON_URGENT, DXX_STRINGIZE_FL(__FILE__, __LINE__, "BUG: object %hu in reach of an explosion is not in the segments found near it"), static_cast<objnum_t>(objp));
+#endif
+	}
+	else
+		range_for (const auto &&objp, vmobjptridx)
+			candidates.emplace_back(objp);
+	return candidates;
+}
+
+/* The damage of an explosion can create objects, such as the robots that
+ * a dying robot releases.  The scan of all objects also damaged those
+ * that were created in a slot after the object being damaged and before
+ * the end of the slots in use when it started.  Queue the objects created
+ * in those slots since the last call, in object order.
+ */
+static void splash_damage_queue_created(const d_level_unique_object_state &LevelUniqueObjectState, const slot_bitmap<MAX_OBJECTS> &free_at_start, slot_bitmap<MAX_OBJECTS> &free_seen, const std::size_t current, const std::size_t end, std::vector<objnum_t> &queue)
+{
+	auto &free_objects = LevelUniqueObjectState.free_objects;
+	if (free_objects == free_seen)
+		return;
+	free_seen = free_objects;
+	for (auto i = current + 1; i < end; ++i)
+		if (free_at_start.is_free(i) && !free_objects.is_free(i))
+		{
+			const auto objnum{static_cast<objnum_t>(i)};
+			if (const auto p{std::ranges::lower_bound(queue, objnum)}; p == queue.end() || *p != objnum)
+				queue.insert(p, objnum);
+		}
+}
+
 static imobjptridx_t object_create_explosion_with_damage(const d_robot_info_array &Robot_info, const d_vclip_array &Vclip, fvmobjptridx &vmobjptridx, const imobjptridx_t obj_explosion_origin, const vmsegptridx_t segnum, const vms_vector &position, const fix size, const vclip_index vclip_type, const fix maxdamage, const fix maxdistance, const fix maxforce, const icobjptridx_t parent)
 {
 	/* `obj_explosion_origin` may not be a weapon in some cases, though
@@ -434,8 +529,14 @@ static imobjptridx_t object_create_explosion_with_damage(const d_robot_info_arra
 		fix damage;
 		// -- now legal for badass explosions on a wall. Assert(obj_explosion_origin != NULL);
 
-		range_for (const auto &&obj_iter, vmobjptridx)
+		auto candidates{splash_damage_candidates(vmobjptridx, obj_fireball->pos, maxdistance)};
+		frame_profile_count(frame_profile_counter::splash_candidates, static_cast<uint32_t>(candidates.size()));
+		const std::size_t end{vmobjptridx.count()};
+		const auto free_at_start{LevelUniqueObjectState.free_objects};
+		auto free_seen{free_at_start};
+		for (std::size_t k = 0; k != candidates.size(); ++k)
 		{
+			const auto &&obj_iter = vmobjptridx(candidates[k]);
 			//	Weapons used to be affected by badass explosions, but this introduces serious problems.
 			//	When a smart bomb blows up, if one of its children goes right towards a nearby wall, it will
 			//	blow up, blowing up all the children.  So I remove it.  MK, 09/11/94
@@ -590,6 +691,7 @@ static imobjptridx_t object_create_explosion_with_damage(const d_robot_info_arra
 					}	// end if (object_to_object_visibility...
 				}	// end if (dist < maxdistance)
 			}
+			splash_damage_queue_created(LevelUniqueObjectState, free_at_start, free_seen, candidates[k], end, candidates);
 		}	// end for
 	}	// end if (maxdamage...
 	return obj_fireball;
@@ -778,7 +880,7 @@ static vmsegptridx_t choose_drop_segment(fvmsegptridx &vmsegptridx, fvcvertptr &
 	 * segment should be found before all MAX_PLAYERS instances are
 	 * constructed.
 	 */
-	per_player_array<std::unique_ptr<connected_segment_raw_distances>> distance_by_player;
+	per_player_array<std::shared_ptr<const connected_segment_raw_distances>> distance_by_player;
 	std::optional<vmsegptridx_t> fallback_drop;
 	for (const unsigned candidate_depth : xrange(std::uniform_int_distribution(net_drop_max_depth_lower + 0u, net_drop_max_depth_upper + 0u)(mrd), net_drop_min_depth, xrange_descending()))
 	{
@@ -794,7 +896,7 @@ static vmsegptridx_t choose_drop_segment(fvmsegptridx &vmsegptridx, fvcvertptr &
 				 * sufficient to cover all data required by all passes
 				 * of the loop.
 				 */
-				rdp = std::make_unique<connected_segment_raw_distances>(vcsegptr, vcwallptr, candidate_depth, plrobj.segnum);
+				rdp = get_connected_segment_distances(vcsegptr, vcwallptr, candidate_depth, plrobj.segnum);
 			auto &rd{*rdp};
 			const auto sn{rd.scan_segment_depths(candidate_depth, mrd)};
 			if (!sn)
@@ -881,7 +983,7 @@ void maybe_drop_net_powerup(powerup_type_t powerup_type, bool adjust_cap, bool r
 		if (objnum == object_none)
 			return;
 		multi_send_create_powerup(powerup_type, segnum, objnum, new_pos);
-		object_create_explosion_without_damage(Vclip, segnum, new_pos, i2f(5), vclip_index::powerup_disappearance);
+		create_cosmetic_explosion(Vclip, segnum, new_pos, i2f(5), vclip_index::powerup_disappearance);
 	}
 }
 
@@ -1706,16 +1808,13 @@ void drop_afterburner_blobs(object &obj, int count, fix size_scale, fix lifetime
 	{
 		const auto &&segnum{find_point_seg(LevelSharedSegmentState, LevelUniqueSegmentState, pos_left, objseg DXX_lighting_hack_pass_parameter)};
 	if (segnum != segment_none)
-		object_create_explosion_without_damage(Vclip, segnum, pos_left, size_scale, vclip_index::afterburner_blob);
+		create_cosmetic_explosion(Vclip, segnum, pos_left, size_scale, vclip_index::afterburner_blob);
 	}
 
 	if (count > 1) {
 		const auto &&segnum{find_point_seg(LevelSharedSegmentState, LevelUniqueSegmentState, pos_right, objseg DXX_lighting_hack_pass_parameter)};
-		if (segnum != segment_none) {
-			const auto &&blob_obj{object_create_explosion_without_damage(Vclip, segnum, pos_right, size_scale, vclip_index::afterburner_blob)};
-			if (lifetime != -1 && blob_obj != object_none)
-				blob_obj->lifeleft = lifetime;
-		}
+		if (segnum != segment_none)
+			create_cosmetic_explosion(Vclip, segnum, pos_right, size_scale, vclip_index::afterburner_blob, lifetime);
 	}
 }
 
@@ -1780,15 +1879,16 @@ vmsegidx_t choose_thief_recreation_segment(fvcsegptr &vcsegptr, fvcwallptr &vcwa
 	static constexpr std::integral_constant<connected_segment_raw_distances::segment_distance_count_type, 20> thief_max_depth{};
 	static constexpr std::integral_constant<connected_segment_raw_distances::segment_distance_count_type, thief_max_depth / 2> thief_min_depth{};
 	static_assert(thief_min_depth >= connected_segment_raw_distances::minimum_supported_max_depth);
-	const connected_segment_raw_distances rd(vcsegptr, vcwallptr, thief_max_depth, plrseg);
+	const auto &&rdp{get_connected_segment_distances(vcsegptr, vcwallptr, thief_max_depth, plrseg)};
+	auto &rd{*rdp};
 	auto mrd{std::minstd_rand(d_rand())};
 	/* connected_segment_raw_distances explicitly avoids reporting any
 	 * segment with a ->special of segment_special::controlcen, even if that
 	 * segment is in range.  Therefore, any returned segment of the
 	 * appropriate distance is usable.
 	 */
-	static_assert(rd.count_segments_at_depth.valid_index(thief_max_depth));
-	static_assert(rd.count_segments_at_depth.valid_index(thief_min_depth + 1u));
+	static_assert(decltype(rd.count_segments_at_depth)::valid_index(thief_max_depth));
+	static_assert(decltype(rd.count_segments_at_depth)::valid_index(thief_min_depth + 1u));
 	for (const unsigned candidate_depth : xrange(thief_max_depth, thief_min_depth, xrange_descending()))
 	{
 		if (const auto sn = rd.scan_segment_depths(candidate_depth, mrd))
@@ -44,6 +44,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "compiler-range_for.h"
 #include "d_levelstate.h"
 #include "segiter.h"
+#include "d_range.h"
 
 using std::min;
 
@@ -118,7 +119,7 @@ static ij_pair find_largest_normal(vms_vector t)
 
 //see if a point in inside a face by projecting into 2d
 [[nodiscard]]
-static unsigned check_point_to_face(const vms_vector &checkp, const vms_vector &norm, const unsigned facenum, const unsigned nv, const vertnum_array_list_t &vertex_list)
+static unsigned check_point_to_face(const vms_vector &checkp, const vms_vector &norm, const unsigned facenum, const unsigned nv, const std::array<vertnum_t, 6> &vertex_list)
 {
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Vertices = LevelSharedVertexState.get_vertices();
@@ -161,7 +162,7 @@ static unsigned check_point_to_face(const vms_vector &checkp, const vms_vector &
 
 //check if a sphere intersects a face
 [[nodiscard]]
-static intersection_type check_sphere_to_face(const vms_vector &pnt, const vms_vector &normal, const unsigned facenum, const unsigned nv, const fix rad, const vertnum_array_list_t &vertex_list)
+static intersection_type check_sphere_to_face(const vms_vector &pnt, const vms_vector &normal, const unsigned facenum, const unsigned nv, const fix rad, const std::array<vertnum_t, 6> &vertex_list)
 {
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Vertices = LevelSharedVertexState.get_vertices();
@@ -227,17 +228,10 @@ static std::optional<vms_vector> check_line_to_face(const vms_vector &p0, const
 	auto &Vertices = LevelSharedVertexState.get_vertices();
 	auto &s = seg.sides[side];
 	const vms_vector &norm = s.normals[facenum];
-
-	const auto &&[num_faces, vertex_list] = create_abs_vertex_lists(seg, s, side);
+	auto &vertex_list = s.face_vertices;
 
 	//use lowest point number
-	const auto vertnum{
-		(num_faces != vertex_array_side_type::quad)
-			? std::min(vertex_list[0], vertex_list[2])
-			: *std::ranges::min_element(std::span(vertex_list).first<4>())
-	};
-
-	const auto result{find_plane_line_intersection(Vertices.vcptr(vertnum), norm, p0, p1, rad)};
+	const auto result{find_plane_line_intersection(Vertices.vcptr(s.plane_vertex), norm, p0, p1, rad)};
 	/* If `hit_type == None`, then `hit_point` is undefined, because no hit
 	 * occurred.
 	 *
@@ -311,7 +305,7 @@ static std::optional<vms_vector> special_check_line_to_face(const vms_vector &p0
 
 	//calc some basic stuff
 
-	const auto &&vertex_list = create_abs_vertex_lists(seg, s, side).vertex_list;
+	auto &vertex_list = s.face_vertices;
 
 	//figure out which edge(s) to check against
 
@@ -565,6 +559,26 @@ static vm_distance_squared check_vector_to_sphere_1(vms_vector &intp,const vms_v
 //$$}
 */
 
+//	The box swept by a vector of radius rad, for rejecting objects out of
+//	its reach before the exact test against their spheres.
+struct swept_box
+{
+	vms_vector min, max;
+	swept_box(const vms_vector &p0, const vms_vector &p1) :
+		min{std::min(p0.x, p1.x), std::min(p0.y, p1.y), std::min(p0.z, p1.z)},
+		max{std::max(p0.x, p1.x), std::max(p0.y, p1.y), std::max(p0.z, p1.z)}
+	{
+	}
+	//	reach is the largest radius the vector and obj can have together
+	bool overlaps(const vms_vector &pos, const fix64 reach) const
+	{
+		const auto outside = [reach](const fix p, const fix lo, const fix hi) {
+			return fix64{p} + reach < lo || fix64{p} - reach > hi;
+		};
+		return !(outside(pos.x, min.x, max.x) || outside(pos.y, min.y, max.y) || outside(pos.z, min.z, max.z));
+	}
+};
+
 //determine if a vector intersects with an object
 //if no intersects, returns 0, else fills in intp and returns dist
 [[nodiscard]]
@@ -605,24 +619,14 @@ static fvi_hit_type fvi_sub(const fvi_query &, vms_vector &intp, segnum_t &ints,
 
 //What the hell is fvi_hit_seg for???
 
-//Find out if a vector intersects with anything.
-//Fills in hit_data, an fvi_info structure (see header file).
-//Parms:
-//  p0 & startseg 	describe the start of the vector
-//  p1 					the end of the vector
-//  rad 					the radius of the cylinder
-//  thisobjnum 		used to prevent an object with colliding with itself
-//  ingore_obj			ignore collisions with this object
-//  check_obj_flag	determines whether collisions with objects are checked
-//Returns the hit_data->hit_type
-fvi_hit_type find_vector_intersection(const fvi_query fq, const segnum_t startseg, const fix rad, fvi_info &hit_data)
-{
-	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
-	auto &Vertices = LevelSharedVertexState.get_vertices();
-	vms_vector hit_pnt;
+object_pair_counts Object_pair_counts;
 
-	icobjidx_t fvi_hit_object = object_none;	// object number of object hit in last find_vector_intersection call.
+namespace {
 
+//	If p0 is not in startseg, fill in hit_data for fvi_hit_type::BadP0
+//	and return true.
+static bool fvi_bad_start(fvcvertptr &vcvertptr, const vms_vector &p0, const segnum_t startseg, fvi_info &hit_data)
+{
 	//check to make sure start point is in seg its supposed to be in
 	//Assert(check_point_in_seg(p0,startseg,0).centermask==0);	//start point not in seg
 
@@ -630,25 +634,33 @@ fvi_hit_type find_vector_intersection(const fvi_query fq, const segnum_t startse
 	if (startseg > Highest_segment_index)
 	{
 		assert(startseg <= Highest_segment_index);
-		hit_data.hit_pnt = fq.p0;
+		hit_data.hit_pnt = p0;
 		hit_data.hit_seg = segnum_t{};
 		hit_data.hit_object = 0;
 		hit_data.hit_side = side_none;
 		hit_data.hit_side_seg = segment_none;
-		return fvi_hit_type::BadP0;
+		return true;
 	}
 
-	auto &vcvertptr = Vertices.vcptr;
 	// Viewer is not in segment as claimed, so say there is no hit.
-	if (get_seg_masks(vcvertptr, fq.p0, vcsegptr(startseg), 0).centermask != sidemask_t{})
+	if (get_seg_masks(vcvertptr, p0, vcsegptr(startseg), 0).centermask != sidemask_t{})
 	{
-		hit_data.hit_pnt = fq.p0;
+		hit_data.hit_pnt = p0;
 		hit_data.hit_seg = startseg;
 		hit_data.hit_side = side_none;
 		hit_data.hit_object = 0;
 		hit_data.hit_side_seg = segment_none;
-		return fvi_hit_type::BadP0;
+		return true;
 	}
+	return false;
+}
+
+//	The rest of find_vector_intersection, once fvi_bad_start has passed.
+static fvi_hit_type fvi_from_start(fvcvertptr &vcvertptr, const fvi_query &fq, const segnum_t startseg, const fix rad, fvi_info &hit_data)
+{
+	vms_vector hit_pnt;
+
+	icobjidx_t fvi_hit_object = object_none;	// object number of object hit in last find_vector_intersection call.
 
 	fvi_segments_visited_t visited;
 	visited[startseg] = true;
@@ -756,6 +768,60 @@ fvi_hit_type find_vector_intersection(const fvi_query fq, const segnum_t startse
 	return hit_type;
 }
 
+}
+
+//Find out if a vector intersects with anything.
+//Fills in hit_data, an fvi_info structure (see header file).
+//Parms:
+//  p0 & startseg 	describe the start of the vector
+//  p1 					the end of the vector
+//  rad 					the radius of the cylinder
+//  thisobjnum 		used to prevent an object with colliding with itself
+//  ingore_obj			ignore collisions with this object
+//  check_obj_flag	determines whether collisions with objects are checked
+//Returns the hit_data->hit_type
+fvi_hit_type find_vector_intersection(const fvi_query fq, const segnum_t startseg, const fix rad, fvi_info &hit_data)
+{
+	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
+	auto &vcvertptr = LevelSharedVertexState.get_vertices().vcptr;
+	if (fvi_bad_start(vcvertptr, fq.p0, startseg, hit_data))
+		return fvi_hit_type::BadP0;
+	return fvi_from_start(vcvertptr, fq, startseg, rad, hit_data);
+}
+
+void find_vector_intersections(const fvi_query &fq, const segnum_t startseg, const fix rad, const std::span<const vms_vector> ends, const std::span<fvi_hit_type> fates, const std::span<fvi_info> hit_data)
+{
+	assert(fates.size() == ends.size());
+	assert(hit_data.empty() || hit_data.size() == ends.size());
+	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
+	auto &vcvertptr = LevelSharedVertexState.get_vertices().vcptr;
+	fvi_info scratch;
+	const auto result = [&](const std::size_t i) -> fvi_info & {
+		return hit_data.empty() ? scratch : hit_data[i];
+	};
+	if (ends.empty())
+		return;
+	if (fvi_bad_start(vcvertptr, fq.p0, startseg, result(0)))
+	{
+		for (const std::size_t i : xrange(ends.size()))
+		{
+			fates[i] = fvi_hit_type::BadP0;
+			result(i) = result(0);
+		}
+		return;
+	}
+	for (const std::size_t i : xrange(ends.size()))
+		fates[i] = fvi_from_start(vcvertptr, fvi_query{
+			fq.p0,
+			ends[i],
+			fq.ignore_obj_list,
+			fq.LevelUniqueObjectState,
+			fq.Robot_info,
+			fq.flags,
+			fq.thisobjnum,
+		}, startseg, rad, result(i));
+}
+
 namespace {
 
 static int check_trans_wall(const vms_vector &pnt, vcsegptridx_t seg, sidenum_t sidenum, int facenum);
@@ -808,10 +874,21 @@ static fvi_hit_type fvi_sub(const fvi_query &fq, vms_vector &intp, segnum_t &int
 			? &(assert(Robot_info != nullptr), (*Robot_info)[get_robot_id(thisobjnum)])
 			: nullptr
 		};
-		range_for (const auto objnum, objects_in(*startseg, vcobjptridx, vcsegptr))
+		const swept_box path{fq.p0, fq.p1};
+		auto &counts = Object_pair_counts;
+		for (const objnum_t i : Segment_object_index.in(startseg))
 		{
+			const auto &&objnum = vcobjptridx(i);
 			if (thisobjnum == objnum)
 				continue;
+			/* The radii below only shrink rad and objnum->size, so an
+			 * object outside this box cannot be hit.
+			 */
+			if (!path.overlaps(objnum->pos, fix64{rad} + objnum->size))
+			{
+				++counts.culled;
+				continue;
+			}
 			if (objnum->flags & OF_SHOULD_BE_DEAD)
 				continue;
 			if (collision[objnum->type] == collision_result::ignore)
@@ -859,6 +936,7 @@ static fvi_hit_type fvi_sub(const fvi_query &fq, vms_vector &intp, segnum_t &int
 				fudged_rad = rad/2;	//(rad*3)/4;
 
 			vms_vector hit_point;
+			++counts.tested;
 			const auto &&d = check_vector_to_object(Robot_info, hit_point, fq.p0, fq.p1, fudged_rad, objnum, thisobjnum);
 			if (d != vm_distance_squared{0})          //we have intersection
 				if (d < closest_d) {
@@ -1232,11 +1310,10 @@ static sphere_intersects_wall_result sphere_intersects_wall(fvcsegptridx &vcsegp
 				if (facemask & bit) {            //on the back of this face
 					//did we go through this wall/door?
 					auto &sidep = sseg.sides[side];
-					const auto &&[num_faces, vertex_list] = create_abs_vertex_lists(sseg, sidep, side);
 
 					//in what way did we hit the face?
 					const auto face_hit_type = check_sphere_to_face(pnt, sidep.normals[face],
-										face, ((num_faces == vertex_array_side_type::quad) ? 4 : 3), rad, vertex_list);
+										face, get_side_is_quad(sidep) ? 4 : 3, rad, sidep.face_vertices);
 
 					if (face_hit_type != intersection_type::None)
 					{            //through this wall/door
@@ -28,7 +28,24 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include <SDL.h>
 #include <ctime>
 #if DXX_USE_SCREENSHOT_FORMAT_PNG
@@ -68,6 +85,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "digi.h"
 #include "u_mem.h"
 #include "palette.h"
+#include "paging.h"
 #include "morph.h"
 #include "lighting.h"
 #include "newdemo.h"
@@ -80,6 +98,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "text.h"
 #include "powerup.h"
 #include "fireball.h"
+#include "frame_profile.h"
 #include "newmenu.h"
 #include "gamefont.h"
 #include "endlevel.h"
@@ -93,12 +112,18 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "cntrlcen.h"
 #include "pcx.h"
 #include "state.h"
+#include "snapshot.h"
 #include "piggy.h"
 #include "ai.h"
 #include "robot.h"
 #include "playsave.h"
 #include "maths.h"
 #include "hudmsg.h"
+#include "physfsx.h"
+#include "input_latency.h"
+#ifdef __ANDROID__
+#include "touch.h"
+#endif
 #if DXX_BUILD_DESCENT == 2
 #include <climits>
 #include "gamepal.h"
@@ -169,7 +194,6 @@ static void powerup_grab_cheat_all();
 #if DXX_BUILD_DESCENT == 2
 d_flickering_light_state Flickering_light_state;
 namespace {
-static void slide_textures(void);
 static void flicker_lights(const d_level_shared_destructible_light_state &LevelSharedDestructibleLightState, d_flickering_light_state &fls, fvmsegptridx &vmsegptridx);
 }
 #endif
@@ -643,9 +667,21 @@ void calc_frame_time()
 {
 	fix last_frametime = FrameTime;
 
-	const auto vsync{CGameCfg.VSync};
-	const auto bound = f1_0 / (likely(vsync) ? MAXIMUM_FPS : CGameArg.SysMaxFPS);
-	const auto may_sleep = !CGameArg.SysNoNiceFPS && !vsync;
+	/* A headless game has no display to wait for */
+	const auto vsync{CGameCfg.VSync && !CGameArg.SysHeadless};
+#ifdef __ANDROID__
+	const fix requested_bound = f1_0 / (likely(vsync) ? MAXIMUM_FPS : CGameArg.SysMaxFPS);
+	/* A time demo draws its frames as fast as it can */
+	const auto bound = Newdemo_timedemo ? fix{} : timer_paced_frame_bound(requested_bound, timer_update() - last_timer_value);
+	/* When pacing lowers the rate below the refresh rate, vsync alone no
+	 * longer bounds the wait, so sleep through it.
+	 */
+	const auto may_sleep = !CGameArg.SysNoNiceFPS && !Newdemo_timedemo && (!vsync || bound > requested_bound);
+#else
+	/* A time demo draws its frames as fast as it can */
+	const auto bound = Newdemo_timedemo ? fix{} : f1_0 / (likely(vsync) ? MAXIMUM_FPS : CGameArg.SysMaxFPS);
+	const auto may_sleep = !CGameArg.SysNoNiceFPS && !Newdemo_timedemo && !vsync;
+#endif
 	const auto multiplayer{+(Game_mode & GM_MULTI)};
 	for (;;)
 	{
@@ -654,6 +690,8 @@ void calc_frame_time()
 		if (FrameTime > 0 && timer_value - sync_timer_value >= bound)
 		{
 			last_timer_value = timer_value;
+			if (bound)
+				timer_record_frame_lateness(timer_value - sync_timer_value - bound);
 
 			sync_timer_value += bound;
 			if (sync_timer_value + bound < timer_value) {
@@ -664,7 +702,18 @@ void calc_frame_time()
 		if (multiplayer)
 			multi_do_frame(); // during long wait, keep packets flowing
 		if (may_sleep)
-			timer_delay_ms(1);
+#ifdef __ANDROID__
+			/* Sleep through most of the remaining interval at once instead of
+			 * waking every millisecond, which keeps the CPU in a low power
+			 * state longer.  Multiplayer still polls to keep packets flowing.
+			 */
+			timer_delay_ms(multiplayer ? 1 : static_cast<unsigned>(std::max<fix64>(1, (((bound - (timer_value - sync_timer_value)) * 1000) >> 16) - 1)));
+#else
+			/* Sleep most of the way, and spin to the deadline.
+			 * Multiplayer still polls to keep packets flowing.
+			 */
+			timer_wait_toward(sync_timer_value + bound, multiplayer ? 1 : UINT_MAX);
+#endif
 	}
 
 	if ( cheats.turbo )
@@ -707,6 +756,141 @@ namespace dcx {
 
 namespace {
 
+#if DXX_USE_SCREENSHOT
+/* What a screenshot records of the game besides the picture.  It is
+ * taken when the screenshot is, since the file is written later, on
+ * another thread.
+ */
+struct screenshot_metadata
+{
+	std::optional<struct tm> time;
+	bool have_mission;
+	std::string mission_path;
+	std::string mission_name;
+	int level_number;
+	std::optional<unsigned> viewer_segment;
+};
+
+/* Screenshots are encoded, and captured frames written, on a thread of
+ * their own, so that the game does not wait for libpng or for the
+ * storage.  Encoded screenshots are handed back to be queued with
+ * PHYSFSX_queueWrite, and their errors reported, on the main thread,
+ * which owns the console.
+ */
+class screenshot_worker
+{
+public:
+	struct result
+	{
+		std::string filename;
+		PHYSFSX_write_buffer contents;
+		std::string error;
+	};
+private:
+	std::mutex m;
+	std::condition_variable wake, idle;
+	std::deque<std::function<void()>> pending;
+	std::vector<result> finished;
+	std::thread thread;
+	bool stop{}, busy{};
+	void worker_main();
+public:
+	~screenshot_worker();
+	/* Queue `job`, unless `limit` jobs are already waiting */
+	bool push(std::function<void()> &&job, std::size_t limit = SIZE_MAX);
+	/* Called by a job to hand back its file */
+	void finish(result &&r);
+	/* Take every file handed back since the last call */
+	std::vector<result> collect();
+	/* Return once every queued job is done */
+	void wait();
+};
+
+screenshot_worker::~screenshot_worker()
+{
+	if (!thread.joinable())
+		return;
+	{
+		const std::lock_guard lock(m);
+		stop = true;
+	}
+	wake.notify_one();
+	thread.join();
+}
+
+void screenshot_worker::worker_main()
+{
+	std::unique_lock lock(m);
+	for (;;)
+	{
+		wake.wait(lock, [this] { return stop || !pending.empty(); });
+		if (pending.empty())
+			return;
+		auto job{std::move(pending.front())};
+		pending.pop_front();
+		busy = true;
+		lock.unlock();
+		job();
+		/* Release what the job holds, such as the capture file, before
+		 * anyone waiting is told that it is done
+		 */
+		job = nullptr;
+		lock.lock();
+		busy = false;
+		if (pending.empty())
+			idle.notify_all();
+	}
+}
+
+bool screenshot_worker::push(std::function<void()> &&job, const std::size_t limit)
+{
+	{
+		const std::lock_guard lock(m);
+		if (pending.size() >= limit)
+			return false;
+		pending.emplace_back(std::move(job));
+		if (!thread.joinable())
+			thread = std::thread(&screenshot_worker::worker_main, this);
+	}
+	wake.notify_one();
+	return true;
+}
+
+void screenshot_worker::finish(result &&r)
+{
+	const std::lock_guard lock(m);
+	finished.emplace_back(std::move(r));
+}
+
+std::vector<screenshot_worker::result> screenshot_worker::collect()
+{
+	const std::lock_guard lock(m);
+	return std::exchange(finished, {});
+}
+
+void screenshot_worker::wait()
+{
+	std::unique_lock lock(m);
+	idle.wait(lock, [this] { return !busy && pending.empty(); });
+}
+
+screenshot_worker &get_screenshot_worker()
+{
+	static screenshot_worker worker;
+	return worker;
+}
+
+void queue_finished_screenshots()
+{
+	for (auto &r : get_screenshot_worker().collect())
+	{
+		if (r.error.empty())
+			PHYSFSX_queueWrite(r.filename.c_str(), std::move(r.contents));
+		else
+			con_printf(CON_URGENT, "Cannot save screenshot \"%s\": %s", r.filename.c_str(), r.error.c_str());
+	}
+}
+
 #if DXX_USE_SCREENSHOT_FORMAT_PNG
 struct RAIIpng_struct
 {
@@ -725,6 +909,10 @@ struct RAIIpng_struct
 struct d_screenshot : RAIIpng_struct
 {
 	using RAIIpng_struct::RAIIpng_struct;
+	/* The first error or warning from libpng, kept for the main thread
+	 * to report
+	 */
+	std::string message;
 	/* error handling callbacks */
 	[[noreturn]]
 	static void png_error_cb(png_struct *png, const char *str);
@@ -743,21 +931,21 @@ void d_screenshot::png_error_cb(png_struct *const png, const char *const str)
 	 * will abort the program if this requirement is violated.  However,
 	 * throwing an exception that unwinds out past libpng is permitted.
 	 */
-	(void)png;
-	con_printf(CON_URGENT, "libpng error: %s", str);
+	static_cast<d_screenshot *>(png_get_error_ptr(png))->message = str;
 	throw png_exception();
 }
 
 void d_screenshot::png_warn_cb(png_struct *const png, const char *const str)
 {
-	(void)png;
-	con_printf(CON_URGENT, "libpng warning: %s", str);
+	auto &message = static_cast<d_screenshot *>(png_get_error_ptr(png))->message;
+	if (message.empty())
+		message = str;
 }
 
 void d_screenshot::png_write_cb(png_struct *const png, uint8_t *const buf, const png_size_t size)
 {
-	const auto file = reinterpret_cast<PHYSFS_File *>(png_get_io_ptr(png));
-	PHYSFSX_writeBytes(file, buf, size);
+	const auto file = reinterpret_cast<PHYSFSX_write_buffer *>(png_get_io_ptr(png));
+	file->write(buf, size);
 }
 
 void d_screenshot::png_flush_cb(png_struct *const png)
@@ -777,20 +965,20 @@ void record_screenshot_time(const struct tm &tm, png_struct *const png_ptr, png_
 	pt.second = tm.tm_sec;
 	png_set_tIME(png_ptr, info_ptr, &pt);
 #else
+	(void)tm;
 	(void)png_ptr;
 	(void)info_ptr;
-	con_printf(CON_NORMAL, "libpng configured without support for time chunk: screenshot will lack time record.");
 #endif
 }
 
 #ifdef PNG_TEXT_SUPPORTED
-void record_screenshot_text_metadata(png_struct *const png_ptr, png_info *const info_ptr)
+void record_screenshot_text_metadata(png_struct *const png_ptr, png_info *const info_ptr, const screenshot_metadata &md)
 {
 	std::array<png_text, 6> text_fields{};
 	char descent_version[80];
 	char descent_build_datetime[21];
 	std::string current_mission_path;
-	ntstring<MISSION_NAME_LEN> current_mission_name;
+	std::string current_mission_name;
 	char current_level_number[4];
 	char viewer_segment[sizeof("65536")];
 	unsigned idx{0};
@@ -818,19 +1006,19 @@ void record_screenshot_text_metadata(png_struct *const png_ptr, png_info *const
 	char key_current_mission_name[] = "Rebirth.mission.textname";
 	char key_viewer_segment[] = "Rebirth.viewer_segment";
 	char key_current_level_number[] = "Rebirth.current_level_number";
-	if (const auto current_mission = Current_mission.get())
+	if (md.have_mission)
 	{
 		{
 			auto &t = text_fields[idx++];
 			t.key = key_current_mission_path;
-			current_mission_path = current_mission->path;
+			current_mission_path = md.mission_path;
 			t.text = current_mission_path.data();
 			t.compression = PNG_TEXT_COMPRESSION_NONE;
 		}
 		{
 			auto &t = text_fields[idx++];
 			t.key = key_current_mission_name;
-			current_mission_name = current_mission->mission_name;
+			current_mission_name = md.mission_name;
 			t.text = current_mission_name.data();
 			t.compression = PNG_TEXT_COMPRESSION_NONE;
 		}
@@ -839,42 +1027,32 @@ void record_screenshot_text_metadata(png_struct *const png_ptr, png_info *const
 			t.key = key_current_level_number;
 			t.text = current_level_number;
 			t.compression = PNG_TEXT_COMPRESSION_NONE;
-			snprintf(current_level_number, sizeof(current_level_number), "%i", Current_level_num);
+			snprintf(current_level_number, sizeof(current_level_number), "%i", md.level_number);
 		}
-		if (const auto viewer = Viewer)
+		if (md.viewer_segment)
 		{
 			auto &t = text_fields[idx++];
 			t.key = key_viewer_segment;
 			t.text = viewer_segment;
 			t.compression = PNG_TEXT_COMPRESSION_NONE;
-			snprintf(viewer_segment, sizeof(viewer_segment), "%hu", viewer->segnum);
+			snprintf(viewer_segment, sizeof(viewer_segment), "%u", *md.viewer_segment);
 		}
 	}
 	png_set_text(png_ptr, info_ptr, text_fields.data(), idx);
 }
 #endif
 
-#if DXX_USE_OGL
-#define write_screenshot_png(F,T,B,P)	write_screenshot_png(F,T,B)
-#endif
-unsigned write_screenshot_png(PHYSFS_File *const file, const struct tm *const tm, const grs_bitmap &bitmap, const palette_array_t &pal)
+/* Encode the `w` by `h` image at `pixels` as a PNG.  The pixels are RGB
+ * triples, or indices into `pal` if it is given.  On failure, r.error
+ * is set and r.contents is incomplete.
+ */
+void write_screenshot_png(screenshot_worker::result &r, const screenshot_metadata &md, const unsigned w, const unsigned h, const bool bottom_up, uint8_t *const begin_byte_buffer, const palette_array_t *const pal)
 {
-	const unsigned bm_w = ((bitmap.bm_w + 3) & ~3);
-	const unsigned bm_h = ((bitmap.bm_h + 3) & ~3);
-#if DXX_USE_OGL
-	const unsigned bufsize = bm_w * bm_h * 3;
-	const auto buf = std::make_unique<uint8_t[]>(bufsize);
-	const auto begin_byte_buffer = buf.get();
-	glReadPixels(0, 0, bm_w, bm_h, GL_RGB, GL_UNSIGNED_BYTE, begin_byte_buffer);
-#else
-	const unsigned bufsize = bitmap.bm_rowsize * bm_h;
-	const auto begin_byte_buffer = bitmap.bm_mdata;
-#endif
 	d_screenshot ss(png_create_write_struct(PNG_LIBPNG_VER_STRING, &ss, &d_screenshot::png_error_cb, &d_screenshot::png_warn_cb));
 	if (!ss.png_ptr)
 	{
-		con_puts(CON_URGENT, "Cannot save screenshot: libpng png_create_write_struct failed");
-		return 1;
+		r.error = "libpng png_create_write_struct failed";
+		return;
 	}
 	/* Assert that Rebirth type rgb_t is layout compatible with
 	 * libpng type png_color, so that the Rebirth palette_array_t
@@ -888,46 +1066,41 @@ unsigned write_screenshot_png(PHYSFS_File *const file, const struct tm *const tm
 	static_assert(offsetof(png_color, blue) == offsetof(rgb_t, b), "blue offsetof mismatch");
 	try {
 		ss.info_ptr = png_create_info_struct(ss.png_ptr);
-		if (tm)
-			record_screenshot_time(*tm, ss.png_ptr, ss.info_ptr);
-		png_set_write_fn(ss.png_ptr, file, &d_screenshot::png_write_cb, &d_screenshot::png_flush_cb);
-#if DXX_USE_OGL
-		const auto color_type{PNG_COLOR_TYPE_RGB};
-#else
-		png_set_PLTE(ss.png_ptr, ss.info_ptr, reinterpret_cast<const png_color *>(pal.data()), pal.size());
-		const auto color_type{PNG_COLOR_TYPE_PALETTE};
-#endif
-		png_set_IHDR(ss.png_ptr, ss.info_ptr, bm_w, bm_h, 8 /* always 256 colors */, color_type, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+		if (md.time)
+			record_screenshot_time(*md.time, ss.png_ptr, ss.info_ptr);
+		png_set_write_fn(ss.png_ptr, &r.contents, &d_screenshot::png_write_cb, &d_screenshot::png_flush_cb);
+		int color_type;
+		/* With palette, written data is byte-sized indices into a color
+		 * table.  Without, it is 3-byte-sized RGB tuples of color.
+		 */
+		uint_fast32_t stride;
+		if (pal)
+		{
+			png_set_PLTE(ss.png_ptr, ss.info_ptr, reinterpret_cast<const png_color *>(pal->data()), pal->size());
+			color_type = PNG_COLOR_TYPE_PALETTE;
+			stride = w;
+		}
+		else
+		{
+			color_type = PNG_COLOR_TYPE_RGB;
+			stride = w * 3;
+		}
+		png_set_IHDR(ss.png_ptr, ss.info_ptr, w, h, 8 /* always 256 colors */, color_type, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
 #ifdef PNG_TEXT_SUPPORTED
-		record_screenshot_text_metadata(ss.png_ptr, ss.info_ptr);
+		record_screenshot_text_metadata(ss.png_ptr, ss.info_ptr, md);
 #endif
 		png_write_info(ss.png_ptr, ss.info_ptr);
+		r.contents.contents.reserve(stride * h / 2);
 		std::array<png_byte *, 1024> row_pointers;
 		const auto rpb = row_pointers.begin();
 		auto o = rpb;
-		const auto end_byte_buffer = begin_byte_buffer + bufsize;
-#if DXX_USE_OGL
-		/* OpenGL glReadPixels returns an image with origin in bottom
-		 * left.  Write rows from end back to beginning, since PNG
-		 * expects origin in top left.  If rows were written in memory
-		 * order, the image would be vertically flipped.
-		 */
-		const uint_fast32_t stride = bm_w * 3;	/* Without palette, written data is 3-byte-sized RGB tuples of color */
-		for (auto p = end_byte_buffer; p != begin_byte_buffer;)
-#else
-		const uint_fast32_t stride = bm_w;	/* With palette, written data is byte-sized indices into a color table */
-		/* SDL canvas uses an image with origin in top left.  Write rows
-		 * in memory order, since this matches the PNG layout.
-		 */
-		for (auto p = begin_byte_buffer; p != end_byte_buffer;)
-#endif
+		for (unsigned y = 0; y != h; ++y)
 		{
-#if DXX_USE_OGL
-			p -= stride;
-#else
-			p += stride;
-#endif
-			*o++ = p;
+			/* PNG expects origin in top left.  An image with origin in
+			 * bottom left is written from its last row back to its
+			 * first, or else it would be vertically flipped.
+			 */
+			*o++ = begin_byte_buffer + stride * (bottom_up ? h - 1 - y : y);
 			if (o == row_pointers.end())
 			{
 				/* Internal capacity exhausted.  Flush rows and rewind
@@ -941,55 +1114,83 @@ unsigned write_screenshot_png(PHYSFS_File *const file, const struct tm *const tm
 		if (const auto len = o - rpb)
 			png_write_rows(ss.png_ptr, rpb, len);
 		png_write_end(ss.png_ptr, ss.info_ptr);
-		return 0;
 	} catch (const d_screenshot::png_exception &) {
 		/* Destructor unwind will handle the exception.  This catch is
 		 * only required to prevent further propagation.
-		 *
-		 * Return nonzero to instruct the caller to delete the failed
-		 * file.
 		 */
-		return 1;
+		r.error = ss.message.empty() ? std::string("libpng error") : std::move(ss.message);
 	}
 }
-#endif
-
-}
-
-#if DXX_USE_SCREENSHOT
-void save_screen_shot(int automap_flag)
+#elif DXX_USE_SCREENSHOT_FORMAT_LEGACY && DXX_USE_OGL
+/* Encode the `w` by `h` RGB image at `rgb` as an uncompressed TGA */
+void write_screenshot_tga(PHYSFSX_write_buffer &out, const unsigned w, const unsigned h, const bool bottom_up, const uint8_t *const rgb)
 {
-#if DXX_USE_OGL
-	if (!CGameArg.DbgGlReadPixelsOk)
+	/* No image ID and no color map, then the image type: uncompressed
+	 * true color
+	 */
+	out.writeU8(0);
+	out.writeU8(0);
+	out.writeU8(2);
+	/* Color map specification and image origin */
+	out.skip(9);
+	out.writeULE16(w);
+	out.writeULE16(h);
+	out.writeU8(24);
+	/* Rows are stored from the bottom of the image up */
+	out.writeU8(0);
+	const std::size_t stride{std::size_t{w} * 3};
+	out.contents.reserve(out.contents.size() + stride * h);
+	for (unsigned y = 0; y != h; ++y)
 	{
-		if (!automap_flag)
-			HUD_init_message_literal(HM_DEFAULT, "glReadPixels not supported on your configuration");
-		return;
+		const auto row{rgb + stride * (bottom_up ? y : h - 1 - y)};
+		/* TGA stores blue, green, red */
+		for (unsigned x = 0; x != w; ++x)
+		{
+			out.writeU8(row[x * 3 + 2]);
+			out.writeU8(row[x * 3 + 1]);
+			out.writeU8(row[x * 3]);
+		}
 	}
+}
 #endif
-#if DXX_USE_SCREENSHOT_FORMAT_PNG
-#define DXX_SCREENSHOT_FILE_EXTENSION	"png"
-#elif DXX_USE_SCREENSHOT_FORMAT_LEGACY
+
 #if DXX_USE_OGL
-#define DXX_SCREENSHOT_FILE_EXTENSION	"tga"
-#else
-#define DXX_SCREENSHOT_FILE_EXTENSION	"pcx"
-#endif
+/* A raw rgb24 file that every frame shown is appended to, while frame
+ * capture runs.  The queued frames share it, so the file is closed when
+ * capture has stopped and the last of them is written.
+ */
+struct frame_capture
+{
+	RAIIPHYSFS_File file;
+	unsigned w, h;
+	std::atomic<unsigned> written, dropped;
+	std::atomic<bool> failed;
+};
+
+static std::shared_ptr<frame_capture> Frame_capture;
+
+/* Frames queued beyond this are dropped, rather than let them take all
+ * the memory when the storage cannot keep up
+ */
+constexpr std::size_t max_queued_capture_frames{8};
 #endif
 
+/* Choose a name in the screenshot directory, for a file made at `tm`
+ * with extension `ext`, that neither exists nor is already taken by a
+ * file still being written.
+ */
+std::string choose_screenshot_name(const struct tm *const tm, const char *const ext)
+{
 	if (!PHYSFS_exists(SCRNS_DIR))
 		PHYSFS_mkdir(SCRNS_DIR); //try making directory
 
-	pause_game_world_time p;
 	unsigned tm_sec;
 	unsigned tm_min;
 	unsigned tm_hour;
 	unsigned tm_mday;
 	unsigned tm_mon;
 	unsigned tm_year;
-	const auto t = time(nullptr);
-	struct tm *tm = nullptr;
-	if (t == static_cast<time_t>(-1) || !(tm = gmtime(&t)))
+	if (!tm)
 		tm_year = tm_mon = tm_mday = tm_hour = tm_min = tm_sec = 0;
 	else
 	{
@@ -1011,37 +1212,101 @@ void save_screen_shot(int automap_flag)
 	 * (unless the clock is frozen or returns invalid times).
 	 */
 	char savename[sizeof(SCRNS_DIR) + sizeof("2000-01-01.00-00-00.NN.ext")];
-	snprintf(savename, sizeof(savename), DXX_SCREENSHOT_TIME_FORMAT_STRING "." DXX_SCREENSHOT_FILE_EXTENSION, DXX_SCREENSHOT_TIME_FORMAT_VALUES);
-	for (unsigned savenum = 0; PHYSFS_exists(savename) && savenum != 100; ++savenum)
+	snprintf(savename, sizeof(savename), DXX_SCREENSHOT_TIME_FORMAT_STRING ".%s", DXX_SCREENSHOT_TIME_FORMAT_VALUES, ext);
+	/* A file still queued for writing does not exist yet, so remember
+	 * the names chosen this second as well.
+	 */
+	static std::string taken_second;
+	static std::vector<std::string> taken;
+	if (const std::string_view second{savename, sizeof(SCRNS_DIR) - 1 + sizeof("2000-01-01.00-00-00") - 1}; second != taken_second)
+	{
+		taken_second = second;
+		taken.clear();
+	}
+	for (unsigned savenum = 0; (PHYSFS_exists(savename) || std::ranges::find(taken, std::string_view{savename}) != taken.end()) && savenum != 100; ++savenum)
 	{
-		snprintf(savename, sizeof(savename), DXX_SCREENSHOT_TIME_FORMAT_STRING ".%02u." DXX_SCREENSHOT_FILE_EXTENSION, DXX_SCREENSHOT_TIME_FORMAT_VALUES, savenum);
+		snprintf(savename, sizeof(savename), DXX_SCREENSHOT_TIME_FORMAT_STRING ".%02u.%s", DXX_SCREENSHOT_TIME_FORMAT_VALUES, savenum, ext);
 #undef DXX_SCREENSHOT_TIME_FORMAT_VALUES
 #undef DXX_SCREENSHOT_TIME_FORMAT_STRING
-#undef DXX_SCREENSHOT_FILE_EXTENSION
 	}
-	if (const auto &&[file, physfserr] = PHYSFSX_openWriteBuffered(savename); file)
-	{
-	if (!automap_flag)
-		HUD_init_message(HM_DEFAULT, "%s '%s'", TXT_DUMPING_SCREEN, &savename[sizeof(SCRNS_DIR) - 1]);
+	return taken.emplace_back(savename);
+}
+
+#if DXX_USE_OGL
+/* Encode a screen read, on the screenshot thread */
+void encode_screenshot(screenshot_worker::result &r, const screenshot_metadata &md, ogl_screen_image &image)
+{
+#if DXX_USE_SCREENSHOT_FORMAT_PNG
+	write_screenshot_png(r, md, image.w, image.h, image.bottom_up, image.rgb.data(), nullptr);
+#elif DXX_USE_SCREENSHOT_FORMAT_LEGACY
+	(void)md;
+	write_screenshot_tga(r.contents, image.w, image.h, image.bottom_up, image.rgb.data());
+#endif
+}
+#endif
+#endif
 
+}
+
+#if DXX_USE_SCREENSHOT
+void save_screen_shot(int automap_flag)
+{
 #if DXX_USE_OGL
-#if !DXX_USE_OGLES
-	glReadBuffer(GL_FRONT);
+	if (!CGameArg.DbgGlReadPixelsOk)
+	{
+		if (!automap_flag)
+			HUD_init_message_literal(HM_DEFAULT, "glReadPixels not supported on your configuration");
+		return;
+	}
 #endif
 #if DXX_USE_SCREENSHOT_FORMAT_PNG
-	auto write_error = write_screenshot_png(file, tm, grd_curscreen->sc_canvas.cv_bitmap, void /* unused */);
+#define DXX_SCREENSHOT_FILE_EXTENSION	"png"
 #elif DXX_USE_SCREENSHOT_FORMAT_LEGACY
-	write_bmp(file, grd_curscreen->get_screen_width(), grd_curscreen->get_screen_height());
-	/* write_bmp never fails */
-	std::false_type write_error;
+#if DXX_USE_OGL
+#define DXX_SCREENSHOT_FILE_EXTENSION	"tga"
+#else
+#define DXX_SCREENSHOT_FILE_EXTENSION	"pcx"
+#endif
 #endif
+
+	pause_game_world_time p;
+	const auto t = time(nullptr);
+	struct tm *tm = nullptr;
+	if (t != static_cast<time_t>(-1))
+		tm = gmtime(&t);
+	std::string savename{choose_screenshot_name(tm, DXX_SCREENSHOT_FILE_EXTENSION)};
+#undef DXX_SCREENSHOT_FILE_EXTENSION
+	screenshot_metadata md{};
+	if (tm)
+		md.time = *tm;
+	if (const auto current_mission = Current_mission.get())
+	{
+		md.have_mission = true;
+		md.mission_path = current_mission->path;
+		md.mission_name = current_mission->mission_name.data();
+		md.level_number = Current_level_num;
+		if (const auto viewer = Viewer)
+			md.viewer_segment = viewer->segnum;
+	}
+	if (!automap_flag)
+		HUD_init_message(HM_DEFAULT, "%s '%s'", TXT_DUMPING_SCREEN, &savename[sizeof(SCRNS_DIR) - 1]);
+
+#if DXX_USE_OGL
+	/* The read finishes on a later frame, and is then encoded and
+	 * written on the screenshot thread.
+	 */
+	if (!ogl_read_screen([savename, md](ogl_screen_image &&image) {
+		get_screenshot_worker().push([savename, md, image = std::move(image)]() mutable {
+			screenshot_worker::result r{std::move(savename), {}, {}};
+			encode_screenshot(r, md, image);
+			get_screenshot_worker().finish(std::move(r));
+		});
+	}))
+		con_printf(CON_URGENT, "Cannot save screenshot \"%s\": the screen cannot be read", savename.c_str());
 #else
 	grs_canvas &screen_canv = grd_curscreen->sc_canvas;
 	palette_array_t pal;
 
-	const auto &&temp_canv = gr_create_canvas(screen_canv.cv_bitmap.bm_w, screen_canv.cv_bitmap.bm_h);
-	gr_ubitmap(*temp_canv, screen_canv.cv_bitmap);
-
 	gr_palette_read(pal);		//get actual palette from the hardware
 	// Correct palette colors
 	range_for (auto &i, pal)
@@ -1051,13 +1316,26 @@ void save_screen_shot(int automap_flag)
 		i.b <<= 2;
 	}
 #if DXX_USE_SCREENSHOT_FORMAT_PNG
-	auto write_error = write_screenshot_png(file, tm, grd_curscreen->sc_canvas.cv_bitmap, pal);
+	/* Copy the canvas, which the next frame draws over, and encode the
+	 * copy on the screenshot thread.
+	 */
+	const auto &bm = screen_canv.cv_bitmap;
+	const unsigned w = bm.bm_w, h = bm.bm_h;
+	std::vector<uint8_t> pixels(std::size_t{w} * h);
+	for (unsigned y = 0; y != h; ++y)
+		std::memcpy(&pixels[std::size_t{w} * y], &bm.get_bitmap_data()[std::size_t{bm.bm_rowsize} * y], w);
+	get_screenshot_worker().push([savename = std::move(savename), md = std::move(md), pal, w, h, pixels = std::move(pixels)]() mutable {
+		screenshot_worker::result r{std::move(savename), {}, {}};
+		write_screenshot_png(r, md, w, h, false, pixels.data(), &pal);
+		get_screenshot_worker().finish(std::move(r));
+	});
 #elif DXX_USE_SCREENSHOT_FORMAT_LEGACY
-	auto write_error = pcx_write_bitmap(file, &temp_canv->cv_bitmap, pal);
-#endif
-#endif
-	if (write_error)
-		PHYSFS_delete(savename);
+	if (const auto &&[file, physfserr] = PHYSFSX_openWriteBuffered(savename.c_str()); file)
+	{
+		const auto &&temp_canv = gr_create_canvas(screen_canv.cv_bitmap.bm_w, screen_canv.cv_bitmap.bm_h);
+		gr_ubitmap(*temp_canv, screen_canv.cv_bitmap);
+		if (pcx_write_bitmap(file, &temp_canv->cv_bitmap, pal))
+			PHYSFS_delete(savename.c_str());
 	}
 	else
 	{
@@ -1065,11 +1343,91 @@ void save_screen_shot(int automap_flag)
 		if (!automap_flag)
 			HUD_init_message(HM_DEFAULT, "Failed to open screenshot file for writing: %s: %s", &savename[sizeof(SCRNS_DIR) - 1], e);
 		else
-			con_printf(CON_URGENT, "Failed to open screenshot file for writing: %s: %s", savename, e);
+			con_printf(CON_URGENT, "Failed to open screenshot file for writing: %s: %s", savename.c_str(), e);
+	}
+#endif
+#endif
+}
+
+void screenshot_finish_writes()
+{
+#if DXX_USE_OGL
+	Frame_capture.reset();
+#endif
+	get_screenshot_worker().wait();
+	queue_finished_screenshots();
+}
+
+void screenshot_after_flip()
+{
+	queue_finished_screenshots();
+#if DXX_USE_OGL
+	const auto c{Frame_capture};
+	if (!c)
+		return;
+	if (!ogl_read_screen([c](ogl_screen_image &&image) {
+		if (!get_screenshot_worker().push([c, image = std::move(image)]() {
+			if (c->failed || image.w != c->w || image.h != c->h)
+			{
+				/* A frame of another size would garble the rest of the
+				 * file
+				 */
+				++c->dropped;
+				return;
+			}
+			const std::size_t stride{std::size_t{image.w} * 3};
+			for (unsigned y = 0; y != image.h; ++y)
+			{
+				const auto row{&image.rgb[stride * (image.bottom_up ? image.h - 1 - y : y)]};
+				if (PHYSFS_writeBytes(c->file, row, stride) != static_cast<PHYSFS_sint64>(stride))
+				{
+					c->failed = true;
+					return;
+				}
+			}
+			++c->written;
+		}, max_queued_capture_frames))
+			++c->dropped;
+	}))
+		++c->dropped;
+#endif
+}
+
+#if DXX_USE_OGL
+void frame_capture_toggle()
+{
+	if (const auto c{std::exchange(Frame_capture, {})})
+	{
+		/* At most a few frames are still queued */
+		get_screenshot_worker().wait();
+		HUD_init_message(HM_DEFAULT, "Frame capture stopped: %u frames written, %u dropped%s", c->written.load(), c->dropped.load(), c->failed ? ", writing failed" : "");
+		return;
+	}
+	if (!CGameArg.DbgGlReadPixelsOk)
+	{
+		HUD_init_message_literal(HM_DEFAULT, "glReadPixels not supported on your configuration");
+		return;
+	}
+	const auto t = time(nullptr);
+	const struct tm *const tm = (t == static_cast<time_t>(-1)) ? nullptr : gmtime(&t);
+	const std::string savename{choose_screenshot_name(tm, "rgb")};
+	auto &&[file, physfserr] = PHYSFSX_openWriteBuffered(savename.c_str());
+	if (!file)
+	{
+		HUD_init_message(HM_DEFAULT, "Failed to open capture file for writing: %s: %s", &savename[sizeof(SCRNS_DIR) - 1], PHYSFS_getErrorByCode(physfserr));
 		return;
 	}
+	const unsigned w = grd_curscreen->get_screen_width();
+	const unsigned h = grd_curscreen->get_screen_height();
+	Frame_capture = std::make_shared<frame_capture>(std::move(file), w, h);
+	HUD_init_message(HM_DEFAULT, "Capturing frames to '%s'", &savename[sizeof(SCRNS_DIR) - 1]);
+	/* The file has one frame per gr_flip, so its rate is the frame
+	 * rate, which -maxfps can hold steady.
+	 */
+	con_printf(CON_NORMAL, "Frame capture: encode with: ffmpeg -f rawvideo -pixel_format rgb24 -video_size %ux%u -framerate %i -i %s capture.mp4", w, h, CGameArg.SysMaxFPS, savename.c_str());
 }
 #endif
+#endif
 
 //initialize flying
 void fly_init(object_base &obj)
@@ -1573,6 +1931,8 @@ void show_netgame_help()
 	DXX_MENUITEM(VERB, TEXT, "SHIFT-LEFT\t  FAST BACKWARD", DEMOHELP_FAST_BACKWARD)	\
 	DXX_MENUITEM(VERB, TEXT, "CTRL-RIGHT\t  JUMP TO END", DEMOHELP_JUMP_END)	\
 	DXX_MENUITEM(VERB, TEXT, "CTRL-LEFT\t  JUMP TO START", DEMOHELP_JUMP_START)	\
+	DXX_MENUITEM(VERB, TEXT, "PGDN\t  FORWARD 30 SECONDS", DEMOHELP_SEEK_FORWARD)	\
+	DXX_MENUITEM(VERB, TEXT, "PGUP\t  BACK 30 SECONDS", DEMOHELP_SEEK_BACKWARD)	\
 	_DXX_HELP_MENU_HINT_CMD_KEY(VERB, DEMOHELP)	\
 
 enum {
@@ -1741,6 +2101,7 @@ game_window *game_setup()
 #endif
 	init_cockpit();
 	init_gauges();
+	input_latency_clear();
 	netplayerinfo_on = 0;
 
 #if DXX_USE_EDITOR
@@ -1775,6 +2136,9 @@ window_event_result game_window::event_handler(const d_event &event)
 
 			event_toggle_focus(1);
 			key_toggle_repeat(0);
+#ifdef __ANDROID__
+			touch_overlay_set_analog(true);
+#endif
 			game_flush_inputs(Controls);
 
 			if (time_paused)
@@ -1801,6 +2165,9 @@ window_event_result game_window::event_handler(const d_event &event)
 
 			event_toggle_focus(0);
 			key_toggle_repeat(1);
+#ifdef __ANDROID__
+			touch_overlay_set_analog(false);
+#endif
 			break;
 
 #if DXX_MAX_BUTTONS_PER_JOYSTICK
@@ -1825,14 +2192,17 @@ window_event_result game_window::event_handler(const d_event &event)
 				result = GameProcessFrame(LevelSharedRobotInfoState);
 			}
 
-			if (!Automap_active)		// efficiency hack
+			if (!Automap_active && !CGameArg.SysHeadless)		// efficiency hack
 			{
 				if (force_cockpit_redraw) {			//screen need redrawing?
 					init_cockpit();
 					force_cockpit_redraw=0;
 				}
+				paging_prefetch_frame(Vclip, vcsegptridx(ConsoleObject->segnum));
+				const object_tick_interpolation interpolate_objects{LevelUniqueObjectState.Objects};
 				game_render_frame(LevelSharedRobotInfoState.Robot_info, Controls);
 			}
+			frame_profile_end_frame();
 			break;
 
 		case event_type::window_close:
@@ -1856,6 +2226,9 @@ window_event_result game_window::event_handler(const d_event &event)
 				show_menus();
 			event_toggle_focus(0);
 			key_toggle_repeat(1);
+#ifdef __ANDROID__
+			touch_overlay_set_analog(false);
+#endif
 			Game_wind = nullptr;
 			return window_event_result::ignored;
 
@@ -1981,6 +2354,7 @@ window_event_result GameProcessFrame(const d_level_shared_robot_info_state &Leve
 	auto result = window_event_result::ignored;
 
 	state_poll_autosave_game(GameUniqueState, LevelUniqueObjectState);
+	level_snapshot_poll();
 	update_player_stats();
 	diminish_palette_towards_normal();		//	Should leave palette effect up for as long as possible by putting right before render.
 	do_afterburner_stuff(Objects);
@@ -2044,7 +2418,10 @@ window_event_result GameProcessFrame(const d_level_shared_robot_info_state &Leve
 #if DXX_USE_MULTIPLAYER
 	if (+(Game_mode & GM_MULTI))
 	{
-		result = std::max(multi_do_frame(), result);
+		{
+			const frame_profile_scope profile{frame_profile_zone::multiplayer};
+			result = std::max(multi_do_frame(), result);
+		}
 		if (Netgame.PlayTimeAllowed.count())
 		{
 			if (ThisLevelTime >= Netgame.PlayTimeAllowed)
@@ -2066,7 +2443,10 @@ window_event_result GameProcessFrame(const d_level_shared_robot_info_state &Leve
 	do_ambient_sounds(vcsegptr(ConsoleObject->segnum)->s2_flags);
 #endif
 
-	digi_sync_sounds();
+	{
+		const frame_profile_scope profile{frame_profile_zone::sound};
+		digi_sync_sounds();
+	}
 
 	if (Endlevel_sequence) {
 		result = std::max(do_endlevel_frame(LevelSharedRobotInfoState), result);
@@ -2102,14 +2482,20 @@ window_event_result GameProcessFrame(const d_level_shared_robot_info_state &Leve
 #ifndef NEWHOMER
 		player_info.homing_object_dist = -1; // Assume not being tracked.  Laser_do_weapon_sequence modifies this.
 #endif
-		result = std::max(game_move_all_objects(LevelSharedRobotInfoState), result);
+		{
+			const frame_profile_scope profile{frame_profile_zone::move_objects};
+			result = std::max(game_move_all_objects(LevelSharedRobotInfoState), result);
+		}
 		powerup_grab_cheat_all();
 
 		if (Endlevel_sequence)	//might have been started during move
 			return result;
 
 		fuelcen_update_all(LevelSharedRobotInfoState.Robot_info);
-		do_ai_frame_all(LevelSharedRobotInfoState.Robot_info);
+		{
+			const frame_profile_scope profile{frame_profile_zone::ai};
+			do_ai_frame_all(LevelSharedRobotInfoState.Robot_info);
+		}
 
 		auto laser_firing_count = FireLaser(player_info, Controls);
 		if (auto &Auto_fire_fusion_cannon_time = player_info.Auto_fire_fusion_cannon_time)
@@ -2144,7 +2530,6 @@ window_event_result GameProcessFrame(const d_level_shared_robot_info_state &Leve
 
 #if DXX_BUILD_DESCENT == 2
 	omega_charge_frame(player_info);
-	slide_textures();
 	auto &LevelSharedDestructibleLightState = LevelSharedSegmentState.DestructibleLights;
 	flicker_lights(LevelSharedDestructibleLightState, Flickering_light_state, vmsegptridx);
 
@@ -2167,14 +2552,127 @@ window_event_result GameProcessFrame(const d_level_shared_robot_info_state &Leve
 	return result;
 }
 
+namespace {
+
+//	The replay flies the player forward, weaving left and right and up and
+//	down over a few seconds, so that it passes robots and walls the same
+//	way on every run.
+void game_replay_controls(control_info &Controls, const unsigned tick)
+{
+	Controls = {};
+	Controls.forward_thrust_time = FrameTime;
+	Controls.heading_time = (tick & 64) ? FrameTime / 2 : -FrameTime / 2;
+	Controls.pitch_time = (tick & 256) ? FrameTime / 8 : -FrameTime / 8;
+	Controls.state.fire_primary = (tick & 31) == 0;
+}
+
+//	Fold where every object is and how it is doing into one number.  Two
+//	runs which print the same value ended in the same place.
+uint32_t game_replay_checksum()
+{
+	auto &Objects = LevelUniqueObjectState.Objects;
+	uint32_t h{2166136261u};
+	const auto add = [&h](const uint32_t v) {
+		for (unsigned i = 0; i != 4; ++i)
+			h = (h ^ ((v >> (i * 8)) & 0xff)) * 16777619u;
+	};
+	for (const auto &&objp : Objects.vcptridx)
+	{
+		const auto &obj = *objp;
+		if (obj.type == OBJ_NONE)
+			continue;
+		add(objp.get_unchecked_index());
+		add(static_cast<uint32_t>(obj.type));
+		add(obj.id);
+		add(static_cast<uint32_t>(obj.segnum));
+		add(obj.pos.x);
+		add(obj.pos.y);
+		add(obj.pos.z);
+		add(obj.orient.fvec.x);
+		add(obj.orient.fvec.y);
+		add(obj.orient.fvec.z);
+		add(obj.shields);
+	}
+	return h;
+}
+
+}
+
+//	Run the game for a fixed number of fixed-length ticks, with d_rand
+//	seeded and the player flown by a script, without rendering or reading
+//	input.  Report how long the ticks took and a checksum of where every
+//	object ended.  Two runs from the same saved game with the same seed
+//	must report the same checksum, so an AI or physics change can be timed
+//	on exactly the same work.
+void game_replay_ticks(const unsigned ticks, const unsigned seed)
+{
+	if (!Game_wind || +(Game_mode & GM_MULTI) || Newdemo_state != ND_STATE_NORMAL)
+	{
+		con_printf(CON_NORMAL, "ai_replay: start a single player game, and stop any demo, first");
+		return;
+	}
+	using clock = std::chrono::steady_clock;
+	const auto saved_frametime{FrameTime};
+	FrameTime = DESIGNATED_GAME_FRAMETIME;
+	d_srand(seed);
+	clock::duration total{}, worst{};
+	unsigned ran = 0;
+	for (; ran != ticks; ++ran)
+	{
+		game_replay_controls(Controls, ran);
+		GameTime64 += FrameTime;
+		calc_d_tick();
+		const auto start{clock::now()};
+		const auto result{GameProcessFrame(LevelSharedRobotInfoState)};
+		const auto spent{clock::now() - start};
+		/* Each tick is a frame to the profiler, so a replay can be
+		 * dumped with frame_profile_csv.
+		 */
+		frame_profile_end_frame();
+		total += spent;
+		worst = std::max(worst, spent);
+		if (result == window_event_result::close || Endlevel_sequence || Player_dead_state != player_dead_state::no)
+		{
+			++ran;
+			break;
+		}
+	}
+	Controls = {};
+	FrameTime = saved_frametime;
+	reset_time();
+	const auto us = [](const clock::duration d) {
+		return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+	};
+	con_printf(CON_NORMAL, "ai_replay: %u of %u ticks, seed %u: %lu us total, %lu us mean, %lu us worst; checksum %08x", ran, ticks, seed, us(total), ran ? us(total) / ran : 0, us(worst), game_replay_checksum());
+}
+
 }
 
 #if DXX_BUILD_DESCENT == 2
+namespace {
+
+struct slide_segment
+{
+	segnum_t segnum;
+	/* The game time its sides were last slid to */
+	fix64 time;
+};
+
+/* The segments with a side that slides, in segment order.  Sides slide
+ * only when drawn, by the time since they were last drawn, so that the
+ * sides out of view cost nothing.
+ */
+static std::vector<slide_segment> Slide_segments;
+
+}
+
 void compute_slide_segs()
 {
 	auto &TmapInfo = LevelUniqueTmapInfoState.TmapInfo;
-	for (const csmusegment suseg : vmsegptr)
+	Slide_segments.clear();
+	for (const auto &&segp : vmsegptridx)
 	{
+		const csmusegment suseg = segp;
 		sidemask_t slide_textures{};
 		for (const auto sidenum : MAX_SIDES_PER_SEGMENT)
 		{
@@ -2195,6 +2693,8 @@ void compute_slide_segs()
 			slide_textures |= build_sidemask(sidenum);
 		}
 		suseg.u.slide_textures = slide_textures;
+		if (slide_textures != sidemask_t{})
+			Slide_segments.emplace_back(slide_segment{segp, GameTime64});
 	}
 }
 
@@ -2214,37 +2714,35 @@ static void update_uv(std::array<uvl, 4> &uvls, uvl &i, fix a)
 			j.*p += f1_0;
 }
 
+/* The distance a side slides in `elapsed`, less any whole texture */
+static fix slide_distance(const fix64 elapsed, const fix rate)
+{
+	return static_cast<fix>((elapsed * rate >> 16) % f1_0);
+}
+
 //	-----------------------------------------------------------------------------
-static void slide_textures(void)
+static void slide_textures(const d_level_unique_tmap_info_state::TmapInfo_array &TmapInfo, unique_segment &useg, const sidemask_t slide_seg, const fix64 elapsed)
 {
-	auto &TmapInfo = LevelUniqueTmapInfoState.TmapInfo;
-	for (unique_segment &useg : vmsegptr)
+	for (const auto sidenum : MAX_SIDES_PER_SEGMENT)
 	{
-		if (const auto slide_seg = useg.slide_textures; slide_seg != sidemask_t{})
+		if (+(slide_seg & build_sidemask(sidenum)))
 		{
-			for (const auto sidenum : MAX_SIDES_PER_SEGMENT)
+			auto &side = useg.sides[sidenum];
+			const auto texture1_index{get_texture_index(side.tmap_num)};
+			if (texture1_index >= TmapInfo.size()) [[unlikely]]
+				continue;
+			const auto &ti{TmapInfo[texture1_index]};
+			const auto tiu = ti.slide_u;
+			const auto tiv = ti.slide_v;
+			if (tiu || tiv)
 			{
-				if (+(slide_seg & build_sidemask(sidenum)))
+				const auto ua = slide_distance(elapsed, tiu << 8);
+				const auto va = slide_distance(elapsed, tiv << 8);
+				auto &uvls = side.uvls;
+				range_for (auto &i, uvls)
 				{
-					auto &side = useg.sides[sidenum];
-					const auto texture1_index{get_texture_index(side.tmap_num)};
-					if (texture1_index >= TmapInfo.size()) [[unlikely]]
-						continue;
-					const auto &ti{TmapInfo[texture1_index]};
-					const auto tiu = ti.slide_u;
-					const auto tiv = ti.slide_v;
-					if (tiu || tiv)
-					{
-						const auto frametime{FrameTime};
-						const auto ua = fixmul(frametime, tiu << 8);
-						const auto va = fixmul(frametime, tiv << 8);
-						auto &uvls = side.uvls;
-						range_for (auto &i, uvls)
-						{
-							update_uv<&uvl::u>(uvls, i, ua);
-							update_uv<&uvl::v>(uvls, i, va);
-						}
-					}
+					update_uv<&uvl::u>(uvls, i, ua);
+					update_uv<&uvl::v>(uvls, i, va);
 				}
 			}
 		}
@@ -2258,10 +2756,9 @@ static void flicker_lights(const d_level_shared_destructible_light_state &LevelS
 	auto &TmapInfo = LevelUniqueTmapInfoState.TmapInfo;
 	auto &Walls = LevelUniqueWallSubsystemState.Walls;
 	auto &vcwallptr = Walls.vcptr;
-	range_for (auto &f, partial_range(fls.Flickering_lights, fls.Num_flickering_lights))
+	for (const auto i : partial_const_range(fls.Active_flickering_lights, fls.Num_active_flickering_lights))
 	{
-		if (f.timer == flicker_timer_disabled)		//disabled
-			continue;
+		auto &f = fls.Flickering_lights[i];
 		const auto &&segp = vmsegptridx(f.segnum);
 		const auto sidenum{f.sidenum};
 		{
@@ -2309,7 +2806,12 @@ static void update_flicker(d_flickering_light_state &fls, const vmsegidx_t segnu
 {
 	const auto &&i = find_flicker(fls, segnum, sidenum);
 	if (i.first != i.second)
+	{
+		const bool was_disabled{i.first->timer == flicker_timer_disabled};
 		i.first->timer = timer;
+		if (was_disabled != (timer == flicker_timer_disabled))
+			compute_active_flickers(fls);
+	}
 }
 
 }
@@ -2325,6 +2827,40 @@ void enable_flicker(d_flickering_light_state &fls, const vmsegidx_t segnum, cons
 {
 	update_flicker(fls, segnum, sidenum, 0);
 }
+
+void slide_visible_textures(const std::span<const segnum_t> segments)
+{
+	if (Slide_segments.empty())
+		return;
+	auto &TmapInfo = LevelUniqueTmapInfoState.TmapInfo;
+	const auto now{GameTime64};
+	for (const auto segnum : segments)
+	{
+		if (segnum == segment_none)
+			continue;
+		unique_segment &useg = vmsegptr(segnum);
+		const auto slide_seg = useg.slide_textures;
+		if (slide_seg == sidemask_t{})
+			continue;
+		const auto i = std::ranges::lower_bound(Slide_segments, segnum, {}, &slide_segment::segnum);
+		if (i == Slide_segments.end() || i->segnum != segnum)
+			continue;
+		/* Game time goes back when a level restarts or a snapshot is
+		 * restored, so only slide forward.
+		 */
+		if (const auto elapsed{now - std::exchange(i->time, now)}; elapsed > 0)
+			slide_textures(TmapInfo, useg, slide_seg, elapsed);
+	}
+}
+
+void compute_active_flickers(d_flickering_light_state &fls)
+{
+	unsigned n{0};
+	for (const auto &&[i, f] : enumerate(partial_const_range(fls.Flickering_lights, fls.Num_flickering_lights)))
+		if (f.timer != flicker_timer_disabled)
+			fls.Active_flickering_lights[n++] = static_cast<uint8_t>(i);
+	fls.Num_active_flickering_lights = n;
+}
 #endif
 
 namespace {
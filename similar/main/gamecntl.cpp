@@ -141,6 +141,13 @@ struct pause_window : ::dcx::pause_window
 {
 	using ::dcx::pause_window::pause_window;
 	virtual window_event_result event_handler(const d_event &) override;
+	/* Multiplayer games cannot be paused, so nothing changes until a key
+	 * is pressed.
+	 */
+	virtual unsigned get_idle_wait() const override
+	{
+		return 250;
+	}
 };
 
 #ifndef RELEASE
@@ -675,6 +682,10 @@ static window_event_result HandleDemoKey(int key)
 		case KEY_CTRLED + KEY_LEFT:
 			return newdemo_goto_beginning();
 			break;
+		case KEY_PAGEDOWN:
+			return newdemo_seek(30);
+		case KEY_PAGEUP:
+			return newdemo_seek(-30);
 
 		KEY_MAC(case KEY_COMMAND+KEY_P:)
 		case KEY_PAUSE:
@@ -701,6 +712,11 @@ static window_event_result HandleDemoKey(int key)
 			}
 			break;
 		}
+#if DXX_USE_OGL
+		case KEY_SHIFTED + KEY_PRINT_SCREEN:
+			frame_capture_toggle();
+			break;
+#endif
 #endif
 #ifndef NDEBUG
 		case KEY_DEBUGGED + KEY_I:
@@ -857,6 +873,11 @@ static window_event_result HandleSystemKey(int key)
 			}
 			break;
 		}
+#if DXX_USE_OGL
+		case KEY_SHIFTED + KEY_PRINT_SCREEN:
+			frame_capture_toggle();
+			break;
+#endif
 #endif
 
 		KEY_MAC(case KEY_COMMAND+KEY_1:)
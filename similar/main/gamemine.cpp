@@ -28,6 +28,10 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <span>
 
 #include "pstypes.h"
 #include "inferno.h"
@@ -39,6 +43,10 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "dxxerror.h"
 #include "gameseg.h"
 #include "physfsx.h"
+#include "byteutil.h"
+#include "level_cache.h"
+#include "load_trace.h"
+#include "mem_account.h"
 #include "switch.h"
 #include "game.h"
 #include "fuelcen.h"
@@ -99,23 +107,75 @@ static station_number build_station_number_from_untrusted(uint8_t untrusted)
 		return station_number::None;
 }
 
+/* A cursor over the compiled mine data, read into memory in one call.
+ * Each read is checked against the end of the data, and a short read is
+ * reported the same way that the PHYSFSX_read helpers report one.
+ */
+class mine_data_reader
+{
+	const NamedPHYSFS_File file;
+	const std::span<const uint8_t> data;
+	std::size_t pos{0};
+	template <std::size_t N>
+	const uint8_t *take(const char *const filename, const unsigned line, const char *const func)
+	{
+		if (data.size() - pos < N) [[unlikely]]
+			PHYSFSX_read_helper_report_error(filename, line, func, file);
+		const auto p = &data[pos];
+		pos += N;
+		return p;
+	}
+public:
+	mine_data_reader(const NamedPHYSFS_File file, const std::span<const uint8_t> data) :
+		file{file}, data{data}
+	{
+	}
+	std::size_t consumed() const
+	{
+		return pos;
+	}
+	int8_t read_s8(const char *const filename = __builtin_FILE(), const unsigned line = __builtin_LINE(), const char *const func = __builtin_FUNCTION())
+	{
+		return static_cast<int8_t>(*take<1>(filename, line, func));
+	}
+	int16_t read_s16(const char *const filename = __builtin_FILE(), const unsigned line = __builtin_LINE(), const char *const func = __builtin_FUNCTION())
+	{
+		return GET_INTEL_SHORT<int16_t>(take<2>(filename, line, func));
+	}
+	uint16_t read_u16(const char *const filename = __builtin_FILE(), const unsigned line = __builtin_LINE(), const char *const func = __builtin_FUNCTION())
+	{
+		return GET_INTEL_SHORT(take<2>(filename, line, func));
+	}
+	int32_t read_s32(const char *const filename = __builtin_FILE(), const unsigned line = __builtin_LINE(), const char *const func = __builtin_FUNCTION())
+	{
+		return GET_INTEL_INT<int32_t>(take<4>(filename, line, func));
+	}
+	void read_vector(vms_vector &v, const char *const filename = __builtin_FILE(), const unsigned line = __builtin_LINE(), const char *const func = __builtin_FUNCTION())
+	{
+		const auto p = take<12>(filename, line, func);
+		v.x = GET_INTEL_INT<int32_t>(p);
+		v.y = GET_INTEL_INT<int32_t>(p + 4);
+		v.z = GET_INTEL_INT<int32_t>(p + 8);
+	}
+};
+
 /*
- * reads a segment2 structure from a PHYSFS_File
+ * reads a segment2 structure from the mine data
  */
-static void segment2_read(const msmusegment s2, const NamedPHYSFS_File fp)
+static void segment2_read(const msmusegment s2, mine_data_reader &fp)
 {
-	s2.s.special = build_segment_special_from_untrusted(PHYSFSX_readByte(fp));
-	s2.s.matcen_num = build_materialization_center_number_from_untrusted(PHYSFSX_readByte(fp));
+	s2.s.special = build_segment_special_from_untrusted(fp.read_s8());
+	s2.s.matcen_num = build_materialization_center_number_from_untrusted(fp.read_s8());
 	/* station_idx is overwritten by the caller in some cases, but set
 	 * it here for compatibility with how the game previously worked */
-	s2.s.station_idx = build_station_number_from_untrusted(PHYSFSX_readByte(fp));
-	const auto s2_flags = PHYSFSX_readByte(fp);
+	s2.s.station_idx = build_station_number_from_untrusted(fp.read_s8());
+	const auto s2_flags = fp.read_s8();
 	/* Ambient sounds are recomputed by the level load code.  Ignore the value
 	 * read from the file.
 	 */
 	(void)s2_flags;
 	s2.s.s2_flags = {};
-	s2.u.static_light = PHYSFSX_readFix(fp);
+	s2.u.static_light = fp.read_s32();
 }
 
 }
@@ -415,13 +475,13 @@ struct me mine_editor;
 
 namespace {
 
-static void read_children(shared_segment &segp, const sidemask_t bit_mask, const NamedPHYSFS_File LoadFile)
+static void read_children(shared_segment &segp, const sidemask_t bit_mask, mine_data_reader &LoadFile)
 {
 	for (const auto bit : MAX_SIDES_PER_SEGMENT)
 	{
 		if (+(bit_mask & build_sidemask(bit)))
 		{
-			const segnum_t child_segment{PHYSFSX_readULE16(LoadFile)};
+			const segnum_t child_segment{LoadFile.read_u16()};
 			segp.children[bit] = unlikely(child_segment == segment_exit)
 				? child_segment
 				: vmsegidx_t::check_nothrow_index(child_segment).value_or(segment_none);
@@ -430,28 +490,28 @@ static void read_children(shared_segment &segp, const sidemask_t bit_mask, const
 	}
 }
 
-static void read_verts(shared_segment &segp, const NamedPHYSFS_File LoadFile)
+static void read_verts(shared_segment &segp, mine_data_reader &LoadFile)
 {
 	// Read short Segments[segnum].verts[MAX_VERTICES_PER_SEGMENT]
 	range_for (auto &v, segp.verts)
 	{
-		const std::size_t i{PHYSFSX_readULE16(LoadFile)};
+		const std::size_t i{LoadFile.read_u16()};
 		if (i >= MAX_VERTICES)
 			throw std::invalid_argument("vertex number too large");
 		v = static_cast<vertnum_t>(i);
 	}
 }
 
-static void read_special(shared_segment &segp, const sidemask_t bit_mask, const NamedPHYSFS_File LoadFile)
+static void read_special(shared_segment &segp, const sidemask_t bit_mask, mine_data_reader &LoadFile)
 {
 	if (+(bit_mask & build_sidemask(MAX_SIDES_PER_SEGMENT)))
 	{
 		// Read ubyte	Segments[segnum].special
-		segp.special = build_segment_special_from_untrusted(PHYSFSX_readByte(LoadFile));
+		segp.special = build_segment_special_from_untrusted(LoadFile.read_s8());
 		// Read byte	Segments[segnum].matcen_num
-		segp.matcen_num = build_materialization_center_number_from_untrusted(PHYSFSX_readByte(LoadFile));
+		segp.matcen_num = build_materialization_center_number_from_untrusted(LoadFile.read_s8());
 		// Read short	Segments[segnum].value
-		segp.station_idx = build_station_number_from_untrusted(PHYSFSX_readSLE16(LoadFile));
+		segp.station_idx = build_station_number_from_untrusted(LoadFile.read_s16());
 	} else {
 		segp.special = segment_special::nothing;
 		segp.matcen_num = materialization_center_number::None;
@@ -463,8 +523,21 @@ static void read_special(shared_segment &segp, const sidemask_t bit_mask, const
 
 namespace dsx {
 
-int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const Gamesave_current_filename)
+int load_mine_data_compiled(const NamedPHYSFS_File MineFile, const char *const Gamesave_current_filename)
 {
+	const load_trace_span trace{"load_mine_data_compiled"};
+	/* Read the rest of the file in one call, and parse the mine from
+	 * memory.  The mine data has no stored length, so this also reads
+	 * the game data after it, which is small.  The file is left just
+	 * past the mine data.
+	 */
+	const auto mine_start = PHYSFS_tell(MineFile);
+	const std::size_t mine_available = std::max<PHYSFS_sint64>(PHYSFS_fileLength(MineFile) - mine_start, 0);
+	const auto mine_data = std::make_unique_for_overwrite<uint8_t[]>(mine_available);
+	const mem_account_tracked mine_data_account{mem_tag::mission, mine_available};
+	const std::size_t mine_read = std::max<PHYSFS_sint64>(PHYSFSX_readBytes(MineFile, mine_data.get(), mine_available), 0);
+	mine_data_reader LoadFile{MineFile, {mine_data.get(), mine_read}};
+	Level_cache_key = 0;
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Vertices = LevelSharedVertexState.get_vertices();
 	ubyte   compiled_version;
@@ -500,13 +573,13 @@ int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const G
 	fuelcen_reset();
 
 	//=============================== Reading part ==============================
-	compiled_version = PHYSFSX_readByte(LoadFile);
+	compiled_version = LoadFile.read_s8();
 	(void)compiled_version;
 
 	DXX_POISON_VAR(Vertices, 0xfc);
 	const unsigned Num_vertices = New_file_format_load
-		? PHYSFSX_readSLE16(LoadFile)
-		: PHYSFSX_readInt(LoadFile);
+		? LoadFile.read_s16()
+		: LoadFile.read_s32();
 	assert(Num_vertices <= MAX_VERTICES);
 #if DXX_USE_EDITOR
 	LevelSharedVertexState.Num_vertices = Num_vertices;
@@ -514,13 +587,13 @@ int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const G
 
 	DXX_POISON_VAR(Segments, 0xfc);
 	if (New_file_format_load)
-		LevelSharedSegmentState.Num_segments = PHYSFSX_readSLE16(LoadFile);
+		LevelSharedSegmentState.Num_segments = LoadFile.read_s16();
 	else
-		LevelSharedSegmentState.Num_segments = PHYSFSX_readInt(LoadFile);
+		LevelSharedSegmentState.Num_segments = LoadFile.read_s32();
 	assert(LevelSharedSegmentState.Num_segments <= MAX_SEGMENTS);
 
 	range_for (auto &i, partial_range(Vertices, Num_vertices))
-		PHYSFSX_readVector(LoadFile, i);
+		LoadFile.read_vector(i);
 
 	const auto Num_segments = LevelSharedSegmentState.Num_segments;
 	/* Editor builds need both the segment index and segment pointer.
@@ -542,7 +615,7 @@ int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const G
 		#endif
 
 		const sidemask_t children_mask = New_file_format_load
-			? static_cast<sidemask_t>(PHYSFSX_readByte(LoadFile))
+			? static_cast<sidemask_t>(LoadFile.read_s8())
 			: sidemask_t{0x7f};	// read all six children and special stuff...
 
 		if (Gamesave_current_version == 5) { // d2 SHAREWARE level
@@ -561,20 +634,20 @@ int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const G
 
 		if (Gamesave_current_version <= 5) { // descent 1 thru d2 SHAREWARE level
 			// Read fix	Segments[segnum].static_light (shift down 5 bits, write as short)
-			const uint16_t temp_static_light = PHYSFSX_readSLE16(LoadFile);
+			const uint16_t temp_static_light = LoadFile.read_s16();
 			segp.u.static_light = static_cast<fix>(temp_static_light) << 4;
 		}
 
 		// Read the walls as a 6 byte array
 		const sidemask_t wall_mask = New_file_format_load
-			? static_cast<sidemask_t>(PHYSFSX_readByte(LoadFile))
+			? static_cast<sidemask_t>(LoadFile.read_s8())
 			: sidemask_t{0x3f}; // read all six sides
 		for (const auto sidenum : MAX_SIDES_PER_SEGMENT)
 		{
 			auto &sside = segp.s.sides[sidenum];
 			if (+(wall_mask & build_sidemask(sidenum)))
 			{
-				const uint8_t byte_wallnum = PHYSFSX_readByte(LoadFile);
+				const uint8_t byte_wallnum = LoadFile.read_s8();
 				if ( byte_wallnum == 255 )
 					sside.wall_num = wall_none;
 				else
@@ -588,7 +661,7 @@ int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const G
 			auto &uside = segp.u.sides[sidenum];
 			if (segp.s.children[sidenum] == segment_none || segp.s.sides[sidenum].wall_num != wall_none)	{
 				// Read short Segments[segnum].sides[sidenum].tmap_num;
-				const uint16_t temp_tmap1_num = PHYSFSX_readSLE16(LoadFile);
+				const uint16_t temp_tmap1_num = LoadFile.read_s16();
 #if DXX_BUILD_DESCENT == 1
 				uside.tmap_num = build_texture1_value(convert_tmap(static_cast<texture_index>(temp_tmap1_num & 0x7fff)));
 
@@ -596,7 +669,7 @@ int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const G
 					uside.tmap_num2 = texture2_value::None;
 				else {
 					// Read short Segments[segnum].sides[sidenum].tmap_num2;
-					const auto tmap_num2 = texture2_value{static_cast<uint16_t>(PHYSFSX_readSLE16(LoadFile))};
+					const auto tmap_num2 = texture2_value{static_cast<uint16_t>(LoadFile.read_s16())};
 					uside.tmap_num2 = build_texture2_value(convert_tmap(get_texture_index(tmap_num2)), get_texture_rotation_high(tmap_num2));
 				}
 #elif DXX_BUILD_DESCENT == 2
@@ -610,7 +683,7 @@ int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const G
 					uside.tmap_num2 = texture2_value::None;
 				else {
 					// Read short Segments[segnum].sides[sidenum].tmap_num2;
-					const auto tmap_num2 = static_cast<texture2_value>(PHYSFSX_readSLE16(LoadFile));
+					const auto tmap_num2 = static_cast<texture2_value>(LoadFile.read_s16());
 					uside.tmap_num2 = (Gamesave_current_version <= 1 && tmap_num2 != texture2_value::None)
 						? build_texture2_value(convert_d1_tmap_num(get_texture_index(tmap_num2)), get_texture_rotation_high(tmap_num2))
 						: tmap_num2;
@@ -619,11 +692,11 @@ int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const G
 
 				// Read uvl Segments[segnum].sides[sidenum].uvls[4] (u,v>>5, write as short, l>>1 write as short)
 				range_for (auto &i, uside.uvls) {
-					temp_short = PHYSFSX_readSLE16(LoadFile);
+					temp_short = LoadFile.read_s16();
 					i.u = static_cast<fix>(temp_short) << 5;
-					temp_short = PHYSFSX_readSLE16(LoadFile);
+					temp_short = LoadFile.read_s16();
 					i.v = static_cast<fix>(temp_short) << 5;
-					const uint16_t temp_light = PHYSFSX_readSLE16(LoadFile);
+					const uint16_t temp_light = LoadFile.read_s16();
 					i.l = static_cast<fix>(temp_light) << 1;
 				}
 			} else {
@@ -648,6 +721,10 @@ int load_mine_data_compiled(const NamedPHYSFS_File LoadFile, const char *const G
 
 	reset_objects(LevelUniqueObjectState, 1);		//one object, the player
 
+	PHYSFS_seek(MineFile, mine_start + LoadFile.consumed());
+	/* The same bytes parse differently under other file versions */
+	const std::array<uint8_t, 2> mine_format{{static_cast<uint8_t>(Gamesave_current_version), New_file_format_load}};
+	Level_cache_key = level_cache_hash({mine_data.get(), LoadFile.consumed()}, level_cache_hash(mine_format));
 	return 0;
 }
 }
@@ -56,6 +56,11 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "gameseq.h"
 #include "args.h"
 #include "object.h"
+#include "frame_profile.h"
+#include "input_latency.h"
+#if DXX_USE_UDP
+#include "net_udp.h"
+#endif
 
 #include "compiler-range_for.h"
 #include "d_levelstate.h"
@@ -163,16 +168,88 @@ static void show_framerate(grs_canvas &canvas)
 	}
 	const auto &game_font = *GAME_FONT;
 	gr_set_fontcolor(canvas, BM_XRGB(0, 31, 0),-1);
-	char buf[16];
-	if (CGameArg.DbgVerbose)
-		snprintf(buf, sizeof(buf), "%iFPS (%.2fms)", fps_rate, (FrameTime * 1000.) / F1_0);
-	else
-		snprintf(buf, sizeof(buf), "%iFPS", fps_rate);
+	char buf[96];
+	/* Mean and worst lateness against the frame limiter */
+	const auto pacing{timer_get_frame_pacing()};
+	const auto late_mean_ms{(pacing.mean_late * 1000.) / F1_0}, late_max_ms{(pacing.max_late * 1000.) / F1_0};
+#if DXX_USE_VULKAN
+	const auto present_ms = (vk_get_present_latency() * 1000.) / F1_0;
+	const int len = CGameArg.DbgVerbose
+		? snprintf(buf, sizeof(buf), "%iFPS (%.2fms, late %.2f/%.2fms, present %.1fms)", fps_rate, (FrameTime * 1000.) / F1_0, late_mean_ms, late_max_ms, present_ms)
+		: snprintf(buf, sizeof(buf), "%iFPS (present %.0fms)", fps_rate, present_ms);
+#else
+	const int len = CGameArg.DbgVerbose
+		? snprintf(buf, sizeof(buf), "%iFPS (%.2fms, late %.2f/%.2fms)", fps_rate, (FrameTime * 1000.) / F1_0, late_mean_ms, late_max_ms)
+		: snprintf(buf, sizeof(buf), "%iFPS", fps_rate);
+#endif
+	/* Median and 95th percentile of the input to present latency */
+	if (auto &latency = input_latency_get_histogram(); latency.size() && len > 0 && static_cast<std::size_t>(len) < sizeof(buf))
+		snprintf(buf + len, sizeof(buf) - len, " in %u/%ums", latency.percentile(50), latency.percentile(95));
 	const auto &&[w, h] = gr_get_string_size(game_font, buf);
 	const auto bm_h = canvas.cv_bitmap.bm_h;
 	gr_string(canvas, game_font, FSPACX(318) - w, bm_h - line_displacement, buf, w, h);
 }
 
+/* Draw the newest frames of the profile history as stacked bars along
+ * the bottom left, one colour per zone, with the mean of each zone over
+ * the history above them.
+ */
+static void show_frame_profile(grs_canvas &canvas)
+{
+	constexpr std::array<std::array<uint8_t, 3>, frame_profile_zone_count> zone_colours{{
+		{{63, 0, 0}},
+		{{0, 0, 63}},
+		{{40, 40, 40}},
+		{{63, 63, 0}},
+		{{0, 63, 63}},
+		{{63, 0, 63}},
+		{{0, 63, 0}},
+		{{63, 32, 0}},
+		{{32, 0, 63}},
+		{{63, 63, 63}},
+	}};
+	constexpr unsigned shown_frames{128};
+	/* The full height of the graph is this many microseconds */
+	constexpr unsigned graph_us{40000};
+	auto &history = frame_profile_get_history();
+	const std::size_t n{history.size()};
+	if (!n)
+		return;
+	const unsigned bm_w = canvas.cv_bitmap.bm_w, bm_h = canvas.cv_bitmap.bm_h;
+	const unsigned step{std::max(1u, bm_w / 320)};
+	const unsigned graph_h{bm_h / 4};
+	const unsigned first = n > shown_frames ? n - shown_frames : 0;
+	std::array<unsigned long, frame_profile_zone_count> sums{};
+	for (std::size_t i = 0; i != n; ++i)
+		for (std::size_t z = 0; z != frame_profile_zone_count; ++z)
+			sums[z] += history[i].us[z];
+	for (std::size_t i = first; i != n; ++i)
+	{
+		const int x = (i - first) * step;
+		unsigned bottom{bm_h - 1}, stacked_us{};
+		for (std::size_t z = 0; z != frame_profile_zone_count && stacked_us < graph_us; ++z)
+		{
+			const auto us{std::min<unsigned>(history[i].us[z], graph_us - stacked_us)};
+			stacked_us += us;
+			const unsigned h = (static_cast<unsigned long>(us) * graph_h) / graph_us;
+			if (!h)
+				continue;
+			auto &c = zone_colours[z];
+			gr_rect(canvas, x, bottom - h + 1, x + step - 1, bottom, BM_XRGB(c[0], c[1], c[2]));
+			bottom -= h;
+		}
+	}
+	const auto &game_font = *GAME_FONT;
+	const auto line_spacing{LINE_SPACING(game_font, game_font)};
+	int y = bm_h - graph_h - (line_spacing * frame_profile_zone_count);
+	for (std::size_t z = 0; z != frame_profile_zone_count; ++z, y += line_spacing)
+	{
+		auto &c = zone_colours[z];
+		gr_set_fontcolor(canvas, BM_XRGB(c[0], c[1], c[2]), -1);
+		gr_printf(canvas, game_font, 0, y, "%s %.2fms", frame_profile_zone_name(static_cast<frame_profile_zone>(z)), sums[z] / (n * 1000.));
+	}
+}
+
 }
 
 }
@@ -449,6 +526,9 @@ static void game_draw_hud_stuff(const d_robot_info_array &Robot_info, grs_canvas
 	if (CGameCfg.FPSIndicator && PlayerCfg.CockpitMode[1] != cockpit_mode_t::rear_view)
 		show_framerate(canvas);
 
+	if (frame_profile_mode() > 1)
+		show_frame_profile(canvas);
+
 	auto previous_game_mode = Game_mode;
 	if (Newdemo_state == ND_STATE_PLAYBACK)
 		Game_mode = Newdemo_game_mode;
@@ -862,10 +942,20 @@ void game_render_frame_mono(const d_robot_info_array &Robot_info, const control_
 	gr_set_default_canvas();
 	{
 	auto &canvas = *grd_curcanv;
-	update_cockpits(canvas);
+#if DXX_USE_VULKAN
+	vk_set_gpu_pass(vk_gpu_pass::hud);
+#endif
+	const auto gauges_game_mode{Newdemo_state == ND_STATE_PLAYBACK ? Newdemo_game_mode : Game_mode};
+	/* A cockpit mode change must go through update_cockpits to reset the
+	 * gauges
+	 */
+	if (PlayerCfg.CockpitMode[1] != last_drawn_cockpit || !draw_retained_gauges(canvas, gauges_game_mode))
+	{
+		update_cockpits(canvas);
 
-	if (PlayerCfg.CockpitMode[1] == cockpit_mode_t::full_cockpit || PlayerCfg.CockpitMode[1] == cockpit_mode_t::status_bar)
-		render_gauges(canvas, Newdemo_state == ND_STATE_PLAYBACK ? Newdemo_game_mode : Game_mode);
+		if (PlayerCfg.CockpitMode[1] == cockpit_mode_t::full_cockpit || PlayerCfg.CockpitMode[1] == cockpit_mode_t::status_bar)
+			render_gauges(canvas, gauges_game_mode);
+	}
 	}
 
 	if (!no_draw_hud) {
@@ -881,6 +971,9 @@ void game_render_frame_mono(const d_robot_info_array &Robot_info, const control_
 			game_draw_hud_stuff(Robot_info, Screen_3d_window, Controls);
 		}
 	}
+#if DXX_USE_VULKAN
+	vk_set_gpu_pass(vk_gpu_pass::blit_2d);
+#endif
 
 #if DXX_BUILD_DESCENT == 2
 	gr_set_default_canvas();
@@ -892,6 +985,9 @@ void game_render_frame_mono(const d_robot_info_array &Robot_info, const control_
 		gr_set_default_canvas();
 		show_netplayerinfo(*grd_curcanv);
 	}
+#if DXX_USE_UDP
+	net_udp_show_stats(*grd_curcanv);
+#endif
 }
 
 }
@@ -30,6 +30,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "pstypes.h"
 #include "strutil.h"
 #include "console.h"
+#include "load_trace.h"
 #include "gr.h"
 #include "palette.h"
 #include "newmenu.h"
@@ -45,6 +46,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "gameseg.h"
 #include "wall.h"
 #include "gamemine.h"
+#include "lighting.h"
 #include "robot.h"
 #include "bm.h"
 #include "fireball.h"
@@ -57,6 +59,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "newdemo.h"
 #include "gameseq.h"
 #include "polyobj.h"
+#include "render.h"
 #include "text.h"
 #include "gamefont.h"
 #include "gamesave.h"
@@ -922,6 +925,7 @@ static int load_game_data(
 #endif
 	fvmobjptridx &vmobjptridx, fvmsegptridx &vmsegptridx, const NamedPHYSFS_File LoadFile)
 {
+	const load_trace_span trace{"load_game_data"};
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &vmobjptr = Objects.vmptr;
 	auto &WallAnims = GameSharedState.WallAnims;
@@ -1322,6 +1326,7 @@ int load_level(
 #endif
 	const char * filename_passed)
 {
+	const load_trace_span trace{"load_level"};
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &Vertices = LevelSharedVertexState.get_vertices();
@@ -1394,6 +1399,7 @@ int load_level(
 	}
 	else
 		Flickering_light_state.Num_flickering_lights = 0;
+	compute_active_flickers(Flickering_light_state);
 
 	{
 		auto &Secret_return_orient = LevelSharedSegmentState.Secret_return_orient;
@@ -1542,6 +1548,14 @@ int load_level(
 
 #if DXX_BUILD_DESCENT == 2
 	compute_slide_segs();
+#endif
+	build_segment_visibility(vcsegptridx, Vertices.vcptr);
+	invalidate_render_list_cache();
+	reset_dynamic_light_cache();
+	flush_fcd_cache();
+	build_segment_grid(vcsegptridx, Vertices.vcptr);
+#if DXX_USE_OGL
+	build_static_geometry(vcsegptridx, Vertices.vcptr);
 #endif
 	return 0;
 }
@@ -24,8 +24,12 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  */
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
 #include <numeric>
+#include <span>
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>	//	for memset()
@@ -50,6 +54,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "compiler-range_for.h"
 #include "d_array.h"
 #include "d_construct.h"
+#include "d_enumerate.h"
 #include "d_levelstate.h"
 #include "d_range.h"
 #include "d_zip.h"
@@ -508,12 +513,13 @@ static unsigned check_for_degenerate_side(fvcvertptr &vcvertptr, const shared_se
 [[nodiscard]]
 static unsigned check_for_degenerate_segment(fvcvertptr &vcvertptr, const shared_segment &sp)
 {
-	if (vm_vec_build_dot(
-			vm_vec_cross(
-				vm_vec_normalized(extract_forward_vector_from_segment(vcvertptr, sp)),
-				vm_vec_normalized(extract_right_vector_from_segment(vcvertptr, sp))),
-			vm_vec_normalized(extract_up_vector_from_segment(vcvertptr, sp))
-	) <= 0)
+	std::array<vms_vector, 3> axes{{
+		extract_forward_vector_from_segment(vcvertptr, sp),
+		extract_right_vector_from_segment(vcvertptr, sp),
+		extract_up_vector_from_segment(vcvertptr, sp),
+	}};
+	vm_vec_normalize_batch(axes);
+	if (vm_vec_build_dot(vm_vec_cross(axes[0], axes[1]), axes[2]) <= 0)
 		return 1;
 
 	//	Now, see if degenerate because of any side.
@@ -823,7 +829,6 @@ int check_segment_connections()
 namespace dsx {
 namespace {
 
-constexpr vm_distance fcd_abort_cache_value{F1_0 * 1000};
 constexpr vm_distance fcd_abort_return_value{-1};
 
 }
@@ -835,6 +840,123 @@ constexpr vm_distance fcd_abort_return_value{-1};
 lighting_hack Doing_lighting_hack_flag{lighting_hack::normal};
 #endif
 
+namespace {
+
+//	A uniform grid over the mine.  Each cell lists, in segment order, the
+//	segments whose vertices' bounding box, grown by segment_grid_margin,
+//	overlaps it, so that find_point_seg only checks the segments near the
+//	point when it cannot trace there from the hint.  A segment whose
+//	inside reaches further than the margin past its vertices is not
+//	found from outside its box.
+struct segment_grid
+{
+	struct bounds
+	{
+		vms_vector min, max;
+		bool contains(const vms_vector &p) const
+		{
+			return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z && p.z <= max.z;
+		}
+		bool overlaps(const bounds &o) const
+		{
+			return o.max.x >= min.x && o.min.x <= max.x && o.max.y >= min.y && o.min.y <= max.y && o.max.z >= min.z && o.min.z <= max.z;
+		}
+	};
+	static constexpr std::size_t outside = SIZE_MAX;
+	bounds extent;
+	std::array<unsigned, 3> cells;
+	std::array<fix, 3> cell_size;
+	std::vector<bounds> segment_bounds;
+	//	cell_segments[cell_start[c]] to cell_segments[cell_start[c + 1]]
+	//	are the segments of cell c
+	std::vector<uint32_t> cell_start;
+	std::vector<segnum_t> cell_segments;
+	unsigned axis_cell(const unsigned axis, const fix v) const
+	{
+		const auto lo = axis == 0 ? extent.min.x : axis == 1 ? extent.min.y : extent.min.z;
+		const auto c = (fix64{v} - lo) / cell_size[axis];
+		return static_cast<unsigned>(std::clamp<fix64>(c, 0, cells[axis] - 1));
+	}
+	std::size_t cell_index(const unsigned x, const unsigned y, const unsigned z) const
+	{
+		return (std::size_t{z} * cells[1] + y) * cells[0] + x;
+	}
+	std::size_t cell_of(const vms_vector &p) const
+	{
+		if (!extent.contains(p))
+			return outside;
+		return cell_index(axis_cell(0, p.x), axis_cell(1, p.y), axis_cell(2, p.z));
+	}
+};
+
+constexpr fix segment_grid_margin = F1_0;
+//	Cells per segment, on average
+constexpr double segment_grid_density = 1;
+
+static segment_grid Segment_grid;
+
+}
+
+void build_segment_grid(fvcsegptridx &vcsegptridx, fvcvertptr &vcvertptr)
+{
+	auto &grid = Segment_grid;
+	grid.segment_bounds.clear();
+	grid.cell_start.clear();
+	grid.cell_segments.clear();
+	grid.extent = {{INT32_MAX, INT32_MAX, INT32_MAX}, {INT32_MIN, INT32_MIN, INT32_MIN}};
+	for (const auto &&segp : vcsegptridx)
+	{
+		segment_grid::bounds b{{INT32_MAX, INT32_MAX, INT32_MAX}, {INT32_MIN, INT32_MIN, INT32_MIN}};
+		for (const auto v : segp->verts)
+		{
+			auto &vp = *vcvertptr(v);
+			b.min = {std::min(b.min.x, vp.x), std::min(b.min.y, vp.y), std::min(b.min.z, vp.z)};
+			b.max = {std::max(b.max.x, vp.x), std::max(b.max.y, vp.y), std::max(b.max.z, vp.z)};
+		}
+		b.min = {b.min.x - segment_grid_margin, b.min.y - segment_grid_margin, b.min.z - segment_grid_margin};
+		b.max = {b.max.x + segment_grid_margin, b.max.y + segment_grid_margin, b.max.z + segment_grid_margin};
+		auto &e = grid.extent;
+		e.min = {std::min(e.min.x, b.min.x), std::min(e.min.y, b.min.y), std::min(e.min.z, b.min.z)};
+		e.max = {std::max(e.max.x, b.max.x), std::max(e.max.y, b.max.y), std::max(e.max.z, b.max.z)};
+		grid.segment_bounds.emplace_back(b);
+	}
+	const auto n_segments = grid.segment_bounds.size();
+	if (!n_segments)
+		return;
+	const std::array<double, 3> size{{
+		static_cast<double>(fix64{grid.extent.max.x} - grid.extent.min.x) + 1,
+		static_cast<double>(fix64{grid.extent.max.y} - grid.extent.min.y) + 1,
+		static_cast<double>(fix64{grid.extent.max.z} - grid.extent.min.z) + 1,
+	}};
+	/* Roughly cubic cells, segment_grid_density per segment */
+	const double edge = std::cbrt(size[0] * size[1] * size[2] / (n_segments * segment_grid_density));
+	for (const unsigned axis : xrange(3u))
+	{
+		const auto n = static_cast<unsigned>(std::clamp(std::ceil(size[axis] / edge), 1., 64.));
+		grid.cells[axis] = n;
+		grid.cell_size[axis] = static_cast<fix>(std::ceil(size[axis] / n));
+	}
+	const auto n_cells = std::size_t{grid.cells[0]} * grid.cells[1] * grid.cells[2];
+	/* Count the segments of each cell, then fill them in segment order */
+	const auto for_each_cell = [&grid](const segment_grid::bounds &b, auto &&f) {
+		const auto x0 = grid.axis_cell(0, b.min.x), x1 = grid.axis_cell(0, b.max.x);
+		const auto y0 = grid.axis_cell(1, b.min.y), y1 = grid.axis_cell(1, b.max.y);
+		const auto z0 = grid.axis_cell(2, b.min.z), z1 = grid.axis_cell(2, b.max.z);
+		for (auto z = z0; z <= z1; ++z)
+			for (auto y = y0; y <= y1; ++y)
+				for (auto x = x0; x <= x1; ++x)
+					f(grid.cell_index(x, y, z));
+	};
+	grid.cell_start.assign(n_cells + 1, 0);
+	for (auto &b : grid.segment_bounds)
+		for_each_cell(b, [&grid](const std::size_t c) { ++grid.cell_start[c + 1]; });
+	std::partial_sum(grid.cell_start.begin(), grid.cell_start.end(), grid.cell_start.begin());
+	grid.cell_segments.resize(grid.cell_start.back());
+	std::vector<uint32_t> fill(grid.cell_start.begin(), grid.cell_start.end() - 1);
+	for (const auto &&[segnum, b] : enumerate(grid.segment_bounds))
+		for_each_cell(b, [&grid, &fill, segnum](const std::size_t c) { grid.cell_segments[fill[c]++] = static_cast<segnum_t>(segnum); });
+}
+
 imsegptridx_t find_point_seg(const d_level_shared_segment_state &LevelSharedSegmentState, d_level_unique_segment_state &, const vms_vector &p, const imsegptridx_t segnum DXX_lighting_hack_decl_parameter)
 {
 	return segnum.rebind_policy(find_point_seg(LevelSharedSegmentState, p, segnum DXX_lighting_hack_pass_parameter));
@@ -868,6 +990,26 @@ icsegptridx_t find_point_seg(const d_level_shared_segment_state &LevelSharedSegm
 		auto &Segments = LevelSharedSegmentState.get_segments();
 		auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 		auto &Vertices = LevelSharedVertexState.get_vertices();
+		//	The editor changes segments without rebuilding the grid
+		if (auto &grid = Segment_grid; !grid.cell_start.empty()
+#if DXX_USE_EDITOR
+			&& !EditorWindow
+#endif
+			)
+		{
+			const auto cell = grid.cell_of(p);
+			if (cell == segment_grid::outside)
+				return segment_none;
+			for (const auto s : std::span(grid.cell_segments).subspan(grid.cell_start[cell], grid.cell_start[cell + 1] - grid.cell_start[cell]))
+			{
+				if (!grid.segment_bounds[s].contains(p))
+					continue;
+				const auto &&segp = Segments.vmptridx(s);
+				if (get_seg_masks(Vertices.vcptr, p, segp, 0).centermask == sidemask_t{})
+					return segp;
+			}
+			return segment_none;
+		}
 		for (const auto &&segp : Segments.vmptridx)
 		{
 			if (get_seg_masks(Vertices.vcptr, p, segp, 0).centermask == sidemask_t{})
@@ -877,6 +1019,44 @@ icsegptridx_t find_point_seg(const d_level_shared_segment_state &LevelSharedSegm
 	return segment_none;
 }
 
+bool find_segments_near(const vms_vector &p, const fix radius, std::vector<segnum_t> &segments)
+{
+	segments.clear();
+	auto &grid = Segment_grid;
+	//	The editor changes segments without rebuilding the grid
+	if (grid.cell_start.empty()
+#if DXX_USE_EDITOR
+		|| EditorWindow
+#endif
+		)
+		return false;
+	const auto lo = [radius](const fix v) {
+		return static_cast<fix>(std::max<fix64>(fix64{v} - radius, INT32_MIN));
+	};
+	const auto hi = [radius](const fix v) {
+		return static_cast<fix>(std::min<fix64>(fix64{v} + radius, INT32_MAX));
+	};
+	const segment_grid::bounds q{{lo(p.x), lo(p.y), lo(p.z)}, {hi(p.x), hi(p.y), hi(p.z)}};
+	if (!grid.extent.overlaps(q))
+		return true;
+	const auto x0 = grid.axis_cell(0, q.min.x), x1 = grid.axis_cell(0, q.max.x);
+	const auto y0 = grid.axis_cell(1, q.min.y), y1 = grid.axis_cell(1, q.max.y);
+	const auto z0 = grid.axis_cell(2, q.min.z), z1 = grid.axis_cell(2, q.max.z);
+	for (auto z = z0; z <= z1; ++z)
+		for (auto y = y0; y <= y1; ++y)
+			for (auto x = x0; x <= x1; ++x)
+			{
+				const auto c = grid.cell_index(x, y, z);
+				for (const auto s : std::span(grid.cell_segments).subspan(grid.cell_start[c], grid.cell_start[c + 1] - grid.cell_start[c]))
+					if (grid.segment_bounds[s].overlaps(q))
+						segments.emplace_back(s);
+			}
+	/* A segment that spans several cells is listed in each */
+	std::ranges::sort(segments);
+	segments.erase(std::ranges::unique(segments).begin(), segments.end());
+	return true;
+}
+
 
 //--repair-- //	------------------------------------------------------------------------------
 //--repair-- void clsd_repair_center(int segnum)
@@ -947,129 +1127,113 @@ icsegptridx_t find_point_seg(const d_level_shared_segment_state &LevelSharedSegm
 //--repair-- 	return ((Lsegment_highest_segment_index == Highest_segment_index) && (Lsegment_highest_vertex_index == Highest_vertex_index));
 //--repair-- }
 
-#if DXX_BUILD_DESCENT == 1
 namespace {
-static inline void add_to_fcd_cache(segnum_t seg0, segnum_t seg1, vm_distance dist)
+
+//	find_connected_distance keeps the paths it finds in a table of fixed
+//	size, keyed by the two segments and the wall mask, so that the same
+//	query from sounds and the AI, which recurs every frame, does not search
+//	again.  A pair that maps to a slot in use replaces the pair in it.
+//	The distance is rebuilt from the centers next to either end and the
+//	length of the path between them, so it is the one a new search would
+//	return for any two points.  The paths are dropped when the state of
+//	any wall changes, which is checked once per frame, and by
+//	flush_fcd_cache.
+struct fcd_path
 {
-	(void)seg0;
-	(void)seg1;
-	(void)dist;
-}
-}
-#elif DXX_BUILD_DESCENT == 2
-#define	MIN_CACHE_FCD_DIST	(F1_0*80)	//	Must be this far apart for cache lookup to succeed.  Recognizes small changes in distance matter at small distances.
-namespace {
+	enum class result : uint8_t
+	{
+		//	seg1 is depth segments away
+		found,
+		//	seg1 is not taken from the queue before a segment depth away is
+		//	queued
+		beyond,
+	};
+	segnum_t seg0, seg1;
+	wall_is_doorway_mask wid_flag;
+	result r;
+	uint8_t depth;
+	//	Whether a segment beyond seg1 was queued before seg1 was taken
+	//	from the queue, so that a search limited to depth + 1 gives up
+	bool deeper;
+	uint32_t generation;
+	vms_vector near0, near1;
+	vm_distance inner;
+};
 
-struct fcd_data
+//	Deeper paths would overrun the points of fcd_search
+constexpr unsigned fcd_max_depth = 62;
+constexpr std::size_t fcd_path_slots = 4096;
+//	A path that is beyond at this depth is beyond at every depth
+constexpr uint8_t fcd_unreachable_depth = UINT8_MAX;
+
+struct fcd_path_table
 {
-	segnum_t	seg0, seg1;
-	vm_distance dist;
+	std::array<fcd_path, fcd_path_slots> paths;
+	//	Slots of earlier generations are empty
+	uint32_t generation{1};
+	uint32_t wall_digest;
+	fix64 checked_time;
 };
 
-fix64	Last_fcd_flush_time;
-unsigned Fcd_index;
-std::array<fcd_data, 8> Fcd_cache;
+static fcd_path_table Fcd_paths;
 
-static void add_to_fcd_cache(const segnum_t seg0, const segnum_t seg1, const vm_distance dist)
+//	Everything wall_is_doorway reads from the walls and their sides
+static uint32_t fcd_wall_digest(fvcwallptr &vcwallptr)
 {
-	if (dist > MIN_CACHE_FCD_DIST) {
-		if (Fcd_index >= Fcd_cache.size())
-			Fcd_index = 0;
-		auto &f = Fcd_cache[Fcd_index++];
-		f.seg0 = seg0;
-		f.seg1 = seg1;
-		f.dist = dist;
-	} else {
-		//	If it's in the cache, remove it.
-		for (auto &f : Fcd_cache)
-			if (f.seg0 == seg0 && f.seg1 == seg1)
-			{
-				f.seg0 = segment_none;
-				break;
-			}
+	uint32_t h{2166136261u};
+	const auto mix = [&h](const uint32_t v) {
+		h = (h ^ v) * 16777619u;
+	};
+	for (auto &w : vcwallptr)
+	{
+		mix(w.type);
+		mix(underlying_value(w.flags));
+		mix(underlying_value(w.state));
+		auto &uside = vcsegptr(w.segnum)->unique_segment::sides[w.sidenum];
+		mix(underlying_value(uside.tmap_num));
+		mix(underlying_value(uside.tmap_num2));
 	}
+	return h;
 }
 
+static uint32_t fcd_path_generation(fvcwallptr &vcwallptr)
+{
+	auto &t = Fcd_paths;
+	if (t.checked_time != GameTime64)
+	{
+		t.checked_time = GameTime64;
+		if (const auto digest{fcd_wall_digest(vcwallptr)}; digest != t.wall_digest)
+		{
+			t.wall_digest = digest;
+			++t.generation;
+		}
+	}
+	return t.generation;
 }
 
-//	----------------------------------------------------------------------------------------------------------
-void flush_fcd_cache()
+static std::size_t fcd_path_slot(const segnum_t seg0, const segnum_t seg1, const wall_is_doorway_mask wid_flag)
 {
-	Fcd_index = 0;
-	Last_fcd_flush_time = {GameTime64};
-
-	for (auto &f : Fcd_cache)
-		f.seg0 = segment_none;
+	return ((static_cast<uint32_t>(seg0) * 2654435761u) ^ (static_cast<uint32_t>(seg1) * 40503u) ^ underlying_value(wid_flag)) % fcd_path_slots;
 }
-#endif
 
-//	----------------------------------------------------------------------------------------------------------
-//	Determine whether seg0 and seg1 are reachable in a way that allows sound to pass.
-//	Search up to a maximum depth of max_depth.
-//	Return the distance.
-vm_distance find_connected_distance(const vms_vector &p0, const vcsegptridx_t seg0, const vms_vector &p1, const vcsegptridx_t seg1, int max_depth, const wall_is_doorway_mask wid_flag)
+//	Search from seg0 breadth first, until seg1 is taken from the queue or
+//	a segment max_depth away is queued, and record the path to seg1.
+static void fcd_search(fcd_path &p, fvcvertptr &vcvertptr, fvcwallptr &vcwallptr, const vcsegptridx_t seg0, const vcsegptridx_t seg1, const unsigned max_depth, const wall_is_doorway_mask wid_flag)
 {
-	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
-	auto &Vertices = LevelSharedVertexState.get_vertices();
-	segnum_t		cur_seg;
 	int qtail{0}, qhead = 0;
 	std::array<seg_seg, MAX_SEGMENTS> seg_queue;
-	int		cur_depth;
-	int		num_points;
+	std::array<uint16_t, MAX_SEGMENTS> depth{};
+	visited_segment_bitarray_t visited;
 	struct point_seg
 	{
 		vms_vector point;
 	};
-	std::array<point_seg, 64> point_segs;
-
-	//	If > this, will overrun point_segs buffer
-#ifdef WINDOWS
-	if (max_depth == -1) max_depth = 200;
-#endif	
-
-	if (const auto s = std::size(point_segs) - 2u; max_depth > s)
-		max_depth = s;
-
-	auto &Walls = LevelUniqueWallSubsystemState.Walls;
-	auto &vcwallptr = Walls.vcptr;
-	if (seg0 == seg1) {
-		return vm_vec_dist_quick(p0, p1);
-	} else {
-		auto conn_side = find_connect_side(seg0, seg1);
-		if (conn_side != side_none)
-		{
-#if DXX_BUILD_DESCENT == 2
-			if (WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, seg1, conn_side) & wid_flag)
-#endif
-			{
-				return vm_vec_dist_quick(p0, p1);
-			}
-		}
-	}
-
-#if DXX_BUILD_DESCENT == 2
-	//	Periodically flush cache.
-	if ((GameTime64 - Last_fcd_flush_time > F1_0*2) || (GameTime64 < Last_fcd_flush_time)) {
-		flush_fcd_cache();
-	}
-
-	else
-	//	Can't quickly get distance, so see if in Fcd_cache.
-	range_for (auto &i, Fcd_cache)
-		if (i.seg0 == seg0 && i.seg1 == seg1)
-		{
-			return i.dist;
-		}
-#endif
+	std::array<point_seg, fcd_max_depth + 2> point_segs;
 
-	num_points = 0;
-
-	std::array<uint16_t, MAX_SEGMENTS> depth{};
-	visited_segment_bitarray_t visited;
-
-	cur_seg = seg0;
+	segnum_t cur_seg = seg0;
 	visited[cur_seg] = true;
-	cur_depth = 0;
+	unsigned cur_depth{0}, queued_depth{0};
+	p.r = fcd_path::result::beyond;
 
 	while (cur_seg != seg1) {
 		const cscusegment segp = *vmsegptr(cur_seg);
@@ -1084,72 +1248,251 @@ vm_distance find_connected_distance(const vms_vector &p0, const vcsegptridx_t se
 			if (wid_flag == wall_is_doorway_mask::None || (WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, segp, snum) & wid_flag))
 			{
 				v = true;
-					seg_queue[qtail].start = cur_seg;
-					seg_queue[qtail].end = this_seg;
-					depth[qtail++] = cur_depth+1;
-					if (max_depth != -1) {
-						if (depth[qtail-1] == max_depth) {
-							add_to_fcd_cache(seg0, seg1, fcd_abort_cache_value);
-							return fcd_abort_return_value;
-						}
-					} else if (this_seg == seg1) {
-						goto fcd_done1;
-					}
+				seg_queue[qtail].start = cur_seg;
+				seg_queue[qtail].end = this_seg;
+				queued_depth = depth[qtail++] = cur_depth + 1;
+				if (queued_depth == max_depth)
+				{
+					p.depth = max_depth;
+					return;
+				}
 			}
 		}	//	for (sidenum...
 
 		if (qhead >= qtail) {
-			add_to_fcd_cache(seg0, seg1, fcd_abort_cache_value);
-			return fcd_abort_return_value;
+			p.depth = fcd_unreachable_depth;
+			return;
 		}
 
 		cur_seg = seg_queue[qhead].end;
 		cur_depth = depth[qhead];
 		qhead++;
-
-fcd_done1: ;
 	}	//	while (cur_seg ...
+	p.r = fcd_path::result::found;
+	p.depth = cur_depth;
+	p.deeper = queued_depth > cur_depth;
 
-	//	Set qtail to the segment which ends at the goal.
-	while (seg_queue[--qtail].end != seg1)
-		if (qtail < 0) {
-			add_to_fcd_cache(seg0, seg1, fcd_abort_cache_value);
-			return fcd_abort_return_value;
-		}
-
-	auto &vcvertptr = Vertices.vcptr;
-	while (qtail >= 0) {
-		segnum_t	parent_seg, this_seg;
-
-		this_seg = seg_queue[qtail].end;
-		parent_seg = seg_queue[qtail].start;
-		point_segs[num_points].point = compute_segment_center(vcvertptr, vcsegptr(this_seg));
-		num_points++;
-
+	//	The points run from the center of seg1 back to the center of seg0.
+	unsigned num_points{0};
+	for (qtail = qhead - 1;; )
+	{
+		const auto parent_seg = seg_queue[qtail].start;
+		point_segs[num_points++].point = compute_segment_center(vcvertptr, vcsegptr(seg_queue[qtail].end));
 		if (parent_seg == seg0)
 			break;
-
 		while (seg_queue[--qtail].end != parent_seg)
-			Assert(qtail >= 0);
+			assert(qtail >= 0);
 	}
+	point_segs[num_points++].point = compute_segment_center(vcvertptr, seg0);
 
-	point_segs[num_points].point = compute_segment_center(vcvertptr, seg0);
-	num_points++;
+	p.near1 = point_segs[1].point;
+	p.near0 = point_segs[num_points - 2].point;
+	vm_distance inner{0};
+	for (unsigned i = 1; i + 2 < num_points; ++i)
+		inner += vm_vec_dist_quick(point_segs[i].point, point_segs[i + 1].point);
+	p.inner = inner;
+}
 
-	if (num_points == 1) {
-		return vm_vec_dist_quick(p0, p1);
+//	find_connected_distance_from keeps one search from seg0 to every
+//	segment it reaches, in the order fcd_search would visit them, so that
+//	the queries of all the sounds around the listener share it.
+struct fcd_source_search
+{
+	segnum_t seg0{segment_none};
+	wall_is_doorway_mask wid_flag;
+	uint32_t generation;
+	//	fcd_unreachable_depth for a segment that is not reached
+	std::array<uint8_t, MAX_SEGMENTS> depth;
+	std::array<segnum_t, MAX_SEGMENTS> parent;
+	//	The position of each segment in the queue, seg0 being 0
+	std::array<uint16_t, MAX_SEGMENTS> order;
+	//	The position of the segment whose children included the first
+	//	segment at each depth.  A search limited to that depth stops there.
+	std::array<uint16_t, fcd_max_depth + 1> first_queued_by;
+};
+
+static fcd_source_search Fcd_source;
+
+static void fcd_search_all(fcd_source_search &s, fvcwallptr &vcwallptr, const vcsegptridx_t seg0, const wall_is_doorway_mask wid_flag)
+{
+	s.depth.fill(fcd_unreachable_depth);
+	s.first_queued_by.fill(UINT16_MAX);
+	std::array<segnum_t, MAX_SEGMENTS> seg_queue;
+	std::size_t qhead{0}, qtail{0};
+	const segnum_t start{seg0};
+	seg_queue[qtail++] = start;
+	s.depth[start] = 0;
+	s.parent[start] = start;
+	for (uint16_t n = 0; qhead != qtail; ++n)
+	{
+		const auto cur_seg = seg_queue[qhead++];
+		const unsigned cur_depth = s.depth[cur_seg];
+		//	Segments are taken from the queue in order of depth, and no
+		//	search goes past this one.
+		if (cur_depth == fcd_max_depth)
+			break;
+		s.order[cur_seg] = n;
+		const cscusegment segp = *vmsegptr(cur_seg);
+		for (const auto snum : MAX_SIDES_PER_SEGMENT)
+		{
+			const auto this_seg = segp.s.children[snum];
+			if (!IS_CHILD(this_seg))
+				continue;
+			auto &d = s.depth[this_seg];
+			if (d != fcd_unreachable_depth)
+				continue;
+			if (wid_flag == wall_is_doorway_mask::None || (WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, segp, snum) & wid_flag))
+			{
+				d = cur_depth + 1;
+				s.parent[this_seg] = cur_seg;
+				seg_queue[qtail++] = this_seg;
+				if (auto &f = s.first_queued_by[cur_depth + 1]; f == UINT16_MAX)
+					f = n;
+			}
+		}
 	}
-	auto dist = vm_vec_dist_quick(p1, point_segs[1].point);
-		dist += vm_vec_dist_quick(p0, point_segs[num_points-2].point);
+}
 
-		for (int i=1; i<num_points-2; i++) {
-			dist += vm_vec_dist_quick(point_segs[i].point, point_segs[i+1].point);
+//	A limit of 0 would not stop the search, and a negative one is taken as
+//	no limit, so both search as deep as the points allow.
+static unsigned fcd_limit_depth(int max_depth)
+{
+#ifdef WINDOWS
+	if (max_depth == -1) max_depth = 200;
+#endif
+	if (max_depth <= 0 || max_depth > static_cast<int>(fcd_max_depth))
+		return fcd_max_depth;
+	return max_depth;
+}
+
+//	Whether the distance is the straight line between the points, without
+//	a search: when they are in the same segment, or in neighbors.
+static bool fcd_is_direct(fvcwallptr &vcwallptr, const vcsegptridx_t seg0, const vcsegptridx_t seg1, const wall_is_doorway_mask wid_flag)
+{
+	if (seg0 == seg1)
+		return true;
+	auto conn_side = find_connect_side(seg0, seg1);
+	if (conn_side != side_none)
+	{
+#if DXX_BUILD_DESCENT == 2
+		if (WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, seg1, conn_side) & wid_flag)
+#else
+		(void)vcwallptr;
+		(void)wid_flag;
+#endif
+		{
+			return true;
 		}
+	}
+	return false;
+}
+
+}
 
-	add_to_fcd_cache(seg0, seg1, dist);
+//	----------------------------------------------------------------------------------------------------------
+void flush_fcd_cache()
+{
+	++Fcd_paths.generation;
+}
 
+uint32_t wall_state_generation(fvcwallptr &vcwallptr)
+{
+	return fcd_path_generation(vcwallptr);
+}
+
+//	----------------------------------------------------------------------------------------------------------
+//	Determine whether seg0 and seg1 are reachable in a way that allows sound to pass.
+//	Search up to a maximum depth of max_depth.
+//	Return the distance.
+vm_distance find_connected_distance(const vms_vector &p0, const vcsegptridx_t seg0, const vms_vector &p1, const vcsegptridx_t seg1, const int max_depth_arg, const wall_is_doorway_mask wid_flag)
+{
+	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
+	auto &Vertices = LevelSharedVertexState.get_vertices();
+
+	const int max_depth = fcd_limit_depth(max_depth_arg);
+
+	auto &Walls = LevelUniqueWallSubsystemState.Walls;
+	auto &vcwallptr = Walls.vcptr;
+	if (fcd_is_direct(vcwallptr, seg0, seg1, wid_flag))
+		return vm_vec_dist_quick(p0, p1);
+
+	//	The editor changes segments without telling the table
+	const bool use_table{
+#if DXX_USE_EDITOR
+		!EditorWindow
+#else
+		true
+#endif
+	};
+	fcd_path uncached;
+	auto &p = use_table ? Fcd_paths.paths[fcd_path_slot(seg0, seg1, wid_flag)] : uncached;
+	const auto generation{use_table ? fcd_path_generation(vcwallptr) : 0};
+	if (!use_table || p.generation != generation || p.seg0 != seg0 || p.seg1 != seg1 || p.wid_flag != wid_flag || (p.r == fcd_path::result::beyond && p.depth < max_depth))
+	{
+		fcd_search(p, Vertices.vcptr, vcwallptr, seg0, seg1, max_depth, wid_flag);
+		p.seg0 = seg0;
+		p.seg1 = seg1;
+		p.wid_flag = wid_flag;
+		p.generation = generation;
+	}
+	if (p.r == fcd_path::result::beyond)
+		return fcd_abort_return_value;
+	//	A path found by a deeper search may still be beyond this one
+	if (p.depth >= max_depth || (p.depth + 1 == max_depth && p.deeper))
+		return fcd_abort_return_value;
+	auto dist = vm_vec_dist_quick(p1, p.near1);
+	dist += vm_vec_dist_quick(p0, p.near0);
+	dist += p.inner;
 	return dist;
+}
+
+//	----------------------------------------------------------------------------------------------------------
+vm_distance find_connected_distance_from(const vms_vector &p0, const vcsegptridx_t seg0, const vms_vector &p1, const vcsegptridx_t seg1, const int max_depth_arg, const wall_is_doorway_mask wid_flag)
+{
+#if DXX_USE_EDITOR
+	//	The editor changes segments without telling the search
+	if (EditorWindow)
+		return find_connected_distance(p0, seg0, p1, seg1, max_depth_arg, wid_flag);
+#endif
+	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
+	auto &vcvertptr = LevelSharedVertexState.get_vertices().vcptr;
+	const auto max_depth{fcd_limit_depth(max_depth_arg)};
+	auto &Walls = LevelUniqueWallSubsystemState.Walls;
+	auto &vcwallptr = Walls.vcptr;
+	if (fcd_is_direct(vcwallptr, seg0, seg1, wid_flag))
+		return vm_vec_dist_quick(p0, p1);
 
+	auto &s = Fcd_source;
+	if (const auto generation{fcd_path_generation(vcwallptr)}; s.generation != generation || s.seg0 != seg0 || s.wid_flag != wid_flag)
+	{
+		fcd_search_all(s, vcwallptr, seg0, wid_flag);
+		s.seg0 = seg0;
+		s.wid_flag = wid_flag;
+		s.generation = generation;
+	}
+	//	A search limited to max_depth stops when it queues the first
+	//	segment that deep, so seg1 must be taken from the queue before.
+	const segnum_t target{seg1};
+	if (const unsigned d = s.depth[target]; d >= max_depth || s.order[target] > s.first_queued_by[max_depth])
+		return fcd_abort_return_value;
+
+	//	The same points as fcd_search: the centers of the segments next
+	//	to either end, and the path between them.
+	segnum_t near = s.parent[target];
+	auto center{compute_segment_center(vcvertptr, vcsegptr(near))};
+	auto dist = vm_vec_dist_quick(p1, center);
+	if (near == seg0)
+		center = compute_segment_center(vcvertptr, seg1);
+	else
+		while (s.depth[near] > 1)
+		{
+			near = s.parent[near];
+			auto next{compute_segment_center(vcvertptr, vcsegptr(near))};
+			dist += vm_vec_dist_quick(center, next);
+			center = next;
+		}
+	dist += vm_vec_dist_quick(p0, center);
+	return dist;
 }
 
 }
@@ -1312,6 +1655,16 @@ namespace dcx {
 namespace {
 #endif
 
+static void set_side_face_vertices(shared_segment &sp, const sidenum_t sidenum)
+{
+	auto &s = sp.sides[sidenum];
+	const auto &&[num_faces, vertex_list] = create_abs_vertex_lists(sp, s, sidenum);
+	s.face_vertices = vertex_list;
+	s.plane_vertex = (num_faces != vertex_array_side_type::quad)
+		? std::min(vertex_list[0], vertex_list[2])
+		: *std::ranges::min_element(std::span(vertex_list).first<4>());
+}
+
 // -------------------------------------------------------------------------------
 void create_walls_on_side(fvcvertptr &vcvertptr, shared_segment &sp, const sidenum_t sidenum)
 {
@@ -1353,12 +1706,16 @@ void create_walls_on_side(fvcvertptr &vcvertptr, shared_segment &sp, const siden
 			s1 = sign(dist1);
 
 		if (!(s0 == 0 || s1 == 0 || s0 != s1))
+		{
+			set_side_face_vertices(sp, sidenum);
 			return;
+		}
 		//detriangulate!
 	}
 	s.type = side_type::quad;
 	s.normals[0] = vn;
 	s.normals[1] = vn;
+	set_side_face_vertices(sp, sidenum);
 }
 
 // -------------------------------------------------------------------------------
@@ -24,8 +24,12 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  */
 
 #include "dxxsconf.h"
+#include <atomic>
 #include <cctype>
+#include <future>
+#include <string>
 #include <utility>
+#include <vector>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,6 +44,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #endif
 
 #include "inferno.h"
+#include "load_trace.h"
 #include "game.h"
 #include "player.h"
 #include "key.h"
@@ -51,6 +56,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "event.h"
 #include "screens.h"
 #include "textures.h"
+#include "texmerge.h"
 #include "gauges.h"
 #include "3d.h"
 #include "effects.h"
@@ -925,6 +931,44 @@ static const d_fname &get_level_file(int level_num)
 		return Current_mission->level_names[level_num - 1];
 }
 
+/* The files of the next level are read through once on a worker, from
+ * when the player leaves the level, so that loading it finds them in
+ * the system's file cache instead of waiting on the disk.  The bytes
+ * are not kept: the loaders read through PhysFS handles, and the mine
+ * cannot be parsed ahead, since parsing writes over the level that is
+ * still being shown.
+ */
+struct level_prefetch
+{
+	std::string level_name;
+	std::atomic<bool> cancel;
+	std::future<void> done;
+};
+
+static level_prefetch Level_prefetch;
+
+/* Read each file that opens, until told to stop.  A list of alternative
+ * names for one file is given as one entry of `names`, and only the
+ * first of them that opens is read.
+ */
+static void level_prefetch_read(const std::vector<std::vector<std::string>> &names, const std::atomic<bool> &cancel)
+{
+	std::array<uint8_t, 64 * 1024> buf;
+	for (auto &alternatives : names)
+		for (auto &n : alternatives)
+		{
+			std::array<char, PATH_MAX> name{};
+			n.copy(name.data(), name.size() - 1);
+			auto fp{PHYSFSX_openReadBuffered_updateCase(name.data()).first};
+			if (!fp)
+				continue;
+			while (!cancel.load(std::memory_order_relaxed) && PHYSFS_readBytes(fp, buf.data(), buf.size()) > 0)
+			{
+			}
+			break;
+		}
+}
+
 // routine to calculate the checksum of the segments.
 static void do_checksum_calc(const uint8_t *b, int len, unsigned int *s1, unsigned int *s2)
 {
@@ -1036,8 +1080,57 @@ void load_level_robots(const d_fname &level_name)
 
 //load a level off disk. level numbers start at 1.  Secret levels are -1,-2,-3
 namespace dsx {
+
+void gameseq_prefetch_level(const int level_num)
+{
+	if (!Current_mission || !level_num || level_num > Current_mission->last_level || level_num < Current_mission->last_secret_level)
+		return;
+	const d_fname &level_name = get_level_file(level_num);
+	if (Level_prefetch.done.valid() && Level_prefetch.level_name == level_name.data())
+		return;
+	gameseq_cancel_level_prefetch();
+	Level_prefetch.level_name = level_name.data();
+	std::vector<std::vector<std::string>> names;
+	/* Where load_level looks for the level: by its name, then beside the
+	 * mission file
+	 */
+	names.push_back({level_name.data(), std::string(Current_mission->path.cbegin(), Current_mission->filename) + level_name.data()});
+#if DXX_BUILD_DESCENT == 2
+	if (std::array<char, FILENAME_LEN> hxm; change_filename_extension(hxm, level_name, "HXM"))
+		names.push_back({hxm.data()});
+#endif
+	Level_prefetch.cancel = false;
+	Level_prefetch.done = std::async(std::launch::async, [names = std::move(names)]() {
+		level_prefetch_read(names, Level_prefetch.cancel);
+	});
+}
+
+void gameseq_prefetch_next_level()
+{
+	/* Usually the next level, so that its files are read during the exit
+	 * and the score screen.  StartNewLevel prefetches again if the guess
+	 * is wrong.
+	 */
+	if (Current_mission && Current_level_num > 0 && Current_level_num != Current_mission->last_level)
+		gameseq_prefetch_level(Current_level_num + 1);
+}
+
+void gameseq_cancel_level_prefetch()
+{
+	if (!Level_prefetch.done.valid())
+		return;
+	Level_prefetch.cancel = true;
+	Level_prefetch.done.get();
+	Level_prefetch.level_name.clear();
+}
+
 void LoadLevel(int level_num,int page_in_textures)
 {
+	const load_trace_span trace{"LoadLevel"};
+	/* Loading reads the files itself from here, so a prefetch that is
+	 * still running would only compete with it
+	 */
+	gameseq_cancel_level_prefetch();
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &Vertices = LevelSharedVertexState.get_vertices();
@@ -1798,6 +1891,12 @@ static window_event_result (AdvanceLevel)(
 #endif
 	if (Current_level_num != Current_mission->last_level)
 	{
+		/* Usually the next level, so its song loads during the score
+		 * screen.  StartNewLevel prefetches again if the guess is wrong.
+		 */
+		if (Current_level_num > 0)
+			songs_prefetch_level_song(Current_level_num + 1);
+		gameseq_prefetch_next_level();
 		if (+(Game_mode & GM_MULTI))
 		{
 			const auto result = multi_endlevel_score();
@@ -1981,6 +2080,7 @@ window_event_result StartNewLevelSub(const d_robot_info_array &Robot_info, const
 window_event_result StartNewLevelSub(const d_robot_info_array &Robot_info, const int level_num, const int page_in_textures, const secret_restore secret_flag)
 #endif
 {
+	const load_trace_span trace{"StartNewLevelSub"};
 	auto &LevelUniqueControlCenterState = LevelUniqueObjectState.ControlCenterState;
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &vmobjptr = Objects.vmptr;
@@ -2085,6 +2185,8 @@ window_event_result StartNewLevelSub(const d_robot_info_array &Robot_info, const
 
 #if DXX_USE_OGL
 	ogl_cache_level_textures();
+#else
+	texmerge_cache_level_textures(GameBitmaps, Textures);
 #endif
 
 
@@ -2210,6 +2312,9 @@ window_event_result StartNewLevel(int level_num)
 	/* Autosave is permitted immediately on entering a new level */
 	state_set_immediate_autosave(GameUniqueState);
 	ThisLevelTime = {};
+	songs_prefetch_level_song(level_num);
+	/* Read the level's files while the briefing is shown */
+	gameseq_prefetch_level(level_num);
 
 #if DXX_BUILD_DESCENT == 1
 	if (!(Game_mode & GM_MULTI)) {
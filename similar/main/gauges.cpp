@@ -29,6 +29,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <optional>
 #include <ranges>
 
 #include "hudmsg.h"
@@ -50,6 +51,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "controls.h"
 #include "text.h"
 #include "render.h"
+#include "screens.h"
 #include "piggy.h"
 #include "laser.h"
 #include "weapon.h"
@@ -590,6 +592,10 @@ static int score_display;
 static fix score_time;
 static laser_level old_laser_level;
 static int invulnerable_frame;
+/* Bumped by init_gauges, which discards the weapon box state, so that the
+ * status bar is drawn again
+ */
+static unsigned retained_gauge_generation;
 }
 int	Color_0_31_0 = -1;
 
@@ -884,6 +890,14 @@ struct gauge_inset_window
 	weapon_box_user user{weapon_box_user::weapon};
 	uint8_t overlap_dirty{};
 	fix time_static_played{};
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+	/* The view whose copy the window shows, and the frames since it was
+	 * rendered, for render_inset_view_reduced
+	 */
+	const object *view_viewer{};
+	int view_rear{};
+	unsigned view_age{};
+#endif
 #endif
 };
 
@@ -2280,6 +2294,7 @@ void init_gauges()
 {
 	inset_window = {};
 	old_laser_level	= {};
+	++retained_gauge_generation;
 }
 }
 
@@ -3915,6 +3930,178 @@ void draw_hud(const d_robot_info_array &Robot_info, grs_canvas &canvas, const ob
 	}
 }
 
+namespace {
+
+/* Everything that the status bar shows.  When it is the same on two
+ * frames in a row, the status bar is copied, and later frames put the
+ * copy back in one draw until something changes.
+ */
+struct retained_gauge_state
+{
+	unsigned generation;
+	uint16_t screen_width, screen_height;
+	HudType hud_mode;
+	game_mode_flags game_mode;
+	int shields, energy;
+	uint32_t powerup_flags;
+	primary_weapon_index primary_weapon;
+	secondary_weapon_index secondary_weapon;
+	enum laser_level laser_level;
+	uint16_t vulcan_ammo;
+	per_secondary_weapon_array<uint8_t> secondary_ammo;
+#if DXX_BUILD_DESCENT == 1
+	uint8_t bomb_gauge;
+#elif DXX_BUILD_DESCENT == 2
+	fix omega_charge;
+	fix afterburner_charge;
+	uint8_t secondary_last_was_super;
+#endif
+	player_ship_color ship_color;
+	uint16_t lives;
+	int score;
+	int16_t net_kills_total, net_killed_total;
+	bool operator==(const retained_gauge_state &) const = default;
+};
+
+/* What render_gauges drew last, and whether the screen copy is of it */
+static std::optional<retained_gauge_state> retained_gauges_drawn;
+static bool retained_gauges_copied;
+#if !DXX_USE_OGL
+static grs_canvas_ptr retained_gauge_canvas;
+#endif
+
+static int get_gauge_shields(const object &plrobj)
+{
+	const auto shields = f2ir(plrobj.shields);
+	return shields < 0 ? 0 : shields;
+}
+
+/* Returns nothing while any gauge is animating, or the status bar is not
+ * shown, since then it must be drawn every frame.
+ */
+static std::optional<retained_gauge_state> get_retained_gauge_state(const object &plrobj, const game_mode_flags Game_mode)
+{
+	if (PlayerCfg.CockpitMode[1] != cockpit_mode_t::status_bar)
+		return std::nullopt;
+	/* Recording writes the gauge values to the demo as they are drawn */
+	if (Newdemo_state == ND_STATE_RECORDING)
+		return std::nullopt;
+#if DXX_USE_STEREOSCOPIC_RENDER
+	if (VR_stereo != StereoFormat::None)
+		return std::nullopt;
+#endif
+	auto &player_info = plrobj.ctype.player_info;
+	auto &pl_flags = player_info.powerup_flags;
+	if (pl_flags & (PLAYER_FLAGS_CLOAKED | PLAYER_FLAGS_INVULNERABLE))
+		return std::nullopt;
+	if (score_display)
+		return std::nullopt;
+	for (auto &inset : inset_window)
+	{
+		if (inset.box_state != weapon_box_state::set)
+			return std::nullopt;
+#if DXX_BUILD_DESCENT == 2
+		if (inset.user != weapon_box_user::weapon)
+			return std::nullopt;
+#endif
+	}
+	return retained_gauge_state{
+		.generation = retained_gauge_generation,
+		.screen_width = grd_curscreen->get_screen_width(),
+		.screen_height = grd_curscreen->get_screen_height(),
+		.hud_mode = PlayerCfg.HudMode,
+		.game_mode = Game_mode,
+		.shields = get_gauge_shields(plrobj),
+		.energy = f2ir(player_info.energy),
+		.powerup_flags = pl_flags.get_player_flags(),
+		.primary_weapon = player_info.Primary_weapon.get_active(),
+		.secondary_weapon = player_info.Secondary_weapon.get_active(),
+		.laser_level = player_info.laser_level,
+		.vulcan_ammo = player_info.vulcan_ammo,
+		.secondary_ammo = player_info.secondary_ammo,
+#if DXX_BUILD_DESCENT == 1
+		.bomb_gauge = PlayerCfg.BombGauge,
+#elif DXX_BUILD_DESCENT == 2
+		.omega_charge = player_info.Omega_charge,
+		.afterburner_charge = Afterburner_charge,
+		.secondary_last_was_super = player_info.Secondary_last_was_super,
+#endif
+		.ship_color = get_player_or_team_color(Netgame, Game_mode, Player_num),
+		.lives = get_local_player().lives,
+		.score = player_info.mission.score,
+		.net_kills_total = player_info.net_kills_total,
+		.net_killed_total = player_info.net_killed_total,
+	};
+}
+
+/* The status bar fills the screen below the 3d window */
+static std::array<int, 4> get_retained_gauge_region()
+{
+	const auto &bm = Screen_3d_window.cv_bitmap;
+	const int y = bm.bm_y + bm.bm_h;
+	return {{0, y, grd_curscreen->get_screen_width(), grd_curscreen->get_screen_height() - y}};
+}
+
+static void retain_gauges(grs_canvas &canvas, const std::optional<retained_gauge_state> &state)
+{
+	if (!state)
+	{
+		retained_gauges_drawn.reset();
+		retained_gauges_copied = false;
+		return;
+	}
+	if (state != retained_gauges_drawn)
+	{
+		/* Wait to see whether it changes again before copying */
+		retained_gauges_drawn = state;
+		retained_gauges_copied = false;
+		return;
+	}
+	if (retained_gauges_copied)
+		return;
+	const auto [x, y, w, h] = get_retained_gauge_region();
+	if (w <= 0 || h <= 0)
+		return;
+#if DXX_USE_OGL
+	(void)canvas;
+	ogl_retain_screen_region(x, y, w, h);
+#else
+	if (!retained_gauge_canvas || retained_gauge_canvas->cv_bitmap.bm_w != w || retained_gauge_canvas->cv_bitmap.bm_h != h)
+		retained_gauge_canvas = gr_create_canvas(w, h);
+	gr_bm_ubitblt(*retained_gauge_canvas, w, h, 0, 0, x, y, canvas.cv_bitmap);
+#endif
+	retained_gauges_copied = true;
+}
+
+}
+
+bool draw_retained_gauges(grs_canvas &canvas, const game_mode_flags Game_mode)
+{
+	if (!retained_gauges_copied)
+		return false;
+	auto &vmobjptr = LevelUniqueObjectState.Objects.vmptr;
+	const auto state = get_retained_gauge_state(get_local_plrobj(), Game_mode);
+	if (!state || state != retained_gauges_drawn)
+		return false;
+	const auto [x, y, w, h] = get_retained_gauge_region();
+#if DXX_USE_OGL
+	(void)canvas;
+	if (!ogl_draw_screen_region(x, y, w, h))
+	{
+		retained_gauges_copied = false;
+		return false;
+	}
+#else
+	if (!retained_gauge_canvas || retained_gauge_canvas->cv_bitmap.bm_w != w || retained_gauge_canvas->cv_bitmap.bm_h != h)
+	{
+		retained_gauges_copied = false;
+		return false;
+	}
+	gr_bm_ubitblt(canvas, w, h, x, y, 0, 0, retained_gauge_canvas->cv_bitmap);
+#endif
+	return true;
+}
+
 //print out some player statistics
 void render_gauges(grs_canvas &canvas, const game_mode_flags Game_mode)
 {
@@ -3928,8 +4115,7 @@ void render_gauges(grs_canvas &canvas, const game_mode_flags Game_mode)
 
 	assert(PlayerCfg.CockpitMode[1] == cockpit_mode_t::full_cockpit || PlayerCfg.CockpitMode[1] == cockpit_mode_t::status_bar);
 
-	auto shields = f2ir(plrobj.shields);
-	if (shields < 0 ) shields = 0;
+	const auto shields = get_gauge_shields(plrobj);
 
 	gr_set_curfont(canvas, *GAME_FONT);
 
@@ -4020,6 +4206,7 @@ void render_gauges(grs_canvas &canvas, const game_mode_flags Game_mode)
 	else
 		draw_player_ship(hudctx, player_info, cloak, SB_SHIP_GAUGE_X, SB_SHIP_GAUGE_Y);
 #endif
+	retain_gauges(canvas, get_retained_gauge_state(plrobj, Game_mode));
 }
 
 //	---------------------------------------------------------------------------------------------------------
@@ -4049,12 +4236,51 @@ void do_cockpit_window_view(const gauge_inset_window_view win, const weapon_box_
 	if (inset_user == weapon_box_user::weapon || inset_user == weapon_box_user::post_missile_static)
 		return;		//already set
 	inset_user = user;
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+	inset.view_viewer = nullptr;
+#endif
 	if (inset.overlap_dirty) {
 		inset.overlap_dirty = 0;
 		gr_set_default_canvas();
 	}
 }
 
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+/* With -gl_insetscale, render the view at a fraction of the window's
+ * size and scale it up.  With -gl_insetrate, render it only every few
+ * frames, and show the copy of the last render in between.  Returns
+ * false, drawing nothing, if neither is in use.
+ */
+static bool render_inset_view_reduced(grs_canvas &window_canv, const gauge_inset_window_view win, const object &viewer, const int rear_view_flag, window_rendered_data &window)
+{
+	const unsigned divisor{std::max(CGameArg.OglInsetScale, 1u)};
+	const unsigned interval{std::max(CGameArg.OglInsetRate, 1u)};
+	if (divisor == 1 && interval == 1)
+		return false;
+	auto &inset = inset_window[win];
+	const auto view{underlying_value(win)};
+	const auto &bm = window_canv.cv_bitmap;
+	if (inset.view_viewer == &viewer && inset.view_rear == rear_view_flag && ++inset.view_age < interval && ogl_draw_view_region(view, bm.bm_x, bm.bm_y, bm.bm_w, bm.bm_h))
+		return true;
+	const int w{std::max(bm.bm_w / static_cast<int>(divisor), 1)};
+	const int h{std::max(bm.bm_h / static_cast<int>(divisor), 1)};
+	grs_subcanvas view_canv;
+	gr_init_sub_canvas(view_canv, window_canv, 0, 0, w, h);
+	gr_set_current_canvas(view_canv);
+	render_frame(view_canv, 0, window);
+	/* Copy the small render, and draw the copy over the whole window,
+	 * covering the render
+	 */
+	ogl_retain_view_region(view, bm.bm_x, bm.bm_y, w, h);
+	ogl_draw_view_region(view, bm.bm_x, bm.bm_y, bm.bm_w, bm.bm_h);
+	inset.view_viewer = &viewer;
+	inset.view_rear = rear_view_flag;
+	inset.view_age = 0;
+	gr_set_current_canvas(window_canv);
+	return true;
+}
+#endif
+
 void do_cockpit_window_view(grs_canvas &canvas, const gauge_inset_window_view win, const object &viewer, const int rear_view_flag, const weapon_box_user user, const char *const label, const player_info *const player_info)
 {
 	grs_subcanvas window_canv;
@@ -4113,6 +4339,9 @@ void do_cockpit_window_view(grs_canvas &canvas, const gauge_inset_window_view wi
 		goto abort;
 	}
 	else
+#endif
+#if DXX_USE_OGL && !DXX_USE_VULKAN
+	if (!render_inset_view_reduced(window_canv, win, viewer, rear_view_flag, window))
 #endif
 		render_frame(window_canv, 0, window);
 
@@ -80,8 +80,8 @@ struct iff_bitmap_header : prohibit_void_ptr<iff_bitmap_header>
 
 }
 
-ubyte iff_transparent_color;
-ubyte iff_has_transparency;	// 0=no transparency, 1=iff_transparent_color is valid
+thread_local ubyte iff_transparent_color;
+thread_local ubyte iff_has_transparency;	// 0=no transparency, 1=iff_transparent_color is valid
 
 #define form_sig MAKE_SIG('F','O','R','M')
 #define ilbm_sig MAKE_SIG('I','L','B','M')
@@ -56,9 +56,12 @@ char copyright[] = "DESCENT II  COPYRIGHT (C) 1994-1996 PARALLAX SOFTWARE CORPOR
 
 #include <cctype>
 #include <locale>
+#include <optional>
+#include <thread>
 #include "pstypes.h"
 #include "strutil.h"
 #include "console.h"
+#include "cmd.h"
 #include "gr.h"
 #include "key.h"
 #include "bm.h"
@@ -81,12 +84,17 @@ char copyright[] = "DESCENT II  COPYRIGHT (C) 1994-1996 PARALLAX SOFTWARE CORPOR
 #include "config.h"
 #include "multi.h"
 #include "gameseq.h"
+#include "load_trace.h"
+#include "parallel.h"
+#include "mission.h"
+#include "piggy.h"
 #if DXX_BUILD_DESCENT == 2
 #include "gamepal.h"
 #include "movie.h"
 #endif
 #include "playsave.h"
 #include "newdemo.h"
+#include "state.h"
 #include "joy.h"
 #if !DXX_USE_OGL
 #include "../texmap/scanline.h" //for select_tmap -MM
@@ -183,9 +191,23 @@ static void print_commandline_help()
 	VERB("  -add-missions-dir <s>         Add contents of location <s> to the missions directory\n")	\
 	VERB("  -use_players_dir              Put player files and saved games in Players subdirectory\n")	\
 	VERB("  -lowmem                       Lowers animation detail for better performance with\n\t\t\t\tlow memory\n")	\
+	VERB("  -pvs                          Precompute which segments can see each other when a level loads\n")	\
+	VERB("  -levelcache                   Keep data precomputed for each level in cache files\n")	\
+	VERB("  -rlecache <n>                 Keep up to <n> KB of decompressed bitmaps (default: 4096)\n")	\
+	VERB("  -bitmapcache <n>              Keep up to <n> KB of bitmaps read from the PIG, at least 1024\n\t\t\t\t(default: 0, the built in size)\n")	\
+	VERB("  -texmergecache <n>            Keep up to <n> KB of textures merged with overlays (default: 2048)\n")	\
+	VERB("  -physicstick <n>              Move objects in fixed steps of <n> per second, drawn in between\n\t\t\t\t(default: 0, moves once per frame)\n")	\
+	VERB("  -aibudget <n>                 Let far, unseen robots think less often when AI takes over <n> ms\n\t\t\t\tper frame (default: 0, every robot thinks every frame)\n")	\
+	VERB("  -threads <n>                  Split game work over at most <n> threads (default: 0, one per core);\n\t\t\t\t1 runs it all on the main thread\n")	\
 	VERB("  -pilot <s>                    Select pilot <s> automatically\n")	\
+	VERB("  -autoexec <s>                 Execute the console commands in file <s> at startup\n")	\
+	DXX_COMMAND_LINE_HELP_SDL(	\
+		VERB("  -headless                     Run without video, sound or titles, ticking 30 times a second\n\t\t\t\tunless -maxfps is given; use with -pilot and -autoexec\n")	\
+	)	\
 	VERB("  -auto-record-demo             Start recording on level entry\n")	\
 	VERB("  -record-demo-format           Set demo name automatically\n")	\
+	VERB("  -compress-demo                Record demos in compressed blocks\n")	\
+	VERB("  -timedemo <s>                 Play demo <s> as fast as possible, report frame times and quit;\n\t\t\t\twith -headless, play without drawing\n")	\
 	VERB("  -autodemo                     Start in demo mode\n")	\
 	VERB("  -window                       Run the game in a window\n")	\
 	VERB("  -noborders                    Don't show borders in window mode\n")	\
@@ -208,6 +230,7 @@ static void print_commandline_help()
 	)	\
 	DXX_if_defined_01(DXX_USE_SDLMIXER, (	\
 		VERB("  -nosdlmixer                   Disable Sound output via SDL_mixer\n")	\
+		VERB("  -sndbuffer <n>                Mix <n> samples per buffer, smaller for less latency\n")	\
 	))	\
 	VERB("\n Graphics:\n\n")	\
 	VERB("  -lowresfont                   Force use of low resolution fonts\n")	\
@@ -226,6 +249,20 @@ static void print_commandline_help()
 		VERB("                                    5: Auto: if VSync is enabled and ARB_sync is supported, use mode 2, otherwise mode 0\n")	\
 		VERB("  -gl_syncwait <n>              Wait interval (ms) for sync mode 2 (default: " DXX_STRINGIZE(OGL_SYNC_WAIT_DEFAULT) ")\n")	\
 		VERB("  -gl_darkedges                 Re-enable dark edges around filtered textures (as present in earlier versions of the engine)\n")	\
+		VERB("  -gl_staticgeometry            Keep the level's wall geometry in a static vertex buffer\n")	\
+		VERB("  -gl_streambuffer              Stream textured polygons through a persistently mapped buffer (OpenGL 4.4)\n")	\
+		VERB("  -gl_fronttoback               Draw the opaque walls nearest first, so hidden walls are not textured\n")	\
+		VERB("  -gl_modelmatrix               Move the points of robots and other models by their submodel matrices in OpenGL\n")	\
+		VERB("  -gl_insetscale <n>            Render the views in the cockpit windows at 1/<n> of their size (default: 1)\n")	\
+		VERB("  -gl_insetrate <n>             Render the views in the cockpit windows every <n>th frame (default: 1)\n")	\
+		VERB("  -gl_texturebudget <n>         Unload unused textures when more than <n> MB are loaded (default: 0, no limit)\n")	\
+		VERB("  -gl_texcache                  Keep block compressed level textures in a cache file\n")	\
+		DXX_if_defined_01(DXX_USE_VULKAN, (	\
+		VERB("  -vk_arraytextures             Draw level textures from one Vulkan array texture\n")	\
+		VERB("  -vk_recordthreads <n>         Record Vulkan draws on <n> extra threads (default: one per spare core)\n")	\
+		VERB("  -vk_dynres <n>                Lower the Vulkan render resolution to as little as <n>%% while the GPU falls behind\n")	\
+		VERB("  -vk_shaderlights              Light static walls from explosions and other dynamic lights in the Vulkan shaders (needs -gl_staticgeometry)\n")	\
+		))	\
 		DXX_if_defined_01(DXX_USE_STEREOSCOPIC_RENDER, (	\
 		VERB("  -gl_stereo                    Enable OpenGL stereo quad buffering, if available\n")	\
 		VERB("  -gl_stereoview <n>            Select OpenGL stereo viewport mode (experimental; incomplete)\n")	\
@@ -279,6 +316,7 @@ static void print_commandline_help()
 	)	\
 	DXX_COMMAND_LINE_HELP_SDL(	\
 		VERB("  -tmap <s>                     Select texmapper <s> to use\n\t\t\t\t(default: c, available: c, fp, quad)\n")	\
+		VERB("  -tmap_threads <n>             Fill walls on <n> threads, -1 for one per core\n\t\t\t\t(default: 0, off; needs -tmap c)\n")	\
 		VERB("  -hwsurface                    Use SDL HW Surface\n")	\
 		VERB("  -asyncblit                    Use queued blits over SDL. Can speed up rendering\n")	\
 	)	\
@@ -445,11 +483,50 @@ namespace dsx {
 
 namespace {
 
+/* A step of startup that uses no state the steps beside it change, so it
+ * runs on its own thread.  Its span, and the time that the main thread
+ * waits for it in join(), are recorded in the startup trace.
+ */
+class startup_task
+{
+	const char *const name;
+	std::thread thread;
+public:
+	template <typename F>
+		startup_task(const char *const task_name, F &&f) :
+			name{task_name}, thread{[task_name, f = std::forward<F>(f)]() mutable {
+				const load_trace_span trace{task_name};
+				f();
+			}}
+	{
+	}
+	~startup_task()
+	{
+		join();
+	}
+	void join()
+	{
+		if (!thread.joinable())
+			return;
+		const load_trace_span trace{"wait for ", name};
+		thread.join();
+	}
+};
+
+/* A step of startup that runs on the main thread */
+template <typename F>
+static decltype(auto) startup_step(const char *const name, F &&f)
+{
+	const load_trace_span trace{name};
+	return f();
+}
+
 static int main(int argc, char *argv[])
 {
 	if (!PHYSFSX_init(argc, argv))
 		return 1;
 	con_init();  // Initialise the console
+	parallel_set_thread_limit(CGameArg.SysThreads);
 
 	setbuf(stdout, NULL); // unbuffered output via printf
 #ifdef _WIN32
@@ -465,6 +542,11 @@ static int main(int argc, char *argv[])
 
 	printf("\nType '%s -help' for a list of command-line options.\n\n", PROGNAME);
 
+	/* Run with -verbose to see the time of each step, and which were on
+	 * the critical path to the main menu.
+	 */
+	std::optional<load_trace_span> startup_trace{std::in_place, "startup"};
+
 	PHYSFSX_listSearchPathContent();
 	
 	if (!PHYSFSX_checkSupportedArchiveTypes())
@@ -525,7 +607,13 @@ static int main(int argc, char *argv[])
 	}
 #endif
 
-	load_text();
+	/* gamedata_init reads the ham, pig and sound files after the window
+	 * opens and the titles play.  Read them now, so that gamedata_init
+	 * finds them in cache.
+	 */
+	startup_task read_ahead{"piggy_read_ahead", piggy_read_ahead};
+
+	startup_step("load_text", load_text);
 
 	//print out the banner title
 #if DXX_BUILD_DESCENT == 1
@@ -600,11 +688,35 @@ static int main(int argc, char *argv[])
 		}
 	}
 	
-	ReadConfigFile(CGameCfg, GameCfg);
+	startup_step("ReadConfigFile", [] { ReadConfigFile(CGameCfg, GameCfg); });
+	{
+		/* Bring the files of the pilot who will most likely be chosen
+		 * into cache while the archives, palette and game data load.
+		 */
+		const auto pilot{CGameArg.SysPilot.empty() ? static_cast<const char *>(GameCfg.LastPlayer) : CGameArg.SysPilot.c_str()};
+		if (*pilot)
+			for (const auto ext : {"plr", "plx", "ngp"})
+			{
+				char filename[PATH_MAX];
+				snprintf(filename, sizeof(filename), PLAYER_DIRECTORY_STRING("%.8s.%s"), pilot, ext);
+				PHYSFSX_queueReadAhead(filename);
+			}
+	}
+
+	startup_step("PHYSFSX_addArchiveContent", PHYSFSX_addArchiveContent);
 
-	PHYSFSX_addArchiveContent();
+#if DXX_BUILD_DESCENT == 2
+	/* Mounting the movie libraries needs nothing from the steps up to
+	 * show_titles, which plays the first movie.
+	 */
+	decltype(init_movies()) loaded_builtin_movies;
+	startup_task movies{"init_movies", [&loaded_builtin_movies] {
+		con_puts(CON_DEBUG, "Initializing movie libraries...");
+		loaded_builtin_movies = init_movies();		//init movie libraries
+	}};
+#endif
 
-	const auto &&arch_atexit_result = arch_init();
+	const auto &&arch_atexit_result = startup_step("arch_init", arch_init);
 	/* This variable exists for the side effects that occur when it is
 	 * destroyed.  clang-9 fails to recognize those side effects as a
 	 * "use" and warns that the variable is unused.  Cast it to void to
@@ -624,33 +736,33 @@ static int main(int argc, char *argv[])
 
 	// Load the palette stuff. Returns non-zero if error.
 	con_puts(CON_DEBUG, "Initializing palette system...");
+	startup_step("gr_use_palette_table", [] {
 #if DXX_BUILD_DESCENT == 1
-	gr_use_palette_table("palette.256");
+		gr_use_palette_table("palette.256");
 #elif DXX_BUILD_DESCENT == 2
-	gr_use_palette_table(D2_DEFAULT_PALETTE );
+		gr_use_palette_table(D2_DEFAULT_PALETTE );
 #endif
+	});
 
 	con_puts(CON_DEBUG, "Initializing font system...");
-	gamefont_init();	// must load after palette data loaded.
+	startup_step("gamefont_init", gamefont_init);	// must load after palette data loaded.
 
+	startup_step("gr_set_mode", [] {
 #if DXX_USE_OGL
-	gr_set_mode_from_window_size();
+		gr_set_mode_from_window_size();
 #else
-	gr_set_mode(Game_screen_mode);
+		gr_set_mode(Game_screen_mode);
 #endif
+	});
 
 #if DXX_BUILD_DESCENT == 2
-	con_puts(CON_DEBUG, "Initializing movie libraries...");
-	auto &&loaded_builtin_movies = init_movies();		//init movie libraries
-	/* clang does not recognize that creating the variable for the
-	 * purpose of extending the returned value's lifetime is a use.  Add
-	 * an explicit dummy use to silence its bogus -Wunused-variable
-	 * warning.
-	 */
-	(void)loaded_builtin_movies;
+	movies.join();
 #endif
 
-	show_titles();
+	/* Scan for missions while the titles play */
+	const auto &&mission_scan = mission_list_start_scan();
+	(void)mission_scan;
+	startup_step("show_titles", show_titles);
 
 	set_screen_mode(SCREEN_MENU);
 #if DXX_USE_DEBUG_MEMORY_ALLOCATOR
@@ -675,7 +787,7 @@ static int main(int argc, char *argv[])
 #endif
 
 	con_puts(CON_DEBUG, "Doing gamedata_init...");
-	gamedata_init(LevelSharedRobotInfoState);
+	startup_step("gamedata_init", [] { gamedata_init(LevelSharedRobotInfoState); });
 
 #if DXX_BUILD_DESCENT == 2
 #if DXX_USE_EDITOR
@@ -690,11 +802,13 @@ static int main(int argc, char *argv[])
 		return(0);
 
 #if DXX_BUILD_DESCENT == 2
-	piggy_init_pigfile("groupa.pig");	//get correct pigfile
+	startup_step("piggy_init_pigfile", [] { piggy_init_pigfile("groupa.pig"); });	//get correct pigfile
 #endif
 
 	con_puts(CON_DEBUG, "Running game...");
-	init_game();
+	startup_step("init_game", init_game);
+	read_ahead.join();
+	startup_trace.reset();
 
 #if DXX_BUILD_DESCENT == 1
 	key_flush();
@@ -749,6 +863,8 @@ static int main(int argc, char *argv[])
 	{
 		Game_mode = {};
 		DoMenu();
+		if (!CGameArg.SysAutoExec.empty())
+			cmd_appendf("exec %s", CGameArg.SysAutoExec.c_str());
 	}
 
 	while (window_get_front())
@@ -764,10 +880,18 @@ static int main(int argc, char *argv[])
 			window_close(wind);
 	}
 
+	state_wait_for_autosave();
 	WriteConfigFile(CGameCfg, GameCfg);
+#if DXX_USE_SCREENSHOT
+	screenshot_finish_writes();
+#endif
+	PHYSFSX_waitForQueuedWrites();
 
 	con_puts(CON_DEBUG, "Cleanup...");
 	close_game();
+#if !DXX_USE_OGL
+	tmap_tiles_close();
+#endif
 	texmerge_close();
 	gamedata_close();
 	Current_mission.reset();
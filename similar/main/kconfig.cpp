@@ -60,6 +60,11 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "d_enumerate.h"
 #include "d_range.h"
 #include "d_zip.h"
+#include "input_latency.h"
+#ifdef __ANDROID__
+#include <cmath>
+#include "touch.h"
+#endif
 
 using std::min;
 using std::max;
@@ -1036,6 +1041,22 @@ static void adjust_axis_field(fix& time, const std::array<fix, N> &axes, unsigne
 		time += amount;
 }
 
+#ifdef __ANDROID__
+/* A touch stick pushed to its edge moves like a fully ramped key.  The
+ * first part of its travel does nothing, so that a resting thumb does not
+ * drift.
+ */
+static fix touch_axis_time(const float deflection, const fix speed_factor)
+{
+	constexpr float dead_zone{0.15f};
+	const float magnitude{std::fabs(deflection)};
+	if (magnitude <= dead_zone)
+		return 0;
+	const float scaled{(std::min(magnitude, 1.f) - dead_zone) / (1.f - dead_zone)};
+	return static_cast<fix>(std::copysign(scaled, deflection) * speed_factor);
+}
+#endif
+
 static void clamp_value(fix& value, const fix& lower, const fix& upper)
 {
 	value = min(max(value, lower), upper);
@@ -1124,6 +1145,8 @@ void kconfig_read_controls(control_info &Controls, const d_event &event, int aut
 
 	const auto frametime{FrameTime};
 
+	if (event.type != event_type::idle)
+		input_latency_consume();
 	switch (event.type)
 	{
 		case event_type::key_command:
@@ -1312,6 +1335,12 @@ void kconfig_end_loop(control_info &Controls, const fix frametime)
 #endif
 
 	const auto speed_factor = (cheats.turbo ? 2 : 1) * frametime;
+#ifdef __ANDROID__
+	/* The sticks drive the same controls as their keys: the move stick
+	 * is W/A/S/D and the look stick is the arrows.
+	 */
+	const auto touch_axes = touch_overlay_get_axes();
+#endif
 
 	//------------ Read pitch_time -----------
 	if ( !Controls.state.slide_on )
@@ -1331,6 +1360,10 @@ void kconfig_end_loop(control_info &Controls, const fix frametime)
 		// From mouse...
 #ifdef dxx_kconfig_ui_kc_mouse_pitch_ud
 		adjust_axis_field(Controls.pitch_time, Controls.mouse_axis, kcm_mouse[dxx_kconfig_ui_kc_mouse_pitch_ud].value, kcm_mouse[dxx_kconfig_ui_kc_mouse_invert_pitch].value, PlayerCfg.MouseSens[player_config_mouse_index::pitch_ud]);
+#endif
+#ifdef __ANDROID__
+		// From touch...
+		Controls.pitch_time -= touch_axis_time(touch_axes.look_y, speed_factor / pitch_factor);
 #endif
 	}
 	else Controls.pitch_time = 0;
@@ -1379,6 +1412,10 @@ void kconfig_end_loop(control_info &Controls, const fix frametime)
 #if defined(dxx_kconfig_ui_kc_mouse_turn) && defined(dxx_kconfig_ui_kc_mouse_invert_turn)
 		// From mouse...
 		adjust_axis_field(Controls.heading_time, Controls.mouse_axis, kcm_mouse[dxx_kconfig_ui_kc_mouse_turn].value, !kcm_mouse[dxx_kconfig_ui_kc_mouse_invert_turn].value, PlayerCfg.MouseSens[player_config_mouse_index::turn_lr]);
+#endif
+#ifdef __ANDROID__
+		// From touch...
+		Controls.heading_time += touch_axis_time(touch_axes.look_x, speed_factor);
 #endif
 	}
 	else Controls.heading_time = 0;
@@ -1411,6 +1448,10 @@ void kconfig_end_loop(control_info &Controls, const fix frametime)
 	// From mouse...
 	adjust_axis_field(Controls.sideways_thrust_time, Controls.mouse_axis, kcm_mouse[dxx_kconfig_ui_kc_mouse_slide_lr].value, !kcm_mouse[dxx_kconfig_ui_kc_mouse_invert_slide_lr].value, PlayerCfg.MouseSens[player_config_mouse_index::slide_lr]);
 #endif
+#ifdef __ANDROID__
+	// From touch...
+	Controls.sideways_thrust_time += touch_axis_time(touch_axes.move_x, speed_factor);
+#endif
 
 	//----------- Read bank_time -----------------
 	if ( Controls.state.bank_on )
@@ -1452,6 +1493,10 @@ void kconfig_end_loop(control_info &Controls, const fix frametime)
 	// From mouse...
 	adjust_axis_field(Controls.forward_thrust_time, Controls.mouse_axis, kcm_mouse[dxx_kconfig_ui_kc_mouse_throttle].value, kcm_mouse[dxx_kconfig_ui_kc_mouse_invert_throttle].value, PlayerCfg.MouseSens[player_config_mouse_index::throttle]);
 #endif
+#ifdef __ANDROID__
+	// From touch...
+	Controls.forward_thrust_time -= touch_axis_time(touch_axes.move_y, speed_factor);
+#endif
 
 	//----------- Read cruise-control-type of throttle.
 	if ( Controls.state.cruise_off > 0 ) Controls.state.cruise_off = Cruise_speed = 0;
@@ -26,6 +26,9 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include <span>
+#include <unordered_map>
+#include <vector>
 
 #include "inferno.h"
 #include "game.h"
@@ -38,6 +41,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "gameseg.h"
 #include "textures.h"
 #include "fireball.h"
+#include "particle.h"
 #include "polyobj.h"
 #include "robot.h"
 #include "weapon.h"
@@ -729,7 +733,7 @@ imobjptridx_t Laser_create_new(const vms_vector &direction, const vms_vector &po
 		if (parent != Viewer && parent->type != OBJ_WEAPON) {
 			// Muzzle flash
 			if (const auto flash_vclip = weapon_info.flash_vclip; Vclip.valid_index(flash_vclip))
-				object_create_explosion_without_damage(Vclip, vmsegptridx(obj->segnum), obj->pos, weapon_info.flash_size, flash_vclip);
+				create_cosmetic_explosion(Vclip, vmsegptridx(obj->segnum), obj->pos, weapon_info.flash_size, flash_vclip);
 		}
 
 		do_omega_stuff(vmsegptridx, parent, position, obj);
@@ -846,7 +850,7 @@ imobjptridx_t Laser_create_new(const vms_vector &direction, const vms_vector &po
 	if (( parent != Viewer ) && (parent->type != OBJ_WEAPON))	{
 		// Muzzle flash
 		if (const auto flash_vclip = weapon_info.flash_vclip; Vclip.valid_index(flash_vclip))
-			object_create_explosion_without_damage(Vclip, segnum.absolute_sibling(obj->segnum), obj->pos, weapon_info.flash_size, flash_vclip);
+			create_cosmetic_explosion(Vclip, segnum.absolute_sibling(obj->segnum), obj->pos, weapon_info.flash_size, flash_vclip);
 	}
 
 	if (weapon_info.flash_sound != sound_effect::None)
@@ -1048,6 +1052,63 @@ static fix get_scaled_min_trackable_dot()
 }
 #endif
 
+//	The objects a homing weapon might track, gathered once per frame instead of by every
+//	search, and the lines of sight between homing weapons and their targets, kept for
+//	homing_sight_lifetime so that a weapon which checks its goal every frame does not
+//	trace the same line every frame.
+struct homing_search_state
+{
+	struct sight
+	{
+		object_signature_t tracker_signature, target_signature;
+		fix64 time;
+		bool visible;
+	};
+	fix64 candidates_time{-1};
+	std::vector<objnum_t> candidates;
+	//	Keyed by tracker and target object numbers
+	std::unordered_map<uint32_t, sight> sights;
+};
+
+constexpr fix homing_sight_lifetime{F1_0 / 30};
+
+static homing_search_state Homing_search;
+
+//	Players, robots and weapons, in object order.  An object created later in the frame is
+//	not a candidate until the next frame.
+static std::span<const objnum_t> homing_candidates(const object_array &Objects)
+{
+	auto &h = Homing_search;
+	if (h.candidates_time != GameTime64)
+	{
+		h.candidates_time = GameTime64;
+		h.candidates.clear();
+		auto &hot = Object_hot_fields;
+		for (objnum_t i{}, n = Objects.get_count(); i != n; ++i)
+			if (hot.is(i, OBJ_PLAYER) || hot.is(i, OBJ_ROBOT) || hot.is(i, OBJ_WEAPON))
+				h.candidates.emplace_back(i);
+		std::erase_if(h.sights, [](const auto &p) {
+			const auto age{GameTime64 - p.second.time};
+			return age < 0 || age >= homing_sight_lifetime;
+		});
+	}
+	return h.candidates;
+}
+
+static bool homing_target_visible(const vcobjptridx_t tracker, const objnum_t target_num, const object_base &target)
+{
+	const auto [i, inserted] = Homing_search.sights.try_emplace((uint32_t{tracker.get_unchecked_index()} << 16) | target_num);
+	auto &s = i->second;
+	if (!inserted && s.tracker_signature == tracker->signature && s.target_signature == target.signature)
+	{
+		const auto age{GameTime64 - s.time};
+		if (age >= 0 && age < homing_sight_lifetime)
+			return s.visible;
+	}
+	s = {tracker->signature, target.signature, GameTime64, object_to_object_visibility(tracker, target, FQ_TRANSWALL) != 0};
+	return s.visible;
+}
+
 //	-----------------------------------------------------------------------------------------------------------
 //	Return true if weapon *tracker is able to track object Objects[track_goal], else return false.
 //	In order for the object to be trackable, it must be within a reasonable turning radius for the missile
@@ -1088,7 +1149,7 @@ static int object_is_trackable(const imobjptridx_t objp, const vmobjptridx_t tra
 
 	if (*dot >= get_scaled_min_trackable_dot()) {
 		//	dot is in legal range, now see if object is visible
-		return object_to_object_visibility(tracker, objp, FQ_TRANSWALL);
+		return homing_target_visible(tracker, objp.get_unchecked_index(), objp);
 	} else {
 		return 0;
 	}
@@ -1182,10 +1243,21 @@ imobjptridx_t find_homing_object_complete(const vms_vector &curpos, const vmobjp
 
 	imobjptridx_t best_objnum{object_none};
 	fix	max_dot{-F1_0 * 2};
-	range_for (const auto &&curobjp, vmobjptridx)
+	auto &hot = Object_hot_fields;
+	/* A type of -1 becomes OBJ_NONE, which no candidate has */
+	const auto hot_type1{static_cast<object_type_t>(track_obj_type1)};
+	const auto hot_type2{static_cast<object_type_t>(track_obj_type2)};
+	for (const auto i : homing_candidates(Objects))
 	{
 		int is_proximity{0};
 
+		if (!hot.is(i, hot_type1) && !hot.is(i, hot_type2)
+#if DXX_BUILD_DESCENT == 2
+			&& !hot.is(i, OBJ_WEAPON)
+#endif
+			)
+			continue;
+		const auto &&curobjp = vmobjptridx(i);
 		if ((curobjp->type != track_obj_type1) && (curobjp->type != track_obj_type2))
 		{
 #if DXX_BUILD_DESCENT == 2
@@ -1242,7 +1314,7 @@ imobjptridx_t find_homing_object_complete(const vms_vector &curpos, const vmobjp
 
 			if (dot > min_trackable_dot) {
 				if (dot > max_dot) {
-					if (object_to_object_visibility(tracker, curobjp, FQ_TRANSWALL)) {
+					if (homing_target_visible(tracker, i, curobjp)) {
 						max_dot = dot;
 						best_objnum = curobjp;
 					}
@@ -2170,8 +2242,33 @@ static void create_smart_children(object_array &Objects, const vmobjptridx_t obj
 		if (+(Game_mode & GM_MULTI))
 			d_srand(8321L);
 
+		/* The objects in range are cast to from objp a batch at a time,
+		 * and the visible ones kept in object order until objlist is full.
+		 */
+		std::array<objnum_t, MAX_OBJDISTS> candidates;
+		std::array<vms_vector, MAX_OBJDISTS> candidate_pos;
+		std::array<fvi_hit_type, MAX_OBJDISTS> fates;
+		unsigned n_candidates{0};
+		const auto cast_candidates = [&]() {
+			find_vector_intersections(fvi_query{
+				objp->pos,
+				objp->pos,
+				fvi_query::unused_ignore_obj_list,
+				fvi_query::unused_LevelUniqueObjectState,
+				fvi_query::unused_Robot_info,
+				FQ_TRANSWALL,
+				objp,
+			}, objp->segnum, 0x10, std::span(candidate_pos).first(n_candidates), std::span(fates).first(n_candidates), {});
+			for (unsigned i = 0; i < n_candidates; ++i)
+				if (fates[i] == fvi_hit_type::None && numobjs < MAX_OBJDISTS)
+					objlist[numobjs++] = candidates[i];
+			n_candidates = 0;
+		};
+		auto &hot = Object_hot_fields;
 		range_for (const auto &&curobjp, vcobjptridx)
 		{
+			if (const auto i{curobjp.get_unchecked_index()}; !hot.is(i, OBJ_ROBOT) && !hot.is(i, OBJ_PLAYER))
+				continue;
 			if (((curobjp->type == OBJ_ROBOT && !curobjp->ctype.ai_info.CLOAKED) || curobjp->type == OBJ_PLAYER) && curobjp != parent.num)
 			{
 				if (curobjp->type == OBJ_PLAYER)
@@ -2200,18 +2297,19 @@ static void create_smart_children(object_array &Objects, const vmobjptridx_t obj
 				const auto &&dist = vm_vec_dist2(objp->pos, curobjp->pos);
 				if (dist < MAX_SMART_DISTANCE_SQUARED)
 				{
-					if (object_to_object_visibility(objp, curobjp, FQ_TRANSWALL))
+					candidates[n_candidates] = curobjp;
+					candidate_pos[n_candidates] = curobjp->pos;
+					if (++n_candidates == MAX_OBJDISTS)
 					{
-						objlist[numobjs] = curobjp;
-						numobjs++;
-						if (numobjs >= MAX_OBJDISTS) {
-							numobjs = MAX_OBJDISTS;
+						cast_candidates();
+						if (numobjs >= MAX_OBJDISTS)
 							break;
-						}
 					}
 				}
 			}
 		}
+		if (n_candidates)
+			cast_candidates();
 
 		//	Get type of weapon for child from parent.
 #if DXX_BUILD_DESCENT == 1
@@ -39,6 +39,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "game.h"
 #include "vclip.h"
 #include "lighting.h"
+#include "light_span.h"
 #include "3d.h"
 #include "interp.h"
 #include "gameseg.h"
@@ -55,6 +56,12 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "palette.h"
 #include "bm.h"
 #include "wall.h"
+#if DXX_USE_OGL
+#include "ogl_init.h"
+#endif
+#if DXX_USE_EDITOR
+#include "editor/editor.h"
+#endif
 
 #include "compiler-range_for.h"
 #include "d_bitset.h"
@@ -80,6 +87,34 @@ static void add_light_div(g3s_lrgb &d, const g3s_lrgb &light, const fix &scale)
 	d.b += fixdiv(light.b, scale);
 }
 
+//	The render vertices first seen in one segment, and a sphere around
+//	them, so that lights can skip segments they cannot reach.
+struct render_vertex_run
+{
+	std::array<float, 3> center;
+	float radius;
+	unsigned begin, end;
+};
+
+//	vm_vec_dist_quick is never less than 0.902 times the true distance
+constexpr float quick_distance_lower_bound = 0.89f;
+
+//	The positions of the render vertices, and the light that the plain
+//	falloff of apply_light adds to them, by render vertex index, for
+//	light_span_div.  set_dynamic_light adds the light to Dynamic_light
+//	once all sources are applied.
+struct render_vertex_light
+{
+	std::array<fix, MAX_VERTICES> x, y, z;
+	std::array<fix, MAX_VERTICES> r, g, b;
+	light_span_vertices span()
+	{
+		return {x.data(), y.data(), z.data(), r.data(), g.data(), b.data()};
+	}
+};
+
+static render_vertex_light Render_vertex_light;
+
 static void add_light_dot_square(g3s_lrgb &d, const g3s_lrgb &light, const fix &dot)
 {
 	auto square = fixmul(dot, dot);
@@ -98,6 +133,18 @@ static fix compute_player_light_emission_intensity(const object_base &objp)
 	return std::max(static_cast<fix>(vm_vec_mag_quick(sthrust) / 4), F2_0) + F0_5;
 }
 
+#if DXX_USE_OGL
+using static_light_list = std::vector<ogl_static_light>;
+
+static std::array<float, 3> static_light_vector(const vms_vector &v)
+{
+	return {{f2fl(v.x), f2fl(v.y), f2fl(v.z)}};
+}
+
+//	Lights collected by set_dynamic_light when the backend lights static faces
+static static_light_list Static_lights;
+#endif
+
 static fix compute_fireball_light_emission_intensity(const d_vclip_array &Vclip, const object_base &objp)
 {
 	const auto oid = get_fireball_id(objp);
@@ -117,7 +164,13 @@ static fix compute_fireball_light_emission_intensity(const d_vclip_array &Vclip,
 namespace dsx {
 namespace {
 
-static void apply_light(fvmsegptridx &vmsegptridx, const g3s_lrgb obj_light_emission, const vcsegptridx_t obj_seg, const vms_vector &obj_pos, const unsigned n_render_vertices, std::array<vertnum_t, MAX_VERTICES> &render_vertices, const std::array<segnum_t, MAX_VERTICES> &vert_segnum_list, const icobjptridx_t objnum)
+//	If static_lights is set, the source is also added to it, so that the
+//	backend can apply it to static faces as this function does to vertices.
+static void apply_light(fvmsegptridx &vmsegptridx, const g3s_lrgb obj_light_emission, const vcsegptridx_t obj_seg, const vms_vector &obj_pos, const unsigned n_render_vertices, std::array<vertnum_t, MAX_VERTICES> &render_vertices, const std::array<segnum_t, MAX_VERTICES> &vert_segnum_list, const std::span<const render_vertex_run> vertex_runs, const light_span_vertices &vertex_light, const icobjptridx_t objnum
+#if DXX_USE_OGL
+	, static_light_list *const static_lights
+#endif
+	)
 {
 	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
 	auto &Vertices = LevelSharedVertexState.get_vertices();
@@ -134,8 +187,24 @@ static void apply_light(fvmsegptridx &vmsegptridx, const g3s_lrgb obj_light_emis
 		auto &vcvertptr = Vertices.vcptr;
 		// for pretty dim sources, only process vertices in object's own segment.
 		//	12/04/95, MK, markers only cast light in own segment.
+#if DXX_USE_OGL
+		const auto add_static_light = [&](const uint32_t segment, const vms_vector *const headlight_dir, const fix headlight_max_dist) {
+			if (!static_lights)
+				return;
+			auto &l = static_lights->emplace_back();
+			l.pos = static_light_vector(obj_pos);
+			l.range = f2fl(abs(obji_64));
+			l.color = {{f2fl(obj_light_emission.r), f2fl(obj_light_emission.g), f2fl(obj_light_emission.b)}};
+			l.segment = segment;
+			l.headlight_dir = headlight_dir ? static_light_vector(*headlight_dir) : std::array<float, 3>{};
+			l.headlight_max_dist = headlight_dir ? f2fl(headlight_max_dist) : 0;
+		};
+#endif
 		if ((abs(obji_64) <= F1_0*8) || is_marker) {
 			auto &vp = obj_seg->verts;
+#if DXX_USE_OGL
+			add_static_light(static_cast<uint32_t>(segnum_t{obj_seg}), nullptr, 0);
+#endif
 
 			range_for (const auto vertnum, vp)
 			{
@@ -181,55 +250,78 @@ static void apply_light(fvmsegptridx &vmsegptridx, const g3s_lrgb obj_light_emis
 					}
 			}
 #endif
-			range_for (const unsigned vv, xrange(n_render_vertices))
+#if DXX_USE_OGL
+			/* Headlights outside multiplayer are not limited by distance */
+			add_static_light(ogl_static_light_any_segment, headlight_shift && objnum ? &objnum->orient.fvec : nullptr, !(Game_mode & GM_MULTI) ? INT32_MAX : max_headlight_dist);
+#endif
+			/* A vertex is lit if its quick distance, shifted down by
+			 * headlight_shift, is less than the range
+			 */
+			const float reach = f2fl(abs(obji_64)) * (1 << headlight_shift) / quick_distance_lower_bound + 1.f;
+			const std::array<float, 3> light_pos{{f2fl(obj_pos.x), f2fl(obj_pos.y), f2fl(obj_pos.z)}};
+			for (const auto &run : vertex_runs)
 			{
-				fix			dist;
-				int apply_light{0};
-
-				const auto vertnum = render_vertices[vv];
-				auto vsegnum = vert_segnum_list[vv];
-				auto &vertpos = *vcvertptr(vertnum);
-
-				if (use_fcd_lighting && abs(obji_64) > F1_0*32)
+				if (!use_fcd_lighting)
 				{
-					dist = find_connected_distance(obj_pos, obj_seg, vertpos, vmsegptridx(vsegnum), n_render_vertices, wall_is_doorway_mask::fly_rendpast);
-					if (dist >= 0)
-						apply_light = 1;
+					const float dx = run.center[0] - light_pos[0], dy = run.center[1] - light_pos[1], dz = run.center[2] - light_pos[2];
+					if (const float r = reach + run.radius; dx * dx + dy * dy + dz * dz > r * r)
+						continue;
 				}
-				else
+				if (!headlight_shift && !(use_fcd_lighting && abs(obji_64) > F1_0*32))
 				{
-					dist = vm_vec_dist_quick(obj_pos, vertpos);
-					apply_light = 1;
+					light_span_div({obj_pos, obj_light_emission.r, obj_light_emission.g, obj_light_emission.b, abs(obji_64)}, vertex_light, run.begin, run.end);
+					continue;
 				}
+				range_for (const unsigned vv, xrange(run.begin, run.end))
+				{
+					fix			dist;
+					int apply_light{0};
 
-				if (apply_light && ((dist >> headlight_shift) < abs(obji_64))) {
-
-					if (dist < MIN_LIGHT_DIST)
-						dist = MIN_LIGHT_DIST;
+					const auto vertnum = render_vertices[vv];
+					auto vsegnum = vert_segnum_list[vv];
+					auto &vertpos = *vcvertptr(vertnum);
 
-					if (headlight_shift && objnum)
+					if (use_fcd_lighting && abs(obji_64) > F1_0*32)
 					{
-						fix dot;
-						// MK, Optimization note: You compute distance about 15 lines up, this is partially redundant
-						const auto vec_to_point = vm_vec_normalized_quick(vm_vec_build_sub(vertpos, obj_pos));
-						dot = vm_vec_build_dot(vec_to_point, objnum->orient.fvec);
-						if (dot < F1_0/2)
+						dist = find_connected_distance(obj_pos, obj_seg, vertpos, vmsegptridx(vsegnum), n_render_vertices, wall_is_doorway_mask::fly_rendpast);
+						if (dist >= 0)
+							apply_light = 1;
+					}
+					else
+					{
+						dist = vm_vec_dist_quick(obj_pos, vertpos);
+						apply_light = 1;
+					}
+
+					if (apply_light && ((dist >> headlight_shift) < abs(obji_64))) {
+
+						if (dist < MIN_LIGHT_DIST)
+							dist = MIN_LIGHT_DIST;
+
+						if (headlight_shift && objnum)
 						{
-							// Do the normal thing, but darken around headlight.
-							add_light_div(Dynamic_light[vertnum], obj_light_emission, fixmul(HEADLIGHT_SCALE, dist));
+							fix dot;
+							// MK, Optimization note: You compute distance about 15 lines up, this is partially redundant
+							const auto vec_to_point = vm_vec_normalized_quick(vm_vec_build_sub(vertpos, obj_pos));
+							dot = vm_vec_build_dot(vec_to_point, objnum->orient.fvec);
+							if (dot < F1_0/2)
+							{
+								// Do the normal thing, but darken around headlight.
+								add_light_div(Dynamic_light[vertnum], obj_light_emission, fixmul(HEADLIGHT_SCALE, dist));
+							}
+							else
+							{
+								if (!(Game_mode & GM_MULTI) || dist < max_headlight_dist)
+								{
+									add_light_dot_square(Dynamic_light[vertnum], obj_light_emission, dot);
+								}
+							}
 						}
 						else
 						{
-							if (!(Game_mode & GM_MULTI) || dist < max_headlight_dist)
-							{
-								add_light_dot_square(Dynamic_light[vertnum], obj_light_emission, dot);
-							}
+							add_light_div(Dynamic_light[vertnum], obj_light_emission, dist);
 						}
 					}
-					else
-					{
-						add_light_div(Dynamic_light[vertnum], obj_light_emission, dist);
-					}
 				}
 			}
 		}
@@ -243,7 +335,11 @@ static void apply_light(fvmsegptridx &vmsegptridx, const g3s_lrgb obj_light_emis
 namespace {
 
 // ----------------------------------------------------------------------------------------------
-static void cast_muzzle_flash_light(fvmsegptridx &vmsegptridx, int n_render_vertices, std::array<vertnum_t, MAX_VERTICES> &render_vertices, const std::array<segnum_t, MAX_VERTICES> &vert_segnum_list)
+static void cast_muzzle_flash_light(fvmsegptridx &vmsegptridx, int n_render_vertices, std::array<vertnum_t, MAX_VERTICES> &render_vertices, const std::array<segnum_t, MAX_VERTICES> &vert_segnum_list, const std::span<const render_vertex_run> vertex_runs, const light_span_vertices &vertex_light
+#if DXX_USE_OGL
+	, static_light_list *const static_lights
+#endif
+	)
 {
 	fix64 current_time;
 	short time_since_flash;
@@ -259,7 +355,11 @@ static void cast_muzzle_flash_light(fvmsegptridx &vmsegptridx, int n_render_vert
 			{
 				g3s_lrgb ml;
 				ml.r = ml.g = ml.b = ((FLASH_LEN_FIXED_SECONDS - time_since_flash) * FLASH_SCALE);
-				apply_light(vmsegptridx, ml, vmsegptridx(i.segnum), i.pos, n_render_vertices, render_vertices, vert_segnum_list, object_none);
+				apply_light(vmsegptridx, ml, vmsegptridx(i.segnum), i.pos, n_render_vertices, render_vertices, vert_segnum_list, vertex_runs, vertex_light, object_none
+#if DXX_USE_OGL
+					, static_lights
+#endif
+					);
 			}
 			else
 			{
@@ -506,6 +606,108 @@ static g3s_lrgb compute_light_emission(const d_robot_info_array &Robot_info, d_l
 	return white_light();
 }
 
+//	Light from sources that stay put, such as powerups on the floor,
+//	hostages and the reactor, is kept in light across frames for the
+//	vertices of the last frame.  A source is cached once it emits the same
+//	light from the same position for two frames in a row, and taken out
+//	again as soon as it changes or goes away.  Sources that move are lit
+//	every frame as before.  The sum of integer parts does not depend on
+//	their order, so the result is the same as lighting everything anew.
+struct light_cache_source
+{
+	enum class state : uint8_t
+	{
+		none,
+		seen,
+		cached,
+	};
+	state st;
+	object_signature_t signature;
+	vms_vector pos;
+	g3s_lrgb emission;
+	uint32_t frame;
+	bool same(const object_base &objp, const g3s_lrgb &e) const
+	{
+		return st != state::none && signature == objp.signature && pos == objp.pos && emission.r == e.r && emission.g == e.g && emission.b == e.b;
+	}
+};
+
+struct light_cache_state
+{
+	per_vertex_array<g3s_lrgb> light;
+	enumerated_bitset<MAX_VERTICES, vertnum_t> maintained;
+	std::vector<vertnum_t> vertices;
+	std::array<light_cache_source, MAX_OBJECTS> sources;
+	uint32_t frame;
+};
+
+static light_cache_state Light_cache;
+
+//	Only the plain falloff of apply_light, with no headlight and no limit
+//	to the source's own segment, is cached.
+static bool light_source_cacheable(const object &objp, const g3s_lrgb &emission)
+{
+	if (abs(((emission.r + emission.g + emission.b) / 3) * 64) <= F1_0 * 8)
+		return false;
+#if DXX_BUILD_DESCENT == 2
+	if (objp.type == OBJ_MARKER)
+		return false;
+	if (objp.type == OBJ_PLAYER && (objp.ctype.player_info.powerup_flags & PLAYER_FLAGS_HEADLIGHT_ON))
+		return false;
+#else
+	(void)objp;
+#endif
+	return true;
+}
+
+static void apply_cached_light(fvcvertptr &vcvertptr, per_vertex_array<g3s_lrgb> &light, const light_cache_source &source, const std::span<const vertnum_t> vertices, const bool remove)
+{
+	const auto &e = source.emission;
+	const fix range = abs(((e.r + e.g + e.b) / 3) * 64);
+	for (const auto vertnum : vertices)
+	{
+		fix dist = vm_vec_dist_quick(source.pos, *vcvertptr(vertnum));
+		if (!(dist < range))
+			continue;
+		if (dist < MIN_LIGHT_DIST)
+			dist = MIN_LIGHT_DIST;
+		auto &d = light[vertnum];
+		if (remove)
+		{
+			d.r -= fixdiv(e.r, dist);
+			d.g -= fixdiv(e.g, dist);
+			d.b -= fixdiv(e.b, dist);
+		}
+		else
+			add_light_div(d, e, dist);
+	}
+}
+
+#if DXX_USE_OGL
+//	apply_light adds its sources to the backend's list, so cached sources
+//	are added the same way.
+static void add_cached_static_light(static_light_list *const static_lights, const light_cache_source &source)
+{
+	if (!static_lights)
+		return;
+	const auto &e = source.emission;
+	auto &l = static_lights->emplace_back();
+	l.pos = static_light_vector(source.pos);
+	l.range = f2fl(abs(((e.r + e.g + e.b) / 3) * 64));
+	l.color = {{f2fl(e.r), f2fl(e.g), f2fl(e.b)}};
+	l.segment = ogl_static_light_any_segment;
+	l.headlight_dir = {};
+	l.headlight_max_dist = f2fl(!(Game_mode & GM_MULTI) ? INT32_MAX : F1_0*200);
+}
+#endif
+
+}
+
+void reset_dynamic_light_cache()
+{
+	Light_cache.maintained = {};
+	Light_cache.vertices.clear();
+	Light_cache.sources = {};
 }
 
 // ----------------------------------------------------------------------------------------------
@@ -528,12 +730,24 @@ void set_dynamic_light(const d_robot_info_array &Robot_info, render_state_t &rst
 
 	enumerated_bitset<MAX_VERTICES, vertnum_t> render_vertex_flags;
 
+#if DXX_USE_OGL
+	/* When the backend lights static faces, vertex light is only needed
+	 * for the segments whose objects compute_object_light will light
+	 */
+	static_light_list *const static_lights = ogl_static_lights_enabled() ? &Static_lights : nullptr;
+	if (static_lights)
+		static_lights->clear();
+#endif
 	//	Create list of vertices that need to be looked at for setting of ambient light.
 	auto &Dynamic_light = LevelUniqueLightState.Dynamic_light;
 	uint_fast32_t n_render_vertices{0};
 	range_for (const auto segnum, partial_const_range(rstate.Render_list, rstate.N_render_segs))
 	{
 		if (segnum != segment_none) {
+#if DXX_USE_OGL
+			if (static_lights && Segments[segnum].objects == object_none)
+				continue;
+#endif
 			auto &vp = Segments[segnum].verts;
 			range_for (const auto vnum, vp)
 			{
@@ -544,14 +758,77 @@ void set_dynamic_light(const d_robot_info_array &Robot_info, render_state_t &rst
 					render_vertices[n_render_vertices] = vnum;
 					vert_segnum_list[n_render_vertices] = segnum;
 					n_render_vertices++;
-					Dynamic_light[vnum] = {};
 				}
 			}
 		}
 	}
+	const auto render_vertex_range = std::span<const vertnum_t>(render_vertices).first(n_render_vertices);
 
-	cast_muzzle_flash_light(vmsegptridx, n_render_vertices, render_vertices, vert_segnum_list);
-
+	auto &LevelSharedVertexState = LevelSharedSegmentState.get_vertex_state();
+	auto &vcvertptr = LevelSharedVertexState.get_vertices().vcptr;
+	/* Every segment adds its vertices in one run */
+	std::array<render_vertex_run, MAX_RENDER_SEGS> vertex_runs;
+	unsigned n_vertex_runs{0};
+	for (unsigned begin = 0, end; begin < n_render_vertices; begin = end)
+	{
+		const auto segnum = vert_segnum_list[begin];
+		for (end = begin + 1; end < n_render_vertices && vert_segnum_list[end] == segnum; ++end)
+		{
+		}
+		std::array<float, 3> center{};
+		for (const auto vertnum : std::span(render_vertices).subspan(begin, end - begin))
+		{
+			auto &v = *vcvertptr(vertnum);
+			center[0] += f2fl(v.x);
+			center[1] += f2fl(v.y);
+			center[2] += f2fl(v.z);
+		}
+		for (auto &c : center)
+			c /= end - begin;
+		float radius2 = 0;
+		for (const auto vertnum : std::span(render_vertices).subspan(begin, end - begin))
+		{
+			auto &v = *vcvertptr(vertnum);
+			const float dx = f2fl(v.x) - center[0], dy = f2fl(v.y) - center[1], dz = f2fl(v.z) - center[2];
+			radius2 = std::max(radius2, dx * dx + dy * dy + dz * dz);
+		}
+		vertex_runs[n_vertex_runs++] = {center, sqrtf(radius2) + 1.f, begin, end};
+	}
+	const auto vertex_run_range = std::span<const render_vertex_run>(vertex_runs).first(n_vertex_runs);
+	auto &vertex_light = Render_vertex_light;
+	for (const auto &&[vv, vertnum] : enumerate(render_vertex_range))
+	{
+		auto &v = *vcvertptr(vertnum);
+		vertex_light.x[vv] = v.x;
+		vertex_light.y[vv] = v.y;
+		vertex_light.z[vv] = v.z;
+	}
+	std::fill_n(vertex_light.r.begin(), n_render_vertices, 0);
+	std::fill_n(vertex_light.g.begin(), n_render_vertices, 0);
+	std::fill_n(vertex_light.b.begin(), n_render_vertices, 0);
+	const auto vertex_light_span = vertex_light.span();
+	const bool use_cache{
+#if DXX_USE_EDITOR
+		!EditorWindow
+#else
+		true
+#endif
+	};
+	auto &cache = Light_cache;
+	if (!use_cache)
+		reset_dynamic_light_cache();
+	const auto frame = ++cache.frame;
+	/* Every source, in object order, so the backend gets its lights in
+	 * the same order as before
+	 */
+	struct frame_light_source
+	{
+		vcobjptridx_t obj;
+		g3s_lrgb emission;
+		bool cached;
+	};
+	static std::vector<frame_light_source> frame_sources;
+	frame_sources.clear();
 	range_for (const auto &&obj, vcobjptridx)
 	{
 		const object &objp = obj;
@@ -559,9 +836,100 @@ void set_dynamic_light(const d_robot_info_array &Robot_info, render_state_t &rst
 			continue;
 		const auto &&obj_light_emission = compute_light_emission(Robot_info, LevelUniqueLightState, Vclip, obj);
 
-		if (((obj_light_emission.r+obj_light_emission.g+obj_light_emission.b)/3) > 0)
-			apply_light(vmsegptridx, obj_light_emission, vcsegptridx(objp.segnum), objp.pos, n_render_vertices, render_vertices, vert_segnum_list, obj);
+		if (!(((obj_light_emission.r+obj_light_emission.g+obj_light_emission.b)/3) > 0))
+			continue;
+		if (use_cache && light_source_cacheable(objp, obj_light_emission))
+		{
+			auto &source = cache.sources[obj.get_unchecked_index()];
+			if (!source.same(objp, obj_light_emission))
+			{
+				if (source.st == light_cache_source::state::cached)
+					apply_cached_light(vcvertptr, cache.light, source, cache.vertices, true);
+				source = {light_cache_source::state::seen, objp.signature, objp.pos, obj_light_emission, frame};
+			}
+			else
+			{
+				if (source.st == light_cache_source::state::seen)
+				{
+					/* Still for two frames, so cache it from now on */
+					source.st = light_cache_source::state::cached;
+					apply_cached_light(vcvertptr, cache.light, source, cache.vertices, false);
+				}
+				source.frame = frame;
+				frame_sources.push_back({obj, obj_light_emission, true});
+				continue;
+			}
+		}
+		frame_sources.push_back({obj, obj_light_emission, false});
+	}
+	/* Take out the sources that were cached but are gone, no longer emit
+	 * or cannot be cached any more
+	 */
+	std::array<const light_cache_source *, MAX_OBJECTS> cached_sources;
+	unsigned n_cached_sources{0};
+	for (auto &source : cache.sources)
+	{
+		if (source.st == light_cache_source::state::none)
+			continue;
+		if (source.frame != frame)
+		{
+			if (source.st == light_cache_source::state::cached)
+				apply_cached_light(vcvertptr, cache.light, source, cache.vertices, true);
+			source.st = light_cache_source::state::none;
+		}
+		else if (source.st == light_cache_source::state::cached)
+			cached_sources[n_cached_sources++] = &source;
+	}
+	/* Vertices not seen last frame get the cached sources added now */
+	for (const auto vertnum : render_vertex_range)
+	{
+		if (cache.maintained[vertnum])
+			continue;
+		cache.light[vertnum] = {};
+		for (const auto source : std::span(cached_sources).first(n_cached_sources))
+			apply_cached_light(vcvertptr, cache.light, *source, std::span(&vertnum, 1), false);
 	}
+	for (const auto vertnum : cache.vertices)
+		cache.maintained[vertnum] = false;
+	cache.vertices.assign(render_vertex_range.begin(), render_vertex_range.end());
+	for (const auto vertnum : render_vertex_range)
+	{
+		cache.maintained[vertnum] = true;
+		Dynamic_light[vertnum] = cache.light[vertnum];
+	}
+
+	cast_muzzle_flash_light(vmsegptridx, n_render_vertices, render_vertices, vert_segnum_list, vertex_run_range, vertex_light_span
+#if DXX_USE_OGL
+		, static_lights
+#endif
+		);
+
+	for (auto &&[obj, obj_light_emission, cached] : frame_sources)
+	{
+		if (cached)
+		{
+#if DXX_USE_OGL
+			add_cached_static_light(static_lights, cache.sources[obj.get_unchecked_index()]);
+#endif
+			continue;
+		}
+		apply_light(vmsegptridx, obj_light_emission, vcsegptridx(obj->segnum), obj->pos, n_render_vertices, render_vertices, vert_segnum_list, vertex_run_range, vertex_light_span, obj
+#if DXX_USE_OGL
+			, static_lights
+#endif
+			);
+	}
+	for (const auto &&[vv, vertnum] : enumerate(render_vertex_range))
+	{
+		auto &d = Dynamic_light[vertnum];
+		d.r += vertex_light.r[vv];
+		d.g += vertex_light.g[vv];
+		d.b += vertex_light.b[vv];
+	}
+#if DXX_USE_OGL
+	if (static_lights)
+		ogl_set_static_lights(*static_lights, PlayerCfg.AlphaEffects ? .93f : 1.f);
+#endif
 }
 
 // ---------------------------------------------------------
@@ -485,6 +485,7 @@ static window_event_result player_menu_keycommand( listbox *lb,const d_event &ev
 
 					snprintf(name, sizeof(name), PLAYER_DIRECTORY_STRING("%.8s.plr"), items[citem]);
 
+					PHYSFSX_waitForQueuedWrites();
 					ret = !PHYSFS_delete(name);
 
 					if (!ret)
@@ -587,6 +588,7 @@ static void RegisterPlayer()
 		InterfaceUniqueState.update_window_title();
 	}
 
+	PHYSFSX_waitForQueuedWrites();
 	auto list = PHYSFSX_findFiles(PLAYER_DIRECTORY_STRING(""), types);
 	if (!list)
 		return;	// memory error
@@ -772,6 +774,12 @@ window_event_result main_menu::event_handler(const d_event &event)
 			break;
 
 		case event_type::idle:
+			if (!CGameArg.SysTimeDemo.empty())
+			{
+				const auto filename{std::exchange(CGameArg.SysTimeDemo, {})};
+				newdemo_start_timedemo(filename.c_str());
+				break;
+			}
 #if DXX_BUILD_DESCENT == 1
 #define DXX_DEMO_KEY_DELAY	45
 #elif DXX_BUILD_DESCENT == 2
@@ -25,6 +25,9 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 #include "dxxsconf.h"
 #include <algorithm>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <stdio.h>
 #include <stdlib.h>
@@ -39,7 +42,9 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "window.h"
 #include "mission.h"
 #include "gamesave.h"
+#include "gameseq.h"
 #include "piggy.h"
+#include "digi.h"
 #include "console.h"
 #include "polyobj.h"
 #include "dxxerror.h"
@@ -533,84 +538,214 @@ namespace dsx {
 
 namespace {
 
-static const mle *read_mission_file(mission_list_type &mission_list, std::string_view str_pathname, const descent_hog_size descent_hog_size, const mission_filter_mode mission_filter)
+constexpr char mission_header_cache_filename[] = "missions.cache";
+constexpr std::array<uint8_t, 4> mission_header_cache_magic{{'D', 'X', 'M', 'C'}};
+/* Each game reads the headers a little differently, so the game is part
+ * of the version.
+ */
+constexpr PHYSFS_uint32 mission_header_cache_version = 0x100 | DXX_BUILD_DESCENT;
+
+/* What read_mission_file learns by opening a mission file, kept with
+ * the size and modification time of the file so that it is only opened
+ * again when it changes.
+ */
+struct mission_header_cache_entry
+{
+	PHYSFS_sint64 mtime = -1, size = -1;
+	bool is_mission = false;
+	/* Set when the file is found by a scan in this run.  Only entries
+	 * that were found are written back.
+	 */
+	bool seen = false;
+	Mission::descent_version_type descent_version{};
+	Mission::anarchy_only_level anarchy_only_flag{};
+	std::string mission_name;
+};
+
+/* Filled by the background scan and by build_mission_list.  The
+ * foreground waits for the scan before it touches the cache.
+ */
+std::unordered_map<std::string, mission_header_cache_entry> Mission_header_cache;
+bool Mission_header_cache_loaded, Mission_header_cache_dirty;
+std::thread Mission_scan_thread;
+
+static void read_mission_header_cache()
 {
-	if (const auto mfile = PHYSFSX_openReadBuffered(str_pathname.data()).first)
+	Mission_header_cache_loaded = true;
+	auto [fp, err] = PHYSFSX_openReadBuffered(mission_header_cache_filename);
+	if (!fp)
+		return;
+	std::array<uint8_t, 4> magic;
+	PHYSFS_uint32 version, count;
+	if (PHYSFS_readBytes(fp, magic.data(), magic.size()) != static_cast<PHYSFS_sint64>(magic.size()) || magic != mission_header_cache_magic || !PHYSFS_readULE32(fp, &version) || version != mission_header_cache_version || !PHYSFS_readULE32(fp, &count))
+		return;
+	for (; count; --count)
 	{
-		const auto idx_last_slash{str_pathname.find_last_of('/')};
-		/* If no slash is found, the filename starts at the beginning of the
-		 * view.  If a slash is found, the filename starts at the next
-		 * character after the slash.
-		 */
-		const auto idx_filename{(idx_last_slash == str_pathname.npos) ? 0 : idx_last_slash + 1};
-		const auto idx_file_extension{str_pathname.find_first_of('.', {idx_filename})};
-		if (idx_file_extension == str_pathname.npos)
-			return nullptr;	//missing extension
-		if (idx_file_extension >= DXX_MAX_MISSION_PATH_LENGTH)
-			return nullptr;	// path too long, would be truncated in save game files
-#if DXX_BUILD_DESCENT == 1
-		constexpr auto descent_version = Mission::descent_version_type::descent1;
-#elif DXX_BUILD_DESCENT == 2
-		// look if it's .mn2 or .msn
-		const auto descent_version = (str_pathname[idx_file_extension + 3] == MISSION_EXTENSION_DESCENT_II[3])
-			? Mission::descent_version_type::descent2
-			: Mission::descent_version_type::descent1;
-#endif
-		str_pathname.remove_suffix(str_pathname.size() - idx_file_extension);
+		PHYSFS_uint16 path_length;
+		PHYSFS_sint64 mtime, size;
+		std::array<uint8_t, 4> flags;
+		if (!PHYSFS_readULE16(fp, &path_length) || !PHYSFS_readSLE64(fp, &mtime) || !PHYSFS_readSLE64(fp, &size) || PHYSFS_readBytes(fp, flags.data(), flags.size()) != static_cast<PHYSFS_sint64>(flags.size()))
+			return;
+		/* flags: is_mission, descent_version, anarchy_only_flag, name length */
+		std::string path(path_length, 0), name(flags[3], 0);
+		if (PHYSFS_readBytes(fp, path.data(), path.size()) != static_cast<PHYSFS_sint64>(path.size()) || PHYSFS_readBytes(fp, name.data(), name.size()) != static_cast<PHYSFS_sint64>(name.size()))
+			return;
+		auto &e = Mission_header_cache[std::move(path)];
+		e.mtime = mtime;
+		e.size = size;
+		e.is_mission = flags[0];
+		e.descent_version = Mission::descent_version_type{flags[1]};
+		e.anarchy_only_flag = Mission::anarchy_only_level{static_cast<bool>(flags[2])};
+		e.mission_name = std::move(name);
+	}
+	con_printf(CON_VERBOSE, "Read %zu mission headers from \"%s\"", Mission_header_cache.size(), mission_header_cache_filename);
+}
 
-		PHYSFSX_gets_line_t<80> buf;
-		const auto &&nv = get_any_mission_type_name_value(buf, mfile, descent_version);
-		const auto &p = nv.name;
-		if (!p)
-			return nullptr;
+static void write_mission_header_cache()
+{
+	if (!Mission_header_cache_dirty)
+		return;
+	Mission_header_cache_dirty = false;
+	auto [fp, err] = PHYSFSX_openWriteBuffered(mission_header_cache_filename);
+	if (!fp)
+	{
+		con_printf(CON_VERBOSE, "Failed to write mission header cache \"%s\": %s", mission_header_cache_filename, PHYSFS_getErrorByCode(err));
+		return;
+	}
+	PHYSFS_uint32 count = 0;
+	for (auto &&[path, e] : Mission_header_cache)
+		if (e.seen)
+			++count;
+	PHYSFS_writeBytes(fp, mission_header_cache_magic.data(), mission_header_cache_magic.size());
+	PHYSFS_writeULE32(fp, mission_header_cache_version);
+	PHYSFS_writeULE32(fp, count);
+	for (auto &&[path, e] : Mission_header_cache)
+	{
+		if (!e.seen)
+			continue;
+		const std::array<uint8_t, 4> flags{{e.is_mission, static_cast<uint8_t>(e.descent_version), static_cast<uint8_t>(e.anarchy_only_flag), static_cast<uint8_t>(e.mission_name.size())}};
+		PHYSFS_writeULE16(fp, path.size());
+		PHYSFS_writeSLE64(fp, e.mtime);
+		PHYSFS_writeSLE64(fp, e.size);
+		PHYSFS_writeBytes(fp, flags.data(), flags.size());
+		PHYSFS_writeBytes(fp, path.data(), path.size());
+		PHYSFS_writeBytes(fp, e.mission_name.data(), e.mission_name.size());
+	}
+}
 
-		const auto semicolon = strchr(p, ';');
-		/* If a semicolon exists, point to it.  Otherwise, point to the
-		 * null byte terminating the buffer.
-		 */
-		auto t = semicolon ? semicolon : std::next(p, strlen(p));
-		/* Iterate backward until either the beginning of the buffer or the
-		 * first non-whitespace character.
-		 */
-		for (; t != p && isspace(static_cast<unsigned>(*t));)
-		{
-			-- t;
-		}
+/* Read the name and type of the mission in `pathname` into `e` */
+static void read_mission_header(const char *const pathname, const Mission::descent_version_type descent_version, mission_header_cache_entry &e)
+{
+	e.is_mission = false;
+	const auto mfile = PHYSFSX_openReadBuffered(pathname).first;
+	if (!mfile)
+		return;
+	PHYSFSX_gets_line_t<80> buf;
+	const auto &&nv = get_any_mission_type_name_value(buf, mfile, descent_version);
+	const auto &p = nv.name;
+	if (!p)
+		return;
 
-		auto anarchy_only_flag{Mission::anarchy_only_level::allow_any_game};
-		if (PHYSFSX_gets_line_t<64> temp; PHYSFSX_fgets(temp, mfile))
+	const auto semicolon = strchr(p, ';');
+	/* If a semicolon exists, point to it.  Otherwise, point to the
+	 * null byte terminating the buffer.
+	 */
+	auto t = semicolon ? semicolon : std::next(p, strlen(p));
+	/* Iterate backward until either the beginning of the buffer or the
+	 * first non-whitespace character.
+	 */
+	for (; t != p && isspace(static_cast<unsigned>(*t));)
+	{
+		-- t;
+	}
+
+	auto anarchy_only_flag{Mission::anarchy_only_level::allow_any_game};
+	if (PHYSFSX_gets_line_t<64> temp; PHYSFSX_fgets(temp, mfile))
+	{
+		if (istok(temp,"type"))
 		{
-			if (istok(temp,"type"))
+			//get mission type
+			if (const auto p = get_value(temp))
 			{
-				//get mission type
-				if (const auto p = get_value(temp))
-				{
-					if (istok(p, "anarchy"))
-					{
-						if (mission_filter == mission_filter_mode::exclude_anarchy)
-							return nullptr;
-						anarchy_only_flag = Mission::anarchy_only_level::only_anarchy_games;
-					}
-				}
+				if (istok(p, "anarchy"))
+					anarchy_only_flag = Mission::anarchy_only_level::only_anarchy_games;
 			}
 		}
-		return &mission_list.emplace_back(
-			/* Cast to ptrdiff_t is safe, because
-			 * `if (idx_file_extension >= DXX_MAX_MISSION_PATH_LENGTH)` is
-			 * true, then execution does not reach this line.  All values in
-			 * [0, DXX_MAX_MISSION_PATH_LENGTH) can be represented by
-			 * `std::ptrdiff_t`, so no narrowing occurs.
-			 */
-			Mission_path{str_pathname, static_cast<std::ptrdiff_t>(idx_filename)},
-			descent_hog_size,
+	}
+	e.is_mission = true;
 #if DXX_BUILD_DESCENT == 2
-			nv.descent_version,
+	e.descent_version = nv.descent_version;
+#else
+	e.descent_version = descent_version;
 #endif
-			anarchy_only_flag,
-			std::span(p, std::min<std::size_t>(mle::maximum_mission_name_length, std::distance(p, t)))
-		);
+	e.anarchy_only_flag = anarchy_only_flag;
+	e.mission_name.assign(p, std::min<std::size_t>(mle::maximum_mission_name_length, std::distance(p, t)));
+}
+
+/* Returns the header of the mission in `pathname`, opening the file only
+ * if the cache has nothing for it or the file changed since.  Files in
+ * archives that report no modification time are always opened.
+ */
+static const mission_header_cache_entry *find_mission_header(const char *const pathname, const Mission::descent_version_type descent_version)
+{
+	PHYSFS_Stat st;
+	if (!PHYSFS_stat(pathname, &st))
+		return nullptr;
+	auto &e = Mission_header_cache[pathname];
+	e.seen = true;
+	if (st.modtime == -1 || e.mtime != st.modtime || e.size != st.filesize)
+	{
+		e.mtime = st.modtime;
+		e.size = st.filesize;
+		read_mission_header(pathname, descent_version, e);
+		Mission_header_cache_dirty = true;
 	}
-	return nullptr;
+	return e.is_mission ? &e : nullptr;
+}
+
+static const mle *read_mission_file(mission_list_type &mission_list, std::string_view str_pathname, const descent_hog_size descent_hog_size, const mission_filter_mode mission_filter)
+{
+	const auto idx_last_slash{str_pathname.find_last_of('/')};
+	/* If no slash is found, the filename starts at the beginning of the
+	 * view.  If a slash is found, the filename starts at the next
+	 * character after the slash.
+	 */
+	const auto idx_filename{(idx_last_slash == str_pathname.npos) ? 0 : idx_last_slash + 1};
+	const auto idx_file_extension{str_pathname.find_first_of('.', {idx_filename})};
+	if (idx_file_extension == str_pathname.npos)
+		return nullptr;	//missing extension
+	if (idx_file_extension >= DXX_MAX_MISSION_PATH_LENGTH)
+		return nullptr;	// path too long, would be truncated in save game files
+#if DXX_BUILD_DESCENT == 1
+	constexpr auto descent_version = Mission::descent_version_type::descent1;
+#elif DXX_BUILD_DESCENT == 2
+	// look if it's .mn2 or .msn
+	const auto descent_version = (str_pathname[idx_file_extension + 3] == MISSION_EXTENSION_DESCENT_II[3])
+		? Mission::descent_version_type::descent2
+		: Mission::descent_version_type::descent1;
+#endif
+	const auto h = find_mission_header(str_pathname.data(), descent_version);
+	if (!h)
+		return nullptr;
+	if (h->anarchy_only_flag == Mission::anarchy_only_level::only_anarchy_games && mission_filter == mission_filter_mode::exclude_anarchy)
+		return nullptr;
+	str_pathname.remove_suffix(str_pathname.size() - idx_file_extension);
+
+	return &mission_list.emplace_back(
+		/* Cast to ptrdiff_t is safe, because
+		 * `if (idx_file_extension >= DXX_MAX_MISSION_PATH_LENGTH)` is
+		 * true, then execution does not reach this line.  All values in
+		 * [0, DXX_MAX_MISSION_PATH_LENGTH) can be represented by
+		 * `std::ptrdiff_t`, so no narrowing occurs.
+		 */
+		Mission_path{str_pathname, static_cast<std::ptrdiff_t>(idx_filename)},
+		descent_hog_size,
+#if DXX_BUILD_DESCENT == 2
+		h->descent_version,
+#endif
+		h->anarchy_only_flag,
+		std::span(h->mission_name.data(), h->mission_name.size())
+	);
 }
 
 static std::span<const char> get_d1_mission_name_from_descent_hog_size(const descent_hog_size size)
@@ -769,6 +904,39 @@ static void add_missions_to_list(mission_list_type &mission_list, mission_candid
 	}
 }
 
+static void add_missions_dir_to_list(mission_list_type &mission_list, const mission_filter_mode mission_filter)
+{
+	mission_candidate_search_path search_str{{MISSION_DIR}};
+	DXX_POISON_MEMORY(std::span(search_str).subspan<sizeof(MISSION_DIR)>(), 0xcc);
+	add_missions_to_list(mission_list, search_str, std::next(search_str.begin(), sizeof(MISSION_DIR) - 1), mission_filter);
+}
+
+static void mission_list_finish_scan()
+{
+	if (Mission_scan_thread.joinable())
+		Mission_scan_thread.join();
+}
+
+}
+
+mission_list_scan::~mission_list_scan()
+{
+	mission_list_finish_scan();
+}
+
+mission_list_scan mission_list_start_scan()
+{
+	if (!Mission_header_cache_loaded)
+		read_mission_header_cache();
+	if (!Mission_scan_thread.joinable())
+		Mission_scan_thread = std::thread([]() {
+			/* The list is thrown away.  The scan is only run to fill
+			 * Mission_header_cache.
+			 */
+			mission_list_type mission_list;
+			add_missions_dir_to_list(mission_list, mission_filter_mode::include_anarchy);
+		});
+	return {};
 }
 
 }
@@ -797,6 +965,10 @@ Mission::~Mission()
     // May become more complex with the editor
 	if (!path.empty() && builtin_hogsize == descent_hog_size::None)
 		{
+			/* The search path entry cannot be removed while a file from
+			 * it is open
+			 */
+			gameseq_cancel_level_prefetch();
 			char hogpath[PATH_MAX];
 			snprintf(hogpath, sizeof(hogpath), "%s.hog", path.c_str());
 			PHYSFSX_removeRelFromSearchPath(hogpath);
@@ -826,6 +998,9 @@ static mission_list_type build_mission_list(const mission_filter_mode mission_fi
 //@@		return num_missions;
 //@@	}
 
+	mission_list_finish_scan();
+	if (!Mission_header_cache_loaded)
+		read_mission_header_cache();
 	mission_list_type mission_list;
 	
 #if DXX_BUILD_DESCENT == 2
@@ -833,9 +1008,8 @@ static mission_list_type build_mission_list(const mission_filter_mode mission_fi
 	add_builtin_mission_to_list(mission_list, builtin_mission_filename);  //read built-in first
 #endif
 	add_d1_builtin_mission_to_list(mission_list);
-	mission_candidate_search_path search_str{{MISSION_DIR}};
-	DXX_POISON_MEMORY(std::span(search_str).subspan<sizeof(MISSION_DIR)>(), 0xcc);
-	add_missions_to_list(mission_list, search_str, std::next(search_str.begin(), sizeof(MISSION_DIR) - 1), mission_filter);
+	add_missions_dir_to_list(mission_list, mission_filter);
+	write_mission_header_cache();
 	
 	// move original missions (in story-chronological order)
 	// to top of mission list
@@ -866,6 +1040,7 @@ int load_mission_ham()
 		Num_sound_files = 0;
 		read_sndfile(0);
 		piggy_read_sounds();
+		digi_prepare_sounds();
 	}
 
 	if (Current_mission->descent_version == Mission::descent_version_type::descent2a &&
@@ -50,6 +50,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "collide.h"
 #include "dxxerror.h"
 #include "fireball.h"
+#include "particle.h"
 #include "newmenu.h"
 #include "console.h"
 #include "wall.h"
@@ -115,6 +116,8 @@ namespace dsx {
 namespace {
 
 static void MultiLevelInv_Repopulate(fix frequency);
+static void multi_send_world_checksum();
+static void multi_do_world_checksum(playernum_t pnum, multiplayer_rspan<multiplayer_command_t::MULTI_WORLD_CHECKSUM> buf);
 void multi_new_bounty_target_with_sound(playernum_t, const char *callsign);
 static void multi_reset_object_texture(object_base &objp);
 static void multi_process_data(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, playernum_t pnum, std::span<const uint8_t> data, multiplayer_command_t type);
@@ -376,6 +379,12 @@ constexpr int message_length[] = {
 	for_each_multiplayer_command(define_message_length)
 };
 
+/* The names without the MULTI_ prefix */
+constexpr const char *message_name[] = {
+#define define_message_name(NAME,SIZE)	&#NAME[6],
+	for_each_multiplayer_command(define_message_name)
+};
+
 }
 
 }
@@ -383,6 +392,12 @@ constexpr int message_length[] = {
 namespace dsx {
 
 netgame_info Netgame;
+
+const char *multi_command_name(const uint8_t type)
+{
+	return type < std::size(message_name) ? message_name[type] : nullptr;
+}
+
 multi_level_inv MultiLevelInv;
 
 }
@@ -686,6 +701,7 @@ void multi_make_player_ghost(const playernum_t playernum)
 	}
 	const auto &&obj = vmobjptridx(vcplayerptr(playernum)->objnum);
 	obj->type = OBJ_GHOST;
+	Object_hot_fields.update(obj);
 	obj->render_type = render_type::RT_NONE;
 	obj->movement_source = object::movement_type::None;
 	multi_reset_player_object(obj);
@@ -703,6 +719,7 @@ void multi_make_ghost_player(const playernum_t playernum)
 	}
 	const auto &&obj = vmobjptridx(vcplayerptr(playernum)->objnum);
 	obj->type = OBJ_PLAYER;
+	Object_hot_fields.update(obj);
 	obj->movement_source = object::movement_type::physics;
 	multi_reset_player_object(obj);
 	if (playernum != Player_num)
@@ -1056,7 +1073,7 @@ static void multi_compute_kill(const d_robot_info_array &Robot_info, const imobj
 window_event_result multi_do_frame()
 {
 	static d_time_fix lasttime;
-	static fix64 last_gmode_time = 0, last_inventory_time = 0, last_repo_time = 0;
+	static fix64 last_gmode_time = 0, last_inventory_time = 0, last_repo_time = 0, last_checksum_time = 0;
 
 	if (!(Game_mode & GM_MULTI) || Newdemo_state == ND_STATE_PLAYBACK)
 	{
@@ -1099,6 +1116,11 @@ window_event_result multi_do_frame()
 			MultiLevelInv_Repopulate((F1_0/2));
 			last_repo_time = timer_query();
 		}
+		if (timer_query() >= last_checksum_time + F1_0)
+		{
+			multi_send_world_checksum();
+			last_checksum_time = timer_query();
+		}
 	}
 
 	multi_send_message(); // Send any waiting messages
@@ -2260,7 +2282,7 @@ static void multi_do_create_powerup(fvmsegptridx &vmsegptridx, const playernum_t
 
 	map_objnum_local_to_remote(my_objnum, objnum, pnum);
 
-	object_create_explosion_without_damage(Vclip, segnum, new_pos, i2f(5), vclip_index::powerup_disappearance);
+	create_cosmetic_explosion(Vclip, segnum, new_pos, i2f(5), vclip_index::powerup_disappearance);
 }
 
 static void multi_do_play_sound(object_array &Objects, const playernum_t pnum, const multiplayer_rspan<multiplayer_command_t::MULTI_PLAY_SOUND> buf)
@@ -2515,7 +2537,8 @@ static std::optional<multiplayer_command_t> build_multiplayer_command_from_untru
 void multi_process_bigdata(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, const playernum_t pnum, const std::span<const uint8_t> buf)
 {
 	// Takes a bunch of messages, check them for validity,
-	// and pass them to multi_process_data.
+	// and pass them to multi_process_data.  Each message is passed as a
+	// subspan of `buf`, so nothing is copied before its handler reads it.
 
 	uint_fast32_t bytes_processed{0};
 
@@ -2542,6 +2565,7 @@ void multi_process_bigdata(const d_level_shared_robot_info_state &LevelSharedRob
 			return;
 		}
 
+		net_udp_count_traffic(Net_udp_traffic_stats.command_received, type, sub_len);
 		multi_process_data(LevelSharedRobotInfoState, pnum, buf.subspan(bytes_processed, sub_len), *mtype);
 		bytes_processed += sub_len;
 	}
@@ -3937,6 +3961,7 @@ static void multi_do_vulcan_weapon_ammo_adjust(fvmobjptr &vmobjptr, const multip
 
 	const auto ammo{GET_INTEL_SHORT(&buf[4])};
 		obj->ctype.powerup_info.count = ammo;
+	MultiLevelInv_ObjectChanged(local_objnum);
 }
 
 }
@@ -5303,40 +5328,108 @@ static void multi_do_player_inventory(const playernum_t pnum, const multiplayer_
 }
 
 /*
- * Count the inventory of the level. Initial (start) or current (now).
- * In 'current', also consider player inventories (and the thief bot).
+ * What one object adds to the inventory of the level.
  * NOTE: We add actual ammo amount - we do not want to count in 'amount of powerups'. Makes it easier to keep track of overhead (proximities, vulcan ammo)
  */
-static void MultiLevelInv_CountLevelPowerups()
+struct multi_level_inv_object
 {
-	auto &Objects = LevelUniqueObjectState.Objects;
-	auto &vmobjptridx = Objects.vmptridx;
-        if (!(Game_mode & GM_MULTI) || +(Game_mode & GM_MULTI_COOP))
-                return;
-        MultiLevelInv.Current = {};
+	powerup_type_t type{};
+	uint32_t count{};
+	uint32_t vulcan_ammo{};	// contained in a vulcan or gauss cannon
+};
 
-        range_for (const auto &&objp, vmobjptridx)
-        {
-                if (objp->type == OBJ_WEAPON) // keep live bombs in inventory so they will respawn after they're gone
-                {
-                        auto wid = get_weapon_id(objp);
-                        if (wid == weapon_id_type::PROXIMITY_ID)
-                                MultiLevelInv.Current[powerup_type_t::POW_PROXIMITY_WEAPON]++;
+/*
+ * The objects' share of the current inventory, kept as the objects are
+ * created and deleted, so that a recount need not scan every object.
+ * Creating or deleting an object only marks its slot; the slot is
+ * counted again at the next recount, when its creator has finished
+ * filling it in.
+ */
+struct multi_level_inv_objects
+{
+	per_powerup_type_array<uint32_t> Count;
+	std::array<multi_level_inv_object, MAX_OBJECTS> Counted;
+	std::bitset<MAX_OBJECTS> Changed;
+	/* Set when the objects were replaced wholesale, as by loading a
+	 * level or restoring a game, and every slot must be counted again.
+	 */
+	bool Stale{true};
+	void update();
+};
+
+static multi_level_inv_objects MultiLevelInv_Objects;
+
+/*
+ * A checksum of the state that every player in the game should agree
+ * on, sent once a second so that a desync is noticed as it happens.
+ * Each part is a sum of shares, so that a share can be taken out and put
+ * back when its subject changes, and so that equal subjects do not
+ * cancel out.
+ */
+struct multi_world_checksum
+{
+	uint32_t objects{}, walls{}, players{};
+	constexpr bool operator==(const multi_world_checksum &) const = default;
+};
+
+/*
+ * The objects' share of the checksum, kept as the objects change in the
+ * way of multi_level_inv_objects.  The walls and players are few enough
+ * to be summed when the checksum is sent.
+ */
+struct multi_world_checksum_objects
+{
+	uint32_t Sum{};
+	std::array<uint32_t, MAX_OBJECTS> Summed;
+	std::bitset<MAX_OBJECTS> Changed;
+	bool Stale{true};
+	void update();
+};
+
+struct multi_world_checksum_state
+{
+	multi_world_checksum_objects Objects;
+	/* The checksums last sent, newest at Sent[Next - 1].  A peer's
+	 * checksum can trail ours by the latency between us.
+	 */
+	std::array<multi_world_checksum, 4> Sent;
+	uint8_t Next{};
+	/* How many checksums in a row from each player matched none of Sent */
+	per_player_array<uint8_t> Mismatches{};
+};
+
+static multi_world_checksum_state MultiWorldChecksum;
+
+static multi_level_inv_object MultiLevelInv_CountObject(const object &obj)
+{
+	multi_level_inv_object r;
+	if (obj.type == OBJ_WEAPON) // keep live bombs in inventory so they will respawn after they're gone
+	{
+		const auto wid = get_weapon_id(obj);
+		if (wid == weapon_id_type::PROXIMITY_ID)
+		{
+			r.type = powerup_type_t::POW_PROXIMITY_WEAPON;
+			r.count = 1;
+		}
 #if DXX_BUILD_DESCENT == 2
-                        if (wid == weapon_id_type::SUPERPROX_ID)
-                                MultiLevelInv.Current[powerup_type_t::POW_SMART_MINE]++;
+		else if (wid == weapon_id_type::SUPERPROX_ID)
+		{
+			r.type = powerup_type_t::POW_SMART_MINE;
+			r.count = 1;
+		}
 #endif
-                }
-                if (objp->type != OBJ_POWERUP)
-                        continue;
-                auto pid = get_powerup_id(objp);
+		return r;
+	}
+	if (obj.type != OBJ_POWERUP)
+		return r;
+	const auto pid = get_powerup_id(obj);
                 switch (pid)
                 {
 					case powerup_type_t::POW_VULCAN_WEAPON:
 #if DXX_BUILD_DESCENT == 2
 					case powerup_type_t::POW_GAUSS_WEAPON:
 #endif
-						MultiLevelInv.Current[powerup_type_t::POW_VULCAN_AMMO] += objp->ctype.powerup_info.count; // add contained ammo so we do not lose this from level when used up
+						r.vulcan_ammo = obj.ctype.powerup_info.count; // add contained ammo so we do not lose this from level when used up
 						/* fall through to increment Current[pid] */
 						[[fallthrough]];
                         case powerup_type_t::POW_LASER:
@@ -5367,7 +5460,8 @@ static void MultiLevelInv_CountLevelPowerups()
                         case powerup_type_t::POW_FLAG_BLUE:
                         case powerup_type_t::POW_FLAG_RED:
 #endif
-                                MultiLevelInv.Current[pid]++;
+                                r.type = pid;
+                                r.count = 1;
                                 break;
                         case powerup_type_t::POW_MISSILE_4:
                         case powerup_type_t::POW_HOMING_AMMO_4:
@@ -5376,21 +5470,87 @@ static void MultiLevelInv_CountLevelPowerups()
                         case powerup_type_t::POW_GUIDED_MISSILE_4:
                         case powerup_type_t::POW_MERCURY_MISSILE_4:
 #endif
-                                MultiLevelInv.Current[static_cast<powerup_type_t>(underlying_value(pid) - 1)] += 4;
+                                r.type = static_cast<powerup_type_t>(underlying_value(pid) - 1);
+                                r.count = 4;
                                 break;
                         case powerup_type_t::POW_PROXIMITY_WEAPON:
 #if DXX_BUILD_DESCENT == 2
                         case powerup_type_t::POW_SMART_MINE:
 #endif
-                                MultiLevelInv.Current[pid] += 4; // count the actual bombs
+                                r.type = pid;
+                                r.count = 4; // count the actual bombs
                                 break;
                         case powerup_type_t::POW_VULCAN_AMMO:
-                                MultiLevelInv.Current[pid] += VULCAN_AMMO_AMOUNT; // count the actual ammo
+                                r.type = pid;
+                                r.count = VULCAN_AMMO_AMOUNT; // count the actual ammo
                                 break;
                         default:
                                 break; // All other items either do not exist or we NEVER want to have them respawn.
                 }
-        }
+	return r;
+}
+
+static void MultiLevelInv_AddObject(per_powerup_type_array<uint32_t> &count, const multi_level_inv_object &o)
+{
+	count[o.type] += o.count;
+	count[powerup_type_t::POW_VULCAN_AMMO] += o.vulcan_ammo;
+}
+
+static void MultiLevelInv_RemoveObject(per_powerup_type_array<uint32_t> &count, const multi_level_inv_object &o)
+{
+	count[o.type] -= o.count;
+	count[powerup_type_t::POW_VULCAN_AMMO] -= o.vulcan_ammo;
+}
+
+void multi_level_inv_objects::update()
+{
+	auto &Objects = LevelUniqueObjectState.Objects;
+	if (Stale)
+	{
+		Stale = false;
+		Changed.reset();
+		Count = {};
+		Counted = {};
+		range_for (const auto &&objp, Objects.vcptridx)
+		{
+			auto &c = Counted[objp.get_unchecked_index()];
+			c = MultiLevelInv_CountObject(*objp);
+			MultiLevelInv_AddObject(Count, c);
+		}
+		return;
+	}
+	if (Changed.none())
+		return;
+	for (std::size_t i{0}; i != Changed.size(); ++i)
+	{
+		if (!Changed[i])
+			continue;
+		auto &c = Counted[i];
+		MultiLevelInv_RemoveObject(Count, c);
+		c = MultiLevelInv_CountObject(*Objects.vcptr(static_cast<objnum_t>(i)));
+		MultiLevelInv_AddObject(Count, c);
+	}
+	Changed.reset();
+}
+
+/*
+ * Count the inventory of the level. Initial (start) or current (now).
+ * In 'current', also consider player inventories (and the thief bot).
+ */
+static void MultiLevelInv_CountLevelPowerups()
+{
+        if (!(Game_mode & GM_MULTI) || +(Game_mode & GM_MULTI_COOP))
+                return;
+	auto &o = MultiLevelInv_Objects;
+	o.update();
+	MultiLevelInv.Current = o.Count;
+#ifndef NDEBUG
+	/* Check the kept counts against a scan of every object */
+	per_powerup_type_array<uint32_t> scanned{};
+	for (auto &obj : LevelUniqueObjectState.Objects.vcptr)
+		MultiLevelInv_AddObject(scanned, MultiLevelInv_CountObject(obj));
+	assert(scanned == o.Count);
+#endif
 }
 
 static void MultiLevelInv_CountPlayerInventory()
@@ -5483,6 +5643,7 @@ static void MultiLevelInv_CountPlayerInventory()
 
 void MultiLevelInv_InitializeCount()
 {
+	MultiLevelInv_Objects.Stale = true;
 	MultiLevelInv_CountLevelPowerups();
 	MultiLevelInv.Initial = MultiLevelInv.Current;
 	MultiLevelInv.RespawnTimer = {};
@@ -5494,8 +5655,32 @@ void MultiLevelInv_Recount()
 	MultiLevelInv_CountPlayerInventory();
 }
 
-// Takes a powerup type and checks if we are allowed to spawn it.
 namespace dsx {
+
+void MultiLevelInv_ObjectChanged(const objnum_t objnum)
+{
+	MultiLevelInv_Objects.Changed.set(objnum);
+}
+
+void MultiLevelInv_ObjectsReplaced()
+{
+	MultiLevelInv_Objects.Stale = true;
+}
+
+void multi_world_checksum_object_changed(const objnum_t objnum)
+{
+	MultiWorldChecksum.Objects.Changed.set(objnum);
+}
+
+void multi_world_checksum_objects_replaced()
+{
+	auto &c = MultiWorldChecksum;
+	c.Objects.Stale = true;
+	c.Sent = {};
+	c.Mismatches = {};
+}
+
+// Takes a powerup type and checks if we are allowed to spawn it.
 bool MultiLevelInv_AllowSpawn(powerup_type_t powerup_type)
 {
 	auto &LevelUniqueControlCenterState = LevelUniqueObjectState.ControlCenterState;
@@ -5551,6 +5736,146 @@ void MultiLevelInv_Repopulate(fix frequency)
 	}
 }
 
+static uint32_t multi_world_checksum_mix(uint32_t h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+static uint32_t multi_world_checksum_object(const object_base &obj)
+{
+	switch (obj.type)
+	{
+		case OBJ_ROBOT:
+		case OBJ_POWERUP:
+		case OBJ_HOSTAGE:
+		case OBJ_CNTRLCEN:
+			break;
+		default:
+			/* Players, weapons and effects come and go too quickly for
+			 * the peers to agree at any one time.
+			 */
+			return 0;
+	}
+	uint32_t h{static_cast<uint32_t>(obj.type) << 8 | obj.id};
+	/* Where a resting object is belongs in the checksum, but where a
+	 * moving one is differs between the peers by their latency.
+	 */
+	if (obj.movement_source != object::movement_type::physics)
+		h = h << 16 | obj.segnum;
+	return multi_world_checksum_mix(h);
+}
+
+void multi_world_checksum_objects::update()
+{
+	auto &Objects = LevelUniqueObjectState.Objects;
+	if (Stale)
+	{
+		Stale = false;
+		Changed.reset();
+		Sum = 0;
+		Summed = {};
+		range_for (const auto &&objp, Objects.vcptridx)
+			Sum += Summed[objp.get_unchecked_index()] = multi_world_checksum_object(*objp);
+		return;
+	}
+	if (Changed.none())
+		return;
+	for (std::size_t i{0}; i != Changed.size(); ++i)
+	{
+		if (!Changed[i])
+			continue;
+		auto &s = Summed[i];
+		Sum -= s;
+		auto &obj = *Objects.vcptr(static_cast<objnum_t>(i));
+		s = obj.type == OBJ_NONE ? 0 : multi_world_checksum_object(obj);
+		Sum += s;
+	}
+	Changed.reset();
+}
+
+static multi_world_checksum multi_world_checksum_compute()
+{
+	multi_world_checksum r;
+	auto &o = MultiWorldChecksum.Objects;
+	o.update();
+	r.objects = o.Sum;
+	/* Doors open and close on each machine's own clock, so only the
+	 * lasting changes to a wall are summed.
+	 */
+	range_for (const auto &&p, LevelUniqueWallSubsystemState.Walls.vcptridx)
+	{
+		auto &w = *p;
+		const uint32_t flags{(+(w.flags & wall_flag::blasted) ? 1u : 0u) | (+(w.flags & wall_flag::door_locked) ? 2u : 0u) | (+(w.flags & wall_flag::illusion_off) ? 4u : 0u)};
+		r.walls += multi_world_checksum_mix(static_cast<uint32_t>(p.get_unchecked_index()) << 16 | w.type << 8 | flags);
+	}
+	auto &vcobjptr = LevelUniqueObjectState.Objects.vcptr;
+	for (const auto &&[i, plr] : enumerate(partial_const_range(Players, N_players)))
+	{
+		if (plr.connected == player_connection_status::disconnected)
+			continue;
+		auto &player_info = vcobjptr(plr.objnum)->ctype.player_info;
+		const uint32_t keys{(player_info.powerup_flags & PLAYER_FLAGS_BLUE_KEY ? 1u : 0u) | (player_info.powerup_flags & PLAYER_FLAGS_RED_KEY ? 2u : 0u) | (player_info.powerup_flags & PLAYER_FLAGS_GOLD_KEY ? 4u : 0u)};
+		r.players += multi_world_checksum_mix(static_cast<uint32_t>(i) << 24 | keys);
+		r.players += multi_world_checksum_mix((static_cast<uint32_t>(i) << 24) | (1u << 23) | ((static_cast<uint16_t>(player_info.net_kills_total) << 8) ^ static_cast<uint16_t>(player_info.net_killed_total)));
+	}
+	return r;
+}
+
+void multi_send_world_checksum()
+{
+	auto &c = MultiWorldChecksum;
+	const auto sum{multi_world_checksum_compute()};
+	c.Sent[c.Next] = sum;
+	c.Next = (c.Next + 1) % c.Sent.size();
+	multi_command<multiplayer_command_t::MULTI_WORLD_CHECKSUM> multibuf;
+	PUT_INTEL_INT(&multibuf[1], sum.objects);
+	PUT_INTEL_INT(&multibuf[5], sum.walls);
+	PUT_INTEL_INT(&multibuf[9], sum.players);
+	multi_send_data(multibuf, multiplayer_data_priority::_0);
+}
+
+void multi_do_world_checksum(const playernum_t pnum, const multiplayer_rspan<multiplayer_command_t::MULTI_WORLD_CHECKSUM> buf)
+{
+	if (Network_status != network_state::playing)
+		return;
+	const multi_world_checksum theirs{
+		GET_INTEL_INT<uint32_t>(&buf[1]),
+		GET_INTEL_INT<uint32_t>(&buf[5]),
+		GET_INTEL_INT<uint32_t>(&buf[9]),
+	};
+	auto &c = MultiWorldChecksum;
+	auto &mismatches = c.Mismatches[pnum];
+	if (std::ranges::find(c.Sent, theirs) != c.Sent.end())
+	{
+		mismatches = 0;
+		return;
+	}
+	/* Two in a row is more than the latency explains.  Report it once
+	 * per desync.
+	 */
+	if (++mismatches != 2)
+		return;
+	/* A change to an object that was not noted leaves the kept sum
+	 * wrong here, not the world.  Sum every object again before
+	 * blaming the world.
+	 */
+	const auto kept{c.Objects.Sum};
+	c.Objects.Stale = true;
+	const auto ours{multi_world_checksum_compute()};
+	if (ours == theirs)
+	{
+		con_printf(CON_VERBOSE, "Multi: world checksum of objects was kept wrongly: %08x, summed %08x", kept, ours.objects);
+		mismatches = 0;
+		return;
+	}
+	con_printf(CON_URGENT, "Multi: desync with player #%u \"%s\": objects %08x/%08x, walls %08x/%08x, players %08x/%08x (theirs/ours)", pnum, static_cast<const char *>(vcplayerptr(pnum)->callsign), theirs.objects, ours.objects, theirs.walls, ours.walls, theirs.players, ours.players);
+}
+
 }
 
 #if DXX_BUILD_DESCENT == 2
@@ -6028,6 +6353,9 @@ static void multi_process_data(const d_level_shared_robot_info_state &LevelShare
 		case multiplayer_command_t::MULTI_PLAYER_INV:
 			multi_do_player_inventory(pnum, multi_subspan_first<multiplayer_command_t::MULTI_PLAYER_INV>(data));
 			break;
+		case multiplayer_command_t::MULTI_WORLD_CHECKSUM:
+			multi_do_world_checksum(pnum, multi_subspan_first<multiplayer_command_t::MULTI_WORLD_CHECKSUM>(data));
+			break;
 	}
 }
 
@@ -6505,10 +6833,11 @@ void show_netgame_info(const netgame_info &netgame)
 			blank_7,
 			network_options_header,
 			packets_per_second,
+			smooth_positions,
 		};
 		enum
 		{
-			count_array_elements = static_cast<unsigned>(packets_per_second) + 1
+			count_array_elements = static_cast<unsigned>(smooth_positions) + 1
 		};
 		enumerated_array<std::array<char, 50>, count_array_elements, netgame_menu_info_index> lines;
 		enumerated_array<newmenu_item, count_array_elements, netgame_menu_info_index> menu_items;
@@ -6609,6 +6938,7 @@ void show_netgame_info(const netgame_info &netgame)
 			array_snprintf(lines[enemy_names_on_hud], "Enemy Names On Hud\t  %s", netgame.ShowEnemyNames?TXT_YES:TXT_NO);
 			array_snprintf(lines[friendly_fire], "Friendly Fire (Team, Coop)\t  %s", netgame.NoFriendlyFire?TXT_NO:TXT_YES);
 			array_snprintf(lines[packets_per_second], "Packets Per Second\t  %i", netgame.PacketsPerSec);
+			array_snprintf(lines[smooth_positions], "Smooth Player Movement\t  %s", netgame.SmoothPositions ? TXT_YES : TXT_NO);
 		}
 	};
 	struct netgame_info_menu : netgame_info_menu_items, passive_newmenu
@@ -22,6 +22,8 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  * Multiplayer robot code
  *
  */
+#include <algorithm>
+#include <span>
 #include <type_traits>
 #include "multiinternal.h"
 
@@ -58,11 +60,16 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "d_construct.h"
 #include "d_levelstate.h"
 #include "partial_range.h"
+#include "d_range.h"
 
 namespace dcx {
 namespace {
 std::array<multi_send_robot_position_priority, MAX_ROBOTS_CONTROLLED> robot_send_pending;
 std::array<multi_command<multiplayer_command_t::MULTI_ROBOT_FIRE>, MAX_ROBOTS_CONTROLLED> robot_fire_buf;
+/* When the position of the robot in each slot was last sent, as opposed
+ * to robot_last_send_time, when it was last asked to be sent
+ */
+std::array<fix64, MAX_ROBOTS_CONTROLLED> robot_last_position_time;
 }
 std::array<objnum_t, MAX_ROBOTS_CONTROLLED> robot_controlled;
 std::array<int, MAX_ROBOTS_CONTROLLED> robot_agitation;
@@ -323,7 +330,7 @@ int multi_add_controlled_robot(const vmobjptridx_t objnum, int agitation)
 	objrobot.ctype.ai_info.REMOTE_OWNER = Player_num;
 	objrobot.ctype.ai_info.REMOTE_SLOT_NUM = i;
 	robot_controlled_time[i] = {GameTime64};
-	robot_last_send_time[i] = robot_last_message_time[i] = {GameTime64};
+	robot_last_send_time[i] = robot_last_message_time[i] = robot_last_position_time[i] = {GameTime64};
 	return(1);
 }	
 
@@ -397,6 +404,43 @@ void multi_send_release_robot(const vmobjptridx_t objnum)
 	multi_send_data(multibuf, multiplayer_data_priority::_2);
 }
 
+/* How many robot positions to send per robot frame.  The players choose
+ * the packet rate to suit the slowest connection in the game, so the
+ * robots get a share in proportion.
+ */
+static unsigned multi_robot_position_budget()
+{
+	return std::clamp<unsigned>(Netgame.PacketsPerSec / 10, 1, MAX_ROBOTS_CONTROLLED);
+}
+
+/* How much the other players need the position of the robot in `slot`.
+ * It grows with the time since the position was last sent, since the
+ * other players' copies drift further the longer they go uncorrected,
+ * so no robot waits forever.
+ */
+static fix64 multi_robot_position_urgency(const fvcobjptr &vcobjptr, const object &robot, const unsigned slot)
+{
+	fix64 r{GameTime64 - robot_last_position_time[slot] + 1};
+	if (robot_send_pending[slot] == multi_send_robot_position_priority::_2)
+		r *= 4;
+	if (player_is_visible(robot.ctype.ai_info.ail.previous_visibility))
+		r *= 2;
+	/* A robot near a player is seen in detail, and one far away is not
+	 * seen at all
+	 */
+	constexpr fix near_distance{F1_0 * 100};
+	fix nearest{INT32_MAX};
+	for (auto &plr : partial_const_range(Players, N_players))
+	{
+		if (plr.connected != player_connection_status::playing)
+			continue;
+		auto &plrobj = *vcobjptr(plr.objnum);
+		if (plrobj.type == OBJ_PLAYER)
+			nearest = std::min(nearest, static_cast<fix>(vm_vec_dist_quick(robot.pos, plrobj.pos)));
+	}
+	return r * near_distance / std::max(nearest, near_distance / 4);
+}
+
 }
 }
 
@@ -404,31 +448,40 @@ void multi_send_robot_frame()
 {
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &vmobjptridx = Objects.vmptridx;
-	static int last_sent = 0;
-
-	int i;
-
-	const unsigned sent = 0;
-	for (i = 0; i < MAX_ROBOTS_CONTROLLED; i++)
+	/* A fire message is an event, so every one is sent.  A position
+	 * replaces the last one sent, so when more robots wait than the
+	 * budget allows, the most urgent are sent, and the rest wait for a
+	 * later frame.  A robot that fired always has its position sent
+	 * first, so that the shot leaves from where the robot is.
+	 */
+	std::array<std::pair<fix64, unsigned>, MAX_ROBOTS_CONTROLLED> waiting;
+	std::size_t n_waiting{0};
+	for (const unsigned i : xrange(MAX_ROBOTS_CONTROLLED))
+		if (robot_controlled[i] != object_none && robot_send_pending[i] != multi_send_robot_position_priority::_0)
+			waiting[n_waiting++] = {multi_robot_position_urgency(Objects.vcptr, *vmobjptridx(robot_controlled[i]), i), i};
+	const auto by_urgency{std::span(waiting).first(n_waiting)};
+	std::ranges::sort(by_urgency, std::ranges::greater{}, &std::pair<fix64, unsigned>::first);
+	const auto budget{multi_robot_position_budget()};
+	unsigned sent{0};
+	for (const auto &[urgency, slot] : by_urgency)
+	{
+		if (sent >= budget && !robot_fired[slot])
+			continue;
+		++sent;
+		const auto p = std::exchange(robot_send_pending[slot], multi_send_robot_position_priority::_0);
+		robot_last_position_time[slot] = {GameTime64};
+		multi_send_robot_position_sub(vmobjptridx(robot_controlled[slot]), underlying_value(p) > 1 ? multiplayer_data_priority::_1 : multiplayer_data_priority::_0);
+	}
+	for (const unsigned i : xrange(MAX_ROBOTS_CONTROLLED))
 	{
-		int sending = (last_sent+1+i)%MAX_ROBOTS_CONTROLLED;
-		if (robot_controlled[sending] != object_none && (underlying_value(robot_send_pending[sending]) > sent || robot_fired[sending] > sent))
+		if (robot_controlled[i] == object_none)
+			continue;
+		if (auto &&b = robot_fired[i])
 		{
-			if (auto &pending = robot_send_pending[sending]; pending != multi_send_robot_position_priority::_0)
-			{
-				const auto p = std::exchange(pending, multi_send_robot_position_priority::_0);
-				multi_send_robot_position_sub(vmobjptridx(robot_controlled[sending]), underlying_value(p) > 1 ? multiplayer_data_priority::_1 : multiplayer_data_priority::_0);
-			}
-
-			if (auto &&b = robot_fired[sending])
-			{
-				b = 0;
-				multi_send_data(robot_fire_buf[sending], multiplayer_data_priority::_1);
-			}
-			last_sent = sending;
+			b = 0;
+			multi_send_data(robot_fire_buf[i], multiplayer_data_priority::_1);
 		}
 	}
-	Assert((last_sent >= 0) && (last_sent <= MAX_ROBOTS_CONTROLLED));
 }
 
 namespace dsx {
@@ -11,16 +11,20 @@
  */
 
 #include "dxxsconf.h"
+#include <cinttypes>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <future>
 #include <random>
 #include <ranges>
+#include <unordered_map>
 
 #include "pstypes.h"
 #include "window.h"
 #include "strutil.h"
 #include "args.h"
+#include "cvar.h"
 #include "timer.h"
 #include "newmenu.h"
 #include "key.h"
@@ -62,10 +66,23 @@
 #include "d_levelstate.h"
 #include "d_range.h"
 #include "d_zip.h"
+#include "frame_profile.h"
 #include "partial_range.h"
+#include "physfsx.h"
 #include <array>
 #include <utility>
 
+/* sendmmsg and recvmmsg move several datagrams per system call.  Where
+ * they are missing, the same calls are made one datagram at a time.
+ */
+#ifndef DXX_USE_MMSG
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#define DXX_USE_MMSG	1
+#else
+#define DXX_USE_MMSG	0
+#endif
+#endif
+
 #if DXX_BUILD_DESCENT == 1
 #define UDP_REQ_ID "D1XR" // ID string for a request packet
 #elif DXX_BUILD_DESCENT == 2
@@ -100,6 +117,8 @@ enum class upid : uint8_t
 	mdata_pnorm,	// Packet containing multi buffer from a player. Priority 0,1 - no ACK needed.
 	mdata_pneedack,	// Packet containing multi buffer from a player. Priority 2 - ACK needed. Also contains pkt_num
 	mdata_ack,	// ACK packet for UPID_MDATA_P1.
+	pdata_delta,	// Packet from player containing his movement data, relative to his last pdata packet.
+	object_data_ack,	// ACK packet from a joining player for upid::object_data.
 #if DXX_USE_TRACKER
 	/* Tracker upid codes are special.  They must be compatible with the
 	 * tracker, which is a separate program maintained in a different
@@ -162,11 +181,14 @@ template <>
 constexpr std::size_t upid_length<upid::pong> = 10;
 
 template <>
-constexpr std::size_t upid_length<upid::pdata> = 49;
+constexpr std::size_t upid_length<upid::pdata> = 50;
 
 template <>
 constexpr std::size_t upid_length<upid::mdata_ack> = 7;
 
+template <>
+constexpr std::size_t upid_length<upid::object_data_ack> = 7;
+
 template <upid id>
 using upid_rspan = std::span<const uint8_t, upid_length<id>>;
 
@@ -208,6 +230,153 @@ struct UDP_frame_info : prohibit_void_ptr<UDP_frame_info>
 	quaternionpos			qpp;
 };
 
+/* Every pdata_keyframe_interval'th position update is a full upid::pdata
+ * packet, numbered by `sequence`.  The others are upid::pdata_delta
+ * packets, which name the sequence of the keyframe they were built
+ * against and are dropped by peers which did not receive it.
+ */
+constexpr unsigned pdata_keyframe_interval = 6;
+
+struct UDP_pdata_keyframe
+{
+	quaternionpos qpp;
+	uint8_t sequence;
+	bool valid;
+};
+
+/* upid::pdata_delta is 4 header bytes (upid, player, connected,
+ * keyframe sequence) and then these fields, bit packed, least
+ * significant bit first.  Each is a fix shifted right by its `shift`,
+ * stored signed in `bits` bits.  Position is relative to the keyframe.
+ * A flag bit tells whether the segment differs from the keyframe's, and
+ * if so, the segment follows in 16 bits.
+ */
+struct pdata_delta_field
+{
+	unsigned bits, shift;
+};
+constexpr std::size_t pdata_delta_header_size = 4;
+constexpr pdata_delta_field pdata_delta_pos{20, 4};
+constexpr pdata_delta_field pdata_delta_orient{12, 4};
+constexpr pdata_delta_field pdata_delta_vel{18, 8};
+constexpr pdata_delta_field pdata_delta_rotvel{16, 4};
+constexpr std::size_t pdata_delta_max_size = pdata_delta_header_size + (3 * pdata_delta_pos.bits + 4 * pdata_delta_orient.bits + 1 + 16 + 3 * pdata_delta_vel.bits + 3 * pdata_delta_rotvel.bits + 7) / 8;
+
+class pdata_bit_writer
+{
+	const std::span<uint8_t> out;
+	std::size_t bit{0};
+public:
+	pdata_bit_writer(const std::span<uint8_t> out) :
+		out{out}
+	{
+		std::ranges::fill(out, 0);
+	}
+	void put(const uint32_t value, const unsigned bits)
+	{
+		for (unsigned i = 0; i != bits; ++i, ++bit)
+			if (value & (1u << i))
+				out[bit / 8] |= 1u << (bit % 8);
+	}
+	/* Returns false if `value` does not fit */
+	bool put(const int32_t value, const pdata_delta_field f)
+	{
+		const int32_t q = value >> f.shift;
+		const int32_t limit = 1 << (f.bits - 1);
+		if (q < -limit || q >= limit)
+			return false;
+		put(static_cast<uint32_t>(q), f.bits);
+		return true;
+	}
+	bool put(const vms_vector &v, const pdata_delta_field f)
+	{
+		return put(v.x, f) && put(v.y, f) && put(v.z, f);
+	}
+	std::size_t size() const
+	{
+		return (bit + 7) / 8;
+	}
+};
+
+class pdata_bit_reader
+{
+	const std::span<const uint8_t> in;
+	std::size_t bit{0};
+public:
+	pdata_bit_reader(const std::span<const uint8_t> in) :
+		in{in}
+	{
+	}
+	/* Bits past the end of the packet read as zero.  Check overrun()
+	 * after the last read.
+	 */
+	uint32_t get(const unsigned bits)
+	{
+		uint32_t v{};
+		for (unsigned i = 0; i != bits; ++i, ++bit)
+			if (bit / 8 < in.size() && (in[bit / 8] & (1u << (bit % 8))))
+				v |= 1u << i;
+		return v;
+	}
+	int32_t get(const pdata_delta_field f)
+	{
+		const uint32_t sign = 1u << (f.bits - 1);
+		return (static_cast<int32_t>(get(f.bits) ^ sign) - static_cast<int32_t>(sign)) * (1 << f.shift);
+	}
+	vms_vector get_vector(const pdata_delta_field f)
+	{
+		const auto x{get(f)};
+		const auto y{get(f)};
+		const auto z{get(f)};
+		return {x, y, z};
+	}
+	bool overrun() const
+	{
+		return bit > in.size() * 8;
+	}
+};
+
+/* Returns the size of the packet, or 0 if `qpp` is too far from `key`
+ * to be sent as a delta.
+ */
+static std::size_t net_udp_build_pdata_delta(const std::span<uint8_t, pdata_delta_max_size> buf, const quaternionpos &qpp, const quaternionpos &key)
+{
+	pdata_bit_writer w{buf.subspan(pdata_delta_header_size)};
+	if (!w.put(vm_vec_build_sub(qpp.pos, key.pos), pdata_delta_pos))
+		return 0;
+	for (const auto o : {qpp.orient.w, qpp.orient.x, qpp.orient.y, qpp.orient.z})
+		w.put(int32_t{o}, pdata_delta_orient);
+	if (qpp.segment == key.segment)
+		w.put(0u, 1);
+	else
+	{
+		w.put(1u, 1);
+		w.put(uint32_t{static_cast<uint16_t>(qpp.segment)}, 16);
+	}
+	if (!w.put(qpp.vel, pdata_delta_vel) || !w.put(qpp.rotvel, pdata_delta_rotvel))
+		return 0;
+	return pdata_delta_header_size + w.size();
+}
+
+static bool net_udp_read_pdata_delta(const std::span<const uint8_t> data, const quaternionpos &key, quaternionpos &qpp)
+{
+	pdata_bit_reader r{data.subspan(pdata_delta_header_size)};
+	qpp.pos = vm_vec_build_add(key.pos, r.get_vector(pdata_delta_pos));
+	qpp.orient.w = r.get(pdata_delta_orient);
+	qpp.orient.x = r.get(pdata_delta_orient);
+	qpp.orient.y = r.get(pdata_delta_orient);
+	qpp.orient.z = r.get(pdata_delta_orient);
+	if (!r.get(1))
+		qpp.segment = key.segment;
+	else if (const auto s{vmsegidx_t::check_nothrow_index(segnum_t{static_cast<uint16_t>(r.get(16))})})
+		qpp.segment = *s;
+	else
+		return false;
+	qpp.vel = r.get_vector(pdata_delta_vel);
+	qpp.rotvel = r.get_vector(pdata_delta_rotvel);
+	return !r.overrun();
+}
+
 enum class join_netgame_status_code : uint8_t
 {
 	game_in_disallowed_state,
@@ -443,6 +612,152 @@ struct UDP_sequence_syncplayer_packet
 	}
 };
 
+/* The objects are sent to a joining player as numbered upid::object_data
+ * packets.  The host keeps up to object_sync_window of them unacknowledged
+ * at once, and sends each again every object_sync_resend_delay until the
+ * joining player acknowledges it.  The joining player reads them in order,
+ * holding any that arrive early.
+ */
+constexpr unsigned object_sync_window = 32;
+constexpr fix object_sync_resend_delay = F1_0 / 5;
+
+struct UDP_object_sync_state
+{
+	struct packet
+	{
+		std::array<uint8_t, UPID_MAX_SIZE> buf;
+		/* Zero when the slot is free */
+		uint16_t length;
+		fix64 sent_time;
+	};
+	std::array<packet, object_sync_window> packets;
+	/* The host: the oldest packet not acknowledged.  The joining player:
+	 * the next packet to read.
+	 */
+	uint16_t base;
+	/* The host: the sequence of the next packet to build */
+	uint16_t next;
+	packet &slot(const uint16_t sequence)
+	{
+		return packets[sequence % object_sync_window];
+	}
+};
+
+/* When Netgame.SmoothPositions is set, the positions received about each
+ * remote player are kept with the time they arrived, and the player is
+ * shown where it was a little while ago, blended between the two
+ * positions either side of that time.  The delay follows how unevenly the
+ * positions arrive.  When no newer position has arrived, the player is
+ * moved on along its last velocity for at most pdata_max_extrapolation.
+ */
+constexpr unsigned pdata_jitter_buffer_size = 8;
+constexpr fix pdata_min_delay = F1_0 / 50;
+constexpr fix pdata_max_delay = F1_0 / 4;
+constexpr fix pdata_max_extrapolation = F1_0 / 4;
+/* Positions further apart than this are a respawn or a teleport, and are
+ * not blended.
+ */
+constexpr fix pdata_max_blend_distance = F1_0 * 40;
+
+struct UDP_pdata_jitter_buffer
+{
+	struct snapshot
+	{
+		fix64 time;
+		quaternionpos qpp;
+	};
+	std::array<snapshot, pdata_jitter_buffer_size> snapshots;
+	/* The newest snapshot is snapshots[newest_index] */
+	uint8_t newest_index;
+	uint8_t count;
+	/* Running averages of the time between positions and of how far each
+	 * time differs from the average.
+	 */
+	fix interval;
+	fix jitter;
+	const snapshot &get(const unsigned age) const
+	{
+		return snapshots[(newest_index + pdata_jitter_buffer_size - age) % pdata_jitter_buffer_size];
+	}
+	void push(const fix64 time, const quaternionpos &qpp)
+	{
+		if (count)
+		{
+			const fix d = static_cast<fix>(std::min<fix64>(time - get(0).time, F1_0));
+			if (count == 1)
+				interval = d;
+			else
+			{
+				jitter += (std::abs(d - interval) - jitter) / 16;
+				interval += (d - interval) / 16;
+			}
+		}
+		newest_index = (newest_index + 1) % pdata_jitter_buffer_size;
+		snapshots[newest_index] = {time, qpp};
+		if (count < pdata_jitter_buffer_size)
+			++count;
+	}
+	fix delay() const
+	{
+		return std::clamp(interval + 2 * jitter, pdata_min_delay, pdata_max_delay);
+	}
+};
+
+/* The address found by udp_dns_filladdr_async, or what went wrong */
+struct udp_dns_async_result
+{
+	_sockaddr addr;
+	const char *error;
+};
+
+/* Write the bytes of `rw` which are not zero, after a bitmap of which
+ * they are.  Most objects leave much of object_rw zero, so this about
+ * doubles how many fit in a packet.
+ */
+constexpr std::size_t object_rw_mask_size = (sizeof(object_rw) + 7) / 8;
+
+/* The size that net_udp_pack_object_rw writes for `rw`, so that the
+ * caller can check for room before packing straight into the packet.
+ */
+static std::size_t net_udp_packed_object_rw_size(const object_rw &rw)
+{
+	const auto in = reinterpret_cast<const uint8_t *>(&rw);
+	return object_rw_mask_size + sizeof(object_rw) - std::count(in, in + sizeof(object_rw), 0);
+}
+
+static std::size_t net_udp_pack_object_rw(const object_rw &rw, const std::span<uint8_t> out)
+{
+	const auto in = reinterpret_cast<const uint8_t *>(&rw);
+	std::fill_n(out.begin(), object_rw_mask_size, 0);
+	std::size_t loc = object_rw_mask_size;
+	for (std::size_t i = 0; i != sizeof(object_rw); ++i)
+		if (const auto b = in[i])
+		{
+			out[i / 8] |= 1u << (i % 8);
+			out[loc++] = b;
+		}
+	return loc;
+}
+
+/* Returns the bytes read from `in`, or zero if it is too short */
+static std::size_t net_udp_unpack_object_rw(const std::span<const uint8_t> in, object_rw &rw)
+{
+	if (in.size() < object_rw_mask_size)
+		return 0;
+	const auto out = reinterpret_cast<uint8_t *>(&rw);
+	std::size_t loc = object_rw_mask_size;
+	for (std::size_t i = 0; i != sizeof(object_rw); ++i)
+	{
+		if (!(in[i / 8] & (1u << (i % 8))))
+			out[i] = 0;
+		else if (loc < in.size())
+			out[i] = in[loc++];
+		else
+			return 0;
+	}
+	return loc;
+}
+
 // Prototypes
 static void net_udp_init();
 static void net_udp_close();
@@ -465,6 +780,7 @@ static void net_udp_send_extras();
 #if DXX_USE_TRACKER
 static int udp_tracker_register();
 static int udp_tracker_reqgames();
+static void udp_tracker_send_deferred();
 #endif
 
 template <upid id>
@@ -490,29 +806,121 @@ static void net_udp_ping_frame(fix64 time);
 static void net_udp_process_ping(upid_rspan<upid::ping>, const _sockaddr &sender_addr);
 static void net_udp_process_pong(upid_rspan<upid::pong>, const _sockaddr &sender_addr);
 static void net_udp_read_endlevel_packet(const uint8_t *data, const _sockaddr &sender_addr);
-static void net_udp_send_mdata(int needack, fix64 time);
+static void net_udp_send_mdata(fix64 time);
 static void net_udp_process_mdata(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, std::span<uint8_t> data, const _sockaddr &sender_addr, int needack);
 static void net_udp_send_pdata();
 static void net_udp_process_pdata (std::span<const uint8_t> data, const _sockaddr &sender_addr);
+static void net_udp_process_pdata_delta(std::span<const uint8_t> data, const _sockaddr &sender_addr);
+static void net_udp_relay_and_read_pdata(std::span<const uint8_t> data, UDP_frame_info &pd);
+static void net_udp_update_pdata_relevance();
 static void net_udp_read_pdata_packet(UDP_frame_info *pd);
+static void net_udp_apply_pdata_jitter_buffers(fix64 time);
 static void net_udp_timeout_check(fix64 time);
 static int net_udp_get_new_player_num ();
 static void net_udp_noloss_got_ack(std::span<const uint8_t>);
 static void net_udp_noloss_init_mdata_queue();
 static void net_udp_noloss_clear_mdata_trace(ubyte player_num);
 static void net_udp_noloss_process_queue(fix64 time);
-static int net_udp_start_game();
+static int net_udp_start_game(bool unattended);
 
 // Variables
 static int UDP_num_sendto, UDP_len_sendto, UDP_num_recvfrom, UDP_len_recvfrom;
 static UDP_mdata_info		UDP_MData;
-static unsigned UDP_mdata_queue_highest;
-static std::array<UDP_mdata_store, UDP_MDATA_STOR_QUEUE_SIZE> UDP_mdata_queue;
+/* Whether UDP_MData holds a priority 2 message, so must be sent with
+ * upid::mdata_pneedack, and when it must be sent because it holds a
+ * priority 1 or 2 message.  Zero if it holds only priority 0 messages,
+ * which wait for the next robot frame.
+ */
+static bool UDP_MData_needack;
+static fix64 UDP_MData_flush_time;
+/* How long a priority 1 or 2 message may wait for others to share its
+ * packet
+ */
+constexpr fix UDP_MDATA_LATENCY_BUDGET = F1_0 / 100;
+#define UDP_MDATA_RESEND_DELAY (F1_0/4)
+
+/* The mdata packets waiting for ACKs, in a ring, oldest first.  ACKs find
+ * their packet through slot_by_pkt_num and resends through the resends
+ * ring, so neither scans the queue.
+ */
+struct UDP_mdata_ring
+{
+	struct resend
+	{
+		fix64 due;
+		uint32_t serial;
+		uint16_t slot;
+		uint8_t pnum;
+	};
+	std::array<UDP_mdata_store, UDP_MDATA_STOR_QUEUE_SIZE> store;
+	/* Numbers each packet added, so that an index entry or a resend left
+	 * behind by a packet no longer queued is not applied to a packet
+	 * which reused its slot.
+	 */
+	std::array<uint32_t, UDP_MDATA_STOR_QUEUE_SIZE> serial;
+	uint32_t next_serial;
+	unsigned head, count;
+	/* The slot of the packet sent to each player with a given pkt_num, at
+	 * pkt_num % UDP_MDATA_STOR_QUEUE_SIZE.  A player's pkt_num only
+	 * advances for packets queued for him, so the ones still queued never
+	 * share a position.
+	 */
+	per_player_array<std::array<uint16_t, UDP_MDATA_STOR_QUEUE_SIZE>> slot_by_pkt_num;
+	/* One entry for each packet and player waiting for an ACK, in the
+	 * order they are due.  Every resend waits UDP_MDATA_RESEND_DELAY, so
+	 * a new entry always goes at the back.  Entries of packets since
+	 * ACK'd or removed stay until they are due, which the extra room
+	 * allows for.
+	 */
+	std::array<resend, 2 * UDP_MDATA_STOR_QUEUE_SIZE * MAX_PLAYERS> resends;
+	unsigned resend_head, resend_count;
+	void pop_head()
+	{
+		store[head] = {};
+		head = (head + 1) % UDP_MDATA_STOR_QUEUE_SIZE;
+		--count;
+	}
+	void push_resend(const resend &r)
+	{
+		if (resend_count == resends.size())
+		{
+			/* That should not happen.  If it does, the oldest resend is
+			 * lost, and the packet times out if it is not ACK'd.
+			 */
+			resend_head = (resend_head + 1) % resends.size();
+			--resend_count;
+		}
+		resends[(resend_head + resend_count) % resends.size()] = r;
+		++resend_count;
+	}
+};
+
+static UDP_mdata_ring UDP_mdata_queue;
 static per_player_array<UDP_mdata_check> UDP_mdata_trace;
+/* The last full pdata packet sent, and the last received from each
+ * player, which upid::pdata_delta packets are relative to.
+ */
+static UDP_pdata_keyframe UDP_pdata_sent;
+static unsigned UDP_pdata_sent_since_keyframe;
+static per_player_array<UDP_pdata_keyframe> UDP_pdata_received;
+/* Bytes of pdata received about each player since the last traffic report */
+static per_player_array<unsigned> UDP_len_pdata;
+static per_player_array<UDP_pdata_jitter_buffer> UDP_pdata_jitter;
+/* The host sends every Nth position update of player [from] to player
+ * [to], and counts the updates it skipped since the last one sent.
+ * Zero means every update.
+ */
+static per_player_array<per_player_array<uint8_t>> UDP_pdata_relay_interval;
+static per_player_array<per_player_array<uint8_t>> UDP_pdata_relay_skipped;
 static UDP_sequence_syncplayer_packet UDP_sync_player; // For rejoin object syncing
+static UDP_object_sync_state UDP_object_sync; // Both ends of rejoin object syncing
 static uint16_t UDP_MyPort;
 #if DXX_USE_TRACKER
 static _sockaddr TrackerSocket;
+/* The lookup of TrackerSocket, while it runs */
+static std::future<udp_dns_async_result> TrackerSocketLookup;
+/* Whether udp_tracker_reqgames was called before TrackerSocket was known */
+static bool TrackerReqgamesDeferred;
 enum class TrackerAckState : uint8_t
 {
 	TACK_NOCONNECTION,   // No connection with tracker (yet);
@@ -879,6 +1287,81 @@ static bool convert_text_portstring(const std::array<char, 6> &portstring, uint1
 	return true;
 }
 
+}
+
+/* Network statistics - START */
+net_udp_traffic_stats Net_udp_traffic_stats;
+
+namespace {
+
+/* 0: off.  1: log the traffic counts every net_udp_stats_log_interval.
+ * 2: also draw them over the game.
+ */
+cvar_t net_stats_cvar{"net_stats", "0", CVAR_NONE, 0, 0};
+constexpr fix net_udp_stats_log_interval = F1_0 * 30;
+/* When set to a file name, the counters are written there in the
+ * Prometheus text format every net_udp_metrics_interval, for a
+ * collector that reads files.  The tick times are only written while
+ * frame_profile is on.
+ */
+cvar_t net_metrics_file_cvar{"net_metrics_file", "", CVAR_NONE, 0, 0};
+constexpr fix net_udp_metrics_interval = F1_0 * 5;
+
+constexpr std::array<const char *, 27> upid_names{{
+	nullptr,
+	"version_deny",
+	"game_info_req",
+	"game_info",
+	"game_info_lite_req",
+	"game_info_lite",
+	"dump",
+	"addplayer",
+	"request",
+	"quit_joining",
+	"sync",
+	"object_data",
+	"ping",
+	"pong",
+	"endlevel_h",
+	"endlevel_c",
+	"pdata",
+	"mdata_pnorm",
+	"mdata_pneedack",
+	"mdata_ack",
+	"pdata_delta",
+	"tracker_register",
+	"tracker_remove",
+	"tracker_reqgames",
+	"tracker_gameinfo",
+	"tracker_ack",
+	"tracker_holepunch",
+}};
+
+static void net_udp_record_rtt(const unsigned ms)
+{
+	std::size_t bucket{0};
+	for (unsigned limit = 25; bucket != net_udp_rtt_buckets - 1 && ms >= limit; limit *= 2)
+		++bucket;
+	++Net_udp_traffic_stats.rtt[bucket];
+}
+
+static void net_udp_reset_stats()
+{
+	Net_udp_traffic_stats = {};
+	Net_udp_traffic_stats.start_time = timer_query();
+}
+
+}
+
+void net_udp_stats_init()
+{
+	cvar_registervariable(net_stats_cvar);
+	cvar_registervariable(net_metrics_file_cvar);
+}
+/* Network statistics - END */
+
+namespace {
+
 /* General UDP functions - START */
 ssize_t dxx_sendto(const int sockfd, const csocket_data_buffer msg, const int flags, const csockaddr_ref to)
 {
@@ -886,7 +1369,10 @@ ssize_t dxx_sendto(const int sockfd, const csocket_data_buffer msg, const int fl
 
 	UDP_num_sendto++;
 	if (rv > 0)
+	{
 		UDP_len_sendto += rv;
+		net_udp_count_traffic(Net_udp_traffic_stats.upid_sent, msg[0], rv);
+	}
 
 	return rv;
 }
@@ -901,6 +1387,59 @@ ssize_t dxx_recvfrom(const int sockfd, const socket_data_buffer msg, const int f
 	return rv;
 }
 
+/* Send the same datagram to each peer in `to` */
+static void dxx_sendto_each(const int sockfd, const csocket_data_buffer msg, const int flags, const std::span<const _sockaddr *const> to)
+{
+#if DXX_USE_MMSG
+	iovec iov{const_cast<uint8_t *>(msg.data()), msg.size()};
+	std::array<mmsghdr, MAX_PLAYERS> hdr;
+	for (auto remaining{to}; !remaining.empty();)
+	{
+		const auto batch{remaining.first(std::min(remaining.size(), hdr.size()))};
+		for (std::size_t i = 0; i != batch.size(); ++i)
+		{
+			const csockaddr_ref r{*batch[i]};
+			auto &h = hdr[i];
+			h = {};
+			h.msg_hdr.msg_name = const_cast<sockaddr *>(&r.sa);
+			h.msg_hdr.msg_namelen = r.len;
+			h.msg_hdr.msg_iov = &iov;
+			h.msg_hdr.msg_iovlen = 1;
+		}
+		const auto sent{sendmmsg(sockfd, hdr.data(), batch.size(), flags)};
+		if (sent <= 0)
+		{
+			/* Like dxx_sendto, a failed send is counted and not retried */
+			UDP_num_sendto++;
+			remaining = remaining.subspan(1);
+		}
+		else
+		{
+			UDP_num_sendto += sent;
+			UDP_len_sendto += sent * msg.size();
+			net_udp_count_traffic(Net_udp_traffic_stats.upid_sent, msg[0], msg.size(), sent);
+			remaining = remaining.subspan(sent);
+		}
+	}
+#else
+	for (const auto a : to)
+		dxx_sendto(sockfd, msg, flags, *a);
+#endif
+}
+
+/* The addresses of the players other than the host for which `keep(i)`
+ * is true, for dxx_sendto_each.
+ */
+template <typename F>
+static std::span<const _sockaddr *const> udp_peer_addresses(std::array<const _sockaddr *, MAX_PLAYERS> &out, F keep)
+{
+	std::size_t n{0};
+	for (unsigned i = 1; i < MAX_PLAYERS; ++i)
+		if (keep(i))
+			out[n++] = &Netgame.players[i].protocol.udp.addr;
+	return std::span<const _sockaddr *const>(out).first(n);
+}
+
 static game_info_request_result net_udp_check_game_info_request(const upid_rspan<upid::game_info_lite_req> data, std::integral_constant<upid, upid::game_info_lite_req>)
 {
 	if (const auto sender_major_version{GET_INTEL_SHORT(&data[5])}; sender_major_version != DXX_VERSION_MAJORi)
@@ -970,6 +1509,8 @@ static std::optional<upid> build_upid_from_untrusted(const uint8_t cmd)
 		case static_cast<uint8_t>(upid::mdata_pnorm):
 		case static_cast<uint8_t>(upid::mdata_pneedack):
 		case static_cast<uint8_t>(upid::mdata_ack):
+		case static_cast<uint8_t>(upid::pdata_delta):
+		case static_cast<uint8_t>(upid::object_data_ack):
 #if DXX_USE_TRACKER
 		case static_cast<uint8_t>(upid::tracker_gameinfo):
 		case static_cast<uint8_t>(upid::tracker_ack):
@@ -995,20 +1536,232 @@ static void net_udp_process_version_deny(const upid_rspan<upid::version_deny> da
 
 namespace {
 
+using net_udp_stats_line = std::array<char, 96>;
+constexpr std::size_t net_udp_stats_top_upids = 6;
+constexpr std::size_t net_udp_stats_top_commands = 8;
+constexpr std::size_t net_udp_stats_line_count = 3 + net_udp_stats_top_upids + net_udp_stats_top_commands;
+
+/* Write to `out` the types with the most bytes sent and received, most
+ * first.  Returns how many were written.
+ */
+static std::size_t net_udp_top_traffic(const std::array<net_udp_traffic_counter, 256> &sent, const std::array<net_udp_traffic_counter, 256> &received, const std::span<uint8_t> out)
+{
+	std::array<uint8_t, 256> types;
+	std::size_t n{0};
+	for (unsigned i = 0; i != types.size(); ++i)
+		if (sent[i].bytes || received[i].bytes)
+			types[n++] = i;
+	const auto total = [&](const uint8_t t) {
+		return uint64_t{sent[t].bytes} + received[t].bytes;
+	};
+	const auto shown{std::min(n, out.size())};
+	std::partial_sort(types.begin(), std::next(types.begin(), shown), std::next(types.begin(), n), [&](const uint8_t a, const uint8_t b) {
+		return total(a) > total(b);
+	});
+	std::copy_n(types.begin(), shown, out.begin());
+	return shown;
+}
+
+static std::size_t net_udp_format_traffic(const std::span<net_udp_stats_line> lines, const std::array<net_udp_traffic_counter, 256> &sent, const std::array<net_udp_traffic_counter, 256> &received, const char *const kind, const auto name_of)
+{
+	std::array<uint8_t, std::max(net_udp_stats_top_upids, net_udp_stats_top_commands)> top;
+	const auto n{net_udp_top_traffic(sent, received, std::span(top).first(lines.size()))};
+	for (std::size_t i = 0; i != n; ++i)
+	{
+		const auto t{top[i]};
+		std::array<char, 24> number;
+		const char *name = name_of(t);
+		if (!name)
+		{
+			std::snprintf(number.data(), number.size(), "%s %u", kind, t);
+			name = number.data();
+		}
+		std::snprintf(lines[i].data(), lines[i].size(), "%-20s out %6u %8uB  in %6u %8uB", name, sent[t].count, sent[t].bytes, received[t].count, received[t].bytes);
+	}
+	return n;
+}
+
+/* Fill `lines` with a summary of Net_udp_traffic_stats.  Returns how many
+ * lines were written.
+ */
+static std::size_t net_udp_format_stats(const std::span<net_udp_stats_line, net_udp_stats_line_count> lines)
+{
+	auto &s = Net_udp_traffic_stats;
+	uint64_t out_bytes{0}, in_bytes{0};
+	for (auto &c : s.upid_sent)
+		out_bytes += c.bytes;
+	for (auto &c : s.upid_received)
+		in_bytes += c.bytes;
+	const auto seconds{static_cast<unsigned>((timer_query() - s.start_time) / F1_0)};
+	std::snprintf(lines[0].data(), lines[0].size(), "Network traffic over %us: out %" PRIu64 "KB, in %" PRIu64 "KB", seconds, out_bytes / 1024, in_bytes / 1024);
+	std::snprintf(lines[1].data(), lines[1].size(), "MData queue %u, peak %u, %u resends", UDP_mdata_queue.count, s.mdata_queue_peak, s.mdata_resends);
+	static_assert(net_udp_rtt_buckets == 8);
+	auto &r = s.rtt;
+	std::snprintf(lines[2].data(), lines[2].size(), "RTT <25ms %u, <50 %u, <100 %u, <200 %u, <400 %u, <800 %u, <1600 %u, more %u", r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7]);
+	std::size_t n{3};
+	n += net_udp_format_traffic(lines.subspan(n, net_udp_stats_top_upids), s.upid_sent, s.upid_received, "upid", [](const uint8_t t) {
+		return t < upid_names.size() ? upid_names[t] : nullptr;
+	});
+	n += net_udp_format_traffic(lines.subspan(n, net_udp_stats_top_commands), s.command_sent, s.command_received, "command", multi_command_name);
+	return n;
+}
+
+static void net_udp_write_traffic_metrics(PHYSFSX_write_buffer &file, const char *const direction, const std::array<net_udp_traffic_counter, 256> &counters)
+{
+	PHYSFSX_printf(file, "# TYPE dxx_udp_%s_bytes_total counter\n", direction);
+	for (auto &&[t, c] : enumerate(counters))
+		if (c.count)
+		{
+			if (t < upid_names.size() && upid_names[t])
+				PHYSFSX_printf(file, "dxx_udp_%s_bytes_total{upid=\"%s\"} %u\n", direction, upid_names[t], c.bytes);
+			else
+				PHYSFSX_printf(file, "dxx_udp_%s_bytes_total{upid=\"%u\"} %u\n", direction, static_cast<unsigned>(t), c.bytes);
+		}
+	PHYSFSX_printf(file, "# TYPE dxx_udp_%s_packets_total counter\n", direction);
+	for (auto &&[t, c] : enumerate(counters))
+		if (c.count)
+		{
+			if (t < upid_names.size() && upid_names[t])
+				PHYSFSX_printf(file, "dxx_udp_%s_packets_total{upid=\"%s\"} %u\n", direction, upid_names[t], c.count);
+			else
+				PHYSFSX_printf(file, "dxx_udp_%s_packets_total{upid=\"%u\"} %u\n", direction, static_cast<unsigned>(t), c.count);
+		}
+}
+
+/* Queue Net_udp_traffic_stats, the players and the recent tick times
+ * to be written to `filename`.  The counters restart with each level,
+ * which a collector takes as a counter reset.
+ */
+static void net_udp_write_metrics(const char *const filename)
+{
+	auto &s = Net_udp_traffic_stats;
+	PHYSFSX_write_buffer file;
+	PHYSFSX_puts_literal(file, "# TYPE dxx_stats_window_seconds gauge\n");
+	PHYSFSX_printf(file, "dxx_stats_window_seconds %.3f\n", (timer_query() - s.start_time) / static_cast<double>(F1_0));
+	unsigned playing{0};
+	for (auto &i : partial_const_range(Netgame.players, N_players))
+		if (i.connected == player_connection_status::playing)
+			++playing;
+	PHYSFSX_puts_literal(file, "# TYPE dxx_players gauge\n");
+	PHYSFSX_printf(file, "dxx_players %u\n", playing);
+	PHYSFSX_puts_literal(file, "# TYPE dxx_players_max gauge\n");
+	PHYSFSX_printf(file, "dxx_players_max %u\n", static_cast<unsigned>(Netgame.max_numplayers));
+	PHYSFSX_puts_literal(file, "# TYPE dxx_player_rtt_seconds gauge\n");
+	for (auto &&[pnum, i] : enumerate(partial_const_range(Netgame.players, N_players)))
+		if (pnum != Player_num && i.connected != player_connection_status::disconnected)
+			PHYSFSX_printf(file, "dxx_player_rtt_seconds{player=\"%u\"} %.3f\n", static_cast<unsigned>(pnum), i.ping / 1000.);
+	PHYSFSX_puts_literal(file, "# TYPE dxx_noloss_queue gauge\n");
+	PHYSFSX_printf(file, "dxx_noloss_queue %u\n", UDP_mdata_queue.count);
+	PHYSFSX_puts_literal(file, "# TYPE dxx_noloss_queue_peak gauge\n");
+	PHYSFSX_printf(file, "dxx_noloss_queue_peak %u\n", s.mdata_queue_peak);
+	PHYSFSX_puts_literal(file, "# TYPE dxx_noloss_resends_total counter\n");
+	PHYSFSX_printf(file, "dxx_noloss_resends_total %u\n", s.mdata_resends);
+	net_udp_write_traffic_metrics(file, "sent", s.upid_sent);
+	net_udp_write_traffic_metrics(file, "received", s.upid_received);
+	if (auto &history{frame_profile_get_history()}; const auto n{history.size()})
+	{
+		std::array<uint32_t, frame_profile_game_history::capacity()> us;
+		for (std::size_t i = 0; i != n; ++i)
+			us[i] = history[i].total();
+		const std::span<uint32_t> ticks{us.data(), n};
+		std::ranges::sort(ticks);
+		/* The quantiles are of the recent ticks in the history, but the
+		 * sum and count of a summary must never go down, so they are of
+		 * every tick recorded.
+		 */
+		auto &totals{frame_profile_get_totals()};
+		PHYSFSX_puts_literal(file, "# TYPE dxx_tick_seconds summary\n");
+		for (const auto q : {0.5, 0.9, 0.99, 1.0})
+			PHYSFSX_printf(file, "dxx_tick_seconds{quantile=\"%g\"} %.6f\n", q, ticks[static_cast<std::size_t>(q * (n - 1))] / 1e6);
+		PHYSFSX_printf(file, "dxx_tick_seconds_sum %.6f\n", totals.us / 1e6);
+		PHYSFSX_printf(file, "dxx_tick_seconds_count %" PRIu64 "\n", totals.frames);
+	}
+	PHYSFSX_queueWrite(filename, std::move(file));
+}
+
 static void udp_traffic_stat()
 {
 	static fix64 last_traf_time = 0;
+	static fix64 last_stats_log_time = 0;
+	static fix64 last_metrics_time = 0;
+
+	if (net_stats_cvar.intval && timer_query() >= last_stats_log_time + net_udp_stats_log_interval)
+	{
+		last_stats_log_time = timer_query();
+		std::array<net_udp_stats_line, net_udp_stats_line_count> lines;
+		const auto n{net_udp_format_stats(lines)};
+		for (std::size_t i = 0; i != n; ++i)
+			con_printf(CON_NORMAL, "%s", lines[i].data());
+	}
+
+	if (!net_metrics_file_cvar.string.empty() && timer_query() >= last_metrics_time + net_udp_metrics_interval)
+	{
+		last_metrics_time = timer_query();
+		net_udp_write_metrics(net_metrics_file_cvar.string.c_str());
+	}
 
 	if (timer_query() >= last_traf_time + F1_0)
 	{
 		last_traf_time = timer_query();
 		con_printf(CON_DEBUG, "P#%u TRAFFIC - OUT: %fKB/s %iPPS IN: %fKB/s %iPPS",Player_num, static_cast<float>(UDP_len_sendto)/1024, UDP_num_sendto, static_cast<float>(UDP_len_recvfrom)/1024, UDP_num_recvfrom);
+		std::array<char, MAX_PLAYERS * 12> pdata_text;
+		std::size_t pdata_len{0};
+		for (auto &&[i, n] : enumerate(UDP_len_pdata))
+			if (n && pdata_len < pdata_text.size())
+				pdata_len += std::snprintf(&pdata_text[pdata_len], pdata_text.size() - pdata_len, " %u:%uB/s", static_cast<unsigned>(i), n);
+		if (pdata_len)
+			con_printf(CON_DEBUG, "P#%u POSITION IN:%s", Player_num, pdata_text.data());
+		if (Netgame.SmoothPositions)
+		{
+			std::size_t jitter_len{0};
+			for (auto &&[i, b] : enumerate(UDP_pdata_jitter))
+				if (b.count > 1 && jitter_len < pdata_text.size())
+					jitter_len += std::snprintf(&pdata_text[jitter_len], pdata_text.size() - jitter_len, " %u:%i/%ims", static_cast<unsigned>(i), f2i(b.jitter * 1000), f2i(b.delay() * 1000));
+			if (jitter_len)
+				con_printf(CON_DEBUG, "P#%u POSITION JITTER/DELAY:%s", Player_num, pdata_text.data());
+		}
 		UDP_num_sendto = UDP_len_sendto = UDP_num_recvfrom = UDP_len_recvfrom = 0;
+		UDP_len_pdata = {};
 	}
 }
 
-// Resolve address
-int udp_dns_filladdr(sockaddr_ref addr, const char *host, uint16_t port, bool numeric_only, bool silent)
+}
+
+namespace dsx {
+
+void net_udp_print_stats(const bool reset)
+{
+	std::array<net_udp_stats_line, net_udp_stats_line_count> lines;
+	const auto n{net_udp_format_stats(lines)};
+	for (std::size_t i = 0; i != n; ++i)
+		con_printf(CON_NORMAL, "%s", lines[i].data());
+	if (reset)
+		net_udp_reset_stats();
+}
+
+void net_udp_show_stats(grs_canvas &canvas)
+{
+	if (net_stats_cvar.intval < 2 || !(Game_mode & GM_NETWORK))
+		return;
+	std::array<net_udp_stats_line, net_udp_stats_line_count> lines;
+	const auto n{net_udp_format_stats(lines)};
+	const auto &game_font = *GAME_FONT;
+	const auto &&line_spacing = LINE_SPACING(game_font, game_font);
+	gr_set_fontcolor(canvas, BM_XRGB(0, 31, 0), -1);
+	int y = line_spacing * 6;
+	for (std::size_t i = 0; i != n; ++i, y += line_spacing)
+		gr_string(canvas, game_font, FSPACX(2), y, lines[i].data());
+}
+
+}
+
+namespace {
+
+/* The part of udp_dns_filladdr which only uses its arguments, so that it
+ * can run on another thread.  Returns nullptr on success, or what went
+ * wrong.
+ */
+static const char *udp_dns_lookup(sockaddr_ref addr, const char *host, uint16_t port, bool numeric_only)
 {
 	// Variables
 	addrinfo hints{};
@@ -1034,22 +1787,10 @@ int udp_dns_filladdr(sockaddr_ref addr, const char *host, uint16_t port, bool nu
 	// Resolve the domain name
 	RAIIaddrinfo result;
 	if (result.getaddrinfo(host, sPort, &hints) != 0)
-	{
-		con_printf( CON_URGENT, "udp_dns_filladdr (getaddrinfo) failed for host %s", host );
-		if (!silent)
-			nm_messagebox(menu_title{TXT_ERROR}, {TXT_OK}, "Could not resolve address\n%s", host);
-		addr.sa.sa_family = AF_UNSPEC;
-		return -1;
-	}
+		return "Could not resolve address";
 	
 	if (result->ai_addrlen > addr.len)
-	{
-		con_printf(CON_URGENT, "Address too big for host %s", host);
-		if (!silent)
-			nm_messagebox(menu_title{TXT_ERROR}, {TXT_OK}, "Address too big for host\n%s", host);
-		addr.sa.sa_family = AF_UNSPEC;
-		return -1;
-	}
+		return "Address too big for host";
 	// Now copy it over
 	memcpy(&addr.sa, result->ai_addr, addr.len = result->ai_addrlen);
 	
@@ -1064,9 +1805,37 @@ int udp_dns_filladdr(sockaddr_ref addr, const char *host, uint16_t port, bool nu
 	 *
 	 * -- Matt
 	 */
+	return nullptr;
+}
+
+// Resolve address
+int udp_dns_filladdr(sockaddr_ref addr, const char *host, uint16_t port, bool numeric_only, bool silent)
+{
+	if (const auto error = udp_dns_lookup(addr, host, port, numeric_only))
+	{
+		con_printf(CON_URGENT, "udp_dns_filladdr: %s %s", error, host);
+		if (!silent)
+			nm_messagebox(menu_title{TXT_ERROR}, {TXT_OK}, "%s\n%s", error, host);
+		addr.sa.sa_family = AF_UNSPEC;
+		return -1;
+	}
 	return 0;
 }
 
+/* Resolve `host` on another thread, so that a slow name server does not
+ * stop the menus.  Destroying the future before it is ready waits for
+ * the lookup.
+ */
+static std::future<udp_dns_async_result> udp_dns_filladdr_async(std::string host, const uint16_t port)
+{
+	return std::async(std::launch::async, [host = std::move(host), port]() {
+		udp_dns_async_result result{};
+		result.error = udp_dns_lookup(result.addr, host.c_str(), port, false);
+		return result;
+	});
+}
+
+
 // Open socket
 static int udp_open_socket(RAIIsocket &sock, int port)
 {
@@ -1146,6 +1915,51 @@ static ssize_t udp_receive_packet(RAIIsocket &sock, const socket_data_buffer msg
 		msg[msglen] = 0;
 	return msglen;
 }
+
+#if DXX_USE_MMSG
+constexpr std::size_t udp_receive_batch_size = 16;
+
+/* The packets of one recvmmsg call.  Each caller keeps its own, because
+ * processing a packet can run a menu which listens again.
+ */
+struct udp_receive_batch
+{
+	std::array<std::array<uint8_t, UPID_MAX_SIZE>, udp_receive_batch_size> packet;
+	std::array<_sockaddr, udp_receive_batch_size> sender_addr;
+	std::array<std::size_t, udp_receive_batch_size> size;
+};
+
+// Gets up to udp_receive_batch_size packets without waiting.  Returns how many were received.
+static std::size_t udp_receive_packets(RAIIsocket &sock, udp_receive_batch &b)
+{
+	if (!sock)
+		return 0;
+	std::array<iovec, udp_receive_batch_size> iov;
+	std::array<mmsghdr, udp_receive_batch_size> hdr{};
+	for (std::size_t i = 0; i != udp_receive_batch_size; ++i)
+	{
+		iov[i] = {b.packet[i].data(), b.packet[i].size()};
+		auto &h = hdr[i].msg_hdr;
+		h.msg_name = &b.sender_addr[i];
+		h.msg_namelen = sizeof(b.sender_addr[i]);
+		h.msg_iov = &iov[i];
+		h.msg_iovlen = 1;
+	}
+	const int n = recvmmsg(sock, hdr.data(), hdr.size(), MSG_DONTWAIT, nullptr);
+	if (n <= 0)
+		return 0;
+	for (int i = 0; i != n; ++i)
+	{
+		const std::size_t msglen = hdr[i].msg_len;
+		b.size[i] = msglen;
+		if (msglen < b.packet[i].size())
+			b.packet[i][msglen] = 0;
+		UDP_num_recvfrom++;
+		UDP_len_recvfrom += msglen;
+	}
+	return n;
+}
+#endif
 /* General UDP functions - END */
 
 struct direct_join
@@ -1209,11 +2023,18 @@ struct manual_join_menu_items : direct_join, manual_join_user_inputs
 
 struct manual_join_menu : manual_join_menu_items, newmenu
 {
+	/* The lookup of hostaddrbuf, while it runs */
+	std::future<udp_dns_async_result> resolving;
 	manual_join_menu(grs_canvas &src) :
 		newmenu(menu_title{nullptr}, menu_subtitle{"ENTER GAME ADDRESS"}, menu_filename{nullptr}, tiny_mode_flag::normal, tab_processing_flag::ignore, adjusted_citem::create(m, input_host_address), src)
 	{
 	}
 	virtual window_event_result event_handler(const d_event &event) override;
+	/* The idle handler polls the address lookup and the connection */
+	virtual unsigned get_idle_wait() const override
+	{
+		return 0;
+	}
 };
 
 struct netgame_list_game_menu_items
@@ -1257,6 +2078,16 @@ struct netgame_list_game_menu : netgame_list_game_menu_items, direct_join, newme
 	unsigned num_active_udp_games{0};
 	uint8_t num_active_udp_changed{1};
 	std::array<UDP_netgame_info_lite, UDP_MAX_NETGAMES> Active_udp_games{};
+	/* The position in Active_udp_games of each game, by GameID, so that
+	 * a game info packet finds its game without comparing every name.
+	 */
+	std::unordered_multimap<fix, unsigned> Active_udp_games_by_id;
+	void clear_games()
+	{
+		num_active_udp_changed = 1;
+		num_active_udp_games = 0;
+		Active_udp_games_by_id.clear();
+	}
 	netgame_list_game_menu(grs_canvas &src) :
 		newmenu(menu_title{"NETGAMES"}, menu_subtitle{nullptr}, menu_filename{nullptr}, tiny_mode_flag::tiny, tab_processing_flag::process, adjusted_citem::create(menus, 0), src)
 	{
@@ -1269,6 +2100,11 @@ struct netgame_list_game_menu : netgame_list_game_menu_items, direct_join, newme
 		netgame_list_menu = nullptr;
 	}
 	virtual window_event_result event_handler(const d_event &event) override;
+	/* The idle handler listens for games and connects to the chosen one */
+	virtual unsigned get_idle_wait() const override
+	{
+		return 0;
+	}
 };
 
 manual_join_user_inputs manual_join_menu_items::s_last_inputs;
@@ -1373,6 +2209,31 @@ window_event_result manual_join_menu::event_handler(const d_event &event)
 			}
 			break;
 		case event_type::idle:
+			if (resolving.valid())
+			{
+				if (resolving.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+					break;
+				const auto result = resolving.get();
+				if (result.error)
+				{
+					con_printf(CON_URGENT, "udp_dns_filladdr: %s %s", result.error, hostaddrbuf.data());
+					nm_set_item_text(m[label_status_text], "");
+					nm_messagebox(menu_title{TXT_ERROR}, {TXT_OK}, "%s\n%s", result.error, hostaddrbuf.data());
+					break;
+				}
+				host_addr = result.addr;
+				s_last_inputs = *this;
+				multi_new_game();
+				N_players = 0;
+				change_playernum_to(1);
+				start_time = timer_query();
+				last_time = 0;
+				
+				Netgame.players[0].protocol.udp.addr = host_addr;
+				connecting = direct_join::connect_type::connecting;
+				nm_set_item_text(m[label_status_text], "Connecting...");
+				break;
+			}
 			if (connecting != direct_join::connect_type::idle)
 			{
 				if (net_udp_game_connect(this))
@@ -1386,6 +2247,8 @@ window_event_result manual_join_menu::event_handler(const d_event &event)
 		{
 			int sockres = -1;
 
+			if (resolving.valid())
+				return window_event_result::handled;
 			net_udp_init(); // yes, redundant call but since the menu does not know any better it would allow any IP entry as long as Netgame-entry looks okay... my head hurts...
 			if (!convert_text_portstring(guestportbuf, UDP_MyPort, false, false))
 				return window_event_result::handled;
@@ -1395,23 +2258,10 @@ window_event_result manual_join_menu::event_handler(const d_event &event)
 			uint16_t hostport;
 			if (!convert_text_portstring(hostportbuf, hostport, true, false))
 				return window_event_result::handled;
-			// Resolve address
-			if (udp_dns_filladdr(host_addr, hostaddrbuf.data(), hostport, false, false) < 0)
-				return window_event_result::handled;
-			else
-			{
-				s_last_inputs = *this;
-				multi_new_game();
-				N_players = 0;
-				change_playernum_to(1);
-				start_time = timer_query();
-				last_time = 0;
-				
-				Netgame.players[0].protocol.udp.addr = host_addr;
-				connecting = direct_join::connect_type::connecting;
-				nm_set_item_text(m[label_status_text], "Connecting...");
-				return window_event_result::handled;
-			}
+			// Resolve address, then connect when idle finds it resolved
+			resolving = udp_dns_filladdr_async(hostaddrbuf.data(), hostport);
+			nm_set_item_text(m[label_status_text], "Resolving...");
+			return window_event_result::handled;
 		}
 		case event_type::window_close:
 			if (!Game_wind) // they cancelled
@@ -1475,9 +2325,7 @@ window_event_result netgame_list_game_menu::event_handler(const d_event &event)
 		case event_type::window_activated:
 		{
 			Netgame.protocol.udp.valid = 0;
-			Active_udp_games = {};
-			num_active_udp_changed = 1;
-			num_active_udp_games = 0;
+			clear_games();
 			net_udp_request_game_info(GBcast);
 #if DXX_USE_IPv6
 			net_udp_request_game_info(GMcast_v6);
@@ -1490,6 +2338,9 @@ window_event_result netgame_list_game_menu::event_handler(const d_event &event)
 			break;
 		}
 		case event_type::idle:
+#if DXX_USE_TRACKER
+			udp_tracker_send_deferred();
+#endif
 			if (connecting != direct_join::connect_type::idle)
 			{
 				if (net_udp_game_connect(this))
@@ -1522,9 +2373,7 @@ window_event_result netgame_list_game_menu::event_handler(const d_event &event)
 			if( key == KEY_F4 )
 			{
 				// Empty the list
-				Active_udp_games = {};
-				num_active_udp_changed = 1;
-				num_active_udp_games = 0;
+				clear_games();
 				
 				// Request LAN games
 				net_udp_request_game_info(GBcast);
@@ -1540,9 +2389,7 @@ window_event_result netgame_list_game_menu::event_handler(const d_event &event)
 #if DXX_USE_TRACKER
 			if (key == KEY_F5)
 			{
-				Active_udp_games = {};
-				num_active_udp_changed = 1;
-				num_active_udp_games = 0;
+				clear_games();
 				net_udp_request_game_info(GBcast);
 
 #if DXX_USE_IPv6
@@ -1554,9 +2401,7 @@ window_event_result netgame_list_game_menu::event_handler(const d_event &event)
 			if( key == KEY_F6 )
 			{
 				// Zero the list
-				Active_udp_games = {};
-				num_active_udp_changed = 1;
-				num_active_udp_games = 0;
+				clear_games();
 				
 				// Request from the tracker
 				udp_tracker_reqgames();
@@ -1777,7 +2622,10 @@ void net_udp_init()
 #endif
 
 	Netgame = {};
+	net_udp_reset_stats();
 	UDP_MData = {};
+	UDP_MData_needack = false;
+	UDP_MData_flush_time = 0;
 	net_udp_noloss_init_mdata_queue();
 	UDP_sequence_request_packet UDP_Seq{GetMyNetRanking(), InterfaceUniqueState.PilotName, 0};
 
@@ -1997,7 +2845,7 @@ static void net_udp_welcome_player(const UDP_sequence_request_packet &their, con
 
 	// Joining a running game will need quite a few packets on the mdata-queue, so let players only join if we have enough space.
 	if (Netgame.PacketLossPrevention)
-		if ((UDP_MDATA_STOR_QUEUE_SIZE - UDP_mdata_queue_highest) < UDP_MDATA_STOR_MIN_FREE_2JOIN)
+		if ((UDP_MDATA_STOR_QUEUE_SIZE - UDP_mdata_queue.count) < UDP_MDATA_STOR_MIN_FREE_2JOIN)
 			return;
 
 	if (their.Current_level_num != Current_level_num)
@@ -2115,6 +2963,8 @@ static void net_udp_welcome_player(const UDP_sequence_request_packet &their, con
 	UDP_sync_player = UDP_sequence_syncplayer_packet(player_num, their.rank, their.callsign, udp_addr);
 	Network_send_objects = 1;
 	Network_send_objnum = -1;
+	Network_send_object_mode = 0;
+	UDP_object_sync = {};
 	Netgame.players[player_num].LastPacketTime = timer_query();
 
 	net_udp_send_objects(network_player_added);
@@ -2310,39 +3160,22 @@ static void net_udp_stop_resync(const struct _sockaddr &udp_addr)
 namespace dsx {
 namespace {
 
-void net_udp_send_objects(const Network_player_added network_player_added)
+/* Fill the next upid::object_data packet for the joining player.  Each
+ * entry is the local object number, the owner and the remote object
+ * number, and then the packed object_rw unless the entry is the start
+ * of the transfer or the final count.  Network_send_object_mode is 0
+ * while sending unowned objects and those of the joining player, 1 while
+ * sending everyone else's, 2 while the final count is due and 3 once it
+ * was written.
+ */
+static std::size_t net_udp_build_object_packet(const std::span<uint8_t, UPID_MAX_SIZE> object_buffer, const uint16_t sequence, int &obj_count)
 {
-	auto &LevelUniqueControlCenterState = LevelUniqueObjectState.ControlCenterState;
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &vmobjptr = Objects.vmptr;
-	uint8_t player_num = UDP_sync_player.player_num;
-	static int obj_count = 0;
-	unsigned loc{0}, obj_count_frame = 0;
-	static fix64 last_send_time = 0;
-	
-	if (last_send_time + (F1_0/50) > timer_query())
-		return;
-	last_send_time = timer_query();
-
-	// Send clear objects array trigger and send player num
-
-	Assert(Network_send_objects != 0);
-	Assert(player_num >= 0);
-	Assert(player_num < Netgame.max_numplayers);
-
-	if (Network_status == network_state::endlevel || LevelUniqueControlCenterState.Control_center_destroyed)
-	{
-		// Endlevel started before we finished sending the goods, we'll
-		// have to stop and try again after the level.
-		multi::udp::dispatch->kick_player(UDP_sync_player.udp_addr, kick_player_reason::endlevel);
-		Network_send_objects = 0; 
-		return;
-	}
-
-	std::array<uint8_t, UPID_MAX_SIZE> object_buffer{{
-		underlying_value(upid::object_data)
-	}};
-	loc = 5;
+	const uint8_t player_num = UDP_sync_player.player_num;
+	object_buffer[0] = underlying_value(upid::object_data);
+	PUT_INTEL_SHORT(&object_buffer[1], sequence);
+	unsigned loc{4}, obj_count_frame{0};
 
 	if (Network_send_objnum == -1)
 	{
@@ -2354,88 +3187,148 @@ void net_udp_send_objects(const Network_player_added network_player_added)
 		Network_send_objnum = 0;
 		obj_count_frame = 1;
 	}
-	
-	objnum_t i;
-	for (i = Network_send_objnum; i <= Highest_object_index; i++)
+
+	while (Network_send_object_mode < 2)
 	{
-		const auto &&objp = vmobjptr(i);
-		if ((objp->type != OBJ_POWERUP) && (objp->type != OBJ_PLAYER) &&
-				(objp->type != OBJ_CNTRLCEN) && (objp->type != OBJ_GHOST) &&
-				(objp->type != OBJ_ROBOT) && (objp->type != OBJ_HOSTAGE)
+		objnum_t i;
+		for (i = Network_send_objnum; i <= Highest_object_index; i++)
+		{
+			const auto &&objp = vmobjptr(i);
+			if ((objp->type != OBJ_POWERUP) && (objp->type != OBJ_PLAYER) &&
+					(objp->type != OBJ_CNTRLCEN) && (objp->type != OBJ_GHOST) &&
+					(objp->type != OBJ_ROBOT) && (objp->type != OBJ_HOSTAGE)
 #if DXX_BUILD_DESCENT == 2
-				&& !(objp->type == OBJ_WEAPON && get_weapon_id(objp) == weapon_id_type::PMINE_ID)
+					&& !(objp->type == OBJ_WEAPON && get_weapon_id(objp) == weapon_id_type::PMINE_ID)
 #endif
-				)
-			continue;
-		if ((Network_send_object_mode == 0) && ((object_owner[i] != -1) && (object_owner[i] != player_num)))
-			continue;
-		if ((Network_send_object_mode == 1) && ((object_owner[i] == -1) || (object_owner[i] == player_num)))
-			continue;
+					)
+				continue;
+			if ((Network_send_object_mode == 0) && ((object_owner[i] != -1) && (object_owner[i] != player_num)))
+				continue;
+			if ((Network_send_object_mode == 1) && ((object_owner[i] == -1) || (object_owner[i] == player_num)))
+				continue;
 
-		if ( loc + sizeof(object_rw) + 9 > UPID_MAX_SIZE-1 )
-			break; // Not enough room for another object
+			// use object_rw to send objects for now. if object sometime contains some day contains something useful the client should know about, we should use it. but by now it's also easier to use object_rw because then we also do not need fix64 timer values.
+			object_rw rw{};
+			multi_object_to_object_rw(objp, &rw);
+			const auto packed_size = net_udp_packed_object_rw_size(rw);
+			if (loc + 9 + packed_size > UPID_MAX_SIZE || obj_count_frame == UINT8_MAX)
+				break; // Not enough room for another object
 
-		obj_count_frame++;
-		obj_count++;
+			obj_count_frame++;
+			obj_count++;
 
-		const auto &&[owner, remote_objnum] = objnum_local_to_remote(i);
-		Assert(owner == object_owner[i]);
+			const auto &&[owner, remote_objnum] = objnum_local_to_remote(i);
+			Assert(owner == object_owner[i]);
 
-		PUT_INTEL_INT(&object_buffer[loc], i);                        loc += 4;
-		object_buffer[loc] = owner;                                 loc += 1;
-		PUT_INTEL_INT(&object_buffer[loc], remote_objnum);            loc += 4;
-		// use object_rw to send objects for now. if object sometime contains some day contains something useful the client should know about, we should use it. but by now it's also easier to use object_rw because then we also do not need fix64 timer values.
-		multi_object_to_object_rw(vmobjptr(i), reinterpret_cast<object_rw *>(&object_buffer[loc]));
-		loc += sizeof(object_rw);
+			PUT_INTEL_INT(&object_buffer[loc], i);                        loc += 4;
+			object_buffer[loc] = owner;                                 loc += 1;
+			PUT_INTEL_INT(&object_buffer[loc], remote_objnum);            loc += 4;
+			loc += net_udp_pack_object_rw(rw, object_buffer.subspan(loc, packed_size));
+		}
+		Network_send_objnum = i;
+		if (i <= Highest_object_index)
+			break;
+		// go to next mode
+		Network_send_objnum = 0;
+		++Network_send_object_mode;
 	}
 
-	if (obj_count_frame) // Send any objects we've buffered
+	if (Network_send_object_mode == 2 && loc + 9 <= UPID_MAX_SIZE && obj_count_frame != UINT8_MAX)
 	{
-		Network_send_objnum = i;
-		PUT_INTEL_INT(&object_buffer[1], obj_count_frame);
+		// Send count so other side can make sure he got them all
+		PUT_INTEL_INT(&object_buffer[loc], network_checksum_marker_object); loc += 4;
+		object_buffer[loc] = player_num;                            loc += 1;
+		PUT_INTEL_INT(&object_buffer[loc], obj_count);                loc += 4;
+		obj_count_frame++;
+		Network_send_object_mode = 3;
+	}
+	object_buffer[3] = obj_count_frame;
+	return loc;
+}
 
-		Assert(loc <= UPID_MAX_SIZE);
+void net_udp_send_objects(const Network_player_added network_player_added)
+{
+	auto &LevelUniqueControlCenterState = LevelUniqueObjectState.ControlCenterState;
+	uint8_t player_num = UDP_sync_player.player_num;
+	static int obj_count = 0;
+	static fix64 last_send_time = 0;
+	
+	if (last_send_time + (F1_0/50) > timer_query())
+		return;
+	last_send_time = timer_query();
 
-		dxx_sendto(UDP_Socket[0], std::span(object_buffer).first(loc), 0, UDP_sync_player.udp_addr);
+	// Send clear objects array trigger and send player num
+
+	Assert(Network_send_objects != 0);
+	Assert(player_num >= 0);
+	Assert(player_num < Netgame.max_numplayers);
+
+	if (Network_status == network_state::endlevel || LevelUniqueControlCenterState.Control_center_destroyed)
+	{
+		// Endlevel started before we finished sending the goods, we'll
+		// have to stop and try again after the level.
+		multi::udp::dispatch->kick_player(UDP_sync_player.udp_addr, kick_player_reason::endlevel);
+		Network_send_objects = 0; 
+		return;
 	}
 
-	if (i > Highest_object_index)
+	auto &sync = UDP_object_sync;
+	const auto now = last_send_time;
+	for (uint16_t sequence = sync.base; sequence != sync.next; ++sequence)
 	{
-		if (Network_send_object_mode == 0)
+		auto &p = sync.slot(sequence);
+		if (p.length && p.sent_time + object_sync_resend_delay <= now)
 		{
-			Network_send_objnum = 0;
-			Network_send_object_mode = 1; // go to next mode
+			p.sent_time = now;
+			dxx_sendto(UDP_Socket[0], std::span(p.buf).first(p.length), 0, UDP_sync_player.udp_addr);
 		}
-		else 
-		{
-			Assert(Network_send_object_mode == 1); 
-
-			// Send count so other side can make sure he got them all
-			object_buffer[0] = underlying_value(upid::object_data);
-			PUT_INTEL_INT(&object_buffer[1], 1);
-			PUT_INTEL_INT(&object_buffer[5], network_checksum_marker_object);
-			object_buffer[9] = player_num;
-			PUT_INTEL_INT(&object_buffer[10], obj_count);
-			dxx_sendto(UDP_Socket[0], std::span(object_buffer).first<14>(), 0, UDP_sync_player.udp_addr);
+	}
+	while (Network_send_object_mode != 3 && static_cast<uint16_t>(sync.next - sync.base) < object_sync_window)
+	{
+		auto &p = sync.slot(sync.next);
+		p.length = net_udp_build_object_packet(p.buf, sync.next, obj_count);
+		p.sent_time = now;
+		++sync.next;
+		dxx_sendto(UDP_Socket[0], std::span(p.buf).first(p.length), 0, UDP_sync_player.udp_addr);
+	}
 
-			// Send sync packet which tells the player who he is and to start!
-			net_udp_send_rejoin_sync(network_player_added, player_num);
+	if (Network_send_object_mode == 3 && sync.base == sync.next)
+	{
+		// Send sync packet which tells the player who he is and to start!
+		net_udp_send_rejoin_sync(network_player_added, player_num);
 
-			// Turn off send object mode
-			Network_send_objnum = -1;
-			Network_send_objects = 0;
-			obj_count = 0;
+		// Turn off send object mode
+		Network_send_objnum = -1;
+		Network_send_objects = 0;
+		obj_count = 0;
 
 #if DXX_BUILD_DESCENT == 1
-			Network_sending_extras=3; // start to send extras
+		Network_sending_extras=3; // start to send extras
 #elif DXX_BUILD_DESCENT == 2
-			Network_sending_extras=9; // start to send extras
+		Network_sending_extras=9; // start to send extras
 #endif
-			VerifyPlayerJoined = Player_joining_extras = player_num;
+		VerifyPlayerJoined = Player_joining_extras = player_num;
+	}
+}
 
-			return;
-		} // mode == 1;
-	} // i > Highest_object_index
+static void net_udp_process_object_data_ack(const upid_rspan<upid::object_data_ack> data, const _sockaddr &sender_addr)
+{
+	if (!multi_i_am_master() || !Network_send_objects || sender_addr != UDP_sync_player.udp_addr)
+		return;
+	auto &sync = UDP_object_sync;
+	const uint16_t received_base = GET_INTEL_SHORT(&data[1]);
+	const uint32_t received_after = GET_INTEL_INT(&data[3]);
+	if (static_cast<uint16_t>(received_base - sync.base) > static_cast<uint16_t>(sync.next - sync.base))
+		return;	// stale or bogus
+	for (; sync.base != received_base; ++sync.base)
+		sync.slot(sync.base).length = 0;
+	for (unsigned i = 0; i != 32; ++i)
+		if (received_after & (1u << i))
+		{
+			const uint16_t sequence = received_base + 1 + i;
+			if (static_cast<uint16_t>(sequence - sync.base) < static_cast<uint16_t>(sync.next - sync.base))
+				sync.slot(sequence).length = 0;
+		}
 }
 
 }
@@ -2464,7 +3357,7 @@ static int net_udp_verify_objects(int remote, int local)
 	return(1);
 }
 
-static void net_udp_read_object_packet(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, const uint8_t *const data)
+static void net_udp_read_object_packet(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, const std::span<const uint8_t> data)
 {
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &Robot_info = LevelSharedRobotInfoState.Robot_info;
@@ -2472,11 +3365,13 @@ static void net_udp_read_object_packet(const d_level_shared_robot_info_state &Le
 	// Object from another net player we need to sync with
 	sbyte obj_owner;
 	static int mode = 0, object_count = 0, my_pnum = 0;
-	unsigned loc{5};
-	const int nobj{GET_INTEL_INT<int32_t>(&data[1])};
+	unsigned loc{4};
+	const unsigned nobj{data[3]};
 
-	for (int i = 0; i < nobj; i++)
+	for (unsigned i = 0; i < nobj; i++)
 	{
+		if (loc + 9 > data.size())
+			return;
 		const unsigned uobjnum{GET_INTEL_INT(&data[loc])};
 		objnum_t objnum = uobjnum;                         loc += 4;
 		obj_owner = data[loc];                                      loc += 1;
@@ -2528,6 +3423,11 @@ static void net_udp_read_object_packet(const d_level_shared_robot_info_state &Le
 				}
 				objnum = obj_allocate(LevelUniqueObjectState);
 			}
+			object_rw rw;
+			const auto packed_size = net_udp_unpack_object_rw(data.subspan(loc), rw);
+			if (!packed_size)
+				return;
+			loc += packed_size;
 			if (objnum != object_none) {
 				auto obj = vmobjptridx(objnum);
 				if (obj->type != OBJ_NONE)
@@ -2536,8 +3436,9 @@ static void net_udp_read_object_packet(const d_level_shared_robot_info_state &Le
 					Assert(obj->segnum == segment_none);
 				}
 				Assert(objnum < MAX_OBJECTS);
-				multi_object_rw_to_object(reinterpret_cast<const object_rw *>(&data[loc]), obj);
-				loc += sizeof(object_rw);
+				multi_object_rw_to_object(&rw, obj);
+				MultiLevelInv_ObjectChanged(obj.get_unchecked_index());
+				multi_world_checksum_object_changed(obj.get_unchecked_index());
 				auto segnum = obj->segnum;
 				if (segnum != segment_none)
 				{
@@ -2554,6 +3455,39 @@ static void net_udp_read_object_packet(const d_level_shared_robot_info_state &Le
 	} // For each object in packet
 }
 
+static void net_udp_receive_object_packet(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, const std::span<const uint8_t> data, const _sockaddr &sender_addr)
+{
+	if (data.size() < 4)
+		return;
+	auto &sync = UDP_object_sync;
+	const uint16_t sequence = GET_INTEL_SHORT(&data[1]);
+	if (static_cast<uint16_t>(sequence - sync.base) < object_sync_window)
+	{
+		auto &p = sync.slot(sequence);
+		if (!p.length)
+		{
+			std::ranges::copy(data, p.buf.begin());
+			p.length = data.size();
+		}
+		for (auto *q = &sync.slot(sync.base); q->length && Network_status == network_state::waiting; q = &sync.slot(sync.base))
+		{
+			net_udp_read_object_packet(LevelSharedRobotInfoState, std::span(q->buf).first(q->length));
+			q->length = 0;
+			++sync.base;
+		}
+	}
+	/* Acknowledge everything read, and any packets held after the gap */
+	uint32_t received_after{0};
+	for (unsigned i = 0; i + 1 < object_sync_window; ++i)
+		if (sync.slot(sync.base + 1 + i).length)
+			received_after |= 1u << i;
+	std::array<uint8_t, upid_length<upid::object_data_ack>> buf;
+	buf[0] = underlying_value(upid::object_data_ack);
+	PUT_INTEL_SHORT(&buf[1], sync.base);
+	PUT_INTEL_INT(&buf[3], received_after);
+	dxx_sendto(UDP_Socket[0], buf, 0, sender_addr);
+}
+
 }
 
 namespace dsx {
@@ -2822,9 +3756,10 @@ void dispatch_table::send_endlevel_packet() const
 			}
 		}
 
-		for (unsigned i = 1; i < MAX_PLAYERS; ++i)
-			if (vcplayerptr(i)->connected != player_connection_status::disconnected)
-				dxx_sendto(UDP_Socket[0], buf, 0, Netgame.players[i].protocol.udp.addr);
+		std::array<const _sockaddr *, MAX_PLAYERS> peers;
+		dxx_sendto_each(UDP_Socket[0], buf, 0, udp_peer_addresses(peers, [](const unsigned i) {
+			return vcplayerptr(i)->connected != player_connection_status::disconnected;
+		}));
 	}
 	else
 	{
@@ -2987,6 +3922,7 @@ static std::span<const uint8_t> net_udp_prepare_heavy_game_info(const d_level_un
 	buf[len] = Netgame.NoFriendlyFire;						len++;
 	buf[len] = Netgame.MouselookFlags;						len++;
 	buf[len] = Netgame.PitchLockFlags;                      len++;
+	buf[len] = Netgame.SmoothPositions;						len++;
 	len += copy_from_ntstring(buf, len, Netgame.game_name);
 	len += copy_from_ntstring(buf, len, Netgame.mission_title);
 	len += copy_from_ntstring(buf, len, Netgame.mission_name);
@@ -3104,7 +4040,14 @@ static void net_udp_process_game_info_light(const std::span<const uint8_t> buf,
 #endif
 		menu->num_active_udp_changed = 1;
 		auto r = partial_range(menu->Active_udp_games, menu->num_active_udp_games);
-		const auto &&i{std::ranges::find_if(r, [&recv_game](const UDP_netgame_info_lite &g) { return !d_stricmp(g.game_name.data(), recv_game.game_name.data()) && g.GameID == recv_game.GameID; })};
+		auto i{r.end()};
+		const auto &&[first, last] = menu->Active_udp_games_by_id.equal_range(recv_game.GameID);
+		for (auto j = first; j != last; ++j)
+			if (!d_stricmp(menu->Active_udp_games[j->second].game_name.data(), recv_game.game_name.data()))
+			{
+				i = std::next(r.begin(), j->second);
+				break;
+			}
 		if (i == menu->Active_udp_games.end())
 		{
 			return;
@@ -3133,13 +4076,17 @@ static void net_udp_process_game_info_light(const std::span<const uint8_t> buf,
 		if (i == r.end())
 		{
 			if (i->numconnected)
-				++ menu->num_active_udp_games;
+				menu->Active_udp_games_by_id.emplace(i->GameID, menu->num_active_udp_games++);
 		}
 		else if (!i->numconnected)
 		{
 			// Delete this game
 			std::move(std::next(i), r.end(), i);
 			-- menu->num_active_udp_games;
+			auto &by_id = menu->Active_udp_games_by_id;
+			by_id.clear();
+			for (unsigned position = 0; position != menu->num_active_udp_games; ++position)
+				by_id.emplace(menu->Active_udp_games[position].GameID, position);
 		}
 	}
 }
@@ -3243,6 +4190,7 @@ static void net_udp_process_game_info_heavy(const uint8_t *data, uint_fast32_t,
 		Netgame.NoFriendlyFire = data[len];						len++;
 		Netgame.MouselookFlags = data[len];						len++;
 		Netgame.PitchLockFlags = data[len];                     len++;
+		Netgame.SmoothPositions = data[len];						len++;
 		copy_to_ntstring(data, len, Netgame.game_name);
 		copy_to_ntstring(data, len, Netgame.mission_title);
 		copy_to_ntstring(data, len, Netgame.mission_name);
@@ -3350,6 +4298,7 @@ static void net_udp_process_packet(const d_level_shared_robot_info_state &LevelS
 	const auto data = buf.data();
 	const auto length = buf.size();
 	const auto dcmd = data[0];
+	net_udp_count_traffic(Net_udp_traffic_stats.upid_received, dcmd, length);
 	const auto cmd = build_upid_from_untrusted(dcmd);
 	if (!cmd)
 	{
@@ -3485,7 +4434,11 @@ static void net_udp_process_packet(const d_level_shared_robot_info_state &LevelS
 		case upid::object_data:
 			if (multi_i_am_master() || length > UPID_MAX_SIZE || Network_status != network_state::waiting)
 				break;
-			net_udp_read_object_packet(LevelSharedRobotInfoState, data);
+			net_udp_receive_object_packet(LevelSharedRobotInfoState, buf, sender_addr);
+			break;
+		case upid::object_data_ack:
+			if (const auto s = build_upid_rspan<upid::object_data_ack>(buf))
+				net_udp_process_object_data_ack(*s, sender_addr);
 			break;
 		case upid::ping:
 			if (multi_i_am_master())
@@ -3511,6 +4464,9 @@ static void net_udp_process_packet(const d_level_shared_robot_info_state &LevelS
 			if (const auto s = build_upid_rspan<upid::pdata>(buf))
 				net_udp_process_pdata(*s, sender_addr);
 			break;
+		case upid::pdata_delta:
+			net_udp_process_pdata_delta(buf, sender_addr);
+			break;
 		case upid::mdata_pnorm:
 			net_udp_process_mdata(LevelSharedRobotInfoState, buf, sender_addr, 0);
 			break;
@@ -3807,6 +4763,7 @@ constexpr std::integral_constant<unsigned, 5 * reactor_invul_time_mini_scale> re
 	DXX_MENUITEM_AUTOSAVE_LABEL_INPUT(VERB)	\
 	DXX_MENUITEM(VERB, TEXT, "", blank_6)                                     \
 	DXX_MENUITEM(VERB, TEXT, "Network Options", network_label)	               \
+	DXX_MENUITEM(VERB, CHECK, "Smooth remote player movement", opt_smooth_positions, Netgame.SmoothPositions)	\
 	DXX_MENUITEM(VERB, TEXT, "Packets per second (" DXX_STRINGIZE_PPS(MIN_PPS) " - " DXX_STRINGIZE_PPS(MAX_PPS) ")", opt_label_pps)	\
 	DXX_MENUITEM(VERB, INPUT, packstring, opt_packets)	\
 	DXX_MENUITEM(VERB, TEXT, "Network port", opt_label_port)	\
@@ -4398,7 +5355,7 @@ static int net_udp_game_param_handler( newmenu *menu,const d_event &event, param
 				return 1;
 			}
 			if (citem==opt->start_game)
-				return !net_udp_start_game();
+				return !net_udp_start_game(false);
 			return 1;
 		}
 		default:
@@ -4412,12 +5369,13 @@ static int net_udp_game_param_handler( newmenu *menu,const d_event &event, param
 
 namespace dsx {
 
-window_event_result net_udp_setup_game()
-{
-	param_opt opt;
-	auto &m = opt.m;
-	char level_text[32];
+namespace {
 
+/* Set up Netgame for a new game hosted on Current_mission, from the
+ * defaults and the netgame profile.
+ */
+static void net_udp_init_hosted_netgame()
+{
 	net_udp_init();
 
 	multi_new_game();
@@ -4452,6 +5410,7 @@ window_event_result net_udp_setup_game()
 	Netgame.NoFriendlyFire = 0;
 	Netgame.MouselookFlags = 0;
 	Netgame.PitchLockFlags = 0;
+	Netgame.SmoothPositions = 0;
 
 #if DXX_USE_TRACKER
 	Netgame.Tracker = 1;
@@ -4464,10 +5423,32 @@ window_event_result net_udp_setup_game()
 		Netgame.gamemode = network_game_type::anarchy;
 #endif
 
-	Netgame.mission_name.copy_if(&*Current_mission->filename, Netgame.mission_name.size());
-	Netgame.mission_title = Current_mission->mission_name;
+	Netgame.mission_name.copy_if(&*Current_mission->filename, Netgame.mission_name.size());
+	Netgame.mission_title = Current_mission->mission_name;
+
+	Netgame.levelnum = 1;
+}
+
+/* Netgame.Tracker is kept in the netgame profile, but a game only uses
+ * the tracker when one was set on the command line.
+ */
+static void net_udp_apply_tracker_arg()
+{
+#if DXX_USE_TRACKER
+	if (CGameArg.MplTrackerAddr.empty())
+		Netgame.Tracker = 0;
+#endif
+}
+
+}
 
-	Netgame.levelnum = 1;
+window_event_result net_udp_setup_game()
+{
+	param_opt opt;
+	auto &m = opt.m;
+	char level_text[32];
+
+	net_udp_init_hosted_netgame();
 
 	unsigned optnum{0};
 	opt.start_game=optnum;
@@ -4558,17 +5539,52 @@ menu_subtitle{"Rebirth now supports automatic\n"
 		net_udp_close();
 
 	write_netgame_profile(&Netgame);
-#if DXX_USE_TRACKER
 	/* Force off _after_ writing profile, so that command line does not
 	 * change ngp file.
 	 */
-	if (CGameArg.MplTrackerAddr.empty())
-		Netgame.Tracker = 0;
-#endif
+	net_udp_apply_tracker_arg();
 
 	return (i >= 0) ? window_event_result::close : window_event_result::handled;
 }
 
+void net_udp_host_game(const char *const mission, const int levelnum)
+{
+	if (Game_wind)
+	{
+		con_puts(CON_URGENT, "host: a game is already running");
+		return;
+	}
+	if (!InterfaceUniqueState.PilotName[0u])
+	{
+		con_puts(CON_URGENT, "host: no pilot is selected");
+		return;
+	}
+	mission_entry_predicate mission_predicate;
+	mission_predicate.filesystem_name = mission;
+#if DXX_BUILD_DESCENT == 2
+	mission_predicate.check_version = false;
+#endif
+	if (const auto errstr = load_mission_by_name(mission_predicate, mission_name_type::guess))
+	{
+		con_printf(CON_URGENT, "host: cannot load mission \"%s\": %s", mission, errstr);
+		return;
+	}
+#if DXX_BUILD_DESCENT == 1
+	if (levelnum < Current_mission->last_secret_level || levelnum > Current_mission->last_level || levelnum == 0)
+#elif DXX_BUILD_DESCENT == 2
+	if (levelnum < 1 || levelnum > Current_mission->last_level)
+#endif
+	{
+		con_printf(CON_URGENT, "host: level %d is out of range", levelnum);
+		return;
+	}
+	net_udp_init_hosted_netgame();
+	Netgame.levelnum = levelnum;
+	net_udp_apply_tracker_arg();
+	if (!net_udp_start_game(true))
+		net_udp_close();
+}
+
 namespace {
 
 static void net_udp_set_game_mode(const network_game_type gamemode)
@@ -4768,13 +5784,8 @@ static int net_udp_send_sync(void)
 
 namespace dsx {
 namespace {
-static int net_udp_select_players()
+static void net_udp_add_host_player()
 {
-	int j;
-	char text[MAX_PLAYERS+4][45];
-	char subtitle[50];
-	unsigned save_nplayers;              //how may people would like to join
-
 	if (Netgame.ShufflePowerupSeed)
 	{
 		unsigned seed{0};
@@ -4799,6 +5810,38 @@ static int net_udp_select_players()
 	}
 
 	net_udp_add_player(UDP_sequence_request_packet{GetMyNetRanking(), InterfaceUniqueState.PilotName, 0}, {});
+}
+
+/* Start with only the host.  Everyone else joins the game in progress,
+ * and team games keep the teams from the netgame profile.
+ */
+static int net_udp_select_players_unattended()
+{
+	net_udp_add_host_player();
+	range_for (auto &i, partial_range(Netgame.players, N_players, Netgame.players.size()))
+	{
+		i.callsign = {};
+		i.rank = netplayer_info::player_rank::None;
+	}
+#if DXX_USE_TRACKER
+	if (Netgame.Tracker)
+	{
+		TrackerAckStatus = TrackerAckState::TACK_NOCONNECTION;
+		TrackerAckTime = timer_query();
+		udp_tracker_register();
+	}
+#endif
+	return 1;
+}
+
+static int net_udp_select_players()
+{
+	int j;
+	char text[MAX_PLAYERS+4][45];
+	char subtitle[50];
+	unsigned save_nplayers;              //how may people would like to join
+
+	net_udp_add_host_player();
 	start_poll_menu_items spd;
 		
 	for (int i=0; i< MAX_PLAYERS+4; i++ ) {
@@ -4910,7 +5953,7 @@ abort:
 
 namespace {
 
-static int net_udp_start_game()
+static int net_udp_start_game(const bool unattended)
 {
 	int i;
 
@@ -4938,7 +5981,7 @@ static int net_udp_start_game()
 
 	Netgame.protocol.udp.your_index = 0; // I am Host. I need to know that y'know? For syncing later.
 	
-	if (!net_udp_select_players()
+	if (!(unattended ? net_udp_select_players_unattended() : net_udp_select_players())
 		|| StartNewLevel(Netgame.levelnum) == window_event_result::close)
 	{
 		Game_mode = {};
@@ -4956,6 +5999,7 @@ static int net_udp_wait_for_sync(void)
 	int choice{0};
 	
 	Network_status = network_state::waiting;
+	UDP_object_sync = {};
 
 	std::array<newmenu_item, 2> m{{
 		newmenu_item::nm_item_text{text},
@@ -5066,6 +6110,8 @@ window_event_result dispatch_table::level_sync() const
 	int result{0};
 
 	UDP_MData = {};
+	UDP_MData_needack = false;
+	UDP_MData_flush_time = 0;
 	net_udp_noloss_init_mdata_queue();
 
 	net_udp_flush(UDP_Socket); // Flush any old packets
@@ -5295,6 +6341,21 @@ static void net_udp_listen(RAIIsocket &sock)
 {
 	if (!sock)
 		return;
+#if DXX_USE_MMSG
+	udp_receive_batch batch;
+	while (const auto n = udp_receive_packets(sock, batch))
+	{
+		for (std::size_t i = 0; i != n; ++i)
+			/* An empty datagram ends the drain in the fallback.  Here it
+			 * is skipped, since the rest of the batch is already read.
+			 */
+			if (const auto size = batch.size[i])
+				net_udp_process_packet(LevelSharedRobotInfoState, {batch.packet[i].data(), size}, batch.sender_addr[i]);
+		/* A short batch means the socket was drained */
+		if (n < udp_receive_batch_size)
+			break;
+	}
+#else
 	struct _sockaddr sender_addr;
 	std::array<uint8_t, UPID_MAX_SIZE> packet;
 	for (;;)
@@ -5308,6 +6369,7 @@ static void net_udp_listen(RAIIsocket &sock)
 		 */
 		net_udp_process_packet(LevelSharedRobotInfoState, {packet.data(), static_cast<std::size_t>(size)}, sender_addr);
 	}
+#endif
 }
 
 void net_udp_listen()
@@ -5329,6 +6391,7 @@ void dispatch_table::send_data(const std::span<const uint8_t> buf, const multipl
 #if DXX_HAVE_POISON_VALGRIND
 	DXX_CHECK_MEM_IS_DEFINED(buf);
 #endif
+	net_udp_count_traffic(Net_udp_traffic_stats.command_sent, buf[0], len);
 
 	/* Build a span describing the region of UDP_MData.mbuf that is available
 	 * to be written, by skipping over any bytes already queued.
@@ -5342,7 +6405,7 @@ void dispatch_table::send_data(const std::span<const uint8_t> buf, const multipl
 #ifndef NDEBUG
 		const auto check{buf[0]};
 #endif
-		net_udp_send_mdata(0, timer_query());
+		net_udp_send_mdata(timer_query());
 		if (UDP_MData.mbuf_size != 0)
 			Int3();
 #ifndef NDEBUG
@@ -5359,7 +6422,12 @@ void dispatch_table::send_data(const std::span<const uint8_t> buf, const multipl
 	UDP_MData.mbuf_size += len;
 
 	if (priority != multiplayer_data_priority::_0)
-		net_udp_send_mdata(priority == multiplayer_data_priority::_2 ? 1 : 0, timer_query());
+	{
+		if (priority == multiplayer_data_priority::_2)
+			UDP_MData_needack = true;
+		if (!UDP_MData_flush_time)
+			UDP_MData_flush_time = timer_query() + UDP_MDATA_LATENCY_BUDGET;
+	}
 }
 
 }
@@ -5400,7 +6468,7 @@ namespace udp {
 void dispatch_table::do_protocol_frame(int force, int listen) const
 {
 	auto &LevelUniqueControlCenterState = LevelUniqueObjectState.ControlCenterState;
-	static fix64 last_pdata_time = 0, last_mdata_time = 16, last_endlevel_time = 32, last_bcast_time = 48, last_resync_time = 64;
+	static fix64 last_pdata_time = 0, last_mdata_time = 16, last_endlevel_time = 32, last_bcast_time = 48, last_resync_time = 64, last_relevance_time = 80;
 
 	if (!(Game_mode&GM_NETWORK) || !UDP_Socket[0])
 		return;
@@ -5410,6 +6478,12 @@ void dispatch_table::do_protocol_frame(int force, int listen) const
 	if (WaitForRefuseAnswer && time>(RefuseTimeLimit+(F1_0*12)))
 		WaitForRefuseAnswer=0;
 
+	if (multi_i_am_master() && time >= last_relevance_time + (F1_0 / 2))
+	{
+		last_relevance_time = time;
+		net_udp_update_pdata_relevance();
+	}
+
 	// Send positional update either in the regular PPS interval OR if forced
 	if (force || (Netgame.PacketsPerSec && time >= (last_pdata_time + (F1_0 / Netgame.PacketsPerSec))))
 	{
@@ -5424,11 +6498,14 @@ void dispatch_table::do_protocol_frame(int force, int listen) const
 	{
 		last_mdata_time = time;
 		multi_send_robot_frame();
-		net_udp_send_mdata(0, time);
+		net_udp_send_mdata(time);
 	}
 
 	net_udp_noloss_process_queue(time);
 
+	if (Netgame.SmoothPositions)
+		net_udp_apply_pdata_jitter_buffers(time);
+
 	if (VerifyPlayerJoined!=-1 && time >= last_resync_time+F1_0)
 	{
 		last_resync_time = time;
@@ -5467,6 +6544,10 @@ void dispatch_table::do_protocol_frame(int force, int listen) const
 			net_udp_send_extras();
 	}
 
+	// Send the priority messages of this frame, and any since, together once they waited long enough
+	if (UDP_MData_flush_time && timer_query() >= UDP_MData_flush_time)
+		net_udp_send_mdata(timer_query());
+
 	udp_traffic_stat();
 }
 }
@@ -5477,6 +6558,21 @@ namespace {
 
 /* CODE FOR PACKET LOSS PREVENTION - START */
 /* This code tries to make sure that packets with opcode upid::mdata_pneedack aren't lost and sent and received in order. */
+
+/* If player is not playing anymore, we can remove him from list. Also remove *me* (even if that should have been done already). Also make sure Clients do not send to anyone else than Host */
+static bool net_udp_noloss_drop_ack(const unsigned plc)
+{
+	return vcplayerptr(plc)->connected != player_connection_status::playing || plc == Player_num || (!multi_i_am_master() && plc > 0);
+}
+
+static bool net_udp_noloss_all_acked(const UDP_mdata_store &m)
+{
+	for (unsigned plc = 0; plc < MAX_PLAYERS; ++plc)
+		if (!m.player_ack[plc])
+			return false;
+	return true;
+}
+
 /*
  * Adds a packet to our queue. Should be called when an IMPORTANT mdata packet is created.
  * player_ack is an array which should contain 0 for each player that needs to send an ACK signal.
@@ -5489,17 +6585,16 @@ static void net_udp_noloss_add_queue_pkt(fix64 time, const std::span<const uint8
 	if (!Netgame.PacketLossPrevention)
 		return;
 
-	if (UDP_mdata_queue_highest == UDP_MDATA_STOR_QUEUE_SIZE) // The list is full. That should not happen. But if it does, we must do something.
+	auto &q = UDP_mdata_queue;
+	if (q.count == UDP_MDATA_STOR_QUEUE_SIZE) // The list is full. That should not happen. But if it does, we must do something.
 	{
 		con_printf(CON_VERBOSE, "P#%u: MData store list is full!", Player_num);
 		if (multi_i_am_master()) // I am host. I will kick everyone who did not ACK the first packet and then remove it.
 		{
 			for ( int i=1; i<N_players; i++ )
-				if (UDP_mdata_queue[0].player_ack[i] == 0)
+				if (q.store[q.head].player_ack[i] == 0)
 					multi::udp::dispatch->kick_player(Netgame.players[i].protocol.udp.addr, kick_player_reason::pkttimeout);
-			std::move(std::next(UDP_mdata_queue.begin()), UDP_mdata_queue.end(), UDP_mdata_queue.begin());
-			UDP_mdata_queue[UDP_MDATA_STOR_QUEUE_SIZE - 1] = {};
-			UDP_mdata_queue_highest--;
+			q.pop_head();
 		}
 		else // I am just a client. I gotta go.
 		{
@@ -5512,28 +6607,38 @@ static void net_udp_noloss_add_queue_pkt(fix64 time, const std::span<const uint8
 				g->set_visible(1);
 			multi_quit_game = 1;
 			game_leave_menus();
+			return;
 		}
-		Assert(UDP_mdata_queue_highest == (UDP_MDATA_STOR_QUEUE_SIZE - 1));
+		Assert(q.count == (UDP_MDATA_STOR_QUEUE_SIZE - 1));
 	}
 
 	con_printf(CON_VERBOSE, "P#%u: Adding MData pkt_num [%i,%i,%i,%i,%i,%i,%i,%i], type %i from P#%i to MData store list", Player_num, UDP_mdata_trace[0].pkt_num_tosend,UDP_mdata_trace[1].pkt_num_tosend,UDP_mdata_trace[2].pkt_num_tosend,UDP_mdata_trace[3].pkt_num_tosend,UDP_mdata_trace[4].pkt_num_tosend,UDP_mdata_trace[5].pkt_num_tosend,UDP_mdata_trace[6].pkt_num_tosend,UDP_mdata_trace[7].pkt_num_tosend, data[0], pnum);
-	UDP_mdata_queue[UDP_mdata_queue_highest].used = 1;
-	UDP_mdata_queue[UDP_mdata_queue_highest].pkt_initial_timestamp = time;
+	const uint16_t slot = (q.head + q.count) % UDP_MDATA_STOR_QUEUE_SIZE;
+	const auto serial{q.serial[slot] = ++q.next_serial};
+	++q.count;
+	Net_udp_traffic_stats.mdata_queue_peak = std::max(Net_udp_traffic_stats.mdata_queue_peak, q.count);
+	auto &m = q.store[slot];
+	m = {};
+	m.used = 1;
+	m.pkt_initial_timestamp = time;
 	for (unsigned i = 0; i < MAX_PLAYERS; ++i)
 	{
 		if (i == Player_num || player_ack[i] || vcplayerptr(i)->connected == player_connection_status::disconnected)	// if player me, is not playing or does not require an ACK, do not add timestamp or increment pkt_num
 			continue;
 		
-		UDP_mdata_queue[UDP_mdata_queue_highest].pkt_timestamp[i] = time;
-		UDP_mdata_queue[UDP_mdata_queue_highest].pkt_num[i] = UDP_mdata_trace[i].pkt_num_tosend;
+		m.pkt_timestamp[i] = time;
+		m.pkt_num[i] = UDP_mdata_trace[i].pkt_num_tosend;
+		q.slot_by_pkt_num[i][m.pkt_num[i] % UDP_MDATA_STOR_QUEUE_SIZE] = slot;
+		q.push_resend({time + UDP_MDATA_RESEND_DELAY, serial, slot, static_cast<uint8_t>(i)});
 		UDP_mdata_trace[i].pkt_num_tosend++;
 		if (UDP_mdata_trace[i].pkt_num_tosend > UDP_MDATA_PKT_NUM_MAX)
 			UDP_mdata_trace[i].pkt_num_tosend = UDP_MDATA_PKT_NUM_MIN;
 	}
-	UDP_mdata_queue[UDP_mdata_queue_highest].Player_num = pnum;
-	UDP_mdata_queue[UDP_mdata_queue_highest].player_ack = player_ack;
-	memcpy(&UDP_mdata_queue[UDP_mdata_queue_highest].data, data.data(), UDP_mdata_queue[UDP_mdata_queue_highest].data_size = data.size());
-	UDP_mdata_queue_highest++;
+	m.Player_num = pnum;
+	m.player_ack = player_ack;
+	memcpy(&m.data, data.data(), m.data_size = data.size());
+	if (net_udp_noloss_all_acked(m))
+		m.used = 0;
 }
 
 /*
@@ -5601,30 +6706,34 @@ void net_udp_noloss_got_ack(const std::span<const uint8_t> data)
 	dest_pnum = data[len];												len++;
 	const uint32_t pkt_num{GET_INTEL_INT(&data[len])};										len += 4;
 
-	for (int i = 0; i < UDP_mdata_queue_highest; i++)
+	if (sender_pnum >= MAX_PLAYERS)
+		return;
+	auto &m = UDP_mdata_queue.store[UDP_mdata_queue.slot_by_pkt_num[sender_pnum][pkt_num % UDP_MDATA_STOR_QUEUE_SIZE]];
+	if (m.used && (pkt_num == m.pkt_num[sender_pnum]) && (dest_pnum == m.Player_num))
 	{
-		if ((pkt_num == UDP_mdata_queue[i].pkt_num[sender_pnum]) && (dest_pnum == UDP_mdata_queue[i].Player_num))
-		{
-			con_printf(CON_VERBOSE, "P#%u: Got MData ACK for pkt_num %i from pnum %i for pnum %i",Player_num, pkt_num, sender_pnum, dest_pnum);
-			UDP_mdata_queue[i].player_ack[sender_pnum] = 1;
-			break;
-		}
+		con_printf(CON_VERBOSE, "P#%u: Got MData ACK for pkt_num %i from pnum %i for pnum %i",Player_num, pkt_num, sender_pnum, dest_pnum);
+		m.player_ack[sender_pnum] = 1;
+		if (net_udp_noloss_all_acked(m))
+			m.used = 0;
 	}
 }
 
 /* Init/Free the queue. Call at start and end of a game or level. */
 void net_udp_noloss_init_mdata_queue(void)
 {
-	UDP_mdata_queue_highest=0;
 	con_printf(CON_VERBOSE, "P#%u: Clearing MData store/trace list",Player_num);
 	UDP_mdata_queue = {};
+	UDP_pdata_sent = {};
+	UDP_pdata_relay_interval = {};
 	for (int i = 0; i < MAX_PLAYERS; i++)
 		net_udp_noloss_clear_mdata_trace(i);
 }
 
-/* Reset the trace list for given player when (dis)connect happens */
+/* Reset the trace list and the pdata keyframe for given player when (dis)connect happens */
 void net_udp_noloss_clear_mdata_trace(ubyte player_num)
 {
+	UDP_pdata_received[player_num] = {};
+	UDP_pdata_jitter[player_num] = {};
 	con_printf(CON_VERBOSE, "P#%u: Clearing trace list for %i",Player_num, player_num);
 	UDP_mdata_trace[player_num].pkt_num = {};
 	UDP_mdata_trace[player_num].cur_slot = 0;
@@ -5646,58 +6755,76 @@ void net_udp_noloss_process_queue(fix64 time)
 	if (!Netgame.PacketLossPrevention)
 		return;
 
-	for (int queuec = 0; queuec < UDP_mdata_queue_highest; queuec++)
+	auto &q = UDP_mdata_queue;
+	// Resend what is due, oldest first.  Timers of packets which were ACK'd or removed since are dropped here.
+	while (q.resend_count && q.resends[q.resend_head].due <= time)
 	{
-		int needack{0};
-
-		// This might happen if we get out ACK's in the wrong order. So ignore that packet for now. It'll resolve itself.
-		if (!UDP_mdata_queue[queuec].used)
+		// Send up to half our max packet size
+		if (total_len >= (UPID_MAX_SIZE/2))
+			break;
+		const auto r{q.resends[q.resend_head]};
+		q.resend_head = (q.resend_head + 1) % q.resends.size();
+		--q.resend_count;
+		if (q.serial[r.slot] != r.serial)
 			continue;
-
-		// Check if at least one connected player has not ACK'd the packet
-		for (unsigned plc = 0; plc < MAX_PLAYERS; ++plc)
+		auto &m = q.store[r.slot];
+		if (!m.used)
+			continue;
+		const unsigned plc = r.pnum;
+		if (net_udp_noloss_drop_ack(plc))
 		{
-			// If player is not playing anymore, we can remove him from list. Also remove *me* (even if that should have been done already). Also make sure Clients do not send to anyone else than Host
-			if ((vcplayerptr(plc)->connected != player_connection_status::playing || plc == Player_num) || (!multi_i_am_master() && plc > 0))
-				UDP_mdata_queue[queuec].player_ack[plc] = 1;
-
-			if (!UDP_mdata_queue[queuec].player_ack[plc])
-			{
-				// Resend if enough time has passed.
-				if (UDP_mdata_queue[queuec].pkt_timestamp[plc] + (F1_0/4) <= time)
-				{
-					con_printf(CON_VERBOSE, "P#%u: Resending pkt_num %i from pnum %i to pnum %i",Player_num, UDP_mdata_queue[queuec].pkt_num[plc], UDP_mdata_queue[queuec].Player_num, plc);
-					UDP_mdata_queue[queuec].pkt_timestamp[plc] = time;
-					std::array<uint8_t, sizeof(UDP_mdata_info)> buf{};
-
-					unsigned len{0};
-					// Prepare the packet and send it
-					buf[len] = underlying_value(upid::mdata_pneedack);													len++;
-					buf[len] = UDP_mdata_queue[queuec].Player_num;								len++;
-					PUT_INTEL_INT(&buf[len], UDP_mdata_queue[queuec].pkt_num[plc]);					len += 4;
-					memcpy(&buf[len], UDP_mdata_queue[queuec].data.data(), sizeof(char)*UDP_mdata_queue[queuec].data_size);
-																								len += UDP_mdata_queue[queuec].data_size;
-					dxx_sendto(UDP_Socket[0], std::span(buf).first(len), 0, Netgame.players[plc].protocol.udp.addr);
-					total_len += len;
-				}
-				needack++;
-			}
+			m.player_ack[plc] = 1;
+			if (net_udp_noloss_all_acked(m))
+				m.used = 0;
+			continue;
 		}
-
-		// Check if we can remove that packet due to to it had no resend's or Timeout
-		if (needack==0 || (UDP_mdata_queue[queuec].pkt_initial_timestamp + UDP_TIMEOUT <= time))
+		if (m.player_ack[plc])
+			continue;
+		con_printf(CON_VERBOSE, "P#%u: Resending pkt_num %i from pnum %i to pnum %i",Player_num, m.pkt_num[plc], m.Player_num, plc);
+		++Net_udp_traffic_stats.mdata_resends;
+		m.pkt_timestamp[plc] = time;
+		q.push_resend({time + UDP_MDATA_RESEND_DELAY, r.serial, r.slot, r.pnum});
+		std::array<uint8_t, sizeof(UDP_mdata_info)> buf{};
+
+		unsigned len{0};
+		// Prepare the packet and send it
+		buf[len] = underlying_value(upid::mdata_pneedack);													len++;
+		buf[len] = m.Player_num;								len++;
+		PUT_INTEL_INT(&buf[len], m.pkt_num[plc]);					len += 4;
+		memcpy(&buf[len], m.data.data(), sizeof(char)*m.data_size);
+																					len += m.data_size;
+		dxx_sendto(UDP_Socket[0], std::span(buf).first(len), 0, Netgame.players[plc].protocol.udp.addr);
+		total_len += len;
+	}
+
+	// Remove ACK'd and timed out packets from the head of the queue.  Packets are queued in time order, so the first which is neither ends the search.
+	while (q.count)
+	{
+		auto &m = q.store[q.head];
+		if (m.used)
 		{
+			if (m.pkt_initial_timestamp + UDP_TIMEOUT > time)
+				break;
+			int needack{0};
+			for (unsigned plc = 0; plc < MAX_PLAYERS; ++plc)
+			{
+				if (net_udp_noloss_drop_ack(plc))
+					m.player_ack[plc] = 1;
+				if (!m.player_ack[plc])
+					needack++;
+			}
 			if (needack) // packet timed out but still not all have ack'd.
 			{
 				if (multi_i_am_master()) // We are host, so we kick the remaining players.
 				{
 					for ( int plc=1; plc<N_players; plc++ )
-						if (UDP_mdata_queue[queuec].player_ack[plc] == 0)
+						if (m.player_ack[plc] == 0)
 							multi::udp::dispatch->kick_player(Netgame.players[plc].protocol.udp.addr, kick_player_reason::pkttimeout);
 				}
 				else // We are client, so we gotta go.
 				{
 					Netgame.PacketLossPrevention = 0; // Disable PLP - otherwise we get stuck in an infinite loop here. NOTE: We could as well clean the whole queue to continue protect our disconnect signal bit it's not that important - we just wanna leave.
+					q.pop_head();
 					const auto g{Game_wind};
 					if (g)
 						g->set_visible(0);
@@ -5706,30 +6833,12 @@ void net_udp_noloss_process_queue(fix64 time)
 						g->set_visible(1);
 					multi_quit_game = 1;
 					game_leave_menus();
+					return;
 				}
 			}
-			con_printf(CON_VERBOSE, "P#%u: Removing stored pkt_num [%i,%i,%i,%i,%i,%i,%i,%i] - missing ACKs: %i",Player_num, UDP_mdata_queue[queuec].pkt_num[0],UDP_mdata_queue[queuec].pkt_num[1],UDP_mdata_queue[queuec].pkt_num[2],UDP_mdata_queue[queuec].pkt_num[3],UDP_mdata_queue[queuec].pkt_num[4],UDP_mdata_queue[queuec].pkt_num[5],UDP_mdata_queue[queuec].pkt_num[6],UDP_mdata_queue[queuec].pkt_num[7], needack); // Just *marked* for removal. The actual process happens further below.
-			UDP_mdata_queue[queuec].used = 0;
-		}
-
-		// Send up to half our max packet size
-		if (total_len >= (UPID_MAX_SIZE/2))
-			break;
-	}
-
-	// Now that we are done processing the queue, actually remove all unused packets from the top of the list.
-	{
-		const auto b = UDP_mdata_queue.begin();
-		const auto e = std::next(b, UDP_mdata_queue_highest);
-		const auto &&first_used_entry{std::ranges::find_if(b, e, [](const UDP_mdata_store &m) { return m.used; })};
-		if (first_used_entry != b)
-		{
-			std::move(first_used_entry, e, b);
-			const auto total_used_entries = std::distance(first_used_entry, e);
-			UDP_mdata_queue_highest = total_used_entries;
-			for (auto first_unused_entry = std::next(b, total_used_entries); first_unused_entry != e; ++first_unused_entry)
-				*first_unused_entry = {};
+			con_printf(CON_VERBOSE, "P#%u: Removing stored pkt_num [%i,%i,%i,%i,%i,%i,%i,%i] - missing ACKs: %i",Player_num, m.pkt_num[0],m.pkt_num[1],m.pkt_num[2],m.pkt_num[3],m.pkt_num[4],m.pkt_num[5],m.pkt_num[6],m.pkt_num[7], needack);
 		}
+		q.pop_head();
 	}
 }
 
@@ -5747,6 +6856,7 @@ void dispatch_table::send_data_direct(const std::span<const uint8_t> data, const
 
 	if (data.empty())
 		return;
+	net_udp_count_traffic(Net_udp_traffic_stats.command_sent, data[0], data.size());
 
 	if (!multi_i_am_master() && pnum != 0)
 		Error("Client sent direct data to non-Host in net_udp_send_mdata_direct()!\n");
@@ -5788,7 +6898,7 @@ void dispatch_table::send_data_direct(const std::span<const uint8_t> data, const
 
 namespace {
 
-void net_udp_send_mdata(int needack, fix64 time)
+void net_udp_send_mdata(const fix64 time)
 {
 	if (!(Game_mode&GM_NETWORK) || !UDP_Socket[0])
 		return;
@@ -5796,8 +6906,7 @@ void net_udp_send_mdata(int needack, fix64 time)
 	if (!(UDP_MData.mbuf_size > 0))
 		return;
 
-	if (!Netgame.PacketLossPrevention)
-		needack = 0;
+	const bool needack{UDP_MData_needack && Netgame.PacketLossPrevention};
 
 	std::array<uint8_t, sizeof(UDP_mdata_info)> buf{};
 
@@ -5841,6 +6950,8 @@ void net_udp_send_mdata(int needack, fix64 time)
 	UDP_MData.Player_num = 0;
 	UDP_MData.mbuf_size = 0;
 	UDP_MData.mbuf = {};
+	UDP_MData_needack = false;
+	UDP_MData_flush_time = 0;
 }
 
 void net_udp_process_mdata(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, const std::span<uint8_t> data, const _sockaddr &sender_addr, int needack)
@@ -5908,26 +7019,61 @@ void net_udp_process_mdata(const d_level_shared_robot_info_state &LevelSharedRob
 	multi_process_bigdata(LevelSharedRobotInfoState, pnum, subdata);
 }
 
-void net_udp_send_pdata()
+/* How often the host sends the position updates of one player to
+ * another: every update when the other may see him, every second update
+ * when he is further away, and every fourth when the mine has no open
+ * path between them within pdata_relevance_depth segments.
+ */
+constexpr int pdata_relevance_depth = 16;
+
+static uint8_t net_udp_pdata_relay_interval(const unsigned a, const unsigned b)
 {
 	auto &Objects = LevelUniqueObjectState.Objects;
-	auto &vmobjptr = Objects.vmptr;
-	std::array<uint8_t, 3 + quaternionpos::packed_size::value> buf;
-	int len{0};
+	auto &vcobjptr = Objects.vcptr;
+	auto &pa = *vcplayerptr(a);
+	auto &pb = *vcplayerptr(b);
+	if (pa.connected != player_connection_status::playing || pb.connected != player_connection_status::playing)
+		return 1;
+	auto &oa = *vcobjptr(pa.objnum);
+	auto &ob = *vcobjptr(pb.objnum);
+	const auto dist{find_connected_distance(oa.pos, vcsegptridx(oa.segnum), ob.pos, vcsegptridx(ob.segnum), pdata_relevance_depth, wall_is_doorway_mask::rendpast)};
+	if (dist < 0)
+		return 4;
+	if (dist < i2f(320))
+		return 1;
+	return 2;
+}
 
-	if (!(Game_mode&GM_NETWORK) || !UDP_Socket[0])
-		return;
-	auto &plr = get_local_player();
-	if (plr.connected != player_connection_status::playing)
-		return;
+void net_udp_update_pdata_relevance()
+{
 	if (!(Network_status == network_state::playing || Network_status == network_state::endlevel))
 		return;
+	for (unsigned a = 0; a < N_players; ++a)
+		for (unsigned b = a + 1; b < N_players; ++b)
+			UDP_pdata_relay_interval[a][b] = UDP_pdata_relay_interval[b][a] = net_udp_pdata_relay_interval(a, b);
+}
+
+/* Whether the host sends this position update of `from` to `to`.
+ * Keyframes always go, so that the deltas which are sent can be read.
+ */
+static bool net_udp_pdata_relay_due(const unsigned from, const unsigned to, const bool keyframe)
+{
+	auto &skipped = UDP_pdata_relay_skipped[from][to];
+	if (keyframe || ++skipped >= UDP_pdata_relay_interval[from][to])
+	{
+		skipped = 0;
+		return true;
+	}
+	return false;
+}
 
+static void net_udp_build_pdata(const std::span<uint8_t, upid_length<upid::pdata>> buf, const player_connection_status connected, const quaternionpos &qpp)
+{
+	int len{0};
 	buf[len] = underlying_value(upid::pdata);									len++;
 	buf[len] = Player_num;									len++;
-	buf[len] = underlying_value(plr.connected);						len++;
+	buf[len] = underlying_value(connected);						len++;
 
-	const auto qpp{build_quaternionpos(vmobjptr(plr.objnum))};
 	PUT_INTEL_SHORT(&buf[len], qpp.orient.w);							len += 2;
 	PUT_INTEL_SHORT(&buf[len], qpp.orient.x);							len += 2;
 	PUT_INTEL_SHORT(&buf[len], qpp.orient.y);							len += 2;
@@ -5940,12 +7086,50 @@ void net_udp_send_pdata()
 	multi_put_vector(&buf[len], qpp.rotvel);
 	len += 12;
 	// 46 + 3 = 49
+	UDP_pdata_sent = {qpp, static_cast<uint8_t>(UDP_pdata_sent.sequence + 1), true};
+	UDP_pdata_sent_since_keyframe = 0;
+	buf[len] = UDP_pdata_sent.sequence;						len++;
+}
+
+void net_udp_send_pdata()
+{
+	auto &Objects = LevelUniqueObjectState.Objects;
+	auto &vmobjptr = Objects.vmptr;
+	std::array<uint8_t, upid_length<upid::pdata>> full_buf;
+	std::array<uint8_t, pdata_delta_max_size> delta_buf;
+
+	if (!(Game_mode&GM_NETWORK) || !UDP_Socket[0])
+		return;
+	auto &plr = get_local_player();
+	if (plr.connected != player_connection_status::playing)
+		return;
+	if (!(Network_status == network_state::playing || Network_status == network_state::endlevel))
+		return;
+
+	const auto qpp{build_quaternionpos(vmobjptr(plr.objnum))};
+	std::span<const uint8_t> buf;
+	if (UDP_pdata_sent.valid && ++UDP_pdata_sent_since_keyframe < pdata_keyframe_interval)
+		if (const auto delta_len{net_udp_build_pdata_delta(delta_buf, qpp, UDP_pdata_sent.qpp)})
+		{
+			delta_buf[0] = underlying_value(upid::pdata_delta);
+			delta_buf[1] = Player_num;
+			delta_buf[2] = underlying_value(plr.connected);
+			delta_buf[3] = UDP_pdata_sent.sequence;
+			buf = std::span(delta_buf).first(delta_len);
+		}
+	if (buf.empty())
+	{
+		net_udp_build_pdata(full_buf, plr.connected, qpp);
+		buf = full_buf;
+	}
 
 	if (multi_i_am_master())
 	{
-		for (unsigned i = 1; i < MAX_PLAYERS; ++i)
-			if (vcplayerptr(i)->connected != player_connection_status::disconnected)
-				dxx_sendto(UDP_Socket[0], buf, 0, Netgame.players[i].protocol.udp.addr);
+		const bool keyframe{buf[0] == underlying_value(upid::pdata)};
+		std::array<const _sockaddr *, MAX_PLAYERS> peers;
+		dxx_sendto_each(UDP_Socket[0], buf, 0, udp_peer_addresses(peers, [keyframe](const unsigned i) {
+			return vcplayerptr(i)->connected != player_connection_status::disconnected && net_udp_pdata_relay_due(Player_num, i, keyframe);
+		}));
 	}
 	else
 	{
@@ -5989,21 +7173,54 @@ void net_udp_process_pdata(const std::span<const uint8_t> data, const _sockaddr
 	len += 12;
 	pd.qpp.rotvel = multi_get_vector(data.subspan<3 + 8 + 12 + 2 + 12, 12>());
 	len += 12;
+	UDP_len_pdata[playernum] += data.size();
+	net_udp_relay_and_read_pdata(data, pd);
+	/* Keep the keyframe for later deltas.  This is stored after reading
+	 * the packet, since a reconnect there clears the old keyframe.
+	 */
+	UDP_pdata_received[playernum] = {pd.qpp, data[len], true};
+}
+
+void net_udp_process_pdata_delta(const std::span<const uint8_t> data, const _sockaddr &sender_addr)
+{
+	if (!(+(Game_mode & GM_NETWORK) && (Network_status == network_state::playing || Network_status == network_state::endlevel)))
+		return;
+	if (data.size() < pdata_delta_header_size)
+		return;
+	const playernum_t playernum = data[1];
+	if (playernum >= std::size(Netgame.players))
+		return;
+	if (sender_addr != Netgame.players[multi_i_am_master() ? playernum : 0].protocol.udp.addr)
+		return;
+	UDP_len_pdata[playernum] += data.size();
+	auto &key = UDP_pdata_received[playernum];
+	// a delta against a keyframe we missed is useless, so wait for the next keyframe
+	if (!key.valid || key.sequence != data[3])
+		return;
+	UDP_frame_info pd{};
+	pd.Player_num = playernum;
+	pd.connected = player_connection_status{data[2]};
+	if (!net_udp_read_pdata_delta(data, key.qpp, pd.qpp))
+		return;
+	net_udp_relay_and_read_pdata(data, pd);
+}
 
+void net_udp_relay_and_read_pdata(const std::span<const uint8_t> data, UDP_frame_info &pd)
+{
 	if (multi_i_am_master()) // I am host - must relay this packet to others!
 	{
 		const unsigned ppn = pd.Player_num;
 		if (ppn > 0 && ppn <= N_players && vcplayerptr(ppn)->connected == player_connection_status::playing) // some checking whether this packet is legal
 		{
-			for (unsigned i = 1; i < MAX_PLAYERS; ++i)
-			{
+			const bool keyframe{data[0] == underlying_value(upid::pdata)};
+			std::array<const _sockaddr *, MAX_PLAYERS> peers;
+			dxx_sendto_each(UDP_Socket[0], data, 0, udp_peer_addresses(peers, [ppn, keyframe](const unsigned i) {
 				// not to sender or disconnected/waiting players - right.
 				if (i == ppn)
-					continue;
+					return false;
 				auto &iplr = *vcplayerptr(i);
-				if (iplr.connected != player_connection_status::disconnected && iplr.connected != player_connection_status::waiting)
-					dxx_sendto(UDP_Socket[0], data, 0, Netgame.players[i].protocol.udp.addr);
-			}
+				return iplr.connected != player_connection_status::disconnected && iplr.connected != player_connection_status::waiting && net_udp_pdata_relay_due(ppn, i, keyframe);
+			}));
 		}
 	}
 
@@ -6070,11 +7287,127 @@ void net_udp_read_pdata_packet(UDP_frame_info *pd)
 	if (vcplayerptr(Player_num)->connected == player_connection_status::disconnected || vcplayerptr(Player_num)->connected == player_connection_status::waiting)
                 return;
 	//------------ Read the player's ship's object info ----------------------
+	if (Netgame.SmoothPositions)
+	{
+		auto &b = UDP_pdata_jitter[TheirPlayernum];
+		const bool first = !b.count;
+		b.push(timer_query(), pd->qpp);
+		/* Later positions are applied by net_udp_apply_pdata_jitter_buffers */
+		if (!first)
+			return;
+	}
 	extract_quaternionpos(Objects.vmptr, vmsegptr, TheirObj, pd->qpp);
 	if (TheirObj->movement_source == object::movement_type::physics)
 		set_thrust_from_velocity(TheirObj);
 }
 
+static fix net_udp_blend_fix(const fix a, const fix b, const fix t)
+{
+	return a + fixmul(b - a, t);
+}
+
+static vms_vector net_udp_blend_vector(const vms_vector &a, const vms_vector &b, const fix t)
+{
+	return {
+		net_udp_blend_fix(a.x, b.x, t),
+		net_udp_blend_fix(a.y, b.y, t),
+		net_udp_blend_fix(a.z, b.z, t),
+	};
+}
+
+/* Blend the orientations component by component.  The result need not be
+ * of unit length, since vms_matrix_from_quaternion normalizes it.  Taking
+ * the sign of `b` nearer to `a` keeps the blend on the shorter arc.
+ */
+static vms_quaternion net_udp_blend_quaternion(const vms_quaternion &a, vms_quaternion b, const fix t)
+{
+	if (int{a.w} * b.w + int{a.x} * b.x + int{a.y} * b.y + int{a.z} * b.z < 0)
+	{
+		b.w = -b.w;
+		b.x = -b.x;
+		b.y = -b.y;
+		b.z = -b.z;
+	}
+	return {
+		static_cast<int16_t>(net_udp_blend_fix(a.w, b.w, t)),
+		static_cast<int16_t>(net_udp_blend_fix(a.x, b.x, t)),
+		static_cast<int16_t>(net_udp_blend_fix(a.y, b.y, t)),
+		static_cast<int16_t>(net_udp_blend_fix(a.z, b.z, t)),
+	};
+}
+
+/* Find the position of one player at `render_time`.  Returns false if it
+ * should stay where it is.
+ */
+static bool net_udp_sample_pdata_jitter_buffer(const UDP_pdata_jitter_buffer &b, const fix64 render_time, quaternionpos &qpp)
+{
+	const auto &newest = b.get(0);
+	if (render_time >= newest.time)
+	{
+		/* Nothing newer arrived in time.  Move it on along its velocity,
+		 * but only so far.
+		 */
+		const fix dt = static_cast<fix>(std::min<fix64>(render_time - newest.time, pdata_max_extrapolation));
+		qpp = newest.qpp;
+		qpp.pos = vm_vec_scale_add(newest.qpp.pos, newest.qpp.vel, dt);
+	}
+	else
+	{
+		unsigned age = 1;
+		for (; age < b.count && b.get(age).time > render_time; ++age)
+		{
+		}
+		if (age == b.count)
+			/* Older than anything held, which only happens while the
+			 * buffer fills.  Wait for time to catch up.
+			 */
+			return false;
+		const auto &before = b.get(age);
+		const auto &after = b.get(age - 1);
+		qpp = after.qpp;
+		if (vm_vec_dist_quick(before.qpp.pos, after.qpp.pos) > pdata_max_blend_distance)
+			return true;
+		const fix t = static_cast<fix>(((render_time - before.time) * F1_0) / (after.time - before.time));
+		qpp.orient = net_udp_blend_quaternion(before.qpp.orient, after.qpp.orient, t);
+		qpp.pos = net_udp_blend_vector(before.qpp.pos, after.qpp.pos, t);
+		qpp.vel = net_udp_blend_vector(before.qpp.vel, after.qpp.vel, t);
+		qpp.rotvel = net_udp_blend_vector(before.qpp.rotvel, after.qpp.rotvel, t);
+	}
+	/* A point on the way may be in a different segment than either end, and
+	 * one moved on past the last position may be outside the mine.
+	 */
+	const auto &&segnum = find_point_seg(LevelSharedSegmentState, qpp.pos, vcsegptridx(newest.qpp.segment) DXX_lighting_hack_pass_parameter);
+	if (segnum == segment_none)
+		qpp = newest.qpp;
+	else
+		qpp.segment = segnum;
+	return true;
+}
+
+void net_udp_apply_pdata_jitter_buffers(const fix64 time)
+{
+	auto &Objects = LevelUniqueObjectState.Objects;
+	auto &vmobjptridx = Objects.vmptridx;
+	const auto &plr = *vcplayerptr(Player_num);
+	if (plr.connected == player_connection_status::disconnected || plr.connected == player_connection_status::waiting)
+		return;
+	for (auto &&[pnum, b] : enumerate(UDP_pdata_jitter))
+	{
+		if (!b.count || pnum == Player_num || pnum >= N_players)
+			continue;
+		const auto &tplr = *vcplayerptr(static_cast<unsigned>(pnum));
+		if (tplr.connected != player_connection_status::playing)
+			continue;
+		quaternionpos qpp;
+		if (!net_udp_sample_pdata_jitter_buffer(b, time - b.delay(), qpp))
+			continue;
+		const auto &&obj = vmobjptridx(tplr.objnum);
+		extract_quaternionpos(Objects.vmptr, vmsegptr, obj, qpp);
+		if (obj->movement_source == object::movement_type::physics)
+			set_thrust_from_velocity(obj);
+	}
+}
+
 }
 
 #if DXX_BUILD_DESCENT == 2
@@ -6133,12 +7466,10 @@ void net_udp_ping_frame(fix64 time)
 			PUT_INTEL_INT(&buf[len], i.ping);		len += 4;
 		}
 		
-		for (unsigned i = 1; i < MAX_PLAYERS; ++i)
-		{
-			if (vcplayerptr(i)->connected == player_connection_status::disconnected)
-				continue;
-			dxx_sendto(UDP_Socket[0], buf, 0, Netgame.players[i].protocol.udp.addr);
-		}
+		std::array<const _sockaddr *, MAX_PLAYERS> peers;
+		dxx_sendto_each(UDP_Socket[0], buf, 0, udp_peer_addresses(peers, [](const unsigned i) {
+			return vcplayerptr(i)->connected != player_connection_status::disconnected;
+		}));
 		PingTime = time;
 	}
 }
@@ -6158,6 +7489,8 @@ void net_udp_process_ping(const upid_rspan<upid::ping> data, const _sockaddr &se
 	{
 		i.ping = GET_INTEL_INT(&(data[len]));		len += 4;
 	}
+	/* The host measures the round trip, and only tells each client its own */
+	net_udp_record_rtt(Netgame.players[Player_num].ping);
 	
 	buf[0] = underlying_value(upid::pong);
 	buf[1] = Player_num;
@@ -6190,6 +7523,7 @@ void net_udp_process_pong(const upid_rspan<upid::pong> data, const _sockaddr &se
 	else
 		result = 0;
 	Netgame.players[playernum].ping = result;
+	net_udp_record_rtt(result);
 }
 
 }
@@ -6449,16 +7783,35 @@ static int udp_tracker_init()
 	TrackerAckStatus = TrackerAckState::TACK_NOCONNECTION;
 	TrackerAckTime = timer_query();
 
-	const char *tracker_addr = CGameArg.MplTrackerAddr.c_str();
-
-	// Fill the address
-	if (udp_dns_filladdr(TrackerSocket, tracker_addr, CGameArg.MplTrackerPort, false, true) < 0)
-		return -1;
+	/* The address only comes from the command line, so it is looked up
+	 * once, in the background, and again only if that failed.
+	 */
+	if (!TrackerSocketLookup.valid() && TrackerSocket.sa.sa_family == AF_UNSPEC)
+		TrackerSocketLookup = udp_dns_filladdr_async(CGameArg.MplTrackerAddr, CGameArg.MplTrackerPort);
 
 	// Yay
 	return 0;
 }
 
+/* The address of the tracker, or nullptr while udp_tracker_init still
+ * looks it up or if that failed.  Nothing is sent to the tracker until
+ * it is known.
+ */
+static const _sockaddr *udp_tracker_socket()
+{
+	if (TrackerSocketLookup.valid())
+	{
+		if (TrackerSocketLookup.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return nullptr;
+		const auto result = TrackerSocketLookup.get();
+		if (result.error)
+			con_printf(CON_URGENT, "udp_dns_filladdr: %s %s", result.error, CGameArg.MplTrackerAddr.c_str());
+		else
+			TrackerSocket = result.addr;
+	}
+	return TrackerSocket.sa.sa_family == AF_UNSPEC ? nullptr : &TrackerSocket;
+}
+
 /* Compares sender to tracker. Returns 1 if address matches, Returns 2 is address and port matches. */
 static int sender_is_tracker(const _sockaddr &sender, const _sockaddr &tracker)
 {
@@ -6516,7 +7869,10 @@ static int udp_tracker_unregister()
 {
 	std::array<uint8_t, 1> pBuf;
 	pBuf[0] = UPID_TRACKER_REMOVE;
-	return dxx_sendto(UDP_Socket[0], pBuf, 0, TrackerSocket);
+	const auto tracker = udp_tracker_socket();
+	if (!tracker)
+		return -1;
+	return dxx_sendto(UDP_Socket[0], pBuf, 0, *tracker);
 }
 
 }
@@ -6526,6 +7882,9 @@ namespace {
 /* Register or update (i.e. keep alive) a game on the tracker */
 static int udp_tracker_register()
 {
+	const auto tracker = udp_tracker_socket();
+	if (!tracker)
+		return -1;	// registered again with the next keep alive
 	net_udp_update_netgame();
 
 	game_info_light light;
@@ -6537,19 +7896,34 @@ static int udp_tracker_register()
 	len += snprintf(reinterpret_cast<char *>(&pBuf[1]), sizeof(pBuf)-1, "b=" UDP_REQ_ID DXX_VERSION_STR ".%hu,z=", MULTI_PROTO_VERSION );
 	memcpy(&pBuf[len], light_span.data(), light_span.size());		len += light_span.size();
 
-	return dxx_sendto(UDP_Socket[0], std::span(pBuf).first(len), 0, TrackerSocket);
+	return dxx_sendto(UDP_Socket[0], std::span(pBuf).first(len), 0, *tracker);
 }
 
 /* Ask the tracker to send us a list of games */
 static int udp_tracker_reqgames()
 {
+	const auto tracker = udp_tracker_socket();
+	if (!tracker)
+	{
+		TrackerReqgamesDeferred = TrackerSocketLookup.valid();
+		return -1;
+	}
 	std::array<uint8_t, 2 + sizeof(UDP_REQ_ID) + sizeof("00000.00000.00000.00000")> pBuf{};
 	unsigned len{1};
 
 	pBuf[0] = UPID_TRACKER_REQGAMES;
 	len += snprintf(reinterpret_cast<char *>(&pBuf[1]), sizeof(pBuf)-1, UDP_REQ_ID DXX_VERSION_STR ".%hu", MULTI_PROTO_VERSION );
 
-	return dxx_sendto(UDP_Socket[0], std::span(pBuf).first(len), 0, TrackerSocket);
+	return dxx_sendto(UDP_Socket[0], std::span(pBuf).first(len), 0, *tracker);
+}
+
+/* Send the request for games once the lookup that held it finishes */
+static void udp_tracker_send_deferred()
+{
+	if (!TrackerReqgamesDeferred || (TrackerSocketLookup.valid() && TrackerSocketLookup.wait_for(std::chrono::seconds(0)) != std::future_status::ready))
+		return;
+	TrackerReqgamesDeferred = false;
+	udp_tracker_reqgames();
 }
 }
 }
@@ -6667,8 +8041,11 @@ static void udp_tracker_request_holepunch(const tracker_game_id id)
 	const uint16_t TrackerGameID = underlying_value(id);
 	PUT_INTEL_SHORT(&pBuf[1], TrackerGameID);
 
+	const auto tracker = udp_tracker_socket();
+	if (!tracker)
+		return;
 	con_printf(CON_VERBOSE, "[Tracker] Sending hole-punch request for game [%i] to tracker.", TrackerGameID);
-	dxx_sendto(UDP_Socket[0], pBuf, 0, TrackerSocket);
+	dxx_sendto(UDP_Socket[0], pBuf, 0, *tracker);
 }
 
 /* Tracker sent us an address from a client requesting hole punching.
@@ -24,13 +24,26 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  */
 
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <stdio.h>
 #include <stdarg.h>
 #include <errno.h>
 #include <ctype.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <type_traits>
+#include <map>
+#include <numeric>
+#include <vector>
+#include "cmd.h"
 #include "d_range.h"
+#include "lz_block.h"
+#include "mem_account.h"
 
 #include "u_mem.h"
 #include "inferno.h"
@@ -166,9 +179,353 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 const std::array<file_extension_t, 1> demo_file_extensions{{DEMO_EXT}};
 
+namespace {
+
+/* A compressed demo starts with demo_compressed_magic and the block size.
+ * Then the event stream follows in blocks of that many bytes, the last
+ * one shorter.  Each block is its uncompressed size, its stored size and
+ * its data, as lz_block data unless both sizes are equal.  Offsets into
+ * the demo are always offsets into the uncompressed stream, so that
+ * seeking works the same for both kinds.
+ */
+constexpr std::array<uint8_t, 4> demo_compressed_magic{{'D', 'X', 'D', 'Z'}};
+constexpr std::size_t demo_block_size = 64 * 1024;
+
+/* What is recorded is collected in memory, and handed to a thread which
+ * writes it to the file at the start of each recorded frame, or sooner
+ * if the frame grows past flush_size.  The game never waits for the disk
+ * except when recording stops.
+ */
+class demo_writer
+{
+	static constexpr std::size_t flush_size = 64 * 1024;
+	RAIIPHYSFS_File file;
+	std::thread thread;
+	std::mutex lock;
+	std::condition_variable wake;
+	/* Buffers waiting to be written, and emptied buffers for reuse */
+	std::vector<std::vector<uint8_t>> pending, spare;
+	/* Changed only with `lock` held */
+	mem_account_tracked queued_account{mem_tag::demo};
+	bool stopping;
+	bool compress;
+	std::atomic<bool> write_failed;
+	/* What is recorded since the last flush */
+	std::vector<uint8_t> buffer;
+	mem_account_tracked buffer_account{mem_tag::demo};
+	/* Owned by the thread: what is left over for the next block, and the
+	 * block compressed
+	 */
+	std::vector<uint8_t> block, packed;
+	mem_account_tracked block_account{mem_tag::demo};
+	void run();
+	void account_queued();
+	void write(std::span<const uint8_t> data);
+	void write_block(std::span<const uint8_t> raw);
+public:
+	~demo_writer()
+	{
+		stop();
+	}
+	explicit operator bool() const
+	{
+		return static_cast<bool>(file);
+	}
+	void start(RAIIPHYSFS_File f, bool compressed);
+	void append(const void *data, std::size_t size);
+	void flush();
+	/* Write everything recorded, then close the file.  Returns false if
+	 * any write failed.
+	 */
+	bool stop();
+	/* Whether a write failed, as when the disk is full.  Everything
+	 * recorded after the failure is discarded.
+	 */
+	bool failed() const
+	{
+		return write_failed.load(std::memory_order_relaxed);
+	}
+};
+
+void demo_writer::start(RAIIPHYSFS_File f, const bool compressed)
+{
+	file = std::move(f);
+	if (!file)
+		return;
+	pending.clear();
+	buffer.clear();
+	block.clear();
+	stopping = false;
+	compress = compressed;
+	write_failed = compressed && (
+		PHYSFS_writeBytes(file, demo_compressed_magic.data(), demo_compressed_magic.size()) != static_cast<PHYSFS_sint64>(demo_compressed_magic.size()) ||
+		!PHYSFS_writeULE32(file, demo_block_size));
+	thread = std::thread([this] { run(); });
+}
+
+void demo_writer::account_queued()
+{
+	std::size_t bytes{};
+	for (auto &b : pending)
+		bytes += b.capacity();
+	for (auto &b : spare)
+		bytes += b.capacity();
+	queued_account.set(bytes);
+}
+
+void demo_writer::write(const std::span<const uint8_t> data)
+{
+	if (write_failed)
+		return;
+	if (!compress)
+	{
+		if (PHYSFS_writeBytes(file, data.data(), data.size()) != static_cast<PHYSFS_sint64>(data.size()))
+			write_failed = true;
+		return;
+	}
+	block.insert(block.end(), data.begin(), data.end());
+	std::size_t written = 0;
+	for (; block.size() - written >= demo_block_size; written += demo_block_size)
+		write_block(std::span(block).subspan(written, demo_block_size));
+	block.erase(block.begin(), std::next(block.begin(), written));
+	block_account.set(block.capacity() + packed.capacity());
+}
+
+void demo_writer::write_block(const std::span<const uint8_t> raw)
+{
+	packed.resize(lz_block_compress_bound(raw.size()));
+	const auto packed_size = lz_block_compress(raw, packed);
+	/* Keep the block as it is if compressing does not shrink it */
+	const auto data = packed_size < raw.size() ? std::span<const uint8_t>(packed).first(packed_size) : raw;
+	if (!PHYSFS_writeULE32(file, raw.size()) ||
+		!PHYSFS_writeULE32(file, data.size()) ||
+		PHYSFS_writeBytes(file, data.data(), data.size()) != static_cast<PHYSFS_sint64>(data.size()))
+		write_failed = true;
+}
+
+void demo_writer::run()
+{
+	std::unique_lock l{lock};
+	for (;;)
+	{
+		wake.wait(l, [this] { return !pending.empty() || stopping; });
+		if (pending.empty())
+		{
+			if (!block.empty() && !write_failed)
+				write_block(block);
+			return;
+		}
+		auto batch{std::exchange(pending, {})};
+		l.unlock();
+		for (auto &b : batch)
+		{
+			write(b);
+			b.clear();
+		}
+		l.lock();
+		for (auto &b : batch)
+			spare.emplace_back(std::move(b));
+		account_queued();
+	}
+}
+
+void demo_writer::append(const void *const data, const std::size_t size)
+{
+	const auto p = reinterpret_cast<const uint8_t *>(data);
+	buffer.insert(buffer.end(), p, p + size);
+	if (buffer.size() >= flush_size)
+		flush();
+	else
+		buffer_account.set(buffer.capacity());
+}
+
+void demo_writer::flush()
+{
+	if (buffer.empty() || !file)
+		return;
+	{
+		std::lock_guard l{lock};
+		pending.emplace_back(std::move(buffer));
+		if (spare.empty())
+			buffer = {};
+		else
+		{
+			buffer = std::move(spare.back());
+			spare.pop_back();
+		}
+		account_queued();
+	}
+	buffer_account.set(buffer.capacity());
+	wake.notify_one();
+}
+
+bool demo_writer::stop()
+{
+	if (!file)
+		return true;
+	flush();
+	{
+		std::lock_guard l{lock};
+		stopping = true;
+	}
+	wake.notify_one();
+	thread.join();
+	file.reset();
+	spare.clear();
+	account_queued();
+	block = {};
+	packed = {};
+	block_account.set(0);
+	return !write_failed;
+}
+
+/* Reads a demo, either as it is or through the blocks of a compressed
+ * demo.  Only the block holding the current offset is kept decompressed.
+ */
+class demo_reader
+{
+	RAIIPHYSFS_File file;
+	bool compress;
+	std::size_t block_size;
+	/* Where the header of each block starts in the file */
+	std::vector<PHYSFS_sint64> block_offsets;
+	PHYSFS_sint64 raw_length, position;
+	/* The decompressed block, and its index, or SIZE_MAX if none */
+	std::vector<uint8_t> block, packed;
+	mem_account_tracked block_account{mem_tag::demo};
+	std::size_t block_index;
+	bool load_block(std::size_t index);
+public:
+	explicit operator bool() const
+	{
+		return static_cast<bool>(file);
+	}
+	bool compressed() const
+	{
+		return compress;
+	}
+	void open(RAIIPHYSFS_File f);
+	void reset()
+	{
+		file.reset();
+		block_offsets.clear();
+		block = {};
+		packed = {};
+		block_account.set(0);
+	}
+	PHYSFS_sint64 read(void *buffer, std::size_t size);
+	PHYSFS_sint64 tell() const
+	{
+		return compress ? position : PHYSFS_tell(file);
+	}
+	void seek(PHYSFS_sint64 offset);
+	PHYSFS_sint64 length() const
+	{
+		return compress ? raw_length : PHYSFS_fileLength(file);
+	}
+	bool eof() const
+	{
+		return compress ? position >= raw_length : PHYSFS_eof(file);
+	}
+};
+
+void demo_reader::open(RAIIPHYSFS_File f)
+{
+	file = std::move(f);
+	compress = false;
+	block_offsets.clear();
+	block_index = SIZE_MAX;
+	if (!file)
+		return;
+	std::array<uint8_t, 4> magic;
+	PHYSFS_uint32 size;
+	if (PHYSFS_readBytes(file, magic.data(), magic.size()) != static_cast<PHYSFS_sint64>(magic.size()) || magic != demo_compressed_magic ||
+		!PHYSFS_readULE32(file, &size) || !size || size > demo_block_size * 16)
+	{
+		PHYSFS_seek(file, 0);
+		return;
+	}
+	compress = true;
+	block_size = size;
+	raw_length = position = 0;
+	/* Index the blocks.  A block cut short, as when the game stopped
+	 * while recording, ends the demo.
+	 */
+	const auto file_length = PHYSFS_fileLength(file);
+	for (;;)
+	{
+		const auto offset = PHYSFS_tell(file);
+		PHYSFS_uint32 raw_size, stored_size;
+		if (!PHYSFS_readULE32(file, &raw_size) || !PHYSFS_readULE32(file, &stored_size) ||
+			!raw_size || raw_size > block_size || stored_size > raw_size ||
+			offset + 8 + stored_size > file_length ||
+			!PHYSFS_seek(file, offset + 8 + stored_size))
+			break;
+		block_offsets.emplace_back(offset);
+		raw_length += raw_size;
+		if (raw_size != block_size)
+			break;
+	}
+}
+
+bool demo_reader::load_block(const std::size_t index)
+{
+	block_index = SIZE_MAX;
+	PHYSFS_uint32 raw_size, stored_size;
+	if (!PHYSFS_seek(file, block_offsets[index]) ||
+		!PHYSFS_readULE32(file, &raw_size) || !PHYSFS_readULE32(file, &stored_size))
+		return false;
+	block.resize(raw_size);
+	if (stored_size == raw_size)
+	{
+		if (PHYSFS_readBytes(file, block.data(), raw_size) != raw_size)
+			return false;
+	}
+	else
+	{
+		packed.resize(stored_size);
+		if (PHYSFS_readBytes(file, packed.data(), stored_size) != stored_size ||
+			!lz_block_decompress(packed, block))
+			return false;
+	}
+	block_account.set(block.capacity() + packed.capacity());
+	block_index = index;
+	return true;
+}
+
+PHYSFS_sint64 demo_reader::read(void *const buffer, const std::size_t size)
+{
+	if (!compress)
+		return PHYSFS_readBytes(file, buffer, size);
+	const auto out = static_cast<uint8_t *>(buffer);
+	std::size_t done = 0;
+	while (done != size && position < raw_length)
+	{
+		const std::size_t index = position / block_size;
+		if (index != block_index && !load_block(index))
+			break;
+		const std::size_t at = position % block_size;
+		const auto n = std::min(size - done, block.size() - at);
+		std::memcpy(out + done, block.data() + at, n);
+		done += n;
+		position += n;
+	}
+	return done;
+}
+
+void demo_reader::seek(const PHYSFS_sint64 offset)
+{
+	if (compress)
+		position = std::clamp<PHYSFS_sint64>(offset, 0, raw_length);
+	else
+		PHYSFS_seek(file, offset);
+}
+
+}
+
 // In- and Out-files
-static RAIIPHYSFS_File infile;
-static RAIIPHYSFS_File outfile;
+static demo_reader infile;
+static demo_writer outfile;
 
 namespace dcx {
 game_mode_flags Newdemo_game_mode;
@@ -178,6 +535,7 @@ int Newdemo_state{0};
 int Newdemo_vcr_state{0};
 int Newdemo_show_percentage{1};
 sbyte Newdemo_do_interpolate{1};
+bool Newdemo_timedemo;
 int Newdemo_num_written;
 #if DXX_BUILD_DESCENT == 2
 ubyte DemoDoRight{0},DemoDoLeft=0;
@@ -239,10 +597,10 @@ constexpr std::integral_constant<int, 0> shareware{};
 
 int newdemo_get_percent_done()	{
 	if ( Newdemo_state == ND_STATE_PLAYBACK ) {
-		return (PHYSFS_tell(infile) * 100) / nd_playback_v_demosize;
+		return (infile.tell() * 100) / nd_playback_v_demosize;
 	}
 	if ( Newdemo_state == ND_STATE_RECORDING ) {
-		return PHYSFS_tell(outfile);
+		return Newdemo_num_written;
 	}
 	return 0;
 }
@@ -282,8 +640,8 @@ static void my_extract_shortpos(object_base &objp, const shortpos *const spp)
 
 static int _newdemo_read(void *const buffer, const std::size_t elsize, const std::size_t nelem)
 {
-	const auto num_read{(PHYSFS_readBytes)(infile, buffer, elsize * nelem)};
-	if (num_read < nelem || PHYSFS_eof(infile))
+	const auto num_read{infile.read(buffer, elsize * nelem)};
+	if (num_read < nelem || infile.eof())
 		nd_playback_v_bad_read = -1;
 
 	return num_read;
@@ -314,23 +672,27 @@ namespace {
 
 static int _newdemo_write(const void *buffer, int elsize, int nelem )
 {
-	int num_written, total_size;
+	int total_size;
 
 	if (unlikely(nd_record_v_no_space))
 		return -1;
 
+	/* The writer thread found the disk full while writing an earlier
+	 * frame.
+	 */
+	if (unlikely(outfile.failed()))
+	{
+		nd_record_v_no_space=2;
+		newdemo_stop_recording();
+		return -1;
+	}
+
 	total_size = elsize * nelem;
 	nd_record_v_framebytes_written += total_size;
 	Newdemo_num_written += total_size;
 	Assert(outfile);
-	num_written = (PHYSFS_writeBytes)(outfile, buffer, elsize * nelem);
-
-	if (likely(num_written == nelem))
-		return num_written;
-
-	nd_record_v_no_space=2;
-	newdemo_stop_recording();
-	return -1;
+	outfile.append(buffer, total_size);
+	return nelem;
 }
 
 static int newdemo_write(const std::integral auto *buffer, int elsize, int nelem)
@@ -1185,6 +1547,8 @@ void newdemo_record_start_frame(fix frame_time )
 #endif
 		nd_record_v_frame_number -= nd_record_v_start_frame;
 
+		/* The previous frame is complete */
+		outfile.flush();
 		nd_write_byte(ND_EVENT_START_FRAME);
 		nd_write_short(nd_record_v_framebytes_written - 1);        // from previous frame
 		nd_record_v_framebytes_written=3;
@@ -2021,7 +2385,7 @@ static int newdemo_read_demo_start(const purpose_type purpose)
 			Primary_weapon = static_cast<primary_weapon_index>(Secondary_weapon.get_active());
 			Secondary_weapon = static_cast<secondary_weapon_index>(c);
 		} else
-			PHYSFS_seek(infile, PHYSFS_tell(infile) - 1);
+			infile.seek(infile.tell() - 1);
 	}
 #endif
 
@@ -2077,6 +2441,158 @@ static void newdemo_pop_ctrlcen_triggers()
 	}
 }
 
+namespace dsx {
+
+namespace {
+
+/* The demo file only records how the state changes from one frame to the
+ * next, so reaching a given frame means reading every frame before it.
+ * While a demo is read forward, keep a copy of the playback state every
+ * nd_keyframe_interval frames.  A seek restores the nearest copy before
+ * its target and reads forward from there.
+ */
+constexpr int nd_keyframe_interval = 300;
+
+struct nd_keyframe_segment
+{
+	segnum_t segnum;
+	unique_segment useg;
+};
+
+struct nd_keyframe
+{
+	PHYSFS_sint64 offset;
+	int framecount;
+	int level;
+	unsigned object_count;
+	std::vector<object> objects;
+	std::array<player, MAX_PLAYERS> players;
+	std::vector<wall> walls;
+	std::vector<active_door> active_doors;
+#if DXX_BUILD_DESCENT == 2
+	std::vector<cloaking_wall> cloaking_walls;
+#endif
+	/* Only the segments that differ from the baseline of the level */
+	std::vector<nd_keyframe_segment> segments;
+	sbyte cntrlcen_destroyed;
+	ubyte dead, rear;
+#if DXX_BUILD_DESCENT == 2
+	ubyte guided;
+#endif
+};
+
+/* Ordered by file offset */
+std::vector<nd_keyframe> nd_keyframes;
+/* The segments of each level as they were when its first keyframe was
+ * taken.  Keyframes store only their differences from this.
+ */
+std::map<int, std::vector<unique_segment>> nd_keyframe_baselines;
+/* Set while the playback state is exactly the state the recording had at
+ * the current frame.  Reading backward does not undo every event, and
+ * jumping to the end skips them, so neither leaves a state worth keeping.
+ */
+uint8_t nd_keyframe_exact;
+
+void newdemo_clear_keyframes()
+{
+	nd_keyframes.clear();
+	nd_keyframe_baselines.clear();
+}
+
+bool nd_segment_differs(const unique_segment &a, const unique_segment &b)
+{
+	return a.light_subtracted != b.light_subtracted || a.static_light != b.static_light || std::memcmp(&a.sides, &b.sides, sizeof(a.sides));
+}
+
+void newdemo_take_keyframe()
+{
+	const auto offset = infile.tell();
+	const auto next = std::find_if(nd_keyframes.begin(), nd_keyframes.end(), [offset](const nd_keyframe &k) { return k.offset >= offset; });
+	if (next != nd_keyframes.end() && next->framecount < nd_playback_v_framecount + nd_keyframe_interval)
+		return;
+	if ((next == nd_keyframes.begin() ? 0 : std::prev(next)->framecount) + nd_keyframe_interval > nd_playback_v_framecount)
+		return;
+	auto &Objects = LevelUniqueObjectState.Objects;
+	auto &Walls = LevelUniqueWallSubsystemState.Walls;
+	auto &ActiveDoors = LevelUniqueWallSubsystemState.ActiveDoors;
+	auto &baseline = nd_keyframe_baselines[Current_level_num];
+	if (baseline.empty())
+		for (const unique_segment &useg : vcsegptr)
+			baseline.emplace_back(useg);
+	nd_keyframe k{
+		.offset = offset,
+		.framecount = nd_playback_v_framecount,
+		.level = Current_level_num,
+		.object_count = Objects.get_count(),
+		.objects = std::vector<object>(Objects.begin(), Objects.end()),
+		.players = {},
+		.walls = std::vector<wall>(Walls.begin(), Walls.begin() + Walls.get_count()),
+		.active_doors = std::vector<active_door>(ActiveDoors.begin(), ActiveDoors.begin() + ActiveDoors.get_count()),
+#if DXX_BUILD_DESCENT == 2
+		.cloaking_walls = std::vector<cloaking_wall>(LevelUniqueWallSubsystemState.CloakingWalls.begin(), LevelUniqueWallSubsystemState.CloakingWalls.begin() + LevelUniqueWallSubsystemState.CloakingWalls.get_count()),
+#endif
+		.segments = {},
+		.cntrlcen_destroyed = nd_playback_v_cntrlcen_destroyed,
+		.dead = nd_playback_v_dead,
+		.rear = nd_playback_v_rear,
+#if DXX_BUILD_DESCENT == 2
+		.guided = nd_playback_v_guided,
+#endif
+	};
+	std::copy(Players.begin(), Players.end(), k.players.begin());
+	auto b = baseline.begin();
+	std::size_t segnum = 0;
+	for (const unique_segment &useg : vcsegptr)
+	{
+		if (nd_segment_differs(useg, *b))
+			k.segments.push_back({static_cast<segnum_t>(segnum), useg});
+		++b;
+		++segnum;
+	}
+	nd_keyframes.insert(next, std::move(k));
+}
+
+void newdemo_restore_keyframe(const nd_keyframe &k)
+{
+	auto &Objects = LevelUniqueObjectState.Objects;
+	auto &Walls = LevelUniqueWallSubsystemState.Walls;
+	auto &ActiveDoors = LevelUniqueWallSubsystemState.ActiveDoors;
+	std::copy(k.objects.begin(), k.objects.end(), Objects.begin());
+	Objects.set_count(k.object_count);
+	std::copy(k.players.begin(), k.players.end(), Players.begin());
+	std::copy(k.walls.begin(), k.walls.end(), Walls.begin());
+	Walls.set_count(k.walls.size());
+	std::copy(k.active_doors.begin(), k.active_doors.end(), ActiveDoors.begin());
+	ActiveDoors.set_count(k.active_doors.size());
+#if DXX_BUILD_DESCENT == 2
+	auto &CloakingWalls = LevelUniqueWallSubsystemState.CloakingWalls;
+	std::copy(k.cloaking_walls.begin(), k.cloaking_walls.end(), CloakingWalls.begin());
+	CloakingWalls.set_count(k.cloaking_walls.size());
+#endif
+	auto b = nd_keyframe_baselines[k.level].begin();
+	for (unique_segment &useg : vmsegptr)
+		useg = *b++;
+	for (auto &s : k.segments)
+	{
+		unique_segment &useg = *vmsegptr(s.segnum);
+		useg = s.useg;
+	}
+	nd_playback_v_cntrlcen_destroyed = k.cntrlcen_destroyed;
+	nd_playback_v_dead = k.dead;
+	nd_playback_v_rear = k.rear;
+#if DXX_BUILD_DESCENT == 2
+	nd_playback_v_guided = k.guided;
+#endif
+	nd_playback_v_framecount = k.framecount;
+	nd_playback_v_at_eof = 0;
+	infile.seek(k.offset);
+	nd_keyframe_exact = 1;
+}
+
+}
+
+}
+
 namespace dsx {
 static int newdemo_read_frame_information(int rewrite)
 {
@@ -2090,6 +2606,8 @@ static int newdemo_read_frame_information(int rewrite)
 
 	done = 0;
 
+	if (!rewrite && (Newdemo_vcr_state == ND_STATE_REWINDING || Newdemo_vcr_state == ND_STATE_ONEFRAMEBACKWARD))
+		nd_keyframe_exact = 0;
 	if (Newdemo_vcr_state != ND_STATE_PAUSED)
 		for (unique_segment &useg : vmsegptr)
 		{
@@ -3317,6 +3835,7 @@ static int newdemo_read_frame_information(int rewrite)
 				unsigned num_walls;
 				nd_read_int (&num_walls);
 				Walls.set_count(num_walls);
+				++LevelUniqueWallSubsystemState.change_count;
 				if (rewrite)
 					nd_write_int (Walls.get_count());
 				for (auto &w : vmwallptr)
@@ -3375,7 +3894,7 @@ static int newdemo_read_frame_information(int rewrite)
 
 		case ND_EVENT_EOF: {
 			done=-1;
-			PHYSFS_seek(infile, PHYSFS_tell(infile) - 1);        // get back to the EOF marker
+			infile.seek(infile.tell() - 1);        // get back to the EOF marker
 			nd_playback_v_at_eof = 1;
 			nd_playback_v_framecount++;
 			break;
@@ -3420,6 +3939,8 @@ static int newdemo_read_frame_information(int rewrite)
 		nm_messagebox(menu_title{nullptr}, {TXT_OK}, "%s %s", TXT_DEMO_ERR_READING, TXT_DEMO_OLD_CORRUPT);
 		Current_mission.reset();
 	}
+	else if (done == 1 && !rewrite && nd_keyframe_exact && (Newdemo_vcr_state == ND_STATE_PLAYBACK || Newdemo_vcr_state == ND_STATE_FASTFORWARD))
+		newdemo_take_keyframe();
 
 	return done;
 }
@@ -3429,10 +3950,11 @@ window_event_result newdemo_goto_beginning()
 {
 	//if (nd_playback_v_framecount == 0)
 	//	return;
-	PHYSFS_seek(infile, 0);
+	infile.seek(0);
 	Newdemo_vcr_state = ND_STATE_PLAYBACK;
 	if (newdemo_read_demo_start(purpose_type::chose_play))
 		newdemo_stop_playback();
+	nd_keyframe_exact = 1;
 	if (newdemo_read_frame_information(0) == -1)
 		newdemo_stop_playback();
 	if (newdemo_read_frame_information(0) == -1)
@@ -3454,7 +3976,8 @@ window_event_result newdemo_goto_end(int to_rewrite)
 	ubyte energy{0}, shield=0;
 	int loc{0}, bint=0;
 
-	PHYSFSX_fseek(infile, -2, SEEK_END);
+	nd_keyframe_exact = 0;
+	infile.seek(infile.length() - 2);
 	nd_read_byte(&level);
 
 	if (!to_rewrite)
@@ -3484,7 +4007,7 @@ window_event_result newdemo_goto_end(int to_rewrite)
 	if (shareware)
 	{
 		if (+(Newdemo_game_mode & GM_MULTI)) {
-			PHYSFSX_fseek(infile, -10, SEEK_END);
+			infile.seek(infile.length() - 10);
 			nd_read_byte(&cloaked);
 			for (playernum_t i = 0; i < MAX_PLAYERS; i++)
 			{
@@ -3501,18 +4024,18 @@ window_event_result newdemo_goto_end(int to_rewrite)
 		if (to_rewrite)
 			return window_event_result::handled;
 
-		PHYSFSX_fseek(infile, -12, SEEK_END);
+		infile.seek(infile.length() - 12);
 		nd_read_short(&frame_length);
 	}
 	else
 #endif
 	{
-	PHYSFSX_fseek(infile, -4, SEEK_END);
+	infile.seek(infile.length() - 4);
 	nd_read_short(&byte_count);
-	PHYSFSX_fseek(infile, -2 - byte_count, SEEK_CUR);
+	infile.seek(infile.tell() - 2 - byte_count);
 
 	nd_read_short(&frame_length);
-	loc = PHYSFS_tell(infile);
+	loc = infile.tell();
 	if (+(Newdemo_game_mode & GM_MULTI))
 	{
 		nd_read_byte(&cloaked);
@@ -3599,12 +4122,12 @@ window_event_result newdemo_goto_end(int to_rewrite)
 	if (to_rewrite)
 		return window_event_result::handled;
 
-	PHYSFS_seek(infile, loc);
+	infile.seek(loc);
 	}
-	PHYSFSX_fseek(infile, -frame_length, SEEK_CUR);
+	infile.seek(infile.tell() - frame_length);
 	nd_read_int(&nd_playback_v_framecount);            // get the frame count
 	nd_playback_v_framecount--;
-	PHYSFSX_fseek(infile, 4, SEEK_CUR);
+	infile.seek(infile.tell() + 4);
 	Newdemo_vcr_state = ND_STATE_PLAYBACK;
 	newdemo_read_frame_information(0); // then the frame information
 	Newdemo_vcr_state = ND_STATE_PAUSED;
@@ -3612,14 +4135,54 @@ window_event_result newdemo_goto_end(int to_rewrite)
 }
 }
 
+namespace dsx {
+window_event_result newdemo_seek(const int seconds)
+{
+	/* Frames are recorded at most once every REC_DELAY */
+	const int target = std::max(nd_playback_v_framecount + seconds * (F1_0 / (REC_DELAY)), 0);
+	const auto vcr_state = Newdemo_vcr_state;
+	const nd_keyframe *best = nullptr;
+	for (auto &k : nd_keyframes)
+	{
+		if (k.framecount >= target)
+			break;
+		if (k.level == Current_level_num)
+			best = &k;
+	}
+	if (best && (target < nd_playback_v_framecount || best->framecount > nd_playback_v_framecount || !nd_keyframe_exact))
+		newdemo_restore_keyframe(*best);
+	else if (target < nd_playback_v_framecount)
+	{
+		if (newdemo_goto_beginning() == window_event_result::close)
+			return window_event_result::close;
+	}
+	/* Reading fast forward skips the sounds of the frames passed over */
+	Newdemo_vcr_state = ND_STATE_FASTFORWARD;
+	while (nd_playback_v_framecount < target && !nd_playback_v_at_eof)
+	{
+		if (newdemo_read_frame_information(0) == -1)
+		{
+			if (nd_playback_v_at_eof)
+				break;
+			newdemo_stop_playback();
+			return window_event_result::close;
+		}
+	}
+	Newdemo_vcr_state = vcr_state == ND_STATE_PLAYBACK ? ND_STATE_PLAYBACK : ND_STATE_PAUSED;
+	nd_playback_v_style = NORMAL_PLAYBACK;
+	nd_playback_total = nd_recorded_total;
+	return window_event_result::handled;
+}
+}
+
 static window_event_result newdemo_back_frames(int frames)
 {
 	short last_frame_length;
 	for (int i = 0; i < frames; i++)
 	{
-		PHYSFS_seek(infile, PHYSFS_tell(infile) - 10);
+		infile.seek(infile.tell() - 10);
 		nd_read_short(&last_frame_length);
-		PHYSFS_seek(infile, PHYSFS_tell(infile) + 8 - last_frame_length);
+		infile.seek(infile.tell() + 8 - last_frame_length);
 
 		if (!nd_playback_v_at_eof && newdemo_read_frame_information(0) == -1) {
 			newdemo_stop_playback();
@@ -3628,9 +4191,9 @@ static window_event_result newdemo_back_frames(int frames)
 		if (nd_playback_v_at_eof)
 			nd_playback_v_at_eof = 0;
 
-		PHYSFS_seek(infile, PHYSFS_tell(infile) - 10);
+		infile.seek(infile.tell() - 10);
 		nd_read_short(&last_frame_length);
-		PHYSFS_seek(infile, PHYSFS_tell(infile) + 8 - last_frame_length);
+		infile.seek(infile.tell() + 8 - last_frame_length);
 	}
 
 	return window_event_result::handled;
@@ -3747,6 +4310,42 @@ static window_event_result interpolate_frame(fix d_play, fix d_recorded)
 	return result;
 }
 
+namespace {
+
+/* How long each frame of a time demo took, from the end of one to the end
+ * of the next.  The frames that load a level are left out.
+ */
+struct timedemo_times
+{
+	std::chrono::steady_clock::time_point last;
+	std::vector<std::chrono::steady_clock::duration> frames;
+};
+
+timedemo_times timedemo;
+
+void newdemo_timedemo_report()
+{
+	auto &frames = timedemo.frames;
+	if (frames.empty())
+		con_printf(CON_URGENT, "Time demo: no frames played");
+	else
+	{
+		using ms = std::chrono::duration<double, std::milli>;
+		const ms total = std::accumulate(frames.begin(), frames.end(), std::chrono::steady_clock::duration{});
+		std::sort(frames.begin(), frames.end());
+		const auto percentile = [&frames](const unsigned p) {
+			return ms(frames[(frames.size() - 1) * p / 100]).count();
+		};
+		const auto n = frames.size();
+		con_printf(CON_URGENT, "Time demo: %zu frames in %.2fs, %.1f fps; frame time avg %.3fms, p95 %.3fms, p99 %.3fms, max %.3fms", n, total.count() / 1000, n * 1000 / total.count(), total.count() / n, percentile(95), percentile(99), ms(frames.back()).count());
+	}
+	frames = {};
+	Newdemo_timedemo = false;
+	cmd_append("quit");
+}
+
+}
+
 window_event_result newdemo_playback_one_frame()
 {
 	auto &LevelUniqueControlCenterState = LevelUniqueObjectState.ControlCenterState;
@@ -3787,7 +4386,7 @@ window_event_result newdemo_playback_one_frame()
 		else
 			frames_back = 1;
 		if (nd_playback_v_at_eof) {
-			PHYSFS_seek(infile, PHYSFS_tell(infile) + (shareware ? -2 : +11));
+			infile.seek(infile.tell() + (shareware ? -2 : +11));
 		}
 		result = newdemo_back_frames(frames_back);
 
@@ -3845,6 +4444,19 @@ window_event_result newdemo_playback_one_frame()
 		} else
 			Newdemo_vcr_state = ND_STATE_PAUSED;
 	}
+	else if (Newdemo_timedemo)
+	{
+		const int level = Current_level_num;
+		if (newdemo_read_frame_information(0) == -1)
+		{
+			newdemo_stop_playback();
+			return window_event_result::close;
+		}
+		const auto now = std::chrono::steady_clock::now();
+		if (level == Current_level_num && nd_playback_v_framecount > 1)
+			timedemo.frames.emplace_back(now - timedemo.last);
+		timedemo.last = now;
+	}
 	else {
 
 		//  First, uptate the total playback time to date.  Then we check to see
@@ -3950,7 +4562,7 @@ void newdemo_start_recording()
 	PHYSFS_mkdir(DEMO_DIR); //always try making directory - could only exist in read-only path
 
 	auto &&[o, physfserr] = PHYSFSX_openWriteBuffered(DEMO_FILENAME);
-	outfile = std::move(o);
+	outfile.start(std::move(o), CGameArg.SysCompressDemo);
 	if (!outfile)
 	{
 		Newdemo_state = ND_STATE_NORMAL;
@@ -4148,7 +4760,9 @@ void newdemo_stop_recording()
 		newdemo_write_end();
 	}
 
-	outfile.reset();
+	/* The last frames may only now find the disk full */
+	if (!outfile.stop() && !nd_record_v_no_space)
+		nd_record_v_no_space = 2;
 	Newdemo_state = ND_STATE_NORMAL;
 	gr_palette_load( gr_palette );
 try_again:
@@ -4270,7 +4884,7 @@ void newdemo_start_playback(const char * filename)
 		}
 	}
 
-	infile = PHYSFSX_openReadBuffered_updateCase(filename2).first;
+	infile.open(PHYSFSX_openReadBuffered_updateCase(filename2).first);
 
 	if (!infile) {
 		return;
@@ -4291,11 +4905,13 @@ void newdemo_start_playback(const char * filename)
 	Game_mode = GM_NORMAL;
 	Newdemo_state = ND_STATE_PLAYBACK;
 	Newdemo_vcr_state = ND_STATE_PLAYBACK;
-	nd_playback_v_demosize = PHYSFS_fileLength(infile);
+	nd_playback_v_demosize = infile.length();
 	nd_playback_v_bad_read = 0;
 	nd_playback_v_at_eof = 0;
 	nd_playback_v_framecount = 0;
 	nd_playback_v_style = NORMAL_PLAYBACK;
+	newdemo_clear_keyframes();
+	nd_keyframe_exact = 1;
 #if DXX_BUILD_DESCENT == 2
 	init_seismic_disturbances();
 	//turn off 3d views on cockpit
@@ -4317,12 +4933,28 @@ void newdemo_start_playback(const char * filename)
 		Game_wind = game_setup();							// create game environment
 }
 
+void newdemo_start_timedemo(const char *const filename)
+{
+	Newdemo_timedemo = true;
+	timedemo.frames.clear();
+	newdemo_start_playback(filename);
+	if (Newdemo_state != ND_STATE_PLAYBACK)
+	{
+		con_printf(CON_URGENT, "Time demo: cannot play \"%s\"", filename);
+		Newdemo_timedemo = false;
+		cmd_append("quit");
+	}
+}
+
 }
 
 namespace dsx {
 void newdemo_stop_playback()
 {
 	infile.reset();
+	newdemo_clear_keyframes();
+	if (Newdemo_timedemo)
+		newdemo_timedemo_report();
 	Newdemo_state = ND_STATE_NORMAL;
 	change_playernum_to(0);             //this is reality
 	get_local_player().callsign = nd_playback_v_save_callsign;
@@ -4348,12 +4980,12 @@ int newdemo_swap_endian(const char *filename)
 	else
 		return 0;
 
-	infile = PHYSFSX_openReadBuffered_updateCase(inpath).first;
+	infile.open(PHYSFSX_openReadBuffered_updateCase(inpath).first);
 	if (!infile)
 		goto read_error;
 
-	nd_playback_v_demosize = PHYSFS_fileLength(infile);	// should be exactly the same size
-	outfile = PHYSFSX_openWriteBuffered(DEMO_FILENAME).first;
+	nd_playback_v_demosize = infile.length();	// should be exactly the same size
+	outfile.start(PHYSFSX_openWriteBuffered(DEMO_FILENAME).first, infile.compressed());
 	if (!outfile)
 	{
 		infile.reset();
@@ -4369,7 +5001,7 @@ int newdemo_swap_endian(const char *filename)
 	if (newdemo_read_demo_start(purpose_type::rewrite))
 	{
 		infile.reset();
-		outfile.reset();
+		outfile.stop();
 		swap_endian = 0;
 		return 0;
 	}
@@ -4380,9 +5012,8 @@ int newdemo_swap_endian(const char *filename)
 	newdemo_write_end();	// and write it
 
 	swap_endian = 0;
-	complete = nd_playback_v_demosize == Newdemo_num_written;
+	complete = outfile.stop() && nd_playback_v_demosize == Newdemo_num_written;
 	infile.reset();
-	outfile.reset();
 
 	std::array<char, PATH_MAX> bakpath;
 	if (complete && change_filename_extension(bakpath, inpath, DEMO_BACKUP_EXT))
@@ -71,6 +71,12 @@ namespace dcx {
 
 namespace {
 
+/* The input cursor blinks every 0x8000 of timer_query, about half a
+ * second, and held mouse buttons scroll every fifth of a second, so an
+ * idle menu wakes a few times for each.
+ */
+constexpr unsigned newmenu_idle_wait = 125;
+
 struct callback_newmenu : newmenu
 {
 	callback_newmenu(const menu_title title, const menu_subtitle subtitle, const menu_filename filename, const tiny_mode_flag tiny_mode, const tab_processing_flag tabs_flag, const adjusted_citem citem_init, grs_canvas &src, subfunction_type subfunction, void *userdata) :
@@ -81,6 +87,11 @@ struct callback_newmenu : newmenu
 	const subfunction_type subfunction;
 	void *const userdata;		// For whatever - like with window system
 	virtual window_event_result event_handler(const d_event &) override;
+	/* The subfunction may poll the network or animate on idle */
+	virtual unsigned get_idle_wait() const override
+	{
+		return subfunction ? 0 : newmenu::get_idle_wait();
+	}
 };
 
 struct step_down
@@ -1622,6 +1633,12 @@ void newmenu_layout::create_structure()
 
 }
 
+unsigned newmenu::get_idle_wait() const
+{
+	// A multiplayer game underneath must keep running
+	return +(Game_mode & GM_MULTI) ? 0 : newmenu_idle_wait;
+}
+
 window_event_result newmenu::event_handler(const d_event &event)
 {
 #if DXX_MAX_BUTTONS_PER_JOYSTICK
@@ -2164,6 +2181,12 @@ static window_event_result listbox_draw(listbox *lb)
 
 }
 
+unsigned listbox::get_idle_wait() const
+{
+	// The marquee scrolls a title which is too wide
+	return (marquee || +(Game_mode & GM_MULTI)) ? 0 : newmenu_idle_wait;
+}
+
 window_event_result listbox::event_handler(const d_event &event)
 {
 	if (const auto rval = callback_handler(event, window_event_result::ignored); rval != window_event_result::ignored)
@@ -24,7 +24,10 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  */
 
 #include <algorithm>
+#include <bitset>
+#include <cstddef>
 #include <cstdlib>
+#include <span>
 #include <stdio.h>
 
 #include "inferno.h"
@@ -48,6 +51,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "robot.h"
 #include "interp.h"
 #include "fireball.h"
+#include "particle.h"
 #include "laser.h"
 #include "dxxerror.h"
 #include "ai.h"
@@ -71,6 +75,9 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "gameseq.h"
 #include "playsave.h"
 #include "timer.h"
+#include "args.h"
+#include "parallel.h"
+#include "frame_profile.h"
 #if DXX_USE_EDITOR
 #include "editor/editor.h"
 #endif
@@ -249,10 +256,6 @@ namespace dsx {
 //draw an object that has one bitmap & doesn't rotate
 void draw_object_blob(GameBitmaps_array &GameBitmaps, const object_base &Viewer, grs_canvas &canvas, const object_base &obj, const bitmap_index bmi)
 {
-	auto &bm = GameBitmaps[bmi];
-	PIGGY_PAGE_IN( bmi );
-
-	const auto osize{obj.size};
 	// draw these with slight offset to viewer preventing too much ugly clipping
 	auto pos = obj.pos;
 	if (obj.type == OBJ_FIREBALL && get_fireball_id(obj) == vclip_index::volatile_wall_hit)
@@ -261,6 +264,13 @@ void draw_object_blob(GameBitmaps_array &GameBitmaps, const object_base &Viewer,
 		vm_vec_normalized_dir_quick(offs_vec, Viewer.pos, pos);
 		vm_vec_scale_add2(pos,offs_vec,F1_0);
 	}
+	draw_blob(GameBitmaps, canvas, pos, obj.size, bmi);
+}
+
+void draw_blob(GameBitmaps_array &GameBitmaps, grs_canvas &canvas, const vms_vector &pos, const fix osize, const bitmap_index bmi)
+{
+	auto &bm = GameBitmaps[bmi];
+	PIGGY_PAGE_IN( bmi );
 
 	using wh = std::pair<fix, fix>;
 	const auto bm_w = bm.bm_w;
@@ -960,9 +970,10 @@ void init_objects()
 {
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &vmobjptr = Objects.vmptr;
+	LevelUniqueObjectState.free_objects.free_all();
+	LevelUniqueObjectState.free_objects.set_used(0);
 	for (objnum_t i = 0; i< MAX_OBJECTS; ++i)
 	{
-		LevelUniqueObjectState.free_obj_list[i] = i;
 		auto &obj = *vmobjptr(i);
 		DXX_POISON_VAR(obj, 0xfd);
 		obj.type = OBJ_NONE;
@@ -990,7 +1001,7 @@ void special_reset_objects(d_level_unique_object_state &LevelUniqueObjectState,
 	Objects.set_count(1);
 	assert(Objects.front().type != OBJ_NONE);		//0 should be used
 
-	DXX_POISON_VAR(LevelUniqueObjectState.free_obj_list, 0xfd);
+	LevelUniqueObjectState.free_objects.use_all();
 #if DXX_BUILD_DESCENT == 1
 	/* Descent 1 does not have a guidebot, so there is nothing to fix up.  For
 	 * simplicity, both games pass the parameter.
@@ -1011,7 +1022,10 @@ void special_reset_objects(d_level_unique_object_state &LevelUniqueObjectState,
 		}
 #endif
 		if (obj.type == OBJ_NONE)
-			LevelUniqueObjectState.free_obj_list[--num_objects] = i;
+		{
+			--num_objects;
+			LevelUniqueObjectState.free_objects.set_free(i);
+		}
 		else
 			if (i > Highest_object_index)
 				Objects.set_count(i + 1);
@@ -1022,8 +1036,56 @@ void special_reset_objects(d_level_unique_object_state &LevelUniqueObjectState,
 	LevelUniqueObjectState.num_objects = num_objects;
 }
 
+object_hot_fields Object_hot_fields;
+
+void object_hot_fields::update(const vcobjptridx_t obj)
+{
+	const auto i{obj.get_unchecked_index()};
+	type[i] = obj->type;
+	signature[i] = obj->signature;
+	segnum[i] = obj->segnum;
+}
+
+void object_hot_fields::refresh(const object_array &Objects)
+{
+	for (const auto &&objp : Objects.vcptridx)
+		update(objp);
+	/* Slots past the highest object are unused */
+	std::fill(std::next(type.begin(), Objects.get_count()), type.end(), OBJ_NONE);
+}
+
+segment_object_index Segment_object_index;
+
+void segment_object_index::link(const vcsegptridx_t segnum, const objnum_t objnum)
+{
+	auto &v = objects[segnum];
+	const unique_segment &useg = segnum;
+	if (useg.objects == object_none)
+		v.clear();
+	v.insert(v.begin(), objnum);
+}
+
+void segment_object_index::unlink(const segnum_t segnum, const objnum_t objnum)
+{
+	auto &v = objects[segnum];
+	if (const auto i = std::ranges::find(v, objnum); i != v.end())
+		v.erase(i);
+}
+
+std::span<const objnum_t> segment_object_index::in(const vcsegptridx_t segnum) const
+{
+	const unique_segment &useg = segnum;
+	if (useg.objects == object_none)
+		return {};
+	return objects[segnum];
+}
+
 void obj_link_unchecked(fvmobjptr &vmobjptr, const vmobjptridx_t obj, const vmsegptridx_t segnum)
 {
+	/* Before the link, so that the index can see whether the segment's
+	 * list was empty.
+	 */
+	Segment_object_index.link(segnum, obj);
 	obj->segnum = segnum;
 	unique_segment &useg = segnum;
 	obj->next = std::exchange(useg.objects, obj);
@@ -1031,10 +1093,12 @@ void obj_link_unchecked(fvmobjptr &vmobjptr, const vmobjptridx_t obj, const vmse
 
 	if (obj->next != object_none)
 		vmobjptr(obj->next)->prev = obj;
+	Object_hot_fields.update(obj);
 }
 
 void obj_unlink(fvmobjptr &vmobjptr, fvmsegptr &vmsegptr, object_base &obj)
 {
+	Segment_object_index.unlink(obj.segnum, static_cast<objnum_t>(&static_cast<const object &>(obj) - &LevelUniqueObjectState.Objects.front()));
 	const auto next{obj.next};
 	/* It is a bug elsewhere if vmsegptr ever fails here.  However, it is
 	 * expensive to check, so only force verification in debug builds.
@@ -1075,7 +1139,9 @@ imobjptridx_t obj_allocate(d_level_unique_object_state &LevelUniqueObjectState)
 	if (LevelUniqueObjectState.num_objects >= Objects.size())
 		return object_none;
 
-	const auto objnum = LevelUniqueObjectState.free_obj_list[LevelUniqueObjectState.num_objects++];
+	const objnum_t objnum = LevelUniqueObjectState.free_objects.first_free();
+	LevelUniqueObjectState.free_objects.set_used(objnum);
+	++LevelUniqueObjectState.num_objects;
 	if (objnum >= Objects.get_count())
 	{
 		Objects.set_count(objnum + 1);
@@ -1092,23 +1158,20 @@ namespace {
 //the object has been unlinked
 static void obj_free(d_level_unique_object_state &LevelUniqueObjectState, const vmobjidx_t objnum)
 {
-	const auto num_objects = -- LevelUniqueObjectState.num_objects;
-	assert(num_objects < LevelUniqueObjectState.free_obj_list.size());
-	LevelUniqueObjectState.free_obj_list[num_objects] = objnum;
+	assert(LevelUniqueObjectState.num_objects > 0);
+	-- LevelUniqueObjectState.num_objects;
+	auto &free_objects = LevelUniqueObjectState.free_objects;
+	assert(!free_objects.is_free(objnum));
+	free_objects.set_free(objnum);
 	auto &Objects = LevelUniqueObjectState.get_objects();
 
-	objnum_t o = objnum;
-	if (o == Highest_object_index)
+	if (objnum == static_cast<objnum_t>(Highest_object_index))
 	{
-		for (;;)
-		{
-			--o;
-			if (Objects.vcptr(o)->type != OBJ_NONE)
-				break;
-			if (o == 0)
-				break;
-		}
-		Objects.set_count(o + 1);
+		/* Slot 0 is kept as the count floor even when it is free, as
+		 * the walk over the objects did before.
+		 */
+		const auto o = free_objects.last_used();
+		Objects.set_count(o < free_objects.size() ? o + 1 : 1);
 	}
 }
 
@@ -1234,6 +1297,8 @@ imobjptridx_t obj_create(d_level_unique_object_state &LevelUniqueObjectState, co
 
 	if (obj == object_none)		//no free objects
 		return object_none;
+	MultiLevelInv_ObjectChanged(obj.get_unchecked_index());
+	multi_world_checksum_object_changed(obj.get_unchecked_index());
 
 	// Zero out object structure to keep weird bugs from happening
 	// in uninitialized fields.
@@ -1402,6 +1467,9 @@ void obj_delete(d_level_unique_object_state &LevelUniqueObjectState, segment_arr
 	 * until that happens.
 	 */
 	obj->signature = signature;
+	Object_hot_fields.type[obj.get_unchecked_index()] = OBJ_NONE;
+	MultiLevelInv_ObjectChanged(obj.get_unchecked_index());
+	multi_world_checksum_object_changed(obj.get_unchecked_index());
 	obj_free(LevelUniqueObjectState, obj);
 }
 
@@ -1447,6 +1515,7 @@ void dead_player_end(void)
 	select_cockpit(PlayerCfg.CockpitMode[0]);
 	Viewer = Viewer_save;
 	ConsoleObject->type = OBJ_PLAYER;
+	Object_hot_fields.update(vmobjptridx(ConsoleObject));
 	ConsoleObject->flags = Player_flags_save;
 
 	assert(Control_type_save == object::control_type::flying || Control_type_save == object::control_type::slew);
@@ -1595,6 +1664,7 @@ window_event_result dead_player_frame(const d_robot_info_array &Robot_info)
 				ConsoleObject->flags &= ~OF_SHOULD_BE_DEAD;		//don't really kill player
 				ConsoleObject->render_type = render_type::RT_NONE;				//..just make him disappear
 				ConsoleObject->type = OBJ_GHOST;						//..and kill intersections
+				Object_hot_fields.update(cobjp);
 #if DXX_BUILD_DESCENT == 2
 				player_info.powerup_flags &= ~PLAYER_FLAGS_HEADLIGHT_ON;
 #endif
@@ -1726,6 +1796,8 @@ static void obj_delete_all_that_should_be_dead()
 	auto &vmobjptridx = Objects.vmptridx;
 	objnum_t		local_dead_player_object=object_none;
 
+	Object_hot_fields.refresh(Objects);
+
 	// Move all objects
 	range_for (const auto &&objp, vmobjptridx)
 	{
@@ -1756,6 +1828,7 @@ void obj_relink(fvmobjptr &vmobjptr, fvmsegptr &vmsegptr, const vmobjptridx_t ob
 {
 	obj_unlink(vmobjptr, vmsegptr, objnum);
 	obj_link_unchecked(vmobjptr, objnum, newsegnum);
+	multi_world_checksum_object_changed(objnum.get_unchecked_index());
 }
 
 // for getting out of messed up linking situations (i.e. caused by demo playback)
@@ -1863,6 +1936,101 @@ namespace {
 
 //--------------------------------------------------------------------
 //move an object for the current frame
+//	The objects object_move_all has already animated this frame, and those
+//	of them it has also spun, by signature so that an object created in a
+//	freed slot during the frame is still moved in full.
+static std::array<object_signature_t, MAX_OBJECTS> Object_independent_signature;
+static std::bitset<MAX_OBJECTS> Object_independent_done, Object_independent_spun;
+
+//	Below this many objects, the calls take less time than waking the
+//	worker threads.
+constexpr std::size_t object_independent_parallel_threshold = 256;
+constexpr std::size_t object_independent_batch = 64;
+
+static void count_down_lifeleft(object_base &obj)
+{
+	auto lifeleft = obj.lifeleft;
+	if (lifeleft != IMMORTAL_TIME) //if not immortal...
+	{
+		lifeleft -= FrameTime; //...inevitable countdown towards death
+#if DXX_BUILD_DESCENT == 2
+		if (obj.type == OBJ_MARKER)
+		{
+			if (lifeleft < F1_0*1000)
+				lifeleft += F1_0; // Make sure this object doesn't go out.
+		}
+#endif
+		obj.lifeleft = lifeleft;
+	}
+}
+
+//	Whether an object is spun in the pre-pass: no control code turns it,
+//	and it will not die of old age this frame.  The countdown itself stays
+//	in the serial pass, since a collision there can set the life of any
+//	object.  If that shortens the life, the object is deleted at the end
+//	of the frame, so the spin does not matter; if it lengthens it, the
+//	serial pass spins the object.
+static bool object_spins_independently(const object_base &obj)
+{
+	const auto control{obj.control_source};
+	return obj.movement_source == object::movement_type::spinning && obj.lifeleft >= FrameTime &&
+		(control == object::control_type::None || control == object::control_type::powerup || control == object::control_type::light);
+}
+
+//	The part of an object's move that reads and writes only that object:
+//	the animation of a powerup, and the spin of an object no control code
+//	turns.  The spin is done before the object's control code rather than
+//	after it, which is the same for these objects, since their control
+//	code does not read the orientation.
+static void object_move_independent(object_base &obj, const objnum_t objnum)
+{
+	if (obj.control_source == object::control_type::powerup)
+		do_powerup_animation(Vclip, obj, objnum);
+	if (object_spins_independently(obj))
+		spin_object(obj);
+}
+
+static bool object_independent_done(const object_base &obj, const objnum_t objnum)
+{
+	return Object_independent_done[objnum] && Object_independent_signature[objnum] == obj.signature;
+}
+
+static void object_move_all_independent(object_array &Objects)
+{
+	Object_independent_done.reset();
+	Object_independent_spun.reset();
+	const std::size_t count{static_cast<std::size_t>(Objects.get_count())};
+	const auto batch = [&Objects, count](const std::size_t b) {
+		const auto end{std::min(count, (b + 1) * object_independent_batch)};
+		for (std::size_t i = b * object_independent_batch; i < end; ++i)
+		{
+			auto &obj = *Objects.vmptr(static_cast<objnum_t>(i));
+			if (obj.type == OBJ_NONE || (obj.flags & OF_SHOULD_BE_DEAD))
+				continue;
+			object_move_independent(obj, static_cast<objnum_t>(i));
+			Object_independent_signature[i] = obj.signature;
+		}
+	};
+	const auto batches{(count + object_independent_batch - 1) / object_independent_batch};
+	if (count >= object_independent_parallel_threshold)
+		parallel_for(batches, batch);
+	else
+		for (std::size_t b = 0; b < batches; ++b)
+			batch(b);
+	/* std::bitset cannot be set from several threads at once.  The
+	 * pre-pass does not change what object_spins_independently reads, so
+	 * it gives the same answer here.
+	 */
+	for (const auto &&objp : Objects.vcptridx)
+		if (objp->type != OBJ_NONE && !(objp->flags & OF_SHOULD_BE_DEAD))
+		{
+			const auto i{objp.get_unchecked_index()};
+			Object_independent_done.set(i);
+			if (object_spins_independently(*objp))
+				Object_independent_spun.set(i);
+		}
+}
+
 static window_event_result object_move_one(const d_level_shared_robot_info_state &LevelSharedRobotInfoState, const vmobjptridx_t obj, control_info &Controls)
 {
 #if DXX_BUILD_DESCENT == 2
@@ -1898,21 +2066,8 @@ static window_event_result object_move_one(const d_level_shared_robot_info_state
 		}
 	}
 
-	{
-		auto lifeleft = obj->lifeleft;
-		if (lifeleft != IMMORTAL_TIME) //if not immortal...
-		{
-			lifeleft -= FrameTime; //...inevitable countdown towards death
-#if DXX_BUILD_DESCENT == 2
-			if (obj->type == OBJ_MARKER)
-			{
-				if (lifeleft < F1_0*1000)
-					lifeleft += F1_0; // Make sure this object doesn't go out.
-			}
-#endif
-			obj->lifeleft = lifeleft;
-		}
-	}
+	const auto independent_done{object_independent_done(obj, obj)};
+	count_down_lifeleft(obj);
 #if DXX_BUILD_DESCENT == 2
 	Drop_afterburner_blob_flag = 0;
 #endif
@@ -1932,6 +2087,8 @@ static window_event_result object_move_one(const d_level_shared_robot_info_state
 			break;
 
 		case object::control_type::powerup:
+			if (!independent_done)
+				do_powerup_animation(Vclip, obj, obj);
 			do_powerup_frame(Vclip, obj);
 			break;
 	
@@ -1943,7 +2100,10 @@ static window_event_result object_move_one(const d_level_shared_robot_info_state
 		case object::control_type::ai:
 			//NOTE LINK TO object::control_type::morph ABOVE!!!
 			if (Game_suspended & SUSP_ROBOTS) return window_event_result::ignored;
-			do_ai_frame(LevelSharedRobotInfoState, obj);
+			{
+				const frame_profile_scope profile{frame_profile_zone::ai};
+				do_ai_frame(LevelSharedRobotInfoState, obj);
+			}
 			break;
 
 		case object::control_type::weapon:
@@ -2013,11 +2173,15 @@ static window_event_result object_move_one(const d_level_shared_robot_info_state
 			break;				//this doesn't move
 
 		case object::movement_type::physics:	//move by physics
-			result = do_physics_sim(LevelSharedRobotInfoState.Robot_info, obj, obj_previous_position, obj->type == OBJ_PLAYER ? (prepare_seglist = true, phys_visited_segs.nsegs = 0, &phys_visited_segs) : nullptr);
+			{
+				const frame_profile_scope profile{frame_profile_zone::physics};
+				result = do_physics_sim(LevelSharedRobotInfoState.Robot_info, obj, obj_previous_position, obj->type == OBJ_PLAYER ? (prepare_seglist = true, phys_visited_segs.nsegs = 0, &phys_visited_segs) : nullptr);
+			}
 			break;
 
 		case object::movement_type::spinning:
-			spin_object(obj);
+			if (!independent_done || !Object_independent_spun[obj.get_unchecked_index()])
+				spin_object(obj);
 			break;
 	}
 
@@ -2165,18 +2329,26 @@ static window_event_result object_move_all(const d_level_shared_robot_info_state
 		free_object_slots(MAX_USED_OBJECTS);		//	Free all possible object slots.
 
 	obj_delete_all_that_should_be_dead();
+	effect_particles_move(FrameTime);
 
 	if (PlayerCfg.AutoLeveling)
 		ConsoleObject->mtype.phys_info.flags |= PF_LEVELLING;
 	else
 		ConsoleObject->mtype.phys_info.flags &= ~PF_LEVELLING;
 
+	object_move_all_independent(Objects);
+
 	// Move all objects
 	range_for (const auto &&objp, vmobjptridx)
 	{
 		if ( (objp->type != OBJ_NONE) && (!(objp->flags&OF_SHOULD_BE_DEAD)) )	{
 			result = std::max(object_move_one(LevelSharedRobotInfoState, objp, Controls), result);
 		}
+		if (objp == ConsoleObject)
+		{
+			const frame_profile_scope profile{frame_profile_zone::ai};
+			ai_perception_prepass();
+		}
 	}
 
 //	check_duplicate_objects();
@@ -2187,10 +2359,116 @@ static window_event_result object_move_all(const d_level_shared_robot_info_state
 
 }
 
+namespace {
+
+//	With -physicstick, objects move in steps of a fixed length.  Each
+//	object's place before the last step is kept, and rendering draws the
+//	objects between that place and the current one, by the part of a step
+//	the frame time has run past it.
+struct object_tick_place
+{
+	vms_vector pos;
+	vms_matrix orient;
+	segnum_t segnum;
+	object_signature_t signature;
+};
+
+//	Catching up after a slow frame stops after this many steps, so that a
+//	step slower than the tick cannot fall further behind on every frame.
+constexpr unsigned max_object_ticks_per_frame = 4;
+
+static fix Object_tick_time;
+static std::array<object_tick_place, MAX_OBJECTS> Object_tick_places;
+
+static fix object_tick_length()
+{
+	const auto hz{CGameArg.SysPhysicsTick};
+	/* Remote players send their places every frame, which the steps would
+	 * lag behind.
+	 */
+	if (!hz || +(Game_mode & GM_MULTI))
+		return 0;
+	return F1_0 / static_cast<fix>(hz);
+}
+
+static void record_object_tick_places(const object_array &Objects)
+{
+	for (const auto &&objp : Objects.vcptridx)
+	{
+		auto &place = Object_tick_places[objp.get_unchecked_index()];
+		place = {objp->pos, objp->orient, objp->segnum, objp->signature};
+	}
+}
+
+}
+
 window_event_result game_move_all_objects(const d_level_shared_robot_info_state &LevelSharedRobotInfoState)
 {
 	LevelUniqueObjectState.last_console_player_position = ConsoleObject->pos;
-	return object_move_all(LevelSharedRobotInfoState);
+	const auto tick{object_tick_length()};
+	if (!tick)
+	{
+		Object_tick_time = 0;
+		return object_move_all(LevelSharedRobotInfoState);
+	}
+	auto result = window_event_result::ignored;
+	const auto frametime{FrameTime};
+	Object_tick_time += frametime;
+	for (unsigned steps{0}; Object_tick_time >= tick; ++steps)
+	{
+		if (steps == max_object_ticks_per_frame)
+		{
+			Object_tick_time = 0;
+			break;
+		}
+		record_object_tick_places(LevelUniqueObjectState.Objects);
+		FrameTime = tick;
+		result = std::max(object_move_all(LevelSharedRobotInfoState), result);
+		FrameTime = frametime;
+		Object_tick_time -= tick;
+		if (Endlevel_sequence)
+			break;
+	}
+	return result;
+}
+
+object_tick_interpolation::object_tick_interpolation(object_array &Objects)
+{
+	const auto tick{object_tick_length()};
+	if (!tick || Endlevel_sequence || Newdemo_state == ND_STATE_PLAYBACK)
+		return;
+	const fix k{fixdiv(std::min(Object_tick_time, tick), tick)};
+	for (const auto &&objp : Objects.vmptridx)
+	{
+		if (objp->type == OBJ_NONE)
+			continue;
+		auto &place = Object_tick_places[objp.get_unchecked_index()];
+		/* Only objects which stayed in their segment for the step are drawn
+		 * between the two places, so that the point drawn, like both ends,
+		 * is in the segment the renderer finds the object in.
+		 */
+		if (place.signature != objp->signature || place.segnum != objp->segnum)
+			continue;
+		if (place.pos == objp->pos && place.orient.fvec == objp->orient.fvec && place.orient.uvec == objp->orient.uvec)
+			continue;
+		saved.push_back({objp, objp->pos, objp->orient});
+		objp->pos = vm_vec_scale_add(place.pos, vm_vec_build_sub(objp->pos, place.pos), k);
+		const auto fvec{vm_vec_scale_add(place.orient.fvec, vm_vec_build_sub(objp->orient.fvec, place.orient.fvec), k)};
+		const auto uvec{vm_vec_scale_add(place.orient.uvec, vm_vec_build_sub(objp->orient.uvec, place.orient.uvec), k)};
+		if (fvec != vms_vector{} && uvec != vms_vector{})
+			objp->orient = vm_vector_to_matrix_u(fvec, uvec);
+	}
+}
+
+object_tick_interpolation::~object_tick_interpolation()
+{
+	auto &vmobjptr = LevelUniqueObjectState.Objects.vmptr;
+	for (auto &place : saved)
+	{
+		auto &obj = *vmobjptr(place.objnum);
+		obj.pos = place.pos;
+		obj.orient = place.orient;
+	}
 }
 
 window_event_result endlevel_move_all_objects(const d_level_shared_robot_info_state &LevelSharedRobotInfoState)
@@ -2272,14 +2550,18 @@ void reset_objects(d_level_unique_object_state &LevelUniqueObjectState, const un
 	auto &Objects = LevelUniqueObjectState.get_objects();
 	assert(LevelUniqueObjectState.num_objects < Objects.size());
 	Objects.set_count(n_objs);
+	MultiLevelInv_ObjectsReplaced();
+	multi_world_checksum_objects_replaced();
 #if DXX_BUILD_DESCENT == 2
 	if (LevelUniqueObjectState.BuddyState.Buddy_objnum.get_unchecked_index() >= n_objs)
 		LevelUniqueObjectState.BuddyState.Buddy_objnum = object_none;
 #endif
 
+	auto &free_objects = LevelUniqueObjectState.free_objects;
+	free_objects.use_all();
 	for (objnum_t i = n_objs; i < MAX_OBJECTS; ++i)
 	{
-		LevelUniqueObjectState.free_obj_list[i] = i;
+		free_objects.set_free(i);
 		auto &obj = *Objects.vmptr(i);
 		DXX_POISON_VAR(obj, 0xfd);
 		obj.type = OBJ_NONE;
@@ -2453,6 +2735,7 @@ void clear_transient_objects(int clear_all)
 			obj_delete(LevelUniqueObjectState, Segments, obj);
 		}
 	}
+	effect_particles_clear();
 }
 
 //attaches an object, such as a fireball, to another object, such as a robot
@@ -2632,111 +2915,168 @@ void wake_up_rendered_objects(const object &viewer, window_rendered_data &window
 }
 #endif
 
+namespace {
+
+/* The multi-byte fields of each part of object_rw, which is the layout
+ * of objects in savegames and in the network join messages.  object_rw is
+ * packed, so its fields are described by offset and size rather than by
+ * reference.
+ */
+struct object_rw_field
+{
+	uint16_t offset;
+	uint8_t size;
+};
+
+#define DXX_OBJECT_RW_FIELD(M)	object_rw_field{offsetof(object_rw, M), sizeof(std::declval<object_rw &>().M)}
+#define DXX_OBJECT_RW_VECTOR(M)	DXX_OBJECT_RW_FIELD(M.x), DXX_OBJECT_RW_FIELD(M.y), DXX_OBJECT_RW_FIELD(M.z)
+#define DXX_OBJECT_RW_ANGVEC(M)	DXX_OBJECT_RW_FIELD(M.p), DXX_OBJECT_RW_FIELD(M.b), DXX_OBJECT_RW_FIELD(M.h)
+
+constexpr std::array object_rw_common_fields{
+	DXX_OBJECT_RW_FIELD(signature),
+	DXX_OBJECT_RW_FIELD(next),
+	DXX_OBJECT_RW_FIELD(prev),
+	DXX_OBJECT_RW_FIELD(segnum),
+	DXX_OBJECT_RW_FIELD(attached_obj),
+	DXX_OBJECT_RW_VECTOR(pos),
+	DXX_OBJECT_RW_VECTOR(orient.rvec),
+	DXX_OBJECT_RW_VECTOR(orient.uvec),
+	DXX_OBJECT_RW_VECTOR(orient.fvec),
+	DXX_OBJECT_RW_FIELD(size),
+	DXX_OBJECT_RW_FIELD(shields),
+	DXX_OBJECT_RW_VECTOR(last_pos),
+	DXX_OBJECT_RW_FIELD(lifeleft),
+};
+
+constexpr std::array object_rw_physics_fields{
+	DXX_OBJECT_RW_VECTOR(mtype.phys_info.velocity),
+	DXX_OBJECT_RW_VECTOR(mtype.phys_info.thrust),
+	DXX_OBJECT_RW_FIELD(mtype.phys_info.mass),
+	DXX_OBJECT_RW_FIELD(mtype.phys_info.drag),
+	DXX_OBJECT_RW_FIELD(mtype.phys_info.obsolete_brakes),
+	DXX_OBJECT_RW_VECTOR(mtype.phys_info.rotvel),
+	DXX_OBJECT_RW_VECTOR(mtype.phys_info.rotthrust),
+	DXX_OBJECT_RW_FIELD(mtype.phys_info.turnroll),
+	DXX_OBJECT_RW_FIELD(mtype.phys_info.flags),
+};
+
+constexpr std::array object_rw_spin_fields{
+	DXX_OBJECT_RW_VECTOR(mtype.spin_rate),
+};
+
+constexpr std::array object_rw_laser_fields{
+	DXX_OBJECT_RW_FIELD(ctype.laser_info.parent_type),
+	DXX_OBJECT_RW_FIELD(ctype.laser_info.parent_num),
+	DXX_OBJECT_RW_FIELD(ctype.laser_info.parent_signature),
+	DXX_OBJECT_RW_FIELD(ctype.laser_info.creation_time),
+	DXX_OBJECT_RW_FIELD(ctype.laser_info.last_hitobj),
+	DXX_OBJECT_RW_FIELD(ctype.laser_info.track_goal),
+	DXX_OBJECT_RW_FIELD(ctype.laser_info.multiplier),
+};
+
+constexpr std::array object_rw_explosion_fields{
+	DXX_OBJECT_RW_FIELD(ctype.expl_info.spawn_time),
+	DXX_OBJECT_RW_FIELD(ctype.expl_info.delete_time),
+	DXX_OBJECT_RW_FIELD(ctype.expl_info.delete_objnum),
+	DXX_OBJECT_RW_FIELD(ctype.expl_info.attach_parent),
+	DXX_OBJECT_RW_FIELD(ctype.expl_info.prev_attach),
+	DXX_OBJECT_RW_FIELD(ctype.expl_info.next_attach),
+};
+
+constexpr std::array object_rw_ai_fields{
+	DXX_OBJECT_RW_FIELD(ctype.ai_info.hide_segment),
+	DXX_OBJECT_RW_FIELD(ctype.ai_info.hide_index),
+	DXX_OBJECT_RW_FIELD(ctype.ai_info.path_length),
+#if DXX_BUILD_DESCENT == 1
+	DXX_OBJECT_RW_FIELD(ctype.ai_info.cur_path_index),
+	DXX_OBJECT_RW_FIELD(ctype.ai_info.follow_path_start_seg),
+	DXX_OBJECT_RW_FIELD(ctype.ai_info.follow_path_end_seg),
+#elif DXX_BUILD_DESCENT == 2
+	DXX_OBJECT_RW_FIELD(ctype.ai_info.dying_start_time),
+#endif
+	DXX_OBJECT_RW_FIELD(ctype.ai_info.danger_laser_num),
+	DXX_OBJECT_RW_FIELD(ctype.ai_info.danger_laser_signature),
+};
+
+constexpr std::array object_rw_light_fields{
+	DXX_OBJECT_RW_FIELD(ctype.light_info.intensity),
+};
+
+constexpr std::array object_rw_powerup_fields{
+	DXX_OBJECT_RW_FIELD(ctype.powerup_info.count),
+#if DXX_BUILD_DESCENT == 2
+	DXX_OBJECT_RW_FIELD(ctype.powerup_info.creation_time),
+	DXX_OBJECT_RW_FIELD(ctype.powerup_info.flags),
+#endif
+};
+
+constexpr auto object_rw_polyobj_fields{[]() {
+	std::array<object_rw_field, 4 + 3 * MAX_SUBMODELS> r{{
+		DXX_OBJECT_RW_FIELD(rtype.pobj_info.model_num),
+		DXX_OBJECT_RW_FIELD(rtype.pobj_info.subobj_flags),
+		DXX_OBJECT_RW_FIELD(rtype.pobj_info.tmap_override),
+		DXX_OBJECT_RW_FIELD(rtype.pobj_info.alt_textures),
+	}};
+	auto i = std::next(r.begin(), 4);
+	for (std::size_t j = 0; j != MAX_SUBMODELS; ++j)
+		for (const auto f : {DXX_OBJECT_RW_ANGVEC(rtype.pobj_info.anim_angles[0])})
+			*i++ = {static_cast<uint16_t>(f.offset + j * sizeof(vms_angvec)), f.size};
+	return r;
+}()};
+
+constexpr std::array object_rw_vclip_fields{
+	DXX_OBJECT_RW_FIELD(rtype.vclip_info.vclip_num),
+	DXX_OBJECT_RW_FIELD(rtype.vclip_info.frametime),
+};
+
+#undef DXX_OBJECT_RW_ANGVEC
+#undef DXX_OBJECT_RW_VECTOR
+#undef DXX_OBJECT_RW_FIELD
+
+void object_rw_swap_fields(uint8_t *const p, const std::span<const object_rw_field> fields)
+{
+	for (const auto f : fields)
+		std::reverse(p + f.offset, p + f.offset + f.size);
+}
+
+}
+
 // Swap endianess of given object_rw if swap == 1
 void object_rw_swap(object_rw *obj, const physfsx_endian swap)
 {
 	if (swap == physfsx_endian::native)
 		return;
 
-	obj->signature     = SWAPINT(obj->signature);
-	obj->next          = SWAPSHORT(obj->next);
-	obj->prev          = SWAPSHORT(obj->prev);
-	obj->segnum        = SWAPSHORT(obj->segnum);
-	obj->attached_obj  = SWAPSHORT(obj->attached_obj);
-	obj->pos.x         = SWAPINT(obj->pos.x);
-	obj->pos.y         = SWAPINT(obj->pos.y);
-	obj->pos.z         = SWAPINT(obj->pos.z);
-	obj->orient.rvec.x = SWAPINT(obj->orient.rvec.x);
-	obj->orient.rvec.y = SWAPINT(obj->orient.rvec.y);
-	obj->orient.rvec.z = SWAPINT(obj->orient.rvec.z);
-	obj->orient.fvec.x = SWAPINT(obj->orient.fvec.x);
-	obj->orient.fvec.y = SWAPINT(obj->orient.fvec.y);
-	obj->orient.fvec.z = SWAPINT(obj->orient.fvec.z);
-	obj->orient.uvec.x = SWAPINT(obj->orient.uvec.x);
-	obj->orient.uvec.y = SWAPINT(obj->orient.uvec.y);
-	obj->orient.uvec.z = SWAPINT(obj->orient.uvec.z);
-	obj->size          = SWAPINT(obj->size);
-	obj->shields       = SWAPINT(obj->shields);
-	obj->last_pos.x    = SWAPINT(obj->last_pos.x);
-	obj->last_pos.y    = SWAPINT(obj->last_pos.y);
-	obj->last_pos.z    = SWAPINT(obj->last_pos.z);
-	obj->lifeleft      = SWAPINT(obj->lifeleft);
-	
+	const auto p = reinterpret_cast<uint8_t *>(obj);
+	object_rw_swap_fields(p, object_rw_common_fields);
 	switch (typename object::movement_type{obj->movement_source})
 	{
 		case object::movement_type::None:
 			obj->mtype = {};
 			break;
 		case object::movement_type::physics:
-			obj->mtype.phys_info.velocity.x  = SWAPINT(obj->mtype.phys_info.velocity.x);
-			obj->mtype.phys_info.velocity.y  = SWAPINT(obj->mtype.phys_info.velocity.y);
-			obj->mtype.phys_info.velocity.z  = SWAPINT(obj->mtype.phys_info.velocity.z);
-			obj->mtype.phys_info.thrust.x    = SWAPINT(obj->mtype.phys_info.thrust.x);
-			obj->mtype.phys_info.thrust.y    = SWAPINT(obj->mtype.phys_info.thrust.y);
-			obj->mtype.phys_info.thrust.z    = SWAPINT(obj->mtype.phys_info.thrust.z);
-			obj->mtype.phys_info.mass        = SWAPINT(obj->mtype.phys_info.mass);
-			obj->mtype.phys_info.drag        = SWAPINT(obj->mtype.phys_info.drag);
-			obj->mtype.phys_info.rotvel.x    = SWAPINT(obj->mtype.phys_info.rotvel.x);
-			obj->mtype.phys_info.rotvel.y    = SWAPINT(obj->mtype.phys_info.rotvel.y);
-			obj->mtype.phys_info.rotvel.z    = SWAPINT(obj->mtype.phys_info.rotvel.z);
-			obj->mtype.phys_info.rotthrust.x = SWAPINT(obj->mtype.phys_info.rotthrust.x);
-			obj->mtype.phys_info.rotthrust.y = SWAPINT(obj->mtype.phys_info.rotthrust.y);
-			obj->mtype.phys_info.rotthrust.z = SWAPINT(obj->mtype.phys_info.rotthrust.z);
-			obj->mtype.phys_info.turnroll    = SWAPINT(obj->mtype.phys_info.turnroll);
-			obj->mtype.phys_info.flags       = SWAPSHORT(obj->mtype.phys_info.flags);
+			object_rw_swap_fields(p, object_rw_physics_fields);
 			break;
-			
 		case object::movement_type::spinning:
-			obj->mtype.spin_rate.x = SWAPINT(obj->mtype.spin_rate.x);
-			obj->mtype.spin_rate.y = SWAPINT(obj->mtype.spin_rate.y);
-			obj->mtype.spin_rate.z = SWAPINT(obj->mtype.spin_rate.z);
+			object_rw_swap_fields(p, object_rw_spin_fields);
 			break;
 	}
-	
 	switch (typename object::control_type{obj->control_source})
 	{
 		case object::control_type::weapon:
-			obj->ctype.laser_info.parent_type      = SWAPSHORT(obj->ctype.laser_info.parent_type);
-			obj->ctype.laser_info.parent_num       = SWAPSHORT(obj->ctype.laser_info.parent_num);
-			obj->ctype.laser_info.parent_signature = SWAPINT(obj->ctype.laser_info.parent_signature);
-			obj->ctype.laser_info.creation_time    = SWAPINT(obj->ctype.laser_info.creation_time);
-			obj->ctype.laser_info.last_hitobj      = SWAPSHORT(obj->ctype.laser_info.last_hitobj);
-			obj->ctype.laser_info.track_goal       = SWAPSHORT(obj->ctype.laser_info.track_goal);
-			obj->ctype.laser_info.multiplier       = SWAPINT(obj->ctype.laser_info.multiplier);
+			object_rw_swap_fields(p, object_rw_laser_fields);
 			break;
-			
 		case object::control_type::explosion:
-			obj->ctype.expl_info.spawn_time    = SWAPINT(obj->ctype.expl_info.spawn_time);
-			obj->ctype.expl_info.delete_time   = SWAPINT(obj->ctype.expl_info.delete_time);
-			obj->ctype.expl_info.delete_objnum = SWAPSHORT(obj->ctype.expl_info.delete_objnum);
-			obj->ctype.expl_info.attach_parent = SWAPSHORT(obj->ctype.expl_info.attach_parent);
-			obj->ctype.expl_info.prev_attach   = SWAPSHORT(obj->ctype.expl_info.prev_attach);
-			obj->ctype.expl_info.next_attach   = SWAPSHORT(obj->ctype.expl_info.next_attach);
+			object_rw_swap_fields(p, object_rw_explosion_fields);
 			break;
-			
 		case object::control_type::ai:
-			obj->ctype.ai_info.hide_segment           = SWAPSHORT(obj->ctype.ai_info.hide_segment);
-			obj->ctype.ai_info.hide_index             = SWAPSHORT(obj->ctype.ai_info.hide_index);
-			obj->ctype.ai_info.path_length            = SWAPSHORT(obj->ctype.ai_info.path_length);
-#if DXX_BUILD_DESCENT == 1
-			obj->ctype.ai_info.cur_path_index         = SWAPSHORT(obj->ctype.ai_info.cur_path_index);
-#elif DXX_BUILD_DESCENT == 2
-			obj->ctype.ai_info.dying_start_time       = SWAPINT(obj->ctype.ai_info.dying_start_time);
-#endif
-			obj->ctype.ai_info.danger_laser_num       = SWAPSHORT(obj->ctype.ai_info.danger_laser_num);
-			obj->ctype.ai_info.danger_laser_signature = SWAPINT(obj->ctype.ai_info.danger_laser_signature);
+			object_rw_swap_fields(p, object_rw_ai_fields);
 			break;
-			
 		case object::control_type::light:
-			obj->ctype.light_info.intensity = SWAPINT(obj->ctype.light_info.intensity);
+			object_rw_swap_fields(p, object_rw_light_fields);
 			break;
-			
 		case object::control_type::powerup:
-			obj->ctype.powerup_info.count         = SWAPINT(obj->ctype.powerup_info.count);
-#if DXX_BUILD_DESCENT == 2
-			obj->ctype.powerup_info.creation_time = SWAPINT(obj->ctype.powerup_info.creation_time);
-			obj->ctype.powerup_info.flags         = SWAPINT(obj->ctype.powerup_info.flags);
-#endif
+			object_rw_swap_fields(p, object_rw_powerup_fields);
 			break;
 		case object::control_type::None:
 		case object::control_type::flying:
@@ -2749,7 +3089,6 @@ void object_rw_swap(object_rw *obj, const physfsx_endian swap)
 		default:
 			break;
 	}
-	
 	switch (render_type{obj->render_type})
 	{
 		case render_type::RT_NONE:
@@ -2758,31 +3097,16 @@ void object_rw_swap(object_rw *obj, const physfsx_endian swap)
 			[[fallthrough]];
 		case render_type::RT_MORPH:
 		case render_type::RT_POLYOBJ:
-		{
-			obj->rtype.pobj_info.model_num                = SWAPINT(obj->rtype.pobj_info.model_num);
-			for (uint_fast32_t i=0;i<MAX_SUBMODELS;i++)
-			{
-				obj->rtype.pobj_info.anim_angles[i].p = SWAPINT(obj->rtype.pobj_info.anim_angles[i].p);
-				obj->rtype.pobj_info.anim_angles[i].b = SWAPINT(obj->rtype.pobj_info.anim_angles[i].b);
-				obj->rtype.pobj_info.anim_angles[i].h = SWAPINT(obj->rtype.pobj_info.anim_angles[i].h);
-			}
-			obj->rtype.pobj_info.subobj_flags             = SWAPINT(obj->rtype.pobj_info.subobj_flags);
-			obj->rtype.pobj_info.tmap_override            = SWAPINT(obj->rtype.pobj_info.tmap_override);
-			obj->rtype.pobj_info.alt_textures             = SWAPINT(obj->rtype.pobj_info.alt_textures);
+			object_rw_swap_fields(p, object_rw_polyobj_fields);
 			break;
-		}
-			
 		case render_type::RT_WEAPON_VCLIP:
 		case render_type::RT_HOSTAGE:
 		case render_type::RT_POWERUP:
 		case render_type::RT_FIREBALL:
-			obj->rtype.vclip_info.vclip_num = SWAPINT(obj->rtype.vclip_info.vclip_num);
-			obj->rtype.vclip_info.frametime = SWAPINT(obj->rtype.vclip_info.frametime);
+			object_rw_swap_fields(p, object_rw_vclip_fields);
 			break;
-			
 		case render_type::RT_LASER:
 			break;
-			
 	}
 }
 
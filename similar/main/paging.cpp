@@ -23,10 +23,13 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  *
  */
 
+#include <algorithm>
+#include <optional>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <vector>
 
 #include "pstypes.h"
 #include "inferno.h"
@@ -35,6 +38,8 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "wall.h"
 #include "object.h"
 #include "console.h"
+#include "digi.h"
+#include "load_trace.h"
 #include "game.h"
 #include "piggy.h"
 #include "texmerge.h"
@@ -58,6 +63,61 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 namespace {
 
+/* What the paging_touch functions do with each bitmap they reach */
+enum class paging_mode : uint8_t
+{
+	/* Page it in now */
+	page_in,
+	/* Queue it for piggy_bitmap_service_prefetch */
+	prefetch,
+	/* Add it to Paging_collected */
+	collect,
+};
+
+static paging_mode Paging_mode;
+static std::vector<bitmap_index> Paging_collected;
+/* Sounds found while collecting, read after the bitmaps */
+static std::vector<sound_effect> Paging_sounds;
+
+static void paging_touch_bitmap(const bitmap_index bmp)
+{
+	switch (Paging_mode)
+	{
+		case paging_mode::page_in:
+			PIGGY_PAGE_IN(bmp);
+			break;
+		case paging_mode::prefetch:
+			piggy_bitmap_request_prefetch(GameBitmaps, bmp);
+			break;
+		case paging_mode::collect:
+			Paging_collected.emplace_back(bmp);
+			break;
+	}
+}
+
+static void paging_touch_sound(const sound_effect s)
+{
+	/* Game data uses None, and sometimes other values past the end, for
+	 * no sound.
+	 */
+	if (s >= MAX_SOUNDS)
+		return;
+	switch (Paging_mode)
+	{
+		case paging_mode::page_in:
+			piggy_sound_page_in(digi_xlat_sound(s));
+			break;
+		case paging_mode::prefetch:
+			/* A sound that is not read by now is read when it is first
+			 * played.
+			 */
+			break;
+		case paging_mode::collect:
+			Paging_sounds.emplace_back(digi_xlat_sound(s));
+			break;
+	}
+}
+
 static void paging_touch_vclip(const vclip &vc, const unsigned line
 #if DXX_HAVE_CXX_BUILTIN_FILE_LINE
 							   = __builtin_LINE()
@@ -84,8 +144,9 @@ static void paging_touch_vclip(const vclip &vc, const unsigned line
 	}
 	range_for (auto &i, u.r)
 	{
-		PIGGY_PAGE_IN(i);
+		paging_touch_bitmap(i);
 	}
+	paging_touch_sound(vc.sound_num);
 }
 
 static void paging_touch_vclip(const d_vclip_array &Vclip, const vclip_index vclip_id, const unsigned line
@@ -118,9 +179,10 @@ static void paging_touch_wall_effects(const d_eclip_array &Effects, const Textur
 	{
 		if ( i.changing_wall_texture == tmap_num )	{
 			paging_touch_vclip(i.vc);
+			paging_touch_sound(i.sound_num);
 
 			if (i.dest_bm_num < Textures.size())
-				PIGGY_PAGE_IN( Textures[i.dest_bm_num] );	//use this bitmap when monitor destroyed
+				paging_touch_bitmap(Textures[i.dest_bm_num]);	//use this bitmap when monitor destroyed
 			paging_touch_vclip(Vclip, i.dest_vclip);		  //what vclip to play when exploding
 			paging_touch_vclip(Effects, i.dest_eclip); //what eclip to play when exploding
 			paging_touch_vclip(Effects, i.crit_clip); //what eclip to play when mine critical
@@ -149,7 +211,7 @@ static void paging_touch_model(const polygon_model_index modelnum)
 	const uint_fast32_t e = b + pm.n_textures;
 	range_for (const auto p, partial_range(ObjBitmapPtrs, b, e))
 	{
-		PIGGY_PAGE_IN(ObjBitmaps[p]);
+		paging_touch_bitmap(ObjBitmaps[p]);
 		paging_touch_object_effects(Effects, p);
 	}
 }
@@ -160,11 +222,14 @@ static void paging_touch_weapon(const d_vclip_array &Vclip, const weapon_info &w
 
 	if (weapon.picture != bitmap_index{})
 	{
-		PIGGY_PAGE_IN(weapon.picture);
+		paging_touch_bitmap(weapon.picture);
 	}		
 	
 	paging_touch_vclip(Vclip, weapon.flash_vclip);
 	paging_touch_vclip(Vclip, weapon.wall_hit_vclip);
+	paging_touch_sound(weapon.flash_sound);
+	paging_touch_sound(weapon.robot_hit_sound);
+	paging_touch_sound(weapon.wall_hit_sound);
 	if (weapon.damage_radius)
 	{
 		// Robot_hit_vclips are actually badass_vclips
@@ -183,7 +248,7 @@ static void paging_touch_weapon(const d_vclip_array &Vclip, const weapon_info &w
 		paging_touch_model(weapon.model_num);
 		break;
 	case weapon_info::render_type::blob:
-		PIGGY_PAGE_IN(weapon.bitmap);
+		paging_touch_bitmap(weapon.bitmap);
 		break;
 	}
 }
@@ -217,6 +282,15 @@ static void paging_touch_robot(const d_robot_info_array &Robot_info, const d_vcl
 	paging_touch_model(ri.model_num);
 	paging_touch_vclip(Vclip, ri.exp1_vclip_num);
 	paging_touch_vclip(Vclip, ri.exp2_vclip_num);
+	paging_touch_sound(ri.exp1_sound_num);
+	paging_touch_sound(ri.exp2_sound_num);
+	paging_touch_sound(ri.see_sound);
+	paging_touch_sound(ri.attack_sound);
+	paging_touch_sound(ri.claw_sound);
+#if DXX_BUILD_DESCENT == 2
+	paging_touch_sound(ri.taunt_sound);
+	paging_touch_sound(ri.deathroll_sound);
+#endif
 
 	// Page in his weapons
 	paging_touch_weapon(Vclip, Weapon_info, ri.weapon_type);
@@ -240,7 +314,7 @@ static void paging_touch_object(const d_robot_info_array &Robot_info, const Text
 			if (const auto tmap_override{obj.rtype.pobj_info.tmap_override}; tmap_override != texture_index{UINT16_MAX})
 			{
 				if (tmap_override < Textures.size()) [[likely]]
-					PIGGY_PAGE_IN(Textures[tmap_override]);
+					paging_touch_bitmap(Textures[tmap_override]);
 			}
 			else
 				paging_touch_model(obj.rtype.pobj_info.model_num);
@@ -294,7 +368,7 @@ static void paging_touch_side(const d_eclip_array &Effects, const Textures_array
 		paging_touch_wall_effects(Effects, Textures, Vclip, get_texture_index(tmap2));
 	} else	{
 		if (const auto ti{get_texture_index(tmap1)}; ti < Textures.size()) [[likely]]
-			PIGGY_PAGE_IN(Textures[ti]);
+			paging_touch_bitmap(Textures[ti]);
 	}
 }
 
@@ -354,8 +428,10 @@ static void paging_touch_walls(const Textures_array &Textures, const wall_animat
 			{
 				if (j >= Textures.size()) [[unlikely]]
 					continue;
-				PIGGY_PAGE_IN(Textures[j]);
+				paging_touch_bitmap(Textures[j]);
 			}
+			paging_touch_sound(anim.open_sound);
+			paging_touch_sound(anim.close_sound);
 		}
 	}
 }
@@ -364,6 +440,7 @@ static void paging_touch_walls(const Textures_array &Textures, const wall_animat
 namespace dsx {
 void paging_touch_all(const d_vclip_array &Vclip)
 {
+	const load_trace_span trace{"paging_touch_all"};
 	auto &Effects = LevelUniqueEffectsClipState.Effects;
 	auto &Objects = LevelUniqueObjectState.Objects;
 	auto &WallAnims = GameSharedState.WallAnims;
@@ -376,6 +453,13 @@ void paging_touch_all(const d_vclip_array &Vclip)
 	gr_flip();
 #endif
 	auto &Robot_info = LevelSharedRobotInfoState.Robot_info;
+	/* Collect every bitmap first, so that they can be paged in together
+	 * in file order.
+	 */
+	std::optional<load_trace_span> collect{std::in_place, "paging_collect"};
+	Paging_collected.clear();
+	Paging_sounds.clear();
+	Paging_mode = paging_mode::collect;
 	for (const cscusegment segp : vcsegptr)
 	{
 		paging_touch_segment(Effects, Robot_info, Textures, Vclip, Weapon_info, vcobjptridx, vcsegptr, segp);
@@ -398,11 +482,64 @@ void paging_touch_all(const d_vclip_array &Vclip)
 	range_for (auto &s, Gauges)
 	{
 		if (s != bitmap_index{})
-			PIGGY_PAGE_IN( s );
+			paging_touch_bitmap(s);
 	}
 	paging_touch_vclip(Vclip[vclip_index::player_appearance]);
 	paging_touch_vclip(Vclip[vclip_index::powerup_disappearance]);
+	Paging_mode = paging_mode::page_in;
+	collect.reset();
+	con_printf(CON_VERBOSE, "paging: %zu bitmap uses found", Paging_collected.size());
+	{
+		const load_trace_span trace{"piggy_bitmap_page_in_all"};
+		piggy_bitmap_page_in_all(GameBitmaps, Paging_collected);
+	}
+	{
+		/* Sounds are numbered in file order */
+		const load_trace_span trace{"piggy_sound_page_in"};
+		std::ranges::sort(Paging_sounds);
+		const auto [first, last] = std::ranges::unique(Paging_sounds);
+		Paging_sounds.erase(first, last);
+		for (const auto s : Paging_sounds)
+			piggy_sound_page_in(s);
+		con_printf(CON_VERBOSE, "paging: %zu sounds found", Paging_sounds.size());
+	}
 
 	reset_cockpit();		//force cockpit redraw next time
 }
+
+void paging_prefetch_frame(const d_vclip_array &Vclip, const vcsegidx_t player_segnum)
+{
+	/* Time spent paging in queued bitmaps each frame */
+	constexpr unsigned paging_prefetch_budget_us{1000};
+	static segnum_t last_segnum{segment_none};
+	if (const segnum_t segnum{player_segnum}; last_segnum != segnum)
+	{
+		last_segnum = segnum;
+		auto &Effects = LevelUniqueEffectsClipState.Effects;
+		auto &Objects = LevelUniqueObjectState.Objects;
+		auto &vcobjptridx = Objects.vcptridx;
+		auto &Robot_info = LevelSharedRobotInfoState.Robot_info;
+		/* Queue what the player may meet next: the robots, matcen
+		 * contents and textures of the segments up to two connections
+		 * away.
+		 */
+		std::array<segnum_t, 1 + 6 + 6 * 6> nearby;
+		std::size_t n{0}, depth_end{0};
+		nearby[n++] = player_segnum;
+		for (unsigned depth = 0; depth != 2; ++depth)
+		{
+			const auto depth_begin{depth_end};
+			depth_end = n;
+			for (std::size_t i = depth_begin; i != depth_end; ++i)
+				for (const auto child : vcsegptr(nearby[i])->children)
+					if (IS_CHILD(child) && std::find(nearby.begin(), std::next(nearby.begin(), n), child) == std::next(nearby.begin(), n))
+						nearby[n++] = child;
+		}
+		Paging_mode = paging_mode::prefetch;
+		for (const auto segnum : partial_const_range(nearby, n))
+			paging_touch_segment(Effects, Robot_info, Textures, Vclip, Weapon_info, vcobjptridx, vcsegptr, vcsegptr(segnum));
+		Paging_mode = paging_mode::page_in;
+	}
+	piggy_bitmap_service_prefetch(GameBitmaps, paging_prefetch_budget_us);
+}
 }
@@ -0,0 +1,191 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * Cosmetic fireballs kept apart from the objects
+ *
+ */
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <span>
+#include <utility>
+
+#include "particle.h"
+#include "fireball.h"
+#include "gameseg.h"
+#include "gr.h"
+#include "newdemo.h"
+#include "object.h"
+#include "playsave.h"
+#include "segment.h"
+#include "vclip.h"
+
+namespace dsx {
+
+namespace {
+
+constexpr std::size_t max_effect_particles{512};
+
+/* The particles are stored by field, so that aging every particle
+ * touches only the lifetimes, and moving them only the particles that
+ * drift.  The live particles are the first `count` of each array.
+ */
+struct effect_particle_pool
+{
+	std::array<vms_vector, max_effect_particles> pos, velocity;
+	std::array<fix, max_effect_particles> size, lifeleft;
+	std::array<segnum_t, max_effect_particles> segnum;
+	std::array<vclip_index, max_effect_particles> vclip;
+	/* The live particles in order of segment, for the renderer.  Rebuilt
+	 * when first needed after the particles change.
+	 */
+	std::array<uint16_t, max_effect_particles> by_segment;
+	unsigned count;
+	bool by_segment_valid;
+	void remove(unsigned i);
+	void set(unsigned i, vcsegidx_t s, const vms_vector &p, const vms_vector &v, fix sz, vclip_index vc, fix life);
+	std::span<const uint16_t> in(segnum_t s);
+};
+
+static effect_particle_pool Effect_particles;
+
+void effect_particle_pool::remove(const unsigned i)
+{
+	const auto last{--count};
+	pos[i] = pos[last];
+	velocity[i] = velocity[last];
+	size[i] = size[last];
+	lifeleft[i] = lifeleft[last];
+	segnum[i] = segnum[last];
+	vclip[i] = vclip[last];
+	by_segment_valid = false;
+}
+
+void effect_particle_pool::set(const unsigned i, const vcsegidx_t s, const vms_vector &p, const vms_vector &v, const fix sz, const vclip_index vc, const fix life)
+{
+	pos[i] = p;
+	velocity[i] = v;
+	size[i] = sz;
+	lifeleft[i] = life;
+	segnum[i] = s;
+	vclip[i] = vc;
+	by_segment_valid = false;
+}
+
+std::span<const uint16_t> effect_particle_pool::in(const segnum_t s)
+{
+	const std::span<uint16_t> live{by_segment.data(), count};
+	if (!by_segment_valid)
+	{
+		by_segment_valid = true;
+		std::iota(live.begin(), live.end(), 0);
+		std::ranges::sort(live, {}, [this](const uint16_t i) { return segnum[i]; });
+	}
+	const auto r{std::ranges::equal_range(live, s, {}, [this](const uint16_t i) { return segnum[i]; })};
+	return {r.begin(), r.end()};
+}
+
+}
+
+void create_cosmetic_explosion(const d_vclip_array &Vclip, const vmsegptridx_t segnum, const vms_vector &position, const fix size, const vclip_index vclip_type, const fix lifetime)
+{
+	auto &vc = Vclip[vclip_type];
+	if (Newdemo_state == ND_STATE_RECORDING || vc.light_value || (vc.flags & VF_ROD))
+	{
+		const auto &&obj{object_create_explosion_without_damage(Vclip, segnum, position, size, vclip_type)};
+		if (lifetime != -1 && obj != object_none)
+			obj->lifeleft = lifetime;
+		return;
+	}
+	effect_particle_create(segnum, position, {}, size, vclip_type, lifetime == -1 ? vc.play_time : lifetime);
+}
+
+void effect_particle_create(const vcsegidx_t segnum, const vms_vector &position, const vms_vector &velocity, const fix size, const vclip_index vclip_type, const fix lifetime)
+{
+	auto &p = Effect_particles;
+	unsigned i;
+	if (p.count < max_effect_particles)
+		i = p.count++;
+	else
+	{
+		/* Replace the particle that would have gone soonest */
+		const std::span<const fix> live{p.lifeleft.data(), p.count};
+		i = std::distance(live.begin(), std::ranges::min_element(live));
+	}
+	p.set(i, segnum, position, velocity, size, vclip_type, lifetime);
+}
+
+void effect_particles_move(const fix frametime)
+{
+	auto &p = Effect_particles;
+	for (unsigned i{0}; i < p.count;)
+	{
+		if ((p.lifeleft[i] -= frametime) <= 0)
+		{
+			p.remove(i);
+			continue;
+		}
+		if (const auto &v{p.velocity[i]}; v != vms_vector{})
+		{
+			vm_vec_scale_add2(p.pos[i], v, frametime);
+			const auto &&segnum{find_point_seg(LevelSharedSegmentState, p.pos[i], Segments.vcptridx(p.segnum[i]) DXX_lighting_hack_pass_parameter)};
+			if (segnum == segment_none)
+			{
+				p.remove(i);
+				continue;
+			}
+			if (p.segnum[i] != segnum)
+			{
+				p.segnum[i] = segnum;
+				p.by_segment_valid = false;
+			}
+		}
+		++i;
+	}
+}
+
+bool effect_particles_in(const segnum_t segnum)
+{
+	return Effect_particles.count && !Effect_particles.in(segnum).empty();
+}
+
+void effect_particles_render(const d_vclip_array &Vclip, grs_canvas &canvas, const segnum_t segnum)
+{
+	auto &p = Effect_particles;
+	const auto in{p.in(segnum)};
+	if (in.empty())
+		return;
+	const bool alpha = PlayerCfg.AlphaBlendFireballs;
+	std::array<uint16_t, max_effect_particles> order;
+	const auto draw{std::span(order).first(in.size())};
+	std::ranges::copy(in, draw.begin());
+	if (alpha)
+	{
+		gr_settransblend(canvas, GR_FADE_OFF, gr_blend::additive_c);
+		/* Added light does not depend on the order it is added in, so
+		 * draw the particles showing the same frame together, for the
+		 * renderer to send as one batch.  The frame of a vclip follows
+		 * from the time left.
+		 */
+		std::ranges::sort(draw, {}, [&p](const uint16_t i) { return std::pair(p.vclip[i], p.lifeleft[i]); });
+	}
+	for (const auto i : draw)
+		draw_vclip_sprite(canvas, p.pos[i], p.size[i], p.lifeleft[i], Vclip[p.vclip[i]]);
+	if (alpha)
+		gr_settransblend(canvas, GR_FADE_OFF, gr_blend::normal);
+}
+
+void effect_particles_clear()
+{
+	Effect_particles.count = 0;
+	Effect_particles.by_segment_valid = false;
+}
+
+}
@@ -663,6 +663,7 @@ window_event_result do_physics_sim(const d_robot_info_array &Robot_info, const v
 					Assert(size0+size1 != 0);	// Error, both sizes are 0, so how did they collide, anyway?!?
 					auto pos_hit{vm_vec_scale_add(ppos0, vm_vec_build_sub(ppos1, ppos0), fixdiv(size0, size0 + size1))};
 
+					++Object_pair_counts.reported;
 					collide_two_objects(Robot_info, obj, hit, pos_hit);
 				}
 
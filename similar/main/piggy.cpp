@@ -48,19 +48,33 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "gamemine.h"
 #include "textures.h"
 #include "texmerge.h"
+#include "texmap.h"
 #include "paging.h"
 #include "game.h"
 #include "text.h"
 #include "vclip.h"
 #include "makesig.h"
 #include "console.h"
+#include "bitmap_cache_ring.h"
+#include "load_trace.h"
+#include "mem_account.h"
+#include "mem_trim.h"
 #include "compiler-cf_assert.h"
 #include "compiler-range_for.h"
 #include "d_construct.h"
 #include "d_range.h"
 #include "d_zip.h"
 #include "partial_range.h"
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <vector>
+#include "parallel.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #if DXX_BUILD_DESCENT == 1
 #include "custom.h"
@@ -111,6 +125,8 @@ namespace {
 
 static std::unique_ptr<ubyte[]> BitmapBits;
 static std::unique_ptr<ubyte[]> SoundBits;
+static mem_account_tracked BitmapBits_account{mem_tag::bitmaps};
+static mem_account_tracked SoundBits_account{mem_tag::sounds};
 
 struct SoundFile
 {
@@ -126,6 +142,7 @@ hashtable AllDigiSndNames;
 per_bitmap_index_array<pig_bitmap_offset> GameBitmapOffset;
 #if DXX_BUILD_DESCENT == 2
 static std::unique_ptr<uint8_t[]> Bitmap_replacement_data;
+static mem_account_tracked Bitmap_replacement_account{mem_tag::mission};
 static std::array<char, FILENAME_LEN> Current_pigfile;
 }
 #endif
@@ -155,11 +172,101 @@ static std::array<SoundFile, MAX_SOUND_FILES> AllSounds;
 #define DBM_FLAG_ABM    64 // animated bitmap
 
 static int Piggy_bitmap_cache_size;
+/* The bytes at the start of the cache held by bitmaps that were not read
+ * from the pig, and so cannot be paged out.  Paged in bitmaps are placed
+ * by Piggy_bitmap_cache in the rest.
+ */
 static int Piggy_bitmap_cache_next;
 static uint8_t *Piggy_bitmap_cache_data;
+static bitmap_cache_ring Piggy_bitmap_cache;
+/* Set when a paged in bitmap is used, and cleared when the cache passes
+ * it looking for room, so that only bitmaps not used for a whole lap of
+ * the cache are paged out.
+ */
+static per_bitmap_index_array<uint8_t> Piggy_bitmap_used;
 static per_bitmap_index_array<uint8_t> GameBitmapFlags;
 static per_bitmap_index_array<bitmap_index> GameBitmapXlat;
 static RAIINamedPHYSFS_File Piggy_fp;
+/* A map of the file behind Piggy_fp, when that file is not in an
+ * archive.  Bitmap page-in reads from it without a system call.
+ */
+static PHYSFSX_mapped_file Piggy_map;
+static std::size_t Piggy_map_pos;
+/* Bitmaps waiting for piggy_bitmap_service_prefetch, oldest first */
+static std::vector<bitmap_index> Piggy_prefetch_queue;
+static per_bitmap_index_array<uint8_t> Piggy_prefetch_queued;
+/* Where piggy_sound_page_in puts each sound that piggy_read_sounds left
+ * on disk, or nullptr if the sound is read or not needed.
+ */
+static std::array<uint8_t *, MAX_SOUND_FILES> Piggy_sound_dest;
+#if DXX_BUILD_DESCENT == 2
+/* The sound file, kept open for piggy_sound_page_in.  Descent 1 keeps
+ * its sounds in the PIG, and reads them through Piggy_fp.
+ */
+static RAIINamedPHYSFS_File Piggy_sound_fp;
+static PHYSFSX_mapped_file Piggy_sound_map;
+#endif
+
+/* The size of the bitmap cache asked for with -bitmapcache, or `fallback`
+ * if none was.  The cache must hold the largest bitmap, so it is never
+ * less than 1 MB.
+ */
+static int piggy_bitmap_cache_budget(const int fallback)
+{
+	if (const auto kb = CGameArg.SysBitmapCacheBudget)
+		return std::max(kb, 1024u) * 1024;
+	return fallback;
+}
+
+static void piggy_bitmap_cache_reset()
+{
+	Piggy_bitmap_cache.reset(Piggy_bitmap_cache_data + Piggy_bitmap_cache_next, Piggy_bitmap_cache_size - Piggy_bitmap_cache_next);
+}
+
+static void piggy_map_open()
+{
+	Piggy_map = PHYSFSX_mapReadOnly(Piggy_fp.filename, PHYSFS_fileLength(Piggy_fp));
+	Piggy_map_pos = 0;
+}
+
+static void piggy_page_seek(const unsigned offset)
+{
+	if (Piggy_map)
+		Piggy_map_pos = offset;
+	else
+		PHYSFS_seek(Piggy_fp, offset);
+}
+
+static void piggy_page_read(uint8_t *const dest, const std::size_t n)
+{
+	if (!Piggy_map)
+	{
+		PHYSFSX_readBytes(Piggy_fp, dest, n);
+		return;
+	}
+	const auto m = Piggy_map.get();
+	/* A read past the end copies what is there, as a short file read
+	 * would, and leaves the rest of dest zeroed.
+	 */
+	const auto available = Piggy_map_pos < m.size() ? std::min(n, m.size() - Piggy_map_pos) : 0;
+	std::copy_n(std::next(m.begin(), Piggy_map_pos), available, dest);
+	std::fill(dest + available, dest + n, 0);
+	Piggy_map_pos += n;
+}
+
+static int piggy_page_read_int()
+{
+	std::array<uint8_t, 4> b;
+	piggy_page_read(b.data(), b.size());
+	return GET_INTEL_INT(b.data());
+}
+
+#if DXX_BUILD_DESCENT == 2
+static uint32_t piggy_page_file_length()
+{
+	return Piggy_map ? Piggy_map.get().size() : PHYSFS_fileLength(Piggy_fp);
+}
+#endif
 }
 
 #if DXX_BUILD_DESCENT == 1
@@ -177,6 +284,8 @@ std::array<uint8_t, 64 * 64> bogus_data;
 #if DXX_BUILD_DESCENT == 1
 namespace {
 static std::array<int, MAX_SOUND_FILES> SoundCompressed;
+/* Whether piggy_sound_page_in must decompress the sounds */
+static bool Piggy_sounds_compressed;
 }
 #elif DXX_BUILD_DESCENT == 2
 #define BM_FLAGS_TO_COPY (BM_FLAG_TRANSPARENT | BM_FLAG_SUPER_TRANSPARENT \
@@ -216,11 +325,35 @@ struct DiskSoundHeader
 	int offset;
 } __pack__;
 
+#if DXX_BUILD_DESCENT == 2
+/* The replacements read from the last POG file, kept so that a level
+ * that uses the same file neither reads it again nor disturbs the
+ * bitmaps it replaced.  While applied, the replaced bitmaps point into
+ * `contents`, and their originals are kept to be put back.
+ */
+struct pog_replacements
+{
+	std::array<char, FILENAME_LEN> filename{};
+	PHYSFS_sint64 file_length{-1};
+	std::vector<uint8_t> contents;
+	std::vector<uint16_t> indices;
+	std::vector<DiskBitmapHeader> headers;
+	std::size_t data_start{};
+	bool applied{};
+	std::vector<grs_bitmap> originals;
+	std::vector<pig_bitmap_offset> original_offsets;
+	mem_account_tracked contents_account{mem_tag::mission};
+};
+
+static pog_replacements Pog_replacements;
+#endif
+
 }
 
 namespace dsx {
 namespace {
 static void piggy_bitmap_page_out_all();
+static std::size_t piggy_bitmap_cache_trim();
 #if DXX_BUILD_DESCENT == 2
 
 /* the inverse of the d2 Textures array, but for the descent 1 pigfile.
@@ -453,6 +586,7 @@ static void piggy_close_file()
 {
 	if (Piggy_fp)
 	{
+		Piggy_map.reset();
 		Piggy_fp.reset();
 #if DXX_BUILD_DESCENT == 2
 		Current_pigfile[0] = 0;
@@ -461,6 +595,20 @@ static void piggy_close_file()
 }
 }
 
+void piggy_read_ahead()
+{
+#if DXX_BUILD_DESCENT == 1
+	PHYSFSX_readAhead(DEFAULT_PIGFILE_REGISTERED);
+#elif DXX_BUILD_DESCENT == 2
+	PHYSFSX_readAhead(DEFAULT_HAMFILE_REGISTERED);
+	PHYSFSX_readAhead(DEFAULT_PIGFILE_REGISTERED);
+	/* The version of the ham file is not known yet, so assume the
+	 * registered game.
+	 */
+	PHYSFSX_readAhead(GameArg.SndDigiSampleRate == sound_sample_rate::_22k ? "descent2.s22" : "descent2.s11");
+#endif
+}
+
 #if DXX_BUILD_DESCENT == 1
 properties_init_result properties_init(d_level_shared_robot_info_state &LevelSharedRobotInfoState)
 {
@@ -501,6 +649,7 @@ properties_init_result properties_init(d_level_shared_robot_info_state &LevelSha
 			Error("Cannot find " DEFAULT_PIGFILE_REGISTERED " or BITMAPS.TBL");
 		return properties_init_result::use_gamedata_read_tbl;	// need to run gamedata_read_tbl
 	}
+	piggy_map_open();
 
 	unsigned Pigdata_start;
 	switch (descent1_pig_size{PHYSFS_fileLength(Piggy_fp)}) {
@@ -619,7 +768,8 @@ properties_init_result properties_init(d_level_shared_robot_info_state &LevelSha
                 sbytes += sndh.length;
 	}
 
-		SoundBits = std::make_unique<ubyte[]>(sbytes + 16);
+		SoundBits = std::make_unique_for_overwrite<ubyte[]>(sbytes + 16);
+		SoundBits_account.set(sbytes + 16);
 	}
 
 #if 1	//def EDITOR
@@ -629,10 +779,16 @@ properties_init_result properties_init(d_level_shared_robot_info_state &LevelSha
 	Piggy_bitmap_cache_size = PIGGY_BUFFER_SIZE;
 	if (CGameArg.SysLowMem)
 		Piggy_bitmap_cache_size = PIGGY_SMALL_BUFFER_SIZE;
+#endif
+#if !DXX_USE_EDITOR
+	Piggy_bitmap_cache_size = std::min(Piggy_bitmap_cache_size, piggy_bitmap_cache_budget(Piggy_bitmap_cache_size));
 #endif
 	BitmapBits = std::make_unique<ubyte[]>(Piggy_bitmap_cache_size);
+	BitmapBits_account.set(Piggy_bitmap_cache_size);
 	Piggy_bitmap_cache_data = BitmapBits.get();
 	Piggy_bitmap_cache_next = 0;
+	piggy_bitmap_cache_reset();
+	mem_trim_register(mem_trim_cost::page_in, piggy_bitmap_cache_trim);
 
 	return retval;
 }
@@ -688,6 +844,7 @@ void piggy_init_pigfile(const std::span<const char> filename)
 			Error("Cannot load PIG file: expected (id=%.8lx version=%.8x), found (id=%.8x version=%.8x) in \"%s\"", PIGFILE_ID, PIGFILE_VERSION, pig_id, pig_version, effective_filename);
 		#endif
 		}
+		piggy_map_open();
 	}
 
 	std::copy_n(filename.data(), std::min(filename.size(), std::size(Current_pigfile) - 1), Current_pigfile.begin());
@@ -731,10 +888,14 @@ void piggy_init_pigfile(const std::span<const char> filename)
 	Piggy_bitmap_cache_size = PIGGY_BUFFER_SIZE;
 	if (CGameArg.SysLowMem)
 		Piggy_bitmap_cache_size = PIGGY_SMALL_BUFFER_SIZE;
+	Piggy_bitmap_cache_size = piggy_bitmap_cache_budget(Piggy_bitmap_cache_size);
 #endif
 	BitmapBits = std::make_unique<ubyte[]>(Piggy_bitmap_cache_size);
+	BitmapBits_account.set(Piggy_bitmap_cache_size);
 	Piggy_bitmap_cache_data = BitmapBits.get();
 	Piggy_bitmap_cache_next = 0;
+	piggy_bitmap_cache_reset();
+	mem_trim_register(mem_trim_cost::page_in, piggy_bitmap_cache_trim);
 
 	Pigfile_initialized=1;
 }
@@ -754,6 +915,13 @@ void piggy_new_pigfile(const std::span<char, FILENAME_LEN> pigname)
 	    && !Bitmap_replacement_data) // no need to reload: no bitmaps were altered
 		return;
 
+	/* Reading the pig replaces every bitmap, so the POG replacements are
+	 * no longer applied, and their originals are stale.
+	 */
+	Pog_replacements.applied = false;
+	Pog_replacements.originals.clear();
+	Pog_replacements.original_offsets.clear();
+
 	if (!Pigfile_initialized) {                     //have we ever opened a pigfile?
 		piggy_init_pigfile(pigname);            //..no, so do initialization stuff
 		return;
@@ -762,6 +930,7 @@ void piggy_new_pigfile(const std::span<char, FILENAME_LEN> pigname)
 		piggy_close_file();             //close old pig if still open
 
 	Piggy_bitmap_cache_next = 0;            //free up cache
+	piggy_bitmap_cache_reset();
 
 	std::copy_n(pigname.data(), std::min(pigname.size(), std::size(Current_pigfile) - 1), Current_pigfile.begin());
 
@@ -807,6 +976,7 @@ void piggy_new_pigfile(const std::span<char, FILENAME_LEN> pigname)
 			Error("Cannot load PIG file: expected (id=%.8lx version=%.8x), found (id=%.8x version=%.8x) in \"%s\"", PIGFILE_ID, PIGFILE_VERSION, pig_id, pig_version, effective_filename);
 		#endif
 		}
+		piggy_map_open();
 		N_bitmaps = PHYSFSX_readInt(Piggy_fp);
 
 		header_size = N_bitmaps * sizeof(DiskBitmapHeader);
@@ -963,6 +1133,8 @@ void piggy_new_pigfile(const std::span<char, FILENAME_LEN> pigname)
 		//@@
 		//@@piggy_close_file();
 
+		/* Page in after the bitmaps just read */
+		piggy_bitmap_cache_reset();
 		piggy_write_pigfile(pigname);
 
 		Current_pigfile[0] = 0;                 //say no pig, to force reload
@@ -1075,7 +1247,8 @@ int read_hamfile(d_level_shared_robot_info_state &LevelSharedRobotInfoState)
 			if (piggy_is_needed(i))
 				sbytes += sndh.length;
 		}
-		SoundBits = std::make_unique<ubyte[]>(sbytes + 16);
+		SoundBits = std::make_unique_for_overwrite<ubyte[]>(sbytes + 16);
+		SoundBits_account.set(sbytes + 16);
 	}
 	return 1;
 }
@@ -1124,7 +1297,8 @@ void read_sndfile(const int required)
 		if (piggy_is_needed(i))
 			sbytes += sndh.length;
 	}
-	SoundBits = std::make_unique<ubyte[]>(sbytes + 16);
+	SoundBits = std::make_unique_for_overwrite<ubyte[]>(sbytes + 16);
+	SoundBits_account.set(sbytes + 16);
 }
 
 properties_init_result properties_init(d_level_shared_robot_info_state &LevelSharedRobotInfoState)
@@ -1198,8 +1372,12 @@ void piggy_read_sounds(int pc_shareware)
 	}
 
 	ptr = SoundBits.get();
-
-	std::vector<uint8_t> lastbuf;
+	Piggy_sounds_compressed = pc_shareware;
+	/* Only reserve space for the sounds here.  Each is read by
+	 * piggy_sound_page_in when it is first played, or when paging finds
+	 * that the level uses it.
+	 */
+	Piggy_sound_dest = {};
 	for (i=0; i<Num_sound_files; i++ )
 	{
 		auto &snd = GameSounds[i];
@@ -1208,23 +1386,8 @@ void piggy_read_sounds(int pc_shareware)
 		{
 			if ( piggy_is_needed(i) )
 			{
-				const auto current_sound_offset{d.offset};
-				const auto sound_offset = underlying_value(current_sound_offset);
-				PHYSFS_seek(Piggy_fp, sound_offset);
-
-				// Read in the sound data!!!
-				snd.data = digi_sound::allocated_data{ptr, current_sound_offset};
+				Piggy_sound_dest[i] = ptr;
 				ptr += snd.length;
-		//Arne's decompress for shareware on all soundcards - Tim@Rikers.org
-				if (pc_shareware)
-				{
-					const auto compressed_length = SoundCompressed[i];
-					lastbuf.resize(compressed_length);
-					PHYSFSX_readBytes(Piggy_fp, lastbuf.data(), compressed_length);
-					sound_decompress(lastbuf.data(), compressed_length, snd.data.get());
-				}
-				else
-					PHYSFSX_readBytes(Piggy_fp, snd.data.get(), snd.length);
 			}
 		}
 	}
@@ -1236,32 +1399,157 @@ void piggy_read_sounds(void)
 	int i;
 
 	ptr = SoundBits.get();
-	auto fp = PHYSFSX_openReadBuffered(DEFAULT_SNDFILE).first;
-	if (!fp)
+	Piggy_sound_dest = {};
+	Piggy_sound_map.reset();
+	Piggy_sound_fp = PHYSFSX_openReadBuffered(DEFAULT_SNDFILE).first;
+	if (!Piggy_sound_fp)
 		return;
+	Piggy_sound_map = PHYSFSX_mapReadOnly(Piggy_sound_fp.filename, PHYSFS_fileLength(Piggy_sound_fp));
 
+	/* Only reserve space for the sounds here.  Each is read by
+	 * piggy_sound_page_in when it is first played, or when paging finds
+	 * that the level uses it.
+	 */
 	for (i=0; i<Num_sound_files; i++ )      {
 		auto &snd = GameSounds[i];
 		auto &d = snd.data.get_deleter();
 		if (!d.must_free_buffer())
 		{
+			snd.data.reset();
 			if ( piggy_is_needed(i) )       {
-				const auto current_sound_offset = snd.data.get_deleter().offset;
-				const auto sound_offset = underlying_value(current_sound_offset);
-				PHYSFS_seek(fp, sound_offset);
-
-				// Read in the sound data!!!
-				snd.data = digi_sound::allocated_data{ptr, current_sound_offset};
+				Piggy_sound_dest[i] = ptr;
 				ptr += snd.length;
-				PHYSFSX_readBytes(fp, snd.data.get(), snd.length);
 			}
-			else
-				snd.data.reset();
 		}
 	}
 }
 #endif
 
+bool piggy_sound_page_in(const sound_effect soundnum)
+{
+	if (soundnum >= Num_sound_files)
+		return false;
+	auto &snd = GameSounds[soundnum];
+	if (snd.data)
+		return true;
+	const auto dest = Piggy_sound_dest[soundnum];
+	auto &d = snd.data.get_deleter();
+	/* A sound replaced by a custom sound owns its data, so it is never
+	 * null here.  Once the replacement is removed, the original is read
+	 * as usual.
+	 */
+	if (!dest || d.must_free_buffer())
+		return false;
+#if DXX_BUILD_DESCENT == 1
+	auto &fp = Piggy_fp;
+	auto &map = Piggy_map;
+	const std::size_t stored_length = Piggy_sounds_compressed ? SoundCompressed[soundnum] : snd.length;
+#elif DXX_BUILD_DESCENT == 2
+	auto &fp = Piggy_sound_fp;
+	auto &map = Piggy_sound_map;
+	const std::size_t stored_length = snd.length;
+#endif
+	if (!fp)
+		return false;
+	const std::size_t offset = underlying_value(d.offset);
+	std::vector<uint8_t> stored;
+	std::span<const uint8_t> source;
+	if (map && offset <= map.get().size() && stored_length <= map.get().size() - offset)
+		source = map.get().subspan(offset, stored_length);
+	else
+	{
+		stored.resize(stored_length);
+		if (PHYSFS_seek(fp, offset) == 0 || PHYSFSX_readBytes(fp, stored.data(), stored_length) != static_cast<PHYSFS_sint64>(stored_length))
+		{
+			con_printf(CON_URGENT, "Failed to read sound %u from \"%s\"", soundnum, fp.filename);
+			Piggy_sound_dest[soundnum] = nullptr;
+			return false;
+		}
+		source = stored;
+	}
+#if DXX_BUILD_DESCENT == 1
+	//Arne's decompress for shareware on all soundcards - Tim@Rikers.org
+	if (Piggy_sounds_compressed)
+	{
+		/* sound_decompress takes its input as non-const */
+		if (stored.empty())
+			stored.assign(source.begin(), source.end());
+		sound_decompress(stored.data(), stored.size(), dest);
+	}
+	else
+#endif
+		std::copy(source.begin(), source.end(), dest);
+	Piggy_sound_dest[soundnum] = nullptr;
+	snd.data = digi_sound::allocated_data{dest, d.offset};
+	return true;
+}
+
+namespace {
+
+/* Mac PIG data has colours 0 and 255 swapped, and swapping them back
+ * can change the size of an RLE bitmap, so its place in the cache is
+ * only known after it is read.
+ */
+static bool piggy_pig_needs_swap()
+{
+#if DXX_BUILD_DESCENT == 1
+	return MacPig;
+#elif DXX_BUILD_DESCENT == 2
+#ifndef MACDATA
+	switch (pigfile_size{piggy_page_file_length()})
+	{
+		default:
+			return GameArg.EdiMacData;
+		case pigfile_size::mac_alien1_pigsize:
+		case pigfile_size::mac_alien2_pigsize:
+		case pigfile_size::mac_fire_pigsize:
+		case pigfile_size::mac_groupa_pigsize:
+		case pigfile_size::mac_ice_pigsize:
+		case pigfile_size::mac_water_pigsize:
+			return true;
+	}
+#else
+	return false;
+#endif
+#endif
+}
+
+/* Tells Piggy_bitmap_cache what became of the bitmaps in its way */
+struct piggy_bitmap_cache_policy
+{
+	GameBitmaps_array &GameBitmaps;
+	void before_reclaim() const
+	{
+#if !DXX_USE_OGL
+		tmap_tiles_flush();
+#endif
+	}
+	bitmap_cache_ring_use use(const bitmap_cache_ring::entry &e) const
+	{
+		const bitmap_index b{e.id};
+		auto &bm = GameBitmaps[b];
+		/* Paged out since, or replaced by a custom bitmap */
+		if (bm.get_flag_mask(BM_FLAG_PAGED_OUT) || bm.bm_data != Piggy_bitmap_cache.data(e))
+			return bitmap_cache_ring_use::stale;
+		return std::exchange(Piggy_bitmap_used[b], 0) ? bitmap_cache_ring_use::hot : bitmap_cache_ring_use::cold;
+	}
+	void evict(const bitmap_cache_ring::entry &e) const
+	{
+		auto &bm = GameBitmaps[bitmap_index{e.id}];
+		bm.set_flags(BM_FLAG_PAGED_OUT);
+		gr_set_bitmap_data(bm, nullptr);
+	}
+	void moved(const bitmap_cache_ring::entry &e) const
+	{
+		/* The pixels are unchanged, so the texture made from them, and
+		 * any merged or expanded copy, is still good.
+		 */
+		GameBitmaps[bitmap_index{e.id}].bm_mdata = Piggy_bitmap_cache.data(e);
+	}
+};
+
+}
+
 void piggy_bitmap_page_in(GameBitmaps_array &GameBitmaps, const bitmap_index entry_bitmap_index)
 {
 	const auto i = underlying_value(entry_bitmap_index);
@@ -1283,109 +1571,45 @@ void piggy_bitmap_page_in(GameBitmaps_array &GameBitmaps, const bitmap_index ent
 	{
 		pause_game_world_time p;
 
-	ReDoIt:
-		PHYSFS_seek(Piggy_fp, static_cast<unsigned>(GameBitmapOffset[xlat_bitmap_index]));
+		piggy_page_seek(static_cast<unsigned>(GameBitmapOffset[xlat_bitmap_index]));
 
 		gr_set_bitmap_flags(*bmp, GameBitmapFlags[xlat_bitmap_index]);
-#if DXX_BUILD_DESCENT == 1
-		gr_set_bitmap_data (*bmp, &Piggy_bitmap_cache_data [Piggy_bitmap_cache_next]);
-#endif
-
+		const bool swap{piggy_pig_needs_swap()};
+		const piggy_bitmap_cache_policy policy{GameBitmaps};
+		std::size_t length;
 		if (bmp->get_flag_mask(BM_FLAG_RLE))
 		{
-			int zsize = PHYSFSX_readInt(Piggy_fp);
+			int zsize = piggy_page_read_int();
+			/* Swapping colours 0 and 255 can make a run of one pixel into
+			 * a run code and a pixel, so leave room for twice the size.
+			 */
+			const auto dest = Piggy_bitmap_cache.reserve(swap ? 2 * zsize : zsize, policy);
+			if (!dest)
+				Error("Bitmap %u needs %i bytes, but the bitmap cache only holds %u", static_cast<unsigned>(i), zsize, static_cast<unsigned>(Piggy_bitmap_cache.size()));
 #if DXX_BUILD_DESCENT == 1
-
-			// GET JOHN NOW IF YOU GET THIS ASSERT!!!
-			Assert( Piggy_bitmap_cache_next+zsize < Piggy_bitmap_cache_size );
-			if ( Piggy_bitmap_cache_next+zsize >= Piggy_bitmap_cache_size ) {
-				piggy_bitmap_page_out_all();
-				goto ReDoIt;
-			}
-			memcpy( &Piggy_bitmap_cache_data[Piggy_bitmap_cache_next], &zsize, sizeof(int) );
-			Piggy_bitmap_cache_next += sizeof(int);
-			PHYSFSX_readBytes(Piggy_fp, &Piggy_bitmap_cache_data[Piggy_bitmap_cache_next], zsize - 4);
-			if (MacPig)
-			{
-				rle_swap_0_255(*bmp);
-				memcpy(&zsize, bmp->bm_data, 4);
-			}
-			Piggy_bitmap_cache_next += zsize-4;
+			memcpy(dest, &zsize, sizeof(int));
 #elif DXX_BUILD_DESCENT == 2
-			const pigfile_size pigsize{static_cast<uint32_t>(PHYSFS_fileLength(Piggy_fp))};
-
-			// GET JOHN NOW IF YOU GET THIS ASSERT!!!
-			//Assert( Piggy_bitmap_cache_next+zsize < Piggy_bitmap_cache_size );
-			if ( Piggy_bitmap_cache_next+zsize >= Piggy_bitmap_cache_size ) {
-				Int3();
-				piggy_bitmap_page_out_all();
-				goto ReDoIt;
-			}
-			PHYSFSX_readBytes(Piggy_fp, &Piggy_bitmap_cache_data[Piggy_bitmap_cache_next + 4], zsize - 4);
-			PUT_INTEL_INT(&Piggy_bitmap_cache_data[Piggy_bitmap_cache_next], zsize);
-			gr_set_bitmap_data(*bmp, &Piggy_bitmap_cache_data[Piggy_bitmap_cache_next]);
-
-#ifndef MACDATA
-			switch (pigsize) {
-			default:
-				if (!GameArg.EdiMacData)
-					break;
-				[[fallthrough]];
-			case pigfile_size::mac_alien1_pigsize:
-			case pigfile_size::mac_alien2_pigsize:
-			case pigfile_size::mac_fire_pigsize:
-			case pigfile_size::mac_groupa_pigsize:
-			case pigfile_size::mac_ice_pigsize:
-			case pigfile_size::mac_water_pigsize:
+			PUT_INTEL_INT(dest, zsize);
+#endif
+			piggy_page_read(dest + 4, zsize - 4);
+			gr_set_bitmap_data(*bmp, dest);
+			if (swap)
+			{
 				rle_swap_0_255(*bmp);
 				memcpy(&zsize, bmp->bm_data, 4);
-				break;
 			}
-#endif
-
-			Piggy_bitmap_cache_next += zsize;
-			if ( Piggy_bitmap_cache_next+zsize >= Piggy_bitmap_cache_size ) {
-				Int3();
-				piggy_bitmap_page_out_all();
-				goto ReDoIt;
-			}
-#endif
-
+			length = zsize;
 		} else {
-			// GET JOHN NOW IF YOU GET THIS ASSERT!!!
-			Assert( Piggy_bitmap_cache_next+(bmp->bm_h*bmp->bm_w) < Piggy_bitmap_cache_size );
-			if ( Piggy_bitmap_cache_next+(bmp->bm_h*bmp->bm_w) >= Piggy_bitmap_cache_size ) {
-				piggy_bitmap_page_out_all();
-				goto ReDoIt;
-			}
-			PHYSFSX_readBytes(Piggy_fp, &Piggy_bitmap_cache_data[Piggy_bitmap_cache_next], bmp->bm_h * bmp->bm_w);
-#if DXX_BUILD_DESCENT == 1
-			Piggy_bitmap_cache_next+=bmp->bm_h*bmp->bm_w;
-			if (MacPig)
-				swap_0_255(*bmp);
-#elif DXX_BUILD_DESCENT == 2
-			const pigfile_size pigsize{static_cast<uint32_t>(PHYSFS_fileLength(Piggy_fp))};
-			gr_set_bitmap_data(*bmp, &Piggy_bitmap_cache_data[Piggy_bitmap_cache_next]);
-			Piggy_bitmap_cache_next+=bmp->bm_h*bmp->bm_w;
-
-#ifndef MACDATA
-			switch (pigsize) {
-			default:
-				if (!GameArg.EdiMacData)
-					break;
-				[[fallthrough]];
-			case pigfile_size::mac_alien1_pigsize:
-			case pigfile_size::mac_alien2_pigsize:
-			case pigfile_size::mac_fire_pigsize:
-			case pigfile_size::mac_groupa_pigsize:
-			case pigfile_size::mac_ice_pigsize:
-			case pigfile_size::mac_water_pigsize:
+			length = bmp->bm_h * bmp->bm_w;
+			const auto dest = Piggy_bitmap_cache.reserve(length, policy);
+			if (!dest)
+				Error("Bitmap %u needs %u bytes, but the bitmap cache only holds %u", static_cast<unsigned>(i), static_cast<unsigned>(length), static_cast<unsigned>(Piggy_bitmap_cache.size()));
+			piggy_page_read(dest, length);
+			gr_set_bitmap_data(*bmp, dest);
+			if (swap)
 				swap_0_255(*bmp);
-				break;
-			}
-#endif
-#endif
 		}
+		Piggy_bitmap_cache.commit(underlying_value(xlat_bitmap_index), length);
 
 		//@@if ( bmp->bm_selector ) {
 		//@@#if !defined(WINDOWS) && !defined(MACINTOSH)
@@ -1397,6 +1621,8 @@ void piggy_bitmap_page_in(GameBitmaps_array &GameBitmaps, const bitmap_index ent
 		compute_average_rgb(bmp, bmp->avg_color_rgb);
 
 	}
+	/* Keep it past the next time the cache reaches it */
+	Piggy_bitmap_used[xlat_bitmap_index] = 1;
 
 	if (CGameArg.SysLowMem)
 	{
@@ -1413,11 +1639,145 @@ void piggy_bitmap_page_in(GameBitmaps_array &GameBitmaps, const bitmap_index ent
 //@@#endif
 }
 
+void piggy_bitmap_request_prefetch(GameBitmaps_array &GameBitmaps, const bitmap_index bmp)
+{
+	const auto i = underlying_value(bmp);
+	if (i < 1 || i >= Num_bitmap_files)
+		return;
+	if (GameBitmapOffset[bmp] == pig_bitmap_offset::None)
+		return;
+	if (!GameBitmaps[bmp].get_flag_mask(BM_FLAG_PAGED_OUT))
+		return;
+	auto &queued = Piggy_prefetch_queued[bmp];
+	if (queued)
+		return;
+	queued = 1;
+	Piggy_prefetch_queue.emplace_back(bmp);
+	/* Start the read now, so that the data is in memory by the time the
+	 * queue is serviced.  The size is exact for an unpacked bitmap, and
+	 * close enough for an RLE one.
+	 */
+	const auto xlat_bitmap_index = CGameArg.SysLowMem ? GameBitmapXlat[bmp] : bmp;
+	auto &xbm = GameBitmaps[xlat_bitmap_index];
+	if (Piggy_map)
+		Piggy_map.prefetch(static_cast<unsigned>(GameBitmapOffset[xlat_bitmap_index]), sizeof(uint32_t) + xbm.bm_w * xbm.bm_h);
+}
+
+std::size_t piggy_bitmap_service_prefetch(GameBitmaps_array &GameBitmaps, const unsigned budget_us)
+{
+	if (Piggy_prefetch_queue.empty())
+		return 0;
+	using clock = std::chrono::steady_clock;
+	const auto deadline{clock::now() + std::chrono::microseconds{budget_us}};
+	auto it = Piggy_prefetch_queue.begin();
+	const auto end = Piggy_prefetch_queue.end();
+	do
+	{
+		const auto bmp = *it;
+		/* Making room pages out only the bitmaps not used since the
+		 * cache last reached them, so a prefetch no longer risks paging
+		 * out the bitmaps in use.
+		 */
+		Piggy_prefetch_queued[bmp] = 0;
+		PIGGY_PAGE_IN(bmp);
+	} while (++it != end && clock::now() < deadline);
+	Piggy_prefetch_queue.erase(Piggy_prefetch_queue.begin(), it);
+	if (Piggy_prefetch_queue.empty())
+		Piggy_prefetch_queued = {};
+	return Piggy_prefetch_queue.size();
+}
+
+void piggy_bitmap_page_in_all(GameBitmaps_array &GameBitmaps, const std::span<bitmap_index> bitmaps)
+{
+	const auto xlat = [](const bitmap_index b) {
+		return CGameArg.SysLowMem ? GameBitmapXlat[b] : b;
+	};
+	/* Keep one of each bitmap that is read from the PIG and paged out,
+	 * in file order.
+	 */
+	const auto [removed_begin, removed_end] = std::ranges::remove_if(bitmaps, [&GameBitmaps](const bitmap_index b) {
+		const auto i = underlying_value(b);
+		return i < 1 || i >= Num_bitmap_files || GameBitmapOffset[b] == pig_bitmap_offset::None || !GameBitmaps[b].get_flag_mask(BM_FLAG_PAGED_OUT);
+	});
+	auto wanted = bitmaps.first(std::distance(bitmaps.begin(), removed_begin));
+	std::ranges::sort(wanted);
+	wanted = wanted.first(std::distance(wanted.begin(), std::ranges::unique(wanted).begin()));
+	std::ranges::stable_sort(wanted, {}, [&xlat](const bitmap_index b) {
+		return static_cast<unsigned>(GameBitmapOffset[xlat(b)]);
+	});
+	std::size_t placed{0};
+	if (Piggy_map && !piggy_pig_needs_swap())
+	{
+		pause_game_world_time p;
+		struct placement
+		{
+			grs_bitmap *bmp;
+			std::size_t offset, length;
+		};
+		std::vector<placement> work;
+		work.reserve(wanted.size());
+		const auto m = Piggy_map.get();
+		const piggy_bitmap_cache_policy policy{GameBitmaps};
+		/* Lay the bitmaps out in the cache here, as the serial page-in
+		 * would.  Placing one may move the ones placed before it, so the
+		 * copy goes to wherever each one is after all are placed.  Stop
+		 * after half the cache, so that no placement reaches one placed
+		 * in this batch a second time, and leave the rest to the serial
+		 * page-in.
+		 */
+		std::size_t placed_bytes{0};
+		for (const auto b : wanted)
+		{
+			const auto x = xlat(b);
+			auto &bm = GameBitmaps[x];
+			if (bm.get_flag_mask(BM_FLAG_PAGED_OUT))
+			{
+				const std::size_t offset{static_cast<unsigned>(GameBitmapOffset[x])};
+				const auto flags = GameBitmapFlags[x];
+				std::size_t length;
+				if (flags & BM_FLAG_RLE)
+				{
+					if (offset + sizeof(uint32_t) > m.size())
+						break;
+					length = GET_INTEL_INT(&m[offset]);
+					if (length < sizeof(uint32_t))
+						break;
+				}
+				else
+					length = bm.bm_w * bm.bm_h;
+				if (offset + length > m.size() || (placed_bytes += length) > Piggy_bitmap_cache.size() / 2)
+					break;
+				const auto dest = Piggy_bitmap_cache.reserve(length, policy);
+				gr_set_bitmap_flags(bm, flags);
+				gr_set_bitmap_data(bm, dest);
+				Piggy_bitmap_cache.commit(underlying_value(x), length);
+				Piggy_bitmap_used[x] = 1;
+				work.emplace_back(placement{&bm, offset, length});
+			}
+			++placed;
+		}
+		parallel_for(work.size(), [&work, m](const std::size_t i) {
+			auto &w = work[i];
+			std::copy_n(std::next(m.begin(), w.offset), w.length, w.bmp->bm_mdata);
+			compute_average_rgb(w.bmp, w.bmp->avg_color_rgb);
+		});
+		if (CGameArg.SysLowMem)
+			for (const auto b : wanted.first(placed))
+				if (const auto x = xlat(b); x != b)
+					GameBitmaps[b] = GameBitmaps[x];
+	}
+	for (const auto b : wanted.subspan(placed))
+		PIGGY_PAGE_IN(b);
+}
+
 namespace {
 
 void piggy_bitmap_page_out_all()
 {
-	Piggy_bitmap_cache_next = 0;
+#if !DXX_USE_OGL
+	tmap_tiles_flush();
+#endif
+	Piggy_bitmap_cache.clear();
 
 	texmerge_flush();
 	rle_cache_flush();
@@ -1432,10 +1792,37 @@ void piggy_bitmap_page_out_all()
 	}
 }
 
+/* Page out every bitmap, and give the pages of the cache back to the
+ * system.  Each bitmap is paged in again when it is next used.  Returns
+ * the bytes given back.
+ */
+std::size_t piggy_bitmap_cache_trim()
+{
+	Piggy_prefetch_queue.clear();
+	Piggy_prefetch_queued = {};
+	piggy_bitmap_page_out_all();
+#ifdef _WIN32
+	return 0;
+#else
+	/* The bitmaps at the start of the cache were not read from the pig,
+	 * and stay.
+	 */
+	const uintptr_t page{static_cast<uintptr_t>(sysconf(_SC_PAGESIZE))};
+	const uintptr_t begin{(reinterpret_cast<uintptr_t>(Piggy_bitmap_cache_data + Piggy_bitmap_cache_next) + page - 1) & ~(page - 1)};
+	const uintptr_t end{reinterpret_cast<uintptr_t>(Piggy_bitmap_cache_data + Piggy_bitmap_cache_size) & ~(page - 1)};
+	if (end <= begin || madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED))
+		return 0;
+	return end - begin;
+#endif
+}
+
 }
 
 void piggy_load_level_data()
 {
+	const load_trace_span trace{"piggy_load_level_data"};
+	Piggy_prefetch_queue.clear();
+	Piggy_prefetch_queued = {};
 	piggy_bitmap_page_out_all();
 	paging_touch_all(Vclip);
 }
@@ -1568,6 +1955,87 @@ static void write_int(int i, PHYSFS_File *file)
 static void free_bitmap_replacements()
 {
 	Bitmap_replacement_data.reset();
+	Bitmap_replacement_account.set(0);
+}
+
+/* Put back the bitmaps replaced from a POG file, paged out so that they
+ * are read from the pig again when used.
+ */
+static void restore_pog_replacements()
+{
+	auto &r = Pog_replacements;
+	if (!r.applied)
+		return;
+	r.applied = false;
+	/* In reverse, so that an index replaced twice ends as it began */
+	for (std::size_t k = r.originals.size(); k--;)
+	{
+		const bitmap_index bi{r.indices[k]};
+		auto &bm = GameBitmaps[bi];
+		gr_set_bitmap_data(bm, nullptr);	// free ogl texture
+		bm = r.originals[k];
+		GameBitmapOffset[bi] = r.original_offsets[k];
+		if (GameBitmapOffset[bi] != pig_bitmap_offset::None)
+		{
+			/* The pig cache may have been reused since */
+			bm.set_flags(BM_FLAG_PAGED_OUT);
+			gr_set_bitmap_data(bm, nullptr);
+		}
+	}
+	r.originals.clear();
+	r.original_offsets.clear();
+	texmerge_flush();
+}
+
+static void apply_pog_replacements()
+{
+	auto &r = Pog_replacements;
+	r.originals.clear();
+	r.original_offsets.clear();
+	for (auto &&[i, bmh] : zip(r.indices, r.headers))
+	{
+		const bitmap_index bi{i};
+		grs_bitmap *const bm = &GameBitmaps[bi];
+		int width;
+
+		width = bmh.width + (static_cast<short>(bmh.wh_extra & 0x0f) << 8);
+		const auto original_data = bm->bm_data;
+		gr_set_bitmap_data(*bm, NULL);	// free ogl texture
+		r.originals.emplace_back(*bm).bm_data = original_data;
+		r.original_offsets.emplace_back(GameBitmapOffset[bi]);
+		gr_init_bitmap(*bm, bm_mode::linear, 0, 0, width, bmh.height + (static_cast<short>(bmh.wh_extra & 0xf0) << 4), width, &r.contents[r.data_start + bmh.offset]);
+#if !DXX_USE_OGL
+		bm->avg_color = bmh.avg_color;
+#endif
+
+		gr_set_bitmap_flags(*bm, bmh.flags & BM_FLAGS_TO_COPY);
+		GameBitmapOffset[bi] = pig_bitmap_offset::None; // don't try to read bitmap from current pigfile
+	}
+	r.applied = true;
+	texmerge_flush();       //for re-merging with new textures
+}
+
+/* Read the POG file `ifile` into `r`.  Returns false if it is not a POG
+ * file.
+ */
+static bool read_pog_replacements(const NamedPHYSFS_File ifile, pog_replacements &r)
+{
+	const auto id = PHYSFSX_readInt(ifile);
+	const auto version = PHYSFSX_readInt(ifile);
+
+	if (id != MAKE_SIG('G','O','P','D') || version != 1)
+		return false;
+
+	const unsigned n_bitmaps = PHYSFSX_readInt(ifile);
+
+	r.indices.resize(n_bitmaps);
+	for (auto &i : r.indices)
+		i = PHYSFSX_readSLE16(ifile);
+	r.headers.resize(n_bitmaps);
+	for (auto &bmh : r.headers)
+		bmh = DiskBitmapHeader_read(ifile);
+	r.data_start = PHYSFS_tell(ifile);
+	return true;
 }
 #endif
 }
@@ -1579,11 +2047,19 @@ void piggy_close()
 #endif
 	piggy_close_file();
 	BitmapBits.reset();
+	BitmapBits_account.set(0);
+	Piggy_sound_dest = {};
+#if DXX_BUILD_DESCENT == 2
+	Piggy_sound_map.reset();
+	Piggy_sound_fp.reset();
+#endif
 	SoundBits.reset();
+	SoundBits_account.set(0);
 	for (auto &gs : partial_range(GameSounds, Num_sound_files))
 		gs.data.reset();
 #if DXX_BUILD_DESCENT == 2
 	free_bitmap_replacements();
+	Pog_replacements = {};
 	free_d1_tmap_nums();
 #endif
 }
@@ -1705,62 +2181,56 @@ void load_bitmap_replacements(const std::span<const char, FILENAME_LEN> level_na
 	//first, free up data allocated for old bitmaps
 	free_bitmap_replacements();
 
+	auto &r = Pog_replacements;
 	std::array<char, FILENAME_LEN> ifile_name;
-	if (!change_filename_extension(ifile_name, level_name.data(), "POG"))
+	const auto file_length = change_filename_extension(ifile_name, level_name.data(), "POG")
+		? PHYSFSX_fsize(ifile_name.data())
+		: -1;
+	if (file_length < 0)
+	{
+		restore_pog_replacements();
 		return;
-	if (auto ifile = PHYSFSX_openReadBuffered(ifile_name.data()).first)
+	}
+	/* A POG of the same name and size as the last one is taken to be the
+	 * same file, and is not read again.
+	 */
+	if (d_stricmp(r.filename.data(), ifile_name.data()) || r.file_length != file_length)
 	{
-		int id,version;
-		unsigned n_bitmaps;
-		int bitmap_data_size;
-
-		id = PHYSFSX_readInt(ifile);
-		version = PHYSFSX_readInt(ifile);
-
-		if (id != MAKE_SIG('G','O','P','D') || version != 1) {
+		auto ifile = PHYSFSX_openReadBuffered(ifile_name.data()).first;
+		if (!ifile)
+		{
+			restore_pog_replacements();
 			return;
 		}
-
-		n_bitmaps = PHYSFSX_readInt(ifile);
-
-		const auto indices = std::make_unique<uint16_t[]>(n_bitmaps);
-		range_for (auto &i, unchecked_partial_range(indices.get(), n_bitmaps))
-			i = PHYSFSX_readSLE16(ifile);
-
-		bitmap_data_size = PHYSFS_fileLength(ifile) - PHYSFS_tell(ifile) - sizeof(DiskBitmapHeader) * n_bitmaps;
-		Bitmap_replacement_data = std::make_unique<ubyte[]>(bitmap_data_size);
-
-		range_for (const auto i, unchecked_partial_range(indices.get(), n_bitmaps))
+		std::vector<uint8_t> contents(file_length);
+		if (PHYSFSX_readBytes(ifile, contents.data(), file_length) != file_length)
 		{
-			const bitmap_index bi{i};
-			grs_bitmap *const bm = &GameBitmaps[bi];
-			int width;
-
-			const auto bmh = DiskBitmapHeader_read(ifile);
-
-			width = bmh.width + (static_cast<short>(bmh.wh_extra & 0x0f) << 8);
-			gr_set_bitmap_data(*bm, NULL);	// free ogl texture
-			gr_init_bitmap(*bm, bm_mode::linear, 0, 0, width, bmh.height + (static_cast<short>(bmh.wh_extra & 0xf0) << 4), width, NULL);
-#if !DXX_USE_OGL
-			bm->avg_color = bmh.avg_color;
-#endif
-			bm->bm_data = reinterpret_cast<uint8_t *>(static_cast<uintptr_t>(bmh.offset));
-
-			gr_set_bitmap_flags(*bm, bmh.flags & BM_FLAGS_TO_COPY);
-			GameBitmapOffset[bi] = pig_bitmap_offset::None; // don't try to read bitmap from current pigfile
+			restore_pog_replacements();
+			return;
 		}
-
-		PHYSFSX_readBytes(ifile, Bitmap_replacement_data, bitmap_data_size);
-
-		range_for (const auto i, unchecked_partial_range(indices.get(), n_bitmaps))
+		/* Levels often ship copies of one POG under each level's name.
+		 * If this one has the same contents as the last, the bitmaps it
+		 * replaces are already in place.
+		 */
+		if (contents != r.contents)
 		{
-			const bitmap_index bi{i};
-			grs_bitmap *const bm = &GameBitmaps[bi];
-			gr_set_bitmap_data(*bm, &Bitmap_replacement_data[reinterpret_cast<uintptr_t>(bm->bm_data)]);
+			restore_pog_replacements();
+			pog_replacements n;
+			PHYSFS_seek(ifile, 0);
+			if (!read_pog_replacements(ifile, n))
+			{
+				r = {};
+				return;
+			}
+			n.contents = std::move(contents);
+			n.contents_account.set(n.contents.size());
+			r = std::move(n);
 		}
-		last_palette_loaded_pig[0]= 0;  //force pig re-load
-		texmerge_flush();       //for re-merging with new textures
+		r.filename = ifile_name;
+		r.file_length = file_length;
 	}
+	if (!r.applied)
+		apply_pog_replacements();
 }
 
 namespace {
@@ -2069,6 +2539,7 @@ void load_d1_bitmap_replacements()
 
 	//first, free up data allocated for old bitmaps
 	free_bitmap_replacements();
+	restore_pog_replacements();
 
 	switch (descent1_pig_size{PHYSFS_fileLength(d1_Piggy_fp)})
 	{
@@ -2117,6 +2588,7 @@ void load_d1_bitmap_replacements()
 		Warning_puts(D1_PIG_LOAD_FAILED);
 		return;
 	}
+	Bitmap_replacement_account.set(D1_BITMAPS_SIZE);
 
 	const auto d1_colormap{build_d1_colormap_from_palette_file()};
 
@@ -83,6 +83,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #define NoFriendlyFireStr "NoFriendlyFire"
 #define MouselookFlagsStr "Mouselook"
 #define PitchLockFlagsStr "PitchLockRelease"
+#define SmoothPositionsStr "SmoothPositions"
 #define AutosaveIntervalStr	"AutosaveInterval"
 #define TrackerStr "Tracker"
 #define TrackerNATHPStr "trackernat"
@@ -354,7 +355,7 @@ static int convert_pattern_array(const std::span<const char> name, const std::sp
 	return 1;
 }
 
-static void print_pattern_array(PHYSFS_File *fout, const char *name, const std::span<const int> array)
+static void print_pattern_array(PHYSFSX_write_buffer &fout, const char *name, const std::span<const int> array)
 {
 	for (std::size_t i = 0; i < array.size(); ++i)
 		PHYSFSX_printf(fout,"%s%" DXX_PRI_size_type "=%d\n", name, i, array[i]);
@@ -774,131 +775,108 @@ void plyr_save_stats(const char *const callsign, int kills, int deaths)
 #endif
 
 namespace {
-static int write_player_dxx(const char *filename)
+static void write_player_dxx(const char *filename)
 {
-	int rc{0};
-	char tempfile[PATH_MAX];
-
-	strcpy(tempfile,filename);
-	tempfile[strlen(tempfile)-4]=0;
-	strcat(tempfile,".pl$");
-	auto fout = PHYSFSX_openWriteBuffered(tempfile).first;
-	if (!fout && CGameArg.SysUsePlayersDir)
-	{
-		PHYSFS_mkdir(PLAYER_DIRECTORY_STRING(""));	//try making directory
-		fout = PHYSFSX_openWriteBuffered(tempfile).first;
-	}
-	
-	if(fout)
-	{
-		PHYSFSX_puts_literal(fout,
-							PLX_OPTION_HEADER_TEXT "\n"
+	PHYSFSX_write_buffer fout;
+	PHYSFSX_puts_literal(fout,
+						PLX_OPTION_HEADER_TEXT "\n"
 #if DXX_BUILD_DESCENT == 1
-							WEAPON_REORDER_HEADER_TEXT "\n"
+						WEAPON_REORDER_HEADER_TEXT "\n"
 #endif
-			);
+		);
 #if DXX_BUILD_DESCENT == 1
-		PHYSFSX_printf(fout,
-					WEAPON_REORDER_PRIMARY_NAME_TEXT "=" WEAPON_REORDER_PRIMARY_VALUE_TEXT "\n"
-					WEAPON_REORDER_SECONDARY_NAME_TEXT "=" WEAPON_REORDER_SECONDARY_VALUE_TEXT "\n",
-					underlying_value(PlayerCfg.PrimaryOrder[0]), underlying_value(PlayerCfg.PrimaryOrder[1]), underlying_value(PlayerCfg.PrimaryOrder[2]), underlying_value(PlayerCfg.PrimaryOrder[3]), underlying_value(PlayerCfg.PrimaryOrder[4]), underlying_value(PlayerCfg.PrimaryOrder[5]),
-					underlying_value(PlayerCfg.SecondaryOrder[0]), underlying_value(PlayerCfg.SecondaryOrder[1]), underlying_value(PlayerCfg.SecondaryOrder[2]), underlying_value(PlayerCfg.SecondaryOrder[3]), underlying_value(PlayerCfg.SecondaryOrder[4]), underlying_value(PlayerCfg.SecondaryOrder[5]));
+	PHYSFSX_printf(fout,
+				WEAPON_REORDER_PRIMARY_NAME_TEXT "=" WEAPON_REORDER_PRIMARY_VALUE_TEXT "\n"
+				WEAPON_REORDER_SECONDARY_NAME_TEXT "=" WEAPON_REORDER_SECONDARY_VALUE_TEXT "\n",
+				underlying_value(PlayerCfg.PrimaryOrder[0]), underlying_value(PlayerCfg.PrimaryOrder[1]), underlying_value(PlayerCfg.PrimaryOrder[2]), underlying_value(PlayerCfg.PrimaryOrder[3]), underlying_value(PlayerCfg.PrimaryOrder[4]), underlying_value(PlayerCfg.PrimaryOrder[5]),
+				underlying_value(PlayerCfg.SecondaryOrder[0]), underlying_value(PlayerCfg.SecondaryOrder[1]), underlying_value(PlayerCfg.SecondaryOrder[2]), underlying_value(PlayerCfg.SecondaryOrder[3]), underlying_value(PlayerCfg.SecondaryOrder[4]), underlying_value(PlayerCfg.SecondaryOrder[5]));
 #endif
-		PHYSFSX_puts_literal(fout,
+	PHYSFSX_puts_literal(fout,
 #if DXX_BUILD_DESCENT == 1
-							END_TEXT "\n"
+						END_TEXT "\n"
 #endif
-							KEYBOARD_HEADER_TEXT "\n");
-		print_pattern_array(fout, SENSITIVITY_NAME_TEXT, PlayerCfg.KeyboardSens);
-		PHYSFSX_puts_literal(fout,
-							END_TEXT "\n"
-							JOYSTICK_HEADER_TEXT "\n"
-							);
-		print_pattern_array(fout, SENSITIVITY_NAME_TEXT, PlayerCfg.JoystickSens);
-		print_pattern_array(fout, LINEAR_NAME_TEXT, PlayerCfg.JoystickLinear);
-		print_pattern_array(fout, SPEED_NAME_TEXT, PlayerCfg.JoystickSpeed);
-		print_pattern_array(fout, DEADZONE_NAME_TEXT, PlayerCfg.JoystickDead);
-		PHYSFSX_puts_literal(fout,
-							END_TEXT "\n"
-							MOUSE_HEADER_TEXT "\n"
-							);
-		PHYSFSX_printf(fout,MOUSE_FLIGHTSIM_NAME_TEXT "=" MOUSE_FLIGHTSIM_VALUE_TEXT "\n",PlayerCfg.MouseFlightSim);
-		print_pattern_array(fout, SENSITIVITY_NAME_TEXT, PlayerCfg.MouseSens);
+						KEYBOARD_HEADER_TEXT "\n");
+	print_pattern_array(fout, SENSITIVITY_NAME_TEXT, PlayerCfg.KeyboardSens);
+	PHYSFSX_puts_literal(fout,
+						END_TEXT "\n"
+						JOYSTICK_HEADER_TEXT "\n"
+						);
+	print_pattern_array(fout, SENSITIVITY_NAME_TEXT, PlayerCfg.JoystickSens);
+	print_pattern_array(fout, LINEAR_NAME_TEXT, PlayerCfg.JoystickLinear);
+	print_pattern_array(fout, SPEED_NAME_TEXT, PlayerCfg.JoystickSpeed);
+	print_pattern_array(fout, DEADZONE_NAME_TEXT, PlayerCfg.JoystickDead);
+	PHYSFSX_puts_literal(fout,
+						END_TEXT "\n"
+						MOUSE_HEADER_TEXT "\n"
+						);
+	PHYSFSX_printf(fout,MOUSE_FLIGHTSIM_NAME_TEXT "=" MOUSE_FLIGHTSIM_VALUE_TEXT "\n",PlayerCfg.MouseFlightSim);
+	print_pattern_array(fout, SENSITIVITY_NAME_TEXT, PlayerCfg.MouseSens);
                 print_pattern_array(fout, MOUSE_OVERRUN_NAME_TEXT, PlayerCfg.MouseOverrun);
-		PHYSFSX_printf(fout,MOUSE_FSDEAD_NAME_TEXT "=" MOUSE_FSDEAD_VALUE_TEXT "\n",PlayerCfg.MouseFSDead);
-		PHYSFSX_printf(fout,MOUSE_FSINDICATOR_NAME_TEXT "=" MOUSE_FSINDICATOR_VALUE_TEXT "\n",PlayerCfg.MouseFSIndicator);
-		PHYSFSX_puts_literal(fout,
-							END_TEXT "\n"
-							WEAPON_KEYv2_HEADER_TEXT "\n"
-							);
-		PHYSFSX_printf(fout,"1=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[0],PlayerCfg.KeySettingsRebirth[1],PlayerCfg.KeySettingsRebirth[2]);
-		PHYSFSX_printf(fout,"2=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[3],PlayerCfg.KeySettingsRebirth[4],PlayerCfg.KeySettingsRebirth[5]);
-		PHYSFSX_printf(fout,"3=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[6],PlayerCfg.KeySettingsRebirth[7],PlayerCfg.KeySettingsRebirth[8]);
-		PHYSFSX_printf(fout,"4=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[9],PlayerCfg.KeySettingsRebirth[10],PlayerCfg.KeySettingsRebirth[11]);
-		PHYSFSX_printf(fout,"5=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[12],PlayerCfg.KeySettingsRebirth[13],PlayerCfg.KeySettingsRebirth[14]);
-		PHYSFSX_printf(fout,"6=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[15],PlayerCfg.KeySettingsRebirth[16],PlayerCfg.KeySettingsRebirth[17]);
-		PHYSFSX_printf(fout,"7=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[18],PlayerCfg.KeySettingsRebirth[19],PlayerCfg.KeySettingsRebirth[20]);
-		PHYSFSX_printf(fout,"8=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[21],PlayerCfg.KeySettingsRebirth[22],PlayerCfg.KeySettingsRebirth[23]);
-		PHYSFSX_printf(fout,"9=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[24],PlayerCfg.KeySettingsRebirth[25],PlayerCfg.KeySettingsRebirth[26]);
-		PHYSFSX_printf(fout,"0=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[27],PlayerCfg.KeySettingsRebirth[28],PlayerCfg.KeySettingsRebirth[29]);
-		PHYSFSX_puts_literal(fout,
-							END_TEXT "\n"
-							COCKPIT_HEADER_TEXT "\n"
-							);
+	PHYSFSX_printf(fout,MOUSE_FSDEAD_NAME_TEXT "=" MOUSE_FSDEAD_VALUE_TEXT "\n",PlayerCfg.MouseFSDead);
+	PHYSFSX_printf(fout,MOUSE_FSINDICATOR_NAME_TEXT "=" MOUSE_FSINDICATOR_VALUE_TEXT "\n",PlayerCfg.MouseFSIndicator);
+	PHYSFSX_puts_literal(fout,
+						END_TEXT "\n"
+						WEAPON_KEYv2_HEADER_TEXT "\n"
+						);
+	PHYSFSX_printf(fout,"1=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[0],PlayerCfg.KeySettingsRebirth[1],PlayerCfg.KeySettingsRebirth[2]);
+	PHYSFSX_printf(fout,"2=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[3],PlayerCfg.KeySettingsRebirth[4],PlayerCfg.KeySettingsRebirth[5]);
+	PHYSFSX_printf(fout,"3=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[6],PlayerCfg.KeySettingsRebirth[7],PlayerCfg.KeySettingsRebirth[8]);
+	PHYSFSX_printf(fout,"4=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[9],PlayerCfg.KeySettingsRebirth[10],PlayerCfg.KeySettingsRebirth[11]);
+	PHYSFSX_printf(fout,"5=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[12],PlayerCfg.KeySettingsRebirth[13],PlayerCfg.KeySettingsRebirth[14]);
+	PHYSFSX_printf(fout,"6=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[15],PlayerCfg.KeySettingsRebirth[16],PlayerCfg.KeySettingsRebirth[17]);
+	PHYSFSX_printf(fout,"7=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[18],PlayerCfg.KeySettingsRebirth[19],PlayerCfg.KeySettingsRebirth[20]);
+	PHYSFSX_printf(fout,"8=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[21],PlayerCfg.KeySettingsRebirth[22],PlayerCfg.KeySettingsRebirth[23]);
+	PHYSFSX_printf(fout,"9=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[24],PlayerCfg.KeySettingsRebirth[25],PlayerCfg.KeySettingsRebirth[26]);
+	PHYSFSX_printf(fout,"0=" WEAPON_KEYv2_VALUE_TEXT "\n",PlayerCfg.KeySettingsRebirth[27],PlayerCfg.KeySettingsRebirth[28],PlayerCfg.KeySettingsRebirth[29]);
+	PHYSFSX_puts_literal(fout,
+						END_TEXT "\n"
+						COCKPIT_HEADER_TEXT "\n"
+						);
 #if DXX_BUILD_DESCENT == 1
-		PHYSFSX_printf(fout, COCKPIT_MODE_NAME_TEXT "=%i\n", underlying_value(PlayerCfg.CockpitMode[0]));
+	PHYSFSX_printf(fout, COCKPIT_MODE_NAME_TEXT "=%i\n", underlying_value(PlayerCfg.CockpitMode[0]));
 #endif
-		PHYSFSX_printf(fout,COCKPIT_HUD_NAME_TEXT "=%u\n", static_cast<unsigned>(PlayerCfg.HudMode));
-		PHYSFSX_printf(fout,COCKPIT_RETICLE_TYPE_NAME_TEXT "=%i\n", underlying_value(PlayerCfg.ReticleType));
-		PHYSFSX_printf(fout,COCKPIT_RETICLE_COLOR_NAME_TEXT "=%i,%i,%i,%i\n",PlayerCfg.ReticleRGBA[0],PlayerCfg.ReticleRGBA[1],PlayerCfg.ReticleRGBA[2],PlayerCfg.ReticleRGBA[3]);
-		PHYSFSX_printf(fout,COCKPIT_RETICLE_SIZE_NAME_TEXT "=%i\n",PlayerCfg.ReticleSize);
-		PHYSFSX_puts_literal(fout,
-							END_TEXT "\n"
-							TOGGLES_HEADER_TEXT "\n"
-							);
+	PHYSFSX_printf(fout,COCKPIT_HUD_NAME_TEXT "=%u\n", static_cast<unsigned>(PlayerCfg.HudMode));
+	PHYSFSX_printf(fout,COCKPIT_RETICLE_TYPE_NAME_TEXT "=%i\n", underlying_value(PlayerCfg.ReticleType));
+	PHYSFSX_printf(fout,COCKPIT_RETICLE_COLOR_NAME_TEXT "=%i,%i,%i,%i\n",PlayerCfg.ReticleRGBA[0],PlayerCfg.ReticleRGBA[1],PlayerCfg.ReticleRGBA[2],PlayerCfg.ReticleRGBA[3]);
+	PHYSFSX_printf(fout,COCKPIT_RETICLE_SIZE_NAME_TEXT "=%i\n",PlayerCfg.ReticleSize);
+	PHYSFSX_puts_literal(fout,
+						END_TEXT "\n"
+						TOGGLES_HEADER_TEXT "\n"
+						);
 #if DXX_BUILD_DESCENT == 1
-		PHYSFSX_printf(fout,TOGGLES_BOMBGAUGE_NAME_TEXT "=%i\n",PlayerCfg.BombGauge);
+	PHYSFSX_printf(fout,TOGGLES_BOMBGAUGE_NAME_TEXT "=%i\n",PlayerCfg.BombGauge);
 #elif DXX_BUILD_DESCENT == 2
-		PHYSFSX_printf(fout,TOGGLES_ESCORTHOTKEYS_NAME_TEXT "=%i\n",PlayerCfg.EscortHotKeys);
-		PHYSFSX_printf(fout, TOGGLES_THIEF_ABSENCE_SP "=%i\n", PlayerCfg.ThiefModifierFlags & ThiefModifier::Absent);
-		PHYSFSX_printf(fout, TOGGLES_THIEF_NO_ENERGY_WEAPONS_SP "=%i\n", PlayerCfg.ThiefModifierFlags & ThiefModifier::NoEnergyWeapons);
+	PHYSFSX_printf(fout,TOGGLES_ESCORTHOTKEYS_NAME_TEXT "=%i\n",PlayerCfg.EscortHotKeys);
+	PHYSFSX_printf(fout, TOGGLES_THIEF_ABSENCE_SP "=%i\n", PlayerCfg.ThiefModifierFlags & ThiefModifier::Absent);
+	PHYSFSX_printf(fout, TOGGLES_THIEF_NO_ENERGY_WEAPONS_SP "=%i\n", PlayerCfg.ThiefModifierFlags & ThiefModifier::NoEnergyWeapons);
 #endif
-		PHYSFSX_printf(fout, TOGGLES_AUTOSAVE_INTERVAL_SP "=%i\n", PlayerCfg.SPGameplayOptions.AutosaveInterval.count());
-		PHYSFSX_printf(fout,TOGGLES_PERSISTENTDEBRIS_NAME_TEXT "=%i\n",PlayerCfg.PersistentDebris);
-		PHYSFSX_printf(fout,TOGGLES_PRSHOT_NAME_TEXT "=%i\n",PlayerCfg.PRShot);
-		PHYSFSX_printf(fout,TOGGLES_NOREDUNDANCY_NAME_TEXT "=%i\n",PlayerCfg.NoRedundancy);
-		PHYSFSX_printf(fout,TOGGLES_MULTIMESSAGES_NAME_TEXT "=%i\n",PlayerCfg.MultiMessages);
-		PHYSFSX_printf(fout,TOGGLES_MULTIPINGHUD_NAME_TEXT "=%i\n",PlayerCfg.MultiPingHud);
-		PHYSFSX_printf(fout,TOGGLES_NORANKINGS_NAME_TEXT "=%i\n",PlayerCfg.NoRankings);
-		PHYSFSX_printf(fout,TOGGLES_AUTOMAPFREEFLIGHT_NAME_TEXT "=%i\n",PlayerCfg.AutomapFreeFlight);
-		PHYSFSX_printf(fout,TOGGLES_NOFIREAUTOSELECT_NAME_TEXT "=%i\n",static_cast<unsigned>(PlayerCfg.NoFireAutoselect));
-		PHYSFSX_printf(fout,TOGGLES_CYCLEAUTOSELECTONLY_NAME_TEXT "=%i\n",PlayerCfg.CycleAutoselectOnly);
+	PHYSFSX_printf(fout, TOGGLES_AUTOSAVE_INTERVAL_SP "=%i\n", PlayerCfg.SPGameplayOptions.AutosaveInterval.count());
+	PHYSFSX_printf(fout,TOGGLES_PERSISTENTDEBRIS_NAME_TEXT "=%i\n",PlayerCfg.PersistentDebris);
+	PHYSFSX_printf(fout,TOGGLES_PRSHOT_NAME_TEXT "=%i\n",PlayerCfg.PRShot);
+	PHYSFSX_printf(fout,TOGGLES_NOREDUNDANCY_NAME_TEXT "=%i\n",PlayerCfg.NoRedundancy);
+	PHYSFSX_printf(fout,TOGGLES_MULTIMESSAGES_NAME_TEXT "=%i\n",PlayerCfg.MultiMessages);
+	PHYSFSX_printf(fout,TOGGLES_MULTIPINGHUD_NAME_TEXT "=%i\n",PlayerCfg.MultiPingHud);
+	PHYSFSX_printf(fout,TOGGLES_NORANKINGS_NAME_TEXT "=%i\n",PlayerCfg.NoRankings);
+	PHYSFSX_printf(fout,TOGGLES_AUTOMAPFREEFLIGHT_NAME_TEXT "=%i\n",PlayerCfg.AutomapFreeFlight);
+	PHYSFSX_printf(fout,TOGGLES_NOFIREAUTOSELECT_NAME_TEXT "=%i\n",static_cast<unsigned>(PlayerCfg.NoFireAutoselect));
+	PHYSFSX_printf(fout,TOGGLES_CYCLEAUTOSELECTONLY_NAME_TEXT "=%i\n",PlayerCfg.CycleAutoselectOnly);
                 PHYSFSX_printf(fout,TOGGLES_CLOAKINVULTIMER_NAME_TEXT "=%i\n",PlayerCfg.CloakInvulTimer);
-		PHYSFSX_printf(fout,TOGGLES_RESPAWN_ANY_KEY "=%i\n",static_cast<unsigned>(PlayerCfg.RespawnMode));
-		PHYSFSX_printf(fout, TOGGLES_MOUSELOOK "=%i\n", PlayerCfg.MouselookFlags);
-		PHYSFSX_printf(fout, TOGGLES_PITCH_LOCK "=%i\n", PlayerCfg.PitchLockFlags);
-		PHYSFSX_puts_literal(fout,
-							END_TEXT "\n"
-							GRAPHICS_HEADER_TEXT "\n"
-							);
-		PHYSFSX_printf(fout,GRAPHICS_ALPHAEFFECTS_NAME_TEXT "=%i\n",PlayerCfg.AlphaEffects);
-		PHYSFSX_printf(fout,GRAPHICS_DYNLIGHTCOLOR_NAME_TEXT "=%i\n",PlayerCfg.DynLightColor);
-		PHYSFSX_puts_literal(fout, END_TEXT "\n"
-							PLX_VERSION_HEADER_TEXT "\n"
-							"plx version=" DXX_VERSION_STR "\n"
-							END_TEXT "\n"
-							END_TEXT "\n"
-							);
-		fout.reset();
-		if(rc==0)
-		{
-			PHYSFS_delete(filename);
-			rc = PHYSFSX_rename(tempfile,filename);
-		}
-		return rc;
-	}
-	else
-		return errno;
+	PHYSFSX_printf(fout,TOGGLES_RESPAWN_ANY_KEY "=%i\n",static_cast<unsigned>(PlayerCfg.RespawnMode));
+	PHYSFSX_printf(fout, TOGGLES_MOUSELOOK "=%i\n", PlayerCfg.MouselookFlags);
+	PHYSFSX_printf(fout, TOGGLES_PITCH_LOCK "=%i\n", PlayerCfg.PitchLockFlags);
+	PHYSFSX_puts_literal(fout,
+						END_TEXT "\n"
+						GRAPHICS_HEADER_TEXT "\n"
+						);
+	PHYSFSX_printf(fout,GRAPHICS_ALPHAEFFECTS_NAME_TEXT "=%i\n",PlayerCfg.AlphaEffects);
+	PHYSFSX_printf(fout,GRAPHICS_DYNLIGHTCOLOR_NAME_TEXT "=%i\n",PlayerCfg.DynLightColor);
+	PHYSFSX_puts_literal(fout, END_TEXT "\n"
+						PLX_VERSION_HEADER_TEXT "\n"
+						"plx version=" DXX_VERSION_STR "\n"
+						END_TEXT "\n"
+						END_TEXT "\n"
+						);
+	PHYSFSX_queueWrite(filename, std::move(fout));
 }
 }
 
@@ -920,6 +898,7 @@ int read_player_file()
 	const auto plr_filename_length{std::snprintf(filename.data(), filename.size(), PLAYER_DIRECTORY_STRING("%.8s.plr"), static_cast<const char *>(InterfaceUniqueState.PilotName))};
 	if (plr_filename_length >= filename.size())
 		return -1;
+	PHYSFSX_waitForQueuedWrites();
 	auto &&[file, physfserr]{PHYSFSX_openReadBuffered(filename.data())};
 	if (!file)
 	{
@@ -1456,182 +1435,98 @@ namespace dsx {
 void write_player_file()
 {
 	char filename[PATH_MAX];
-	int errno_ret;
 
 	if ( Newdemo_state == ND_STATE_PLAYBACK )
 		return;
 
-	errno_ret = WriteConfigFile(CGameCfg, GameCfg);
+	WriteConfigFile(CGameCfg, GameCfg);
 
 	snprintf(filename, sizeof(filename), PLAYER_DIRECTORY_STRING("%.8s.plx"), static_cast<const char *>(InterfaceUniqueState.PilotName));
 	write_player_dxx(filename);
 	snprintf(filename, sizeof(filename), PLAYER_DIRECTORY_STRING("%.8s.plr"), static_cast<const char *>(InterfaceUniqueState.PilotName));
-	auto file = PHYSFSX_openWriteBuffered(filename).first;
-	if (!file)
-		return;
+	PHYSFSX_write_buffer file;
 
 	//Write out player's info
-	PHYSFS_writeULE32(file, SAVE_FILE_ID);
+	file.writeULE32(SAVE_FILE_ID);
 #if DXX_BUILD_DESCENT == 1
-	PHYSFS_writeULE16(file, SAVED_GAME_VERSION);
-	PHYSFS_writeULE16(file, PLAYER_STRUCT_VERSION);
-	PHYSFS_writeSLE32(file, PlayerCfg.NHighestLevels);
-	PHYSFS_writeSLE32(file, underlying_value(PlayerCfg.DefaultDifficulty));
-	PHYSFS_writeSLE32(file, PlayerCfg.AutoLeveling);
-	errno_ret = EZERO;
+	file.writeULE16(SAVED_GAME_VERSION);
+	file.writeULE16(PLAYER_STRUCT_VERSION);
+	file.writeULE32(PlayerCfg.NHighestLevels);
+	file.writeULE32(underlying_value(PlayerCfg.DefaultDifficulty));
+	file.writeULE32(PlayerCfg.AutoLeveling);
 
 	//write higest level info
-	if (const auto count{PlayerCfg.NHighestLevels * sizeof(hli)}; PHYSFSX_writeBytes(file, PlayerCfg.HighestLevels, count) != count)
-	{
-		errno_ret = errno;
-		return;
-	}
-
-	if (PHYSFSX_writeBytes(file, saved_games, sizeof(saved_games)) != sizeof(saved_games))
-	{
-		errno_ret = errno;
-		return;
-	}
-
-	range_for (auto &i, PlayerCfg.NetworkMessageMacro)
-		if (PHYSFSX_writeBytes(file, i.data(), i.size()) != i.size())
-		{
-		errno_ret = errno;
-		return;
-	}
-
-	//write kconfig info
-	{
-		if (PHYSFSX_writeBytes(file, PlayerCfg.KeySettings.Keyboard, sizeof(PlayerCfg.KeySettings.Keyboard)) != sizeof(PlayerCfg.KeySettings.Keyboard))
-			errno_ret=errno;
-#if DXX_MAX_JOYSTICKS
-		auto &KeySettingsJoystick = PlayerCfg.KeySettings.Joystick;
-#else
-		const std::array<uint8_t, MAX_CONTROLS> KeySettingsJoystick{};
-#endif
-		if (PHYSFSX_writeBytes(file, KeySettingsJoystick, sizeof(KeySettingsJoystick)) != sizeof(KeySettingsJoystick))
-			errno_ret=errno;
-		for (unsigned i = 0; i < MAX_CONTROLS*3; i++)
-			if (PHYSFSX_writeBytes(file, "0", sizeof(ubyte)) != sizeof(ubyte)) // Skip obsolete Flightstick/Thrustmaster/Gravis map fields
-				errno_ret=errno;
-		if (PHYSFSX_writeBytes(file, PlayerCfg.KeySettings.Mouse, sizeof(PlayerCfg.KeySettings.Mouse)) != sizeof(PlayerCfg.KeySettings.Mouse))
-			errno_ret=errno;
-		{
-			std::array<uint8_t, MAX_CONTROLS> cyberman{};
-			if (PHYSFSX_writeBytes(file, cyberman.data(), cyberman.size()) != cyberman.size())	// Skip obsolete Cyberman map field
-				errno_ret=errno;
-		}
-	
-		if(errno_ret == EZERO)
-		{
-			ubyte old_avg_joy_sensitivity{8};
-			if (PHYSFSX_writeBytes(file, &PlayerCfg.ControlType, sizeof(ubyte)) != sizeof(ubyte))
-				errno_ret=errno;
-			else if (PHYSFSX_writeBytes(file, &old_avg_joy_sensitivity, sizeof(ubyte)) != sizeof(ubyte))
-				errno_ret=errno;
-		}
-	}
-
-	if (!file.close())
-		errno_ret = errno;
-
-	if (errno_ret != EZERO) {
-		PHYSFS_delete(filename);			//delete bogus file
-		nm_messagebox(menu_title{TXT_ERROR}, {TXT_OK}, "%s\n\n%s",TXT_ERROR_WRITING_PLR, strerror(errno_ret));
-	}
+	file.write(PlayerCfg.HighestLevels.data(), PlayerCfg.NHighestLevels * sizeof(hli));
+	file.write(&saved_games, sizeof(saved_games));
 #elif DXX_BUILD_DESCENT == 2
-	(void)errno_ret;
-	PHYSFS_writeULE16(file, PLAYER_FILE_VERSION);
-
-	
-	PHYSFS_seek(file,PHYSFS_tell(file)+2*(sizeof(PHYSFS_uint16))); // skip Game_window_w, Game_window_h
-	PHYSFSX_writeU8(file, underlying_value(PlayerCfg.DefaultDifficulty));
-	PHYSFSX_writeU8(file, PlayerCfg.AutoLeveling);
-	PHYSFSX_writeU8(file, PlayerCfg.ReticleType == reticle_type::none ? 0 : 1);
-	PHYSFSX_writeU8(file, underlying_value(PlayerCfg.CockpitMode[0]));
-	PHYSFS_seek(file,PHYSFS_tell(file)+sizeof(PHYSFS_uint8)); // skip Default_display_mode
-	PHYSFSX_writeU8(file, static_cast<uint8_t>(PlayerCfg.MissileViewEnabled));
-	PHYSFSX_writeU8(file, PlayerCfg.HeadlightActiveDefault);
-	PHYSFSX_writeU8(file, PlayerCfg.GuidedInBigWindow);
-	PHYSFS_seek(file,PHYSFS_tell(file)+sizeof(PHYSFS_uint8)); // skip Automap_always_hires
+	file.writeULE16(PLAYER_FILE_VERSION);
+	file.skip(2 * sizeof(PHYSFS_uint16)); // skip Game_window_w, Game_window_h
+	file.writeU8(underlying_value(PlayerCfg.DefaultDifficulty));
+	file.writeU8(PlayerCfg.AutoLeveling);
+	file.writeU8(PlayerCfg.ReticleType == reticle_type::none ? 0 : 1);
+	file.writeU8(underlying_value(PlayerCfg.CockpitMode[0]));
+	file.skip(sizeof(PHYSFS_uint8)); // skip Default_display_mode
+	file.writeU8(static_cast<uint8_t>(PlayerCfg.MissileViewEnabled));
+	file.writeU8(PlayerCfg.HeadlightActiveDefault);
+	file.writeU8(PlayerCfg.GuidedInBigWindow);
+	file.skip(sizeof(PHYSFS_uint8)); // skip Automap_always_hires
 
 	//write higest level info
-	PHYSFS_writeULE16(file, PlayerCfg.NHighestLevels);
-	if (const auto count{sizeof(hli) * PlayerCfg.NHighestLevels}; PHYSFSX_writeBytes(file, PlayerCfg.HighestLevels, count) != count)
-		goto write_player_file_failed;
+	file.writeULE16(PlayerCfg.NHighestLevels);
+	file.write(PlayerCfg.HighestLevels.data(), sizeof(hli) * PlayerCfg.NHighestLevels);
+#endif
 
 	range_for (auto &i, PlayerCfg.NetworkMessageMacro)
-		if (PHYSFSX_writeBytes(file, i.data(), i.size()) != i.size())
-		goto write_player_file_failed;
+		file.write(i.data(), i.size());
 
 	//write kconfig info
 	{
-
-		ubyte old_avg_joy_sensitivity{8};
-		ubyte control_type_dos = PlayerCfg.ControlType;
-
-		if (PHYSFSX_writeBytes(file, PlayerCfg.KeySettings.Keyboard, sizeof(PlayerCfg.KeySettings.Keyboard)) != sizeof(PlayerCfg.KeySettings.Keyboard))
-			goto write_player_file_failed;
+		file.write(&PlayerCfg.KeySettings.Keyboard, sizeof(PlayerCfg.KeySettings.Keyboard));
 #if DXX_MAX_JOYSTICKS
 		auto &KeySettingsJoystick = PlayerCfg.KeySettings.Joystick;
 #else
 		const std::array<uint8_t, MAX_CONTROLS> KeySettingsJoystick{};
 #endif
-		if (PHYSFSX_writeBytes(file, KeySettingsJoystick, sizeof(KeySettingsJoystick)) != sizeof(KeySettingsJoystick))
-			goto write_player_file_failed;
+		file.write(&KeySettingsJoystick, sizeof(KeySettingsJoystick));
 		for (unsigned i = 0; i < MAX_CONTROLS*3; i++)
-			if (PHYSFSX_writeBytes(file, "0", sizeof(ubyte)) != sizeof(ubyte)) // Skip obsolete Flightstick/Thrustmaster/Gravis map fields
-				goto write_player_file_failed;
-		if (PHYSFSX_writeBytes(file, PlayerCfg.KeySettings.Mouse, sizeof(PlayerCfg.KeySettings.Mouse)) != sizeof(PlayerCfg.KeySettings.Mouse))
-			goto write_player_file_failed;
+			file.write("0", sizeof(ubyte)); // Skip obsolete Flightstick/Thrustmaster/Gravis map fields
+		file.write(&PlayerCfg.KeySettings.Mouse, sizeof(PlayerCfg.KeySettings.Mouse));
+#if DXX_BUILD_DESCENT == 1
+		file.skip(MAX_CONTROLS);	// Skip obsolete Cyberman map field
+		file.writeU8(PlayerCfg.ControlType);
+		file.writeU8(8);	// old_avg_joy_sensitivity
+#elif DXX_BUILD_DESCENT == 2
 		for (unsigned i = 0; i < MAX_CONTROLS*2; i++)
-			if (PHYSFSX_writeBytes(file, "0", sizeof(ubyte)) != sizeof(ubyte)) // Skip obsolete Cyberman/Winjoy map fields
-				goto write_player_file_failed;
-		if (PHYSFSX_writeBytes(file, &control_type_dos, sizeof(ubyte)) != sizeof(ubyte))
-			goto write_player_file_failed;
-		ubyte control_type_win{0};
-		if (PHYSFSX_writeBytes(file, &control_type_win, sizeof(ubyte)) != sizeof(ubyte))
-			goto write_player_file_failed;
-		if (PHYSFSX_writeBytes(file, &old_avg_joy_sensitivity, sizeof(ubyte)) != sizeof(ubyte))
-			goto write_player_file_failed;
+			file.write("0", sizeof(ubyte)); // Skip obsolete Cyberman/Winjoy map fields
+		file.writeU8(PlayerCfg.ControlType);	// control_type_dos
+		file.writeU8(0);	// control_type_win
+		file.writeU8(8);	// old_avg_joy_sensitivity
 
 		range_for (const unsigned i, xrange(11u))
 		{
-			PHYSFSX_writeBytes(file, &PlayerCfg.PrimaryOrder[i], sizeof(ubyte));
-			PHYSFSX_writeBytes(file, &PlayerCfg.SecondaryOrder[i], sizeof(ubyte));
+			file.writeU8(underlying_value(PlayerCfg.PrimaryOrder[i]));
+			file.writeU8(underlying_value(PlayerCfg.SecondaryOrder[i]));
 		}
 
-		PHYSFS_writeULE32(file, static_cast<unsigned>(PlayerCfg.Cockpit3DView[gauge_inset_window_view::primary]));
-		PHYSFS_writeULE32(file, static_cast<unsigned>(PlayerCfg.Cockpit3DView[gauge_inset_window_view::secondary]));
+		file.writeULE32(static_cast<unsigned>(PlayerCfg.Cockpit3DView[gauge_inset_window_view::primary]));
+		file.writeULE32(static_cast<unsigned>(PlayerCfg.Cockpit3DView[gauge_inset_window_view::secondary]));
 
-		PHYSFS_writeULE32(file, PlayerCfg.NetlifeKills);
-		PHYSFS_writeULE32(file, PlayerCfg.NetlifeKilled);
-		int i=get_lifetime_checksum (PlayerCfg.NetlifeKills,PlayerCfg.NetlifeKilled);
-		PHYSFS_writeULE32(file, i);
+		file.writeULE32(PlayerCfg.NetlifeKills);
+		file.writeULE32(PlayerCfg.NetlifeKilled);
+		file.writeULE32(get_lifetime_checksum(PlayerCfg.NetlifeKills, PlayerCfg.NetlifeKilled));
+#endif
 	}
 
+#if DXX_BUILD_DESCENT == 2
 	//write guidebot name
-	PHYSFSX_writeString(file, PlayerCfg.GuidebotNameReal);
-
-	{
-		char buf[128];
-		strcpy(buf, "DOS joystick");
-		PHYSFSX_writeString(file, buf);		// Write out current joystick for player.
-	}
-
-	if (!file.close())
-		goto write_player_file_failed;
-
-	return;
-
- write_player_file_failed:
-	nm_messagebox(menu_title{TXT_ERROR}, {TXT_OK}, "%s\n\n%s", TXT_ERROR_WRITING_PLR, PHYSFS_getLastError());
-	if (file)
+	file.write(PlayerCfg.GuidebotNameReal.data(), strlen(PlayerCfg.GuidebotNameReal) + 1);
 	{
-		file.reset();
-		PHYSFS_delete(filename);        //delete bogus file
+		static const char joystick_name[]{"DOS joystick"};
+		file.write(joystick_name, sizeof(joystick_name));		// Write out current joystick for player.
 	}
 #endif
+
+	PHYSFSX_queueWrite(filename, std::move(file));
 }
 
 namespace {
@@ -1669,6 +1564,7 @@ void read_netgame_profile(netgame_info *ng)
 #endif
 
 	snprintf(filename, sizeof(filename), PLAYER_DIRECTORY_STRING("%.8s.ngp"), static_cast<const char *>(InterfaceUniqueState.PilotName));
+	PHYSFSX_waitForQueuedWrites();
 	auto file = PHYSFSX_openReadBuffered(filename).first;
 	if (!file)
 		return;
@@ -1761,6 +1657,8 @@ void read_netgame_profile(netgame_info *ng)
 			convert_integer(ng->MouselookFlags, value);
 		else if (compare_nonterminated_name(name, PitchLockFlagsStr))
 			convert_integer(ng->PitchLockFlags, value);
+		else if (compare_nonterminated_name(name, SmoothPositionsStr))
+			convert_integer(ng->SmoothPositions, value);
 		else if (compare_nonterminated_name(name, AutosaveIntervalStr))
 		{
 			if (const auto r = convert_integer<uint16_t>(value))
@@ -1783,9 +1681,7 @@ void write_netgame_profile(const netgame_info *ng)
 {
 	char filename[PATH_MAX];
 	snprintf(filename, sizeof(filename), PLAYER_DIRECTORY_STRING("%.8s.ngp"), static_cast<const char *>(InterfaceUniqueState.PilotName));
-	auto file = PHYSFSX_openWriteBuffered(filename).first;
-	if (!file)
-		return;
+	PHYSFSX_write_buffer file;
 
 	PHYSFSX_printf(file, GameNameStr "=%s\n", ng->game_name.data());
 	PHYSFSX_printf(file, GameModeStr "=%i\n", underlying_value(ng->gamemode));
@@ -1815,6 +1711,7 @@ void write_netgame_profile(const netgame_info *ng)
 	PHYSFSX_printf(file, NoFriendlyFireStr "=%i\n", ng->NoFriendlyFire);
 	PHYSFSX_printf(file, MouselookFlagsStr "=%i\n", ng->MouselookFlags);
 	PHYSFSX_printf(file, PitchLockFlagsStr "=%i\n", ng->PitchLockFlags);
+	PHYSFSX_printf(file, SmoothPositionsStr "=%i\n", ng->SmoothPositions);
 	PHYSFSX_printf(file, AutosaveIntervalStr "=%i\n", ng->MPGameplayOptions.AutosaveInterval.count());
 #if DXX_USE_TRACKER
 	PHYSFSX_printf(file, TrackerStr "=%i\n", ng->Tracker);
@@ -1823,6 +1720,7 @@ void write_netgame_profile(const netgame_info *ng)
 	PHYSFSX_puts_literal(file, TrackerStr "=0\n" TrackerNATHPStr "=0\n");
 #endif
 	PHYSFSX_puts_literal(file, NGPVersionStr "=" DXX_VERSION_STR "\n");
+	PHYSFSX_queueWrite(filename, std::move(file));
 }
 #endif
 
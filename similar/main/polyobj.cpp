@@ -401,6 +401,7 @@ static
 void free_model(polymodel &po)
 {
 	po.model_data.reset();
+	po.draw_list.ops = {};
 }
 
 }
@@ -467,8 +468,14 @@ void draw_polygon_model(grs_canvas &canvas, const tmap_drawer_type tmap_drawer_p
 
 	polygon_model_points robot_points;
 
+	const auto &draw_list = po->draw_list;
 	if (subobj_flags == 0)		//draw entire object
-		g3_draw_polygon_model(texture_list.data(), robot_points, canvas, tmap_drawer_ptr, anim_angles, light, glow_values, po->model_data.get());
+	{
+		if (!draw_list.ops.empty())
+			g3_draw_polygon_model(texture_list.data(), robot_points, canvas, tmap_drawer_ptr, anim_angles, light, glow_values, draw_list[draw_list.model]);
+		else
+			g3_draw_polygon_model(texture_list.data(), robot_points, canvas, tmap_drawer_ptr, anim_angles, light, glow_values, po->model_data.get());
+	}
 
 	else {
 		auto flags{subobj_flags};
@@ -478,7 +485,10 @@ void draw_polygon_model(grs_canvas &canvas, const tmap_drawer_type tmap_drawer_p
 
 				//if submodel, rotate around its center point, not pivot point
 				auto &&subctx = g3_start_instance_matrix();
-				g3_draw_polygon_model(texture_list.data(), robot_points, canvas, tmap_drawer_ptr, anim_angles, light, glow_values, &po->model_data[po->submodel_ptrs[i]]);
+				if (!draw_list.ops.empty())
+					g3_draw_polygon_model(texture_list.data(), robot_points, canvas, tmap_drawer_ptr, anim_angles, light, glow_values, draw_list[draw_list.submodels[i]]);
+				else
+					g3_draw_polygon_model(texture_list.data(), robot_points, canvas, tmap_drawer_ptr, anim_angles, light, glow_values, &po->model_data[po->submodel_ptrs[i]]);
 				g3_done_instance(subctx);
 			}	
 	}
@@ -591,6 +601,7 @@ polygon_model_index load_polygon_model(const char *filename, int n_textures, int
 
 	if (highest_texture_num+1 != n_textures)
 		Error("Model <%s> references %d textures but specifies %d.",filename,highest_texture_num+1,n_textures);
+	build_polygon_model_draw_list(model);
 
 	model.n_textures = n_textures;
 	model.first_texture = first_texture;
@@ -642,6 +653,7 @@ ASSERT_SERIAL_UDT_MESSAGE_SIZE(polymodel, 12 + (10 * 4) + (10 * 3 * sizeof(vms_v
 void polymodel_read(polymodel &pm, const NamedPHYSFS_File fp)
 {
 	pm.model_data.reset();
+	pm.draw_list.ops = {};
 	PHYSFSX_serialize_read(fp, pm);
 }
 
@@ -678,6 +690,7 @@ void polygon_model_data_read(polymodel *pm, PHYSFS_File *fp)
 #elif DXX_BUILD_DESCENT == 2
 	g3_init_polygon_model(std::span{pm->model_data.get(), model_data_size});
 #endif
+	build_polygon_model_draw_list(*pm);
 }
 
 polygon_model_index build_polygon_model_index_from_untrusted(const unsigned i)
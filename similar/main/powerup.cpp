@@ -37,6 +37,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "object.h"
 #include "game.h"
 #include "fireball.h"
+#include "particle.h"
 #include "powerup.h"
 #include "gauges.h"
 #include "sounds.h"
@@ -68,15 +69,15 @@ uint8_t N_powerup_types;
 namespace dsx {
 d_powerup_info_array Powerup_info;
 
-//process this powerup for this frame
-void do_powerup_frame(const d_vclip_array &Vclip, const vmobjptridx_t obj)
+//animate this powerup for this frame
+void do_powerup_animation(const d_vclip_array &Vclip, object_base &obj, const objnum_t objnum)
 {
-	vclip_info *vci = &obj->rtype.vclip_info;
+	vclip_info *vci = &obj.rtype.vclip_info;
 
 #if DXX_BUILD_DESCENT == 1
 	const fix fudge = 0;
+	(void)objnum;
 #elif DXX_BUILD_DESCENT == 2
-	long objnum = obj;
 	const fix fudge = (FrameTime * (objnum&3)) >> 4;
 #endif
 	
@@ -109,9 +110,12 @@ void do_powerup_frame(const d_vclip_array &Vclip, const vmobjptridx_t obj)
 		}
 	}
 	}
+}
 
+void do_powerup_frame(const d_vclip_array &Vclip, const vmobjptridx_t obj)
+{
 	if (obj->lifeleft <= 0) {
-		object_create_explosion_without_damage(Vclip, vmsegptridx(obj->segnum), obj->pos, F1_0 * 7 / 2, vclip_index::powerup_disappearance);
+		create_cosmetic_explosion(Vclip, vmsegptridx(obj->segnum), obj->pos, F1_0 * 7 / 2, vclip_index::powerup_disappearance);
 
 		if (const auto sound_num{Vclip[vclip_index::powerup_disappearance].sound_num}; sound_num != sound_effect::None)
 			digi_link_sound_to_object(sound_num, obj, 0, F1_0, sound_stack::allow_stacking);
@@ -507,6 +511,7 @@ int do_powerup(const vmobjptridx_t obj)
 				 * false, so that the cannon can remain in the mine.
 				 */
 				obj->ctype.powerup_info.count -= ammo_used;
+				MultiLevelInv_ObjectChanged(obj.get_unchecked_index());
 				if (!used)
 				{
 					powerup_basic(7, 14, 21, VULCAN_AMMO_SCORE, "%s!", TXT_VULCAN_AMMO);
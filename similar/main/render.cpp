@@ -25,6 +25,10 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 #include <algorithm>
 #include <bitset>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <limits>
 #include <cstdlib>
 #include <stdio.h>
@@ -53,8 +57,10 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "endlevel.h"
 #include "u_mem.h"
 #include "piggy.h"
+#include "polyobj.h"
 #include "timer.h"
 #include "effects.h"
+#include "particle.h"
 #include "playsave.h"
 #if DXX_USE_OGL
 #include "ogl_init.h"
@@ -69,6 +75,8 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "d_zip.h"
 #include "partial_range.h"
 #include "segiter.h"
+#include "frame_profile.h"
+#include "level_cache.h"
 
 #if DXX_USE_EDITOR
 #include "editor/editor.h"
@@ -107,6 +115,7 @@ static uint16_t s_current_generation;
 #ifndef NDEBUG
 static std::bitset<MAX_OBJECTS> object_rendered;
 #endif
+static render_object_cull_stats Object_cull_stats;
 }
 
 namespace dcx {
@@ -318,6 +327,12 @@ static void render_face(grs_canvas &canvas, const shared_segment &segp, const si
 	const auto control_center_destroyed = LevelUniqueControlCenterState.Control_center_destroyed;
 	const auto need_flashing_lights = (control_center_destroyed | Seismic_tremor_magnitude);	//make lights flash
 	auto &Dynamic_light = LevelUniqueLightState.Dynamic_light;
+#if DXX_USE_OGL
+	//the backend adds dynamic light to static faces itself
+	const auto backend_dynamic_light = ogl_current_static_face.active && ogl_static_lights_enabled();
+#else
+	constexpr std::false_type backend_dynamic_light{};
+#endif
 	//set light values for each vertex & build pointlist
 	for (auto &&[dli, uvli, vpi] : zip(std::span(dyn_light).first(nv), uvl_copy, vp))
 	{
@@ -343,9 +358,12 @@ static void render_face(grs_canvas &canvas, const shared_segment &segp, const si
 		}
 
 		// add light color
-		add_light_and_saturate(dli.r, Dlvpi.r);
-		add_light_and_saturate(dli.g, Dlvpi.g);
-		add_light_and_saturate(dli.b, Dlvpi.b);
+		if (!backend_dynamic_light)
+		{
+			add_light_and_saturate(dli.r, Dlvpi.r);
+			add_light_and_saturate(dli.g, Dlvpi.g);
+			add_light_and_saturate(dli.b, Dlvpi.b);
+		}
 		if (PlayerCfg.AlphaEffects) // due to additive blending, transparent sprites will become invivible in font of white surfaces (lamps). Fix that with a little desaturation
 		{
 			dli.r *= .93;
@@ -463,6 +481,14 @@ static void check_face(grs_canvas &canvas, const vmsegidx_t segnum, const sidenu
 #endif
 }
 
+#if DXX_USE_OGL
+//	Index of a side's first corner in the static geometry buffer
+static constexpr unsigned static_geometry_base(const segnum_t segnum, const sidenum_t sidenum)
+{
+	return (static_cast<unsigned>(segnum) * static_cast<unsigned>(MAX_SIDES_PER_SEGMENT.value) + static_cast<unsigned>(sidenum)) * 4;
+}
+#endif
+
 template <std::size_t... N>
 static inline void check_render_face(grs_canvas &canvas, std::index_sequence<N...>, const vcsegptridx_t segnum, const sidenum_t sidenum, const unsigned facenum, const std::array<vertnum_t, 4> &ovp, const texture1_value tmap1, const texture2_value tmap2, const std::array<uvl, 4> &uvlp, const wall_is_doorway_result wid_flags, const std::size_t nv)
 {
@@ -470,7 +496,19 @@ static inline void check_render_face(grs_canvas &canvas, std::index_sequence<N..
 	const std::array<g3s_uvl, 4> uvl_copy{{
 		{uvlp[N].u, uvlp[N].v, uvlp[N].l}...
 	}};
+#if DXX_USE_OGL
+	/* Editor builds may move vertices after the level was loaded */
+	if (CGameArg.OglStaticGeometry
+#if DXX_USE_EDITOR
+		&& !EditorWindow
+#endif
+	)
+		ogl_current_static_face = {static_geometry_base(segnum, sidenum), {{static_cast<uint8_t>(N)...}}, true};
+#endif
 	render_face(canvas, segnum, sidenum, nv, vp, tmap1, tmap2, uvl_copy, wid_flags);
+#if DXX_USE_OGL
+	ogl_current_static_face.active = false;
+#endif
 	check_face(canvas, segnum, sidenum, facenum, nv, vp, tmap1, tmap2, uvl_copy);
 }
 
@@ -637,7 +675,107 @@ static void render_object_search(grs_canvas &canvas, const d_level_unique_light_
 }
 #endif
 
-static void do_render_object(grs_canvas &canvas, const d_level_unique_light_state &LevelUniqueLightState, const vmobjptridx_t obj, window_rendered_data &window)
+/* Skips the objects that cannot be seen, before they are drawn.  Part of
+ * an object can only be seen through the window of a segment its
+ * bounding sphere reaches into.  Those are the segment it is listed in,
+ * its own segment, and the segments through the sides the sphere
+ * crosses, and through the sides those cross in turn, which covers an
+ * object in a corner.
+ */
+class object_culler
+{
+	fvcsegptr &vcsegptr;
+	fvcvertptr &vcvertptr;
+	const render_state_t &rstate;
+	const rect *listed_window{};
+	void add_window(rect &w, segnum_t segnum) const;
+	rect window_around(const object_base &obj, fix rad) const;
+public:
+	object_culler(fvcsegptr &vcsegptr, fvcvertptr &vcvertptr, const render_state_t &rstate) :
+		vcsegptr{vcsegptr}, vcvertptr{vcvertptr}, rstate{rstate}
+	{
+	}
+	/* Cull the objects listed in a segment seen through `w` */
+	void set_listed_window(const rect &w)
+	{
+		listed_window = &w;
+	}
+	bool visible(const object_base &obj) const;
+};
+
+void object_culler::add_window(rect &w, const segnum_t segnum) const
+{
+	if (rstate.render_pos[segnum] == -1)
+		return;
+	const auto i{rstate.render_seg_map.find(segnum)};
+	if (i == rstate.render_seg_map.end())
+		return;
+	const auto &sw{i->second.render_window};
+	w.left = std::min(w.left, sw.left);
+	w.top = std::min(w.top, sw.top);
+	w.right = std::max(w.right, sw.right);
+	w.bot = std::max(w.bot, sw.bot);
+}
+
+rect object_culler::window_around(const object_base &obj, const fix rad) const
+{
+	auto w{*listed_window};
+	add_window(w, obj.segnum);
+	const auto crossed = [this, &obj, rad](const segnum_t segnum, auto &&f) {
+		const auto &&seg{vcsegptr(segnum)};
+		const auto sidemask{get_seg_masks(vcvertptr, obj.pos, seg, rad).sidemask};
+		if (sidemask == sidemask_t{})
+			return;
+		for (const auto sn : MAX_SIDES_PER_SEGMENT)
+			if (+(sidemask & build_sidemask(sn)))
+				if (const auto child{seg->children[sn]}; IS_CHILD(child))
+					f(child);
+	};
+	crossed(obj.segnum, [&](const segnum_t child) {
+		add_window(w, child);
+		crossed(child, [&](const segnum_t grandchild) {
+			add_window(w, grandchild);
+		});
+	});
+	return w;
+}
+
+bool object_culler::visible(const object_base &obj) const
+{
+	if (_search_mode || !listed_window)
+		return true;
+	/* A weapon model is stretched along its length, and its size is its
+	 * width, so use the larger of the two.
+	 */
+	const auto rad{obj.render_type == render_type::RT_POLYOBJ
+		? std::max(obj.size, LevelSharedPolygonModelState.Polygon_models[obj.rtype.pobj_info.model_num].rad)
+		: obj.size};
+	g3_screen_bounds b;
+	switch (g3_project_sphere_bounds(obj.pos, rad, b))
+	{
+		case g3_sphere_projection::behind:
+			++Object_cull_stats.behind;
+			return false;
+		case g3_sphere_projection::near:
+			break;
+		case g3_sphere_projection::bounded:
+		{
+			const auto overlaps = [&b](const rect &w) {
+				return b.right >= w.left && b.left <= w.right && b.bot >= w.top && b.top <= w.bot;
+			};
+			if (!overlaps(*listed_window) && !overlaps(window_around(obj, rad)))
+			{
+				++Object_cull_stats.outside_window;
+				return false;
+			}
+			break;
+		}
+	}
+	++Object_cull_stats.drawn;
+	return true;
+}
+
+static void do_render_object(grs_canvas &canvas, const d_level_unique_light_state &LevelUniqueLightState, const vmobjptridx_t obj, window_rendered_data &window, const object_culler &culler)
 {
 	int count{0};
 
@@ -685,6 +823,7 @@ static void do_render_object(grs_canvas &canvas, const d_level_unique_light_stat
 	else
 	#endif
 		//NOTE LINK TO ABOVE
+	if (culler.visible(obj))
 		render_object(canvas, LevelUniqueLightState, obj);
 
 	for (auto n = obj->attached_obj; n != object_none;)
@@ -695,15 +834,18 @@ static void do_render_object(grs_canvas &canvas, const d_level_unique_light_stat
 		Assert(o->flags & OF_ATTACHED);
 		n = o->ctype.expl_info.next_attach;
 
-		render_object(canvas, LevelUniqueLightState, o);
+		if (culler.visible(o))
+			render_object(canvas, LevelUniqueLightState, o);
 	}
 }
 }
 }
 
-//increment counter for checking if points rotated
-//This must be called at the start of the frame if rotate_list() will be used
-void render_start_frame()
+namespace {
+
+//increment counter for checking if points rotated, so that rotate_list
+//rotates every point again, as it must after the view moves
+static void render_next_point_generation()
 {
 	if (s_current_generation == std::numeric_limits<decltype(s_current_generation)>::max())
 	{
@@ -713,6 +855,20 @@ void render_start_frame()
 	++ s_current_generation;
 }
 
+}
+
+render_object_cull_stats render_take_object_cull_stats()
+{
+	return std::exchange(Object_cull_stats, {});
+}
+
+//This must be called at the start of the frame if rotate_list() will be used
+void render_start_frame()
+{
+	render_next_point_generation();
+	frame_arena_next_frame();
+}
+
 //Given a lit of point numbers, rotate any that haven't been rotated this frame
 g3s_codes rotate_list(fvcvertptr &vcvertptr, const std::span<const vertnum_t> pointnumlist)
 {
@@ -725,6 +881,34 @@ g3s_codes rotate_list(fvcvertptr &vcvertptr, const std::span<const vertnum_t> po
 			: (static_cast<float>(timer_query()) / F0_5)
 	};
 
+	if (likely(!cheats_acid))
+	{
+		/* Gather the points not yet rotated this frame, so that they are
+		 * rotated together
+		 */
+		std::array<vms_vector, MAX_VERTICES_PER_SEGMENT> src;
+		std::array<g3s_point, MAX_VERTICES_PER_SEGMENT> rotated;
+		std::array<g3s_reusable_point *, MAX_VERTICES_PER_SEGMENT> dest;
+		std::size_t n = 0;
+		const auto flush = [&]() {
+			g3_rotate_points(std::span(src).first(n), rotated);
+			for (std::size_t i = 0; i < n; ++i)
+				static_cast<g3s_point &>(*dest[i]) = rotated[i];
+			n = 0;
+		};
+		for (const auto pnum : pointnumlist)
+		{
+			auto &pnt = Segment_points[pnum];
+			if (pnt.p3_last_generation == current_generation)
+				continue;
+			pnt.p3_last_generation = current_generation;
+			src[n] = *vcvertptr(pnum);
+			dest[n] = &pnt;
+			if (++n == src.size())
+				flush();
+		}
+		flush();
+	}
 	for (const auto pnum : pointnumlist)
 	{
 		auto &pnt = Segment_points[pnum];
@@ -732,13 +916,11 @@ g3s_codes rotate_list(fvcvertptr &vcvertptr, const std::span<const vertnum_t> po
 		{
 			pnt.p3_last_generation = current_generation;
 			auto &v = *vcvertptr(pnum);
-			g3_rotate_point(pnt, likely(!cheats_acid) ? v : (
-				vertex{
-					v.x + fl2f(sinf(f + f2fl(v.x))),
-					v.y + fl2f(sinf(f * 1.5f + f2fl(v.y))),
-					v.z + fl2f(sinf(f * 2.5f + f2fl(v.z))),
-				}
-			));
+			g3_rotate_point(pnt, vertex{
+				v.x + fl2f(sinf(f + f2fl(v.x))),
+				v.y + fl2f(sinf(f * 1.5f + f2fl(v.y))),
+				v.z + fl2f(sinf(f * 2.5f + f2fl(v.z))),
+			});
 		}
 		cc.uand &= pnt.p3_codes;
 		cc.uor  |= pnt.p3_codes;
@@ -791,6 +973,202 @@ static void render_segment(fvcvertptr &vcvertptr, fvcwallptr &vcwallptr, const v
 }
 #endif
 
+#if DXX_USE_OGL
+namespace dsx {
+
+//	Called when a level is loaded.  Gather the corners of every side, in
+//	the order render_side passes them to render_face, for the backend's
+//	static vertex buffer.
+void build_static_geometry(fvcsegptridx &vcsegptridx, fvcvertptr &vcvertptr)
+{
+	if (!CGameArg.OglStaticGeometry
+#if DXX_USE_EDITOR
+		|| EditorWindow
+#endif
+	)
+	{
+		ogl_free_static_geometry();
+		return;
+	}
+	std::vector<std::array<float, 3>> corners(static_geometry_base(static_cast<segnum_t>(vcsegptridx.count()), sidenum_t{}));
+	for (const auto &&seg : vcsegptridx)
+		for (const auto sidenum : MAX_SIDES_PER_SEGMENT)
+		{
+			auto *out = &corners[static_geometry_base(seg, sidenum)];
+			for (const auto vn : get_side_verts(seg, sidenum))
+			{
+				auto &v = *vcvertptr(vn);
+				*out++ = {{f2fl(v.x), f2fl(v.y), f2fl(v.z)}};
+			}
+		}
+	ogl_upload_static_geometry(corners);
+}
+
+}
+#endif
+
+namespace dsx {
+
+namespace {
+
+//	One row of bits per segment, with a bit set for every segment that
+//	may be seen from anywhere inside it.  Empty unless -pvs built it for
+//	the current level.
+struct segment_visibility_rows
+{
+	std::size_t stride;
+	std::vector<uint64_t> bits;
+};
+
+segment_visibility_rows Segment_visibility;
+
+struct portal_plane
+{
+	std::array<float, 3> normal;
+	float offset;
+};
+
+struct portal_geometry
+{
+	segnum_t child;
+	uint8_t num_planes;
+	std::array<portal_plane, 2> planes;
+	std::array<std::array<float, 3>, 4> corners;
+};
+
+//	Bump when the rows built for a mine could change
+constexpr uint32_t segment_visibility_cache_version = 1;
+
+//	Corners this close to the inside of a crossed portal still count as
+//	beyond it, to cover rounding and sides that are not quite planar.
+constexpr float portal_plane_margin = 0.5f;
+
+static std::array<float, 3> portal_float_vector(const vms_vector &v)
+{
+	return {{f2fl(v.x), f2fl(v.y), f2fl(v.z)}};
+}
+
+static unsigned portal_index(const std::size_t segnum, const sidenum_t sidenum)
+{
+	return segnum * static_cast<unsigned>(MAX_SIDES_PER_SEGMENT.value) + static_cast<unsigned>(sidenum);
+}
+
+//	A line of sight that passed through `crossed` stays on the far side
+//	of the plane it crossed, so it can only pass through `next` if some
+//	corner of `next` is there too.  Side normals point into the segment,
+//	and for a side with two faces, the crossing may be through either.
+static bool portal_beyond(const portal_geometry &crossed, const portal_geometry &next)
+{
+	for (const auto &c : next.corners)
+		for (const auto &p : std::span(crossed.planes).first(crossed.num_planes))
+			if (p.normal[0] * c[0] + p.normal[1] * c[1] + p.normal[2] * c[2] - p.offset < portal_plane_margin)
+				return true;
+	return false;
+}
+
+}
+
+//	Called when a level is loaded.  For every segment S, walk every chain
+//	of portals that leaves S, ignoring walls, and keep going only while
+//	the next portal is beyond the first two portals of the chain and the
+//	portal just crossed.  Every segment that can be seen from inside S is
+//	reached this way, so build_segment_list may skip the rest.  Walls are
+//	still checked by build_segment_list, so doors need no rebuild.
+//	With -levelcache, the rows are kept in the level cache.
+void build_segment_visibility(fvcsegptridx &vcsegptridx, fvcvertptr &vcvertptr)
+{
+	Segment_visibility = {};
+	if (!CGameArg.SysPortalVisibility
+#if DXX_USE_EDITOR
+		|| EditorWindow
+#endif
+	)
+		return;
+	const std::size_t count = vcsegptridx.count();
+	const std::size_t stride = (count + 63) / 64;
+	std::vector<uint64_t> bits(stride * count);
+	const std::span<uint8_t> cache_bytes{reinterpret_cast<uint8_t *>(bits.data()), bits.size() * sizeof(uint64_t)};
+	if (level_cache_read("pvs", segment_visibility_cache_version, cache_bytes))
+	{
+		Segment_visibility = {stride, std::move(bits)};
+		return;
+	}
+	std::vector<portal_geometry> portals(count * static_cast<unsigned>(MAX_SIDES_PER_SEGMENT.value));
+	for (const auto &&seg : vcsegptridx)
+		for (const auto sidenum : MAX_SIDES_PER_SEGMENT)
+		{
+			auto &p = portals[portal_index(seg, sidenum)];
+			const auto child = seg->shared_segment::children[sidenum];
+			p.child = IS_CHILD(child) ? child : segment_none;
+			auto &side = seg->shared_segment::sides[sidenum];
+			const auto &&[num_faces, vertex_list] = create_abs_vertex_lists(seg, side, sidenum);
+			//	Both faces of a side with two faces share vertex_list[0]
+			const auto base = portal_float_vector(*vcvertptr(vertex_list[0]));
+			p.num_planes = num_faces == vertex_array_side_type::quad ? 1 : 2;
+			for (unsigned f = 0; f < p.num_planes; ++f)
+			{
+				const auto n = portal_float_vector(side.normals[f]);
+				p.planes[f] = {n, n[0] * base[0] + n[1] * base[1] + n[2] * base[2]};
+			}
+			auto *out = p.corners.data();
+			for (const auto vn : get_side_verts(seg, sidenum))
+				*out++ = portal_float_vector(*vcvertptr(vn));
+		}
+	std::vector<uint32_t> seen(portals.size());
+	uint32_t generation = 0;
+	std::vector<unsigned> pending;
+	for (std::size_t s = 0; s < count; ++s)
+	{
+		const auto row = std::span(bits).subspan(s * stride, stride);
+		const auto mark = [row](const std::size_t segnum) {
+			row[segnum / 64] |= uint64_t{1} << (segnum % 64);
+		};
+		mark(s);
+		for (const auto s0 : MAX_SIDES_PER_SEGMENT)
+		{
+			auto &p0 = portals[portal_index(s, s0)];
+			if (p0.child == segment_none)
+				continue;
+			const std::size_t c1 = p0.child;
+			mark(c1);
+			for (const auto s1 : MAX_SIDES_PER_SEGMENT)
+			{
+				const auto i1 = portal_index(c1, s1);
+				auto &p1 = portals[i1];
+				if (p1.child == segment_none || p1.child == s || !portal_beyond(p0, p1))
+					continue;
+				mark(p1.child);
+				seen[i1] = ++generation;
+				pending.assign(1, i1);
+				while (!pending.empty())
+				{
+					const auto iq = pending.back();
+					pending.pop_back();
+					auto &q = portals[iq];
+					const std::size_t from = iq / static_cast<unsigned>(MAX_SIDES_PER_SEGMENT.value);
+					for (const auto t : MAX_SIDES_PER_SEGMENT)
+					{
+						const auto ir = portal_index(q.child, t);
+						auto &r = portals[ir];
+						//	The side back to `from` is the portal just crossed
+						if (r.child == segment_none || r.child == from || seen[ir] == generation)
+							continue;
+						if (!portal_beyond(p0, r) || !portal_beyond(p1, r) || !portal_beyond(q, r))
+							continue;
+						seen[ir] = generation;
+						mark(r.child);
+						pending.push_back(ir);
+					}
+				}
+			}
+		}
+	}
+	level_cache_write("pvs", segment_visibility_cache_version, cache_bytes);
+	Segment_visibility = {stride, std::move(bits)};
+}
+
+}
+
 #if DXX_USE_EDITOR
 #ifndef NDEBUG
 
@@ -1146,11 +1524,75 @@ bool render_compare_context_t::operator()(const distant_object &a, const distant
 	return delta_dist_squared > 0;	//return distance
 }
 
+struct object_depth_key
+{
+	uint64_t key;
+	objnum_t objnum;
+};
+
+//	Stable sort by key.  Short lists, which are most of them, are sorted
+//	in place.  Longer ones take one counting pass per byte of the key that
+//	is not the same in every element.
+static void sort_object_depth_keys(std::vector<object_depth_key> &keys, std::vector<object_depth_key> &scratch)
+{
+	const auto n = keys.size();
+	if (n <= 16)
+	{
+		for (std::size_t i = 1; i < n; ++i)
+		{
+			const auto k = keys[i];
+			auto j = i;
+			for (; j && keys[j - 1].key > k.key; --j)
+				keys[j] = keys[j - 1];
+			keys[j] = k;
+		}
+		return;
+	}
+	uint64_t key_or = 0, key_and = ~uint64_t{0};
+	for (const auto &k : keys)
+	{
+		key_or |= k.key;
+		key_and &= k.key;
+	}
+	const auto varying = key_or ^ key_and;
+	scratch.resize(n);
+	for (unsigned shift = 0; shift < 64; shift += 8)
+	{
+		if (!((varying >> shift) & 0xff))
+			continue;
+		std::array<unsigned, 257> offsets{};
+		for (const auto &k : keys)
+			++offsets[((k.key >> shift) & 0xff) + 1];
+		for (unsigned b = 1; b < offsets.size(); ++b)
+			offsets[b] += offsets[b - 1];
+		for (const auto &k : keys)
+			scratch[offsets[(k.key >> shift) & 0xff]++] = k;
+		keys.swap(scratch);
+	}
+}
+
 static void sort_segment_object_list(fvcobjptr &vcobjptr, const vms_vector &Viewer_eye, render_state_t::per_segment_state_t &segstate)
 {
-	render_compare_context_t context(vcobjptr, Viewer_eye, segstate);
 	auto &v = segstate.objects;
-	std::sort(v.begin(), v.end(), std::cref(context));
+	if (v.size() < 2)
+		return;
+	render_compare_context_t context(vcobjptr, Viewer_eye, segstate);
+	//	Farthest first, so sort on the complement of the distance
+	static std::vector<object_depth_key> keys, scratch;
+	keys.clear();
+	for (const auto t : v)
+		keys.push_back({~static_cast<uint64_t>(underlying_value(context[t.objnum].dist_squared)), t.objnum});
+	sort_object_depth_keys(keys, scratch);
+	for (auto &&[o, k] : zip(v, keys))
+		o.objnum = k.objnum;
+#if DXX_BUILD_DESCENT == 2
+	//	Objects at the same position may still need to swap so that
+	//	weapons and fireballs draw on top.  Only those pairs are out of
+	//	order now, so this pass is linear unless they are common.
+	for (std::size_t i = 1; i < v.size(); ++i)
+		for (auto j = i; j && context(v[j], v[j - 1]); --j)
+			std::swap(v[j], v[j - 1]);
+#endif
 }
 
 }
@@ -1173,8 +1615,9 @@ static void build_object_lists(object_array &Objects, fvcsegptr &vcsegptr, const
 	{
 		const auto segnum = rstate.Render_list[nn];
 		if (segnum != segment_none) {
-			for (const auto obj : objects_in(vcsegptr(segnum), Objects.vcptridx, vcsegptr))
+			for (const objnum_t i : Segment_object_index.in(vcsegptridx(segnum)))
 			{
+				const auto &&obj = Objects.vcptridx(i);
 				int list_pos;
 				if (obj->type == OBJ_NONE)
 				{
@@ -1376,6 +1819,15 @@ static void build_segment_list(render_state_t &rstate, const vms_vector &Viewer_
 	auto &vcvertptr = Vertices.vcptr;
 	auto &Walls = LevelUniqueWallSubsystemState.Walls;
 	auto &vcwallptr = Walls.vcptr;
+	//	The visibility rows hold for eyes inside the segment, so only use
+	//	them when the eye has not strayed out of start_seg_num.
+	std::span<const uint64_t> visible_row;
+	if (const auto stride = Segment_visibility.stride; stride
+#if DXX_USE_EDITOR
+		&& !EditorWindow
+#endif
+		&& get_seg_masks(vcvertptr, Viewer_eye, vcsegptr(start_seg_num), 0).centermask == sidemask_t{})
+		visible_row = std::span(Segment_visibility.bits).subspan(start_seg_num * stride, stride);
 	for (l=0;l<Render_depth;l++) {
 		for (scnt=0;scnt < ecnt;scnt++) {
 			auto segnum = rstate.Render_list[scnt];
@@ -1437,6 +1889,8 @@ static void build_segment_list(render_state_t &rstate, const vms_vector &Viewer_
 			range_for (const auto siden, child_range)
 			{
 				const auto ch = seg->shared_segment::children[siden];
+				if (!visible_row.empty() && !(visible_row[ch / 64] & (uint64_t{1} << (ch % 64))))
+					continue;
 				{
 					{
 						short min_x{32767},max_x=-32767,min_y=32767,max_y=-32767;
@@ -1525,6 +1979,174 @@ done_list:
 	rstate.N_render_segs = lcnt;
 
 }
+
+//	The segment list of a view depends only on the view, the level and
+//	whether each wall can be seen through, so a view that has not changed
+//	since one of the last few frames can reuse the list built then.
+//	Several entries are kept, since the rear view, guided missile and
+//	other cockpit windows render their own views every frame.
+struct render_list_cache_entry
+{
+	struct segment_state
+	{
+		segnum_t segnum;
+		uint16_t Seg_depth;
+		bool processed;
+		rect render_window;
+	};
+	bool valid;
+	g3_view_state view;
+	vms_vector Viewer_eye;
+	segnum_t start_seg_num;
+	int render_depth;
+	uint16_t canvas_w, canvas_h;
+	std::vector<wall_is_doorway_result> walls;
+	unsigned N_render_segs, first_terminal_seg;
+	std::array<segnum_t, MAX_RENDER_SEGS> Render_list;
+	std::vector<segment_state> segments;
+};
+
+std::array<render_list_cache_entry, 4> Render_list_cache;
+unsigned Render_list_cache_next;
+
+static void get_render_list_wall_states(std::vector<wall_is_doorway_result> &walls)
+{
+	auto &Walls = LevelUniqueWallSubsystemState.Walls;
+	auto &vcwallptr = Walls.vcptr;
+	walls.clear();
+	for (auto &w : vcwallptr)
+		walls.emplace_back(WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, vcsegptr(w.segnum), w.sidenum));
+}
+
+static void build_or_reuse_segment_list(render_state_t &rstate, const vms_vector &Viewer_eye, visited_twobit_array_t &visited, unsigned &first_terminal_seg, const vcsegidx_t start_seg_num)
+{
+#if DXX_USE_EDITOR
+	if (EditorWindow)
+	{
+		build_segment_list(rstate, Viewer_eye, visited, first_terminal_seg, start_seg_num);
+		return;
+	}
+#endif
+	const auto view = g3_get_view_state();
+	const uint16_t canvas_w = grd_curcanv->cv_bitmap.bm_w, canvas_h = grd_curcanv->cv_bitmap.bm_h;
+	static std::vector<wall_is_doorway_result> walls;
+	get_render_list_wall_states(walls);
+	for (auto &e : Render_list_cache)
+	{
+		if (!e.valid || e.start_seg_num != start_seg_num || !(e.Viewer_eye == Viewer_eye) || !(e.view == view) || e.render_depth != Render_depth || e.canvas_w != canvas_w || e.canvas_h != canvas_h || e.walls != walls)
+			continue;
+		rstate.N_render_segs = e.N_render_segs;
+		std::copy_n(e.Render_list.begin(), e.N_render_segs, rstate.Render_list.begin());
+		for (auto &s : e.segments)
+		{
+			auto &rsm = rstate.render_seg_map[s.segnum];
+			rsm.Seg_depth = s.Seg_depth;
+			rsm.processed = s.processed;
+			rsm.render_window = s.render_window;
+		}
+		for (const auto segnum : partial_const_range(rstate.Render_list, rstate.N_render_segs))
+			if (segnum != segment_none)
+				visited[segnum] = 1;
+		first_terminal_seg = e.first_terminal_seg;
+		return;
+	}
+	build_segment_list(rstate, Viewer_eye, visited, first_terminal_seg, start_seg_num);
+	auto &e = Render_list_cache[Render_list_cache_next];
+	Render_list_cache_next = (Render_list_cache_next + 1) % Render_list_cache.size();
+	e.valid = true;
+	e.view = view;
+	e.Viewer_eye = Viewer_eye;
+	e.start_seg_num = start_seg_num;
+	e.render_depth = Render_depth;
+	e.canvas_w = canvas_w;
+	e.canvas_h = canvas_h;
+	e.walls.swap(walls);
+	e.N_render_segs = rstate.N_render_segs;
+	e.first_terminal_seg = first_terminal_seg;
+	std::copy_n(rstate.Render_list.begin(), rstate.N_render_segs, e.Render_list.begin());
+	e.segments.clear();
+	for (auto &&[segnum, rsm] : rstate.render_seg_map)
+		e.segments.push_back({segnum, rsm.Seg_depth, rsm.processed, rsm.render_window});
+}
+
+}
+
+//	Called when a level is loaded
+void invalidate_render_list_cache()
+{
+	for (auto &e : Render_list_cache)
+		e.valid = false;
+}
+
+namespace {
+
+//	A thread that builds the object lists of a view while the main thread
+//	sets the dynamic light of the same view.  The segment walk of every
+//	view and the drawing share the rotated points and the projection, so
+//	only this part of a frame can run beside the main thread.
+class render_object_list_worker
+{
+	std::mutex mutex;
+	std::condition_variable start, done;
+	std::function<void()> job;
+	bool busy = false, quit = false;
+	std::thread thread;
+	void main()
+	{
+		std::unique_lock lock(mutex);
+		for (;;)
+		{
+			start.wait(lock, [this] { return quit || busy; });
+			if (quit)
+				return;
+			lock.unlock();
+			job();
+			lock.lock();
+			busy = false;
+			done.notify_one();
+		}
+	}
+public:
+	~render_object_list_worker()
+	{
+		if (!thread.joinable())
+			return;
+		{
+			std::lock_guard lock(mutex);
+			quit = true;
+		}
+		start.notify_one();
+		thread.join();
+	}
+	//	Runs `f` on the worker, or right away if there is no second core
+	template <typename F>
+		void run(F &&f)
+		{
+			if (!thread.joinable())
+			{
+				if (std::thread::hardware_concurrency() < 2)
+				{
+					f();
+					return;
+				}
+				thread = std::thread(&render_object_list_worker::main, this);
+			}
+			{
+				std::lock_guard lock(mutex);
+				job = std::forward<F>(f);
+				busy = true;
+			}
+			start.notify_one();
+		}
+	void wait()
+	{
+		std::unique_lock lock(mutex);
+		done.wait(lock, [this] { return !busy; });
+	}
+};
+
+render_object_list_worker Render_object_list_worker;
+
 }
 
 //renders onto current canvas
@@ -1565,18 +2187,62 @@ void render_mine(grs_canvas &canvas, const vms_vector &Viewer_eye, const vcsegid
 	}
 	//else
 	#endif
+	{
 		//NOTE LINK TO ABOVE!!	-Link killed by kreatordxx to get editor selection working again
-		build_segment_list(rstate, Viewer_eye, visited, first_terminal_seg, start_seg_num);		//fills in Render_list & N_render_segs
+		const frame_profile_scope profile{frame_profile_zone::render_segments};
+#if DXX_USE_STEREOSCOPIC_RENDER && DXX_USE_OGL
+		/* Both eyes of a stereo view find the visible segments from one
+		 * point, whose view holds both of theirs, so that the second eye
+		 * finds the list of the first in Render_list_cache instead of
+		 * walking the mine again.  The hardware renderers do not clip to
+		 * the render windows, so a list found from that point only
+		 * draws a few more segments at the edges.
+		 */
+		if (VR_stereo != StereoFormat::None && eye_offset)
+		{
+			const auto visibility_eye{g3_stereo_visibility_position(eye_offset)};
+			g3_set_view_position(visibility_eye);
+			build_or_reuse_segment_list(rstate, visibility_eye, visited, first_terminal_seg, start_seg_num);
+			g3_set_view_position(Viewer_eye);
+			/* Points rotated for the walk are wrong for the eye */
+			render_next_point_generation();
+		}
+		else
+#endif
+		build_or_reuse_segment_list(rstate, Viewer_eye, visited, first_terminal_seg, start_seg_num);		//fills in Render_list & N_render_segs
+	}
 
 	const auto &&render_range = partial_const_range(rstate.Render_list, rstate.N_render_segs);
 	const auto &&reversed_render_range = render_range.reversed();
+#if DXX_BUILD_DESCENT == 2
+	slide_visible_textures(std::span(rstate.Render_list).first(rstate.N_render_segs));
+#endif
 	//render away
 
 	//if (!(_search_mode))
-		build_object_lists(Objects, vcsegptr, Viewer_eye, rstate);
-
 	if (eye_offset<=0) // Do for left eye or zero.
-		set_dynamic_light(LevelSharedRobotInfoState.Robot_info, rstate);
+	{
+		/* set_dynamic_light reads only the segment list of rstate, so
+		 * the object lists can be built beside it.
+		 */
+		Render_object_list_worker.run([&Objects, &Viewer_eye, &rstate] {
+			build_object_lists(Objects, vcsegptr, Viewer_eye, rstate);
+		});
+		{
+			const frame_profile_scope profile{frame_profile_zone::render_lighting};
+			set_dynamic_light(LevelSharedRobotInfoState.Robot_info, rstate);
+		}
+		/* Only the wait for the worker is charged to the object lists */
+		const frame_profile_scope profile{frame_profile_zone::render_objects};
+		Render_object_list_worker.wait();
+	}
+	else
+	{
+		const frame_profile_scope profile{frame_profile_zone::render_objects};
+		build_object_lists(Objects, vcsegptr, Viewer_eye, rstate);
+	}
+	const frame_profile_scope profile{frame_profile_zone::render_draw};
+	object_culler culler{vcsegptr, Vertices.vcptr, rstate};
 
 	if (reversed_render_range.empty())
 		/* Impossible, but later code has undefined behavior if this
@@ -1607,6 +2273,16 @@ void render_mine(grs_canvas &canvas, const vms_vector &Viewer_eye, const vcsegid
 		}
 	}
 #if !DXX_USE_OGL
+	/* The search reads back the canvas as it draws, and the outlines are
+	 * drawn straight to it, so neither can defer the spans.
+	 */
+#ifndef NDEBUG
+	const bool tile_spans = !_search_mode && !Outline_mode;
+#else
+	const bool tile_spans = !_search_mode;
+#endif
+	if (tile_spans)
+		tmap_tiles_begin();
 	range_for (const auto segnum, reversed_render_range)
 	{
 		// Interpolation_method = 0;
@@ -1627,9 +2303,11 @@ void render_mine(grs_canvas &canvas, const vms_vector &Viewer_eye, const vcsegid
 
 			render_segment(vcvertptr, vcwallptr, Viewer_eye, *grd_curcanv, vcsegptridx(segnum));
 			visited[segnum]=3;
-			if (srsm.objects.empty())
+			if (srsm.objects.empty() && !effect_particles_in(segnum))
 				continue;
 
+			//sprites are blitted straight to the canvas, over the spans so far
+			tmap_tiles_end();
 			{		//reset for objects
 				Window_clip_left  = Window_clip_top = 0;
 				Window_clip_right = canvas.cv_bitmap.bm_w-1;
@@ -1639,15 +2317,20 @@ void render_mine(grs_canvas &canvas, const vms_vector &Viewer_eye, const vcsegid
 			{
 				//int n_expl_objs=0,expl_objs[5],i;
 				const auto save_linear_depth = std::exchange(Max_linear_depth, Max_linear_depth_objects);
+				culler.set_listed_window(srsm.render_window);
 				range_for (auto &v, srsm.objects)
 				{
-					do_render_object(canvas, LevelUniqueLightState, vmobjptridx(v.objnum), window);	// note link to above else
+					do_render_object(canvas, LevelUniqueLightState, vmobjptridx(v.objnum), window, culler);	// note link to above else
 				}
+				effect_particles_render(Vclip, canvas, segnum);
 				Max_linear_depth = save_linear_depth;
 			}
+			if (tile_spans)
+				tmap_tiles_begin();
 
 		}
 	}
+	tmap_tiles_end();
 #else
         // Two pass rendering. Since sprites and some level geometry can have transparency (blending), we need some fancy sorting.
         // GL_DEPTH_TEST helps to sort everything in view but we should make sure translucent sprites are rendered after geometry to prevent them to turn walls invisible (if rendered BEFORE geometry but still in FRONT of it).
@@ -1657,7 +2340,20 @@ void render_mine(grs_canvas &canvas, const vms_vector &Viewer_eye, const vcsegid
 	auto &Walls = LevelUniqueWallSubsystemState.Walls;
 	auto &vcwallptr = Walls.vcptr;
         // First Pass: render opaque level geometry and level geometry with alpha pixels (high Alpha-Test func)
-	range_for (const auto segnum, reversed_render_range)
+	/* With -gl_fronttoback, this pass draws the nearest segments first,
+	 * so the depth test rejects the hidden walls behind them before they
+	 * are textured.  That is only right for sides that are not blended,
+	 * since a blended side must not hide what is drawn after it, so the
+	 * blended sides move to the second pass, which stays back to front.
+	 */
+	const bool front_to_back = CGameArg.OglFrontToBack;
+	const auto alphablend_side = [&TmapInfo](const unique_segment &seg, const sidenum_t sn) {
+		if (!PlayerCfg.AlphaBlendEClips)
+			return false;
+		const auto texture1_index{get_texture_index(seg.sides[sn].tmap_num)};
+		return texture1_index < TmapInfo.size() && is_alphablend_eclip(TmapInfo[texture1_index].eclip_num);
+	};
+	const auto first_pass = [&](const segnum_t segnum)
 	{
 		auto &srsm = rstate.render_seg_map[segnum];
 
@@ -1685,28 +2381,28 @@ void render_mine(grs_canvas &canvas, const vms_vector &Viewer_eye, const vcsegid
 					for (const auto sn : MAX_SIDES_PER_SEGMENT)
 					{
 						const auto wid = WALL_IS_DOORWAY(GameBitmaps, Textures, vcwallptr, seg, sn);
+						if (front_to_back && (alphablend_side(*seg, sn)
+#if DXX_BUILD_DESCENT == 2
+							|| (wid & WALL_IS_DOORWAY_FLAG::cloaked)
+#endif
+							))
+							continue;
 						if (wid == wall_is_doorway_result::transparent_wall || wid == wall_is_doorway_result::transillusory_wall
 #if DXX_BUILD_DESCENT == 2
 							|| (wid & WALL_IS_DOORWAY_FLAG::cloaked)
 #endif
 							)
 						{
-							if (PlayerCfg.AlphaBlendEClips)
-							{
-								const auto texture1_index{get_texture_index(seg->unique_segment::sides[sn].tmap_num)};
-								if (texture1_index >= TmapInfo.size()) [[unlikely]]
-								{
-									/* Do nothing - skip indexing into TmapInfo */
-								}
-								else if (is_alphablend_eclip(TmapInfo[texture1_index].eclip_num))
-									// Do NOT render geometry with blending textures. Since we've not rendered any objects, yet, they would disappear behind them.
-									continue;
-							}
+							if (alphablend_side(*seg, sn))
+								// Do NOT render geometry with blending textures. Since we've not rendered any objects, yet, they would disappear behind them.
+								continue;
 #if !DXX_USE_VULKAN
+							ogl_stream_flush();
 							glAlphaFunc(GL_GEQUAL,0.8); // prevent ugly outlines if an object (which is rendered later) is shown behind a grate, door, etc. if texture filtering is enabled. These sides are rendered later again with normal AlphaFunc
 #endif
 							render_side(vcvertptr, canvas, seg, sn, wid, Viewer_eye);
 #if !DXX_USE_VULKAN
+							ogl_stream_flush();
 							glAlphaFunc(GL_GEQUAL,0.02);
 #endif
 						}
@@ -1716,7 +2412,13 @@ void render_mine(grs_canvas &canvas, const vms_vector &Viewer_eye, const vcsegid
 				}
 			}
 		}
-	}
+	};
+	if (front_to_back)
+		range_for (const auto segnum, render_range)
+			first_pass(segnum);
+	else
+		range_for (const auto segnum, reversed_render_range)
+			first_pass(segnum);
 
         // Second pass: Render objects and level geometry with alpha pixels (normal Alpha-Test func) and eclips with blending
 	range_for (const auto segnum, reversed_render_range)
@@ -1755,11 +2457,13 @@ void render_mine(grs_canvas &canvas, const vms_vector &Viewer_eye, const vcsegid
 						{
 							render_side(vcvertptr, canvas, seg, sn, wid, Viewer_eye);
 						}
+						else if (front_to_back && alphablend_side(*seg, sn))
+							render_side(vcvertptr, canvas, seg, sn, wid, Viewer_eye);
 					}
 				}
 			}
 			visited[segnum]=3;
-			if (srsm.objects.empty())
+			if (srsm.objects.empty() && !effect_particles_in(segnum))
 				continue;
 			{		//reset for objects
 				Window_clip_left  = Window_clip_top = 0;
@@ -1768,10 +2472,20 @@ void render_mine(grs_canvas &canvas, const vms_vector &Viewer_eye, const vcsegid
 			}
 
 			{
+#if DXX_USE_VULKAN
+				vk_set_gpu_pass(vk_gpu_pass::objects);
+				vk_begin_object_group();
+#endif
+				culler.set_listed_window(srsm.render_window);
 				range_for (auto &v, srsm.objects)
 				{
-					do_render_object(canvas, LevelUniqueLightState, vmobjptridx(v.objnum), window);	// note link to above else
+					do_render_object(canvas, LevelUniqueLightState, vmobjptridx(v.objnum), window, culler);	// note link to above else
 				}
+				effect_particles_render(Vclip, canvas, segnum);
+#if DXX_USE_VULKAN
+				vk_end_object_group();
+				vk_set_gpu_pass(vk_gpu_pass::mine);
+#endif
 			}
 		}
 	}
@@ -0,0 +1,377 @@
+/*
+ * This file is part of the DXX-Rebirth project <https://www.dxx-rebirth.com/>.
+ * It is copyright by its individual contributors, as recorded in the
+ * project's Git history.  See COPYING.txt at the top level for license
+ * terms and a link to the Git history.
+ */
+
+/*
+ *
+ * In-memory snapshots of the current level, and the rewind buffer
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include "snapshot.h"
+#include "ai.h"
+#include "automap.h"
+#include "cmd.h"
+#include "console.h"
+#include "controls.h"
+#include "cvar.h"
+#include "d_levelstate.h"
+#include "endlevel.h"
+#include "fireball.h"
+#include "fuelcen.h"
+#include "game.h"
+#include "gameseq.h"
+#include "level_cache.h"
+#include "maths.h"
+#include "morph.h"
+#include "newdemo.h"
+#include "object.h"
+#include "player.h"
+#include "segment.h"
+#include "switch.h"
+#include "wall.h"
+
+namespace dsx {
+
+namespace {
+
+struct level_snapshot_segment
+{
+	segnum_t segnum;
+	unique_segment useg;
+};
+
+/* Every segment of the level as it was at the first snapshot.  Each
+ * snapshot keeps a reference to the copy its segments are relative to,
+ * so a new copy for a later visit to the level does not break it.
+ */
+using level_snapshot_baseline = std::shared_ptr<const std::vector<unique_segment>>;
+
+}
+
+struct level_snapshot
+{
+	uint64_t level_key;
+	int level;
+	fix64 game_time;
+	unsigned rand_state;
+	unsigned num_objects;
+	unsigned accumulated_robots;
+	unsigned total_hostages;
+	unsigned debris_object_count;
+#if DXX_BUILD_DESCENT == 2
+	d_unique_buddy_state buddy;
+	d_thief_unique_state thief;
+	d_guided_missile_indices guided_missile;
+#endif
+	slot_bitmap<MAX_OBJECTS> free_objects;
+	std::vector<object> objects;
+	d_level_unique_boss_state boss;
+	d_level_unique_control_center_state control_center;
+	vms_vector last_console_player_position;
+	std::array<player, MAX_PLAYERS> players;
+	std::vector<wall> walls;
+	std::vector<active_door> active_doors;
+#if DXX_BUILD_DESCENT == 2
+	std::vector<cloaking_wall> cloaking_walls;
+#endif
+	std::vector<trigger> triggers;
+	unsigned num_exploding_walls;
+	level_snapshot_baseline baseline;
+	/* Only the segments that differ from the baseline */
+	std::vector<level_snapshot_segment> segments;
+	std::vector<uint8_t> automap_visited;
+	d_level_unique_fuelcenter_state fuelcenters;
+	d_level_shared_robotcenter_state robotcenters;
+	ai_snapshot ai;
+#if DXX_BUILD_DESCENT == 2
+	d_marker_state markers;
+	fix flash_effect;
+	fix64 time_flash_last_played;
+	fix afterburner_charge;
+#endif
+};
+
+void level_snapshot_deleter::operator()(level_snapshot *const s) const
+{
+	delete s;
+}
+
+namespace {
+
+level_snapshot_baseline Level_snapshot_baseline;
+
+/* Seconds of play that `rewind` can undo.  0 turns the rewind buffer
+ * off.
+ */
+cvar_t rewind_seconds_cvar{"rewind_seconds", "0", CVAR_NONE, 0, 0};
+
+/* One snapshot per second of game time, oldest first */
+std::deque<level_snapshot_ptr> Rewind_buffer;
+fix64 Rewind_next_time;
+
+level_snapshot_ptr Quick_snapshot;
+
+bool level_snapshot_allowed()
+{
+	return Game_wind && !(Game_mode & GM_MULTI) && Newdemo_state == ND_STATE_NORMAL && Player_dead_state == player_dead_state::no && !Endlevel_sequence;
+}
+
+bool level_snapshot_segment_differs(const unique_segment &a, const unique_segment &b)
+{
+	return a.objects != b.objects || a.light_subtracted != b.light_subtracted || a.slide_textures != b.slide_textures || a.static_light != b.static_light || std::memcmp(&a.sides, &b.sides, sizeof(a.sides));
+}
+
+const level_snapshot_baseline &level_snapshot_get_baseline()
+{
+	auto &b = Level_snapshot_baseline;
+	if (!b || b->size() != vcsegptr.count())
+	{
+		std::vector<unique_segment> segments;
+		segments.reserve(vcsegptr.count());
+		for (const unique_segment &useg : vcsegptr)
+			segments.emplace_back(useg);
+		b = std::make_shared<const std::vector<unique_segment>>(std::move(segments));
+	}
+	return b;
+}
+
+/* Drop the snapshots that are later than the game time, because the game
+ * went back to before they were taken.
+ */
+void level_snapshot_trim_rewind_buffer()
+{
+	while (!Rewind_buffer.empty() && Rewind_buffer.back()->game_time > GameTime64)
+		Rewind_buffer.pop_back();
+	Rewind_next_time = GameTime64 + F1_0;
+}
+
+void con_cmd_snapshot(unsigned long, const char *const *)
+{
+	if (auto s = level_snapshot_take())
+	{
+		con_printf(CON_NORMAL, "snapshot: %zu KB", level_snapshot_size(*s) / 1024);
+		Quick_snapshot = std::move(s);
+	}
+	else
+		con_printf(CON_NORMAL, "snapshot: start a single player game, and stop any demo, first");
+}
+
+void con_cmd_snapshot_restore(unsigned long, const char *const *)
+{
+	if (!Quick_snapshot)
+		con_printf(CON_NORMAL, "snapshot_restore: no snapshot taken");
+	else if (!level_snapshot_restore(*Quick_snapshot))
+		con_printf(CON_NORMAL, "snapshot_restore: the snapshot is of another level, or the game cannot be restored now");
+}
+
+void con_cmd_rewind(unsigned long argc, const char *const *const argv)
+{
+	const std::size_t seconds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 5;
+	if (Rewind_buffer.empty())
+	{
+		con_printf(CON_NORMAL, "rewind: nothing recorded; set rewind_seconds to the number of seconds to keep");
+		return;
+	}
+	/* The last snapshot is from less than a second ago */
+	const auto i = Rewind_buffer.size() - std::min(std::max<std::size_t>(seconds, 1), Rewind_buffer.size());
+	if (!level_snapshot_restore(*Rewind_buffer[i]))
+		con_printf(CON_NORMAL, "rewind: the game cannot be restored now");
+}
+
+}
+
+level_snapshot_ptr level_snapshot_take()
+{
+	if (!level_snapshot_allowed())
+		return {};
+	auto &MorphObjectState = LevelUniqueObjectState.MorphObjectState;
+	/* Morph data points into the live objects, so it cannot be copied */
+	if (std::ranges::any_of(MorphObjectState.morph_objects, [](const morph_data::ptr &m) { return !!m; }))
+		return {};
+	auto &Objects = LevelUniqueObjectState.Objects;
+	auto &Walls = LevelUniqueWallSubsystemState.Walls;
+	auto &ActiveDoors = LevelUniqueWallSubsystemState.ActiveDoors;
+	auto &Triggers = LevelUniqueWallSubsystemState.Triggers;
+	auto &Automap_visited = LevelUniqueAutomapState.Automap_visited;
+	level_snapshot_ptr s{new level_snapshot{
+		.level_key = Level_cache_key,
+		.level = Current_level_num,
+		.game_time = GameTime64,
+		.rand_state = d_rand_state(),
+		.num_objects = LevelUniqueObjectState.num_objects,
+		.accumulated_robots = LevelUniqueObjectState.accumulated_robots,
+		.total_hostages = LevelUniqueObjectState.total_hostages,
+		.debris_object_count = LevelUniqueObjectState.Debris_object_count,
+#if DXX_BUILD_DESCENT == 2
+		.buddy = LevelUniqueObjectState.BuddyState,
+		.thief = LevelUniqueObjectState.ThiefState,
+		.guided_missile = LevelUniqueObjectState.Guided_missile,
+#endif
+		.free_objects = LevelUniqueObjectState.free_objects,
+		.objects = std::vector<object>(Objects.begin(), Objects.begin() + Objects.get_count()),
+		.boss = LevelUniqueObjectState.BossState,
+		.control_center = LevelUniqueObjectState.ControlCenterState,
+		.last_console_player_position = LevelUniqueObjectState.last_console_player_position,
+		.players = {},
+		.walls = std::vector<wall>(Walls.begin(), Walls.begin() + Walls.get_count()),
+		.active_doors = std::vector<active_door>(ActiveDoors.begin(), ActiveDoors.begin() + ActiveDoors.get_count()),
+#if DXX_BUILD_DESCENT == 2
+		.cloaking_walls = std::vector<cloaking_wall>(LevelUniqueWallSubsystemState.CloakingWalls.begin(), LevelUniqueWallSubsystemState.CloakingWalls.begin() + LevelUniqueWallSubsystemState.CloakingWalls.get_count()),
+#endif
+		.triggers = std::vector<trigger>(Triggers.begin(), Triggers.begin() + Triggers.get_count()),
+		.num_exploding_walls = Num_exploding_walls,
+		.baseline = level_snapshot_get_baseline(),
+		.segments = {},
+		.automap_visited = std::vector<uint8_t>(Automap_visited.begin(), Automap_visited.begin() + vcsegptr.count()),
+		.fuelcenters = LevelUniqueFuelcenterState,
+		.robotcenters = LevelSharedRobotcenterState,
+		.ai = {},
+#if DXX_BUILD_DESCENT == 2
+		.markers = MarkerState,
+		.flash_effect = Flash_effect,
+		.time_flash_last_played = Time_flash_last_played,
+		.afterburner_charge = Afterburner_charge,
+#endif
+	}};
+	std::copy(Players.begin(), Players.end(), s->players.begin());
+	auto b = s->baseline->begin();
+	std::size_t segnum = 0;
+	for (const unique_segment &useg : vcsegptr)
+	{
+		if (level_snapshot_segment_differs(useg, *b))
+			s->segments.push_back({static_cast<segnum_t>(segnum), useg});
+		++b;
+		++segnum;
+	}
+	ai_take_snapshot(s->ai);
+	return s;
+}
+
+bool level_snapshot_restore(const level_snapshot &s)
+{
+	if (!level_snapshot_allowed() || s.level_key != Level_cache_key || s.level != Current_level_num || s.baseline->size() != vcsegptr.count())
+		return false;
+	auto &Objects = LevelUniqueObjectState.Objects;
+	auto &Walls = LevelUniqueWallSubsystemState.Walls;
+	auto &ActiveDoors = LevelUniqueWallSubsystemState.ActiveDoors;
+	auto &Triggers = LevelUniqueWallSubsystemState.Triggers;
+	/* Slots past the end of the snapshot keep their signature, so that
+	 * objects created in them later are not mistaken for the objects
+	 * that were there before the restore.
+	 */
+	for (auto i = Objects.begin() + s.objects.size(), e = Objects.begin() + Objects.get_count(); i < e; ++i)
+		i->type = OBJ_NONE;
+	std::copy(s.objects.begin(), s.objects.end(), Objects.begin());
+	Objects.set_count(s.objects.size());
+	LevelUniqueObjectState.num_objects = s.num_objects;
+	LevelUniqueObjectState.accumulated_robots = s.accumulated_robots;
+	LevelUniqueObjectState.total_hostages = s.total_hostages;
+	LevelUniqueObjectState.Debris_object_count = s.debris_object_count;
+#if DXX_BUILD_DESCENT == 2
+	LevelUniqueObjectState.BuddyState = s.buddy;
+	LevelUniqueObjectState.ThiefState = s.thief;
+	LevelUniqueObjectState.Guided_missile = s.guided_missile;
+#endif
+	LevelUniqueObjectState.free_objects = s.free_objects;
+	LevelUniqueObjectState.BossState = s.boss;
+	LevelUniqueObjectState.ControlCenterState = s.control_center;
+	LevelUniqueObjectState.last_console_player_position = s.last_console_player_position;
+	init_morphs(LevelUniqueObjectState.MorphObjectState);
+	std::copy(s.players.begin(), s.players.end(), Players.begin());
+	std::copy(s.walls.begin(), s.walls.end(), Walls.begin());
+	Walls.set_count(s.walls.size());
+	std::copy(s.active_doors.begin(), s.active_doors.end(), ActiveDoors.begin());
+	ActiveDoors.set_count(s.active_doors.size());
+#if DXX_BUILD_DESCENT == 2
+	auto &CloakingWalls = LevelUniqueWallSubsystemState.CloakingWalls;
+	std::copy(s.cloaking_walls.begin(), s.cloaking_walls.end(), CloakingWalls.begin());
+	CloakingWalls.set_count(s.cloaking_walls.size());
+#endif
+	std::copy(s.triggers.begin(), s.triggers.end(), Triggers.begin());
+	Triggers.set_count(s.triggers.size());
+	Num_exploding_walls = s.num_exploding_walls;
+	++LevelUniqueWallSubsystemState.change_count;
+	LevelUniqueStuckObjectState.init_stuck_objects();
+	auto b = s.baseline->begin();
+	for (unique_segment &useg : vmsegptr)
+		useg = *b++;
+	for (auto &i : s.segments)
+	{
+		unique_segment &useg = *vmsegptr(i.segnum);
+		useg = i.useg;
+	}
+	std::copy(s.automap_visited.begin(), s.automap_visited.end(), LevelUniqueAutomapState.Automap_visited.begin());
+	LevelUniqueFuelcenterState = s.fuelcenters;
+	LevelSharedRobotcenterState = s.robotcenters;
+	ai_restore_snapshot(s.ai);
+#if DXX_BUILD_DESCENT == 2
+	MarkerState = s.markers;
+	Flash_effect = s.flash_effect;
+	Time_flash_last_played = s.time_flash_last_played;
+	Afterburner_charge = s.afterburner_charge;
+#endif
+	GameTime64 = s.game_time;
+	d_srand(s.rand_state);
+	level_snapshot_trim_rewind_buffer();
+	reset_time();
+	return true;
+}
+
+std::size_t level_snapshot_size(const level_snapshot &s)
+{
+	return sizeof(s) +
+		s.objects.size() * sizeof(object) +
+		s.walls.size() * sizeof(wall) +
+		s.active_doors.size() * sizeof(active_door) +
+#if DXX_BUILD_DESCENT == 2
+		s.cloaking_walls.size() * sizeof(cloaking_wall) +
+#endif
+		s.triggers.size() * sizeof(trigger) +
+		s.segments.size() * sizeof(level_snapshot_segment) +
+		s.automap_visited.size() +
+		s.ai.Point_segs.size() * sizeof(point_seg);
+}
+
+void level_snapshot_init()
+{
+	cvar_registervariable(rewind_seconds_cvar);
+	cmd_addcommand("snapshot", con_cmd_snapshot, "snapshot\n" "    keep a copy of the current level in memory, for snapshot_restore");
+	cmd_addcommand("snapshot_restore", con_cmd_snapshot_restore, "snapshot_restore\n" "    go back to the copy of the level kept by snapshot");
+	cmd_addcommand("rewind", con_cmd_rewind, "rewind [seconds]\n" "    go back [seconds] (default 5) of play.  Set rewind_seconds to how many seconds to keep");
+}
+
+void level_snapshot_poll()
+{
+	const auto keep = rewind_seconds_cvar.intval;
+	if (keep <= 0)
+	{
+		Rewind_buffer.clear();
+		return;
+	}
+	/* A new level restarts the game time */
+	if (!Rewind_buffer.empty() && (Rewind_buffer.back()->level != Current_level_num || Rewind_buffer.back()->level_key != Level_cache_key || Rewind_buffer.back()->game_time > GameTime64))
+	{
+		Rewind_buffer.clear();
+		Rewind_next_time = 0;
+	}
+	if (GameTime64 < Rewind_next_time)
+		return;
+	auto s = level_snapshot_take();
+	if (!s)
+		return;
+	Rewind_buffer.emplace_back(std::move(s));
+	while (Rewind_buffer.size() > static_cast<unsigned>(keep))
+		Rewind_buffer.pop_front();
+	Rewind_next_time = GameTime64 + F1_0;
+}
+
+}
@@ -768,6 +768,63 @@ static void redbook_first_song_func()
 }
 #endif
 
+namespace {
+
+struct builtin_level_song
+{
+	const user_configured_level_songs *songs;
+	song_number songnum;
+};
+
+/* Pick the builtin song of `levelnum`.  `songs` is nullptr if the song
+ * list has no song for it.
+ */
+static builtin_level_song choose_builtin_level_song(const int levelnum)
+{
+	if (levelnum < 0)
+	{
+		/* Secret songs are processed separately and do not need
+		 * to exclude non-levels.  Secret songs start at offset 0, so a
+		 * test for `size == 0` is sufficient.
+		 */
+		if (const auto size{BIMSecretSongs.size()})
+			return {&BIMSecretSongs, static_cast<song_number>((-levelnum - 1) % size)};
+		return {nullptr, song_number::None};
+	}
+	/* Level songs start at offset `song_number::first_level_song`, so
+	 * require that the song list contain more than that many entries.
+	 * A list with at most `song_number::first_level_song` entries only
+	 * has non-level songs, so nothing can be played for level songs.
+	 */
+	if (const auto size{BIMSongs.size()}; size > static_cast<std::size_t>(song_number::first_level_song))
+	{
+		/* Compute `count_level_songs` to exclude songs assigned to
+		 * non-levels, such as title, briefing, etc.
+		 */
+		const auto count_level_songs{size - static_cast<std::size_t>(song_number::first_level_song)};
+		return {&BIMSongs, build_song_number_from_level_song_number(static_cast<level_song_number>(static_cast<unsigned>(levelnum - 1) % count_level_songs))};
+	}
+	return {nullptr, song_number::None};
+}
+
+}
+
+void songs_prefetch_level_song(const int levelnum)
+{
+	/* Windows plays HMP through its own MIDI code, which does not
+	 * convert the file first.
+	 */
+#if DXX_USE_SDLMIXER && !defined(_WIN32)
+	if (CGameCfg.MusicType != music_type::Builtin)
+		return;
+	songs_init();
+	if (const auto [songs, songnum]{choose_builtin_level_song(levelnum)}; songs)
+		mix_prefetch_file((*songs)[songnum].filename.data());
+#else
+	(void)levelnum;
+#endif
+}
+
 // play track given by levelnum (depending on the music type and it's playing behaviour) or increment/decrement current track number via offset value
 
 void songs_play_level_song(int levelnum, int offset)
@@ -785,35 +842,8 @@ void songs_play_level_song(int levelnum, int offset)
 				return;
 
 			Song_playing = song_number::None;
-			if (levelnum < 0)
-			{
-				/* Secret songs are processed separately and do not need
-				 * to exclude non-levels.  Secret songs start at offset 0, so a
-				 * test for `size == 0` is sufficient.
-				 */
-				if (const auto size{BIMSecretSongs.size()})
-				{
-					const auto secretsongnum{static_cast<song_number>((-levelnum - 1) % size)};
-					if (songs_play_file(BIMSecretSongs[secretsongnum].filename.data(), 1, nullptr))
-						Song_playing = secretsongnum;
-				}
-				break;
-			}
-			/* Level songs start at offset `song_number::first_level_song`, so
-			 * require that the song list contain more than that many entries.
-			 * A list with at most `song_number::first_level_song` entries only
-			 * has non-level songs, so nothing can be played for level songs.
-			 */
-			if (const auto size{BIMSongs.size()}; size > static_cast<std::size_t>(song_number::first_level_song))
-			{
-				/* Compute `count_level_songs` to exclude songs assigned to
-				 * non-levels, such as title, briefing, etc.
-				 */
-				const auto count_level_songs{size - static_cast<std::size_t>(song_number::first_level_song)};
-				const song_number songnum{build_song_number_from_level_song_number(static_cast<level_song_number>(underlying_value(level_songnum) % count_level_songs))};
-				if (songs_play_file(BIMSongs[songnum].filename.data(), 1, nullptr))
-					Song_playing = songnum;
-			}
+			if (const auto [songs, songnum]{choose_builtin_level_song(levelnum)}; songs && songs_play_file((*songs)[songnum].filename.data(), 1, nullptr))
+				Song_playing = songnum;
 			break;
 		}
 #if DXX_USE_SDL_REDBOOK_AUDIO
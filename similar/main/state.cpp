@@ -28,6 +28,7 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include <math.h>
 #include <string.h>
 #include <ranges>
+#include <thread>
 
 #include "pstypes.h"
 #include "inferno.h"
@@ -904,6 +905,11 @@ static void state_read_player(PHYSFS_File *fp, player &pl, const physfsx_endian
 
 }
 
+/* Write the savegame to the buffer of the returned file, which is still
+ * open.  The returned file is empty if it could not be opened.
+ */
+RAIIPHYSFS_File state_write_savegame(const char *filename, const char *desc);
+
 }
 
 namespace dcx {
@@ -915,6 +921,16 @@ void state_format_savegame_filename(d_game_unique_state::savegame_file_path &fil
 	snprintf(filename.data(), filename.size(), PLAYER_DIRECTORY_STRING("%.8s.%cg%x"), static_cast<const char *>(InterfaceUniqueState.PilotName), +(Game_mode & GM_MULTI_COOP) ? 'm' : 's', i);
 }
 
+/* The last autosave, whose thread may still be writing it to disk */
+struct pending_autosave_write
+{
+	std::thread thread;
+	d_game_unique_state::savegame_file_path filename;
+	PHYSFS_ErrorCode error;
+};
+
+pending_autosave_write pending_autosave;
+
 void state_autosave_game(const int multiplayer)
 {
 	d_game_unique_state::savegame_description desc;
@@ -934,15 +950,40 @@ void state_autosave_game(const int multiplayer)
 	}
 	else
 	{
+		state_wait_for_autosave();
 		d_game_unique_state::savegame_file_path filename;
 		state_format_savegame_filename(filename, NUM_SAVES - 1);
-		if (state_save_all_sub(filename.data(), p))
-			con_printf(CON_NORMAL, "Autosave written to \"%s\"", filename.data());
+		auto fp{state_write_savegame(filename.data(), p)};
+		if (!fp)
+			return;
+		/* Everything so far went to the write buffer of `fp`.  The disk
+		 * write happens when it is flushed, which the game need not wait
+		 * for.  Flush before closing, since PhysFS holds its global lock
+		 * while it closes a file.
+		 */
+		auto &w = pending_autosave;
+		w.filename = filename;
+		w.error = PHYSFS_ERR_OK;
+		w.thread = std::thread([&w, fp = std::move(fp)]() mutable {
+			if (!PHYSFS_flush(fp) || !fp.close())
+				w.error = PHYSFS_getLastErrorCode();
+		});
+		con_printf(CON_NORMAL, "Autosave written to \"%s\"", filename.data());
 	}
 }
 
 }
 
+void state_wait_for_autosave()
+{
+	auto &w = pending_autosave;
+	if (!w.thread.joinable())
+		return;
+	w.thread.join();
+	if (w.error != PHYSFS_ERR_OK)
+		con_printf(CON_URGENT, "Failed to write autosave \"%s\": %s", w.filename.data(), PHYSFS_getErrorByCode(w.error));
+}
+
 }
 
 namespace dsx {
@@ -952,6 +993,7 @@ namespace {
 uint8_t read_savegame_properties(const std::size_t savegame_index, d_game_unique_state::savegame_file_path &filename, d_game_unique_state::savegame_description *const dsc, grs_bitmap_ptr *const sc_bmp)
 {
 	state_format_savegame_filename(filename, savegame_index);
+	state_wait_for_autosave();
 	const auto fp = PHYSFSX_openReadBuffered(filename.data()).first;
 	if (!fp)
 		return 0;
@@ -1282,7 +1324,13 @@ int state_save_all(const secret_save secret, const blind_save blind_save)
 	return rval;
 }
 
-int state_save_all_sub(const char *filename, const char *desc)
+int state_save_all_sub(const char *const filename, const char *const desc)
+{
+	auto fp{state_write_savegame(filename, desc)};
+	return fp && fp.close();
+}
+
+RAIIPHYSFS_File state_write_savegame(const char *const filename, const char *const desc)
 {
 	auto &LevelUniqueControlCenterState = LevelUniqueObjectState.ControlCenterState;
 	auto &Objects = LevelUniqueObjectState.Objects;
@@ -1293,6 +1341,7 @@ int state_save_all_sub(const char *filename, const char *desc)
 	auto &Station = LevelUniqueFuelcenterState.Station;
 	fix tmptime32{0};
 
+	state_wait_for_autosave();
 	#ifndef NDEBUG
 	if (CGameArg.SysUsePlayersDir && strncmp(filename, PLAYER_DIRECTORY_TEXT, sizeof(PLAYER_DIRECTORY_TEXT) - 1))
 		Int3();
@@ -1319,7 +1368,7 @@ int state_save_all_sub(const char *filename, const char *desc)
 			}
 		};
 		run_blocking_newmenu<error_writing_savegame>(filename, errstr);
-		return 0;
+		return {};
 	}
 
 	pause_game_world_time p;
@@ -1614,7 +1663,13 @@ int state_save_all_sub(const char *filename, const char *desc)
 			m = -1;
 		PHYSFSX_writeBytes(fp, &m, sizeof(m));
 	}
-	PHYSFS_seek(fp, PHYSFS_tell(fp) + (NUM_MARKERS)*(CALLSIGN_LEN+1)); // MarkerOwner is obsolete
+	{
+		/* MarkerOwner is obsolete.  Write zeros instead of seeking past it,
+		 * since a seek would flush the write buffer.
+		 */
+		const std::array<char, NUM_MARKERS * (CALLSIGN_LEN + 1)> marker_owner{};
+		PHYSFSX_writeBytes(fp, marker_owner.data(), marker_owner.size());
+	}
 	range_for (const auto &m, MarkerState.message)
 		PHYSFSX_writeBytes(fp, m.data(), m.size());
 
@@ -1715,7 +1770,7 @@ int state_save_all_sub(const char *filename, const char *desc)
 		PHYSFSX_writeBytes(fp, &Netgame.numconnected, sizeof(ubyte));
 		PHYSFSX_writeBytes(fp, &Netgame.level_time, sizeof(int));
 	}
-	return 1;
+	return std::move(fp);
 }
 
 //	-----------------------------------------------------------------------------------
@@ -1856,6 +1911,7 @@ int state_restore_all_sub(const d_level_shared_destructible_light_state &LevelSh
 		Int3();
 	#endif
 
+	state_wait_for_autosave();
 	auto fp = PHYSFSX_openReadBuffered(filename).first;
 	if ( !fp ) return 0;
 
@@ -2173,6 +2229,7 @@ int state_restore_all_sub(const d_level_shared_destructible_light_state &LevelSh
 	init_exploding_walls();
 	{
 		auto &Walls = LevelUniqueWallSubsystemState.Walls;
+		++LevelUniqueWallSubsystemState.change_count;
 	Walls.set_count(PHYSFSX_readSXE32(fp, swap));
 		for (auto &w : Walls.vmptr)
 			wall_read(fp, w);
@@ -2584,6 +2641,7 @@ int state_get_game_id(const d_game_unique_state::savegame_file_path &filename)
 	if (!(Game_mode & GM_MULTI_COOP))
 		return 0;
 
+	state_wait_for_autosave();
 	auto fp = PHYSFSX_openReadBuffered(filename.data()).first;
 	if ( !fp ) return 0;
 
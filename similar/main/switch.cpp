@@ -197,6 +197,7 @@ static int do_change_walls(const trigger &t, const uint8_t new_wall_type)
 				wall0.type == new_wall_type)
 				continue;		//already in correct state, so skip
 
+			++LevelUniqueWallSubsystemState.change_count;
 			ret |= 1;
 
 			auto &vcvertptr = Vertices.vcptr;
@@ -76,87 +76,94 @@ static std::unique_ptr<uint8_t[]> build_light_table(std::size_t grid_w, std::siz
 namespace {
 
 // ------------------------------------------------------------------------
-static void draw_cell(grs_canvas &canvas, const vms_vector &Viewer_eye, const int i, const int j, g3_draw_tmap_point &p0, g3_draw_tmap_point &p1, g3_draw_tmap_point &p2, g3_draw_tmap_point &p3, int &mine_tiles_drawn, const int org_i, const int org_j, const std::size_t grid_w)
+static void draw_cell(grs_canvas &canvas, const vms_vector &Viewer_eye, const int i, const int j, g3s_point &p0, g3s_point &p1, g3s_point &p2, g3s_point &p3, int &mine_tiles_drawn, const int org_i, const int org_j, const std::size_t grid_w)
 {
-	std::array<g3_draw_tmap_point *, 3> pointlist{{
-		&p0,
-		&p1,
-		&p3,
-	}};
-
-	const fix lightval_i0j0{LIGHTVAL(i, j)};
-	const fix lightval_i0j1{LIGHTVAL(i, j + 1)};
-	const fix lightval_i1j0{LIGHTVAL(i + 1, j)};
-	g3_check_and_draw_tmap(canvas, pointlist, (std::array<g3s_uvl, 3>{{
-		{
-			.u = i * f1_0 / 4,
-			.v = j * f1_0 / 4,
-			.l = lightval_i0j0,
-		},
-		{
-			.u = i * f1_0 / 4,
-			.v = (j + 1) * f1_0 / 4,
-			.l = lightval_i0j1,
-		},
-		{
-			.u = (i + 1) * f1_0 / 4,
-			.v = j * f1_0 / 4,
-			.l = lightval_i1j0,
-		},
-	}}), (std::array<g3s_lrgb, 3>{{
-		{
-			.r = lightval_i0j0,
-			.g = lightval_i0j0,
-			.b = lightval_i0j0,
-		},
-		{
-			.r = lightval_i0j1,
-			.g = lightval_i0j1,
-			.b = lightval_i0j1,
-		},
-		{
-			.r = lightval_i1j0,
-			.g = lightval_i1j0,
-			.b = lightval_i1j0,
-		},
-	}}), *terrain_bm, draw_tmap);
-
-	pointlist[0] = &p1;
-	pointlist[1] = &p2;
-	const fix lightval_i1j1{LIGHTVAL(i + 1, j + 1)};
-	g3_check_and_draw_tmap(canvas, pointlist, (std::array<g3s_uvl, 3>{{
-		{
-			.u = i * f1_0 / 4,
-			.v = (j + 1) * f1_0 / 4,
-			.l = lightval_i0j1,
-		},
-		{
-			.u = (i + 1) * f1_0 / 4,
-			.v = (j + 1) * f1_0 / 4,
-			.l = lightval_i1j1,
-		},
-		{
-			.u = (i + 1) * f1_0 / 4,
-			.v = j * f1_0 / 4,
-			.l = lightval_i1j0,
-		},
-	}}), (std::array<g3s_lrgb, 3>{{
-		{
-			.r = lightval_i0j1,
-			.g = lightval_i0j1,
-			.b = lightval_i0j1,
-		},
-		{
-			.r = lightval_i1j1,
-			.g = lightval_i1j1,
-			.b = lightval_i1j1,
-		},
-		{
-			.r = lightval_i1j0,
-			.g = lightval_i1j0,
-			.b = lightval_i1j0,
-		},
-	}}), *terrain_bm, draw_tmap);
+	/* Most of the grid is behind or beside the viewer.  A cell with all
+	 * four corners off the same side of the view draws nothing, so skip
+	 * it before building its triangles.
+	 */
+	if ((p0.p3_codes & p1.p3_codes & p2.p3_codes & p3.p3_codes) == clipping_code::None)
+	{
+		std::array<g3_draw_tmap_point *, 3> pointlist{{
+			&p0,
+			&p1,
+			&p3,
+		}};
+
+		const fix lightval_i0j0{LIGHTVAL(i, j)};
+		const fix lightval_i0j1{LIGHTVAL(i, j + 1)};
+		const fix lightval_i1j0{LIGHTVAL(i + 1, j)};
+		g3_check_and_draw_tmap(canvas, pointlist, (std::array<g3s_uvl, 3>{{
+			{
+				.u = i * f1_0 / 4,
+				.v = j * f1_0 / 4,
+				.l = lightval_i0j0,
+			},
+			{
+				.u = i * f1_0 / 4,
+				.v = (j + 1) * f1_0 / 4,
+				.l = lightval_i0j1,
+			},
+			{
+				.u = (i + 1) * f1_0 / 4,
+				.v = j * f1_0 / 4,
+				.l = lightval_i1j0,
+			},
+		}}), (std::array<g3s_lrgb, 3>{{
+			{
+				.r = lightval_i0j0,
+				.g = lightval_i0j0,
+				.b = lightval_i0j0,
+			},
+			{
+				.r = lightval_i0j1,
+				.g = lightval_i0j1,
+				.b = lightval_i0j1,
+			},
+			{
+				.r = lightval_i1j0,
+				.g = lightval_i1j0,
+				.b = lightval_i1j0,
+			},
+		}}), *terrain_bm, draw_tmap);
+
+		pointlist[0] = &p1;
+		pointlist[1] = &p2;
+		const fix lightval_i1j1{LIGHTVAL(i + 1, j + 1)};
+		g3_check_and_draw_tmap(canvas, pointlist, (std::array<g3s_uvl, 3>{{
+			{
+				.u = i * f1_0 / 4,
+				.v = (j + 1) * f1_0 / 4,
+				.l = lightval_i0j1,
+			},
+			{
+				.u = (i + 1) * f1_0 / 4,
+				.v = (j + 1) * f1_0 / 4,
+				.l = lightval_i1j1,
+			},
+			{
+				.u = (i + 1) * f1_0 / 4,
+				.v = j * f1_0 / 4,
+				.l = lightval_i1j0,
+			},
+		}}), (std::array<g3s_lrgb, 3>{{
+			{
+				.r = lightval_i0j1,
+				.g = lightval_i0j1,
+				.b = lightval_i0j1,
+			},
+			{
+				.r = lightval_i1j1,
+				.g = lightval_i1j1,
+				.b = lightval_i1j1,
+			},
+			{
+				.r = lightval_i1j0,
+				.g = lightval_i1j0,
+				.b = lightval_i1j0,
+			},
+		}}), *terrain_bm, draw_tmap);
+	}
 
 	if (i==org_i && j==org_j)
 		mine_tiles_drawn |= 1;
@@ -24,6 +24,8 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
  */
 
 
+#include <list>
+#include <unordered_map>
 #include "gr.h"
 #include "dxxerror.h"
 #include "fmtcheck.h"
@@ -34,6 +36,8 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 #include "segment.h"
 #include "texmerge.h"
 #include "piggy.h"
+#include "args.h"
+#include "console.h"
 
 #include "compiler-range_for.h"
 #include "d_range.h"
@@ -42,6 +46,8 @@ COPYRIGHT 1993-1999 PARALLAX SOFTWARE CORPORATION.  ALL RIGHTS RESERVED.
 
 #if DXX_USE_OGL
 #include "ogl_init.h"
+#else
+#include "texmap.h"
 #endif
 
 namespace dcx {
@@ -93,7 +99,7 @@ struct TEXTURE_CACHE {
 	}
 	cache_key key{};
 	grs_bitmap_ptr bitmap;
-	fix64		last_time_used{};
+	std::size_t bytes;
 };
 
 /* Helper classes merge_texture_0 through merge_texture_3 correspond to
@@ -205,32 +211,49 @@ static void merge_textures(const unsigned wh, const uint8_t *const top_data, con
 	}
 }
 
-static std::array<TEXTURE_CACHE, /* MAX_NUM_CACHE_BITMAPS = */ 10> Cache;
+/* Merged bitmaps, most recently used first, and an index into them by
+ * cache key.  Entries are evicted from the back once the merged bitmaps
+ * exceed -texmergecache.
+ */
+static std::list<TEXTURE_CACHE> Cache;
+static std::unordered_map<TEXTURE_CACHE::cache_key, std::list<TEXTURE_CACHE>::iterator> Cache_index;
+static std::size_t Cache_bytes;
+
+/* The callers draw the merged bitmap before they ask for another, but
+ * keep at least as many as the old fixed cache held.
+ */
+constexpr std::size_t cache_min_entries{10};
 
 static int cache_hits = 0;
 static int cache_misses = 0;
 
+static std::size_t texmerge_cache_budget()
+{
+	return std::size_t{CGameArg.SysTexMergeCacheBudget} * 1024;
+}
+
 }
 
 //----------------------------------------------------------------------
 
 void texmerge_flush()
 {
-	range_for (auto &i, Cache)
-	{
-		i.last_time_used = {};
-		i.key = {};
-	}
+	/* The source bitmaps are being paged out or replaced, so the merged
+	 * bitmaps are stale.
+	 */
+	texmerge_close();
 }
 
 
 //-------------------------------------------------------------------------
 void texmerge_close()
 {
-	range_for (auto &i, Cache)
-	{
-		i.bitmap.reset();
-	}
+#if !DXX_USE_OGL
+	tmap_tiles_flush();
+#endif
+	Cache_index.clear();
+	Cache.clear();
+	Cache_bytes = 0;
 }
 
 }
@@ -244,20 +267,12 @@ grs_bitmap &texmerge_get_cached_bitmap(GameBitmaps_array &GameBitmaps, const Tex
 	
 	const auto orient{get_texture_rotation_low(tmap_top)};
 
-	auto least_recently_used = &Cache.front();
-	auto lowest_time_used{least_recently_used->last_time_used};
 	const auto cache_lookup_key{TEXTURE_CACHE::build_cache_key(texture_bottom, texture_top, orient)};
-	range_for (auto &i, Cache)
+	if (const auto i{Cache_index.find(cache_lookup_key)}; i != Cache_index.end())
 	{
-		if (i.key == cache_lookup_key)	{
-			cache_hits++;
-			i.last_time_used = timer_query();
-			return *i.bitmap.get();
-		}	
-		if ( i.last_time_used < lowest_time_used )	{
-			lowest_time_used = {i.last_time_used};
-			least_recently_used = &i;
-		}
+		cache_hits++;
+		Cache.splice(Cache.begin(), Cache, i->second);
+		return *i->second->bitmap.get();
 	}
 
 	//---- Page out the LRU bitmap;
@@ -297,12 +312,54 @@ grs_bitmap &texmerge_get_cached_bitmap(GameBitmaps_array &GameBitmaps, const Tex
 #endif
 	}
 
-	least_recently_used->key = cache_lookup_key;
-	least_recently_used->bitmap = std::move(merged_bitmap);
-	least_recently_used->last_time_used = timer_query();
+	const std::size_t bytes{std::size_t{mb.bm_w} * mb.bm_h};
+	if (Cache.size() >= cache_min_entries && Cache_bytes + bytes > texmerge_cache_budget())
+	{
+#if !DXX_USE_OGL
+		//binned spans may still read the bitmaps being evicted
+		tmap_tiles_flush();
+#endif
+		do {
+			auto &e = Cache.back();
+			Cache_bytes -= e.bytes;
+			Cache_index.erase(e.key);
+			Cache.pop_back();
+		} while (Cache.size() >= cache_min_entries && Cache_bytes + bytes > texmerge_cache_budget());
+	}
+	Cache.emplace_front(TEXTURE_CACHE{cache_lookup_key, std::move(merged_bitmap), bytes});
+	Cache_index.emplace(cache_lookup_key, Cache.begin());
+	Cache_bytes += bytes;
 	return mb;
 }
 
+void texmerge_cache_level_textures(GameBitmaps_array &GameBitmaps, const Textures_array &Textures)
+{
+	const auto hits{cache_hits}, misses{cache_misses};
+	[&]() {
+		range_for (const unique_segment &seg, vcsegptr)
+		{
+			range_for (auto &side, seg.sides)
+			{
+				const auto tmap2{side.tmap_num2};
+				if (tmap2 == texture2_value::None)
+					continue;
+				if (get_texture_index(side.tmap_num) >= NumTextures || get_texture_index(tmap2) >= NumTextures)
+					continue;
+				/* Stop when the mine has more combinations than fit,
+				 * rather than evict the ones merged first.
+				 */
+				if (Cache.size() >= cache_min_entries && Cache_bytes + Cache.front().bytes > texmerge_cache_budget())
+				{
+					con_printf(CON_VERBOSE, "texmerge: cache budget of %uKB reached while merging level textures", CGameArg.SysTexMergeCacheBudget);
+					return;
+				}
+				static_cast<void>(texmerge_get_cached_bitmap(GameBitmaps, Textures, side.tmap_num, tmap2));
+			}
+		}
+	}();
+	con_printf(CON_DEBUG, "texmerge: %i textures merged for level, %i already cached", cache_misses - misses, cache_hits - hits);
+}
+
 tmapinfo_flags get_side_combined_tmapinfo_flags(const d_level_unique_tmap_info_state::TmapInfo_array &TmapInfo, const unique_side &uside)
 {
 	const auto texture1_index{get_texture_index(uside.tmap_num)};
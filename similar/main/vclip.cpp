@@ -49,15 +49,25 @@ vclip_index build_vclip_index_from_untrusted(const std::size_t i)
 namespace dsx {
 d_vclip_array Vclip;		// General purpose vclips.
 
-//draw an object which renders as a vclip
-void draw_vclip_object(grs_canvas &canvas, const vcobjptridx_t obj, const fix timeleft, const vclip &vc)
+namespace {
+
+//the frame of the vclip to show with timeleft to go, or -1 for none
+static int get_vclip_frame(const vclip &vc, const fix timeleft)
 {
 	const auto nf = vc.num_frames;
 	int bitmapnum = (nf - f2i(fixdiv((nf - 1) * timeleft, vc.play_time))) - 1;
 
 	if (bitmapnum >= vc.num_frames)
 		bitmapnum = vc.num_frames - 1;
+	return bitmapnum;
+}
+
+}
 
+//draw an object which renders as a vclip
+void draw_vclip_object(grs_canvas &canvas, const vcobjptridx_t obj, const fix timeleft, const vclip &vc)
+{
+	const auto bitmapnum{get_vclip_frame(vc, timeleft)};
 	if (bitmapnum >= 0 )	{
 		if (vc.flags & VF_ROD)
 			draw_object_tmap_rod(canvas, nullptr, obj, vc.frames[bitmapnum]);
@@ -67,6 +77,14 @@ void draw_vclip_object(grs_canvas &canvas, const vcobjptridx_t obj, const fix ti
 	}
 }
 
+void draw_vclip_sprite(grs_canvas &canvas, const vms_vector &pos, const fix size, const fix timeleft, const vclip &vc)
+{
+	assert(!(vc.flags & VF_ROD));
+	const auto bitmapnum{get_vclip_frame(vc, timeleft)};
+	if (bitmapnum >= 0)
+		draw_blob(GameBitmaps, canvas, pos, size, vc.frames[bitmapnum]);
+}
+
 void draw_weapon_vclip(const d_vclip_array &Vclip, const weapon_info_array &Weapon_info, grs_canvas &canvas, const vcobjptridx_t obj)
 {
 	Assert(obj->type == OBJ_WEAPON);
@@ -230,6 +230,7 @@ wall_is_doorway_result WALL_IS_DOORWAY(const GameBitmaps_array &GameBitmaps, con
 void wall_init(d_level_unique_wall_subsystem_state &LevelUniqueWallSubsystemState)
 {
 	init_exploding_walls();
+	++LevelUniqueWallSubsystemState.change_count;
 	auto &Walls = LevelUniqueWallSubsystemState.Walls;
 	Walls.set_count(0);
 	range_for (auto &w, Walls)
@@ -259,6 +260,7 @@ void wall_set_tmap_num(const wclip &anim, const vmsegptridx_t seg, const sidenum
 	const auto newdemo_state{Newdemo_state};
 	if (newdemo_state == ND_STATE_PLAYBACK)
 		return;
+	++LevelUniqueWallSubsystemState.change_count;
 
 	const auto tmap = anim.frames[frame_num];
 	auto &uside = seg->unique_segment::sides[side];
@@ -297,6 +299,7 @@ static void blast_blastable_wall(const vmsegptridx_t seg, const sidenum_t side,
 	auto &sside = seg->shared_segment::sides[side];
 	const auto wall_num = sside.wall_num;
 	w0.hps = -1;	//say it's blasted
+	++LevelUniqueWallSubsystemState.change_count;
 
 	const auto &&csegp = seg.absolute_sibling(seg->shared_segment::children[side]);
 	auto Connectside = find_connect_side(seg, csegp);
@@ -452,7 +455,7 @@ void wall_open_door(const vmsegptridx_t seg, const sidenum_t side)
 		d->time = 0;
 	}
 
-
+	++LevelUniqueWallSubsystemState.change_count;
 	w->state = wall_state::opening;
 
 	// So that door can't be shot while opening
@@ -555,6 +558,7 @@ void start_wall_cloak(const vmsegptridx_t seg, const sidenum_t side)
 		if (c >= CloakingWalls.size())
 		{
 			Int3();		//ran out of cloaking wall slots
+			++LevelUniqueWallSubsystemState.change_count;
 			w->type = WALL_OPEN;
 			if (const auto &&w1 = Walls.vmptr.check_untrusted(cwall_num))
 				(*w1)->type = WALL_OPEN;
@@ -1054,6 +1058,7 @@ static void wall_illusion_op(fvmwallptr &vmwallptr, const vcsegptridx_t seg, con
 	const auto &&r = wall_illusion_op(vmwallptr, seg, side);
 	if (r.first)
 	{
+		++LevelUniqueWallSubsystemState.change_count;
 		op(*r.first);
 		op(*r.second);
 	}
@@ -1254,6 +1259,7 @@ bool ad_removal_predicate::operator()(active_door &d) const
 			if (!is_door_obstructed(vcobjptridx, vcsegptr, vcsegptridx(w.segnum), w.sidenum))
 #endif
 			{
+				++LevelUniqueWallSubsystemState.change_count;
 				w.state = wall_state::closing;
 				d.time = 0;
 			}
@@ -1285,6 +1291,7 @@ static void scale_cloaking_wall_light_to_wall(std::array<uvl, 4> &back_uvls, std
 static cwresult do_cloaking_wall_frame(const bool initial, cloaking_wall &d, const cwframe front, const cwframe back)
 {
 	if (d.time > CLOAKING_WALL_TIME) {
+		++LevelUniqueWallSubsystemState.change_count;
 		front.w.type = back.w.type = WALL_OPEN;
 		front.w.state = back.w.state = wall_state::closed;		//why closed? why not?
 		return {
@@ -1303,6 +1310,7 @@ static cwresult do_cloaking_wall_frame(const bool initial, cloaking_wall &d, con
 
 		if (front.w.type != WALL_CLOAKED)
 		{		//just switched
+			++LevelUniqueWallSubsystemState.change_count;
 			front.w.type = back.w.type = WALL_CLOAKED;
 			copy_cloaking_wall_light_to_wall(back.uvls, front.uvls, d);
 		}
@@ -1336,6 +1344,8 @@ static cwresult do_decloaking_wall_frame(const bool initial, cloaking_wall &d, c
 	}
 	else if (d.time > CLOAKING_WALL_TIME/2) {		//fading in
 		fix light_scale;
+		if (front.w.type != WALL_CLOSED)
+			++LevelUniqueWallSubsystemState.change_count;
 		front.w.type = back.w.type = WALL_CLOSED;
 
 		light_scale = fixdiv(d.time - CLOAKING_WALL_TIME / 2, CLOAKING_WALL_TIME / 2);
@@ -1353,6 +1363,8 @@ static cwresult do_decloaking_wall_frame(const bool initial, cloaking_wall &d, c
 			record = true;
 			front.w.cloak_value = back.w.cloak_value = cloak_value;
 		}
+		if (front.w.type != WALL_CLOAKED)
+			++LevelUniqueWallSubsystemState.change_count;
 		front.w.type = WALL_CLOAKED;
 		back.w.type = WALL_CLOAKED;
 		return {
@@ -11,6 +11,8 @@
  *
  */
 
+#include <algorithm>
+#include <bit>
 #include <string>
 #include <vector>
 #include <stdlib.h>
@@ -152,6 +154,8 @@ static void InitGameArg()
 {
 	CGameArg.SysMaxFPS = MAXIMUM_FPS;
 	CGameArg.SysRenderZoomAdjustment = 0;
+	CGameArg.SysRleCacheBudget = 4096;
+	CGameArg.SysTexMergeCacheBudget = 2048;
 #if DXX_USE_UDP
 	CGameArg.MplUdpHostAddr = UDP_MANUAL_ADDR_DEFAULT;
 #if DXX_USE_TRACKER
@@ -164,6 +168,9 @@ static void InitGameArg()
 #if DXX_USE_OGL
 	CGameArg.OglSyncMethod = OGL_SYNC_METHOD_DEFAULT;
 	CGameArg.OglSyncWait = OGL_SYNC_WAIT_DEFAULT;
+#if DXX_USE_VULKAN
+	CGameArg.OglVkRecordThreads = -1;
+#endif
 #if DXX_USE_STEREOSCOPIC_RENDER
 	CGameArg.OglStereo = false;
 #endif
@@ -235,18 +242,55 @@ static void ReadCmdArgs(Inilist &ini, Arglist &&Args)
 			CGameArg.SysUsePlayersDir = static_cast<int8_t>(- (sizeof(PLAYER_DIRECTORY_TEXT) - 1));
 		else if (!d_stricmp(p, "-lowmem"))
 			CGameArg.SysLowMem = true;
+		else if (!d_stricmp(p, "-pvs"))
+			CGameArg.SysPortalVisibility = true;
+		else if (!d_stricmp(p, "-levelcache"))
+			CGameArg.SysLevelCache = true;
+		else if (!d_stricmp(p, "-rlecache"))
+			CGameArg.SysRleCacheBudget = arg_integer(pp, end);
+		else if (!d_stricmp(p, "-bitmapcache"))
+			CGameArg.SysBitmapCacheBudget = arg_integer(pp, end);
+		else if (!d_stricmp(p, "-texmergecache"))
+			CGameArg.SysTexMergeCacheBudget = arg_integer(pp, end);
+		else if (!d_stricmp(p, "-physicstick"))
+			CGameArg.SysPhysicsTick = std::clamp<long>(arg_integer(pp, end), 0, MAXIMUM_FPS);
+		else if (!d_stricmp(p, "-aibudget"))
+			CGameArg.SysAiBudget = std::clamp<long>(arg_integer(pp, end), 0, 1000);
+		else if (!d_stricmp(p, "-threads"))
+			CGameArg.SysThreads = std::clamp<long>(arg_integer(pp, end), 0, 64);
 		else if (!d_stricmp(p, "-pilot"))
 			CGameArg.SysPilot = arg_string(pp, end);
 		else if (!d_stricmp(p, "-record-demo-format"))
 			CGameArg.SysRecordDemoNameTemplate = arg_string(pp, end);
 		else if (!d_stricmp(p, "-auto-record-demo"))
 			CGameArg.SysAutoRecordDemo = true;
+		else if (!d_stricmp(p, "-compress-demo"))
+			CGameArg.SysCompressDemo = true;
+		else if (!d_stricmp(p, "-timedemo"))
+		{
+			CGameArg.SysTimeDemo = arg_string(pp, end);
+			CGameArg.SysNoTitles = true;
+		}
 		else if (!d_stricmp(p, "-window"))
 			CGameArg.SysWindow = true;
 		else if (!d_stricmp(p, "-noborders"))
 			CGameArg.SysNoBorders = true;
 		else if (!d_stricmp(p, "-notitles"))
 			CGameArg.SysNoTitles = true;
+		else if (!d_stricmp(p, "-headless"))
+		{
+#if !DXX_USE_OGL
+			CGameArg.SysHeadless = true;
+			CGameArg.SysNoTitles = true;
+			CGameArg.SndNoSound = true;
+			CGameArg.SndNoMusic = true;
+#if DXX_BUILD_DESCENT == 2
+			GameArg.SysNoMovies = 1;
+#endif
+#endif
+		}
+		else if (!d_stricmp(p, "-autoexec"))
+			CGameArg.SysAutoExec = arg_string(pp, end);
 #if DXX_BUILD_DESCENT == 2
 		else if (!d_stricmp(p, "-nomovies"))
 			GameArg.SysNoMovies 		= 1;
@@ -304,6 +348,16 @@ static void ReadCmdArgs(Inilist &ini, Arglist &&Args)
 					else
 #endif
 				throw unhandled_argument(std::move(*pp));
+#endif
+		}
+		else if (!d_stricmp(p, "-sndbuffer"))
+		{
+			/* SDL wants a power of two */
+			const auto n = std::clamp<long>(arg_integer(pp, end), 0, 8192);
+#if DXX_USE_SDLMIXER
+			CGameArg.SndBufferSize = n ? std::bit_floor(static_cast<unsigned>(std::max<long>(n, 128))) : 0;
+#else
+			(void)n;
 #endif
 		}
 
@@ -328,6 +382,32 @@ static void ReadCmdArgs(Inilist &ini, Arglist &&Args)
 			CGameArg.OglSyncWait = arg_integer(pp, end);
 		else if (!d_stricmp(p, "-gl_darkedges"))
 			CGameArg.OglDarkEdges = true;
+		else if (!d_stricmp(p, "-gl_staticgeometry"))
+			CGameArg.OglStaticGeometry = true;
+		else if (!d_stricmp(p, "-gl_streambuffer"))
+			CGameArg.OglStreamBuffer = true;
+		else if (!d_stricmp(p, "-gl_fronttoback"))
+			CGameArg.OglFrontToBack = true;
+		else if (!d_stricmp(p, "-gl_modelmatrix"))
+			CGameArg.OglModelMatrix = true;
+		else if (!d_stricmp(p, "-gl_insetscale"))
+			CGameArg.OglInsetScale = arg_integer(pp, end);
+		else if (!d_stricmp(p, "-gl_insetrate"))
+			CGameArg.OglInsetRate = arg_integer(pp, end);
+		else if (!d_stricmp(p, "-gl_texturebudget"))
+			CGameArg.OglTextureBudget = arg_integer(pp, end);
+		else if (!d_stricmp(p, "-gl_texcache"))
+			CGameArg.OglTextureCache = true;
+#if DXX_USE_VULKAN
+		else if (!d_stricmp(p, "-vk_arraytextures"))
+			CGameArg.OglVkArrayTextures = true;
+		else if (!d_stricmp(p, "-vk_recordthreads"))
+			CGameArg.OglVkRecordThreads = arg_integer(pp, end);
+		else if (!d_stricmp(p, "-vk_dynres"))
+			CGameArg.OglVkDynResMin = arg_integer(pp, end);
+		else if (!d_stricmp(p, "-vk_shaderlights"))
+			CGameArg.OglVkShaderLights = true;
+#endif
 #if DXX_USE_STEREOSCOPIC_RENDER
 		else if (!d_stricmp(p, "-gl_stereo"))
 			CGameArg.OglStereo = true;
@@ -432,6 +512,8 @@ static void ReadCmdArgs(Inilist &ini, Arglist &&Args)
 #else
 		else if (!d_stricmp(p, "-tmap"))
 			CGameArg.DbgTexMap = arg_string(pp, end);
+		else if (!d_stricmp(p, "-tmap_threads"))
+			CGameArg.DbgTexMapThreads = arg_integer(pp, end);
 		else if (!d_stricmp(p, "-hwsurface"))
 			CGameArg.DbgSdlHWSurface = true;
 		else if (!d_stricmp(p, "-asyncblit"))
@@ -465,6 +547,11 @@ namespace {
 
 static void PostProcessGameArg()
 {
+	/* Nobody watches a headless game, so only tick at the rate the
+	 * game was designed for, unless -maxfps asked for something else.
+	 */
+	if (CGameArg.SysHeadless && CGameArg.SysMaxFPS == MAXIMUM_FPS)
+		CGameArg.SysMaxFPS = DESIGNATED_GAME_FPS;
 	if (CGameArg.SysMaxFPS < MINIMUM_FPS)
 		CGameArg.SysMaxFPS = MINIMUM_FPS;
 	else if (CGameArg.SysMaxFPS > MAXIMUM_FPS)
@@ -480,6 +567,20 @@ static void PostProcessGameArg()
 		sdl_disable_lock_keys[sizeof(sdl_disable_lock_keys) - 2] = '1';
 	SDL_putenv(sdl_disable_lock_keys);
 #endif
+#if !DXX_USE_OGL
+	if (CGameArg.SysHeadless)
+	{
+#if SDL_MAJOR_VERSION == 1
+		static char sdl_videodriver[] = "SDL_VIDEODRIVER=dummy";
+		static char sdl_audiodriver[] = "SDL_AUDIODRIVER=dummy";
+		SDL_putenv(sdl_videodriver);
+		SDL_putenv(sdl_audiodriver);
+#else
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+#endif
+	}
+#endif
 }
 
 static std::string ConstructIniStackExplanation(const Inilist &ini)
@@ -211,6 +211,7 @@ bool PHYSFSX_init(int argc, char *argv[])
 	if (!PHYSFS_init(argv[0]))
 		Error("Failed to init PhysFS: %s", PHYSFS_getLastError());
 #endif
+	PHYSFSX_registerHogArchiver();
 	PHYSFS_permitSymbolicLinks(1);
 	const auto base_dir{PHYSFS_getBaseDir()};
 #if (defined(__APPLE__) && defined(__MACH__))	// others?
@@ -246,6 +247,10 @@ bool PHYSFSX_init(int argc, char *argv[])
 
 		// Best-effort: try to create the directory so it's visible to users.
 		mkdir("/storage/emulated/0/dxx-rebirth", 0755);
+
+		// Game data packaged in the APK is read from it in place, after
+		// any copy the user placed in storage.
+		PHYSFSX_mountApkAssets();
 	}
 #endif
 